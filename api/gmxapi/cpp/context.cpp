@@ -61,6 +61,7 @@
 #include "gromacs/mdrunutility/logging.h"
 #include "gromacs/mdrunutility/multisim.h"
 #include "gromacs/mdrun/runner.h"
+#include "gromacs/mdrun/simulationinput.h"
 #include "gromacs/mdrunutility/handlerestart.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/basenetwork.h"
@@ -285,13 +286,19 @@ std::shared_ptr<Session> ContextImpl::launch(const Workflow& work)
          *       Ref: https://gitlab.com/gromacs/gromacs/-/issues/3652
          */
 
+        // Extend a copy, so that the client arguments can be reused for later launches.
+        MDArgs mdArgs = mdArgs_;
+
         // Set input TPR name
-        mdArgs_.emplace_back("-s");
-        mdArgs_.emplace_back(filename);
+        mdArgs.emplace_back("-s");
+        mdArgs.emplace_back(filename);
 
-        // Set checkpoint file name
-        mdArgs_.emplace_back("-cpi");
-        mdArgs_.emplace_back("state.cpt");
+        // Set checkpoint file name, unless we continue from the state kept in memory
+        if (!keepStateInMemory_)
+        {
+            mdArgs.emplace_back("-cpi");
+            mdArgs.emplace_back("state.cpt");
+        }
         /* Note: we normalize the checkpoint file name, but not its full path.
          * Through version 0.0.8, gmxapi clients change working directory
          * for each session, so relative path(s) below are appropriate.
@@ -304,14 +311,14 @@ std::shared_ptr<Session> ContextImpl::launch(const Workflow& work)
 
         // Create a mock argv. Note that argv[0] is expected to hold the program name.
         const int  offset = 1;
-        const auto argc   = static_cast<size_t>(mdArgs_.size() + offset);
+        const auto argc   = static_cast<size_t>(mdArgs.size() + offset);
         auto       argv   = std::vector<char*>(argc, nullptr);
         // argv[0] is ignored, but should be a valid string (e.g. null terminated array of char)
         argv[0]  = new char[1];
         *argv[0] = '\0';
         for (size_t argvIndex = offset; argvIndex < argc; ++argvIndex)
         {
-            const auto& mdArg = mdArgs_[argvIndex - offset];
+            const auto& mdArg = mdArgs[argvIndex - offset];
             argv[argvIndex]   = new char[mdArg.length() + 1];
             strcpy(argv[argvIndex], mdArg.c_str());
         }
@@ -375,6 +382,23 @@ std::shared_ptr<Session> ContextImpl::launch(const Workflow& work)
         builder.addFilenames(options.filenames);
         // TODO: Remove `s` and `-cpi` from LegacyMdrunOptions before launch(). #3652
         auto simulationInput = makeSimulationInput(options);
+        if (keepStateInMemory_)
+        {
+            if (!options.mdrunOptions.writeConfout)
+            {
+                throw UsageError(
+                        "Keeping the simulation state in memory requires writing the final "
+                        "configuration.");
+            }
+            // Reuse the input kept in memory when the same TPR file is requested
+            if (!retainedInput_
+                || retainedInput_.get()->tprFilename_ != simulationInput.get()->tprFilename_)
+            {
+                retainedInput_                        = simulationInput;
+                retainedInput_.get()->retainInMemory_ = true;
+            }
+            simulationInput = retainedInput_;
+        }
         builder.addInput(simulationInput);
 
         // Note: The gmx_output_env_t life time is not managed after the call to parse_common_args.
@@ -430,6 +454,11 @@ void Context::setMDArgs(const MDArgs& mdArgs)
     impl_->mdArgs_ = mdArgs;
 }
 
+void Context::setKeepStateInMemory(bool keepStateInMemory)
+{
+    impl_->keepStateInMemory_ = keepStateInMemory;
+}
+
 Context::~Context() = default;
 
 } // end namespace gmxapi
@@ -45,6 +45,7 @@
 #include <string>
 
 #include "gromacs/mdrun/legacymdrunoptions.h"
+#include "gromacs/mdrun/simulationinputhandle.h"
 #include "gromacs/mdtypes/mdrunoptions.h"
 #include "gromacs/utility/gmxmpi.h"
 
@@ -250,6 +251,17 @@ public:
      */
     MDArgs mdArgs_;
 
+    //! Whether successive launches continue from the final state of the previous one.
+    bool keepStateInMemory_ = false;
+
+    /*!
+     * \brief Simulation input kept in memory between launches.
+     *
+     * Only used when keepStateInMemory_ is set. The runner of each launch
+     * shares the input and updates its retained state at the end of the run.
+     */
+    gmx::SimulationInputHandle retainedInput_;
+
     /*!
      * \brief Legacy option-handling and set up for mdrun.
      *
@@ -162,6 +162,19 @@ public:
      */
     void setMDArgs(const MDArgs& mdArgs);
 
+    /*!
+     * \brief Continue each launched simulation from the end of the previous one, in memory.
+     *
+     * \param keepStateInMemory Whether to keep simulation input and state in memory.
+     *
+     * When enabled, the first launch reads the TPR file and keeps its contents in memory.
+     * A later launch of a workflow for the same TPR file then starts a new simulation
+     * from the final configuration of the previous launch, without reading the TPR file
+     * again and without reading a checkpoint file. This requires that the final
+     * configuration is written, i.e. mdrun must not be given `-noconfout`.
+     */
+    void setKeepStateInMemory(bool keepStateInMemory);
+
     /*!
      * \brief Launch a workflow in the current context, if possible.
      *
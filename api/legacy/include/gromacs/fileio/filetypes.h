@@ -85,6 +85,7 @@ enum GromacsFileType
     efXPM,
     efRND,
     efCSV,
+    efJSON,
     efNR
 };
 
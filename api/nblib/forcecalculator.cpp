@@ -40,6 +40,8 @@
  * \author Prashanth Kanduri <kanduri@cscs.ch>
  * \author Sebastian Keller <keller@cscs.ch>
  */
+#include <algorithm>
+
 #include "nblib/exception.h"
 #include "nblib/forcecalculator.h"
 #include "nblib/gmxcalculator.h"
@@ -50,7 +52,8 @@ namespace nblib
 
 ForceCalculator::~ForceCalculator() = default;
 
-ForceCalculator::ForceCalculator(const SimulationState& system, const NBKernelOptions& options)
+ForceCalculator::ForceCalculator(const SimulationState& system, const NBKernelOptions& options) :
+    computeEnergies_(options.computeVirialAndEnergy)
 {
     gmxForceCalculator_ = nblib::GmxSetupDirector::setupGmxForceCalculator(system, options);
 }
@@ -65,11 +68,57 @@ void ForceCalculator::compute(gmx::ArrayRef<const Vec3> coordinates, gmx::ArrayR
     gmxForceCalculator_->compute(coordinates, forces);
 }
 
+void ForceCalculator::computeBatch(gmx::ArrayRef<const Vec3> coordinates,
+                                   gmx::ArrayRef<const Box>  boxes,
+                                   gmx::ArrayRef<Vec3>       forces,
+                                   gmx::ArrayRef<real>       energies)
+{
+    const size_t numParticles      = gmxForceCalculator_->particleInfoAllVdw().size();
+    const size_t numConfigurations = boxes.size();
+    if (coordinates.size() != numConfigurations * numParticles)
+    {
+        throw InputException("Coordinates array should hold all particles for each box");
+    }
+    if (coordinates.size() != forces.size())
+    {
+        throw InputException("Coordinates array and force buffer size mismatch");
+    }
+    if (!energies.empty() && energies.size() != numConfigurations)
+    {
+        throw InputException("Energy buffer should hold one value for each box");
+    }
+    if (!energies.empty() && !computeEnergies_)
+    {
+        throw InputException("Energies are only computed with computeVirialAndEnergy");
+    }
+
+    for (size_t configuration = 0; configuration < numConfigurations; configuration++)
+    {
+        const auto x = coordinates.subArray(configuration * numParticles, numParticles);
+        const auto f = forces.subArray(configuration * numParticles, numParticles);
+        std::fill(f.begin(), f.end(), Vec3(0, 0, 0));
+
+        gmxForceCalculator_->updatePairlist(gmxForceCalculator_->particleInfoAllVdw(), x,
+                                            boxes[configuration]);
+        gmxForceCalculator_->compute(x, f);
+        if (!energies.empty())
+        {
+            energies[configuration] = gmxForceCalculator_->potentialEnergy();
+        }
+    }
+}
+
 void ForceCalculator::updatePairList(gmx::ArrayRef<const int> particleInfoAllVdW,
                                      gmx::ArrayRef<Vec3>      coordinates,
                                      const Box&               box)
 {
-    gmxForceCalculator_->setParticlesOnGrid(particleInfoAllVdW, coordinates, box);
+    gmxForceCalculator_->updatePairlist(particleInfoAllVdW, coordinates, box);
+}
+
+void ForceCalculator::updatePairList(gmx::ArrayRef<Vec3> coordinates, const Box& box)
+{
+    gmxForceCalculator_->updatePairlist(gmxForceCalculator_->particleInfoAllVdw(), coordinates,
+                                        box);
 }
 
 } // namespace nblib
@@ -89,6 +89,24 @@ public:
      */
     void compute(gmx::ArrayRef<const Vec3> coordinates, gmx::ArrayRef<Vec3> forces);
 
+    /*! \brief Computes the forces of a batch of configurations of the system
+     *
+     * The configurations are stored one after the other, each with all particles of the
+     * system. For each configuration the particles are put on the grid and the pair lists
+     * are recomputed, reusing all host and device buffers, before the forces are computed.
+     * This avoids setting up a new ForceCalculator for every configuration.
+     *
+     * \param[in] coordinates of all configurations
+     * \param[in] boxes The simulation box of each configuration
+     * \param[out] forces buffer of the size of \p coordinates, overwritten with the forces
+     * \param[out] energies Optional buffer for the short-range potential energy of each
+     *                      configuration, requires NBKernelOptions::computeVirialAndEnergy
+     */
+    void computeBatch(gmx::ArrayRef<const Vec3> coordinates,
+                      gmx::ArrayRef<const Box>  boxes,
+                      gmx::ArrayRef<Vec3>       forces,
+                      gmx::ArrayRef<real>       energies = {});
+
     /*! \brief Puts particles on a grid based on bounds specified by the box
      *
      * As compute is called repeatedly, the particles drift apart and the force computation becomes
@@ -103,7 +121,21 @@ public:
                         gmx::ArrayRef<Vec3>      coordinates,
                         const Box&               box);
 
+    /*! \brief Puts particles on a grid and recomputes the pair lists
+     *
+     * As updatePairList() above, with the particle info used at construction time.
+     * All host and device buffers are reused, so this is much cheaper than
+     * constructing a new ForceCalculator.
+     *
+     * \param coordinates The coordinates to be placed on grids
+     * \param[in] box The system simulation box
+     */
+    void updatePairList(gmx::ArrayRef<Vec3> coordinates, const Box& box);
+
 private:
+    //! Whether the energies are computed
+    bool computeEnergies_;
+
     //! GROMACS force calculator to compute forces
     std::unique_ptr<GmxForceCalculator> gmxForceCalculator_;
 };
@@ -43,12 +43,19 @@
 #include "nblib/gmxcalculator.h"
 #include "gromacs/ewald/ewald_utils.h"
 #include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/gpu_utils/device_stream_manager.h"
+#include "gromacs/hardware/device_information.h"
 #include "gromacs/mdlib/rf_util.h"
 #include "gromacs/mdtypes/enerdata.h"
 #include "gromacs/mdtypes/forcerec.h"
 #include "gromacs/mdtypes/interaction_const.h"
 #include "gromacs/mdtypes/simulation_workload.h"
+#include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/gpu_data_mgmt.h"
 #include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/nbnxm_gpu.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/timing/wallcycle.h"
 #include "gromacs/utility/range.h"
 #include "nblib/exception.h"
 #include "nblib/simulationstate.h"
@@ -63,6 +70,7 @@ GmxForceCalculator::GmxForceCalculator()
     interactionConst_ = std::make_unique<interaction_const_t>();
     stepWork_         = std::make_unique<gmx::StepWorkload>();
     nrnb_             = std::make_unique<t_nrnb>();
+    shiftForces_.resize(numShiftVectors);
 }
 
 GmxForceCalculator::~GmxForceCalculator() = default;
@@ -73,12 +81,43 @@ void GmxForceCalculator::compute(gmx::ArrayRef<const gmx::RVec> coordinateInput,
     // update the coordinates in the backend
     nbv_->convertCoordinates(gmx::AtomLocality::Local, false, coordinateInput);
 
+    if (stepWork_->computeEnergy)
+    {
+        // The kernels accumulate the energies
+        enerd_->grpp.ener[egLJSR][0]   = 0;
+        enerd_->grpp.ener[egCOULSR][0] = 0;
+    }
+
+    if (nbv_->useGpu())
+    {
+        // The outputs are accumulated on the device, so they need clearing before each launch
+        Nbnxm::gpu_clear_outputs(nbv_->gpu_nbv, stepWork_->computeVirial);
+        Nbnxm::gpu_upload_shiftvec(nbv_->gpu_nbv, nbv_->nbat.get());
+        Nbnxm::gpu_copy_xq_to_gpu(nbv_->gpu_nbv, nbv_->nbat.get(), gmx::AtomLocality::Local);
+    }
+
+    // With a GPU this launches the kernel asynchronously
     nbv_->dispatchNonbondedKernel(gmx::InteractionLocality::Local, *interactionConst_, *stepWork_,
                                   enbvClearFYes, *forcerec_, enerd_.get(), nrnb_.get());
 
+    if (nbv_->useGpu())
+    {
+        Nbnxm::gpu_launch_cpyback(nbv_->gpu_nbv, nbv_->nbat.get(), *stepWork_,
+                                  gmx::AtomLocality::Local);
+        Nbnxm::gpu_wait_finish_task(nbv_->gpu_nbv, *stepWork_, gmx::AtomLocality::Local,
+                                    enerd_->grpp.ener[egLJSR].data(),
+                                    enerd_->grpp.ener[egCOULSR].data(), shiftForces_,
+                                    nullWallcycle);
+    }
+
     nbv_->atomdata_add_nbat_f_to_f(gmx::AtomLocality::All, forceOutput);
 }
 
+real GmxForceCalculator::potentialEnergy() const
+{
+    return enerd_->grpp.ener[egLJSR][0] + enerd_->grpp.ener[egCOULSR][0];
+}
+
 void GmxForceCalculator::setParticlesOnGrid(gmx::ArrayRef<const int>       particleInfoAllVdw,
                                             gmx::ArrayRef<const gmx::RVec> coordinates,
                                             const Box&                     box)
@@ -99,4 +138,53 @@ void GmxForceCalculator::setParticlesOnGrid(gmx::ArrayRef<const int>       parti
                       coordinates, 0, nullptr);
 }
 
+void GmxForceCalculator::updatePairlist(gmx::ArrayRef<const int>       particleInfoAllVdw,
+                                        gmx::ArrayRef<const gmx::RVec> coordinates,
+                                        const Box&                     box)
+{
+    setParticlesOnGrid(particleInfoAllVdw, coordinates, box);
+    updateShiftVectors(box.legacyMatrix());
+    // Putting the particles on the grid changes their order in the atom data
+    setAtomProperties(particleInfoAllVdw);
+    constructPairlist();
+}
+
+void GmxForceCalculator::setAtomProperties(gmx::ArrayRef<const int> particleInfoAllVdw)
+{
+    nbv_->setAtomProperties(particleTypeIdOfAllParticles_, charges_, particleInfoAllVdw);
+    if (nbv_->useGpu())
+    {
+        Nbnxm::gpu_init_atomdata(nbv_->gpu_nbv, nbv_->nbat.get());
+    }
+}
+
+void GmxForceCalculator::constructPairlist()
+{
+    // With a GPU, this also uploads the list
+    nbv_->constructPairlist(gmx::InteractionLocality::Local, exclusions_, 0, nrnb_.get());
+    if (nbv_->useGpu())
+    {
+        nbv_->setupGpuShortRangeWork(nullptr, gmx::InteractionLocality::Local);
+    }
+}
+
+void GmxForceCalculator::updateShiftVectors(const matrix& box)
+{
+    bool boxChanged = false;
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            boxChanged = boxChanged || (box[d][e] != box_[d][e]);
+        }
+    }
+    if (boxChanged)
+    {
+        copy_mat(box, box_);
+        calc_shifts(box_, forcerec_->shift_vec);
+        // A changed box requires the shift vectors to be uploaded again
+        nbnxn_atomdata_copy_shiftvec(TRUE, forcerec_->shift_vec, nbv_->nbat.get());
+    }
+}
+
 } // namespace nblib
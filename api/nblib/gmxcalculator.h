@@ -48,7 +48,9 @@
 #define NBLIB_GMXCALCULATOR_H
 
 #include <memory>
+#include <vector>
 
+#include "gromacs/utility/listoflists.h"
 #include "nblib/vector.h"
 
 struct nonbonded_verlet_t;
@@ -56,11 +58,13 @@ struct t_forcerec;
 struct t_nrnb;
 struct interaction_const_t;
 struct gmx_enerdata_t;
+struct DeviceInformation;
 
 namespace gmx
 {
 template<typename T>
 class ArrayRef;
+class DeviceStreamManager;
 class StepWorkload;
 } // namespace gmx
 
@@ -79,7 +83,9 @@ struct NBKernelOptions;
  *
  * Handles the task of storing the simulation problem description using the internal
  * representation used within GROMACS. It currently supports short range non-bonded
- * interactions (PP) on a single node CPU.
+ * interactions (PP) on a single node, computed on the CPU or on a GPU. All host and
+ * device buffers persist between calls, so that a call to compute only converts and
+ * transfers the coordinates, launches the kernel and reduces the forces.
  *
  */
 
@@ -93,15 +99,46 @@ public:
     //! Compute forces and return
     void compute(gmx::ArrayRef<const gmx::RVec> coordinateInput, gmx::ArrayRef<gmx::RVec> forceOutput);
 
+    //! Returns the short-range LJ plus Coulomb energy of the last compute call, when computed
+    real potentialEnergy() const;
+
     //! Puts particles on a grid based on bounds specified by the box (for every NS step)
     void setParticlesOnGrid(gmx::ArrayRef<const int>       particleInfoAllVdw,
                             gmx::ArrayRef<const gmx::RVec> coordinates,
                             const Box&                     box);
 
+    /*! \brief Puts particles on a grid and rebuilds the pairlist for their new order
+     *
+     * The particle properties are set again in the grid order and, with a GPU,
+     * the atom data and the pairlist are uploaded into the existing device buffers,
+     * which are only reallocated when they need to grow.
+     */
+    void updatePairlist(gmx::ArrayRef<const int>       particleInfoAllVdw,
+                        gmx::ArrayRef<const gmx::RVec> coordinates,
+                        const Box&                     box);
+
+    //! Returns the particle info that was used at setup time
+    gmx::ArrayRef<const int> particleInfoAllVdw() const { return particleInfoAllVdw_; }
+
 private:
     //! Friend to allow setting up private members in this class
     friend class NbvSetupUtil;
 
+    //! Sets the particle types and charges in the current grid order of the particles
+    void setAtomProperties(gmx::ArrayRef<const int> particleInfoAllVdw);
+
+    //! Constructs the pairlist and, with a GPU, uploads it
+    void constructPairlist();
+
+    //! Updates the shift vectors when the box has changed
+    void updateShiftVectors(const matrix& box);
+
+    //! Detected devices, owned here for the lifetime of the device stream manager
+    std::vector<std::unique_ptr<DeviceInformation>> deviceInfoList_;
+
+    //! Device context and streams, when the non-bonded forces are computed on a GPU
+    std::unique_ptr<gmx::DeviceStreamManager> deviceStreamManager_;
+
     //! Non-Bonded Verlet object for force calculation
     std::unique_ptr<nonbonded_verlet_t> nbv_;
 
@@ -120,6 +157,21 @@ private:
     //! Non-bonded flop counter; currently only needed as an argument for dispatchNonbondedKernel
     std::unique_ptr<t_nrnb> nrnb_;
 
+    //! Shift forces, only computed with the virial
+    std::vector<gmx::RVec> shiftForces_;
+
+    //! Particle info used at setup time
+    std::vector<int> particleInfoAllVdw_;
+
+    //! Particle type ids, in the input order of the particles
+    std::vector<int> particleTypeIdOfAllParticles_;
+
+    //! Particle charges, in the input order of the particles
+    std::vector<real> charges_;
+
+    //! Exclusions for pairlist construction
+    gmx::ListOfLists<int> exclusions_;
+
     //! Legacy matrix for box
     matrix box_{ { 0 } };
 };
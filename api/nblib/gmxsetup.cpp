@@ -43,6 +43,9 @@
 #include "nblib/gmxsetup.h"
 #include "gromacs/ewald/ewald_utils.h"
 #include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/gpu_utils/device_stream_manager.h"
+#include "gromacs/hardware/device_information.h"
+#include "gromacs/hardware/device_management.h"
 #include "gromacs/mdlib/forcerec.h"
 #include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdlib/rf_util.h"
@@ -50,6 +53,7 @@
 #include "gromacs/mdtypes/interaction_const.h"
 #include "gromacs/mdtypes/simulation_workload.h"
 #include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/gpu_data_mgmt.h"
 #include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/nbnxm/nbnxm_simd.h"
 #include "gromacs/nbnxm/pairlistset.h"
@@ -79,6 +83,11 @@ static Nbnxm::KernelType translateBenchmarkEnum(const SimdKernels& kernel)
  */
 static void checkKernelSetup(const NBKernelOptions& options)
 {
+    if (options.useGpu)
+    {
+        // The SIMD options only apply to the CPU kernels
+        return;
+    }
     if (options.nbnxmSimd >= SimdKernels::Count || options.nbnxmSimd == SimdKernels::SimdAuto)
     {
         throw InputException("Need a valid kernel SIMD type");
@@ -112,6 +121,13 @@ Nbnxm::KernelSetup NbvSetupUtil::getKernelSetup(const NBKernelOptions& options)
 
     Nbnxm::KernelSetup kernelSetup;
 
+    if (options.useGpu)
+    {
+        kernelSetup.kernelType         = Nbnxm::KernelType::Gpu8x8x8;
+        kernelSetup.ewaldExclusionType = Nbnxm::EwaldExclusionType::Analytical;
+        return kernelSetup;
+    }
+
     // The int enum options.nbnxnSimd is set up to match Nbnxm::KernelType + 1
     kernelSetup.kernelType = translateBenchmarkEnum(options.nbnxmSimd);
     // The plain-C kernel does not support analytical ewald correction
@@ -168,7 +184,34 @@ void NbvSetupUtil::setNonBondedParameters(const std::vector<ParticleType>& parti
 void NbvSetupUtil::setAtomProperties(const std::vector<int>&  particleTypeIdOfAllParticles,
                                      const std::vector<real>& charges)
 {
-    gmxForceCalculator_->nbv_->setAtomProperties(particleTypeIdOfAllParticles, charges, particleInfoAllVdw_);
+    // Kept for setting the properties again after the particles are put on the grid anew
+    gmxForceCalculator_->particleTypeIdOfAllParticles_ = particleTypeIdOfAllParticles;
+    gmxForceCalculator_->charges_                      = charges;
+    gmxForceCalculator_->particleInfoAllVdw_           = particleInfoAllVdw_;
+    gmxForceCalculator_->setAtomProperties(particleInfoAllVdw_);
+}
+
+//! Returns a stream manager for the first compatible GPU, stores the detected devices
+static std::unique_ptr<gmx::DeviceStreamManager>
+createDeviceStreamManager(std::vector<std::unique_ptr<DeviceInformation>>* deviceInfoList)
+{
+    std::string errorMessage;
+    if (!canPerformDeviceDetection(&errorMessage))
+    {
+        throw InputException("GPUs cannot be detected: " + errorMessage);
+    }
+    *deviceInfoList              = findDevices();
+    const auto compatibleDevices = getCompatibleDevices(*deviceInfoList);
+    if (compatibleDevices.empty())
+    {
+        throw InputException("No compatible GPU was found");
+    }
+    const DeviceInformation& deviceInfo = compatibleDevices[0].get();
+    setActiveDevice(deviceInfo);
+
+    gmx::SimulationWorkload simulationWork;
+    simulationWork.useGpuNonbonded = true;
+    return std::make_unique<gmx::DeviceStreamManager>(deviceInfo, false, simulationWork, false);
 }
 
 //! Sets up and returns a Nbnxm object for the given options and system
@@ -194,15 +237,27 @@ void NbvSetupUtil::setupNbnxmInstance(const size_t numParticleTypes, const NBKer
 
     auto atomData = std::make_unique<nbnxn_atomdata_t>(pinPolicy);
 
+    // Needs to be called with the number of unique ParticleTypes.
+    // The GPU forces are reduced on the host from a single output buffer.
+    nbnxn_atomdata_init(gmx::MDLogger(), atomData.get(), kernelSetup.kernelType, combinationRule,
+                        numParticleTypes, nonbondedParameters_, 1, options.useGpu ? 1 : numThreads);
+
+    NbnxmGpu* nbnxmGpu = nullptr;
+    if (options.useGpu)
+    {
+        gmxForceCalculator_->deviceStreamManager_ =
+                createDeviceStreamManager(&gmxForceCalculator_->deviceInfoList_);
+        // The device buffers set up here persist for the lifetime of the calculator
+        nbnxmGpu = Nbnxm::gpu_init(*gmxForceCalculator_->deviceStreamManager_,
+                                   gmxForceCalculator_->interactionConst_.get(), pairlistParams,
+                                   atomData.get(), false);
+    }
+
     // Put everything together
     auto nbv = std::make_unique<nonbonded_verlet_t>(std::move(pairlistSets), std::move(pairSearch),
-                                                    std::move(atomData), kernelSetup, nullptr,
+                                                    std::move(atomData), kernelSetup, nbnxmGpu,
                                                     nullWallcycle);
 
-    // Needs to be called with the number of unique ParticleTypes
-    nbnxn_atomdata_init(gmx::MDLogger(), nbv->nbat.get(), kernelSetup.kernelType, combinationRule,
-                        numParticleTypes, nonbondedParameters_, 1, numThreads);
-
     gmxForceCalculator_->nbv_ = std::move(nbv);
 }
 
@@ -289,7 +344,11 @@ void NbvSetupUtil::setupForceRec(const matrix& box)
     assert((gmxForceCalculator_->forcerec_ && "Forcerec not initialized"));
     gmxForceCalculator_->forcerec_->nbfp = nonbondedParameters_;
     snew(gmxForceCalculator_->forcerec_->shift_vec, numShiftVectors);
+    copy_mat(box, gmxForceCalculator_->box_);
     calc_shifts(box, gmxForceCalculator_->forcerec_->shift_vec);
+    // The GPU kernels take the shift vectors from the atom data
+    nbnxn_atomdata_copy_shiftvec(FALSE, gmxForceCalculator_->forcerec_->shift_vec,
+                                 gmxForceCalculator_->nbv_->nbat.get());
 }
 
 void NbvSetupUtil::setParticlesOnGrid(const std::vector<Vec3>& coordinates, const Box& box)
@@ -299,8 +358,9 @@ void NbvSetupUtil::setParticlesOnGrid(const std::vector<Vec3>& coordinates, cons
 
 void NbvSetupUtil::constructPairList(const gmx::ListOfLists<int>& exclusions)
 {
-    gmxForceCalculator_->nbv_->constructPairlist(gmx::InteractionLocality::Local, exclusions, 0,
-                                                 gmxForceCalculator_->nrnb_.get());
+    // Kept for constructing the pairlist again after the particles are put on the grid anew
+    gmxForceCalculator_->exclusions_ = exclusions;
+    gmxForceCalculator_->constructPairlist();
 }
 
 
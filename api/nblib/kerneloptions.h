@@ -85,7 +85,7 @@ enum class CoulombType : int
  */
 struct NBKernelOptions final
 {
-    //! Whether to use a GPU, currently GPUs are not supported
+    //! Whether to compute the forces on the first compatible GPU, the SIMD type is then ignored
     bool useGpu = false;
     //! The number of OpenMP threads to use
     int numOpenMPThreads = 1;
@@ -42,6 +42,8 @@
  * \author Sebastian Keller <keller@cscs.ch>
  * \author Artem Zhmurov <zhmurov@gmail.com>
  */
+#include <cmath>
+
 #include <gtest/gtest.h>
 
 #include "gromacs/topology/exclusionblocks.h"
@@ -196,6 +198,92 @@ TEST(NBlibTest, UpdateChangesForces)
     }
 }
 
+TEST(NBlibTest, UpdatedPairListGivesSameForcesAsNewCalculator)
+{
+    auto options        = NBKernelOptions();
+    options.nbnxmSimd   = SimdKernels::SimdNo;
+    options.coulombType = CoulombType::Cutoff;
+
+    SpcMethanolSimulationStateBuilder spcMethanolSystemBuilder;
+
+    auto simState        = spcMethanolSystemBuilder.setupSimulationState();
+    auto forceCalculator = ForceCalculator(simState, options);
+
+    // Translate the particles periodically, which changes their order on the grid
+    const real boxLength = simState.box().legacyMatrix()[dimX][dimX];
+    for (Vec3& x : simState.coordinates())
+    {
+        x[dimX] = std::fmod(x[dimX] + 0.5 * boxLength, boxLength);
+    }
+
+    forceCalculator.updatePairList(simState.coordinates(), simState.box());
+    std::vector<Vec3> forces(simState.coordinates().size(), Vec3(0, 0, 0));
+    forceCalculator.compute(simState.coordinates(), forces);
+
+    auto              newForceCalculator = ForceCalculator(simState, options);
+    std::vector<Vec3> newForces(simState.coordinates().size(), Vec3(0, 0, 0));
+    newForceCalculator.compute(simState.coordinates(), newForces);
+
+    for (size_t i = 0; i < forces.size(); i++)
+    {
+        for (int j = 0; j < dimSize; j++)
+        {
+            EXPECT_REAL_EQ_TOL(newForces[i][j], forces[i][j], gmx::test::defaultRealTolerance());
+        }
+    }
+}
+
+TEST(NBlibTest, BatchGivesSameForcesAsSeparateCalculators)
+{
+    auto options                   = NBKernelOptions();
+    options.nbnxmSimd              = SimdKernels::SimdNo;
+    options.coulombType            = CoulombType::Cutoff;
+    options.computeVirialAndEnergy = true;
+
+    SpcMethanolSimulationStateBuilder spcMethanolSystemBuilder;
+
+    auto       simState     = spcMethanolSystemBuilder.setupSimulationState();
+    const auto numParticles = simState.coordinates().size();
+
+    // The second configuration is the first one translated periodically
+    std::vector<Vec3> coordinates(simState.coordinates());
+    const real        boxLength = simState.box().legacyMatrix()[dimX][dimX];
+    for (size_t i = 0; i < numParticles; i++)
+    {
+        Vec3 x  = simState.coordinates()[i];
+        x[dimX] = std::fmod(x[dimX] + 0.5 * boxLength, boxLength);
+        coordinates.push_back(x);
+    }
+    std::vector<Box> boxes(2, simState.box());
+
+    auto              forceCalculator = ForceCalculator(simState, options);
+    std::vector<Vec3> forces(coordinates.size());
+    std::vector<real> energies(boxes.size());
+    forceCalculator.computeBatch(coordinates, boxes, forces, energies);
+
+    for (size_t configuration = 0; configuration < boxes.size(); configuration++)
+    {
+        std::copy(coordinates.begin() + configuration * numParticles,
+                  coordinates.begin() + (configuration + 1) * numParticles,
+                  simState.coordinates().begin());
+        auto              singleForceCalculator = ForceCalculator(simState, options);
+        std::vector<Vec3> singleForces(numParticles, Vec3(0, 0, 0));
+        singleForceCalculator.compute(simState.coordinates(), singleForces);
+
+        for (size_t i = 0; i < numParticles; i++)
+        {
+            for (int j = 0; j < dimSize; j++)
+            {
+                EXPECT_REAL_EQ_TOL(singleForces[i][j], forces[configuration * numParticles + i][j],
+                                   gmx::test::defaultRealTolerance());
+            }
+        }
+    }
+    // A periodic translation does not change the energy
+    EXPECT_REAL_EQ_TOL(energies[0], energies[1],
+                       gmx::test::relativeToleranceAsFloatingPoint(1, 1e-5));
+}
+
 TEST(NBlibTest, ArgonForcesAreCorrect)
 {
     auto options        = NBKernelOptions();
@@ -90,6 +90,12 @@ if(GMX_MPI)
       gmx_test_mpi_in_place(MPI_IN_PLACE_EXISTS)
     endif()
 
+    # The MPI extensions header is used to query CUDA-aware MPI support
+    include(CheckIncludeFiles)
+    set(CMAKE_REQUIRED_INCLUDES ${MPI_C_INCLUDE_PATH})
+    check_include_files("mpi.h;mpi-ext.h" HAVE_MPI_EXT)
+    unset(CMAKE_REQUIRED_INCLUDES)
+
     # Find path of the mpi compilers
     if (${MPI_C_FOUND})
         get_filename_component(_mpi_c_compiler_path "${MPI_C_COMPILER}" PATH)
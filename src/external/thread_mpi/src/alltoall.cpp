@@ -63,15 +63,11 @@ int tMPI_Alltoall(void* sendbuf, int sendcount, tMPI_Datatype sendtype,
                   void* recvbuf, int recvcount, tMPI_Datatype recvtype,
                   tMPI_Comm comm)
 {
-    int                 synct;
-    struct coll_env    *cev;
     int                 myrank;
-    int                 ret = TMPI_SUCCESS;
     int                 i;
     size_t              sendsize = sendtype->size*sendcount;
     size_t              recvsize = recvtype->size*recvcount;
-    int                 n_remaining;
-    struct tmpi_thread *cur = tMPI_Get_current();
+    struct tmpi_thread *cur      = tMPI_Get_current();
 
 #ifdef TMPI_PROFILE
     tMPI_Profile_count_start(cur);
@@ -90,83 +86,63 @@ int tMPI_Alltoall(void* sendbuf, int sendcount, tMPI_Datatype sendtype,
     {
         return tMPI_Error(comm, TMPI_ERR_BUF);
     }
-
-    myrank = tMPI_Comm_seek_rank(comm, cur);
-
-    /* we increase our counter, and determine which coll_env we get */
-    cev = tMPI_Get_cev(comm, myrank, &synct);
-
-    /* post our pointers */
-    /* we set up multiple posts, so no Post_multi */
-    cev->met[myrank].tag      = TMPI_ALLTOALL_TAG;
-    cev->met[myrank].datatype = sendtype;
-    tMPI_Atomic_set( &(cev->met[myrank].n_remaining), cev->N-1 );
-    for (i = 0; i < comm->grp.N; i++)
+    if (sendtype != recvtype)
     {
-        cev->met[myrank].bufsize[i]   = sendsize;
-        cev->met[myrank].buf[i]       = (char*)sendbuf+sendsize*i;
-        cev->met[myrank].read_data[i] = FALSE;
+        return tMPI_Error(comm, TMPI_ERR_MULTI_MISMATCH);
     }
-    tMPI_Atomic_memory_barrier_rel();
-    tMPI_Atomic_set(&(cev->met[myrank].current_sync), synct);
-
-    /* post availability */
-    for (i = 0; i < cev->N; i++)
+    if (sendsize > recvsize)
     {
-        if (i != myrank)
-        {
-            tMPI_Event_signal( &(cev->met[i].recv_ev) );
-        }
+        return tMPI_Error(comm, TMPI_ERR_XFER_BUFSIZE);
+    }
+    if (sendbuf == recvbuf && sendsize > 0)
+    {
+        return tMPI_Error(comm, TMPI_ERR_XFER_BUF_OVERLAP);
     }
 
-    /* we don't do the copy buffer thing here because it's pointless:
-       the processes have to synchronize anyway, because they all
-       send and receive. */
+    myrank = tMPI_Comm_seek_rank(comm, cur);
 
-    /* do root transfer */
-    tMPI_Coll_root_xfer(comm, sendtype, recvtype,
-                        sendsize, recvsize,
-                        (char*)sendbuf+sendsize*myrank,
-                        (char*)recvbuf+recvsize*myrank, &ret);
-    cev->met[myrank].read_data[myrank] = TRUE;
-    /* and poll data availability */
-    n_remaining = cev->N-1;
-    while (n_remaining > 0)
-    {
+    /* All threads share memory, so rather than posting an envelope for
+       every destination, we publish our send buffer and let every
+       thread copy its own block out of the buffers of all others. Two
+       flag barriers delimit the time during which the send buffers are
+       read. */
+    tMPI_Atomic_ptr_set(&(comm->reduce_sendbuf[myrank]), sendbuf);
 #if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
-        tMPI_Profile_wait_start(cur);
+    tMPI_Profile_wait_start(cur);
 #endif
-        tMPI_Event_wait( &(cev->met[myrank]).recv_ev );
+    tMPI_Coll_barrier_wait( &(comm->cbarrier), myrank);
 #if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
-        tMPI_Profile_wait_stop(cur, TMPIWAIT_Coll_recv);
+    tMPI_Profile_wait_stop(cur, TMPIWAIT_Coll_recv);
 #endif
-        for (i = 0; i < cev->N; i++)
+
+    if (sendsize > 0)
+    {
+        /* start with our right neighbour to spread the reads over the
+           send buffers */
+        for (i = 0; i < comm->grp.N; i++)
         {
-            if ((!cev->met[myrank].read_data[i]) &&
-                (tMPI_Atomic_get(&(cev->met[i].current_sync)) == synct))
-            {
-                tMPI_Event_process( &(cev->met[myrank]).recv_ev, 1);
-                tMPI_Mult_recv(comm, cev, i, myrank, TMPI_ALLTOALL_TAG,
-                               recvtype, recvsize, (char*)recvbuf+recvsize*i,
-                               &ret);
-                if (ret != TMPI_SUCCESS)
-                {
-                    return ret;
-                }
-                cev->met[myrank].read_data[i] = TRUE;
-                n_remaining--;
-            }
+            int   rank = (myrank + i) % comm->grp.N;
+            char *src  = (char*)tMPI_Atomic_ptr_get(
+                        &(comm->reduce_sendbuf[rank]));
+
+            memcpy((char*)recvbuf + recvsize*rank, src + sendsize*myrank,
+                   sendsize);
         }
     }
 
-
     /* and wait until everybody is done copying our data */
-    tMPI_Wait_for_others(cev, myrank);
+#if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
+    tMPI_Profile_wait_start(cur);
+#endif
+    tMPI_Coll_barrier_wait( &(comm->cbarrier), myrank);
+#if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
+    tMPI_Profile_wait_stop(cur, TMPIWAIT_Coll_send);
+#endif
 
 #ifdef TMPI_PROFILE
     tMPI_Profile_count_stop(cur, TMPIFN_Alltoall);
 #endif
-    return ret;
+    return TMPI_SUCCESS;
 }
 
 
@@ -259,6 +259,81 @@ void tMPI_Coll_sync_destroy(struct coll_sync *csync)
     free(csync->events);
 }
 
+int tMPI_Coll_barrier_init(struct coll_barrier *cb, int N)
+{
+    size_t nlines;
+    int    i;
+
+    cb->N       = N;
+    cb->Nrounds = 0;
+    while ((1 << cb->Nrounds) < N)
+    {
+        cb->Nrounds++;
+    }
+
+    /* allocate one extra line so we can align the start */
+    nlines    = (size_t)N*(cb->Nrounds+1);
+    cb->alloc = tMPI_Malloc(sizeof(union coll_barrier_line)*(nlines+1));
+    if (cb->alloc == NULL)
+    {
+        return TMPI_ERR_NO_MEM;
+    }
+    cb->lines = (union coll_barrier_line*)
+        (((size_t)cb->alloc + TMPI_CACHE_LINE_SIZE - 1) &
+         ~((size_t)TMPI_CACHE_LINE_SIZE - 1));
+
+    for (i = 0; i < N; i++)
+    {
+        union coll_barrier_line *lines = cb->lines + i*(cb->Nrounds+1);
+        int                      k;
+
+        lines[0].self.episode = 0;
+        TMPI_YIELD_WAIT_DATA_INIT(&(lines[0].self));
+        for (k = 0; k < cb->Nrounds; k++)
+        {
+            tMPI_Atomic_set(&(lines[k+1].flag), 0);
+        }
+    }
+    return TMPI_SUCCESS;
+}
+
+void tMPI_Coll_barrier_destroy(struct coll_barrier *cb)
+{
+    free(cb->alloc);
+    cb->alloc = NULL;
+    cb->lines = NULL;
+}
+
+void tMPI_Coll_barrier_wait(struct coll_barrier *cb, int myrank)
+{
+    union coll_barrier_line *my = cb->lines + myrank*(cb->Nrounds+1);
+    int                      episode;
+    int                      k;
+    int                      dist = 1;
+
+    /* the episode counts only increase, so a flag that was already set
+       for a later barrier by a fast thread still releases us. The
+       difference is taken as unsigned to allow for wrap-around. */
+    episode            = my[0].self.episode + 1;
+    my[0].self.episode = episode;
+    for (k = 0; k < cb->Nrounds; k++)
+    {
+        int partner = (myrank + dist) % cb->N;
+
+        /* make our earlier writes visible before signalling */
+        tMPI_Atomic_memory_barrier_rel();
+        tMPI_Atomic_set(&(cb->lines[partner*(cb->Nrounds+1) + k + 1].flag),
+                        episode);
+        while ((int)((unsigned int)tMPI_Atomic_get(&(my[k+1].flag)) -
+                     (unsigned int)episode) < 0)
+        {
+            TMPI_YIELD_WAIT(&(my[0].self));
+        }
+        tMPI_Atomic_memory_barrier_acq();
+        dist *= 2;
+    }
+}
+
 /* get a pointer the next coll_env once it's ready. */
 struct coll_env *tMPI_Get_cev(tMPI_Comm comm, int myrank, int *counter)
 {
@@ -571,8 +646,9 @@ void tMPI_Wait_for_data(struct tmpi_thread tmpi_unused *cur, struct coll_env *ce
 
 int tMPI_Barrier(tMPI_Comm comm)
 {
-#ifdef TMPI_PROFILE
     struct tmpi_thread *cur = tMPI_Get_current();
+
+#ifdef TMPI_PROFILE
     tMPI_Profile_count_start(cur);
 #endif
 
@@ -591,7 +667,8 @@ int tMPI_Barrier(tMPI_Comm comm)
         tMPI_Profile_wait_start(cur);
 #endif
 
-        tMPI_Barrier_wait( &(comm->barrier) );
+        tMPI_Coll_barrier_wait( &(comm->cbarrier),
+                                tMPI_Comm_seek_rank(comm, cur) );
 #if defined(TMPI_PROFILE)
         tMPI_Profile_wait_stop(cur, TMPIWAIT_Barrier);
 #endif
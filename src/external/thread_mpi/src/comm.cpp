@@ -197,6 +197,11 @@ int tMPI_Comm_alloc(tMPI_Comm *newcomm, tMPI_Comm parent, int N)
 
     /* initialize the main barrier */
     tMPI_Barrier_init(&(retc->barrier), N);
+    ret = tMPI_Coll_barrier_init(&(retc->cbarrier), N);
+    if (ret != TMPI_SUCCESS)
+    {
+        return ret;
+    }
 
     /* the reduce barriers */
     {
@@ -352,6 +357,7 @@ int tMPI_Comm_destroy(tMPI_Comm comm, tmpi_bool do_link_lock)
     }
     free(comm->cev);
     free(comm->csync);
+    tMPI_Coll_barrier_destroy( &(comm->cbarrier) );
 
     ret = tMPI_Thread_mutex_destroy( &(comm->comm_create_lock) );
     if (ret != 0)
@@ -386,6 +386,34 @@ struct coll_sync
     int         N;      /* the number of threads */
 };
 
+/* one cache line of a collective barrier. */
+union coll_barrier_line
+{
+    tMPI_Atomic_t flag;           /* a flag set by another thread */
+    struct
+    {
+        int episode;              /* the number of barriers entered */
+        TMPI_YIELD_WAIT_DATA      /* data associated with waiting */
+    } self;                       /* data only used by the owning thread */
+    char padding[TMPI_CACHE_LINE_SIZE];
+};
+
+/* barrier for all threads of a comm, based on flags that each live on
+   their own cache line. It uses a dissemination pattern: in round k,
+   thread i sets a flag of thread (i+2^k)%N and waits for its own flag
+   to be set by thread (i-2^k)%N. Every flag thus has a single writer and
+   a single reader, and there is no shared counter that all threads
+   contend for. The barrier takes ceil(log2(N)) rounds. */
+struct coll_barrier
+{
+    int                      N;       /* the number of threads */
+    int                      Nrounds; /* the number of rounds */
+    union coll_barrier_line *lines;   /* Nrounds+1 lines per thread: the
+                                         first for its own data, then
+                                         one flag per round */
+    void                    *alloc;   /* the unaligned allocation */
+};
+
 
 
 
@@ -551,9 +579,13 @@ struct tmpi_comm_
 {
     struct tmpi_group_ grp; /* the communicator group */
 
-    /* the barrier for tMPI_Barrier() */
+    /* a counter-based barrier for internal synchronization */
     tMPI_Barrier_t barrier;
 
+    /* the flag-based barrier for tMPI_Barrier() and the shared-memory
+       collectives */
+    struct coll_barrier cbarrier;
+
 
     /* List of barriers for reduce operations.
        reduce_barrier[0] contains a list of N/2 barriers for N threads
@@ -806,6 +838,13 @@ int tMPI_Coll_sync_init(struct coll_sync *msc, int N);
 /* destroy a coll sync structure */
 void tMPI_Coll_sync_destroy(struct coll_sync *msc);
 
+/* initialize a collective barrier for N threads */
+int tMPI_Coll_barrier_init(struct coll_barrier *cb, int N);
+/* destroy a collective barrier */
+void tMPI_Coll_barrier_destroy(struct coll_barrier *cb);
+/* wait on a collective barrier until all threads have arrived */
+void tMPI_Coll_barrier_wait(struct coll_barrier *cb, int myrank);
+
 #ifdef USE_COLLECTIVE_COPY_BUFFER
 /* initialize a copy_buffer_list */
 int tMPI_Copy_buffer_list_init(struct copy_buffer_list *cbl, int Nbufs,
@@ -284,10 +284,13 @@ int tMPI_Reduce(void* sendbuf, void* recvbuf, int count,
 int tMPI_Allreduce(void* sendbuf, void* recvbuf, int count,
                    tMPI_Datatype datatype, tMPI_Op op, tMPI_Comm comm)
 {
-    void               *rootbuf = NULL; /* root process' receive buffer */
-    struct tmpi_thread *cur     = tMPI_Get_current();
-    int                 myrank  = tMPI_Comm_seek_rank(comm, cur);
-    int                 ret;
+    struct tmpi_thread *cur = tMPI_Get_current();
+    int                 myrank;
+    int                 N;
+    int                 elems_per_line;
+    int                 nlines;
+    int                 i;
+    int                 ret = TMPI_SUCCESS;
 
 #ifdef TMPI_PROFILE
     tMPI_Profile_count_start(cur);
@@ -300,44 +303,131 @@ int tMPI_Allreduce(void* sendbuf, void* recvbuf, int count,
     {
         return TMPI_SUCCESS;
     }
+    if (!comm)
+    {
+        return tMPI_Error(TMPI_COMM_WORLD, TMPI_ERR_COMM);
+    }
     if (!recvbuf)
     {
         return tMPI_Error(comm, TMPI_ERR_BUF);
     }
+    if ( (!datatype->op_functions) || (!datatype->op_functions[op]) )
+    {
+        return tMPI_Error(comm, TMPI_ERR_OP_FN);
+    }
     if (sendbuf == TMPI_IN_PLACE) /* i.e. sendbuf == TMPI_IN_PLACE */
     {
         sendbuf = recvbuf;
     }
+    myrank = tMPI_Comm_seek_rank(comm, cur);
+    N      = tMPI_Comm_N(comm);
 
-    ret = tMPI_Reduce_fast(sendbuf, recvbuf, count, datatype, op, 0, comm);
-#if defined(TMPI_PROFILE)
+    if (N == 1)
+    {
+        if (sendbuf != recvbuf)
+        {
+            memcpy(recvbuf, sendbuf, datatype->size*count);
+        }
+#ifdef TMPI_PROFILE
+        tMPI_Profile_count_stop(cur, TMPIFN_Allreduce);
+#endif
+        return TMPI_SUCCESS;
+    }
+
+    /* This is a shared-memory reduce-scatter followed by an allgather:
+       every thread reduces one contiguous part of the buffers of all
+       threads into its own receive buffer, after which every thread
+       copies the parts reduced by the others. The parts are a whole
+       number of cache lines so the threads don't write to the same
+       lines, and each element is reduced only once, so the result is
+       identical on all threads. With in-place operation, the part of
+       the send buffer that a thread overwrites is only read by
+       itself. */
+    elems_per_line = TMPI_CACHE_LINE_SIZE/datatype->size;
+    if (elems_per_line < 1)
+    {
+        elems_per_line = 1;
+    }
+    nlines = (count + elems_per_line - 1)/elems_per_line;
+
+    tMPI_Atomic_ptr_set(&(comm->reduce_sendbuf[myrank]), sendbuf);
+    tMPI_Atomic_ptr_set(&(comm->reduce_recvbuf[myrank]), recvbuf);
+#if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
     tMPI_Profile_wait_start(cur);
 #endif
-    tMPI_Barrier_wait( &(comm->barrier));
+    tMPI_Coll_barrier_wait( &(comm->cbarrier), myrank);
 #if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
     tMPI_Profile_wait_stop(cur, TMPIWAIT_Reduce);
 #endif
-    /* distribute rootbuf */
-    rootbuf = (void*)tMPI_Atomic_ptr_get(&(comm->reduce_recvbuf[0]));
 
-    /* and now we just copy things back. We know that the root thread
-       arrives last, so there's no point in using tMPI_Scatter with
-       copy buffers, etc. */
-    if (myrank != 0)
+    /* reduce our part, starting with our own buffer: the part of our
+       send buffer that we overwrite with in-place operation is then
+       already consumed. */
     {
-        if (rootbuf == recvbuf)
+        int start = (int)(((long long)nlines*myrank/N)*elems_per_line);
+        int end   = (int)(((long long)nlines*(myrank+1)/N)*elems_per_line);
+
+        if (end > count)
         {
-            return tMPI_Error(comm, TMPI_ERR_XFER_BUF_OVERLAP);
+            end = count;
+        }
+        if (start < end)
+        {
+            size_t offset = datatype->size*start;
+            char  *dest   = (char*)recvbuf + offset;
+            char  *a      = (char*)sendbuf + offset;
+
+            for (i = 1; i < N && ret == TMPI_SUCCESS; i++)
+            {
+                char *b = (char*)tMPI_Atomic_ptr_get(
+                            &(comm->reduce_sendbuf[(myrank+i)%N])) + offset;
+
+                ret = tMPI_Reduce_run_op(dest, a, b, datatype, end-start,
+                                         op, comm);
+                a   = dest;
+            }
+        }
+    }
+
+    /* wait until all parts are reduced and all send buffers are read */
+#if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
+    tMPI_Profile_wait_start(cur);
+#endif
+    tMPI_Coll_barrier_wait( &(comm->cbarrier), myrank);
+#if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
+    tMPI_Profile_wait_stop(cur, TMPIWAIT_Reduce);
+#endif
+
+    /* gather the parts reduced by the others */
+    for (i = 1; i < N; i++)
+    {
+        int rank  = (myrank+i)%N;
+        int start = (int)(((long long)nlines*rank/N)*elems_per_line);
+        int end   = (int)(((long long)nlines*(rank+1)/N)*elems_per_line);
+
+        if (end > count)
+        {
+            end = count;
+        }
+        if (start < end)
+        {
+            size_t offset = datatype->size*start;
+            char  *src    = (char*)tMPI_Atomic_ptr_get(
+                        &(comm->reduce_recvbuf[rank])) + offset;
+
+            memcpy((char*)recvbuf + offset, src, datatype->size*(end-start));
         }
-        memcpy(recvbuf, rootbuf, datatype->size*count );
     }
 
+    /* and wait until nobody reads our receive buffer any more */
 #if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
     tMPI_Profile_wait_start(cur);
 #endif
-    tMPI_Barrier_wait( &(comm->barrier));
-#if defined(TMPI_PROFILE)
+    tMPI_Coll_barrier_wait( &(comm->cbarrier), myrank);
+#if defined(TMPI_PROFILE) && defined(TMPI_CYCLE_COUNT)
     tMPI_Profile_wait_stop(cur, TMPIWAIT_Reduce);
+#endif
+#ifdef TMPI_PROFILE
     tMPI_Profile_count_stop(cur, TMPIFN_Allreduce);
 #endif
     return ret;
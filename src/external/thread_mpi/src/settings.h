@@ -117,6 +117,13 @@
 #define N_COLL_ENV 2
 #endif
 
+/* The size to which the flags of the collective barriers are padded and
+   aligned, and the granularity with which the work of tMPI_Allreduce is
+   divided over the threads, so no two threads write to the same cache
+   line. 128 covers the cache lines of POWER and the adjacent-line
+   prefetching of x86. */
+#define TMPI_CACHE_LINE_SIZE 128
+
 
 /* Whether to do profiling of the number of MPI communication calls. A
     report with the total number of calls for each communication function
@@ -45,12 +45,14 @@
 #include "analysisdata.h"
 
 #include <memory>
+#include <utility>
 
 #include "gromacs/analysisdata/dataframe.h"
 #include "gromacs/analysisdata/datastorage.h"
 #include "gromacs/analysisdata/paralleloptions.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/inmemoryserializer.h"
 
 namespace gmx
 {
@@ -70,13 +72,43 @@ namespace internal
 class AnalysisDataHandleImpl
 {
 public:
+    //! Operations that are serialized for recorded frames.
+    enum class RecordedOperation : int
+    {
+        SelectDataSet,
+        SetPoint,
+        SetPointWithError,
+        FinishPointSet,
+        FinishFrame
+    };
+
     //! Creates a handle associated with the given data object.
-    explicit AnalysisDataHandleImpl(AnalysisData* data) : data_(*data), currentFrame_(nullptr) {}
+    AnalysisDataHandleImpl(AnalysisData* data, bool bRecord) :
+        data_(*data),
+        currentFrame_(nullptr),
+        bRecord_(bRecord)
+    {
+    }
+
+    //! Whether a frame is currently being added.
+    bool isInFrame() const { return bRecord_ ? recorder_ != nullptr : currentFrame_ != nullptr; }
+    //! Records an operation for the current frame.
+    void record(RecordedOperation op)
+    {
+        int value = static_cast<int>(op);
+        recorder_->doInt(&value);
+    }
 
     //! The data object that this handle belongs to.
     AnalysisData& data_;
     //! Current storage frame object, or NULL if no current frame.
     AnalysisDataStorageFrame* currentFrame_;
+    //! Whether frames are recorded instead of stored.
+    bool bRecord_;
+    //! Serializer for the frame being recorded, or NULL if no current frame.
+    std::unique_ptr<InMemorySerializer> recorder_;
+    //! Last finished recorded frame.
+    std::vector<char> recordedFrame_;
 };
 
 } // namespace internal
@@ -107,6 +139,8 @@ public:
      * to these objects.
      */
     HandleList handles_;
+    //! Whether the handles record frames instead of storing them.
+    bool bRecording_ = false;
 };
 
 /********************************************************************
@@ -154,10 +188,14 @@ AnalysisDataHandle AnalysisData::startData(const AnalysisDataParallelOptions& op
                        "Too many calls to startData() compared to provided options");
     if (impl_->handles_.empty())
     {
-        impl_->storage_.startParallelDataStorage(this, &moduleManager(), opt);
+        impl_->bRecording_ = opt.recordFrames();
+        if (!impl_->bRecording_)
+        {
+            impl_->storage_.startParallelDataStorage(this, &moduleManager(), opt);
+        }
     }
 
-    Impl::HandlePointer handle(new internal::AnalysisDataHandleImpl(this));
+    Impl::HandlePointer handle(new internal::AnalysisDataHandleImpl(this, opt.recordFrames()));
     impl_->handles_.push_back(std::move(handle));
     return AnalysisDataHandle(impl_->handles_.back().get());
 }
@@ -165,6 +203,10 @@ AnalysisDataHandle AnalysisData::startData(const AnalysisDataParallelOptions& op
 
 void AnalysisData::finishFrameSerial(int frameIndex)
 {
+    if (impl_->bRecording_)
+    {
+        return;
+    }
     impl_->storage_.finishFrameSerial(frameIndex);
 }
 
@@ -184,7 +226,7 @@ void AnalysisData::finishData(AnalysisDataHandle handle)
 
     impl_->handles_.erase(i);
 
-    if (impl_->handles_.empty())
+    if (impl_->handles_.empty() && !impl_->bRecording_)
     {
         impl_->storage_.finishDataStorage();
     }
@@ -216,8 +258,16 @@ AnalysisDataHandle::AnalysisDataHandle(internal::AnalysisDataHandleImpl* impl) :
 void AnalysisDataHandle::startFrame(int index, real x, real dx)
 {
     GMX_RELEASE_ASSERT(impl_ != nullptr, "Invalid data handle used");
-    GMX_RELEASE_ASSERT(impl_->currentFrame_ == nullptr,
+    GMX_RELEASE_ASSERT(!impl_->isInFrame(),
                        "startFrame() called twice without calling finishFrame()");
+    if (impl_->bRecord_)
+    {
+        impl_->recorder_ = std::make_unique<InMemorySerializer>();
+        impl_->recorder_->doInt(&index);
+        impl_->recorder_->doReal(&x);
+        impl_->recorder_->doReal(&dx);
+        return;
+    }
     impl_->currentFrame_ = &impl_->data_.impl_->storage_.startFrame(index, x, dx);
 }
 
@@ -225,8 +275,13 @@ void AnalysisDataHandle::startFrame(int index, real x, real dx)
 void AnalysisDataHandle::selectDataSet(int index)
 {
     GMX_RELEASE_ASSERT(impl_ != nullptr, "Invalid data handle used");
-    GMX_RELEASE_ASSERT(impl_->currentFrame_ != nullptr,
-                       "selectDataSet() called without calling startFrame()");
+    GMX_RELEASE_ASSERT(impl_->isInFrame(), "selectDataSet() called without calling startFrame()");
+    if (impl_->bRecord_)
+    {
+        impl_->record(internal::AnalysisDataHandleImpl::RecordedOperation::SelectDataSet);
+        impl_->recorder_->doInt(&index);
+        return;
+    }
     impl_->currentFrame_->selectDataSet(index);
 }
 
@@ -234,8 +289,15 @@ void AnalysisDataHandle::selectDataSet(int index)
 void AnalysisDataHandle::setPoint(int column, real value, bool bPresent)
 {
     GMX_RELEASE_ASSERT(impl_ != nullptr, "Invalid data handle used");
-    GMX_RELEASE_ASSERT(impl_->currentFrame_ != nullptr,
-                       "setPoint() called without calling startFrame()");
+    GMX_RELEASE_ASSERT(impl_->isInFrame(), "setPoint() called without calling startFrame()");
+    if (impl_->bRecord_)
+    {
+        impl_->record(internal::AnalysisDataHandleImpl::RecordedOperation::SetPoint);
+        impl_->recorder_->doInt(&column);
+        impl_->recorder_->doReal(&value);
+        impl_->recorder_->doBool(&bPresent);
+        return;
+    }
     impl_->currentFrame_->setValue(column, value, bPresent);
 }
 
@@ -243,8 +305,16 @@ void AnalysisDataHandle::setPoint(int column, real value, bool bPresent)
 void AnalysisDataHandle::setPoint(int column, real value, real error, bool bPresent)
 {
     GMX_RELEASE_ASSERT(impl_ != nullptr, "Invalid data handle used");
-    GMX_RELEASE_ASSERT(impl_->currentFrame_ != nullptr,
-                       "setPoint() called without calling startFrame()");
+    GMX_RELEASE_ASSERT(impl_->isInFrame(), "setPoint() called without calling startFrame()");
+    if (impl_->bRecord_)
+    {
+        impl_->record(internal::AnalysisDataHandleImpl::RecordedOperation::SetPointWithError);
+        impl_->recorder_->doInt(&column);
+        impl_->recorder_->doReal(&value);
+        impl_->recorder_->doReal(&error);
+        impl_->recorder_->doBool(&bPresent);
+        return;
+    }
     impl_->currentFrame_->setValue(column, value, error, bPresent);
 }
 
@@ -252,11 +322,10 @@ void AnalysisDataHandle::setPoint(int column, real value, real error, bool bPres
 void AnalysisDataHandle::setPoints(int firstColumn, int count, const real* values, bool bPresent)
 {
     GMX_RELEASE_ASSERT(impl_ != nullptr, "Invalid data handle used");
-    GMX_RELEASE_ASSERT(impl_->currentFrame_ != nullptr,
-                       "setPoints() called without calling startFrame()");
+    GMX_RELEASE_ASSERT(impl_->isInFrame(), "setPoints() called without calling startFrame()");
     for (int i = 0; i < count; ++i)
     {
-        impl_->currentFrame_->setValue(firstColumn + i, values[i], bPresent);
+        setPoint(firstColumn + i, values[i], bPresent);
     }
 }
 
@@ -266,8 +335,12 @@ void AnalysisDataHandle::finishPointSet()
     GMX_RELEASE_ASSERT(impl_ != nullptr, "Invalid data handle used");
     GMX_RELEASE_ASSERT(impl_->data_.isMultipoint(),
                        "finishPointSet() called for non-multipoint data");
-    GMX_RELEASE_ASSERT(impl_->currentFrame_ != nullptr,
-                       "finishPointSet() called without calling startFrame()");
+    GMX_RELEASE_ASSERT(impl_->isInFrame(), "finishPointSet() called without calling startFrame()");
+    if (impl_->bRecord_)
+    {
+        impl_->record(internal::AnalysisDataHandleImpl::RecordedOperation::FinishPointSet);
+        return;
+    }
     impl_->currentFrame_->finishPointSet();
 }
 
@@ -275,14 +348,85 @@ void AnalysisDataHandle::finishPointSet()
 void AnalysisDataHandle::finishFrame()
 {
     GMX_RELEASE_ASSERT(impl_ != nullptr, "Invalid data handle used");
-    GMX_RELEASE_ASSERT(impl_->currentFrame_ != nullptr,
-                       "finishFrame() called without calling startFrame()");
+    GMX_RELEASE_ASSERT(impl_->isInFrame(), "finishFrame() called without calling startFrame()");
+    if (impl_->bRecord_)
+    {
+        impl_->record(internal::AnalysisDataHandleImpl::RecordedOperation::FinishFrame);
+        impl_->recordedFrame_ = impl_->recorder_->finishAndGetBuffer();
+        impl_->recorder_.reset();
+        return;
+    }
     AnalysisDataStorageFrame* frame = impl_->currentFrame_;
     impl_->currentFrame_            = nullptr;
     frame->finishFrame();
 }
 
 
+std::vector<char> AnalysisDataHandle::takeRecordedFrame()
+{
+    GMX_RELEASE_ASSERT(impl_ != nullptr, "Invalid data handle used");
+    GMX_RELEASE_ASSERT(impl_->bRecord_, "takeRecordedFrame() called for a non-recording handle");
+    std::vector<char> frame;
+    std::swap(frame, impl_->recordedFrame_);
+    return frame;
+}
+
+
+void AnalysisDataHandle::addRecordedFrame(ArrayRef<const char> frame)
+{
+    using RecordedOperation = internal::AnalysisDataHandleImpl::RecordedOperation;
+
+    InMemoryDeserializer deserializer(frame, GMX_DOUBLE);
+    int                  index;
+    real                 x, dx;
+    deserializer.doInt(&index);
+    deserializer.doReal(&x);
+    deserializer.doReal(&dx);
+    startFrame(index, x, dx);
+    while (true)
+    {
+        int op;
+        deserializer.doInt(&op);
+        switch (static_cast<RecordedOperation>(op))
+        {
+            case RecordedOperation::SelectDataSet:
+            {
+                int dataSet;
+                deserializer.doInt(&dataSet);
+                selectDataSet(dataSet);
+                break;
+            }
+            case RecordedOperation::SetPoint:
+            {
+                int  column;
+                real value;
+                bool bPresent;
+                deserializer.doInt(&column);
+                deserializer.doReal(&value);
+                deserializer.doBool(&bPresent);
+                setPoint(column, value, bPresent);
+                break;
+            }
+            case RecordedOperation::SetPointWithError:
+            {
+                int  column;
+                real value, error;
+                bool bPresent;
+                deserializer.doInt(&column);
+                deserializer.doReal(&value);
+                deserializer.doReal(&error);
+                deserializer.doBool(&bPresent);
+                setPoint(column, value, error, bPresent);
+                break;
+            }
+            case RecordedOperation::FinishPointSet: finishPointSet(); break;
+            case RecordedOperation::FinishFrame: finishFrame(); return;
+            default: GMX_THROW(InternalError("Invalid recorded analysis data frame"));
+        }
+    }
+}
+
+
 void AnalysisDataHandle::finishData()
 {
     GMX_RELEASE_ASSERT(impl_ != nullptr, "Invalid data handle used");
@@ -44,7 +44,10 @@
 #ifndef GMX_ANALYSISDATA_ANALYSISDATA_H
 #define GMX_ANALYSISDATA_ANALYSISDATA_H
 
+#include <vector>
+
 #include "gromacs/analysisdata/abstractdata.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/real.h"
 
 namespace gmx
@@ -163,6 +166,10 @@ public:
      * The \p opt options should be the same for all calls to this method,
      * and the number of calls should match the parallelization factor
      * defined in \p opt.
+     *
+     * If \p opt requests frames to be recorded, the attached modules are
+     * not notified of anything, and the frames added through the handle
+     * can only be retrieved with AnalysisDataHandle::takeRecordedFrame().
      */
     AnalysisDataHandle startData(const AnalysisDataParallelOptions& opt);
     /*! \brief
@@ -356,6 +363,30 @@ public:
      *      modules in frame notification methods.
      */
     void finishFrame();
+    /*! \brief
+     * Returns the last frame finished with a recording handle.
+     *
+     * \returns Serialized calls made for the frame, or an empty buffer if
+     *     no frame has been finished since the previous call.
+     *
+     * Can only be called on a handle created with options that request
+     * frames to be recorded (see AnalysisDataParallelOptions).
+     *
+     * Does not throw.
+     */
+    std::vector<char> takeRecordedFrame();
+    /*! \brief
+     * Adds a frame that was recorded with another handle.
+     *
+     * \param[in] frame  Frame returned by takeRecordedFrame() for a data
+     *     object with the same dimensionality.
+     * \throws    unspecified  Any exception thrown by the methods that
+     *     are used to add the frame.
+     *
+     * Equivalent to repeating the calls from startFrame() to finishFrame()
+     * that were made on the recording handle.
+     */
+    void addRecordedFrame(ArrayRef<const char> frame);
     //! Calls AnalysisData::finishData() for this handle.
     void finishData();
 
@@ -44,6 +44,8 @@
 
 #include "datastorage.h"
 
+#include <cstdlib>
+
 #include <algorithm>
 #include <iterator>
 #include <limits>
@@ -53,9 +55,11 @@
 #include "gromacs/analysisdata/abstractdata.h"
 #include "gromacs/analysisdata/dataframe.h"
 #include "gromacs/analysisdata/datamodulemanager.h"
+#include "gromacs/analysisdata/framearchive.h"
 #include "gromacs/analysisdata/paralleloptions.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/mutex.h"
 
 namespace gmx
 {
@@ -64,11 +68,16 @@ namespace gmx
  * AnalysisDataParallelOptions
  */
 
-AnalysisDataParallelOptions::AnalysisDataParallelOptions() : parallelizationFactor_(1) {}
+AnalysisDataParallelOptions::AnalysisDataParallelOptions() :
+    parallelizationFactor_(1),
+    bRecordFrames_(false)
+{
+}
 
 
 AnalysisDataParallelOptions::AnalysisDataParallelOptions(int parallelizationFactor) :
-    parallelizationFactor_(parallelizationFactor)
+    parallelizationFactor_(parallelizationFactor),
+    bRecordFrames_(false)
 {
     GMX_RELEASE_ASSERT(parallelizationFactor >= 1, "Invalid parallelization factor");
 }
@@ -84,6 +93,24 @@ namespace internal
 //! Smart pointer type for managing a storage frame builder.
 typedef std::unique_ptr<AnalysisDataStorageFrame> AnalysisDataFrameBuilderPointer;
 
+namespace
+{
+
+/*! \brief
+ * Returns the number of bytes of packed frames to keep in memory.
+ *
+ * The limit is given in MiB with the GMX_ANALYSISDATA_MEMORY_LIMIT
+ * environment variable, and defaults to 1024 MiB.
+ */
+size_t archiveMemoryLimit()
+{
+    const char* env       = std::getenv("GMX_ANALYSISDATA_MEMORY_LIMIT");
+    const long  megabytes = (env != nullptr ? std::strtol(env, nullptr, 10) : 1024);
+    return static_cast<size_t>(std::max(megabytes, 0L)) << 20;
+}
+
+} // namespace
+
 /*! \internal \brief
  * Private implementation class for AnalysisDataStorage.
  *
@@ -187,6 +214,19 @@ public:
     {
         return storageLimit_ > 0 || (pendingLimit_ > 1 && modules_->hasSerialModules());
     }
+    /*! \brief
+     * Creates \a archive_ if all frames need to be stored.
+     *
+     * \throws std::bad_alloc if out of memory.
+     */
+    void initArchive();
+    /*! \brief
+     * Moves notified frames that are no longer recent into \a archive_.
+     *
+     * \throws std::bad_alloc if out of memory.
+     * \throws FileIOError if the archive cannot write its temporary file.
+     */
+    void archiveFrames();
     //! Implementation for AnalysisDataStorage::finishFrame().
     void finishFrame(int index);
     /*! \brief
@@ -241,6 +281,15 @@ public:
      * access scenarions (which are not yet otherwise implemented).
      */
     FrameList frames_;
+    /*! \brief
+     * Packed storage for old frames if all frames are stored.
+     *
+     * Frames that have been notified and are older than the latest
+     * AnalysisDataFrameArchive::c_chunkSize notified frames are packed here,
+     * and their values released from \a frames_.  Null if all frames are
+     * not stored.
+     */
+    std::unique_ptr<AnalysisDataFrameArchive> archive_;
     //! Location of oldest frame in \a frames_.
     size_t firstFrameLocation_;
     //! Index of the first frame that is not fully notified.
@@ -263,6 +312,14 @@ public:
      * frame (see \a frames_).
      */
     int nextIndex_;
+    /*! \brief
+     * Protects the frames and the builders when frames are constructed
+     * concurrently.
+     *
+     * Also serializes the parallel notifications, so that modules see
+     * them from one thread at a time.
+     */
+    Mutex mutex_;
 };
 
 /********************************************************************
@@ -289,7 +346,8 @@ public:
         eMissing,  //!< Frame has not yet been started.
         eStarted,  //!< startFrame() has been called.
         eFinished, //!< finishFrame() has been called.
-        eNotified  //!< Appropriate notifications have been sent.
+        eNotified, //!< Appropriate notifications have been sent.
+        eArchived  //!< Values have been moved to the frame archive.
     };
 
     /*! \brief
@@ -308,9 +366,13 @@ public:
     bool isNotified() const { return status_ >= eNotified; }
     //! Whether the frame is ready to be available outside the storage.
     bool isAvailable() const { return status_ >= eFinished; }
+    //! Whether the values have been moved to the frame archive.
+    bool isArchived() const { return status_ >= eArchived; }
 
     //! Marks the frame as notified.
     void markNotified() { status_ = eNotified; }
+    //! Marks the frame as archived and releases the memory for its values.
+    void markArchived();
 
     //! Returns the storage implementation object.
     AnalysisDataStorageImpl& storageImpl() const { return storageImpl_; }
@@ -465,6 +527,30 @@ void AnalysisDataStorageImpl::rotateBuffer()
 }
 
 
+void AnalysisDataStorageImpl::initArchive()
+{
+    if (storeAll() && !archive_)
+    {
+        archive_ = std::make_unique<AnalysisDataFrameArchive>(archiveMemoryLimit());
+    }
+}
+
+
+void AnalysisDataStorageImpl::archiveFrames()
+{
+    GMX_ASSERT(storeAll(), "Frames are only archived if everything is stored");
+    // The most recent frames stay unpacked, as modules commonly access a
+    // few frames before the current one.
+    while (archive_->frameCount() + AnalysisDataFrameArchive::c_chunkSize < firstUnnotifiedIndex_)
+    {
+        AnalysisDataStorageFrameData& frame = *frames_[archive_->frameCount()];
+        GMX_RELEASE_ASSERT(frame.isNotified(), "Archiving a frame before notifications");
+        archive_->addFrame(frame.frameReference());
+        frame.markArchived();
+    }
+}
+
+
 AnalysisDataFrameBuilderPointer AnalysisDataStorageImpl::getFrameBuilder()
 {
     if (builders_.empty())
@@ -479,6 +565,7 @@ AnalysisDataFrameBuilderPointer AnalysisDataStorageImpl::getFrameBuilder()
 
 void AnalysisDataStorageImpl::finishFrame(int index)
 {
+    lock_guard<Mutex> lock(mutex_);
     const int storageIndex = computeStorageLocation(index);
     GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
 
@@ -524,7 +611,11 @@ void AnalysisDataStorageImpl::finishFrameSerial(int index)
         modules_->notifyFrameFinish(storedFrame.header());
     }
     storedFrame.markNotified();
-    if (storedFrame.frameIndex() >= storageLimit_)
+    if (archive_)
+    {
+        archiveFrames();
+    }
+    else if (storedFrame.frameIndex() >= storageLimit_)
     {
         rotateBuffer();
     }
@@ -570,6 +661,17 @@ void AnalysisDataStorageFrameData::clearFrame(int newIndex)
 }
 
 
+void AnalysisDataStorageFrameData::markArchived()
+{
+    status_ = eArchived;
+    std::vector<AnalysisDataValue>().swap(values_);
+    if (baseData().isMultipoint())
+    {
+        std::vector<AnalysisDataPointSetInfo>().swap(pointSets_);
+    }
+}
+
+
 void AnalysisDataStorageFrameData::startFrame(const AnalysisDataFrameHeader&  header,
                                               AnalysisDataFrameBuilderPointer builder)
 {
@@ -585,6 +687,7 @@ void AnalysisDataStorageFrameData::addPointSet(int
                                                int                               firstColumn,
                                                ArrayRef<const AnalysisDataValue> v)
 {
+    lock_guard<Mutex>        lock(storageImpl().mutex_);
     const int                valueCount = v.size();
     AnalysisDataPointSetInfo pointSetInfo(0, valueCount, dataSetIndex, firstColumn);
     AnalysisDataPointSetRef  pointSet(header(), pointSetInfo, v);
@@ -754,6 +857,10 @@ AnalysisDataFrameRef AnalysisDataStorage::tryGetDataFrame(int index) const
     {
         return AnalysisDataFrameRef();
     }
+    if (storedFrame.isArchived())
+    {
+        return impl_->archive_->frame(index);
+    }
     return storedFrame.frameReference();
 }
 
@@ -782,6 +889,7 @@ void AnalysisDataStorage::startDataStorage(AbstractAnalysisData* data, AnalysisD
     // Data needs to be set before calling extendBuffer()
     impl_->data_    = data;
     impl_->modules_ = modules;
+    impl_->initArchive();
     if (!impl_->storeAll())
     {
         // 2 = pending limit (1) + 1
@@ -800,6 +908,7 @@ void AnalysisDataStorage::startParallelDataStorage(AbstractAnalysisData*
     // Data needs to be set before calling extendBuffer()
     impl_->data_    = data;
     impl_->modules_ = modules;
+    impl_->initArchive();
     if (!impl_->storeAll())
     {
         impl_->extendBuffer(impl_->storageLimit_ + pendingLimit + 1);
@@ -810,6 +919,7 @@ void AnalysisDataStorage::startParallelDataStorage(AbstractAnalysisData*
 AnalysisDataStorageFrame& AnalysisDataStorage::startFrame(const AnalysisDataFrameHeader& header)
 {
     GMX_ASSERT(header.isValid(), "Invalid header");
+    lock_guard<Mutex>                       lock(impl_->mutex_);
     internal::AnalysisDataStorageFrameData* storedFrame;
     if (impl_->storeAll())
     {
@@ -850,6 +960,7 @@ AnalysisDataStorageFrame& AnalysisDataStorage::startFrame(int index, real x, rea
 
 AnalysisDataStorageFrame& AnalysisDataStorage::currentFrame(int index)
 {
+    lock_guard<Mutex> lock(impl_->mutex_);
     const int storageIndex = impl_->computeStorageLocation(index);
     GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
 
@@ -252,8 +252,11 @@ private:
  * AnalysisDataStorageFrame::finishPointSet()) take the responsibility of
  * calling all the notification methods in AnalysisDataModuleManager,
  *
- * \todo
- * Proper multi-threaded implementation.
+ * With parallel storage, startFrame(), currentFrame(), finishFrame() and
+ * the methods of AnalysisDataStorageFrame can be called concurrently from
+ * different threads for different frames.  The serial notifications, i.e.,
+ * finishFrameSerial() and access to stored frames, must not run
+ * concurrently with these.
  *
  * \inlibraryapi
  * \ingroup module_analysisdata
@@ -0,0 +1,401 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements gmx::AnalysisDataFrameArchive.
+ *
+ * \ingroup module_analysisdata
+ */
+#include "gmxpre.h"
+
+#include "framearchive.h"
+
+#include "config.h"
+
+#include <cstring>
+
+#if HAVE_MMAP
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Flag in the control byte of a value for isSet().
+constexpr uint8_t c_valueSet = 1 << 0;
+//! Flag in the control byte of a value for hasError().
+constexpr uint8_t c_errorSet = 1 << 1;
+//! Flag in the control byte of a value for isPresent().
+constexpr uint8_t c_valuePresent = 1 << 2;
+//! Shift of the number of stored value bytes in the control byte.
+constexpr int c_byteCountShift = 3;
+
+//! Returns the bit pattern of \p value.
+uint64_t toBits(real value)
+{
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(value));
+    return bits;
+}
+
+//! Returns the value with bit pattern \p bits.
+real fromBits(uint64_t bits)
+{
+    real value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//! Returns the number of low bytes needed to represent \p bits.
+int significantByteCount(uint64_t bits)
+{
+    int count = 0;
+    while (bits != 0)
+    {
+        bits >>= 8;
+        ++count;
+    }
+    return count;
+}
+
+/*! \brief
+ * Appends packed data to a byte buffer.
+ */
+class ChunkWriter
+{
+public:
+    //! Creates a writer that appends to \p data.
+    explicit ChunkWriter(std::vector<uint8_t>* data) : data_(*data) {}
+
+    //! Appends a non-negative integer in a variable number of bytes.
+    void writeCount(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            data_.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        data_.push_back(static_cast<uint8_t>(value));
+    }
+    //! Appends the \p count low bytes of \p bits.
+    void writeBytes(uint64_t bits, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            data_.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+        }
+    }
+    //! Appends a real value with all its bytes.
+    void writeReal(real value) { writeBytes(toBits(value), sizeof(real)); }
+
+private:
+    std::vector<uint8_t>& data_;
+};
+
+/*! \brief
+ * Reads packed data written by ChunkWriter.
+ */
+class ChunkReader
+{
+public:
+    //! Creates a reader for \p data.
+    explicit ChunkReader(ArrayRef<const uint8_t> data) : data_(data), position_(0) {}
+
+    //! Whether all the data has been read.
+    bool atEnd() const { return position_ == data_.size(); }
+    //! Reads an integer written with ChunkWriter::writeCount().
+    uint64_t readCount()
+    {
+        uint64_t value = 0;
+        int      shift = 0;
+        uint8_t  byte;
+        do
+        {
+            byte = readByte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            shift += 7;
+        } while ((byte & 0x80) != 0);
+        return value;
+    }
+    //! Reads \p count low bytes written with ChunkWriter::writeBytes().
+    uint64_t readBytes(int count)
+    {
+        uint64_t bits = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            bits |= static_cast<uint64_t>(readByte()) << (8 * i);
+        }
+        return bits;
+    }
+    //! Reads a value written with ChunkWriter::writeReal().
+    real readReal() { return fromBits(readBytes(sizeof(real))); }
+    //! Reads a single byte.
+    uint8_t readByte()
+    {
+        GMX_RELEASE_ASSERT(position_ < data_.size(), "Corrupted analysis data archive");
+        return data_[position_++];
+    }
+
+private:
+    ArrayRef<const uint8_t> data_;
+    size_t                  position_;
+};
+
+} // namespace
+
+AnalysisDataFrameArchive::AnalysisDataFrameArchive(size_t memoryLimit) :
+    memoryLimit_(memoryLimit),
+    frameCount_(0),
+    firstChunkInMemory_(0),
+    memoryUsage_(0),
+    file_(nullptr),
+    fileSize_(0),
+    unpackedChunk_(-1)
+{
+}
+
+AnalysisDataFrameArchive::~AnalysisDataFrameArchive()
+{
+    if (file_ != nullptr)
+    {
+        std::fclose(file_);
+    }
+}
+
+void AnalysisDataFrameArchive::addFrame(const AnalysisDataFrameRef& frame)
+{
+    GMX_RELEASE_ASSERT(frame.frameIndex() == frameCount_, "Frames must be archived in order");
+    if (frameCount_ % c_chunkSize == 0)
+    {
+        chunks_.emplace_back();
+        std::fill(previousValues_.begin(), previousValues_.end(), 0);
+        std::fill(previousErrors_.begin(), previousErrors_.end(), 0);
+    }
+    Chunk&      chunk = chunks_.back();
+    ChunkWriter writer(&chunk.data);
+    writer.writeReal(frame.x());
+    writer.writeReal(frame.dx());
+    writer.writeCount(frame.pointSetCount());
+    size_t position = 0;
+    for (int i = 0; i < frame.pointSetCount(); ++i)
+    {
+        const AnalysisDataPointSetRef& pointSet = frame.pointSet(i);
+        writer.writeCount(pointSet.columnCount());
+        writer.writeCount(pointSet.dataSetIndex());
+        writer.writeCount(pointSet.firstColumn());
+        if (previousValues_.size() < position + pointSet.columnCount())
+        {
+            previousValues_.resize(position + pointSet.columnCount(), 0);
+            previousErrors_.resize(position + pointSet.columnCount(), 0);
+        }
+        for (const AnalysisDataValue& value : pointSet.values())
+        {
+            const uint64_t valueBits = toBits(value.value());
+            const uint64_t valueDiff = valueBits ^ previousValues_[position];
+            const int      byteCount = significantByteCount(valueDiff);
+            uint8_t        control   = static_cast<uint8_t>(byteCount << c_byteCountShift);
+            control |= (value.isSet() ? c_valueSet : 0);
+            control |= (value.hasError() ? c_errorSet : 0);
+            control |= (value.isPresent() ? c_valuePresent : 0);
+            chunk.data.push_back(control);
+            writer.writeBytes(valueDiff, byteCount);
+            previousValues_[position] = valueBits;
+            if (value.hasError())
+            {
+                const uint64_t errorBits      = toBits(value.error());
+                const uint64_t errorDiff      = errorBits ^ previousErrors_[position];
+                const int      errorByteCount = significantByteCount(errorDiff);
+                chunk.data.push_back(static_cast<uint8_t>(errorByteCount));
+                writer.writeBytes(errorDiff, errorByteCount);
+                previousErrors_[position] = errorBits;
+            }
+            ++position;
+        }
+    }
+    chunk.size = chunk.data.size();
+    ++frameCount_;
+    if (unpackedChunk_ == ssize(chunks_) - 1)
+    {
+        unpackedChunk_ = -1;
+    }
+    if (frameCount_ % c_chunkSize == 0)
+    {
+        chunk.data.shrink_to_fit();
+        memoryUsage_ += chunk.size;
+        spillChunks();
+    }
+}
+
+void AnalysisDataFrameArchive::spillChunks()
+{
+    // The last chunk is full when this is called, so all chunks can be moved.
+    while (memoryUsage_ > memoryLimit_ && firstChunkInMemory_ < chunks_.size())
+    {
+        Chunk& chunk = chunks_[firstChunkInMemory_];
+        if (file_ == nullptr)
+        {
+            file_ = std::tmpfile();
+            if (file_ == nullptr)
+            {
+                GMX_THROW(FileIOError("Could not create a temporary file for analysis data"));
+            }
+        }
+        if (gmx_fseek(file_, fileSize_, SEEK_SET) != 0
+            || std::fwrite(chunk.data.data(), 1, chunk.size, file_) != chunk.size
+            || std::fflush(file_) != 0)
+        {
+            GMX_THROW(FileIOError("Could not write analysis data to a temporary file"));
+        }
+        chunk.fileOffset = fileSize_;
+        fileSize_ += chunk.size;
+        memoryUsage_ -= chunk.size;
+        std::vector<uint8_t>().swap(chunk.data);
+        ++firstChunkInMemory_;
+    }
+}
+
+void AnalysisDataFrameArchive::unpackChunk(int chunkIndex) const
+{
+    const Chunk&   chunk = chunks_[chunkIndex];
+    const uint8_t* data  = chunk.data.data();
+#if HAVE_MMAP
+    void*  mapping     = nullptr;
+    size_t mappingSize = 0;
+#else
+    std::vector<uint8_t> fileData;
+#endif
+    if (chunk.fileOffset >= 0)
+    {
+#if HAVE_MMAP
+        const int64_t pageSize  = sysconf(_SC_PAGESIZE);
+        const int64_t mapOffset = chunk.fileOffset - chunk.fileOffset % pageSize;
+        mappingSize             = chunk.size + (chunk.fileOffset - mapOffset);
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fileno(file_), mapOffset);
+        if (mapping == MAP_FAILED)
+        {
+            GMX_THROW(FileIOError("Could not map analysis data from a temporary file"));
+        }
+        data = static_cast<const uint8_t*>(mapping) + (chunk.fileOffset - mapOffset);
+#else
+        fileData.resize(chunk.size);
+        if (gmx_fseek(file_, chunk.fileOffset, SEEK_SET) != 0
+            || std::fread(fileData.data(), 1, chunk.size, file_) != chunk.size)
+        {
+            GMX_THROW(FileIOError("Could not read analysis data from a temporary file"));
+        }
+        data = fileData.data();
+#endif
+    }
+
+    ChunkReader reader(arrayRefFromArray(data, chunk.size));
+    unpackedFrames_.resize(c_chunkSize);
+    std::vector<uint64_t> previousValues;
+    std::vector<uint64_t> previousErrors;
+    for (int frameIndex = chunkIndex * c_chunkSize; !reader.atEnd(); ++frameIndex)
+    {
+        UnpackedFrame& unpacked = unpackedFrames_[frameIndex % c_chunkSize];
+        const real     x        = reader.readReal();
+        const real     dx       = reader.readReal();
+        unpacked.header         = AnalysisDataFrameHeader(frameIndex, x, dx);
+        unpacked.values.clear();
+        unpacked.pointSets.clear();
+        const int pointSetCount = reader.readCount();
+        for (int i = 0; i < pointSetCount; ++i)
+        {
+            const int valueCount   = reader.readCount();
+            const int dataSetIndex = reader.readCount();
+            const int firstColumn  = reader.readCount();
+            unpacked.pointSets.emplace_back(unpacked.values.size(), valueCount, dataSetIndex,
+                                            firstColumn);
+            if (previousValues.size() < unpacked.values.size() + valueCount)
+            {
+                previousValues.resize(unpacked.values.size() + valueCount, 0);
+                previousErrors.resize(unpacked.values.size() + valueCount, 0);
+            }
+            for (int j = 0; j < valueCount; ++j)
+            {
+                const size_t   position = unpacked.values.size();
+                const uint8_t  control  = reader.readByte();
+                const uint64_t valueBits =
+                        previousValues[position] ^ reader.readBytes(control >> c_byteCountShift);
+                previousValues[position] = valueBits;
+                AnalysisDataValue value;
+                value.value() = fromBits(valueBits);
+                if ((control & c_errorSet) != 0)
+                {
+                    const int      errorByteCount = reader.readByte();
+                    const uint64_t errorBits =
+                            previousErrors[position] ^ reader.readBytes(errorByteCount);
+                    previousErrors[position] = errorBits;
+                    value.setError(fromBits(errorBits));
+                }
+                if ((control & c_valueSet) != 0)
+                {
+                    value.setValue(value.value(), (control & c_valuePresent) != 0);
+                }
+                unpacked.values.push_back(value);
+            }
+        }
+    }
+#if HAVE_MMAP
+    if (mapping != nullptr)
+    {
+        munmap(mapping, mappingSize);
+    }
+#endif
+    unpackedChunk_ = chunkIndex;
+}
+
+AnalysisDataFrameRef AnalysisDataFrameArchive::frame(int index) const
+{
+    GMX_ASSERT(index >= 0 && index < frameCount_, "Frame not in the archive");
+    const int chunkIndex = index / c_chunkSize;
+    if (unpackedChunk_ != chunkIndex)
+    {
+        unpackChunk(chunkIndex);
+    }
+    const UnpackedFrame& frame = unpackedFrames_[index % c_chunkSize];
+    return AnalysisDataFrameRef(frame.header, frame.values, frame.pointSets);
+}
+
+} // namespace gmx
@@ -0,0 +1,178 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares gmx::AnalysisDataFrameArchive.
+ *
+ * This header is only meant for use within the analysis data module,
+ * for implementing AnalysisDataStorage.
+ *
+ * \inlibraryapi
+ * \ingroup module_analysisdata
+ */
+#ifndef GMX_ANALYSISDATA_FRAMEARCHIVE_H
+#define GMX_ANALYSISDATA_FRAMEARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <vector>
+
+#include "gromacs/analysisdata/dataframe.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/classhelpers.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Compressed storage for analysis data frames.
+ *
+ * Frames are added in order of their index and packed into chunks of
+ * c_chunkSize frames.  Each value is stored as the bytes that differ from
+ * the value at the same position in the previous frame of the chunk, which
+ * is compact for data that changes little from frame to frame.  Unset
+ * values and missing error estimates take a single byte.
+ *
+ * When the memory used by the packed chunks exceeds the limit given to the
+ * constructor, the oldest chunks are moved to an anonymous temporary file,
+ * and read back through a memory mapping where available.
+ *
+ * Accessing a frame unpacks its whole chunk, so that accessing the frames
+ * in order is cheap.  The references returned by frame() stay valid until
+ * a frame from another chunk is accessed or a frame is added to the chunk.
+ *
+ * Methods in this class are not thread-safe.
+ *
+ * \inlibraryapi
+ * \ingroup module_analysisdata
+ */
+class AnalysisDataFrameArchive
+{
+public:
+    //! Number of frames packed together.
+    static constexpr int c_chunkSize = 64;
+
+    /*! \brief
+     * Creates an empty archive.
+     *
+     * \param[in] memoryLimit  Number of bytes of packed chunks to keep in
+     *     memory before moving chunks to a temporary file.
+     */
+    explicit AnalysisDataFrameArchive(size_t memoryLimit);
+    ~AnalysisDataFrameArchive();
+
+    //! Returns the number of frames in the archive.
+    int frameCount() const { return frameCount_; }
+    //! Returns the number of bytes of packed data kept in memory.
+    size_t memoryUsage() const { return memoryUsage_; }
+    //! Returns the number of bytes of packed data moved to the temporary file.
+    int64_t spilledSize() const { return fileSize_; }
+
+    /*! \brief
+     * Adds a frame to the archive.
+     *
+     * \param[in] frame  Frame to add.  Its index must equal frameCount().
+     * \throws    std::bad_alloc if out of memory.
+     * \throws    FileIOError if the temporary file cannot be written.
+     */
+    void addFrame(const AnalysisDataFrameRef& frame);
+    /*! \brief
+     * Returns a frame from the archive.
+     *
+     * \param[in] index  Zero-based frame index, less than frameCount().
+     * \throws    std::bad_alloc if out of memory.
+     * \throws    FileIOError if the temporary file cannot be read.
+     */
+    AnalysisDataFrameRef frame(int index) const;
+
+private:
+    //! Packed data for a chunk of frames.
+    struct Chunk
+    {
+        //! Packed frames, empty if the chunk has been moved to the file.
+        std::vector<uint8_t> data;
+        //! Offset of the chunk in the temporary file, or -1 if in memory.
+        int64_t fileOffset = -1;
+        //! Size of the packed frames.
+        size_t size = 0;
+    };
+
+    //! A frame unpacked from a chunk.
+    struct UnpackedFrame
+    {
+        //! Header of the frame.
+        AnalysisDataFrameHeader header;
+        //! Values of the frame.
+        std::vector<AnalysisDataValue> values;
+        //! Point sets of the frame.
+        std::vector<AnalysisDataPointSetInfo> pointSets;
+    };
+
+    //! Moves packed chunks to the temporary file until within the memory limit.
+    void spillChunks();
+    //! Unpacks chunk \p chunkIndex into \a unpackedFrames_.
+    void unpackChunk(int chunkIndex) const;
+
+    //! Maximum number of bytes of packed chunks kept in memory.
+    size_t memoryLimit_;
+    //! Number of frames in the archive.
+    int frameCount_;
+    //! Packed chunks, the last of which may not be full.
+    std::vector<Chunk> chunks_;
+    //! Index of the first chunk that is still in memory.
+    size_t firstChunkInMemory_;
+    //! Bytes of packed data in memory in full chunks.
+    size_t memoryUsage_;
+    //! Bit patterns of the values in the previous frame added.
+    std::vector<uint64_t> previousValues_;
+    //! Bit patterns of the error estimates in the previous frame added.
+    std::vector<uint64_t> previousErrors_;
+    //! Temporary file for spilled chunks, or nullptr if not yet needed.
+    FILE* file_;
+    //! Number of bytes written to \a file_.
+    int64_t fileSize_;
+    //! Index of the chunk in \a unpackedFrames_, or -1 if none.
+    mutable int unpackedChunk_;
+    //! Frames of the most recently accessed chunk.
+    mutable std::vector<UnpackedFrame> unpackedFrames_;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(AnalysisDataFrameArchive);
+};
+
+} // namespace gmx
+
+#endif
@@ -76,8 +76,21 @@ public:
     //! Returns the number of frames that may be constructed concurrently.
     int parallelizationFactor() const { return parallelizationFactor_; }
 
+    /*! \brief
+     * Sets whether frames are recorded for use elsewhere.
+     *
+     * If set, data handles created with these options do not pass the
+     * frames to the attached modules, but record them such that they can
+     * be added to the same data object in another process (see
+     * AnalysisDataHandle::takeRecordedFrame()).
+     */
+    void setRecordFrames(bool bRecord) { bRecordFrames_ = bRecord; }
+    //! Returns whether frames are recorded instead of processed.
+    bool recordFrames() const { return bRecordFrames_; }
+
 private:
-    int parallelizationFactor_;
+    int  parallelizationFactor_;
+    bool bRecordFrames_;
 };
 
 } // namespace gmx
@@ -50,6 +50,8 @@
 
 #include "gromacs/analysisdata/analysisdata.h"
 
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -405,6 +407,32 @@ TYPED_TEST(AnalysisDataCommonTest, CallsModuleCorrectlyWithOutOfOrderFrames)
     ASSERT_NO_THROW_GMX(handle2.finishData());
 }
 
+/*
+ * Tests that frames recorded through one data object are forwarded correctly
+ * to modules when added to another data object.
+ */
+TYPED_TEST(AnalysisDataCommonTest, CallsModuleCorrectlyWithRecordedFrames)
+{
+    gmx::AnalysisData recordingData;
+    ASSERT_NO_THROW_GMX(AnalysisDataTest::setupDataObject(this->input_, &recordingData));
+    ASSERT_NO_THROW_GMX(AnalysisDataTest::addStaticCheckerModule());
+    gmx::AnalysisDataParallelOptions recordingOptions;
+    recordingOptions.setRecordFrames(true);
+    gmx::AnalysisDataHandle recordingHandle;
+    gmx::AnalysisDataHandle handle;
+    ASSERT_NO_THROW_GMX(recordingHandle = recordingData.startData(recordingOptions));
+    ASSERT_NO_THROW_GMX(handle = this->data_.startData(gmx::AnalysisDataParallelOptions()));
+    for (int row = 0; row < this->input_.frameCount(); ++row)
+    {
+        ASSERT_NO_THROW_GMX(AnalysisDataTest::presentDataFrame(this->input_, row, recordingHandle));
+        const std::vector<char> frame = recordingHandle.takeRecordedFrame();
+        ASSERT_FALSE(frame.empty());
+        ASSERT_NO_THROW_GMX(handle.addRecordedFrame(frame));
+    }
+    ASSERT_NO_THROW_GMX(recordingHandle.finishData());
+    ASSERT_NO_THROW_GMX(handle.finishData());
+}
+
 /*
  * Tests that data can be accessed correctly from a module that requests
  * storage using AbstractAnalysisData::requestStorage() with parameter -1.
@@ -0,0 +1,193 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx::AnalysisDataFrameArchive.
+ *
+ * These tests check that frames packed into the archive are returned
+ * unchanged, both from memory and after being moved to the temporary file,
+ * and that gmx::AnalysisDataStorage returns archived frames when storing
+ * all frames.
+ *
+ * \ingroup module_analysisdata
+ */
+#include "gmxpre.h"
+
+#include "gromacs/analysisdata/framearchive.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/analysisdata/analysisdata.h"
+#include "gromacs/analysisdata/paralleloptions.h"
+
+namespace
+{
+
+using gmx::AnalysisDataFrameArchive;
+using gmx::AnalysisDataFrameHeader;
+using gmx::AnalysisDataFrameRef;
+using gmx::AnalysisDataPointSetInfo;
+using gmx::AnalysisDataValue;
+
+//! Number of frames to add, not a multiple of the chunk size.
+const int c_frameCount = 3 * AnalysisDataFrameArchive::c_chunkSize + 5;
+
+//! Creates a frame with varying point sets and value flags.
+void makeFrame(int                                    index,
+               std::vector<AnalysisDataValue>*        values,
+               std::vector<AnalysisDataPointSetInfo>* pointSets)
+{
+    values->clear();
+    pointSets->clear();
+    const int pointSetCount = 1 + index % 3;
+    for (int i = 0; i < pointSetCount; ++i)
+    {
+        const int valueCount = 2 + (index + i) % 4;
+        pointSets->emplace_back(values->size(), valueCount, i % 2, i);
+        for (int j = 0; j < valueCount; ++j)
+        {
+            AnalysisDataValue value;
+            switch ((index + j) % 4)
+            {
+                case 0: value.setValue(0.5_real * j + 0.01_real * index); break;
+                case 1: value.setValue(-1.0_real * index, 0.25_real * j); break;
+                case 2: value.setValue(3.0_real, false); break;
+                default: break;
+            }
+            values->push_back(value);
+        }
+    }
+}
+
+//! Checks that \p frame matches the frame created by makeFrame().
+void checkFrame(int index, const AnalysisDataFrameRef& frame)
+{
+    std::vector<AnalysisDataValue>        values;
+    std::vector<AnalysisDataPointSetInfo> pointSets;
+    makeFrame(index, &values, &pointSets);
+    ASSERT_TRUE(frame.isValid());
+    EXPECT_EQ(index, frame.frameIndex());
+    EXPECT_EQ(static_cast<real>(0.1 * index), frame.x());
+    EXPECT_EQ(static_cast<real>(0.1), frame.dx());
+    ASSERT_EQ(pointSets.size(), static_cast<size_t>(frame.pointSetCount()));
+    for (size_t i = 0; i < pointSets.size(); ++i)
+    {
+        const gmx::AnalysisDataPointSetRef& pointSet = frame.pointSet(i);
+        EXPECT_EQ(pointSets[i].dataSetIndex(), pointSet.dataSetIndex());
+        EXPECT_EQ(pointSets[i].firstColumn(), pointSet.firstColumn());
+        ASSERT_EQ(pointSets[i].valueCount(), pointSet.columnCount());
+        for (int j = 0; j < pointSet.columnCount(); ++j)
+        {
+            const AnalysisDataValue& expected = values[pointSets[i].valueOffset() + j];
+            const AnalysisDataValue& actual   = pointSet.values()[j];
+            EXPECT_EQ(expected.isSet(), actual.isSet());
+            EXPECT_EQ(expected.hasError(), actual.hasError());
+            EXPECT_EQ(expected.isPresent(), actual.isPresent());
+            EXPECT_EQ(expected.value(), actual.value());
+            EXPECT_EQ(expected.error(), actual.error());
+        }
+    }
+}
+
+//! Adds frames created by makeFrame() to \p archive.
+void fillArchive(AnalysisDataFrameArchive* archive)
+{
+    std::vector<AnalysisDataValue>        values;
+    std::vector<AnalysisDataPointSetInfo> pointSets;
+    for (int index = 0; index < c_frameCount; ++index)
+    {
+        makeFrame(index, &values, &pointSets);
+        archive->addFrame(AnalysisDataFrameRef(AnalysisDataFrameHeader(index, 0.1 * index, 0.1),
+                                               values, pointSets));
+    }
+}
+
+TEST(AnalysisDataFrameArchiveTest, ReturnsFramesFromMemory)
+{
+    AnalysisDataFrameArchive archive(1 << 30);
+    fillArchive(&archive);
+    EXPECT_EQ(c_frameCount, archive.frameCount());
+    EXPECT_EQ(0, archive.spilledSize());
+    for (int index = 0; index < c_frameCount; ++index)
+    {
+        checkFrame(index, archive.frame(index));
+    }
+}
+
+TEST(AnalysisDataFrameArchiveTest, ReturnsFramesFromTemporaryFile)
+{
+    AnalysisDataFrameArchive archive(0);
+    fillArchive(&archive);
+    EXPECT_EQ(0U, archive.memoryUsage());
+    EXPECT_GT(archive.spilledSize(), 0);
+    // Access the chunks in reverse order to unpack each of them separately.
+    for (int index = c_frameCount - 1; index >= 0; --index)
+    {
+        checkFrame(index, archive.frame(index));
+    }
+}
+
+TEST(AnalysisDataFrameArchiveTest, AnalysisDataReturnsArchivedFrames)
+{
+    gmx::AnalysisData data;
+    data.setColumnCount(0, 3);
+    ASSERT_TRUE(data.requestStorage(-1));
+    gmx::AnalysisDataHandle handle = data.startData(gmx::AnalysisDataParallelOptions());
+    for (int index = 0; index < c_frameCount; ++index)
+    {
+        handle.startFrame(index, 0.1 * index);
+        handle.setPoint(0, index);
+        handle.setPoint(1, 0.5_real * index, 0.25_real);
+        handle.setPoint(2, 1.0_real, false);
+        handle.finishFrame();
+    }
+    handle.finishData();
+
+    ASSERT_EQ(c_frameCount, data.frameCount());
+    for (int index = 0; index < c_frameCount; ++index)
+    {
+        AnalysisDataFrameRef frame = data.getDataFrame(index);
+        EXPECT_EQ(index, frame.frameIndex());
+        EXPECT_EQ(static_cast<real>(0.1 * index), frame.x());
+        EXPECT_EQ(index, frame.y(0));
+        EXPECT_EQ(static_cast<real>(0.5 * index), frame.y(1));
+        EXPECT_EQ(0.25, frame.pointSet(0).values()[1].error());
+        EXPECT_FALSE(frame.present(2));
+    }
+}
+
+} // namespace
@@ -708,8 +708,56 @@ void setNeighborsOfGridPoint(int pointIndex, const BiasGrid& grid, std::vector<i
     }
 }
 
+/*! \brief
+ * Returns the maximum number of neighbors of any point in the grid.
+ *
+ * \param[in] grid  The grid.
+ */
+int64_t maxNumNeighborsOfGridPoint(const BiasGrid& grid)
+{
+    const int c_maxNeighborsAlongAxis =
+            1 + 2 * static_cast<int>(BiasGrid::c_numPointsPerSigma * BiasGrid::c_scopeCutoff);
+
+    int64_t numNeighbors = 1;
+    for (int d = 0; d < grid.numDimensions(); d++)
+    {
+        const int numPoints = grid.axis(d).numPoints();
+        numNeighbors *= grid.axis(d).isFepLambdaAxis()
+                                ? numPoints
+                                : std::min(c_maxNeighborsAlongAxis, numPoints);
+    }
+    return numNeighbors;
+}
+
 } // namespace
 
+const std::vector<int>& BiasGrid::neighbors(int pointIndex) const
+{
+    std::vector<int>& neighbors = neighbors_[pointIndex];
+
+    /* Every point is its own neighbor, so an empty list has not been generated yet */
+    if (neighbors.empty())
+    {
+        setNeighborsOfGridPoint(pointIndex, *this, &neighbors);
+    }
+
+    return neighbors;
+}
+
+const std::vector<int>& BiasGrid::neighborsWithoutStoring(int               pointIndex,
+                                                          std::vector<int>* buffer) const
+{
+    if (!neighbors_[pointIndex].empty())
+    {
+        return neighbors_[pointIndex];
+    }
+
+    buffer->clear();
+    setNeighborsOfGridPoint(pointIndex, *this, buffer);
+
+    return *buffer;
+}
+
 void BiasGrid::initPoints()
 {
     awh_ivec numPointsDimWork = { 0 };
@@ -842,15 +890,16 @@ BiasGrid::BiasGrid(const std::vector<DimParams>& dimParams, const AwhDimParams*
     /* Set their values */
     initPoints();
 
-    /* Keep a neighbor list for each point.
-     * Note: could also generate neighbor list only when needed
-     * instead of storing them for each point.
+    /* Keep a neighbor list for each point. When the total size of the lists
+     * would be large, the lists are only generated when needed.
      */
-    for (size_t m = 0; m < point_.size(); m++)
+    neighbors_.resize(numPoints);
+    if (numPoints * maxNumNeighborsOfGridPoint(*this) <= c_maxNumNeighborsToStoreUpFront)
     {
-        std::vector<int>* neighbor = &point_[m].neighbor;
-
-        setNeighborsOfGridPoint(m, *this, neighbor);
+        for (int m = 0; m < numPoints; m++)
+        {
+            setNeighborsOfGridPoint(m, *this, &neighbors_[m]);
+        }
     }
 }
 
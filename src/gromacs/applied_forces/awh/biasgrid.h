@@ -54,6 +54,8 @@
 #ifndef GMX_AWH_BIASGRID_H
 #define GMX_AWH_BIASGRID_H
 
+#include <cstdint>
+
 #include <memory>
 #include <optional>
 #include <string>
@@ -155,14 +157,12 @@ private:
  * \brief A point in the grid.
  *
  * A grid point has a coordinate value and a coordinate index of the same dimensionality as the
- * grid. It knows the linear indices of its neighboring point (which are useful only when handed up
- * to the grid).
+ * grid. Its neighbors are provided by the grid, see BiasGrid::neighbors().
  */
 struct GridPoint
 {
-    awh_dvec         coordValue; /**< Multidimensional coordinate value of this point */
-    awh_ivec         index;      /**< Multidimensional point indices */
-    std::vector<int> neighbor;   /**< Linear point indices of the neighboring points */
+    awh_dvec coordValue; /**< Multidimensional coordinate value of this point */
+    awh_ivec index;      /**< Multidimensional point indices */
 };
 
 /*! \internal
@@ -191,6 +191,15 @@ public:
     //! Cut-off in sigma for considering points, neglects 4e-8 of the density.
     static constexpr double c_scopeCutoff = 5.5;
 
+    /*! \brief
+     * The maximum total number of neighbor indices to generate for all points at construction.
+     *
+     * With more dimensions the number of neighbors per point grows exponentially.
+     * For grids above this limit, neighbor lists are only generated for points
+     * where they are requested, which are usually only the visited points.
+     */
+    static constexpr int64_t c_maxNumNeighborsToStoreUpFront = 16 * 1024 * 1024;
+
     /*! \brief Construct a grid using AWH input parameters.
      *
      * \param[in] dimParams     Dimension parameters including the expected inverse variance of the
@@ -211,6 +220,28 @@ public:
      */
     const GridPoint& point(size_t pointIndex) const { return point_[pointIndex]; }
 
+    /*! \brief Returns the linear indices of the neighboring points of a point.
+     *
+     * The list is generated on first request for a point and stored.
+     *
+     * \note Not thread safe, since this can modify the neighbor storage.
+     *
+     * \param[in] pointIndex  Index of the point.
+     * \returns a constant reference to the neighbor indices.
+     */
+    const std::vector<int>& neighbors(int pointIndex) const;
+
+    /*! \brief Returns the neighbors of a point without storing them
+     *
+     * Intended for loops over all points, which should not trigger
+     * generating and storing neighbor lists for the whole grid.
+     *
+     * \param[in]     pointIndex  Index of the point.
+     * \param[in,out] buffer      Buffer for neighbor indices not stored by the grid.
+     * \returns the neighbor indices, either the stored list or \p buffer.
+     */
+    const std::vector<int>& neighborsWithoutStoring(int pointIndex, std::vector<int>* buffer) const;
+
     /*! \brief Returns the dimensionality of the grid.
      *
      * \returns the dimensionality of the grid.
@@ -269,6 +300,8 @@ public:
 private:
     std::vector<GridPoint> point_; /**< Points on the grid */
     std::vector<GridAxis>  axis_;  /**< Axes, one for each dimension. */
+    //! Neighbor indices for each point, empty when not generated yet
+    mutable std::vector<std::vector<int>> neighbors_;
 };
 
 /*! \endcond */
@@ -53,12 +53,14 @@
 #include <cstring>
 
 #include <algorithm>
+#include <numeric>
 #include <optional>
 
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/math/utilities.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdrunutility/multisim.h"
 #include "gromacs/mdtypes/awh_history.h"
 #include "gromacs/mdtypes/awh_params.h"
@@ -308,11 +310,12 @@ void BiasState::calcConvolvedPmf(const std::vector<DimParams>& dimParams,
     std::vector<float> pmf(numPoints);
     getPmf(pmf);
 
+    std::vector<int> neighborBuffer;
     for (size_t m = 0; m < numPoints; m++)
     {
         double           freeEnergyWeights = 0;
         const GridPoint& point             = grid.point(m);
-        for (auto& neighbor : point.neighbor)
+        for (auto& neighbor : grid.neighborsWithoutStoring(m, &neighborBuffer))
         {
             /* Do not convolve the bias along a lambda axis - only use the pmf from the current point */
             if (!pointsHaveDifferentLambda(grid, m, neighbor))
@@ -425,14 +428,16 @@ int BiasState::warnForHistogramAnomalies(const BiasGrid& grid, int biasIndex, do
     /* Check all points for warnings */
     int    numWarnings = 0;
     size_t numPoints   = grid.numPoints();
+
+    std::vector<int> neighborBuffer;
     for (size_t m = 0; m < numPoints; m++)
     {
         /* Skip points close to boundary or non-target region */
-        const GridPoint& gridPoint = grid.point(m);
-        bool             skipPoint = false;
-        for (size_t n = 0; (n < gridPoint.neighbor.size()) && !skipPoint; n++)
+        const std::vector<int>& neighbors = grid.neighborsWithoutStoring(m, &neighborBuffer);
+        bool                    skipPoint = false;
+        for (size_t n = 0; (n < neighbors.size()) && !skipPoint; n++)
         {
-            int neighbor = gridPoint.neighbor[n];
+            int neighbor = neighbors[n];
             skipPoint    = !points_[neighbor].inTargetRegion();
             for (int d = 0; (d < grid.numDimensions()) && !skipPoint; d++)
             {
@@ -517,7 +522,7 @@ void BiasState::calcConvolvedForce(const std::vector<DimParams>& dimParams,
     }
 
     /* Only neighboring points have non-negligible contribution. */
-    const std::vector<int>& neighbor          = grid.point(coordState_.gridpointIndex()).neighbor;
+    const std::vector<int>& neighbor          = grid.neighbors(coordState_.gridpointIndex());
     gmx::ArrayRef<double>   forceFromNeighbor = forceWorkBuffer;
     for (size_t n = 0; n < neighbor.size(); n++)
     {
@@ -643,6 +648,32 @@ void BiasState::getSkippedUpdateHistogramScaleFactors(const BiasParams& params,
     }
 }
 
+namespace
+{
+
+/*! \brief The minimum number of points to update for using OpenMP threading
+ *
+ * Local updates only touch a neighborhood of points, which is not worth
+ * the threading overhead, whereas global updates loop over the whole grid.
+ */
+constexpr int c_minNumPointsForThreading = 512;
+
+/*! \brief Returns the number of OpenMP threads to use for updating \p numPoints points
+ *
+ * The point updates are independent of each other, so distributing
+ * them over threads gives results identical to serial execution.
+ */
+int numThreadsForPointUpdates(size_t numPoints)
+{
+    if (numPoints < c_minNumPointsForThreading)
+    {
+        return 1;
+    }
+    return std::max(gmx_omp_nthreads_get(emntDefault), 1);
+}
+
+} // namespace
+
 void BiasState::doSkippedUpdatesForAllPoints(const BiasParams& params)
 {
     double weightHistScaling;
@@ -650,16 +681,26 @@ void BiasState::doSkippedUpdatesForAllPoints(const BiasParams& params)
 
     getSkippedUpdateHistogramScaleFactors(params, &weightHistScaling, &logPmfsumScaling);
 
-    for (auto& pointState : points_)
+    const int numPoints  = points_.size();
+    const int numThreads = numThreadsForPointUpdates(numPoints);
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+    for (int m = 0; m < numPoints; m++)
     {
-        bool didUpdate = pointState.performPreviouslySkippedUpdates(
-                params, histogramSize_.numUpdates(), weightHistScaling, logPmfsumScaling);
-
-        /* Update the bias for this point only if there were skipped updates in the past to avoid calculating the log unneccessarily */
-        if (didUpdate)
+        try
         {
-            pointState.updateBias();
+            PointState& pointState = points_[m];
+
+            bool didUpdate = pointState.performPreviouslySkippedUpdates(
+                    params, histogramSize_.numUpdates(), weightHistScaling, logPmfsumScaling);
+
+            /* Update the bias for this point only if there were skipped updates in the past
+             * to avoid calculating the log unneccessarily */
+            if (didUpdate)
+            {
+                pointState.updateBias();
+            }
         }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 }
 
@@ -671,7 +712,7 @@ void BiasState::doSkippedUpdatesInNeighborhood(const BiasParams& params, const B
     getSkippedUpdateHistogramScaleFactors(params, &weightHistScaling, &logPmfsumScaling);
 
     /* For each neighbor point of the center point, refresh its state by adding the results of all past, skipped updates. */
-    const std::vector<int>& neighbors = grid.point(coordState_.gridpointIndex()).neighbor;
+    const std::vector<int>& neighbors = grid.neighbors(coordState_.gridpointIndex());
     for (auto& neighbor : neighbors)
     {
         bool didUpdate = points_[neighbor].performPreviouslySkippedUpdates(
@@ -687,9 +728,19 @@ void BiasState::doSkippedUpdatesInNeighborhood(const BiasParams& params, const B
 namespace
 {
 
+/*! \brief The minimum number of grid points for merging update lists by exchanging indices
+ *
+ * For small grids, summing flags for all points in a single reduction is cheapest.
+ */
+constexpr int c_minNumPointsForSparseUpdateListMerge = 4096;
+
 /*! \brief
  * Merge update lists from multiple sharing simulations.
  *
+ * For large grids, only the point indices in the update lists are exchanged,
+ * instead of flags for all points, as long as the lists are short enough.
+ * Both ways give the same, sorted, merged list.
+ *
  * \param[in,out] updateList    Update list for this simulation (assumed >= npoints long).
  * \param[in]     numPoints     Total number of points.
  * \param[in]     commRecord    Struct for intra-simulation communication.
@@ -700,6 +751,32 @@ void mergeSharedUpdateLists(std::vector<int>*     updateList,
                             const t_commrec*      commRecord,
                             const gmx_multisim_t* multiSimComm)
 {
+    if (numPoints >= c_minNumPointsForSparseUpdateListMerge)
+    {
+        /* Exchange the list sizes, so all simulations take the same path below */
+        std::vector<int> listSizes(multiSimComm->numSimulations_, 0);
+        listSizes[multiSimComm->simulationIndex_] = updateList->size();
+        sumOverSimulations(gmx::ArrayRef<int>(listSizes), commRecord, multiSimComm);
+
+        const int totalListSize = std::accumulate(listSizes.begin(), listSizes.end(), 0);
+        if (totalListSize < numPoints)
+        {
+            /* Gather all lists by summing, each simulation fills only its own segment */
+            std::vector<int> pointIndices(totalListSize, 0);
+            const int        offset = std::accumulate(
+                    listSizes.begin(), listSizes.begin() + multiSimComm->simulationIndex_, 0);
+            std::copy(updateList->begin(), updateList->end(), pointIndices.begin() + offset);
+
+            sumOverSimulations(gmx::ArrayRef<int>(pointIndices), commRecord, multiSimComm);
+
+            std::sort(pointIndices.begin(), pointIndices.end());
+            updateList->assign(pointIndices.begin(),
+                               std::unique(pointIndices.begin(), pointIndices.end()));
+
+            return;
+        }
+    }
+
     std::vector<int> numUpdatesOfPoint;
 
     /* Flag the update points of this sim.
@@ -815,30 +892,28 @@ void sumHistograms(gmx::ArrayRef<PointState> pointState,
         GMX_ASSERT(numSharedUpdate == multiSimComm->numSimulations_,
                    "Sharing within a simulation is not implemented (yet)");
 
-        /* Collect the weights and counts in linear arrays to be able to use gmx_sumd_sim. */
-        std::vector<double> weightSum;
-        std::vector<double> coordVisits;
+        /* Collect the weights and counts in one linear array to be able to use
+           a single gmx_sumd_sim call. */
+        const size_t        numLocalPoints = localUpdateList.size();
+        std::vector<double> weightSumAndCoordVisits(2 * numLocalPoints);
 
-        weightSum.resize(localUpdateList.size());
-        coordVisits.resize(localUpdateList.size());
-
-        for (size_t localIndex = 0; localIndex < localUpdateList.size(); localIndex++)
+        for (size_t localIndex = 0; localIndex < numLocalPoints; localIndex++)
         {
             const PointState& ps = pointState[localUpdateList[localIndex]];
 
-            weightSum[localIndex]   = ps.weightSumIteration();
-            coordVisits[localIndex] = ps.numVisitsIteration();
+            weightSumAndCoordVisits[localIndex]                  = ps.weightSumIteration();
+            weightSumAndCoordVisits[numLocalPoints + localIndex] = ps.numVisitsIteration();
         }
 
-        sumOverSimulations(gmx::ArrayRef<double>(weightSum), commRecord, multiSimComm);
-        sumOverSimulations(gmx::ArrayRef<double>(coordVisits), commRecord, multiSimComm);
+        sumOverSimulations(gmx::ArrayRef<double>(weightSumAndCoordVisits), commRecord, multiSimComm);
 
         /* Transfer back the result */
-        for (size_t localIndex = 0; localIndex < localUpdateList.size(); localIndex++)
+        for (size_t localIndex = 0; localIndex < numLocalPoints; localIndex++)
         {
             PointState& ps = pointState[localUpdateList[localIndex]];
 
-            ps.setPartialWeightAndCount(weightSum[localIndex], coordVisits[localIndex]);
+            ps.setPartialWeightAndCount(weightSumAndCoordVisits[localIndex],
+                                        weightSumAndCoordVisits[numLocalPoints + localIndex]);
         }
     }
 
@@ -1201,22 +1276,32 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
     setHistogramUpdateScaleFactors(params, newHistogramSize, histogramSize_.histogramSize(),
                                    &weightHistScalingNew, &logPmfsumScalingNew);
 
-    /* Update free energy and reference weight histogram for points in the update list. */
-    for (int pointIndex : *updateList)
+    /* Update free energy and reference weight histogram for points in the update list.
+     * The points in the list are unique and their updates are independent.
+     */
+    const int numPointsToUpdate = updateList->size();
+    const int numThreads        = numThreadsForPointUpdates(numPointsToUpdate);
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+    for (int i = 0; i < numPointsToUpdate; i++)
     {
-        PointState* pointStateToUpdate = &points_[pointIndex];
-
-        /* Do updates from previous update steps that were skipped because this point was at that time non-local. */
-        if (params.skipUpdates())
+        try
         {
-            pointStateToUpdate->performPreviouslySkippedUpdates(params, histogramSize_.numUpdates(),
-                                                                weightHistScalingSkipped,
-                                                                logPmfsumScalingSkipped);
-        }
+            PointState* pointStateToUpdate = &points_[(*updateList)[i]];
+
+            /* Do updates from previous update steps that were skipped because this point
+             * was at that time non-local. */
+            if (params.skipUpdates())
+            {
+                pointStateToUpdate->performPreviouslySkippedUpdates(
+                        params, histogramSize_.numUpdates(), weightHistScalingSkipped,
+                        logPmfsumScalingSkipped);
+            }
 
-        /* Now do an update with new sampling data. */
-        pointStateToUpdate->updateWithNewSampling(params, histogramSize_.numUpdates(),
-                                                  weightHistScalingNew, logPmfsumScalingNew);
+            /* Now do an update with new sampling data. */
+            pointStateToUpdate->updateWithNewSampling(params, histogramSize_.numUpdates(),
+                                                      weightHistScalingNew, logPmfsumScalingNew);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 
     /* Only update the histogram size after we are done with the local point updates */
@@ -1235,9 +1320,10 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
 
     /* Update the bias. The bias is updated separately and last since it simply a function of
        the free energy and the target distribution and we want to avoid doing extra work. */
-    for (int pointIndex : *updateList)
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+    for (int i = 0; i < numPointsToUpdate; i++)
     {
-        points_[pointIndex].updateBias();
+        points_[(*updateList)[i]].updateBias();
     }
 
     /* Increase the update counter. */
@@ -1250,7 +1336,7 @@ double BiasState::updateProbabilityWeightsAndConvolvedBias(const std::vector<Dim
                                                            std::vector<double, AlignedAllocator<double>>* weight) const
 {
     /* Only neighbors of the current coordinate value will have a non-negligible chance of getting sampled */
-    const std::vector<int>& neighbors = grid.point(coordState_.gridpointIndex()).neighbor;
+    const std::vector<int>& neighbors = grid.neighbors(coordState_.gridpointIndex());
 
 #if GMX_SIMD_HAVE_DOUBLE
     typedef SimdDouble PackType;
@@ -1331,12 +1417,14 @@ double BiasState::calcConvolvedBias(const std::vector<DimParams>& dimParams,
                                     const BiasGrid&               grid,
                                     const awh_dvec&               coordValue) const
 {
-    int              point     = grid.nearestIndex(coordValue);
-    const GridPoint& gridPoint = grid.point(point);
+    int point = grid.nearestIndex(coordValue);
+
+    /* This is also used for output over the whole grid, so we should not store neighbors */
+    std::vector<int> neighborBuffer;
 
     /* Sum the probability weights from the neighborhood of the given point */
     double weightSum = 0;
-    for (int neighbor : gridPoint.neighbor)
+    for (int neighbor : grid.neighborsWithoutStoring(point, &neighborBuffer))
     {
         /* No convolution is required along the lambda dimension. */
         if (pointsHaveDifferentLambda(grid, point, neighbor))
@@ -1354,7 +1442,7 @@ double BiasState::calcConvolvedBias(const std::vector<DimParams>& dimParams,
 
 void BiasState::sampleProbabilityWeights(const BiasGrid& grid, gmx::ArrayRef<const double> probWeightNeighbor)
 {
-    const std::vector<int>& neighbor = grid.point(coordState_.gridpointIndex()).neighbor;
+    const std::vector<int>& neighbor = grid.neighbors(coordState_.gridpointIndex());
 
     /* Save weights for next update */
     for (size_t n = 0; n < neighbor.size(); n++)
@@ -1430,7 +1518,7 @@ void BiasState::sampleCoordAndPmf(const std::vector<DimParams>& dimParams,
     /* Update the PMF of points along a lambda axis with their bias. */
     if (lambdaAxisIndex)
     {
-        const std::vector<int>& neighbors = grid.point(gridPointIndex).neighbor;
+        const std::vector<int>& neighbors = grid.neighbors(gridPointIndex);
 
         std::vector<double> lambdaMarginalDistribution =
                 calculateFELambdaMarginalDistribution(grid, neighbors, probWeightNeighbor);
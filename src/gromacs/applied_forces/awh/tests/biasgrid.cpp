@@ -115,7 +115,7 @@ TEST(biasGridTest, neighborhood)
     /* Checking for all points is overkill, we check every 7th */
     for (size_t i = 0; i < grid.numPoints(); i += 7)
     {
-        const GridPoint& point = grid.point(i);
+        const std::vector<int>& neighbors = grid.neighbors(i);
 
         /* NOTE: This code relies on major-minor index ordering in Grid */
         int pointIndex0 = i / numPointsDim[1];
@@ -128,12 +128,12 @@ TEST(biasGridTest, neighborhood)
         int    distanceFromEdge1 = std::min(pointIndex1, numPointsDim[1] - 1 - pointIndex1);
         size_t numNeighbors      = (2 * scopeInPoints + 1)
                               * (scopeInPoints + std::min(scopeInPoints, distanceFromEdge1) + 1);
-        if (point.neighbor.size() != numNeighbors)
+        if (neighbors.size() != numNeighbors)
         {
             haveCorrectNumNeighbors = false;
         }
 
-        for (auto& j : point.neighbor)
+        for (auto& j : neighbors)
         {
             if (j >= 0 && j < numPoints)
             {
@@ -171,7 +171,7 @@ TEST(biasGridTest, neighborhood)
         }
 
         /* Clear the marked points in the checking grid */
-        for (auto& neighbor : point.neighbor)
+        for (auto& neighbor : neighbors)
         {
             if (neighbor >= 0 && neighbor < numPoints)
             {
@@ -186,5 +186,43 @@ TEST(biasGridTest, neighborhood)
     EXPECT_TRUE(haveCorrectNumNeighbors);
 }
 
+TEST(biasGridTest, neighborsAreGeneratedOnRequestForLargeGrids)
+{
+    const int scopeInPoints =
+            static_cast<int>(BiasGrid::c_scopeCutoff * BiasGrid::c_numPointsPerSigma);
+
+    /* A 4-dimensional grid with about 15 points along each dimension
+     * has too many neighbors in total to generate them all up front.
+     */
+    const int                 numDim = 4;
+    std::vector<AwhDimParams> awhDimParams(numDim);
+    std::vector<DimParams>    dimParams;
+    const real                beta = 3.0;
+    for (int d = 0; d < numDim; d++)
+    {
+        awhDimParams[d].origin = 0.5;
+        awhDimParams[d].end    = 2.0;
+        awhDimParams[d].period = 0;
+        dimParams.push_back(DimParams::pullDimParams(1, 1 / (beta * 0.1 * 0.1), beta));
+    }
+
+    BiasGrid grid(dimParams, awhDimParams.data());
+
+    /* Take a point in the middle of the grid, so it has all neighbors within scope */
+    awh_dvec  centerValue = { 1.25, 1.25, 1.25, 1.25 };
+    const int pointIndex  = grid.nearestIndex(centerValue);
+
+    std::vector<int>        buffer;
+    const std::vector<int>& unstoredNeighbors = grid.neighborsWithoutStoring(pointIndex, &buffer);
+    EXPECT_EQ(&unstoredNeighbors, &buffer);
+
+    const std::vector<int>& neighbors = grid.neighbors(pointIndex);
+    EXPECT_THAT(neighbors, testing::ContainerEq(buffer));
+    EXPECT_EQ(neighbors.size(), static_cast<size_t>(std::pow(2 * scopeInPoints + 1, numDim)));
+
+    /* Now the stored list should be returned */
+    EXPECT_EQ(&grid.neighborsWithoutStoring(pointIndex, &buffer), &neighbors);
+}
+
 } // namespace test
 } // namespace gmx
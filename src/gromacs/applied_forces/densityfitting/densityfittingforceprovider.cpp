@@ -53,10 +53,13 @@
 #include "gromacs/math/densityfittingforce.h"
 #include "gromacs/math/gausstransform.h"
 #include "gromacs/mdlib/broadcaststructs.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/enerdata.h"
 #include "gromacs/mdtypes/forceoutput.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/strconvert.h"
 
 #include "densityfittingamplitudelookup.h"
@@ -169,7 +172,8 @@ private:
     GaussianSpreadKernelParameters::Shape spreadKernel_;
     GaussTransform3D                      gaussTransform_;
     DensitySimilarityMeasure              measure_;
-    DensityFittingForce                   densityFittingForce_;
+    //! The force evaluators, one for each thread, since they hold work buffers
+    std::vector<DensityFittingForce> densityFittingForces_;
     //! the local atom coordinates transformed into the grid coordinate system
     std::vector<RVec>             transformedCoordinates_;
     std::vector<RVec>             forces_;
@@ -202,7 +206,7 @@ DensityFittingForceProvider::Impl::Impl(const DensityFittingParameters&
                                    transformationToDensityLattice.scaleOperationOnly())),
     gaussTransform_(referenceDensity.extents(), spreadKernel_),
     measure_(parameters.similarityMeasureMethod_, referenceDensity),
-    densityFittingForce_(spreadKernel_),
+    densityFittingForces_(1, DensityFittingForce(spreadKernel_)),
     transformedCoordinates_(localAtomSet_.numAtomsLocal()),
     amplitudeLookup_(parameters_.amplitudeLookupMethod_),
     transformationToDensityLattice_(transformationToDensityLattice),
@@ -310,13 +314,9 @@ void DensityFittingForceProvider::Impl::calculateForces(const ForceProviderInput
         }
     }
 
-    auto amplitudeIterator = amplitudes.cbegin();
+    const int numThreads = std::max(gmx_omp_nthreads_get(emntDefault), 1);
 
-    for (const auto& r : transformedCoordinates_)
-    {
-        gaussTransform_.add({ r, *amplitudeIterator });
-        ++amplitudeIterator;
-    }
+    gaussTransform_.add(transformedCoordinates_, amplitudes, numThreads);
 
     // communicate grid
     if (havePPDomainDecomposition(&forceProviderInput.cr_))
@@ -331,11 +331,21 @@ void DensityFittingForceProvider::Impl::calculateForces(const ForceProviderInput
             measure_.gradient(gaussTransform_.constView());
     // calculate forces
     forces_.resize(localAtomSet_.numAtomsLocal());
-    std::transform(
-            std::begin(transformedCoordinates_), std::end(transformedCoordinates_), std::begin(amplitudes),
-            std::begin(forces_), [&densityDerivative, this](const RVec r, real amplitude) {
-                return densityFittingForce_.evaluateForce({ r, amplitude }, densityDerivative);
-            });
+    while (ssize(densityFittingForces_) < numThreads)
+    {
+        densityFittingForces_.push_back(densityFittingForces_[0]);
+    }
+    const int numAtoms = transformedCoordinates_.size();
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+    for (int i = 0; i < numAtoms; i++)
+    {
+        try
+        {
+            forces_[i] = densityFittingForces_[gmx_omp_get_thread_num()].evaluateForce(
+                    { transformedCoordinates_[i], amplitudes[i] }, densityDerivative);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
 
     transformationToDensityLattice_.scaleOperationOnly().inverseIgnoringZeroScale(forces_);
 
@@ -44,14 +44,24 @@
 
 #include "cmdlineinit.h"
 
+#include "config.h"
+
+#include <cstdlib>
 #include <cstring>
 
 #include <memory>
+#include <string>
 #include <utility>
 
+#ifdef HAVE_UNISTD_H
+#    include <unistd.h>
+#endif
+
 #include "gromacs/commandline/cmdlinemodulemanager.h"
 #include "gromacs/commandline/cmdlineoptionsmodule.h"
 #include "gromacs/commandline/cmdlineprogramcontext.h"
+#include "gromacs/hardware/cpuinfo.h"
+#include "gromacs/simd/support.h"
 #include "gromacs/utility/basenetwork.h"
 #include "gromacs/utility/datafilefinder.h"
 #include "gromacs/utility/exceptions.h"
@@ -112,12 +122,58 @@ void broadcastArguments(int* argc, char*** argv)
     }
 }
 
+/*! \brief
+ * Replaces the process with a build for the SIMD type that fits this CPU best.
+ *
+ * Installations for heterogeneous clusters can install builds for several
+ * SIMD types side by side, each named after this binary with an underscore
+ * and the SIMD type appended (e.g., gmx_AVX_512 and gmx_AVX2_256 next to
+ * gmx). If the SIMD type suggested for this CPU differs from the one this
+ * binary was compiled with and such a build exists, it is executed with the
+ * same arguments. This is done before initializing MPI, so each rank picks
+ * the build for its own node. Setting GMX_NO_SIMD_DISPATCH disables this.
+ */
+void execSimdSpecificBinary(int argc, char* argv[])
+{
+#ifdef HAVE_UNISTD_H
+    if (std::getenv("GMX_NO_SIMD_DISPATCH") != nullptr)
+    {
+        return;
+    }
+    const SimdType suggested = simdSuggested(CpuInfo::detect());
+    if (suggested == simdCompiled() || suggested == SimdType::None)
+    {
+        return;
+    }
+    std::string simdBinaryPath;
+    try
+    {
+        CommandLineProgramContext context(argc, argv);
+        simdBinaryPath = std::string(context.fullBinaryPath()) + "_" + simdString(suggested);
+    }
+    catch (const std::exception&)
+    {
+        // Without a binary path, simply continue with this binary
+        return;
+    }
+    if (access(simdBinaryPath.c_str(), X_OK) == 0)
+    {
+        // Only returns on failure, in which case this binary is used
+        execv(simdBinaryPath.c_str(), argv);
+    }
+#else
+    GMX_UNUSED_VALUE(argc);
+    GMX_UNUSED_VALUE(argv);
+#endif
+}
+
 //! \}
 
 } // namespace
 
 CommandLineProgramContext& initForCommandLine(int* argc, char*** argv)
 {
+    execSimdSpecificBinary(*argc, *argv);
     gmx::init(argc, argv);
     GMX_RELEASE_ASSERT(!g_commandLineContext, "initForCommandLine() calls cannot be nested");
     // TODO: Consider whether the argument broadcast would better be done
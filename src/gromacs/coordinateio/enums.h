@@ -127,6 +127,13 @@ enum class CoordinateFileFlags : unsigned long
      * output file or generate an error.
      */
     RequireCoordinateSelection = 1 << 9,
+    /*! \brief
+     * Streams the frames to other processes.
+     *
+     * Does not need any abilities from the output method, but is ordered
+     * last so that the frames are streamed after all other modifications.
+     */
+    RequireFrameStreaming = 1 << 10,
     //! Needed for enumeration array.
     Count
 };
@@ -51,5 +51,6 @@
 #include "gromacs/coordinateio/outputadapters/setstarttime.h"
 #include "gromacs/coordinateio/outputadapters/settimestep.h"
 #include "gromacs/coordinateio/outputadapters/setvelocities.h"
+#include "gromacs/coordinateio/outputadapters/streamframes.h"
 
 #endif
@@ -0,0 +1,379 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*!\internal
+ * \file
+ * \brief
+ * Implements gmx::StreamFrames and gmx::FrameStreamReader.
+ *
+ * The ring buffer starts with a StreamHeader, followed by the slots. Each
+ * slot has a SlotHeader with a sequence number that works as a sequence
+ * lock: it is odd while the writer fills the slot, and 2*(n+1) once frame
+ * n is complete. Readers copy the frame and check that the sequence number
+ * did not change, so the writer never has to wait for them.
+ *
+ * \ingroup module_coordinateio
+ */
+
+#include "gmxpre.h"
+
+#include "streamframes.h"
+
+#include "config.h"
+
+#include <atomic>
+#include <new>
+
+#if HAVE_MMAP
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "gromacs/math/vec.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/stringutil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Identifies a frame stream file
+constexpr int32_t c_streamMagic = 0x46525354;
+//! Version of the ring buffer layout
+constexpr int32_t c_streamVersion = 1;
+//! Alignment of the slots, avoids sharing cache lines between slots
+constexpr size_t c_slotAlignment = 64;
+
+static_assert(std::atomic<int64_t>::is_always_lock_free,
+              "Ring buffer synchronization between processes needs lock-free atomics");
+
+//! Header at the start of the ring buffer
+struct StreamHeader
+{
+    //! Set to c_streamMagic once the header is complete
+    std::atomic<int32_t> magic;
+    //! Layout version
+    int32_t version;
+    //! Number of atoms per frame
+    int32_t numAtoms;
+    //! Number of slots in the ring buffer
+    int32_t numSlots;
+    //! Size of a slot in bytes
+    int64_t slotSize;
+    //! Number of completely written frames
+    std::atomic<int64_t> numFramesWritten;
+    //! Non-zero when the writer has finished
+    std::atomic<int32_t> isFinished;
+};
+
+//! Header of each slot, followed by the positions as floats
+struct SlotHeader
+{
+    //! Sequence lock, see the file documentation
+    std::atomic<int64_t> sequence;
+    //! Simulation step
+    int64_t step;
+    //! Time
+    double time;
+    //! Box
+    float box[DIM * DIM];
+};
+
+//! Rounds \p size up to the slot alignment
+size_t alignedSize(size_t size)
+{
+    return (size + c_slotAlignment - 1) / c_slotAlignment * c_slotAlignment;
+}
+
+//! Returns the size of a slot for \p numAtoms atoms
+size_t slotSize(int numAtoms)
+{
+    return alignedSize(sizeof(SlotHeader) + DIM * sizeof(float) * numAtoms);
+}
+
+//! Returns the header of the ring buffer
+StreamHeader* streamHeader(void* mapping)
+{
+    return static_cast<StreamHeader*>(mapping);
+}
+
+//! Returns the header of slot \p slot
+SlotHeader* slotHeader(void* mapping, int64_t slot)
+{
+    const StreamHeader* header = streamHeader(mapping);
+    return reinterpret_cast<SlotHeader*>(static_cast<char*>(mapping) + alignedSize(sizeof(StreamHeader))
+                                         + slot * header->slotSize);
+}
+
+//! Returns the positions stored in slot \p slot
+float* slotPositions(void* mapping, int64_t slot)
+{
+    return reinterpret_cast<float*>(slotHeader(mapping, slot) + 1);
+}
+
+} // namespace
+
+StreamFrames::StreamFrames(const std::string& fileName, int numSlots) :
+    fileName_(fileName), numSlots_(numSlots)
+{
+    GMX_RELEASE_ASSERT(numSlots > 0, "Need at least one slot for streaming frames");
+#if !HAVE_MMAP
+    GMX_THROW(NotImplementedError("Streaming frames needs support for memory mapped files"));
+#endif
+}
+
+StreamFrames::StreamFrames(StreamFrames&& old) noexcept :
+    fileName_(std::move(old.fileName_)),
+    numSlots_(old.numSlots_),
+    mapping_(old.mapping_),
+    mappingSize_(old.mappingSize_)
+{
+    old.mapping_ = nullptr;
+}
+
+StreamFrames::~StreamFrames()
+{
+#if HAVE_MMAP
+    if (mapping_ != nullptr)
+    {
+        streamHeader(mapping_)->isFinished.store(1, std::memory_order_release);
+        munmap(mapping_, mappingSize_);
+    }
+#endif
+}
+
+void StreamFrames::createMapping(int numAtoms)
+{
+#if HAVE_MMAP
+    mappingSize_ = alignedSize(sizeof(StreamHeader)) + numSlots_ * slotSize(numAtoms);
+
+    /* Replace instead of truncating the file, so readers that are still
+     * attached to an earlier stream keep a valid mapping */
+    unlink(fileName_.c_str());
+    int fd = open(fileName_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+    {
+        GMX_THROW(FileIOError("Could not create frame stream file " + fileName_));
+    }
+    if (ftruncate(fd, mappingSize_) != 0)
+    {
+        close(fd);
+        GMX_THROW(FileIOError("Could not resize frame stream file " + fileName_));
+    }
+    void* mapping = mmap(nullptr, mappingSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        GMX_THROW(FileIOError("Could not map frame stream file " + fileName_));
+    }
+    mapping_ = mapping;
+
+    /* The file is zero filled, so only the header and slot sequences need setting */
+    StreamHeader* header = new (mapping_) StreamHeader;
+    header->version      = c_streamVersion;
+    header->numAtoms     = numAtoms;
+    header->numSlots     = numSlots_;
+    header->slotSize     = slotSize(numAtoms);
+    header->numFramesWritten.store(0, std::memory_order_relaxed);
+    header->isFinished.store(0, std::memory_order_relaxed);
+    for (int slot = 0; slot < numSlots_; slot++)
+    {
+        new (slotHeader(mapping_, slot)) SlotHeader;
+        slotHeader(mapping_, slot)->sequence.store(0, std::memory_order_relaxed);
+    }
+    header->magic.store(c_streamMagic, std::memory_order_release);
+#else
+    GMX_UNUSED_VALUE(numAtoms);
+#endif
+}
+
+void StreamFrames::processFrame(const int /*framenumber*/, t_trxframe* input)
+{
+    if (!input->bX || input->x == nullptr)
+    {
+        GMX_THROW(InconsistentInputError("Frame streaming requested but current frame has no coordinates"));
+    }
+    if (mapping_ == nullptr)
+    {
+        createMapping(input->natoms);
+    }
+    StreamHeader* header = streamHeader(mapping_);
+    if (input->natoms != header->numAtoms)
+    {
+        GMX_THROW(InconsistentInputError(
+                formatString("Can not stream frame with %d atoms to a stream of frames with %d atoms",
+                             input->natoms, header->numAtoms)));
+    }
+
+    const int64_t frameIndex = header->numFramesWritten.load(std::memory_order_relaxed);
+    const int64_t slot       = frameIndex % numSlots_;
+    SlotHeader*   slotData   = slotHeader(mapping_, slot);
+
+    slotData->sequence.store(2 * frameIndex + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slotData->step = input->bStep ? input->step : frameIndex;
+    slotData->time = input->bTime ? input->time : 0;
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            slotData->box[d * DIM + e] = input->bBox ? input->box[d][e] : 0;
+        }
+    }
+    float* x = slotPositions(mapping_, slot);
+    for (int i = 0; i < input->natoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            x[i * DIM + d] = input->x[i][d];
+        }
+    }
+
+    slotData->sequence.store(2 * frameIndex + 2, std::memory_order_release);
+    header->numFramesWritten.store(frameIndex + 1, std::memory_order_release);
+}
+
+FrameStreamReader::FrameStreamReader(const std::string& fileName)
+{
+#if HAVE_MMAP
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        GMX_THROW(FileIOError("Could not open frame stream file " + fileName));
+    }
+    struct stat fileStatus;
+    void*       mapping = MAP_FAILED;
+    if (fstat(fd, &fileStatus) == 0
+        && static_cast<size_t>(fileStatus.st_size) >= alignedSize(sizeof(StreamHeader)))
+    {
+        mappingSize_ = fileStatus.st_size;
+        mapping      = mmap(nullptr, mappingSize_, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        GMX_THROW(FileIOError("Could not map frame stream file " + fileName));
+    }
+    mapping_                   = mapping;
+    const StreamHeader* header = streamHeader(mapping_);
+    if (header->magic.load(std::memory_order_acquire) != c_streamMagic
+        || header->version != c_streamVersion
+        || mappingSize_ < alignedSize(sizeof(StreamHeader)) + header->numSlots * header->slotSize)
+    {
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        GMX_THROW(FileIOError("File " + fileName + " is not a complete frame stream"));
+    }
+#else
+    GMX_UNUSED_VALUE(fileName);
+    GMX_THROW(NotImplementedError("Streaming frames needs support for memory mapped files"));
+#endif
+}
+
+FrameStreamReader::~FrameStreamReader()
+{
+#if HAVE_MMAP
+    if (mapping_ != nullptr)
+    {
+        munmap(mapping_, mappingSize_);
+    }
+#endif
+}
+
+int FrameStreamReader::numAtoms() const
+{
+    return streamHeader(mapping_)->numAtoms;
+}
+
+int FrameStreamReader::numSlots() const
+{
+    return streamHeader(mapping_)->numSlots;
+}
+
+int64_t FrameStreamReader::numFramesWritten() const
+{
+    return streamHeader(mapping_)->numFramesWritten.load(std::memory_order_acquire);
+}
+
+bool FrameStreamReader::isFinished() const
+{
+    return streamHeader(mapping_)->isFinished.load(std::memory_order_acquire) != 0;
+}
+
+bool FrameStreamReader::readFrame(int64_t frameIndex, StreamedFrame* frame) const
+{
+    if (frameIndex < 0)
+    {
+        return false;
+    }
+    const StreamHeader* header   = streamHeader(mapping_);
+    const int64_t       slot     = frameIndex % header->numSlots;
+    const SlotHeader*   slotData = slotHeader(mapping_, slot);
+
+    const int64_t sequence = slotData->sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * frameIndex + 2)
+    {
+        return false;
+    }
+
+    frame->step = slotData->step;
+    frame->time = slotData->time;
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            frame->box[d][e] = slotData->box[d * DIM + e];
+        }
+    }
+    frame->x.resize(header->numAtoms);
+    const float* x = slotPositions(mapping_, slot);
+    for (int i = 0; i < header->numAtoms; i++)
+    {
+        frame->x[i] = { x[i * DIM + XX], x[i * DIM + YY], x[i * DIM + ZZ] };
+    }
+
+    /* The writer may have started overwriting the slot while we copied */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slotData->sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+} // namespace gmx
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \file
+ * \brief
+ * Declares gmx::StreamFrames and gmx::FrameStreamReader.
+ *
+ * \inpublicapi
+ * \ingroup module_coordinateio
+ */
+#ifndef GMX_COORDINATEIO_STREAMFRAMES_H
+#define GMX_COORDINATEIO_STREAMFRAMES_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gromacs/coordinateio/ioutputadapter.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*!\brief
+ * StreamFrames class publishes coordinate frames to other processes.
+ *
+ * Each processed frame is copied into a ring buffer in a shared memory
+ * mapped file, e.g. in /dev/shm, from which analysis processes on the same
+ * node can read it with FrameStreamReader while the writer continues.
+ * The writer never waits for readers: when a reader falls behind by more
+ * than the number of slots in the ring buffer, the oldest frames are lost
+ * for that reader. Only positions, box, step and time are streamed.
+ *
+ * The ring buffer is created when the first frame is processed, and all
+ * later frames need to have the same number of atoms. The file is left
+ * in place at destruction, readers can detect the end of the stream with
+ * FrameStreamReader::isFinished().
+ *
+ * Needs support for memory mapped files, constructing the object throws
+ * NotImplementedError without it.
+ *
+ * \inpublicapi
+ * \ingroup module_coordinateio
+ *
+ */
+class StreamFrames : public IOutputAdapter
+{
+public:
+    /*! \brief
+     * Construct StreamFrames object that streams to file \p fileName.
+     *
+     * \param[in] fileName Name of the file to map, replaced when it exists.
+     * \param[in] numSlots Number of frames kept in the ring buffer.
+     * \throws NotImplementedError When memory mapping is not supported.
+     */
+    explicit StreamFrames(const std::string& fileName, int numSlots = c_defaultNumSlots);
+    /*! \brief
+     *  Move constructor for StreamFrames.
+     */
+    StreamFrames(StreamFrames&& old) noexcept;
+
+    ~StreamFrames() override;
+
+    /*! \brief
+     * Publish the coordinate frame to the ring buffer.
+     *
+     * The frame itself is not modified.
+     *
+     * \param[in] input Coordinate frame to be streamed.
+     * \throws InconsistentInputError When the frame has no coordinates or
+     *                                the number of atoms changed.
+     * \throws FileIOError When the ring buffer can not be created.
+     */
+    void processFrame(int /*framenumber*/, t_trxframe* input) override;
+
+    void checkAbilityDependencies(unsigned long /* abilities */) const override {}
+
+    //! Default number of frames in the ring buffer.
+    static constexpr int c_defaultNumSlots = 16;
+
+private:
+    //! Creates the ring buffer for frames with \p numAtoms atoms.
+    void createMapping(int numAtoms);
+
+    //! Name of the shared memory file.
+    std::string fileName_;
+    //! Number of frames kept in the ring buffer.
+    int numSlots_;
+    //! Start of the mapped ring buffer, nullptr before the first frame.
+    void* mapping_ = nullptr;
+    //! Size of the mapping in bytes.
+    size_t mappingSize_ = 0;
+};
+
+//! Smart pointer to manage the object.
+using StreamFramesPointer = std::unique_ptr<StreamFrames>;
+
+/*!\brief
+ * A frame read from a ring buffer written by StreamFrames.
+ *
+ * \inpublicapi
+ * \ingroup module_coordinateio
+ */
+struct StreamedFrame
+{
+    //! Simulation step of the frame.
+    int64_t step = 0;
+    //! Time of the frame.
+    double time = 0;
+    //! Simulation box.
+    matrix box = { { 0 } };
+    //! Positions of all streamed atoms.
+    std::vector<RVec> x;
+};
+
+/*!\brief
+ * Reads frames from a ring buffer written by StreamFrames.
+ *
+ * Frames are identified by their index in the stream, counting from zero.
+ * A frame can be read as long as it has not been overwritten, so a reader
+ * that wants every frame needs to keep up with the writer.
+ *
+ * \inpublicapi
+ * \ingroup module_coordinateio
+ */
+class FrameStreamReader
+{
+public:
+    /*! \brief
+     * Attach to the ring buffer in \p fileName.
+     *
+     * \throws FileIOError When the file can not be mapped or is not a
+     *                     frame stream.
+     * \throws NotImplementedError When memory mapping is not supported.
+     */
+    explicit FrameStreamReader(const std::string& fileName);
+    ~FrameStreamReader();
+
+    //! Number of atoms in each frame.
+    int numAtoms() const;
+    //! Number of frames kept in the ring buffer.
+    int numSlots() const;
+    //! Number of frames written to the stream so far.
+    int64_t numFramesWritten() const;
+    //! Whether the writer has finished the stream.
+    bool isFinished() const;
+
+    /*! \brief
+     * Read frame number \p frameIndex into \p frame.
+     *
+     * \returns false when the frame has not been written yet or was
+     *          already overwritten, \p frame is then in an undefined state.
+     */
+    bool readFrame(int64_t frameIndex, StreamedFrame* frame) const;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(FrameStreamReader);
+
+private:
+    //! Start of the mapped ring buffer.
+    void* mapping_ = nullptr;
+    //! Size of the mapping in bytes.
+    size_t mappingSize_ = 0;
+};
+
+} // namespace gmx
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*!\internal
+ * \file
+ * \brief
+ * Tests for gmx::StreamFrames and gmx::FrameStreamReader.
+ *
+ * \ingroup module_coordinateio
+ */
+
+#include "gmxpre.h"
+
+#include "gromacs/coordinateio/outputadapters/streamframes.h"
+
+#include "config.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/exceptions.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+
+namespace test
+{
+
+namespace
+{
+
+#if HAVE_MMAP
+
+//! Number of atoms in the test frames
+constexpr int c_numAtoms = 5;
+
+class StreamFramesTest : public ::testing::Test
+{
+public:
+    StreamFramesTest() :
+        fileName_(fileManager_.getTemporaryFilePath("frames.stream")), x_(c_numAtoms)
+    {
+        clear_trxframe(&frame_, true);
+        frame_.natoms = c_numAtoms;
+        frame_.bX     = true;
+        frame_.x      = as_rvec_array(x_.data());
+        frame_.bStep  = true;
+        frame_.bTime  = true;
+        frame_.bBox   = true;
+    }
+
+    //! Fills the frame with data that depends on \p frameIndex
+    void setFrame(int frameIndex)
+    {
+        frame_.step = 10 * frameIndex;
+        frame_.time = 0.5 * frameIndex;
+        for (int d = 0; d < DIM; d++)
+        {
+            frame_.box[d][d] = 3 + frameIndex;
+        }
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            x_[i] = { 0.1F * i, 0.2F * frameIndex, -0.3F * (i + frameIndex) };
+        }
+    }
+
+    //! Checks that \p streamed matches the data set for \p frameIndex
+    void checkFrame(int frameIndex, const StreamedFrame& streamed)
+    {
+        setFrame(frameIndex);
+        EXPECT_EQ(frame_.step, streamed.step);
+        EXPECT_EQ(frame_.time, streamed.time);
+        for (int d = 0; d < DIM; d++)
+        {
+            for (int e = 0; e < DIM; e++)
+            {
+                EXPECT_EQ(frame_.box[d][e], streamed.box[d][e]);
+            }
+        }
+        ASSERT_EQ(c_numAtoms, static_cast<int>(streamed.x.size()));
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(x_[i][d], streamed.x[i][d]);
+            }
+        }
+    }
+
+    TestFileManager   fileManager_;
+    std::string       fileName_;
+    std::vector<RVec> x_;
+    t_trxframe        frame_;
+};
+
+TEST_F(StreamFramesTest, ReaderSeesFramesInRingBuffer)
+{
+    StreamFrames streamer(fileName_, 2);
+    for (int frameIndex = 0; frameIndex < 3; frameIndex++)
+    {
+        setFrame(frameIndex);
+        streamer.processFrame(frameIndex, &frame_);
+    }
+
+    FrameStreamReader reader(fileName_);
+    EXPECT_EQ(c_numAtoms, reader.numAtoms());
+    EXPECT_EQ(2, reader.numSlots());
+    EXPECT_EQ(3, reader.numFramesWritten());
+    EXPECT_FALSE(reader.isFinished());
+
+    StreamedFrame streamed;
+    // The first frame was overwritten, the fourth is not written yet
+    EXPECT_FALSE(reader.readFrame(0, &streamed));
+    EXPECT_FALSE(reader.readFrame(3, &streamed));
+    for (int frameIndex = 1; frameIndex < 3; frameIndex++)
+    {
+        ASSERT_TRUE(reader.readFrame(frameIndex, &streamed));
+        checkFrame(frameIndex, streamed);
+    }
+}
+
+TEST_F(StreamFramesTest, ReaderSeesEndOfStream)
+{
+    {
+        StreamFrames streamer(fileName_);
+        setFrame(0);
+        streamer.processFrame(0, &frame_);
+    }
+    FrameStreamReader reader(fileName_);
+    EXPECT_TRUE(reader.isFinished());
+    StreamedFrame streamed;
+    ASSERT_TRUE(reader.readFrame(0, &streamed));
+    checkFrame(0, streamed);
+}
+
+TEST_F(StreamFramesTest, RejectsChangedNumberOfAtoms)
+{
+    StreamFrames streamer(fileName_);
+    setFrame(0);
+    streamer.processFrame(0, &frame_);
+    frame_.natoms = c_numAtoms - 1;
+    EXPECT_THROW(streamer.processFrame(1, &frame_), InconsistentInputError);
+}
+
+TEST_F(StreamFramesTest, RejectsFrameWithoutCoordinates)
+{
+    StreamFrames streamer(fileName_);
+    frame_.bX = false;
+    EXPECT_THROW(streamer.processFrame(0, &frame_), InconsistentInputError);
+}
+
+TEST_F(StreamFramesTest, ReaderRejectsMissingStream)
+{
+    EXPECT_THROW(FrameStreamReader reader(fileName_), FileIOError);
+}
+
+#endif
+
+} // namespace
+
+} // namespace test
+
+} // namespace gmx
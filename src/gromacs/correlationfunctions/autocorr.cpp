@@ -60,8 +60,10 @@
 #include "gromacs/math/functions.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/utility/arraysize.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/real.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/strconvert.h"
@@ -546,8 +548,7 @@ void low_do_autocorr(const char*             fn,
 {
     FILE *   fp, *gp = nullptr;
     int      i;
-    real*    csum;
-    real *   ctmp, *fit;
+    real*    fit;
     real     sum, Ct2av, Ctav;
     gmx_bool bFour = acf.bFour;
 
@@ -588,37 +589,50 @@ void low_do_autocorr(const char*             fn,
                gmx::boolToString(bFour), gmx::boolToString(bNormalize));
         printf("mode = %lu, dt = %g, nrestart = %d\n", mode, dt, nrestart);
     }
-    /* Allocate temp arrays */
-    snew(csum, nframes);
-    snew(ctmp, nframes);
-
     /* Loop over items (e.g. molecules or dihedrals)
      * In this loop the actual correlation functions are computed, but without
      * normalizing them.
+     * The items are independent, so they are distributed over threads, each
+     * with its own temporary arrays. The FFTs for a single item then run on
+     * the calling thread only. The debug output of do_four_core() writes to
+     * fixed file names, so that case is kept serial.
      */
-    for (int i = 0; i < nitem; i++)
+    const int nthreads = (debug != nullptr) ? 1 : std::min(gmx_omp_get_max_threads(), nitem);
+#pragma omp parallel num_threads(nthreads)
     {
-        if (bVerbose && (((i % 100) == 0) || (i == nitem - 1)))
+        try
         {
-            fprintf(stderr, "\rThingie %d", i + 1);
-            fflush(stderr);
-        }
+            real* csum;
+            real* ctmp;
+            snew(csum, nframes);
+            snew(ctmp, nframes);
+#pragma omp for schedule(dynamic)
+            for (int i = 0; i < nitem; i++)
+            {
+                if (bVerbose && gmx_omp_get_thread_num() == 0)
+                {
+                    fprintf(stderr, "\rThingie %d", i + 1);
+                    fflush(stderr);
+                }
 
-        if (bFour)
-        {
-            do_four_core(mode, nframes, c1[i], csum, ctmp);
-        }
-        else
-        {
-            do_ac_core(nframes, nout, ctmp, c1[i], nrestart, mode);
+                if (bFour)
+                {
+                    do_four_core(mode, nframes, c1[i], csum, ctmp);
+                }
+                else
+                {
+                    do_ac_core(nframes, nout, ctmp, c1[i], nrestart, mode);
+                }
+            }
+            sfree(ctmp);
+            sfree(csum);
         }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
     if (bVerbose)
     {
-        fprintf(stderr, "\n");
+        fprintf(stderr, "\rThingie %d\n", nitem);
     }
-    sfree(ctmp);
-    sfree(csum);
 
     if (fn)
     {
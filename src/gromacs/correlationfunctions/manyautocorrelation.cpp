@@ -80,44 +80,52 @@ int many_auto_correl(std::vector<std::vector<real>>* c)
     {
         i.resize(nfft, 0);
     }
-#pragma omp parallel
+    // Only start as many threads as there are functions to compute.
+    const int maxThreads = std::min(gmx_omp_get_max_threads(), static_cast<int>(nfunc));
+#pragma omp parallel num_threads(maxThreads)
     {
         try
         {
             gmx_fft_t         fft1;
             std::vector<real> in, out;
 
-            int nthreads  = gmx_omp_get_max_threads();
+            // Use the actual team size, which is one when called from
+            // within another parallel region.
+            int nthreads  = gmx_omp_get_num_threads();
             int thread_id = gmx_omp_get_thread_num();
             int i0        = (thread_id * nfunc) / nthreads;
             int i1        = std::min(nfunc, ((thread_id + 1) * nfunc) / nthreads);
 
-            gmx_fft_init_1d(&fft1, nfft, GMX_FFT_FLAG_CONSERVATIVE);
-            /* Allocate temporary arrays */
-            in.resize(2 * nfft, 0);
-            out.resize(2 * nfft, 0);
-            for (int i = i0; (i < i1); i++)
+            if (i0 < i1)
             {
-                for (size_t j = 0; j < ndata; j++)
+                gmx_fft_init_1d(&fft1, nfft, GMX_FFT_FLAG_CONSERVATIVE);
+                /* Allocate temporary arrays */
+                in.resize(2 * nfft, 0);
+                out.resize(2 * nfft, 0);
+                for (int i = i0; (i < i1); i++)
                 {
-                    in[2 * j + 0] = (*c)[i][j];
-                    in[2 * j + 1] = 0;
-                }
-                gmx_fft_1d(fft1, GMX_FFT_BACKWARD, in.data(), out.data());
-                for (size_t j = 0; j < nfft; j++)
-                {
-                    in[2 * j + 0] =
-                            (out[2 * j + 0] * out[2 * j + 0] + out[2 * j + 1] * out[2 * j + 1]) / nfft;
-                    in[2 * j + 1] = 0;
-                }
-                gmx_fft_1d(fft1, GMX_FFT_FORWARD, in.data(), out.data());
-                for (size_t j = 0; (j < nfft); j++)
-                {
-                    (*c)[i][j] = out[2 * j + 0];
+                    for (size_t j = 0; j < ndata; j++)
+                    {
+                        in[2 * j + 0] = (*c)[i][j];
+                        in[2 * j + 1] = 0;
+                    }
+                    gmx_fft_1d(fft1, GMX_FFT_BACKWARD, in.data(), out.data());
+                    for (size_t j = 0; j < nfft; j++)
+                    {
+                        in[2 * j + 0] = (out[2 * j + 0] * out[2 * j + 0]
+                                         + out[2 * j + 1] * out[2 * j + 1])
+                                        / nfft;
+                        in[2 * j + 1] = 0;
+                    }
+                    gmx_fft_1d(fft1, GMX_FFT_FORWARD, in.data(), out.data());
+                    for (size_t j = 0; (j < nfft); j++)
+                    {
+                        (*c)[i][j] = out[2 * j + 0];
+                    }
                 }
+                /* Free the memory */
+                gmx_fft_destroy(fft1);
             }
-            /* Free the memory */
-            gmx_fft_destroy(fft1);
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
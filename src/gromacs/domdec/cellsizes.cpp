@@ -592,36 +592,85 @@ static void set_dd_cell_sizes_dlb_root(gmx_domdec_t*      dd,
     }
     else if (dd_load_count(comm) > 0)
     {
-        real load_aver  = comm->load[d].sum_m / ncd;
-        real change_max = 0;
-        real load_i;
-        real change;
+        /* We predict the balanced cell sizes by modeling the load density
+         * as uniform within each current cell. The balanced boundaries then
+         * follow from inverting the cumulative load along the row. Contrary
+         * to changing each cell size based on its own imbalance only, this
+         * takes into account that the load moves to the neighboring cells,
+         * which gives much faster convergence for strong density gradients,
+         * e.g. for membrane systems.
+         */
+        const domdec_load_t& load     = comm->load[d];
+        const auto           cellLoad = [&load](int i) -> real {
+            return load.load[i * load.nload + 2];
+        };
+
+        real loadSum = 0;
         for (int i = 0; i < ncd; i++)
         {
-            /* Determine the relative imbalance of cell i */
-            load_i         = comm->load[d].load[i * comm->load[d].nload + 2];
-            real imbalance = (load_i - load_aver) / (load_aver > 0 ? load_aver : 1);
-            /* Determine the change of the cell size using underrelaxation */
-            change     = -c_relax * imbalance;
-            change_max = std::max(change_max, std::max(change, -change));
+            loadSum += cellLoad(i);
         }
-        /* Limit the amount of scaling.
-         * We need to use the same rescaling for all cells in one row,
-         * otherwise the load balancing might not converge.
-         */
-        real sc = c_relax;
-        if (change_max > change_limit)
+
+        if (loadSum > 0)
         {
-            sc *= change_limit / change_max;
+            /* Determine the predicted cell sizes, stored in cell_size */
+            real loadCumulative = 0;
+            real lowerBound     = 0;
+            int  cell           = 0;
+            for (int i = 0; i < ncd; i++)
+            {
+                real upperBound = 1;
+                if (i < ncd - 1)
+                {
+                    const real loadTarget = (loadSum * (i + 1)) / ncd;
+                    while (cell < ncd - 1 && loadCumulative + cellLoad(cell) < loadTarget)
+                    {
+                        loadCumulative += cellLoad(cell);
+                        cell++;
+                    }
+                    const real loadCell = cellLoad(cell);
+                    real       fraction = 0;
+                    if (loadCell > 0)
+                    {
+                        fraction = std::min((loadTarget - loadCumulative) / loadCell, 1.0_real);
+                    }
+                    const real cellSizeCurrent =
+                            rowMaster->cellFrac[cell + 1] - rowMaster->cellFrac[cell];
+                    upperBound = rowMaster->cellFrac[cell] + fraction * cellSizeCurrent;
+                }
+                cell_size[i] = upperBound - lowerBound;
+                lowerBound   = upperBound;
+            }
+
+            /* Determine the change of the cell size using underrelaxation */
+            real change_max = 0;
+            for (int i = 0; i < ncd; i++)
+            {
+                const real cellSizeOld = rowMaster->cellFrac[i + 1] - rowMaster->cellFrac[i];
+                const real change      = c_relax * (cell_size[i] / cellSizeOld - 1);
+                change_max             = std::max(change_max, std::abs(change));
+            }
+            /* Limit the amount of scaling.
+             * We need to use the same rescaling for all cells in one row,
+             * otherwise the load balancing might not converge.
+             */
+            real sc = c_relax;
+            if (change_max > change_limit)
+            {
+                sc *= change_limit / change_max;
+            }
+            for (int i = 0; i < ncd; i++)
+            {
+                const real cellSizeOld = rowMaster->cellFrac[i + 1] - rowMaster->cellFrac[i];
+                cell_size[i] = cellSizeOld * (1 + sc * (cell_size[i] / cellSizeOld - 1));
+            }
         }
-        for (int i = 0; i < ncd; i++)
+        else
         {
-            /* Determine the relative imbalance of cell i */
-            load_i         = comm->load[d].load[i * comm->load[d].nload + 2];
-            real imbalance = (load_i - load_aver) / (load_aver > 0 ? load_aver : 1);
-            /* Determine the change of the cell size using underrelaxation */
-            change       = -sc * imbalance;
-            cell_size[i] = (rowMaster->cellFrac[i + 1] - rowMaster->cellFrac[i]) * (1 + change);
+            for (int i = 0; i < ncd; i++)
+            {
+                cell_size[i] = rowMaster->cellFrac[i + 1] - rowMaster->cellFrac[i];
+            }
         }
     }
 
@@ -48,8 +48,10 @@
 
 #include "gromacs/domdec/domdec_network.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
 
 #include "atomdistribution.h"
 #include "distribute.h"
@@ -216,14 +218,25 @@ static void dd_collect_vec_gatherv(gmx_domdec_t*                  dd,
     {
         const AtomDistribution& ma = *dd->ma;
 
-        int bufferAtom = 0;
+        /* The atom groups of all ranks are stored consecutively in rank
+         * order in ma.atomGroups, which is also the order of the received
+         * buffer. So we can reorder into the global vector with a single
+         * loop over all atoms, which we can run in parallel.
+         */
+        int numAtoms = 0;
         for (int rank = 0; rank < dd->nnodes; rank++)
         {
-            const auto& domainGroups = ma.domainGroups[rank];
-            for (const int& globalAtom : domainGroups.atomGroups)
-            {
-                copy_rvec(ma.rvecBuffer[bufferAtom++], v[globalAtom]);
-            }
+            GMX_ASSERT(ma.domainGroups[rank].atomGroups.data() == ma.atomGroups.data() + numAtoms,
+                       "The atom groups of the ranks should be stored consecutively");
+            numAtoms += ma.domainGroups[rank].atomGroups.ssize();
+        }
+
+        const int* globalAtoms = ma.atomGroups.data();
+        const int  numThreads  = gmx_omp_nthreads_get(emntDomdec);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+        for (int bufferAtom = 0; bufferAtom < numAtoms; bufferAtom++)
+        {
+            copy_rvec(ma.rvecBuffer[bufferAtom], v[globalAtoms[bufferAtom]]);
         }
     }
 }
@@ -248,7 +261,7 @@ void dd_collect_vec(gmx_domdec_t*                  dd,
 }
 
 
-void dd_collect_state(gmx_domdec_t* dd, const t_state* state_local, t_state* state)
+void dd_collect_state_without_atom_vectors(const gmx_domdec_t* dd, const t_state* state_local, t_state* state)
 {
     int nh = state_local->nhchainlength;
 
@@ -290,6 +303,29 @@ void dd_collect_state(gmx_domdec_t* dd, const t_state* state_local, t_state* sta
         state->baros_integral     = state_local->baros_integral;
         state->pull_com_prev_step = state_local->pull_com_prev_step;
     }
+}
+
+gmx::ArrayRef<const int> dd_local_state_global_atom_indices(const gmx_domdec_t* dd,
+                                                             const t_state*      state_local)
+{
+    if (state_local->ddp_count == dd->ddp_count)
+    {
+        /* The local state and DD are in sync, use the DD indices */
+        return gmx::constArrayRefFromArray(dd->globalAtomGroupIndices.data(), dd->ncg_home);
+    }
+    else if (state_local->ddp_count_cg_gl == state_local->ddp_count)
+    {
+        /* The DD is out of sync with the local state, use the indices stored with the state */
+        return state_local->cg_gl;
+    }
+
+    gmx_incons("Requested the atom indices of a state for which the distribution is unknown");
+}
+
+void dd_collect_state(gmx_domdec_t* dd, const t_state* state_local, t_state* state)
+{
+    dd_collect_state_without_atom_vectors(dd, state_local, state);
+
     if (state_local->flags & (1 << estX))
     {
         auto globalXRef = state ? state->x : gmx::ArrayRef<gmx::RVec>();
@@ -64,4 +64,21 @@ void dd_collect_vec(gmx_domdec_t*                  dd,
 /*! \brief Gathers state \p localState to \p globalState on the master rank */
 void dd_collect_state(gmx_domdec_t* dd, const t_state* localState, t_state* globalState);
 
+/*! \brief Copies the parts of \p localState that are not per atom to \p globalState on the master rank
+ *
+ * This is dd_collect_state() without the collection of the per-atom
+ * vectors x, v and cg_p, which are then left unchanged in \p globalState.
+ * Does not communicate.
+ */
+void dd_collect_state_without_atom_vectors(const gmx_domdec_t* dd,
+                                           const t_state*      localState,
+                                           t_state*            globalState);
+
+/*! \brief Returns the global atom indices of the home atoms of \p localState
+ *
+ * The order matches that of the per-atom vectors in \p localState.
+ */
+gmx::ArrayRef<const int> dd_local_state_global_atom_indices(const gmx_domdec_t* dd,
+                                                             const t_state*      localState);
+
 #endif
@@ -52,6 +52,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "gromacs/domdec/builder.h"
 #include "gromacs/domdec/collect.h"
@@ -1730,6 +1731,75 @@ static real* get_slb_frac(const gmx::MDLogger& mdlog, const char* dir, int nc, c
     return slb_frac;
 }
 
+/*! \brief Sets static cell size fractions from relative rank capabilities
+ *
+ * Each PP rank can set its relative capability through the environment
+ * variable GMX_DD_RANK_WEIGHT. When not all ranks have the same weight,
+ * the cell sizes along each decomposed dimension, for which no sizes were
+ * set by the user, are set proportional to the summed weights of the ranks
+ * in each slab. These fractions are used with DLB off and as the starting
+ * point when DLB is turned on.
+ * Must be called by all PP ranks, after the PP communicator has been set up.
+ */
+static void setCellFractionsFromRankWeights(const gmx::MDLogger& mdlog, gmx_domdec_t* dd)
+{
+    double      weight    = 1;
+    const char* weightEnv = getenv("GMX_DD_RANK_WEIGHT");
+    if (weightEnv != nullptr)
+    {
+        char* end = nullptr;
+        weight    = std::strtod(weightEnv, &end);
+        if (end == weightEnv || !(weight > 0))
+        {
+            gmx_fatal(FARGS, "GMX_DD_RANK_WEIGHT should be a positive number, not '%s'", weightEnv);
+        }
+    }
+
+    std::vector<double> weights(dd->nnodes, 0.0);
+    weights[dd_index(dd->numCells, dd->ci)] = weight;
+#if GMX_MPI
+    if (dd->nnodes > 1)
+    {
+        MPI_Allreduce(
+                MPI_IN_PLACE, weights.data(), dd->nnodes, MPI_DOUBLE, MPI_SUM, dd->mpi_comm_all);
+    }
+#endif
+    const double firstWeight = weights[0];
+    if (std::all_of(weights.begin(), weights.end(),
+                    [firstWeight](double w) { return w == firstWeight; }))
+    {
+        return;
+    }
+
+    gmx_domdec_comm_t* comm = dd->comm;
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        const int nc = dd->numCells[dim];
+        if (nc == 1 || comm->slb_frac[dim] != nullptr)
+        {
+            continue;
+        }
+
+        snew(comm->slb_frac[dim], nc);
+        double tot = 0;
+        for (int i = 0; i < dd->nnodes; i++)
+        {
+            ivec xyz;
+            ddindex2xyz(dd->numCells, i, xyz);
+            comm->slb_frac[dim][xyz[dim]] += weights[i];
+            tot += weights[i];
+        }
+        std::string relativeCellSizes = gmx::formatString(
+                "Relative cell sizes in the %c direction from the rank weights:", 'x' + dim);
+        for (int i = 0; i < nc; i++)
+        {
+            comm->slb_frac[dim][i] /= tot;
+            relativeCellSizes += gmx::formatString(" %5.3f", comm->slb_frac[dim][i]);
+        }
+        GMX_LOG(mdlog.info).appendText(relativeCellSizes);
+    }
+}
+
 static int multi_body_bondeds_count(const gmx_mtop_t* mtop)
 {
     int                  n     = 0;
@@ -2306,6 +2376,7 @@ static void checkDDGridSetup(const DDGridSetup&   ddGridSetup,
 
 /*! \brief Set the cell size and interaction limits, as well as the DD grid */
 static DDRankSetup getDDRankSetup(const gmx::MDLogger& mdlog,
+                                  MPI_Comm             communicator,
                                   int                  numNodes,
                                   const DDGridSetup&   ddGridSetup,
                                   const t_inputrec&    ir)
@@ -2345,7 +2416,11 @@ static DDRankSetup getDDRankSetup(const gmx::MDLogger& mdlog,
             && ddGridSetup.ddDimensions[1] == YY
             && ddRankSetup.numRanksDoingPme > ddGridSetup.numDomains[XX]
             && ddRankSetup.numRanksDoingPme % ddGridSetup.numDomains[XX] == 0
-            && getenv("GMX_PMEONEDD") == nullptr)
+            && getenv("GMX_PMEONEDD") == nullptr
+            && (getenv("GMX_PME_DECOMP_TUNE") == nullptr
+                || pmeFftPrefersPencilDecomposition(mdlog, communicator, ir,
+                                                    ddRankSetup.numRanksDoingPme,
+                                                    ddGridSetup.numDomains[XX])))
         {
             ddRankSetup.npmedecompdim = 2;
             ddRankSetup.npmenodes_x   = ddGridSetup.numDomains[XX];
@@ -3008,7 +3083,8 @@ DomainDecompositionBuilder::Impl::Impl(const MDLogger&      mdlog,
 
     cr_->npmenodes = ddGridSetup_.numPmeOnlyRanks;
 
-    ddRankSetup_ = getDDRankSetup(mdlog_, cr_->sizeOfDefaultCommunicator, ddGridSetup_, ir_);
+    ddRankSetup_ = getDDRankSetup(mdlog_, cr_->mpiDefaultCommunicator,
+                                  cr_->sizeOfDefaultCommunicator, ddGridSetup_, ir_);
 
     /* Generate the group communicator, also decides the duty of each rank */
     cartSetup_ = makeGroupCommunicators(mdlog_, ddSettings_, options_.rankOrder, ddRankSetup_, cr_,
@@ -3033,6 +3109,8 @@ gmx_domdec_t* DomainDecompositionBuilder::Impl::build(LocalAtomSetManager* atomS
 
     if (thisRankHasDuty(cr_, DUTY_PP))
     {
+        setCellFractionsFromRankWeights(mdlog_, dd);
+
         set_ddgrid_parameters(mdlog_, dd, options_.dlbScaling, &mtop_, &ir_, &ddbox_);
 
         setup_neighbor_relations(dd);
@@ -53,10 +53,13 @@
 #include <cmath>
 #include <cstdio>
 
+#include <algorithm>
+
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/domdec/options.h"
 #include "gromacs/ewald/pme.h"
+#include "gromacs/fft/parallel_3dfft.h"
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/math/utilities.h"
 #include "gromacs/math/vec.h"
@@ -65,8 +68,10 @@
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/timing/cyclecounter.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/logger.h"
 #include "gromacs/utility/stringutil.h"
 
@@ -183,8 +188,88 @@ static gmx_bool fits_pp_pme_perf(int ntot, int npme, float ratio)
     return fits_pme_ratio(ntot, npme, ratio);
 }
 
+/*! \brief Calibrates the PME FFT cost of the PME load model on this machine
+ *
+ * The master rank times a serial forward plus backward FFT of the PME grid.
+ * The FFT performance depends strongly on the FFT library and the cache sizes,
+ * whereas the other reference costs of the model are relatively constant
+ * over recent CPUs. Collective call over \p communicator.
+ */
+static PmeLoadCalibration getPmeLoadCalibration(const gmx::MDLogger& mdlog,
+                                                MPI_Comm             communicator,
+                                                const t_inputrec&    ir)
+{
+    PmeLoadCalibration calibration;
+
+#if GMX_MPI
+    int rank;
+    MPI_Comm_rank(communicator, &rank);
+
+    const bool doCalibration =
+            (gmx_cycles_have_counter() && getenv("GMX_NO_PME_LOAD_CALIBRATION") == nullptr);
+
+    /* A communicator with only the master rank for a serial FFT */
+    MPI_Comm fftCommunicator;
+    MPI_Comm_split(communicator, (rank == 0 && doCalibration) ? 0 : MPI_UNDEFINED, rank,
+                   &fftCommunicator);
+
+    if (fftCommunicator != MPI_COMM_NULL)
+    {
+        MPI_Comm             comm[2] = { fftCommunicator, MPI_COMM_NULL };
+        const ivec           ndata   = { ir.nkx, ir.nky, ir.nkz };
+        gmx_parallel_3dfft_t pfft    = nullptr;
+        real*                realGrid;
+        t_complex*           complexGrid;
+        gmx_parallel_3dfft_init(&pfft, ndata, &realGrid, &complexGrid, comm, FALSE, 1);
+
+        ivec localNData, localOffset, localSize;
+        gmx_parallel_3dfft_real_limits(pfft, localNData, localOffset, localSize);
+        std::fill(realGrid, realGrid + localSize[XX] * localSize[YY] * localSize[ZZ], 0.0_real);
+
+        /* The first pair of FFTs is for warming up and not timed */
+        constexpr int c_numTimedFftPairs = 3;
+        gmx_cycles_t  startCycles        = 0;
+        for (int i = 0; i <= c_numTimedFftPairs; i++)
+        {
+            if (i == 1)
+            {
+                startCycles = gmx_cycles_read();
+            }
+            gmx_parallel_3dfft_execute(pfft, GMX_FFT_REAL_TO_COMPLEX, 0, nullptr);
+            gmx_parallel_3dfft_execute(pfft, GMX_FFT_COMPLEX_TO_REAL, 0, nullptr);
+        }
+        const double cycles =
+                static_cast<double>(gmx_cycles_read() - startCycles) / c_numTimedFftPairs;
+
+        gmx_parallel_3dfft_destroy(pfft);
+        MPI_Comm_free(&fftCommunicator);
+
+        /* Limit the correction, as a timing on a busy core can be far off */
+        constexpr double c_maxCorrection = 4;
+        calibration.fftCostFactor        = std::clamp(cycles / pmeFftReferenceCycles(ir),
+                                               1 / c_maxCorrection, c_maxCorrection);
+
+        GMX_LOG(mdlog.info)
+                .appendTextFormatted(
+                        "PME FFT benchmark: %.2f Mcycles per FFT pair, %.2f times the cost "
+                        "assumed by the PME load model",
+                        cycles * 1e-6, calibration.fftCostFactor);
+    }
+
+    /* Rank 0 made the measurement, make all ranks use the same calibration */
+    gmx_bcast(sizeof(calibration), &calibration, communicator);
+#else
+    GMX_UNUSED_VALUE(mdlog);
+    GMX_UNUSED_VALUE(communicator);
+    GMX_UNUSED_VALUE(ir);
+#endif
+
+    return calibration;
+}
+
 /*! \brief Make a guess for the number of PME ranks to use. */
 static int guess_npme(const gmx::MDLogger& mdlog,
+                      MPI_Comm             communicator,
                       const gmx_mtop_t&    mtop,
                       const t_inputrec&    ir,
                       const matrix         box,
@@ -193,7 +278,7 @@ static int guess_npme(const gmx::MDLogger& mdlog,
     float ratio;
     int   npme;
 
-    ratio = pme_load_estimate(mtop, ir, box);
+    ratio = pme_load_estimate(mtop, ir, box, getPmeLoadCalibration(mdlog, communicator, ir));
 
     GMX_LOG(mdlog.info).appendTextFormatted("Guess for relative PME load: %.2f", ratio);
 
@@ -785,6 +870,7 @@ void checkForValidRankCountRequests(const int  numRanksRequested,
  *
  * If the user did not choose a number, then decide for them. */
 static int getNumPmeOnlyRanksToUse(const gmx::MDLogger& mdlog,
+                                   MPI_Comm             communicator,
                                    const DomdecOptions& options,
                                    const gmx_mtop_t&    mtop,
                                    const t_inputrec&    ir,
@@ -836,7 +922,8 @@ static int getNumPmeOnlyRanksToUse(const gmx::MDLogger& mdlog,
                 }
                 else
                 {
-                    numPmeOnlyRanks = guess_npme(mdlog, mtop, ir, box, numRanksRequested);
+                    numPmeOnlyRanks =
+                            guess_npme(mdlog, communicator, mtop, ir, box, numRanksRequested);
                     extraMessage    = ", as guessed by mdrun";
                 }
             }
@@ -902,7 +989,8 @@ DDGridSetup getDDGridSetup(const gmx::MDLogger&           mdlog,
                            gmx::ArrayRef<const gmx::RVec> xGlobal,
                            gmx_ddbox_t*                   ddbox)
 {
-    int numPmeOnlyRanks = getNumPmeOnlyRanksToUse(mdlog, options, mtop, ir, box, numRanksRequested);
+    int numPmeOnlyRanks = getNumPmeOnlyRanksToUse(mdlog, communicator, options, mtop, ir, box,
+                                                  numRanksRequested);
 
     gmx::IVec numDomains;
     if (options.numCells[XX] > 0)
@@ -938,3 +1026,111 @@ DDGridSetup getDDGridSetup(const gmx::MDLogger&           mdlog,
 
     return ddGridSetup;
 }
+
+#if GMX_MPI
+/*! \brief Returns the time for a forward plus backward PME FFT with \p numRanksY ranks along y
+ *
+ * Collective call over \p communicator, all ranks in it take part in the FFT.
+ */
+static double timePmeFft(MPI_Comm communicator, const t_inputrec& ir, const int numRanksY)
+{
+    int rank;
+    MPI_Comm_rank(communicator, &rank);
+
+    /* Set up the communicators in the same way as gmx_pme_init does */
+    MPI_Comm comm[2] = { MPI_COMM_NULL, MPI_COMM_NULL };
+    if (numRanksY == 1)
+    {
+        comm[0] = communicator;
+    }
+    else
+    {
+        MPI_Comm_split(communicator, rank % numRanksY, rank, &comm[0]);
+        MPI_Comm_split(communicator, rank / numRanksY, rank, &comm[1]);
+    }
+
+    const ivec           ndata = { ir.nkx, ir.nky, ir.nkz };
+    gmx_parallel_3dfft_t pfft  = nullptr;
+    real*                realGrid;
+    t_complex*           complexGrid;
+    gmx_parallel_3dfft_init(&pfft, ndata, &realGrid, &complexGrid, comm, FALSE, 1);
+
+    ivec localNData, localOffset, localSize;
+    gmx_parallel_3dfft_real_limits(pfft, localNData, localOffset, localSize);
+    std::fill(realGrid, realGrid + localSize[XX] * localSize[YY] * localSize[ZZ], 0.0_real);
+
+    /* The first pair of FFTs is for warming up and not timed */
+    constexpr int c_numTimedFftPairs = 5;
+    double        startTime          = 0;
+    for (int i = 0; i <= c_numTimedFftPairs; i++)
+    {
+        if (i == 1)
+        {
+            MPI_Barrier(communicator);
+            startTime = MPI_Wtime();
+        }
+        gmx_parallel_3dfft_execute(pfft, GMX_FFT_REAL_TO_COMPLEX, 0, nullptr);
+        gmx_parallel_3dfft_execute(pfft, GMX_FFT_COMPLEX_TO_REAL, 0, nullptr);
+    }
+    double time = MPI_Wtime() - startTime;
+    MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, communicator);
+
+    gmx_parallel_3dfft_destroy(pfft);
+    if (numRanksY > 1)
+    {
+        MPI_Comm_free(&comm[0]);
+        MPI_Comm_free(&comm[1]);
+    }
+
+    return time / c_numTimedFftPairs;
+}
+#endif
+
+bool pmeFftPrefersPencilDecomposition(const gmx::MDLogger& mdlog,
+                                      MPI_Comm             communicator,
+                                      const t_inputrec&    ir,
+                                      const int            numRanksDoingPme,
+                                      const int            numPmeRanksX)
+{
+    bool usePencils = true;
+
+#if GMX_MPI
+    int rank;
+    MPI_Comm_rank(communicator, &rank);
+
+    /* We benchmark on the first ranks, which are not necessarily the ranks
+     * that will do PME. This is fine, as we are after the relative cost.
+     */
+    MPI_Comm fftCommunicator;
+    MPI_Comm_split(communicator, rank < numRanksDoingPme ? 0 : MPI_UNDEFINED, rank,
+                   &fftCommunicator);
+
+    if (fftCommunicator != MPI_COMM_NULL)
+    {
+        const double timeSlab   = timePmeFft(fftCommunicator, ir, 1);
+        const double timePencil = timePmeFft(fftCommunicator, ir, numRanksDoingPme / numPmeRanksX);
+        usePencils              = (timePencil <= timeSlab);
+
+        GMX_LOG(mdlog.info)
+                .appendTextFormatted(
+                        "PME FFT benchmark: %d x 1 slabs %.3f ms, %d x %d pencils %.3f ms, "
+                        "using %s",
+                        numRanksDoingPme, timeSlab * 1000, numPmeRanksX,
+                        numRanksDoingPme / numPmeRanksX, timePencil * 1000,
+                        usePencils ? "pencils" : "slabs");
+
+        MPI_Comm_free(&fftCommunicator);
+    }
+
+    /* Rank 0 is always part of the benchmark, make all ranks agree with it */
+    gmx_bcast(sizeof(usePencils), &usePencils, communicator);
+#else
+    GMX_UNUSED_VALUE(mdlog);
+    GMX_UNUSED_VALUE(communicator);
+    GMX_UNUSED_VALUE(ir);
+    GMX_UNUSED_VALUE(numRanksDoingPme);
+    GMX_UNUSED_VALUE(numPmeRanksX);
+#endif
+
+    return usePencils;
+}
@@ -119,4 +119,17 @@ DDGridSetup getDDGridSetup(const gmx::MDLogger&           mdlog,
                            gmx::ArrayRef<const gmx::RVec> xGlobal,
                            gmx_ddbox_t*                   ddbox);
 
+/*! \brief Returns whether a benchmark prefers a 2D pencil over a 1D slab PME FFT decomposition
+ *
+ * Times forward and backward PME FFTs over the first \p numRanksDoingPme ranks
+ * of \p communicator with \p numRanksDoingPme x 1 slabs and with pencils
+ * with \p numPmeRanksX ranks along x. Collective call over \p communicator,
+ * all ranks get the same result.
+ */
+bool pmeFftPrefersPencilDecomposition(const gmx::MDLogger& mdlog,
+                                      MPI_Comm             communicator,
+                                      const t_inputrec&    ir,
+                                      int                  numRanksDoingPme,
+                                      int                  numPmeRanksX);
+
 #endif
@@ -112,7 +112,15 @@ struct MolblockIndices
     int type;
 };
 
-/*! \brief Struct for thread local work data for local topology generation */
+/*! \brief The number of work chunks per OpenMP thread for local topology generation
+ *
+ * Using more chunks than threads with dynamic scheduling balances the load
+ * when the density of bonded interactions is inhomogeneous, e.g. for a protein
+ * in water, the results are still combined in a fixed order.
+ */
+static constexpr int c_numLocalTopologyWorkChunksPerThread = 4;
+
+/*! \brief Struct for work chunk local data for local topology generation */
 struct thread_work_t
 {
     /*! \brief Constructor
@@ -155,7 +163,7 @@ struct gmx_reverse_top_t
     reverse_ilist_t ril_intermol;
 
     /* Work data structures for multi-threading */
-    //! \brief Thread work array for local topology generation
+    //! \brief Work chunk array for local topology generation, chunk 0 stores in the final output
     std::vector<thread_work_t> th_work;
     //! @endcond
 };
@@ -453,29 +461,37 @@ void dd_print_missing_interactions(const gmx::MDLogger&           mdlog,
     gmx_fatal_collective(FARGS, cr->mpi_comm_mygroup, MASTER(cr), "%s", errorMessage.c_str());
 }
 
-/*! \brief Return global topology molecule information for global atom index \p i_gl */
+/*! \brief Return global topology molecule information for global atom index \p i_gl
+ *
+ * On input \p mb should be a guess for the molblock, e.g. the molblock
+ * returned for the previous atom. As local atoms are mostly ordered by
+ * molecule, this avoids the search in the common case.
+ */
 static void global_atomnr_to_moltype_ind(const gmx_reverse_top_t* rt, int i_gl, int* mb, int* mt, int* mol, int* i_mol)
 {
     const MolblockIndices* mbi   = rt->mbi.data();
     int                    start = 0;
     int                    end   = rt->mbi.size(); /* exclusive */
-    int                    mid;
+    int                    mid   = *mb;
 
-    /* binary search for molblock_ind */
-    while (TRUE)
+    if (mid < 0 || mid >= end || i_gl < mbi[mid].a_start || i_gl >= mbi[mid].a_end)
     {
-        mid = (start + end) / 2;
-        if (i_gl >= mbi[mid].a_end)
-        {
-            start = mid + 1;
-        }
-        else if (i_gl < mbi[mid].a_start)
-        {
-            end = mid;
-        }
-        else
+        /* binary search for molblock_ind */
+        while (TRUE)
         {
-            break;
+            mid = (start + end) / 2;
+            if (i_gl >= mbi[mid].a_end)
+            {
+                start = mid + 1;
+            }
+            else if (i_gl < mbi[mid].a_start)
+            {
+                end = mid;
+            }
+            else
+            {
+                break;
+            }
         }
     }
 
@@ -725,7 +741,10 @@ static gmx_reverse_top_t make_reverse_top(const gmx_mtop_t* mtop,
         rt.mbi.push_back(mbi);
     }
 
-    for (int th = 0; th < gmx_omp_nthreads_get(emntDomdec); th++)
+    const int numThreads = gmx_omp_nthreads_get(emntDomdec);
+    const int numWorkChunks =
+            (numThreads > 1 ? numThreads * c_numLocalTopologyWorkChunksPerThread : 1);
+    for (int chunk = 0; chunk < numWorkChunks; chunk++)
     {
         rt.th_work.emplace_back(mtop->ffparams);
     }
@@ -1254,7 +1273,7 @@ static inline void check_assign_interactions_atom(int                       i,
 
 /*! \brief This function looks up and assigns bonded interactions for zone iz.
  *
- * With thread parallelizing each thread acts on a different atom range:
+ * With thread parallelizing each work chunk acts on a different atom range:
  * at_start to at_end.
  */
 static int make_bondeds_zone(gmx_domdec_t*                      dd,
@@ -1281,6 +1300,7 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
     bBCheck = rt->bBCheck;
 
     nbonded_local = 0;
+    mb            = 0;
 
     for (int i : atomRange)
     {
@@ -1331,13 +1351,14 @@ static void make_exclusions_zone(gmx_domdec_t*                     dd,
     const gmx::index oldNumLists = lexcls->ssize();
 
     std::vector<int> exclusionsForAtom;
+    int              mb = 0;
     for (int at = at_start; at < at_end; at++)
     {
         exclusionsForAtom.clear();
 
         if (GET_CGINFO_EXCL_INTER(cginfo[at]))
         {
-            int a_gl, mb, mt, mol, a_mol;
+            int a_gl, mt, mol, a_mol;
 
             /* Copy the exclusions from the global top */
             a_gl = dd->globalAtomIndices[at];
@@ -1436,44 +1457,49 @@ static int make_local_bondeds_excls(gmx_domdec_t*           dd,
         cg0 = zones->cg_range[izone];
         cg1 = zones->cg_range[izone + 1];
 
-        const int numThreads = rt->th_work.size();
-#pragma omp parallel for num_threads(numThreads) schedule(static)
-        for (int thread = 0; thread < numThreads; thread++)
+        /* The atom range is divided over more chunks than threads,
+         * dynamic scheduling then balances the load over threads, whereas
+         * combining the chunk results in chunk order keeps them independent
+         * of the scheduling.
+         */
+        const int numWorkChunks = rt->th_work.size();
+#pragma omp parallel for num_threads(gmx_omp_nthreads_get(emntDomdec)) schedule(dynamic)
+        for (int chunk = 0; chunk < numWorkChunks; chunk++)
         {
             try
             {
                 int                     cg0t, cg1t;
                 InteractionDefinitions* idef_t;
 
-                cg0t = cg0 + ((cg1 - cg0) * thread) / numThreads;
-                cg1t = cg0 + ((cg1 - cg0) * (thread + 1)) / numThreads;
+                cg0t = cg0 + ((cg1 - cg0) * chunk) / numWorkChunks;
+                cg1t = cg0 + ((cg1 - cg0) * (chunk + 1)) / numWorkChunks;
 
-                if (thread == 0)
+                if (chunk == 0)
                 {
                     idef_t = idef;
                 }
                 else
                 {
-                    idef_t = &rt->th_work[thread].idef;
+                    idef_t = &rt->th_work[chunk].idef;
                     idef_t->clear();
                 }
 
-                rt->th_work[thread].nbonded = make_bondeds_zone(
+                rt->th_work[chunk].nbonded = make_bondeds_zone(
                         dd, zones, mtop->molblock, bRCheckMB, rcheck, bRCheck2B, rc2, pbc_null,
                         cg_cm, idef->iparams.data(), idef_t, izone, gmx::Range<int>(cg0t, cg1t));
 
                 if (izone < numIZonesForExclusions)
                 {
                     ListOfLists<int>* excl_t;
-                    if (thread == 0)
+                    if (chunk == 0)
                     {
-                        // Thread 0 stores exclusions directly in the final storage
+                        // Chunk 0 stores exclusions directly in the final storage
                         excl_t = lexcls;
                     }
                     else
                     {
-                        // Threads > 0 store in temporary storage, starting at list index 0
-                        excl_t = &rt->th_work[thread].excl;
+                        // Chunks > 0 store in temporary storage, starting at list index 0
+                        excl_t = &rt->th_work[chunk].excl;
                         excl_t->clear();
                     }
 
@@ -199,9 +199,12 @@ void GpuHaloExchange::Impl::reinitHalo(float3* d_coordinatesBuffer, float3* d_fo
     // address to other neighbour. We can do this here in reinit fn
     // since the pointers will not change until the next NS step.
 
+    // With library MPI the data is instead received by MPI directly
+    // into these buffers, so no remote pointers are needed.
+
     // Coordinates buffer:
     void* recvPtr = static_cast<void*>(&d_x_[atomOffset_]);
-#if GMX_MPI
+#if GMX_THREAD_MPI
     MPI_Sendrecv(&recvPtr, sizeof(void*), MPI_BYTE, recvRankX_, 0, &remoteXPtr_, sizeof(void*),
                  MPI_BYTE, sendRankX_, 0, mpi_comm_mysim_, MPI_STATUS_IGNORE);
 
@@ -209,6 +212,8 @@ void GpuHaloExchange::Impl::reinitHalo(float3* d_coordinatesBuffer, float3* d_fo
     recvPtr = static_cast<void*>(d_recvBuf_);
     MPI_Sendrecv(&recvPtr, sizeof(void*), MPI_BYTE, recvRankF_, 0, &remoteFPtr_, sizeof(void*),
                  MPI_BYTE, sendRankF_, 0, mpi_comm_mysim_, MPI_STATUS_IGNORE);
+#else
+    GMX_UNUSED_VALUE(recvPtr);
 #endif
 
     wallcycle_sub_stop(wcycle_, ewcsDD_GPU);
@@ -370,6 +375,8 @@ void GpuHaloExchange::Impl::communicateHaloData(float3*               d_ptr,
     int   sendSize;
     void* remotePtr;
     int   sendRank;
+    void* recvPtr;
+    int   recvSize;
     int   recvRank;
 
     if (haloQuantity == HaloQuantity::HaloCoordinates)
@@ -378,9 +385,11 @@ void GpuHaloExchange::Impl::communicateHaloData(float3*               d_ptr,
         sendSize  = xSendSize_;
         remotePtr = remoteXPtr_;
         sendRank  = sendRankX_;
+        recvPtr   = static_cast<void*>(&d_x_[atomOffset_]);
+        recvSize  = xRecvSize_;
         recvRank  = recvRankX_;
 
-#if GMX_MPI
+#if GMX_THREAD_MPI
         // Wait for event from receiving task that remote coordinates are ready, and enqueue that event to stream used
         // for subsequent data push. This avoids a race condition with the remote data being written in the previous timestep.
         // Similarly send event to task that will push data to this task.
@@ -399,10 +408,62 @@ void GpuHaloExchange::Impl::communicateHaloData(float3*               d_ptr,
         sendSize  = fSendSize_;
         remotePtr = remoteFPtr_;
         sendRank  = sendRankF_;
+        recvPtr   = static_cast<void*>(d_recvBuf_);
+        recvSize  = fRecvSize_;
         recvRank  = recvRankF_;
     }
 
+#if GMX_THREAD_MPI
+    GMX_UNUSED_VALUE(recvPtr);
+    GMX_UNUSED_VALUE(recvSize);
     communicateHaloDataWithCudaDirect(sendPtr, sendSize, sendRank, remotePtr, recvRank);
+#else
+    GMX_UNUSED_VALUE(remotePtr);
+    communicateHaloDataWithCudaMPI(sendPtr, sendSize, sendRank, recvPtr, recvSize, recvRank);
+#endif
+}
+
+void GpuHaloExchange::Impl::communicateHaloDataWithCudaMPI(void* sendPtr,
+                                                           int   sendSize,
+                                                           int   sendRank,
+                                                           void* recvPtr,
+                                                           int   recvSize,
+                                                           int   recvRank)
+{
+#if GMX_LIB_MPI
+    // MPI operates on device buffers outside of any stream, so all
+    // preceding work in the non-local stream, in particular packing
+    // of the send buffer, needs to have completed. Work already
+    // enqueued in the local stream continues to overlap with the
+    // communication.
+    nonLocalStream_.synchronize();
+
+    MPI_Request request;
+
+    // Post the receive first to avoid unexpected message buffering
+    // of device data in the MPI library.
+    if (recvSize > 0)
+    {
+        MPI_Irecv(recvPtr, recvSize * DIM, MPI_FLOAT, recvRank, 0, mpi_comm_mysim_, &request);
+    }
+
+    if (sendSize > 0)
+    {
+        MPI_Send(sendPtr, sendSize * DIM, MPI_FLOAT, sendRank, 0, mpi_comm_mysim_);
+    }
+
+    if (recvSize > 0)
+    {
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+    }
+#else
+    GMX_UNUSED_VALUE(sendPtr);
+    GMX_UNUSED_VALUE(sendSize);
+    GMX_UNUSED_VALUE(sendRank);
+    GMX_UNUSED_VALUE(recvPtr);
+    GMX_UNUSED_VALUE(recvSize);
+    GMX_UNUSED_VALUE(recvRank);
+#endif
 }
 
 void GpuHaloExchange::Impl::communicateHaloDataWithCudaDirect(void* sendPtr,
@@ -479,8 +540,8 @@ GpuHaloExchange::Impl::Impl(gmx_domdec_t*        dd,
     wcycle_(wcycle)
 {
 
-    GMX_RELEASE_ASSERT(GMX_THREAD_MPI,
-                       "GPU Halo exchange is currently only supported with thread-MPI enabled");
+    GMX_RELEASE_ASSERT(GMX_THREAD_MPI || GMX_LIB_MPI,
+                       "GPU Halo exchange requires thread-MPI or a CUDA-aware MPI library");
 
     if (usePBC_ && dd->unitCellInfo.haveScrewPBC)
     {
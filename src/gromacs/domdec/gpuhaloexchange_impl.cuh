@@ -134,6 +134,21 @@ private:
      */
     void communicateHaloDataWithCudaDirect(void* sendPtr, int sendSize, int sendRank, void* remotePtr, int recvRank);
 
+    /*! \brief Data transfer for GPU halo exchange using CUDA-aware MPI
+     * \param [in] sendPtr       address to send data from
+     * \param [in] sendSize      number of atoms to be sent
+     * \param [in] sendRank      rank to send data to
+     * \param [in] recvPtr       address to recv data into
+     * \param [in] recvSize      number of atoms to be received
+     * \param [in] recvRank      rank to recv data from
+     */
+    void communicateHaloDataWithCudaMPI(void* sendPtr,
+                                        int   sendSize,
+                                        int   sendRank,
+                                        void* recvPtr,
+                                        int   recvSize,
+                                        int   recvRank);
+
     //! Domain decomposition object
     gmx_domdec_t* dd_ = nullptr;
     //! map of indices to be sent from this rank
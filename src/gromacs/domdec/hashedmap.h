@@ -50,12 +50,14 @@
 #include <climits>
 
 #include <algorithm>
+#include <limits>
 #include <utility>
 #include <vector>
 
 #include "gromacs/compat/utility.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
 
 namespace gmx
 {
@@ -65,6 +67,14 @@ namespace gmx
  * Efficiently manages mapping from integer keys to values.
  * Note that this basically implements a subset of the functionality of
  * std::unordered_map, but is an order of magnitude faster.
+ *
+ * The keys and values are stored in a single open-addressing table with
+ * linear probing using Robin Hood insertion: an entry that is further away
+ * from its hashed position takes the place of an entry that is closer.
+ * This keeps probe sequences short and allows lookups of keys that are
+ * not present to stop early. Erasing shifts the following entries back,
+ * so no tombstones are needed. All entries with the same hash are
+ * contiguous in memory, which gives good cache locality.
  */
 template<class T>
 class HashedMap
@@ -73,17 +83,33 @@ private:
     /*! \libinternal \brief Structure for the key/value hash table */
     struct hashEntry
     {
-        int key = -1;  /**< The key */
-        T   value;     /**< The value(s) */
-        int next = -1; /**< Index in the list of the next element with the same hash, -1 if none */
+        int key = c_emptyKey; /**< The key, c_emptyKey when the entry is not in use */
+        T   value;            /**< The value(s) */
     };
 
+    /*! \brief Key value that signals an unused table entry */
+    static constexpr int c_emptyKey = std::numeric_limits<int>::min();
     /*! \brief The table size is set to at least this factor time the nr of keys */
-    static constexpr float c_relTableSizeSetMin = 1.5;
-    /*! \brief Threshold for increasing the table size */
-    static constexpr float c_relTableSizeThresholdMin = 1.3;
-    /*! \brief Threshold for decreasing the table size */
-    static constexpr float c_relTableSizeThresholdMax = 3.5;
+    static constexpr float c_relTableSizeSetMin = 2.0;
+    /*! \brief Threshold for increasing the table size in clear() */
+    static constexpr float c_relTableSizeThresholdMin = 1.6;
+    /*! \brief Threshold for decreasing the table size in clear() */
+    static constexpr float c_relTableSizeThresholdMax = 4.5;
+    /*! \brief Threshold for doubling the table size on insertion, limits the probe lengths */
+    static constexpr float c_relTableSizeInsertMin = 1.25;
+
+    /*! \brief Sets the table size and clears all entries
+     *
+     * \param[in] tableSize  The table size, should be a power of 2
+     */
+    void setTableSize(int tableSize)
+    {
+        table_.assign(tableSize, hashEntry());
+
+        /* Table size is a power of 2, so a binary mask gives the hash */
+        bitMask_     = tableSize - 1;
+        numElements_ = 0;
+    }
 
     /*! \brief Resizes the table
      *
@@ -93,26 +119,39 @@ private:
     {
         GMX_RELEASE_ASSERT(numElements_ == 0, "Table needs to be empty for resize");
 
-        /* The fraction of table entries with 0   size lists is e^-f.
-         * The fraction of table entries with >=1 size lists is 1 - e^-f
-         * where f is: the #elements / tableSize
-         * The fraction of elements not in the direct list is: 1 - (1 - e^-f)/f.
-         * Thus the optimal table size is roughly double #elements.
+        /* With linear probing the expected number of probes for a key
+         * that is not present grows rapidly with the occupancy, so we
+         * make the hash table a power of 2 and at least double #elements.
          */
-        /* Make the hash table a power of 2 and at least 1.5 * #elements */
         int tableSize = 64;
         while (tableSize <= INT_MAX / 2
                && static_cast<float>(numElementsEstimate) * c_relTableSizeSetMin > tableSize)
         {
             tableSize *= 2;
         }
-        table_.resize(tableSize);
+        setTableSize(tableSize);
+    }
 
-        /* Table size is a power of 2, so a binary mask gives the hash */
-        bitMask_                        = tableSize - 1;
-        startIndexForSpaceForListEntry_ = tableSize;
+    /*! \brief Doubles the table size, keeping all the entries */
+    void grow()
+    {
+        std::vector<hashEntry> oldTable;
+        oldTable.swap(table_);
+
+        setTableSize(2 * static_cast<int>(oldTable.size()));
+
+        for (const hashEntry& entry : oldTable)
+        {
+            if (entry.key != c_emptyKey)
+            {
+                insert_assign<false>(entry.key, entry.value);
+            }
+        }
     }
 
+    /*! \brief Returns the distance of table index \p index from the hashed index of \p key */
+    int probeDistance(int key, int index) const { return (index - (key & bitMask_)) & bitMask_; }
+
 public:
     /*! \brief Constructor
      *
@@ -136,73 +175,81 @@ private:
      * \tparam    allowAssign  Sets whether assignment of a key that is present is allowed
      * \param[in] key          The key for the entry
      * \param[in] value        The value for the entry
-     * \throws InvalidInputError from a debug build when attempting to insert a duplicate key with \p allowAssign=true
+     * \throws InvalidInputError from a debug build when attempting to insert a duplicate key with \p allowAssign=false
      */
     // cppcheck-suppress unusedPrivateFunction
     template<bool allowAssign>
     void insert_assign(int key, const T& value)
     {
-        size_t ind = (key & bitMask_);
+        GMX_ASSERT(key != c_emptyKey, "The key should not be the empty key value");
 
-        if (table_[ind].key >= 0)
+        if (static_cast<float>(numElements_ + 1) * c_relTableSizeInsertMin > bucket_count())
         {
-            /* Loop over the entries for this hash.
-             * If we find the matching key, return the value.
-             */
-            int ind_prev = ind;
-            if (table_[ind_prev].key == key)
+            grow();
+        }
+
+        hashEntry entry;
+        entry.key   = key;
+        entry.value = value;
+
+        int ind      = (key & bitMask_);
+        int distance = 0;
+        while (table_[ind].key != c_emptyKey)
+        {
+            hashEntry& tableEntry = table_[ind];
+            if (tableEntry.key == entry.key)
             {
-                if (allowAssign)
-                {
-                    table_[ind].value = value;
-                    return;
-                }
-                else
+                /* Note that after the first swap below entry.key can not
+                 * match any more, since all keys in the table are unique.
+                 */
+                if (!allowAssign)
                 {
 // Note: This is performance critical, so we only throw in debug mode
 #ifndef NDEBUG
                     GMX_THROW(InvalidInputError("Attempt to insert duplicate key"));
 #endif
                 }
+                tableEntry.value = entry.value;
+                return;
             }
-            while (table_[ind_prev].next >= 0)
+            /* Robin Hood: take the place of an entry closer to its hash */
+            const int tableEntryDistance = probeDistance(tableEntry.key, ind);
+            if (tableEntryDistance < distance)
             {
-                ind_prev = table_[ind_prev].next;
-                if (table_[ind_prev].key == key)
-                {
-                    if (allowAssign)
-                    {
-                        table_[ind_prev].value = value;
-                        return;
-                    }
-                    else
-                    {
-#ifndef NDEBUG
-                        GMX_THROW(InvalidInputError("Attempt to insert duplicate key"));
-#endif
-                    }
-                }
+                std::swap(entry, tableEntry);
+                distance = tableEntryDistance;
             }
-            /* Search for space in table_ */
-            ind = startIndexForSpaceForListEntry_;
-            while (ind < table_.size() && table_[ind].key >= 0)
+            ind = ((ind + 1) & bitMask_);
+            distance++;
+        }
+
+        table_[ind] = entry;
+
+        numElements_ += 1;
+    }
+
+    /*! \brief Returns the table index of \p key, or -1 when not present */
+    int findIndex(int key) const
+    {
+        GMX_ASSERT(key != c_emptyKey, "The key should not be the empty key value");
+
+        int ind = (key & bitMask_);
+        for (int distance = 0;; distance++)
+        {
+            const int tableKey = table_[ind].key;
+            if (tableKey == key)
             {
-                ind++;
+                return ind;
             }
-            /* If we are at the end of the list we need to increase the size */
-            if (ind == table_.size())
+            /* With Robin Hood ordering our key can not be beyond an entry
+             * that is closer to its hashed index than we are.
+             */
+            if (tableKey == c_emptyKey || probeDistance(tableKey, ind) < distance)
             {
-                table_.resize(table_.size() + 1);
+                return -1;
             }
-            table_[ind_prev].next = ind;
-
-            startIndexForSpaceForListEntry_ = ind + 1;
+            ind = ((ind + 1) & bitMask_);
         }
-
-        table_[ind].key   = key;
-        table_[ind].value = value;
-
-        numElements_ += 1;
     }
 
 public:
@@ -210,7 +257,8 @@ public:
      *
      * \param[in] key    The key for the entry
      * \param[in] value  The value for the entry
-     * \throws InvalidInputError from a debug build when attempting to inser         */
+     * \throws InvalidInputError from a debug build when attempting to insert a duplicate key
+     */
     void insert(int key, const T& value) { insert_assign<false>(key, value); }
 
     /*! \brief Inserts an entry when the key is not present, otherwise sets the value
@@ -226,34 +274,25 @@ public:
      */
     void erase(int key)
     {
-        int ind_prev = -1;
-        int ind      = (key & bitMask_);
-        do
+        int ind = findIndex(key);
+        if (ind < 0)
         {
-            if (table_[ind].key == key)
-            {
-                if (ind_prev >= 0)
-                {
-                    table_[ind_prev].next = table_[ind].next;
-
-                    /* This index is a linked entry, so we free an entry.
-                     * Check if we are creating the first empty space.
-                     */
-                    if (ind < startIndexForSpaceForListEntry_)
-                    {
-                        startIndexForSpaceForListEntry_ = ind;
-                    }
-                }
-                table_[ind].key  = -1;
-                table_[ind].next = -1;
+            return;
+        }
 
-                numElements_ -= 1;
+        /* Shift the following entries that are not at their hashed index
+         * back by one, so the probe sequences stay contiguous.
+         */
+        int next = ((ind + 1) & bitMask_);
+        while (table_[next].key != c_emptyKey && probeDistance(table_[next].key, next) > 0)
+        {
+            table_[ind] = table_[next];
+            ind         = next;
+            next        = ((next + 1) & bitMask_);
+        }
+        table_[ind].key = c_emptyKey;
 
-                return;
-            }
-            ind_prev = ind;
-            ind      = table_[ind].next;
-        } while (ind >= 0);
+        numElements_ -= 1;
     }
 
     /*! \brief Returns a pointer to the value for the given key or nullptr when not present
@@ -272,17 +311,9 @@ public:
      */
     const T* find(int key) const
     {
-        int ind = (key & bitMask_);
-        do
-        {
-            if (table_[ind].key == key)
-            {
-                return &table_[ind].value;
-            }
-            ind = table_[ind].next;
-        } while (ind >= 0);
+        const int ind = findIndex(key);
 
-        return nullptr;
+        return (ind >= 0 ? &table_[ind].value : nullptr);
     }
 
     /*! \brief Clear all the entries in the list
@@ -296,11 +327,9 @@ public:
 
         for (hashEntry& entry : table_)
         {
-            entry.key  = -1;
-            entry.next = -1;
+            entry.key = c_emptyKey;
         }
-        startIndexForSpaceForListEntry_ = bucket_count();
-        numElements_                    = 0;
+        numElements_ = 0;
 
         /* Resize the hash table when the occupation is far from optimal.
          * Do not resize with 0 elements to avoid minimal size when clear()
@@ -319,8 +348,6 @@ private:
     std::vector<hashEntry> table_;
     /*! \brief The bit mask for computing the hash of a key */
     int bitMask_ = 0;
-    /*! \brief Index in table_ at which to start looking for empty space for a new linked list entry */
-    int startIndexForSpaceForListEntry_ = 0;
     /*! \brief The number of elements currently stored in the table */
     int numElements_ = 0;
 };
@@ -598,20 +598,26 @@ static void check_index_consistency(const gmx_domdec_t* dd, int natoms_sys, cons
     }
 }
 
-//! Clear all DD global state indices
-static void clearDDStateIndices(gmx_domdec_t* dd, const bool keepLocalAtomIndices)
+/*! \brief Clear the DD global state indices
+ *
+ * With \p keepHomeAtomIndices the global to local indices of the home atoms
+ * are kept, so these only need to be updated for atoms that change index
+ * during repartitioning.
+ */
+static void clearDDStateIndices(gmx_domdec_t* dd, const bool keepHomeAtomIndices)
 {
     gmx_ga2la_t& ga2la = *dd->ga2la;
 
-    if (!keepLocalAtomIndices)
+    if (!keepHomeAtomIndices)
     {
         /* Clear the whole list without the overhead of searching */
         ga2la.clear();
     }
     else
     {
+        const int numHomeAtoms    = dd->comm->atomRanges.numHomeAtoms();
         const int numAtomsInZones = dd->comm->atomRanges.end(DDAtomRanges::Type::Zones);
-        for (int i = 0; i < numAtomsInZones; i++)
+        for (int i = numHomeAtoms; i < numAtomsInZones; i++)
         {
             ga2la.erase(dd->globalAtomIndices[i]);
         }
@@ -957,9 +963,7 @@ static float dd_force_load_fraction(gmx_domdec_t* dd)
     }
 }
 
-/*! \brief Return the relative performance loss on the total run time
- * due to the force calculation load imbalance. */
-static float dd_force_imb_perf_loss(gmx_domdec_t* dd)
+float dd_force_imb_perf_loss(const gmx_domdec_t* dd)
 {
     if (dd->comm->nload > 0 && dd->comm->load_step > 0)
     {
@@ -1249,7 +1253,7 @@ static void turn_on_dlb(const gmx::MDLogger& mdlog, gmx_domdec_t* dd, int64_t st
 
     /* We can set the required cell size info here,
      * so we do not need to communicate this.
-     * The grid is completely uniform.
+     * The grid is uniform, or set by the static cell size fractions.
      */
     for (int d = 0; d < dd->ndim; d++)
     {
@@ -1259,14 +1263,18 @@ static void turn_on_dlb(const gmx::MDLogger& mdlog, gmx_domdec_t* dd, int64_t st
         {
             comm->load[d].sum_m = comm->load[d].sum;
 
-            int nc = dd->numCells[dd->dim[d]];
+            const int   dim     = dd->dim[d];
+            const int   nc      = dd->numCells[dim];
+            const real* slbFrac = comm->slb_frac[dim];
+            rowMaster->cellFrac[0] = 0;
             for (int i = 0; i < nc; i++)
             {
-                rowMaster->cellFrac[i] = i / static_cast<real>(nc);
+                const real cellFraction = (slbFrac ? slbFrac[i] : 1 / static_cast<real>(nc));
+                rowMaster->cellFrac[i + 1] = rowMaster->cellFrac[i] + cellFraction;
                 if (d > 0)
                 {
-                    rowMaster->bounds[i].cellFracLowerMax = i / static_cast<real>(nc);
-                    rowMaster->bounds[i].cellFracUpperMin = (i + 1) / static_cast<real>(nc);
+                    rowMaster->bounds[i].cellFracLowerMax = rowMaster->cellFrac[i];
+                    rowMaster->bounds[i].cellFracUpperMin = rowMaster->cellFrac[i + 1];
                 }
             }
             rowMaster->cellFrac[nc] = 1.0;
@@ -2439,35 +2447,44 @@ static void set_zones_size(gmx_domdec_t*      dd,
 
 /*! \brief Order data in \p dataToSort according to \p sort
  *
- * Note: both buffers should have at least \p sort.size() elements.
+ * The first \p numInPlace entries of \p sort should refer to themselves,
+ * these elements are left untouched.
+ *
+ * Note: \p dataToSort should have at least \p sort.size() elements,
+ *       \p sortBuffer at least \p sort.size() - \p numInPlace elements.
  */
 template<typename T>
 static void orderVector(gmx::ArrayRef<const gmx_cgsort_t> sort,
+                        const int                         numInPlace,
                         gmx::ArrayRef<T>                  dataToSort,
                         gmx::ArrayRef<T>                  sortBuffer)
 {
     GMX_ASSERT(dataToSort.size() >= sort.size(), "The vector needs to be sufficiently large");
-    GMX_ASSERT(sortBuffer.size() >= sort.size(),
+    GMX_ASSERT(sortBuffer.ssize() >= sort.ssize() - numInPlace,
                "The sorting buffer needs to be sufficiently large");
 
     /* Order the data into the temporary buffer */
     size_t i = 0;
-    for (const gmx_cgsort_t& entry : sort)
+    for (const gmx_cgsort_t& entry : sort.subArray(numInPlace, sort.ssize() - numInPlace))
     {
         sortBuffer[i++] = dataToSort[entry.ind];
     }
 
     /* Copy back to the original array */
-    std::copy(sortBuffer.begin(), sortBuffer.begin() + sort.size(), dataToSort.begin());
+    std::copy(sortBuffer.begin(), sortBuffer.begin() + i, dataToSort.begin() + numInPlace);
 }
 
 /*! \brief Order data in \p dataToSort according to \p sort
+ *
+ * The first \p numInPlace entries of \p sort should refer to themselves,
+ * these elements are left untouched.
  *
  * Note: \p vectorToSort should have at least \p sort.size() elements,
  *       \p workVector is resized when it is too small.
  */
 template<typename T>
 static void orderVector(gmx::ArrayRef<const gmx_cgsort_t> sort,
+                        const int                         numInPlace,
                         gmx::ArrayRef<T>                  vectorToSort,
                         std::vector<T>*                   workVector)
 {
@@ -2475,7 +2492,7 @@ static void orderVector(gmx::ArrayRef<const gmx_cgsort_t> sort,
     {
         workVector->resize(sort.size());
     }
-    orderVector<T>(sort, vectorToSort, *workVector);
+    orderVector<T>(sort, numInPlace, vectorToSort, *workVector);
 }
 
 //! Returns the sorting order for atoms based on the nbnxn grid order in sort
@@ -2519,23 +2536,32 @@ static void dd_sort_state(gmx_domdec_t* dd, t_forcerec* fr, t_state* state)
     gmx::ArrayRef<const gmx_cgsort_t> cgsort = sort->sorted;
     GMX_RELEASE_ASSERT(cgsort.ssize() == dd->ncg_home, "We should sort all the home atom groups");
 
+    /* Atoms that precede all changes in the order keep their place,
+     * so we only need to reorder the remainder.
+     */
+    int numInPlace = 0;
+    while (numInPlace < cgsort.ssize() && cgsort[numInPlace].ind == numInPlace)
+    {
+        numInPlace++;
+    }
+
     if (state->flags & (1 << estX))
     {
-        orderVector(cgsort, makeArrayRef(state->x), rvecBuffer.buffer);
+        orderVector(cgsort, numInPlace, makeArrayRef(state->x), rvecBuffer.buffer);
     }
     if (state->flags & (1 << estV))
     {
-        orderVector(cgsort, makeArrayRef(state->v), rvecBuffer.buffer);
+        orderVector(cgsort, numInPlace, makeArrayRef(state->v), rvecBuffer.buffer);
     }
     if (state->flags & (1 << estCGP))
     {
-        orderVector(cgsort, makeArrayRef(state->cg_p), rvecBuffer.buffer);
+        orderVector(cgsort, numInPlace, makeArrayRef(state->cg_p), rvecBuffer.buffer);
     }
 
     /* Reorder the global cg index */
-    orderVector<int>(cgsort, dd->globalAtomGroupIndices, &sort->intBuffer);
+    orderVector<int>(cgsort, numInPlace, dd->globalAtomGroupIndices, &sort->intBuffer);
     /* Reorder the cginfo */
-    orderVector<int>(cgsort, fr->cginfo, &sort->intBuffer);
+    orderVector<int>(cgsort, numInPlace, fr->cginfo, &sort->intBuffer);
     /* Set the home atom number */
     dd->comm->atomRanges.setEnd(DDAtomRanges::Type::Home, dd->ncg_home);
 
@@ -2543,6 +2569,40 @@ static void dd_sort_state(gmx_domdec_t* dd, t_forcerec* fr, t_state* state)
     fr->nbv->setLocalAtomOrder();
 }
 
+/*! \brief Updates the global to local and local to global indices of the home atoms after sorting
+ *
+ * Only the entries of atoms that changed local index are updated and
+ * entries for atoms that arrived from other domains are inserted.
+ * Entries of atoms that left this domain should already have been removed.
+ *
+ * \param[in,out] dd                    The domain decomposition struct
+ * \param[in]     numOldAtomsWithIndex  The number of home atoms before redistribution
+ *                                      that had valid indices before sorting
+ */
+static void updateHomeAtomIndicesAfterSort(gmx_domdec_t* dd, const int numOldAtomsWithIndex)
+{
+    gmx::ArrayRef<const gmx_cgsort_t> cgsort                 = dd->comm->sort->sorted;
+    gmx::ArrayRef<const int>          globalAtomGroupIndices = dd->globalAtomGroupIndices;
+    std::vector<int>&                 globalAtomIndices      = dd->globalAtomIndices;
+    gmx_ga2la_t&                      ga2la                  = *dd->ga2la;
+
+    globalAtomIndices.resize(dd->ncg_home);
+    for (int a = 0; a < dd->ncg_home; a++)
+    {
+        const int oldIndex    = cgsort[a].ind;
+        const int globalIndex = globalAtomGroupIndices[a];
+        globalAtomIndices[a]  = globalIndex;
+        if (oldIndex >= numOldAtomsWithIndex)
+        {
+            ga2la.insert(globalIndex, { a, 0 });
+        }
+        else if (oldIndex != a)
+        {
+            ga2la.at(globalIndex).la = a;
+        }
+    }
+}
+
 //! Accumulates load statistics.
 static void add_dd_statistics(gmx_domdec_t* dd)
 {
@@ -2909,7 +2969,7 @@ void dd_partition_system(FILE*                     fplog,
 
         /* Clear the non-home indices */
         clearDDStateIndices(dd, true);
-        ncgindex_set = 0;
+        ncgindex_set = dd->ncg_home;
 
         /* To avoid global communication, we do not recompute the extent
          * of the system for dims without pbc. Therefore we need to copy
@@ -2955,7 +3015,7 @@ void dd_partition_system(FILE*                     fplog,
     {
         wallcycle_sub_start(wcycle, ewcsDD_REDIST);
 
-        ncgindex_set = dd->ncg_home;
+        GMX_ASSERT(ncgindex_set == dd->ncg_home, "All home atoms should have valid indices");
         dd_redistribute_cg(fplog, step, dd, ddbox.tric_dir, state_local, fr, nrnb, &ncg_moved);
 
         GMX_RELEASE_ASSERT(bSortCG, "Sorting is required after redistribution");
@@ -3012,9 +3072,9 @@ void dd_partition_system(FILE*                     fplog,
         /* After sorting and compacting we set the correct size */
         state_change_natoms(state_local, comm->atomRanges.numHomeAtoms());
 
-        /* Rebuild all the indices */
-        dd->ga2la->clear();
-        ncgindex_set = 0;
+        /* Update the indices of the atoms that changed place or arrived */
+        updateHomeAtomIndicesAfterSort(dd, ncgindex_set);
+        ncgindex_set = dd->ncg_home;
 
         wallcycle_sub_stop(wcycle, ewcsDD_GRID);
     }
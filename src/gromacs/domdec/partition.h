@@ -78,6 +78,14 @@ class VirtualSitesHandler;
 //! Check whether the DD grid has moved too far for correctness.
 bool check_grid_jump(int64_t step, const gmx_domdec_t* dd, real cutoff, const gmx_ddbox_t* ddbox, gmx_bool bFatal);
 
+/*! \brief Return the relative performance loss on the total run time
+ * due to the force calculation load imbalance.
+ *
+ * Returns 0 when no loads were measured. Only the DD master rank
+ * has the load statistics.
+ */
+float dd_force_imb_perf_loss(const gmx_domdec_t* dd);
+
 /*! \brief Print statistics for domain decomposition communication */
 void print_dd_statistics(const t_commrec* cr, const t_inputrec* ir, FILE* fplog);
 
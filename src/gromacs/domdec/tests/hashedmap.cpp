@@ -163,6 +163,66 @@ TEST(HashedMap, LinkedEntries)
     checkFinds(map, 3 + 2 * largePowerOf2, 'c');
 }
 
+// Check that entries displaced by probing into the slots of other
+// hashes are found and survive erasing of the entries in front of them
+TEST(HashedMap, DisplacedEntries)
+{
+    gmx::HashedMap<char> map(20);
+
+    const int largePowerOf2 = 2048;
+
+    // Three keys with hash 3 occupy the slots of hashes 4 and 5
+    map.insert(3 + 0 * largePowerOf2, 'a');
+    map.insert(3 + 1 * largePowerOf2, 'b');
+    map.insert(3 + 2 * largePowerOf2, 'c');
+    map.insert(4, 'd');
+    map.insert(5, 'e');
+
+    checkFinds(map, 3 + 0 * largePowerOf2, 'a');
+    checkFinds(map, 3 + 1 * largePowerOf2, 'b');
+    checkFinds(map, 3 + 2 * largePowerOf2, 'c');
+    checkFinds(map, 4, 'd');
+    checkFinds(map, 5, 'e');
+    checkDoesNotFind(map, 3 + 3 * largePowerOf2);
+    checkDoesNotFind(map, 4 + largePowerOf2);
+
+    map.erase(3 + 0 * largePowerOf2);
+    map.erase(4);
+
+    checkDoesNotFind(map, 3 + 0 * largePowerOf2);
+    checkFinds(map, 3 + 1 * largePowerOf2, 'b');
+    checkFinds(map, 3 + 2 * largePowerOf2, 'c');
+    checkDoesNotFind(map, 4);
+    checkFinds(map, 5, 'e');
+    EXPECT_EQ(map.size(), 3);
+
+    // Erasing a key that is not present should not change the map
+    map.erase(6);
+    EXPECT_EQ(map.size(), 3);
+    checkFinds(map, 5, 'e');
+}
+
+// Check that the table grows when inserting many elements
+TEST(HashedMap, GrowsTableOnInsertion)
+{
+    gmx::HashedMap<char> map(1);
+
+    const int initialBucketCount = map.bucket_count();
+    const int numElements        = 4 * initialBucketCount;
+    for (int i = 0; i < numElements; i++)
+    {
+        map.insert(7 * i, static_cast<char>('a' + i % 26));
+    }
+    EXPECT_GT(map.bucket_count(), numElements);
+    EXPECT_EQ(map.size(), numElements);
+
+    for (int i = 0; i < numElements; i++)
+    {
+        checkFinds(map, 7 * i, static_cast<char>('a' + i % 26));
+    }
+    checkDoesNotFind(map, 7 * numElements);
+}
+
 // HashedMap only throws in debug mode, so only test in debug mode
 #ifndef NDEBUG
 
@@ -185,13 +245,15 @@ TEST(HashedMap, ResizesTable)
     // This test assumes the minimum bucket count is 64 or less
     EXPECT_LT(map.bucket_count(), 128);
 
-    for (int i = 0; i < 60; i++)
+    // Insert enough elements to trigger a resize in clear(),
+    // but few enough to not trigger growing on insertion
+    for (int i = 0; i < 45; i++)
     {
         map.insert(2 * i + 3, 'a');
     }
     EXPECT_LT(map.bucket_count(), 128);
 
-    // Check that the table size is double #elements after clear()
+    // Check that the table size is at least double #elements after clear()
     map.clear();
     EXPECT_EQ(map.bucket_count(), 128);
 
@@ -462,6 +462,37 @@ void project_to_eigvectors(rvec* x, t_eigvec* vec, const t_edpar& edi)
         rvec_inc(x[i], edi.sav.x[i]);
     }
 }
+
+/*!\brief Projects coordinates onto eigenvectors in parallel and stores result in vec->xproj.
+ * Each rank only projects the positions of its local atoms and the projections are
+ * summed over the ranks, which avoids every rank projecting all positions.
+ * \param[in] x The collective coordinates, of which only the local ones are used
+ * \param[in,out] vec The eigenvectors
+ * \param[in] edi essential dynamics parameters holding average structure and masses
+ * \param[in] cr Communication record
+ */
+void project_local_atoms_to_eigvectors(const rvec* x, t_eigvec* vec, const t_edpar& edi, const t_commrec* cr)
+{
+    if (!vec->neig)
+    {
+        return;
+    }
+
+    for (int i = 0; i < vec->neig; i++)
+    {
+        real proj = 0.0;
+        for (int j = 0; j < edi.sav.nr_loc; j++)
+        {
+            const int c = edi.sav.c_ind[j];
+            rvec      dx;
+            rvec_sub(x[c], edi.sav.x[c], dx);
+            proj += edi.sav.sqrtm[c] * iprod(vec->vec[i][c], dx);
+        }
+        vec->xproj[i] = proj;
+    }
+
+    gmx_sum(vec->neig, vec->xproj, cr);
+}
 } // namespace
 
 /* Project vector x onto all edi->vecs (mon, linfix,...) */
@@ -959,7 +990,14 @@ static void do_single_flood(FILE*            edo,
     translate_and_rotate(buf->xcoll, edi->sav.nr, transvec, rotmat);
 
     /* Project fitted structure onto supbspace -> store in edi->flood.vecs.xproj */
-    project_to_eigvectors(buf->xcoll, &edi->flood.vecs, *edi);
+    if (PAR(cr))
+    {
+        project_local_atoms_to_eigvectors(buf->xcoll, &edi->flood.vecs, *edi, cr);
+    }
+    else
+    {
+        project_to_eigvectors(buf->xcoll, &edi->flood.vecs, *edi);
+    }
 
     if (!edi->flood.bConstForce)
     {
@@ -0,0 +1,501 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ * \brief
+ * Implements the PME kernel benchmark.
+ *
+ * \ingroup module_ewald
+ */
+
+#include "gmxpre.h"
+
+#include "pme_bench.h"
+
+#include "config.h"
+
+#include <memory>
+#include <random>
+
+#include "gromacs/domdec/domdec.h"
+#include "gromacs/ewald/ewald_utils.h"
+#include "gromacs/ewald/pme.h"
+#include "gromacs/ewald/pme_gpu_internal.h"
+#include "gromacs/ewald/pme_gpu_program.h"
+#include "gromacs/ewald/pme_internal.h"
+#include "gromacs/fft/fft.h"
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/gpu_utils/device_stream_manager.h"
+#include "gromacs/hardware/device_information.h"
+#include "gromacs/hardware/device_management.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/simulation_workload.h"
+#include "gromacs/mdtypes/state_propagator_data_gpu.h"
+#include "gromacs/timing/cyclecounter.h"
+#include "gromacs/timing/wallcycle.h"
+#include "gromacs/timing/walltime_accounting.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/logger.h"
+#include "gromacs/utility/stringutil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! The relative tolerance used to set the Ewald coefficient from the cut-off
+constexpr real c_ewaldRTol = 1e-5;
+
+//! One benchmark setup
+struct PmeBenchSetup
+{
+    //! The number of grid points along each box vector
+    int gridSize;
+    //! The PME interpolation order
+    int pmeOrder;
+    //! The number of atoms
+    int numAtoms;
+};
+
+//! The times in microseconds per iteration for one setup
+struct PmeBenchResult
+{
+    //! The setup that was run
+    PmeBenchSetup setup;
+    //! Spline computation and spreading
+    double spread = 0;
+    //! Forward and backward FFT
+    double fft = 0;
+    //! Solve in reciprocal space
+    double solve = 0;
+    //! Force gathering
+    double gather = 0;
+    //! The whole PME computation
+    double total = 0;
+};
+
+//! Returns the edge length of the cubic box for \p setup
+real boxSize(const PmeBenchOptions& options, const PmeBenchSetup& setup)
+{
+    return setup.gridSize * options.gridSpacing;
+}
+
+//! Sets up \p ir for a Coulomb PME calculation with \p setup
+void setInputRec(const PmeBenchSetup& setup, t_inputrec* ir)
+{
+    ir->coulombtype = eelPME;
+    ir->nkx         = setup.gridSize;
+    ir->nky         = setup.gridSize;
+    ir->nkz         = setup.gridSize;
+    ir->pme_order   = setup.pmeOrder;
+    ir->epsilon_r   = 1;
+}
+
+//! Generates uniformly distributed atoms with alternating charges in the box for \p setup
+void generateSystem(const PmeBenchOptions& options,
+                    const PmeBenchSetup&   setup,
+                    matrix                 box,
+                    std::vector<RVec>*     coordinates,
+                    std::vector<real>*     charges)
+{
+    const real size = boxSize(options, setup);
+    clear_mat(box);
+    box[XX][XX] = size;
+    box[YY][YY] = size;
+    box[ZZ][ZZ] = size;
+
+    // A fixed seed gives the same system for every run
+    std::mt19937                         rng(setup.numAtoms);
+    std::uniform_real_distribution<real> position(0, size);
+    coordinates->resize(setup.numAtoms);
+    charges->resize(setup.numAtoms);
+    for (int i = 0; i < setup.numAtoms; i++)
+    {
+        (*coordinates)[i] = { position(rng), position(rng), position(rng) };
+        (*charges)[i]     = (i % 2 == 0) ? 0.5 : -0.5;
+    }
+}
+
+//! Returns the work for a normal MD step, with energy and virial when requested
+StepWorkload makeStepWork(const PmeBenchOptions& options)
+{
+    StepWorkload stepWork;
+    stepWork.computeForces = true;
+    stepWork.computeEnergy = options.computeEnergy;
+    stepWork.computeVirial = options.computeEnergy;
+    return stepWork;
+}
+
+/*! \brief Runs PME on the CPU for \p setup and returns the times per iteration
+ *
+ * The same code as in mdrun is called and the stages are timed with the
+ * mdrun cycle counters, so the times correspond to the PME entries
+ * in the performance table of the mdrun log file.
+ */
+PmeBenchResult runCpu(const PmeBenchOptions& options,
+                      const PmeBenchSetup&   setup,
+                      double                 uSecPerCycle)
+{
+    t_inputrec ir;
+    setInputRec(setup, &ir);
+    matrix            box;
+    std::vector<RVec> coordinates;
+    std::vector<real> charges;
+    generateSystem(options, setup, box, &coordinates, &charges);
+    std::vector<RVec> forces(setup.numAtoms);
+
+    t_commrec      cr            = { 0 };
+    NumPmeDomains  numPmeDomains = { 1, 1 };
+    const MDLogger logger;
+    gmx_pme_t*     pme = gmx_pme_init(&cr, numPmeDomains, &ir, false, false, false,
+                                  calc_ewaldcoeff_q(options.cutoff, c_ewaldRTol), 0,
+                                  options.numThreads, PmeRunMode::CPU, nullptr, nullptr, nullptr,
+                                  nullptr, logger);
+    gmx_pme_reinit_atoms(pme, setup.numAtoms, charges.data(), nullptr, nullptr);
+
+    const StepWorkload stepWork = makeStepWork(options);
+    t_nrnb             nrnb;
+    matrix             virialQ, virialLJ;
+    real               energyQ, energyLJ, dvdlambdaQ, dvdlambdaLJ;
+
+    gmx_wallcycle_t wcycle = wallcycle_init(nullptr, 0, &cr);
+    if (wcycle == nullptr)
+    {
+        gmx_fatal(FARGS, "The PME benchmark requires cycle counters, which are not available");
+    }
+
+    for (int iter = 0; iter < options.numWarmupIterations + options.numIterations; iter++)
+    {
+        if (iter == options.numWarmupIterations)
+        {
+            wallcycle_reset_all(wcycle);
+        }
+        wallcycle_start(wcycle, ewcPMEMESH);
+        gmx_pme_do(pme, coordinates, forces, charges.data(), nullptr, nullptr, nullptr, nullptr,
+                   nullptr, box, &cr, 0, 0, &nrnb, wcycle, virialQ, virialLJ, &energyQ, &energyLJ,
+                   0, 0, &dvdlambdaQ, &dvdlambdaLJ, stepWork);
+        wallcycle_stop(wcycle, ewcPMEMESH);
+    }
+
+    const double uSecPerCycleIteration = uSecPerCycle / options.numIterations;
+    auto         cyclesOf              = [wcycle](int ewc) {
+        int    count;
+        double cycles;
+        wallcycle_get(wcycle, ewc, &count, &cycles);
+        return cycles;
+    };
+    PmeBenchResult result;
+    result.setup  = setup;
+    result.spread = cyclesOf(ewcPME_SPREAD) * uSecPerCycleIteration;
+    result.fft    = cyclesOf(ewcPME_FFT) * uSecPerCycleIteration;
+    result.solve  = cyclesOf(ewcPME_SOLVE) * uSecPerCycleIteration;
+    result.gather = cyclesOf(ewcPME_GATHER) * uSecPerCycleIteration;
+    result.total  = cyclesOf(ewcPMEMESH) * uSecPerCycleIteration;
+
+    wallcycle_destroy(wcycle);
+    gmx_pme_destroy(pme);
+
+    return result;
+}
+
+/*! \brief Runs PME on the GPU for \p setup and returns the times per iteration
+ *
+ * Each stage is launched separately and waited for, the time between
+ * the launch and the completion is measured on the host. This includes
+ * the launch overhead and, for the gather, the transfer of the forces
+ * to the host. The total is the sum of the stages.
+ */
+PmeBenchResult runGpu(const PmeBenchOptions&     options,
+                      const PmeBenchSetup&       setup,
+                      const DeviceStreamManager& deviceStreamManager,
+                      const PmeGpuProgram*       pmeGpuProgram)
+{
+    t_inputrec ir;
+    setInputRec(setup, &ir);
+    std::string      errorMessage;
+    if (!pme_gpu_supports_input(ir, &errorMessage))
+    {
+        gmx_fatal(FARGS, "PME on a GPU does not support this setup: %s", errorMessage.c_str());
+    }
+    matrix            box;
+    std::vector<RVec> coordinates;
+    std::vector<real> charges;
+    generateSystem(options, setup, box, &coordinates, &charges);
+
+    const DeviceContext& deviceContext = deviceStreamManager.context();
+    const DeviceStream&  deviceStream  = deviceStreamManager.stream(DeviceStreamType::Pme);
+
+    t_commrec      cr            = { 0 };
+    NumPmeDomains  numPmeDomains = { 1, 1 };
+    const MDLogger logger;
+    gmx_pme_t*     pme = gmx_pme_init(&cr, numPmeDomains, &ir, false, false, false,
+                                  calc_ewaldcoeff_q(options.cutoff, c_ewaldRTol), 0, 1,
+                                  PmeRunMode::GPU, nullptr, &deviceContext, &deviceStream,
+                                  pmeGpuProgram, logger);
+    gmx_pme_reinit_atoms(pme, setup.numAtoms, charges.data(), nullptr, nullptr);
+
+    StatePropagatorDataGpu stateGpu(&deviceStream, deviceContext, GpuApiCallBehavior::Sync,
+                                    pme_gpu_get_block_size(pme), nullptr);
+    stateGpu.reinit(setup.numAtoms, setup.numAtoms);
+    stateGpu.copyCoordinatesToGpu(coordinates, AtomLocality::All);
+    pme_gpu_set_device_x(pme, stateGpu.getCoordinates());
+
+    pme_gpu_prepare_computation(pme, box, nullptr, makeStepWork(options));
+
+    auto timeStage = [pme](auto&& launchStage) {
+        const double startTime = gmx_gettime();
+        launchStage();
+        pme_gpu_synchronize(pme->gpu);
+        return (gmx_gettime() - startTime) * 1e6;
+    };
+    // The FFT has no stub for builds without GPU support, where we never get here
+    auto launchFft = [pme](gmx_fft_direction direction) {
+#if GMX_GPU
+        pme_gpu_3dfft(pme->gpu, direction, 0);
+#else
+        GMX_UNUSED_VALUE(pme);
+        GMX_UNUSED_VALUE(direction);
+        GMX_RELEASE_ASSERT(false, "PME GPU FFT called without GPU support");
+#endif
+    };
+
+    PmeBenchResult result;
+    result.setup = setup;
+    for (int iter = 0; iter < options.numWarmupIterations + options.numIterations; iter++)
+    {
+        // Clears the grid and the energy and virial output
+        pme_gpu_reinit_computation(pme, nullptr);
+
+        const double spread =
+                timeStage([pme]() { pme_gpu_spread(pme->gpu, nullptr, nullptr, true, true, 1.0); });
+        double fft = timeStage([&]() { launchFft(GMX_FFT_REAL_TO_COMPLEX); });
+        const double solve = timeStage([&]() {
+            pme_gpu_solve(pme->gpu, 0, nullptr, GridOrdering::XYZ, options.computeEnergy);
+        });
+        fft += timeStage([&]() { launchFft(GMX_FFT_COMPLEX_TO_REAL); });
+        const double gather = timeStage([pme]() { pme_gpu_gather(pme->gpu, nullptr, 1.0); });
+
+        if (iter >= options.numWarmupIterations)
+        {
+            result.spread += spread / options.numIterations;
+            result.fft += fft / options.numIterations;
+            result.solve += solve / options.numIterations;
+            result.gather += gather / options.numIterations;
+        }
+    }
+    result.total = result.spread + result.fft + result.solve + result.gather;
+
+    gmx_pme_destroy(pme);
+
+    return result;
+}
+
+//! Selects and activates the GPU given by the options, returns its information
+DeviceInformation* selectGpu(const PmeBenchOptions&                           options,
+                             std::vector<std::unique_ptr<DeviceInformation>>* deviceInfoList)
+{
+    std::string errorMessage;
+    if (!pme_gpu_supports_build(&errorMessage))
+    {
+        gmx_fatal(FARGS, "PME cannot run on a GPU with this build: %s", errorMessage.c_str());
+    }
+    if (!canPerformDeviceDetection(&errorMessage))
+    {
+        gmx_fatal(FARGS, "Cannot detect GPUs: %s", errorMessage.c_str());
+    }
+    *deviceInfoList               = findDevices();
+    DeviceInformation* deviceInfo = nullptr;
+    for (auto& detectedDeviceInfo : *deviceInfoList)
+    {
+        if (detectedDeviceInfo->id == options.gpuId)
+        {
+            deviceInfo = detectedDeviceInfo.get();
+        }
+    }
+    if (deviceInfo == nullptr || !deviceIdIsCompatible(*deviceInfoList, options.gpuId))
+    {
+        gmx_fatal(FARGS,
+                  "GPU with ID %d was requested, but it was not detected or is not compatible",
+                  options.gpuId);
+    }
+    setActiveDevice(*deviceInfo);
+
+    return deviceInfo;
+}
+
+//! Returns all combinations of grid sizes, orders and atom counts in \p options
+std::vector<PmeBenchSetup> makeSetups(const PmeBenchOptions& options)
+{
+    std::vector<PmeBenchSetup> setups;
+    for (int gridSize : options.gridSizes)
+    {
+        for (int pmeOrder : options.pmeOrders)
+        {
+            PmeBenchSetup setup = { gridSize, pmeOrder, 0 };
+            if (options.atomCounts.empty())
+            {
+                const real size = boxSize(options, setup);
+                setup.numAtoms  = static_cast<int>(options.atomDensity * size * size * size);
+                setups.push_back(setup);
+            }
+            for (int numAtoms : options.atomCounts)
+            {
+                setup.numAtoms = numAtoms;
+                setups.push_back(setup);
+            }
+        }
+    }
+    return setups;
+}
+
+//! Returns \p input with the characters that need it escaped for use in a JSON string
+std::string jsonEscaped(const std::string& input)
+{
+    return replaceAll(replaceAll(input, "\\", "\\\\"), "\"", "\\\"");
+}
+
+//! Writes the settings and the results of all benchmark setups to a JSON file
+void writeJsonReport(const PmeBenchOptions&         options,
+                     const DeviceInformation*       deviceInfo,
+                     ArrayRef<const PmeBenchResult> results)
+{
+    FILE* fp = gmx_ffopen(options.jsonOutputFile, "w");
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"grid_spacing\": %g,\n", options.gridSpacing);
+    fprintf(fp, "  \"threads\": %d,\n", options.useGpu ? 1 : options.numThreads);
+    fprintf(fp, "  \"iterations\": %d,\n", options.numIterations);
+    fprintf(fp, "  \"compute_energy\": %s,\n", options.computeEnergy ? "true" : "false");
+    if (deviceInfo != nullptr)
+    {
+        fprintf(fp, "  \"gpu\": \"%s\",\n",
+                jsonEscaped(getDeviceInformationString(*deviceInfo)).c_str());
+    }
+    fprintf(fp, "  \"time_unit\": \"microseconds\",\n");
+    fprintf(fp, "  \"benchmarks\": [\n");
+    for (index i = 0; i < results.ssize(); i++)
+    {
+        const PmeBenchResult& result = results[i];
+
+        fprintf(fp, "    {\n");
+        fprintf(fp, "      \"grid\": %d,\n", result.setup.gridSize);
+        fprintf(fp, "      \"order\": %d,\n", result.setup.pmeOrder);
+        fprintf(fp, "      \"atoms\": %d,\n", result.setup.numAtoms);
+        fprintf(fp, "      \"spread\": %g,\n", result.spread);
+        fprintf(fp, "      \"fft\": %g,\n", result.fft);
+        fprintf(fp, "      \"solve\": %g,\n", result.solve);
+        fprintf(fp, "      \"gather\": %g,\n", result.gather);
+        fprintf(fp, "      \"total\": %g\n", result.total);
+        fprintf(fp, "    }%s\n", i + 1 < results.ssize() ? "," : "");
+    }
+    fprintf(fp, "  ]\n");
+    fprintf(fp, "}\n");
+
+    gmx_ffclose(fp);
+}
+
+} // namespace
+
+void pmeBench(const PmeBenchOptions& options)
+{
+    std::vector<std::unique_ptr<DeviceInformation>> deviceInfoList;
+    DeviceInformation*                               deviceInfo = nullptr;
+    std::unique_ptr<DeviceStreamManager>             deviceStreamManager;
+    PmeGpuProgramStorage                             pmeGpuProgram;
+    double                                           uSecPerCycle = 0;
+    if (options.useGpu)
+    {
+        deviceInfo = selectGpu(options, &deviceInfoList);
+
+        SimulationWorkload simulationWork;
+        simulationWork.useGpuPme = true;
+        deviceStreamManager =
+                std::make_unique<DeviceStreamManager>(*deviceInfo, false, simulationWork, false);
+        pmeGpuProgram = buildPmeGpuProgram(deviceStreamManager->context());
+    }
+    else
+    {
+        uSecPerCycle = gmx_cycles_calibrate(1.0) * 1e6;
+        if (uSecPerCycle <= 0)
+        {
+            gmx_fatal(FARGS, "Could not calibrate the cycle counter");
+        }
+    }
+
+    if (deviceInfo != nullptr)
+    {
+        fprintf(stdout, "Running PME on GPU %s\n", getDeviceInformationString(*deviceInfo).c_str());
+    }
+    else
+    {
+        fprintf(stdout, "Running PME on the CPU with %d OpenMP thread%s\n", options.numThreads,
+                options.numThreads > 1 ? "s" : "");
+    }
+    fprintf(stdout, "Times are in microseconds per iteration, averaged over %d iterations\n",
+            options.numIterations);
+    fprintf(stdout, "\n%5s %5s %9s %9s %9s %9s %9s %9s\n", "grid", "order", "atoms", "spread",
+            "fft", "solve", "gather", "total");
+
+    std::vector<PmeBenchResult> results;
+    for (const PmeBenchSetup& setup : makeSetups(options))
+    {
+        if (options.useGpu)
+        {
+            results.push_back(runGpu(options, setup, *deviceStreamManager, pmeGpuProgram.get()));
+        }
+        else
+        {
+            results.push_back(runCpu(options, setup, uSecPerCycle));
+        }
+        const PmeBenchResult& result = results.back();
+        fprintf(stdout, "%5d %5d %9d %9.1f %9.1f %9.1f %9.1f %9.1f\n", setup.gridSize,
+                setup.pmeOrder, setup.numAtoms, result.spread, result.fft, result.solve,
+                result.gather, result.total);
+    }
+
+    if (!options.jsonOutputFile.empty())
+    {
+        writeJsonReport(options, deviceInfo, results);
+    }
+}
+
+} // namespace gmx
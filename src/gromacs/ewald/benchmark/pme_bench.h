@@ -0,0 +1,96 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \libinternal \file
+ * \brief
+ * Declares the PME kernel benchmark that times the PME stages on a CPU or GPU.
+ *
+ * \inlibraryapi
+ * \ingroup module_ewald
+ */
+
+#ifndef GMX_EWALD_PME_BENCH_H
+#define GMX_EWALD_PME_BENCH_H
+
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+//! The options for the PME benchmark
+struct PmeBenchOptions
+{
+    //! The number of grid points along each box vector, one benchmark per entry
+    std::vector<int> gridSizes = { 32, 64 };
+    //! The PME interpolation orders to benchmark
+    std::vector<int> pmeOrders = { 4 };
+    //! The atom counts to benchmark, when empty set from the box volume and atomDensity
+    std::vector<int> atomCounts;
+    //! The grid spacing in nm, the cubic box edge is the grid size times this
+    real gridSpacing = 0.12;
+    //! The atom density in atoms/nm^3 used when no atom counts are given
+    real atomDensity = 100;
+    //! The Coulomb cut-off in nm, only used for setting the Ewald coefficient
+    real cutoff = 1.0;
+    //! The number of OpenMP threads to use with the CPU code
+    int numThreads = 1;
+    //! The number of timed iterations for each setup
+    int numIterations = 100;
+    //! The number of untimed iterations run before the timed ones
+    int numWarmupIterations = 10;
+    //! Whether to run PME on a GPU
+    bool useGpu = false;
+    //! The ID of the GPU to use
+    int gpuId = 0;
+    //! Whether to compute the energy and virial
+    bool computeEnergy = false;
+    //! Output file name for the JSON report, when empty no report is written
+    std::string jsonOutputFile;
+};
+
+/*! \brief Runs the PME benchmarks for all combinations of grid sizes, orders and atom counts
+ *
+ * For each setup the time per iteration of the spreading (including the
+ * spline computation), the forward plus backward 3D FFT, the solve and
+ * the gather stage is printed to stdout and optionally written to a JSON file.
+ */
+void pmeBench(const PmeBenchOptions& options);
+
+} // namespace gmx
+
+#endif
@@ -40,6 +40,12 @@
 
 #include <cmath>
 
+#include <array>
+#include <vector>
+
+#include "gromacs/math/functions.h"
+#include "gromacs/math/invertmatrix.h"
+#include "gromacs/math/units.h"
 #include "gromacs/math/utilities.h"
 #include "gromacs/utility/real.h"
 
@@ -113,3 +119,138 @@ real calc_ewaldcoeff_lj(real rc, real rtol)
     }
     return beta;
 }
+
+real estimateEwaldDirectSpaceForceError(real sumChargeSquared,
+                                        int  numCharges,
+                                        real volume,
+                                        real rc,
+                                        real ewaldcoeff)
+{
+    GMX_ASSERT(numCharges > 0, "Need charges to estimate the Ewald error");
+
+    real error = 2.0 * sumChargeSquared / std::sqrt(numCharges * rc * volume);
+    error *= std::exp(-gmx::square(ewaldcoeff * rc));
+
+    return ONE_4PI_EPS0 * error;
+}
+
+/*! \brief The number of aliasing images on each side used in the reciprocal-space estimate */
+static constexpr int c_numAliasingImages = 6;
+
+/*! \brief Grid vectors with larger beta-scaled norm do not contribute to the error estimate
+ *
+ * Each term is weighted by exp(-2 pi^2 k^2 / beta^2), beyond this exponent
+ * the terms are more than 40 orders of magnitude smaller than the largest one.
+ */
+static constexpr double c_maxReciprocalExponent = 50;
+
+/*! \brief Computes the B-spline aliasing sums for grid index \p m of a dimension with \p K lines
+ *
+ * Returns the first and second order sums in \p poly1 and \p poly2,
+ * as the eps_poly1 and eps_poly2 functions of gmx pme_error.
+ */
+static void bsplineAliasingSums(int m, int K, int order, real* poly1, real* poly2)
+{
+    if (m == 0)
+    {
+        *poly1 = 0;
+        *poly2 = 0;
+        return;
+    }
+
+    double sumImages       = 0;
+    double sumImagesSquare = 0;
+    for (int i = -c_numAliasingImages; i <= c_numAliasingImages; i++)
+    {
+        if (i != 0)
+        {
+            const double x = 2.0 * M_PI * (m / static_cast<double>(K) + i);
+            sumImages += std::pow(x, -order);
+            sumImagesSquare += std::pow(x, -2 * order);
+        }
+    }
+    const double sumAll = std::pow(2.0 * M_PI * m / static_cast<double>(K), -order) + sumImages;
+
+    *poly1 = -sumImages / sumAll;
+    *poly2 = sumImagesSquare / (sumAll * sumAll) + gmx::square(*poly1);
+}
+
+real estimatePmeReciprocalSpaceForceError(real         sumChargeSquared,
+                                          int          numCharges,
+                                          const matrix box,
+                                          const ivec   gridSize,
+                                          int          pmeOrder,
+                                          real         ewaldcoeff)
+{
+    GMX_ASSERT(numCharges > 0, "Need charges to estimate the PME error");
+
+    matrix recipBox;
+    gmx::invertBoxMatrix(box, recipBox);
+    const real volume = det(box);
+
+    /* The aliasing sums only depend on the index along one dimension */
+    std::array<std::vector<real>, DIM> poly1;
+    std::array<std::vector<real>, DIM> poly2;
+    for (int d = 0; d < DIM; d++)
+    {
+        poly1[d].resize(gridSize[d]);
+        poly2[d].resize(gridSize[d]);
+        for (int i = 0; i < gridSize[d]; i++)
+        {
+            const int m = (i <= gridSize[d] / 2 ? i : i - gridSize[d]);
+            bsplineAliasingSums(m, gridSize[d], pmeOrder, &poly1[d][i], &poly2[d][i]);
+        }
+        if (pmeOrder % 2 == 1 && gridSize[d] % 2 == 0)
+        {
+            /* With odd order the spline modulus is zero at the Nyquist frequency.
+             * As in make_bspline_moduli() we use the neighboring value instead.
+             */
+            poly1[d][gridSize[d] / 2] = poly1[d][gridSize[d] / 2 - 1];
+            poly2[d][gridSize[d] / 2] = poly2[d][gridSize[d] / 2 - 1];
+        }
+    }
+
+    const double expFactor = gmx::square(M_PI / ewaldcoeff);
+
+    double sum = 0;
+    for (int ix = 0; ix < gridSize[XX]; ix++)
+    {
+        const int    mx  = (ix <= gridSize[XX] / 2 ? ix : ix - gridSize[XX]);
+        const double mhx = mx * recipBox[XX][XX];
+        if (expFactor * mhx * mhx > c_maxReciprocalExponent)
+        {
+            continue;
+        }
+        for (int iy = 0; iy < gridSize[YY]; iy++)
+        {
+            const int    my  = (iy <= gridSize[YY] / 2 ? iy : iy - gridSize[YY]);
+            const double mhy = mx * recipBox[YY][XX] + my * recipBox[YY][YY];
+            if (expFactor * (mhx * mhx + mhy * mhy) > c_maxReciprocalExponent)
+            {
+                continue;
+            }
+            const real p1xy = poly1[XX][ix] + poly1[YY][iy];
+            const real p2xy = poly2[XX][ix] + poly2[YY][iy] + 2 * poly1[XX][ix] * poly1[YY][iy];
+            for (int iz = 0; iz < gridSize[ZZ]; iz++)
+            {
+                const int    mz  = (iz <= gridSize[ZZ] / 2 ? iz : iz - gridSize[ZZ]);
+                const double mhz =
+                        mx * recipBox[ZZ][XX] + my * recipBox[ZZ][YY] + mz * recipBox[ZZ][ZZ];
+                const double m2  = mhx * mhx + mhy * mhy + mhz * mhz;
+                if (m2 == 0 || expFactor * m2 > c_maxReciprocalExponent)
+                {
+                    continue;
+                }
+                const double coeff = std::exp(-expFactor * m2) / (2.0 * M_PI * volume * m2);
+                const real   p1    = p1xy + poly1[ZZ][iz];
+                const real   eps   = p2xy + poly2[ZZ][iz] + 2 * poly1[ZZ][iz] * p1xy + p1 * p1;
+
+                sum += coeff * coeff * m2 * eps;
+            }
+        }
+    }
+
+    const double error2 = 32.0 * M_PI * M_PI * sum * gmx::square(sumChargeSquared) / numCharges;
+
+    return ONE_4PI_EPS0 * std::sqrt(error2);
+}
@@ -81,6 +81,45 @@ real calc_ewaldcoeff_q(real rc, real rtol);
  */
 real calc_ewaldcoeff_lj(real rc, real rtol);
 
+/*! \brief Estimates the RMS direct-space Coulomb force error of Ewald summation
+ *
+ * Uses the Kolafa-Perram estimate, which assumes randomly distributed charges.
+ *
+ * \param[in] sumChargeSquared  Sum of the squared charges in the system
+ * \param[in] numCharges        The number of charged particles
+ * \param[in] volume            The volume of the unit cell
+ * \param[in] rc                Cutoff radius
+ * \param[in] ewaldcoeff        The Ewald splitting coefficient
+ * \return                      The RMS force error in kJ mol^-1 nm^-1
+ */
+real estimateEwaldDirectSpaceForceError(real sumChargeSquared,
+                                        int  numCharges,
+                                        real volume,
+                                        real rc,
+                                        real ewaldcoeff);
+
+/*! \brief Estimates the RMS reciprocal-space Coulomb force error of smooth PME
+ *
+ * Computes the position-independent term of the error estimate used by
+ * gmx pme_error, which is the dominant term for homogeneous systems.
+ * Only grid vectors that can contribute significantly are visited, so
+ * the cost is nearly independent of the grid size.
+ *
+ * \param[in] sumChargeSquared  Sum of the squared charges in the system
+ * \param[in] numCharges        The number of charged particles
+ * \param[in] box               The unit cell
+ * \param[in] gridSize          The PME grid size along x, y and z
+ * \param[in] pmeOrder          The PME interpolation order
+ * \param[in] ewaldcoeff        The Ewald splitting coefficient
+ * \return                      The RMS force error in kJ mol^-1 nm^-1
+ */
+real estimatePmeReciprocalSpaceForceError(real         sumChargeSquared,
+                                          int          numCharges,
+                                          const matrix box,
+                                          const ivec   gridSize,
+                                          int          pmeOrder,
+                                          real         ewaldcoeff);
+
 
 /*! \libinternal \brief Class to handle box scaling for Ewald and PME.
  *
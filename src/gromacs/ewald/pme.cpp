@@ -196,7 +196,18 @@ bool pme_gpu_supports_input(const t_inputrec& ir, std::string* error)
     }
     if (EVDW_PME(ir.vdwtype))
     {
-        errorReasons.emplace_back("Lennard-Jones PME");
+        if (!GMX_GPU_CUDA)
+        {
+            errorReasons.emplace_back("Lennard-Jones PME with other GPU frameworks than CUDA");
+        }
+        if (ir.ljpme_combination_rule != eljpmeGEOM)
+        {
+            errorReasons.emplace_back("Lennard-Jones PME with Lorentz-Berthelot combination rule");
+        }
+        if (ir.efep != efepNO)
+        {
+            errorReasons.emplace_back("Lennard-Jones PME with free-energy calculations");
+        }
     }
     if (!EI_DYNAMICS(ir.eI))
     {
@@ -221,7 +232,13 @@ static bool pme_gpu_check_restrictions(const gmx_pme_t* pme, std::string* error)
     std::list<std::string> errorReasons;
     if (pme->nnodes != 1)
     {
-        errorReasons.emplace_back("PME decomposition");
+        /* Decomposing the grid over GPUs needs a distributed GPU 3D FFT and
+         * local-grid spread and gather kernels with halo exchange, which we
+         * do not have. A single separate PME rank can serve many PP GPUs.
+         */
+        errorReasons.emplace_back(
+                "PME decomposition over multiple ranks, use a single (separate) PME rank "
+                "instead");
     }
     if (pme->pme_order != 4)
     {
@@ -229,7 +246,23 @@ static bool pme_gpu_check_restrictions(const gmx_pme_t* pme, std::string* error)
     }
     if (pme->doLJ)
     {
-        errorReasons.emplace_back("Lennard-Jones PME");
+        /* The LJ-PME grid takes the place of the Coulomb FEP state B grid */
+        if (!GMX_GPU_CUDA)
+        {
+            errorReasons.emplace_back("Lennard-Jones PME with other GPU frameworks than CUDA");
+        }
+        if (pme->ljpme_combination_rule != eljpmeGEOM)
+        {
+            errorReasons.emplace_back("Lennard-Jones PME with Lorentz-Berthelot combination rule");
+        }
+        if (pme->bFEP)
+        {
+            errorReasons.emplace_back("Lennard-Jones PME with free-energy calculations");
+        }
+        if (pme->runMode == PmeRunMode::Mixed)
+        {
+            errorReasons.emplace_back("Lennard-Jones PME with the FFT and solve on the CPU");
+        }
     }
     if (GMX_DOUBLE)
     {
@@ -902,6 +935,7 @@ void gmx_pme_reinit(struct gmx_pme_t** pmedata,
                     struct gmx_pme_t*  pme_src,
                     const t_inputrec*  ir,
                     const ivec         grid_size,
+                    int                pme_order,
                     real               ewaldcoeff_q,
                     real               ewaldcoeff_lj)
 {
@@ -913,7 +947,7 @@ void gmx_pme_reinit(struct gmx_pme_t** pmedata,
     irc.coulombtype            = ir->coulombtype;
     irc.vdwtype                = ir->vdwtype;
     irc.efep                   = ir->efep;
-    irc.pme_order              = ir->pme_order;
+    irc.pme_order              = pme_order;
     irc.epsilon_r              = ir->epsilon_r;
     irc.ljpme_combination_rule = ir->ljpme_combination_rule;
     irc.nkx                    = grid_size[XX];
@@ -936,7 +970,7 @@ void gmx_pme_reinit(struct gmx_pme_t** pmedata,
          */
         if (!pme_src->gpu && pme_src->nnodes == 1)
         {
-            gmx_pme_reinit_atoms(*pmedata, pme_src->atc[0].numAtoms(), nullptr, nullptr);
+            gmx_pme_reinit_atoms(*pmedata, pme_src->atc[0].numAtoms(), nullptr, nullptr, nullptr);
         }
         // TODO this is mostly passing around current values
     }
@@ -1171,15 +1205,20 @@ int gmx_pme_do(struct gmx_pme_t*              pme,
 
         if (!pme->bUseThreads)
         {
-            wrap_periodic_pmegrid(pme, grid);
-
-            /* sum contributions to local grid from other nodes */
-            if (pme->nnodes > 1)
+            if (pme->nnodes == 1)
             {
-                gmx_sum_qgrid_dd(pme, grid, GMX_SUM_GRID_FORWARD);
+                /* Saves passes over the grid compared with separate steps */
+                copy_wrapped_pmegrid_to_fftgrid(pme, grid, fftgrid, grid_index);
             }
+            else
+            {
+                wrap_periodic_pmegrid(pme, grid);
+
+                /* sum contributions to local grid from other nodes */
+                gmx_sum_qgrid_dd(pme, grid, GMX_SUM_GRID_FORWARD);
 
-            copy_pmegrid_to_fftgrid(pme, grid, fftgrid, grid_index);
+                copy_pmegrid_to_fftgrid(pme, grid, fftgrid, grid_index);
+            }
         }
 
         wallcycle_stop(wcycle, ewcPME_SPREAD);
@@ -1409,13 +1448,17 @@ int gmx_pme_do(struct gmx_pme_t*              pme,
                          pme->pme_order * pme->pme_order * pme->pme_order * atc.numAtoms());
                 if (pme->nthread == 1)
                 {
-                    wrap_periodic_pmegrid(pme, grid);
-                    /* sum contributions to local grid from other nodes */
-                    if (pme->nnodes > 1)
+                    if (pme->nnodes == 1)
+                    {
+                        copy_wrapped_pmegrid_to_fftgrid(pme, grid, fftgrid, grid_index);
+                    }
+                    else
                     {
+                        wrap_periodic_pmegrid(pme, grid);
+                        /* sum contributions to local grid from other nodes */
                         gmx_sum_qgrid_dd(pme, grid, GMX_SUM_GRID_FORWARD);
+                        copy_pmegrid_to_fftgrid(pme, grid, fftgrid, grid_index);
                     }
-                    copy_pmegrid_to_fftgrid(pme, grid, fftgrid, grid_index);
                 }
                 wallcycle_stop(wcycle, ewcPME_SPREAD);
 
@@ -1700,13 +1743,21 @@ void gmx_pme_destroy(gmx_pme_t* pme)
     delete pme;
 }
 
-void gmx_pme_reinit_atoms(gmx_pme_t* pme, const int numAtoms, const real* chargesA, const real* chargesB)
+void gmx_pme_reinit_atoms(gmx_pme_t*  pme,
+                          const int   numAtoms,
+                          const real* chargesA,
+                          const real* chargesB,
+                          const real* sqrtC6A)
 {
     if (pme->gpu != nullptr)
     {
         GMX_ASSERT(!(pme->bFEP_q && chargesB == nullptr),
                    "B state charges must be specified if running Coulomb FEP on the GPU");
-        pme_gpu_reinit_atoms(pme->gpu, numAtoms, chargesA, pme->bFEP_q ? chargesB : nullptr);
+        GMX_ASSERT(!(pme->doLJ && sqrtC6A == nullptr),
+                   "C6 coefficients must be specified if running LJ-PME on the GPU");
+        /* The second GPU grid holds either the B state charges or the LJ-PME coefficients */
+        const real* coefficientsB = pme->doLJ ? sqrtC6A : (pme->bFEP_q ? chargesB : nullptr);
+        pme_gpu_reinit_atoms(pme->gpu, numAtoms, chargesA, coefficientsB);
     }
     else
     {
@@ -153,14 +153,16 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
                         const PmeGpuProgram* pmeGpuProgram,
                         const gmx::MDLogger& mdlog);
 
-/*! \brief As gmx_pme_init, but takes most settings, except the grid/Ewald coefficients, from
- * pme_src. This is only called when the PME cut-off/grid size changes.
+/*! \brief As gmx_pme_init, but takes most settings, except the grid, the interpolation order
+ * and the Ewald coefficients, from pme_src. This is only called when the PME cut-off/grid size
+ * changes.
  */
 void gmx_pme_reinit(gmx_pme_t**       pmedata,
                     const t_commrec*  cr,
                     gmx_pme_t*        pme_src,
                     const t_inputrec* ir,
                     const ivec        grid_size,
+                    int               pme_order,
                     real              ewaldcoeff_q,
                     real              ewaldcoeff_lj);
 
@@ -223,8 +225,14 @@ void gmx_pme_calc_energy(gmx_pme_t* pme, gmx::ArrayRef<const gmx::RVec> x, gmx::
  * state A. Can be nullptr if PME is not performed on the GPU.
  * \param[in]     chargesB   The pointer to the array of particle charges in state B. Only used if
  * charges are perturbed and can otherwise be nullptr.
+ * \param[in]     sqrtC6A    The pointer to the array of square roots of the particle C6
+ * parameters. Only used with LJ-PME on the GPU and can otherwise be nullptr.
  */
-void gmx_pme_reinit_atoms(gmx_pme_t* pme, int numAtoms, const real* chargesA, const real* chargesB);
+void gmx_pme_reinit_atoms(gmx_pme_t*  pme,
+                          int         numAtoms,
+                          const real* chargesA,
+                          const real* chargesB,
+                          const real* sqrtC6A);
 
 /* A block of PME GPU functions */
 
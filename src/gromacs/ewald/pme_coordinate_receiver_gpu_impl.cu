@@ -48,6 +48,7 @@
 #include "config.h"
 
 #include "gromacs/ewald/pme_force_sender_gpu.h"
+#include "gromacs/ewald/pme_pp_communication.h"
 #include "gromacs/gpu_utils/cudautils.cuh"
 #include "gromacs/gpu_utils/gpueventsynchronizer.cuh"
 #include "gromacs/utility/gmxmpi.h"
@@ -62,9 +63,8 @@ PmeCoordinateReceiverGpu::Impl::Impl(const DeviceStream&    pmeStream,
     comm_(comm),
     ppRanks_(ppRanks)
 {
-    GMX_RELEASE_ASSERT(
-            GMX_THREAD_MPI,
-            "PME-PP GPU Communication is currently only supported with thread-MPI enabled");
+    GMX_RELEASE_ASSERT(GMX_THREAD_MPI || GMX_LIB_MPI,
+                       "PME-PP GPU Communication is only supported with an MPI build");
     request_.resize(ppRanks.size());
     ppSync_.resize(ppRanks.size());
 }
@@ -73,7 +73,9 @@ PmeCoordinateReceiverGpu::Impl::~Impl() = default;
 
 void PmeCoordinateReceiverGpu::Impl::sendCoordinateBufferAddressToPpRanks(DeviceBuffer<RVec> d_x)
 {
+    d_x_ = d_x;
 
+#if GMX_THREAD_MPI
     int ind_start = 0;
     int ind_end   = 0;
     for (const auto& receiver : ppRanks_)
@@ -84,20 +86,35 @@ void PmeCoordinateReceiverGpu::Impl::sendCoordinateBufferAddressToPpRanks(Device
         // Data will be transferred directly from GPU.
         void* sendBuf = reinterpret_cast<void*>(&d_x[ind_start]);
 
-#if GMX_MPI
         MPI_Send(&sendBuf, sizeof(void**), MPI_BYTE, receiver.rankId, 0, comm_);
-#else
-        GMX_UNUSED_VALUE(sendBuf);
-#endif
     }
+#endif
 }
 
-/*! \brief Receive coordinate data directly using CUDA memory copy */
+/*! \brief Receive coordinate data directly using CUDA memory copy or CUDA-aware MPI */
 void PmeCoordinateReceiverGpu::Impl::launchReceiveCoordinatesFromPpCudaDirect(int ppRank)
 {
+#if GMX_LIB_MPI
+    // With library MPI the PP ranks can be on other nodes, so the
+    // data is received by the CUDA-aware MPI library directly into
+    // the PME coordinate buffer
+    int indStart = 0;
+    int numAtoms = 0;
+    for (const auto& sender : ppRanks_)
+    {
+        if (sender.rankId == ppRank)
+        {
+            numAtoms = sender.numAtoms;
+            break;
+        }
+        indStart += sender.numAtoms;
+    }
+    MPI_Irecv(&d_x_[indStart], numAtoms * sizeof(rvec), MPI_BYTE, ppRank, eCommType_COORD_GPU,
+              comm_, &request_[recvCount_]);
+    recvCount_++;
+#elif GMX_THREAD_MPI
     // Data will be pushed directly from PP task
 
-#if GMX_MPI
     // Receive event from PP task
     MPI_Irecv(&ppSync_[recvCount_], sizeof(GpuEventSynchronizer*), MPI_BYTE, ppRank, 0, comm_,
               &request_[recvCount_]);
@@ -115,9 +132,13 @@ void PmeCoordinateReceiverGpu::Impl::enqueueWaitReceiveCoordinatesFromPpCudaDire
 #if GMX_MPI
         MPI_Waitall(recvCount_, request_.data(), MPI_STATUS_IGNORE);
 #endif
-        for (int i = 0; i < recvCount_; i++)
+        // With library MPI the data has arrived when the receives complete
+        if (GMX_THREAD_MPI)
         {
-            ppSync_[i]->enqueueWaitEvent(pmeStream_);
+            for (int i = 0; i < recvCount_; i++)
+            {
+                ppSync_[i]->enqueueWaitEvent(pmeStream_);
+            }
         }
         // reset receive counter
         recvCount_ = 0;
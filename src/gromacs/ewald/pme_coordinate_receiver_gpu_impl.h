@@ -90,6 +90,8 @@ private:
     MPI_Comm comm_;
     //! list of PP ranks
     gmx::ArrayRef<PpRanks> ppRanks_;
+    //! PME coordinate buffer in GPU memory, received into directly with library MPI
+    DeviceBuffer<RVec> d_x_ = nullptr;
     //! vector of MPI requests
     std::vector<MPI_Request> request_;
     //! vector of synchronization events to receive from PP tasks
@@ -60,9 +60,8 @@ PmeForceSenderGpu::Impl::Impl(const DeviceStream& pmeStream, MPI_Comm comm, gmx:
     comm_(comm),
     ppRanks_(ppRanks)
 {
-    GMX_RELEASE_ASSERT(
-            GMX_THREAD_MPI,
-            "PME-PP GPU Communication is currently only supported with thread-MPI enabled");
+    GMX_RELEASE_ASSERT(GMX_THREAD_MPI || GMX_LIB_MPI,
+                       "PME-PP GPU Communication is only supported with an MPI build");
 }
 
 PmeForceSenderGpu::Impl::~Impl() = default;
@@ -70,6 +69,9 @@ PmeForceSenderGpu::Impl::~Impl() = default;
 /*! \brief  sends force buffer address to PP ranks */
 void PmeForceSenderGpu::Impl::sendForceBufferAddressToPpRanks(rvec* d_f)
 {
+    d_f_ = d_f;
+
+#if GMX_THREAD_MPI
     int ind_start = 0;
     int ind_end   = 0;
     for (const auto& receiver : ppRanks_)
@@ -80,29 +82,47 @@ void PmeForceSenderGpu::Impl::sendForceBufferAddressToPpRanks(rvec* d_f)
         // Data will be transferred directly from GPU.
         void* sendBuf = reinterpret_cast<void*>(&d_f[ind_start]);
 
-#if GMX_MPI
         MPI_Send(&sendBuf, sizeof(void**), MPI_BYTE, receiver.rankId, 0, comm_);
-#else
-        GMX_UNUSED_VALUE(sendBuf);
-#endif
     }
+#endif
 }
 
-/*! \brief Send PME data directly using CUDA memory copy */
+/*! \brief Send PME data directly using CUDA memory copy or CUDA-aware MPI */
 void PmeForceSenderGpu::Impl::sendFToPpCudaDirect(int ppRank)
 {
+#if GMX_LIB_MPI
+    // With library MPI the PP ranks can be on other nodes, so the
+    // forces are sent by the CUDA-aware MPI library directly from
+    // the PME force buffer once the PME force calculations are done
+    pmeSync_.markEvent(pmeStream_);
+    pmeSync_.waitForEvent();
+
+    int indStart = 0;
+    int numAtoms = 0;
+    for (const auto& receiver : ppRanks_)
+    {
+        if (receiver.rankId == ppRank)
+        {
+            numAtoms = receiver.numAtoms;
+            break;
+        }
+        indStart += receiver.numAtoms;
+    }
+    MPI_Send(d_f_[indStart], numAtoms * sizeof(rvec), MPI_BYTE, ppRank, 0, comm_);
+#else
     // Data will be pulled directly from PP task
 
     // Record and send event to ensure PME force calcs are completed before PP task pulls data
     pmeSync_.markEvent(pmeStream_);
     GpuEventSynchronizer* pmeSyncPtr = &pmeSync_;
-#if GMX_MPI
+#    if GMX_MPI
     // TODO Using MPI_Isend would be more efficient, particularly when
     // sending to multiple PP ranks
     MPI_Send(&pmeSyncPtr, sizeof(GpuEventSynchronizer*), MPI_BYTE, ppRank, 0, comm_);
-#else
+#    else
     GMX_UNUSED_VALUE(pmeSyncPtr);
     GMX_UNUSED_VALUE(ppRank);
+#    endif
 #endif
 }
 
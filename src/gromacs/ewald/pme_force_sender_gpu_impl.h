@@ -85,6 +85,8 @@ private:
     MPI_Comm comm_;
     //! list of PP ranks
     gmx::ArrayRef<PpRanks> ppRanks_;
+    //! PME force buffer in GPU memory, sent from directly with library MPI
+    rvec* d_f_ = nullptr;
 };
 
 } // namespace gmx
@@ -301,7 +301,8 @@ __device__ __forceinline__ void sumForceComponents(float* __restrict__ fx,
  * \param[in] forceIndexGlobal    The index of the thread in the gm_coefficients array.
  * \param[in] recipBox            The reciprocal box.
  * \param[in] scale               The scale to use when calculating the forces. For gm_coefficientsB
- * (when using multiple coefficients on a single grid) the scale will be (1.0 - scale).
+ * (when using multiple coefficients on a single grid) the scale will be
+ * kernelParams.current.scaleB.
  * \param[in] gm_coefficients     Global memory array of the coefficients to use for an unperturbed
  * or FEP in state A if a single grid is used (\p multiCoefficientsSingleGrid == true).If two
  * separate grids are used this should be the coefficients of the grid in question.
@@ -557,7 +558,8 @@ __launch_bounds__(c_gatherMaxThreadsPerBlock, c_gatherMinBlocksPerMP) __global__
         if (forceIndexLocal < atomsPerBlock)
         {
             calculateAndStoreGridForces(sm_forces, forceIndexLocal, forceIndexGlobal,
-                                        kernelParams.current.recipBox, 1.0F - scale, gm_coefficientsB);
+                                        kernelParams.current.recipBox, kernelParams.current.scaleB,
+                                        gm_coefficientsB);
         }
 
         __syncwarp();
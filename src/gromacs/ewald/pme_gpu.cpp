@@ -201,13 +201,15 @@ void pme_gpu_launch_spread(gmx_pme_t*            pme,
 
     PmeGpu* pmeGpu = pme->gpu;
 
-    GMX_ASSERT(pmeGpu->common->ngrids == 1 || (pmeGpu->common->ngrids == 2 && pme->bFEP_q),
-               "If not decoupling Coulomb interactions there should only be one FEP grid. If "
-               "decoupling Coulomb interactions there should be two grids.");
+    GMX_ASSERT(pmeGpu->common->ngrids == 1
+                       || (pmeGpu->common->ngrids == 2 && (pme->bFEP_q != pme->doLJ)),
+               "If not decoupling Coulomb interactions and not using LJ-PME there should only be "
+               "one grid. With either of them there should be two grids.");
 
     /* PME on GPU can currently manage two grids:
      * grid_index=0: Coulomb PME with charges in the normal state or from FEP state A.
-     * grid_index=1: Coulomb PME with charges from FEP state B.
+     * grid_index=1: Coulomb PME with charges from FEP state B or, with LJ-PME,
+     *               LJ-PME with the geometric C6 coefficients.
      */
     real** fftgrids = pme->fftgrid;
     /* Spread the coefficients on a grid */
@@ -317,7 +319,9 @@ static void pme_gpu_reduce_outputs(const bool            computeEnergyAndVirial,
     {
         GMX_ASSERT(enerd, "Invalid energy output manager");
         forceWithVirial->addVirialContribution(output.coulombVirial_);
+        forceWithVirial->addVirialContribution(output.lennardJonesVirial_);
         enerd->term[F_COUL_RECIP] += output.coulombEnergy_;
+        enerd->term[F_LJ_RECIP] += output.lennardJonesEnergy_;
         enerd->dvdl_lin[efptCOUL] += output.coulombDvdl_;
     }
     if (output.haveForceOutput_)
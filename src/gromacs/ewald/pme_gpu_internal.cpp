@@ -51,6 +51,7 @@
 
 #include "config.h"
 
+#include <cmath>
 #include <list>
 #include <memory>
 #include <string>
@@ -543,7 +544,7 @@ void pme_gpu_getEnergyAndVirial(const gmx_pme_t& pme, const float lambda, PmeOut
 {
     const PmeGpu* pmeGpu = pme.gpu;
 
-    GMX_ASSERT(lambda == 1.0 || pmeGpu->common->ngrids == 2,
+    GMX_ASSERT(lambda == 1.0 || (pmeGpu->common->ngrids == 2 && !pmeGpu->common->doLJ),
                "Invalid combination of lambda and number of grids");
 
     for (int gridIndex = 0; gridIndex < pmeGpu->common->ngrids; gridIndex++)
@@ -558,38 +559,35 @@ void pme_gpu_getEnergyAndVirial(const gmx_pme_t& pme, const float lambda, PmeOut
     {
         for (int dim2 = 0; dim2 < DIM; dim2++)
         {
-            output->coulombVirial_[dim1][dim2] = 0;
+            output->coulombVirial_[dim1][dim2]      = 0;
+            output->lennardJonesVirial_[dim1][dim2] = 0;
         }
     }
-    output->coulombEnergy_ = 0;
-    float scale            = 1.0;
+    output->coulombEnergy_      = 0;
+    output->lennardJonesEnergy_ = 0;
+    float scale                 = 1.0;
     for (int gridIndex = 0; gridIndex < pmeGpu->common->ngrids; gridIndex++)
     {
-        if (pmeGpu->common->ngrids == 2)
+        /* With LJ-PME the second grid holds the dispersion contributions */
+        const bool isLJGrid = (pmeGpu->common->doLJ && gridIndex == 1);
+        if (pmeGpu->common->ngrids == 2 && !pmeGpu->common->doLJ)
         {
             scale = gridIndex == 0 ? (1.0 - lambda) : lambda;
         }
-        output->coulombVirial_[XX][XX] +=
-                scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][0];
-        output->coulombVirial_[YY][YY] +=
-                scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][1];
-        output->coulombVirial_[ZZ][ZZ] +=
-                scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][2];
-        output->coulombVirial_[XX][YY] +=
-                scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][3];
-        output->coulombVirial_[YY][XX] +=
-                scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][3];
-        output->coulombVirial_[XX][ZZ] +=
-                scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][4];
-        output->coulombVirial_[ZZ][XX] +=
-                scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][4];
-        output->coulombVirial_[YY][ZZ] +=
-                scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][5];
-        output->coulombVirial_[ZZ][YY] +=
-                scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][5];
-        output->coulombEnergy_ += scale * 0.5F * pmeGpu->staging.h_virialAndEnergy[gridIndex][6];
-    }
-    if (pmeGpu->common->ngrids > 1)
+        matrix& virial = isLJGrid ? output->lennardJonesVirial_ : output->coulombVirial_;
+        real&   energy = isLJGrid ? output->lennardJonesEnergy_ : output->coulombEnergy_;
+        virial[XX][XX] += scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][0];
+        virial[YY][YY] += scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][1];
+        virial[ZZ][ZZ] += scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][2];
+        virial[XX][YY] += scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][3];
+        virial[YY][XX] += scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][3];
+        virial[XX][ZZ] += scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][4];
+        virial[ZZ][XX] += scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][4];
+        virial[YY][ZZ] += scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][5];
+        virial[ZZ][YY] += scale * 0.25F * pmeGpu->staging.h_virialAndEnergy[gridIndex][5];
+        energy += scale * 0.5F * pmeGpu->staging.h_virialAndEnergy[gridIndex][6];
+    }
+    if (pmeGpu->common->ngrids > 1 && !pmeGpu->common->doLJ)
     {
         output->coulombDvdl_ = 0.5F
                                * (pmeGpu->staging.h_virialAndEnergy[FEP_STATE_B][6]
@@ -672,6 +670,13 @@ static void pme_gpu_reinit_grids(PmeGpu* pmeGpu)
 
     kernelParamsPtr->grid.ewaldFactor =
             (M_PI * M_PI) / (pmeGpu->common->ewaldcoeff_q * pmeGpu->common->ewaldcoeff_q);
+    if (pmeGpu->common->doLJ)
+    {
+        const real ewaldcoeffLJ = pmeGpu->common->ewaldcoeff_lj;
+        kernelParamsPtr->grid.ewaldFactorLJ = (M_PI * M_PI) / (ewaldcoeffLJ * ewaldcoeffLJ);
+        kernelParamsPtr->grid.ewaldDenomFactorLJ =
+                3.0 / (M_PI * std::sqrt(M_PI) * ewaldcoeffLJ * ewaldcoeffLJ * ewaldcoeffLJ);
+    }
     /* The grid size variants */
     for (int i = 0; i < DIM; i++)
     {
@@ -723,9 +728,11 @@ static void pme_gpu_copy_common_data_from(const gmx_pme_t* pme)
     /* TODO: Consider refactoring the CPU PME code to use the same structure,
      * so that this function becomes 2 lines */
     PmeGpu* pmeGpu               = pme->gpu;
-    pmeGpu->common->ngrids       = pme->bFEP_q ? 2 : 1;
-    pmeGpu->common->epsilon_r    = pme->epsilon_r;
-    pmeGpu->common->ewaldcoeff_q = pme->ewaldcoeff_q;
+    pmeGpu->common->ngrids        = (pme->bFEP_q || pme->doLJ) ? 2 : 1;
+    pmeGpu->common->doLJ          = pme->doLJ;
+    pmeGpu->common->epsilon_r     = pme->epsilon_r;
+    pmeGpu->common->ewaldcoeff_q  = pme->ewaldcoeff_q;
+    pmeGpu->common->ewaldcoeff_lj = pme->ewaldcoeff_lj;
     pmeGpu->common->nk[XX]       = pme->nkx;
     pmeGpu->common->nk[YY]       = pme->nky;
     pmeGpu->common->nk[ZZ]       = pme->nkz;
@@ -1159,6 +1166,34 @@ static auto selectSpreadKernelPtr(const PmeGpu*  pmeGpu,
     return kernelPtr;
 }
 
+/*! \brief Sets the scaling factors of the coefficients of the two grids used in gather
+ *
+ * With perturbed charges the grids are weighted by (1 - lambda) and lambda,
+ * with LJ-PME the Coulomb and the LJ grid both contribute fully.
+ *
+ * \param[in] pmeGpu  The PME GPU structure.
+ * \param[in] lambda  The Coulomb lambda value.
+ */
+static void pme_gpu_set_coefficient_scales(const PmeGpu* pmeGpu, const real lambda)
+{
+    auto* kernelParamsPtr = pmeGpu->kernelParams.get();
+    if (pmeGpu->common->ngrids == 1)
+    {
+        kernelParamsPtr->current.scale  = 1.0;
+        kernelParamsPtr->current.scaleB = 0.0;
+    }
+    else if (pmeGpu->common->doLJ)
+    {
+        kernelParamsPtr->current.scale  = 1.0;
+        kernelParamsPtr->current.scaleB = 1.0;
+    }
+    else
+    {
+        kernelParamsPtr->current.scale  = 1.0 - lambda;
+        kernelParamsPtr->current.scaleB = lambda;
+    }
+}
+
 void pme_gpu_spread(const PmeGpu*         pmeGpu,
                     GpuEventSynchronizer* xReadyOnDevice,
                     real**                h_grids,
@@ -1215,14 +1250,7 @@ void pme_gpu_spread(const PmeGpu*         pmeGpu,
     const int blockCount = pmeGpu->nAtomsAlloc / atomsPerBlock;
     auto      dimGrid    = pmeGpuCreateGrid(pmeGpu, blockCount);
 
-    if (pmeGpu->common->ngrids == 1)
-    {
-        kernelParamsPtr->current.scale = 1.0;
-    }
-    else
-    {
-        kernelParamsPtr->current.scale = 1.0 - lambda;
-    }
+    pme_gpu_set_coefficient_scales(pmeGpu, lambda);
 
     KernelLaunchConfig config;
     config.blockSize[0] = order;
@@ -1368,9 +1396,16 @@ void pme_gpu_solve(const PmeGpu* pmeGpu,
 
     int                                timingId  = gtPME_SOLVE;
     PmeGpuProgramImpl::PmeKernelHandle kernelPtr = nullptr;
+    const bool                         solveLJ   = (pmeGpu->common->doLJ && gridIndex == 1);
     if (gridOrdering == GridOrdering::YZX)
     {
-        if (gridIndex == 0)
+        if (solveLJ)
+        {
+            kernelPtr = computeEnergyAndVirial
+                                ? pmeGpu->programHandle_->impl_->solveYZXEnergyKernelLJ
+                                : pmeGpu->programHandle_->impl_->solveYZXKernelLJ;
+        }
+        else if (gridIndex == 0)
         {
             kernelPtr = computeEnergyAndVirial ? pmeGpu->programHandle_->impl_->solveYZXEnergyKernelA
                                                : pmeGpu->programHandle_->impl_->solveYZXKernelA;
@@ -1383,7 +1418,13 @@ void pme_gpu_solve(const PmeGpu* pmeGpu,
     }
     else if (gridOrdering == GridOrdering::XYZ)
     {
-        if (gridIndex == 0)
+        if (solveLJ)
+        {
+            kernelPtr = computeEnergyAndVirial
+                                ? pmeGpu->programHandle_->impl_->solveXYZEnergyKernelLJ
+                                : pmeGpu->programHandle_->impl_->solveXYZKernelLJ;
+        }
+        else if (gridIndex == 0)
         {
             kernelPtr = computeEnergyAndVirial ? pmeGpu->programHandle_->impl_->solveXYZEnergyKernelA
                                                : pmeGpu->programHandle_->impl_->solveXYZKernelA;
@@ -1558,14 +1599,7 @@ void pme_gpu_gather(PmeGpu* pmeGpu, real** h_grids, const float lambda)
     pme_gpu_start_timing(pmeGpu, timingId);
     auto* timingEvent     = pme_gpu_fetch_timing_event(pmeGpu, timingId);
     auto* kernelParamsPtr = pmeGpu->kernelParams.get();
-    if (pmeGpu->common->ngrids == 1)
-    {
-        kernelParamsPtr->current.scale = 1.0;
-    }
-    else
-    {
-        kernelParamsPtr->current.scale = 1.0 - lambda;
-    }
+    pme_gpu_set_coefficient_scales(pmeGpu, lambda);
 
 #if c_canEmbedBuffers
     const auto kernelArgs = prepareGpuKernelArguments(kernelPtr, config, kernelParamsPtr);
@@ -541,7 +541,8 @@ GPU_FUNC_QUALIFIER void pme_gpu_destroy(PmeGpu* GPU_FUNC_ARGUMENT(pmeGpu)) GPU_F
  * \param[in] pmeGpu    The PME GPU structure.
  * \param[in] nAtoms    The number of particles.
  * \param[in] chargesA  The pointer to the host-side array of particle charges in the unperturbed state or FEP state A.
- * \param[in] chargesB  The pointer to the host-side array of particle charges in FEP state B.
+ * \param[in] chargesB  The pointer to the host-side array of particle charges in FEP state B or,
+ *                      with LJ-PME, of the square roots of the C6 coefficients.
  *
  * This is a function that should only be called in the beginning of the run and on domain
  * decomposition. Should be called before the pme_gpu_set_io_ranges.
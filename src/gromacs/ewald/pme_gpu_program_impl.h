@@ -151,7 +151,8 @@ struct PmeGpuProgramImpl
     //@{
     /** Solve kernel doesn't care about the interpolation order, but can optionally
      * compute energy and virial, and supports XYZ and YZX grid orderings.
-     * The kernels are templated separately for grids in state A and B.
+     * The kernels are templated separately for grids in state A and B
+     * and for the LJ-PME grid.
      */
     size_t solveMaxWorkGroupSize;
 
@@ -163,6 +164,11 @@ struct PmeGpuProgramImpl
     PmeKernelHandle solveXYZKernelB;
     PmeKernelHandle solveYZXEnergyKernelB;
     PmeKernelHandle solveXYZEnergyKernelB;
+    //! LJ-PME solve kernels for the second grid, only implemented with CUDA
+    PmeKernelHandle solveYZXKernelLJ       = nullptr;
+    PmeKernelHandle solveXYZKernelLJ       = nullptr;
+    PmeKernelHandle solveYZXEnergyKernelLJ = nullptr;
+    PmeKernelHandle solveXYZEnergyKernelLJ = nullptr;
     //@}
 
     PmeGpuProgramImpl() = delete;
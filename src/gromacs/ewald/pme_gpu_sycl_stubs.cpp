@@ -0,0 +1,184 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ * \brief
+ * Implements the PME GPU functions declared with GPU_FUNC_QUALIFIER for SYCL builds.
+ *
+ * PME on GPUs is not supported with SYCL yet (see pme_gpu_supports_build()),
+ * so these are never called. They behave like the null implementations
+ * of non-GPU builds and exist only because the SYCL build enables the real
+ * declarations of the functions shared with the non-bonded GPU module.
+ *
+ * \ingroup module_ewald
+ */
+#include "gmxpre.h"
+
+#include "gromacs/ewald/pme.h"
+#include "gromacs/ewald/pme_output.h"
+
+#include "pme_gpu_internal.h"
+
+int pme_gpu_get_block_size(const gmx_pme_t* /*pme*/)
+{
+    return 0;
+}
+
+void pme_gpu_reset_timings(const gmx_pme_t* /*pme*/) {}
+
+void pme_gpu_get_timings(const gmx_pme_t* /*pme*/, gmx_wallclock_gpu_pme_t* /*timings*/) {}
+
+void pme_gpu_prepare_computation(gmx_pme_t* /*pme*/,
+                                 const matrix /*box*/,
+                                 gmx_wallcycle* /*wcycle*/,
+                                 const gmx::StepWorkload& /*stepWork*/)
+{
+}
+
+void pme_gpu_launch_spread(gmx_pme_t* /*pme*/,
+                           GpuEventSynchronizer* /*xReadyOnDevice*/,
+                           gmx_wallcycle* /*wcycle*/,
+                           real /*lambdaQ*/)
+{
+}
+
+void pme_gpu_launch_complex_transforms(gmx_pme_t* /*pme*/,
+                                       gmx_wallcycle* /*wcycle*/,
+                                       const gmx::StepWorkload& /*stepWork*/)
+{
+}
+
+void pme_gpu_launch_gather(const gmx_pme_t* /*pme*/, gmx_wallcycle* /*wcycle*/, real /*lambdaQ*/) {}
+
+bool pme_gpu_try_finish_task(gmx_pme_t* /*pme*/,
+                             const gmx::StepWorkload& /*stepWork*/,
+                             gmx_wallcycle* /*wcycle*/,
+                             gmx::ForceWithVirial* /*forceWithVirial*/,
+                             gmx_enerdata_t* /*enerd*/,
+                             real /*lambdaQ*/,
+                             GpuTaskCompletion /*completionKind*/)
+{
+    return false;
+}
+
+void pme_gpu_wait_and_reduce(gmx_pme_t* /*pme*/,
+                             const gmx::StepWorkload& /*stepWork*/,
+                             gmx_wallcycle* /*wcycle*/,
+                             gmx::ForceWithVirial* /*forceWithVirial*/,
+                             gmx_enerdata_t* /*enerd*/,
+                             real /*lambdaQ*/)
+{
+}
+
+void pme_gpu_reinit_computation(const gmx_pme_t* /*pme*/, gmx_wallcycle* /*wcycle*/) {}
+
+void pme_gpu_set_device_x(const gmx_pme_t* /*pme*/, DeviceBuffer<gmx::RVec> /*d_x*/) {}
+
+void* pme_gpu_get_device_f(const gmx_pme_t* /*pme*/)
+{
+    return nullptr;
+}
+
+GpuEventSynchronizer* pme_gpu_get_f_ready_synchronizer(const gmx_pme_t* /*pme*/)
+{
+    return nullptr;
+}
+
+void pme_gpu_synchronize(const PmeGpu* /*pmeGpu*/) {}
+
+void pme_gpu_spread(const PmeGpu* /*pmeGpu*/,
+                    GpuEventSynchronizer* /*xReadyOnDevice*/,
+                    float** /*h_grids*/,
+                    bool /*computeSplines*/,
+                    bool /*spreadCharges*/,
+                    real /*lambda*/)
+{
+}
+
+void pme_gpu_solve(const PmeGpu* /*pmeGpu*/,
+                   int /*gridIndex*/,
+                   t_complex* /*h_grid*/,
+                   GridOrdering /*gridOrdering*/,
+                   bool /*computeEnergyAndVirial*/)
+{
+}
+
+void pme_gpu_gather(PmeGpu* /*pmeGpu*/, float** /*h_grids*/, float /*lambda*/) {}
+
+void pme_gpu_set_kernelparam_coordinates(const PmeGpu* /*pmeGpu*/, DeviceBuffer<gmx::RVec> /*d_x*/) {}
+
+void* pme_gpu_get_kernelparam_forces(const PmeGpu* /*pmeGpu*/)
+{
+    return nullptr;
+}
+
+GpuEventSynchronizer* pme_gpu_get_forces_ready_synchronizer(const PmeGpu* /*pmeGpu*/)
+{
+    return nullptr;
+}
+
+void pme_gpu_getEnergyAndVirial(const gmx_pme_t& /*pme*/, float /*lambda*/, PmeOutput* /*output*/) {}
+
+PmeOutput pme_gpu_getOutput(const gmx_pme_t& /*pme*/, bool /*computeEnergyAndVirial*/, real /*lambdaQ*/)
+{
+    return PmeOutput{};
+}
+
+void pme_gpu_update_input_box(PmeGpu* /*pmeGpu*/, const matrix /*box*/) {}
+
+void pme_gpu_get_real_grid_sizes(const PmeGpu* /*pmeGpu*/, gmx::IVec* /*gridSize*/, gmx::IVec* /*paddedGridSize*/)
+{
+}
+
+void pme_gpu_reinit(gmx_pme_t* /*pme*/,
+                    const DeviceContext* /*deviceContext*/,
+                    const DeviceStream* /*deviceStream*/,
+                    const PmeGpuProgram* /*pmeGpuProgram*/)
+{
+}
+
+void pme_gpu_destroy(PmeGpu* /*pmeGpu*/) {}
+
+void pme_gpu_reinit_atoms(PmeGpu* /*pmeGpu*/, int /*nAtoms*/, const real* /*chargesA*/, const real* /*chargesB*/)
+{
+}
+
+PmeOutput pme_gpu_wait_finish_task(gmx_pme_t* /*pme*/,
+                                   bool /*computeEnergyAndVirial*/,
+                                   real /*lambdaQ*/,
+                                   gmx_wallcycle* /*wcycle*/)
+{
+    return PmeOutput{};
+}
@@ -115,6 +115,10 @@ struct PmeGpuGridParams
 {
     /*! \brief Ewald solving factor = (M_PI / pme->ewaldcoeff_q)^2 */
     float ewaldFactor;
+    /*! \brief LJ-PME solving factor = (M_PI / pme->ewaldcoeff_lj)^2 */
+    float ewaldFactorLJ;
+    /*! \brief LJ-PME denominator factor = 3 / (M_PI^(3/2) * pme->ewaldcoeff_lj^3) */
+    float ewaldDenomFactorLJ;
 
     /* Grid sizes */
     /*! \brief Real-space grid data dimensions. */
@@ -204,6 +208,9 @@ struct PmeGpuDynamicParams
 
     /*! \brief The current coefficient scaling value. */
     float scale;
+    /*! \brief The coefficient scaling value for the second grid:
+     * (1 - scale) with perturbed charges, 1 when the second grid holds the LJ-PME coefficients. */
+    float scaleB;
 };
 
 /*! \internal \brief
@@ -102,12 +102,17 @@ struct PmeShared
 {
     /*! \brief Grid count */
     int ngrids;
+    /*! \brief Whether the second grid is used for LJ-PME with geometric combination rule
+     * (instead of for the Coulomb charges of FEP state B) */
+    bool doLJ;
     /*! \brief Grid dimensions - nkx, nky, nkz */
     int nk[DIM];
     /*! \brief PME interpolation order */
     int pme_order;
     /*! \brief Ewald splitting coefficient for Coulomb */
     real ewaldcoeff_q;
+    /*! \brief Ewald splitting coefficient for LJ */
+    real ewaldcoeff_lj;
     /*! \brief Electrostatics parameter */
     real epsilon_r;
     /*! \brief Gridline indices - nnx, nny, nnz */
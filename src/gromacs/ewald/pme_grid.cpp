@@ -49,6 +49,7 @@
 #include "gromacs/math/vec.h"
 #include "gromacs/timing/cyclecounter.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/smalloc.h"
 
 #include "pme_internal.h"
@@ -427,6 +428,83 @@ void wrap_periodic_pmegrid(const gmx_pme_t* pme, real* pmegrid)
     }
 }
 
+void copy_wrapped_pmegrid_to_fftgrid(const gmx_pme_t* pme,
+                                     const real*      pmegrid,
+                                     real*            fftgrid,
+                                     int              grid_index)
+{
+    GMX_ASSERT(pme->nnodes == 1, "Wrapping while copying requires the whole grid on this rank");
+
+    ivec local_fft_ndata, local_fft_offset, local_fft_size;
+
+    gmx_parallel_3dfft_real_limits(pme->pfft_setup[grid_index], local_fft_ndata, local_fft_offset,
+                                   local_fft_size);
+
+    const int nx      = pme->nkx;
+    const int ny      = pme->nky;
+    const int nz      = pme->nkz;
+    const int pny     = pme->pmegrid_ny;
+    const int pnz     = pme->pmegrid_nz;
+    const int overlap = pme->pme_order - 1;
+
+    GMX_ASSERT(local_fft_ndata[XX] == nx && local_fft_ndata[YY] == ny && local_fft_ndata[ZZ] == nz,
+               "With a single rank the FFT grid should cover the whole PME grid");
+
+    /* Returns the value at z-index iz of row with the periodic overlap in z added */
+    auto wrappedInZ = [overlap, nz](const real* row, int iz) {
+        return iz < overlap ? row[iz] + row[nz + iz] : row[iz];
+    };
+
+    /* We add the overlap in the same order as wrap_periodic_pmegrid(),
+     * first z, then y, then x, so the results are identical.
+     */
+    for (int ix = 0; ix < nx; ix++)
+    {
+        for (int iy = 0; iy < ny; iy++)
+        {
+            const real* row   = pmegrid + (ix * pny + iy) * pnz;
+            const real* rowY  = (iy < overlap) ? pmegrid + (ix * pny + ny + iy) * pnz : nullptr;
+            const real* rowX  = (ix < overlap) ? pmegrid + ((nx + ix) * pny + iy) * pnz : nullptr;
+            const real* rowXY = (ix < overlap && iy < overlap)
+                                        ? pmegrid + ((nx + ix) * pny + ny + iy) * pnz
+                                        : nullptr;
+            real*       fftRow = fftgrid + (ix * local_fft_size[YY] + iy) * local_fft_size[ZZ];
+
+            if (rowY == nullptr && rowX == nullptr)
+            {
+                /* Only wrap in z, this is the bulk of the grid */
+                for (int iz = 0; iz < overlap; iz++)
+                {
+                    fftRow[iz] = row[iz] + row[nz + iz];
+                }
+                for (int iz = overlap; iz < nz; iz++)
+                {
+                    fftRow[iz] = row[iz];
+                }
+                continue;
+            }
+
+            for (int iz = 0; iz < nz; iz++)
+            {
+                real value = wrappedInZ(row, iz);
+                if (rowY)
+                {
+                    value += wrappedInZ(rowY, iz);
+                }
+                if (rowX)
+                {
+                    real valueX = wrappedInZ(rowX, iz);
+                    if (rowXY)
+                    {
+                        valueX += wrappedInZ(rowXY, iz);
+                    }
+                    value += valueX;
+                }
+                fftRow[iz] = value;
+            }
+        }
+    }
+}
 
 void unwrap_periodic_pmegrid(struct gmx_pme_t* pme, real* pmegrid)
 {
@@ -65,6 +65,17 @@ int copy_fftgrid_to_pmegrid(gmx_pme_t* pme, const real* fftgrid, real* pmegrid,
 
 void wrap_periodic_pmegrid(const gmx_pme_t* pme, real* pmegrid);
 
+/*! \brief Copies the PME grid to the FFT grid, adding the periodic overlap on the fly
+ *
+ * Produces the same FFT grid as wrap_periodic_pmegrid() followed by
+ * copy_pmegrid_to_fftgrid(), but in a single pass over the grids,
+ * and without modifying \p pmegrid. Can only be used with a single PME rank.
+ */
+void copy_wrapped_pmegrid_to_fftgrid(const gmx_pme_t* pme,
+                                     const real*      pmegrid,
+                                     real*            fftgrid,
+                                     int              grid_index);
+
 void unwrap_periodic_pmegrid(gmx_pme_t* pme, real* pmegrid);
 
 void pmegrid_init(pmegrid_t* grid,
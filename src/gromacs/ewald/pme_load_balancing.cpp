@@ -93,6 +93,7 @@ struct pme_setup_t
     real rlistInner;           /**< cut-off for the inner pair-list              */
     real spacing;              /**< (largest) PME grid spacing                   */
     ivec grid;                 /**< the PME grid dimensions                      */
+    int  pme_order;            /**< the PME interpolation order                  */
     real grid_efficiency;      /**< ineffiency factor for non-uniform grids <= 1 */
     real ewaldcoeff_q;         /**< Electrostatic Ewald coefficient            */
     real ewaldcoeff_lj;        /**< LJ Ewald coefficient, only for the call to send_switchgrid */
@@ -186,6 +187,9 @@ struct pme_load_balancing_t
 
     int stage; /**< the current stage */
 
+    bool tunePmeOrder;  /**< should we also try the other PME interpolation order? */
+    int  pmeOrderTrial; /**< index of the setup with the other PME order, -1 when not added */
+
     int    cycles_n;  /**< step cycle counter cumulative count */
     double cycles_c;  /**< step cycle counter cumulative cycles */
     double startTime; /**< time stamp when the balancing was started on the master rank (relative to the UNIX epoch start).*/
@@ -257,6 +261,7 @@ void pme_loadbal_init(pme_load_balancing_t**     pme_lb_p,
     pme_lb->setup[0].grid[XX]      = ir.nkx;
     pme_lb->setup[0].grid[YY]      = ir.nky;
     pme_lb->setup[0].grid[ZZ]      = ir.nkz;
+    pme_lb->setup[0].pme_order     = ir.pme_order;
     pme_lb->setup[0].ewaldcoeff_q  = ic.ewaldcoeff_q;
     pme_lb->setup[0].ewaldcoeff_lj = ic.ewaldcoeff_lj;
 
@@ -289,6 +294,19 @@ void pme_loadbal_init(pme_load_balancing_t**     pme_lb_p,
 
     pme_lb->stage = 0;
 
+    /* Changing the interpolation order is only supported with PME on the CPU
+     * of the PP ranks, as GPU PME only supports order 4.
+     */
+    pme_lb->tunePmeOrder = (getenv("GMX_PME_TUNE_ORDER") != nullptr && !pme_lb->bSepPMERanks
+                            && !pme_gpu_task_enabled(pmedata)
+                            && (ir.pme_order == 4 || ir.pme_order == 5));
+    pme_lb->pmeOrderTrial = -1;
+    if (pme_lb->tunePmeOrder)
+    {
+        GMX_LOG(mdlog.info)
+                .appendText("PME load balancing will also try a different PME interpolation order");
+    }
+
     pme_lb->fastest     = 0;
     pme_lb->lower_limit = 0;
     pme_lb->start       = 0;
@@ -358,7 +376,8 @@ static gmx_bool pme_loadbal_increase_cutoff(pme_load_balancing_t* pme_lb, int pm
     /* Try to add a new setup with next larger cut-off to the list */
     pme_setup_t set;
 
-    set.pmedata = nullptr;
+    set.pmedata   = nullptr;
+    set.pme_order = pme_order;
 
     NumPmeDomains numPmeDomains = getNumPmeDomains(dd);
 
@@ -445,11 +464,72 @@ static gmx_bool pme_loadbal_increase_cutoff(pme_load_balancing_t* pme_lb, int pm
     return TRUE;
 }
 
+/*! \brief Try to add a setup using the other PME order with the cut-off of the fastest setup
+ *
+ * For a fixed Ewald coefficient beta, the reciprocal-space error is dominated
+ * by a term proportional to (beta h)^order, with h the grid spacing.
+ * We choose the spacing for the other order such that this term is unchanged,
+ * which gives a coarser grid with order 5 and a finer grid with order 4.
+ */
+static bool pme_loadbal_add_order_trial(pme_load_balancing_t* pme_lb, const gmx_domdec_t* dd)
+{
+    const pme_setup_t& fastest = pme_lb->setup[pme_lb->fastest];
+
+    pme_setup_t set = fastest;
+
+    set.pmedata   = nullptr;
+    set.pme_order = (fastest.pme_order == 4 ? 5 : 4);
+
+    const real betaH    = fastest.ewaldcoeff_q * fastest.spacing;
+    const real exponent = fastest.pme_order / static_cast<real>(set.pme_order);
+    const real spacing  = std::pow(betaH, exponent) / fastest.ewaldcoeff_q;
+
+    clear_ivec(set.grid);
+    set.spacing = calcFftGrid(nullptr, pme_lb->box_start, spacing,
+                              minimalPmeGridSize(set.pme_order), &set.grid[XX], &set.grid[YY],
+                              &set.grid[ZZ]);
+
+    NumPmeDomains numPmeDomains = getNumPmeDomains(dd);
+    if (!gmx_pme_check_restrictions(set.pme_order, set.grid[XX], set.grid[YY], set.grid[ZZ],
+                                    numPmeDomains.x, true, false))
+    {
+        return false;
+    }
+
+    set.grid_efficiency = 1;
+    for (int d = 0; d < DIM; d++)
+    {
+        set.grid_efficiency *= (set.grid[d] * set.spacing) / norm(pme_lb->box_start[d]);
+    }
+
+    set.count  = 0;
+    set.cycles = 0;
+
+    if (debug)
+    {
+        fprintf(debug, "PME loadbal: grid %d %d %d, coulomb cutoff %f, pme order %d\n",
+                set.grid[XX], set.grid[YY], set.grid[ZZ], set.rcut_coulomb, set.pme_order);
+    }
+    pme_lb->pmeOrderTrial = pme_lb->setup.size();
+    pme_lb->setup.push_back(set);
+    return true;
+}
+
 /*! \brief Print the PME grid */
-static void print_grid(FILE* fp_err, FILE* fp_log, const char* pre, const char* desc, const pme_setup_t* set, double cycles)
+static void print_grid(FILE*              fp_err,
+                       FILE*              fp_log,
+                       const char*        pre,
+                       const char*        desc,
+                       const pme_setup_t* set,
+                       double             cycles,
+                       bool               printPmeOrder)
 {
     auto buf = gmx::formatString("%-11s%10s pme grid %d %d %d, coulomb cutoff %.3f", pre, desc,
                                  set->grid[XX], set->grid[YY], set->grid[ZZ], set->rcut_coulomb);
+    if (printPmeOrder)
+    {
+        buf += gmx::formatString(", pme order %d", set->pme_order);
+    }
     if (cycles >= 0)
     {
         buf += gmx::formatString(": %.1f M-cycles", cycles * 1e-6);
@@ -589,7 +669,7 @@ static void pme_load_balance(pme_load_balancing_t*          pme_lb,
     }
 
     sprintf(buf, "step %4s: ", gmx_step_str(step, sbuf));
-    print_grid(fp_err, fp_log, buf, "timed with", set, cycles);
+    print_grid(fp_err, fp_log, buf, "timed with", set, cycles, pme_lb->tunePmeOrder);
 
     GMX_RELEASE_ASSERT(set->count > c_numPostSwitchTuningIntervalSkip, "We should skip cycles");
     if (set->count == (c_numPostSwitchTuningIntervalSkip + 1))
@@ -642,6 +722,13 @@ static void pme_load_balance(pme_load_balancing_t*          pme_lb,
     }
     cycles_fast = pme_lb->setup[pme_lb->fastest].cycles;
 
+    if (pme_lb->cur == pme_lb->pmeOrderTrial && set->count == c_numPostSwitchTuningIntervalSkip + 1)
+    {
+        /* We have timed the other PME order, this was the last setup to try */
+        pme_lb->stage = pme_lb->nstage;
+        pme_lb->cur   = pme_lb->fastest;
+    }
+
     /* Check in stage 0 if we should stop scanning grids.
      * Stop when the time is more than maxRelativeSlowDownAccepted longer than the fastest.
      */
@@ -727,12 +814,12 @@ static void pme_load_balance(pme_load_balancing_t*          pme_lb,
                                  < pme_lb->setup[pme_lb->cur - 1].grid_efficiency * relativeEfficiencyFactor));
     }
 
-    if (pme_lb->stage > 0 && pme_lb->end == 1)
+    if (pme_lb->stage > 0 && pme_lb->stage < pme_lb->nstage && pme_lb->end == 1)
     {
         pme_lb->cur   = pme_lb->lower_limit;
         pme_lb->stage = pme_lb->nstage;
     }
-    else if (pme_lb->stage > 0 && pme_lb->end > 1)
+    else if (pme_lb->stage > 0 && pme_lb->stage < pme_lb->nstage && pme_lb->end > 1)
     {
         /* If stage = nstage-1:
          *   scan over all setups, rerunning only those setups
@@ -765,6 +852,14 @@ static void pme_load_balance(pme_load_balancing_t*          pme_lb,
         }
     }
 
+    if (pme_lb->stage == pme_lb->nstage && pme_lb->tunePmeOrder && pme_lb->pmeOrderTrial < 0
+        && pme_loadbal_add_order_trial(pme_lb, cr->dd))
+    {
+        /* Time the cut-off of the fastest setup with the other PME order */
+        pme_lb->cur   = pme_lb->pmeOrderTrial;
+        pme_lb->stage = pme_lb->nstage - 1;
+    }
+
     if (DOMAINDECOMP(cr) && pme_lb->stage > 0)
     {
         OK = change_dd_cutoff(cr, box, x, pme_lb->setup[pme_lb->cur].rlistOuter);
@@ -853,7 +948,7 @@ static void pme_load_balance(pme_load_balancing_t*          pme_lb,
              * copying part of the old pointers.
              */
             gmx_pme_reinit(&set->pmedata, cr, pme_lb->setup[0].pmedata, &ir, set->grid,
-                           set->ewaldcoeff_q, set->ewaldcoeff_lj);
+                           set->pme_order, set->ewaldcoeff_q, set->ewaldcoeff_lj);
         }
         *pmedata = set->pmedata;
     }
@@ -865,12 +960,12 @@ static void pme_load_balance(pme_load_balancing_t*          pme_lb,
 
     if (debug)
     {
-        print_grid(nullptr, debug, "", "switched to", set, -1);
+        print_grid(nullptr, debug, "", "switched to", set, -1, pme_lb->tunePmeOrder);
     }
 
     if (pme_lb->stage == pme_lb->nstage)
     {
-        print_grid(fp_err, fp_log, "", "optimal", set, -1);
+        print_grid(fp_err, fp_log, "", "optimal", set, -1, pme_lb->tunePmeOrder);
     }
 }
 
@@ -1117,6 +1212,11 @@ static void print_pme_loadbal_settings(pme_load_balancing_t* pme_lb,
     fprintf(fplog, "            rcoulomb  rlist            grid      spacing   1/beta\n");
     print_pme_loadbal_setting(fplog, "initial", &pme_lb->setup[0]);
     print_pme_loadbal_setting(fplog, "final", &pme_lb->setup[pme_lb->cur]);
+    if (pme_lb->setup[pme_lb->cur].pme_order != pme_lb->setup[0].pme_order)
+    {
+        fprintf(fplog, " PME interpolation order changed from %d to %d\n",
+                pme_lb->setup[0].pme_order, pme_lb->setup[pme_lb->cur].pme_order);
+    }
     fprintf(fplog, " cost-ratio           %4.2f             %4.2f\n", pp_ratio, grid_ratio);
     fprintf(fplog, " (note that these numbers concern only part of the total PP and PME load)\n");
 
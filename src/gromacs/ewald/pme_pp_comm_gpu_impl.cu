@@ -47,6 +47,7 @@
 
 #include "config.h"
 
+#include "gromacs/ewald/pme_pp_communication.h"
 #include "gromacs/gpu_utils/cudautils.cuh"
 #include "gromacs/gpu_utils/device_context.h"
 #include "gromacs/gpu_utils/device_stream.h"
@@ -66,19 +67,20 @@ PmePpCommGpu::Impl::Impl(MPI_Comm             comm,
     comm_(comm),
     pmeRank_(pmeRank)
 {
-    GMX_RELEASE_ASSERT(
-            GMX_THREAD_MPI,
-            "PME-PP GPU Communication is currently only supported with thread-MPI enabled");
+    GMX_RELEASE_ASSERT(GMX_THREAD_MPI || GMX_LIB_MPI,
+                       "PME-PP GPU Communication is only supported with an MPI build");
 }
 
 PmePpCommGpu::Impl::~Impl() = default;
 
 void PmePpCommGpu::Impl::reinit(int size)
 {
-    // This rank will access PME rank memory directly, so needs to receive the remote PME buffer addresses.
 #if GMX_MPI
+#    if GMX_THREAD_MPI
+    // This rank will access PME rank memory directly, so needs to receive the remote PME buffer addresses.
     MPI_Recv(&remotePmeXBuffer_, sizeof(void**), MPI_BYTE, pmeRank_, 0, comm_, MPI_STATUS_IGNORE);
     MPI_Recv(&remotePmeFBuffer_, sizeof(void**), MPI_BYTE, pmeRank_, 0, comm_, MPI_STATUS_IGNORE);
+#    endif
 
     // Reallocate buffer used for staging PME force on GPU
     reallocateDeviceBuffer(&d_pmeForces_, size, &d_pmeForcesSize_, &d_pmeForcesSizeAlloc_, deviceContext_);
@@ -93,6 +95,14 @@ void PmePpCommGpu::Impl::reinit(int size)
 void PmePpCommGpu::Impl::receiveForceFromPmeCudaDirect(void* recvPtr, int recvSize, bool receivePmeForceToGpu)
 {
 #if GMX_MPI
+    void* pmeForcePtr = receivePmeForceToGpu ? static_cast<void*>(d_pmeForces_) : recvPtr;
+#    if GMX_LIB_MPI
+    // The PME rank can be on another node, so let the CUDA-aware MPI
+    // library receive the force data, which the PME rank sends once
+    // its force calculation is completed
+    MPI_Recv(pmeForcePtr, recvSize * DIM * sizeof(float), MPI_BYTE, pmeRank_, 0, comm_,
+             MPI_STATUS_IGNORE);
+#    else
     // Receive event from PME task and add to stream, to ensure pull of data doesn't
     // occur before PME force calc is completed
     GpuEventSynchronizer* pmeSync;
@@ -100,10 +110,10 @@ void PmePpCommGpu::Impl::receiveForceFromPmeCudaDirect(void* recvPtr, int recvSi
     pmeSync->enqueueWaitEvent(pmePpCommStream_);
 
     // Pull force data from remote GPU
-    void*       pmeForcePtr = receivePmeForceToGpu ? static_cast<void*>(d_pmeForces_) : recvPtr;
     cudaError_t stat = cudaMemcpyAsync(pmeForcePtr, remotePmeFBuffer_, recvSize * DIM * sizeof(float),
                                        cudaMemcpyDefault, pmePpCommStream_.stream());
     CU_RET_ERR(stat, "cudaMemcpyAsync on Recv from PME CUDA direct data transfer failed");
+#    endif
 
     if (receivePmeForceToGpu)
     {
@@ -112,7 +122,7 @@ void PmePpCommGpu::Impl::receiveForceFromPmeCudaDirect(void* recvPtr, int recvSi
         // reducing it with the other force contributions.
         forcesReadySynchronizer_.markEvent(pmePpCommStream_);
     }
-    else
+    else if (GMX_THREAD_MPI)
     {
         // Ensure CPU waits for PME forces to be copied before reducing
         // them with other forces on the CPU
@@ -130,7 +140,13 @@ void PmePpCommGpu::Impl::sendCoordinatesToPmeCudaDirect(void* sendPtr,
                                                         bool gmx_unused sendPmeCoordinatesFromGpu,
                                                         GpuEventSynchronizer* coordinatesReadyOnDeviceEvent)
 {
-#if GMX_MPI
+#if GMX_LIB_MPI
+    // The PME rank can be on another node, so let the CUDA-aware MPI
+    // library send the coordinates once they are available on device
+    coordinatesReadyOnDeviceEvent->waitForEvent();
+    MPI_Send(sendPtr, sendSize * DIM * sizeof(float), MPI_BYTE, pmeRank_, eCommType_COORD_GPU,
+             comm_);
+#elif GMX_MPI
     // ensure stream waits until coordinate data is available on device
     coordinatesReadyOnDeviceEvent->enqueueWaitEvent(pmePpCommStream_);
 
@@ -122,7 +122,7 @@ static void realloc_work(struct pme_solve_work_t* work, int nkx)
         srenew(work->mhx, work->nalloc);
         srenew(work->mhy, work->nalloc);
         srenew(work->mhz, work->nalloc);
-        srenew(work->m2, work->nalloc);
+        reallocSimdAlignedAndPadded(&work->m2, work->nalloc);
         reallocSimdAlignedAndPadded(&work->denom, work->nalloc);
         reallocSimdAlignedAndPadded(&work->tmp1, work->nalloc);
         reallocSimdAlignedAndPadded(&work->tmp2, work->nalloc);
@@ -135,6 +135,7 @@ static void realloc_work(struct pme_solve_work_t* work, int nkx)
         for (size_t i = 0; i < roundUpToMultipleOfFactor<c_simdWidth>(work->nalloc); i++)
         {
             work->denom[i] = 1;
+            work->m2[i]    = 0;
         }
     }
 }
@@ -163,7 +164,7 @@ static void free_work(struct pme_solve_work_t* work)
         sfree(work->mhx);
         sfree(work->mhy);
         sfree(work->mhz);
-        sfree(work->m2);
+        sfree_aligned(work->m2);
         sfree_aligned(work->denom);
         sfree_aligned(work->tmp1);
         sfree_aligned(work->tmp2);
@@ -323,6 +324,61 @@ calc_exponentials_lj(int start, int end, ArrayRef<real> r, ArrayRef<real> tmp2,
 }
 #endif
 
+#if defined PME_SIMD_SOLVE
+/* Compute the LJ energy and, optionally, virial terms through SIMD */
+inline static void calc_energy_terms_lj(int /*unused*/,
+                                        int /*unused*/,
+                                        real                     factor,
+                                        bool                     computeVirialTerm,
+                                        ArrayRef<const SimdReal> m2_aligned,
+                                        ArrayRef<const SimdReal> d_aligned,
+                                        ArrayRef<SimdReal>       tmp1_aligned,
+                                        ArrayRef<SimdReal>       tmp2_aligned)
+{
+    const SimdReal factor_simd(factor);
+    const SimdReal one(1.0);
+    const SimdReal two(2.0);
+    const SimdReal three(3.0);
+
+    GMX_ASSERT(m2_aligned.size() == d_aligned.size(), "m2 and d must have same size");
+    GMX_ASSERT(m2_aligned.size() == tmp1_aligned.size(), "m2 and tmp1 must have same size");
+    GMX_ASSERT(m2_aligned.size() == tmp2_aligned.size(), "m2 and tmp2 must have same size");
+    for (size_t kx = 0; kx != m2_aligned.size(); ++kx)
+    {
+        const SimdReal twoM2k = two * factor_simd * m2_aligned[kx];
+        const SimdReal tmp1   = tmp1_aligned[kx];
+        const SimdReal tmp2   = tmp2_aligned[kx];
+        const SimdReal eterm  = -((one - twoM2k) * tmp1 + twoM2k * tmp2);
+        tmp1_aligned[kx]      = eterm * d_aligned[kx];
+        if (computeVirialTerm)
+        {
+            tmp2_aligned[kx] = three * (-tmp1 + tmp2) * d_aligned[kx];
+        }
+    }
+}
+#else
+inline static void calc_energy_terms_lj(int            start,
+                                        int            end,
+                                        real           factor,
+                                        bool           computeVirialTerm,
+                                        ArrayRef<real> m2,
+                                        ArrayRef<real> d,
+                                        ArrayRef<real> tmp1,
+                                        ArrayRef<real> tmp2)
+{
+    for (int kx = start; kx < end; kx++)
+    {
+        const real m2k   = factor * m2[kx];
+        const real eterm = -((1.0 - 2.0 * m2k) * tmp1[kx] + 2.0 * m2k * tmp2[kx]);
+        if (computeVirialTerm)
+        {
+            tmp2[kx] = 3.0 * (-tmp1[kx] + tmp2[kx]) * d[kx];
+        }
+        tmp1[kx] = eterm * d[kx];
+    }
+}
+#endif
+
 #if defined PME_SIMD_SOLVE
 using PME_T = SimdReal;
 #else
@@ -731,14 +787,12 @@ int solve_pme_lj_yzx(const gmx_pme_t* pme,
                     ArrayRef<PME_T>(tmp2, tmp2 + roundUpToMultipleOfFactor<c_simdWidth>(kxend)),
                     ArrayRef<PME_T>(denom, denom + roundUpToMultipleOfFactor<c_simdWidth>(kxend)));
 
-            for (kx = kxstart; kx < kxend; kx++)
-            {
-                m2k      = factor * m2[kx];
-                eterm    = -((1.0 - 2.0 * m2k) * tmp1[kx] + 2.0 * m2k * tmp2[kx]);
-                vterm    = 3.0 * (-tmp1[kx] + tmp2[kx]);
-                tmp1[kx] = eterm * denom[kx];
-                tmp2[kx] = vterm * denom[kx];
-            }
+            calc_energy_terms_lj(
+                    kxstart, kxend, factor, true,
+                    ArrayRef<PME_T>(m2, m2 + roundUpToMultipleOfFactor<c_simdWidth>(kxend)),
+                    ArrayRef<PME_T>(denom, denom + roundUpToMultipleOfFactor<c_simdWidth>(kxend)),
+                    ArrayRef<PME_T>(tmp1, tmp1 + roundUpToMultipleOfFactor<c_simdWidth>(kxend)),
+                    ArrayRef<PME_T>(tmp2, tmp2 + roundUpToMultipleOfFactor<c_simdWidth>(kxend)));
 
             if (!bLB)
             {
@@ -771,7 +825,9 @@ int solve_pme_lj_yzx(const gmx_pme_t* pme,
                 {
                     struct2[kx] = 0.0;
                 }
-                /* Due to symmetry we only need to calculate 4 of the 7 terms */
+                /* Due to symmetry we only need to calculate 4 of the 7 terms.
+                 * We scale each grid pair in the same pass over memory.
+                 */
                 for (ig = 0; ig <= 3; ++ig)
                 {
                     t_complex *p0, *p1;
@@ -780,24 +836,33 @@ int solve_pme_lj_yzx(const gmx_pme_t* pme,
                     p0 = grid[ig] + iy * local_size[ZZ] * local_size[XX] + iz * local_size[XX];
                     p1 = grid[6 - ig] + iy * local_size[ZZ] * local_size[XX] + iz * local_size[XX];
                     scale = 2.0 * lb_scale_factor_symm[ig];
-                    for (kx = kxstart; kx < kxend; ++kx, ++p0, ++p1)
+                    if (ig < 3)
                     {
-                        struct2[kx] += scale * (p0->re * p1->re + p0->im * p1->im);
+                        for (kx = kxstart; kx < kxend; ++kx, ++p0, ++p1)
+                        {
+                            struct2[kx] += scale * (p0->re * p1->re + p0->im * p1->im);
+
+                            eterm  = tmp1[kx];
+                            p0->re = p0->re * eterm;
+                            p0->im = p0->im * eterm;
+                            p1->re = p1->re * eterm;
+                            p1->im = p1->im * eterm;
+                        }
                     }
-                }
-                for (ig = 0; ig <= 6; ++ig)
-                {
-                    t_complex* p0;
-
-                    p0 = grid[ig] + iy * local_size[ZZ] * local_size[XX] + iz * local_size[XX];
-                    for (kx = kxstart; kx < kxend; kx++, p0++)
+                    else
                     {
-                        d1 = p0->re;
-                        d2 = p0->im;
-
-                        eterm  = tmp1[kx];
-                        p0->re = d1 * eterm;
-                        p0->im = d2 * eterm;
+                        /* The middle grid is paired with itself */
+                        for (kx = kxstart; kx < kxend; ++kx, ++p0)
+                        {
+                            d1 = p0->re;
+                            d2 = p0->im;
+
+                            struct2[kx] += scale * (d1 * d1 + d2 * d2);
+
+                            eterm  = tmp1[kx];
+                            p0->re = d1 * eterm;
+                            p0->im = d2 * eterm;
+                        }
                     }
                 }
                 for (kx = kxstart; kx < kxend; kx++)
@@ -873,12 +938,12 @@ int solve_pme_lj_yzx(const gmx_pme_t* pme,
                     ArrayRef<PME_T>(tmp2, tmp2 + roundUpToMultipleOfFactor<c_simdWidth>(kxend)),
                     ArrayRef<PME_T>(denom, denom + roundUpToMultipleOfFactor<c_simdWidth>(kxend)));
 
-            for (kx = kxstart; kx < kxend; kx++)
-            {
-                m2k      = factor * m2[kx];
-                eterm    = -((1.0 - 2.0 * m2k) * tmp1[kx] + 2.0 * m2k * tmp2[kx]);
-                tmp1[kx] = eterm * denom[kx];
-            }
+            calc_energy_terms_lj(
+                    kxstart, kxend, factor, false,
+                    ArrayRef<PME_T>(m2, m2 + roundUpToMultipleOfFactor<c_simdWidth>(kxend)),
+                    ArrayRef<PME_T>(denom, denom + roundUpToMultipleOfFactor<c_simdWidth>(kxend)),
+                    ArrayRef<PME_T>(tmp1, tmp1 + roundUpToMultipleOfFactor<c_simdWidth>(kxend)),
+                    ArrayRef<PME_T>(tmp2, tmp2 + roundUpToMultipleOfFactor<c_simdWidth>(kxend)));
             gcount = (bLB ? 7 : 1);
             for (ig = 0; ig < gcount; ++ig)
             {
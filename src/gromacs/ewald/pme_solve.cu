@@ -55,9 +55,11 @@
  * \tparam[in] gridOrdering             Specifies the dimension ordering of the complex grid.
  * \tparam[in] computeEnergyAndVirial   Tells if the reciprocal energy and virial should be computed.
  * \tparam[in] gridIndex                The index of the grid to use in the kernel.
+ * \tparam[in] solveLJ                  Tells if the grid holds LJ-PME (geometric) coefficients
+ *                                      instead of charges.
  * \param[in]  kernelParams             Input PME CUDA data in constant memory.
  */
-template<GridOrdering gridOrdering, bool computeEnergyAndVirial, const int gridIndex>
+template<GridOrdering gridOrdering, bool computeEnergyAndVirial, const int gridIndex, bool solveLJ>
 __launch_bounds__(c_solveMaxThreadsPerBlock) CLANG_DISABLE_OPTIMIZATION_ATTRIBUTE __global__
         void pme_solve_kernel(const struct PmeGpuCudaKernelParams kernelParams)
 {
@@ -154,7 +156,7 @@ __launch_bounds__(c_solveMaxThreadsPerBlock) CLANG_DISABLE_OPTIMIZATION_ATTRIBUT
         {
             mMinor = (kMinor < maxkMinor) ? kMinor : (kMinor - nMinor);
         }
-        /* We should skip the k-space point (0,0,0) */
+        /* We should skip the k-space point (0,0,0) with Coulomb, but not with LJ */
         const bool notZeroPoint = (kMinor > 0) | (kMajor > 0) | (kMiddle > 0);
 
         float mX, mY, mZ;
@@ -196,7 +198,7 @@ __launch_bounds__(c_solveMaxThreadsPerBlock) CLANG_DISABLE_OPTIMIZATION_ATTRIBUT
             default: assert(false);
         }
 
-        if (notZeroPoint)
+        if (notZeroPoint | solveLJ)
         {
             const float mhxk = mX * kernelParams.current.recipBox[XX][XX];
             const float mhyk = mX * kernelParams.current.recipBox[XX][YY]
@@ -206,16 +208,38 @@ __launch_bounds__(c_solveMaxThreadsPerBlock) CLANG_DISABLE_OPTIMIZATION_ATTRIBUT
                                + mZ * kernelParams.current.recipBox[ZZ][ZZ];
 
             const float m2k = mhxk * mhxk + mhyk * mhyk + mhzk * mhzk;
-            assert(m2k != 0.0f);
+            assert(solveLJ || m2k != 0.0f);
             // TODO: use LDG/textures for gm_splineValue
-            float denom = m2k * float(CUDART_PI_F) * kernelParams.current.boxVolume
-                          * gm_splineValueMajor[kMajor] * gm_splineValueMiddle[kMiddle]
-                          * gm_splineValueMinor[kMinor];
-            assert(isfinite(denom));
-            assert(denom != 0.0f);
+            const float splineValues = gm_splineValueMajor[kMajor] * gm_splineValueMiddle[kMiddle]
+                                       * gm_splineValueMinor[kMinor];
 
-            const float tmp1   = expf(-kernelParams.grid.ewaldFactor * m2k);
-            const float etermk = kernelParams.constants.elFactor * tmp1 / denom;
+            float etermk;
+            /* The LJ virial term, see solve_pme_lj_yzx() */
+            float vtermkLJ = 0.0f;
+            if (solveLJ)
+            {
+                const float denom = kernelParams.grid.ewaldDenomFactorLJ
+                                    * kernelParams.current.boxVolume * splineValues;
+                assert(isfinite(denom));
+                assert(denom != 0.0f);
+
+                const float factorM2k = kernelParams.grid.ewaldFactorLJ * m2k;
+                const float mk        = sqrtf(factorM2k);
+                const float tmp1      = expf(-factorM2k);
+                const float tmp2      = sqrtf(float(CUDART_PI_F)) * mk * erfcf(mk);
+                etermk = -((1.0f - 2.0f * factorM2k) * tmp1 + 2.0f * factorM2k * tmp2) / denom;
+                vtermkLJ = 6.0f * kernelParams.grid.ewaldFactorLJ * (tmp2 - tmp1) / denom;
+            }
+            else
+            {
+                const float denom =
+                        m2k * float(CUDART_PI_F) * kernelParams.current.boxVolume * splineValues;
+                assert(isfinite(denom));
+                assert(denom != 0.0f);
+
+                const float tmp1 = expf(-kernelParams.grid.ewaldFactor * m2k);
+                etermk           = kernelParams.constants.elFactor * tmp1 / denom;
+            }
 
             float2       gridValue    = *gm_gridCell;
             const float2 oldGridValue = gridValue;
@@ -228,11 +252,22 @@ __launch_bounds__(c_solveMaxThreadsPerBlock) CLANG_DISABLE_OPTIMIZATION_ATTRIBUT
                 const float tmp1k =
                         2.0f * (gridValue.x * oldGridValue.x + gridValue.y * oldGridValue.y);
 
-                float vfactor = (kernelParams.grid.ewaldFactor + 1.0f / m2k) * 2.0f;
-                float ets2    = corner_fac * tmp1k;
-                energy        = ets2;
+                float ets2 = corner_fac * tmp1k;
+                energy     = ets2;
 
-                float ets2vf = ets2 * vfactor;
+                float ets2vf;
+                if (solveLJ)
+                {
+                    const float struct2 = 2.0f
+                                          * (oldGridValue.x * oldGridValue.x
+                                             + oldGridValue.y * oldGridValue.y);
+                    ets2vf = corner_fac * vtermkLJ * struct2;
+                }
+                else
+                {
+                    float vfactor = (kernelParams.grid.ewaldFactor + 1.0f / m2k) * 2.0f;
+                    ets2vf        = ets2 * vfactor;
+                }
 
                 virxx = ets2vf * mhxk * mhxk - ets2;
                 virxy = ets2vf * mhxk * mhyk;
@@ -354,11 +389,27 @@ __launch_bounds__(c_solveMaxThreadsPerBlock) CLANG_DISABLE_OPTIMIZATION_ATTRIBUT
 }
 
 //! Kernel instantiations
-template __global__ void pme_solve_kernel<GridOrdering::YZX, true, 0>(const PmeGpuCudaKernelParams);
-template __global__ void pme_solve_kernel<GridOrdering::YZX, false, 0>(const PmeGpuCudaKernelParams);
-template __global__ void pme_solve_kernel<GridOrdering::XYZ, true, 0>(const PmeGpuCudaKernelParams);
-template __global__ void pme_solve_kernel<GridOrdering::XYZ, false, 0>(const PmeGpuCudaKernelParams);
-template __global__ void pme_solve_kernel<GridOrdering::YZX, true, 1>(const PmeGpuCudaKernelParams);
-template __global__ void pme_solve_kernel<GridOrdering::YZX, false, 1>(const PmeGpuCudaKernelParams);
-template __global__ void pme_solve_kernel<GridOrdering::XYZ, true, 1>(const PmeGpuCudaKernelParams);
-template __global__ void pme_solve_kernel<GridOrdering::XYZ, false, 1>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::YZX, true, 0, false>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::YZX, false, 0, false>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::XYZ, true, 0, false>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::XYZ, false, 0, false>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::YZX, true, 1, false>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::YZX, false, 1, false>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::XYZ, true, 1, false>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::XYZ, false, 1, false>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::YZX, true, 1, true>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::YZX, false, 1, true>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::XYZ, true, 1, true>(const PmeGpuCudaKernelParams);
+template __global__ void
+pme_solve_kernel<GridOrdering::XYZ, false, 1, true>(const PmeGpuCudaKernelParams);
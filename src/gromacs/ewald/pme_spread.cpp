@@ -44,6 +44,7 @@
 #include <cassert>
 
 #include <algorithm>
+#include <functional>
 
 #include "gromacs/ewald/pme.h"
 #include "gromacs/fft/parallel_3dfft.h"
@@ -454,13 +455,22 @@ static void copy_local_grid(const gmx_pme_t* pme, const pmegrids_t* pmegrids, in
     }
 }
 
-static void reduce_threadgrid_overlap(const gmx_pme_t*  pme,
-                                      const pmegrids_t* pmegrids,
-                                      int               thread,
-                                      real*             fftgrid,
-                                      real*             commbuf_x,
-                                      real*             commbuf_y,
-                                      int               grid_index)
+//! Selects which destinations of the thread-grid overlap reduction are processed
+enum class ThreadGridReductionPart
+{
+    All,                  //!< Reduce to the local FFT grid and the communication buffers
+    CommunicationBuffers, //!< Only reduce to the communication buffers
+    LocalGrid             //!< Only reduce to the local FFT grid
+};
+
+static void reduce_threadgrid_overlap(const gmx_pme_t*              pme,
+                                      const pmegrids_t*             pmegrids,
+                                      int                           thread,
+                                      real*                         fftgrid,
+                                      real*                         commbuf_x,
+                                      real*                         commbuf_y,
+                                      int                           grid_index,
+                                      const ThreadGridReductionPart reductionPart)
 {
     ivec             local_fft_ndata, local_fft_offset, local_fft_size;
     int              fft_nx, fft_ny, fft_nz;
@@ -596,6 +606,15 @@ static void reduce_threadgrid_overlap(const gmx_pme_t*  pme,
                     continue;
                 }
 
+                const bool toCommunicationBuffer = (bCommX || bCommY);
+                if ((reductionPart == ThreadGridReductionPart::CommunicationBuffers
+                     && !toCommunicationBuffer)
+                    || (reductionPart == ThreadGridReductionPart::LocalGrid
+                        && toCommunicationBuffer))
+                {
+                    continue;
+                }
+
                 thread_f = (fx * pmegrids->nc[YY] + fy) * pmegrids->nc[ZZ] + fz;
 
                 pmegrid_f = &pmegrids->grid_th[thread_f];
@@ -613,7 +632,7 @@ static void reduce_threadgrid_overlap(const gmx_pme_t*  pme,
                        ty1 - oy, offy, ty1, offz - oz, tz1 - oz, offz, tz1);
 #endif
 
-                if (!(bCommX || bCommY))
+                if (!toCommunicationBuffer)
                 {
                     /* Copy from the thread local grid to the node grid */
                     for (x = offx; x < tx1; x++)
@@ -697,14 +716,66 @@ static void reduce_threadgrid_overlap(const gmx_pme_t*  pme,
 }
 
 
-static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
+/*! \brief Exchanges grid overlap data with neighboring ranks
+ *
+ * When \p overlappedWork is set, it is run while the messages are in flight
+ * and cleared afterwards, so only the first exchange is overlapped.
+ */
+static void sendRecvGridOverlap(real*                  sendptr,
+                                int                    sendCount,
+                                int                    sendRank,
+                                real*                  recvptr,
+                                int                    recvCount,
+                                int                    recvRank,
+                                int                    tag,
+                                MPI_Comm               comm,
+                                std::function<void()>* overlappedWork)
+{
+#if GMX_MPI
+    if (*overlappedWork)
+    {
+        MPI_Request requests[2];
+        MPI_Irecv(recvptr, recvCount, GMX_MPI_REAL, recvRank, tag, comm, &requests[0]);
+        MPI_Isend(sendptr, sendCount, GMX_MPI_REAL, sendRank, tag, comm, &requests[1]);
+
+        (*overlappedWork)();
+        *overlappedWork = nullptr;
+
+        MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+    }
+    else
+    {
+        MPI_Status stat;
+        MPI_Sendrecv(sendptr, sendCount, GMX_MPI_REAL, sendRank, tag, recvptr, recvCount,
+                     GMX_MPI_REAL, recvRank, tag, comm, &stat);
+    }
+#else
+    GMX_UNUSED_VALUE(sendptr);
+    GMX_UNUSED_VALUE(sendCount);
+    GMX_UNUSED_VALUE(sendRank);
+    GMX_UNUSED_VALUE(recvptr);
+    GMX_UNUSED_VALUE(recvCount);
+    GMX_UNUSED_VALUE(recvRank);
+    GMX_UNUSED_VALUE(tag);
+    GMX_UNUSED_VALUE(comm);
+    GMX_UNUSED_VALUE(overlappedWork);
+#endif
+}
+
+/*! \brief Sums the overlapping parts of the fftgrid over the neighboring ranks
+ *
+ * \p localWork, which should not touch the communication buffers,
+ * is run during the first communication.
+ */
+static void sum_fftgrid_dd(const gmx_pme_t*      pme,
+                           real*                 fftgrid,
+                           int                   grid_index,
+                           std::function<void()> localWork)
 {
     ivec local_fft_ndata, local_fft_offset, local_fft_size;
     int  send_index0, send_nindex;
     int  recv_nindex;
-#if GMX_MPI
-    MPI_Status stat;
-#endif
+
     int recv_size_y;
     int size_yx;
     int x, y, z, indg, indb;
@@ -732,11 +803,9 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
         {
             size_yx = 0;
         }
-#if GMX_MPI
         int datasize = (local_fft_ndata[XX] + size_yx) * local_fft_ndata[ZZ];
 
         int send_size_y = overlap->send_size;
-#endif
 
         for (size_t ipulse = 0; ipulse < overlap->comm_data.size(); ipulse++)
         {
@@ -756,12 +825,11 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
                         send_nindex, local_fft_ndata[ZZ]);
             }
 
-#if GMX_MPI
             int send_id = overlap->comm_data[ipulse].send_id;
             int recv_id = overlap->comm_data[ipulse].recv_id;
-            MPI_Sendrecv(sendptr, send_size_y * datasize, GMX_MPI_REAL, send_id, ipulse, recvptr,
-                         recv_size_y * datasize, GMX_MPI_REAL, recv_id, ipulse, overlap->mpi_comm, &stat);
-#endif
+            sendRecvGridOverlap(sendptr, send_size_y * datasize, send_id, recvptr,
+                                recv_size_y * datasize, recv_id, ipulse, overlap->mpi_comm,
+                                &localWork);
 
             for (x = 0; x < local_fft_ndata[XX]; x++)
             {
@@ -817,15 +885,13 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
                     local_fft_ndata[ZZ]);
         }
 
-#if GMX_MPI
         int   datasize = local_fft_ndata[YY] * local_fft_ndata[ZZ];
         int   send_id  = overlap->comm_data[ipulse].send_id;
         int   recv_id  = overlap->comm_data[ipulse].recv_id;
         auto* sendptr  = const_cast<real*>(overlap->sendbuf.data());
         auto* recvptr  = const_cast<real*>(overlap->recvbuf.data());
-        MPI_Sendrecv(sendptr, send_nindex * datasize, GMX_MPI_REAL, send_id, ipulse, recvptr,
-                     recv_nindex * datasize, GMX_MPI_REAL, recv_id, ipulse, overlap->mpi_comm, &stat);
-#endif
+        sendRecvGridOverlap(sendptr, send_nindex * datasize, send_id, recvptr,
+                            recv_nindex * datasize, recv_id, ipulse, overlap->mpi_comm, &localWork);
 
         for (x = 0; x < recv_nindex; x++)
         {
@@ -840,6 +906,12 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
             }
         }
     }
+
+    /* Run the local work when there was no communication to overlap it with */
+    if (localWork)
+    {
+        localWork();
+    }
 }
 
 void spread_on_grid(const gmx_pme_t*  pme,
@@ -962,30 +1034,43 @@ void spread_on_grid(const gmx_pme_t*  pme,
 #ifdef PME_TIME_THREADS
         c3 = omp_cyc_start();
 #endif
+        auto reduceThreadGrids = [&](const ThreadGridReductionPart reductionPart) {
 #pragma omp parallel for num_threads(grids->nthread) schedule(static)
-        for (int thread = 0; thread < grids->nthread; thread++)
-        {
-            try
+            for (int thread = 0; thread < grids->nthread; thread++)
             {
-                reduce_threadgrid_overlap(pme, grids, thread, fftgrid,
-                                          const_cast<real*>(pme->overlap[0].sendbuf.data()),
-                                          const_cast<real*>(pme->overlap[1].sendbuf.data()), grid_index);
+                try
+                {
+                    reduce_threadgrid_overlap(pme, grids, thread, fftgrid,
+                                              const_cast<real*>(pme->overlap[0].sendbuf.data()),
+                                              const_cast<real*>(pme->overlap[1].sendbuf.data()),
+                                              grid_index, reductionPart);
+                }
+                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
             }
-            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-        }
-#ifdef PME_TIME_THREADS
-        c3 = omp_cyc_end(c3);
-        cs3 += (double)c3;
-#endif
+        };
 
         if (pme->nnodes > 1)
         {
+            /* First reduce the parts that other ranks need, so we can
+             * reduce the rest of the local grid during the communication.
+             */
+            reduceThreadGrids(ThreadGridReductionPart::CommunicationBuffers);
+
             /* Communicate the overlapping part of the fftgrid.
              * For this communication call we need to check pme->bUseThreads
              * to have all ranks communicate here, regardless of pme->nthread.
              */
-            sum_fftgrid_dd(pme, fftgrid, grid_index);
+            sum_fftgrid_dd(pme, fftgrid, grid_index,
+                           [&]() { reduceThreadGrids(ThreadGridReductionPart::LocalGrid); });
         }
+        else
+        {
+            reduceThreadGrids(ThreadGridReductionPart::All);
+        }
+#ifdef PME_TIME_THREADS
+        c3 = omp_cyc_end(c3);
+        cs3 += (double)c3;
+#endif
     }
 
 #ifdef PME_TIME_THREADS
@@ -0,0 +1,129 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the Ewald error estimates.
+ *
+ * \ingroup module_ewald
+ */
+#include "gmxpre.h"
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/ewald/ewald_utils.h"
+#include "gromacs/math/functions.h"
+#include "gromacs/math/units.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Sum of squared charges of a water-like system in a cubic box of 5 nm
+constexpr real c_sumChargeSquared = 3000 * 0.5;
+//! Number of charges of a water-like system in a cubic box of 5 nm
+constexpr int c_numCharges = 3000;
+
+TEST(EwaldErrorEstimateTest, DirectSpaceErrorMatchesKolafaPerram)
+{
+    const real rc     = 1.0;
+    const real volume = 125;
+    const real beta   = calc_ewaldcoeff_q(rc, 1e-5);
+
+    const real reference = ONE_4PI_EPS0 * 2 * c_sumChargeSquared
+                           / std::sqrt(c_numCharges * rc * volume) * std::exp(-square(beta * rc));
+    const real error =
+            estimateEwaldDirectSpaceForceError(c_sumChargeSquared, c_numCharges, volume, rc, beta);
+    EXPECT_REAL_EQ_TOL(reference, error, relativeToleranceAsFloatingPoint(reference, 1e-6));
+}
+
+TEST(EwaldErrorEstimateTest, ReciprocalSpaceErrorDecreasesWithFinerGrid)
+{
+    const matrix box  = { { 5, 0, 0 }, { 0, 5, 0 }, { 0, 0, 5 } };
+    const real   beta = calc_ewaldcoeff_q(1.0, 1e-5);
+
+    real previousError = GMX_REAL_MAX;
+    for (int gridSize : { 32, 40, 48, 64 })
+    {
+        const ivec grid  = { gridSize, gridSize, gridSize };
+        const real error = estimatePmeReciprocalSpaceForceError(c_sumChargeSquared, c_numCharges,
+                                                                box, grid, 4, beta);
+        EXPECT_GT(error, 0);
+        EXPECT_LT(error, previousError);
+        previousError = error;
+    }
+}
+
+TEST(EwaldErrorEstimateTest, ReciprocalSpaceErrorDecreasesWithHigherOrder)
+{
+    const matrix box  = { { 5, 0, 0 }, { 0, 5, 0 }, { 0, 0, 5 } };
+    const real   beta = calc_ewaldcoeff_q(1.0, 1e-5);
+
+    for (int gridSize : { 32, 48 })
+    {
+        const ivec grid        = { gridSize, gridSize, gridSize };
+        const real errorOrder4 = estimatePmeReciprocalSpaceForceError(
+                c_sumChargeSquared, c_numCharges, box, grid, 4, beta);
+        const real errorOrder5 = estimatePmeReciprocalSpaceForceError(
+                c_sumChargeSquared, c_numCharges, box, grid, 5, beta);
+        EXPECT_LT(errorOrder5, errorOrder4);
+    }
+}
+
+TEST(EwaldErrorEstimateTest, ReciprocalSpaceErrorHandlesTriclinicBoxes)
+{
+    const matrix cubic     = { { 5, 0, 0 }, { 0, 5, 0 }, { 0, 0, 5 } };
+    const matrix triclinic = { { 5, 0, 0 }, { 2.5, 5, 0 }, { 0, 2.5, 5 } };
+    const ivec   grid      = { 40, 40, 40 };
+    const real   beta      = calc_ewaldcoeff_q(1.0, 1e-5);
+
+    /* The volumes are equal and the grid spacing is similar, so should be the errors */
+    const real errorCubic = estimatePmeReciprocalSpaceForceError(c_sumChargeSquared, c_numCharges,
+                                                                 cubic, grid, 4, beta);
+    const real errorTriclinic = estimatePmeReciprocalSpaceForceError(
+            c_sumChargeSquared, c_numCharges, triclinic, grid, 4, beta);
+    EXPECT_GT(errorTriclinic, 0.5 * errorCubic);
+    EXPECT_LT(errorTriclinic, 2 * errorCubic);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
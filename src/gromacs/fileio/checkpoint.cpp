@@ -84,6 +84,7 @@
 #include "gromacs/utility/keyvaluetreebuilder.h"
 #include "gromacs/utility/keyvaluetreeserializer.h"
 #include "gromacs/utility/mdmodulenotification.h"
+#include "gromacs/utility/path.h"
 #include "gromacs/utility/programcontext.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/sysinfo.h"
@@ -91,6 +92,7 @@
 
 #define CPT_MAGIC1 171817
 #define CPT_MAGIC2 171819
+#define CPT_MAGIC_ATOM_DATA 171821
 
 namespace gmx
 {
@@ -157,7 +159,8 @@ enum cptv
     cptv_PullAverage,      /**< Added possibility to output average pull force and position */
     cptv_MdModules,        /**< Added checkpointing for MdModules */
     cptv_ModularSimulator, /**< Added checkpointing for modular simulator */
-    cptv_Count             /**< the total number of cptv versions */
+    cptv_DistributedAtomData, /**< Added storage of per-atom state vectors in per-rank files */
+    cptv_Count                /**< the total number of cptv versions */
 };
 
 /*! \brief Version number of the file format written to checkpoint
@@ -177,6 +180,20 @@ enum cptv
  * the correct code path. */
 static const int cpt_version = cptv_Count - 1;
 
+/*! \brief The state entries that are stored in separate files per rank
+ * in distributed checkpoints. */
+static const int c_atomDataPartFlags = (1 << estX) | (1 << estV) | (1 << estCGP);
+
+/*! \brief Returns the state flags of the entries stored in the main checkpoint file */
+static int mainFileStateFlags(const CheckpointHeaderContents& headerContents)
+{
+    if (headerContents.numAtomDataParts > 0)
+    {
+        return headerContents.flags_state & ~c_atomDataPartFlags;
+    }
+    return headerContents.flags_state;
+}
+
 
 const char* est_names[estNR] = { "FE-lambda",
                                  "box",
@@ -1236,6 +1253,19 @@ static void do_cpt_header(XDR* xd, gmx_bool bRead, FILE* list, CheckpointHeaderC
     {
         contents->isModularSimulatorCheckpoint = false;
     }
+
+    if (contents->file_version >= cptv_DistributedAtomData)
+    {
+        do_cpt_int_err(xd, "atom data parts", &contents->numAtomDataParts, list);
+        if (contents->numAtomDataParts > 0)
+        {
+            do_cpt_string_err(xd, "atom data part base name", contents->atomDataPartBaseName, list);
+        }
+    }
+    else
+    {
+        contents->numAtomDataParts = 0;
+    }
 }
 
 static int do_cpt_footer(XDR* xd, int file_version)
@@ -2306,7 +2336,7 @@ void write_checkpoint_data(t_fileio*                         fp,
 
     do_cpt_header(gmx_fio_getxdr(fp), FALSE, nullptr, &headerContents);
 
-    if ((do_cpt_state(gmx_fio_getxdr(fp), state->flags, state, nullptr) < 0)
+    if ((do_cpt_state(gmx_fio_getxdr(fp), mainFileStateFlags(headerContents), state, nullptr) < 0)
         || (do_cpt_ekinstate(gmx_fio_getxdr(fp), headerContents.flags_eks, &state->ekinstate, nullptr) < 0)
         || (do_cpt_enerhist(gmx_fio_getxdr(fp), FALSE, headerContents.flags_enh, enerhist, nullptr) < 0)
         || (doCptPullHist(gmx_fio_getxdr(fp), FALSE, headerContents.flagsPullHistory, pullHist,
@@ -2499,6 +2529,178 @@ static void check_match(FILE*                           fplog,
     }
 }
 
+std::string checkpointAtomDataPartFileName(const std::string& directory, const char* baseName, int part)
+{
+    const std::string fileName = gmx::formatString("%s_part%d.cpt", baseName, part);
+
+    return directory.empty() ? fileName : gmx::Path::join(directory, fileName);
+}
+
+void write_checkpoint_atom_data_part(const char*              fn,
+                                     int64_t                  step,
+                                     int                      part,
+                                     int                      numParts,
+                                     int                      natomsGlobal,
+                                     gmx::ArrayRef<const int> globalAtomIndices,
+                                     const t_state&           localState)
+{
+    t_fileio* fp = gmx_fio_open(fn, "w");
+    XDR*      xd = gmx_fio_getxdr(fp);
+
+    int magic      = CPT_MAGIC_ATOM_DATA;
+    int version    = cpt_version;
+    int doublePrec = GMX_DOUBLE;
+    int flags      = localState.flags & c_atomDataPartFlags;
+    int numAtoms   = globalAtomIndices.ssize();
+    do_cpt_int_err(xd, "magic number", &magic, nullptr);
+    do_cpt_int_err(xd, "checkpoint version", &version, nullptr);
+    do_cpt_step_err(xd, "step", &step, nullptr);
+    do_cpt_int_err(xd, "part", &part, nullptr);
+    do_cpt_int_err(xd, "#parts", &numParts, nullptr);
+    do_cpt_int_err(xd, "#atoms", &natomsGlobal, nullptr);
+    do_cpt_int_err(xd, "double", &doublePrec, nullptr);
+    do_cpt_int_err(xd, "state flags", &flags, nullptr);
+    do_cpt_int_err(xd, "#home atoms", &numAtoms, nullptr);
+
+    /* The serialization routines take non-const pointers for reading and writing */
+    bool bOK = gmx_fio_ndo_int(fp, const_cast<int*>(globalAtomIndices.data()), numAtoms);
+    for (int ecpt = 0; ecpt < estNR && bOK; ecpt++)
+    {
+        if (flags & (1 << ecpt))
+        {
+            const rvec* v = (ecpt == estX) ? localState.x.rvec_array()
+                                           : (ecpt == estV ? localState.v.rvec_array()
+                                                           : localState.cg_p.rvec_array());
+            bOK = gmx_fio_ndo_rvec(fp, const_cast<rvec*>(v), numAtoms);
+        }
+    }
+
+    if (!bOK || gmx_fio_fsync(fp) != 0 || gmx_fio_close(fp) != 0)
+    {
+        gmx_file("Cannot write checkpoint atom data; maybe you are out of disk space?");
+    }
+}
+
+/*! \brief Reads the per-atom state vectors of a distributed checkpoint into \p state
+ *
+ * Does nothing when the checkpoint \p fn stores the atom data itself.
+ * The atom data files are expected in the same directory as \p fn.
+ */
+static void readCheckpointAtomDataParts(const char* fn, const CheckpointHeaderContents& headerContents, t_state* state)
+{
+    if (headerContents.numAtomDataParts == 0)
+    {
+        return;
+    }
+
+    const std::string directory    = gmx::Path::getParentPath(fn);
+    const int         flags        = headerContents.flags_state & c_atomDataPartFlags;
+    int               numAtomsRead = 0;
+    std::vector<bool> haveAtom(headerContents.natoms, false);
+    std::vector<int>  indices;
+    std::vector<gmx::RVec> buffer;
+    for (int ecpt = 0; ecpt < estNR; ecpt++)
+    {
+        if (flags & (1 << ecpt))
+        {
+            auto& v = (ecpt == estX) ? state->x : (ecpt == estV ? state->v : state->cg_p);
+            v.resizeWithPadding(headerContents.natoms);
+        }
+    }
+
+    for (int part = 0; part < headerContents.numAtomDataParts; part++)
+    {
+        const std::string partFn = checkpointAtomDataPartFileName(
+                directory, headerContents.atomDataPartBaseName, part);
+        if (!gmx_fexist(partFn))
+        {
+            gmx_fatal(FARGS,
+                      "Checkpoint file %s stores the atom data in %d separate files, but file %s "
+                      "is missing",
+                      fn, headerContents.numAtomDataParts, partFn.c_str());
+        }
+        t_fileio* fp = gmx_fio_open(partFn.c_str(), "r");
+        XDR*      xd = gmx_fio_getxdr(fp);
+
+        int     magic, version, filePart, numParts, natoms, doublePrec, fileFlags, numAtoms;
+        int64_t step;
+        do_cpt_int_err(xd, "magic number", &magic, nullptr);
+        if (magic != CPT_MAGIC_ATOM_DATA)
+        {
+            gmx_fatal(FARGS, "File %s is not a checkpoint atom data file", partFn.c_str());
+        }
+        do_cpt_int_err(xd, "checkpoint version", &version, nullptr);
+        do_cpt_step_err(xd, "step", &step, nullptr);
+        do_cpt_int_err(xd, "part", &filePart, nullptr);
+        do_cpt_int_err(xd, "#parts", &numParts, nullptr);
+        do_cpt_int_err(xd, "#atoms", &natoms, nullptr);
+        do_cpt_int_err(xd, "double", &doublePrec, nullptr);
+        do_cpt_int_err(xd, "state flags", &fileFlags, nullptr);
+        do_cpt_int_err(xd, "#home atoms", &numAtoms, nullptr);
+        if (step != headerContents.step || filePart != part
+            || numParts != headerContents.numAtomDataParts || natoms != headerContents.natoms
+            || fileFlags != flags)
+        {
+            gmx_fatal(FARGS, "Checkpoint atom data file %s does not match checkpoint file %s",
+                      partFn.c_str(), fn);
+        }
+        if (doublePrec != GMX_DOUBLE)
+        {
+            gmx_fatal(FARGS,
+                      "Checkpoint atom data file %s was written in %s precision and can only be "
+                      "read by a %s precision build",
+                      partFn.c_str(), doublePrec ? "double" : "mixed", doublePrec ? "double" : "mixed");
+        }
+        if (numAtoms < 0 || numAtomsRead + numAtoms > natoms)
+        {
+            cp_error();
+        }
+
+        indices.resize(numAtoms);
+        buffer.resize(numAtoms);
+        if (!gmx_fio_ndo_int(fp, indices.data(), numAtoms))
+        {
+            cp_error();
+        }
+        for (const int globalAtom : indices)
+        {
+            if (globalAtom < 0 || globalAtom >= natoms || haveAtom[globalAtom])
+            {
+                gmx_fatal(FARGS, "Checkpoint atom data file %s contains invalid atom indices",
+                          partFn.c_str());
+            }
+            haveAtom[globalAtom] = true;
+        }
+        numAtomsRead += numAtoms;
+
+        for (int ecpt = 0; ecpt < estNR; ecpt++)
+        {
+            if (flags & (1 << ecpt))
+            {
+                if (!gmx_fio_ndo_rvec(fp, as_rvec_array(buffer.data()), numAtoms))
+                {
+                    cp_error();
+                }
+                auto& v = (ecpt == estX) ? state->x : (ecpt == estV ? state->v : state->cg_p);
+                for (int i = 0; i < numAtoms; i++)
+                {
+                    v[indices[i]] = buffer[i];
+                }
+            }
+        }
+        if (gmx_fio_close(fp) != 0)
+        {
+            cp_error();
+        }
+    }
+
+    if (numAtomsRead != headerContents.natoms)
+    {
+        gmx_fatal(FARGS, "The atom data files of checkpoint file %s contain %d atoms instead of %d",
+                  fn, numAtomsRead, headerContents.natoms);
+    }
+}
+
 static void read_checkpoint(const char*                    fn,
                             t_fileio*                      logfio,
                             const t_commrec*               cr,
@@ -2603,13 +2805,14 @@ static void read_checkpoint(const char*                    fn,
         check_match(fplog, cr, dd_nc, *headerContents, reproducibilityRequested);
     }
 
-    ret             = do_cpt_state(gmx_fio_getxdr(fp), headerContents->flags_state, state, nullptr);
+    ret             = do_cpt_state(gmx_fio_getxdr(fp), mainFileStateFlags(*headerContents), state, nullptr);
     *init_fep_state = state->fep_state; /* there should be a better way to do this than setting it
                                            here. Investigate for 5.0. */
     if (ret)
     {
         cp_error();
     }
+    readCheckpointAtomDataParts(fn, *headerContents, state);
     ret = do_cpt_ekinstate(gmx_fio_getxdr(fp), headerContents->flags_eks, &state->ekinstate, nullptr);
     if (ret)
     {
@@ -2806,11 +3009,12 @@ static CheckpointHeaderContents read_checkpoint_data(t_fileio*
     state->nnhpres       = headerContents.nnhpres;
     state->nhchainlength = headerContents.nhchainlength;
     state->flags         = headerContents.flags_state;
-    int ret              = do_cpt_state(gmx_fio_getxdr(fp), state->flags, state, nullptr);
+    int ret = do_cpt_state(gmx_fio_getxdr(fp), mainFileStateFlags(headerContents), state, nullptr);
     if (ret)
     {
         cp_error();
     }
+    readCheckpointAtomDataParts(gmx_fio_getname(fp), headerContents, state);
     ret = do_cpt_ekinstate(gmx_fio_getxdr(fp), headerContents.flags_eks, &state->ekinstate, nullptr);
     if (ret)
     {
@@ -2930,7 +3134,7 @@ void list_checkpoint(const char* fn, FILE* out)
     state.nnhpres       = headerContents.nnhpres;
     state.nhchainlength = headerContents.nhchainlength;
     state.flags         = headerContents.flags_state;
-    ret                 = do_cpt_state(gmx_fio_getxdr(fp), state.flags, &state, out);
+    ret                 = do_cpt_state(gmx_fio_getxdr(fp), mainFileStateFlags(headerContents), &state, out);
     if (ret)
     {
         cp_error();
@@ -41,6 +41,7 @@
 
 #include <cstdio>
 
+#include <string>
 #include <vector>
 
 #include "gromacs/compat/pointers.h"
@@ -61,6 +62,8 @@ struct t_trxframe;
 namespace gmx
 {
 
+template<typename>
+class ArrayRef;
 struct MdModulesNotifier;
 class KeyValueTreeObject;
 class ReadCheckpointDataHolder;
@@ -240,8 +243,44 @@ struct CheckpointHeaderContents
     int eSwapCoords;
     //! Whether the checkpoint was written by modular simulator.
     bool isModularSimulatorCheckpoint = false;
+    //! Number of files with the per-atom state vectors, 0 when these are stored in this file.
+    int numAtomDataParts = 0;
+    //! File name without directory and extension of the atom data files, when used.
+    char atomDataPartBaseName[CPTSTRLEN] = { 0 };
 };
 
+/*! \brief Returns the name of atom data file \p part of a distributed checkpoint
+ *
+ * \param[in] directory  The directory, with or without trailing separator, can be empty
+ * \param[in] baseName   The base name stored in the checkpoint header
+ * \param[in] part       The index of the part, i.e. the DD rank that wrote it
+ */
+std::string checkpointAtomDataPartFileName(const std::string& directory, const char* baseName, int part);
+
+/*! \brief Writes the per-atom state vectors of the home atoms of a rank to a separate file
+ *
+ * This is used for distributed checkpoints, where each domain decomposition
+ * rank writes the x, v and cg_p entries present in \p localState for
+ * its home atoms, together with their global indices, so these do not
+ * need to be collected on the master rank. The main checkpoint file then
+ * lists the number of parts and their base name. The file is synced to disk.
+ *
+ * \param[in] fn                 The file name
+ * \param[in] step               The step of the checkpoint
+ * \param[in] part               The index of this part
+ * \param[in] numParts           The total number of parts
+ * \param[in] natomsGlobal       The total number of atoms in the system
+ * \param[in] globalAtomIndices  The global indices of the home atoms
+ * \param[in] localState         The local state
+ */
+void write_checkpoint_atom_data_part(const char*              fn,
+                                     int64_t                  step,
+                                     int                      part,
+                                     int                      numParts,
+                                     int                      natomsGlobal,
+                                     gmx::ArrayRef<const int> globalAtomIndices,
+                                     const t_state&           localState);
+
 /*! \brief Low-level checkpoint writing function */
 void write_checkpoint_data(t_fileio*                         fp,
                            CheckpointHeaderContents          headerContents,
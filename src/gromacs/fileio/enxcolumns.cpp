@@ -0,0 +1,343 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the column-wise sidecar store for energy file terms.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "enxcolumns.h"
+
+#include <algorithm>
+
+#include "gromacs/fileio/xdrf.h"
+#include "gromacs/utility/futil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Magic number identifying an energy column sidecar file ("EDRC")
+constexpr int c_energyColumnsMagic = 0x45445243;
+//! Magic number starting each block of frames ("EDRB")
+constexpr int c_energyColumnsBlockMagic = 0x45445242;
+//! Version of the sidecar file format
+constexpr int c_energyColumnsVersion = 1;
+//! Maximum length of a term name, including the terminating null character
+constexpr unsigned int c_maxTermNameLength = 256;
+
+//! Reads or writes \p value in the precision given by \p isDouble, returns true on success
+bool doValue(XDR* xdr, bool isDouble, double* value)
+{
+    if (isDouble)
+    {
+        return xdr_double(xdr, value) != 0;
+    }
+    float valueFloat = *value;
+    bool  ok         = xdr_float(xdr, &valueFloat) != 0;
+    *value           = valueFloat;
+    return ok;
+}
+
+} // namespace
+
+std::string EnergyColumnWriter::sidecarFileName(const std::string& edrFileName)
+{
+    return edrFileName + "col";
+}
+
+std::unique_ptr<EnergyColumnWriter> EnergyColumnWriter::create(const std::string& fileName,
+                                                               ArrayRef<const std::string> termNames,
+                                                               int framesPerBlock)
+{
+    /* The sidecar is optional, so we use plain fopen to avoid fatal errors */
+    FILE* fp = std::fopen(fileName.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        return nullptr;
+    }
+    XDR xdr;
+    xdrstdio_create(&xdr, fp, XDR_ENCODE);
+    int  magic    = c_energyColumnsMagic;
+    int  version  = c_energyColumnsVersion;
+    int  isDouble = GMX_DOUBLE;
+    int  numTerms = termNames.ssize();
+    bool ok       = (xdr_int(&xdr, &magic) != 0 && xdr_int(&xdr, &version) != 0
+               && xdr_int(&xdr, &isDouble) != 0 && xdr_int(&xdr, &numTerms) != 0);
+    for (auto name = termNames.begin(); ok && name != termNames.end(); ++name)
+    {
+        char* nameString = const_cast<char*>(name->c_str());
+        ok               = xdr_string(&xdr, &nameString, c_maxTermNameLength) != 0;
+    }
+    xdr_destroy(&xdr);
+    if (!ok || std::fflush(fp) != 0)
+    {
+        std::fclose(fp);
+        return nullptr;
+    }
+
+    return std::make_unique<EnergyColumnWriter>(fp, numTerms, framesPerBlock);
+}
+
+EnergyColumnWriter::EnergyColumnWriter(FILE* fp, int numTerms, int framesPerBlock) :
+    fp_(fp), numTerms_(numTerms), framesPerBlock_(framesPerBlock), values_(numTerms)
+{
+}
+
+EnergyColumnWriter::~EnergyColumnWriter()
+{
+    flush();
+    if (fp_ != nullptr)
+    {
+        std::fclose(fp_);
+    }
+}
+
+bool EnergyColumnWriter::addFrame(int64_t step, double time, ArrayRef<const real> values)
+{
+    if (fp_ == nullptr || values.ssize() != numTerms_)
+    {
+        return false;
+    }
+    steps_.push_back(step);
+    times_.push_back(time);
+    for (int term = 0; term < numTerms_; term++)
+    {
+        values_[term].push_back(values[term]);
+    }
+
+    return (gmx::ssize(steps_) < framesPerBlock_) || flush();
+}
+
+bool EnergyColumnWriter::flush()
+{
+    if (fp_ == nullptr)
+    {
+        return false;
+    }
+    if (steps_.empty())
+    {
+        return true;
+    }
+
+    XDR xdr;
+    xdrstdio_create(&xdr, fp_, XDR_ENCODE);
+    int  magic     = c_energyColumnsBlockMagic;
+    int  numFrames = steps_.size();
+    bool ok        = xdr_int(&xdr, &magic) != 0 && xdr_int(&xdr, &numFrames) != 0;
+    for (int frame = 0; ok && frame < numFrames; frame++)
+    {
+        ok = xdr_int64(&xdr, &steps_[frame]) != 0;
+    }
+    for (int frame = 0; ok && frame < numFrames; frame++)
+    {
+        ok = xdr_double(&xdr, &times_[frame]) != 0;
+    }
+    for (int term = 0; ok && term < numTerms_; term++)
+    {
+        for (int frame = 0; ok && frame < numFrames; frame++)
+        {
+            double value = values_[term][frame];
+            ok           = doValue(&xdr, GMX_DOUBLE, &value);
+        }
+        values_[term].clear();
+    }
+    xdr_destroy(&xdr);
+    steps_.clear();
+    times_.clear();
+
+    if (!ok || std::fflush(fp_) != 0)
+    {
+        /* Writing failed, stop updating the sidecar */
+        std::fclose(fp_);
+        fp_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<EnergyColumnReader> EnergyColumnReader::open(const std::string& fileName)
+{
+    FILE* fp = std::fopen(fileName.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return nullptr;
+    }
+    XDR xdr;
+    xdrstdio_create(&xdr, fp, XDR_DECODE);
+    int  magic, version, isDouble, numTerms;
+    bool ok = (xdr_int(&xdr, &magic) != 0 && magic == c_energyColumnsMagic
+               && xdr_int(&xdr, &version) != 0 && version == c_energyColumnsVersion
+               && xdr_int(&xdr, &isDouble) != 0 && xdr_int(&xdr, &numTerms) != 0 && numTerms >= 0);
+    std::vector<std::string> termNames;
+    for (int term = 0; ok && term < numTerms; term++)
+    {
+        char  nameBuffer[c_maxTermNameLength];
+        char* nameString = nameBuffer;
+        ok               = xdr_string(&xdr, &nameString, c_maxTermNameLength) != 0;
+        if (ok)
+        {
+            termNames.emplace_back(nameString);
+        }
+    }
+    xdr_destroy(&xdr);
+    if (!ok)
+    {
+        std::fclose(fp);
+        return nullptr;
+    }
+
+    return std::make_unique<EnergyColumnReader>(fp, isDouble != 0, std::move(termNames));
+}
+
+EnergyColumnReader::EnergyColumnReader(FILE* fp, bool isDouble, std::vector<std::string> termNames) :
+    fp_(fp), isDouble_(isDouble), termNames_(std::move(termNames)), firstBlockOffset_(gmx_ftell(fp))
+{
+}
+
+EnergyColumnReader::~EnergyColumnReader()
+{
+    std::fclose(fp_);
+}
+
+int EnergyColumnReader::termIndex(const std::string& name) const
+{
+    auto term = std::find(termNames_.begin(), termNames_.end(), name);
+
+    return (term == termNames_.end()) ? -1 : static_cast<int>(term - termNames_.begin());
+}
+
+bool EnergyColumnReader::readTerms(ArrayRef<const int> terms, EnergyColumns* columns)
+{
+    const int numTerms = termNames_.size();
+    for (int term : terms)
+    {
+        if (term < 0 || term >= numTerms)
+        {
+            return false;
+        }
+    }
+    columns->steps.clear();
+    columns->times.clear();
+    columns->values.assign(terms.size(), {});
+
+    if (gmx_fseek(fp_, 0, SEEK_END) != 0)
+    {
+        return false;
+    }
+    const gmx_off_t fileSize = gmx_ftell(fp_);
+    if (gmx_fseek(fp_, firstBlockOffset_, SEEK_SET) != 0)
+    {
+        return false;
+    }
+    const int           bytesPerValue = isDouble_ ? sizeof(double) : sizeof(float);
+    std::vector<double> column;
+    bool                ok = true;
+    while (ok)
+    {
+        /* Stop at the end of the file and at incomplete blocks, which
+         * can be present when the writer was interrupted.
+         */
+        XDR xdr;
+        xdrstdio_create(&xdr, fp_, XDR_DECODE);
+        int  magic, numFrames;
+        bool blockIsComplete = (xdr_int(&xdr, &magic) != 0 && xdr_int(&xdr, &numFrames) != 0);
+        if (!blockIsComplete)
+        {
+            xdr_destroy(&xdr);
+            break;
+        }
+        if (magic != c_energyColumnsBlockMagic || numFrames <= 0)
+        {
+            xdr_destroy(&xdr);
+            ok = false;
+            break;
+        }
+        std::vector<int64_t> steps(numFrames);
+        std::vector<double>  times(numFrames);
+        for (int frame = 0; blockIsComplete && frame < numFrames; frame++)
+        {
+            blockIsComplete = xdr_int64(&xdr, &steps[frame]) != 0;
+        }
+        for (int frame = 0; blockIsComplete && frame < numFrames; frame++)
+        {
+            blockIsComplete = xdr_double(&xdr, &times[frame]) != 0;
+        }
+        std::vector<std::vector<double>> blockValues(terms.size());
+        for (int term = 0; blockIsComplete && term < numTerms; term++)
+        {
+            if (std::find(terms.begin(), terms.end(), term) == terms.end())
+            {
+                /* Skip the column, the values have a fixed size in XDR */
+                const gmx_off_t columnSize = static_cast<gmx_off_t>(numFrames) * bytesPerValue;
+                blockIsComplete            = (gmx_fseek(fp_, columnSize, SEEK_CUR) == 0);
+                continue;
+            }
+            column.resize(numFrames);
+            for (int frame = 0; blockIsComplete && frame < numFrames; frame++)
+            {
+                blockIsComplete = doValue(&xdr, isDouble_, &column[frame]);
+            }
+            for (size_t i = 0; i < terms.size(); i++)
+            {
+                if (terms[i] == term)
+                {
+                    blockValues[i] = column;
+                }
+            }
+        }
+        xdr_destroy(&xdr);
+        /* Seeking past skipped columns succeeds also beyond the end of the file */
+        if (!blockIsComplete || gmx_ftell(fp_) > fileSize)
+        {
+            break;
+        }
+        columns->steps.insert(columns->steps.end(), steps.begin(), steps.end());
+        columns->times.insert(columns->times.end(), times.begin(), times.end());
+        for (size_t i = 0; i < terms.size(); i++)
+        {
+            columns->values[i].insert(columns->values[i].end(), blockValues[i].begin(),
+                                      blockValues[i].end());
+        }
+    }
+
+    return ok;
+}
+
+} // namespace gmx
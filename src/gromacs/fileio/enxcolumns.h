@@ -0,0 +1,175 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a column-wise sidecar store for energy file terms.
+ *
+ * An energy file stores all terms of a frame together, so reading a
+ * single term means reading every frame in full. The sidecar stores the
+ * instantaneous values of every term in blocks of frames, with the
+ * values of each term contiguous within a block, so that a few terms
+ * can be read with a sequential pass over only the data needed.
+ * The sidecar is written next to the energy file (\c ener.edr ->
+ * \c ener.edrcol) when the environment variable GMX_EDR_COLUMNS is set.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_ENXCOLUMNS_H
+#define GMX_FILEIO_ENXCOLUMNS_H
+
+#include <cstdint>
+#include <cstdio>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief Writes energy terms to a column-wise sidecar file.
+ *
+ * Frames are buffered and written as one block of columns when the
+ * block is full, and when the writer is destroyed. Write errors are
+ * not fatal, since the sidecar is only an optimization: the writer
+ * then stops writing and the file only contains the completed blocks.
+ */
+class EnergyColumnWriter
+{
+public:
+    //! The default number of frames per block
+    static constexpr int c_defaultFramesPerBlock = 1000;
+
+    //! Returns the name of the sidecar file for \p edrFileName
+    static std::string sidecarFileName(const std::string& edrFileName);
+
+    /*! \brief Creates a writer for terms \p termNames that writes to \p fileName
+     *
+     * Returns nullptr when the file can not be written.
+     */
+    static std::unique_ptr<EnergyColumnWriter> create(const std::string&           fileName,
+                                                      ArrayRef<const std::string> termNames,
+                                                      int framesPerBlock = c_defaultFramesPerBlock);
+
+    //! Constructor, should only be called by create()
+    EnergyColumnWriter(FILE* fp, int numTerms, int framesPerBlock);
+    //! Writes the buffered frames and closes the file
+    ~EnergyColumnWriter();
+
+    /*! \brief Adds a frame with the values of all terms
+     *
+     * \returns false when writing to file failed, now or earlier
+     */
+    bool addFrame(int64_t step, double time, ArrayRef<const real> values);
+
+    //! Writes the buffered frames, returns false when writing failed, now or earlier
+    bool flush();
+
+private:
+    //! The file, nullptr after a write error
+    FILE* fp_;
+    //! The number of terms
+    int numTerms_;
+    //! The number of frames per block
+    int framesPerBlock_;
+    //! The steps of the buffered frames
+    std::vector<int64_t> steps_;
+    //! The times of the buffered frames
+    std::vector<double> times_;
+    //! The values of the buffered frames, term by term
+    std::vector<std::vector<real>> values_;
+};
+
+//! Values of selected energy terms for all frames in a sidecar file
+struct EnergyColumns
+{
+    //! The step of each frame
+    std::vector<int64_t> steps;
+    //! The time of each frame
+    std::vector<double> times;
+    //! For each selected term the value in each frame
+    std::vector<std::vector<double>> values;
+};
+
+/*! \libinternal \brief Reads selected terms from a column-wise sidecar file.
+ */
+class EnergyColumnReader
+{
+public:
+    /*! \brief Opens sidecar file \p fileName
+     *
+     * Returns nullptr when the file does not exist or is not a sidecar
+     * file. Failure is not fatal so that callers can fall back to
+     * reading the energy file itself.
+     */
+    static std::unique_ptr<EnergyColumnReader> open(const std::string& fileName);
+
+    //! Constructor, should only be called by open()
+    EnergyColumnReader(FILE* fp, bool isDouble, std::vector<std::string> termNames);
+    ~EnergyColumnReader();
+
+    //! Returns the names of all terms in the file
+    ArrayRef<const std::string> termNames() const { return termNames_; }
+
+    //! Returns the index of the term called \p name, -1 when not present
+    int termIndex(const std::string& name) const;
+
+    /*! \brief Reads all frames of the terms with indices \p terms
+     *
+     * Data of other terms is skipped. Reading ends at the first
+     * incomplete block.
+     *
+     * \returns false when the file is corrupt or a term index is invalid.
+     */
+    bool readTerms(ArrayRef<const int> terms, EnergyColumns* columns);
+
+private:
+    //! The file
+    FILE* fp_;
+    //! Whether the values are stored in double precision
+    bool isDouble_;
+    //! The names of the terms
+    std::vector<std::string> termNames_;
+    //! The offset of the first block
+    int64_t firstBlockOffset_;
+};
+
+} // namespace gmx
+
+#endif
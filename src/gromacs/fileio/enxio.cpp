@@ -39,11 +39,15 @@
 
 #include "enxio.h"
 
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
 #include <algorithm>
+#include <string>
+#include <vector>
 
+#include "gromacs/fileio/enxcolumns.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
 #include "gromacs/fileio/xdrf.h"
@@ -90,10 +94,12 @@ typedef struct
 
 struct ener_file
 {
-    ener_old_t eo;
-    t_fileio*  fio;
-    int        framenr;
-    real       frametime;
+    ener_old_t               eo;
+    t_fileio*                fio;
+    int                      framenr;
+    real                     frametime;
+    gmx_bool                 bWriteColumns; /* write a column sidecar with the energy names */
+    gmx::EnergyColumnWriter* columnWriter;  /* writes the energy terms by column, when used */
 };
 
 static void enxsubblock_init(t_enxsubblock* sb)
@@ -435,6 +441,19 @@ void do_enxnms(ener_file_t ef, int* nre, gmx_enxnm_t** nms)
     }
 
     edr_strings(xdr, bRead, file_version, *nre, nms);
+
+    if (!bRead && ef->bWriteColumns)
+    {
+        std::vector<std::string> termNames;
+        for (int i = 0; i < *nre; i++)
+        {
+            termNames.emplace_back((*nms)[i].name);
+        }
+        const std::string sidecarFileName =
+                gmx::EnergyColumnWriter::sidecarFileName(gmx_fio_getname(ef->fio));
+        delete ef->columnWriter;
+        ef->columnWriter = gmx::EnergyColumnWriter::create(sidecarFileName, termNames).release();
+    }
 }
 
 static gmx_bool do_eheader(ener_file_t ef,
@@ -757,6 +776,8 @@ void close_enx(ener_file_t ef)
         // Nothing to do
         return;
     }
+    delete ef->columnWriter;
+    ef->columnWriter = nullptr;
     if (gmx_fio_close(ef->fio) != 0)
     {
         gmx_file(
@@ -866,6 +887,18 @@ ener_file_t open_enx(const char* fn, const char* mode)
     else
     {
         ef->fio = gmx_fio_open(fn, mode);
+
+        /* A column sidecar can only be written for a new file. When
+         * appending, remove any existing one, since it would be out of date.
+         */
+        if (mode[0] == 'w')
+        {
+            ef->bWriteColumns = (getenv("GMX_EDR_COLUMNS") != nullptr);
+        }
+        else
+        {
+            std::remove(gmx::EnergyColumnWriter::sidecarFileName(fn).c_str());
+        }
     }
 
     ef->framenr   = 0;
@@ -1112,6 +1145,20 @@ gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
         {
             gmx_file("Cannot write energy file; maybe you are out of disk space?");
         }
+        if (bOK && ef->columnWriter != nullptr && fr->nre > 0)
+        {
+            std::vector<real> values(fr->nre);
+            for (i = 0; i < fr->nre; i++)
+            {
+                values[i] = fr->ener[i].e;
+            }
+            if (!ef->columnWriter->addFrame(fr->step, fr->t, values))
+            {
+                /* The sidecar is only an optimization, so we just stop writing it */
+                delete ef->columnWriter;
+                ef->columnWriter = nullptr;
+            }
+        }
     }
 
     if (!bOK)
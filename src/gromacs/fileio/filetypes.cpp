@@ -139,7 +139,8 @@ static const t_deffile deffile[efNR] = {
     { eftASC, ".cub", "pot", nullptr, "Gaussian cube file" },
     { eftASC, ".xpm", "root", nullptr, "X PixMap compatible matrix file" },
     { eftASC, "", "rundir", nullptr, "Run directory" },
-    { eftASC, ".csv", "bench", nullptr, "CSV data file" }
+    { eftASC, ".csv", "bench", nullptr, "CSV data file" },
+    { eftASC, ".json", "bench", nullptr, "JSON data file" }
 };
 
 const char* ftp2ext(int ftp)
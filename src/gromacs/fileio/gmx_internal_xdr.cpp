@@ -745,4 +745,141 @@ void xdrstdio_create(XDR* xdrs, FILE* file, enum xdr_op op)
     xdrs->x_handy   = 0;
     xdrs->x_base    = nullptr;
 }
+
+static bool_t       xdrmem_getbytes(XDR* /*xdrs*/, char* /*addr*/, unsigned int /*len*/);
+static bool_t       xdrmem_putbytes(XDR* /*xdrs*/, char* /*addr*/, unsigned int /*len*/);
+static unsigned int xdrmem_getpos(XDR* /*xdrs*/);
+static bool_t       xdrmem_setpos(XDR* /*xdrs*/, unsigned int /*pos*/);
+static xdr_int32_t* xdrmem_inline(XDR* /*xdrs*/, int /*len*/);
+static void         xdrmem_destroy(XDR* /*xdrs*/);
+static bool_t       xdrmem_getint32(XDR* /*xdrs*/, xdr_int32_t* /*ip*/);
+static bool_t       xdrmem_putint32(XDR* /*xdrs*/, xdr_int32_t* /*ip*/);
+static bool_t       xdrmem_getuint32(XDR* /*xdrs*/, xdr_uint32_t* /*ip*/);
+static bool_t       xdrmem_putuint32(XDR* /*xdrs*/, xdr_uint32_t* /*ip*/);
+
+/*
+ * For memory streams x_base points to the start of the buffer,
+ * x_private to the current position and x_handy holds the number
+ * of bytes left in the buffer.
+ */
+static void xdrmem_destroy(XDR* /*xdrs*/) {}
+
+static bool_t xdrmem_getbytes(XDR* xdrs, char* addr, unsigned int len)
+{
+    if (static_cast<unsigned int>(xdrs->x_handy) < len)
+    {
+        return FALSE;
+    }
+    memcpy(addr, xdrs->x_private, len);
+    xdrs->x_private += len;
+    xdrs->x_handy -= len;
+    return TRUE;
+}
+
+static bool_t xdrmem_putbytes(XDR* xdrs, char* addr, unsigned int len)
+{
+    if (static_cast<unsigned int>(xdrs->x_handy) < len)
+    {
+        return FALSE;
+    }
+    memcpy(xdrs->x_private, addr, len);
+    xdrs->x_private += len;
+    xdrs->x_handy -= len;
+    return TRUE;
+}
+
+static unsigned int xdrmem_getpos(XDR* xdrs)
+{
+    return static_cast<unsigned int>(xdrs->x_private - xdrs->x_base);
+}
+
+static bool_t xdrmem_setpos(XDR* xdrs, unsigned int pos)
+{
+    char* newaddr  = xdrs->x_base + pos;
+    char* lastaddr = xdrs->x_private + xdrs->x_handy;
+
+    if (newaddr > lastaddr)
+    {
+        return FALSE;
+    }
+    xdrs->x_private = newaddr;
+    xdrs->x_handy   = static_cast<int>(lastaddr - newaddr);
+    return TRUE;
+}
+
+static xdr_int32_t* xdrmem_inline(XDR* xdrs, int len)
+{
+    (void)xdrs;
+    (void)len;
+    /* We do not guarantee alignment of the buffer, so do not use inline access */
+    return nullptr;
+}
+
+static bool_t xdrmem_getint32(XDR* xdrs, xdr_int32_t* ip)
+{
+    xdr_int32_t mycopy;
+
+    if (!xdrmem_getbytes(xdrs, reinterpret_cast<char*>(&mycopy), 4))
+    {
+        return FALSE;
+    }
+    *ip = xdr_ntohl(mycopy);
+    return TRUE;
+}
+
+static bool_t xdrmem_putint32(XDR* xdrs, xdr_int32_t* ip)
+{
+    xdr_int32_t mycopy = xdr_htonl(*ip);
+
+    return xdrmem_putbytes(xdrs, reinterpret_cast<char*>(&mycopy), 4);
+}
+
+static bool_t xdrmem_getuint32(XDR* xdrs, xdr_uint32_t* ip)
+{
+    xdr_uint32_t mycopy;
+
+    if (!xdrmem_getbytes(xdrs, reinterpret_cast<char*>(&mycopy), 4))
+    {
+        return FALSE;
+    }
+    *ip = xdr_ntohl(mycopy);
+    return TRUE;
+}
+
+static bool_t xdrmem_putuint32(XDR* xdrs, xdr_uint32_t* ip)
+{
+    xdr_uint32_t mycopy = xdr_htonl(*ip);
+
+    return xdrmem_putbytes(xdrs, reinterpret_cast<char*>(&mycopy), 4);
+}
+
+/*
+ * Ops vector for memory type XDR
+ */
+static struct XDR::xdr_ops xdrmem_ops = {
+    xdrmem_getbytes,  /* deserialize counted bytes */
+    xdrmem_putbytes,  /* serialize counted bytes */
+    xdrmem_getpos,    /* get offset in the stream */
+    xdrmem_setpos,    /* set offset in the stream */
+    xdrmem_inline,    /* prime stream for inline macros */
+    xdrmem_destroy,   /* destroy stream */
+    xdrmem_getint32,  /* deserialize a int */
+    xdrmem_putint32,  /* serialize a int */
+    xdrmem_getuint32, /* deserialize a int */
+    xdrmem_putuint32  /* serialize a int */
+};
+
+/*
+ * Initialize a memory xdr stream.
+ * Sets the xdr stream handle xdrs for use on size bytes of memory at addr.
+ * Operation flag is set to op.
+ */
+void xdrmem_create(XDR* xdrs, char* addr, unsigned int size, enum xdr_op op)
+{
+    xdrs->x_op      = op;
+    xdrs->x_ops     = &xdrmem_ops;
+    xdrs->x_private = addr;
+    xdrs->x_base    = addr;
+    xdrs->x_handy   = static_cast<int>(size);
+}
 #endif /* GMX_INTERNAL_XDR */
@@ -43,8 +43,11 @@
 
 #include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #if HAVE_IO_H
@@ -58,6 +61,7 @@
 
 #include "gromacs/fileio/filetypes.h"
 #include "gromacs/fileio/md5.h"
+#include "gromacs/fileio/xtcindex.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/mutex.h"
@@ -367,6 +371,35 @@ static int gmx_fio_close_locked(t_fileio* fio)
     return rc;
 }
 
+/* Whether XTC frame index sidecar files should be written */
+static bool xtcIndexSidecarRequested()
+{
+    return std::getenv("GMX_XTC_INDEX") != nullptr;
+}
+
+/* Write the index sidecar for an XTC file that was read up to its end,
+ * unless an equally complete sidecar is already present. */
+static void write_xtc_index_sidecar_on_close(t_fileio* fio)
+{
+    if (!fio->bRead || !fio->xtcIndex || !xtcIndexSidecarRequested() || fio->fp == nullptr
+        || gmx_fseek(fio->fp, 0, SEEK_END) != 0)
+    {
+        return;
+    }
+    const gmx_off_t fileSize = gmx_ftell(fio->fp);
+    if (fio->xtcIndex->coveredBytes() != fileSize)
+    {
+        return;
+    }
+    const std::string sidecar  = gmx::XtcFrameIndex::sidecarFileName(fio->fn);
+    const auto        existing = gmx::XtcFrameIndex::readFromFile(sidecar, fio->xtcIndex->natoms());
+    if ((!existing || existing->coveredBytes() < fileSize) && !fio->xtcIndex->writeToFile(sidecar)
+        && debug)
+    {
+        fprintf(debug, "Could not write XTC frame index file %s\n", sidecar.c_str());
+    }
+}
+
 int gmx_fio_close(t_fileio* fio)
 {
     int rc = 0;
@@ -374,6 +407,7 @@ int gmx_fio_close(t_fileio* fio)
     Lock openFilesLock(open_file_mutex);
 
     gmx_fio_lock(fio);
+    write_xtc_index_sidecar_on_close(fio);
     /* first remove it from the list */
     gmx_fio_remove(fio);
     rc = gmx_fio_close_locked(fio);
@@ -764,13 +798,120 @@ gmx_bool gmx_fio_getread(t_fileio* fio)
     return ret;
 }
 
+/* Must match definition in xtcio.cpp */
+#ifndef XTC_MAGIC
+#    define XTC_MAGIC 1995
+#endif
+
+/* Seek using the XTC frame index, returns false when the index can not
+ * be used for this seek and the file position was left unchanged. */
+static bool xtc_seek_time_indexed(t_fileio* fio, real time, int natoms, gmx_bool bSeekForwardOnly)
+{
+    if (fio->bXtcIndexDisabled)
+    {
+        return false;
+    }
+    if (!fio->bXtcIndexSidecarChecked)
+    {
+        fio->bXtcIndexSidecarChecked = TRUE;
+        auto sidecar = gmx::XtcFrameIndex::readFromFile(
+                gmx::XtcFrameIndex::sidecarFileName(fio->fn), natoms);
+        if (sidecar && (!fio->xtcIndex || sidecar->coveredBytes() > fio->xtcIndex->coveredBytes()))
+        {
+            fio->xtcIndex = std::move(sidecar);
+        }
+    }
+    if (!fio->xtcIndex || fio->xtcIndex->natoms() != natoms)
+    {
+        return false;
+    }
+
+    const gmx_off_t currentPos = gmx_ftell(fio->fp);
+    const int frame = fio->xtcIndex->findFrameAtTime(time, bSeekForwardOnly ? currentPos : 0);
+    if (frame < 0)
+    {
+        return false;
+    }
+
+    /* Check that the file still has the indexed frame at this offset,
+     * the sidecar could be stale when the trajectory was modified. */
+    const gmx::XtcFrameIndexEntry& entry = fio->xtcIndex->frames()[frame];
+    int                            magic = 0, fileNatoms = 0, fileStep = 0;
+    const bool bOK = (gmx_fseek(fio->fp, entry.offset, SEEK_SET) == 0 && xdr_int(fio->xdr, &magic)
+                      && xdr_int(fio->xdr, &fileNatoms) && xdr_int(fio->xdr, &fileStep)
+                      && magic == XTC_MAGIC && fileNatoms == natoms
+                      && fileStep == static_cast<int>(entry.step));
+    gmx_fseek(fio->fp, bOK ? entry.offset : currentPos, SEEK_SET);
+    if (!bOK)
+    {
+        fio->xtcIndex.reset();
+        fio->bXtcIndexDisabled = TRUE;
+    }
+
+    return bOK;
+}
+
 int xtc_seek_time(t_fileio* fio, real time, int natoms, gmx_bool bSeekForwardOnly)
 {
-    int ret;
+    int ret = 0;
 
     gmx_fio_lock(fio);
-    ret = xdr_xtc_seek_time(time, fio->fp, fio->xdr, natoms, bSeekForwardOnly);
+    if (!xtc_seek_time_indexed(fio, time, natoms, bSeekForwardOnly))
+    {
+        ret = xdr_xtc_seek_time(time, fio->fp, fio->xdr, natoms, bSeekForwardOnly);
+    }
     gmx_fio_unlock(fio);
 
     return ret;
 }
+
+void gmx_fio_xtc_index_frame(t_fileio* fio,
+                             gmx_off_t start,
+                             gmx_off_t end,
+                             int       natoms,
+                             int64_t   step,
+                             real      time)
+{
+    gmx_fio_lock(fio);
+    if (!fio->bRead && !xtcIndexSidecarRequested())
+    {
+        /* An index of a file being written is only useful in a sidecar */
+        fio->bXtcIndexDisabled = TRUE;
+    }
+    if (!fio->bXtcIndexDisabled && !fio->xtcIndex)
+    {
+        fio->xtcIndex = std::make_unique<gmx::XtcFrameIndex>(natoms);
+        if (!fio->bRead)
+        {
+            const std::string sidecar = gmx::XtcFrameIndex::sidecarFileName(fio->fn);
+            if (start > 0)
+            {
+                /* We are appending, continue the index of the existing part */
+                auto existing = gmx::XtcFrameIndex::readFromFile(sidecar, natoms);
+                if (existing)
+                {
+                    existing->truncate(start);
+                    fio->xtcIndex = std::move(existing);
+                }
+            }
+            if (fio->xtcIndex->coveredBytes() == start)
+            {
+                fio->xtcIndex->startWritingSidecar(sidecar);
+            }
+        }
+    }
+    if (fio->xtcIndex)
+    {
+        const bool bAdded = (fio->xtcIndex->natoms() == natoms
+                             && fio->xtcIndex->addFrame(start, end, step, time));
+        /* While reading, frames before the end of the index are already
+         * present and frames after a gap can not be indexed, but when
+         * writing every frame should be contiguous with the previous one. */
+        if (fio->xtcIndex->natoms() != natoms || (!bAdded && !fio->bRead))
+        {
+            fio->xtcIndex.reset();
+            fio->bXtcIndexDisabled = TRUE;
+        }
+    }
+    gmx_fio_unlock(fio);
+}
@@ -171,6 +171,21 @@ int gmx_fio_get_file_md5(t_fileio* fio, gmx_off_t offset, std::array<unsigned ch
 
 
 int xtc_seek_time(t_fileio* fio, real time, int natoms, gmx_bool bSeekForwardOnly);
+/* Seek to the first frame with time >= time. Uses the frame offset index
+ * when it covers the requested time, otherwise a bisection over the file.
+ * Returns 0 on success. */
+
+void gmx_fio_xtc_index_frame(t_fileio* fio,
+                             gmx_off_t start,
+                             gmx_off_t end,
+                             int       natoms,
+                             int64_t   step,
+                             real      time);
+/* Record that the XTC frame with step and time occupies bytes [start, end)
+ * of the file, for use in the frame offset index. When the environment
+ * variable GMX_XTC_INDEX is set, files opened for writing keep an index
+ * sidecar file up to date with every frame, and files read sequentially
+ * to the end write a sidecar on closing. */
 
 
 #endif
@@ -54,10 +54,17 @@
 
    WARNING WARNING WARNING WARNING */
 
+#include <memory>
+
 #include "thread_mpi/lock.h"
 
 #include "gromacs/fileio/xdrf.h"
 
+namespace gmx
+{
+class XtcFrameIndex;
+}
+
 struct t_fileio
 {
     FILE*    fp;         /* the file pointer */
@@ -75,6 +82,9 @@ struct t_fileio
                               for performance reasons: in some cases every
                               single byte that gets read/written requires
                               a lock */
+    std::unique_ptr<gmx::XtcFrameIndex> xtcIndex; /* frame offsets for XTC files */
+    gmx_bool bXtcIndexDisabled;                   /* no frame index can be kept */
+    gmx_bool bXtcIndexSidecarChecked;             /* reading the sidecar was attempted */
 };
 
 /** lock the mutex associated with a fio  */
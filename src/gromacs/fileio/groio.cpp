@@ -39,11 +39,15 @@
 
 #include "groio.h"
 
+#include <cctype>
+#include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/topology/atoms.h"
@@ -53,8 +57,10 @@
 #include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/utility/coolstuff.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 static void get_coordnum_fp(FILE* in, char* title, int* natoms)
@@ -84,6 +90,56 @@ void get_coordnum(const char* infile, int* natoms)
  * We have removed writing of variable precision to avoid compatibility
  * issues with other software packages.
  */
+/*! \brief Reads the single number in a fixed-format gro coordinate field
+ *
+ * This is what sscanf(field, "%lf %lf") returning 1 checks, but
+ * without the overhead of sscanf, which matters for large systems.
+ *
+ * \returns whether the field contains exactly one number
+ */
+static bool readGroCoordinateField(const char* field, double* value)
+{
+    char*        end;
+    const double number = std::strtod(field, &end);
+    if (end == field)
+    {
+        return false;
+    }
+    char* endOfSecond;
+    std::strtod(end, &endOfSecond);
+    if (endOfSecond != end)
+    {
+        return false;
+    }
+    *value = number;
+    return true;
+}
+
+/*! \brief Copies the first word of \p field, of at most \p maxLength characters, to \p word
+ *
+ * Equivalent to sscanf(field, "%5s", word) for maxLength = 5, \p word
+ * is left unchanged when there is no word.
+ */
+static void readGroWord(const char* field, int maxLength, char* word)
+{
+    while (std::isspace(static_cast<unsigned char>(*field)))
+    {
+        field++;
+    }
+    if (*field == '\0')
+    {
+        return;
+    }
+    int length = 0;
+    while (length < maxLength && field[length] != '\0'
+           && !std::isspace(static_cast<unsigned char>(field[length])))
+    {
+        word[length] = field[length];
+        length++;
+    }
+    word[length] = '\0';
+}
+
 static gmx_bool get_w_conf(FILE*       in,
                            const char* infile,
                            char*       title,
@@ -185,8 +241,15 @@ static gmx_bool get_w_conf(FILE*       in,
         /* residue number*/
         memcpy(name, line, 5);
         name[5] = '\0';
-        sscanf(name, "%d", &resnr);
-        sscanf(line + 5, "%5s", resname);
+        {
+            char*      end;
+            const long number = std::strtol(name, &end, 10);
+            if (end != name)
+            {
+                resnr = static_cast<int>(number);
+            }
+        }
+        readGroWord(line + 5, 5, resname);
 
         if (!oldResFirst || oldres != resnr || strncmp(resname, oldresname, sizeof(resname)) != 0)
         {
@@ -225,7 +288,7 @@ static gmx_bool get_w_conf(FILE*       in,
                 ptr++;
             }
             buf[c] = '\0';
-            if (sscanf(buf, "%lf %lf", &x1, &x2) != 1)
+            if (!readGroCoordinateField(buf, &x1))
             {
                 gmx_fatal(FARGS,
                           "Something is wrong in the coordinate formatting of file %s. Note that "
@@ -250,7 +313,9 @@ static gmx_bool get_w_conf(FILE*       in,
                     ptr++;
                 }
                 buf[c] = '\0';
-                if (sscanf(buf, "%lf", &x1) != 1)
+                char* end;
+                x1 = std::strtod(buf, &end);
+                if (end == buf)
                 {
                     v[i][m] = 0;
                 }
@@ -445,6 +510,36 @@ static const char* get_hconf_format(bool haveVelocities)
     }
 }
 
+/*! \brief The number of atoms formatted into one buffer by one thread
+ *
+ * The buffers are formatted in parallel and written in order, in batches
+ * of a few buffers per thread to limit the memory usage.
+ */
+static constexpr int c_hconfAtomsPerChunk = 16384;
+
+//! Appends printf-formatted output to \p buffer
+static void appendFormatted(std::vector<char>* buffer, const char* format, ...)
+{
+    // Sufficient for all lines of atoms with normal coordinate values
+    constexpr int c_initialSize = 128;
+
+    const size_t oldSize = buffer->size();
+    va_list      ap;
+    va_start(ap, format);
+    buffer->resize(oldSize + c_initialSize);
+    va_list apCopy;
+    va_copy(apCopy, ap);
+    int length = vsnprintf(buffer->data() + oldSize, c_initialSize, format, apCopy);
+    va_end(apCopy);
+    if (length >= c_initialSize)
+    {
+        buffer->resize(oldSize + length + 1);
+        length = vsnprintf(buffer->data() + oldSize, length + 1, format, ap);
+    }
+    va_end(ap);
+    buffer->resize(oldSize + std::max(length, 0));
+}
+
 static void write_hconf_box(FILE* out, const matrix box)
 {
     if ((box[XX][YY] != 0.0F) || (box[XX][ZZ] != 0.0F) || (box[YY][XX] != 0.0F)
@@ -469,49 +564,71 @@ void write_hconf_indexed_p(FILE*          out,
                            const rvec*    v,
                            const matrix   box)
 {
-    int ai, i, resind, resnr;
-
     fprintf(out, "%s\n", (title && title[0]) ? title : gmx::bromacs().c_str());
     fprintf(out, "%5d\n", nx);
 
-    const char* format = get_hconf_format(v != nullptr);
+    const std::string format = std::string("%5d%-5.5s%5.5s%5d") + get_hconf_format(v != nullptr);
 
-    for (i = 0; (i < nx); i++)
+    /* Formatting dominates the cost of writing large systems, so we
+     * format chunks of atoms in parallel into buffers, which we then
+     * write in order.
+     */
+    const int numChunks      = (nx + c_hconfAtomsPerChunk - 1) / c_hconfAtomsPerChunk;
+    const int chunksPerBatch = 4 * gmx_omp_get_max_threads();
+    std::vector<std::vector<char>> buffers(std::min(numChunks, chunksPerBatch));
+    for (int batchStart = 0; batchStart < numChunks; batchStart += chunksPerBatch)
     {
-        ai = index[i];
-
-        resind = atoms->atom[ai].resind;
-        std::string resnm;
-        if (resind < atoms->nres)
-        {
-            resnm = *atoms->resinfo[resind].name;
-            resnr = atoms->resinfo[resind].nr;
-        }
-        else
-        {
-            resnm = " ??? ";
-            resnr = resind + 1;
-        }
-
-        std::string nm;
-        if (atoms->atom)
-        {
-            nm = *atoms->atomname[ai];
-        }
-        else
-        {
-            nm = " ??? ";
-        }
-
-        fprintf(out, "%5d%-5.5s%5.5s%5d", resnr % 100000, resnm.c_str(), nm.c_str(), (ai + 1) % 100000);
-        /* next fprintf uses built format string */
-        if (v)
+        const int batchEnd = std::min(batchStart + chunksPerBatch, numChunks);
+#pragma omp parallel for schedule(dynamic)
+        for (int chunk = batchStart; chunk < batchEnd; chunk++)
         {
-            fprintf(out, format, x[ai][XX], x[ai][YY], x[ai][ZZ], v[ai][XX], v[ai][YY], v[ai][ZZ]);
+            try
+            {
+                std::vector<char>* buffer = &buffers[chunk - batchStart];
+                buffer->clear();
+                const int atomEnd = std::min((chunk + 1) * c_hconfAtomsPerChunk, nx);
+                for (int i = chunk * c_hconfAtomsPerChunk; i < atomEnd; i++)
+                {
+                    const int ai = index[i];
+
+                    const int   resind = atoms->atom[ai].resind;
+                    const char* resnm;
+                    int         resnr;
+                    if (resind < atoms->nres)
+                    {
+                        resnm = *atoms->resinfo[resind].name;
+                        resnr = atoms->resinfo[resind].nr;
+                    }
+                    else
+                    {
+                        resnm = " ??? ";
+                        resnr = resind + 1;
+                    }
+
+                    const char* nm = atoms->atom ? *atoms->atomname[ai] : " ??? ";
+
+                    if (v)
+                    {
+                        appendFormatted(buffer, format.c_str(), resnr % 100000, resnm, nm,
+                                        (ai + 1) % 100000, x[ai][XX], x[ai][YY], x[ai][ZZ],
+                                        v[ai][XX], v[ai][YY], v[ai][ZZ]);
+                    }
+                    else
+                    {
+                        appendFormatted(buffer, format.c_str(), resnr % 100000, resnm, nm,
+                                        (ai + 1) % 100000, x[ai][XX], x[ai][YY], x[ai][ZZ]);
+                    }
+                }
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
         }
-        else
+        for (int chunk = batchStart; chunk < batchEnd; chunk++)
         {
-            fprintf(out, format, x[ai][XX], x[ai][YY], x[ai][ZZ]);
+            const std::vector<char>& buffer = buffers[chunk - batchStart];
+            if (fwrite(buffer.data(), sizeof(char), buffer.size(), out) != buffer.size())
+            {
+                gmx_file("Cannot write gro file");
+            }
         }
     }
 
@@ -44,6 +44,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <atomic>
 
 #include "gromacs/fileio/xdr_datatype.h"
 #include "gromacs/fileio/xdrf.h"
@@ -369,6 +370,162 @@ static void receiveints(int buf[], const int num_of_ints, int num_of_bits, const
     nums[0] = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
 }
 
+/*____________________________________________________________________________
+ |
+ | Faster versions of the routines above, producing bit-identical output.
+ |
+ | The bit routines use a 64-bit accumulator so that any number of bits up
+ | to 32 is handled without per-byte branching on the bit position, and the
+ | integer routines use 64-bit arithmetic instead of byte-wise multi-precision
+ | multiplication and division whenever the packed integer fits in 64 bits,
+ | which is the case for all but extremely large ranges of coordinates.
+ | They use the same state in buf[0-2] as the routines above.
+ */
+
+/* Whether the reference implementation was selected with xdr3dfcoord_use_reference_implementation() */
+static std::atomic<bool> g_useReferenceCoordinateCodec(false);
+
+void xdr3dfcoord_use_reference_implementation(bool useReference)
+{
+    g_useReferenceCoordinateCodec = useReference;
+}
+
+static bool useReferenceCoordinateCodec()
+{
+    static const bool requestedByEnvironment = (getenv("GMX_XTC_REFERENCE_CODEC") != nullptr);
+
+    return requestedByEnvironment || g_useReferenceCoordinateCodec;
+}
+
+static inline void sendbits64(int buf[], int num_of_bits, unsigned int num)
+{
+    unsigned char* cbuf     = reinterpret_cast<unsigned char*>(buf) + 3 * sizeof(*buf);
+    unsigned int   cnt      = static_cast<unsigned int>(buf[0]);
+    int            lastbits = buf[1];
+    uint64_t       bits     = ((static_cast<uint64_t>(buf[2]) & ((1U << lastbits) - 1)) << num_of_bits)
+                    | (num & ((uint64_t(1) << num_of_bits) - 1));
+
+    lastbits += num_of_bits;
+    while (lastbits >= 8)
+    {
+        lastbits -= 8;
+        cbuf[cnt++] = static_cast<unsigned char>(bits >> lastbits);
+    }
+    buf[0] = cnt;
+    buf[1] = lastbits;
+    buf[2] = static_cast<int>(bits & 0xff);
+    if (lastbits > 0)
+    {
+        cbuf[cnt] = static_cast<unsigned char>(bits << (8 - lastbits));
+    }
+}
+
+static void sendints64(int buf[], const int num_of_bits, unsigned int sizes[3], unsigned int nums[3])
+{
+    if (num_of_bits > 64)
+    {
+        sendints(buf, 3, num_of_bits, sizes, nums);
+        return;
+    }
+    for (int i = 1; i < 3; i++)
+    {
+        if (nums[i] >= sizes[i])
+        {
+            fprintf(stderr,
+                    "major breakdown in sendints num %u doesn't "
+                    "match size %u\n",
+                    nums[i], sizes[i]);
+            exit(1);
+        }
+    }
+    uint64_t packed = (static_cast<uint64_t>(nums[0]) * sizes[1] + nums[1]) * sizes[2] + nums[2];
+
+    /* The bytes of the packed integer are stored least significant
+     * first, with the bits of each byte most significant first. */
+    int numFullBytes = num_of_bits / 8;
+    while (numFullBytes > 0)
+    {
+        const int    numBytes = std::min(numFullBytes, 4);
+        unsigned int chunk    = 0;
+        for (int b = 0; b < numBytes; b++)
+        {
+            chunk = (chunk << 8) | static_cast<unsigned int>(packed & 0xff);
+            packed >>= 8;
+        }
+        sendbits64(buf, 8 * numBytes, chunk);
+        numFullBytes -= numBytes;
+    }
+    if (num_of_bits % 8 > 0)
+    {
+        sendbits64(buf, num_of_bits % 8, static_cast<unsigned int>(packed));
+    }
+}
+
+static inline unsigned int receivebits64(int buf[], int num_of_bits)
+{
+    const unsigned char* cbuf     = reinterpret_cast<unsigned char*>(buf) + 3 * sizeof(*buf);
+    int                  cnt      = buf[0];
+    int                  lastbits = buf[1];
+    uint64_t             bits     = static_cast<uint64_t>(buf[2]) & ((1U << lastbits) - 1);
+
+    while (lastbits < num_of_bits)
+    {
+        bits = (bits << 8) | cbuf[cnt++];
+        lastbits += 8;
+    }
+    lastbits -= num_of_bits;
+    buf[0] = cnt;
+    buf[1] = lastbits;
+    buf[2] = static_cast<int>(bits & 0xff);
+
+    return static_cast<unsigned int>((bits >> lastbits) & ((uint64_t(1) << num_of_bits) - 1));
+}
+
+static void receiveints64(int buf[], int num_of_bits, const unsigned int sizes[3], int nums[3])
+{
+    if (num_of_bits > 64)
+    {
+        receiveints(buf, 3, num_of_bits, sizes, nums);
+        return;
+    }
+    /* Full bytes come first, the last chunk has 1 to 8 bits */
+    uint64_t packed = 0;
+    int      shift  = 0;
+    while (num_of_bits > 8)
+    {
+        packed |= static_cast<uint64_t>(receivebits64(buf, 8)) << shift;
+        shift += 8;
+        num_of_bits -= 8;
+    }
+    packed |= static_cast<uint64_t>(receivebits64(buf, num_of_bits)) << shift;
+
+    nums[2] = static_cast<int>(packed % sizes[2]);
+    packed /= sizes[2];
+    nums[1] = static_cast<int>(packed % sizes[1]);
+    nums[0] = static_cast<int>(packed / sizes[1]);
+}
+
+/*! \brief Convert \p size3 floats to the nearest integers after scaling with \p precision
+ *
+ * Returns false when a value would overflow, but still converts all values.
+ * Rounding is done exactly as in the loop of the reference encoder. This is
+ * deliberately not done with SIMD, since compilers contract the vector
+ * multiplication and addition into a fused multiply-add, which rounds
+ * differently and would change the output.
+ */
+static bool quantizeCoordinates(const float* fp, unsigned int size3, float precision, int* ip)
+{
+    bool bOK = true;
+    for (unsigned int i = 0; i < size3; i++)
+    {
+        const float lf = (fp[i] >= 0.0) ? fp[i] * precision + 0.5 : fp[i] * precision - 0.5;
+        /* scaling would cause overflow */
+        bOK   = bOK && (std::fabs(lf) <= maxAbsoluteInt);
+        ip[i] = static_cast<int>(lf);
+    }
+    return bOK;
+}
+
 /*____________________________________________________________________________
  |
  | xdr3dfcoord - read or write compressed 3d coordinates to xdr file.
@@ -424,6 +581,8 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
     int          errval = 1;
     int          rc;
 
+    const bool bFast = !useReferenceCoordinateCodec();
+
     bRead         = (xdrs->x_op == XDR_DECODE);
     bitsizeint[0] = bitsizeint[1] = bitsizeint[2] = 0;
     prevcoord[0] = prevcoord[1] = prevcoord[2] = 0;
@@ -486,7 +645,31 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
         lip                               = ip;
         mindiff                           = INT_MAX;
         oldlint1 = oldlint2 = oldlint3 = 0;
-        while (lfp < fp + size3)
+        if (bFast)
+        {
+            if (!quantizeCoordinates(fp, size3, *precision, ip))
+            {
+                errval = 0;
+            }
+            for (lip = ip; lip < ip + size3; lip += 3)
+            {
+                for (int d = 0; d < 3; d++)
+                {
+                    minint[d] = std::min(minint[d], lip[d]);
+                    maxint[d] = std::max(maxint[d], lip[d]);
+                }
+                diff = std::abs(oldlint1 - lip[0]) + std::abs(oldlint2 - lip[1])
+                       + std::abs(oldlint3 - lip[2]);
+                if (diff < mindiff && lip > ip)
+                {
+                    mindiff = diff;
+                }
+                oldlint1 = lip[0];
+                oldlint2 = lip[1];
+                oldlint3 = lip[2];
+            }
+        }
+        while (!bFast && lfp < fp + size3)
         {
             /* find nearest integer */
             if (*lfp >= 0.0)
@@ -672,12 +855,22 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
             tmpcoord[0] = thiscoord[0] - minint[0];
             tmpcoord[1] = thiscoord[1] - minint[1];
             tmpcoord[2] = thiscoord[2] - minint[2];
-            if (bitsize == 0)
+            if (bitsize == 0 && bFast)
+            {
+                sendbits64(buf, bitsizeint[0], tmpcoord[0]);
+                sendbits64(buf, bitsizeint[1], tmpcoord[1]);
+                sendbits64(buf, bitsizeint[2], tmpcoord[2]);
+            }
+            else if (bitsize == 0)
             {
                 sendbits(buf, bitsizeint[0], tmpcoord[0]);
                 sendbits(buf, bitsizeint[1], tmpcoord[1]);
                 sendbits(buf, bitsizeint[2], tmpcoord[2]);
             }
+            else if (bFast)
+            {
+                sendints64(buf, bitsize, sizeint, tmpcoord);
+            }
             else
             {
                 sendints(buf, 3, bitsize, sizeint, tmpcoord);
@@ -724,8 +917,20 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
             if (run != prevrun || is_smaller != 0)
             {
                 prevrun = run;
-                sendbits(buf, 1, 1); /* flag the change in run-length */
-                sendbits(buf, 5, run + is_smaller + 1);
+                if (bFast)
+                {
+                    /* flag the change in run-length, followed by the run-length */
+                    sendbits64(buf, 6, (1 << 5) | (run + is_smaller + 1));
+                }
+                else
+                {
+                    sendbits(buf, 1, 1); /* flag the change in run-length */
+                    sendbits(buf, 5, run + is_smaller + 1);
+                }
+            }
+            else if (bFast)
+            {
+                sendbits64(buf, 1, 0); /* flag the fact that runlength did not change */
             }
             else
             {
@@ -733,7 +938,14 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
             }
             for (k = 0; k < run; k += 3)
             {
-                sendints(buf, 3, smallidx, sizesmall, &tmpcoord[k]);
+                if (bFast)
+                {
+                    sendints64(buf, smallidx, sizesmall, &tmpcoord[k]);
+                }
+                else
+                {
+                    sendints(buf, 3, smallidx, sizesmall, &tmpcoord[k]);
+                }
             }
             if (is_smaller != 0)
             {
@@ -904,12 +1116,22 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
         {
             thiscoord = reinterpret_cast<int*>(lip) + i * 3;
 
-            if (bitsize == 0)
+            if (bitsize == 0 && bFast)
+            {
+                thiscoord[0] = receivebits64(buf, bitsizeint[0]);
+                thiscoord[1] = receivebits64(buf, bitsizeint[1]);
+                thiscoord[2] = receivebits64(buf, bitsizeint[2]);
+            }
+            else if (bitsize == 0)
             {
                 thiscoord[0] = receivebits(buf, bitsizeint[0]);
                 thiscoord[1] = receivebits(buf, bitsizeint[1]);
                 thiscoord[2] = receivebits(buf, bitsizeint[2]);
             }
+            else if (bFast)
+            {
+                receiveints64(buf, bitsize, sizeint, thiscoord);
+            }
             else
             {
                 receiveints(buf, 3, bitsize, sizeint, thiscoord);
@@ -925,11 +1147,11 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
             prevcoord[2] = thiscoord[2];
 
 
-            flag       = receivebits(buf, 1);
+            flag       = bFast ? receivebits64(buf, 1) : receivebits(buf, 1);
             is_smaller = 0;
             if (flag == 1)
             {
-                run        = receivebits(buf, 5);
+                run        = bFast ? receivebits64(buf, 5) : receivebits(buf, 5);
                 is_smaller = run % 3;
                 run -= is_smaller;
                 is_smaller--;
@@ -939,7 +1161,14 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
                 thiscoord += 3;
                 for (k = 0; k < run; k += 3)
                 {
-                    receiveints(buf, 3, smallidx, sizesmall, thiscoord);
+                    if (bFast)
+                    {
+                        receiveints64(buf, smallidx, sizesmall, thiscoord);
+                    }
+                    else
+                    {
+                        receiveints(buf, 3, smallidx, sizesmall, thiscoord);
+                    }
                     i++;
                     thiscoord[0] += prevcoord[0] - smallnum;
                     thiscoord[1] += prevcoord[1] - smallnum;
@@ -52,7 +52,6 @@
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/topology/atomprop.h"
 #include "gromacs/topology/ifunc.h"
-#include "gromacs/topology/residuetypes.h"
 #include "gromacs/topology/symtab.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/coolstuff.h"
@@ -296,13 +295,12 @@ void write_pdbfile_indexed(FILE*          out,
 
     fprintf(out, "MODEL %8d\n", model_nr > 0 ? model_nr : 1);
 
-    ResidueType rt;
     for (int ii = 0; ii < nindex; ii++)
     {
         int         i      = index[ii];
         int         resind = atoms->atom[i].resind;
-        std::string resnm  = *atoms->resinfo[resind].name;
-        std::string nm     = *atoms->atomname[i];
+        const char* resnm  = *atoms->resinfo[resind].name;
+        const char* nm     = *atoms->atomname[i];
 
         int           resnr = atoms->resinfo[resind].nr;
         unsigned char resic = atoms->resinfo[resind].ic;
@@ -343,22 +341,22 @@ void write_pdbfile_indexed(FILE*          out,
         bfac  = pdbinfo.bfac;
         if (!usePqrFormat)
         {
-            gmx_fprintf_pdb_atomline(out, type, i + 1, nm.c_str(), altloc, resnm.c_str(), ch, resnr,
-                                     resic, 10 * x[i][XX], 10 * x[i][YY], 10 * x[i][ZZ], occup,
-                                     bfac, atoms->atom[i].elem);
+            gmx_fprintf_pdb_atomline(out, type, i + 1, nm, altloc, resnm, ch, resnr, resic,
+                                     10 * x[i][XX], 10 * x[i][YY], 10 * x[i][ZZ], occup, bfac,
+                                     atoms->atom[i].elem);
 
             if (atoms->pdbinfo && atoms->pdbinfo[i].bAnisotropic)
             {
                 fprintf(out, "ANISOU%5d  %-4.4s%4.4s%c%4d%c %7d%7d%7d%7d%7d%7d\n", (i + 1) % 100000,
-                        nm.c_str(), resnm.c_str(), ch, resnr, (resic == '\0') ? ' ' : resic,
+                        nm, resnm, ch, resnr, (resic == '\0') ? ' ' : resic,
                         atoms->pdbinfo[i].uij[0], atoms->pdbinfo[i].uij[1], atoms->pdbinfo[i].uij[2],
                         atoms->pdbinfo[i].uij[3], atoms->pdbinfo[i].uij[4], atoms->pdbinfo[i].uij[5]);
             }
         }
         else
         {
-            gmx_fprintf_pqr_atomline(out, type, i + 1, nm.c_str(), resnm.c_str(), ch, resnr,
-                                     10 * x[i][XX], 10 * x[i][YY], 10 * x[i][ZZ], occup, bfac);
+            gmx_fprintf_pqr_atomline(out, type, i + 1, nm, resnm, ch, resnr, 10 * x[i][XX],
+                                     10 * x[i][YY], 10 * x[i][ZZ], occup, bfac);
         }
     }
 
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Tests reading and writing checkpoints with separate atom data files.
+ *
+ * \ingroup module_fileio
+ */
+
+#include "gmxpre.h"
+
+#include <cstring>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/checkpoint.h"
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/mdtypes/checkpointdata.h"
+#include "gromacs/mdtypes/observableshistory.h"
+#include "gromacs/mdtypes/state.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/mdmodulenotification.h"
+#include "gromacs/utility/path.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(CheckpointAtomData, RoundTripThroughSeparateParts)
+{
+    TestFileManager                     fileManager;
+    const int                           natoms      = 5;
+    const int                           stateFlags  = (1 << estX) | (1 << estV) | (1 << estBOX);
+    const std::vector<std::vector<int>> partIndices = { { 3, 0, 4 }, { 1, 2 } };
+    const int                           numParts    = partIndices.size();
+    const std::string checkpointFileName = fileManager.getTemporaryFilePath("state.cpt");
+    const std::string directory          = Path::getParentPath(checkpointFileName);
+
+    for (int part = 0; part < numParts; part++)
+    {
+        t_state localState;
+        localState.flags = stateFlags;
+        state_change_natoms(&localState, partIndices[part].size());
+        for (size_t i = 0; i < partIndices[part].size(); i++)
+        {
+            const real a    = partIndices[part][i];
+            localState.x[i] = { a, 2 * a, 3 * a };
+            localState.v[i] = { -a, -2 * a, -3 * a };
+        }
+        write_checkpoint_atom_data_part(
+                checkpointAtomDataPartFileName(directory, "state_step10", part).c_str(), 10, part,
+                numParts, natoms, partIndices[part], localState);
+    }
+
+    t_state globalState;
+    globalState.flags = stateFlags;
+    state_change_natoms(&globalState, natoms);
+    CheckpointHeaderContents headerContents = {};
+    headerContents.double_prec              = GMX_DOUBLE;
+    headerContents.step                     = 10;
+    headerContents.natoms                   = natoms;
+    headerContents.flags_state              = stateFlags;
+    headerContents.numAtomDataParts         = numParts;
+    std::strcpy(headerContents.atomDataPartBaseName, "state_step10");
+    ObservablesHistory               observablesHistory;
+    MdModulesNotifier                notifier;
+    std::vector<gmx_file_position_t> outputFiles;
+    WriteCheckpointDataHolder        modularSimulatorCheckpointData;
+    t_fileio*                        fio = gmx_fio_open(checkpointFileName.c_str(), "w");
+    write_checkpoint_data(fio, headerContents, false, 0, &globalState, &observablesHistory,
+                          notifier, &outputFiles, &modularSimulatorCheckpointData);
+    gmx_fio_close(fio);
+
+    t_trxframe frame;
+    fio = gmx_fio_open(checkpointFileName.c_str(), "r");
+    read_checkpoint_trxframe(fio, &frame);
+    gmx_fio_close(fio);
+
+    ASSERT_EQ(natoms, frame.natoms);
+    ASSERT_TRUE(frame.bX);
+    ASSERT_TRUE(frame.bV);
+    for (int i = 0; i < natoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ((d + 1) * i, frame.x[i][d]);
+            EXPECT_EQ(-(d + 1) * i, frame.v[i][d]);
+        }
+    }
+    sfree(frame.x);
+    sfree(frame.v);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
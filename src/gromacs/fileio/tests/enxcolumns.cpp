@@ -0,0 +1,214 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the column-wise energy term sidecar.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/enxcolumns.h"
+
+#include <cstdlib>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/enxio.h"
+#include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/setenv.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Returns the value of term \p term in frame \p frame used in the tests
+real termValue(int frame, int term)
+{
+    return 0.5 * frame + 10 * term;
+}
+
+TEST(EnergyColumnsTest, ReadsSelectedTermsOverBlocks)
+{
+    TestFileManager                fileManager;
+    const std::string              fileName  = fileManager.getTemporaryFilePath("ener.edrcol");
+    const std::vector<std::string> termNames = { "Bond", "Angle", "Potential", "Pressure" };
+    const int                      numFrames = 11;
+    {
+        // Use blocks with fewer frames than the total, so a partial block is written last
+        auto writer = EnergyColumnWriter::create(fileName, termNames, 4);
+        ASSERT_NE(nullptr, writer);
+        for (int frame = 0; frame < numFrames; frame++)
+        {
+            std::vector<real> values;
+            for (size_t term = 0; term < termNames.size(); term++)
+            {
+                values.push_back(termValue(frame, term));
+            }
+            EXPECT_TRUE(writer->addFrame(frame * 100, frame * 0.2, values));
+        }
+    }
+
+    auto reader = EnergyColumnReader::open(fileName);
+    ASSERT_NE(nullptr, reader);
+    ASSERT_EQ(termNames.size(), reader->termNames().size());
+    EXPECT_EQ(2, reader->termIndex("Potential"));
+    EXPECT_EQ(-1, reader->termIndex("Kinetic En."));
+
+    EnergyColumns columns;
+    ASSERT_TRUE(reader->readTerms(std::vector<int>{ 3, 1 }, &columns));
+    ASSERT_EQ(numFrames, gmx::ssize(columns.steps));
+    ASSERT_EQ(2, gmx::ssize(columns.values));
+    for (int frame = 0; frame < numFrames; frame++)
+    {
+        EXPECT_EQ(frame * 100, columns.steps[frame]);
+        EXPECT_DOUBLE_EQ(frame * 0.2, columns.times[frame]);
+        EXPECT_FLOAT_EQ(termValue(frame, 3), columns.values[0][frame]);
+        EXPECT_FLOAT_EQ(termValue(frame, 1), columns.values[1][frame]);
+    }
+
+    EXPECT_FALSE(reader->readTerms(std::vector<int>{ 4 }, &columns));
+}
+
+TEST(EnergyColumnsTest, IgnoresIncompleteLastBlock)
+{
+    TestFileManager                fileManager;
+    const std::string              fileName  = fileManager.getTemporaryFilePath("ener.edrcol");
+    const std::vector<std::string> termNames = { "Bond", "Angle" };
+    {
+        auto writer = EnergyColumnWriter::create(fileName, termNames, 2);
+        ASSERT_NE(nullptr, writer);
+        for (int frame = 0; frame < 4; frame++)
+        {
+            EXPECT_TRUE(writer->addFrame(frame, frame,
+                                         std::vector<real>{ termValue(frame, 0), termValue(frame, 1) }));
+        }
+    }
+    // Cut off the end of the last column of the second block
+    FILE* fp = std::fopen(fileName.c_str(), "rb");
+    ASSERT_NE(nullptr, fp);
+    std::vector<char> contents;
+    int               c;
+    while ((c = std::fgetc(fp)) != EOF)
+    {
+        contents.push_back(c);
+    }
+    std::fclose(fp);
+    fp = std::fopen(fileName.c_str(), "wb");
+    ASSERT_NE(nullptr, fp);
+    std::fwrite(contents.data(), 1, contents.size() - 1, fp);
+    std::fclose(fp);
+
+    auto reader = EnergyColumnReader::open(fileName);
+    ASSERT_NE(nullptr, reader);
+    EnergyColumns columns;
+    ASSERT_TRUE(reader->readTerms(std::vector<int>{ 0 }, &columns));
+    EXPECT_EQ(2, gmx::ssize(columns.steps));
+    ASSERT_TRUE(reader->readTerms(std::vector<int>{ 1 }, &columns));
+    EXPECT_EQ(2, gmx::ssize(columns.steps));
+}
+
+TEST(EnergyColumnsTest, SidecarIsWrittenWithEnergyFile)
+{
+    TestFileManager   fileManager;
+    const std::string fileName = fileManager.getTemporaryFilePath("ener.edr");
+    // Registers the sidecar for clean-up
+    ASSERT_EQ(EnergyColumnWriter::sidecarFileName(fileName),
+              fileManager.getTemporaryFilePath("ener.edrcol"));
+
+    const char*       environmentVariable       = getenv("GMX_EDR_COLUMNS");
+    const std::string environmentVariableBackup = environmentVariable ? environmentVariable : "";
+    gmxSetenv("GMX_EDR_COLUMNS", "1", 1);
+    ener_file_t ef = open_enx(fileName.c_str(), "w");
+    if (environmentVariable == nullptr)
+    {
+        gmxUnsetenv("GMX_EDR_COLUMNS");
+    }
+    else
+    {
+        gmxSetenv("GMX_EDR_COLUMNS", environmentVariableBackup.c_str(), 1);
+    }
+    const int    numTerms = 2;
+    gmx_enxnm_t* names;
+    snew(names, numTerms);
+    names[0].name = gmx_strdup("Bond");
+    names[0].unit = gmx_strdup("kJ/mol");
+    names[1].name = gmx_strdup("Angle");
+    names[1].unit = gmx_strdup("kJ/mol");
+    int nre       = numTerms;
+    do_enxnms(ef, &nre, &names);
+    t_enxframe frame;
+    init_enxframe(&frame);
+    snew(frame.ener, numTerms);
+    frame.e_alloc = numTerms;
+    frame.nre     = numTerms;
+    for (int i = 0; i < 3; i++)
+    {
+        frame.step = i * 10;
+        frame.t    = i;
+        for (int term = 0; term < numTerms; term++)
+        {
+            frame.ener[term].e = termValue(i, term);
+        }
+        do_enx(ef, &frame);
+    }
+    free_enxframe(&frame);
+    free_enxnms(numTerms, names);
+    done_ener_file(ef);
+
+    auto reader = EnergyColumnReader::open(EnergyColumnWriter::sidecarFileName(fileName));
+    ASSERT_NE(nullptr, reader);
+    EXPECT_EQ(1, reader->termIndex("Angle"));
+    EnergyColumns columns;
+    ASSERT_TRUE(reader->readTerms(std::vector<int>{ 1 }, &columns));
+    ASSERT_EQ(3, gmx::ssize(columns.steps));
+    EXPECT_EQ(20, columns.steps[2]);
+    EXPECT_FLOAT_EQ(termValue(2, 1), columns.values[0][2]);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,139 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the compressed coordinate encoding in xdr3dfcoord.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/xdrf.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Encodes \p x with the reference or the fast implementation and returns the XDR bytes
+std::vector<char> encode(std::vector<float> x, float precision, bool useReference)
+{
+    std::vector<char> buffer(x.size() * sizeof(float) + 1024);
+    XDR               xdrs;
+    xdrmem_create(&xdrs, buffer.data(), buffer.size(), XDR_ENCODE);
+    xdr3dfcoord_use_reference_implementation(useReference);
+    int size = x.size() / 3;
+    EXPECT_EQ(1, xdr3dfcoord(&xdrs, x.data(), &size, &precision));
+    buffer.resize(xdr_getpos(&xdrs));
+    xdr_destroy(&xdrs);
+    xdr3dfcoord_use_reference_implementation(false);
+    return buffer;
+}
+
+//! Decodes \p numAtoms coordinates from \p buffer with the reference or the fast implementation
+std::vector<float> decode(std::vector<char> buffer, int numAtoms, bool useReference)
+{
+    std::vector<float> x(3 * numAtoms);
+    XDR                xdrs;
+    xdrmem_create(&xdrs, buffer.data(), buffer.size(), XDR_DECODE);
+    xdr3dfcoord_use_reference_implementation(useReference);
+    int   size      = numAtoms;
+    float precision = 0;
+    EXPECT_EQ(1, xdr3dfcoord(&xdrs, x.data(), &size, &precision));
+    EXPECT_EQ(numAtoms, size);
+    EXPECT_EQ(xdr_getpos(&xdrs), buffer.size());
+    xdr_destroy(&xdrs);
+    xdr3dfcoord_use_reference_implementation(false);
+    return x;
+}
+
+/*! \brief Parameters are the box size, the precision and the fraction
+ * of atoms placed close to the previous atom, as in water molecules. */
+using CoordinateCodecParameters = std::tuple<float, float, float>;
+
+class CoordinateCodecTest : public ::testing::TestWithParam<CoordinateCodecParameters>
+{
+};
+
+TEST_P(CoordinateCodecTest, FastImplementationMatchesReference)
+{
+    const float boxSize       = std::get<0>(GetParam());
+    const float precision     = std::get<1>(GetParam());
+    const float closeFraction = std::get<2>(GetParam());
+
+    std::mt19937                          rng(1234);
+    std::uniform_real_distribution<float> position(-0.5F * boxSize, boxSize);
+    std::uniform_real_distribution<float> displacement(-0.15F, 0.15F);
+    std::uniform_real_distribution<float> uniform(0.0F, 1.0F);
+    // Also cover the special handling of up to 9 atoms
+    for (int numAtoms : { 1, 5, 9, 10, 333, 2001 })
+    {
+        SCOPED_TRACE("with " + std::to_string(numAtoms) + " atoms");
+        std::vector<float> x(3 * numAtoms);
+        for (int i = 0; i < numAtoms; i++)
+        {
+            const bool isClose = (i > 0 && uniform(rng) < closeFraction);
+            for (int d = 0; d < 3; d++)
+            {
+                x[3 * i + d] = isClose ? x[3 * (i - 1) + d] + displacement(rng) : position(rng);
+            }
+        }
+
+        const std::vector<char> reference = encode(x, precision, true);
+        EXPECT_EQ(reference, encode(x, precision, false));
+
+        const std::vector<float> referenceX = decode(reference, numAtoms, true);
+        EXPECT_EQ(referenceX, decode(reference, numAtoms, false));
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(ProducesIdenticalOutput,
+                        CoordinateCodecTest,
+                        ::testing::Combine(::testing::Values(2.0F, 100.0F, 40000.0F),
+                                           ::testing::Values(100.0F, 1000.0F),
+                                           ::testing::Values(0.0F, 0.7F)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
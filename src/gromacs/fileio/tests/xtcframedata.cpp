@@ -0,0 +1,130 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for copying raw XTC frames without decoding the coordinates.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/xtcio.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(XtcFrameDataTest, CopiedFramesHaveNewTimesAndSameCoordinates)
+{
+    constexpr int     c_numAtoms  = 50;
+    constexpr int     c_numFrames = 3;
+    TestFileManager   fileManager;
+    const std::string inputName  = fileManager.getTemporaryFilePath("in.xtc");
+    const std::string outputName = fileManager.getTemporaryFilePath("out.xtc");
+
+    matrix            box = { { 3, 0, 0 }, { 0, 3, 0 }, { 0, 0, 3 } };
+    std::vector<RVec> x(c_numAtoms);
+    t_fileio*         fio = open_xtc(inputName.c_str(), "w");
+    for (int frame = 0; frame < c_numFrames; frame++)
+    {
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            x[i] = { 0.01F * (i + frame), 0.02F * i, 0.03F * (i % 7) };
+        }
+        write_xtc(fio, c_numAtoms, frame, 0.1F * frame, box, as_rvec_array(x.data()), 1000);
+    }
+    close_xtc(fio);
+
+    t_fileio*         in  = open_xtc(inputName.c_str(), "r");
+    t_fileio*         out = open_xtc(outputName.c_str(), "w");
+    std::vector<char> frameData;
+    gmx_bool          bOK;
+    int               numFrames = 0;
+    while (read_next_xtc_frame_data(in, c_numAtoms, &frameData, &bOK))
+    {
+        int     natoms;
+        int64_t step;
+        real    time;
+        ASSERT_TRUE(read_xtc_frame_data_header(&frameData, &natoms, &step, &time));
+        EXPECT_EQ(c_numAtoms, natoms);
+        EXPECT_EQ(numFrames, step);
+        EXPECT_TRUE(write_xtc_frame_data(out, &frameData, step + 10, time + 5));
+        numFrames++;
+    }
+    EXPECT_EQ(c_numFrames, numFrames);
+    close_xtc(in);
+    close_xtc(out);
+
+    t_fileio*         original = open_xtc(inputName.c_str(), "r");
+    t_fileio*         copy     = open_xtc(outputName.c_str(), "r");
+    std::vector<RVec> x1(c_numAtoms), x2(c_numAtoms);
+    matrix            box1, box2;
+    int64_t           step1, step2;
+    real              time1, time2, prec1, prec2;
+    gmx_bool          bOK1, bOK2;
+    for (int frame = 0; frame < c_numFrames; frame++)
+    {
+        ASSERT_TRUE(read_next_xtc(original, c_numAtoms, &step1, &time1, box1,
+                                  as_rvec_array(x1.data()), &prec1, &bOK1));
+        ASSERT_TRUE(read_next_xtc(copy, c_numAtoms, &step2, &time2, box2,
+                                  as_rvec_array(x2.data()), &prec2, &bOK2));
+        EXPECT_EQ(step1 + 10, step2);
+        EXPECT_FLOAT_EQ(time1 + 5, time2);
+        EXPECT_EQ(prec1, prec2);
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(x1[i][d], x2[i][d]);
+            }
+        }
+    }
+    close_xtc(original);
+    close_xtc(copy);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
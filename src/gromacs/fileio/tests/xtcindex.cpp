@@ -0,0 +1,171 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the XTC frame offset index.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/xtcindex.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/setenv.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(XtcFrameIndexTest, AcceptsOnlyContiguousFrames)
+{
+    XtcFrameIndex index(3);
+    EXPECT_FALSE(index.addFrame(10, 20, 0, 0.0F));
+    EXPECT_TRUE(index.addFrame(0, 20, 0, 0.0F));
+    EXPECT_FALSE(index.addFrame(24, 40, 1, 1.0F));
+    EXPECT_TRUE(index.addFrame(20, 40, 1, 1.0F));
+    EXPECT_EQ(2, index.frames().ssize());
+    EXPECT_EQ(40, index.coveredBytes());
+
+    index.truncate(39);
+    EXPECT_EQ(1, index.frames().ssize());
+    EXPECT_EQ(20, index.coveredBytes());
+}
+
+TEST(XtcFrameIndexTest, FindsFramesByTime)
+{
+    XtcFrameIndex index(3);
+    for (int i = 0; i < 5; i++)
+    {
+        index.addFrame(i * 100, (i + 1) * 100, i * 10, i * 2.0F);
+    }
+    EXPECT_EQ(0, index.findFrameAtTime(-1.0F, 0));
+    EXPECT_EQ(2, index.findFrameAtTime(4.0F, 0));
+    EXPECT_EQ(3, index.findFrameAtTime(4.5F, 0));
+    EXPECT_EQ(3, index.findFrameAtTime(4.0F, 300));
+    EXPECT_EQ(-1, index.findFrameAtTime(9.0F, 0));
+}
+
+TEST(XtcFrameIndexTest, SidecarFileRoundTrips)
+{
+    TestFileManager   fileManager;
+    const std::string fileName = fileManager.getTemporaryFilePath("traj.xtcidx");
+
+    XtcFrameIndex index(7);
+    index.addFrame(0, 64, 0, 0.0F);
+    index.addFrame(64, 130, 5, 0.5F);
+    ASSERT_TRUE(index.writeToFile(fileName));
+
+    EXPECT_EQ(nullptr, XtcFrameIndex::readFromFile(fileName, 8));
+    auto readIndex = XtcFrameIndex::readFromFile(fileName, 7);
+    ASSERT_NE(nullptr, readIndex);
+    ASSERT_EQ(2, readIndex->frames().ssize());
+    EXPECT_EQ(64, readIndex->frames()[1].offset);
+    EXPECT_EQ(130, readIndex->frames()[1].end);
+    EXPECT_EQ(5, readIndex->frames()[1].step);
+    EXPECT_FLOAT_EQ(0.5F, readIndex->frames()[1].time);
+}
+
+TEST(XtcFrameIndexTest, SeekUsesSidecarWrittenDuringOutput)
+{
+    TestFileManager   fileManager;
+    const std::string fileName = fileManager.getTemporaryFilePath("traj.xtc");
+    // Registers the sidecar for clean-up
+    ASSERT_EQ(XtcFrameIndex::sidecarFileName(fileName),
+              fileManager.getTemporaryFilePath("traj.xtcidx"));
+    const int         natoms   = 4;
+    const real        prec     = 1000;
+    matrix            box      = { { 2, 0, 0 }, { 0, 2, 0 }, { 0, 0, 2 } };
+    std::vector<RVec> x(natoms);
+
+    const char*       environmentVariable = getenv("GMX_XTC_INDEX");
+    const std::string environmentVariableBackup = environmentVariable ? environmentVariable : "";
+    gmxSetenv("GMX_XTC_INDEX", "1", 1);
+    t_fileio* fio = open_xtc(fileName.c_str(), "w");
+    for (int frame = 0; frame < 10; frame++)
+    {
+        for (int i = 0; i < natoms; i++)
+        {
+            x[i] = { 0.1F * frame, 0.2F * i, 0.3F };
+        }
+        ASSERT_EQ(1,
+                  write_xtc(fio, natoms, frame * 100, 0.5F * frame, box, as_rvec_array(x.data()), prec));
+    }
+    close_xtc(fio);
+    if (environmentVariable == nullptr)
+    {
+        gmxUnsetenv("GMX_XTC_INDEX");
+    }
+    else
+    {
+        gmxSetenv("GMX_XTC_INDEX", environmentVariableBackup.c_str(), 1);
+    }
+
+    auto index = XtcFrameIndex::readFromFile(XtcFrameIndex::sidecarFileName(fileName), natoms);
+    ASSERT_NE(nullptr, index);
+    EXPECT_EQ(10, index->frames().ssize());
+
+    fio = open_xtc(fileName.c_str(), "r");
+    int      readNatoms;
+    int64_t  step;
+    real     time, readPrec;
+    rvec*    readX;
+    gmx_bool bOK;
+    ASSERT_EQ(1, read_first_xtc(fio, &readNatoms, &step, &time, box, &readX, &readPrec, &bOK));
+    ASSERT_EQ(0, xtc_seek_time(fio, 3.2, natoms, TRUE));
+    ASSERT_EQ(1, read_next_xtc(fio, natoms, &step, &time, box, readX, &readPrec, &bOK));
+    EXPECT_EQ(700, step);
+    EXPECT_NEAR(0.7, readX[0][XX], 1e-3);
+    sfree(readX);
+    close_xtc(fio);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,140 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for reading XTC frames ahead on multiple threads.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/xtcprefetch.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+class XtcFramePrefetcherTest : public ::testing::TestWithParam<int>
+{
+public:
+    XtcFramePrefetcherTest() : fileName_(fileManager_.getTemporaryFilePath("traj.xtc"))
+    {
+        matrix            box = { { 3, 0, 0 }, { 0, 3, 0 }, { 0, 0, 3 } };
+        std::vector<RVec> x(c_numAtoms);
+        t_fileio*         fio = open_xtc(fileName_.c_str(), "w");
+        for (int frame = 0; frame < c_numFrames; frame++)
+        {
+            for (int i = 0; i < c_numAtoms; i++)
+            {
+                x[i] = { 0.01F * (i + frame), 0.02F * i, 0.03F * (i % 7) };
+            }
+            write_xtc(fio, c_numAtoms, frame, 0.1F * frame, box, as_rvec_array(x.data()), 1000);
+        }
+        close_xtc(fio);
+    }
+
+    //! Number of atoms, large enough for compression to be used
+    static constexpr int c_numAtoms = 50;
+    //! Number of frames, not a multiple of the tested thread counts
+    static constexpr int c_numFrames = 11;
+
+    TestFileManager fileManager_;
+    std::string     fileName_;
+};
+
+TEST_P(XtcFramePrefetcherTest, ReadsTheSameFramesAsSerialReading)
+{
+    t_fileio* serialFile   = open_xtc(fileName_.c_str(), "r");
+    t_fileio* prefetchFile = open_xtc(fileName_.c_str(), "r");
+
+    XtcFramePrefetcher prefetcher(prefetchFile, c_numAtoms, GetParam());
+    std::vector<RVec>  x1(c_numAtoms), x2(c_numAtoms);
+    matrix             box1, box2;
+    int64_t            step1, step2;
+    real               time1, time2, prec1, prec2;
+    gmx_bool           bOK1, bOK2;
+    int                numFrames = 0;
+    while (true)
+    {
+        int result1 = read_next_xtc(serialFile, c_numAtoms, &step1, &time1, box1,
+                                    as_rvec_array(x1.data()), &prec1, &bOK1);
+        int result2 = prefetcher.readNextFrame(&step2, &time2, box2, as_rvec_array(x2.data()),
+                                               &prec2, &bOK2);
+        ASSERT_EQ(result1, result2);
+        EXPECT_EQ(bOK1, bOK2);
+        if (result1 == 0)
+        {
+            break;
+        }
+        numFrames++;
+        EXPECT_EQ(step1, step2);
+        EXPECT_EQ(time1, time2);
+        EXPECT_EQ(prec1, prec2);
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ(box1[d][d], box2[d][d]);
+        }
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(x1[i][d], x2[i][d]);
+            }
+        }
+    }
+    EXPECT_EQ(c_numFrames, numFrames);
+
+    close_xtc(serialFile);
+    close_xtc(prefetchFile);
+}
+
+INSTANTIATE_TEST_CASE_P(WithThreadCounts, XtcFramePrefetcherTest, ::testing::Values(1, 2, 4));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -150,6 +150,25 @@ TEST_F(XvgioTest, readXvgIgnoreCommentLineWorks)
     compareValues(xvgRefData.asConstView(), xvgTestData.asConstView());
 }
 
+TEST_F(XvgioTest, readXvgShortLineIsPaddedWithZeros)
+{
+    useStringAsXvgFile(
+            "1 2 3\n"
+            "4 5\n"
+            "7 8x 9\n");
+    writeXvgFile();
+
+    MultiDimArray<std::vector<double>, dynamicExtents2D> xvgTestData = readXvgData(referenceFilename());
+
+    const int                                            numRows    = 3;
+    const int                                            numColumns = 3;
+    MultiDimArray<std::vector<double>, dynamicExtents2D> xvgRefData(numRows, numColumns);
+    std::iota(begin(xvgRefData), end(xvgRefData), 1);
+    xvgRefData(1, 2) = 0;
+
+    compareValues(xvgRefData.asConstView(), xvgTestData.asConstView());
+}
+
 // TODO Remove this test once all calls to read_xvg have been ported to readXvgData
 TEST_F(XvgioTest, readXvgDeprecatedWorks)
 {
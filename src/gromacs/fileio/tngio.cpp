@@ -401,7 +401,8 @@ static void tng_set_frames_per_frame_set(gmx_tng_trajectory_t gmx_tng,
     /* FIXME after 5.0: consider nstenergy also? */
     if (bUseLossyCompression)
     {
-        gcd = ir->nstxout_compressed;
+        gcd = greatest_common_divisor_if_positive(ir->nstxout_compressed, ir->nstvout_compressed);
+        gcd = greatest_common_divisor_if_positive(gcd, ir->nstfout_compressed);
     }
     else
     {
@@ -444,9 +445,15 @@ static void set_writing_intervals(gmx_tng_trajectory_t gmx_tng,
     {
         xout = ir->nstxout_compressed;
 
-        /* If there is no uncompressed coordinate output write forces
-           and velocities to the compressed tng file. */
-        if (ir->nstxout)
+        /* Write the compressed velocity and force output when requested.
+           Otherwise, if there is no uncompressed coordinate output write
+           forces and velocities to the compressed tng file. */
+        if (ir->nstvout_compressed > 0 || ir->nstfout_compressed > 0)
+        {
+            vout = ir->nstvout_compressed;
+            fout = ir->nstfout_compressed;
+        }
+        else if (ir->nstxout)
         {
             vout = 0;
             fout = 0;
@@ -41,6 +41,8 @@
 
 #include "gromacs/fileio/tpxio.h"
 
+#include "config.h"
+
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -49,6 +51,13 @@
 #include <memory>
 #include <vector>
 
+#if HAVE_MMAP
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
 #include "gromacs/fileio/filetypes.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
@@ -68,8 +77,10 @@
 #include "gromacs/topology/mtop_util.h"
 #include "gromacs/topology/symtab.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/alignedallocator.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/baseversion.h"
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
@@ -134,6 +145,7 @@ enum tpxv
     tpxv_StoreNonBondedInteractionExclusionGroup, /**< Store the non bonded interaction exclusion group in the topology */
     tpxv_VSite1,                                  /**< Added 1 type virtual site */
     tpxv_MTS,                                     /**< Added multiple time stepping */
+    tpxv_CompressedVelocitiesAndForces,           /**< Added compressed v and f output */
     tpxv_Count                                    /**< the total number of tpxv versions */
 };
 
@@ -1141,6 +1153,16 @@ static void do_inputrec(gmx::ISerializer* serializer, t_inputrec* ir, int file_v
     serializer->doInt(&ir->nstfout);
     serializer->doInt(&ir->nstenergy);
     serializer->doInt(&ir->nstxout_compressed);
+    if (file_version >= tpxv_CompressedVelocitiesAndForces)
+    {
+        serializer->doInt(&ir->nstvout_compressed);
+        serializer->doInt(&ir->nstfout_compressed);
+    }
+    else
+    {
+        ir->nstvout_compressed = 0;
+        ir->nstfout_compressed = 0;
+    }
     if (file_version >= 59)
     {
         serializer->doDouble(&ir->init_t);
@@ -3165,6 +3187,76 @@ static void doTpxBodyBuffer(gmx::ISerializer* serializer, gmx::ArrayRef<char> bu
     serializer->doOpaque(buffer.data(), buffer.size());
 }
 
+namespace
+{
+
+/*! \brief Read-only memory map of the body of a TPR file
+ *
+ * This lets the body be deserialized directly from the page cache of
+ * the file, instead of first reading it into a buffer. When the file
+ * can not be mapped, data() is empty and the body should be read
+ * through the file I/O layer instead.
+ */
+class MappedTprBody
+{
+public:
+    MappedTprBody(const char* fileName, gmx_off_t bodyOffset, int64_t bodySize)
+    {
+#if HAVE_MMAP
+        int fd = open(fileName, O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat fileStatus;
+        if (bodyOffset > 0 && bodySize > 0 && fstat(fd, &fileStatus) == 0
+            && fileStatus.st_size >= bodyOffset + bodySize)
+        {
+            /* The mapping needs to start at a page boundary */
+            const gmx_off_t mapOffset = bodyOffset - bodyOffset % gmx::pageSize();
+            mappingSize_              = bodyOffset + bodySize - mapOffset;
+            void* mapping = mmap(nullptr, mappingSize_, PROT_READ, MAP_PRIVATE, fd, mapOffset);
+            if (mapping != MAP_FAILED)
+            {
+                mapping_ = mapping;
+                body_    = gmx::constArrayRefFromArray(
+                        static_cast<const char*>(mapping) + (bodyOffset - mapOffset), bodySize);
+            }
+        }
+        close(fd);
+#else
+        GMX_UNUSED_VALUE(fileName);
+        GMX_UNUSED_VALUE(bodyOffset);
+        GMX_UNUSED_VALUE(bodySize);
+#endif
+    }
+
+    ~MappedTprBody()
+    {
+#if HAVE_MMAP
+        if (mapping_ != nullptr)
+        {
+            munmap(mapping_, mappingSize_);
+        }
+#endif
+    }
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(MappedTprBody);
+
+    //! Returns the mapped body, empty when mapping failed
+    gmx::ArrayRef<const char> data() const { return body_; }
+
+private:
+    //! The start of the mapping, nullptr when not mapped
+    void* mapping_ = nullptr;
+    //! The size of the mapping
+    size_t mappingSize_ = 0;
+    //! The body of the TPR file within the mapping
+    gmx::ArrayRef<const char> body_;
+};
+
+} // namespace
+
 /*! \brief
  * Populates simulation datastructures.
  *
@@ -3183,6 +3275,7 @@ static void doTpxBodyBuffer(gmx::ISerializer* serializer, gmx::ArrayRef<char> bu
  *
  * \param[in] tpx The file header.
  * \param[in] serializer The Serialization interface used to read the TPR.
+ * \param[in] fio The file the TPR is read from, positioned after the header.
  * \param[out] ir Input rec to populate.
  * \param[out] state State vectors to populate.
  * \param[out] x Coordinates to populate if needed.
@@ -3193,6 +3286,7 @@ static void doTpxBodyBuffer(gmx::ISerializer* serializer, gmx::ArrayRef<char> bu
  */
 static PartialDeserializedTprFile readTpxBody(TpxFileHeader*    tpx,
                                               gmx::ISerializer* serializer,
+                                              t_fileio*         fio,
                                               t_inputrec*       ir,
                                               t_state*          state,
                                               rvec*             x,
@@ -3202,12 +3296,25 @@ static PartialDeserializedTprFile readTpxBody(TpxFileHeader*    tpx,
     PartialDeserializedTprFile partialDeserializedTpr;
     if (tpx->fileVersion >= tpxv_AddSizeField && tpx->fileGeneration >= 27)
     {
-        partialDeserializedTpr.body.resize(tpx->sizeOfTprBody);
         partialDeserializedTpr.header = *tpx;
-        doTpxBodyBuffer(serializer, partialDeserializedTpr.body);
+        // The body is a single opaque block directly after the header, so
+        // we can deserialize it straight from a memory map of the file.
+        MappedTprBody mappedBody(gmx_fio_getname(fio), gmx_fio_ftell(fio), tpx->sizeOfTprBody);
+        if (!mappedBody.data().empty())
+        {
+            gmx::InMemoryDeserializer tprBodyDeserializer(
+                    mappedBody.data(), tpx->isDouble, gmx::EndianSwapBehavior::SwapIfHostIsLittleEndian);
+            partialDeserializedTpr.pbcType =
+                    do_tpx_body(&tprBodyDeserializer, tpx, ir, state, x, v, mtop);
+        }
+        else
+        {
+            partialDeserializedTpr.body.resize(tpx->sizeOfTprBody);
+            doTpxBodyBuffer(serializer, partialDeserializedTpr.body);
 
-        partialDeserializedTpr.pbcType =
-                completeTprDeserialization(&partialDeserializedTpr, ir, state, x, v, mtop);
+            partialDeserializedTpr.pbcType =
+                    completeTprDeserialization(&partialDeserializedTpr, ir, state, x, v, mtop);
+        }
     }
     else
     {
@@ -3314,7 +3421,8 @@ PartialDeserializedTprFile read_tpx_state(const char* fn, t_inputrec* ir, t_stat
     PartialDeserializedTprFile partialDeserializedTpr;
     do_tpxheader(&serializer, &partialDeserializedTpr.header, fn, fio, ir == nullptr);
     partialDeserializedTpr =
-            readTpxBody(&partialDeserializedTpr.header, &serializer, ir, state, nullptr, nullptr, mtop);
+            readTpxBody(&partialDeserializedTpr.header, &serializer, fio, ir, state, nullptr,
+                        nullptr, mtop);
     close_tpx(fio);
     return partialDeserializedTpr;
 }
@@ -3329,7 +3437,7 @@ PbcType read_tpx(const char* fn, t_inputrec* ir, matrix box, int* natoms, rvec*
     gmx::FileIOXdrSerializer serializer(fio);
     do_tpxheader(&serializer, &tpx, fn, fio, ir == nullptr);
     PartialDeserializedTprFile partialDeserializedTpr =
-            readTpxBody(&tpx, &serializer, ir, &state, x, v, mtop);
+            readTpxBody(&tpx, &serializer, fio, ir, &state, x, v, mtop);
     close_tpx(fio);
     if (mtop != nullptr && natoms != nullptr)
     {
@@ -60,6 +60,7 @@
 #include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/xdrf.h"
 #include "gromacs/fileio/xtcio.h"
+#include "gromacs/fileio/xtcprefetch.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/topology/atoms.h"
@@ -69,6 +70,7 @@
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 #if GMX_USE_PLUGINS
@@ -97,6 +99,8 @@ struct t_trxstatus
 #if GMX_USE_PLUGINS
     gmx_vmdplugin_t* vmdplugin;
 #endif
+
+    gmx::XtcFramePrefetcher* xtcPrefetcher; /* Decodes XTC frames ahead with TRX_PREFETCH */
 };
 
 /* utility functions */
@@ -167,6 +171,7 @@ static void status_init(t_trxstatus* status)
     status->tf              = 0;
     status->persistent_line = nullptr;
     status->tng             = nullptr;
+    status->xtcPrefetcher   = nullptr;
 }
 
 
@@ -599,6 +604,7 @@ void close_trx(t_trxstatus* status)
         return;
     }
     gmx_tng_close(&status->tng);
+    delete status->xtcPrefetcher;
     if (status->fio)
     {
         gmx_fio_close(status->fio);
@@ -816,9 +822,24 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                     }
                     initcount(status);
                 }
-                bRet = (read_next_xtc(status->fio, fr->natoms, &fr->step, &fr->time, fr->box, fr->x,
-                                      &fr->prec, &bOK)
-                        != 0);
+                if ((status->flags & TRX_PREFETCH) && status->xtcPrefetcher == nullptr
+                    && gmx_omp_get_max_threads() > 1)
+                {
+                    status->xtcPrefetcher = new gmx::XtcFramePrefetcher(
+                            status->fio, fr->natoms, gmx_omp_get_max_threads());
+                }
+                if (status->xtcPrefetcher)
+                {
+                    bRet = (status->xtcPrefetcher->readNextFrame(&fr->step, &fr->time, fr->box,
+                                                                  fr->x, &fr->prec, &bOK)
+                            != 0);
+                }
+                else
+                {
+                    bRet = (read_next_xtc(status->fio, fr->natoms, &fr->step, &fr->time, fr->box,
+                                          fr->x, &fr->prec, &bOK)
+                            != 0);
+                }
                 fr->bPrec = (bRet && fr->prec > 0);
                 fr->bStep = bRet;
                 fr->bTime = bRet;
@@ -1078,6 +1099,8 @@ void rewind_trj(t_trxstatus* status)
 {
     initcount(status);
 
+    delete status->xtcPrefetcher;
+    status->xtcPrefetcher = nullptr;
     gmx_fio_rewind(status->fio);
 }
 
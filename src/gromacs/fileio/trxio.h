@@ -208,6 +208,10 @@ int check_times(real t);
 #define TRX_NEED_F (1u << 5u)
 /* Useful for reading natoms from a trajectory without skipping */
 #define TRX_DONT_SKIP (1u << 6u)
+/* Allow reading and decoding XTC frames ahead on multiple OpenMP threads.
+ * Only use when the trajectory is only accessed through read_next_frame,
+ * since the file position is then ahead of the last frame returned. */
+#define TRX_PREFETCH (1u << 7u)
 
 /* For trxframe.not_ok */
 #define HEADER_NOT_OK (1u << 0u)
@@ -97,6 +97,11 @@ const char* get_warning_file(warninp_t wi)
     return wi->filenm.c_str();
 }
 
+int warning_count(warninp_t wi)
+{
+    return wi->nwarn_note + wi->nwarn_warn + wi->nwarn_error;
+}
+
 static void low_warning(warninp_t wi, const char* wtype, int n, const char* s)
 {
 #define indent 2
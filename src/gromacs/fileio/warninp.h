@@ -67,6 +67,9 @@ int get_warning_line(warninp_t wi);
 const char* get_warning_file(warninp_t wi);
 /* Get filename for the warning */
 
+int warning_count(warninp_t wi);
+/* Return the total number of notes, warnings and errors issued so far */
+
 void warning(warninp_t wi, const char* s);
 /* Issue a warning, with the string s. If s == NULL, then warn_buf
  * will be printed instead. The file and line set by set_warning_line
@@ -58,6 +58,14 @@
 /* Read or write reduced precision *float* coordinates */
 int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision);
 
+/* Select the reference implementation of the coordinate compression in
+ * xdr3dfcoord. By default faster routines are used (a single pass for the
+ * conversion to integers and 64-bit bit and integer packing), which give
+ * bit-identical results.
+ * The reference implementation is also used when the environment variable
+ * GMX_XTC_REFERENCE_CODEC is set. */
+void xdr3dfcoord_use_reference_implementation(bool useReference);
+
 
 /* Read or write a *real* value (stored as float) */
 int xdr_real(XDR* xdrs, real* r);
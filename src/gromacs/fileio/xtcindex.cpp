@@ -0,0 +1,217 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the frame offset index for random access in XTC files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "xtcindex.h"
+
+#include <algorithm>
+
+#include "gromacs/fileio/xdrf.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Magic number identifying an XTC index sidecar file ("XTCI")
+constexpr int c_xtcIndexMagic = 0x58544349;
+//! Version of the sidecar file format
+constexpr int c_xtcIndexVersion = 1;
+
+//! Reads or writes the sidecar header, returns true on success
+bool doHeader(XDR* xdr, int* magic, int* version, int* natoms)
+{
+    return xdr_int(xdr, magic) != 0 && xdr_int(xdr, version) != 0 && xdr_int(xdr, natoms) != 0;
+}
+
+//! Reads or writes a single frame entry, returns true on success
+bool doEntry(XDR* xdr, XtcFrameIndexEntry* entry)
+{
+    int64_t offset = entry->offset;
+    int64_t end    = entry->end;
+    bool    ok     = (xdr_int64(xdr, &offset) != 0 && xdr_int64(xdr, &end) != 0
+               && xdr_int64(xdr, &entry->step) != 0 && xdr_float(xdr, &entry->time) != 0);
+    entry->offset = offset;
+    entry->end    = end;
+    return ok;
+}
+
+/*! \brief Writes \p frames to \p fp, preceded by the header when \p writeHeader is set
+ *
+ * \returns true on success
+ */
+bool writeFrames(FILE* fp, bool writeHeader, int natoms, ArrayRef<const XtcFrameIndexEntry> frames)
+{
+    XDR xdr;
+    xdrstdio_create(&xdr, fp, XDR_ENCODE);
+    int  magic   = c_xtcIndexMagic;
+    int  version = c_xtcIndexVersion;
+    bool ok      = !writeHeader || doHeader(&xdr, &magic, &version, &natoms);
+    for (auto frame = frames.begin(); ok && frame != frames.end(); ++frame)
+    {
+        XtcFrameIndexEntry entry = *frame;
+        ok                       = doEntry(&xdr, &entry);
+    }
+    xdr_destroy(&xdr);
+    return ok && std::fflush(fp) == 0;
+}
+
+} // namespace
+
+XtcFrameIndex::XtcFrameIndex(int natoms) : natoms_(natoms) {}
+
+XtcFrameIndex::~XtcFrameIndex()
+{
+    if (sidecar_ != nullptr)
+    {
+        std::fclose(sidecar_);
+    }
+}
+
+std::string XtcFrameIndex::sidecarFileName(const std::string& xtcFileName)
+{
+    return xtcFileName + "idx";
+}
+
+std::unique_ptr<XtcFrameIndex> XtcFrameIndex::readFromFile(const std::string& fileName, int natoms)
+{
+    /* The index is optional, so we use plain fopen to avoid fatal errors */
+    FILE* fp = std::fopen(fileName.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return nullptr;
+    }
+    XDR xdr;
+    xdrstdio_create(&xdr, fp, XDR_DECODE);
+    int  magic, version, fileNatoms;
+    auto index = std::make_unique<XtcFrameIndex>(natoms);
+    bool ok    = (doHeader(&xdr, &magic, &version, &fileNatoms) && magic == c_xtcIndexMagic
+               && version == c_xtcIndexVersion && fileNatoms == natoms);
+    XtcFrameIndexEntry entry;
+    while (ok && doEntry(&xdr, &entry))
+    {
+        ok = index->addFrame(entry.offset, entry.end, entry.step, entry.time);
+    }
+    xdr_destroy(&xdr);
+    std::fclose(fp);
+
+    return ok ? std::move(index) : nullptr;
+}
+
+bool XtcFrameIndex::writeToFile(const std::string& fileName) const
+{
+    FILE* fp = std::fopen(fileName.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+    bool ok = writeFrames(fp, true, natoms_, frames_);
+    return (std::fclose(fp) == 0) && ok;
+}
+
+bool XtcFrameIndex::startWritingSidecar(const std::string& fileName)
+{
+    if (sidecar_ != nullptr)
+    {
+        std::fclose(sidecar_);
+    }
+    sidecar_ = std::fopen(fileName.c_str(), "wb");
+    if (sidecar_ != nullptr && !writeFrames(sidecar_, true, natoms_, frames_))
+    {
+        std::fclose(sidecar_);
+        sidecar_ = nullptr;
+    }
+    return sidecar_ != nullptr;
+}
+
+bool XtcFrameIndex::addFrame(gmx_off_t offset, gmx_off_t end, int64_t step, float time)
+{
+    if (offset != coveredBytes() || end <= offset)
+    {
+        return false;
+    }
+    if (!frames_.empty() && time < frames_.back().time)
+    {
+        timesAreSorted_ = false;
+    }
+    frames_.push_back({ offset, end, step, time });
+
+    if (sidecar_ != nullptr
+        && !writeFrames(sidecar_, false, natoms_, arrayRefFromArray(&frames_.back(), 1)))
+    {
+        /* Writing failed, stop updating the sidecar */
+        std::fclose(sidecar_);
+        sidecar_ = nullptr;
+    }
+    return true;
+}
+
+void XtcFrameIndex::truncate(gmx_off_t fileSize)
+{
+    auto firstBeyond = std::find_if(frames_.begin(), frames_.end(), [fileSize](const auto& frame) {
+        return frame.end > fileSize;
+    });
+    frames_.erase(firstBeyond, frames_.end());
+}
+
+int XtcFrameIndex::findFrameAtTime(float time, gmx_off_t minOffset) const
+{
+    if (!timesAreSorted_)
+    {
+        return -1;
+    }
+    auto frame = std::lower_bound(
+            frames_.begin(), frames_.end(), time,
+            [](const XtcFrameIndexEntry& entry, float t) { return entry.time < t; });
+    /* Frames are contiguous in the file, so offsets increase with the frame index */
+    while (frame != frames_.end() && frame->offset < minOffset)
+    {
+        ++frame;
+    }
+    if (frame == frames_.end())
+    {
+        return -1;
+    }
+    return static_cast<int>(frame - frames_.begin());
+}
+
+} // namespace gmx
@@ -0,0 +1,155 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a frame offset index for random access in XTC files.
+ *
+ * The index stores the file offset, step and time of every frame, so
+ * that seeking to a time only needs a single fseek instead of a
+ * bisection that re-parses frame headers. The index can be stored in a
+ * sidecar file next to the trajectory (\c traj.xtc -> \c traj.xtcidx),
+ * which mdrun writes as it goes when the environment variable
+ * GMX_XTC_INDEX is set.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_XTCINDEX_H
+#define GMX_FILEIO_XTCINDEX_H
+
+#include <cstdint>
+#include <cstdio>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/futil.h"
+
+namespace gmx
+{
+
+//! Location and identity of a single frame in an XTC file
+struct XtcFrameIndexEntry
+{
+    //! Offset of the frame header in the file
+    gmx_off_t offset;
+    //! Offset just past the end of the frame
+    gmx_off_t end;
+    //! MD step of the frame
+    int64_t step;
+    //! Time of the frame
+    float time;
+};
+
+/*! \libinternal \brief Frame offset index for an XTC file.
+ *
+ * Frames are only accepted when they are contiguous with the frames
+ * already present, so the index always describes a prefix of the
+ * trajectory file.
+ */
+class XtcFrameIndex
+{
+public:
+    //! Constructs an empty index for frames with \p natoms atoms
+    explicit XtcFrameIndex(int natoms);
+    ~XtcFrameIndex();
+
+    //! Returns the name of the index sidecar file for \p xtcFileName
+    static std::string sidecarFileName(const std::string& xtcFileName);
+
+    /*! \brief Reads an index from sidecar file \p fileName
+     *
+     * Returns nullptr when the file does not exist, is corrupt, or does
+     * not describe frames with \p natoms atoms.
+     */
+    static std::unique_ptr<XtcFrameIndex> readFromFile(const std::string& fileName, int natoms);
+
+    /*! \brief Writes all frames to sidecar file \p fileName
+     *
+     * \returns true on success. Failure is not fatal because the
+     * index is only an optimization.
+     */
+    bool writeToFile(const std::string& fileName) const;
+
+    /*! \brief Starts mirroring every frame added to sidecar file \p fileName
+     *
+     * The file is rewritten with the current frames and each frame
+     * added later is appended and flushed immediately, so the sidecar
+     * stays consistent with a trajectory that is being written.
+     *
+     * \returns true on success.
+     */
+    bool startWritingSidecar(const std::string& fileName);
+
+    /*! \brief Adds a frame spanning [\p offset, \p end) in the file
+     *
+     * \returns false, without changing the index, when the frame does
+     * not directly follow the last frame in the index.
+     */
+    bool addFrame(gmx_off_t offset, gmx_off_t end, int64_t step, float time);
+
+    //! Removes all frames that do not fit entirely in the first \p fileSize bytes
+    void truncate(gmx_off_t fileSize);
+
+    /*! \brief Returns the index of the first frame with time at least \p time
+     * and offset at least \p minOffset, or -1 when there is none.
+     *
+     * Requires the frame times to be non-decreasing, returns -1 otherwise.
+     */
+    int findFrameAtTime(float time, gmx_off_t minOffset) const;
+
+    //! Returns the number of atoms per frame
+    int natoms() const { return natoms_; }
+    //! Returns the offset of the end of the last indexed frame
+    gmx_off_t coveredBytes() const { return frames_.empty() ? 0 : frames_.back().end; }
+    //! Returns the indexed frames
+    ArrayRef<const XtcFrameIndexEntry> frames() const { return frames_; }
+
+private:
+    //! Number of atoms per frame
+    int natoms_;
+    //! The frames, in file order
+    std::vector<XtcFrameIndexEntry> frames_;
+    //! Whether frame times are non-decreasing, so bisection is possible
+    bool timesAreSorted_ = true;
+    //! Sidecar file that frames are appended to, when in use
+    FILE* sidecar_ = nullptr;
+};
+
+} // namespace gmx
+
+#endif
@@ -213,7 +213,8 @@ int write_xtc(t_fileio* fio, int natoms, int64_t step, real time, const rvec* bo
         return 1;
     }
 
-    xd = gmx_fio_getxdr(fio);
+    xd                    = gmx_fio_getxdr(fio);
+    const gmx_off_t start = gmx_fio_ftell(fio);
     /* write magic number and xtc identidier */
     if (xtc_header(xd, &magic_number, &natoms, &step, &time, FALSE, &bDum) == 0)
     {
@@ -231,6 +232,10 @@ int write_xtc(t_fileio* fio, int natoms, int64_t step, real time, const rvec* bo
             bOK = 0;
         }
     }
+    if (bOK)
+    {
+        gmx_fio_xtc_index_frame(fio, start, gmx_fio_ftell(fio), natoms, step, time);
+    }
     return bOK; /* 0 if bad, 1 if writing went well */
 }
 
@@ -239,8 +244,9 @@ int read_first_xtc(t_fileio* fio, int* natoms, int64_t* step, real* time, matrix
     int  magic;
     XDR* xd;
 
-    *bOK = TRUE;
-    xd   = gmx_fio_getxdr(fio);
+    *bOK                  = TRUE;
+    xd                    = gmx_fio_getxdr(fio);
+    const gmx_off_t start = gmx_fio_ftell(fio);
 
     /* read header and malloc x */
     if (!xtc_header(xd, &magic, natoms, step, time, TRUE, bOK))
@@ -254,21 +260,31 @@ int read_first_xtc(t_fileio* fio, int* natoms, int64_t* step, real* time, matrix
     snew(*x, *natoms);
 
     *bOK = (xtc_coord(xd, natoms, box, *x, prec, TRUE) != 0);
+    if (*bOK)
+    {
+        gmx_fio_xtc_index_frame(fio, start, gmx_fio_ftell(fio), *natoms, *step, *time);
+    }
 
     return static_cast<int>(*bOK);
 }
 
-int read_next_xtc(t_fileio* fio, int natoms, int64_t* step, real* time, matrix box, rvec* x, real* prec, gmx_bool* bOK)
+/* Read the frame at the current position of xd, returns 1 on success */
+static int read_xtc_frame(XDR*      xd,
+                          int       natoms,
+                          int*      n,
+                          int64_t*  step,
+                          real*     time,
+                          matrix    box,
+                          rvec*     x,
+                          real*     prec,
+                          gmx_bool* bOK)
 {
-    int  magic;
-    int  n;
-    XDR* xd;
+    int magic;
 
     *bOK = TRUE;
-    xd   = gmx_fio_getxdr(fio);
 
     /* read header */
-    if (!xtc_header(xd, &magic, &n, step, time, TRUE, bOK))
+    if (!xtc_header(xd, &magic, n, step, time, TRUE, bOK))
     {
         return 0;
     }
@@ -276,12 +292,162 @@ int read_next_xtc(t_fileio* fio, int natoms, int64_t* step, real* time, matrix b
     /* Check magic number */
     check_xtc_magic(magic);
 
+    if (*n > natoms)
+    {
+        gmx_fatal(FARGS, "Frame contains more atoms (%d) than expected (%d)", *n, natoms);
+    }
+
+    *bOK = (xtc_coord(xd, &natoms, box, x, prec, TRUE) != 0);
+
+    return static_cast<int>(*bOK);
+}
+
+int read_next_xtc(t_fileio* fio, int natoms, int64_t* step, real* time, matrix box, rvec* x, real* prec, gmx_bool* bOK)
+{
+    int             n;
+    XDR*            xd    = gmx_fio_getxdr(fio);
+    const gmx_off_t start = gmx_fio_ftell(fio);
+
+    const int result = read_xtc_frame(xd, natoms, &n, step, time, box, x, prec, bOK);
+    if (result)
+    {
+        gmx_fio_xtc_index_frame(fio, start, gmx_fio_ftell(fio), n, *step, *time);
+    }
+
+    return result;
+}
+
+int read_next_xtc_frame_data(t_fileio* fio, int natoms, std::vector<char>* frameData, gmx_bool* bOK)
+{
+    int             magic, n, size;
+    int64_t         step;
+    real            time;
+    float           fdum;
+    int             idum;
+    XDR*            xd    = gmx_fio_getxdr(fio);
+    FILE*           fp    = gmx_fio_getfp(fio);
+    const gmx_off_t start = gmx_fio_ftell(fio);
+
+    *bOK = TRUE;
+
+    /* Parse the header to find the size of the frame in the file */
+    if (!xtc_header(xd, &magic, &n, &step, &time, TRUE, bOK))
+    {
+        return 0;
+    }
+    check_xtc_magic(magic);
     if (n > natoms)
     {
         gmx_fatal(FARGS, "Frame contains more atoms (%d) than expected (%d)", n, natoms);
     }
+    /* box */
+    for (int i = 0; i < DIM * DIM && *bOK; i++)
+    {
+        *bOK = (xdr_float(xd, &fdum) != 0);
+    }
+    *bOK = *bOK && (xdr_int(xd, &size) != 0);
+    if (*bOK && size > 9)
+    {
+        /* precision, minint[3], maxint[3] and smallidx, then the byte count */
+        *bOK = (xdr_float(xd, &fdum) != 0);
+        for (int i = 0; i < 2 * DIM + 1 && *bOK; i++)
+        {
+            *bOK = (xdr_int(xd, &idum) != 0);
+        }
+        *bOK = *bOK && (xdr_int(xd, &idum) != 0);
+    }
+    if (!*bOK)
+    {
+        return 0;
+    }
+    gmx_off_t length = gmx_fio_ftell(fio) - start;
+    if (size > 9)
+    {
+        /* The compressed coordinates are padded to a multiple of 4 bytes */
+        length += ((idum + 3) / 4) * 4;
+    }
+    else
+    {
+        length += size * DIM * sizeof(float);
+    }
 
-    *bOK = (xtc_coord(xd, &natoms, box, x, prec, TRUE) != 0);
+    /* Read the whole frame into memory */
+    frameData->resize(length);
+    *bOK = (gmx_fseek(fp, start, SEEK_SET) == 0
+            && fread(frameData->data(), 1, length, fp) == static_cast<size_t>(length));
+    if (*bOK)
+    {
+        gmx_fio_xtc_index_frame(fio, start, start + length, n, step, time);
+    }
 
     return static_cast<int>(*bOK);
 }
+
+int decode_xtc_frame_data(std::vector<char>* frameData,
+                          int                natoms,
+                          int64_t*           step,
+                          real*              time,
+                          matrix             box,
+                          rvec*              x,
+                          real*              prec,
+                          gmx_bool*          bOK)
+{
+    XDR xd;
+    int n;
+
+    xdrmem_create(&xd, frameData->data(), frameData->size(), XDR_DECODE);
+    int result = read_xtc_frame(&xd, natoms, &n, step, time, box, x, prec, bOK);
+    xdr_destroy(&xd);
+
+    return result;
+}
+
+int read_xtc_frame_data_header(std::vector<char>* frameData, int* natoms, int64_t* step, real* time)
+{
+    XDR      xd;
+    int      magic;
+    gmx_bool bOK;
+
+    xdrmem_create(&xd, frameData->data(), frameData->size(), XDR_DECODE);
+    int result = xtc_header(&xd, &magic, natoms, step, time, TRUE, &bOK);
+    xdr_destroy(&xd);
+    if (result)
+    {
+        check_xtc_magic(magic);
+    }
+
+    return result;
+}
+
+int write_xtc_frame_data(t_fileio* fio, std::vector<char>* frameData, int64_t step, real time)
+{
+    int     magic_number = XTC_MAGIC;
+    int     natoms;
+    int64_t oldStep;
+    real    oldTime;
+
+    if (read_xtc_frame_data_header(frameData, &natoms, &oldStep, &oldTime) == 0)
+    {
+        return 0;
+    }
+
+    /* Replace the step and time in the header, the rest of the frame is unchanged */
+    XDR      xd;
+    gmx_bool bDum;
+    xdrmem_create(&xd, frameData->data(), frameData->size(), XDR_ENCODE);
+    int bOK = xtc_header(&xd, &magic_number, &natoms, &step, &time, FALSE, &bDum);
+    xdr_destroy(&xd);
+
+    FILE*           fp    = gmx_fio_getfp(fio);
+    const gmx_off_t start = gmx_fio_ftell(fio);
+    if (bOK)
+    {
+        bOK = (fwrite(frameData->data(), 1, frameData->size(), fp) == frameData->size()
+               && gmx_fio_flush(fio) == 0);
+    }
+    if (bOK)
+    {
+        gmx_fio_xtc_index_frame(fio, start, gmx_fio_ftell(fio), natoms, step, time);
+    }
+    return bOK; /* 0 if bad, 1 if writing went well */
+}
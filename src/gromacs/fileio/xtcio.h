@@ -39,6 +39,8 @@
 #ifndef GMX_FILEIO_XTCIO_H
 #define GMX_FILEIO_XTCIO_H
 
+#include <vector>
+
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/real.h"
@@ -75,7 +77,40 @@ int read_first_xtc(struct t_fileio* fio,
 int read_next_xtc(struct t_fileio* fio, int natoms, int64_t* step, real* time, matrix box, rvec* x, real* prec, gmx_bool* bOK);
 /* Read subsequent frames */
 
+int read_next_xtc_frame_data(struct t_fileio*   fio,
+                             int                natoms,
+                             std::vector<char>* frameData,
+                             gmx_bool*          bOK);
+/* Read the raw data of the next frame into frameData without decoding
+ * the coordinates, so frames can be decoded independently later. */
+
+int decode_xtc_frame_data(std::vector<char>* frameData,
+                          int                natoms,
+                          int64_t*           step,
+                          real*              time,
+                          matrix             box,
+                          rvec*              x,
+                          real*              prec,
+                          gmx_bool*          bOK);
+/* Decode a frame read with read_next_xtc_frame_data, like read_next_xtc.
+ * Does not access any file, so can be called concurrently for
+ * different frames. */
+
 int write_xtc(struct t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec);
 /* Write a frame to xtc file */
 
+int read_xtc_frame_data_header(std::vector<char>* frameData,
+                               int*               natoms,
+                               int64_t*           step,
+                               real*              time);
+/* Decode only the header of a frame read with read_next_xtc_frame_data */
+
+int write_xtc_frame_data(struct t_fileio*   fio,
+                         std::vector<char>* frameData,
+                         int64_t            step,
+                         real               time);
+/* Write a frame read with read_next_xtc_frame_data verbatim to xtc file,
+ * with the step and time in its header replaced. This avoids decoding
+ * and compressing the coordinates again. */
+
 #endif
@@ -0,0 +1,155 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the reader that decodes XTC frames ahead on multiple threads.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "xtcprefetch.h"
+
+#include <algorithm>
+
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+XtcFramePrefetcher::XtcFramePrefetcher(t_fileio* fio, int natoms, int numThreads) :
+    fio_(fio), natoms_(natoms), numThreads_(std::max(numThreads, 1))
+{
+    GMX_RELEASE_ASSERT(fio_ != nullptr, "Need a file to read from");
+}
+
+void XtcFramePrefetcher::readBatch(std::vector<Frame>* batch)
+{
+    batch->resize(numThreads_);
+    size_t numFrames = 0;
+    while (!readingDone_ && numFrames < batch->size())
+    {
+        Frame& frame = (*batch)[numFrames++];
+        frame.result = read_next_xtc_frame_data(fio_, natoms_, &frame.data, &frame.bOK);
+        /* Stop at the end of the file or at the first incomplete frame */
+        readingDone_ = (frame.result == 0);
+    }
+    batch->resize(numFrames);
+}
+
+void XtcFramePrefetcher::decodeBatch()
+{
+    if (pending_.empty())
+    {
+        readBatch(&pending_);
+    }
+    std::vector<Frame> next;
+    const int          numFrames = static_cast<int>(pending_.size());
+
+#pragma omp parallel num_threads(numThreads_)
+    {
+        try
+        {
+            /* The master reads the next batch while the other threads
+             * decode, after that it takes part in decoding. */
+#pragma omp master
+            {
+                readBatch(&next);
+            }
+#pragma omp for schedule(dynamic) nowait
+            for (int i = 0; i < numFrames; i++)
+            {
+                Frame& frame = pending_[i];
+                if (frame.result != 0)
+                {
+                    frame.x.resize(natoms_);
+                    frame.result = decode_xtc_frame_data(&frame.data, natoms_, &frame.step,
+                                                         &frame.time, frame.box,
+                                                         as_rvec_array(frame.x.data()),
+                                                         &frame.prec, &frame.bOK);
+                }
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    std::swap(decoded_, pending_);
+    std::swap(pending_, next);
+    next_ = 0;
+}
+
+int XtcFramePrefetcher::readNextFrame(int64_t*  step,
+                                      real*     time,
+                                      matrix    box,
+                                      rvec*     x,
+                                      real*     prec,
+                                      gmx_bool* bOK)
+{
+    if (next_ == decoded_.size())
+    {
+        if (readingDone_ && pending_.empty())
+        {
+            *bOK = TRUE;
+            return 0;
+        }
+        decodeBatch();
+        if (decoded_.empty())
+        {
+            *bOK = TRUE;
+            return 0;
+        }
+    }
+
+    const Frame& frame = decoded_[next_++];
+    *bOK               = frame.bOK;
+    if (frame.result != 0)
+    {
+        *step = frame.step;
+        *time = frame.time;
+        copy_mat(frame.box, box);
+        for (int i = 0; i < natoms_; i++)
+        {
+            copy_rvec(frame.x[i], x[i]);
+        }
+        *prec = frame.prec;
+    }
+
+    return frame.result;
+}
+
+} // namespace gmx
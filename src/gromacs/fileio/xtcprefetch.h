@@ -0,0 +1,131 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a reader that decodes XTC frames ahead on multiple threads.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_XTCPREFETCH_H
+#define GMX_FILEIO_XTCPREFETCH_H
+
+#include <cstdint>
+
+#include <vector>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/classhelpers.h"
+#include "gromacs/utility/real.h"
+
+struct t_fileio;
+
+namespace gmx
+{
+
+/*! \libinternal \brief Reads XTC frames ahead and decodes them concurrently.
+ *
+ * Raw frame data is read sequentially from the file in batches of one
+ * frame per thread. While the frames of a batch are decoded by the
+ * OpenMP threads, the master thread reads the raw data of the next
+ * batch, so file reading and decompression overlap. Frames are returned
+ * in file order.
+ *
+ * The position of the file is ahead of the last returned frame, so the
+ * file should not be accessed otherwise while this object exists.
+ */
+class XtcFramePrefetcher
+{
+public:
+    /*! \brief Constructs a prefetcher for frames with at most \p natoms atoms
+     *
+     * \param[in] fio         The XTC file, positioned at the start of a frame
+     * \param[in] natoms      The number of atoms in the trajectory
+     * \param[in] numThreads  The number of OpenMP threads to decode with
+     */
+    XtcFramePrefetcher(t_fileio* fio, int natoms, int numThreads);
+
+    //! Reads the next frame, with the same semantics as read_next_xtc()
+    int readNextFrame(int64_t* step, real* time, matrix box, rvec* x, real* prec, gmx_bool* bOK);
+
+private:
+    //! A frame in a batch, raw and decoded
+    struct Frame
+    {
+        //! The raw frame data from the file
+        std::vector<char> data;
+        //! The return value of the read or decode call
+        int result = 0;
+        //! Whether the frame is complete
+        gmx_bool bOK = FALSE;
+        //! The MD step
+        int64_t step = 0;
+        //! The time
+        real time = 0;
+        //! The box
+        matrix box = { { 0 } };
+        //! The coordinates
+        std::vector<RVec> x;
+        //! The precision
+        real prec = 0;
+    };
+
+    //! Reads the raw data for up to one frame per thread into \p batch
+    void readBatch(std::vector<Frame>* batch);
+    //! Decodes the pending batch, while reading the next one
+    void decodeBatch();
+
+    //! The file to read from
+    t_fileio* fio_;
+    //! The number of atoms in the trajectory
+    int natoms_;
+    //! The number of threads to use
+    int numThreads_;
+    //! Whether reading stopped, at the end of the file or at an error
+    bool readingDone_ = false;
+    //! Decoded frames which are returned in order
+    std::vector<Frame> decoded_;
+    //! The index in \c decoded_ of the next frame to return
+    size_t next_ = 0;
+    //! Raw frames which have been read but not decoded
+    std::vector<Frame> pending_;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(XtcFramePrefetcher);
+};
+
+} // namespace gmx
+
+#endif
@@ -41,9 +41,11 @@
 
 #include <cassert>
 #include <cctype>
+#include <cstdlib>
 #include <cstring>
 
 #include <string>
+#include <vector>
 
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/oenv.h"
@@ -522,6 +524,39 @@ static int wordcount(char* ptr)
     return n;
 }
 
+/*! \brief Reads up to \p numColumns whitespace-separated numbers from \p line into \p values
+ *
+ * Reading stops at the first field that does not start with a number.
+ * The rest of a field after its number is ignored, as with the
+ * "%*s" skipping this replaces. This parses each line in a single pass,
+ * whereas rescanning the line per column scales quadratically with
+ * the number of columns.
+ *
+ * \returns the number of values read
+ */
+static int readXvgDataLine(const char* line, int numColumns, double* values)
+{
+    const char* ptr = line;
+    int         column;
+    for (column = 0; column < numColumns; column++)
+    {
+        char*        end;
+        const double value = std::strtod(ptr, &end);
+        if (end == ptr)
+        {
+            break;
+        }
+        values[column] = value;
+        // Skip any remainder of this field
+        ptr = end;
+        while (*ptr != '\0' && !std::isspace(static_cast<unsigned char>(*ptr)))
+        {
+            ptr++;
+        }
+    }
+    return column;
+}
+
 static char* read_xvgr_string(const char* line)
 {
     const char *ptr0, *ptr1;
@@ -554,10 +589,7 @@ int read_xvg_legend(const char* fn, double*** y, int* ny, char** subtitle, char*
 {
     FILE*    fp;
     char*    ptr;
-    char*    base = nullptr;
-    char*    fmt  = nullptr;
-    int      k, line = 0, nny, nx, maxx, rval, legend_nalloc, set, nchar;
-    double   lf;
+    int      k, line = 0, nny, nx, maxx, legend_nalloc, set, nchar;
     double** yy = nullptr;
     char*    tmpbuf;
     int      len = STRLEN;
@@ -566,6 +598,7 @@ int read_xvg_legend(const char* fn, double*** y, int* ny, char** subtitle, char*
     nx           = 0;
     maxx         = 0;
     fp           = gmx_fio_fopen(fn, "r");
+    std::vector<double> values;
 
     snew(tmpbuf, len);
     if (subtitle != nullptr)
@@ -640,8 +673,7 @@ int read_xvg_legend(const char* fn, double*** y, int* ny, char** subtitle, char*
                     return 0;
                 }
                 snew(yy, nny);
-                snew(fmt, 3 * nny + 1);
-                snew(base, 3 * nny + 1);
+                values.resize(nny);
             }
             /* Allocate column space */
             if (nx >= maxx)
@@ -652,25 +684,10 @@ int read_xvg_legend(const char* fn, double*** y, int* ny, char** subtitle, char*
                     srenew(yy[k], maxx);
                 }
             }
-            /* Initiate format string */
-            fmt[0]  = '\0';
-            base[0] = '\0';
-
-            /* fprintf(stderr,"ptr='%s'\n",ptr);*/
-            for (k = 0; (k < nny); k++)
+            const int numValues = readXvgDataLine(ptr, nny, values.data());
+            for (k = 0; (k < numValues); k++)
             {
-                std::strcpy(fmt, base);
-                std::strcat(fmt, "%lf");
-                rval = sscanf(ptr, fmt, &lf);
-                /* fprintf(stderr,"rval = %d\n",rval);*/
-                if ((rval == EOF) || (rval == 0))
-                {
-                    break;
-                }
-                yy[k][nx] = lf;
-                srenew(fmt, 3 * (nny + 1) + 1);
-                srenew(base, 3 * nny + 1);
-                std::strcat(base, "%*s");
+                yy[k][nx] = values[k];
             }
             if (k != nny)
             {
@@ -687,8 +704,6 @@ int read_xvg_legend(const char* fn, double*** y, int* ny, char** subtitle, char*
 
     *y = yy;
     sfree(tmpbuf);
-    sfree(base);
-    sfree(fmt);
 
     if (legend_nalloc > 0)
     {
@@ -735,8 +750,6 @@ gmx::MultiDimArray<std::vector<double>, gmx::dynamicExtents2D> readXvgData(const
 {
     FILE* fp = gmx_fio_fopen(fn.c_str(), "r");
     char* ptr;
-    char* base = nullptr;
-    char* fmt  = nullptr;
     char* tmpbuf;
     int   len = STRLEN;
 
@@ -761,54 +774,29 @@ gmx::MultiDimArray<std::vector<double>, gmx::dynamicExtents2D> readXvgData(const
             {
                 return {}; // There are no columns and hence no data to process
             }
-            snew(fmt, 3 * numColumns + 1);
-            snew(base, 3 * numColumns + 1);
-        }
-        /* Initiate format string */
-        fmt[0]          = '\0';
-        base[0]         = '\0';
-        int columnCount = 0;
-        for (columnCount = 0; (columnCount < numColumns); columnCount++)
-        {
-            double lf;
-            std::strcpy(fmt, base);
-            std::strcat(fmt, "%lf");
-            int rval = sscanf(ptr, fmt, &lf);
-            if ((rval == EOF) || (rval == 0))
-            {
-                break;
-            }
-            xvgData.push_back(lf);
-            srenew(fmt, 3 * (numColumns + 1) + 1);
-            srenew(base, 3 * numColumns + 1);
-            std::strcat(base, "%*s");
         }
+        // Missing columns are set to zero
+        xvgData.resize(xvgData.size() + numColumns, 0.0);
+        const int columnCount =
+                readXvgDataLine(ptr, numColumns, xvgData.data() + xvgData.size() - numColumns);
 
         if (columnCount != numColumns)
         {
             fprintf(stderr, "Only %d columns on line %d in file %s\n", columnCount, line, fn.c_str());
-            for (; (columnCount < numColumns); columnCount++)
-            {
-                xvgData.push_back(0.0);
-            }
         }
     }
     gmx_fio_fclose(fp);
 
     sfree(tmpbuf);
-    sfree(base);
-    sfree(fmt);
-
-    gmx::MultiDimArray<std::vector<double>, gmx::dynamicExtents2D> xvgDataAsArray(numRows, numColumns);
-    std::copy(std::begin(xvgData), std::end(xvgData), begin(xvgDataAsArray.asView()));
 
+    // Transpose from the row-major order of the file
     gmx::MultiDimArray<std::vector<double>, gmx::dynamicExtents2D> xvgDataAsArrayTransposed(
             numColumns, numRows);
     for (std::ptrdiff_t row = 0; row < numRows; ++row)
     {
         for (std::ptrdiff_t column = 0; column < numColumns; ++column)
         {
-            xvgDataAsArrayTransposed(column, row) = xvgDataAsArray(row, column);
+            xvgDataAsArrayTransposed(column, row) = xvgData[row * numColumns + column];
         }
     }
 
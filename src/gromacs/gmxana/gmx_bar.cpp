@@ -57,6 +57,7 @@
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/dir_separator.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/smalloc.h"
@@ -3571,13 +3572,42 @@ int gmx_bar(int argc, char* argv[])
     /* first calculate results */
     bEE      = TRUE;
     disc_err = FALSE;
-    for (f = 0; f < nresults; f++)
     {
-        /* Determine the free energy difference with a factor of 10
-         * more accuracy than requested for printing.
+        /* The lambda pairs are independent, so we process them in parallel.
+         * Each pair sums its block estimates into its own partial sums,
+         * which are added afterwards in the order of the pairs, so the
+         * results do not depend on the number of threads.
          */
-        calc_bar(&(results[f]), 0.1 * prec, nbmin, nbmax, &bEE, partsum);
-
+        const int           partsumSize = (nbmax + 1) * (nbmax + 1);
+        std::vector<double> resultPartsum(static_cast<size_t>(nresults) * partsumSize, 0.0);
+        // Not std::vector<bool>, since multiple threads write to it
+        std::vector<int> resultEE(nresults, 1);
+#pragma omp parallel for schedule(dynamic)
+        for (int r = 0; r < nresults; r++)
+        {
+            try
+            {
+                /* Determine the free energy difference with a factor of 10
+                 * more accuracy than requested for printing.
+                 */
+                gmx_bool haveErrorEstimate = TRUE;
+                calc_bar(&(results[r]), 0.1 * prec, nbmin, nbmax, &haveErrorEstimate,
+                         resultPartsum.data() + static_cast<size_t>(r) * partsumSize);
+                resultEE[r] = static_cast<int>(haveErrorEstimate);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+        for (int r = 0; r < nresults; r++)
+        {
+            bEE = bEE && (resultEE[r] != 0);
+            for (int i = 0; i < partsumSize; i++)
+            {
+                partsum[i] += resultPartsum[static_cast<size_t>(r) * partsumSize + i];
+            }
+        }
+    }
+    for (f = 0; f < nresults; f++)
+    {
         if (results[f].dg_disc_err > prec / 10.)
         {
             disc_err = TRUE;
@@ -42,6 +42,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
@@ -63,8 +64,10 @@
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 
@@ -1431,7 +1434,7 @@ int gmx_cluster(int argc, char* argv[])
 
     matrix      box;
     matrix*     boxes = nullptr;
-    rvec *      xtps, *usextps, *x1, **xx = nullptr;
+    rvec *      xtps, *usextps, **xx = nullptr;
     const char *fn, *trx_out_fn;
     t_clusters  clust;
     t_mat *     rms, *orig = nullptr;
@@ -1444,7 +1447,7 @@ int gmx_cluster(int argc, char* argv[])
     int      isize = 0, ifsize = 0, iosize = 0;
     int *    index = nullptr, *fitidx = nullptr, *outidx = nullptr, *frameindices = nullptr;
     char*    grpname;
-    real     rmsd, **d1, **d2, *time = nullptr, time_invfac, *mass = nullptr;
+    real **  d1, **d2, *time = nullptr, time_invfac, *mass = nullptr;
     char     buf[STRLEN], buf1[80];
     gmx_bool bAnalyze, bUseRmsdCut, bJP_RMSD = FALSE, bReadMat, bReadTraj, bPBC = TRUE;
 
@@ -1473,6 +1476,7 @@ int gmx_cluster(int argc, char* argv[])
     static int   niter = 10000, nrandom = 0, seed = 0, write_ncl = 0, write_nst = 1, minstruct = 1;
     static real  kT = 1e-3;
     static int   M = 10, P = 3;
+    static int   nthreads = -1;
     gmx_output_env_t* oenv;
     gmx_rmpbc_t       gpbc = nullptr;
 
@@ -1551,7 +1555,8 @@ int gmx_cluster(int argc, char* argv[])
           { &kT },
           "Boltzmann weighting factor for Monte Carlo optimization "
           "(zero turns off uphill steps)" },
-        { "-pbc", FALSE, etBOOL, { &bPBC }, "PBC check" }
+        { "-pbc", FALSE, etBOOL, { &bPBC }, "PBC check" },
+        { "-nt", FALSE, etINT, { &nthreads }, "Number of threads to start" }
     };
     t_filenm fnm[] = {
         { efTRX, "-f", nullptr, ffOPTRD },         { efTPS, "-s", nullptr, ffREAD },
@@ -1565,11 +1570,15 @@ int gmx_cluster(int argc, char* argv[])
     };
 #define NFILE asize(fnm)
 
+    nthreads = gmx_omp_get_max_threads();
+
     if (!parse_common_args(&argc, argv, PCA_CAN_VIEW | PCA_CAN_TIME | PCA_TIME_UNIT, NFILE, fnm,
                            asize(pa), pa, asize(desc), desc, 0, nullptr, &oenv))
     {
         return 0;
     }
+    gmx_omp_set_num_threads(nthreads);
+    nthreads = gmx_omp_get_max_threads();
 
     /* parse options */
     bReadMat  = opt2bSet("-dm", NFILE, fnm);
@@ -1790,22 +1799,36 @@ int gmx_cluster(int argc, char* argv[])
         if (!bRMSdist)
         {
             fprintf(stderr, "Computing %dx%d RMS deviation matrix\n", nf, nf);
-            /* Initialize work array */
-            snew(x1, isize);
+            /* Initialize work arrays, one per thread.
+             * Each row of the matrix is computed in parallel, and then
+             * stored serially, so that the matrix statistics are
+             * accumulated in the same order as without threads.
+             */
+            std::vector<std::vector<gmx::RVec>> x1(nthreads, std::vector<gmx::RVec>(isize));
+            std::vector<real>                   rowRmsd(nf);
             for (i1 = 0; i1 < nf; i1++)
             {
-                for (i2 = i1 + 1; i2 < nf; i2++)
+#pragma omp parallel for schedule(static)
+                for (int j = i1 + 1; j < nf; j++)
                 {
-                    for (i = 0; i < isize; i++)
-                    {
-                        copy_rvec(xx[i1][i], x1[i]);
-                    }
-                    if (bFit)
+                    try
                     {
-                        do_fit(isize, mass, xx[i2], x1);
+                        rvec* xj = as_rvec_array(x1[gmx_omp_get_thread_num()].data());
+                        for (int k = 0; k < isize; k++)
+                        {
+                            copy_rvec(xx[i1][k], xj[k]);
+                        }
+                        if (bFit)
+                        {
+                            do_fit(isize, mass, xx[j], xj);
+                        }
+                        rowRmsd[j] = rmsdev(isize, mass, xx[j], xj);
                     }
-                    rmsd = rmsdev(isize, mass, xx[i2], x1);
-                    set_mat_entry(rms, i1, i2, rmsd);
+                    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                }
+                for (i2 = i1 + 1; i2 < nf; i2++)
+                {
+                    set_mat_entry(rms, i1, i2, rowRmsd[i2]);
                 }
                 nrms -= nf - i1 - 1;
                 fprintf(stderr,
@@ -1814,27 +1837,36 @@ int gmx_cluster(int argc, char* argv[])
                         nrms);
                 fflush(stderr);
             }
-            sfree(x1);
         }
         else /* bRMSdist */
         {
             fprintf(stderr, "Computing %dx%d RMS distance deviation matrix\n", nf, nf);
 
-            /* Initiate work arrays */
+            /* Initiate work arrays, with d2 separately for each thread */
             snew(d1, isize);
-            snew(d2, isize);
+            snew(d2, nthreads * isize);
             for (i = 0; (i < isize); i++)
             {
                 snew(d1[i], isize);
+            }
+            for (i = 0; (i < nthreads * isize); i++)
+            {
                 snew(d2[i], isize);
             }
+            std::vector<real> rowRmsd(nf);
             for (i1 = 0; i1 < nf; i1++)
             {
                 calc_dist(isize, xx[i1], d1);
+#pragma omp parallel for schedule(static)
+                for (int j = i1 + 1; j < nf; j++)
+                {
+                    real** dj = d2 + gmx_omp_get_thread_num() * isize;
+                    calc_dist(isize, xx[j], dj);
+                    rowRmsd[j] = rms_dist(isize, d1, dj);
+                }
                 for (i2 = i1 + 1; (i2 < nf); i2++)
                 {
-                    calc_dist(isize, xx[i2], d2);
-                    set_mat_entry(rms, i1, i2, rms_dist(isize, d1, d2));
+                    set_mat_entry(rms, i1, i2, rowRmsd[i2]);
                 }
                 nrms -= nf - i1 - 1;
                 fprintf(stderr,
@@ -1847,6 +1879,9 @@ int gmx_cluster(int argc, char* argv[])
             for (i = 0; (i < isize); i++)
             {
                 sfree(d1[i]);
+            }
+            for (i = 0; (i < nthreads * isize); i++)
+            {
                 sfree(d2[i]);
             }
             sfree(d1);
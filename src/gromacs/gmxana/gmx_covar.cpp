@@ -40,6 +40,8 @@
 #include <cmath>
 #include <cstring>
 
+#include <vector>
+
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/confio.h"
 #include "gromacs/fileio/matio.h"
@@ -61,6 +63,53 @@
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/sysinfo.h"
 
+/*! \brief
+ * Number of frames that are added to the covariance matrix in one pass.
+ *
+ * For large selections, the cost of the accumulation is dominated by
+ * reading and writing the matrix, so handling several frames per pass
+ * over the matrix is much faster than one pass per frame.
+ */
+static constexpr int c_covarFrameBlockSize = 16;
+
+/*! \brief
+ * Adds the outer products of deviation vectors to the covariance matrix.
+ *
+ * \param[in,out] mat     Covariance matrix; only the upper triangle is updated.
+ * \param[in]     natoms  Number of atoms in each deviation vector.
+ * \param[in]     nframes Number of deviation vectors in \p x.
+ * \param[in]     x       \p nframes consecutive deviation vectors.
+ *
+ * The contributions are added in order of the frames, so the result does
+ * not depend on how the frames are split into blocks or on the number of
+ * threads.
+ */
+static void addToCovarianceMatrix(real* mat, int natoms, int nframes, const rvec* x)
+{
+    const int64_t ndim = static_cast<int64_t>(natoms) * DIM;
+#pragma omp parallel for schedule(dynamic)
+    for (int j = 0; j < natoms; j++)
+    {
+        for (int dj = 0; dj < DIM; dj++)
+        {
+            const int64_t k = ndim * (DIM * j + dj);
+            for (int i = j; i < natoms; i++)
+            {
+                const int64_t l = k + DIM * i;
+                for (int d = 0; d < DIM; d++)
+                {
+                    real sum = mat[l + d];
+                    for (int f = 0; f < nframes; f++)
+                    {
+                        sum += x[f * natoms + i][d] * x[f * natoms + j][dj];
+                    }
+                    mat[l + d] = sum;
+                }
+            }
+        }
+    }
+}
+
 int gmx_covar(int argc, char* argv[])
 {
     const char* desc[] = {
@@ -120,10 +169,10 @@ int gmx_covar(int argc, char* argv[])
     matrix            box, zerobox;
     real *            sqrtm, *mat, *eigenvalues, sum, trace, inv_nframes;
     real              t, tstart, tend, **mat2;
-    real              xj, *w_rls = nullptr;
+    real*             w_rls = nullptr;
     real              min, max, *axis;
     int               natoms, nat, nframes0, nframes, nlevels;
-    int64_t           ndim, i, j, k, l;
+    int64_t           ndim, i, j, k;
     int               WriteXref;
     const char *      fitfile, *trxfile, *ndxfile;
     const char *      eigvalfile, *eigvecfile, *averfile, *logfile;
@@ -302,6 +351,8 @@ int gmx_covar(int argc, char* argv[])
     nframes = 0;
     nat     = read_first_x(oenv, &status, trxfile, &t, &xread, box);
     tstart  = t;
+    std::vector<gmx::RVec> xblock(c_covarFrameBlockSize * natoms);
+    int                    blockFrameCount = 0;
     do
     {
         nframes++;
@@ -316,39 +367,30 @@ int gmx_covar(int argc, char* argv[])
             reset_x(nfit, ifit, nat, nullptr, xread, w_rls);
             do_fit(nat, w_rls, xref, xread);
         }
+        rvec* xdev = as_rvec_array(xblock.data()) + blockFrameCount * natoms;
         if (bRef)
         {
             for (i = 0; i < natoms; i++)
             {
-                rvec_sub(xread[index[i]], xref[index[i]], x[i]);
+                rvec_sub(xread[index[i]], xref[index[i]], xdev[i]);
             }
         }
         else
         {
             for (i = 0; i < natoms; i++)
             {
-                rvec_sub(xread[index[i]], xav[i], x[i]);
+                rvec_sub(xread[index[i]], xav[i], xdev[i]);
             }
         }
-
-        for (j = 0; j < natoms; j++)
+        blockFrameCount++;
+        if (blockFrameCount == c_covarFrameBlockSize)
         {
-            for (dj = 0; dj < DIM; dj++)
-            {
-                k  = ndim * (DIM * j + dj);
-                xj = x[j][dj];
-                for (i = j; i < natoms; i++)
-                {
-                    l = k + DIM * i;
-                    for (d = 0; d < DIM; d++)
-                    {
-                        mat[l + d] += x[i][d] * xj;
-                    }
-                }
-            }
+            addToCovarianceMatrix(mat, natoms, blockFrameCount, as_rvec_array(xblock.data()));
+            blockFrameCount = 0;
         }
     } while (read_next_x(oenv, status, &t, xread, box) && (bRef || nframes < nframes0));
     close_trx(status);
+    addToCovarianceMatrix(mat, natoms, blockFrameCount, as_rvec_array(xblock.data()));
     gmx_rmpbc_done(gpbc);
 
     fprintf(stderr, "Read %d frames\n", nframes);
@@ -42,11 +42,15 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
+#include <vector>
+
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
 #include "gromacs/fileio/trxio.h"
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/gmxana/gmx_ana.h"
+#include "gromacs/gmxana/gridaccumulator.h"
 #include "gromacs/gmxana/gstat.h"
 #include "gromacs/math/units.h"
 #include "gromacs/math/vec.h"
@@ -54,11 +58,13 @@
 #include "gromacs/pbcutil/rmpbc.h"
 #include "gromacs/topology/index.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 typedef struct
@@ -168,168 +174,50 @@ static void center_coords(t_atoms* atoms, const int* index_center, int ncenter,
     }
 }
 
-static void calc_electron_density(const char*             fn,
-                                  int**                   index,
-                                  const int               gnx[],
-                                  double***               slDensity,
-                                  int*                    nslices,
-                                  t_topology*             top,
-                                  PbcType                 pbcType,
-                                  int                     axis,
-                                  int                     nr_grps,
-                                  real*                   slWidth,
-                                  t_electron              eltab[],
-                                  int                     nr,
-                                  gmx_bool                bCenter,
-                                  int*                    index_center,
-                                  int                     ncenter,
-                                  gmx_bool                bRelative,
-                                  const gmx_output_env_t* oenv)
+/*! \brief Returns the number of electrons of each atom in the groups,
+ * modified by its partial charge.
+ *
+ * Atoms that are not in any group or not in \p eltab get zero weight.
+ */
+static std::vector<real> electronWeights(const t_topology& top,
+                                         int**             index,
+                                         const int         gnx[],
+                                         int               nr_grps,
+                                         t_electron        eltab[],
+                                         int               nr)
 {
-    rvec*        x0;  /* coordinates without pbc */
-    matrix       box; /* box (3x3) */
-    double       invvol;
-    int          natoms; /* nr. atoms in trj */
-    t_trxstatus* status;
-    int          i, n,     /* loop indices */
-            nr_frames = 0, /* number of frames */
-            slice;         /* current slice */
-    t_electron* found;     /* found by bsearch */
-    t_electron  sought;    /* thingie thought by bsearch */
-    real        boxSz, aveBox;
-    gmx_rmpbc_t gpbc = nullptr;
-
-    real t, z;
-
-    if (axis < 0 || axis >= DIM)
-    {
-        gmx_fatal(FARGS, "Invalid axes. Terminating\n");
-    }
-
-    if ((natoms = read_first_x(oenv, &status, fn, &t, &x0, box)) == 0)
+    std::vector<real> weights(top.atoms.nr, 0);
+    std::vector<bool> done(top.atoms.nr, false);
+    for (int n = 0; n < nr_grps; n++)
     {
-        gmx_fatal(FARGS, "Could not read coordinates from statusfile\n");
-    }
-
-    aveBox = 0;
-
-    if (!*nslices)
-    {
-        *nslices = static_cast<int>(box[axis][axis] * 10); /* default value */
-        fprintf(stderr, "\nDividing the box in %d slices\n", *nslices);
-    }
-
-    snew(*slDensity, nr_grps);
-    for (i = 0; i < nr_grps; i++)
-    {
-        snew((*slDensity)[i], *nslices);
-    }
-
-    gpbc = gmx_rmpbc_init(&top->idef, pbcType, top->atoms.nr);
-    /*********** Start processing trajectory ***********/
-    do
-    {
-        gmx_rmpbc(gpbc, natoms, box, x0);
-
-        /* Translate atoms so the com of the center-group is in the
-         * box geometrical center.
-         */
-        if (bCenter)
-        {
-            center_coords(&top->atoms, index_center, ncenter, box, x0);
-        }
-
-        invvol = *nslices / (box[XX][XX] * box[YY][YY] * box[ZZ][ZZ]);
-
-        if (bRelative)
+        for (int i = 0; i < gnx[n]; i++)
         {
-            *slWidth = 1.0 / (*nslices);
-            boxSz    = 1.0;
-        }
-        else
-        {
-            *slWidth = box[axis][axis] / (*nslices);
-            boxSz    = box[axis][axis];
-        }
-
-        aveBox += box[axis][axis];
-
-        for (n = 0; n < nr_grps; n++)
-        {
-            for (i = 0; i < gnx[n]; i++) /* loop over all atoms in index file */
+            const int atom = index[n][i];
+            if (done[atom])
             {
-                z = x0[index[n][i]][axis];
-                while (z < 0)
-                {
-                    z += box[axis][axis];
-                }
-                while (z > box[axis][axis])
-                {
-                    z -= box[axis][axis];
-                }
-
-                if (bRelative)
-                {
-                    z = z / box[axis][axis];
-                }
-
-                /* determine which slice atom is in */
-                if (bCenter)
-                {
-                    slice = static_cast<int>(std::floor((z - (boxSz / 2.0)) / (*slWidth)) + *nslices / 2.);
-                }
-                else
-                {
-                    slice = static_cast<int>(z / (*slWidth));
-                }
-                sought.nr_el    = 0;
-                sought.atomname = gmx_strdup(*(top->atoms.atomname[index[n][i]]));
-
-                /* now find the number of electrons. This is not efficient. */
-                found = static_cast<t_electron*>(
-                        bsearch(&sought, eltab, nr, sizeof(t_electron),
-                                reinterpret_cast<int (*)(const void*, const void*)>(compare)));
-
-                if (found == nullptr)
-                {
-                    fprintf(stderr, "Couldn't find %s. Add it to the .dat file\n",
-                            *(top->atoms.atomname[index[n][i]]));
-                }
-                else
-                {
-                    (*slDensity)[n][slice] += (found->nr_el - top->atoms.atom[index[n][i]].q) * invvol;
-                }
-                free(sought.atomname);
+                continue;
             }
-        }
-        nr_frames++;
-    } while (read_next_x(oenv, status, &t, x0, box));
-    gmx_rmpbc_done(gpbc);
-
-    /*********** done with status file **********/
-    close_trx(status);
+            done[atom] = true;
 
-    /* slDensity now contains the total number of electrons per slice, summed
-       over all frames. Now divide by nr_frames and volume of slice
-     */
+            t_electron sought; /* thingie thought by bsearch */
+            sought.nr_el    = 0;
+            sought.atomname = *(top.atoms.atomname[atom]);
+            const t_electron* found = static_cast<t_electron*>(
+                    bsearch(&sought, eltab, nr, sizeof(t_electron),
+                            reinterpret_cast<int (*)(const void*, const void*)>(compare)));
 
-    fprintf(stderr, "\nRead %d frames from trajectory. Counting electrons\n", nr_frames);
-
-    if (bRelative)
-    {
-        aveBox /= nr_frames;
-        *slWidth = aveBox / (*nslices);
-    }
-
-    for (n = 0; n < nr_grps; n++)
-    {
-        for (i = 0; i < *nslices; i++)
-        {
-            (*slDensity)[n][i] /= nr_frames;
+            if (found == nullptr)
+            {
+                fprintf(stderr, "Couldn't find %s. Add it to the .dat file\n",
+                        *(top.atoms.atomname[atom]));
+            }
+            else
+            {
+                weights[atom] = found->nr_el - top.atoms.atom[atom].q;
+            }
         }
     }
-
-    sfree(x0); /* free memory used by coordinate array */
+    return weights;
 }
 
 static void calc_density(const char*             fn,
@@ -342,10 +230,14 @@ static void calc_density(const char*             fn,
                          int                     axis,
                          int                     nr_grps,
                          real*                   slWidth,
+                         t_electron              eltab[],
+                         int                     nr,
                          gmx_bool                bCenter,
                          int*                    index_center,
                          int                     ncenter,
                          gmx_bool                bRelative,
+                         real                    sigma,
+                         int                     nthreads,
                          const gmx_output_env_t* oenv,
                          const char**            dens_opt)
 {
@@ -354,13 +246,10 @@ static void calc_density(const char*             fn,
     double       invvol;
     int          natoms; /* nr. atoms in trj */
     t_trxstatus* status;
-    int          i, n,     /* loop indices */
-            nr_frames = 0, /* number of frames */
-            slice;         /* current slice */
-    real        t, z;
-    real        boxSz, aveBox;
-    real*       den_val; /* values from which the density is calculated */
-    gmx_rmpbc_t gpbc = nullptr;
+    int          nr_frames = 0; /* number of frames */
+    real         t;
+    real         boxSz, aveBox;
+    gmx_rmpbc_t  gpbc = nullptr;
 
     if (axis < 0 || axis >= DIM)
     {
@@ -380,33 +269,35 @@ static void calc_density(const char*             fn,
         fprintf(stderr, "\nDividing the box in %d slices\n", *nslices);
     }
 
-    snew(*slDensity, nr_grps);
-    for (i = 0; i < nr_grps; i++)
+    gmx::GridAccumulator accumulator(nr_grps, *nslices, nthreads);
+    if (sigma > 0)
     {
-        snew((*slDensity)[i], *nslices);
+        accumulator.setGaussianSpreading(sigma);
     }
 
     gpbc = gmx_rmpbc_init(&top->idef, pbcType, top->atoms.nr);
     /*********** Start processing trajectory ***********/
 
-    snew(den_val, top->atoms.nr);
-    if (dens_opt[0][0] == 'n')
+    /* values from which the density is calculated */
+    std::vector<real> den_val(top->atoms.nr);
+    if (dens_opt[0][0] == 'e')
     {
-        for (i = 0; (i < top->atoms.nr); i++)
-        {
-            den_val[i] = 1;
-        }
+        den_val = electronWeights(*top, index, gnx, nr_grps, eltab, nr);
+    }
+    else if (dens_opt[0][0] == 'n')
+    {
+        std::fill(den_val.begin(), den_val.end(), 1);
     }
     else if (dens_opt[0][0] == 'c')
     {
-        for (i = 0; (i < top->atoms.nr); i++)
+        for (int i = 0; (i < top->atoms.nr); i++)
         {
             den_val[i] = top->atoms.atom[i].q;
         }
     }
     else
     {
-        for (i = 0; (i < top->atoms.nr); i++)
+        for (int i = 0; (i < top->atoms.nr); i++)
         {
             den_val[i] = top->atoms.atom[i].m;
         }
@@ -439,33 +330,53 @@ static void calc_density(const char*             fn,
 
         aveBox += box[axis][axis];
 
-        for (n = 0; n < nr_grps; n++)
+        const real boxLength = box[axis][axis];
+        const real width     = *slWidth;
+        const int  numSlices = *nslices;
+        for (int n = 0; n < nr_grps; n++)
         {
-            for (i = 0; i < gnx[n]; i++) /* loop over all atoms in index file */
-            {
-                z = x0[index[n][i]][axis];
+            const int* groupIndex = index[n];
+            /* Returns the coordinate along the axis of atom i in the group,
+             * put in the box and optionally scaled to the box.
+             */
+            auto axisCoordinate = [&](int i) {
+                real z = x0[groupIndex[i]][axis];
                 while (z < 0)
                 {
-                    z += box[axis][axis];
+                    z += boxLength;
                 }
-                while (z > box[axis][axis])
+                while (z > boxLength)
                 {
-                    z -= box[axis][axis];
+                    z -= boxLength;
                 }
-
                 if (bRelative)
                 {
-                    z = z / box[axis][axis];
+                    z = z / boxLength;
                 }
+                return z;
+            };
 
+            if (accumulator.hasGaussianSpreading())
+            {
+                accumulator.spread(n, gnx[n], [&](int i, real* weight) {
+                    const real z = axisCoordinate(i);
+                    *weight      = den_val[groupIndex[i]] * invvol;
+                    return bCenter ? (z - (boxSz / 2.0)) / width + numSlices / 2. : z / width;
+                });
+                continue;
+            }
+            accumulator.accumulate(n, gnx[n], [&](int i, real* weight) {
+                const real z = axisCoordinate(i);
                 /* determine which slice atom is in */
+                int slice;
                 if (bCenter)
                 {
-                    slice = static_cast<int>(std::floor((z - (boxSz / 2.0)) / (*slWidth)) + *nslices / 2.);
+                    slice = static_cast<int>(std::floor((z - (boxSz / 2.0)) / width)
+                                             + numSlices / 2.);
                 }
                 else
                 {
-                    slice = static_cast<int>(std::floor(z / (*slWidth)));
+                    slice = static_cast<int>(std::floor(z / width));
                 }
 
                 /* Slice should already be 0<=slice<nslices, but we just make
@@ -474,15 +385,16 @@ static void calc_density(const char*             fn,
                  */
                 if (slice < 0)
                 {
-                    slice += *nslices;
+                    slice += numSlices;
                 }
-                else if (slice >= *nslices)
+                else if (slice >= numSlices)
                 {
-                    slice -= *nslices;
+                    slice -= numSlices;
                 }
 
-                (*slDensity)[n][slice] += den_val[index[n][i]] * invvol;
-            }
+                *weight = den_val[groupIndex[i]] * invvol;
+                return slice;
+            });
         }
         nr_frames++;
     } while (read_next_x(oenv, status, &t, x0, box));
@@ -491,8 +403,8 @@ static void calc_density(const char*             fn,
     /*********** done with status file **********/
     close_trx(status);
 
-    /* slDensity now contains the total mass per slice, summed over all
-       frames. Now divide by nr_frames and volume of slice
+    /* The accumulated grids now contain the total density per slice, summed
+       over all frames. Now divide by nr_frames and volume of slice
      */
 
     fprintf(stderr, "\nRead %d frames from trajectory. Calculating density\n", nr_frames);
@@ -503,16 +415,19 @@ static void calc_density(const char*             fn,
         *slWidth = aveBox / (*nslices);
     }
 
-    for (n = 0; n < nr_grps; n++)
+    accumulator.reduce();
+    snew(*slDensity, nr_grps);
+    for (int n = 0; n < nr_grps; n++)
     {
-        for (i = 0; i < *nslices; i++)
+        snew((*slDensity)[n], *nslices);
+        gmx::ArrayRef<const double> grid = accumulator.grid(n);
+        for (int i = 0; i < *nslices; i++)
         {
-            (*slDensity)[n][i] /= nr_frames;
+            (*slDensity)[n][i] = grid[i] / nr_frames;
         }
     }
 
     sfree(x0); /* free memory used by coordinate array */
-    sfree(den_val);
 }
 
 static void plot_density(double*                 slDensity[],
@@ -672,6 +587,8 @@ int gmx_density(int argc, char* argv[])
     static gmx_bool    bSymmetrize = FALSE;
     static gmx_bool    bCenter     = FALSE;
     static gmx_bool    bRelative   = FALSE;
+    static real        sigma       = 0;
+    static int         nthreads    = -1;
 
     t_pargs pa[] = {
         { "-d",
@@ -698,7 +615,14 @@ int gmx_density(int argc, char* argv[])
           FALSE,
           etBOOL,
           { &bRelative },
-          "Use relative coordinates for changing boxes and scale output by average dimensions." }
+          "Use relative coordinates for changing boxes and scale output by average dimensions." },
+        { "-sigma",
+          FALSE,
+          etREAL,
+          { &sigma },
+          "Spread each atom with a Gaussian of this width, in units of the slice width, "
+          "instead of binning it (0 is off)" },
+        { "-nt", FALSE, etINT, { &nthreads }, "Number of threads to start" }
     };
 
     const char* bugs[] = {
@@ -729,12 +653,16 @@ int gmx_density(int argc, char* argv[])
 
 #define NFILE asize(fnm)
 
+    nthreads = gmx_omp_get_max_threads();
+
     if (!parse_common_args(&argc, argv, PCA_CAN_VIEW | PCA_CAN_TIME, NFILE, fnm, asize(pa), pa,
                            asize(desc), desc, asize(bugs), bugs, &oenv))
     {
         return 0;
     }
 
+    gmx_omp_set_num_threads(nthreads);
+
     GMX_RELEASE_ASSERT(dens_opt[0] != nullptr, "Option setting inconsistency; dens_opt[0] is NULL");
 
     if (bSymmetrize && !bCenter)
@@ -773,16 +701,15 @@ int gmx_density(int argc, char* argv[])
     {
         nr_electrons = get_electrons(&el_tab, ftp2fn(efDAT, NFILE, fnm));
         fprintf(stderr, "Read %d atomtypes from datafile\n", nr_electrons);
-
-        calc_electron_density(ftp2fn(efTRX, NFILE, fnm), index, ngx, &density, &nslices, top,
-                              pbcType, axis, ngrps, &slWidth, el_tab, nr_electrons, bCenter,
-                              index_center, ncenter, bRelative, oenv);
     }
     else
     {
-        calc_density(ftp2fn(efTRX, NFILE, fnm), index, ngx, &density, &nslices, top, pbcType, axis,
-                     ngrps, &slWidth, bCenter, index_center, ncenter, bRelative, oenv, dens_opt);
+        nr_electrons = 0;
+        el_tab       = nullptr;
     }
+    calc_density(ftp2fn(efTRX, NFILE, fnm), index, ngx, &density, &nslices, top, pbcType, axis,
+                 ngrps, &slWidth, el_tab, nr_electrons, bCenter, index_center, ncenter, bRelative,
+                 sigma, nthreads, oenv, dens_opt);
 
     plot_density(density, opt2fn("-o", NFILE, fnm), nslices, ngrps, grpname, slWidth, dens_opt,
                  bCenter, bRelative, bSymmetrize, oenv);
@@ -46,17 +46,20 @@
 #include "gromacs/fileio/matio.h"
 #include "gromacs/fileio/trxio.h"
 #include "gromacs/gmxana/gmx_ana.h"
+#include "gromacs/gmxana/gridaccumulator.h"
 #include "gromacs/gmxana/gstat.h"
 #include "gromacs/math/utilities.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/topology/index.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 int gmx_densmap(int argc, char* argv[])
@@ -99,6 +102,7 @@ int gmx_densmap(int argc, char* argv[])
     static int         n1 = 0, n2 = 0;
     static real        xmin = -1, xmax = -1, bin = 0.02, dmin = 0, dmax = 0, amax = 0, rmax = 0;
     static gmx_bool    bMirror = FALSE, bSums = FALSE;
+    static int         nthreads = -1;
     static const char* eaver[] = { nullptr, "z", "y", "x", nullptr };
     static const char* eunit[] = { nullptr, "nm-3", "nm-2", "count", nullptr };
 
@@ -116,13 +120,14 @@ int gmx_densmap(int argc, char* argv[])
         { "-unit", FALSE, etENUM, { eunit }, "Unit for the output" },
         { "-dmin", FALSE, etREAL, { &dmin }, "Minimum density in output" },
         { "-dmax", FALSE, etREAL, { &dmax }, "Maximum density in output (0 means calculate it)" },
+        { "-nt", FALSE, etINT, { &nthreads }, "Number of threads to start" },
     };
     gmx_bool          bXmin, bXmax, bRadial;
     FILE*             fp;
     t_trxstatus*      status;
     t_topology        top;
     PbcType           pbcType = PbcType::Unset;
-    rvec *            x, xcom[2], direction, center, dx;
+    rvec *            x, xcom[2], direction, center;
     matrix            box;
     real              t, m, mtot;
     t_pbc             pbc;
@@ -131,8 +136,8 @@ int gmx_densmap(int argc, char* argv[])
     const char*       unit;
     int               i, j, k, l, ngrps, anagrp, *gnx = nullptr, nindex, nradial = 0, nfr, nmpower;
     int **            ind = nullptr, *index;
-    real **           grid, maxgrid, m1, m2, box1, box2, *tickx, *tickz, invcellvol;
-    real              invspa = 0, invspz = 0, axial, r, vol_old, vol, rowsum;
+    real **           grid, maxgrid, box1, box2, *tickx, *tickz, invcellvol;
+    real              invspa = 0, invspz = 0, vol_old, vol, rowsum;
     int               nlev = 51;
     t_rgb             rlo = { 1, 1, 1 }, rhi = { 0, 0, 0 };
     gmx_output_env_t* oenv;
@@ -147,12 +152,16 @@ int gmx_densmap(int argc, char* argv[])
 
     npargs = asize(pa);
 
+    nthreads = gmx_omp_get_max_threads();
+
     if (!parse_common_args(&argc, argv, PCA_CAN_TIME | PCA_CAN_VIEW, NFILE, fnm, npargs, pa,
                            asize(desc), desc, 0, nullptr, &oenv))
     {
         return 0;
     }
 
+    gmx_omp_set_num_threads(nthreads);
+
     bXmin   = opt2parg_bSet("-xmin", npargs, pa);
     bXmax   = opt2parg_bSet("-xmax", npargs, pa);
     bRadial = (amax > 0 || rmax > 0);
@@ -268,6 +277,7 @@ int gmx_densmap(int argc, char* argv[])
     {
         snew(grid[i], n2);
     }
+    gmx::GridAccumulator accumulator(1, n1 * n2, nthreads);
 
     box1 = 0;
     box2 = 0;
@@ -287,12 +297,11 @@ int gmx_densmap(int argc, char* argv[])
             {
                 invcellvol /= box[c1][c1] * box[c2][c2];
             }
-            for (i = 0; i < nindex; i++)
-            {
-                j = index[i];
+            accumulator.accumulate(0, nindex, [&](int i, real* weight) {
+                const int j = index[i];
                 if ((!bXmin || x[j][cav] >= xmin) && (!bXmax || x[j][cav] <= xmax))
                 {
-                    m1 = x[j][c1] / box[c1][c1];
+                    real m1 = x[j][c1] / box[c1][c1];
                     if (m1 >= 1)
                     {
                         m1 -= 1;
@@ -301,7 +310,7 @@ int gmx_densmap(int argc, char* argv[])
                     {
                         m1 += 1;
                     }
-                    m2 = x[j][c2] / box[c2][c2];
+                    real m2 = x[j][c2] / box[c2][c2];
                     if (m2 >= 1)
                     {
                         m2 -= 1;
@@ -310,9 +319,11 @@ int gmx_densmap(int argc, char* argv[])
                     {
                         m2 += 1;
                     }
-                    grid[static_cast<int>(m1 * n1)][static_cast<int>(m2 * n2)] += invcellvol;
+                    *weight = invcellvol;
+                    return static_cast<int>(m1 * n1) * n2 + static_cast<int>(m2 * n2);
                 }
-            }
+                return -1;
+            });
         }
         else
         {
@@ -348,26 +359,38 @@ int gmx_densmap(int argc, char* argv[])
                 center[i] = xcom[0][i] + 0.5 * direction[i];
             }
             unitv(direction, direction);
-            for (i = 0; i < nindex; i++)
-            {
-                j = index[i];
-                pbc_dx(&pbc, x[j], center, dx);
-                axial = iprod(dx, direction);
-                r     = std::sqrt(norm2(dx) - axial * axial);
+            accumulator.accumulate(0, nindex, [&](int i, real* weight) {
+                rvec dx;
+                pbc_dx(&pbc, x[index[i]], center, dx);
+                const real axial = iprod(dx, direction);
+                real       r     = std::sqrt(norm2(dx) - axial * axial);
                 if (axial >= -amax && axial < amax && r < rmax)
                 {
                     if (bMirror)
                     {
                         r += rmax;
                     }
-                    grid[static_cast<int>((axial + amax) * invspa)][static_cast<int>(r * invspz)] += 1;
+                    *weight = 1;
+                    return static_cast<int>((axial + amax) * invspa) * n2
+                           + static_cast<int>(r * invspz);
                 }
-            }
+                return -1;
+            });
         }
         nfr++;
     } while (read_next_x(oenv, status, &t, x, box));
     close_trx(status);
 
+    accumulator.reduce();
+    gmx::ArrayRef<const double> gridSum = accumulator.grid(0);
+    for (i = 0; i < n1; i++)
+    {
+        for (j = 0; j < n2; j++)
+        {
+            grid[i][j] = gridSum[i * n2 + j];
+        }
+    }
+
     /* normalize gridpoints */
     maxgrid = 0;
     if (!bRadial)
@@ -323,12 +323,15 @@ static void add_ff(t_hbdata* hbd, int id, int h, int ia, int frame, int ihb)
     else
     {
         hb->nframes = frame - hb->n0;
-        /* We need a while loop here because hbonds may be returning
-         * after a long time.
-         */
-        while (hb->nframes >= hb->maxframes)
-        {
-            n = hb->maxframes + delta;
+        if (hb->nframes >= hb->maxframes)
+        {
+            /* Grow the existence bitmaps by a quarter of their current size
+             * (but at least by delta), so that long-lived hbonds are not
+             * reallocated and copied every delta frames.  The size must
+             * also cover hbonds returning after a long time.
+             */
+            n = std::max(hb->maxframes + std::max(delta, hb->maxframes / 4), hb->nframes + 1);
+            n = ((n + delta - 1) / delta) * delta;
             for (i = 0; (i < maxhydro); i++)
             {
                 srenew(hb->h[i], n / wlen);
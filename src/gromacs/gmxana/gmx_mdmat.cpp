@@ -41,6 +41,9 @@
 #include <cstring>
 
 #include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "gromacs/commandline/filenm.h"
 #include "gromacs/commandline/pargs.h"
@@ -53,6 +56,7 @@
 #include "gromacs/math/vec.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pbcutil/rmpbc.h"
+#include "gromacs/selection/nbsearch.h"
 #include "gromacs/topology/index.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/arraysize.h"
@@ -62,8 +66,6 @@
 #include "gromacs/utility/smalloc.h"
 
 
-#define FARAWAY 10000
-
 static int* res_ndx(t_atoms* atoms)
 {
     int* rndx;
@@ -107,73 +109,91 @@ static int* res_natm(t_atoms* atoms)
     return natm;
 }
 
-static void calc_mat(int        nres,
-                     int        natoms,
-                     const int  rndx[],
-                     rvec       x[],
-                     const int* index,
-                     real       trunc,
-                     real**     mdmat,
-                     int**      nmat,
-                     PbcType    pbcType,
-                     matrix     box)
+/*! \brief Computes the smallest distances between residues and the atom contacts
+ *
+ * Only the residue pairs closer than \p trunc are searched for, with
+ * \p nb, and stored in \p mdmat and \p closePairs. All other pairs
+ * keep the value \p trunc, the pairs that were close in the previous
+ * frame are reset to that before searching.
+ * For every residue, \p contactFirstFrame stores the first frame in
+ * which each atom was within \p trunc of an atom of the residue.
+ */
+static void calc_mat(gmx::AnalysisNeighborhood*                 nb,
+                     int                                        natoms,
+                     const int                                  rndx[],
+                     rvec                                       x[],
+                     int                                        nx,
+                     const int*                                 index,
+                     real                                       trunc,
+                     real**                                     mdmat,
+                     std::vector<std::pair<int, int>>*          closePairs,
+                     int                                        frame,
+                     std::vector<std::unordered_map<int, int>>* contactFirstFrame,
+                     PbcType                                    pbcType,
+                     matrix                                     box)
 {
-    int   i, j, resi, resj;
-    real  trunc2, r, r2;
     t_pbc pbc;
-    rvec  ddx;
+
+    for (const auto& pair : *closePairs)
+    {
+        mdmat[pair.first][pair.second] = trunc;
+        mdmat[pair.second][pair.first] = trunc;
+    }
+    closePairs->clear();
 
     set_pbc(&pbc, pbcType, box);
-    trunc2 = gmx::square(trunc);
-    for (resi = 0; (resi < nres); resi++)
+    const real trunc2 = gmx::square(trunc);
+
+    gmx::AnalysisNeighborhoodPositions pos = gmx::AnalysisNeighborhoodPositions(x, nx).indexed(
+            gmx::constArrayRefFromArray(index, natoms));
+    gmx::AnalysisNeighborhoodSearch     search     = nb->initSearch(&pbc, pos);
+    gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
+    gmx::AnalysisNeighborhoodPair       pair;
+    while (pairSearch.findNextPair(&pair))
     {
-        for (resj = 0; (resj < nres); resj++)
+        const int i = pair.testIndex();
+        const int j = pair.refIndex();
+        /* Every pair is found twice */
+        if (j <= i || pair.distance2() >= trunc2)
         {
-            mdmat[resi][resj] = FARAWAY;
+            continue;
         }
-    }
-    for (i = 0; (i < natoms); i++)
-    {
-        resi = rndx[i];
-        for (j = i + 1; (j < natoms); j++)
+        const int resi = rndx[i];
+        const int resj = rndx[j];
+        (*contactFirstFrame)[resi].emplace(j, frame);
+        (*contactFirstFrame)[resj].emplace(i, frame);
+        if (resi != resj)
         {
-            resj = rndx[j];
-            pbc_dx(&pbc, x[index[i]], x[index[j]], ddx);
-            r2 = norm2(ddx);
-            if (r2 < trunc2)
+            const int  res0 = std::min(resi, resj);
+            const int  res1 = std::max(resi, resj);
+            const real r    = std::sqrt(pair.distance2());
+            if (mdmat[res0][res1] >= trunc)
             {
-                nmat[resi][j]++;
-                nmat[resj][i]++;
+                closePairs->emplace_back(res0, res1);
             }
-            mdmat[resi][resj] = std::min(r2, mdmat[resi][resj]);
+            mdmat[res0][res1] = std::min(r, mdmat[res0][res1]);
         }
     }
 
-    for (resi = 0; (resi < nres); resi++)
+    for (const auto& pair : *closePairs)
     {
-        mdmat[resi][resi] = 0;
-        for (resj = resi + 1; (resj < nres); resj++)
-        {
-            r                 = std::sqrt(mdmat[resi][resj]);
-            mdmat[resi][resj] = r;
-            mdmat[resj][resi] = r;
-        }
+        mdmat[pair.second][pair.first] = mdmat[pair.first][pair.second];
     }
 }
 
-static void tot_nmat(int nres, int natoms, int nframes, int** nmat, int* tot_n, real* mean_n)
+static void tot_nmat(int                                              nres,
+                     int                                              nframes,
+                     const std::vector<std::unordered_map<int, int>>& contactFirstFrame,
+                     int*                                             tot_n,
+                     real*                                            mean_n)
 {
-    int i, j;
-
-    for (i = 0; (i < nres); i++)
+    for (int i = 0; (i < nres); i++)
     {
-        for (j = 0; (j < natoms); j++)
+        /* The number of frames from the first contact of atom j onwards */
+        for (const auto& firstFrame : contactFirstFrame[i])
         {
-            if (nmat[i][j] != 0)
-            {
-                tot_n[i]++;
-                mean_n[i] += nmat[i][j];
-            }
+            tot_n[i]++;
+            mean_n[i] += nframes - firstFrame.second;
         }
         mean_n[i] /= nframes;
     }
@@ -190,6 +210,8 @@ int gmx_mdmat(int argc, char* argv[])
         "trajectory is output.",
         "Also a count of the number of different atomic contacts between",
         "residues over the whole trajectory can be made.",
+        "Distances larger than the truncation distance [TT]-t[tt] are set to that",
+        "distance, so only the close pairs need to be searched for.",
         "The output can be processed with [gmx-xpm2ps] to make a PostScript (tm) plot."
     };
     static real truncate = 1.5;
@@ -222,7 +244,6 @@ int gmx_mdmat(int argc, char* argv[])
     t_rgb             rlo, rhi;
     rvec*             x;
     real **           mdmat, *resnr, **totmdmat;
-    int **            nmat, **totnmat;
     real*             mean_n;
     int*              tot_n;
     matrix            box = { { 0 } };
@@ -285,22 +306,29 @@ int gmx_mdmat(int argc, char* argv[])
 
     snew(resnr, nres);
     snew(mdmat, nres);
-    snew(nmat, nres);
-    snew(totnmat, nres);
     snew(mean_n, nres);
     snew(tot_n, nres);
     for (i = 0; (i < nres); i++)
     {
         snew(mdmat[i], nres);
-        snew(nmat[i], natoms);
-        snew(totnmat[i], natoms);
+        for (j = 0; (j < nres); j++)
+        {
+            mdmat[i][j] = (i == j ? 0 : truncate);
+        }
         resnr[i] = i + 1;
     }
+    /* Accumulates how much closer than truncate the residues are */
     snew(totmdmat, nres);
     for (i = 0; (i < nres); i++)
     {
         snew(totmdmat[i], nres);
     }
+    /* For each residue the frame of the first contact with each atom */
+    std::vector<std::unordered_map<int, int>> contactFirstFrame(nres);
+    std::vector<std::pair<int, int>>          closePairs;
+
+    gmx::AnalysisNeighborhood nb;
+    nb.setCutoff(truncate);
 
     trxnat = read_first_x(oenv, &status, ftp2fn(efTRX, NFILE, fnm), &t, &x, box);
 
@@ -322,24 +350,12 @@ int gmx_mdmat(int argc, char* argv[])
     do
     {
         gmx_rmpbc(gpbc, trxnat, box, x);
+        calc_mat(&nb, natoms, rndx, x, trxnat, index, truncate, mdmat, &closePairs, nframes,
+                 &contactFirstFrame, pbcType, box);
         nframes++;
-        calc_mat(nres, natoms, rndx, x, index, truncate, mdmat, nmat, pbcType, box);
-        for (i = 0; (i < nres); i++)
+        for (const auto& pair : closePairs)
         {
-            for (j = 0; (j < natoms); j++)
-            {
-                if (nmat[i][j])
-                {
-                    totnmat[i][j]++;
-                }
-            }
-        }
-        for (i = 0; (i < nres); i++)
-        {
-            for (j = 0; (j < nres); j++)
-            {
-                totmdmat[i][j] += mdmat[i][j];
-            }
+            totmdmat[pair.first][pair.second] += truncate - mdmat[pair.first][pair.second];
         }
         if (bFrames)
         {
@@ -360,9 +376,11 @@ int gmx_mdmat(int argc, char* argv[])
 
     for (i = 0; (i < nres); i++)
     {
-        for (j = 0; (j < nres); j++)
+        totmdmat[i][i] = 0;
+        for (j = i + 1; (j < nres); j++)
         {
-            totmdmat[i][j] /= nframes;
+            totmdmat[i][j] = truncate - totmdmat[i][j] / nframes;
+            totmdmat[j][i] = totmdmat[i][j];
         }
     }
     write_xpm(opt2FILE("-mean", NFILE, fnm, "w"), 0, "Mean smallest distance", "Distance (nm)",
@@ -378,7 +396,7 @@ int gmx_mdmat(int argc, char* argv[])
         {
             snew(legend[i], STRLEN);
         }
-        tot_nmat(nres, natoms, nframes, totnmat, tot_n, mean_n);
+        tot_nmat(nres, nframes, contactFirstFrame, tot_n, mean_n);
         fp = xvgropen(ftp2fn(efXVG, NFILE, fnm), "Increase in number of contacts", "Residue",
                       "Ratio", oenv);
         sprintf(legend[0], "Total/mean");
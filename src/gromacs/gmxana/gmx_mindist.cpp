@@ -42,6 +42,8 @@
 #include <cstring>
 
 #include <algorithm>
+#include <array>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
@@ -54,15 +56,26 @@
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pbcutil/rmpbc.h"
+#include "gromacs/selection/nbsearch.h"
 #include "gromacs/topology/index.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
+/*! \brief Number of atom pairs above which minimum distances and contacts
+ * are computed with a grid-based neighborhood search
+ *
+ * For fewer pairs, e.g. for the atom-atom distance matrix, setting up the
+ * search costs more than looping over all pairs.
+ */
+static constexpr int64_t c_minNumPairsForGridSearch = 4096;
 
 static void
 periodic_dist(PbcType pbcType, matrix box, rvec x[], int n, const int index[], real* rmin, real* rmax, int* min_ind)
@@ -106,33 +119,61 @@ periodic_dist(PbcType pbcType, matrix box, rvec x[], int n, const int index[], r
         }
     }
 
-    r2min = sqr_box;
-    r2max = 0;
-
-    for (i = 0; i < n; i++)
+    /* Each thread finds the extremes over its own rows. When merging, equal
+     * minima are resolved to the first pair in loop order, as with a single
+     * thread.
+     */
+    const int                       nthreads = gmx_omp_get_max_threads();
+    std::vector<real>               threadR2min(nthreads, sqr_box);
+    std::vector<real>               threadR2max(nthreads, 0);
+    std::vector<std::array<int, 2>> threadMinInd(nthreads, { { -1, -1 } });
+#pragma omp parallel num_threads(nthreads) private(j, s, r2, d0, d)
     {
-        for (j = i + 1; j < n; j++)
+        const int t = gmx_omp_get_thread_num();
+#pragma omp for schedule(dynamic, 16)
+        for (i = 0; i < n; i++)
         {
-            rvec_sub(x[index[i]], x[index[j]], d0);
-            r2 = norm2(d0);
-            if (r2 > r2max)
+            for (j = i + 1; j < n; j++)
             {
-                r2max = r2;
-            }
-            for (s = 0; s < nshift; s++)
-            {
-                rvec_add(d0, shift[s], d);
-                r2 = norm2(d);
-                if (r2 < r2min)
+                rvec_sub(x[index[i]], x[index[j]], d0);
+                r2 = norm2(d0);
+                if (r2 > threadR2max[t])
                 {
-                    r2min      = r2;
-                    min_ind[0] = i;
-                    min_ind[1] = j;
+                    threadR2max[t] = r2;
+                }
+                for (s = 0; s < nshift; s++)
+                {
+                    rvec_add(d0, shift[s], d);
+                    r2 = norm2(d);
+                    if (r2 < threadR2min[t])
+                    {
+                        threadR2min[t]  = r2;
+                        threadMinInd[t] = { { i, j } };
+                    }
                 }
             }
         }
     }
 
+    r2min                     = sqr_box;
+    r2max                     = 0;
+    std::array<int, 2> minInd = { { -1, -1 } };
+    for (int t = 0; t < nthreads; t++)
+    {
+        r2max = std::max(r2max, threadR2max[t]);
+        if (threadMinInd[t][0] >= 0
+            && (threadR2min[t] < r2min || (threadR2min[t] == r2min && threadMinInd[t] < minInd)))
+        {
+            r2min  = threadR2min[t];
+            minInd = threadMinInd[t];
+        }
+    }
+    if (minInd[0] >= 0)
+    {
+        min_ind[0] = minInd[0];
+        min_ind[1] = minInd[1];
+    }
+
     *rmin = std::sqrt(r2min);
     *rmax = std::sqrt(r2max);
 }
@@ -216,6 +257,136 @@ static void periodic_mindist_plot(const char*             trxfn,
             index[ind_mini] + 1, index[ind_minj] + 1);
 }
 
+/*! \brief Minimum distance and contact count from a grid-based search
+ *
+ * Computes the minimum distance outputs of calc_dist() by searching the
+ * positions of \p index2 in the neighborhood of those of \p index1, in
+ * parallel over the positions of \p index2. The search cutoff starts at
+ * \p rcut and is doubled until a pair is found, so that also minimum
+ * distances beyond \p rcut are found.
+ */
+static void calc_mindist(real         rcut,
+                         const t_pbc* pbc,
+                         rvec         x[],
+                         int          nx1,
+                         int          nx2,
+                         const int    index1[],
+                         const int    index2[],
+                         gmx_bool     bGroup,
+                         real*        rmin,
+                         int*         nmin,
+                         int*         ixmin,
+                         int*         jxmin)
+{
+    /* No pair can be further apart than the diagonal of the bounding box */
+    rvec xlo, xhi, extent;
+    copy_rvec(x[index1[0]], xlo);
+    copy_rvec(x[index1[0]], xhi);
+    for (int g = 0; g < 2; g++)
+    {
+        const int* index = (g == 0 ? index1 : index2);
+        for (int i = 0; i < (g == 0 ? nx1 : nx2); i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                xlo[d] = std::min(xlo[d], x[index[i]][d]);
+                xhi[d] = std::max(xhi[d], x[index[i]][d]);
+            }
+        }
+    }
+    rvec_sub(xhi, xlo, extent);
+    const real maxDistance = norm(extent);
+    const real maxCutoff   = (pbc != nullptr ? std::sqrt(max_cutoff2(pbc->pbcType, pbc->box)) : 0);
+
+    const int                nthreads = gmx_omp_get_max_threads();
+    std::vector<real>        threadR2min(nthreads);
+    std::vector<int>         threadNmin(nthreads);
+    std::vector<int>         threadJmin(nthreads);
+    std::vector<int>         threadImin(nthreads);
+    gmx::ArrayRef<const int> refIndex(index1, index1 + nx1);
+    gmx::ArrayRef<const int> testIndex(index2, index2 + nx2);
+
+    real cutoff = rcut;
+    while (true)
+    {
+        /* Beyond the maximum cutoff for PBC, search all pairs instead */
+        const bool bAllPairs    = (cutoff <= 0 || (pbc != nullptr && cutoff >= maxCutoff));
+        const bool bFinalSearch = (bAllPairs || cutoff >= maxDistance);
+        /* The cutoff cannot be changed after initializing a search */
+        gmx::AnalysisNeighborhood nb;
+        nb.setCutoff(bAllPairs ? 0 : cutoff);
+        gmx::AnalysisNeighborhoodSearch search =
+                nb.initSearch(pbc, gmx::AnalysisNeighborhoodPositions(x, nx1).indexed(refIndex));
+        const real rcut2 = gmx::square(rcut);
+#pragma omp parallel num_threads(nthreads)
+        {
+            try
+            {
+                const int t    = gmx_omp_get_thread_num();
+                threadR2min[t] = GMX_REAL_MAX;
+                threadNmin[t]  = 0;
+                threadJmin[t]  = -1;
+                threadImin[t]  = -1;
+#pragma omp for schedule(dynamic, 64)
+                for (int j = 0; j < nx2; j++)
+                {
+                    gmx::AnalysisNeighborhoodPositions testPosition =
+                            gmx::AnalysisNeighborhoodPositions(x, nx2).indexed(testIndex);
+                    gmx::AnalysisNeighborhoodPairSearch pairSearch =
+                            search.startPairSearch(testPosition.selectSingleFromArray(j));
+                    gmx::AnalysisNeighborhoodPair pair;
+                    int                           nmin_j = 0;
+                    while (pairSearch.findNextPair(&pair))
+                    {
+                        const int i = pair.refIndex();
+                        if (index1[i] == index2[j])
+                        {
+                            continue;
+                        }
+                        const real r2 = pair.distance2();
+                        if (r2 < threadR2min[t])
+                        {
+                            threadR2min[t] = r2;
+                            threadImin[t]  = i;
+                            threadJmin[t]  = j;
+                        }
+                        if (r2 <= rcut2)
+                        {
+                            nmin_j++;
+                        }
+                    }
+                    threadNmin[t] += (bGroup ? (nmin_j > 0 ? 1 : 0) : nmin_j);
+                }
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+
+        real rmin2 = GMX_REAL_MAX;
+        int  imin = -1, jmin = -1;
+        *nmin     = 0;
+        for (int t = 0; t < nthreads; t++)
+        {
+            *nmin += threadNmin[t];
+            if (threadJmin[t] >= 0
+                && (threadR2min[t] < rmin2
+                    || (threadR2min[t] == rmin2 && threadJmin[t] < jmin)))
+            {
+                rmin2 = threadR2min[t];
+                imin  = threadImin[t];
+                jmin  = threadJmin[t];
+            }
+        }
+        if (jmin >= 0 || bFinalSearch)
+        {
+            *rmin  = (jmin >= 0 ? std::sqrt(rmin2) : std::sqrt(1e12));
+            *ixmin = (jmin >= 0 ? index1[imin] : -1);
+            *jxmin = (jmin >= 0 ? index2[jmin] : -1);
+            return;
+        }
+        cutoff *= 2;
+    }
+}
+
 static void calc_dist(real     rcut,
                       gmx_bool bPBC,
                       PbcType  pbcType,
@@ -226,6 +397,7 @@ static void calc_dist(real     rcut,
                       int      index1[],
                       int      index2[],
                       gmx_bool bGroup,
+                      gmx_bool bOnlyMin,
                       real*    rmin,
                       real*    rmax,
                       int*     nmin,
@@ -270,6 +442,16 @@ static void calc_dist(real     rcut,
     }
     GMX_RELEASE_ASSERT(index1 != nullptr, "Need a valid index for plotting distances");
 
+    /* Only the maximum distance requires looping over all pairs */
+    if (bOnlyMin && index2 != nullptr
+        && static_cast<int64_t>(nx1) * nx2 >= c_minNumPairsForGridSearch)
+    {
+        calc_mindist(rcut, bPBC ? &pbc : nullptr, x, nx1, nx2, index1, index2, bGroup, rmin, nmin,
+                     ixmin, jxmin);
+        *rmax = 0;
+        return;
+    }
+
     rmin2 = 1e12;
     rmax2 = -1e12;
 
@@ -499,7 +681,7 @@ static void dist_plot(const char*             fn,
             if (ng == 1)
             {
                 calc_dist(rcut, bPBC, pbcType, box, x0, gnx[0], gnx[0], index[0], index[0], bGroup,
-                          &dmin, &dmax, &nmin, &nmax, &min1, &min2, &max1, &max2);
+                          bMin, &dmin, &dmax, &nmin, &nmax, &min1, &min2, &max1, &max2);
                 fprintf(dist, "  %12e", bMin ? dmin : dmax);
                 if (num)
                 {
@@ -513,7 +695,8 @@ static void dist_plot(const char*             fn,
                     for (k = i + 1; (k < ng); k++)
                     {
                         calc_dist(rcut, bPBC, pbcType, box, x0, gnx[i], gnx[k], index[i], index[k],
-                                  bGroup, &dmin, &dmax, &nmin, &nmax, &min1, &min2, &max1, &max2);
+                                  bGroup, bMin, &dmin, &dmax, &nmin, &nmax, &min1, &min2, &max1,
+                                  &max2);
                         fprintf(dist, "  %12e", bMin ? dmin : dmax);
                         if (num)
                         {
@@ -529,7 +712,7 @@ static void dist_plot(const char*             fn,
             for (i = 1; (i < ng); i++)
             {
                 calc_dist(rcut, bPBC, pbcType, box, x0, gnx[0], gnx[i], index[0], index[i], bGroup,
-                          &dmin, &dmax, &nmin, &nmax, &min1, &min2, &max1, &max2);
+                          bMin, &dmin, &dmax, &nmin, &nmax, &min1, &min2, &max1, &max2);
                 fprintf(dist, "  %12e", bMin ? dmin : dmax);
                 if (num)
                 {
@@ -539,9 +722,9 @@ static void dist_plot(const char*             fn,
                 {
                     for (j = 0; j < nres; j++)
                     {
-                        calc_dist(rcut, bPBC, pbcType, box, x0, residue[j + 1] - residue[j], gnx[i],
-                                  &(index[0][residue[j]]), index[i], bGroup, &dmin, &dmax, &nmin,
-                                  &nmax, &min1r, &min2r, &max1r, &max2r);
+                        calc_dist(rcut, bPBC, pbcType, box, x0, residue[j + 1] - residue[j],
+                                  gnx[i], &(index[0][residue[j]]), index[i], bGroup, bMin, &dmin,
+                                  &dmax, &nmin, &nmax, &min1r, &min2r, &max1r, &max2r);
                         mindres[i - 1][j] = std::min(mindres[i - 1][j], dmin);
                         maxdres[i - 1][j] = std::max(maxdres[i - 1][j], dmax);
                     }
@@ -713,6 +896,7 @@ int gmx_mindist(int argc, char* argv[])
     real     rcutoff          = 0.6;
     int      ng               = 1;
     gmx_bool bEachResEachTime = FALSE, bPrintResName = FALSE;
+    int      nthreads         = -1;
     t_pargs  pa[] = {
         { "-matrix", FALSE, etBOOL, { &bMat }, "Calculate half a matrix of group-group distances" },
         { "-max", FALSE, etBOOL, { &bMax }, "Calculate *maximum* distance instead of minimum" },
@@ -735,7 +919,8 @@ int gmx_mindist(int argc, char* argv[])
           etBOOL,
           { &bEachResEachTime },
           "When writing per-residue distances, write distance for each time point" },
-        { "-printresname", FALSE, etBOOL, { &bPrintResName }, "Write residue names" }
+        { "-printresname", FALSE, etBOOL, { &bPrintResName }, "Write residue names" },
+        { "-nt", FALSE, etINT, { &nthreads }, "Number of threads to start" }
     };
     gmx_output_env_t* oenv;
     t_topology*       top     = nullptr;
@@ -755,12 +940,16 @@ int gmx_mindist(int argc, char* argv[])
                        { efTRO, "-ox", "mindist", ffOPTWR }, { efXVG, "-or", "mindistres", ffOPTWR } };
 #define NFILE asize(fnm)
 
+    nthreads = gmx_omp_get_max_threads();
+
     if (!parse_common_args(&argc, argv, PCA_CAN_VIEW | PCA_CAN_TIME | PCA_TIME_UNIT, NFILE, fnm,
                            asize(pa), pa, asize(desc), desc, 0, nullptr, &oenv))
     {
         return 0;
     }
 
+    gmx_omp_set_num_threads(nthreads);
+
     trxfnm  = ftp2fn(efTRX, NFILE, fnm);
     ndxfnm  = ftp2fn_null(efNDX, NFILE, fnm);
     distfnm = opt2fn("-od", NFILE, fnm);
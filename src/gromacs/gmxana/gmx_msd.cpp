@@ -59,8 +59,10 @@
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 static constexpr double diffusionConversionFactor = 1000.0; /* Convert nm^2/ps to 10e-5 cm^2/s */
@@ -238,11 +240,6 @@ static void corr_print(t_corr*                 curr,
 static void
 calc_corr(t_corr* curr, int nr, int nx, int index[], rvec xc[], gmx_bool bRmCOMM, rvec com, t_calc_func* calc1, gmx_bool bTen)
 {
-    int    nx0;
-    real   g;
-    matrix mat;
-    rvec   dcom;
-
     /* Check for new starting point */
     if (curr->nlast < curr->nrestart)
     {
@@ -257,27 +254,39 @@ calc_corr(t_corr* curr, int nr, int nx, int index[], rvec xc[], gmx_bool bRmCOMM
 
     /* nx0 appears to be the number of new starting points,
      * so for all starting points, call calc1.
+     * Each starting point accumulates into a different time lag (and
+     * into its own per-molecule statistics), so the starting points can
+     * be processed in parallel without changing the results.
      */
-    for (nx0 = 0; (nx0 < curr->nlast); nx0++)
+    const int nlast = curr->nlast;
+#pragma omp parallel for schedule(static)
+    for (int nx0 = 0; nx0 < nlast; nx0++)
     {
-        if (bRmCOMM)
-        {
-            rvec_sub(com, curr->com[nx0], dcom);
-        }
-        else
+        try
         {
-            clear_rvec(dcom);
-        }
-        g = calc1(curr, nx, index, nx0, xc, dcom, bTen, mat);
+            matrix mat;
+            rvec   dcom;
+            if (bRmCOMM)
+            {
+                rvec_sub(com, curr->com[nx0], dcom);
+            }
+            else
+            {
+                clear_rvec(dcom);
+            }
+            const real g = calc1(curr, nx, index, nx0, xc, dcom, bTen, mat);
 #ifdef DEBUG2
-        printf("g[%d]=%g\n", nx0, g);
+            printf("g[%d]=%g\n", nx0, g);
 #endif
-        curr->data[nr][in_data(curr, nx0)] += g;
-        if (bTen)
-        {
-            m_add(curr->datam[nr][in_data(curr, nx0)], mat, curr->datam[nr][in_data(curr, nx0)]);
+            const int lag = in_data(curr, nx0);
+            curr->data[nr][lag] += g;
+            if (bTen)
+            {
+                m_add(curr->datam[nr][lag], mat, curr->datam[nr][lag]);
+            }
+            curr->ndata[nr][lag]++;
         }
-        curr->ndata[nr][in_data(curr, nx0)]++;
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 }
 
@@ -1111,6 +1120,7 @@ int gmx_msd(int argc, char* argv[])
     static gmx_bool    bTen       = FALSE;
     static gmx_bool    bMW        = TRUE;
     static gmx_bool    bRmCOMM    = FALSE;
+    static int         nthreads   = -1;
     t_pargs            pa[]       = {
         { "-type", FALSE, etENUM, { normtype }, "Compute diffusion coefficient in one direction" },
         { "-lateral",
@@ -1129,7 +1139,8 @@ int gmx_msd(int argc, char* argv[])
           etTIME,
           { &beginfit },
           "Start time for fitting the MSD (%t), -1 is 10%" },
-        { "-endfit", FALSE, etTIME, { &endfit }, "End time for fitting the MSD (%t), -1 is 90%" }
+        { "-endfit", FALSE, etTIME, { &endfit }, "End time for fitting the MSD (%t), -1 is 90%" },
+        { "-nt", FALSE, etINT, { &nthreads }, "Number of threads to start" }
     };
 
     t_filenm fnm[] = {
@@ -1149,11 +1160,14 @@ int gmx_msd(int argc, char* argv[])
     real              dim_factor;
     gmx_output_env_t* oenv;
 
+    nthreads = gmx_omp_get_max_threads();
+
     if (!parse_common_args(&argc, argv, PCA_CAN_VIEW | PCA_CAN_BEGIN | PCA_CAN_END | PCA_TIME_UNIT,
                            NFILE, fnm, asize(pa), pa, asize(desc), desc, 0, nullptr, &oenv))
     {
         return 0;
     }
+    gmx_omp_set_num_threads(nthreads);
     trx_file = ftp2fn_null(efTRX, NFILE, fnm);
     tps_file = ftp2fn_null(efTPS, NFILE, fnm);
     ndx_file = ftp2fn_null(efNDX, NFILE, fnm);
@@ -41,11 +41,14 @@
 #include <cmath>
 #include <cstring>
 
+#include <algorithm>
+
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
 #include "gromacs/fileio/trxio.h"
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/gmxana/gmx_ana.h"
+#include "gromacs/gmxana/gridaccumulator.h"
 #include "gromacs/gmxana/princ.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/utilities.h"
@@ -53,10 +56,12 @@
 #include "gromacs/pbcutil/rmpbc.h"
 #include "gromacs/topology/index.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 #define EPS0 8.85419E-12
@@ -116,19 +121,18 @@ static void calc_potential(const char*             fn,
                            double                  fudge_z,
                            gmx_bool                bSpherical,
                            gmx_bool                bCorrect,
+                           int                     nthreads,
                            const gmx_output_env_t* oenv)
 {
     rvec*        x0;     /* coordinates without pbc */
     matrix       box;    /* box (3x3) */
     int          natoms; /* nr. atoms in trj */
     t_trxstatus* status;
-    int          i, n,                                   /* loop indices */
-            teller = 0, ax1 = 0, ax2 = 0, nr_frames = 0, /* number of frames */
-            slice;                                       /* current slice */
+    int          i, n,                                  /* loop indices */
+            teller = 0, ax1 = 0, ax2 = 0, nr_frames = 0; /* number of frames */
     double      slVolume; /* volume of slice for spherical averaging */
     double      qsum, nn;
     real        t;
-    double      z;
     rvec        xcm;
     gmx_rmpbc_t gpbc = nullptr;
 
@@ -171,6 +175,8 @@ static void calc_potential(const char*             fn,
         snew((*slPotential)[i], *nslices);
     }
 
+    gmx::GridAccumulator accumulator(nr_grps, *nslices, nthreads);
+
 
     gpbc = gmx_rmpbc_init(&top->idef, pbcType, natoms);
 
@@ -196,41 +202,40 @@ static void calc_potential(const char*             fn,
                           "were found in the trajectory.\n",
                           gnx[n], natoms);
             }
-            for (i = 0; i < gnx[n]; i++) /* loop over all atoms in index file */
-            {
+            const int* groupIndex = index[n];
+            const real boxLength  = box[axis][axis];
+            const real width      = *slWidth;
+            const int  numSlices  = *nslices;
+            accumulator.accumulate(n, gnx[n], [&](int i, real* weight) {
+                int slice;
                 if (bSpherical)
                 {
-                    rvec_add(x0[index[n][i]], xcm, x0[index[n][i]]);
+                    rvec x;
+                    rvec_add(x0[groupIndex[i]], xcm, x);
                     /* only distance from origin counts, not sign */
-                    slice = static_cast<int>(norm(x0[index[n][i]]) / (*slWidth));
-
-                    /* this is a nice check for spherical groups but not for
-                       all water in a cubic box since a lot will fall outside
-                       the sphere
-                       if (slice > (*nslices))
-                       {
-                       fprintf(stderr,"Warning: slice = %d\n",slice);
-                       }
-                     */
-                    (*slCharge)[n][slice] += top->atoms.atom[index[n][i]].q;
+                    slice = static_cast<int>(norm(x) / width);
                 }
                 else
                 {
-                    z = x0[index[n][i]][axis];
-                    z = z + fudge_z;
+                    double z = x0[groupIndex[i]][axis];
+                    z        = z + fudge_z;
                     if (z < 0)
                     {
-                        z += box[axis][axis];
+                        z += boxLength;
                     }
-                    if (z > box[axis][axis])
+                    if (z > boxLength)
                     {
-                        z -= box[axis][axis];
+                        z -= boxLength;
                     }
                     /* determine which slice atom is in */
-                    slice = static_cast<int>((z / (*slWidth)));
-                    (*slCharge)[n][slice] += top->atoms.atom[index[n][i]].q;
+                    slice = static_cast<int>((z / width));
                 }
-            }
+                /* With spherical slices, a lot of e.g. water in a cubic box
+                   falls outside the sphere
+                 */
+                *weight = top->atoms.atom[groupIndex[i]].q;
+                return (slice >= 0 && slice < numSlices) ? slice : -1;
+            });
         }
         nr_frames++;
     } while (read_next_x(oenv, status, &t, x0, box));
@@ -240,6 +245,13 @@ static void calc_potential(const char*             fn,
     /*********** done with status file **********/
     close_trx(status);
 
+    accumulator.reduce();
+    for (n = 0; n < nr_grps; n++)
+    {
+        gmx::ArrayRef<const double> grid = accumulator.grid(n);
+        std::copy(grid.begin(), grid.end(), (*slCharge)[n]);
+    }
+
     /* slCharge now contains the total charge per slice, summed over all
        frames. Now divide by nr_frames and integrate twice
      */
@@ -441,6 +453,7 @@ int gmx_potential(int argc, char* argv[])
     static gmx_bool    bSpherical = FALSE; /* default is bilayer types   */
     static real        fudge_z    = 0;     /* translate coordinates      */
     static gmx_bool    bCorrect   = false;
+    static int         nthreads   = -1;
     t_pargs            pa[]       = {
         { "-d",
           FALSE,
@@ -474,7 +487,8 @@ int gmx_potential(int argc, char* argv[])
           FALSE,
           etBOOL,
           { &bCorrect },
-          "Assume net zero charge of groups to improve accuracy" }
+          "Assume net zero charge of groups to improve accuracy" },
+        { "-nt", FALSE, etINT, { &nthreads }, "Number of threads to start" }
     };
     const char* bugs[] = { "Discarding slices for integration should not be necessary." };
 
@@ -499,12 +513,16 @@ int gmx_potential(int argc, char* argv[])
 
 #define NFILE asize(fnm)
 
+    nthreads = gmx_omp_get_max_threads();
+
     if (!parse_common_args(&argc, argv, PCA_CAN_VIEW | PCA_CAN_TIME, NFILE, fnm, asize(pa), pa,
                            asize(desc), desc, asize(bugs), bugs, &oenv))
     {
         return 0;
     }
 
+    gmx_omp_set_num_threads(nthreads);
+
     /* Calculate axis */
     axis = toupper(axtitle[0]) - 'X';
 
@@ -518,7 +536,8 @@ int gmx_potential(int argc, char* argv[])
 
 
     calc_potential(ftp2fn(efTRX, NFILE, fnm), index, ngx, &potential, &charge, &field, &nslices,
-                   top, pbcType, axis, ngrps, &slWidth, fudge_z, bSpherical, bCorrect, oenv);
+                   top, pbcType, axis, ngrps, &slWidth, fudge_z, bSpherical, bCorrect, nthreads,
+                   oenv);
 
     plot_potential(potential, charge, field, opt2fn("-o", NFILE, fnm), opt2fn("-oc", NFILE, fnm),
                    opt2fn("-of", NFILE, fnm), nslices, ngrps, grpname, slWidth, oenv);
@@ -39,19 +39,24 @@
 #include <cmath>
 #include <cstdlib>
 
+#include <algorithm>
+
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/confio.h"
 #include "gromacs/fileio/trxio.h"
 #include "gromacs/gmxana/gmx_ana.h"
+#include "gromacs/gmxana/gridaccumulator.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pbcutil/rmpbc.h"
 #include "gromacs/topology/index.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 static const double bohr =
@@ -127,6 +132,7 @@ int gmx_spatial(int argc, char* argv[])
     static real     rBINWIDTH    = 0.05; /* nm */
     static gmx_bool bCALCDIV     = TRUE;
     static int      iNAB         = 4;
+    static int      nthreads     = -1;
 
     t_pargs pa[] = { { "-pbc",
                        FALSE,
@@ -153,7 +159,8 @@ int gmx_spatial(int argc, char* argv[])
                        FALSE,
                        etINT,
                        { &iNAB },
-                       "Number of additional bins to ensure proper memory allocation" } };
+                       "Number of additional bins to ensure proper memory allocation" },
+                     { "-nt", FALSE, etINT, { &nthreads }, "Number of threads to start" } };
 
     double            MINBIN[3];
     double            MAXBIN[3];
@@ -190,11 +197,13 @@ int gmx_spatial(int argc, char* argv[])
 
     /* This is the routine responsible for adding default options,
      * calling the X/motif interface, etc. */
+    nthreads = gmx_omp_get_max_threads();
     if (!parse_common_args(&argc, argv, PCA_CAN_TIME | PCA_CAN_VIEW, NFILE, fnm, asize(pa), pa,
                            asize(desc), desc, asize(bugs), bugs, &oenv))
     {
         return 0;
     }
+    gmx_omp_set_num_threads(nthreads);
 
     read_tps_conf(ftp2fn(efTPS, NFILE, fnm), &top, &pbcType, &xtop, nullptr, box, TRUE);
     sfree(xtop);
@@ -255,6 +264,7 @@ int gmx_spatial(int argc, char* argv[])
             snew(bin[i][j], nbin[ZZ]);
         }
     }
+    gmx::GridAccumulator accumulator(1, nbin[XX] * nbin[YY] * nbin[ZZ], nthreads);
     copy_mat(box, box_pbc);
     numfr = 0;
     minx = miny = minz = 999;
@@ -290,35 +300,15 @@ int gmx_spatial(int argc, char* argv[])
                        fr.x[index[i]][YY], fr.x[index[i]][ZZ]);
                 exit(1);
             }
-            x = static_cast<int>(std::ceil((fr.x[index[i]][XX] - MINBIN[XX]) / rBINWIDTH));
-            y = static_cast<int>(std::ceil((fr.x[index[i]][YY] - MINBIN[YY]) / rBINWIDTH));
-            z = static_cast<int>(std::ceil((fr.x[index[i]][ZZ] - MINBIN[ZZ]) / rBINWIDTH));
-            ++bin[x][y][z];
-            if (x < minx)
-            {
-                minx = x;
-            }
-            if (x > maxx)
-            {
-                maxx = x;
-            }
-            if (y < miny)
-            {
-                miny = y;
-            }
-            if (y > maxy)
-            {
-                maxy = y;
-            }
-            if (z < minz)
-            {
-                minz = z;
-            }
-            if (z > maxz)
-            {
-                maxz = z;
-            }
         }
+        accumulator.accumulate(0, nidx, [&](int i, real* weight) {
+            const rvec& xi = fr.x[index[i]];
+            const int   ix = static_cast<int>(std::ceil((xi[XX] - MINBIN[XX]) / rBINWIDTH));
+            const int   iy = static_cast<int>(std::ceil((xi[YY] - MINBIN[YY]) / rBINWIDTH));
+            const int   iz = static_cast<int>(std::ceil((xi[ZZ] - MINBIN[ZZ]) / rBINWIDTH));
+            *weight        = 1;
+            return (ix * nbin[YY] + iy) * nbin[ZZ] + iz;
+        });
         numfr++;
         /* printf("%f\t%f\t%f\n",box[XX][XX],box[YY][YY],box[ZZ][ZZ]); */
 
@@ -329,6 +319,30 @@ int gmx_spatial(int argc, char* argv[])
         gmx_rmpbc_done(gpbc);
     }
 
+    /* Store the counts and find the range of occupied bins */
+    accumulator.reduce();
+    gmx::ArrayRef<const double> binSum = accumulator.grid(0);
+    for (x = 0; x < nbin[XX]; x++)
+    {
+        for (y = 0; y < nbin[YY]; y++)
+        {
+            for (z = 0; z < nbin[ZZ]; z++)
+            {
+                bin[x][y][z] = static_cast<int>(binSum[(x * nbin[YY] + y) * nbin[ZZ] + z]);
+                if (bin[x][y][z] == 0)
+                {
+                    continue;
+                }
+                minx = std::min(minx, x);
+                maxx = std::max(maxx, x);
+                miny = std::min(miny, y);
+                maxy = std::max(maxy, y);
+                minz = std::min(minz, z);
+                maxz = std::max(maxz, z);
+            }
+        }
+    }
+
     if (!bCUTDOWN)
     {
         minx = miny = minz = 0;
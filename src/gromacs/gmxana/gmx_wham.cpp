@@ -54,6 +54,7 @@
 
 #include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/tpxio.h"
@@ -850,6 +851,89 @@ static double tabulated_pot(double dist, t_UmbrellaOptions* opt)
 }
 
 
+/*! \brief
+ * Boltzmann factors exp(-U/kT) of all umbrella potentials, tabulated for all bins.
+ *
+ * The factors only depend on the umbrella positions and the bins, not on the
+ * free energy offsets, so they are computed once per WHAM solve instead of in
+ * every iteration of calc_profile() and calc_z().
+ */
+struct BoltzmannFactorTable
+{
+    //! Index of the first pull coordinate of each window.
+    std::vector<int> windowOffset;
+    //! The factors, opt->bins consecutive values for each pull coordinate.
+    std::vector<double> factors;
+    //! Number of bins.
+    int bins = 0;
+
+    //! Returns the factors for all bins of pull coordinate \p pull in window \p win.
+    const double* get(int win, int pull) const
+    {
+        return factors.data() + static_cast<size_t>(windowOffset[win] + pull) * bins;
+    }
+};
+
+//! Computes the Boltzmann factors of the umbrella potentials of all windows.
+static BoltzmannFactorTable tabulateBoltzmannFactors(const t_UmbrellaWindow* window,
+                                                     int                     nWindows,
+                                                     t_UmbrellaOptions*      opt)
+{
+    const double         min = opt->min, dz = opt->dz;
+    const double         ztot = opt->max - opt->min, ztot_half = ztot / 2;
+    BoltzmannFactorTable table;
+    table.bins = opt->bins;
+    table.windowOffset.resize(nWindows);
+    int nPullTot = 0;
+    for (int i = 0; i < nWindows; ++i)
+    {
+        table.windowOffset[i] = nPullTot;
+        nPullTot += window[i].nPull;
+    }
+    table.factors.resize(static_cast<size_t>(nPullTot) * opt->bins);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < nWindows; ++i)
+    {
+        try
+        {
+            for (int j = 0; j < window[i].nPull; ++j)
+            {
+                double* factors = table.factors.data()
+                                  + static_cast<size_t>(table.windowOffset[i] + j) * opt->bins;
+                for (int k = 0; k < opt->bins; ++k)
+                {
+                    const double temp     = (1.0 * k + 0.5) * dz + min;
+                    /* distance to umbrella center */
+                    double distance = temp - window[i].pos[j];
+                    if (opt->bCycl)
+                    {                             /* in cyclic wham:             */
+                        if (distance > ztot_half) /*    |distance| < ztot_half   */
+                        {
+                            distance -= ztot;
+                        }
+                        else if (distance < -ztot_half)
+                        {
+                            distance += ztot;
+                        }
+                    }
+                    double U;
+                    if (!opt->bTab)
+                    {
+                        U = 0.5 * window[i].k[j] * gmx::square(distance); /* harmonic potential */
+                    }
+                    else
+                    {
+                        U = tabulated_pot(distance, opt); /* Use tabulated potential     */
+                    }
+                    factors[k] = std::exp(-U / (BOLTZ * opt->Temperature));
+                }
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+    return table;
+}
+
 /*! \brief
  * Check which bins substiantially contribute (accelerates WHAM)
  *
@@ -957,12 +1041,22 @@ static void setup_acc_wham(const double* profile, t_UmbrellaWindow* window, int
 }
 
 //! Compute the PMF (one of the two main WHAM routines)
-static void calc_profile(double* profile, t_UmbrellaWindow* window, int nWindows, t_UmbrellaOptions* opt, gmx_bool bExact)
+static void calc_profile(double*                     profile,
+                         t_UmbrellaWindow*           window,
+                         int                         nWindows,
+                         t_UmbrellaOptions*          opt,
+                         gmx_bool                    bExact,
+                         const BoltzmannFactorTable& boltzmann)
 {
-    double ztot_half, ztot, min = opt->min, dz = opt->dz;
-
-    ztot      = opt->max - opt->min;
-    ztot_half = ztot / 2;
+    /* exp(z) of each pull coordinate, in the same order as in boltzmann */
+    std::vector<double> expZ(boltzmann.factors.size() / opt->bins);
+    for (int j = 0; j < nWindows; ++j)
+    {
+        for (int k = 0; k < window[j].nPull; ++k)
+        {
+            expZ[boltzmann.windowOffset[j] + k] = std::exp(window[j].z[k]);
+        }
+    }
 
 #pragma omp parallel
     {
@@ -977,43 +1071,21 @@ static void calc_profile(double* profile, t_UmbrellaWindow* window, int nWindows
             for (i = i0; i < i1; ++i)
             {
                 int    j, k;
-                double num, denom, invg, temp = 0, distance, U = 0;
+                double num, denom, invg;
                 num = denom = 0.;
                 for (j = 0; j < nWindows; ++j)
                 {
                     for (k = 0; k < window[j].nPull; ++k)
                     {
                         invg = 1.0 / window[j].g[k] * window[j].bsWeight[k];
-                        temp = (1.0 * i + 0.5) * dz + min;
                         num += invg * window[j].Histo[k][i];
 
                         if (!(bExact || window[j].bContrib[k][i]))
                         {
                             continue;
                         }
-                        distance = temp - window[j].pos[k]; /* distance to umbrella center */
-                        if (opt->bCycl)
-                        {                             /* in cyclic wham:             */
-                            if (distance > ztot_half) /*    |distance| < ztot_half   */
-                            {
-                                distance -= ztot;
-                            }
-                            else if (distance < -ztot_half)
-                            {
-                                distance += ztot;
-                            }
-                        }
-
-                        if (!opt->bTab)
-                        {
-                            U = 0.5 * window[j].k[k] * gmx::square(distance); /* harmonic potential assumed. */
-                        }
-                        else
-                        {
-                            U = tabulated_pot(distance, opt); /* Use tabulated potential     */
-                        }
-                        denom += invg * window[j].N[k]
-                                 * std::exp(-U / (BOLTZ * opt->Temperature) + window[j].z[k]);
+                        denom += invg * window[j].N[k] * boltzmann.get(j, k)[i]
+                                 * expZ[boltzmann.windowOffset[j] + k];
                     }
                 }
                 profile[i] = num / denom;
@@ -1024,14 +1096,15 @@ static void calc_profile(double* profile, t_UmbrellaWindow* window, int nWindows
 }
 
 //! Compute the free energy offsets z (one of the two main WHAM routines)
-static double calc_z(const double* profile, t_UmbrellaWindow* window, int nWindows, t_UmbrellaOptions* opt, gmx_bool bExact)
+static double calc_z(const double*               profile,
+                     t_UmbrellaWindow*           window,
+                     int                         nWindows,
+                     t_UmbrellaOptions*          opt,
+                     gmx_bool                    bExact,
+                     const BoltzmannFactorTable& boltzmann)
 {
-    double min = opt->min, dz = opt->dz, ztot_half, ztot;
     double maxglob = -1e20;
 
-    ztot      = opt->max - opt->min;
-    ztot_half = ztot / 2;
-
 #pragma omp parallel
     {
         try
@@ -1045,41 +1118,20 @@ static double calc_z(const double* profile, t_UmbrellaWindow* window, int nWindo
 
             for (i = i0; i < i1; ++i)
             {
-                double total = 0, temp, distance, U = 0;
+                double total = 0, temp;
                 int    j, k;
 
                 for (j = 0; j < window[i].nPull; ++j)
                 {
-                    total = 0;
+                    const double* factors = boltzmann.get(i, j);
+                    total                 = 0;
                     for (k = 0; k < window[i].nBin; ++k)
                     {
                         if (!(bExact || window[i].bContrib[j][k]))
                         {
                             continue;
                         }
-                        temp     = (1.0 * k + 0.5) * dz + min;
-                        distance = temp - window[i].pos[j]; /* distance to umbrella center */
-                        if (opt->bCycl)
-                        {                             /* in cyclic wham:             */
-                            if (distance > ztot_half) /*    |distance| < ztot_half   */
-                            {
-                                distance -= ztot;
-                            }
-                            else if (distance < -ztot_half)
-                            {
-                                distance += ztot;
-                            }
-                        }
-
-                        if (!opt->bTab)
-                        {
-                            U = 0.5 * window[i].k[j] * gmx::square(distance); /* harmonic potential assumed. */
-                        }
-                        else
-                        {
-                            U = tabulated_pot(distance, opt); /* Use tabulated potential     */
-                        }
-                        total += profile[k] * std::exp(-U / (BOLTZ * opt->Temperature));
+                        total += profile[k] * factors[k];
                     }
                     /* Avoid floating point exception if window is far outside min and max */
                     if (total != 0.0)
@@ -1735,6 +1787,7 @@ static void do_bootstrapping(const char*        fnres,
         bExact    = FALSE;
         maxchange = 1e20;
         std::memcpy(bsProfile, profile, opt->bins * sizeof(double)); /* use profile as guess */
+        const BoltzmannFactorTable boltzmann = tabulateBoltzmannFactors(synthWindow, nAllPull, opt);
         do
         {
             if ((i % opt->stepUpdateContrib) == 0)
@@ -1749,9 +1802,10 @@ static void do_bootstrapping(const char*        fnres,
             {
                 printf("\t%4d) Maximum change %e\n", i, maxchange);
             }
-            calc_profile(bsProfile, synthWindow, nAllPull, opt, bExact);
+            calc_profile(bsProfile, synthWindow, nAllPull, opt, bExact, boltzmann);
             i++;
-        } while ((maxchange = calc_z(bsProfile, synthWindow, nAllPull, opt, bExact)) > opt->Tolerance
+        } while ((maxchange = calc_z(bsProfile, synthWindow, nAllPull, opt, bExact, boltzmann))
+                         > opt->Tolerance
                  || !bExact);
         printf("\tConverged in %d iterations. Final maximum change %g\n", i, maxchange);
 
@@ -3168,7 +3222,7 @@ static void guessPotByIntegration(t_UmbrellaWindow* window, int nWindows, t_Umbr
     {
         pot[j] = std::exp(-pot[j] / (BOLTZ * opt->Temperature));
     }
-    calc_z(pot, window, nWindows, opt, TRUE);
+    calc_z(pot, window, nWindows, opt, TRUE, tabulateBoltzmannFactors(window, nWindows, opt));
 
     sfree(pot);
     sfree(f);
@@ -3802,7 +3856,8 @@ int gmx_wham(int argc, char* argv[])
     {
         opt.stepchange = 1;
     }
-    i = 0;
+    const BoltzmannFactorTable boltzmann = tabulateBoltzmannFactors(window, nwins, &opt);
+    i                                    = 0;
     do
     {
         if ((i % opt.stepUpdateContrib) == 0)
@@ -3815,13 +3870,14 @@ int gmx_wham(int argc, char* argv[])
             /* if (opt.verbose) */
             printf("Switched to exact iteration in iteration %d\n", i);
         }
-        calc_profile(profile, window, nwins, &opt, bExact);
+        calc_profile(profile, window, nwins, &opt, bExact, boltzmann);
         if (((i % opt.stepchange) == 0 || i == 1) && i != 0)
         {
             printf("\t%4d) Maximum change %e\n", i, maxchange);
         }
         i++;
-    } while ((maxchange = calc_z(profile, window, nwins, &opt, bExact)) > opt.Tolerance || !bExact);
+    } while ((maxchange = calc_z(profile, window, nwins, &opt, bExact, boltzmann)) > opt.Tolerance
+             || !bExact);
     printf("Converged in %d iterations. Final maximum change %g\n", i, maxchange);
 
     /* calc error from Kumar's formula */
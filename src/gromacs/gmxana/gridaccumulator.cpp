@@ -0,0 +1,123 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements GridAccumulator.
+ */
+#include "gmxpre.h"
+
+#include "gridaccumulator.h"
+
+#include <cmath>
+
+#include "gromacs/math/functions.h"
+#include "gromacs/math/gausstransform.h"
+
+namespace gmx
+{
+
+GridAccumulator::GridAccumulator(int numGrids, int gridSize, int numThreads) :
+    numGrids_(numGrids),
+    gridSize_(gridSize),
+    numThreads_(std::max(numThreads, 1)),
+    threadGrids_(numThreads_)
+{
+    for (auto& threadGrid : threadGrids_)
+    {
+        threadGrid.resize(static_cast<size_t>(numGrids_) * gridSize_, 0.0);
+    }
+}
+
+GridAccumulator::~GridAccumulator() = default;
+
+void GridAccumulator::setGaussianSpreading(real sigma)
+{
+    GMX_RELEASE_ASSERT(sigma > 0, "The Gaussian width should be positive");
+    // Four standard deviations cover all but 6e-5 of the Gaussian
+    const int halfWidth = static_cast<int>(std::ceil(4 * sigma));
+    spreaders_.clear();
+    for (int thread = 0; thread < numThreads_; thread++)
+    {
+        spreaders_.push_back(std::make_unique<GaussianOn1DLattice>(halfWidth, sigma));
+    }
+}
+
+void GridAccumulator::spreadPoint(int thread, double* gridData, real coordinate, real weight)
+{
+    // Lattice point b is the center of bin b
+    const real           latticeCoordinate = coordinate - 0.5;
+    const int            nearest           = roundToInt(latticeCoordinate);
+    GaussianOn1DLattice& spreader          = *spreaders_[thread];
+    spreader.spread(weight, latticeCoordinate - nearest);
+    ArrayRef<const float> values    = spreader.view();
+    const int             halfWidth = (values.ssize() - 1) / 2;
+    int                   bin       = (nearest - halfWidth) % gridSize_;
+    if (bin < 0)
+    {
+        bin += gridSize_;
+    }
+    for (const float value : values)
+    {
+        gridData[bin] += value;
+        if (++bin == gridSize_)
+        {
+            bin = 0;
+        }
+    }
+}
+
+void GridAccumulator::reduce()
+{
+    const int numThreads = numThreads_;
+    const int totalSize  = numGrids_ * gridSize_;
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int i = 0; i < totalSize; i++)
+    {
+        double sum = threadGrids_[0][i];
+        for (int thread = 1; thread < numThreads; thread++)
+        {
+            sum += threadGrids_[thread][i];
+            threadGrids_[thread][i] = 0;
+        }
+        threadGrids_[0][i] = sum;
+    }
+}
+
+ArrayRef<double> GridAccumulator::grid(int grid)
+{
+    return { threadGrid(0, grid), threadGrid(0, grid) + gridSize_ };
+}
+
+} // namespace gmx
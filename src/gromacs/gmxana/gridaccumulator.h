@@ -0,0 +1,201 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Declares a multithreaded accumulator of weighted points on regular grids,
+ * shared by the density analysis tools.
+ */
+#ifndef GMXANA_GRIDACCUMULATOR_H
+#define GMXANA_GRIDACCUMULATOR_H
+
+#include <cstdint>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+class GaussianOn1DLattice;
+
+/*! \internal \brief
+ * Accumulates weighted points on one or more grids of equal size using threads.
+ *
+ * Each thread accumulates into its own copy of the grids, so that no
+ * synchronization is needed while adding points, and the copies are summed
+ * only once, by reduce(), after all frames have been processed.  The grids
+ * are stored flat, so it is up to the caller to map two- or
+ * three-dimensional bins to a single index.
+ *
+ * Points are processed in blocks: first the bins of a whole block are
+ * computed, which the compiler can vectorize since the caller-provided
+ * binning function is inlined, and then the weights of the block are
+ * added to the grid.
+ */
+class GridAccumulator
+{
+public:
+    /*! \brief Creates zeroed grids.
+     *
+     * \param[in] numGrids   Number of separate grids (e.g. one per group).
+     * \param[in] gridSize   Number of bins in each grid.
+     * \param[in] numThreads Number of OpenMP threads to accumulate with.
+     */
+    GridAccumulator(int numGrids, int gridSize, int numThreads);
+    ~GridAccumulator();
+
+    /*! \brief Turns on Gaussian spreading for spread().
+     *
+     * \param[in] sigma Gaussian width in units of the bin width.
+     */
+    void setGaussianSpreading(real sigma);
+    //! Whether setGaussianSpreading() has been called.
+    bool hasGaussianSpreading() const { return !spreaders_.empty(); }
+
+    /*! \brief Adds \p numPoints points to grid \p grid.
+     *
+     * \p binFunction is called as `int binFunction(int i, real* weight)`
+     * for each point index i and returns the bin of the point
+     * (or -1 to skip it) and sets its weight.  It is called concurrently
+     * from several threads.
+     */
+    template<typename BinFunction>
+    void accumulate(int grid, int numPoints, BinFunction binFunction);
+
+    /*! \brief Spreads \p numPoints points with a Gaussian along a periodic
+     * one-dimensional grid \p grid.
+     *
+     * \p coordinateFunction is called as
+     * `real coordinateFunction(int i, real* weight)` and returns the
+     * coordinate of point i in units of the bin width, such that bin b
+     * covers [b, b+1), and sets its weight.  It is called concurrently
+     * from several threads.  Requires setGaussianSpreading().
+     */
+    template<typename CoordinateFunction>
+    void spread(int grid, int numPoints, CoordinateFunction coordinateFunction);
+
+    //! Sums the per-thread grids, must be called before grid().
+    void reduce();
+    //! Returns the accumulated values of grid \p grid after reduce().
+    ArrayRef<double> grid(int grid);
+
+private:
+    //! Returns the copy of grid \p grid that belongs to thread \p thread.
+    double* threadGrid(int thread, int grid)
+    {
+        return threadGrids_[thread].data() + static_cast<size_t>(grid) * gridSize_;
+    }
+    //! Spreads one point with the spreader of thread \p thread.
+    void spreadPoint(int thread, double* gridData, real coordinate, real weight);
+
+    //! Number of points for which bins are computed at once.
+    static constexpr int c_blockSize = 256;
+
+    int numGrids_;
+    int gridSize_;
+    int numThreads_;
+    //! Grid data for each thread, the first one holds the sum after reduce().
+    std::vector<std::vector<double>> threadGrids_;
+    //! Gaussian spreader for each thread, empty without spreading.
+    std::vector<std::unique_ptr<GaussianOn1DLattice>> spreaders_;
+};
+
+template<typename BinFunction>
+void GridAccumulator::accumulate(int grid, int numPoints, BinFunction binFunction)
+{
+    const int numThreads = numThreads_;
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            double*   gridData = threadGrid(thread, grid);
+            const int begin    = (numPoints * static_cast<int64_t>(thread)) / numThreads;
+            const int end      = (numPoints * static_cast<int64_t>(thread + 1)) / numThreads;
+            int       bins[c_blockSize];
+            real      weights[c_blockSize];
+            for (int blockBegin = begin; blockBegin < end; blockBegin += c_blockSize)
+            {
+                const int blockSize = std::min(end - blockBegin, c_blockSize);
+                for (int i = 0; i < blockSize; i++)
+                {
+                    bins[i] = binFunction(blockBegin + i, &weights[i]);
+                }
+                for (int i = 0; i < blockSize; i++)
+                {
+                    if (bins[i] >= 0)
+                    {
+                        gridData[bins[i]] += weights[i];
+                    }
+                }
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
+template<typename CoordinateFunction>
+void GridAccumulator::spread(int grid, int numPoints, CoordinateFunction coordinateFunction)
+{
+    GMX_RELEASE_ASSERT(hasGaussianSpreading(), "Spreading requires a Gaussian width");
+    const int numThreads = numThreads_;
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            double*   gridData = threadGrid(thread, grid);
+            const int begin    = (numPoints * static_cast<int64_t>(thread)) / numThreads;
+            const int end      = (numPoints * static_cast<int64_t>(thread + 1)) / numThreads;
+            for (int i = begin; i < end; i++)
+            {
+                real       weight;
+                const real coordinate = coordinateFunction(i, &weight);
+                spreadPoint(thread, gridData, coordinate, weight);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
+} // namespace gmx
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the multithreaded grid accumulator of the density tools
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxana/gridaccumulator.h"
+
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/arrayref.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+class GridAccumulatorTest : public ::testing::TestWithParam<int>
+{
+};
+
+TEST_P(GridAccumulatorTest, AccumulatesTheSameAsSerialBinning)
+{
+    const int        gridSize  = 7;
+    const int        numPoints = 1000;
+    std::vector<int> bins(numPoints);
+    for (int i = 0; i < numPoints; i++)
+    {
+        // Every tenth point is skipped
+        bins[i] = (i % 10 == 9) ? -1 : (i * 3) % gridSize;
+    }
+    std::vector<double> reference(2 * gridSize, 0.0);
+    for (int i = 0; i < numPoints; i++)
+    {
+        if (bins[i] >= 0)
+        {
+            reference[bins[i]] += 1;
+            reference[gridSize + bins[i]] += 0.5 * i;
+        }
+    }
+
+    GridAccumulator accumulator(2, gridSize, GetParam());
+    // Two frames, the second adding to the totals of the first
+    for (int frame = 0; frame < 2; frame++)
+    {
+        accumulator.accumulate(0, numPoints, [&](int i, real* weight) {
+            *weight = 1;
+            return bins[i];
+        });
+        accumulator.accumulate(1, numPoints, [&](int i, real* weight) {
+            *weight = 0.5 * i;
+            return bins[i];
+        });
+    }
+    accumulator.reduce();
+    for (int grid = 0; grid < 2; grid++)
+    {
+        ArrayRef<const double> values = accumulator.grid(grid);
+        ASSERT_EQ(gridSize, values.ssize());
+        for (int bin = 0; bin < gridSize; bin++)
+        {
+            EXPECT_DOUBLE_EQ(2 * reference[grid * gridSize + bin], values[bin]);
+        }
+    }
+}
+
+TEST_P(GridAccumulatorTest, SpreadingConservesWeightOnPeriodicGrid)
+{
+    const int       gridSize = 10;
+    GridAccumulator accumulator(1, gridSize, GetParam());
+    accumulator.setGaussianSpreading(1.5);
+    // Points close to both edges of the grid, which wrap around
+    const std::vector<real> coordinates = { 0.1, 0.5, 3.7, 9.2, 9.9 };
+    accumulator.spread(0, coordinates.size(), [&](int i, real* weight) {
+        *weight = 2;
+        return coordinates[i];
+    });
+    accumulator.reduce();
+    ArrayRef<const double> values = accumulator.grid(0);
+    const double           sum    = std::accumulate(values.begin(), values.end(), 0.0);
+    EXPECT_NEAR(2 * coordinates.size(), sum, 1e-3);
+    // The point at 3.7 dominates bin 3, which is farther from the others
+    EXPECT_GT(values[3], values[6]);
+}
+
+INSTANTIATE_TEST_CASE_P(WithThreadCounts, GridAccumulatorTest, ::testing::Values(1, 2, 3));
+
+} // namespace
+
+} // namespace gmx
@@ -46,6 +46,9 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
+#include <vector>
+
 #include "gromacs/commandline/filenm.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/utility/basenetwork.h"
@@ -60,6 +63,117 @@
 /* The source code in this file should be thread-safe.
       Please keep it that way. */
 
+#if GMX_LIB_MPI && MPI_VERSION >= 3
+//! Whether intra-node sums can use MPI-3 shared memory windows
+#    define GMX_NODECOMM_SHARED_MEMORY 1
+#else
+//! Whether intra-node sums can use MPI-3 shared memory windows
+#    define GMX_NODECOMM_SHARED_MEMORY 0
+#endif
+
+#if GMX_NODECOMM_SHARED_MEMORY
+/*! \brief Buffers in node-shared memory for summing over the ranks within a node
+ *
+ * Each rank in the intra-node communicator has a slot for its input.
+ * The result is stored in a separate buffer, so ranks can write their input
+ * for the next sum while other ranks are still reading the previous result.
+ */
+struct NodeSharedSumBuffer
+{
+    //! The shared memory window, MPI_WIN_NULL when not allocated
+    MPI_Win window = MPI_WIN_NULL;
+    //! The number of doubles each buffer can store
+    int capacity = 0;
+    //! Pointers to the input slots of all ranks in the node
+    std::vector<double*> slots;
+    //! Pointer to the result buffer, owned by rank 0 in the node
+    double* result = nullptr;
+};
+
+/*! \brief (Re)allocates the shared buffers for sums of up to \p capacity doubles
+ *
+ * This is collective over \p comm, which should only contain ranks that share memory.
+ */
+static void reallocNodeSharedSumBuffer(NodeSharedSumBuffer* buffer, MPI_Comm comm, int rank,
+                                       int capacity)
+{
+    if (buffer->window != MPI_WIN_NULL)
+    {
+        MPI_Win_unlock_all(buffer->window);
+        MPI_Win_free(&buffer->window);
+    }
+
+    int numRanks;
+    MPI_Comm_size(comm, &numRanks);
+
+    /* Rank 0 stores the result after its input slot */
+    const MPI_Aint numElements = (rank == 0 ? 2 : 1) * static_cast<MPI_Aint>(capacity);
+    double*        localBuffer = nullptr;
+    MPI_Win_allocate_shared(numElements * sizeof(double), sizeof(double), MPI_INFO_NULL, comm,
+                            &localBuffer, &buffer->window);
+
+    buffer->slots.resize(numRanks);
+    for (int i = 0; i < numRanks; i++)
+    {
+        MPI_Aint size;
+        int      displacementUnit;
+        MPI_Win_shared_query(buffer->window, i, &size, &displacementUnit, &buffer->slots[i]);
+    }
+    buffer->result   = buffer->slots[0] + capacity;
+    buffer->capacity = capacity;
+
+    /* We use a single passive target epoch with explicit synchronization */
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, buffer->window);
+}
+
+/*! \brief Sums \p r using node-shared memory within nodes and MPI between nodes
+ *
+ * Within a node this replaces a reduce and a broadcast by two barriers,
+ * with rank 0 of each node summing directly from the input of the other
+ * ranks in the node.
+ */
+static void sumdUsingNodeSharedMemory(int nr, double r[], const gmx_nodecomm_t& nc)
+{
+    NodeSharedSumBuffer* buffer = nc.sharedSumBuffer;
+
+    if (nr > buffer->capacity)
+    {
+        /* All ranks sum the same number of elements, so this is collective */
+        reallocNodeSharedSumBuffer(buffer, nc.comm_intra, nc.rank_intra, nr + nr / 4);
+    }
+
+    std::copy(r, r + nr, buffer->slots[nc.rank_intra]);
+
+    /* Make our input visible to rank 0 */
+    MPI_Win_sync(buffer->window);
+    MPI_Barrier(nc.comm_intra);
+    MPI_Win_sync(buffer->window);
+
+    if (nc.rank_intra == 0)
+    {
+        double* result = buffer->result;
+        std::copy(buffer->slots[0], buffer->slots[0] + nr, result);
+        for (size_t s = 1; s < buffer->slots.size(); s++)
+        {
+            const double* input = buffer->slots[s];
+            for (int i = 0; i < nr; i++)
+            {
+                result[i] += input[i];
+            }
+        }
+        /* Sum the node sums over the nodes */
+        MPI_Allreduce(MPI_IN_PLACE, result, nr, MPI_DOUBLE, MPI_SUM, nc.comm_inter);
+        MPI_Win_sync(buffer->window);
+    }
+
+    /* Wait for the result to be available */
+    MPI_Barrier(nc.comm_intra);
+    MPI_Win_sync(buffer->window);
+
+    std::copy(buffer->result, buffer->result + nr, r);
+}
+#endif
+
 CommrecHandle init_commrec(MPI_Comm communicator)
 {
     CommrecHandle handle;
@@ -145,7 +259,8 @@ void gmx_setup_nodecomm(FILE gmx_unused* fplog, t_commrec* cr)
 
     nc = &cr->nc;
 
-    nc->bUse = FALSE;
+    nc->bUse            = FALSE;
+    nc->sharedSumBuffer = nullptr;
 #if !GMX_THREAD_MPI
 #    if GMX_MPI
     int n, rank;
@@ -155,16 +270,21 @@ void gmx_setup_nodecomm(FILE gmx_unused* fplog, t_commrec* cr)
     MPI_Comm_size(cr->mpi_comm_mygroup, &n);
     MPI_Comm_rank(cr->mpi_comm_mygroup, &rank);
 
-    int nodehash = gmx_physicalnode_id_hash();
-
     if (debug)
     {
         fprintf(debug, "In gmx_setup_nodecomm: splitting communicator of size %d\n", n);
     }
 
+#        if GMX_NODECOMM_SHARED_MEMORY
+    /* The intra-node communicator, containing the ranks that can share memory */
+    MPI_Comm_split_type(cr->mpi_comm_mygroup, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+                        &nc->comm_intra);
+#        else
+    int nodehash = gmx_physicalnode_id_hash();
 
     /* The intra-node communicator, split on node number */
     MPI_Comm_split(cr->mpi_comm_mygroup, nodehash, rank, &nc->comm_intra);
+#        endif
     MPI_Comm_rank(nc->comm_intra, &nc->rank_intra);
     if (debug)
     {
@@ -197,6 +317,19 @@ void gmx_setup_nodecomm(FILE gmx_unused* fplog, t_commrec* cr)
         {
             MPI_Comm_free(&nc->comm_inter);
         }
+#        if GMX_NODECOMM_SHARED_MEMORY
+        /* This choice only needs to be the same within each node, as the sums
+         * between nodes use the same Allreduce calls with both setups.
+         */
+        if (ni > 1 && getenv("GMX_NO_NODECOMM_SHM") == nullptr)
+        {
+            nc->sharedSumBuffer = new NodeSharedSumBuffer;
+            if (fplog)
+            {
+                fprintf(fplog, "Using MPI shared memory for summing within nodes\n\n");
+            }
+        }
+#        endif
     }
     else
     {
@@ -241,6 +374,13 @@ void gmx_sumd(int gmx_unused nr, double gmx_unused r[], const t_commrec gmx_unus
     GMX_RELEASE_ASSERT(false, "Invalid call to gmx_sumd");
 #else
 #    if MPI_IN_PLACE_EXISTS
+#        if GMX_NODECOMM_SHARED_MEMORY
+    if (cr->nc.sharedSumBuffer != nullptr)
+    {
+        sumdUsingNodeSharedMemory(nr, r, cr->nc);
+        return;
+    }
+#        endif
     if (cr->nc.bUse)
     {
         if (cr->nc.rank_intra == 0)
@@ -293,6 +433,23 @@ void gmx_sumd(int gmx_unused nr, double gmx_unused r[], const t_commrec gmx_unus
 #endif
 }
 
+void gmx_sumd_start(int nr, double r[], const t_commrec* cr, MPI_Request* request)
+{
+#if GMX_LIB_MPI && MPI_VERSION >= 3
+    MPI_Iallreduce(MPI_IN_PLACE, r, nr, MPI_DOUBLE, MPI_SUM, cr->mpi_comm_mygroup, request);
+#else
+    gmx_sumd(nr, r, cr);
+    GMX_UNUSED_VALUE(request);
+#endif
+}
+
+void gmx_sumd_wait(MPI_Request gmx_unused* request)
+{
+#if GMX_LIB_MPI && MPI_VERSION >= 3
+    MPI_Wait(request, MPI_STATUS_IGNORE);
+#endif
+}
+
 void gmx_sumf(int gmx_unused nr, float gmx_unused r[], const t_commrec gmx_unused* cr)
 {
 #if !GMX_MPI
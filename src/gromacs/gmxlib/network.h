@@ -93,6 +93,16 @@ void gmx_sumf(int nr, float r[], const struct t_commrec* cr);
 void gmx_sumd(int nr, double r[], const struct t_commrec* cr);
 /* Calculate the global sum of an array of doubles */
 
+void gmx_sumd_start(int nr, double r[], const struct t_commrec* cr, MPI_Request* request);
+/* Start a global sum of an array of doubles, which should not be accessed
+ * until gmx_sumd_wait() has been called with the same request.
+ * Without support for non-blocking collectives in the MPI library
+ * the sum is completed before returning.
+ */
+
+void gmx_sumd_wait(MPI_Request* request);
+/* Complete a global sum started with gmx_sumd_start() */
+
 #if GMX_DOUBLE
 #    define gmx_sum gmx_sumd
 #else
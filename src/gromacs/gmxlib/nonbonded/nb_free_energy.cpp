@@ -44,6 +44,7 @@
 #include <cmath>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/gmxlib/nonbonded/nb_kernel.h"
@@ -56,6 +57,8 @@
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/mdtypes/mdatom.h"
 #include "gromacs/simd/simd.h"
+#include "gromacs/simd/simd_math.h"
+#include "gromacs/utility/alignedallocator.h"
 #include "gromacs/utility/fatalerror.h"
 
 
@@ -64,6 +67,7 @@ struct ScalarDataTypes
 {
     using RealType                     = real; //!< The data type to use as real.
     using IntType                      = int;  //!< The data type to use as int.
+    using BoolType                     = bool; //!< The data type to use as bool.
     static constexpr int simdRealWidth = 1;    //!< The width of the RealType.
     static constexpr int simdIntWidth  = 1;    //!< The width of the IntType.
 };
@@ -74,17 +78,30 @@ struct SimdDataTypes
 {
     using RealType                     = gmx::SimdReal;         //!< The data type to use as real.
     using IntType                      = gmx::SimdInt32;        //!< The data type to use as int.
+    using BoolType                     = gmx::SimdBool;         //!< The data type to use as bool.
     static constexpr int simdRealWidth = GMX_SIMD_REAL_WIDTH;   //!< The width of the RealType.
     static constexpr int simdIntWidth  = GMX_SIMD_FINT32_WIDTH; //!< The width of the IntType.
 };
 #endif
 
-//! Computes r^(1/p) and 1/r^(1/p) for the standard p=6
-template<class RealType>
-static inline void pthRoot(const RealType r, RealType* pthRoot, RealType* invPthRoot)
+/*! \brief Computes r^(1/p) and 1/r^(1/p) for the standard p=6
+ *
+ * Lanes where \p mask is false return zero for both. The SIMD cbrt does
+ * not accept zero, so those lanes are fed a safe value.
+ */
+template<class RealType, class BoolType>
+static inline void pthRoot(const RealType r,
+                           RealType*      pthRoot,
+                           RealType*      invPthRoot,
+                           const BoolType mask)
 {
-    *invPthRoot = gmx::invsqrt(std::cbrt(r));
-    *pthRoot    = 1 / (*invPthRoot);
+    // Pick up std::cbrt for the scalar and gmx::cbrt for the SIMD types
+    using gmx::cbrt;
+    using std::cbrt;
+
+    const RealType rSafe = gmx::blend(RealType(1.0_real), r, mask);
+    *invPthRoot          = gmx::maskzInvsqrt(cbrt(rSafe), mask);
+    *pthRoot    = gmx::maskzInv(*invPthRoot, mask);
 }
 
 template<class RealType>
@@ -158,7 +175,10 @@ static inline RealType lennardJonesPotential(const RealType v6,
 }
 
 /* Ewald LJ */
-static inline real ewaldLennardJonesGridSubtract(const real c6grid, const real potentialShift, const real onesixth)
+template<class RealType>
+static inline RealType ewaldLennardJonesGridSubtract(const RealType c6grid,
+                                                     const real     potentialShift,
+                                                     const real     onesixth)
 {
     return (c6grid * potentialShift * onesixth);
 }
@@ -169,34 +189,69 @@ static inline RealType potSwitchScalarForceMod(const RealType fScalarInp,
                                                const RealType potential,
                                                const RealType sw,
                                                const RealType r,
-                                               const RealType rVdw,
-                                               const RealType dsw,
-                                               const real     zero)
+                                               const real     rVdw,
+                                               const RealType dsw)
 {
-    if (r < rVdw)
-    {
-        real fScalar = fScalarInp * sw - r * potential * dsw;
-        return (fScalar);
-    }
-    return (zero);
+    return (gmx::selectByMask(fScalarInp * sw - r * potential * dsw, r < rVdw));
 }
 template<class RealType>
 static inline RealType potSwitchPotentialMod(const RealType potentialInp,
                                              const RealType sw,
                                              const RealType r,
-                                             const RealType rVdw,
-                                             const real     zero)
+                                             const real     rVdw)
+{
+    return (gmx::selectByMask(potentialInp * sw, r < rVdw));
+}
+
+
+#define STATE_A 0
+#define STATE_B 1
+#define NSTATES 2
+
+//! The lambda dependent factors of the free-energy kernel for one lambda state
+struct LambdaFactors
 {
-    if (r < rVdw)
+    //! Computes the factors for the Coulomb and VdW lambda values
+    LambdaFactors(const real lambdaCoul, const real lambdaVdw, const real lam_power)
     {
-        real potential = potentialInp * sw;
-        return (potential);
+        /* Lambda factor for state A, 1-lambda*/
+        LFC[STATE_A] = 1 - lambdaCoul;
+        LFV[STATE_A] = 1 - lambdaVdw;
+
+        /* Lambda factor for state B, lambda*/
+        LFC[STATE_B] = lambdaCoul;
+        LFV[STATE_B] = lambdaVdw;
+
+        /*derivative of the lambda factor for state A and B */
+        const real DLF[NSTATES] = { -1, 1 };
+
+        constexpr real sc_r_power = 6.0_real;
+        for (int i = 0; i < NSTATES; i++)
+        {
+            lfac_coul[i]  = (lam_power == 2 ? (1 - LFC[i]) * (1 - LFC[i]) : (1 - LFC[i]));
+            dlfac_coul[i] = DLF[i] * lam_power / sc_r_power * (lam_power == 2 ? (1 - LFC[i]) : 1);
+            lfac_vdw[i]   = (lam_power == 2 ? (1 - LFV[i]) * (1 - LFV[i]) : (1 - LFV[i]));
+            dlfac_vdw[i]  = DLF[i] * lam_power / sc_r_power * (lam_power == 2 ? (1 - LFV[i]) : 1);
+        }
     }
-    return (zero);
-}
 
+    //! The Coulomb and VdW lambda factors for state A and B
+    real LFC[NSTATES], LFV[NSTATES];
+    //! The soft-core lambda factors and their derivatives for state A and B
+    real lfac_coul[NSTATES], dlfac_coul[NSTATES], lfac_vdw[NSTATES], dlfac_vdw[NSTATES];
+};
 
-//! Templated free-energy non-bonded kernel
+/*! \brief Templated free-energy non-bonded kernel
+ *
+ * With SIMD DataTypes, the j-list of each i-particle is processed in chunks
+ * of the SIMD width. The j-particle data is gathered into aligned buffers,
+ * all interaction math is done in SIMD with masks instead of branches,
+ * and the j-forces are scattered back with scalar atomics.
+ *
+ * The energies and dV/dlambda can be computed for multiple lambda states in
+ * one pass over the list. All lambda independent quantities of a pair are
+ * then computed only once.
+ */
 template<typename DataTypes, bool useSoftCore, bool scLambdasOrAlphasDiffer, bool vdwInteractionTypeIsEwald, bool elecInteractionTypeIsEwald, bool vdwModifierIsPotSwitch>
 static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                                   rvec* gmx_restrict         xx,
@@ -206,14 +261,13 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                                   nb_kernel_data_t* gmx_restrict kernel_data,
                                   t_nrnb* gmx_restrict nrnb)
 {
-#define STATE_A 0
-#define STATE_B 1
-#define NSTATES 2
-
     using RealType = typename DataTypes::RealType;
-    using IntType  = typename DataTypes::IntType;
+    using BoolType = typename DataTypes::BoolType;
+
+    constexpr int simdWidth = DataTypes::simdRealWidth;
+    // Alignment of the buffers used for loading and storing RealType
+    constexpr int simdAlignment = simdWidth * sizeof(real);
 
-    /* FIXME: How should these be handled with SIMD? */
     constexpr real onetwelfth = 1.0 / 12.0;
     constexpr real onesixth   = 1.0 / 6.0;
     constexpr real zero       = 0.0;
@@ -243,8 +297,6 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
     const real* nbfp          = fr->nbfp.data();
     const real* nbfp_grid     = fr->ljpme_c6grid;
     real*       Vv            = kernel_data->energygrp_vdw;
-    const real  lambda_coul   = kernel_data->lambda[efptCOUL];
-    const real  lambda_vdw    = kernel_data->lambda[efptVDW];
     real*       dvdl          = kernel_data->dvdl;
     const auto& scParams      = *ic->softCoreParameters;
     const real  alpha_coul    = scParams.alphaCoulomb;
@@ -343,38 +395,59 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
     GMX_RELEASE_ASSERT(!(vdwInteractionTypeIsEwald && vdwModifierIsPotSwitch),
                        "Can not apply soft-core to switched Ewald potentials");
 
-    real dvdl_coul = 0;
-    real dvdl_vdw  = 0;
+    const int numLambdas          = kernel_data->numLambdas;
+    const int numEnergyGroupPairs = kernel_data->numEnergyGroupPairs;
+    GMX_ASSERT(numLambdas == 1 || !(doForces || doShiftForces),
+               "Forces can only be computed for a single lambda state");
 
-    /* Lambda factor for state A, 1-lambda*/
-    real LFC[NSTATES], LFV[NSTATES];
-    LFC[STATE_A] = one - lambda_coul;
-    LFV[STATE_A] = one - lambda_vdw;
-
-    /* Lambda factor for state B, lambda*/
-    LFC[STATE_B] = lambda_coul;
-    LFV[STATE_B] = lambda_vdw;
+    std::vector<LambdaFactors> lambdaFactorsList;
+    lambdaFactorsList.reserve(numLambdas);
+    for (int lambdaIndex = 0; lambdaIndex < numLambdas; lambdaIndex++)
+    {
+        const real* lambda = kernel_data->lambda + lambdaIndex * efptNR;
+        lambdaFactorsList.emplace_back(lambda[efptCOUL], lambda[efptVDW], lam_power);
+    }
 
     /*derivative of the lambda factor for state A and B */
     real DLF[NSTATES];
     DLF[STATE_A] = -1;
     DLF[STATE_B] = 1;
 
-    real           lfac_coul[NSTATES], dlfac_coul[NSTATES], lfac_vdw[NSTATES], dlfac_vdw[NSTATES];
-    constexpr real sc_r_power = 6.0_real;
-    for (int i = 0; i < NSTATES; i++)
-    {
-        lfac_coul[i]  = (lam_power == 2 ? (1 - LFC[i]) * (1 - LFC[i]) : (1 - LFC[i]));
-        dlfac_coul[i] = DLF[i] * lam_power / sc_r_power * (lam_power == 2 ? (1 - LFC[i]) : 1);
-        lfac_vdw[i]   = (lam_power == 2 ? (1 - LFV[i]) * (1 - LFV[i]) : (1 - LFV[i]));
-        dlfac_vdw[i]  = DLF[i] * lam_power / sc_r_power * (lam_power == 2 ? (1 - LFV[i]) : 1);
-    }
+    /* The energy and dV/dlambda accumulators for each lambda state */
+    using RealTypeVector = std::vector<RealType, gmx::AlignedAllocator<RealType>>;
+    RealTypeVector dvdlCoulList(numLambdas, RealType(zero));
+    RealTypeVector dvdlVdwList(numLambdas, RealType(zero));
+    RealTypeVector vCTotList(numLambdas, RealType(zero));
+    RealTypeVector vVTotList(numLambdas, RealType(zero));
 
     // TODO: We should get rid of using pointers to real
     const real* x             = xx[0];
     real* gmx_restrict f      = &(forceWithShiftForces->force()[0][0]);
     real* gmx_restrict fshift = &(forceWithShiftForces->shiftForces()[0][0]);
 
+    /* Buffers for gathering the j-particle data of one chunk of the list
+     * and for scattering the j-forces back. With scalar DataTypes these
+     * hold a single element.
+     */
+    alignas(simdAlignment) real preloadJx[simdWidth];
+    alignas(simdAlignment) real preloadJy[simdWidth];
+    alignas(simdAlignment) real preloadJz[simdWidth];
+    alignas(simdAlignment) real preloadPairIncluded[simdWidth];
+    alignas(simdAlignment) real preloadPairExcluded[simdWidth];
+    alignas(simdAlignment) real preloadSelfFactor[simdWidth];
+    alignas(simdAlignment) real preloadQq[NSTATES][simdWidth];
+    alignas(simdAlignment) real preloadC6[NSTATES][simdWidth];
+    alignas(simdAlignment) real preloadC12[NSTATES][simdWidth];
+    alignas(simdAlignment) real preloadC6Grid[NSTATES][simdWidth];
+    alignas(simdAlignment) real tableIndex[simdWidth];
+    alignas(simdAlignment) real tableF[simdWidth];
+    alignas(simdAlignment) real tableD[simdWidth];
+    alignas(simdAlignment) real tableV[simdWidth];
+    alignas(simdAlignment) real computeLane[simdWidth];
+    alignas(simdAlignment) real forceJx[simdWidth];
+    alignas(simdAlignment) real forceJy[simdWidth];
+    alignas(simdAlignment) real forceJz[simdWidth];
+
     for (int n = 0; n < nri; n++)
     {
         int npair_within_cutoff = 0;
@@ -394,68 +467,110 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
         const real iqB   = facel * chargeB[ii];
         const int  ntiA  = 2 * ntype * typeA[ii];
         const int  ntiB  = 2 * ntype * typeB[ii];
-        real       vctot = 0;
-        real       vvtot = 0;
-        real       fix   = 0;
-        real       fiy   = 0;
-        real       fiz   = 0;
+        RealType   fIX   = zero;
+        RealType   fIY   = zero;
+        RealType   fIZ   = zero;
+        std::fill(vCTotList.begin(), vCTotList.end(), RealType(zero));
+        std::fill(vVTotList.begin(), vVTotList.end(), RealType(zero));
 
-        for (int k = nj0; k < nj1; k++)
+        for (int k = nj0; k < nj1; k += simdWidth)
         {
-            int            tj[NSTATES];
-            const int      jnr = jjnr[k];
-            const int      j3  = 3 * jnr;
-            RealType       c6[NSTATES], c12[NSTATES], qq[NSTATES], Vcoul[NSTATES], Vvdw[NSTATES];
-            RealType       r, rinv, rp, rpm2;
-            RealType       alpha_vdw_eff, alpha_coul_eff, sigma6[NSTATES];
-            const RealType dx  = ix - x[j3];
-            const RealType dy  = iy - x[j3 + 1];
-            const RealType dz  = iz - x[j3 + 2];
-            const RealType rsq = dx * dx + dy * dy + dz * dz;
-            RealType       FscalC[NSTATES], FscalV[NSTATES];
-            /* Check if this pair on the exlusions list.*/
-            const bool bPairIncluded = nlist->excl_fep == nullptr || nlist->excl_fep[k];
-
-            if (rsq >= rcutoff_max2 && bPairIncluded)
+            /* Gather the j-particle data. Lanes past the end of the list
+             * are neither included nor excluded and thus fully masked out.
+             */
+            for (int s = 0; s < simdWidth; s++)
             {
-                /* We save significant time by skipping all code below.
-                 * Note that with soft-core interactions, the actual cut-off
-                 * check might be different. But since the soft-core distance
-                 * is always larger than r, checking on r here is safe.
-                 * Exclusions outside the cutoff can not be skipped as
-                 * when using Ewald: the reciprocal-space
-                 * Ewald component still needs to be subtracted.
-                 */
-
-                continue;
-            }
-            npair_within_cutoff++;
+                if (k + s < nj1)
+                {
+                    const int jnr = jjnr[k + s];
+                    const int j3  = 3 * jnr;
+                    /* Check if this pair on the exlusions list.*/
+                    const bool bPairIncluded = nlist->excl_fep == nullptr || nlist->excl_fep[k + s];
+
+                    preloadJx[s]           = x[j3];
+                    preloadJy[s]           = x[j3 + 1];
+                    preloadJz[s]           = x[j3 + 2];
+                    preloadPairIncluded[s] = bPairIncluded ? one : zero;
+                    preloadPairExcluded[s] = bPairIncluded ? zero : one;
+                    /* If the i particle (ii) has itself (jnr) in its neighborlist,
+                     * which can only happen with the Verlet scheme, the
+                     * self-interaction occurs twice. Scale it down by 50%
+                     * to only include it once.
+                     */
+                    preloadSelfFactor[s] = (ii == jnr) ? half : one;
 
-            if (rsq > 0)
-            {
-                /* Note that unlike in the nbnxn kernels, we do not need
-                 * to clamp the value of rsq before taking the invsqrt
-                 * to avoid NaN in the LJ calculation, since here we do
-                 * not calculate LJ interactions when C6 and C12 are zero.
-                 */
+                    preloadQq[STATE_A][s] = iqA * chargeA[jnr];
+                    preloadQq[STATE_B][s] = iqB * chargeB[jnr];
 
-                rinv = gmx::invsqrt(rsq);
-                r    = rsq * rinv;
+                    int tj[NSTATES];
+                    tj[STATE_A] = ntiA + 2 * typeA[jnr];
+                    tj[STATE_B] = ntiB + 2 * typeB[jnr];
+                    for (int i = 0; i < NSTATES; i++)
+                    {
+                        preloadC6[i][s]     = bPairIncluded ? nbfp[tj[i]] : zero;
+                        preloadC12[i][s]    = bPairIncluded ? nbfp[tj[i] + 1] : zero;
+                        preloadC6Grid[i][s] = vdwInteractionTypeIsEwald ? nbfp_grid[tj[i]] : zero;
+                    }
+                }
+                else
+                {
+                    preloadJx[s]           = ix;
+                    preloadJy[s]           = iy;
+                    preloadJz[s]           = iz;
+                    preloadPairIncluded[s] = zero;
+                    preloadPairExcluded[s] = zero;
+                    preloadSelfFactor[s]   = zero;
+                    for (int i = 0; i < NSTATES; i++)
+                    {
+                        preloadQq[i][s]     = zero;
+                        preloadC6[i][s]     = zero;
+                        preloadC12[i][s]    = zero;
+                        preloadC6Grid[i][s] = zero;
+                    }
+                }
             }
-            else
+
+            const RealType dX  = ix - gmx::load<RealType>(preloadJx);
+            const RealType dY  = iy - gmx::load<RealType>(preloadJy);
+            const RealType dZ  = iz - gmx::load<RealType>(preloadJz);
+            const RealType rSq = dX * dX + dY * dY + dZ * dZ;
+
+            /* We save significant time by skipping all code below for
+             * included pairs beyond the cut-off.
+             * Note that with soft-core interactions, the actual cut-off
+             * check might be different. But since the soft-core distance
+             * is always larger than r, checking on r here is safe.
+             * Exclusions outside the cutoff can not be skipped as
+             * when using Ewald: the reciprocal-space
+             * Ewald component still needs to be subtracted.
+             */
+            const BoolType bPairIncluded =
+                    (zero < gmx::load<RealType>(preloadPairIncluded)) && (rSq < rcutoff_max2);
+            const BoolType bPairExcluded = (zero < gmx::load<RealType>(preloadPairExcluded));
+            const BoolType computeMask   = bPairIncluded || bPairExcluded;
+            if (!gmx::anyTrue(computeMask))
             {
-                /* The force at r=0 is zero, because of symmetry.
-                 * But note that the potential is in general non-zero,
-                 * since the soft-cored r will be non-zero.
-                 */
-                rinv = 0;
-                r    = 0;
+                continue;
             }
+            npair_within_cutoff++;
 
+            /* Note that unlike in the nbnxn kernels, we do not need
+             * to clamp the value of rsq before taking the invsqrt
+             * to avoid NaN in the LJ calculation, since here we do
+             * not calculate LJ interactions when C6 and C12 are zero.
+             *
+             * The force at r=0 is zero, because of symmetry.
+             * But note that the potential is in general non-zero,
+             * since the soft-cored r will be non-zero.
+             */
+            const RealType rInv = gmx::maskzInvsqrt(rSq, computeMask && (zero < rSq));
+            const RealType r    = rSq * rInv;
+
+            RealType rp, rpm2;
             if (useSoftCore)
             {
-                rpm2 = rsq * rsq;  /* r4 */
-                rp   = rpm2 * rsq; /* r6 */
+                rpm2 = rSq * rSq;  /* r4 */
+                rp   = rpm2 * rSq; /* r6 */
             }
             else
             {
@@ -463,224 +578,73 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * with not using soft-core, so we use power of 0 which gives
                  * the simplest math and cheapest code.
                  */
-                rpm2 = rinv * rinv;
-                rp   = 1;
+                rpm2 = rInv * rInv;
+                rp   = one;
             }
 
-            RealType Fscal = 0;
+            /* Forces are only computed with a single lambda state, so Fscal
+             * is only used when there is one iteration of the lambda loop below.
+             */
+            RealType Fscal = zero;
 
-            qq[STATE_A] = iqA * chargeA[jnr];
-            qq[STATE_B] = iqB * chargeB[jnr];
+            RealType qq[NSTATES];
+            qq[STATE_A] = gmx::load<RealType>(preloadQq[STATE_A]);
+            qq[STATE_B] = gmx::load<RealType>(preloadQq[STATE_B]);
 
-            tj[STATE_A] = ntiA + 2 * typeA[jnr];
-            tj[STATE_B] = ntiB + 2 * typeB[jnr];
+            const RealType selfFactor = gmx::load<RealType>(preloadSelfFactor);
 
-            if (bPairIncluded)
-            {
-                c6[STATE_A] = nbfp[tj[STATE_A]];
-                c6[STATE_B] = nbfp[tj[STATE_B]];
+            /* First compute all lambda independent quantities */
+            const bool haveIncludedPair = gmx::anyTrue(bPairIncluded);
 
+            RealType c6[NSTATES], c12[NSTATES], sigma6[NSTATES];
+            RealType alpha_vdw_eff  = zero;
+            RealType alpha_coul_eff = zero;
+            if (haveIncludedPair)
+            {
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    c12[i] = nbfp[tj[i] + 1];
+                    c6[i]     = gmx::load<RealType>(preloadC6[i]);
+                    c12[i]    = gmx::load<RealType>(preloadC12[i]);
+                    sigma6[i] = zero;
                     if (useSoftCore)
                     {
-                        if ((c6[i] > 0) && (c12[i] > 0))
-                        {
-                            /* c12 is stored scaled with 12.0 and c6 is scaled with 6.0 - correct for this */
-                            sigma6[i] = half * c12[i] / c6[i];
-                            if (sigma6[i] < sigma6_min) /* for disappearing coul and vdw with soft core at the same time */
-                            {
-                                sigma6[i] = sigma6_min;
-                            }
-                        }
-                        else
-                        {
-                            sigma6[i] = sigma6_def;
-                        }
+                        const BoolType bothPositive = (zero < c6[i]) && (zero < c12[i]);
+                        /* c12 is stored scaled with 12.0 and c6 is scaled with 6.0 - correct
+                         * for this. The minimum is for disappearing coul and vdw with soft core
+                         * at the same time.
+                         */
+                        const RealType sigma6Pair =
+                                gmx::max(half * c12[i] * gmx::maskzInv(c6[i], bothPositive),
+                                         RealType(sigma6_min));
+                        sigma6[i] = gmx::blend(RealType(sigma6_def), sigma6Pair, bothPositive);
                     }
                 }
 
                 if (useSoftCore)
                 {
                     /* only use softcore if one of the states has a zero endstate - softcore is for avoiding infinities!*/
-                    if ((c12[STATE_A] > 0) && (c12[STATE_B] > 0))
-                    {
-                        alpha_vdw_eff  = 0;
-                        alpha_coul_eff = 0;
-                    }
-                    else
-                    {
-                        alpha_vdw_eff  = alpha_vdw;
-                        alpha_coul_eff = alpha_coul;
-                    }
-                }
-
-                for (int i = 0; i < NSTATES; i++)
-                {
-                    FscalC[i] = 0;
-                    FscalV[i] = 0;
-                    Vcoul[i]  = 0;
-                    Vvdw[i]   = 0;
-
-                    RealType rinvC, rinvV, rC, rV, rpinvC, rpinvV;
-
-                    /* Only spend time on A or B state if it is non-zero */
-                    if ((qq[i] != 0) || (c6[i] != 0) || (c12[i] != 0))
-                    {
-                        /* this section has to be inside the loop because of the dependence on sigma6 */
-                        if (useSoftCore)
-                        {
-                            rpinvC = one / (alpha_coul_eff * lfac_coul[i] * sigma6[i] + rp);
-                            pthRoot(rpinvC, &rinvC, &rC);
-                            if (scLambdasOrAlphasDiffer)
-                            {
-                                rpinvV = one / (alpha_vdw_eff * lfac_vdw[i] * sigma6[i] + rp);
-                                pthRoot(rpinvV, &rinvV, &rV);
-                            }
-                            else
-                            {
-                                /* We can avoid one expensive pow and one / operation */
-                                rpinvV = rpinvC;
-                                rinvV  = rinvC;
-                                rV     = rC;
-                            }
-                        }
-                        else
-                        {
-                            rpinvC = 1;
-                            rinvC  = rinv;
-                            rC     = r;
-
-                            rpinvV = 1;
-                            rinvV  = rinv;
-                            rV     = r;
-                        }
-
-                        /* Only process the coulomb interactions if we have charges,
-                         * and if we either include all entries in the list (no cutoff
-                         * used in the kernel), or if we are within the cutoff.
-                         */
-                        bool computeElecInteraction = (elecInteractionTypeIsEwald && r < rcoulomb)
-                                                      || (!elecInteractionTypeIsEwald && rC < rcoulomb);
-
-                        if ((qq[i] != 0) && computeElecInteraction)
-                        {
-                            if (elecInteractionTypeIsEwald)
-                            {
-                                Vcoul[i]  = ewaldPotential(qq[i], rinvC, sh_ewald);
-                                FscalC[i] = ewaldScalarForce(qq[i], rinvC);
-                            }
-                            else
-                            {
-                                Vcoul[i]  = reactionFieldPotential(qq[i], rinvC, rC, krf, crf);
-                                FscalC[i] = reactionFieldScalarForce(qq[i], rinvC, rC, krf, two);
-                            }
-                        }
-
-                        /* Only process the VDW interactions if we have
-                         * some non-zero parameters, and if we either
-                         * include all entries in the list (no cutoff used
-                         * in the kernel), or if we are within the cutoff.
-                         */
-                        bool computeVdwInteraction = (vdwInteractionTypeIsEwald && r < rvdw)
-                                                     || (!vdwInteractionTypeIsEwald && rV < rvdw);
-                        if ((c6[i] != 0 || c12[i] != 0) && computeVdwInteraction)
-                        {
-                            RealType rinv6;
-                            if (useSoftCore)
-                            {
-                                rinv6 = rpinvV;
-                            }
-                            else
-                            {
-                                rinv6 = calculateRinv6(rinvV);
-                            }
-                            RealType Vvdw6  = calculateVdw6(c6[i], rinv6);
-                            RealType Vvdw12 = calculateVdw12(c12[i], rinv6);
-
-                            Vvdw[i] = lennardJonesPotential(Vvdw6, Vvdw12, c6[i], c12[i], repulsionShift,
-                                                            dispersionShift, onesixth, onetwelfth);
-                            FscalV[i] = lennardJonesScalarForce(Vvdw6, Vvdw12);
-
-                            if (vdwInteractionTypeIsEwald)
-                            {
-                                /* Subtract the grid potential at the cut-off */
-                                Vvdw[i] += ewaldLennardJonesGridSubtract(nbfp_grid[tj[i]],
-                                                                         sh_lj_ewald, onesixth);
-                            }
-
-                            if (vdwModifierIsPotSwitch)
-                            {
-                                RealType d        = rV - ic->rvdw_switch;
-                                d                 = (d > zero) ? d : zero;
-                                const RealType d2 = d * d;
-                                const RealType sw =
-                                        one + d2 * d * (vdw_swV3 + d * (vdw_swV4 + d * vdw_swV5));
-                                const RealType dsw = d2 * (vdw_swF2 + d * (vdw_swF3 + d * vdw_swF4));
-
-                                FscalV[i] = potSwitchScalarForceMod(FscalV[i], Vvdw[i], sw, rV,
-                                                                    rvdw, dsw, zero);
-                                Vvdw[i]   = potSwitchPotentialMod(Vvdw[i], sw, rV, rvdw, zero);
-                            }
-                        }
-
-                        /* FscalC (and FscalV) now contain: dV/drC * rC
-                         * Now we multiply by rC^-p, so it will be: dV/drC * rC^1-p
-                         * Further down we first multiply by r^p-2 and then by
-                         * the vector r, which in total gives: dV/drC * (r/rC)^1-p
-                         */
-                        FscalC[i] *= rpinvC;
-                        FscalV[i] *= rpinvV;
-                    }
-                } // end for (int i = 0; i < NSTATES; i++)
-
-                /* Assemble A and B states */
-                for (int i = 0; i < NSTATES; i++)
-                {
-                    vctot += LFC[i] * Vcoul[i];
-                    vvtot += LFV[i] * Vvdw[i];
-
-                    Fscal += LFC[i] * FscalC[i] * rpm2;
-                    Fscal += LFV[i] * FscalV[i] * rpm2;
-
-                    if (useSoftCore)
-                    {
-                        dvdl_coul += Vcoul[i] * DLF[i]
-                                     + LFC[i] * alpha_coul_eff * dlfac_coul[i] * FscalC[i] * sigma6[i];
-                        dvdl_vdw += Vvdw[i] * DLF[i]
-                                    + LFV[i] * alpha_vdw_eff * dlfac_vdw[i] * FscalV[i] * sigma6[i];
-                    }
-                    else
-                    {
-                        dvdl_coul += Vcoul[i] * DLF[i];
-                        dvdl_vdw += Vvdw[i] * DLF[i];
-                    }
-                }
-            } // end if (bPairIncluded)
-            else if (icoul == GMX_NBKERNEL_ELEC_REACTIONFIELD)
-            {
-                /* For excluded pairs, which are only in this pair list when
-                 * using the Verlet scheme, we don't use soft-core.
-                 * As there is no singularity, there is no need for soft-core.
-                 */
-                const real FF = -two * krf;
-                RealType   VV = krf * rsq - crf;
-
-                if (ii == jnr)
-                {
-                    VV *= half;
-                }
-
-                for (int i = 0; i < NSTATES; i++)
-                {
-                    vctot += LFC[i] * qq[i] * VV;
-                    Fscal += LFC[i] * qq[i] * FF;
-                    dvdl_coul += DLF[i] * qq[i] * VV;
+                    const BoolType bothRepulsive = (zero < c12[STATE_A]) && (zero < c12[STATE_B]);
+                    alpha_vdw_eff  = gmx::selectByNotMask(RealType(alpha_vdw), bothRepulsive);
+                    alpha_coul_eff = gmx::selectByNotMask(RealType(alpha_coul), bothRepulsive);
                 }
             }
 
-            if (elecInteractionTypeIsEwald && (r < rcoulomb || !bPairIncluded))
+            const bool haveExcludedReactionFieldPair =
+                    (icoul == GMX_NBKERNEL_ELEC_REACTIONFIELD && gmx::anyTrue(bPairExcluded));
+            /* For excluded pairs, which are only in this pair list when
+             * using the Verlet scheme, we don't use soft-core.
+             * As there is no singularity, there is no need for soft-core.
+             */
+            const real     excludedReactionFieldF = -two * krf;
+            const RealType excludedReactionFieldV = (krf * rSq - crf) * selfFactor;
+
+            const BoolType computeElecEwaldCorrection =
+                    (bPairIncluded && r < rcoulomb) || bPairExcluded;
+            const bool haveElecEwaldCorrection =
+                    (elecInteractionTypeIsEwald && gmx::anyTrue(computeElecEwaldCorrection));
+            RealType v_lr = zero;
+            RealType f_lr = zero;
+            if (haveElecEwaldCorrection)
             {
                 /* See comment in the preamble. When using Ewald interactions
                  * (unless we use a switch modifier) we subtract the reciprocal-space
@@ -690,39 +654,38 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * the softcore to the entire electrostatic interaction,
                  * including the reciprocal-space component.
                  */
-                real v_lr, f_lr;
-
-                const RealType ewrt   = r * coulombTableScale;
-                IntType        ewitab = static_cast<IntType>(ewrt);
-                const RealType eweps  = ewrt - ewitab;
-                ewitab                = 4 * ewitab;
-                f_lr                  = ewtab[ewitab] + eweps * ewtab[ewitab + 1];
-                v_lr = (ewtab[ewitab + 2] - coulombTableScaleInvHalf * eweps * (ewtab[ewitab] + f_lr));
-                f_lr *= rinv;
+                const RealType ewrt =
+                        gmx::selectByMask(r, computeElecEwaldCorrection) * coulombTableScale;
+                const RealType ewrtTruncated = gmx::trunc(ewrt);
+                const RealType eweps         = ewrt - ewrtTruncated;
+                gmx::store(tableIndex, ewrtTruncated);
+                for (int s = 0; s < simdWidth; s++)
+                {
+                    const int ewitab = 4 * static_cast<int>(tableIndex[s]);
+                    tableF[s]        = ewtab[ewitab];
+                    tableD[s]        = ewtab[ewitab + 1];
+                    tableV[s]        = ewtab[ewitab + 2];
+                }
+                const RealType ewtabF = gmx::load<RealType>(tableF);
+                f_lr                  = ewtabF + eweps * gmx::load<RealType>(tableD);
+                v_lr                  = (gmx::load<RealType>(tableV)
+                        - coulombTableScaleInvHalf * eweps * (ewtabF + f_lr));
+                f_lr = f_lr * rInv;
 
                 /* Note that any possible Ewald shift has already been applied in
                  * the normal interaction part above.
                  */
 
-                if (ii == jnr)
-                {
-                    /* If we get here, the i particle (ii) has itself (jnr)
-                     * in its neighborlist. This can only happen with the Verlet
-                     * scheme, and corresponds to a self-interaction that will
-                     * occur twice. Scale it down by 50% to only include it once.
-                     */
-                    v_lr *= half;
-                }
-
-                for (int i = 0; i < NSTATES; i++)
-                {
-                    vctot -= LFC[i] * qq[i] * v_lr;
-                    Fscal -= LFC[i] * qq[i] * f_lr;
-                    dvdl_coul -= (DLF[i] * qq[i]) * v_lr;
-                }
+                v_lr = gmx::selectByMask(v_lr * selfFactor, computeElecEwaldCorrection);
+                f_lr = gmx::selectByMask(f_lr, computeElecEwaldCorrection);
             }
 
-            if (vdwInteractionTypeIsEwald && r < rvdw)
+            const BoolType computeVdwEwaldCorrection = computeMask && (r < rvdw);
+            const bool     haveVdwEwaldCorrection =
+                    (vdwInteractionTypeIsEwald && gmx::anyTrue(computeVdwEwaldCorrection));
+            RealType vdwEwaldV = zero;
+            RealType vdwEwaldF = zero;
+            if (haveVdwEwaldCorrection)
             {
                 /* See comment in the preamble. When using LJ-Ewald interactions
                  * (unless we use a switch modifier) we subtract the reciprocal-space
@@ -737,60 +700,280 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * r close to 0 for non-interacting pairs.
                  */
 
-                const RealType rs   = rsq * rinv * vdwTableScale;
-                const IntType  ri   = static_cast<IntType>(rs);
-                const RealType frac = rs - ri;
-                const RealType f_lr = (1 - frac) * tab_ewald_F_lj[ri] + frac * tab_ewald_F_lj[ri + 1];
+                const RealType rs = gmx::selectByMask(r, computeVdwEwaldCorrection) * vdwTableScale;
+                const RealType rsTruncated = gmx::trunc(rs);
+                const RealType frac        = rs - rsTruncated;
+                gmx::store(tableIndex, rsTruncated);
+                for (int s = 0; s < simdWidth; s++)
+                {
+                    const int ri = static_cast<int>(tableIndex[s]);
+                    tableF[s]    = tab_ewald_F_lj[ri];
+                    tableD[s]    = tab_ewald_F_lj[ri + 1];
+                    tableV[s]    = tab_ewald_V_lj[ri];
+                }
+                const RealType tabF = gmx::load<RealType>(tableF);
+                const RealType f_lr_lj = (one - frac) * tabF + frac * gmx::load<RealType>(tableD);
                 /* TODO: Currently the Ewald LJ table does not contain
                  * the factor 1/6, we should add this.
                  */
-                const RealType FF = f_lr * rinv / six;
-                RealType       VV =
-                        (tab_ewald_V_lj[ri] - vdwTableScaleInvHalf * frac * (tab_ewald_F_lj[ri] + f_lr))
-                        / six;
+                vdwEwaldF = gmx::selectByMask(f_lr_lj * rInv / six, computeVdwEwaldCorrection);
+                vdwEwaldV = (gmx::load<RealType>(tableV)
+                             - vdwTableScaleInvHalf * frac * (tabF + f_lr_lj))
+                            / six;
+                vdwEwaldV = gmx::selectByMask(vdwEwaldV * selfFactor, computeVdwEwaldCorrection);
+            }
 
-                if (ii == jnr)
+            /* Now compute and accumulate the interactions for each lambda state */
+            for (int lambdaIndex = 0; lambdaIndex < numLambdas; lambdaIndex++)
+            {
+                const LambdaFactors& lambdaFactors = lambdaFactorsList[lambdaIndex];
+                const auto&          LFC           = lambdaFactors.LFC;
+                const auto&          LFV           = lambdaFactors.LFV;
+                const auto&          lfac_coul     = lambdaFactors.lfac_coul;
+                const auto&          dlfac_coul    = lambdaFactors.dlfac_coul;
+                const auto&          lfac_vdw      = lambdaFactors.lfac_vdw;
+                const auto&          dlfac_vdw     = lambdaFactors.dlfac_vdw;
+
+                RealType& vCTot    = vCTotList[lambdaIndex];
+                RealType& vVTot    = vVTotList[lambdaIndex];
+                RealType& dvdlCoul = dvdlCoulList[lambdaIndex];
+                RealType& dvdlVdw  = dvdlVdwList[lambdaIndex];
+
+                if (haveIncludedPair)
                 {
-                    /* If we get here, the i particle (ii) has itself (jnr)
-                     * in its neighborlist. This can only happen with the Verlet
-                     * scheme, and corresponds to a self-interaction that will
-                     * occur twice. Scale it down by 50% to only include it once.
-                     */
-                    VV *= half;
+                    RealType FscalC[NSTATES], FscalV[NSTATES], Vcoul[NSTATES], Vvdw[NSTATES];
+                    for (int i = 0; i < NSTATES; i++)
+                    {
+                        FscalC[i] = zero;
+                        FscalV[i] = zero;
+                        Vcoul[i]  = zero;
+                        Vvdw[i]   = zero;
+
+                        /* Only spend time on A or B state if it is non-zero */
+                        const BoolType nonZeroState =
+                                bPairIncluded && (qq[i] != zero || c6[i] != zero || c12[i] != zero);
+                        if (gmx::anyTrue(nonZeroState))
+                        {
+                            RealType rinvC, rinvV, rC, rV, rpinvC, rpinvV;
+
+                            /* this section has to be inside the loop because of the dependence on sigma6 */
+                            if (useSoftCore)
+                            {
+                                rpinvC = gmx::maskzInv(
+                                        alpha_coul_eff * lfac_coul[i] * sigma6[i] + rp,
+                                        nonZeroState);
+                                pthRoot(rpinvC, &rinvC, &rC, nonZeroState);
+                                if (scLambdasOrAlphasDiffer)
+                                {
+                                    rpinvV = gmx::maskzInv(
+                                            alpha_vdw_eff * lfac_vdw[i] * sigma6[i] + rp,
+                                            nonZeroState);
+                                    pthRoot(rpinvV, &rinvV, &rV, nonZeroState);
+                                }
+                                else
+                                {
+                                    /* We can avoid one expensive pow and one / operation */
+                                    rpinvV = rpinvC;
+                                    rinvV  = rinvC;
+                                    rV     = rC;
+                                }
+                            }
+                            else
+                            {
+                                rpinvC = one;
+                                rinvC  = rInv;
+                                rC     = r;
+
+                                rpinvV = one;
+                                rinvV  = rInv;
+                                rV     = r;
+                            }
+
+                            /* Only process the coulomb interactions if we have charges,
+                             * and if we either include all entries in the list (no cutoff
+                             * used in the kernel), or if we are within the cutoff.
+                             */
+                            const BoolType computeElecInteraction =
+                                    nonZeroState && (qq[i] != zero)
+                                    && (elecInteractionTypeIsEwald ? (r < rcoulomb)
+                                                                   : (rC < rcoulomb));
+
+                            if (gmx::anyTrue(computeElecInteraction))
+                            {
+                                if (elecInteractionTypeIsEwald)
+                                {
+                                    Vcoul[i]  = ewaldPotential(qq[i], rinvC, sh_ewald);
+                                    FscalC[i] = ewaldScalarForce(qq[i], rinvC);
+                                }
+                                else
+                                {
+                                    Vcoul[i] = reactionFieldPotential(qq[i], rinvC, rC, krf, crf);
+                                    FscalC[i] =
+                                            reactionFieldScalarForce(qq[i], rinvC, rC, krf, two);
+                                }
+                                Vcoul[i]  = gmx::selectByMask(Vcoul[i], computeElecInteraction);
+                                FscalC[i] = gmx::selectByMask(FscalC[i], computeElecInteraction);
+                            }
+
+                            /* Only process the VDW interactions if we have
+                             * some non-zero parameters, and if we either
+                             * include all entries in the list (no cutoff used
+                             * in the kernel), or if we are within the cutoff.
+                             */
+                            const BoolType computeVdwInteraction =
+                                    nonZeroState && (c6[i] != zero || c12[i] != zero)
+                                    && (vdwInteractionTypeIsEwald ? (r < rvdw) : (rV < rvdw));
+
+                            if (gmx::anyTrue(computeVdwInteraction))
+                            {
+                                RealType rinv6;
+                                if (useSoftCore)
+                                {
+                                    rinv6 = rpinvV;
+                                }
+                                else
+                                {
+                                    rinv6 = calculateRinv6(rinvV);
+                                }
+                                RealType Vvdw6  = calculateVdw6(c6[i], rinv6);
+                                RealType Vvdw12 = calculateVdw12(c12[i], rinv6);
+
+                                Vvdw[i]   = lennardJonesPotential(Vvdw6, Vvdw12, c6[i], c12[i],
+                                                                repulsionShift, dispersionShift,
+                                                                onesixth, onetwelfth);
+                                FscalV[i] = lennardJonesScalarForce(Vvdw6, Vvdw12);
+
+                                if (vdwInteractionTypeIsEwald)
+                                {
+                                    /* Subtract the grid potential at the cut-off */
+                                    Vvdw[i] = Vvdw[i]
+                                              + ewaldLennardJonesGridSubtract(
+                                                      gmx::load<RealType>(preloadC6Grid[i]),
+                                                      sh_lj_ewald, onesixth);
+                                }
+
+                                if (vdwModifierIsPotSwitch)
+                                {
+                                    const RealType d =
+                                            gmx::max(rV - ic->rvdw_switch, RealType(zero));
+                                    const RealType d2 = d * d;
+                                    const RealType sw =
+                                            one
+                                            + d2 * d * (vdw_swV3 + d * (vdw_swV4 + d * vdw_swV5));
+                                    const RealType dsw =
+                                            d2 * (vdw_swF2 + d * (vdw_swF3 + d * vdw_swF4));
+
+                                    FscalV[i] = potSwitchScalarForceMod(
+                                            FscalV[i], Vvdw[i], sw, rV, rvdw, dsw);
+                                    Vvdw[i] = potSwitchPotentialMod(Vvdw[i], sw, rV, rvdw);
+                                }
+                                Vvdw[i]   = gmx::selectByMask(Vvdw[i], computeVdwInteraction);
+                                FscalV[i] = gmx::selectByMask(FscalV[i], computeVdwInteraction);
+                            }
+
+                            /* FscalC (and FscalV) now contain: dV/drC * rC
+                             * Now we multiply by rC^-p, so it will be: dV/drC * rC^1-p
+                             * Further down we first multiply by r^p-2 and then by
+                             * the vector r, which in total gives: dV/drC * (r/rC)^1-p
+                             */
+                            FscalC[i] = FscalC[i] * rpinvC;
+                            FscalV[i] = FscalV[i] * rpinvV;
+                        }
+                    } // end for (int i = 0; i < NSTATES; i++)
+
+                    /* Assemble A and B states */
+                    for (int i = 0; i < NSTATES; i++)
+                    {
+                        vCTot = vCTot + LFC[i] * Vcoul[i];
+                        vVTot = vVTot + LFV[i] * Vvdw[i];
+
+                        Fscal = Fscal + LFC[i] * FscalC[i] * rpm2;
+                        Fscal = Fscal + LFV[i] * FscalV[i] * rpm2;
+
+                        if (useSoftCore)
+                        {
+                            dvdlCoul = dvdlCoul + Vcoul[i] * DLF[i]
+                                       + LFC[i] * alpha_coul_eff * dlfac_coul[i] * FscalC[i]
+                                                 * sigma6[i];
+                            dvdlVdw = dvdlVdw + Vvdw[i] * DLF[i]
+                                      + LFV[i] * alpha_vdw_eff * dlfac_vdw[i] * FscalV[i]
+                                                * sigma6[i];
+                        }
+                        else
+                        {
+                            dvdlCoul = dvdlCoul + Vcoul[i] * DLF[i];
+                            dvdlVdw  = dvdlVdw + Vvdw[i] * DLF[i];
+                        }
+                    }
+                } // end if (haveIncludedPair)
+
+                if (haveExcludedReactionFieldPair)
+                {
+                    for (int i = 0; i < NSTATES; i++)
+                    {
+                        const RealType qqExcluded = gmx::selectByMask(qq[i], bPairExcluded);
+                        vCTot    = vCTot + LFC[i] * qqExcluded * excludedReactionFieldV;
+                        Fscal    = Fscal + LFC[i] * qqExcluded * excludedReactionFieldF;
+                        dvdlCoul = dvdlCoul + DLF[i] * qqExcluded * excludedReactionFieldV;
+                    }
                 }
 
-                for (int i = 0; i < NSTATES; i++)
+                if (haveElecEwaldCorrection)
                 {
-                    const real c6grid = nbfp_grid[tj[i]];
-                    vvtot += LFV[i] * c6grid * VV;
-                    Fscal += LFV[i] * c6grid * FF;
-                    dvdl_vdw += (DLF[i] * c6grid) * VV;
+                    for (int i = 0; i < NSTATES; i++)
+                    {
+                        vCTot    = vCTot - LFC[i] * qq[i] * v_lr;
+                        Fscal    = Fscal - LFC[i] * qq[i] * f_lr;
+                        dvdlCoul = dvdlCoul - (DLF[i] * qq[i]) * v_lr;
+                    }
                 }
-            }
 
+                if (haveVdwEwaldCorrection)
+                {
+                    for (int i = 0; i < NSTATES; i++)
+                    {
+                        const RealType c6grid = gmx::load<RealType>(preloadC6Grid[i]);
+                        vVTot                 = vVTot + LFV[i] * c6grid * vdwEwaldV;
+                        Fscal                 = Fscal + LFV[i] * c6grid * vdwEwaldF;
+                        dvdlVdw               = dvdlVdw + (DLF[i] * c6grid) * vdwEwaldV;
+                    }
+                }
+            } // end for (int lambdaIndex = 0; lambdaIndex < numLambdas; lambdaIndex++)
             if (doForces)
             {
-                const real tx = Fscal * dx;
-                const real ty = Fscal * dy;
-                const real tz = Fscal * dz;
-                fix           = fix + tx;
-                fiy           = fiy + ty;
-                fiz           = fiz + tz;
-                /* OpenMP atomics are expensive, but this kernels is also
-                 * expensive, so we can take this hit, instead of using
-                 * thread-local output buffers and extra reduction.
-                 *
-                 * All the OpenMP regions in this file are trivial and should
-                 * not throw, so no need for try/catch.
-                 */
+                const RealType tX = Fscal * dX;
+                const RealType tY = Fscal * dY;
+                const RealType tZ = Fscal * dZ;
+                fIX               = fIX + tX;
+                fIY               = fIY + tY;
+                fIZ               = fIZ + tZ;
+
+                gmx::store(forceJx, tX);
+                gmx::store(forceJy, tY);
+                gmx::store(forceJz, tZ);
+                gmx::store(computeLane, gmx::selectByMask(RealType(one), computeMask));
+                for (int s = 0; s < simdWidth; s++)
+                {
+                    if (computeLane[s] != zero)
+                    {
+                        const int j3 = 3 * jjnr[k + s];
+                        /* OpenMP atomics are expensive, but this kernels is also
+                         * expensive, so we can take this hit, instead of using
+                         * thread-local output buffers and extra reduction.
+                         *
+                         * All the OpenMP regions in this file are trivial and should
+                         * not throw, so no need for try/catch.
+                         */
 #pragma omp atomic
-                f[j3] -= tx;
+                        f[j3] -= forceJx[s];
 #pragma omp atomic
-                f[j3 + 1] -= ty;
+                        f[j3 + 1] -= forceJy[s];
 #pragma omp atomic
-                f[j3 + 2] -= tz;
+                        f[j3 + 2] -= forceJz[s];
+                    }
+                }
             }
-        } // end for (int k = nj0; k < nj1; k++)
+        } // end for (int k = nj0; k < nj1; k += simdWidth)
 
         /* The atomics below are expensive with many OpenMP threads.
          * Here unperturbed i-particles will usually only have a few
@@ -799,46 +982,63 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
          */
         if (npair_within_cutoff > 0)
         {
-            if (doForces)
+            if (doForces || doShiftForces)
             {
+                const real fix = gmx::reduce(fIX);
+                const real fiy = gmx::reduce(fIY);
+                const real fiz = gmx::reduce(fIZ);
+                if (doForces)
+                {
 #pragma omp atomic
-                f[ii3] += fix;
+                    f[ii3] += fix;
 #pragma omp atomic
-                f[ii3 + 1] += fiy;
+                    f[ii3 + 1] += fiy;
 #pragma omp atomic
-                f[ii3 + 2] += fiz;
-            }
-            if (doShiftForces)
-            {
+                    f[ii3 + 2] += fiz;
+                }
+                if (doShiftForces)
+                {
 #pragma omp atomic
-                fshift[is3] += fix;
+                    fshift[is3] += fix;
 #pragma omp atomic
-                fshift[is3 + 1] += fiy;
+                    fshift[is3 + 1] += fiy;
 #pragma omp atomic
-                fshift[is3 + 2] += fiz;
+                    fshift[is3 + 2] += fiz;
+                }
             }
             if (doPotential)
             {
-                int ggid = gid[n];
+                for (int lambdaIndex = 0; lambdaIndex < numLambdas; lambdaIndex++)
+                {
+                    const real vctot = gmx::reduce(vCTotList[lambdaIndex]);
+                    const real vvtot = gmx::reduce(vVTotList[lambdaIndex]);
+                    int        ggid  = lambdaIndex * numEnergyGroupPairs + gid[n];
 #pragma omp atomic
-                Vc[ggid] += vctot;
+                    Vc[ggid] += vctot;
 #pragma omp atomic
-                Vv[ggid] += vvtot;
+                    Vv[ggid] += vvtot;
+                }
             }
         }
     } // end for (int n = 0; n < nri; n++)
 
+    for (int lambdaIndex = 0; lambdaIndex < numLambdas; lambdaIndex++)
+    {
+        const real dvdl_coul = gmx::reduce(dvdlCoulList[lambdaIndex]);
+        const real dvdl_vdw  = gmx::reduce(dvdlVdwList[lambdaIndex]);
 #pragma omp atomic
-    dvdl[efptCOUL] += dvdl_coul;
+        dvdl[lambdaIndex * efptNR + efptCOUL] += dvdl_coul;
 #pragma omp atomic
-    dvdl[efptVDW] += dvdl_vdw;
+        dvdl[lambdaIndex * efptNR + efptVDW] += dvdl_vdw;
+    }
 
     /* Estimate flops, average for free energy stuff:
      * 12  flops per outer iteration
-     * 150 flops per inner iteration
+     * 150 flops per inner iteration and lambda state
      */
 #pragma omp atomic
-    inc_nrnb(nrnb, eNR_NBKERNEL_FREE_ENERGY, nlist->nri * 12 + nlist->jindex[nri] * 150);
+    inc_nrnb(nrnb, eNR_NBKERNEL_FREE_ENERGY,
+             nlist->nri * 12 + nlist->jindex[nri] * 150 * numLambdas);
 }
 
 typedef void (*KernelFunction)(const t_nblist* gmx_restrict nlist,
@@ -855,8 +1055,7 @@ static KernelFunction dispatchKernelOnUseSimd(const bool useSimd)
     if (useSimd)
     {
 #if GMX_SIMD_HAVE_REAL && GMX_SIMD_HAVE_INT32_ARITHMETICS && GMX_USE_SIMD_KERNELS
-        /* FIXME: Here SimdDataTypes should be used to enable SIMD. So far, the code in nb_free_energy_kernel is not adapted to SIMD */
-        return (nb_free_energy_kernel<ScalarDataTypes, useSoftCore, scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald,
+        return (nb_free_energy_kernel<SimdDataTypes, useSoftCore, scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald,
                                       elecInteractionTypeIsEwald, vdwModifierIsPotSwitch>);
 #else
         return (nb_free_energy_kernel<ScalarDataTypes, useSoftCore, scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald,
@@ -987,10 +1186,14 @@ void gmx_nb_free_energy_kernel(const t_nblist*            nlist,
     }
     else
     {
-        if (kernel_data->lambda[efptCOUL] == kernel_data->lambda[efptVDW]
-            && scParams.alphaCoulomb == scParams.alphaVdw)
+        scLambdasOrAlphasDiffer = (scParams.alphaCoulomb != scParams.alphaVdw);
+        for (int lambdaIndex = 0; lambdaIndex < kernel_data->numLambdas; lambdaIndex++)
         {
-            scLambdasOrAlphasDiffer = false;
+            const real* lambda = kernel_data->lambda + lambdaIndex * efptNR;
+            if (lambda[efptCOUL] != lambda[efptVDW])
+            {
+                scLambdasOrAlphasDiffer = true;
+            }
         }
     }
 
@@ -53,6 +53,12 @@ typedef struct
 {
     int                    flags;
     const struct t_blocka* exclusions;
+    /* The number of lambda states to compute. lambda and dvdl contain
+     * efptNR entries and the potential arrays numEnergyGroupPairs
+     * entries for each state. Forces can only be computed for one state.
+     */
+    int                    numLambdas;
+    int                    numEnergyGroupPairs;
     const real*            lambda;
     real*                  dvdl;
 
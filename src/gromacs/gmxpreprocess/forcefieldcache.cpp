@@ -0,0 +1,376 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the cache of parsed force-field parameters for grompp.
+ *
+ * \ingroup module_preprocessing
+ */
+#include "gmxpre.h"
+
+#include "forcefieldcache.h"
+
+#include "config.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+
+#include "gromacs/fileio/md5.h"
+#include "gromacs/gmxpreprocess/gpp_atomtype.h"
+#include "gromacs/gmxpreprocess/gpp_bond_atomtype.h"
+#include "gromacs/gmxpreprocess/grompp_impl.h"
+#include "gromacs/gmxpreprocess/toppush.h"
+#include "gromacs/topology/atoms.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/symtab.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/inmemoryserializer.h"
+#include "gromacs/utility/path.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/sysinfo.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Identifies cache files, to be changed when the stored state changes.
+const char* const c_cacheFormat = "grompp force-field cache version 1";
+
+//! Appends \p size bytes at \p data to the MD5 sum in \p state.
+void appendToMD5(md5_state_t* state, const void* data, std::size_t size)
+{
+    gmx_md5_append(state, static_cast<const md5_byte_t*>(data), static_cast<int>(size));
+}
+
+//! Returns the MD5 sum of \p data.
+std::array<unsigned char, 16> computeMD5(ArrayRef<const char> data)
+{
+    md5_state_t state;
+    gmx_md5_init(&state);
+    appendToMD5(&state, data.data(), data.size());
+    return gmx_md5_finish(&state);
+}
+
+//! Reads or writes \p interactionType, which is constructed when reading.
+void serializeInteractionType(ISerializer* serializer, InteractionOfType* interactionType)
+{
+    int numAtoms = interactionType->atoms().ssize();
+    serializer->doInt(&numAtoms);
+    std::vector<int> atoms(interactionType->atoms().begin(), interactionType->atoms().end());
+    atoms.resize(numAtoms);
+    serializer->doIntArray(atoms.data(), numAtoms);
+    std::array<real, MAXFORCEPARAM> forceParam;
+    std::copy(interactionType->forceParam().begin(), interactionType->forceParam().end(),
+              forceParam.begin());
+    serializer->doRealArray(forceParam.data(), MAXFORCEPARAM);
+    std::string name = interactionType->interactionTypeName();
+    serializer->doString(&name);
+    if (serializer->reading())
+    {
+        *interactionType = InteractionOfType(atoms, forceParam, name);
+    }
+}
+
+//! Reads or writes \p values.
+void serializeVector(ISerializer* serializer, std::vector<int>* values)
+{
+    int size = values->size();
+    serializer->doInt(&size);
+    values->resize(size);
+    serializer->doIntArray(values->data(), size);
+}
+
+//! Reads or writes \p values.
+void serializeVector(ISerializer* serializer, std::vector<real>* values)
+{
+    int size = values->size();
+    serializer->doInt(&size);
+    values->resize(size);
+    serializer->doRealArray(values->data(), size);
+}
+
+//! Reads or writes the state of the force field, which is to be empty when reading.
+void serializeForceFieldState(ISerializer*           serializer,
+                              const ForceFieldState& state,
+                              int                    initialSymbolCount)
+{
+    serializer->doBool(state.haveDefaults);
+    serializer->doBool(state.generatePairs);
+    serializer->doInt(state.nonbondedFunction);
+    serializer->doInt(state.combinationRule);
+    serializer->doDouble(state.repulsionPower);
+    serializer->doReal(state.fudgeQQ);
+    serializer->doReal(state.fudgeLJ);
+
+    /* The names are stored first, so the symbol table gets the same
+     * order as when the force field is parsed.
+     */
+    int numSymbols = state.symtab->nr - initialSymbolCount;
+    serializer->doInt(&numSymbols);
+    for (int i = 0; i < numSymbols; i++)
+    {
+        std::string symbol;
+        if (!serializer->reading())
+        {
+            symbol = *get_symtab_handle(state.symtab, initialSymbolCount + i);
+        }
+        serializer->doString(&symbol);
+        if (serializer->reading())
+        {
+            put_symtab(state.symtab, symbol.c_str());
+        }
+    }
+
+    int numBondAtomTypes = state.bondAtomTypes->size();
+    serializer->doInt(&numBondAtomTypes);
+    for (int i = 0; i < numBondAtomTypes; i++)
+    {
+        std::string name;
+        if (!serializer->reading())
+        {
+            name = state.bondAtomTypes->atomNameFromBondAtomType(i);
+        }
+        serializer->doString(&name);
+        if (serializer->reading())
+        {
+            state.bondAtomTypes->addBondAtomType(state.symtab, name);
+        }
+    }
+
+    int numAtomTypes = state.atomTypes->size();
+    serializer->doInt(&numAtomTypes);
+    for (int i = 0; i < numAtomTypes; i++)
+    {
+        std::string       name;
+        t_atom            atom = {};
+        InteractionOfType nonbonded({}, {});
+        int               bondAtomType = 0;
+        int               atomNumber   = 0;
+        if (!serializer->reading())
+        {
+            name         = state.atomTypes->atomNameFromAtomType(i);
+            atom         = *state.atomTypes->atomFromAtomType(i);
+            nonbonded    = *state.atomTypes->nonBondedInteractionFromAtomType(i);
+            bondAtomType = state.atomTypes->bondAtomTypeFromAtomType(i);
+            atomNumber   = state.atomTypes->atomNumberFromAtomType(i);
+        }
+        serializer->doString(&name);
+        serializer->doReal(&atom.m);
+        serializer->doReal(&atom.q);
+        serializer->doReal(&atom.mB);
+        serializer->doReal(&atom.qB);
+        serializer->doUShort(&atom.type);
+        serializer->doUShort(&atom.typeB);
+        serializer->doInt(&atom.ptype);
+        serializer->doInt(&atom.resind);
+        serializer->doInt(&atom.atomnumber);
+        serializer->doCharArray(atom.elem, sizeof(atom.elem));
+        serializeInteractionType(serializer, &nonbonded);
+        serializer->doInt(&bondAtomType);
+        serializer->doInt(&atomNumber);
+        if (serializer->reading())
+        {
+            state.atomTypes->addType(state.symtab, atom, name, nonbonded, bondAtomType, atomNumber);
+        }
+    }
+
+    for (InteractionsOfType& interactions : state.interactionTypes)
+    {
+        int numTypes = interactions.interactionTypes.size();
+        serializer->doInt(&numTypes);
+        if (serializer->reading())
+        {
+            interactions.interactionTypes.resize(numTypes, InteractionOfType({}, {}));
+        }
+        for (InteractionOfType& interactionType : interactions.interactionTypes)
+        {
+            serializeInteractionType(serializer, &interactionType);
+        }
+        serializer->doInt(&interactions.cmakeGridSpacing);
+        serializer->doInt(&interactions.cmapAngles);
+        serializeVector(serializer, &interactions.cmap);
+        serializeVector(serializer, &interactions.cmapAtomTypes);
+    }
+
+    serializeNonbondedParameters(serializer, state.nonbondedParameters, numAtomTypes);
+    if (*state.generatePairs)
+    {
+        serializeNonbondedParameters(serializer, state.pairParameters, numAtomTypes);
+    }
+}
+
+} // namespace
+
+std::unique_ptr<ForceFieldCache> ForceFieldCache::createFromEnvironment(const t_symtab& symtab)
+{
+    const char* directory = std::getenv("GMX_GROMPP_CACHE_DIR");
+    if (directory == nullptr || directory[0] == '\0')
+    {
+        return nullptr;
+    }
+    return std::make_unique<ForceFieldCache>(directory, symtab);
+}
+
+ForceFieldCache::ForceFieldCache(const std::string& directory, const t_symtab& symtab) :
+    directory_(directory),
+    initialSymbolCount_(symtab.nr)
+{
+}
+
+bool ForceFieldCache::isForceFieldDirective(Directive directive)
+{
+    switch (directive)
+    {
+        case Directive::d_defaults:
+        case Directive::d_atomtypes:
+        case Directive::d_bondtypes:
+        case Directive::d_constrainttypes:
+        case Directive::d_pairtypes:
+        case Directive::d_angletypes:
+        case Directive::d_dihedraltypes:
+        case Directive::d_nonbond_params:
+        case Directive::d_implicit_genborn_params:
+        case Directive::d_implicit_surface_params:
+        case Directive::d_cmaptypes: return true;
+        default: return false;
+    }
+}
+
+void ForceFieldCache::addLine(Directive   directive,
+                              const char* text,
+                              const char* fileName,
+                              int         lineNumber)
+{
+    lines_.push_back({ directive, text, fileName, lineNumber });
+}
+
+std::string ForceFieldCache::fileName() const
+{
+    md5_state_t state;
+    gmx_md5_init(&state);
+    appendToMD5(&state, c_cacheFormat, std::strlen(c_cacheFormat));
+    const bool isDouble = GMX_DOUBLE;
+    appendToMD5(&state, &isDouble, sizeof(isDouble));
+    for (const Line& line : lines_)
+    {
+        const int directive = static_cast<int>(line.directive);
+        appendToMD5(&state, &directive, sizeof(directive));
+        // Include the terminating null character to separate the lines
+        appendToMD5(&state, line.text.c_str(), line.text.size() + 1);
+    }
+    std::string digest;
+    for (unsigned char byte : gmx_md5_finish(&state))
+    {
+        digest += formatString("%02x", byte);
+    }
+    return Path::join(directory_, "grompp-ff-" + digest + ".cache");
+}
+
+bool ForceFieldCache::read(const ForceFieldState& state) const
+{
+    std::FILE* file = std::fopen(fileName().c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    /* The file contains the MD5 sum of the serialized state followed
+     * by that state. A mismatch means the file was damaged and is
+     * treated as a cache miss.
+     */
+    std::array<unsigned char, 16> checksum;
+
+    bool isValid = (std::fread(checksum.data(), 1, checksum.size(), file) == checksum.size());
+
+    std::vector<char>       buffer;
+    std::array<char, 65536> chunk;
+    std::size_t             numRead;
+    while (isValid && (numRead = std::fread(chunk.data(), 1, chunk.size(), file)) > 0)
+    {
+        buffer.insert(buffer.end(), chunk.begin(), chunk.begin() + numRead);
+    }
+    std::fclose(file);
+    if (!isValid || buffer.empty() || computeMD5(buffer) != checksum)
+    {
+        return false;
+    }
+
+    InMemoryDeserializer deserializer(buffer, GMX_DOUBLE);
+    std::string          format;
+    deserializer.doString(&format);
+    if (format != c_cacheFormat)
+    {
+        return false;
+    }
+    serializeForceFieldState(&deserializer, state, initialSymbolCount_);
+    return true;
+}
+
+void ForceFieldCache::write(const ForceFieldState& state) const
+{
+    InMemorySerializer serializer;
+    std::string        format = c_cacheFormat;
+    serializer.doString(&format);
+    serializeForceFieldState(&serializer, state, initialSymbolCount_);
+    const std::vector<char>             buffer   = serializer.finishAndGetBuffer();
+    const std::array<unsigned char, 16> checksum = computeMD5(buffer);
+
+    /* Write to a file private to this process and rename it, so that
+     * concurrent runs never see a partially written cache entry.
+     */
+    const std::string cacheFileName = fileName();
+    const std::string tempFileName  = formatString("%s.%d", cacheFileName.c_str(), gmx_getpid());
+    std::FILE*        file          = std::fopen(tempFileName.c_str(), "wb");
+    bool              isWritten     = (file != nullptr);
+    if (isWritten)
+    {
+        isWritten = (std::fwrite(checksum.data(), 1, checksum.size(), file) == checksum.size()
+                     && std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size());
+        isWritten = (std::fclose(file) == 0) && isWritten;
+    }
+    if (!isWritten || gmx_file_rename(tempFileName.c_str(), cacheFileName.c_str()) != 0)
+    {
+        std::remove(tempFileName.c_str());
+        std::fprintf(stderr, "Could not write the force-field cache file %s\n",
+                     cacheFileName.c_str());
+    }
+}
+
+} // namespace gmx
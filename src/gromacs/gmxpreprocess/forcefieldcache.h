@@ -0,0 +1,168 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Declares a cache of the force-field parameters that grompp reads
+ * from the topology before the first molecule type.
+ *
+ * \ingroup module_preprocessing
+ */
+#ifndef GMX_GMXPREPROCESS_FORCEFIELDCACHE_H
+#define GMX_GMXPREPROCESS_FORCEFIELDCACHE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gromacs/gmxpreprocess/topdirs.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+
+class PreprocessingAtomTypes;
+class PreprocessingBondAtomType;
+struct InteractionsOfType;
+struct t_nbparam;
+struct t_symtab;
+
+namespace gmx
+{
+
+/*! \internal \brief
+ * Pointers to the state read_topol() builds from the force-field directives.
+ */
+struct ForceFieldState
+{
+    //! Whether the defaults directive was read.
+    bool* haveDefaults;
+    //! Whether pair parameters are generated.
+    bool* generatePairs;
+    //! The nonbonded function type.
+    int* nonbondedFunction;
+    //! The combination rule.
+    int* combinationRule;
+    //! Power of the repulsion term.
+    double* repulsionPower;
+    //! Scaling of 1-4 electrostatics.
+    real* fudgeQQ;
+    //! Scaling of 1-4 Lennard-Jones interactions.
+    real* fudgeLJ;
+    //! The symbol table the names are stored in.
+    t_symtab* symtab;
+    //! The atom types.
+    PreprocessingAtomTypes* atomTypes;
+    //! The bonded atom types.
+    PreprocessingBondAtomType* bondAtomTypes;
+    //! The interaction types of all interaction functions.
+    ArrayRef<InteractionsOfType> interactionTypes;
+    //! Explicit nonbonded parameters of pairs of atom types.
+    t_nbparam*** nonbondedParameters;
+    //! Explicit 1-4 parameters of pairs of atom types, only with generated pairs.
+    t_nbparam*** pairParameters;
+};
+
+/*! \internal \brief
+ * Cache of the parsed force field, keyed by the preprocessed topology lines.
+ *
+ * Parsing the force-field directives is a large part of the run time
+ * of grompp for large force fields, mainly because of the checks for
+ * repeated parameters. The lines of these directives up to the first
+ * molecule type are collected instead of processed. Their MD5 sum
+ * after preprocessing, so including the effect of defines and
+ * includes, identifies a cache file. When that exists, the state is
+ * read from it. Otherwise the lines are to be processed as usual,
+ * after which the state is written to the cache. Entries are only
+ * written when processing gave no notes, warnings or errors, so using
+ * the cache never hides these.
+ */
+class ForceFieldCache
+{
+public:
+    //! A collected line of a force-field directive.
+    struct Line
+    {
+        //! The directive the line belongs to.
+        Directive directive;
+        //! The line, with comments and continuations processed.
+        std::string text;
+        //! The file the line was read from.
+        std::string fileName;
+        //! The line number in that file.
+        int lineNumber;
+    };
+
+    /*! \brief Returns the cache in the directory set by GMX_GROMPP_CACHE_DIR, or nullptr.
+     *
+     * \param[in] symtab  The symbol table, before any force field names are added.
+     */
+    static std::unique_ptr<ForceFieldCache> createFromEnvironment(const t_symtab& symtab);
+
+    /*! \brief Sets up a cache in \p directory
+     *
+     * \param[in] directory  Directory with the cache files.
+     * \param[in] symtab     The symbol table, before any force field names are added.
+     */
+    ForceFieldCache(const std::string& directory, const t_symtab& symtab);
+
+    //! Returns whether \p directive is one that is collected.
+    static bool isForceFieldDirective(Directive directive);
+
+    //! Collects a line of a force-field directive.
+    void addLine(Directive directive, const char* text, const char* fileName, int lineNumber);
+    //! Returns the collected lines.
+    ArrayRef<const Line> lines() const { return lines_; }
+
+    /*! \brief Reads the state for the collected lines from the cache
+     *
+     * \returns Whether there was a cache entry.
+     */
+    bool read(const ForceFieldState& state) const;
+    //! Writes the state for the collected lines to the cache.
+    void write(const ForceFieldState& state) const;
+
+private:
+    //! Returns the name of the cache file for the collected lines.
+    std::string fileName() const;
+
+    //! The cache directory.
+    std::string directory_;
+    //! Number of symbols in the symbol table before the force field.
+    int initialSymbolCount_;
+    //! The collected lines.
+    std::vector<Line> lines_;
+};
+
+} // namespace gmx
+
+#endif
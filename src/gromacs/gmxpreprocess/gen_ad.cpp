@@ -47,6 +47,8 @@
 
 #include <algorithm>
 #include <numeric>
+#include <utility>
+#include <vector>
 
 #include "gromacs/fileio/confio.h"
 #include "gromacs/gmxpreprocess/gpp_nextnb.h"
@@ -143,6 +145,12 @@ static bool is_dihedral_on_same_bond(const InteractionOfType& p1, const Interact
 }
 
 
+/* Returns the atoms of the central bond of p, with the lowest index first */
+static std::pair<int, int> centralBond(const InteractionOfType& p)
+{
+    return { std::min(p.aj(), p.ak()), std::max(p.aj(), p.ak()) };
+}
+
 static bool preq(const InteractionOfType& p1, const InteractionOfType& p2)
 {
     return (p1.ai() == p2.ai()) && (p1.aj() == p2.aj());
@@ -150,23 +158,8 @@ static bool preq(const InteractionOfType& p1, const InteractionOfType& p2)
 
 static void rm2par(std::vector<InteractionOfType>* p, peq eq)
 {
-    if (p->empty())
-    {
-        return;
-    }
-
-    for (auto param = p->begin() + 1; param != p->end();)
-    {
-        auto prev = param - 1;
-        if (eq(*param, *prev))
-        {
-            param = p->erase(param);
-        }
-        else
-        {
-            ++param;
-        }
-    }
+    /* Erasing the doubles one by one is quadratic in the list length */
+    p->erase(std::unique(p->begin(), p->end(), eq), p->end());
 }
 
 static void cppar(gmx::ArrayRef<const InteractionOfType> types, gmx::ArrayRef<InteractionsOfType> plist, int ftype)
@@ -268,6 +261,21 @@ static std::vector<InteractionOfType> clean_dih(gmx::ArrayRef<const InteractionO
             }
         }
     }
+    /* The central bonds of the impropers, sorted for binary search,
+     * so the cost does not grow quadratically with the system size. */
+    std::vector<std::pair<int, int>> improperBonds;
+    if (bRemoveDihedralIfWithImproper)
+    {
+        improperBonds.reserve(improper.size());
+        for (const auto& imp : improper)
+        {
+            improperBonds.emplace_back(centralBond(imp));
+        }
+        std::sort(improperBonds.begin(), improperBonds.end());
+    }
+
+    std::vector<InteractionOfType> finalDihedrals;
+    finalDihedrals.reserve(newDihedrals.size());
     int k = 0;
     for (auto dihedral = newDihedrals.begin(); dihedral != newDihedrals.end();)
     {
@@ -277,10 +285,8 @@ static std::vector<InteractionOfType> clean_dih(gmx::ArrayRef<const InteractionO
         {
             /* Remove the dihedral if there is an improper on the same
              * bond. */
-            for (auto imp = improper.begin(); imp != improper.end() && bKeep; ++imp)
-            {
-                bKeep = !is_dihedral_on_same_bond(dihedral->first, *imp);
-            }
+            bKeep = !std::binary_search(improperBonds.begin(), improperBonds.end(),
+                                        centralBond(dihedral->first));
         }
 
         if (bKeep)
@@ -316,21 +322,16 @@ static std::vector<InteractionOfType> clean_dih(gmx::ArrayRef<const InteractionO
             }
             if (k == bestl)
             {
+                finalDihedrals.emplace_back(dihedral->first);
                 ++dihedral;
             }
             k++;
         }
         else
         {
-            dihedral = newDihedrals.erase(dihedral);
+            ++dihedral;
         }
     }
-    std::vector<InteractionOfType> finalDihedrals;
-    finalDihedrals.reserve(newDihedrals.size());
-    for (const auto& param : newDihedrals)
-    {
-        finalDihedrals.emplace_back(param.first);
-    }
     return finalDihedrals;
 }
 
@@ -751,6 +752,7 @@ void gen_pad(t_atoms*                               atoms,
          * generally true. Go through the angle and dihedral hackblocks to add
          * entries that we have not yet marked as matched when going through bonds.
          */
+        const std::vector<int> residueFirstAtom = residueFirstAtoms(atoms);
         for (int i = 0; i < atoms->nres; i++)
         {
             /* Add remaining angles from hackblock */
@@ -779,7 +781,8 @@ void gen_pad(t_atoms*                               atoms,
                         p++;
                         res++;
                     }
-                    atomNumbers.emplace_back(search_res_atom(p, res, atoms, "angle", TRUE));
+                    atomNumbers.emplace_back(
+                            search_res_atom(p, res, residueFirstAtom, atoms, "angle", TRUE));
                     bFound = (atomNumbers.back() != -1);
                 }
 
@@ -817,7 +820,8 @@ void gen_pad(t_atoms*                               atoms,
                         p++;
                         res++;
                     }
-                    atomNumbers.emplace_back(search_res_atom(p, res, atoms, "dihedral", TRUE));
+                    atomNumbers.emplace_back(
+                            search_res_atom(p, res, residueFirstAtom, atoms, "dihedral", TRUE));
                     bFound = (atomNumbers.back() != -1);
                 }
 
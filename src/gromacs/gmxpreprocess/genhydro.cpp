@@ -66,13 +66,14 @@ static void copy_atom(const t_atoms* atoms1, int a1, t_atoms* atoms2, int a2, t_
     atoms2->atomname[a2] = put_symtab(symtab, *atoms1->atomname[a1]);
 }
 
-static int pdbasearch_atom(const char* name, int resind, const t_atoms* pdba, const char* searchtype, bool bAllowMissing)
+static int pdbasearch_atom(const char*              name,
+                           int                      resind,
+                           gmx::ArrayRef<const int> residueFirstAtom,
+                           const t_atoms*           pdba,
+                           const char*              searchtype,
+                           bool                     bAllowMissing)
 {
-    int i;
-
-    for (i = 0; (i < pdba->nr) && (pdba->atom[i].resind != resind); i++) {}
-
-    return search_atom(name, i, pdba, searchtype, bAllowMissing);
+    return search_atom(name, residueFirstAtom[resind], pdba, searchtype, bAllowMissing);
 }
 
 static void hacksearch_atom(int*                                            ii,
@@ -80,17 +81,20 @@ static void hacksearch_atom(int*                                            ii,
                             const char*                                     name,
                             gmx::ArrayRef<const std::vector<MoleculePatch>> patches,
                             int                                             resind,
+                            gmx::ArrayRef<const int>                        residueFirstAtom,
                             const t_atoms*                                  pdba)
 {
-    int i;
-
     *ii = -1;
     if (name[0] == '-')
     {
         name++;
         resind--;
     }
-    for (i = 0; (i < pdba->nr) && (pdba->atom[i].resind != resind); i++) {}
+    int i = pdba->nr;
+    if (resind >= 0 && residueFirstAtom[resind] >= 0)
+    {
+        i = residueFirstAtom[resind];
+    }
     for (; (i < pdba->nr) && (pdba->atom[i].resind == resind) && (*ii < 0); i++)
     {
         int j = 0;
@@ -271,6 +275,8 @@ static void expand_hackblocks(const t_atoms*                             pdba,
 
 static int check_atoms_present(const t_atoms* pdba, gmx::ArrayRef<std::vector<MoleculePatch>> patches)
 {
+    const std::vector<int> residueFirstAtom = residueFirstAtoms(pdba);
+
     int nadd = 0;
     for (int i = 0; i < pdba->nr; i++)
     {
@@ -283,7 +289,8 @@ static int check_atoms_present(const t_atoms* pdba, gmx::ArrayRef<std::vector<Mo
                 {
                     /* we're adding */
                     /* check if the atom is already present */
-                    int k = pdbasearch_atom(patch->nname.c_str(), rnr, pdba, "check", TRUE);
+                    int k = pdbasearch_atom(patch->nname.c_str(), rnr, residueFirstAtom, pdba,
+                                            "check", TRUE);
                     if (k != -1)
                     {
                         /* We found the added atom. */
@@ -325,6 +332,8 @@ static void calc_all_pos(const t_atoms*                            pdba,
 
     int jj = 0;
 
+    const std::vector<int> residueFirstAtom = residueFirstAtoms(pdba);
+
     for (int i = 0; i < pdba->nr; i++)
     {
         int rnr = pdba->atom[i].resind;
@@ -339,13 +348,14 @@ static void calc_all_pos(const t_atoms*                            pdba,
                 bool bFoundAll = true;
                 for (int m = 0; (m < patch->nctl && bFoundAll); m++)
                 {
-                    int ia = pdbasearch_atom(patch->a[m].c_str(), rnr, pdba,
+                    int ia = pdbasearch_atom(patch->a[m].c_str(), rnr, residueFirstAtom, pdba,
                                              bCheckMissing ? "atom" : "check", !bCheckMissing);
                     if (ia < 0)
                     {
                         /* not found in original atoms, might still be in
                          * the patch Instructions (patches) */
-                        hacksearch_atom(&ii, &jj, patch->a[m].c_str(), patches, rnr, pdba);
+                        hacksearch_atom(&ii, &jj, patch->a[m].c_str(), patches, rnr,
+                                        residueFirstAtom, pdba);
                         if (ii >= 0)
                         {
                             copy_rvec(patches[ii][jj].newx, xa[m]);
@@ -157,6 +157,16 @@ real PreprocessingAtomTypes::atomNonBondedParamFromAtomType(int nt, int param) c
     return forceParam[param];
 }
 
+const t_atom* PreprocessingAtomTypes::atomFromAtomType(int nt) const
+{
+    return isSet(nt) ? &impl_->types[nt].atom_ : nullptr;
+}
+
+const InteractionOfType* PreprocessingAtomTypes::nonBondedInteractionFromAtomType(int nt) const
+{
+    return isSet(nt) ? &impl_->types[nt].nb_ : nullptr;
+}
+
 PreprocessingAtomTypes::PreprocessingAtomTypes() : impl_(new Impl) {}
 
 PreprocessingAtomTypes::PreprocessingAtomTypes(PreprocessingAtomTypes&& old) noexcept :
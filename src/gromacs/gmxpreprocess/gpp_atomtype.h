@@ -153,6 +153,22 @@ public:
      */
     real atomNonBondedParamFromAtomType(int nt, int param) const;
 
+    /*! \brief
+     * Get the atom information of atom type \p nt.
+     *
+     * \param[in] nt Internal number of atom type.
+     * \returns The atom information, or nullptr when \p nt is not set.
+     */
+    const t_atom* atomFromAtomType(int nt) const;
+
+    /*! \brief
+     * Get the nonbonded parameters of atom type \p nt.
+     *
+     * \param[in] nt Internal number of atom type.
+     * \returns The nonbonded parameters, or nullptr when \p nt is not set.
+     */
+    const InteractionOfType* nonBondedInteractionFromAtomType(int nt) const;
+
     /*! \brief
      * If a value is within the range of the current types or not.
      *
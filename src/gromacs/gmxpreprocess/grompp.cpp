@@ -46,6 +46,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <sys/types.h>
@@ -102,6 +103,7 @@
 #include "gromacs/utility/filestream.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/keyvaluetreebuilder.h"
 #include "gromacs/utility/listoflists.h"
 #include "gromacs/utility/logger.h"
@@ -235,6 +237,47 @@ void InteractionOfType::setForceParameter(int pos, real value)
     forceParam_[pos] = value;
 }
 
+InteractionTypeIndex::Key InteractionTypeIndex::makeKey(gmx::ArrayRef<const int> atoms)
+{
+    GMX_ASSERT(atoms.size() <= MAXATOMLIST, "Interaction types can not have more atoms");
+    Key key;
+    key.fill(-1);
+    key[0] = atoms.ssize();
+    std::copy(atoms.begin(), atoms.end(), key.begin() + 1);
+    return key;
+}
+
+size_t InteractionTypeIndex::KeyHash::operator()(const Key& key) const
+{
+    size_t hash = 0;
+    for (const int value : key)
+    {
+        hash = hash * 1000003 ^ std::hash<int>()(value);
+    }
+    return hash;
+}
+
+int InteractionTypeIndex::find(const std::vector<InteractionOfType>& types,
+                               gmx::ArrayRef<const int>              atoms)
+{
+    if (types.size() < numIndexed_)
+    {
+        clear();
+    }
+    for (; numIndexed_ < types.size(); numIndexed_++)
+    {
+        firstPosition_.emplace(makeKey(types[numIndexed_].atoms()), static_cast<int>(numIndexed_));
+    }
+    const auto found = firstPosition_.find(makeKey(atoms));
+    return found != firstPosition_.end() ? found->second : -1;
+}
+
+void InteractionTypeIndex::clear()
+{
+    firstPosition_.clear();
+    numIndexed_ = 0;
+}
+
 void MoleculeInformation::initMolInfo()
 {
     init_block(&mols);
@@ -317,6 +360,109 @@ static int check_atom_names(const char*          fn1,
     return nmismatch;
 }
 
+//! A bond with a short oscillational period, a1 is -1 when there is none.
+struct ShortBond
+{
+    //! First atom of the bond.
+    int a1 = -1;
+    //! Second atom of the bond.
+    int a2 = -1;
+    //! Squared oscillational period of the bond.
+    real period2 = -1.0;
+};
+
+/*! \brief Returns the first bond in \p moltype with the shortest squared period below \p limit2
+ * that is not constrained.
+ *
+ * Only the harmonic bond types are checked. The atom pairs in
+ * constraints and settles are put in a sorted list, so each short
+ * bond is checked with a binary search instead of a loop over all
+ * constraints.
+ */
+static ShortBond findShortestUnconstrainedBond(const gmx_moltype_t&           moltype,
+                                               gmx::ArrayRef<const t_iparams> ip,
+                                               real                           limit2)
+{
+    const real              twopi2 = gmx::square(2 * M_PI);
+    const t_atom*           atom   = moltype.atoms.atom;
+    const InteractionLists& ilist  = moltype.ilist;
+    const InteractionList&  ilc    = ilist[F_CONSTR];
+    const InteractionList&  ils    = ilist[F_SETTLE];
+
+    std::vector<std::pair<int, int>> constrainedPairs;
+    const auto addPair = [&constrainedPairs](int a1, int a2) {
+        constrainedPairs.emplace_back(std::min(a1, a2), std::max(a1, a2));
+    };
+    for (int j = 0; j < ilc.size(); j += 3)
+    {
+        addPair(ilc.iatoms[j + 1], ilc.iatoms[j + 2]);
+    }
+    for (int j = 0; j < ils.size(); j += 4)
+    {
+        /* Settles constrain all pairs of their three atoms, including a pair of the same atom */
+        for (int k = 1; k <= 3; k++)
+        {
+            for (int l = k; l <= 3; l++)
+            {
+                addPair(ils.iatoms[j + k], ils.iatoms[j + l]);
+            }
+        }
+    }
+    std::sort(constrainedPairs.begin(), constrainedPairs.end());
+
+    ShortBond shortest;
+    for (int ftype = 0; ftype < F_NRE; ftype++)
+    {
+        if (!(ftype == F_BONDS || ftype == F_G96BONDS || ftype == F_HARMONIC))
+        {
+            continue;
+        }
+
+        const InteractionList& ilb = ilist[ftype];
+        for (int i = 0; i < ilb.size(); i += 3)
+        {
+            real fc = ip[ilb.iatoms[i]].harmonic.krA;
+            real re = ip[ilb.iatoms[i]].harmonic.rA;
+            if (ftype == F_G96BONDS)
+            {
+                /* Convert squared sqaure fc to harmonic fc */
+                fc = 2 * fc * re;
+            }
+            int  a1 = ilb.iatoms[i + 1];
+            int  a2 = ilb.iatoms[i + 2];
+            real m1 = atom[a1].m;
+            real m2 = atom[a2].m;
+            real period2;
+            if (fc > 0 && m1 > 0 && m2 > 0)
+            {
+                period2 = twopi2 * m1 * m2 / ((m1 + m2) * fc);
+            }
+            else
+            {
+                period2 = GMX_FLOAT_MAX;
+            }
+            if (debug)
+            {
+                fprintf(debug, "fc %g m1 %g m2 %g period %g\n", fc, m1, m2, std::sqrt(period2));
+            }
+            if (period2 < limit2 && (shortest.a1 < 0 || period2 < shortest.period2))
+            {
+                const bool bFound =
+                        std::binary_search(constrainedPairs.begin(), constrainedPairs.end(),
+                                           std::make_pair(std::min(a1, a2), std::max(a1, a2)));
+                if (!bFound)
+                {
+                    shortest.a1      = a1;
+                    shortest.a2      = a2;
+                    shortest.period2 = period2;
+                }
+            }
+        }
+    }
+
+    return shortest;
+}
+
 static void check_bonds_timestep(const gmx_mtop_t* mtop, double dt, warninp* wi)
 {
     /* This check is not intended to ensure accurate integration,
@@ -339,90 +485,43 @@ static void check_bonds_timestep(const gmx_mtop_t* mtop, double dt, warninp* wi)
      */
     int  min_steps_warn = 5;
     int  min_steps_note = 10;
-    int  ftype;
-    int  i, a1, a2, w_a1, w_a2, j;
-    real twopi2, limit2, fc, re, m1, m2, period2, w_period2;
-    bool bFound, bWater, bWarn;
+    real limit2;
+    bool bWater, bWarn;
 
     /* Get the interaction parameters */
     gmx::ArrayRef<const t_iparams> ip = mtop->ffparams.iparams;
 
-    twopi2 = gmx::square(2 * M_PI);
-
     limit2 = gmx::square(min_steps_note * dt);
 
-    w_a1 = w_a2 = -1;
-    w_period2   = -1.0;
+    /* The moleculetypes are independent, so we search them in parallel
+     * for the bond with the shortest oscillational period that is not
+     * constrained. The results are reduced in moleculetype order below.
+     */
+    const int              numMoltypes = gmx::ssize(mtop->moltype);
+    std::vector<ShortBond> shortestBond(numMoltypes);
+    const int              numThreads = std::min(gmx_omp_get_max_threads(), numMoltypes);
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic) if (numThreads > 1)
+    for (int mt = 0; mt < numMoltypes; mt++)
+    {
+        try
+        {
+            shortestBond[mt] = findShortestUnconstrainedBond(mtop->moltype[mt], ip, limit2);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
 
     const gmx_moltype_t* w_moltype = nullptr;
-    for (const gmx_moltype_t& moltype : mtop->moltype)
+    int                  w_a1 = -1, w_a2 = -1;
+    real                 w_period2 = -1.0;
+    for (int mt = 0; mt < numMoltypes; mt++)
     {
-        const t_atom*           atom  = moltype.atoms.atom;
-        const InteractionLists& ilist = moltype.ilist;
-        const InteractionList&  ilc   = ilist[F_CONSTR];
-        const InteractionList&  ils   = ilist[F_SETTLE];
-        for (ftype = 0; ftype < F_NRE; ftype++)
+        const ShortBond& bond = shortestBond[mt];
+        if (bond.a1 >= 0 && (w_moltype == nullptr || bond.period2 < w_period2))
         {
-            if (!(ftype == F_BONDS || ftype == F_G96BONDS || ftype == F_HARMONIC))
-            {
-                continue;
-            }
-
-            const InteractionList& ilb = ilist[ftype];
-            for (i = 0; i < ilb.size(); i += 3)
-            {
-                fc = ip[ilb.iatoms[i]].harmonic.krA;
-                re = ip[ilb.iatoms[i]].harmonic.rA;
-                if (ftype == F_G96BONDS)
-                {
-                    /* Convert squared sqaure fc to harmonic fc */
-                    fc = 2 * fc * re;
-                }
-                a1 = ilb.iatoms[i + 1];
-                a2 = ilb.iatoms[i + 2];
-                m1 = atom[a1].m;
-                m2 = atom[a2].m;
-                if (fc > 0 && m1 > 0 && m2 > 0)
-                {
-                    period2 = twopi2 * m1 * m2 / ((m1 + m2) * fc);
-                }
-                else
-                {
-                    period2 = GMX_FLOAT_MAX;
-                }
-                if (debug)
-                {
-                    fprintf(debug, "fc %g m1 %g m2 %g period %g\n", fc, m1, m2, std::sqrt(period2));
-                }
-                if (period2 < limit2)
-                {
-                    bFound = false;
-                    for (j = 0; j < ilc.size(); j += 3)
-                    {
-                        if ((ilc.iatoms[j + 1] == a1 && ilc.iatoms[j + 2] == a2)
-                            || (ilc.iatoms[j + 1] == a2 && ilc.iatoms[j + 2] == a1))
-                        {
-                            bFound = true;
-                        }
-                    }
-                    for (j = 0; j < ils.size(); j += 4)
-                    {
-                        if ((a1 == ils.iatoms[j + 1] || a1 == ils.iatoms[j + 2] || a1 == ils.iatoms[j + 3])
-                            && (a2 == ils.iatoms[j + 1] || a2 == ils.iatoms[j + 2]
-                                || a2 == ils.iatoms[j + 3]))
-                        {
-                            bFound = true;
-                        }
-                    }
-                    if (!bFound && (w_moltype == nullptr || period2 < w_period2))
-                    {
-                        w_moltype = &moltype;
-                        w_a1      = a1;
-                        w_a2      = a2;
-                        w_period2 = period2;
-                    }
-                }
-            }
+            w_moltype = &mtop->moltype[mt];
+            w_a1      = bond.a1;
+            w_a2      = bond.a2;
+            w_period2 = bond.period2;
         }
     }
 
@@ -931,6 +1030,11 @@ static void read_posres(gmx_mtop_t*                              mtop,
         gmx::invertBoxMatrix(invbox, invbox);
     }
 
+    /* The copying and scaling of the reference coordinates of all atoms
+     * is spread over threads, the restraints are few in comparison.
+     */
+    const int numThreads = gmx_omp_get_max_threads();
+
     /* Copy the reference coordinates to mtop */
     clear_dvec(sum);
     totmass = 0;
@@ -986,21 +1090,12 @@ static void read_posres(gmx_mtop_t*                              mtop,
                     totmass += atom[ai].m;
                 }
             }
-            if (!bTopB)
+            std::vector<gmx::RVec>& xp = (!bTopB ? molb.posres_xA : molb.posres_xB);
+            xp.resize(nat_molb);
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+            for (int i = 0; i < nat_molb; i++)
             {
-                molb.posres_xA.resize(nat_molb);
-                for (int i = 0; i < nat_molb; i++)
-                {
-                    copy_rvec(x[a + i], molb.posres_xA[i]);
-                }
-            }
-            else
-            {
-                molb.posres_xB.resize(nat_molb);
-                for (int i = 0; i < nat_molb; i++)
-                {
-                    copy_rvec(x[a + i], molb.posres_xB[i]);
-                }
+                copy_rvec(x[a + i], xp[i]);
             }
         }
         a += nat_molb;
@@ -1032,6 +1127,7 @@ static void read_posres(gmx_mtop_t*                              mtop,
             if (!molb.posres_xA.empty() || !molb.posres_xB.empty())
             {
                 std::vector<gmx::RVec>& xp = (!bTopB ? molb.posres_xA : molb.posres_xB);
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
                 for (int i = 0; i < nat_molb; i++)
                 {
                     for (int j = 0; j < npbcdim; j++)
@@ -1274,23 +1370,28 @@ static void init_cmap_grid(gmx_cmap_t* cmap_grid, int ngrid, int grid_spacing)
 
 static int count_constraints(const gmx_mtop_t* mtop, gmx::ArrayRef<const MoleculeInformation> mi, warninp* wi)
 {
-    int count, count_mol;
+    /* Count the constraints once per moleculetype, not per block */
+    std::vector<int> countPerMoltype(mtop->moltype.size(), -1);
 
-    count = 0;
+    int count = 0;
     for (const gmx_molblock_t& molb : mtop->molblock)
     {
-        count_mol                                            = 0;
-        gmx::ArrayRef<const InteractionsOfType> interactions = mi[molb.type].interactions;
-
-        for (int i = 0; i < F_NRE; i++)
+        int& count_mol = countPerMoltype[molb.type];
+        if (count_mol < 0)
         {
-            if (i == F_SETTLE)
-            {
-                count_mol += 3 * interactions[i].size();
-            }
-            else if (interaction_function[i].flags & IF_CONSTRAINT)
+            gmx::ArrayRef<const InteractionsOfType> interactions = mi[molb.type].interactions;
+
+            count_mol = 0;
+            for (int i = 0; i < F_NRE; i++)
             {
-                count_mol += interactions[i].size();
+                if (i == F_SETTLE)
+                {
+                    count_mol += 3 * interactions[i].size();
+                }
+                else if (interaction_function[i].flags & IF_CONSTRAINT)
+                {
+                    count_mol += interactions[i].size();
+                }
             }
         }
 
@@ -1361,17 +1462,18 @@ static real get_max_reference_temp(const t_inputrec* ir, warninp* wi)
     return ref_t;
 }
 
-/* Checks if there are unbound atoms in moleculetype molt.
- * Prints a note for each unbound atoms and a warning if any is present.
+/* Returns the indices of the atoms in moleculetype molt that are not bound
+ * by a potential or constraint to any other atom.
  */
-static void checkForUnboundAtoms(const gmx_moltype_t* molt, gmx_bool bVerbose, warninp* wi, const gmx::MDLogger& logger)
+static std::vector<int> findUnboundAtoms(const gmx_moltype_t& molt)
 {
-    const t_atoms* atoms = &molt->atoms;
+    const t_atoms* atoms = &molt.atoms;
 
+    std::vector<int> danglingAtoms;
     if (atoms->nr == 1)
     {
         /* Only one atom, there can't be unbound atoms */
-        return;
+        return danglingAtoms;
     }
 
     std::vector<int> count(atoms->nr, 0);
@@ -1381,7 +1483,7 @@ static void checkForUnboundAtoms(const gmx_moltype_t* molt, gmx_bool bVerbose, w
         if (((interaction_function[ftype].flags & IF_BOND) && NRAL(ftype) == 2 && ftype != F_CONNBONDS)
             || (interaction_function[ftype].flags & IF_CONSTRAINT) || ftype == F_SETTLE)
         {
-            const InteractionList& il   = molt->ilist[ftype];
+            const InteractionList& il   = molt.ilist[ftype];
             const int              nral = NRAL(ftype);
 
             for (int i = 0; i < il.size(); i += 1 + nral)
@@ -1394,43 +1496,64 @@ static void checkForUnboundAtoms(const gmx_moltype_t* molt, gmx_bool bVerbose, w
         }
     }
 
-    int numDanglingAtoms = 0;
     for (int a = 0; a < atoms->nr; a++)
     {
         if (atoms->atom[a].ptype != eptVSite && count[a] == 0)
         {
-            if (bVerbose)
+            danglingAtoms.push_back(a);
+        }
+    }
+
+    return danglingAtoms;
+}
+
+/* Checks all moleculetypes for unbound atoms.
+ * Prints a note for each unbound atoms and a warning if any is present.
+ * The moleculetypes are searched in parallel and reported in order.
+ */
+static void checkForUnboundAtoms(const gmx_mtop_t* mtop, gmx_bool bVerbose, warninp* wi, const gmx::MDLogger& logger)
+{
+    const int                     numMoltypes = gmx::ssize(mtop->moltype);
+    std::vector<std::vector<int>> danglingAtoms(numMoltypes);
+    const int                     numThreads = std::min(gmx_omp_get_max_threads(), numMoltypes);
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic) if (numThreads > 1)
+    for (int mt = 0; mt < numMoltypes; mt++)
+    {
+        try
+        {
+            danglingAtoms[mt] = findUnboundAtoms(mtop->moltype[mt]);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    for (int mt = 0; mt < numMoltypes; mt++)
+    {
+        const gmx_moltype_t& molt = mtop->moltype[mt];
+        if (bVerbose)
+        {
+            for (const int a : danglingAtoms[mt])
             {
                 GMX_LOG(logger.warning)
                         .asParagraph()
                         .appendTextFormatted(
                                 "Atom %d '%s' in moleculetype '%s' is not bound by a potential or "
                                 "constraint to any other atom in the same moleculetype.",
-                                a + 1, *atoms->atomname[a], *molt->name);
+                                a + 1, *molt.atoms.atomname[a], *molt.name);
             }
-            numDanglingAtoms++;
         }
-    }
 
-    if (numDanglingAtoms > 0)
-    {
-        std::string warningMessage = gmx::formatString(
-                "In moleculetype '%s' %d atoms are not bound by a potential or constraint to any "
-                "other atom in the same moleculetype. Although technically this might not cause "
-                "issues in a simulation, this often means that the user forgot to add a "
-                "bond/potential/constraint or put multiple molecules in the same moleculetype "
-                "definition by mistake. Run with -v to get information for each atom.",
-                *molt->name, numDanglingAtoms);
-        warning_note(wi, warningMessage.c_str());
-    }
-}
-
-/* Checks all moleculetypes for unbound atoms */
-static void checkForUnboundAtoms(const gmx_mtop_t* mtop, gmx_bool bVerbose, warninp* wi, const gmx::MDLogger& logger)
-{
-    for (const gmx_moltype_t& molt : mtop->moltype)
-    {
-        checkForUnboundAtoms(&molt, bVerbose, wi, logger);
+        if (!danglingAtoms[mt].empty())
+        {
+            std::string warningMessage = gmx::formatString(
+                    "In moleculetype '%s' %d atoms are not bound by a potential or constraint to "
+                    "any other atom in the same moleculetype. Although technically this might not "
+                    "cause issues in a simulation, this often means that the user forgot to add a "
+                    "bond/potential/constraint or put multiple molecules in the same "
+                    "moleculetype definition by mistake. Run with -v to get information for each "
+                    "atom.",
+                    *molt.name, static_cast<int>(danglingAtoms[mt].size()));
+            warning_note(wi, warningMessage.c_str());
+        }
     }
 }
 
@@ -2255,6 +2378,10 @@ int gmx_grompp(int argc, char* argv[])
                           "The PME grid size should be >= 2*(pme-order - 1); either manually "
                           "increase the grid size or decrease pme-order");
         }
+        else
+        {
+            check_pme_accuracy(ir, &sys, scaledBox, wi);
+        }
     }
 
     /* MRS: eventually figure out better logic for initializing the fep
@@ -39,7 +39,10 @@
 #ifndef GMX_GMXPREPROCESS_GROMPP_IMPL_H
 #define GMX_GMXPREPROCESS_GROMPP_IMPL_H
 
+#include <array>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "gromacs/gmxpreprocess/notset.h"
 #include "gromacs/topology/atoms.h"
@@ -128,6 +131,44 @@ private:
     std::string interactionTypeName_;
 };
 
+/*! \libinternal \brief
+ * Hashed index from the atoms of interaction types to their position.
+ *
+ * The force-field directives only ever append interaction types, so
+ * the index is extended with the entries added since the last lookup
+ * instead of being rebuilt. Only the first entry with a given
+ * atom-type tuple is indexed, which is the one the linear searches in
+ * grompp choose.
+ */
+class InteractionTypeIndex
+{
+public:
+    /*! \brief Return the position of the first entry in \p types with atoms \p atoms
+     *
+     * Returns -1 when there is no such entry. The index is updated to
+     * cover all of \p types first.
+     */
+    int find(const std::vector<InteractionOfType>& types, gmx::ArrayRef<const int> atoms);
+    //! Drop the index, required when \c types is modified other than by appending.
+    void clear();
+
+private:
+    //! Number of atoms followed by the atom types, padded with -1.
+    using Key = std::array<int, MAXATOMLIST + 1>;
+    //! Hash for Key.
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+    //! Return the key for \p atoms.
+    static Key makeKey(gmx::ArrayRef<const int> atoms);
+
+    //! Position of the first entry with each key.
+    std::unordered_map<Key, int, KeyHash> firstPosition_;
+    //! Number of entries of the types that have been indexed.
+    size_t numIndexed_ = 0;
+};
+
 /*! \libinternal \brief
  * A set of interactions of a given type
  * (found in the enumeration in ifunc.h), complete with
@@ -149,6 +190,8 @@ struct InteractionsOfType
     std::vector<real> cmap;
     //! The five atomtypes followed by a number that identifies the type.
     std::vector<int> cmapAtomTypes;
+    //! Index of interactionTypes by atom types, only used for force-field parameter lookup.
+    InteractionTypeIndex typeIndex;
 
     //! Number of parameters.
     size_t size() const { return interactionTypes.size(); }
@@ -39,10 +39,13 @@
 
 #include "insert_molecules.h"
 
+#include <cstdint>
+
 #include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gromacs/commandline/cmdlineoptionsmodule.h"
@@ -51,6 +54,7 @@
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/gmxlib/conformation_utilities.h"
 #include "gromacs/gmxpreprocess/makeexclusiondistances.h"
+#include "gromacs/gmxpreprocess/occupancygrid.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/utilities.h"
 #include "gromacs/math/vec.h"
@@ -60,7 +64,6 @@
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/random/threefry.h"
 #include "gromacs/random/uniformrealdistribution.h"
-#include "gromacs/selection/nbsearch.h"
 #include "gromacs/selection/selection.h"
 #include "gromacs/selection/selectioncollection.h"
 #include "gromacs/selection/selectionoption.h"
@@ -76,6 +79,7 @@
 #include "gromacs/utility/enumerationhelpers.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 using gmx::RVec;
@@ -105,11 +109,51 @@ static void center_molecule(gmx::ArrayRef<RVec> x)
     }
 }
 
-static void generate_trial_conf(gmx::ArrayRef<RVec>       xin,
-                                const rvec                offset,
-                                RotationType              enum_rot,
-                                gmx::DefaultRandomEngine* rng,
-                                std::vector<RVec>*        xout)
+/*! \brief Random engine that counts the values drawn, so it can be rewound
+ *
+ * The engines themselves can not be copied, but discarding values
+ * gives the same state as drawing them.
+ */
+class CountingRandomEngine
+{
+public:
+    //! Type of the values returned.
+    typedef gmx::DefaultRandomEngine::result_type result_type;
+
+    //! Initialize the engine with \p seed.
+    explicit CountingRandomEngine(int seed) : seed_(seed), engine_(seed) {}
+
+    //! Smallest value that can be returned.
+    static constexpr result_type min() { return gmx::DefaultRandomEngine::min(); }
+    //! Largest value that can be returned.
+    static constexpr result_type max() { return gmx::DefaultRandomEngine::max(); }
+    //! Returns the next random value.
+    result_type operator()()
+    {
+        ++count_;
+        return engine_();
+    }
+    //! Returns the number of values drawn.
+    uint64_t count() const { return count_; }
+    //! Sets the engine to the state after drawing \p count values.
+    void rewind(uint64_t count)
+    {
+        engine_.seed(seed_);
+        engine_.discard(count);
+        count_ = count;
+    }
+
+private:
+    int                      seed_;
+    gmx::DefaultRandomEngine engine_;
+    uint64_t                 count_ = 0;
+};
+
+static void generate_trial_conf(gmx::ArrayRef<RVec>   xin,
+                                const rvec            offset,
+                                RotationType          enum_rot,
+                                CountingRandomEngine* rng,
+                                std::vector<RVec>*    xout)
 {
     gmx::UniformRealDistribution<real> dist(0, 2.0 * M_PI);
     xout->assign(xin.begin(), xin.end());
@@ -139,33 +183,44 @@ static void generate_trial_conf(gmx::ArrayRef<RVec>       xin,
     }
 }
 
-static bool isInsertionAllowed(gmx::AnalysisNeighborhoodSearch* search,
-                               const std::vector<real>&         exclusionDistances,
-                               const std::vector<RVec>&         x,
-                               const std::vector<real>&         exclusionDistances_insrt,
-                               const t_atoms&                   atoms,
-                               const std::set<int>&             removableAtoms,
-                               gmx::AtomsRemover*               remover)
+//! Result of checking a trial configuration for overlap.
+struct TrialResult
+{
+    //! Whether the molecule can be inserted.
+    bool isAllowed = false;
+    //! Replaceable atoms that the molecule overlaps with.
+    std::vector<int> overlappingAtoms;
+};
+
+static void checkInsertion(const gmx::OccupancyGrid& grid,
+                           const std::vector<real>&  exclusionDistances,
+                           const std::vector<RVec>&  x,
+                           const std::vector<real>&  exclusionDistances_insrt,
+                           const std::set<int>&      removableAtoms,
+                           TrialResult*              result)
 {
-    gmx::AnalysisNeighborhoodPositions  pos(x);
-    gmx::AnalysisNeighborhoodPairSearch pairSearch = search->startPairSearch(pos);
-    gmx::AnalysisNeighborhoodPair       pair;
-    while (pairSearch.findNextPair(&pair))
+    std::vector<std::pair<int, real>> neighbors;
+    result->overlappingAtoms.clear();
+    for (size_t i = 0; i < x.size(); i++)
     {
-        const real r1 = exclusionDistances[pair.refIndex()];
-        const real r2 = exclusionDistances_insrt[pair.testIndex()];
-        if (pair.distance2() < gmx::square(r1 + r2))
+        neighbors.clear();
+        grid.findNeighbors(x[i], &neighbors);
+        for (const auto& neighbor : neighbors)
         {
-            if (removableAtoms.count(pair.refIndex()) == 0)
+            const real r1 = exclusionDistances[neighbor.first];
+            const real r2 = exclusionDistances_insrt[i];
+            if (neighbor.second < gmx::square(r1 + r2))
             {
-                return false;
+                if (removableAtoms.count(neighbor.first) == 0)
+                {
+                    result->isAllowed = false;
+                    return;
+                }
+                result->overlappingAtoms.push_back(neighbor.first);
             }
-            // TODO: If molecule information is available, this should ideally
-            // use it to remove whole molecules.
-            remover->markResidue(atoms, pair.refIndex(), true);
         }
     }
-    return true;
+    result->isAllowed = true;
 }
 
 static void insert_mols(int                  nmol_insrt,
@@ -201,10 +256,7 @@ static void insert_mols(int                  nmol_insrt,
         maxRadius = std::max(maxInsertRadius, maxExistingRadius);
     }
 
-    // TODO: Make all of this exception-safe.
-    gmx::AnalysisNeighborhood nb;
-    nb.setCutoff(maxInsertRadius + maxRadius);
-
+    const real cutoff = maxInsertRadius + maxRadius;
 
     if (seed == 0)
     {
@@ -212,11 +264,18 @@ static void insert_mols(int                  nmol_insrt,
     }
     fprintf(stderr, "Using random seed %d\n", seed);
 
-    gmx::DefaultRandomEngine rng(seed);
+    CountingRandomEngine rng(seed);
 
     t_pbc pbc;
     set_pbc(&pbc, pbcType, box);
 
+    /* The grid is kept for all trials and updated with each inserted
+     * molecule. This includes atoms marked for replacement, as these
+     * are only removed at the end.
+     */
+    gmx::OccupancyGrid grid(pbc, cutoff);
+    grid.addPositions(*x);
+
     /* With -ip, take nmol_insrt from file posfn */
     double**   rpos              = nullptr;
     const bool insertAtPositions = !posfn.empty();
@@ -241,7 +300,18 @@ static void insert_mols(int                  nmol_insrt,
         exclusionDistances.reserve(finalAtomCount);
     }
 
-    std::vector<RVec> x_n(x_insrt.size());
+    /* The trials are generated serially, so that they use the same random
+     * numbers as one trial at a time, and then checked for overlap in
+     * parallel. The first allowed trial in a batch is inserted and the
+     * random engine is reset to its state after that trial, discarding
+     * the remaining trials. The batch size adapts to the success rate.
+     */
+    const int                      numThreads   = gmx_omp_get_max_threads();
+    const int                      maxBatchSize = 4 * numThreads;
+    int                            batchSize    = 1;
+    std::vector<std::vector<RVec>> x_n(maxBatchSize);
+    std::vector<TrialResult>       results(maxBatchSize);
+    std::vector<uint64_t>          rngCountAfterTrial(maxBatchSize);
 
     int                                mol        = 0;
     int                                trial      = 0;
@@ -251,15 +321,7 @@ static void insert_mols(int                  nmol_insrt,
 
     while (mol < nmol_insrt && trial < ntry * nmol_insrt)
     {
-        rvec offset_x;
-        if (!insertAtPositions)
-        {
-            // Insert at random positions.
-            offset_x[XX] = box[XX][XX] * dist(rng);
-            offset_x[YY] = box[YY][YY] * dist(rng);
-            offset_x[ZZ] = box[ZZ][ZZ] * dist(rng);
-        }
-        else
+        if (insertAtPositions)
         {
             // Skip a position if ntry trials were not successful.
             if (trial >= firstTrial + ntry)
@@ -271,27 +333,80 @@ static void insert_mols(int                  nmol_insrt,
                 firstTrial = trial;
                 continue;
             }
-            // Insert at positions taken from option -ip file.
-            offset_x[XX] = rpos[XX][mol] + deltaR[XX] * (2 * dist(rng) - 1);
-            offset_x[YY] = rpos[YY][mol] + deltaR[YY] * (2 * dist(rng) - 1);
-            offset_x[ZZ] = rpos[ZZ][mol] + deltaR[ZZ] * (2 * dist(rng) - 1);
         }
-        fprintf(stderr, "\rTry %d", ++trial);
-        fflush(stderr);
-
-        generate_trial_conf(x_insrt, offset_x, enum_rot, &rng, &x_n);
-        gmx::AnalysisNeighborhoodPositions pos(*x);
-        gmx::AnalysisNeighborhoodSearch    search = nb.initSearch(&pbc, pos);
-        if (isInsertionAllowed(&search, exclusionDistances, x_n, exclusionDistances_insrt, *atoms,
-                               removableAtoms, &remover))
+
+        int numTrials = std::min(batchSize, ntry * nmol_insrt - trial);
+        if (insertAtPositions)
+        {
+            // Do not go past the trials for this position.
+            numTrials = std::min(numTrials, firstTrial + ntry - trial);
+        }
+        for (int t = 0; t < numTrials; t++)
+        {
+            rvec offset_x;
+            if (!insertAtPositions)
+            {
+                // Insert at random positions.
+                offset_x[XX] = box[XX][XX] * dist(rng);
+                offset_x[YY] = box[YY][YY] * dist(rng);
+                offset_x[ZZ] = box[ZZ][ZZ] * dist(rng);
+            }
+            else
+            {
+                // Insert at positions taken from option -ip file.
+                offset_x[XX] = rpos[XX][mol] + deltaR[XX] * (2 * dist(rng) - 1);
+                offset_x[YY] = rpos[YY][mol] + deltaR[YY] * (2 * dist(rng) - 1);
+                offset_x[ZZ] = rpos[ZZ][mol] + deltaR[ZZ] * (2 * dist(rng) - 1);
+            }
+            generate_trial_conf(x_insrt, offset_x, enum_rot, &rng, &x_n[t]);
+            rngCountAfterTrial[t] = rng.count();
+        }
+
+#pragma omp parallel for num_threads(std::min(numThreads, numTrials)) schedule(dynamic) \
+        if (numTrials > 1)
+        for (int t = 0; t < numTrials; t++)
+        {
+            try
+            {
+                checkInsertion(grid, exclusionDistances, x_n[t], exclusionDistances_insrt,
+                               removableAtoms, &results[t]);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+
+        bool inserted = false;
+        for (int t = 0; t < numTrials && !inserted; t++)
+        {
+            fprintf(stderr, "\rTry %d", ++trial);
+            fflush(stderr);
+            if (results[t].isAllowed)
+            {
+                // TODO: If molecule information is available, this should ideally
+                // use it to remove whole molecules.
+                for (const int atom : results[t].overlappingAtoms)
+                {
+                    remover.markResidue(*atoms, atom, true);
+                }
+                x->insert(x->end(), x_n[t].begin(), x_n[t].end());
+                grid.addPositions(x_n[t]);
+                exclusionDistances.insert(exclusionDistances.end(),
+                                          exclusionDistances_insrt.begin(),
+                                          exclusionDistances_insrt.end());
+                builder.mergeAtoms(atoms_insrt);
+                ++mol;
+                firstTrial = trial;
+                fprintf(stderr, " success (now %d atoms)!\n", builder.currentAtomCount());
+                if (t + 1 < numTrials)
+                {
+                    rng.rewind(rngCountAfterTrial[t]);
+                }
+                inserted  = true;
+                batchSize = std::max(1, batchSize / 2);
+            }
+        }
+        if (!inserted)
         {
-            x->insert(x->end(), x_n.begin(), x_n.end());
-            exclusionDistances.insert(exclusionDistances.end(), exclusionDistances_insrt.begin(),
-                                      exclusionDistances_insrt.end());
-            builder.mergeAtoms(atoms_insrt);
-            ++mol;
-            firstTrial = trial;
-            fprintf(stderr, " success (now %d atoms)!\n", builder.currentAtomCount());
+            batchSize = std::min(2 * batchSize, maxBatchSize);
         }
     }
 
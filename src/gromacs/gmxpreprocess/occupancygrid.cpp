@@ -0,0 +1,214 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements gmx::OccupancyGrid.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#include "gmxpre.h"
+
+#include "occupancygrid.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+
+#include "gromacs/math/invertmatrix.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Upper limit for the number of cells, to limit memory use for large sparse boxes.
+constexpr int c_maxNumCells = 1 << 24;
+
+} // namespace
+
+OccupancyGrid::OccupancyGrid(const t_pbc& pbc, real cutoff) : pbc_(pbc), cutoff_(cutoff)
+{
+    GMX_RELEASE_ASSERT(cutoff > 0, "The cutoff should be positive");
+    for (int d = 0; d < DIM; d++)
+    {
+        GMX_RELEASE_ASSERT(pbc.box[d][d] > 0, "The grid needs a box with non-zero volume");
+    }
+    invertBoxMatrix(pbc.box, invBox_);
+
+    /* With fractional coordinate s_d = x . c_d, where c_d is column d of
+     * the inverse box, the thickness of the box along d is 1/|c_d|.
+     * Cells that are at least a cutoff thick only require searching
+     * one neighboring cell on each side.
+     */
+    RVec reciprocalLength;
+    for (int d = 0; d < DIM; d++)
+    {
+        reciprocalLength[d] = std::sqrt(gmx::square(invBox_[XX][d]) + gmx::square(invBox_[YY][d])
+                                        + gmx::square(invBox_[ZZ][d]));
+    }
+    real cellSize = cutoff;
+    while (true)
+    {
+        int64_t totalNumCells = 1;
+        for (int d = 0; d < DIM; d++)
+        {
+            numCells_[d] = std::max(1, static_cast<int>(1 / (reciprocalLength[d] * cellSize)));
+            totalNumCells *= numCells_[d];
+        }
+        if (totalNumCells <= c_maxNumCells)
+        {
+            break;
+        }
+        cellSize *= 2;
+    }
+    for (int d = 0; d < DIM; d++)
+    {
+        searchRange_[d] =
+                static_cast<int>(std::ceil(cutoff * reciprocalLength[d] * numCells_[d]));
+    }
+
+    cellHead_.resize(numCells_[XX] * numCells_[YY] * numCells_[ZZ], -1);
+}
+
+RVec OccupancyGrid::fractionalCoordinates(const RVec& x) const
+{
+    RVec s;
+    for (int d = 0; d < DIM; d++)
+    {
+        s[d] = x[XX] * invBox_[XX][d] + x[YY] * invBox_[YY][d] + x[ZZ] * invBox_[ZZ][d];
+    }
+    return s;
+}
+
+int OccupancyGrid::cellIndex(real s, int d) const
+{
+    if (d < pbc_.ndim_ePBC)
+    {
+        s -= std::floor(s);
+    }
+    const int cell = static_cast<int>(std::floor(s * numCells_[d]));
+    return std::min(std::max(cell, 0), numCells_[d] - 1);
+}
+
+void OccupancyGrid::addPosition(const RVec& x)
+{
+    const RVec s    = fractionalCoordinates(x);
+    const int  cell = (cellIndex(s[XX], XX) * numCells_[YY] + cellIndex(s[YY], YY)) * numCells_[ZZ]
+                     + cellIndex(s[ZZ], ZZ);
+    next_.push_back(cellHead_[cell]);
+    cellHead_[cell] = size();
+    positions_.push_back(x);
+}
+
+void OccupancyGrid::addPositions(ArrayRef<const RVec> x)
+{
+    next_.reserve(next_.size() + x.size());
+    positions_.reserve(positions_.size() + x.size());
+    for (const RVec& xi : x)
+    {
+        addPosition(xi);
+    }
+}
+
+void OccupancyGrid::findNeighbors(const RVec& x, std::vector<std::pair<int, real>>* neighbors) const
+{
+    const RVec s = fractionalCoordinates(x);
+
+    /* Collect the cell indices to search along each dimension. With PBC
+     * these wrap around, but each cell should only be searched once.
+     */
+    std::array<std::vector<int>, DIM> cells;
+    for (int d = 0; d < DIM; d++)
+    {
+        if (d < pbc_.ndim_ePBC)
+        {
+            const int center = cellIndex(s[d], d);
+            if (2 * searchRange_[d] + 1 >= numCells_[d])
+            {
+                for (int c = 0; c < numCells_[d]; c++)
+                {
+                    cells[d].push_back(c);
+                }
+            }
+            else
+            {
+                for (int c = center - searchRange_[d]; c <= center + searchRange_[d]; c++)
+                {
+                    cells[d].push_back((c + numCells_[d]) % numCells_[d]);
+                }
+            }
+        }
+        else
+        {
+            /* Positions outside the box are in the edge cells */
+            const int center = static_cast<int>(std::floor(s[d] * numCells_[d]));
+            const int begin  = std::max(center - searchRange_[d], 0);
+            const int end    = std::min(center + searchRange_[d], numCells_[d] - 1);
+            for (int c = std::min(begin, numCells_[d] - 1); c <= std::max(end, 0); c++)
+            {
+                cells[d].push_back(c);
+            }
+        }
+    }
+
+    const real cutoff2 = gmx::square(cutoff_);
+    for (const int cx : cells[XX])
+    {
+        for (const int cy : cells[YY])
+        {
+            for (const int cz : cells[ZZ])
+            {
+                const int cell = (cx * numCells_[YY] + cy) * numCells_[ZZ] + cz;
+                for (int i = cellHead_[cell]; i >= 0; i = next_[i])
+                {
+                    rvec dx;
+                    pbc_dx(&pbc_, x, positions_[i], dx);
+                    const real r2 = norm2(dx);
+                    if (r2 <= cutoff2)
+                    {
+                        neighbors->emplace_back(i, r2);
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace gmx
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Declares gmx::OccupancyGrid for overlap checks in solvate and insert-molecules.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#ifndef GMX_GMXPREPROCESS_OCCUPANCYGRID_H
+#define GMX_GMXPREPROCESS_OCCUPANCYGRID_H
+
+#include <utility>
+#include <vector>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \internal \brief
+ * Cell grid over the unit cell that positions can be added to one at a time.
+ *
+ * Unlike AnalysisNeighborhoodSearch, which has to be initialized again
+ * for all positions whenever a position is added, the grid is kept for
+ * the whole run and each added position only costs updating one cell.
+ * The cells are laid out in fractional coordinates, so triclinic boxes
+ * are supported. Distances are computed with full periodic boundary
+ * conditions, so positions do not need to be put in the box.
+ *
+ * Concurrent calls to findNeighbors() are safe, adding positions is not.
+ */
+class OccupancyGrid
+{
+public:
+    /*! \brief Sets up an empty grid
+     *
+     * \param[in] pbc    Periodic boundary conditions, the box is taken from here.
+     * \param[in] cutoff Largest distance that findNeighbors() returns.
+     */
+    OccupancyGrid(const t_pbc& pbc, real cutoff);
+
+    //! Adds a position with index size().
+    void addPosition(const RVec& x);
+    //! Adds all of \p x in order.
+    void addPositions(ArrayRef<const RVec> x);
+    //! Returns the number of positions added.
+    int size() const { return gmx::ssize(positions_); }
+
+    /*! \brief Finds the positions within the cutoff of \p x
+     *
+     * The indices of the positions are appended to \p neighbors together
+     * with their squared distance to \p x, in no particular order.
+     */
+    void findNeighbors(const RVec& x, std::vector<std::pair<int, real>>* neighbors) const;
+
+private:
+    //! Returns the fractional coordinates of \p x.
+    RVec fractionalCoordinates(const RVec& x) const;
+    //! Returns the cell index along \p d for fractional coordinate \p s, with wrapping for PBC.
+    int cellIndex(real s, int d) const;
+
+    //! Periodic boundary conditions.
+    t_pbc pbc_;
+    //! The largest distance searched.
+    real cutoff_;
+    //! The inverse of the box matrix.
+    matrix invBox_;
+    //! Number of cells along each box vector.
+    IVec numCells_;
+    //! Number of neighboring cells to search along each box vector.
+    IVec searchRange_;
+    //! Index of the last position added to each cell, -1 for empty cells.
+    std::vector<int> cellHead_;
+    //! Index of the previous position added to the same cell, -1 for none.
+    std::vector<int> next_;
+    //! The positions added.
+    std::vector<RVec> positions_;
+};
+
+} // namespace gmx
+
+#endif
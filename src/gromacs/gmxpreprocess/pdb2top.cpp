@@ -735,12 +735,16 @@ static void do_ssbonds(InteractionsOfType*                ps,
                        gmx::ArrayRef<const DisulfideBond> ssbonds,
                        bool                               bAllowMissing)
 {
+    const std::vector<int> residueFirstAtom = residueFirstAtoms(atoms);
+
     for (const auto& bond : ssbonds)
     {
         int ri = bond.firstResidue;
         int rj = bond.secondResidue;
-        int ai = search_res_atom(bond.firstAtom.c_str(), ri, atoms, "special bond", bAllowMissing);
-        int aj = search_res_atom(bond.secondAtom.c_str(), rj, atoms, "special bond", bAllowMissing);
+        int ai = search_res_atom(bond.firstAtom.c_str(), ri, residueFirstAtom, atoms,
+                                 "special bond", bAllowMissing);
+        int aj = search_res_atom(bond.secondAtom.c_str(), rj, residueFirstAtom, atoms,
+                                 "special bond", bAllowMissing);
         if ((ai == -1) || (aj == -1))
         {
             gmx_fatal(FARGS, "Trying to make impossible special bond (%s-%s)!",
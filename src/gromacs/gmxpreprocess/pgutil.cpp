@@ -170,3 +170,29 @@ int search_res_atom(const char* type, int resind, const t_atoms* atoms, const ch
 
     return -1;
 }
+
+std::vector<int> residueFirstAtoms(const t_atoms* atoms)
+{
+    std::vector<int> residueFirstAtom(atoms->nres, -1);
+    for (int i = atoms->nr - 1; i >= 0; i--)
+    {
+        residueFirstAtom[atoms->atom[i].resind] = i;
+    }
+
+    return residueFirstAtom;
+}
+
+int search_res_atom(const char*              type,
+                    int                      resind,
+                    gmx::ArrayRef<const int> residueFirstAtom,
+                    const t_atoms*           atoms,
+                    const char*              bondtype,
+                    bool                     bAllowMissing)
+{
+    if (resind < 0 || resind >= gmx::ssize(residueFirstAtom) || residueFirstAtom[resind] < 0)
+    {
+        return -1;
+    }
+
+    return search_atom(type, residueFirstAtom[resind], atoms, bondtype, bAllowMissing);
+}
@@ -38,6 +38,9 @@
 #ifndef GMX_GMXPREPROCESS_PGUTIL_H
 #define GMX_GMXPREPROCESS_PGUTIL_H
 
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/real.h"
 
@@ -57,4 +60,20 @@ int search_atom(const char* type, int start, const t_atoms* atoms, const char* b
  */
 int search_res_atom(const char* type, int resind, const t_atoms* atoms, const char* bondtype, bool bAllowMissing);
 
+/* Returns the index of the first atom of every residue in atoms,
+ * -1 for residues without atoms.
+ */
+std::vector<int> residueFirstAtoms(const t_atoms* atoms);
+
+/* Same as search_res_atom, but uses the first atoms of the residues,
+ * as returned by residueFirstAtoms(), instead of searching all atoms.
+ * Use this when searching many atoms.
+ */
+int search_res_atom(const char*              type,
+                    int                      resind,
+                    gmx::ArrayRef<const int> residueFirstAtom,
+                    const t_atoms*           atoms,
+                    const char*              bondtype,
+                    bool                     bAllowMissing);
+
 #endif
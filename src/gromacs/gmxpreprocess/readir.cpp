@@ -49,6 +49,9 @@
 #include <string>
 
 #include "gromacs/applied_forces/awh/read_params.h"
+#include "gromacs/ewald/ewald_utils.h"
+#include "gromacs/ewald/pme.h"
+#include "gromacs/fft/calcgrid.h"
 #include "gromacs/fileio/readinp.h"
 #include "gromacs/fileio/warninp.h"
 #include "gromacs/gmxlib/network.h"
@@ -1960,6 +1963,10 @@ void get_ir(const char*     mdparin,
     printStringNoNewline(&inp, "Output frequency and precision for .xtc file");
     ir->nstxout_compressed      = get_eint(&inp, "nstxout-compressed", 0, wi);
     ir->x_compression_precision = get_ereal(&inp, "compressed-x-precision", 1000.0, wi);
+    printStringNoNewline(&inp, "Output frequency for velocities and forces in the compressed");
+    printStringNoNewline(&inp, "trajectory file, only supported with the .tng format");
+    ir->nstvout_compressed = get_eint(&inp, "nstvout-compressed", 0, wi);
+    ir->nstfout_compressed = get_eint(&inp, "nstfout-compressed", 0, wi);
     printStringNoNewline(&inp, "This selects the subset of atoms for the compressed");
     printStringNoNewline(&inp, "trajectory file. You can select multiple groups. By");
     printStringNoNewline(&inp, "default, all atoms will be written.");
@@ -4475,3 +4482,97 @@ void double_check(t_inputrec* ir, matrix box, bool bHasNormalConstraints, bool b
         }
     }
 }
+
+void check_pme_accuracy(const t_inputrec* ir, const gmx_mtop_t* sys, const matrix box, warninp_t wi)
+{
+    /* The estimates are for Coulomb only and for 3D periodicity */
+    if (ir->coulombtype != eelPME || EVDW_PME(ir->vdwtype) || ir->pbcType != PbcType::Xyz)
+    {
+        return;
+    }
+
+    double sumChargeSquared = 0;
+    int    numCharges       = 0;
+    for (const AtomProxy atomP : AtomRange(*sys))
+    {
+        const t_atom& local = atomP.atom();
+        if (local.q != 0)
+        {
+            sumChargeSquared += gmx::square(local.q);
+            numCharges++;
+        }
+    }
+    if (numCharges == 0)
+    {
+        return;
+    }
+
+    const real volume      = det(box);
+    const ivec grid        = { ir->nkx, ir->nky, ir->nkz };
+    const int  minGridSize = minimalPmeGridSize(ir->pme_order);
+
+    real beta        = calc_ewaldcoeff_q(ir->rcoulomb, ir->ewald_rtol);
+    real errorDirect = estimateEwaldDirectSpaceForceError(sumChargeSquared, numCharges, volume,
+                                                          ir->rcoulomb, beta);
+    real errorRecip  = estimatePmeReciprocalSpaceForceError(sumChargeSquared, numCharges, box,
+                                                            grid, ir->pme_order, beta);
+
+    const real errorTarget = std::sqrt(gmx::square(errorDirect) + gmx::square(errorRecip));
+
+    printf("Estimated PME force RMS errors: direct space %.2e, reciprocal space %.2e kJ/mol/nm\n",
+           errorDirect, errorRecip);
+
+    /* Look for the smallest grid that, with some ewald-rtol, gives at most
+     * the same total error with the same cut-off, i.e. the same PP cost.
+     */
+    const int numGridPoints = grid[XX] * grid[YY] * grid[ZZ];
+    int       bestNumPoints = numGridPoints;
+    real      bestRTol      = 0;
+    real      bestSpacing   = 0;
+    ivec      bestGrid;
+    for (real rtol : { 1e-6, 2e-6, 5e-6, 1e-5, 2e-5, 5e-5, 1e-4, 2e-4, 5e-4, 1e-3 })
+    {
+        beta        = calc_ewaldcoeff_q(ir->rcoulomb, rtol);
+        errorDirect = estimateEwaldDirectSpaceForceError(sumChargeSquared, numCharges, volume,
+                                                         ir->rcoulomb, beta);
+        if (errorDirect >= errorTarget)
+        {
+            continue;
+        }
+        const real maxErrorRecip = std::sqrt(gmx::square(errorTarget) - gmx::square(errorDirect));
+        /* Scan from coarse to fine grids, the first acceptable grid is the cheapest */
+        for (real spacing = 0.3; spacing > 0.05; spacing *= 0.95)
+        {
+            ivec trialGrid = { 0, 0, 0 };
+            calcFftGrid(nullptr, box, spacing, minGridSize, &trialGrid[XX], &trialGrid[YY],
+                        &trialGrid[ZZ]);
+            const int numPoints = trialGrid[XX] * trialGrid[YY] * trialGrid[ZZ];
+            if (numPoints >= bestNumPoints)
+            {
+                break;
+            }
+            errorRecip = estimatePmeReciprocalSpaceForceError(sumChargeSquared, numCharges, box,
+                                                              trialGrid, ir->pme_order, beta);
+            if (errorRecip <= maxErrorRecip)
+            {
+                bestNumPoints = numPoints;
+                bestRTol      = rtol;
+                bestSpacing   = spacing;
+                copy_ivec(trialGrid, bestGrid);
+                break;
+            }
+        }
+    }
+
+    /* Only suggest changes that give a significant reduction of the PME cost */
+    if (bestNumPoints < 0.8 * numGridPoints)
+    {
+        auto message = gmx::formatString(
+                "The estimated PME force accuracy with the current settings can also be "
+                "obtained with the same cut-off using ewald-rtol = %g and fourierspacing = %.3f "
+                "(grid %d %d %d), which reduces the number of PME grid points by %.0f%%.",
+                bestRTol, bestSpacing, bestGrid[XX], bestGrid[YY], bestGrid[ZZ],
+                100.0 * (1.0 - bestNumPoints / static_cast<double>(numGridPoints)));
+        warning_note(wi, message);
+    }
+}
@@ -129,6 +129,15 @@ void double_check(t_inputrec* ir, matrix box, bool bHasNormalConstraints, bool b
 void triple_check(const char* mdparin, t_inputrec* ir, gmx_mtop_t* sys, warninp_t wi);
 /* Do even more checks */
 
+void check_pme_accuracy(const t_inputrec* ir,
+                        const gmx_mtop_t* sys,
+                        const matrix      box,
+                        warninp_t         wi);
+/* Estimate the PME force errors for the chosen PME grid and, when a much
+ * smaller grid with a different ewald-rtol gives the same accuracy with the
+ * same cut-off, suggest those settings with a note.
+ */
+
 void get_ir(const char*     mdparin,
             const char*     mdparout,
             gmx::MDModules* mdModules,
@@ -43,6 +43,7 @@
 
 #include <algorithm>
 #include <random>
+#include <utility>
 #include <vector>
 
 #include "gromacs/commandline/pargs.h"
@@ -50,6 +51,7 @@
 #include "gromacs/fileio/pdbio.h"
 #include "gromacs/gmxlib/conformation_utilities.h"
 #include "gromacs/gmxpreprocess/makeexclusiondistances.h"
+#include "gromacs/gmxpreprocess/occupancygrid.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/units.h"
 #include "gromacs/math/vec.h"
@@ -63,9 +65,11 @@
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 using gmx::RVec;
@@ -535,25 +539,42 @@ static void removeSolventOverlappingWithSolute(t_atoms*                 atoms,
     const real        maxRadius1 = *std::max_element(r->begin(), r->end());
     const real        maxRadius2 = *std::max_element(r_solute.begin(), r_solute.end());
 
-    // Now check for overlap.
-    gmx::AnalysisNeighborhood     nb;
-    gmx::AnalysisNeighborhoodPair pair;
-    nb.setCutoff(maxRadius1 + maxRadius2);
-    gmx::AnalysisNeighborhoodPositions  posSolute(x_solute);
-    gmx::AnalysisNeighborhoodSearch     search = nb.initSearch(&pbc, posSolute);
-    gmx::AnalysisNeighborhoodPositions  pos(*x);
-    gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
-    while (pairSearch.findNextPair(&pair))
+    // Now check for overlap. The solvent atoms are checked independently
+    // in parallel, after which the residues of overlapping atoms are
+    // marked for removal.
+    gmx::OccupancyGrid grid(pbc, maxRadius1 + maxRadius2);
+    grid.addPositions(x_solute);
+    const int         numAtoms = gmx::ssize(*x);
+    std::vector<char> overlaps(numAtoms, 0);
+    const int         numThreads = gmx_omp_get_max_threads();
+#pragma omp parallel num_threads(numThreads) if (numThreads > 1)
     {
-        if (remover.isMarked(pair.testIndex()))
+        try
         {
-            pairSearch.skipRemainingPairsForTestPosition();
-            continue;
+            std::vector<std::pair<int, real>> neighbors;
+#pragma omp for schedule(static)
+            for (int i = 0; i < numAtoms; i++)
+            {
+                neighbors.clear();
+                grid.findNeighbors((*x)[i], &neighbors);
+                for (const auto& neighbor : neighbors)
+                {
+                    if (neighbor.second < gmx::square(r_solute[neighbor.first] + (*r)[i]))
+                    {
+                        overlaps[i] = 1;
+                        break;
+                    }
+                }
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+    for (int i = 0; i < numAtoms; i++)
+    {
+        if (overlaps[i] && !remover.isMarked(i))
+        {
+            remover.markResidue(*atoms, i, true);
         }
-        const real r1      = r_solute[pair.refIndex()];
-        const real r2      = (*r)[pair.testIndex()];
-        const bool bRemove = (pair.distance2() < gmx::square(r1 + r2));
-        remover.markResidue(*atoms, pair.testIndex(), bRemove);
     }
 
     remover.removeMarkedElements(x);
@@ -44,10 +44,13 @@
 #include <cstring>
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 #include "gromacs/fileio/pdbio.h"
 #include "gromacs/gmxpreprocess/pdb2top.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/selection/nbsearch.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
@@ -63,6 +66,9 @@ struct SpecialBond
     real        length;
 };
 
+/* Above this number of special atoms the distance matrix is too large to be useful */
+static constexpr int c_maxNumSpecialAtomsInDistanceMatrix = 100;
+
 static bool yesno()
 {
     char c;
@@ -218,20 +224,17 @@ std::vector<DisulfideBond> makeDisulfideBonds(t_atoms* pdba, rvec x[], bool bInt
                 specialBondAtomIdxs.push_back(i);
             }
         }
-        /* distance matrix d[nspec][nspec] */
-        int                            nspec = specialBondAtomIdxs.size();
-        std::vector<std::vector<real>> d(nspec);
-        for (int i = 0; (i < nspec); i++)
+        int nspec = specialBondAtomIdxs.size();
+        /* The distance between special atoms i and j */
+        auto d = [x, &specialBondAtomIdxs](int i, int j) {
+            return std::sqrt(distance2(x[specialBondAtomIdxs[i]], x[specialBondAtomIdxs[j]]));
+        };
+        if (nspec > c_maxNumSpecialAtomsInDistanceMatrix)
         {
-            d[i].resize(nspec);
-            int ai = specialBondAtomIdxs[i];
-            for (int j = 0; (j < nspec); j++)
-            {
-                int aj  = specialBondAtomIdxs[j];
-                d[i][j] = std::sqrt(distance2(x[ai], x[aj]));
-            }
+            fprintf(stderr, "Not printing the Special Atom Distance matrix for %d special atoms\n",
+                    nspec);
         }
-        if (nspec > 1)
+        else if (nspec > 1)
         {
 #define MAXCOL 7
             fprintf(stderr, "Special Atom Distance matrix:\n");
@@ -271,55 +274,91 @@ std::vector<DisulfideBond> makeDisulfideBonds(t_atoms* pdba, rvec x[], bool bInt
                     int e2 = std::min(i, e);
                     for (int j = b; (j < e2); j++)
                     {
-                        fprintf(stderr, " %7.3f", d[i][j]);
+                        fprintf(stderr, " %7.3f", d(i, j));
                     }
                     fprintf(stderr, "\n");
                 }
             }
         }
 
-        for (int i = 0; (i < nspec); i++)
+        /* Find the candidate pairs using a grid search up to the longest
+         * special bond, so large systems do not need to check all pairs.
+         * The pairs are then sorted to process them in the same order as
+         * a loop over all pairs would.
+         */
+        real maxLength = 0;
+        for (const auto& bond : specialBonds)
         {
-            int ai = specialBondAtomIdxs[i];
-            for (int j = i + 1; (j < nspec); j++)
+            maxLength = std::max(maxLength, bond.length);
+        }
+        std::vector<std::pair<int, int>> candidatePairs;
+        if (nspec > 1 && maxLength > 0)
+        {
+            std::vector<gmx::RVec> xspec;
+            xspec.reserve(nspec);
+            for (int ai : specialBondAtomIdxs)
             {
-                int aj = specialBondAtomIdxs[j];
-                /* Ensure creation of at most nspec special bonds to avoid overflowing bonds[] */
-                if (bonds.size() < specialBondAtomIdxs.size()
-                    && is_bond(specialBonds, pdba, ai, aj, d[i][j], &index_sb, &bSwap))
+                xspec.emplace_back(x[ai]);
+            }
+            gmx::AnalysisNeighborhood nb;
+            /* is_bond() accepts up to 1.1 times the length, add margin for rounding */
+            nb.setCutoff(1.11 * maxLength);
+            gmx::AnalysisNeighborhoodPositions  pos(xspec);
+            gmx::AnalysisNeighborhoodSearch     search     = nb.initSearch(nullptr, pos);
+            gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
+            gmx::AnalysisNeighborhoodPair       pair;
+            while (pairSearch.findNextPair(&pair))
+            {
+                if (pair.testIndex() < pair.refIndex())
                 {
-                    fprintf(stderr, "%s %s-%d %s-%d and %s-%d %s-%d%s", bInteractive ? "Link" : "Linking",
-                            *pdba->resinfo[pdba->atom[ai].resind].name,
-                            pdba->resinfo[specialBondResIdxs[i]].nr, *pdba->atomname[ai], ai + 1,
-                            *pdba->resinfo[pdba->atom[aj].resind].name,
-                            pdba->resinfo[specialBondResIdxs[j]].nr, *pdba->atomname[aj], aj + 1,
-                            bInteractive ? " (y/n) ?" : "...\n");
-                    bool bDoit = bInteractive ? yesno() : true;
+                    candidatePairs.emplace_back(pair.testIndex(), pair.refIndex());
+                }
+            }
+            std::sort(candidatePairs.begin(), candidatePairs.end());
+        }
 
-                    if (bDoit)
+        for (const auto& candidatePair : candidatePairs)
+        {
+            int i  = candidatePair.first;
+            int j  = candidatePair.second;
+            int ai = specialBondAtomIdxs[i];
+            int aj = specialBondAtomIdxs[j];
+            /* Ensure creation of at most nspec special bonds to avoid overflowing bonds[] */
+            if (bonds.size() < specialBondAtomIdxs.size()
+                && is_bond(specialBonds, pdba, ai, aj, d(i, j), &index_sb, &bSwap))
+            {
+                fprintf(stderr, "%s %s-%d %s-%d and %s-%d %s-%d%s",
+                        bInteractive ? "Link" : "Linking",
+                        *pdba->resinfo[pdba->atom[ai].resind].name,
+                        pdba->resinfo[specialBondResIdxs[i]].nr, *pdba->atomname[ai], ai + 1,
+                        *pdba->resinfo[pdba->atom[aj].resind].name,
+                        pdba->resinfo[specialBondResIdxs[j]].nr, *pdba->atomname[aj], aj + 1,
+                        bInteractive ? " (y/n) ?" : "...\n");
+                bool bDoit = bInteractive ? yesno() : true;
+
+                if (bDoit)
+                {
+                    DisulfideBond newBond;
+                    /* Store the residue numbers in the bonds array */
+                    newBond.firstResidue  = specialBondResIdxs[i];
+                    newBond.secondResidue = specialBondResIdxs[j];
+                    newBond.firstAtom     = *pdba->atomname[ai];
+                    newBond.secondAtom    = *pdba->atomname[aj];
+                    bonds.push_back(newBond);
+                    /* rename residues */
+                    if (bSwap)
+                    {
+                        rename_1res(pdba, specialBondResIdxs[i],
+                                    specialBonds[index_sb].newSecondResidue.c_str(), bVerbose);
+                        rename_1res(pdba, specialBondResIdxs[j],
+                                    specialBonds[index_sb].newFirstResidue.c_str(), bVerbose);
+                    }
+                    else
                     {
-                        DisulfideBond newBond;
-                        /* Store the residue numbers in the bonds array */
-                        newBond.firstResidue  = specialBondResIdxs[i];
-                        newBond.secondResidue = specialBondResIdxs[j];
-                        newBond.firstAtom     = *pdba->atomname[ai];
-                        newBond.secondAtom    = *pdba->atomname[aj];
-                        bonds.push_back(newBond);
-                        /* rename residues */
-                        if (bSwap)
-                        {
-                            rename_1res(pdba, specialBondResIdxs[i],
-                                        specialBonds[index_sb].newSecondResidue.c_str(), bVerbose);
-                            rename_1res(pdba, specialBondResIdxs[j],
-                                        specialBonds[index_sb].newFirstResidue.c_str(), bVerbose);
-                        }
-                        else
-                        {
-                            rename_1res(pdba, specialBondResIdxs[i],
-                                        specialBonds[index_sb].newFirstResidue.c_str(), bVerbose);
-                            rename_1res(pdba, specialBondResIdxs[j],
-                                        specialBonds[index_sb].newSecondResidue.c_str(), bVerbose);
-                        }
+                        rename_1res(pdba, specialBondResIdxs[i],
+                                    specialBonds[index_sb].newFirstResidue.c_str(), bVerbose);
+                        rename_1res(pdba, specialBondResIdxs[j],
+                                    specialBonds[index_sb].newSecondResidue.c_str(), bVerbose);
                     }
                 }
             }
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx::OccupancyGrid.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxpreprocess/occupancygrid.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/vec.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+class OccupancyGridTest : public ::testing::TestWithParam<std::tuple<PbcType, bool>>
+{
+public:
+    OccupancyGridTest() : rng_(12345), dist_(-0.3, 1.3) {}
+
+    //! Returns a random position, partly outside of \p box
+    RVec randomPosition(const matrix box)
+    {
+        RVec x = { 0, 0, 0 };
+        for (int d = 0; d < DIM; d++)
+        {
+            const real s = dist_(rng_);
+            for (int e = 0; e < DIM; e++)
+            {
+                x[e] += s * box[d][e];
+            }
+        }
+        return x;
+    }
+
+    DefaultRandomEngine           rng_;
+    UniformRealDistribution<real> dist_;
+};
+
+TEST_P(OccupancyGridTest, FindsTheSameNeighborsAsAllPairs)
+{
+    matrix box = { { 3, 0, 0 }, { 0, 4, 0 }, { 0, 0, 5 } };
+    if (std::get<1>(GetParam()))
+    {
+        box[YY][XX] = 1.2;
+        box[ZZ][XX] = -1.0;
+        box[ZZ][YY] = 1.5;
+    }
+    t_pbc pbc;
+    set_pbc(&pbc, std::get<0>(GetParam()), box);
+
+    std::vector<RVec> positions;
+    for (int i = 0; i < 2000; i++)
+    {
+        positions.push_back(randomPosition(box));
+    }
+    const real    cutoff = 0.7;
+    OccupancyGrid grid(pbc, cutoff);
+    // Add the positions both in a block and one at a time
+    grid.addPositions(ArrayRef<const RVec>(positions).subArray(0, 1000));
+    for (int i = 1000; i < gmx::ssize(positions); i++)
+    {
+        grid.addPosition(positions[i]);
+    }
+    ASSERT_EQ(gmx::ssize(positions), grid.size());
+
+    for (int q = 0; q < 200; q++)
+    {
+        const RVec                        xq = randomPosition(box);
+        std::vector<std::pair<int, real>> neighbors;
+        grid.findNeighbors(xq, &neighbors);
+        std::vector<int> found;
+        for (const auto& neighbor : neighbors)
+        {
+            found.push_back(neighbor.first);
+        }
+        std::sort(found.begin(), found.end());
+
+        std::vector<int> expected;
+        for (int i = 0; i < gmx::ssize(positions); i++)
+        {
+            rvec dx;
+            pbc_dx(&pbc, xq, positions[i], dx);
+            if (norm2(dx) <= gmx::square(cutoff))
+            {
+                expected.push_back(i);
+            }
+        }
+        EXPECT_EQ(expected, found);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(
+        WithBoxes,
+        OccupancyGridTest,
+        ::testing::Combine(::testing::Values(PbcType::Xyz, PbcType::XY, PbcType::No),
+                           ::testing::Bool()));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -55,6 +55,7 @@
 
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/warninp.h"
+#include "gromacs/gmxpreprocess/forcefieldcache.h"
 #include "gromacs/gmxpreprocess/gmxcpp.h"
 #include "gromacs/gmxpreprocess/gpp_atomtype.h"
 #include "gromacs/gmxpreprocess/gpp_bond_atomtype.h"
@@ -105,6 +106,7 @@ static void gen_pairs(const InteractionsOfType& nbs, InteractionsOfType* pairs,
 
     fprintf(stderr, "Generating 1-4 interactions: fudge = %g\n", fudge);
     pairs->interactionTypes.clear();
+    pairs->typeIndex.clear();
     int                             i = 0;
     std::array<int, 2>              atomNumbers;
     std::array<real, MAXFORCEPARAM> forceParam = { NOTSET };
@@ -455,6 +457,144 @@ static char** read_topol(const char*                           infile,
     bReadMolType  = FALSE;
     nmol_couple   = 0;
 
+    /* Processes a data line of one of the force-field directives */
+    auto pushForceFieldLine = [&](Directive directive, char* dataLine) {
+        switch (directive)
+        {
+            case Directive::d_defaults:
+                if (bReadDefaults)
+                {
+                    gmx_fatal(FARGS, "%s\nFound a second defaults directive.\n",
+                              cpp_error(&handle, eCPP_SYNTAX));
+                }
+                bReadDefaults = TRUE;
+                nscan = sscanf(dataLine, "%s%s%s%lf%lf%lf", nb_str, comb_str, genpairs, &fLJ,
+                               &fQQ, &fPOW);
+                if (nscan < 2)
+                {
+                    too_few(wi);
+                }
+                else
+                {
+                    bGenPairs = FALSE;
+                    fudgeLJ   = 1.0;
+                    *fudgeQQ  = 1.0;
+
+                    get_nbparm(nb_str, comb_str, &nb_funct, combination_rule, wi);
+                    if (nscan >= 3)
+                    {
+                        bGenPairs = (gmx::equalCaseInsensitive(genpairs, "Y", 1));
+                        if (nb_funct != eNBF_LJ && bGenPairs)
+                        {
+                            gmx_fatal(FARGS,
+                                      "Generating pair parameters is only supported "
+                                      "with LJ non-bonded interactions");
+                        }
+                    }
+                    if (nscan >= 4)
+                    {
+                        fudgeLJ = fLJ;
+                    }
+                    if (nscan >= 5)
+                    {
+                        *fudgeQQ = fQQ;
+                    }
+                    if (nscan >= 6)
+                    {
+                        *reppow = fPOW;
+                    }
+                }
+                nb_funct = ifunc_index(Directive::d_nonbond_params, nb_funct);
+                break;
+            case Directive::d_atomtypes:
+                push_at(symtab, atypes, &bondAtomType, dataLine, nb_funct, &nbparam,
+                        bGenPairs ? &pair : nullptr, wi);
+                break;
+
+            case Directive::d_bondtypes: // Intended to fall through
+            case Directive::d_constrainttypes:
+                push_bt(directive, interactions, 2, nullptr, &bondAtomType, dataLine, wi);
+                break;
+            case Directive::d_pairtypes:
+                if (bGenPairs)
+                {
+                    push_nbt(directive, pair, atypes, dataLine, F_LJ14, wi);
+                }
+                else
+                {
+                    push_bt(directive, interactions, 2, atypes, nullptr, dataLine, wi);
+                }
+                break;
+            case Directive::d_angletypes:
+                push_bt(directive, interactions, 3, nullptr, &bondAtomType, dataLine, wi);
+                break;
+            case Directive::d_dihedraltypes:
+                /* Special routine that can read both 2 and 4 atom dihedral definitions. */
+                push_dihedraltype(directive, interactions, &bondAtomType, dataLine, wi);
+                break;
+
+            case Directive::d_nonbond_params:
+                push_nbt(directive, nbparam, atypes, dataLine, nb_funct, wi);
+                break;
+
+            case Directive::d_implicit_genborn_params: // NOLINT bugprone-branch-clone
+                // Skip this line, so old topologies with
+                // GB parameters can be read.
+                break;
+
+            case Directive::d_implicit_surface_params:
+                // Skip this line, so that any topologies
+                // with surface parameters can be read
+                // (even though these were never formally
+                // supported).
+                break;
+
+            case Directive::d_cmaptypes:
+                push_cmaptype(directive, interactions, 5, atypes, &bondAtomType, dataLine, wi);
+                break;
+            default: gmx_incons("Not a force-field directive");
+        }
+    };
+
+    /* Processes the collected force-field lines, or reads their result
+     * from the cache, and stops collecting.
+     */
+    std::unique_ptr<gmx::ForceFieldCache> forceFieldCache =
+            gmx::ForceFieldCache::createFromEnvironment(*symtab);
+    auto finishForceField = [&]() {
+        gmx::ForceFieldState state;
+        state.haveDefaults        = &bReadDefaults;
+        state.generatePairs       = &bGenPairs;
+        state.nonbondedFunction   = &nb_funct;
+        state.combinationRule     = combination_rule;
+        state.repulsionPower      = reppow;
+        state.fudgeQQ             = fudgeQQ;
+        state.fudgeLJ             = &fudgeLJ;
+        state.symtab              = symtab;
+        state.atomTypes           = atypes;
+        state.bondAtomTypes       = &bondAtomType;
+        state.interactionTypes    = interactions;
+        state.nonbondedParameters = &nbparam;
+        state.pairParameters      = &pair;
+        if (!forceFieldCache->lines().empty() && !forceFieldCache->read(state))
+        {
+            const int numWarnings = warning_count(wi);
+            for (const gmx::ForceFieldCache::Line& line : forceFieldCache->lines())
+            {
+                set_warning_line(wi, line.fileName.c_str(), line.lineNumber);
+                // The push functions take a modifiable, null-terminated line
+                std::vector<char> dataLine(line.text.begin(), line.text.end());
+                dataLine.push_back('\0');
+                pushForceFieldLine(line.directive, dataLine.data());
+            }
+            if (warning_count(wi) == numWarnings)
+            {
+                forceFieldCache->write(state);
+            }
+        }
+        forceFieldCache.reset();
+    };
+
     do
     {
         status = cpp_read_line(&handle, STRLEN, line);
@@ -581,99 +721,33 @@ static char** read_topol(const char*                           infile,
                      * use a gigantic switch to decode,
                      * if there is a valid directive!
                      */
+                    if (forceFieldCache && !gmx::ForceFieldCache::isForceFieldDirective(d))
+                    {
+                        finishForceField();
+                        set_warning_line(wi, cpp_cur_file(&handle), cpp_cur_linenr(&handle));
+                    }
                     switch (d)
                     {
                         case Directive::d_defaults:
-                            if (bReadDefaults)
-                            {
-                                gmx_fatal(FARGS, "%s\nFound a second defaults directive.\n",
-                                          cpp_error(&handle, eCPP_SYNTAX));
-                            }
-                            bReadDefaults = TRUE;
-                            nscan = sscanf(pline, "%s%s%s%lf%lf%lf", nb_str, comb_str, genpairs,
-                                           &fLJ, &fQQ, &fPOW);
-                            if (nscan < 2)
-                            {
-                                too_few(wi);
-                            }
-                            else
-                            {
-                                bGenPairs = FALSE;
-                                fudgeLJ   = 1.0;
-                                *fudgeQQ  = 1.0;
-
-                                get_nbparm(nb_str, comb_str, &nb_funct, combination_rule, wi);
-                                if (nscan >= 3)
-                                {
-                                    bGenPairs = (gmx::equalCaseInsensitive(genpairs, "Y", 1));
-                                    if (nb_funct != eNBF_LJ && bGenPairs)
-                                    {
-                                        gmx_fatal(FARGS,
-                                                  "Generating pair parameters is only supported "
-                                                  "with LJ non-bonded interactions");
-                                    }
-                                }
-                                if (nscan >= 4)
-                                {
-                                    fudgeLJ = fLJ;
-                                }
-                                if (nscan >= 5)
-                                {
-                                    *fudgeQQ = fQQ;
-                                }
-                                if (nscan >= 6)
-                                {
-                                    *reppow = fPOW;
-                                }
-                            }
-                            nb_funct = ifunc_index(Directive::d_nonbond_params, nb_funct);
-
-                            break;
                         case Directive::d_atomtypes:
-                            push_at(symtab, atypes, &bondAtomType, pline, nb_funct, &nbparam,
-                                    bGenPairs ? &pair : nullptr, wi);
-                            break;
-
-                        case Directive::d_bondtypes: // Intended to fall through
+                        case Directive::d_bondtypes:
                         case Directive::d_constrainttypes:
-                            push_bt(d, interactions, 2, nullptr, &bondAtomType, pline, wi);
-                            break;
                         case Directive::d_pairtypes:
-                            if (bGenPairs)
-                            {
-                                push_nbt(d, pair, atypes, pline, F_LJ14, wi);
-                            }
-                            else
-                            {
-                                push_bt(d, interactions, 2, atypes, nullptr, pline, wi);
-                            }
-                            break;
                         case Directive::d_angletypes:
-                            push_bt(d, interactions, 3, nullptr, &bondAtomType, pline, wi);
-                            break;
                         case Directive::d_dihedraltypes:
-                            /* Special routine that can read both 2 and 4 atom dihedral definitions. */
-                            push_dihedraltype(d, interactions, &bondAtomType, pline, wi);
-                            break;
-
                         case Directive::d_nonbond_params:
-                            push_nbt(d, nbparam, atypes, pline, nb_funct, wi);
-                            break;
-
-                        case Directive::d_implicit_genborn_params: // NOLINT bugprone-branch-clone
-                            // Skip this line, so old topologies with
-                            // GB parameters can be read.
-                            break;
-
+                        case Directive::d_implicit_genborn_params:
                         case Directive::d_implicit_surface_params:
-                            // Skip this line, so that any topologies
-                            // with surface parameters can be read
-                            // (even though these were never formally
-                            // supported).
-                            break;
-
                         case Directive::d_cmaptypes:
-                            push_cmaptype(d, interactions, 5, atypes, &bondAtomType, pline, wi);
+                            if (forceFieldCache)
+                            {
+                                forceFieldCache->addLine(d, pline, cpp_cur_file(&handle),
+                                                         cpp_cur_linenr(&handle));
+                            }
+                            else
+                            {
+                                pushForceFieldLine(d, pline);
+                            }
                             break;
 
                         case Directive::d_moleculetype:
@@ -860,6 +934,11 @@ static char** read_topol(const char*                           infile,
         }
     } while (!done);
 
+    if (forceFieldCache)
+    {
+        finishForceField();
+    }
+
     // Check that all strings defined with -D were used when processing topology
     std::string unusedDefineWarning = checkAndWarnForUnusedDefines(*handle);
     if (!unusedDefineWarning.empty())
@@ -64,6 +64,7 @@
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/iserializer.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 
@@ -80,6 +81,7 @@ void generate_nbparams(int                     comb,
     nr   = atypes->size();
     nrfp = NRFP(ftype);
     interactions->interactionTypes.clear();
+    interactions->typeIndex.clear();
 
     std::array<real, MAXFORCEPARAM> forceParam = { NOTSET };
     /* Fill the matrix with force parameters */
@@ -257,6 +259,27 @@ void free_nbparam(t_nbparam** param, int nr)
     sfree(param);
 }
 
+void serializeNonbondedParameters(gmx::ISerializer* serializer, t_nbparam*** param, int nr)
+{
+    if (serializer->reading() && nr > 0)
+    {
+        snew(*param, nr);
+        for (int i = 0; i < nr; i++)
+        {
+            snew((*param)[i], i + 1);
+        }
+    }
+    for (int i = 0; i < nr; i++)
+    {
+        for (int j = 0; j <= i; j++)
+        {
+            t_nbparam* nbp = &(*param)[i][j];
+            serializer->doBool(&nbp->bSet);
+            serializer->doRealArray(nbp->c, 4);
+        }
+    }
+}
+
 static void copy_B_from_A(int ftype, double* c)
 {
     int nrfpA, nrfpB, i;
@@ -1484,39 +1507,6 @@ void push_molt(t_symtab* symtab, std::vector<MoleculeInformation>* mol, char* li
     mol->back().excl_set = false;
 }
 
-static bool findIfAllNBAtomsMatch(gmx::ArrayRef<const int> atomsFromParameterArray,
-                                  gmx::ArrayRef<const int> atomsFromCurrentParameter,
-                                  const t_atoms*           at,
-                                  bool                     bB)
-{
-    if (atomsFromParameterArray.size() != atomsFromCurrentParameter.size())
-    {
-        return false;
-    }
-    else if (bB)
-    {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
-        {
-            if (at->atom[atomsFromCurrentParameter[i]].typeB != atomsFromParameterArray[i])
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-    else
-    {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
-        {
-            if (at->atom[atomsFromCurrentParameter[i]].type != atomsFromParameterArray[i])
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-}
-
 static bool default_nb_params(int                               ftype,
                               gmx::ArrayRef<InteractionsOfType> bt,
                               t_atoms*                          at,
@@ -1569,19 +1559,19 @@ static bool default_nb_params(int                               ftype,
         }
     }
 
-    gmx::ArrayRef<const int> paramAtoms = p->atoms();
     /* Search explicitly if we didnt find it */
     if (!bFound)
     {
-        auto foundParameter =
-                std::find_if(bt[ftype].interactionTypes.begin(), bt[ftype].interactionTypes.end(),
-                             [&paramAtoms, &at, &bB](const auto& param) {
-                                 return findIfAllNBAtomsMatch(param.atoms(), paramAtoms, at, bB);
-                             });
-        if (foundParameter != bt[ftype].interactionTypes.end())
+        std::vector<int> types;
+        for (const int atom : p->atoms())
+        {
+            types.push_back(bB ? at->atom[atom].typeB : at->atom[atom].type);
+        }
+        const int position = bt[ftype].typeIndex.find(bt[ftype].interactionTypes, types);
+        if (position >= 0)
         {
             bFound = true;
-            pi     = &(*foundParameter);
+            pi     = &bt[ftype].interactionTypes[position];
         }
     }
 
@@ -1672,86 +1662,6 @@ static bool default_cmap_params(gmx::ArrayRef<InteractionsOfType> bondtype,
     return bFound;
 }
 
-/* Returns the number of exact atom type matches, i.e. non wild-card matches,
- * returns -1 when there are no matches at all.
- */
-static int natom_match(const InteractionOfType&      pi,
-                       int                           type_i,
-                       int                           type_j,
-                       int                           type_k,
-                       int                           type_l,
-                       const PreprocessingAtomTypes* atypes)
-{
-    if ((pi.ai() == -1 || atypes->bondAtomTypeFromAtomType(type_i) == pi.ai())
-        && (pi.aj() == -1 || atypes->bondAtomTypeFromAtomType(type_j) == pi.aj())
-        && (pi.ak() == -1 || atypes->bondAtomTypeFromAtomType(type_k) == pi.ak())
-        && (pi.al() == -1 || atypes->bondAtomTypeFromAtomType(type_l) == pi.al()))
-    {
-        return (pi.ai() == -1 ? 0 : 1) + (pi.aj() == -1 ? 0 : 1) + (pi.ak() == -1 ? 0 : 1)
-               + (pi.al() == -1 ? 0 : 1);
-    }
-    else
-    {
-        return -1;
-    }
-}
-
-static int findNumberOfDihedralAtomMatches(const InteractionOfType& currentParamFromParameterArray,
-                                           const InteractionOfType& parameterToAdd,
-                                           const t_atoms*           at,
-                                           const PreprocessingAtomTypes* atypes,
-                                           bool                          bB)
-{
-    if (bB)
-    {
-        return natom_match(currentParamFromParameterArray, at->atom[parameterToAdd.ai()].typeB,
-                           at->atom[parameterToAdd.aj()].typeB, at->atom[parameterToAdd.ak()].typeB,
-                           at->atom[parameterToAdd.al()].typeB, atypes);
-    }
-    else
-    {
-        return natom_match(currentParamFromParameterArray, at->atom[parameterToAdd.ai()].type,
-                           at->atom[parameterToAdd.aj()].type, at->atom[parameterToAdd.ak()].type,
-                           at->atom[parameterToAdd.al()].type, atypes);
-    }
-}
-
-static bool findIfAllParameterAtomsMatch(gmx::ArrayRef<const int>      atomsFromParameterArray,
-                                         gmx::ArrayRef<const int>      atomsFromCurrentParameter,
-                                         const t_atoms*                at,
-                                         const PreprocessingAtomTypes* atypes,
-                                         bool                          bB)
-{
-    if (atomsFromParameterArray.size() != atomsFromCurrentParameter.size())
-    {
-        return false;
-    }
-    else if (bB)
-    {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
-        {
-            if (atypes->bondAtomTypeFromAtomType(at->atom[atomsFromCurrentParameter[i]].typeB)
-                != atomsFromParameterArray[i])
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-    else
-    {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
-        {
-            if (atypes->bondAtomTypeFromAtomType(at->atom[atomsFromCurrentParameter[i]].type)
-                != atomsFromParameterArray[i])
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-}
-
 static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ftype,
                                                                           gmx::ArrayRef<InteractionsOfType> bt,
                                                                           t_atoms* at,
@@ -1773,26 +1683,47 @@ static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ft
     nparam_found = 0;
     if (ftype == F_PDIHS || ftype == F_RBDIHS || ftype == F_IDIHS || ftype == F_PIDIHS)
     {
-        int nmatch_max = -1;
+        std::array<int, 4> types;
+        for (int i = 0; i < 4; i++)
+        {
+            const int atom = p.atoms()[i];
+            types[i]       = atypes->bondAtomTypeFromAtomType(bB ? at->atom[atom].typeB
+                                                                 : at->atom[atom].type);
+        }
 
         /* For dihedrals we allow wildcards. We choose the first type
          * that has the most real matches, i.e. non-wildcard matches.
+         * Instead of testing all types, we look up each combination
+         * of real and wildcard atoms in the index.
          */
-        auto prevPos = bt[ftype].interactionTypes.end();
-        auto pos     = bt[ftype].interactionTypes.begin();
-        while (pos != bt[ftype].interactionTypes.end() && nmatch_max < 4)
-        {
-            pos = std::find_if(bt[ftype].interactionTypes.begin(), bt[ftype].interactionTypes.end(),
-                               [&p, &at, &atypes, &bB, &nmatch_max](const auto& param) {
-                                   return (findNumberOfDihedralAtomMatches(param, p, at, atypes, bB)
-                                           > nmatch_max);
-                               });
-            if (pos != bt[ftype].interactionTypes.end())
+        int nmatch_max = -1;
+        int position   = -1;
+        for (int mask = 0; mask < (1 << 4); mask++)
+        {
+            std::array<int, 4> pattern;
+            int                nmatch  = 0;
+            bool               isValid = true;
+            for (int i = 0; i < 4; i++)
+            {
+                const bool isReal = ((mask >> i) & 1) != 0;
+                /* An atom without bond type only matches a wildcard */
+                isValid = isValid && !(isReal && types[i] == -1);
+                pattern[i] = isReal ? types[i] : -1;
+                nmatch += isReal ? 1 : 0;
+            }
+            if (!isValid || nmatch < nmatch_max)
             {
-                prevPos    = pos;
-                nmatch_max = findNumberOfDihedralAtomMatches(*pos, p, at, atypes, bB);
+                continue;
+            }
+            const int found = bt[ftype].typeIndex.find(bt[ftype].interactionTypes, pattern);
+            if (found >= 0 && (nmatch > nmatch_max || found < position))
+            {
+                nmatch_max = nmatch;
+                position   = found;
             }
         }
+        auto prevPos = (position >= 0) ? bt[ftype].interactionTypes.begin() + position
+                                       : bt[ftype].interactionTypes.end();
 
         if (prevPos != bt[ftype].interactionTypes.end())
         {
@@ -1828,18 +1759,20 @@ static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ft
     }
     else /* Not a dihedral */
     {
-        gmx::ArrayRef<const int> atomParam = p.atoms();
-        auto                     found     = std::find_if(
-                bt[ftype].interactionTypes.begin(), bt[ftype].interactionTypes.end(),
-                [&atomParam, &at, &atypes, &bB](const auto& param) {
-                    return findIfAllParameterAtomsMatch(param.atoms(), atomParam, at, atypes, bB);
-                });
-        if (found != bt[ftype].interactionTypes.end())
+        std::vector<int> types;
+        for (const int atom : p.atoms())
+        {
+            types.push_back(atypes->bondAtomTypeFromAtomType(bB ? at->atom[atom].typeB
+                                                                : at->atom[atom].type));
+        }
+        const int position = bt[ftype].typeIndex.find(bt[ftype].interactionTypes, types);
+        if (position >= 0)
         {
             nparam_found = 1;
         }
         *nparam_def = nparam_found;
-        return found;
+        return (position >= 0) ? bt[ftype].interactionTypes.begin() + position
+                               : bt[ftype].interactionTypes.end();
     }
 }
 
@@ -60,6 +60,7 @@ namespace gmx
 template<typename>
 class ArrayRef;
 struct ExclusionBlock;
+class ISerializer;
 } // namespace gmx
 
 void generate_nbparams(int comb, int funct, InteractionsOfType* plist, PreprocessingAtomTypes* atype, warninp* wi);
@@ -132,6 +133,11 @@ int copy_nbparams(t_nbparam** param, int ftype, InteractionsOfType* plist, int n
 
 void free_nbparam(t_nbparam** param, int nr);
 
+void serializeNonbondedParameters(gmx::ISerializer* serializer, t_nbparam*** param, int nr);
+/* Reads or writes the explicit parameters for pairs of the \p nr atom types
+ * in \p param. The matrix is allocated when reading.
+ */
+
 int add_atomtype_decoupled(struct t_symtab*        symtab,
                            PreprocessingAtomTypes* at,
                            t_nbparam***            nbparam,
@@ -45,6 +45,7 @@
 #include "gromacs/gpu_utils/gputraits.cuh"
 #include "gromacs/math/vec.h"
 #include "gromacs/math/vectypes.h"
+#include "gromacs/timing/instrumentation.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxassert.h"
@@ -256,7 +257,8 @@ std::array<void*, sizeof...(Args)> prepareGpuKernelArguments(KernelPtr kernel,
  * \param[in] kernel          Kernel function handle
  * \param[in] config          Kernel configuration for launching
  * \param[in] deviceStream    GPU stream to launch kernel in
- * \param[in] kernelName      Human readable kernel description, for error handling only
+ * \param[in] kernelName      Human readable kernel description, for error handling and
+ *                            for annotating the launch for profilers
  * \param[in] kernelArgs      Array of the pointers to the kernel arguments, prepared by
  * prepareGpuKernelArguments() \throws gmx::InternalError on kernel launch failure
  */
@@ -270,8 +272,10 @@ void launchGpuKernel(void (*kernel)(Args...),
 {
     dim3 blockSize(config.blockSize[0], config.blockSize[1], config.blockSize[2]);
     dim3 gridSize(config.gridSize[0], config.gridSize[1], config.gridSize[2]);
+    instrumentationRangeStart(kernelName);
     cudaLaunchKernel((void*)kernel, gridSize, blockSize, const_cast<void**>(kernelArgs.data()),
                      config.sharedMemorySize, deviceStream.stream());
+    instrumentationRangeEnd();
 
     cudaError_t status = cudaGetLastError();
     if (cudaSuccess != status)
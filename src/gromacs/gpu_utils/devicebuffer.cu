@@ -0,0 +1,183 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Implements the device memory allocation behind DeviceBuffer for CUDA.
+ *
+ * When the device supports it, buffers are allocated stream-ordered
+ * from the default memory pool of the device. The pool keeps freed
+ * memory for reuse, so that reallocating buffers e.g. after domain
+ * decomposition repartitioning neither synchronizes the device nor
+ * returns memory to the driver.
+ *
+ * \ingroup module_gpu_utils
+ */
+#include "gmxpre.h"
+
+#include "devicebuffer.h"
+
+#include "config.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <map>
+#include <mutex>
+
+#include "gromacs/utility/gmxassert.h"
+
+namespace
+{
+
+/*! \brief Whether the use of the device memory pool is disabled
+ *
+ * Besides by the user, the pool is disabled when device buffers can be
+ * passed to an MPI library, since CUDA-aware MPI implementations use CUDA IPC,
+ * which does not support memory from the default memory pool.
+ */
+const bool c_disableDeviceMemoryPool =
+        (std::getenv("GMX_DISABLE_GPU_MEMORY_POOL") != nullptr
+         || (GMX_LIB_MPI
+             && (std::getenv("GMX_GPU_DD_COMMS") != nullptr
+                 || std::getenv("GMX_GPU_PME_PP_COMMS") != nullptr)));
+
+#if CUDART_VERSION >= 11020
+/*! \brief Configures the default memory pool of \p device for reuse of device buffers
+ *
+ * The release threshold is raised, so that freed memory stays in the pool
+ * instead of being returned to the driver at the next synchronization.
+ * Devices with peer access to \p device get access to the pool, so that
+ * buffers can be used for direct GPU communication as with cudaMalloc.
+ *
+ * \returns Whether \p device supports memory pools
+ */
+bool configureDeviceMemoryPool(int device)
+{
+    int supportsMemoryPools = 0;
+    cudaDeviceGetAttribute(&supportsMemoryPools, cudaDevAttrMemoryPoolsSupported, device);
+    if (supportsMemoryPools == 0)
+    {
+        return false;
+    }
+
+    cudaMemPool_t memoryPool;
+    cudaDeviceGetDefaultMemPool(&memoryPool, device);
+    uint64_t releaseThreshold = UINT64_MAX;
+    cudaMemPoolSetAttribute(memoryPool, cudaMemPoolAttrReleaseThreshold, &releaseThreshold);
+
+    int numDevices = 0;
+    cudaGetDeviceCount(&numDevices);
+    for (int peer = 0; peer < numDevices; peer++)
+    {
+        int canAccessPeer = 0;
+        if (peer != device && cudaDeviceCanAccessPeer(&canAccessPeer, peer, device) == cudaSuccess
+            && canAccessPeer)
+        {
+            cudaMemAccessDesc accessDesc = {};
+            accessDesc.location.type     = cudaMemLocationTypeDevice;
+            accessDesc.location.id       = peer;
+            accessDesc.flags             = cudaMemAccessFlagsProtReadWrite;
+            cudaMemPoolSetAccess(memoryPool, &accessDesc, 1);
+        }
+    }
+
+    return true;
+}
+#endif
+
+/*! \brief Returns whether buffers on the current device are allocated from its memory pool
+ *
+ * The pool of each device is configured on first use.
+ */
+bool currentDeviceUsesMemoryPool()
+{
+#if CUDART_VERSION >= 11020
+    if (c_disableDeviceMemoryPool)
+    {
+        return false;
+    }
+
+    static std::mutex          mutex;
+    static std::map<int, bool> deviceUsesMemoryPool;
+
+    int device = 0;
+    cudaGetDevice(&device);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto entry = deviceUsesMemoryPool.find(device);
+    if (entry == deviceUsesMemoryPool.end())
+    {
+        entry = deviceUsesMemoryPool.emplace(device, configureDeviceMemoryPool(device)).first;
+    }
+    return entry->second;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+void* allocateDeviceMemory(size_t numBytes)
+{
+    void*       pointer = nullptr;
+    cudaError_t stat;
+#if CUDART_VERSION >= 11020
+    if (currentDeviceUsesMemoryPool())
+    {
+        /* All GROMACS streams synchronize with the legacy default stream, so
+         * allocating and freeing in that stream orders the buffer lifetime
+         * with respect to all work without synchronizing the host. */
+        stat = cudaMallocAsync(&pointer, numBytes, cudaStreamLegacy);
+        GMX_RELEASE_ASSERT(stat == cudaSuccess, "cudaMallocAsync failure");
+        return pointer;
+    }
+#endif
+    stat = cudaMalloc(&pointer, numBytes);
+    GMX_RELEASE_ASSERT(stat == cudaSuccess, "cudaMalloc failure");
+    return pointer;
+}
+
+void freeDeviceMemory(void* pointer)
+{
+#if CUDART_VERSION >= 11020
+    if (currentDeviceUsesMemoryPool())
+    {
+        GMX_RELEASE_ASSERT(cudaFreeAsync(pointer, cudaStreamLegacy) == cudaSuccess,
+                           "cudaFreeAsync failed");
+        return;
+    }
+#endif
+    GMX_RELEASE_ASSERT(cudaFree(pointer) == cudaSuccess, "cudaFree failed");
+}
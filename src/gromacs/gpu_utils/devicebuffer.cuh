@@ -54,6 +54,17 @@
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/stringutil.h"
 
+/*! \brief Allocates \p numBytes of device memory on the current device
+ *
+ * When supported by the device, the memory comes from the stream-ordered
+ * memory pool of the device, which reuses freed memory. This can be
+ * disabled by setting the environment variable GMX_DISABLE_GPU_MEMORY_POOL.
+ */
+void* allocateDeviceMemory(size_t numBytes);
+
+//! Frees device memory allocated with allocateDeviceMemory()
+void freeDeviceMemory(void* pointer);
+
 /*! \brief
  * Allocates a device-side buffer.
  * It is currently a caller's responsibility to call it only on not-yet allocated buffers.
@@ -67,8 +78,7 @@ template<typename ValueType>
 void allocateDeviceBuffer(DeviceBuffer<ValueType>* buffer, size_t numValues, const DeviceContext& /* deviceContext */)
 {
     GMX_ASSERT(buffer, "needs a buffer pointer");
-    cudaError_t stat = cudaMalloc((void**)buffer, numValues * sizeof(ValueType));
-    GMX_RELEASE_ASSERT(stat == cudaSuccess, "cudaMalloc failure");
+    *buffer = static_cast<ValueType*>(allocateDeviceMemory(numValues * sizeof(ValueType)));
 }
 
 /*! \brief
@@ -85,7 +95,7 @@ void freeDeviceBuffer(DeviceBuffer* buffer)
     GMX_ASSERT(buffer, "needs a buffer pointer");
     if (*buffer)
     {
-        GMX_RELEASE_ASSERT(cudaFree(*buffer) == cudaSuccess, "cudaFree failed");
+        freeDeviceMemory(*buffer);
     }
 }
 
@@ -73,11 +73,19 @@
 #    define OPENCL_FUNC_ARGUMENT REAL_FUNC_ARGUMENT
 #    define OPENCL_FUNC_TERM REAL_FUNC_TERM
 #    define OPENCL_FUNC_TERM_WITH_RETURN(arg) REAL_FUNC_TERM_WITH_RETURN(arg)
+#    define SYCL_FUNC_QUALIFIER REAL_FUNC_QUALIFIER
+#    define SYCL_FUNC_ARGUMENT REAL_FUNC_ARGUMENT
+#    define SYCL_FUNC_TERM REAL_FUNC_TERM
+#    define SYCL_FUNC_TERM_WITH_RETURN(arg) REAL_FUNC_TERM_WITH_RETURN(arg)
+#    define CUDA_OR_SYCL_FUNC_QUALIFIER REAL_FUNC_QUALIFIER
+#    define CUDA_OR_SYCL_FUNC_ARGUMENT REAL_FUNC_ARGUMENT
+#    define CUDA_OR_SYCL_FUNC_TERM REAL_FUNC_TERM
+#    define CUDA_OR_SYCL_FUNC_TERM_WITH_RETURN(arg) REAL_FUNC_TERM_WITH_RETURN(arg)
 
 #else // Not DOXYGEN
 
 /* GPU support is enabled, so these functions will have real code defined somewhere */
-#    if GMX_GPU && !GMX_GPU_SYCL
+#    if GMX_GPU
 #        define GPU_FUNC_QUALIFIER REAL_FUNC_QUALIFIER
 #        define GPU_FUNC_ARGUMENT REAL_FUNC_ARGUMENT
 #        define GPU_FUNC_TERM REAL_FUNC_TERM
@@ -115,6 +123,30 @@
 #        define CUDA_FUNC_TERM_WITH_RETURN(arg) NULL_FUNC_TERM_WITH_RETURN(arg)
 #    endif
 
+#    if GMX_GPU_SYCL
+#        define SYCL_FUNC_QUALIFIER REAL_FUNC_QUALIFIER
+#        define SYCL_FUNC_ARGUMENT REAL_FUNC_ARGUMENT
+#        define SYCL_FUNC_TERM REAL_FUNC_TERM
+#        define SYCL_FUNC_TERM_WITH_RETURN(arg) REAL_FUNC_TERM_WITH_RETURN(arg)
+#    else
+#        define SYCL_FUNC_QUALIFIER NULL_FUNC_QUALIFIER
+#        define SYCL_FUNC_ARGUMENT NULL_FUNC_ARGUMENT
+#        define SYCL_FUNC_TERM NULL_FUNC_TERM
+#        define SYCL_FUNC_TERM_WITH_RETURN(arg) NULL_FUNC_TERM_WITH_RETURN(arg)
+#    endif
+
+#    if GMX_GPU_CUDA || GMX_GPU_SYCL
+#        define CUDA_OR_SYCL_FUNC_QUALIFIER REAL_FUNC_QUALIFIER
+#        define CUDA_OR_SYCL_FUNC_ARGUMENT REAL_FUNC_ARGUMENT
+#        define CUDA_OR_SYCL_FUNC_TERM REAL_FUNC_TERM
+#        define CUDA_OR_SYCL_FUNC_TERM_WITH_RETURN(arg) REAL_FUNC_TERM_WITH_RETURN(arg)
+#    else
+#        define CUDA_OR_SYCL_FUNC_QUALIFIER NULL_FUNC_QUALIFIER
+#        define CUDA_OR_SYCL_FUNC_ARGUMENT NULL_FUNC_ARGUMENT
+#        define CUDA_OR_SYCL_FUNC_TERM NULL_FUNC_TERM
+#        define CUDA_OR_SYCL_FUNC_TERM_WITH_RETURN(arg) NULL_FUNC_TERM_WITH_RETURN(arg)
+#    endif
+
 #endif // ifdef DOXYGEN
 
 #endif // GMX_GPU_UTILS_MACROS_H
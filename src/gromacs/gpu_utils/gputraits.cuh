@@ -52,6 +52,9 @@ using DeviceTexture = cudaTextureObject_t;
 //! \brief Single GPU call timing event - meaningless in CUDA
 using CommandEvent = void;
 
+//! Three-component float vector type used by code shared between the GPU backends
+using Float3 = float3;
+
 /*! \internal \brief
  * GPU kernels scheduling description. This is same in OpenCL/CUDA.
  * Provides reasonable defaults, one typically only needs to set the GPU stream
@@ -47,12 +47,16 @@
 #include <cstddef>
 
 #include "gromacs/gpu_utils/gmxsycl.h"
+#include "gromacs/math/vectypes.h"
 
 using DeviceTexture = void*;
 
 //! \brief Single GPU call timing event, not used with SYCL
 using CommandEvent = void*;
 
+//! Three-component float vector type used by code shared between the GPU backends
+using Float3 = gmx::RVec;
+
 /*! \internal \brief
  * GPU kernels scheduling description. This is same in OpenCL/CUDA.
  * Provides reasonable defaults, one typically only needs to set the GPU stream
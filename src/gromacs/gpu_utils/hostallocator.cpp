@@ -42,9 +42,14 @@
 
 #include "hostallocator.h"
 
+#include "config.h"
+
 #include <cstddef>
 
+#include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "gromacs/gpu_utils/gpu_utils.h"
 #include "gromacs/gpu_utils/pinning.h"
@@ -55,6 +60,101 @@
 namespace gmx
 {
 
+namespace
+{
+
+/*! \internal \brief Cache of pinned host buffers for reuse
+ *
+ * Pinning and unpinning memory is expensive and can synchronize the GPU.
+ * Pinned containers free their buffer whenever they grow, which happens
+ * e.g. for the state and nbnxm buffers at domain decomposition
+ * repartitioning. Freed buffers are therefore kept pinned here, up to
+ * a total size, and are handed out again for allocations that they fit
+ * without wasting more than half of the buffer.
+ */
+class PinnedBufferCache
+{
+public:
+    /*! \brief Returns a cached pinned buffer of at least \p numBytes, or nullptr
+     *
+     * The returned buffer is removed from the cache.
+     */
+    void* take(std::size_t numBytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto buffer = cachedBuffers_.lower_bound(numBytes);
+        if (buffer == cachedBuffers_.end() || buffer->first > 2 * numBytes)
+        {
+            return nullptr;
+        }
+        void* pointer = buffer->second;
+        numCachedBytes_ -= buffer->first;
+        cachedBuffers_.erase(buffer);
+
+        return pointer;
+    }
+
+    //! Records that \p pointer was allocated and pinned with size \p numBytes
+    void add(void* pointer, std::size_t numBytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        sizes_[pointer] = numBytes;
+    }
+
+    /*! \brief Puts the buffer \p pointer into the cache when it fits
+     *
+     * \returns Whether the buffer was cached, otherwise the caller should
+     * unpin and free it.
+     */
+    bool release(void* pointer)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto size = sizes_.find(pointer);
+        GMX_ASSERT(size != sizes_.end(), "Only pinned buffers that were added can be released");
+        if (numCachedBytes_ + size->second > c_maxNumCachedBytes)
+        {
+            sizes_.erase(size);
+            return false;
+        }
+        cachedBuffers_.emplace(size->second, pointer);
+        numCachedBytes_ += size->second;
+
+        return true;
+    }
+
+private:
+    //! The maximum total size of the cached buffers
+    static constexpr std::size_t c_maxNumCachedBytes = 512 * 1024 * 1024;
+
+    //! Protects the cache, as containers can be allocated on any thread
+    std::mutex mutex_;
+    //! The size of every pinned buffer in use or in the cache
+    std::unordered_map<void*, std::size_t> sizes_;
+    //! The cached buffers, ordered by size
+    std::multimap<std::size_t, void*> cachedBuffers_;
+    //! The total size of the cached buffers
+    std::size_t numCachedBytes_ = 0;
+};
+
+/*! \brief Returns the process-wide cache of pinned buffers
+ *
+ * The cache is never destroyed, because unpinning at static destruction
+ * time could happen after the CUDA runtime was shut down.
+ */
+PinnedBufferCache& pinnedBufferCache()
+{
+    static auto* cache = new PinnedBufferCache;
+    return *cache;
+}
+
+//! Whether pinning does anything and pinned buffers should be cached
+constexpr bool c_cachePinnedBuffers = (GMX_GPU_CUDA != 0);
+
+} // namespace
+
 HostAllocationPolicy::HostAllocationPolicy(PinningPolicy pinningPolicy) :
     pinningPolicy_(pinningPolicy)
 {
@@ -70,6 +170,15 @@ void* HostAllocationPolicy::malloc(std::size_t bytes) const noexcept
 {
     if (pinningPolicy_ == PinningPolicy::PinnedIfSupported)
     {
+        if (c_cachePinnedBuffers)
+        {
+            void* cached = pinnedBufferCache().take(bytes);
+            if (cached)
+            {
+                return cached;
+            }
+        }
+
         void* p = PageAlignedAllocationPolicy::malloc(bytes);
         if (p)
         {
@@ -86,6 +195,10 @@ void* HostAllocationPolicy::malloc(std::size_t bytes) const noexcept
              * Note that we always pin (even for size 0) so that we
              * can always unpin without any checks. */
             pinBuffer(p, bytes);
+            if (c_cachePinnedBuffers)
+            {
+                pinnedBufferCache().add(p, bytes);
+            }
         }
         return p;
     }
@@ -104,6 +217,10 @@ void HostAllocationPolicy::free(void* buffer) const noexcept
     }
     if (pinningPolicy_ == PinningPolicy::PinnedIfSupported)
     {
+        if (c_cachePinnedBuffers && pinnedBufferCache().release(buffer))
+        {
+            return;
+        }
         unpinBuffer(buffer);
         PageAlignedAllocationPolicy::free(buffer);
     }
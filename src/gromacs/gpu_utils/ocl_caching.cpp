@@ -49,7 +49,9 @@
 #include <assert.h>
 
 #include <cctype>
+#include <cinttypes>
 #include <cstdio>
+#include <cstdlib>
 
 #include <algorithm>
 #include <array>
@@ -57,10 +59,13 @@
 #include <string>
 #include <vector>
 
+#include "gromacs/utility/baseversion.h"
 #include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/path.h"
 #include "gromacs/utility/programcontext.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/sysinfo.h"
 #include "gromacs/utility/textreader.h"
 #include "gromacs/utility/unique_cptr.h"
 
@@ -69,19 +74,55 @@ namespace gmx
 namespace ocl
 {
 
-std::string makeBinaryCacheFilename(const std::string& kernelFilename, cl_device_id deviceId)
+/*! \brief Returns a string device property of \p deviceId
+ *
+ * \throws InternalError  if an OpenCL error was encountered
+ */
+static std::string getDeviceInfoString(cl_device_id deviceId, cl_device_info paramName)
 {
     // Note that the OpenCL API is defined in terms of bytes, and we
     // assume that sizeof(char) is one byte.
-    std::array<char, 1024> deviceName;
-    size_t                 deviceNameLength;
-    cl_int                 cl_error = clGetDeviceInfo(deviceId, CL_DEVICE_NAME, deviceName.size(),
-                                      deviceName.data(), &deviceNameLength);
+    std::array<char, 1024> value;
+    size_t                 valueLength;
+    cl_int                 cl_error =
+            clGetDeviceInfo(deviceId, paramName, value.size(), value.data(), &valueLength);
     if (cl_error != CL_SUCCESS)
     {
-        GMX_THROW(InternalError(formatString("Could not get OpenCL device name, error was %s",
+        GMX_THROW(InternalError(formatString("Could not get OpenCL device info, error was %s",
                                              ocl_get_error_string(cl_error).c_str())));
     }
+    // The returned length includes the terminating null character
+    return std::string(value.data(), std::max<size_t>(valueLength, 1) - 1);
+}
+
+/*! \brief Returns the 64-bit FNV-1a hash of \p text
+ *
+ * Unlike std::hash, this is the same for every build and run, as
+ * needed for naming files shared between runs.
+ */
+static uint64_t fnv1aHash(const std::string& text)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string makeBinaryCacheFilename(const std::string& kernelFilename,
+                                    cl_device_id       deviceId,
+                                    const std::string& buildKey)
+{
+    const std::string deviceName    = getDeviceInfoString(deviceId, CL_DEVICE_NAME);
+    const std::string deviceVersion = getDeviceInfoString(deviceId, CL_DEVICE_VERSION);
+    const std::string driverVersion = getDeviceInfoString(deviceId, CL_DRIVER_VERSION);
+    const std::string identity      = formatString("%s\n%s\n%s\n%s\n", gmx_version(),
+                                              deviceName.c_str(), deviceVersion.c_str(),
+                                              driverVersion.c_str())
+                                 + buildKey;
+    const uint64_t hash = fnv1aHash(identity);
 
     std::string cacheFilename = "OCL-cache";
     /* remove the kernel source suffix */
@@ -94,9 +135,14 @@ std::string makeBinaryCacheFilename(const std::string& kernelFilename, cl_device
        (symbols), by permitting only alphanumeric characters from the
        current locale. We assume these work well enough in a
        filename. */
-    std::copy_if(deviceName.begin(), deviceName.begin() + deviceNameLength,
-                 std::back_inserter(cacheFilename), isalnum);
-    cacheFilename += ".bin";
+    std::copy_if(deviceName.begin(), deviceName.end(), std::back_inserter(cacheFilename), isalnum);
+    cacheFilename += formatString("_%016" PRIx64 ".bin", hash);
+
+    const char* cacheDirectory = getenv("GMX_OCL_CACHE_DIR");
+    if (cacheDirectory != nullptr)
+    {
+        cacheFilename = Path::join(cacheDirectory, cacheFilename);
+    }
 
     return cacheFilename;
 }
@@ -125,12 +171,8 @@ cl_program makeProgramFromCache(const std::string& filename, cl_context context,
         GMX_THROW(FileIOError("Failed to read binary cache file " + filename));
     }
 
-    /* TODO If/when caching is re-enabled, compare current build
-     * options and code against the build options and the code
-     * corresponding to the cache. If any change is detected then the
-     * cache cannot be used.
-     *
-     * Also caching functionality will need full re-testing. */
+    /* The build options and code are part of the cache file name,
+     * so a cache that was found always matches the current build. */
 
     /* Create program from pre-built binary */
     cl_int     cl_error;
@@ -169,13 +211,27 @@ void writeBinaryToCache(cl_program program, const std::string& filename)
                                 + ocl_get_error_string(cl_error)));
     }
 
-    const auto f = create_unique_with_deleter(fopen(filename.c_str(), "wb"), fclose);
-    if (!f)
+    /* Write to a file unique to this process and rename it afterwards,
+     * so other ranks never read a partially written cache file. */
+    const std::string temporaryFilename = formatString("%s.%d.tmp", filename.c_str(), gmx_getpid());
     {
-        GMX_THROW(FileIOError("Failed to open binary cache file " + filename));
+        const auto f = create_unique_with_deleter(fopen(temporaryFilename.c_str(), "wb"), fclose);
+        if (!f)
+        {
+            GMX_THROW(FileIOError("Failed to open binary cache file " + temporaryFilename));
+        }
+
+        if (fwrite(binary, 1, fileSize, f.get()) != fileSize)
+        {
+            std::remove(temporaryFilename.c_str());
+            GMX_THROW(FileIOError("Failed to write binary cache file " + temporaryFilename));
+        }
+    }
+    if (std::rename(temporaryFilename.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(temporaryFilename.c_str());
+        GMX_THROW(FileIOError("Failed to rename binary cache file to " + filename));
     }
-
-    fwrite(binary, 1, fileSize, f.get());
 }
 
 } // namespace ocl
@@ -57,20 +57,22 @@ namespace ocl
 {
 
 /*! \brief Construct the name for the binary cache file
+ *
+ * The name contains a hash of the GROMACS version, the device name,
+ * device and driver version and \p buildKey, so a binary compiled for a
+ * different device, driver, source or set of options is never reused.
+ * When the GMX_OCL_CACHE_DIR environment variable is set, the file is
+ * placed in that directory, otherwise in the working directory.
  *
  * \param[in]  kernelFilename  Name of the kernel from which the binary will be compiled.
  * \param[in]  deviceId        ID of the device upon which the binary is used.
- *
- * \todo The set of preprocessor options should also form part of the
- * identification of the cached binary. Also perhaps compiler, runtime
- * and device version info?
- *
- * \todo Mutual exclusion of ranks and nodes should also be implemented
- * if/when caching is re-enabled.
+ * \param[in]  buildKey        The build options and kernel source used to compile the binary.
  *
  * \returns The name of the cache file.
  */
-std::string makeBinaryCacheFilename(const std::string& kernelFilename, cl_device_id deviceId);
+std::string makeBinaryCacheFilename(const std::string& kernelFilename,
+                                    cl_device_id       deviceId,
+                                    const std::string& buildKey);
 
 /*! \brief Check if there's a valid cache available, and return it if so
  *
@@ -86,6 +88,10 @@ std::string makeBinaryCacheFilename(const std::string& kernelFilename, cl_device
 cl_program makeProgramFromCache(const std::string& filename, cl_context context, cl_device_id deviceId);
 
 /*! \brief Implement caching of OpenCL binaries
+ *
+ * The binary is first written to a file unique to this process, which
+ * is then renamed to \p filename. Several ranks can thus write the same
+ * cache file concurrently without others reading a partial file.
  *
  * \param[in] program     Index of program to cache
  * \param[in] filename    Name of file to use for the cache
@@ -74,9 +74,13 @@ namespace ocl
 
 /*! \brief True if OpenCL binary caching is enabled.
  *
- *  Currently caching is disabled by default unless the env var override
- *  is used until we resolve concurrency issues. */
-static bool useBuildCache = getenv("GMX_OCL_GENCACHE") != nullptr;
+ *  Caching is enabled by setting GMX_OCL_GENCACHE, or by setting
+ *  GMX_OCL_CACHE_DIR to choose a directory for the cache files, unless
+ *  GMX_OCL_NOGENCACHE is set. It is off by default to avoid leaving
+ *  binaries in the working directory. */
+static bool useBuildCache =
+        (getenv("GMX_OCL_GENCACHE") != nullptr || getenv("GMX_OCL_CACHE_DIR") != nullptr)
+        && getenv("GMX_OCL_NOGENCACHE") == nullptr;
 
 /*! \brief Handles writing the OpenCL JIT compilation log to \c fplog.
  *
@@ -425,12 +429,19 @@ cl_program compileProgram(FILE*              fplog,
     std::string preprocessorOptions = makePreprocessorOptions(
             kernelRootPath, rootPath, getDeviceWarpSize(context, deviceId), deviceVendor, extraDefines);
 
+    std::string kernelSource = TextReader::readFileToString(kernelFilename);
+    if (kernelSource.empty())
+    {
+        GMX_THROW(FileIOError("Error loading OpenCL code " + kernelFilename));
+    }
+
     bool buildCacheWasRead = false;
 
     std::string cacheFilename;
     if (useBuildCache)
     {
-        cacheFilename = makeBinaryCacheFilename(kernelBaseFilename, deviceId);
+        cacheFilename = makeBinaryCacheFilename(
+                kernelBaseFilename, deviceId, preprocessorOptions + '\n' + kernelSource);
     }
 
     /* Create OpenCL program */
@@ -445,13 +456,16 @@ cl_program compileProgram(FILE*              fplog,
                 program           = makeProgramFromCache(cacheFilename, context, deviceId);
                 buildCacheWasRead = true;
             }
-            catch (FileIOError& e)
+            catch (GromacsException& e)
             {
                 // Failing to read from the cache is not a critical error
                 formatExceptionMessageToFile(fplog, e);
             }
-            fprintf(fplog, "OpenCL binary cache file %s is present, will load kernels.\n",
-                    cacheFilename.c_str());
+            if (buildCacheWasRead)
+            {
+                fprintf(fplog, "OpenCL binary cache file %s is present, will load kernels.\n",
+                        cacheFilename.c_str());
+            }
         }
         else
         {
@@ -464,11 +478,6 @@ cl_program compileProgram(FILE*              fplog,
     if (program == nullptr)
     {
         // Compile OpenCL program from source
-        std::string kernelSource = TextReader::readFileToString(kernelFilename);
-        if (kernelSource.empty())
-        {
-            GMX_THROW(FileIOError("Error loading OpenCL code " + kernelFilename));
-        }
         const char* kernelSourcePtr  = kernelSource.c_str();
         size_t      kernelSourceSize = kernelSource.size();
         /* Create program from source code */
@@ -0,0 +1,126 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ *  \brief Declare utility routines for SYCL
+ *
+ *  \inlibraryapi
+ *  \ingroup module_gpu_utils
+ */
+#ifndef GMX_GPU_UTILS_SYCLUTILS_H
+#define GMX_GPU_UTILS_SYCLUTILS_H
+
+#include <type_traits>
+
+#include "gromacs/gpu_utils/device_stream.h"
+#include "gromacs/gpu_utils/devicebuffer.h"
+#include "gromacs/gpu_utils/gmxsycl.h"
+
+/*! \brief Check whether all work in the SYCL queue has completed.
+ *
+ * Enqueues a barrier in the queue and queries its state, so it does not block.
+ * Relies on the SYCL_INTEL_enqueue_barrier extension, same as GpuEventSynchronizer.
+ *
+ * \param[in] deviceStream  The SYCL queue to check.
+ * \returns                 True if all tasks submitted so far have completed.
+ */
+static inline bool haveStreamTasksCompleted(const DeviceStream& deviceStream)
+{
+    const cl::sycl::event barrier = deviceStream.stream().submit_barrier();
+    return barrier.get_info<cl::sycl::info::event::command_execution_status>()
+           == cl::sycl::info::event_command_status::complete;
+}
+
+//! Accessor to a global device buffer
+template<typename T, cl::sycl::access::mode mode>
+using DeviceAccessor = cl::sycl::accessor<T, 1, mode, cl::sycl::access::target::global_buffer>;
+
+//! Accessor to local (shared) work-group memory
+template<typename T>
+using LocalAccessor =
+        cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local>;
+
+//! Placeholder for an accessor which is not used by a kernel flavor
+struct EmptyAccessor
+{
+};
+
+//! An accessor which is only constructed when \p enabled
+template<typename T, cl::sycl::access::mode mode, bool enabled>
+using OptionalAccessor = std::conditional_t<enabled, DeviceAccessor<T, mode>, EmptyAccessor>;
+
+//! A local memory accessor which is only constructed when \p enabled
+template<typename T, bool enabled>
+using OptionalLocalAccessor = std::conditional_t<enabled, LocalAccessor<T>, EmptyAccessor>;
+
+//! Get an accessor to \p buffer in the command group \p cgh
+template<cl::sycl::access::mode mode, typename T>
+static inline DeviceAccessor<T, mode> getAccessor(const DeviceBuffer<T>& buffer, cl::sycl::handler& cgh)
+{
+    return DeviceAccessor<T, mode>{ *buffer.buffer_, cgh };
+}
+
+/*! \brief Get an accessor to \p buffer when \p enabled, or a placeholder otherwise.
+ *
+ * The buffer does not need to be allocated when the accessor is not enabled.
+ */
+template<cl::sycl::access::mode mode, bool enabled, typename T>
+static inline OptionalAccessor<T, mode, enabled> getOptionalAccessor(const DeviceBuffer<T>& buffer,
+                                                                     cl::sycl::handler&     cgh)
+{
+    if constexpr (enabled)
+    {
+        return getAccessor<mode>(buffer, cgh);
+    }
+    else
+    {
+        return EmptyAccessor{};
+    }
+}
+
+//! Get a local memory accessor of \p size elements when \p enabled, or a placeholder otherwise
+template<typename T, bool enabled>
+static inline OptionalLocalAccessor<T, enabled> getOptionalLocalAccessor(size_t size, cl::sycl::handler& cgh)
+{
+    if constexpr (enabled)
+    {
+        return LocalAccessor<T>{ cl::sycl::range<1>(size), cgh };
+    }
+    else
+    {
+        return EmptyAccessor{};
+    }
+}
+
+#endif
@@ -41,6 +41,8 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -357,29 +359,39 @@ void hardwareTopologyDoubleCheckDetection(const gmx::MDLogger gmx_unused& mdlog,
 
 std::unique_ptr<gmx_hw_info_t> gmx_detect_hardware(const PhysicalNodeCommunicator& physicalNodeComm)
 {
+    const auto detectionStart = std::chrono::steady_clock::now();
+
     // Ensure all cores have spun up, where applicable.
     hardwareTopologyPrepareDetection();
 
+    // The CPU and topology detection does not use MPI, so we run it
+    // in a separate thread while this thread detects the GPUs, which
+    // can take long and can communicate over MPI.
     // TODO: We should also do CPU hardware detection only once on each
     // physical node and broadcast it, instead of doing it on every MPI rank.
-    auto hardwareInfo = std::make_unique<gmx_hw_info_t>(
-            std::make_unique<CpuInfo>(CpuInfo::detect()),
-            std::make_unique<HardwareTopology>(HardwareTopology::detect()));
+    auto cpuDetection = std::async(std::launch::async, []() {
+        return std::make_unique<gmx_hw_info_t>(
+                std::make_unique<CpuInfo>(CpuInfo::detect()),
+                std::make_unique<HardwareTopology>(HardwareTopology::detect()));
+    });
+
+    // Detect GPUs
+    DeviceDetectionResult deviceDetectionResult = detectAllDeviceInformation(physicalNodeComm);
+
+    auto hardwareInfo = cpuDetection.get();
 
     // TODO: Get rid of this altogether.
     hardwareInfo->nthreads_hw_avail = hardwareInfo->hardwareTopology->machine().logicalProcessorCount;
 
-    // Detect GPUs
-    // Open a nested scope so no temporary variables can
-    // be mis-used later.
-    {
-        DeviceDetectionResult deviceDetectionResult = detectAllDeviceInformation(physicalNodeComm);
-        hardwareInfo->deviceInfoList.swap(deviceDetectionResult.deviceInfoList_);
-        std::swap(hardwareInfo->hardwareDetectionWarnings_, deviceDetectionResult.deviceDetectionWarnings_);
-    }
+    hardwareInfo->deviceInfoList.swap(deviceDetectionResult.deviceInfoList_);
+    std::swap(hardwareInfo->hardwareDetectionWarnings_, deviceDetectionResult.deviceDetectionWarnings_);
 
     gmx_collect_hardware_mpi(*hardwareInfo->cpuInfo, physicalNodeComm, hardwareInfo.get());
 
+    const std::chrono::duration<double> detectionTime =
+            std::chrono::steady_clock::now() - detectionStart;
+    hardwareInfo->detectionTimeInSeconds = detectionTime.count();
+
     return hardwareInfo;
 }
 
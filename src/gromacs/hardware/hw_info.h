@@ -95,6 +95,9 @@ struct gmx_hw_info_t
 
     //! Container of warning strings to log later when that is possible.
     std::vector<std::string> hardwareDetectionWarnings_;
+
+    //! Wall time in seconds spent in hardware detection, for the startup timing report.
+    double detectionTimeInSeconds = 0;
 };
 
 
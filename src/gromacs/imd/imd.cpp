@@ -1279,11 +1279,11 @@ static void imd_check_integrator_parallel(const t_inputrec* ir, const t_commrec*
 {
     if (PAR(cr))
     {
-        if (((ir->eI) == eiSteep) || ((ir->eI) == eiCG) || ((ir->eI) == eiLBFGS) || ((ir->eI) == eiNM))
+        if (EI_ENERGY_MINIMIZATION(ir->eI) || ((ir->eI) == eiNM))
         {
             gmx_fatal(FARGS,
-                      "%s Energy minimization via steep, CG, lbfgs and nm in parallel is currently "
-                      "not supported by IMD.\n",
+                      "%s Energy minimization via steep, CG, lbfgs, fire and nm in parallel is "
+                      "currently not supported by IMD.\n",
                       IMDstr);
         }
     }
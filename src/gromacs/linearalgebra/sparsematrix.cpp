@@ -188,6 +188,40 @@ void gmx_sparsematrix_increment_value(gmx_sparsematrix_t* A, int row, int col, r
 }
 
 
+void gmx_sparsematrix_set_row_from_dense(gmx_sparsematrix_t* A, int row, int firstCol, int ncol, const real* values)
+{
+    int nonzero = 0;
+    int col;
+
+    assert(row < A->nrow);
+    assert(A->ndata[row] == 0);
+
+    for (col = firstCol; col < ncol; col++)
+    {
+        if (values[col - firstCol] != 0.0)
+        {
+            nonzero++;
+        }
+    }
+
+    if (nonzero > A->nalloc[row])
+    {
+        A->nalloc[row] = nonzero;
+        srenew(A->data[row], A->nalloc[row]);
+    }
+
+    for (col = firstCol; col < ncol; col++)
+    {
+        if (values[col - firstCol] != 0.0)
+        {
+            A->data[row][A->ndata[row]].col   = col;
+            A->data[row][A->ndata[row]].value = values[col - firstCol];
+            A->ndata[row]++;
+        }
+    }
+}
+
+
 /* Routine to compare column values of two entries, used for quicksort of each row.
  *
  * The data entries to compare are of the type gmx_sparsematrix_entry_t, but quicksort
@@ -153,6 +153,17 @@ real gmx_sparsematrix_value(gmx_sparsematrix_t* A, int row, int col);
 void gmx_sparsematrix_increment_value(gmx_sparsematrix_t* A, int row, int col, real difference);
 
 
+/*! \brief Set the entries of an empty row from a dense array of values.
+ *
+ *  All non-zero values[col-firstCol] with firstCol <= col < ncol are stored
+ *  in row, in increasing column order. The row should not contain any entries
+ *  yet. Since no search for existing entries is needed and the storage is
+ *  allocated once, this is much faster than calling
+ *  gmx_sparsematrix_increment_value() for each element of a complete row.
+ */
+void gmx_sparsematrix_set_row_from_dense(gmx_sparsematrix_t* A, int row, int firstCol, int ncol, const real* values);
+
+
 /*! \brief Sort elements in each column and remove zeros.
  *
  *  Sparse matrix access is faster when the elements are stored in
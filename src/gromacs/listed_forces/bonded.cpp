@@ -2205,18 +2205,19 @@ rbdihs(int             nbonds,
 
 
 template<BondedKernelFlavor flavor>
-real idihs(int             nbonds,
-           const t_iatom   forceatoms[],
-           const t_iparams forceparams[],
-           const rvec      x[],
-           rvec4           f[],
-           rvec            fshift[],
-           const t_pbc*    pbc,
-           real            lambda,
-           real*           dvdlambda,
-           const t_mdatoms gmx_unused* md,
-           t_fcdata gmx_unused* fcd,
-           int gmx_unused* global_atom_index)
+std::enable_if_t<flavor != BondedKernelFlavor::ForcesSimdWhenAvailable || !GMX_SIMD_HAVE_REAL, real>
+idihs(int             nbonds,
+      const t_iatom   forceatoms[],
+      const t_iparams forceparams[],
+      const rvec      x[],
+      rvec4           f[],
+      rvec            fshift[],
+      const t_pbc*    pbc,
+      real            lambda,
+      real*           dvdlambda,
+      const t_mdatoms gmx_unused* md,
+      t_fcdata gmx_unused* fcd,
+      int gmx_unused* global_atom_index)
 {
     int  i, type, ai, aj, ak, al;
     int  t1, t2, t3;
@@ -2273,6 +2274,122 @@ real idihs(int             nbonds,
     return vtot;
 }
 
+#if GMX_SIMD_HAVE_REAL
+
+/* As idihs above, but using SIMD to calculate multiple improper dihedrals at once.
+ * This function can replace idihs() when no energy and virial are needed.
+ */
+template<BondedKernelFlavor flavor>
+std::enable_if_t<flavor == BondedKernelFlavor::ForcesSimdWhenAvailable, real>
+idihs(int             nbonds,
+      const t_iatom   forceatoms[],
+      const t_iparams forceparams[],
+      const rvec      x[],
+      rvec4           f[],
+      rvec gmx_unused fshift[],
+      const t_pbc*    pbc,
+      real gmx_unused lambda,
+      real gmx_unused* dvdlambda,
+      const t_mdatoms gmx_unused* md,
+      t_fcdata gmx_unused* fcd,
+      int gmx_unused* global_atom_index)
+{
+    const int                                nfa1 = 5;
+    int                                      i, iu, s;
+    int                                      type;
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ai[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t aj[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ak[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t al[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         buf[2 * GMX_SIMD_REAL_WIDTH];
+    real *                                   kr, *phi0;
+    SimdReal                                 deg2rad_S(DEG2RAD);
+    SimdReal                                 pi_S(M_PI);
+    SimdReal                                 twopi_S(2 * M_PI);
+    SimdReal                                 p_S, q_S;
+    SimdReal                                 phi0_S, phi_S, dp_S;
+    SimdReal                                 mx_S, my_S, mz_S;
+    SimdReal                                 nx_S, ny_S, nz_S;
+    SimdReal                                 nrkj_m2_S, nrkj_n2_S;
+    SimdReal                                 kr_S;
+    SimdReal                                 mddphi_S;
+    SimdReal                                 sf_i_S, msf_l_S;
+    alignas(GMX_SIMD_ALIGNMENT) real         pbc_simd[9 * GMX_SIMD_REAL_WIDTH];
+
+    /* Extract aligned pointer for parameters and variables */
+    kr   = buf + 0 * GMX_SIMD_REAL_WIDTH;
+    phi0 = buf + 1 * GMX_SIMD_REAL_WIDTH;
+
+    set_pbc_simd(pbc, pbc_simd);
+
+    /* nbonds is the number of dihedrals times nfa1, here we step GMX_SIMD_REAL_WIDTH dihs */
+    for (i = 0; (i < nbonds); i += GMX_SIMD_REAL_WIDTH * nfa1)
+    {
+        /* Collect atoms quadruplets for GMX_SIMD_REAL_WIDTH dihedrals.
+         * iu indexes into forceatoms, we should not let iu go beyond nbonds.
+         */
+        iu = i;
+        for (s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+        {
+            type  = forceatoms[iu];
+            ai[s] = forceatoms[iu + 1];
+            aj[s] = forceatoms[iu + 2];
+            ak[s] = forceatoms[iu + 3];
+            al[s] = forceatoms[iu + 4];
+
+            /* At the end fill the arrays with the last atoms and 0 params */
+            if (i + s * nfa1 < nbonds)
+            {
+                kr[s]   = forceparams[type].harmonic.krA;
+                phi0[s] = forceparams[type].harmonic.rA;
+
+                if (iu + nfa1 < nbonds)
+                {
+                    iu += nfa1;
+                }
+            }
+            else
+            {
+                kr[s]   = 0;
+                phi0[s] = 0;
+            }
+        }
+
+        /* Calculate GMX_SIMD_REAL_WIDTH dihedral angles at once */
+        dih_angle_simd(x, ai, aj, ak, al, pbc_simd, &phi_S, &mx_S, &my_S, &mz_S, &nx_S, &ny_S,
+                       &nz_S, &nrkj_m2_S, &nrkj_n2_S, &p_S, &q_S);
+
+        kr_S   = load<SimdReal>(kr);
+        phi0_S = load<SimdReal>(phi0) * deg2rad_S;
+
+        /* As make_dp_periodic(), put phi-phi0 in (-pi,pi) */
+        dp_S = phi_S - phi0_S;
+        dp_S = dp_S - selectByMask(twopi_S, pi_S <= dp_S);
+        dp_S = dp_S + selectByMask(twopi_S, dp_S < -pi_S);
+
+        /* The force factor passed to do_dih_fup() in idihs is kr*dp */
+        mddphi_S = -kr_S * dp_S;
+        sf_i_S   = mddphi_S * nrkj_m2_S;
+        msf_l_S  = mddphi_S * nrkj_n2_S;
+
+        /* After this m?_S will contain f[i] */
+        mx_S = sf_i_S * mx_S;
+        my_S = sf_i_S * my_S;
+        mz_S = sf_i_S * mz_S;
+
+        /* After this m?_S will contain -f[l] */
+        nx_S = msf_l_S * nx_S;
+        ny_S = msf_l_S * ny_S;
+        nz_S = msf_l_S * nz_S;
+
+        do_dih_fup_noshiftf_simd(ai, aj, ak, al, p_S, q_S, mx_S, my_S, mz_S, nx_S, ny_S, nz_S, f);
+    }
+
+    return 0;
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
 /*! \brief Computes angle restraints of two different types */
 template<BondedKernelFlavor flavor>
 real low_angres(int             nbonds,
@@ -73,7 +73,7 @@ class ArrayRef;
 class StepWorkload;
 
 /*! \brief The number on bonded function types supported on GPUs */
-static constexpr int numFTypesOnGpu = 8;
+static constexpr int numFTypesOnGpu = 12;
 
 /*! \brief List of all bonded function types supported on GPUs
  *
@@ -82,9 +82,10 @@ static constexpr int numFTypesOnGpu = 8;
  * \note The function types in the list are ordered on increasing value.
  * \note Currently bonded are only supported with CUDA, not with OpenCL.
  */
-constexpr std::array<int, numFTypesOnGpu> fTypesOnGpu = { F_BONDS,  F_ANGLES, F_UREY_BRADLEY,
-                                                          F_PDIHS,  F_RBDIHS, F_IDIHS,
-                                                          F_PIDIHS, F_LJ14 };
+constexpr std::array<int, numFTypesOnGpu> fTypesOnGpu = {
+    F_BONDS,     F_ANGLES,  F_RESTRANGLES, F_UREY_BRADLEY, F_PDIHS, F_RBDIHS,
+    F_RESTRDIHS, F_CBTDIHS, F_IDIHS,       F_PIDIHS,       F_CMAP,  F_LJ14
+};
 
 /*! \brief Checks whether the GROMACS build allows to compute bonded interactions on a GPU.
  *
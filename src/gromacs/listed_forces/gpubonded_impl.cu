@@ -48,6 +48,10 @@
 
 #include "gpubonded_impl.h"
 
+#include <algorithm>
+#include <array>
+#include <numeric>
+
 #include "gromacs/gpu_utils/cuda_arch_utils.cuh"
 #include "gromacs/gpu_utils/cudautils.cuh"
 #include "gromacs/gpu_utils/device_context.h"
@@ -57,6 +61,7 @@
 #include "gromacs/mdtypes/enerdata.h"
 #include "gromacs/timing/wallcycle.h"
 #include "gromacs/topology/forcefieldparameters.h"
+#include "gromacs/utility/fatalerror.h"
 
 struct t_forcerec;
 
@@ -65,6 +70,30 @@ namespace gmx
 // Number of CUDA threads in a block
 constexpr static int c_threadsPerBlock = 256;
 
+/*! \brief Returns a rough estimate of the relative GPU cost of one interaction of type \p fType
+ *
+ * Only used for ordering the work, so the estimates do not need to be accurate.
+ */
+static int relativeInteractionCost(int fType)
+{
+    switch (fType)
+    {
+        case F_BONDS: return 1;
+        case F_ANGLES:
+        case F_LJ14: return 2;
+        case F_UREY_BRADLEY:
+        case F_RESTRANGLES: return 3;
+        case F_PDIHS:
+        case F_PIDIHS:
+        case F_RBDIHS:
+        case F_IDIHS: return 4;
+        case F_RESTRDIHS:
+        case F_CBTDIHS: return 5;
+        case F_CMAP: return 12;
+        default: return 1;
+    }
+}
+
 // ---- GpuBonded::Impl
 
 GpuBonded::Impl::Impl(const gmx_ffparams_t& ffparams,
@@ -90,6 +119,20 @@ GpuBonded::Impl::Impl(const gmx_ffparams_t& ffparams,
     // to consume additional pinned pages.
     copyToDeviceBuffer(&d_forceParams_, ffparams.iparams.data(), 0, ffparams.numTypes(),
                        deviceStream_, GpuApiCallBehavior::Sync, nullptr);
+
+    const gmx_cmap_t& cmapGrid = ffparams.cmap_grid;
+    if (!cmapGrid.cmapdata.empty())
+    {
+        std::vector<float> cmapData;
+        for (const gmx_cmapdata_t& cmapType : cmapGrid.cmapdata)
+        {
+            cmapData.insert(cmapData.end(), cmapType.cmap.begin(), cmapType.cmap.end());
+        }
+        allocateDeviceBuffer(&d_cmapData_, cmapData.size(), deviceContext_);
+        copyToDeviceBuffer(&d_cmapData_, cmapData.data(), 0, cmapData.size(), deviceStream_,
+                           GpuApiCallBehavior::Sync, nullptr);
+    }
+
     vTot_.resize(F_NRE);
     allocateDeviceBuffer(&d_vTot_, F_NRE, deviceContext_);
     clearDeviceBufferAsync(&d_vTot_, 0, F_NRE, deviceStream_);
@@ -100,6 +143,8 @@ GpuBonded::Impl::Impl(const gmx_ffparams_t& ffparams,
     kernelParams_.d_f                       = d_f_;
     kernelParams_.d_fShift                  = d_fShift_;
     kernelParams_.d_vTot                    = d_vTot_;
+    kernelParams_.d_cmapData                = d_cmapData_;
+    kernelParams_.cmapGridSpacing           = cmapGrid.grid_spacing;
     for (int i = 0; i < numFTypesOnGpu; i++)
     {
         kernelParams_.d_iatoms[i]        = nullptr;
@@ -130,6 +175,7 @@ GpuBonded::Impl::~Impl()
 
     freeDeviceBuffer(&d_forceParams_);
     freeDeviceBuffer(&d_vTot_);
+    freeDeviceBuffer(&d_cmapData_);
 }
 
 //! Return whether function type \p fType in \p idef has perturbed interactions
@@ -187,9 +233,11 @@ static inline int roundUpToFactor(const int input, const int factor)
 
 /*! Divides bonded interactions over threads and GPU.
  *  The bonded interactions are assigned by interaction type to GPU threads. The intereaction
- *  types are assigned in blocks sized as <warp_size>. The beginning and end (thread index) of each
- *  interaction type are stored in kernelParams_. Pointers to the relevant data structures on the
- *  GPU are also stored in kernelParams_.
+ *  types are assigned in blocks sized as <warp_size>, so all threads in a warp compute the same
+ *  type. The types are ordered on decreasing estimated total cost, so the most expensive warps
+ *  are scheduled first and the cheap ones fill up the tail of the kernel. The beginning and end
+ *  (thread index) of each interaction type are stored in kernelParams_. Pointers to the relevant
+ *  data structures on the GPU are also stored in kernelParams_.
  *
  * \todo Use DeviceBuffer for the d_xqPtr.
  */
@@ -201,11 +249,12 @@ void GpuBonded::Impl::updateInteractionListsAndDeviceBuffers(ArrayRef<const int>
 {
     // TODO wallcycle sub start
     haveInteractions_ = false;
-    int fTypesCounter = 0;
 
-    for (int fType : fTypesOnGpu)
+    std::array<int, numFTypesOnGpu> numBondsPerFType;
+    for (int i = 0; i < numFTypesOnGpu; i++)
     {
-        auto& iList = iLists_[fType];
+        const int fType = fTypesOnGpu[i];
+        auto&     iList = iLists_[fType];
 
         /* Perturbation is not implemented in the GPU bonded kernels.
          * But instead of doing all interactions on the CPU, we can
@@ -236,11 +285,26 @@ void GpuBonded::Impl::updateInteractionListsAndDeviceBuffers(ArrayRef<const int>
             copyToDeviceBuffer(&d_iList.iatoms, iList.iatoms.data(), 0, iList.size(), deviceStream_,
                                GpuApiCallBehavior::Async, nullptr);
         }
+        numBondsPerFType[i] = iList.size() / (interaction_function[fType].nratoms + 1);
+    }
+
+    // Order the types on decreasing total cost, the kernel takes the type from kernelParams_
+    std::array<int, numFTypesOnGpu> fTypeOrder;
+    std::iota(fTypeOrder.begin(), fTypeOrder.end(), 0);
+    std::stable_sort(fTypeOrder.begin(), fTypeOrder.end(), [&numBondsPerFType](int a, int b) {
+        return numBondsPerFType[a] * relativeInteractionCost(fTypesOnGpu[a])
+               > numBondsPerFType[b] * relativeInteractionCost(fTypesOnGpu[b]);
+    });
+
+    for (int fTypesCounter = 0; fTypesCounter < numFTypesOnGpu; fTypesCounter++)
+    {
+        const int fType    = fTypesOnGpu[fTypeOrder[fTypesCounter]];
+        const int numBonds = numBondsPerFType[fTypeOrder[fTypesCounter]];
+
         kernelParams_.fTypesOnGpu[fTypesCounter]    = fType;
-        kernelParams_.numFTypeIAtoms[fTypesCounter] = iList.size();
-        int numBonds = iList.size() / (interaction_function[fType].nratoms + 1);
-        kernelParams_.numFTypeBonds[fTypesCounter] = numBonds;
-        kernelParams_.d_iatoms[fTypesCounter]      = d_iLists_[fType].iatoms;
+        kernelParams_.numFTypeIAtoms[fTypesCounter] = iLists_[fType].size();
+        kernelParams_.numFTypeBonds[fTypesCounter]  = numBonds;
+        kernelParams_.d_iatoms[fTypesCounter]       = d_iLists_[fType].iatoms;
         if (fTypesCounter == 0)
         {
             kernelParams_.fTypeRangeStart[fTypesCounter] = 0;
@@ -262,7 +326,13 @@ void GpuBonded::Impl::updateInteractionListsAndDeviceBuffers(ArrayRef<const int>
                            && (kernelParams_.fTypeRangeEnd[fTypesCounter] + 1) % warp_size == 0,
                    "The bonded interactions must be assigned to the GPU in blocks of warp size.");
 
-        fTypesCounter++;
+        if (debug && numBonds > 0)
+        {
+            fprintf(debug, "GPU bonded work: %-16s %7d interactions, threads %7d - %7d\n",
+                    interaction_function[fType].longname, numBonds,
+                    kernelParams_.fTypeRangeStart[fTypesCounter],
+                    kernelParams_.fTypeRangeEnd[fTypesCounter]);
+        }
     }
 
     int fTypeRangeEnd               = kernelParams_.fTypeRangeEnd[numFTypesOnGpu - 1];
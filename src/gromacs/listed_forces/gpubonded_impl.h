@@ -105,6 +105,10 @@ struct BondedCudaKernelParameters
     float* d_vTot;
     //! Interaction list atoms (on GPU)
     t_iatom* d_iatoms[numFTypesOnGpu];
+    //! CMAP grid data for all CMAP types, 4 values per grid point (on GPU)
+    const float* d_cmapData;
+    //! The number of CMAP grid points along each dimension
+    int cmapGridSpacing;
 
     BondedCudaKernelParameters()
     {
@@ -118,6 +122,8 @@ struct BondedCudaKernelParameters
         d_f                       = nullptr;
         d_fShift                  = nullptr;
         d_vTot                    = nullptr;
+        d_cmapData                = nullptr;
+        cmapGridSpacing           = 0;
     }
 };
 
@@ -193,6 +199,8 @@ private:
     HostVector<float> vTot_ = { {}, gmx::HostAllocationPolicy(gmx::PinningPolicy::PinnedIfSupported) };
     //! \brief Device-side total virial
     float* d_vTot_ = nullptr;
+    //! CMAP grid data on the device, null when there are no CMAP types
+    float* d_cmapData_ = nullptr;
 
     //! GPU context object
     const DeviceContext& deviceContext_;
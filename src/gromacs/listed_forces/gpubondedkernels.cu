@@ -73,6 +73,7 @@
 /*------------------------------------------------------------------------------*/
 
 #define CUDA_DEG2RAD_F (CUDART_PI_F / 180.0f)
+#define CUDA_RAD2DEG_F (180.0f / CUDART_PI_F)
 
 /*---------------- BONDED CUDA kernels--------------*/
 
@@ -655,6 +656,608 @@ __device__ void idihs_gpu(const int       i,
     }
 }
 
+template<bool calcVir, bool calcEner>
+__device__ void restrangles_gpu(const int       i,
+                                float*          vtot_loc,
+                                const int       numBonds,
+                                const t_iatom   d_forceatoms[],
+                                const t_iparams d_forceparams[],
+                                const float4    gm_xq[],
+                                float3          gm_f[],
+                                float3          sm_fShiftLoc[],
+                                const PbcAiuc   pbcAiuc)
+{
+    if (i < numBonds)
+    {
+        int4 angleData = *(int4*)(d_forceatoms + 4 * i);
+        int  type      = angleData.x;
+        int  ai        = angleData.y;
+        int  aj        = angleData.z;
+        int  ak        = angleData.w;
+
+        float3 r_ij;
+        float3 delta_post;
+        int    t1 = pbcDxAiuc<calcVir>(pbcAiuc, gm_xq[ai], gm_xq[aj], r_ij);
+        int    t2 = pbcDxAiuc<calcVir>(pbcAiuc, gm_xq[ak], gm_xq[aj], delta_post);
+        float3 delta_ante = -r_ij;
+
+        /* See compute_factors_restangles() in restcbt.cpp, which uses
+         * double precision here. */
+        float k_bending          = d_forceparams[type].harmonic.krA;
+        float cosine_theta_equil = -cosf(d_forceparams[type].harmonic.rA * CUDA_DEG2RAD_F);
+
+        float c_ante = norm2(delta_ante);
+        float c_cros = iprod(delta_ante, delta_post);
+        float c_post = norm2(delta_post);
+
+        float norm          = rsqrtf(c_ante * c_post);
+        float cosine_theta  = c_cros * norm;
+        float sine_theta_sq = 1.0f - cosine_theta * cosine_theta;
+
+        float ratio_ante = c_cros / c_ante;
+        float ratio_post = c_cros / c_post;
+
+        float delta_cosine           = cosine_theta - cosine_theta_equil;
+        float term_theta_theta_equil = 1.0f - cosine_theta * cosine_theta_equil;
+
+        float prefactor = -k_bending * delta_cosine * norm * term_theta_theta_equil
+                          / (sine_theta_sq * sine_theta_sq);
+
+        if (calcEner)
+        {
+            *vtot_loc += k_bending * 0.5f * delta_cosine * delta_cosine / sine_theta_sq;
+        }
+
+        float3 f_i = prefactor * (ratio_ante * delta_ante - delta_post);
+        float3 f_j = prefactor
+                     * ((ratio_post + 1.0f) * delta_post - (ratio_ante + 1.0f) * delta_ante);
+        float3 f_k = prefactor * (delta_ante - ratio_post * delta_post);
+
+        atomicAdd(&gm_f[ai], f_i);
+        atomicAdd(&gm_f[aj], f_j);
+        atomicAdd(&gm_f[ak], f_k);
+
+        if (calcVir)
+        {
+            atomicAdd(&sm_fShiftLoc[t1], f_i);
+            atomicAdd(&sm_fShiftLoc[CENTRAL], f_j);
+            atomicAdd(&sm_fShiftLoc[t2], f_k);
+        }
+    }
+}
+
+/*! \brief Scalar products of the three bond vectors of a restricted or CBT dihedral
+ *
+ * See compute_factors_restrdihs() and compute_factors_cbtdihs() in restcbt.cpp.
+ */
+struct RestCbtProducts
+{
+    // Squared lengths of the bond vectors
+    float c_self_ante, c_self_crnt, c_self_post;
+    // Scalar products between pairs of different bond vectors
+    float c_cros_ante, c_cros_acrs, c_cros_post;
+    // Differences of products of the above, as used in the dihedral cosine
+    float c_prod, d_ante, d_post;
+};
+
+__device__ __forceinline__ static RestCbtProducts
+restcbt_products_gpu(const float3 delta_ante, const float3 delta_crnt, const float3 delta_post)
+{
+    RestCbtProducts p;
+
+    p.c_self_ante = norm2(delta_ante);
+    p.c_self_crnt = norm2(delta_crnt);
+    p.c_self_post = norm2(delta_post);
+    p.c_cros_ante = iprod(delta_ante, delta_crnt);
+    p.c_cros_acrs = iprod(delta_ante, delta_post);
+    p.c_cros_post = iprod(delta_crnt, delta_post);
+    p.c_prod      = p.c_cros_ante * p.c_cros_post - p.c_self_crnt * p.c_cros_acrs;
+    p.d_ante      = p.c_self_ante * p.c_self_crnt - p.c_cros_ante * p.c_cros_ante;
+    p.d_post      = p.c_self_post * p.c_self_crnt - p.c_cros_post * p.c_cros_post;
+
+    /* Avoid round-off problems when three consecutive beads align */
+    p.d_ante = fmaxf(p.d_ante, GMX_REAL_EPS);
+    p.d_post = fmaxf(p.d_post, GMX_REAL_EPS);
+
+    return p;
+}
+
+/*! \brief Adds to \p f_i - \p f_l the forces from the derivatives of the dihedral angle
+ *
+ * \p prefactor_phi is the derivative of the potential with respect to cos(phi)
+ * multiplied by the norm of the dihedral cosine.
+ */
+__device__ __forceinline__ static void restcbt_phi_forces_gpu(const RestCbtProducts& p,
+                                                              const float            prefactor_phi,
+                                                              const float3           delta_ante,
+                                                              const float3           delta_crnt,
+                                                              const float3           delta_post,
+                                                              float3*                f_i,
+                                                              float3*                f_j,
+                                                              float3*                f_k,
+                                                              float3*                f_l)
+{
+    float ratio_phi_ante = p.c_prod / p.d_ante;
+    float ratio_phi_post = p.c_prod / p.d_post;
+
+    float factor_phi_ai_ante = ratio_phi_ante * p.c_self_crnt;
+    float factor_phi_ai_crnt = -p.c_cros_post - ratio_phi_ante * p.c_cros_ante;
+    float factor_phi_ai_post = p.c_self_crnt;
+    float factor_phi_aj_ante = -p.c_cros_post - ratio_phi_ante * (p.c_self_crnt + p.c_cros_ante);
+    float factor_phi_aj_crnt = p.c_cros_post + p.c_cros_acrs * 2.0f
+                               + ratio_phi_ante * (p.c_self_ante + p.c_cros_ante)
+                               + ratio_phi_post * p.c_self_post;
+    float factor_phi_aj_post = -(p.c_cros_ante + p.c_self_crnt) - ratio_phi_post * p.c_cros_post;
+    float factor_phi_ak_ante = p.c_cros_post + p.c_self_crnt + ratio_phi_ante * p.c_cros_ante;
+    float factor_phi_ak_crnt = -(p.c_cros_ante + p.c_cros_acrs * 2.0f)
+                               - ratio_phi_ante * p.c_self_ante
+                               - ratio_phi_post * (p.c_self_post + p.c_cros_post);
+    float factor_phi_ak_post = p.c_cros_ante + ratio_phi_post * (p.c_self_crnt + p.c_cros_post);
+    float factor_phi_al_ante = -p.c_self_crnt;
+    float factor_phi_al_crnt = p.c_cros_ante + ratio_phi_post * p.c_cros_post;
+    float factor_phi_al_post = -ratio_phi_post * p.c_self_crnt;
+
+    *f_i += prefactor_phi
+            * (factor_phi_ai_ante * delta_ante + factor_phi_ai_crnt * delta_crnt
+               + factor_phi_ai_post * delta_post);
+    *f_j += prefactor_phi
+            * (factor_phi_aj_ante * delta_ante + factor_phi_aj_crnt * delta_crnt
+               + factor_phi_aj_post * delta_post);
+    *f_k += prefactor_phi
+            * (factor_phi_ak_ante * delta_ante + factor_phi_ak_crnt * delta_crnt
+               + factor_phi_ak_post * delta_post);
+    *f_l += prefactor_phi
+            * (factor_phi_al_ante * delta_ante + factor_phi_al_crnt * delta_crnt
+               + factor_phi_al_post * delta_post);
+}
+
+/*! \brief Computes the bond vectors used by the restricted and CBT dihedrals
+ *
+ * Uses the same conventions as restrdihs() and cbtdihs() in bonded.cpp.
+ */
+template<bool returnShift>
+__device__ __forceinline__ static void restcbt_dih_vectors_gpu(const float4   xi,
+                                                               const float4   xj,
+                                                               const float4   xk,
+                                                               const float4   xl,
+                                                               const PbcAiuc& pbcAiuc,
+                                                               float3*        delta_ante,
+                                                               float3*        delta_crnt,
+                                                               float3*        delta_post,
+                                                               int*           t1,
+                                                               int*           t2)
+{
+    float3 r_ij;
+    float3 r_kl;
+    *t1 = pbcDxAiuc<returnShift>(pbcAiuc, xi, xj, r_ij);
+    *t2 = pbcDxAiuc<returnShift>(pbcAiuc, xk, xj, *delta_crnt);
+    pbcDxAiuc<false>(pbcAiuc, xk, xl, r_kl);
+    *delta_ante = -r_ij;
+    *delta_post = -r_kl;
+}
+
+/*! \brief Adds the forces of a four-atom restricted or CBT dihedral */
+template<bool calcVir>
+__device__ __forceinline__ static void restcbt_dih_fup_gpu(const int      ai,
+                                                           const int      aj,
+                                                           const int      ak,
+                                                           const int      al,
+                                                           const float3   f_i,
+                                                           const float3   f_j,
+                                                           const float3   f_k,
+                                                           const float3   f_l,
+                                                           const int      t1,
+                                                           const int      t2,
+                                                           const float4   gm_xq[],
+                                                           float3         gm_f[],
+                                                           float3         sm_fShiftLoc[],
+                                                           const PbcAiuc& pbcAiuc)
+{
+    atomicAdd(&gm_f[ai], f_i);
+    atomicAdd(&gm_f[aj], f_j);
+    atomicAdd(&gm_f[ak], f_k);
+    atomicAdd(&gm_f[al], f_l);
+
+    if (calcVir)
+    {
+        float3 dx_jl;
+        int    t3 = pbcDxAiuc<calcVir>(pbcAiuc, gm_xq[al], gm_xq[aj], dx_jl);
+
+        atomicAdd(&sm_fShiftLoc[t1], f_i);
+        atomicAdd(&sm_fShiftLoc[CENTRAL], f_j);
+        atomicAdd(&sm_fShiftLoc[t2], f_k);
+        atomicAdd(&sm_fShiftLoc[t3], f_l);
+    }
+}
+
+template<bool calcVir, bool calcEner>
+__device__ void restrdihs_gpu(const int       i,
+                              float*          vtot_loc,
+                              const int       numBonds,
+                              const t_iatom   d_forceatoms[],
+                              const t_iparams d_forceparams[],
+                              const float4    gm_xq[],
+                              float3          gm_f[],
+                              float3          sm_fShiftLoc[],
+                              const PbcAiuc   pbcAiuc)
+{
+    if (i < numBonds)
+    {
+        int type = d_forceatoms[5 * i];
+        int ai   = d_forceatoms[5 * i + 1];
+        int aj   = d_forceatoms[5 * i + 2];
+        int ak   = d_forceatoms[5 * i + 3];
+        int al   = d_forceatoms[5 * i + 4];
+
+        float3 delta_ante;
+        float3 delta_crnt;
+        float3 delta_post;
+        int    t1;
+        int    t2;
+        restcbt_dih_vectors_gpu<calcVir>(gm_xq[ai], gm_xq[aj], gm_xq[ak], gm_xq[al], pbcAiuc,
+                                         &delta_ante, &delta_crnt, &delta_post, &t1, &t2);
+
+        float cosine_phi0 = cosf(d_forceparams[type].pdihs.phiA * CUDA_DEG2RAD_F);
+        float k_torsion   = d_forceparams[type].pdihs.cpA;
+
+        RestCbtProducts p = restcbt_products_gpu(delta_ante, delta_crnt, delta_post);
+
+        float norm_phi    = rsqrtf(p.d_ante * p.d_post);
+        float cosine_phi  = p.c_prod * norm_phi;
+        float sine_phi_sq = fmaxf(1.0f - cosine_phi * cosine_phi, 0.0f);
+
+        float delta_cosine  = cosine_phi - cosine_phi0;
+        float term_phi_phi0 = 1.0f - cosine_phi * cosine_phi0;
+
+        float prefactor_phi = -k_torsion * delta_cosine * norm_phi * term_phi_phi0
+                              / (sine_phi_sq * sine_phi_sq);
+
+        if (calcEner)
+        {
+            *vtot_loc += k_torsion * 0.5f * delta_cosine * delta_cosine / sine_phi_sq;
+        }
+
+        float3 f_i = make_float3(0.0f, 0.0f, 0.0f);
+        float3 f_j = make_float3(0.0f, 0.0f, 0.0f);
+        float3 f_k = make_float3(0.0f, 0.0f, 0.0f);
+        float3 f_l = make_float3(0.0f, 0.0f, 0.0f);
+        restcbt_phi_forces_gpu(p, prefactor_phi, delta_ante, delta_crnt, delta_post, &f_i, &f_j,
+                               &f_k, &f_l);
+
+        restcbt_dih_fup_gpu<calcVir>(ai, aj, ak, al, f_i, f_j, f_k, f_l, t1, t2, gm_xq, gm_f,
+                                     sm_fShiftLoc, pbcAiuc);
+    }
+}
+
+template<bool calcVir, bool calcEner>
+__device__ void cbtdihs_gpu(const int       i,
+                            float*          vtot_loc,
+                            const int       numBonds,
+                            const t_iatom   d_forceatoms[],
+                            const t_iparams d_forceparams[],
+                            const float4    gm_xq[],
+                            float3          gm_f[],
+                            float3          sm_fShiftLoc[],
+                            const PbcAiuc   pbcAiuc)
+{
+    if (i < numBonds)
+    {
+        int type = d_forceatoms[5 * i];
+        int ai   = d_forceatoms[5 * i + 1];
+        int aj   = d_forceatoms[5 * i + 2];
+        int ak   = d_forceatoms[5 * i + 3];
+        int al   = d_forceatoms[5 * i + 4];
+
+        float3 delta_ante;
+        float3 delta_crnt;
+        float3 delta_post;
+        int    t1;
+        int    t2;
+        restcbt_dih_vectors_gpu<calcVir>(gm_xq[ai], gm_xq[aj], gm_xq[ak], gm_xq[al], pbcAiuc,
+                                         &delta_ante, &delta_crnt, &delta_post, &t1, &t2);
+
+        float torsion_coef[NR_CBTDIHS];
+        for (int j = 0; j < NR_CBTDIHS; j++)
+        {
+            torsion_coef[j] = d_forceparams[type].cbtdihs.cbtcA[j];
+        }
+
+        RestCbtProducts p = restcbt_products_gpu(delta_ante, delta_crnt, delta_post);
+
+        float norm_phi        = rsqrtf(p.d_ante * p.d_post);
+        float norm_theta_ante = rsqrtf(p.c_self_ante * p.c_self_crnt);
+        float norm_theta_post = rsqrtf(p.c_self_crnt * p.c_self_post);
+
+        float cosine_phi        = p.c_prod * norm_phi;
+        float cosine_theta_ante = p.c_cros_ante * norm_theta_ante;
+        float cosine_theta_post = p.c_cros_post * norm_theta_post;
+
+        float sine_theta_ante_sq = fmaxf(1.0f - cosine_theta_ante * cosine_theta_ante, 0.0f);
+        float sine_theta_post_sq = fmaxf(1.0f - cosine_theta_post * cosine_theta_post, 0.0f);
+        float sine_theta_ante    = sqrtf(sine_theta_ante_sq);
+        float sine_theta_post    = sqrtf(sine_theta_post_sq);
+
+        float sine_theta_ante_cu = sine_theta_ante_sq * sine_theta_ante;
+        float sine_theta_post_cu = sine_theta_post_sq * sine_theta_post;
+
+        /* The polynomial in cos(phi) and its derivative */
+        float c   = cosine_phi;
+        float pol = torsion_coef[1]
+                    + c * (torsion_coef[2]
+                           + c * (torsion_coef[3] + c * (torsion_coef[4] + c * torsion_coef[5])));
+        float dpol = torsion_coef[2]
+                     + c * (2.0f * torsion_coef[3]
+                            + c * (3.0f * torsion_coef[4] + 4.0f * c * torsion_coef[5]));
+
+        float3 f_i = make_float3(0.0f, 0.0f, 0.0f);
+        float3 f_j = make_float3(0.0f, 0.0f, 0.0f);
+        float3 f_k = make_float3(0.0f, 0.0f, 0.0f);
+        float3 f_l = make_float3(0.0f, 0.0f, 0.0f);
+
+        /* Forces due to the derivatives of the dihedral angle phi */
+        float prefactor_phi =
+                -torsion_coef[0] * norm_phi * dpol * sine_theta_ante_cu * sine_theta_post_cu;
+        restcbt_phi_forces_gpu(p, prefactor_phi, delta_ante, delta_crnt, delta_post, &f_i, &f_j,
+                               &f_k, &f_l);
+
+        /* Forces due to the derivatives of the bending angle theta_ante */
+        float ratio_theta_ante_ante = p.c_cros_ante / p.c_self_ante;
+        float ratio_theta_ante_crnt = p.c_cros_ante / p.c_self_crnt;
+        float prefactor_theta_ante  = -torsion_coef[0] * norm_theta_ante * pol * (-3.0f)
+                                     * cosine_theta_ante * sine_theta_ante * sine_theta_post_cu;
+
+        f_i += prefactor_theta_ante * (ratio_theta_ante_ante * delta_ante - delta_crnt);
+        f_j += prefactor_theta_ante
+               * ((ratio_theta_ante_crnt + 1.0f) * delta_crnt
+                  - (ratio_theta_ante_ante + 1.0f) * delta_ante);
+        f_k += prefactor_theta_ante * (delta_ante - ratio_theta_ante_crnt * delta_crnt);
+
+        /* Forces due to the derivatives of the bending angle theta_post */
+        float ratio_theta_post_crnt = p.c_cros_post / p.c_self_crnt;
+        float ratio_theta_post_post = p.c_cros_post / p.c_self_post;
+        float prefactor_theta_post  = -torsion_coef[0] * norm_theta_post * pol * (-3.0f)
+                                     * cosine_theta_post * sine_theta_post * sine_theta_ante_cu;
+
+        f_j += prefactor_theta_post * (ratio_theta_post_crnt * delta_crnt - delta_post);
+        f_k += prefactor_theta_post
+               * ((ratio_theta_post_post + 1.0f) * delta_post
+                  - (ratio_theta_post_crnt + 1.0f) * delta_crnt);
+        f_l += prefactor_theta_post * (delta_crnt - ratio_theta_post_post * delta_post);
+
+        if (calcEner)
+        {
+            *vtot_loc += torsion_coef[0] * pol * sine_theta_ante_cu * sine_theta_post_cu;
+        }
+
+        restcbt_dih_fup_gpu<calcVir>(ai, aj, ak, al, f_i, f_j, f_k, f_l, t1, t2, gm_xq, gm_f,
+                                     sm_fShiftLoc, pbcAiuc);
+    }
+}
+
+/*! \brief The CMAP bicubic interpolation coefficient matrix, see cmap_coeff_matrix in bonded.cpp */
+__constant__ static const int c_cmapCoeffMatrix[] = {
+    1,  0,  -3, 2,  0,  0, 0,  0,  -3, 0,  9,  -6, 2, 0,  -6, 4,  0,  0,  0, 0,  0, 0, 0,  0,
+    3,  0,  -9, 6,  -2, 0, 6,  -4, 0,  0,  0,  0,  0, 0,  0,  0,  0,  0,  9, -6, 0, 0, -6, 4,
+    0,  0,  3,  -2, 0,  0, 0,  0,  0,  0,  -9, 6,  0, 0,  6,  -4, 0,  0,  0, 0,  1, 0, -3, 2,
+    -2, 0,  6,  -4, 1,  0, -3, 2,  0,  0,  0,  0,  0, 0,  0,  0,  -1, 0,  3, -2, 1, 0, -3, 2,
+    0,  0,  0,  0,  0,  0, 0,  0,  0,  0,  -3, 2,  0, 0,  3,  -2, 0,  0,  0, 0,  0, 0, 3,  -2,
+    0,  0,  -6, 4,  0,  0, 3,  -2, 0,  1,  -2, 1,  0, 0,  0,  0,  0,  -3, 6, -3, 0, 2, -4, 2,
+    0,  0,  0,  0,  0,  0, 0,  0,  0,  3,  -6, 3,  0, -2, 4,  -2, 0,  0,  0, 0,  0, 0, 0,  0,
+    0,  0,  -3, 3,  0,  0, 2,  -2, 0,  0,  -1, 1,  0, 0,  0,  0,  0,  0,  3, -3, 0, 0, -2, 2,
+    0,  0,  0,  0,  0,  1, -2, 1,  0,  -2, 4,  -2, 0, 1,  -2, 1,  0,  0,  0, 0,  0, 0, 0,  0,
+    0,  -1, 2,  -1, 0,  1, -2, 1,  0,  0,  0,  0,  0, 0,  0,  0,  0,  0,  1, -1, 0, 0, -1, 1,
+    0,  0,  0,  0,  0,  0, -1, 1,  0,  0,  2,  -2, 0, 0,  -1, 1
+};
+
+/*! \brief Returns the grid index of \p ip wrapped into the grid, sets the next index in \p ip1 */
+__device__ __forceinline__ static int
+cmap_setup_grid_index_gpu(int ip, const int gridSpacing, int* ip1)
+{
+    if (ip < 0)
+    {
+        ip = ip + gridSpacing - 1;
+    }
+    else if (ip > gridSpacing)
+    {
+        ip = ip - gridSpacing - 1;
+    }
+
+    *ip1 = (ip == gridSpacing - 1) ? 0 : ip + 1;
+
+    return ip;
+}
+
+/*! \brief Returns the dihedral in the range [0, 2 pi) from the CMAP grid origin */
+__device__ __forceinline__ static float cmap_grid_angle_gpu(const float phi)
+{
+    float xphi = phi + CUDART_PI_F;
+    if (xphi < 0.0f)
+    {
+        xphi += 2.0f * CUDART_PI_F;
+    }
+    else if (xphi >= 2.0f * CUDART_PI_F)
+    {
+        xphi -= 2.0f * CUDART_PI_F;
+    }
+    return xphi;
+}
+
+/*! \brief Adds the CMAP forces for one of the two torsions, \p df is dV/dphi */
+template<bool calcVir>
+__device__ __forceinline__ static void cmap_torsion_fup_gpu(const int      ai,
+                                                            const int      aj,
+                                                            const int      ak,
+                                                            const int      al,
+                                                            const float    df,
+                                                            const float3   r_ij,
+                                                            const float3   r_kj,
+                                                            const float3   r_kl,
+                                                            const float3   m,
+                                                            const float3   n,
+                                                            const int      t1,
+                                                            const int      t2,
+                                                            const float4   gm_xq[],
+                                                            float3         gm_f[],
+                                                            float3         sm_fShiftLoc[],
+                                                            const PbcAiuc& pbcAiuc)
+{
+    /* With a = r_ij x r_kj = m and b = r_kl x r_kj = -n as in cmap_dihs() */
+    float ra2r = 1.0f / norm2(m);
+    float rb2r = 1.0f / norm2(n);
+    float rg   = norm(r_kj);
+    float rgr  = 1.0f / rg;
+
+    float fga = iprod(r_ij, r_kj) * ra2r * rgr;
+    float hgb = iprod(r_kl, r_kj) * rb2r * rgr;
+    float gaa = -ra2r * rg;
+    float gbb = -rb2r * rg;
+
+    float3 f = (df * gaa) * m;
+    float3 g = df * (fga * m + hgb * n);
+    float3 h = (df * gbb) * n;
+
+    float3 f_i = f;
+    float3 f_j = -f - g;
+    float3 f_k = h + g;
+    float3 f_l = -h;
+
+    atomicAdd(&gm_f[ai], f_i);
+    atomicAdd(&gm_f[aj], f_j);
+    atomicAdd(&gm_f[ak], f_k);
+    atomicAdd(&gm_f[al], f_l);
+
+    if (calcVir)
+    {
+        float3 dx_jl;
+        int    t3 = pbcDxAiuc<calcVir>(pbcAiuc, gm_xq[al], gm_xq[aj], dx_jl);
+
+        atomicAdd(&sm_fShiftLoc[t1], f_i);
+        atomicAdd(&sm_fShiftLoc[CENTRAL], f_j);
+        atomicAdd(&sm_fShiftLoc[t2], f_k);
+        atomicAdd(&sm_fShiftLoc[t3], f_l);
+    }
+}
+
+template<bool calcVir, bool calcEner>
+__device__ void cmap_dihs_gpu(const int       i,
+                              float*          vtot_loc,
+                              const int       numBonds,
+                              const t_iatom   d_forceatoms[],
+                              const t_iparams d_forceparams[],
+                              const float     gm_cmapData[],
+                              const int       cmapGridSpacing,
+                              const float4    gm_xq[],
+                              float3          gm_f[],
+                              float3          sm_fShiftLoc[],
+                              const PbcAiuc   pbcAiuc)
+{
+    if (i < numBonds)
+    {
+        /* Five atoms are involved in the two torsions */
+        int type = d_forceatoms[6 * i];
+        int ai   = d_forceatoms[6 * i + 1];
+        int aj   = d_forceatoms[6 * i + 2];
+        int ak   = d_forceatoms[6 * i + 3];
+        int al   = d_forceatoms[6 * i + 4];
+        int am   = d_forceatoms[6 * i + 5];
+
+        const int    cmapA = d_forceparams[type].cmap.cmapA;
+        const float* cmapd = gm_cmapData + 4 * cmapGridSpacing * cmapGridSpacing * cmapA;
+
+        /* First torsion */
+        float3 r1_ij;
+        float3 r1_kj;
+        float3 r1_kl;
+        float3 m1;
+        float3 n1;
+        int    t11;
+        int    t21;
+        int    t31;
+        float  phi1 = dih_angle_gpu<calcVir>(gm_xq[ai], gm_xq[aj], gm_xq[ak], gm_xq[al], pbcAiuc,
+                                            &r1_ij, &r1_kj, &r1_kl, &m1, &n1, &t11, &t21, &t31);
+
+        /* Second torsion */
+        float3 r2_ij;
+        float3 r2_kj;
+        float3 r2_kl;
+        float3 m2;
+        float3 n2;
+        int    t12;
+        int    t22;
+        int    t32;
+        float  phi2 = dih_angle_gpu<calcVir>(gm_xq[aj], gm_xq[ak], gm_xq[al], gm_xq[am], pbcAiuc,
+                                            &r2_ij, &r2_kj, &r2_kl, &m2, &n2, &t12, &t22, &t32);
+
+        float xphi1 = cmap_grid_angle_gpu(phi1);
+        float xphi2 = cmap_grid_angle_gpu(phi2);
+
+        /* Where on the grid are we */
+        float dx = 2.0f * CUDART_PI_F / cmapGridSpacing;
+        int   ip1p1;
+        int   ip2p1;
+        int   iphi1 = static_cast<int>(xphi1 / dx);
+        int   iphi2 = static_cast<int>(xphi2 / dx);
+        iphi1       = cmap_setup_grid_index_gpu(iphi1, cmapGridSpacing, &ip1p1);
+        iphi2       = cmap_setup_grid_index_gpu(iphi2, cmapGridSpacing, &ip2p1);
+
+        const int pos[4] = { iphi1 * cmapGridSpacing + iphi2, ip1p1 * cmapGridSpacing + iphi2,
+                             ip1p1 * cmapGridSpacing + ip2p1, iphi1 * cmapGridSpacing + ip2p1 };
+
+        /* Switch to degrees */
+        dx    = 360.0f / cmapGridSpacing;
+        xphi1 = xphi1 * CUDA_RAD2DEG_F;
+        xphi2 = xphi2 * CUDA_RAD2DEG_F;
+
+        float tx[16];
+        for (int k = 0; k < 4; k++)
+        {
+            tx[k]      = cmapd[pos[k] * 4];
+            tx[k + 4]  = cmapd[pos[k] * 4 + 1] * dx;
+            tx[k + 8]  = cmapd[pos[k] * 4 + 2] * dx;
+            tx[k + 12] = cmapd[pos[k] * 4 + 3] * dx * dx;
+        }
+
+        float tc[16];
+        for (int idx = 0; idx < 16; idx++)
+        {
+            tc[idx] = 0.0f;
+            for (int k = 0; k < 16; k++)
+            {
+                tc[idx] += c_cmapCoeffMatrix[k * 16 + idx] * tx[k];
+            }
+        }
+
+        float tt = (xphi1 - iphi1 * dx) / dx;
+        float tu = (xphi2 - iphi2 * dx) / dx;
+
+        float e   = 0.0f;
+        float df1 = 0.0f;
+        float df2 = 0.0f;
+        for (int k = 3; k >= 0; k--)
+        {
+            const float* tck = tc + k * 4;
+
+            e   = tt * e + ((tck[3] * tu + tck[2]) * tu + tck[1]) * tu + tck[0];
+            df1 = tu * df1 + (3.0f * tc[k + 12] * tt + 2.0f * tc[k + 8]) * tt + tc[k + 4];
+            df2 = tt * df2 + (3.0f * tck[3] * tu + 2.0f * tck[2]) * tu + tck[1];
+        }
+
+        float fac = CUDA_RAD2DEG_F / dx;
+        df1       = df1 * fac;
+        df2       = df2 * fac;
+
+        if (calcEner)
+        {
+            *vtot_loc += e;
+        }
+
+        cmap_torsion_fup_gpu<calcVir>(ai, aj, ak, al, df1, r1_ij, r1_kj, r1_kl, m1, n1, t11, t21,
+                                      gm_xq, gm_f, sm_fShiftLoc, pbcAiuc);
+        cmap_torsion_fup_gpu<calcVir>(aj, ak, al, am, df2, r2_ij, r2_kj, r2_kl, m2, n2, t12, t22,
+                                      gm_xq, gm_f, sm_fShiftLoc, pbcAiuc);
+    }
+}
+
 template<bool calcVir, bool calcEner>
 __device__ void pairs_gpu(const int       i,
                           const int       numBonds,
@@ -786,6 +1389,27 @@ __global__ void exec_kernel_gpu(BondedCudaKernelParameters kernelParams)
                                                  kernelParams.d_forceParams, kernelParams.d_xq,
                                                  kernelParams.d_f, sm_fShiftLoc, kernelParams.pbcAiuc);
                     break;
+                case F_RESTRANGLES:
+                    restrangles_gpu<calcVir, calcEner>(
+                            fTypeTid, &vtot_loc, numBonds, iatoms, kernelParams.d_forceParams,
+                            kernelParams.d_xq, kernelParams.d_f, sm_fShiftLoc, kernelParams.pbcAiuc);
+                    break;
+                case F_RESTRDIHS:
+                    restrdihs_gpu<calcVir, calcEner>(
+                            fTypeTid, &vtot_loc, numBonds, iatoms, kernelParams.d_forceParams,
+                            kernelParams.d_xq, kernelParams.d_f, sm_fShiftLoc, kernelParams.pbcAiuc);
+                    break;
+                case F_CBTDIHS:
+                    cbtdihs_gpu<calcVir, calcEner>(
+                            fTypeTid, &vtot_loc, numBonds, iatoms, kernelParams.d_forceParams,
+                            kernelParams.d_xq, kernelParams.d_f, sm_fShiftLoc, kernelParams.pbcAiuc);
+                    break;
+                case F_CMAP:
+                    cmap_dihs_gpu<calcVir, calcEner>(
+                            fTypeTid, &vtot_loc, numBonds, iatoms, kernelParams.d_forceParams,
+                            kernelParams.d_cmapData, kernelParams.cmapGridSpacing,
+                            kernelParams.d_xq, kernelParams.d_f, sm_fShiftLoc, kernelParams.pbcAiuc);
+                    break;
                 case F_LJ14:
                     pairs_gpu<calcVir, calcEner>(
                             fTypeTid, numBonds, iatoms, kernelParams.d_forceParams,
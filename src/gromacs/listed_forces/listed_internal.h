@@ -99,9 +99,14 @@ struct f_thread_t
 
     ~f_thread_t() = default;
 
-    //! Force array pointer, equals fBuffer.data(), needed because rvec4 is not a C++ type
+    /*! \brief Force array pointer, to be indexed with local atom indices
+     *
+     * Points reduction_block_size times the first touched block before
+     * fBuffer.data(), needed because rvec4 is not a C++ type.
+     * Only the blocks listed in block_index may be accessed.
+     */
     rvec4* f = nullptr;
-    //! Force array buffer
+    //! Force array buffer, covers the blocks from the first to the last touched block
     std::vector<real, gmx::AlignedAllocator<real>> fBuffer;
     //! Mask for marking which parts of f are filled, working array for constructing mask in bonded_threading_t
     std::vector<gmx_bitmask_t> mask;
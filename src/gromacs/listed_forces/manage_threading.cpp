@@ -351,9 +351,6 @@ static void calc_bonded_reduction_mask(int                           natoms,
 
     f_thread->mask.resize(nblock);
     f_thread->block_index.resize(nblock);
-    // NOTE: It seems f_thread->f does not need to be aligned
-    f_thread->fBuffer.resize(nblock * reduction_block_size * sizeof(rvec4) / sizeof(real));
-    f_thread->f = reinterpret_cast<rvec4*>(f_thread->fBuffer.data());
 
     for (gmx_bitmask_t& mask : f_thread->mask)
     {
@@ -396,6 +393,24 @@ static void calc_bonded_reduction_mask(int                           natoms,
             f_thread->block_index[f_thread->nblock_used++] = b;
         }
     }
+
+    /* With the locality based division of the bondeds, each thread only
+     * touches a range of atoms of about natoms/nthreads plus some overlap
+     * with its neighbors. So we only allocate the force buffer for
+     * the range of blocks from the first to the last touched block,
+     * which avoids memory usage growing with natoms*nthreads.
+     */
+    int firstBlock = 0;
+    int numBlocks  = 0;
+    if (f_thread->nblock_used > 0)
+    {
+        firstBlock = f_thread->block_index[0];
+        numBlocks  = f_thread->block_index[f_thread->nblock_used - 1] + 1 - firstBlock;
+    }
+    // NOTE: It seems f_thread->f does not need to be aligned
+    f_thread->fBuffer.resize(numBlocks * reduction_block_size * sizeof(rvec4) / sizeof(real));
+    f_thread->f = reinterpret_cast<rvec4*>(f_thread->fBuffer.data())
+                  - firstBlock * reduction_block_size;
 }
 
 void setup_bonded_threading(bonded_threading_t*           bt,
@@ -49,6 +49,7 @@
 #include "gromacs/math/multidimarray.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxomp.h"
 
 namespace gmx
 {
@@ -71,6 +72,88 @@ DensitySimilarityMeasureImpl::~DensitySimilarityMeasureImpl() = default;
 namespace
 {
 
+/****************** Thread-parallel evaluation over voxels ********************/
+
+/*! \brief The number of voxels per block for threaded evaluation
+ *
+ * Partial results are computed per block and combined in block order,
+ * so that reductions do not depend on the number of threads.
+ */
+constexpr index c_numVoxelsPerBlock = 32768;
+
+//! Returns the number of voxels in a density
+index numVoxels(DensitySimilarityMeasure::density density)
+{
+    return density.mapping().required_span_size();
+}
+
+/*! \brief Reduce a quantity over all voxels using OpenMP threads.
+ *
+ * \tparam Result         The type of the reduced quantity
+ * \param[in] numVoxels    The number of voxels to reduce over
+ * \param[in] evaluate     Returns the result for the voxel range given by begin and end index
+ * \param[in] combine      Combines the results of two consecutive voxel ranges
+ * \returns the reduced result, identical to evaluate(0, numVoxels) for a single block
+ */
+template<typename Result, typename Evaluate, typename Combine>
+Result reduceOverVoxels(index numVoxels, Evaluate evaluate, Combine combine)
+{
+    const index numBlocks =
+            std::max<index>(1, (numVoxels + c_numVoxelsPerBlock - 1) / c_numVoxelsPerBlock);
+    std::vector<Result> blockResults(numBlocks);
+
+    const int numThreads = std::min<index>(gmx_omp_get_max_threads(), numBlocks);
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+    for (index block = 0; block < numBlocks; block++)
+    {
+        try
+        {
+            blockResults[block] = evaluate(block * c_numVoxelsPerBlock,
+                                           std::min(numVoxels, (block + 1) * c_numVoxelsPerBlock));
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    Result result = blockResults[0];
+    for (index block = 1; block < numBlocks; block++)
+    {
+        result = combine(result, blockResults[block]);
+    }
+    return result;
+}
+
+/*! \brief Apply a function of the reference and compared voxel values to all voxels,
+ * using OpenMP threads.
+ *
+ * \param[in]  reference  The reference density
+ * \param[in]  compared   The compared density
+ * \param[out] result     The result density
+ * \param[in]  function   The function to evaluate for each pair of voxel values
+ */
+template<typename Function>
+void transformVoxels(DensitySimilarityMeasure::density                    reference,
+                     DensitySimilarityMeasure::density                    compared,
+                     MultiDimArray<std::vector<float>, dynamicExtents3D>* result,
+                     Function                                             function)
+{
+    const index numVoxelsTotal = numVoxels(reference);
+    const index numBlocks      = (numVoxelsTotal + c_numVoxelsPerBlock - 1) / c_numVoxelsPerBlock;
+
+    const int numThreads = std::min<index>(gmx_omp_get_max_threads(), numBlocks);
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+    for (index block = 0; block < numBlocks; block++)
+    {
+        try
+        {
+            const index voxelBegin = block * c_numVoxelsPerBlock;
+            const index voxelEnd   = std::min(numVoxelsTotal, (block + 1) * c_numVoxelsPerBlock);
+            std::transform(reference.data() + voxelBegin, reference.data() + voxelEnd,
+                           compared.data() + voxelBegin, begin(*result) + voxelBegin, function);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
 /****************** Inner Product *********************************************/
 
 /*! \internal
@@ -116,7 +199,15 @@ real DensitySimilarityInnerProduct::similarity(density comparedDensity)
     }
     /* the similarity measure uses the gradient instead of the reference,
      * here, because it is the reference density divided by the number of voxels */
-    return std::inner_product(begin(gradient_), end(gradient_), begin(comparedDensity), 0.);
+    const float* gradient = gradient_.asConstView().data();
+    const float* compared = comparedDensity.data();
+    return reduceOverVoxels<double>(
+            numVoxels(comparedDensity),
+            [gradient, compared](index voxelBegin, index voxelEnd) {
+                return std::inner_product(gradient + voxelBegin, gradient + voxelEnd,
+                                          compared + voxelBegin, 0.);
+            },
+            std::plus<>());
 }
 
 DensitySimilarityMeasure::density DensitySimilarityInnerProduct::gradient(density comparedDensity)
@@ -194,8 +285,16 @@ real DensitySimilarityRelativeEntropy::similarity(density comparedDensity)
     {
         GMX_THROW(RangeError("Reference density and compared density need to have same extents."));
     }
-    return std::inner_product(begin(referenceDensity_), end(referenceDensity_),
-                              begin(comparedDensity), 0., std::plus<>(), relativeEntropyAtVoxel);
+    const float* reference = referenceDensity_.data();
+    const float* compared  = comparedDensity.data();
+    return reduceOverVoxels<double>(
+            numVoxels(comparedDensity),
+            [reference, compared](index voxelBegin, index voxelEnd) {
+                return std::inner_product(reference + voxelBegin, reference + voxelEnd,
+                                          compared + voxelBegin, 0., std::plus<>(),
+                                          relativeEntropyAtVoxel);
+            },
+            std::plus<>());
 }
 
 DensitySimilarityMeasure::density DensitySimilarityRelativeEntropy::gradient(density comparedDensity)
@@ -204,8 +303,7 @@ DensitySimilarityMeasure::density DensitySimilarityRelativeEntropy::gradient(den
     {
         GMX_THROW(RangeError("Reference density and compared density need to have same extents."));
     }
-    std::transform(begin(referenceDensity_), end(referenceDensity_), begin(comparedDensity),
-                   begin(gradient_), relativeEntropyGradientAtVoxel);
+    transformVoxels(referenceDensity_, comparedDensity, &gradient_, relativeEntropyGradientAtVoxel);
     return gradient_.asConstView();
 }
 
@@ -219,6 +317,8 @@ std::unique_ptr<DensitySimilarityMeasureImpl> DensitySimilarityRelativeEntropy::
 //! Helper values for evaluating the cross correlation
 struct CrossCorrelationEvaluationHelperValues
 {
+    //! The number of voxels the values were evaluated over
+    index numVoxels = 0;
     //! The mean of the reference density
     real meanReference = 0;
     //! The mean of the compared density
@@ -238,31 +338,73 @@ struct CrossCorrelationEvaluationHelperValues
  * "Numerically Stable, Single-Pass, Parallel Statistics Algorithms"
  * and implemented in boost's correlation coefficient
  */
-CrossCorrelationEvaluationHelperValues evaluateHelperValues(DensitySimilarityMeasure::density reference,
-                                                            DensitySimilarityMeasure::density compared)
+CrossCorrelationEvaluationHelperValues evaluateHelperValues(const float* reference,
+                                                            const float* compared,
+                                                            index        numVoxels)
 {
     CrossCorrelationEvaluationHelperValues helperValues;
 
-    index i = 0;
-
-    auto referenceIterator = begin(reference);
-    for (const real comp : compared)
+    for (index i = 0; i < numVoxels; ++i)
     {
-        const real refHelper        = *referenceIterator - helperValues.meanReference;
-        const real comparisonHelper = comp - helperValues.meanComparison;
+        const real refHelper        = reference[i] - helperValues.meanReference;
+        const real comparisonHelper = compared[i] - helperValues.meanComparison;
         helperValues.referenceSquaredSum += (i * square(refHelper)) / (i + 1);
         helperValues.comparisonSquaredSum += (i * square(comparisonHelper)) / (i + 1);
         helperValues.covariance += i * refHelper * comparisonHelper / (i + 1);
         helperValues.meanReference += refHelper / (i + 1);
         helperValues.meanComparison += comparisonHelper / (i + 1);
-
-        ++referenceIterator;
-        ++i;
     }
+    helperValues.numVoxels = numVoxels;
 
     return helperValues;
 }
 
+/*! \brief Combine helper values of two disjoint voxel sets.
+ *
+ * Uses the pairwise update formulas from the same reference as evaluateHelperValues().
+ */
+CrossCorrelationEvaluationHelperValues combineHelperValues(const CrossCorrelationEvaluationHelperValues& a,
+                                                           const CrossCorrelationEvaluationHelperValues& b)
+{
+    CrossCorrelationEvaluationHelperValues combined;
+
+    combined.numVoxels = a.numVoxels + b.numVoxels;
+
+    const real deltaReference  = b.meanReference - a.meanReference;
+    const real deltaComparison = b.meanComparison - a.meanComparison;
+    const real fractionB       = real(b.numVoxels) / combined.numVoxels;
+    const real weight          = a.numVoxels * fractionB;
+
+    combined.meanReference  = a.meanReference + deltaReference * fractionB;
+    combined.meanComparison = a.meanComparison + deltaComparison * fractionB;
+    combined.referenceSquaredSum =
+            a.referenceSquaredSum + b.referenceSquaredSum + square(deltaReference) * weight;
+    combined.comparisonSquaredSum =
+            a.comparisonSquaredSum + b.comparisonSquaredSum + square(deltaComparison) * weight;
+    combined.covariance = a.covariance + b.covariance + deltaReference * deltaComparison * weight;
+
+    return combined;
+}
+
+/*! \brief Calculate helper values for the cross-correlation using OpenMP threads.
+ *
+ * The values are evaluated in blocks of voxels that are combined in order,
+ * so the result does not depend on the number of threads.
+ */
+CrossCorrelationEvaluationHelperValues evaluateHelperValues(DensitySimilarityMeasure::density reference,
+                                                            DensitySimilarityMeasure::density compared)
+{
+    const float* referenceData = reference.data();
+    const float* comparedData  = compared.data();
+    return reduceOverVoxels<CrossCorrelationEvaluationHelperValues>(
+            numVoxels(compared),
+            [referenceData, comparedData](index voxelBegin, index voxelEnd) {
+                return evaluateHelperValues(referenceData + voxelBegin, comparedData + voxelBegin,
+                                            voxelEnd - voxelBegin);
+            },
+            combineHelperValues);
+}
+
 //! Calculate a single cross correlation gradient entry at a voxel.
 class CrossCorrelationGradientAtVoxel
 {
@@ -361,8 +503,8 @@ DensitySimilarityMeasure::density DensitySimilarityCrossCorrelation::gradient(de
     CrossCorrelationEvaluationHelperValues helperValues =
             evaluateHelperValues(referenceDensity_, comparedDensity);
 
-    std::transform(begin(referenceDensity_), end(referenceDensity_), begin(comparedDensity),
-                   begin(gradient_), CrossCorrelationGradientAtVoxel(helperValues));
+    transformVoxels(referenceDensity_, comparedDensity, &gradient_,
+                    CrossCorrelationGradientAtVoxel(helperValues));
 
     return gradient_.asConstView();
 }
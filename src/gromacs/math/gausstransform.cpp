@@ -52,6 +52,9 @@
 #include "gromacs/math/functions.h"
 #include "gromacs/math/multidimarray.h"
 #include "gromacs/math/utilities.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
 
 namespace gmx
 {
@@ -308,6 +311,18 @@ IVec GaussianSpreadKernelParameters::Shape::latticeSpreadRange() const
 class GaussTransform3D::Impl
 {
 public:
+    /*! \internal \brief Work buffers for spreading a single Gaussian, one set per thread.
+     */
+    struct SpreadWorkspace
+    {
+        //! Construct the one-dimensional Gaussians from spread range and width
+        SpreadWorkspace(const IVec& spreadRange, const BasicVector<double>& sigma);
+        //! The outer product of a Gaussian along the z and y dimension
+        OuterProductEvaluator outerProductZY_;
+        //! The three one-dimensional Gaussians, whose outer product is added to the Gauss transform
+        std::array<GaussianOn1DLattice, DIM> gauss1d_;
+    };
+
     //! Construct from extent and spreading width and range
     Impl(const dynamicExtents3D& extent, const GaussianSpreadKernelParameters::Shape& kernelShapeParameters);
     ~Impl() = default;
@@ -317,51 +332,81 @@ public:
     Impl& operator=(const Impl& other) = default;
     //! Add another gaussian
     void add(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParamters);
+    /*! \brief Add the part of a Gaussian that lies within a slab of the lattice
+     *
+     * \param[in] localParameters  of the spreading kernel
+     * \param[in] sliceBegin        the first index along the slowest varying lattice dimension
+     * \param[in] sliceEnd          one past the last index of the slab
+     * \param[in] workspace         work buffers for the spreading
+     */
+    void addToSlab(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters,
+                   int                                                         sliceBegin,
+                   int                                                         sliceEnd,
+                   SpreadWorkspace*                                            workspace);
     //! The width of the Gaussian in lattice spacing units
     BasicVector<double> sigma_;
     //! The spread range in lattice points
     IVec spreadRange_;
     //! The result of the Gauss transform
     MultiDimArray<std::vector<float>, dynamicExtents3D> data_;
-    //! The outer product of a Gaussian along the z and y dimension
-    OuterProductEvaluator outerProductZY_;
-    //! The three one-dimensional Gaussians, whose outer product is added to the Gauss transform
-    std::array<GaussianOn1DLattice, DIM> gauss1d_;
+    //! Work buffers for spreading, one for each thread that was used
+    std::vector<SpreadWorkspace> workspaces_;
 };
 
+GaussTransform3D::Impl::SpreadWorkspace::SpreadWorkspace(const IVec&                spreadRange,
+                                                         const BasicVector<double>& sigma) :
+    gauss1d_({ GaussianOn1DLattice(spreadRange[XX], sigma[XX]),
+               GaussianOn1DLattice(spreadRange[YY], sigma[YY]),
+               GaussianOn1DLattice(spreadRange[ZZ], sigma[ZZ]) })
+{
+}
+
 GaussTransform3D::Impl::Impl(const dynamicExtents3D&                      extent,
                              const GaussianSpreadKernelParameters::Shape& kernelShapeParameters) :
     sigma_{ kernelShapeParameters.sigma_ },
     spreadRange_{ kernelShapeParameters.latticeSpreadRange() },
-    data_{ extent },
-    gauss1d_({ GaussianOn1DLattice(spreadRange_[XX], sigma_[XX]),
-               GaussianOn1DLattice(spreadRange_[YY], sigma_[YY]),
-               GaussianOn1DLattice(spreadRange_[ZZ], sigma_[ZZ]) })
+    data_{ extent }
 {
+    workspaces_.emplace_back(spreadRange_, sigma_);
 }
 
 void GaussTransform3D::Impl::add(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters)
+{
+    addToSlab(localParameters, 0, static_cast<int>(data_.asView().extent(0)), &workspaces_[0]);
+}
+
+void GaussTransform3D::Impl::addToSlab(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters,
+                                       int              sliceBegin,
+                                       int              sliceEnd,
+                                       SpreadWorkspace* workspace)
 {
     const IVec closestLatticePoint = closestIntegerPoint(localParameters.coordinate_);
-    const auto spreadRange =
+    const auto latticeRange =
             spreadRangeWithinLattice(closestLatticePoint, data_.asView().extents(), spreadRange_);
+    IVec rangeBegin = latticeRange.begin();
+    IVec rangeEnd   = latticeRange.end();
+    rangeBegin[ZZ]  = std::max(rangeBegin[ZZ], sliceBegin);
+    rangeEnd[ZZ]    = std::min(rangeEnd[ZZ], sliceEnd);
+    const IntegerBox spreadRange(rangeBegin, rangeEnd);
 
-    // do nothing if the added Gaussian will never reach the lattice
+    // do nothing if the added Gaussian will never reach the lattice, or this slab
     if (spreadRange.empty())
     {
         return;
     }
 
+    auto& gauss1d        = workspace->gauss1d_;
+    auto& outerProductZY = workspace->outerProductZY_;
     for (int dimension = XX; dimension <= ZZ; ++dimension)
     {
         // multiply with amplitude so that Gauss3D = (amplitude * Gauss_x) * Gauss_y * Gauss_z
         const float gauss1DAmplitude = dimension > XX ? 1.0 : localParameters.amplitude_;
-        gauss1d_[dimension].spread(gauss1DAmplitude, localParameters.coordinate_[dimension]
-                                                             - closestLatticePoint[dimension]);
+        gauss1d[dimension].spread(gauss1DAmplitude, localParameters.coordinate_[dimension]
+                                                            - closestLatticePoint[dimension]);
     }
 
-    const auto spreadZY         = outerProductZY_(gauss1d_[ZZ].view(), gauss1d_[YY].view());
-    const auto spreadX          = gauss1d_[XX].view();
+    const auto spreadZY         = outerProductZY(gauss1d[ZZ].view(), gauss1d[YY].view());
+    const auto spreadX          = gauss1d[XX].view();
     const IVec spreadGridOffset = spreadRange_ - closestLatticePoint;
 
     // \todo optimize these loops if performance critical
@@ -401,6 +446,39 @@ void GaussTransform3D::add(const GaussianSpreadKernelParameters::PositionAndAmpl
     impl_->add(localParameters);
 }
 
+void GaussTransform3D::add(ArrayRef<const RVec> coordinates,
+                           ArrayRef<const real> amplitudes,
+                           int                  numThreads)
+{
+    GMX_RELEASE_ASSERT(coordinates.size() == amplitudes.size(),
+                       "Need one amplitude for each coordinate");
+
+    // Slabs thinner than the spread range would mostly recompute the same Gaussians
+    const int numSlices   = impl_->data_.asView().extent(0);
+    const int maxNumSlabs = numSlices / (impl_->spreadRange_[ZZ] + 1);
+    const int numSlabs    = std::max(1, std::min(numThreads, maxNumSlabs));
+    while (ssize(impl_->workspaces_) < numSlabs)
+    {
+        impl_->workspaces_.emplace_back(impl_->spreadRange_, impl_->sigma_);
+    }
+
+#pragma omp parallel for num_threads(numSlabs) schedule(static) if (numSlabs > 1)
+    for (int slab = 0; slab < numSlabs; slab++)
+    {
+        try
+        {
+            const int sliceBegin = (numSlices * slab) / numSlabs;
+            const int sliceEnd   = (numSlices * (slab + 1)) / numSlabs;
+            for (gmx::index i = 0; i < coordinates.ssize(); i++)
+            {
+                impl_->addToSlab({ coordinates[i], amplitudes[i] }, sliceBegin, sliceEnd,
+                                 &impl_->workspaces_[slab]);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
 void GaussTransform3D::setZero()
 {
     std::fill(begin(impl_->data_), end(impl_->data_), 0.);
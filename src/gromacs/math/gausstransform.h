@@ -193,6 +193,19 @@ public:
      */
     void add(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters);
 
+    /*! \brief Add three dimensional Gaussians with given amplitudes at many coordinates.
+     *
+     * The lattice is split into slabs along its first dimension and each thread
+     * spreads all Gaussians reaching its slab. Thus every lattice value receives
+     * its contributions in the order of the coordinates and the result is
+     * identical to calling add() for each coordinate, independent of \p numThreads.
+     *
+     * \param[in] coordinates of the Gaussians to be spread
+     * \param[in] amplitudes  of the Gaussians, one for each coordinate
+     * \param[in] numThreads  the number of OpenMP threads to use
+     */
+    void add(ArrayRef<const RVec> coordinates, ArrayRef<const real> amplitudes, int numThreads);
+
     //! \brief Set all values on the lattice to zero.
     void setZero();
 
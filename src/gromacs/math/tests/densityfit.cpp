@@ -43,6 +43,8 @@
 
 #include "gromacs/math/densityfit.h"
 
+#include <cmath>
+
 #include <numeric>
 
 #include <gtest/gtest.h>
@@ -234,6 +236,47 @@ TEST(DensitySimilarityTest, CrossCorrelationIsMinusOneWhenAntiCorrelated)
     EXPECT_REAL_EQ_TOL(expectedSimilarity, measure.similarity(comparedDensity.asConstView()), tolerance);
 }
 
+TEST(DensitySimilarityTest, CrossCorrelationIsCorrectOverManyVoxelBlocks)
+{
+    MultiDimArray<std::vector<float>, dynamicExtents3D> referenceDensity(50, 40, 60);
+    MultiDimArray<std::vector<float>, dynamicExtents3D> comparedDensity(50, 40, 60);
+    const index numVoxels = referenceDensity.asConstView().mapping().required_span_size();
+    for (index i = 0; i < numVoxels; i++)
+    {
+        referenceDensity.asView().data()[i] = std::sin(0.001 * i) + 0.1 * (i % 7);
+        comparedDensity.asView().data()[i]  = std::cos(0.0005 * i) + 0.05 * (i % 11);
+    }
+
+    // Evaluate the cross correlation with the two-pass algorithm in double precision
+    double meanReference  = 0;
+    double meanComparison = 0;
+    for (index i = 0; i < numVoxels; i++)
+    {
+        meanReference += referenceDensity.asConstView().data()[i];
+        meanComparison += comparedDensity.asConstView().data()[i];
+    }
+    meanReference /= numVoxels;
+    meanComparison /= numVoxels;
+    double covariance           = 0;
+    double referenceSquaredSum  = 0;
+    double comparisonSquaredSum = 0;
+    for (index i = 0; i < numVoxels; i++)
+    {
+        const double reference  = referenceDensity.asConstView().data()[i] - meanReference;
+        const double comparison = comparedDensity.asConstView().data()[i] - meanComparison;
+        covariance += reference * comparison;
+        referenceSquaredSum += reference * reference;
+        comparisonSquaredSum += comparison * comparison;
+    }
+    const real expectedSimilarity =
+            covariance / std::sqrt(referenceSquaredSum * comparisonSquaredSum);
+
+    DensitySimilarityMeasure measure(DensitySimilarityMeasureMethod::crossCorrelation,
+                                     referenceDensity.asConstView());
+    FloatingPointTolerance tolerance(relativeToleranceAsFloatingPoint(1.0, 1e-4));
+    EXPECT_REAL_EQ_TOL(expectedSimilarity, measure.similarity(comparedDensity.asConstView()), tolerance);
+}
+
 TEST(DensitySimilarityTest, CrossCorrelationGradientIsZeroWhenCorrelated)
 {
     MultiDimArray<std::vector<float>, dynamicExtents3D> referenceDensity(30, 30, 30);
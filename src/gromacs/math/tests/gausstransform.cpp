@@ -43,6 +43,7 @@
 
 #include "gromacs/math/gausstransform.h"
 
+#include <algorithm>
 #include <array>
 #include <numeric>
 #include <vector>
@@ -279,6 +280,39 @@ TEST_F(GaussTransformTest, view)
     EXPECT_THAT(expectedValues, testing::Pointwise(FloatEq(tolerance_), gaussTransformVector));
 }
 
+TEST(GaussTransformMultiThreaded, IsIdenticalToAddingEachGaussian)
+{
+    const extents<dynamic_extent, dynamic_extent, dynamic_extent> latticeExtent = { 40, 12, 9 };
+    const GaussianSpreadKernelParameters::Shape kernelShape   = { DVec{ 1., 1.5, 0.8 }, 4. };
+
+    // Place Gaussians all over the lattice, including outside it
+    std::vector<RVec> coordinates;
+    std::vector<real> amplitudes;
+    for (int i = 0; i < 100; i++)
+    {
+        coordinates.emplace_back(
+                0.1 * ((i * 17) % 110) - 3, 0.13 * ((i * 7) % 100), 0.3 * (i % 31) - 1);
+        amplitudes.push_back(0.5 + 0.01 * i);
+    }
+
+    GaussTransform3D serialGaussTransform(latticeExtent, kernelShape);
+    for (size_t i = 0; i < coordinates.size(); i++)
+    {
+        serialGaussTransform.add({ coordinates[i], amplitudes[i] });
+    }
+    GaussTransform3D threadedGaussTransform(latticeExtent, kernelShape);
+    threadedGaussTransform.add(coordinates, amplitudes, 4);
+
+    const auto serialView   = serialGaussTransform.constView();
+    const auto threadedView = threadedGaussTransform.constView();
+    const auto numValues    = serialView.mapping().required_span_size();
+    EXPECT_GT(*std::max_element(serialView.data(), serialView.data() + numValues), 0);
+    for (gmx::index i = 0; i < numValues; i++)
+    {
+        EXPECT_EQ(serialView.data()[i], threadedView.data()[i]);
+    }
+}
+
 } // namespace
 
 } // namespace test
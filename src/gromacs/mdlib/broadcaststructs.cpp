@@ -42,6 +42,7 @@
 
 #include "gromacs/fileio/tpxio.h"
 #include "gromacs/mdtypes/state.h"
+#include "gromacs/utility/inmemoryserializer.h"
 
 template<typename AllocatorType>
 static void bcastPaddedRVecVector(MPI_Comm                                     communicator,
@@ -92,22 +93,37 @@ void broadcastStateWithoutDynamics(MPI_Comm communicator,
     }
 }
 
-static void bc_tpxheader(MPI_Comm communicator, TpxFileHeader* tpx)
+/*! \brief Serializes or deserializes the header and the body of a tpr file
+ *
+ * Packing all data in one buffer lets us broadcast with a single call,
+ * instead of with one call per header entry. At large rank counts
+ * the latency of many small broadcasts was a significant startup cost.
+ */
+static void serializeTpr(gmx::ISerializer* serializer, PartialDeserializedTprFile* tpr)
 {
-    block_bc(communicator, tpx->bIr);
-    block_bc(communicator, tpx->bBox);
-    block_bc(communicator, tpx->bTop);
-    block_bc(communicator, tpx->bX);
-    block_bc(communicator, tpx->bV);
-    block_bc(communicator, tpx->bF);
-    block_bc(communicator, tpx->natoms);
-    block_bc(communicator, tpx->ngtc);
-    block_bc(communicator, tpx->lambda);
-    block_bc(communicator, tpx->fep_state);
-    block_bc(communicator, tpx->sizeOfTprBody);
-    block_bc(communicator, tpx->fileVersion);
-    block_bc(communicator, tpx->fileGeneration);
-    block_bc(communicator, tpx->isDouble);
+    TpxFileHeader* tpx = &tpr->header;
+    serializer->doBool(&tpx->bIr);
+    serializer->doBool(&tpx->bBox);
+    serializer->doBool(&tpx->bTop);
+    serializer->doBool(&tpx->bX);
+    serializer->doBool(&tpx->bV);
+    serializer->doBool(&tpx->bF);
+    serializer->doInt(&tpx->natoms);
+    serializer->doInt(&tpx->ngtc);
+    serializer->doReal(&tpx->lambda);
+    serializer->doInt(&tpx->fep_state);
+    serializer->doInt64(&tpx->sizeOfTprBody);
+    serializer->doInt(&tpx->fileVersion);
+    serializer->doInt(&tpx->fileGeneration);
+    serializer->doBool(&tpx->isDouble);
+
+    int64_t bodySize = tpr->body.size();
+    serializer->doInt64(&bodySize);
+    if (serializer->reading())
+    {
+        tpr->body.resize(bodySize);
+    }
+    serializer->doOpaque(tpr->body.data(), bodySize);
 }
 
 static void bc_tprCharBuffer(MPI_Comm communicator, bool isMasterRank, std::vector<char>* charBuffer)
@@ -124,10 +140,18 @@ void init_parallel(MPI_Comm                    communicator,
                    gmx_mtop_t*                 mtop,
                    PartialDeserializedTprFile* partialDeserializedTpr)
 {
-    bc_tpxheader(communicator, &partialDeserializedTpr->header);
-    bc_tprCharBuffer(communicator, isMasterRank, &partialDeserializedTpr->body);
+    std::vector<char> buffer;
+    if (isMasterRank)
+    {
+        gmx::InMemorySerializer serializer;
+        serializeTpr(&serializer, partialDeserializedTpr);
+        buffer = serializer.finishAndGetBuffer();
+    }
+    bc_tprCharBuffer(communicator, isMasterRank, &buffer);
     if (!isMasterRank)
     {
+        gmx::InMemoryDeserializer deserializer(buffer, GMX_DOUBLE);
+        serializeTpr(&deserializer, partialDeserializedTpr);
         completeTprDeserialization(partialDeserializedTpr, inputrec, mtop);
     }
 }
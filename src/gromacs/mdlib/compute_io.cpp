@@ -64,14 +64,16 @@ double compute_io(const t_inputrec* ir, int natoms, const SimulationGroups& grou
 
     int    nsteps = ir->nsteps;
     int    i, nxtcatoms = 0;
-    int    nstx, nstv, nstf, nste, nstlog, nstxtc;
+    int    nstx, nstv, nstf, nste, nstlog, nstxtc, nstvtc, nstftc;
     double cio;
 
     nstx   = div_nsteps(nsteps, ir->nstxout);
     nstv   = div_nsteps(nsteps, ir->nstvout);
     nstf   = div_nsteps(nsteps, ir->nstfout);
     nstxtc = div_nsteps(nsteps, ir->nstxout_compressed);
-    if (ir->nstxout_compressed > 0)
+    nstvtc = div_nsteps(nsteps, ir->nstvout_compressed);
+    nstftc = div_nsteps(nsteps, ir->nstfout_compressed);
+    if (ir->nstxout_compressed > 0 || ir->nstvout_compressed > 0 || ir->nstfout_compressed > 0)
     {
         for (int i = 0; i < natoms; i++)
         {
@@ -92,6 +94,9 @@ double compute_io(const t_inputrec* ir, int natoms, const SimulationGroups& grou
     cio += nstlog * (nrener * 16 * 2.0);        /* 16 bytes per energy term plus header */
     /* t_energy contains doubles, but real is written to edr */
     cio += (1.0 * nste) * nrener * 3 * sizeof(real);
+    /* Compressed velocities take roughly 5 bytes per atom, forces are compressed losslessly */
+    cio += nstvtc * nxtcatoms * 5.0;
+    cio += nstftc * nxtcatoms * 3.0 * sizeof(real);
 
     if ((ir->efep != efepNO || ir->bSimTemp) && (ir->fepvals->nstdhdl > 0))
     {
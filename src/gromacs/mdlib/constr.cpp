@@ -197,6 +197,8 @@ public:
     t_nrnb* nrnb = nullptr;
     //! Tracks wallcycle usage.
     gmx_wallcycle* wcycle;
+    //! Tunes the number of threads for SETTLE, when requested
+    ModuleThreadCountTuner settleThreadCountTuner_;
 };
 
 Constraints::~Constraints() = default;
@@ -430,7 +432,7 @@ bool Constraints::Impl::apply(bool                      bLog,
 
     if (nsettle > 0)
     {
-        nth = gmx_omp_nthreads_get(emntSETTLE);
+        nth = settleThreadCountTuner_.numThreads();
     }
     else
     {
@@ -516,6 +518,8 @@ bool Constraints::Impl::apply(bool                      bLog,
         switch (econq)
         {
             case ConstraintVariable::Positions:
+            {
+                const gmx_cycles_t settleStartCycles = gmx_cycles_read();
 #pragma omp parallel for num_threads(nth) schedule(static)
                 for (int th = 0; th < nth; th++)
                 {
@@ -532,6 +536,7 @@ bool Constraints::Impl::apply(bool                      bLog,
                     }
                     GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
                 }
+                settleThreadCountTuner_.recordCycles(gmx_cycles_read() - settleStartCycles);
                 inc_nrnb(nrnb, eNR_SETTLE, nsettle);
                 if (!v.empty())
                 {
@@ -542,6 +547,7 @@ bool Constraints::Impl::apply(bool                      bLog,
                     inc_nrnb(nrnb, eNR_CONSTR_VIR, nsettle * 3);
                 }
                 break;
+            }
             case ConstraintVariable::Velocities:
             case ConstraintVariable::Derivative:
             case ConstraintVariable::Force:
@@ -1015,7 +1021,8 @@ Constraints::Impl::Impl(const gmx_mtop_t&     mtop_p,
     pull_work(pull_work),
     ir(ir_p),
     nrnb(nrnb_p),
-    wcycle(wcycle_p)
+    wcycle(wcycle_p),
+    settleThreadCountTuner_(emntSETTLE, getenv("GMX_TUNE_MODULE_NUM_THREADS") != nullptr)
 {
     if (numConstraints + numSettles > 0 && ir.epc == epcMTTK)
     {
@@ -1084,6 +1091,11 @@ Constraints::Impl::Impl(const gmx_mtop_t&     mtop_p,
             }
 
             shaked = std::make_unique<shakedata>();
+            shaked->useNewtonSolver = (getenv("GMX_SHAKE_NEWTON") != nullptr);
+            if (shaked->useNewtonSolver && log)
+            {
+                fprintf(log, "\nSolving the SHAKE constraints with Newton iterations\n");
+            }
         }
     }
 
@@ -134,6 +134,94 @@ int get_ebin_space(t_ebin* eb, int nener, const char* const enm[], const char* u
     return index;
 }
 
+//! The kinds of updates add_ebin() and add_ebin_indexed() can do to an energy entry
+enum class EnergySumMode
+{
+    None,  //!< Only store the current energy
+    First, //!< Store the energy and start the sums
+    Update //!< Store the energy and update the sums and variance
+};
+
+/*! \brief Store \p energy in \p energyEntry and update the sums according to \p sumMode
+ *
+ * Templating on the mode lifts the branches out of the loops over all
+ * energy terms, so these compile to tight loops. The energy type is a
+ * template parameter so the variance is computed in the same precision
+ * as before by both callers.
+ *
+ * \param[in,out] energyEntry     The entry for the current averaging period
+ * \param[in,out] simEnergyEntry  The entry for the whole simulation
+ * \param[in]     energy          The energy to add
+ * \param[in]     m               The number of sums done before this one
+ * \param[in]     invmm           1/(m*(m+1)) when \p m > 0
+ */
+template<EnergySumMode sumMode, typename EnergyType>
+static inline void addEnergyToEntry(t_energy*  energyEntry,
+                                    t_energy*  simEnergyEntry,
+                                    EnergyType energy,
+                                    int        m,
+                                    double     invmm)
+{
+    energyEntry->e = energy;
+    if (sumMode == EnergySumMode::First)
+    {
+        energyEntry->eav  = 0;
+        energyEntry->esum = energy;
+        simEnergyEntry->esum += energy;
+    }
+    else if (sumMode == EnergySumMode::Update)
+    {
+        /* first update sigma, then sum */
+        double diff = energyEntry->esum - m * energy;
+        energyEntry->eav += diff * diff * invmm;
+        energyEntry->esum += energy;
+        simEnergyEntry->esum += energy;
+    }
+}
+
+//! Add \p nener energies to consecutive entries starting at \p eg and \p egs
+template<EnergySumMode sumMode>
+static void addEnergies(t_energy* eg, t_energy* egs, int nener, const real ener[], int m)
+{
+    const double invmm = (sumMode == EnergySumMode::Update) ? (1.0 / m) / (m + 1.0) : 0;
+
+    for (int i = 0; i < nener; i++)
+    {
+        addEnergyToEntry<sumMode, double>(&eg[i], &egs[i], ener[i], m, invmm);
+    }
+}
+
+//! Add the energies for which \p shouldUse is true to consecutive entries
+template<EnergySumMode sumMode>
+static void addEnergiesIndexed(t_energy*                 energyEntry,
+                               t_energy*                 simEnergyEntry,
+                               gmx::ArrayRef<bool>       shouldUse,
+                               gmx::ArrayRef<const real> ener,
+                               int                       m)
+{
+    const double invmm = (sumMode == EnergySumMode::Update) ? (1.0 / m) / (m + 1.0) : 0;
+
+    for (gmx::index i = 0; i < ener.ssize(); i++)
+    {
+        if (shouldUse[i])
+        {
+            addEnergyToEntry<sumMode, real>(energyEntry, simEnergyEntry, ener[i], m, invmm);
+            ++energyEntry;
+            ++simEnergyEntry;
+        }
+    }
+}
+
+//! Returns the kind of update to do for a step with \p nsum previous sums
+static EnergySumMode energySumMode(bool bSum, int nsum)
+{
+    if (!bSum)
+    {
+        return EnergySumMode::None;
+    }
+    return (nsum == 0) ? EnergySumMode::First : EnergySumMode::Update;
+}
+
 // ICC 19 -O3 -msse2 generates wrong code. Lower optimization levels
 // and other SIMD levels seem fine, however.
 #if defined __ICC
@@ -141,61 +229,28 @@ int get_ebin_space(t_ebin* eb, int nener, const char* const enm[], const char* u
 #endif
 void add_ebin(t_ebin* eb, int entryIndex, int nener, const real ener[], gmx_bool bSum)
 {
-    int       i, m;
-    double    e, invmm, diff;
-    t_energy *eg, *egs;
-
     if ((entryIndex + nener > eb->nener) || (entryIndex < 0))
     {
         gmx_fatal(FARGS, "%s-%d: Energies out of range: entryIndex=%d nener=%d maxener=%d",
                   __FILE__, __LINE__, entryIndex, nener, eb->nener);
     }
 
-    eg = &(eb->e[entryIndex]);
-
-    for (i = 0; (i < nener); i++)
-    {
-        eg[i].e = ener[i];
-    }
+    t_energy* eg  = &(eb->e[entryIndex]);
+    t_energy* egs = &(eb->e_sim[entryIndex]);
+    const int m   = eb->nsum;
 
-    if (bSum)
+    switch (energySumMode(bSum, m))
     {
-        egs = &(eb->e_sim[entryIndex]);
-
-        m = eb->nsum;
-
-        if (m == 0)
-        {
-            for (i = 0; (i < nener); i++)
-            {
-                eg[i].eav  = 0;
-                eg[i].esum = ener[i];
-                egs[i].esum += ener[i];
-            }
-        }
-        else
-        {
-            invmm = (1.0 / m) / (m + 1.0);
-
-            for (i = 0; (i < nener); i++)
-            {
-                /* Value for this component */
-                e = ener[i];
-
-                /* first update sigma, then sum */
-                diff = eg[i].esum - m * e;
-                eg[i].eav += diff * diff * invmm;
-                eg[i].esum += e;
-                egs[i].esum += e;
-            }
-        }
+        case EnergySumMode::None: addEnergies<EnergySumMode::None>(eg, egs, nener, ener, m); break;
+        case EnergySumMode::First:
+            addEnergies<EnergySumMode::First>(eg, egs, nener, ener, m);
+            break;
+        case EnergySumMode::Update:
+            addEnergies<EnergySumMode::Update>(eg, egs, nener, ener, m);
+            break;
     }
 }
 
-// TODO It would be faster if this function was templated on both bSum
-// and whether eb->nsum was zero, to lift the branches out of the loop
-// over all possible energy terms, but that is true for a lot of the
-// ebin and mdebin functionality, so we should do it all or nothing.
 void add_ebin_indexed(t_ebin*                   eb,
                       int                       entryIndex,
                       gmx::ArrayRef<bool>       shouldUse,
@@ -210,37 +265,21 @@ void add_ebin_indexed(t_ebin*                   eb,
                        .c_str());
     GMX_ASSERT(entryIndex >= 0, "Must have non-negative entry");
 
-    const int    m              = eb->nsum;
-    const double invmm          = (m == 0) ? 0 : (1.0 / m) / (m + 1.0);
-    t_energy*    energyEntry    = &(eb->e[entryIndex]);
-    t_energy*    simEnergyEntry = &(eb->e_sim[entryIndex]);
-    auto         shouldUseIter  = shouldUse.begin();
-    for (const auto& theEnergy : ener)
+    t_energy* eg  = &(eb->e[entryIndex]);
+    t_energy* egs = &(eb->e_sim[entryIndex]);
+    const int m   = eb->nsum;
+
+    switch (energySumMode(bSum, m))
     {
-        if (*shouldUseIter)
-        {
-            energyEntry->e = theEnergy;
-            if (bSum)
-            {
-                if (m == 0)
-                {
-                    energyEntry->eav  = 0;
-                    energyEntry->esum = theEnergy;
-                    simEnergyEntry->esum += theEnergy;
-                }
-                else
-                {
-                    /* first update sigma, then sum */
-                    double diff = energyEntry->esum - m * theEnergy;
-                    energyEntry->eav += diff * diff * invmm;
-                    energyEntry->esum += theEnergy;
-                    simEnergyEntry->esum += theEnergy;
-                }
-                ++simEnergyEntry;
-            }
-            ++energyEntry;
-        }
-        ++shouldUseIter;
+        case EnergySumMode::None:
+            addEnergiesIndexed<EnergySumMode::None>(eg, egs, shouldUse, ener, m);
+            break;
+        case EnergySumMode::First:
+            addEnergiesIndexed<EnergySumMode::First>(eg, egs, shouldUse, ener, m);
+            break;
+        case EnergySumMode::Update:
+            addEnergiesIndexed<EnergySumMode::Update>(eg, egs, shouldUse, ener, m);
+            break;
     }
 }
 
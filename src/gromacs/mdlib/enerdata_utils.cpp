@@ -49,28 +49,29 @@
 ForeignLambdaTerms::ForeignLambdaTerms(int numLambdas) :
     numLambdas_(numLambdas),
     energies_(1 + numLambdas),
-    dhdl_(1 + numLambdas)
+    dhdl_(1 + numLambdas),
+    terms_(2 * numLambdas)
 {
 }
 
-std::pair<std::vector<double>, std::vector<double>> ForeignLambdaTerms::getTerms(const t_commrec* cr) const
+std::pair<gmx::ArrayRef<const double>, gmx::ArrayRef<const double>>
+ForeignLambdaTerms::getTerms(const t_commrec* cr)
 {
     GMX_RELEASE_ASSERT(finalizedPotentialContributions_,
                        "The object needs to be finalized before calling getTerms");
 
-    std::vector<double> data(2 * numLambdas_);
     for (int i = 0; i < numLambdas_; i++)
     {
-        data[i]               = energies_[1 + i] - energies_[0];
-        data[numLambdas_ + i] = dhdl_[1 + i];
+        terms_[i]               = energies_[1 + i] - energies_[0];
+        terms_[numLambdas_ + i] = dhdl_[1 + i];
     }
     if (cr && cr->nnodes > 1)
     {
-        gmx_sumd(data.size(), data.data(), cr);
+        gmx_sumd(terms_.size(), terms_.data(), cr);
     }
-    auto dataMid = data.begin() + numLambdas_;
+    gmx::ArrayRef<const double> terms = terms_;
 
-    return { { data.begin(), dataMid }, { dataMid, data.end() } };
+    return { terms.subArray(0, numLambdas_), terms.subArray(numLambdas_, numLambdas_) };
 }
 
 void ForeignLambdaTerms::zeroAllTerms()
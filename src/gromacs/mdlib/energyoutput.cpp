@@ -81,6 +81,7 @@
 #include "gromacs/trajectory/energyframe.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/mdmodulenotification.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
@@ -374,6 +375,8 @@ EnergyOutput::EnergyOutput(ener_file*               fp_ene,
                     }
                 }
                 igrp_[n] = get_ebin_space(ebin_, nEc_, gnm, unit_energy);
+                GMX_ASSERT(igrp_[n] == igrp_[0] + n * nEc_,
+                           "Intergroup energy sets should be stored consecutively");
                 n++;
             }
         }
@@ -868,10 +871,9 @@ void EnergyOutput::addDataAtEnergyStep(bool                    bDoDHDL,
                                        const rvec              mu_tot,
                                        const gmx::Constraints* constr)
 {
-    int    j, k, kk, n, gid;
+    int    j, k, kk, gid;
     real   crmsd[2], tmp6[6];
     real   bs[tricl_boxs_nm.size()], vol, dens, pv, enthalpy;
-    real   eee[egNR];
     double store_dhdl[efptNR];
     real   store_energy = 0;
     real   tmp;
@@ -962,23 +964,26 @@ void EnergyOutput::addDataAtEnergyStep(bool                    bDoDHDL,
     }
     if (nE_ > 1)
     {
-        n = 0;
+        /* The intergroup energy sets are stored consecutively, so we gather
+         * them all and add them with a single call.
+         */
+        egrpEnergies_.resize(nE_ * nEc_);
+        kk = 0;
         for (int i = 0; (i < nEg_); i++)
         {
             for (j = i; (j < nEg_); j++)
             {
                 gid = GID(i, j, nEg_);
-                for (k = kk = 0; (k < egNR); k++)
+                for (k = 0; (k < egNR); k++)
                 {
                     if (bEInd_[k])
                     {
-                        eee[kk++] = enerd->grpp.ener[k][gid];
+                        egrpEnergies_[kk++] = enerd->grpp.ener[k][gid];
                     }
                 }
-                add_ebin(ebin_, igrp_[n], nEc_, eee, bSum);
-                n++;
             }
         }
+        add_ebin(ebin_, igrp_[0], nE_ * nEc_, egrpEnergies_.data(), bSum);
     }
 
     if (ekind)
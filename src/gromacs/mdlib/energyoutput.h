@@ -47,6 +47,8 @@
 
 #include <cstdio>
 
+#include <vector>
+
 #include "gromacs/mdtypes/enerdata.h"
 
 class energyhistory_t;
@@ -371,6 +373,8 @@ private:
     int nE_ = 0;
     //! Indexes for integroup energy sets (each set with nEc energies)
     int* igrp_ = nullptr;
+    //! Buffer for all intergroup energies, these are added to the energy bin in one call
+    std::vector<real> egrpEnergies_;
 
     //! Number of temperature coupling groups
     int nTC_ = 0;
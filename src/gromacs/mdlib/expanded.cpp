@@ -1344,8 +1344,11 @@ int ExpandedEnsembleDynamics(FILE*                 log,
 
         /* we don't need to manipulate the ekind information, as it isn't due to be reset until the next step anyway */
 
+        /* Without velocities on the host, e.g. with the update on a GPU,
+         * the caller scales the velocities.
+         */
         nstart = 0;
-        nend   = mdatoms->homenr;
+        nend   = (v != nullptr) ? mdatoms->homenr : 0;
         for (n = nstart; n < nend; n++)
         {
             gt = 0;
@@ -54,6 +54,14 @@ void init_npt_masses(const t_inputrec* ir, t_state* state, t_extmass* MassQ, gmx
 
 void init_expanded_ensemble(gmx_bool bStateFromCP, const t_inputrec* ir, df_history_t* dfhist);
 
+/*! \brief Updates the weights and chooses the lambda state to move to
+ *
+ * Returns the new lambda state, which the caller should only apply after
+ * the output of the current step. With simulated tempering and a state
+ * change, the reference temperatures are changed and \p v is scaled
+ * accordingly. When \p v is nullptr, the caller should scale the
+ * velocities by the square root of the temperature ratio.
+ */
 int ExpandedEnsembleDynamics(FILE*                 log,
                              const t_inputrec*     ir,
                              const gmx_enerdata_t* enerd,
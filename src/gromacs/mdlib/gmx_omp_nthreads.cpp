@@ -44,6 +44,10 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/utility/cstringutil.h"
@@ -83,8 +87,8 @@ static const char* modth_env_var[emntNR] = { "GMX_DEFAULT_NUM_THREADS should nev
 static const char* mod_name[emntNR] = { "default",     "domain decomposition",
                                         "pair search", "non-bonded",
                                         "bonded",      "PME",
-                                        "update",      "LINCS",
-                                        "SETTLE" };
+                                        "update",      "virtual site",
+                                        "LINCS",       "SETTLE" };
 
 /** Number of threads for each algorithmic module.
  *
@@ -481,3 +485,72 @@ void gmx_omp_nthreads_set(int mod, int nthreads)
 
     modth.nth[mod] = nthreads;
 }
+
+namespace gmx
+{
+
+//! The number of calls not timed after switching to a new thread count
+static const int c_numWarmupCallsPerThreadCount = 2;
+//! The number of calls timed per thread count, the minimum time is used
+static const int c_numTimedCallsPerThreadCount = 8;
+
+ModuleThreadCountTuner::ModuleThreadCountTuner(const int module, const bool requestTuning) :
+    module_(module),
+    numThreads_(gmx_omp_nthreads_get(module))
+{
+    isTuning_ = (requestTuning && numThreads_ > 1 && getenv(modth_env_var[module]) == nullptr
+                 && gmx_cycles_have_counter());
+    if (isTuning_)
+    {
+        for (int numThreads = numThreads_; numThreads > 1; numThreads /= 2)
+        {
+            candidates_.push_back(numThreads);
+        }
+        candidates_.push_back(1);
+        minCycles_.resize(candidates_.size(), std::numeric_limits<gmx_cycles_t>::max());
+    }
+}
+
+void ModuleThreadCountTuner::recordCycles(const gmx_cycles_t cycles)
+{
+    if (!isTuning_)
+    {
+        return;
+    }
+
+    if (numCallsForCandidate_ >= c_numWarmupCallsPerThreadCount)
+    {
+        minCycles_[candidateIndex_] = std::min(minCycles_[candidateIndex_], cycles);
+    }
+    numCallsForCandidate_++;
+    if (numCallsForCandidate_ < c_numWarmupCallsPerThreadCount + c_numTimedCallsPerThreadCount)
+    {
+        return;
+    }
+
+    numCallsForCandidate_ = 0;
+    candidateIndex_++;
+    if (candidateIndex_ < candidates_.size())
+    {
+        numThreads_ = candidates_[candidateIndex_];
+        return;
+    }
+
+    // With equal times we keep the larger thread count, which is timed first
+    const auto fastest = std::min_element(minCycles_.begin(), minCycles_.end());
+    numThreads_        = candidates_[std::distance(minCycles_.begin(), fastest)];
+    isTuning_   = false;
+
+    if (debug)
+    {
+        fprintf(debug, "Tuned the number of %s threads:", mod_name[module_]);
+        for (size_t i = 0; i < candidates_.size(); i++)
+        {
+            fprintf(debug, " %d: %llu cycles", candidates_[i],
+                    static_cast<unsigned long long>(minCycles_[i]));
+        }
+        fprintf(debug, ", using %d threads\n", numThreads_);
+    }
+}
+
+} // namespace gmx
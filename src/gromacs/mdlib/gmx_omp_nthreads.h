@@ -39,6 +39,9 @@
 
 #include <stdio.h>
 
+#include <vector>
+
+#include "gromacs/timing/cyclecounter.h"
 #include "gromacs/utility/basedefinitions.h"
 
 struct t_commrec;
@@ -128,4 +131,59 @@ void gmx_omp_nthreads_set(int mod, int nthreads);
  * command line. */
 void gmx_omp_nthreads_read_env(const gmx::MDLogger& mdlog, int* nthreads_omp);
 
+namespace gmx
+{
+
+/*! \libinternal \brief Tunes the number of OpenMP threads of a module at run time
+ *
+ * Small tasks, such as SETTLE or the update with few atoms per rank, can run
+ * faster with fewer threads than assigned to their module, as the OpenMP
+ * fork/join overhead then dominates. While tuning, the caller runs the task
+ * with numThreads() threads and passes the cycles it took to recordCycles().
+ * The thread count of the module and its halvings down to one thread are
+ * timed in turn during the first calls, after which the fastest count is used.
+ *
+ * Note that reductions over threads, and thereby the results, then depend
+ * on the timings, so tuning is only done when requested.
+ */
+class ModuleThreadCountTuner
+{
+public:
+    /*! \brief Constructor
+     *
+     * \param[in] module         The module, tuning starts from gmx_omp_nthreads_get(module)
+     * \param[in] requestTuning  Whether to tune; there is no tuning when the thread count
+     *                           of the module is set by its environment variable, or
+     *                           when there is no cycle counter.
+     */
+    ModuleThreadCountTuner(int module, bool requestTuning);
+
+    //! Returns the number of threads to run the task with
+    int numThreads() const { return numThreads_; }
+
+    //! Returns whether the thread count is still being tuned
+    bool isTuning() const { return isTuning_; }
+
+    //! Record the \p cycles a call of the task with numThreads() threads took
+    void recordCycles(gmx_cycles_t cycles);
+
+private:
+    //! The module, for reporting
+    int module_;
+    //! The thread counts to time, in decreasing order
+    std::vector<int> candidates_;
+    //! The minimum cycle count for each candidate
+    std::vector<gmx_cycles_t> minCycles_;
+    //! The index of the candidate currently timed
+    size_t candidateIndex_ = 0;
+    //! The number of calls done with the current candidate
+    int numCallsForCandidate_ = 0;
+    //! The thread count to use
+    int numThreads_;
+    //! Whether we are still tuning
+    bool isTuning_;
+};
+
+} // namespace gmx
+
 #endif
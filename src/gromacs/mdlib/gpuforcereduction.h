@@ -93,6 +93,17 @@ public:
      */
     void registerRvecForce(void* forcePtr);
 
+    /*! \brief Set how the registered rvec-format force is added in the following executions
+     *
+     * With multiple time stepping, the rvec-format (PME) force is only computed
+     * on the slow steps, where it is scaled by the MTS factor to obtain the
+     * MTS-combined force that is used for the integration.
+     *
+     * \param [in] addRvecForce  Whether the rvec-format force should be added
+     * \param [in] scaleFactor   The factor to scale the rvec-format force with
+     */
+    void setRvecForceContribution(bool addRvecForce, float scaleFactor);
+
     /*! \brief Add a dependency for this force reduction
      *
      * \param [in] dependency   Dependency for this reduction
@@ -87,6 +87,13 @@ void GpuForceReduction::registerRvecForce(void* /* forcePtr */)
     GMX_ASSERT(false, "A CPU stub has been called instead of the correct implementation.");
 }
 
+// NOLINTNEXTLINE readability-convert-member-functions-to-static
+void GpuForceReduction::setRvecForceContribution(const bool /* addRvecForce */,
+                                                 const float /* scaleFactor */)
+{
+    GMX_ASSERT(false, "A CPU stub has been called instead of the correct implementation.");
+}
+
 // NOLINTNEXTLINE readability-convert-member-functions-to-static
 void GpuForceReduction::addDependency(GpuEventSynchronizer* const /* dependency */)
 {
@@ -69,9 +69,10 @@ typedef struct rvecDeviceForceData rvecDeviceForceData_t;
 template<bool addRvecForce, bool accumulateForce>
 static __global__ void reduceKernel(const float3* __restrict__ gm_nbnxmForce,
                                     const float3* __restrict__ rvecForceToAdd,
-                                    float3*    gm_fTotal,
-                                    const int* gm_cell,
-                                    const int  numAtoms)
+                                    float3*     gm_fTotal,
+                                    const int*  gm_cell,
+                                    const int   numAtoms,
+                                    const float rvecForceScaleFactor)
 {
 
     // map particle-level parallelism to 1D CUDA thread and block index
@@ -97,7 +98,7 @@ static __global__ void reduceKernel(const float3* __restrict__ gm_nbnxmForce,
 
         if (addRvecForce)
         {
-            temp += rvecForceToAdd[threadIndex];
+            temp += rvecForceScaleFactor * rvecForceToAdd[threadIndex];
         }
 
         *gm_fDest = temp;
@@ -149,6 +150,13 @@ void GpuForceReduction::Impl::registerRvecForce(DeviceBuffer<RVec> forcePtr)
     rvecForceToAdd_ = forcePtr;
 };
 
+void GpuForceReduction::Impl::setRvecForceContribution(const bool  addRvecForce,
+                                                       const float scaleFactor)
+{
+    addRvecForce_         = addRvecForce;
+    rvecForceScaleFactor_ = scaleFactor;
+}
+
 void GpuForceReduction::Impl::addDependency(GpuEventSynchronizer* const dependency)
 {
     dependencyList_.push_back(dependency);
@@ -185,12 +193,15 @@ void GpuForceReduction::Impl::execute()
     config.gridSize[2]      = 1;
     config.sharedMemorySize = 0;
 
-    auto kernelFn = (rvecForceToAdd_ != nullptr)
+    const bool addRvecForce = (rvecForceToAdd_ != nullptr && addRvecForce_);
+
+    auto kernelFn = addRvecForce
                             ? (accumulate_ ? reduceKernel<true, true> : reduceKernel<true, false>)
                             : (accumulate_ ? reduceKernel<false, true> : reduceKernel<false, false>);
 
     const auto kernelArgs = prepareGpuKernelArguments(kernelFn, config, &d_nbnxmForce, &d_rvecForceToAdd,
-                                                      &baseForce_, &cellInfo_.d_cell, &numAtoms_);
+                                                      &baseForce_, &cellInfo_.d_cell, &numAtoms_,
+                                                      &rvecForceScaleFactor_);
 
     launchGpuKernel(kernelFn, config, deviceStream_, nullptr, "Force Reduction", kernelArgs);
 
@@ -223,6 +234,11 @@ void GpuForceReduction::registerRvecForce(void* forcePtr)
     impl_->registerRvecForce(reinterpret_cast<DeviceBuffer<RVec>>(forcePtr));
 }
 
+void GpuForceReduction::setRvecForceContribution(const bool addRvecForce, const float scaleFactor)
+{
+    impl_->setRvecForceContribution(addRvecForce, scaleFactor);
+}
+
 void GpuForceReduction::addDependency(GpuEventSynchronizer* const dependency)
 {
     impl_->addDependency(dependency);
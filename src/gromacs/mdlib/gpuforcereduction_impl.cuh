@@ -90,6 +90,13 @@ public:
      */
     void registerRvecForce(DeviceBuffer<RVec> forcePtr);
 
+    /*! \brief Set how the registered rvec-format force is added in the following executions
+     *
+     * \param [in] addRvecForce  Whether the rvec-format force should be added
+     * \param [in] scaleFactor   The factor to scale the rvec-format force with
+     */
+    void setRvecForceContribution(bool addRvecForce, float scaleFactor);
+
     /*! \brief Add a dependency for this force reduction
      *
      * \param [in] dependency   Dependency for this reduction
@@ -136,6 +143,10 @@ private:
     DeviceBuffer<RVec> nbnxmForceToAdd_ = nullptr;
     //! Rvec-format force to be added in this reduction
     DeviceBuffer<RVec> rvecForceToAdd_ = nullptr;
+    //! whether the rvec-format force is added in this reduction
+    bool addRvecForce_ = true;
+    //! factor to scale the rvec-format force with, the MTS factor at MTS slow steps
+    float rvecForceScaleFactor_ = 1.0F;
     //! event to be marked when redcution launch has been completed
     GpuEventSynchronizer* completionMarker_ = nullptr;
     //! The wallclock counter
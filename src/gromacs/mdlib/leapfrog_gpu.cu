@@ -88,6 +88,7 @@ constexpr static int c_maxThreadsPerBlock = c_threadsPerBlock;
  *
  * \tparam        numTempScaleValues               The number of different T-couple values.
  * \tparam        velocityScaling                  Type of the Parrinello-Rahman velocity rescaling.
+ * \tparam        temperatureScaling               Type of the temperature coupling scaling.
  * \param[in]     numAtoms                         Total number of atoms.
  * \param[in,out] gm_x                             Coordinates to update upon integration.
  * \param[out]    gm_xp                            A copy of the coordinates before the integration (for constraints).
@@ -95,12 +96,15 @@ constexpr static int c_maxThreadsPerBlock = c_threadsPerBlock;
  * \param[in]     gm_f                             Atomic forces.
  * \param[in]     gm_inverseMasses                 Reciprocal masses.
  * \param[in]     dt                               Timestep.
- * \param[in]     gm_lambdas                       Temperature scaling factors (one per group)
+ * \param[in]     gm_lambdas                       Temperature scaling factors (one per group),
+ *                                                  or Nose-Hoover friction factors 0.5*dt_tc*vxi
  * \param[in]     gm_tempScaleGroups               Mapping of atoms into groups.
  * \param[in]     dtPressureCouple                 Time step for pressure coupling
  * \param[in]     prVelocityScalingMatrixDiagonal  Diagonal elements of Parrinello-Rahman velocity scaling matrix
  */
-template<NumTempScaleValues numTempScaleValues, VelocityScalingType velocityScaling>
+template<NumTempScaleValues     numTempScaleValues,
+         VelocityScalingType    velocityScaling,
+         TemperatureScalingType temperatureScaling>
 __launch_bounds__(c_maxThreadsPerBlock) __global__
         void leapfrog_kernel(const int numAtoms,
                              float3* __restrict__ gm_x,
@@ -113,7 +117,9 @@ __launch_bounds__(c_maxThreadsPerBlock) __global__
                              const unsigned short* __restrict__ gm_tempScaleGroups,
                              const float3 prVelocityScalingMatrixDiagonal);
 
-template<NumTempScaleValues numTempScaleValues, VelocityScalingType velocityScaling>
+template<NumTempScaleValues     numTempScaleValues,
+         VelocityScalingType    velocityScaling,
+         TemperatureScalingType temperatureScaling>
 __launch_bounds__(c_maxThreadsPerBlock) __global__
         void leapfrog_kernel(const int numAtoms,
                              float3* __restrict__ gm_x,
@@ -140,6 +146,9 @@ __launch_bounds__(c_maxThreadsPerBlock) __global__
         // after the update: x and xp have to be passed to constraints in the 'wrong' order.
         gm_xp[threadIndex] = x;
 
+        // The Nose-Hoover friction factor, only used with TemperatureScalingType::NoseHoover
+        float factorNH = 0.0F;
+
         if (numTempScaleValues != NumTempScaleValues::None || velocityScaling != VelocityScalingType::None)
         {
             float3 vp = v;
@@ -156,6 +165,12 @@ __launch_bounds__(c_maxThreadsPerBlock) __global__
                     int tempScaleGroup = gm_tempScaleGroups[threadIndex];
                     lambda             = gm_lambdas[tempScaleGroup];
                 }
+                if (temperatureScaling == TemperatureScalingType::NoseHoover)
+                {
+                    // As on the CPU: v' = ((1 - factorNH) v - M v + f/m dt) / (1 + factorNH)
+                    factorNH = lambda;
+                    lambda   = 1.0F - factorNH;
+                }
                 vp *= lambda;
             }
 
@@ -171,6 +186,11 @@ __launch_bounds__(c_maxThreadsPerBlock) __global__
 
         v += f * imdt;
 
+        if (temperatureScaling == TemperatureScalingType::NoseHoover)
+        {
+            v *= 1.0F / (1.0F + factorNH);
+        }
+
         x += v * dt;
         gm_v[threadIndex] = v;
         gm_x[threadIndex] = x;
@@ -178,6 +198,58 @@ __launch_bounds__(c_maxThreadsPerBlock) __global__
     return;
 }
 
+/*! \brief Select templated kernel for a given type of Parrinello-Rahman velocity scaling.
+ *
+ * \tparam     velocityScaling        Type of the Parrinello-Rahman velocity scaling.
+ * \param[in]  doTemperatureScaling   If the kernel with temperature coupling velocity scaling
+ *                                    should be selected.
+ * \param[in]  numTempScaleValues     Number of temperature coupling groups in the system.
+ * \param[in]  doNoseHoover           If the temperature coupling is Nose-Hoover.
+ *
+ * \returns                        Pointer to CUDA kernel
+ */
+template<VelocityScalingType velocityScaling>
+inline auto selectLeapFrogKernelPtrForVelocityScaling(bool doTemperatureScaling,
+                                                      int  numTempScaleValues,
+                                                      bool doNoseHoover)
+{
+    auto kernelPtr = leapfrog_kernel<NumTempScaleValues::None, velocityScaling,
+                                     TemperatureScalingType::Lambda>;
+
+    if (!doTemperatureScaling)
+    {
+        kernelPtr = leapfrog_kernel<NumTempScaleValues::None, velocityScaling,
+                                    TemperatureScalingType::Lambda>;
+    }
+    else if (doNoseHoover)
+    {
+        if (numTempScaleValues == 1)
+        {
+            kernelPtr = leapfrog_kernel<NumTempScaleValues::Single, velocityScaling,
+                                        TemperatureScalingType::NoseHoover>;
+        }
+        else if (numTempScaleValues > 1)
+        {
+            kernelPtr = leapfrog_kernel<NumTempScaleValues::Multiple, velocityScaling,
+                                        TemperatureScalingType::NoseHoover>;
+        }
+    }
+    else
+    {
+        if (numTempScaleValues == 1)
+        {
+            kernelPtr = leapfrog_kernel<NumTempScaleValues::Single, velocityScaling,
+                                        TemperatureScalingType::Lambda>;
+        }
+        else if (numTempScaleValues > 1)
+        {
+            kernelPtr = leapfrog_kernel<NumTempScaleValues::Multiple, velocityScaling,
+                                        TemperatureScalingType::Lambda>;
+        }
+    }
+    return kernelPtr;
+}
+
 /*! \brief Select templated kernel.
  *
  * Returns pointer to a CUDA kernel based on the number of temperature coupling groups and
@@ -186,48 +258,31 @@ __launch_bounds__(c_maxThreadsPerBlock) __global__
  * \param[in]  doTemperatureScaling   If the kernel with temperature coupling velocity scaling
  *                                    should be selected.
  * \param[in]  numTempScaleValues     Number of temperature coupling groups in the system.
+ * \param[in]  doNoseHoover           If the temperature coupling is Nose-Hoover.
  * \param[in]  prVelocityScalingType  Type of the Parrinello-Rahman velocity scaling.
  *
  * \retrun                         Pointer to CUDA kernel
  */
 inline auto selectLeapFrogKernelPtr(bool                doTemperatureScaling,
                                     int                 numTempScaleValues,
+                                    bool                doNoseHoover,
                                     VelocityScalingType prVelocityScalingType)
 {
     // Check input for consistency: if there is temperature coupling, at least one coupling group should be defined.
     GMX_ASSERT(!doTemperatureScaling || (numTempScaleValues > 0),
                "Temperature coupling was requested with no temperature coupling groups.");
-    auto kernelPtr = leapfrog_kernel<NumTempScaleValues::None, VelocityScalingType::None>;
+    auto kernelPtr = leapfrog_kernel<NumTempScaleValues::None, VelocityScalingType::None,
+                                     TemperatureScalingType::Lambda>;
 
     if (prVelocityScalingType == VelocityScalingType::None)
     {
-        if (!doTemperatureScaling)
-        {
-            kernelPtr = leapfrog_kernel<NumTempScaleValues::None, VelocityScalingType::None>;
-        }
-        else if (numTempScaleValues == 1)
-        {
-            kernelPtr = leapfrog_kernel<NumTempScaleValues::Single, VelocityScalingType::None>;
-        }
-        else if (numTempScaleValues > 1)
-        {
-            kernelPtr = leapfrog_kernel<NumTempScaleValues::Multiple, VelocityScalingType::None>;
-        }
+        kernelPtr = selectLeapFrogKernelPtrForVelocityScaling<VelocityScalingType::None>(
+                doTemperatureScaling, numTempScaleValues, doNoseHoover);
     }
     else if (prVelocityScalingType == VelocityScalingType::Diagonal)
     {
-        if (!doTemperatureScaling)
-        {
-            kernelPtr = leapfrog_kernel<NumTempScaleValues::None, VelocityScalingType::Diagonal>;
-        }
-        else if (numTempScaleValues == 1)
-        {
-            kernelPtr = leapfrog_kernel<NumTempScaleValues::Single, VelocityScalingType::Diagonal>;
-        }
-        else if (numTempScaleValues > 1)
-        {
-            kernelPtr = leapfrog_kernel<NumTempScaleValues::Multiple, VelocityScalingType::Diagonal>;
-        }
+        kernelPtr = selectLeapFrogKernelPtrForVelocityScaling<VelocityScalingType::Diagonal>(
+                doTemperatureScaling, numTempScaleValues, doNoseHoover);
     }
     else
     {
@@ -237,13 +292,16 @@ inline auto selectLeapFrogKernelPtr(bool                doTemperatureScaling,
     return kernelPtr;
 }
 
-void LeapFrogGpu::integrate(const DeviceBuffer<float3>        d_x,
-                            DeviceBuffer<float3>              d_xp,
-                            DeviceBuffer<float3>              d_v,
-                            const DeviceBuffer<float3>        d_f,
+void LeapFrogGpu::integrate(const DeviceBuffer<Float3>        d_x,
+                            DeviceBuffer<Float3>              d_xp,
+                            DeviceBuffer<Float3>              d_v,
+                            const DeviceBuffer<Float3>        d_f,
                             const real                        dt,
                             const bool                        doTemperatureScaling,
                             gmx::ArrayRef<const t_grp_tcstat> tcstat,
+                            const bool                        doNoseHoover,
+                            const float                       dtTemperatureCouple,
+                            gmx::ArrayRef<const double>       nosehooverVxi,
                             const bool                        doParrinelloRahman,
                             const float                       dtPressureCouple,
                             const matrix                      prVelocityScalingMatrix)
@@ -251,7 +309,8 @@ void LeapFrogGpu::integrate(const DeviceBuffer<float3>        d_x,
 
     ensureNoPendingCudaError("In CUDA version of Leap-Frog integrator");
 
-    auto kernelPtr = leapfrog_kernel<NumTempScaleValues::None, VelocityScalingType::None>;
+    auto kernelPtr = leapfrog_kernel<NumTempScaleValues::None, VelocityScalingType::None,
+                                     TemperatureScalingType::Lambda>;
     if (doTemperatureScaling || doParrinelloRahman)
     {
         if (doTemperatureScaling)
@@ -259,9 +318,13 @@ void LeapFrogGpu::integrate(const DeviceBuffer<float3>        d_x,
             GMX_ASSERT(numTempScaleValues_ == ssize(h_lambdas_),
                        "Number of temperature scaling factors changed since it was set for the "
                        "last time.");
+            GMX_ASSERT(!doNoseHoover || ssize(nosehooverVxi) >= numTempScaleValues_,
+                       "Need a Nose-Hoover thermostat velocity for each coupling group.");
             for (int i = 0; i < numTempScaleValues_; i++)
             {
-                h_lambdas_[i] = tcstat[i].lambda;
+                // Here we account for multiple time stepping, as on the CPU
+                h_lambdas_[i] = doNoseHoover ? 0.5 * dtTemperatureCouple * nosehooverVxi[i]
+                                             : tcstat[i].lambda;
             }
             copyToDeviceBuffer(&d_lambdas_, h_lambdas_.data(), 0, numTempScaleValues_,
                                deviceStream_, GpuApiCallBehavior::Async, nullptr);
@@ -282,7 +345,8 @@ void LeapFrogGpu::integrate(const DeviceBuffer<float3>        d_x,
                                 dtPressureCouple * prVelocityScalingMatrix[YY][YY],
                                 dtPressureCouple * prVelocityScalingMatrix[ZZ][ZZ]);
         }
-        kernelPtr = selectLeapFrogKernelPtr(doTemperatureScaling, numTempScaleValues_, prVelocityScalingType);
+        kernelPtr = selectLeapFrogKernelPtr(doTemperatureScaling, numTempScaleValues_, doNoseHoover,
+                                            prVelocityScalingType);
     }
 
     const auto kernelArgs = prepareGpuKernelArguments(
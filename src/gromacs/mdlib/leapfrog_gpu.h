@@ -49,6 +49,9 @@
 #if GMX_GPU_CUDA
 #    include "gromacs/gpu_utils/devicebuffer.cuh"
 #    include "gromacs/gpu_utils/gputraits.cuh"
+#elif GMX_GPU_SYCL
+#    include "gromacs/gpu_utils/devicebuffer_sycl.h"
+#    include "gromacs/gpu_utils/gputraits_sycl.h"
 #endif
 
 #include "gromacs/gpu_utils/hostallocator.h"
@@ -88,13 +91,23 @@ enum class VelocityScalingType
     Diagonal, //!< Apply velocity scaling using a diagonal matrix
 };
 
+/*! \brief Type of the temperature coupling velocity scaling
+ *
+ *  This is needed to template the kernel
+ */
+enum class TemperatureScalingType
+{
+    Lambda,    //!< Scale the velocities by a factor (Berendsen and v-rescale)
+    NoseHoover //!< Apply the leap-frog Nose-Hoover friction term (chains of length 1)
+};
+
 class LeapFrogGpu
 {
 
 public:
     /*! \brief Constructor.
      *
-     * \param[in] deviceContext  Device context (dummy in CUDA).
+     * \param[in] deviceContext  Device context (dummy in CUDA, used for allocations in SYCL).
      * \param[in] deviceStream   Device stream to use.
      */
     LeapFrogGpu(const DeviceContext& deviceContext, const DeviceStream& deviceStream);
@@ -112,17 +125,24 @@ public:
      * \param[in]     dt                       Timestep.
      * \param[in]     doTemperatureScaling     If velocities should be scaled for temperature coupling.
      * \param[in]     tcstat                   Temperature coupling data.
+     * \param[in]     doNoseHoover             If the temperature coupling is Nose-Hoover, then
+     *                                         \p nosehooverVxi is used instead of \p tcstat.
+     * \param[in]     dtTemperatureCouple      Period between temperature coupling steps.
+     * \param[in]     nosehooverVxi            Nose-Hoover thermostat velocities, one per group.
      * \param[in]     doParrinelloRahman       If current step is a Parrinello-Rahman pressure coupling step.
      * \param[in]     dtPressureCouple         Period between pressure coupling steps
      * \param[in]     prVelocityScalingMatrix  Parrinello-Rahman velocity scaling matrix
      */
-    void integrate(const DeviceBuffer<float3>        d_x,
-                   DeviceBuffer<float3>              d_xp,
-                   DeviceBuffer<float3>              d_v,
-                   const DeviceBuffer<float3>        d_f,
+    void integrate(const DeviceBuffer<Float3>        d_x,
+                   DeviceBuffer<Float3>              d_xp,
+                   DeviceBuffer<Float3>              d_v,
+                   const DeviceBuffer<Float3>        d_f,
                    const real                        dt,
                    const bool                        doTemperatureScaling,
                    gmx::ArrayRef<const t_grp_tcstat> tcstat,
+                   const bool                        doNoseHoover,
+                   const float                       dtTemperatureCouple,
+                   gmx::ArrayRef<const double>       nosehooverVxi,
                    const bool                        doParrinelloRahman,
                    const float                       dtPressureCouple,
                    const matrix                      prVelocityScalingMatrix);
@@ -166,7 +186,8 @@ private:
     //! Number of temperature coupling groups (zero = no coupling)
     int numTempScaleValues_ = 0;
     /*! \brief Array with temperature scaling factors.
-     * This is temporary solution to remap data from t_grp_tcstat into plain array
+     * This is temporary solution to remap data from t_grp_tcstat into plain array.
+     * With Nose-Hoover this holds the friction factors 0.5*dtTemperatureCouple*vxi.
      * \todo Replace with better solution.
      */
     gmx::HostVector<float> h_lambdas_;
@@ -186,7 +207,7 @@ private:
     int numTempScaleGroupsAlloc_ = -1;
 
     //! Vector with diagonal elements of the Parrinello-Rahman pressure coupling velocity rescale factors
-    float3 prVelocityScalingMatrixDiagonal_;
+    Float3 prVelocityScalingMatrixDiagonal_;
 };
 
 } // namespace gmx
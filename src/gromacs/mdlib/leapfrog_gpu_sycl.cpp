@@ -0,0 +1,349 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Implements Leap-Frog using SYCL
+ *
+ * This file contains the SYCL implementation of the basic Leap-Frog integrator,
+ * including class initialization, data-structures management and the kernel.
+ * It is a port of leapfrog_gpu.cu; the kernel flavors are selected the same way.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "leapfrog_gpu.h"
+
+#include <utility>
+
+#include "gromacs/gpu_utils/devicebuffer.h"
+#include "gromacs/gpu_utils/gmxsycl.h"
+#include "gromacs/gpu_utils/syclutils.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/group.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+//! Unique kernel name for each Leap-Frog kernel flavor
+template<NumTempScaleValues     numTempScaleValues,
+         VelocityScalingType    velocityScaling,
+         TemperatureScalingType temperatureScaling>
+class LeapFrogKernel;
+
+/*! \brief Set up the accessors and return the Leap-Frog kernel functor.
+ *
+ * Each work-item updates a single atom, see leapfrog_kernel in leapfrog_gpu.cu
+ * for the description of the algorithm and of the parameters.
+ * The temperature scaling factors and groups are only accessed by the kernel
+ * flavors that use them, so these buffers do not need to be allocated otherwise.
+ */
+template<NumTempScaleValues     numTempScaleValues,
+         VelocityScalingType    velocityScaling,
+         TemperatureScalingType temperatureScaling>
+auto leapFrogKernel(cl::sycl::handler&                  cgh,
+                    const DeviceBuffer<Float3>&         d_x,
+                    const DeviceBuffer<Float3>&         d_xp,
+                    const DeviceBuffer<Float3>&         d_v,
+                    const DeviceBuffer<Float3>&         d_f,
+                    const DeviceBuffer<float>&          d_inverseMasses,
+                    const float                         dt,
+                    const DeviceBuffer<float>&          d_lambdas,
+                    const DeviceBuffer<unsigned short>& d_tempScaleGroups,
+                    const Float3                        prVelocityScalingMatrixDiagonal)
+{
+    using cl::sycl::access::mode;
+
+    constexpr bool haveLambdas         = (numTempScaleValues != NumTempScaleValues::None);
+    constexpr bool haveTempScaleGroups = (numTempScaleValues == NumTempScaleValues::Multiple);
+
+    const auto a_x             = getAccessor<mode::read_write>(d_x, cgh);
+    const auto a_xp            = getAccessor<mode::discard_write>(d_xp, cgh);
+    const auto a_v             = getAccessor<mode::read_write>(d_v, cgh);
+    const auto a_f             = getAccessor<mode::read>(d_f, cgh);
+    const auto a_inverseMasses = getAccessor<mode::read>(d_inverseMasses, cgh);
+    const auto a_lambdas       = getOptionalAccessor<mode::read, haveLambdas>(d_lambdas, cgh);
+    const auto a_tempScaleGroups =
+            getOptionalAccessor<mode::read, haveTempScaleGroups>(d_tempScaleGroups, cgh);
+
+    return [=](cl::sycl::id<1> itemIdx) {
+        const int threadIndex = itemIdx[0];
+
+        Float3      x    = a_x[threadIndex];
+        Float3      v    = a_v[threadIndex];
+        const float imdt = a_inverseMasses[threadIndex] * dt;
+
+        // As in CUDA, xp gets the coordinates before the update, see leapfrog_gpu.cu
+        a_xp[threadIndex] = x;
+
+        // The Nose-Hoover friction factor, only used with TemperatureScalingType::NoseHoover
+        float factorNH = 0.0F;
+
+        if constexpr (haveLambdas || velocityScaling != VelocityScalingType::None)
+        {
+            Float3 vp = v;
+
+            if constexpr (haveLambdas)
+            {
+                float lambda;
+                if constexpr (haveTempScaleGroups)
+                {
+                    lambda = a_lambdas[a_tempScaleGroups[threadIndex]];
+                }
+                else
+                {
+                    lambda = a_lambdas[0];
+                }
+                if constexpr (temperatureScaling == TemperatureScalingType::NoseHoover)
+                {
+                    // As on the CPU: v' = ((1 - factorNH) v - M v + f/m dt) / (1 + factorNH)
+                    factorNH = lambda;
+                    lambda   = 1.0F - factorNH;
+                }
+                vp *= lambda;
+            }
+
+            if constexpr (velocityScaling == VelocityScalingType::Diagonal)
+            {
+                vp[XX] -= prVelocityScalingMatrixDiagonal[XX] * v[XX];
+                vp[YY] -= prVelocityScalingMatrixDiagonal[YY] * v[YY];
+                vp[ZZ] -= prVelocityScalingMatrixDiagonal[ZZ] * v[ZZ];
+            }
+
+            v = vp;
+        }
+
+        v += a_f[threadIndex] * imdt;
+
+        if constexpr (temperatureScaling == TemperatureScalingType::NoseHoover)
+        {
+            v *= 1.0F / (1.0F + factorNH);
+        }
+
+        x += v * dt;
+        a_v[threadIndex] = v;
+        a_x[threadIndex] = x;
+    };
+}
+
+//! Submit the Leap-Frog kernel flavor given by the template parameters to \p deviceStream
+template<NumTempScaleValues     numTempScaleValues,
+         VelocityScalingType    velocityScaling,
+         TemperatureScalingType temperatureScaling>
+static void submitLeapFrogKernel(const DeviceStream&                 deviceStream,
+                                 const int                           numAtoms,
+                                 const DeviceBuffer<Float3>&         d_x,
+                                 const DeviceBuffer<Float3>&         d_xp,
+                                 const DeviceBuffer<Float3>&         d_v,
+                                 const DeviceBuffer<Float3>&         d_f,
+                                 const DeviceBuffer<float>&          d_inverseMasses,
+                                 const float                         dt,
+                                 const DeviceBuffer<float>&          d_lambdas,
+                                 const DeviceBuffer<unsigned short>& d_tempScaleGroups,
+                                 const Float3                        prVelocityScalingDiagonal)
+{
+    using KernelNameType =
+            LeapFrogKernel<numTempScaleValues, velocityScaling, temperatureScaling>;
+
+    const cl::sycl::range<1> range(numAtoms);
+
+    cl::sycl::queue q = deviceStream.stream();
+    q.submit([&](cl::sycl::handler& cgh) {
+        auto kernel = leapFrogKernel<numTempScaleValues, velocityScaling, temperatureScaling>(
+                cgh, d_x, d_xp, d_v, d_f, d_inverseMasses, dt, d_lambdas, d_tempScaleGroups,
+                prVelocityScalingDiagonal);
+        cgh.parallel_for<KernelNameType>(range, kernel);
+    });
+}
+
+/*! \brief Select the kernel flavor for the temperature coupling and submit it.
+ *
+ * \tparam    velocityScaling       Type of the Parrinello-Rahman velocity scaling.
+ * \param[in] doTemperatureScaling  If the temperature coupling velocity scaling is applied.
+ * \param[in] numTempScaleValues    Number of temperature coupling groups in the system.
+ * \param[in] doNoseHoover          If the temperature coupling is Nose-Hoover.
+ * \param[in] args                  The arguments of submitLeapFrogKernel.
+ */
+template<VelocityScalingType velocityScaling, class... Args>
+static void launchLeapFrogKernelForVelocityScaling(const bool doTemperatureScaling,
+                                                   const int  numTempScaleValues,
+                                                   const bool doNoseHoover,
+                                                   Args&&... args)
+{
+    if (!doTemperatureScaling)
+    {
+        submitLeapFrogKernel<NumTempScaleValues::None, velocityScaling,
+                             TemperatureScalingType::Lambda>(std::forward<Args>(args)...);
+    }
+    else if (doNoseHoover)
+    {
+        if (numTempScaleValues == 1)
+        {
+            submitLeapFrogKernel<NumTempScaleValues::Single, velocityScaling,
+                                 TemperatureScalingType::NoseHoover>(std::forward<Args>(args)...);
+        }
+        else
+        {
+            submitLeapFrogKernel<NumTempScaleValues::Multiple, velocityScaling,
+                                 TemperatureScalingType::NoseHoover>(std::forward<Args>(args)...);
+        }
+    }
+    else
+    {
+        if (numTempScaleValues == 1)
+        {
+            submitLeapFrogKernel<NumTempScaleValues::Single, velocityScaling,
+                                 TemperatureScalingType::Lambda>(std::forward<Args>(args)...);
+        }
+        else
+        {
+            submitLeapFrogKernel<NumTempScaleValues::Multiple, velocityScaling,
+                                 TemperatureScalingType::Lambda>(std::forward<Args>(args)...);
+        }
+    }
+}
+
+void LeapFrogGpu::integrate(const DeviceBuffer<Float3>        d_x,
+                            DeviceBuffer<Float3>              d_xp,
+                            DeviceBuffer<Float3>              d_v,
+                            const DeviceBuffer<Float3>        d_f,
+                            const real                        dt,
+                            const bool                        doTemperatureScaling,
+                            gmx::ArrayRef<const t_grp_tcstat> tcstat,
+                            const bool                        doNoseHoover,
+                            const float                       dtTemperatureCouple,
+                            gmx::ArrayRef<const double>       nosehooverVxi,
+                            const bool                        doParrinelloRahman,
+                            const float                       dtPressureCouple,
+                            const matrix                      prVelocityScalingMatrix)
+{
+    // Check input for consistency: if there is temperature coupling,
+    // at least one coupling group should be defined.
+    GMX_ASSERT(!doTemperatureScaling || (numTempScaleValues_ > 0),
+               "Temperature coupling was requested with no temperature coupling groups.");
+
+    if (doTemperatureScaling)
+    {
+        GMX_ASSERT(numTempScaleValues_ == ssize(h_lambdas_),
+                   "Number of temperature scaling factors changed since it was set for the "
+                   "last time.");
+        GMX_ASSERT(!doNoseHoover || ssize(nosehooverVxi) >= numTempScaleValues_,
+                   "Need a Nose-Hoover thermostat velocity for each coupling group.");
+        for (int i = 0; i < numTempScaleValues_; i++)
+        {
+            // Here we account for multiple time stepping, as on the CPU
+            h_lambdas_[i] = doNoseHoover ? 0.5 * dtTemperatureCouple * nosehooverVxi[i]
+                                         : tcstat[i].lambda;
+        }
+        copyToDeviceBuffer(&d_lambdas_, h_lambdas_.data(), 0, numTempScaleValues_, deviceStream_,
+                           GpuApiCallBehavior::Async, nullptr);
+    }
+
+    if (doParrinelloRahman)
+    {
+        GMX_ASSERT(prVelocityScalingMatrix[YY][XX] == 0 && prVelocityScalingMatrix[ZZ][XX] == 0
+                           && prVelocityScalingMatrix[ZZ][YY] == 0
+                           && prVelocityScalingMatrix[XX][YY] == 0
+                           && prVelocityScalingMatrix[XX][ZZ] == 0
+                           && prVelocityScalingMatrix[YY][ZZ] == 0,
+                   "Fully anisotropic Parrinello-Rahman pressure coupling is not yet supported "
+                   "in GPU version of Leap-Frog integrator.");
+        prVelocityScalingMatrixDiagonal_ =
+                Float3(dtPressureCouple * prVelocityScalingMatrix[XX][XX],
+                       dtPressureCouple * prVelocityScalingMatrix[YY][YY],
+                       dtPressureCouple * prVelocityScalingMatrix[ZZ][ZZ]);
+        launchLeapFrogKernelForVelocityScaling<VelocityScalingType::Diagonal>(
+                doTemperatureScaling, numTempScaleValues_, doNoseHoover, deviceStream_, numAtoms_,
+                d_x, d_xp, d_v, d_f, d_inverseMasses_, dt, d_lambdas_, d_tempScaleGroups_,
+                prVelocityScalingMatrixDiagonal_);
+    }
+    else
+    {
+        launchLeapFrogKernelForVelocityScaling<VelocityScalingType::None>(
+                doTemperatureScaling, numTempScaleValues_, doNoseHoover, deviceStream_, numAtoms_,
+                d_x, d_xp, d_v, d_f, d_inverseMasses_, dt, d_lambdas_, d_tempScaleGroups_,
+                prVelocityScalingMatrixDiagonal_);
+    }
+}
+
+LeapFrogGpu::LeapFrogGpu(const DeviceContext& deviceContext, const DeviceStream& deviceStream) :
+    deviceContext_(deviceContext),
+    deviceStream_(deviceStream),
+    numAtoms_(0)
+{
+    changePinningPolicy(&h_lambdas_, gmx::PinningPolicy::PinnedIfSupported);
+}
+
+LeapFrogGpu::~LeapFrogGpu()
+{
+    freeDeviceBuffer(&d_inverseMasses_);
+    freeDeviceBuffer(&d_lambdas_);
+    freeDeviceBuffer(&d_tempScaleGroups_);
+}
+
+void LeapFrogGpu::set(const int             numAtoms,
+                      const real*           inverseMasses,
+                      const int             numTempScaleValues,
+                      const unsigned short* tempScaleGroups)
+{
+    numAtoms_           = numAtoms;
+    numTempScaleValues_ = numTempScaleValues;
+
+    reallocateDeviceBuffer(&d_inverseMasses_, numAtoms_, &numInverseMasses_,
+                           &numInverseMassesAlloc_, deviceContext_);
+    copyToDeviceBuffer(&d_inverseMasses_, inverseMasses, 0, numAtoms_, deviceStream_,
+                       GpuApiCallBehavior::Sync, nullptr);
+
+    // Temperature scale group map only used if there are more then one group
+    if (numTempScaleValues > 1)
+    {
+        reallocateDeviceBuffer(&d_tempScaleGroups_, numAtoms_, &numTempScaleGroups_,
+                               &numTempScaleGroupsAlloc_, deviceContext_);
+        copyToDeviceBuffer(&d_tempScaleGroups_, tempScaleGroups, 0, numAtoms_, deviceStream_,
+                           GpuApiCallBehavior::Sync, nullptr);
+    }
+
+    // If the temperature coupling is enabled, we need to make space for scaling factors
+    if (numTempScaleValues_ > 0)
+    {
+        h_lambdas_.resize(numTempScaleValues);
+        reallocateDeviceBuffer(&d_lambdas_, numTempScaleValues_, &numLambdas_, &numLambdasAlloc_,
+                               deviceContext_);
+    }
+}
+
+} // namespace gmx
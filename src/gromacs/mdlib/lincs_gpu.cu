@@ -72,10 +72,10 @@
 namespace gmx
 {
 
-//! Number of CUDA threads in a block
+//! Number of CUDA threads in a block, used unless a group of coupled constraints does not fit
 constexpr static int c_threadsPerBlock = 256;
-//! Maximum number of threads in a block (for __launch_bounds__)
-constexpr static int c_maxThreadsPerBlock = c_threadsPerBlock;
+//! Maximum number of threads in a block (for __launch_bounds__), limits the coupled group size
+constexpr static int c_maxThreadsPerBlock = 1024;
 
 /*! \brief Main kernel for LINCS constraints.
  *
@@ -87,7 +87,9 @@ constexpr static int c_maxThreadsPerBlock = c_threadsPerBlock;
  * to fit the current thread block. This may leave some 'dummy' threads in the end of the thread block, i.e.
  * threads that are not required to do actual work. Since constraints from different blocks are not coupled,
  * there is no need to synchronize across the device. However, extensive communication in a thread block
- * are still needed.
+ * are still needed. The block size is chosen in set() as the smallest power of two, not smaller
+ * than c_threadsPerBlock, that fits the largest group of coupled constraints. So groups of up to
+ * c_maxThreadsPerBlock constraints, e.g. all-bonds constraints on lipids or sugars, are supported.
  *
  * \todo Reduce synchronization overhead. Some ideas are:
  *        1. Consider going to warp-level synchronization for the coupled constraints.
@@ -453,10 +455,11 @@ void LincsGpu::apply(const float3* d_x,
     auto kernelPtr = getLincsKernelPtr(updateVelocities, computeVirial);
 
     KernelLaunchConfig config;
-    config.blockSize[0] = c_threadsPerBlock;
+    config.blockSize[0] = threadsPerBlock_;
     config.blockSize[1] = 1;
     config.blockSize[2] = 1;
-    config.gridSize[0] = (kernelParams_.numConstraintsThreads + c_threadsPerBlock - 1) / c_threadsPerBlock;
+    config.gridSize[0] =
+            (kernelParams_.numConstraintsThreads + threadsPerBlock_ - 1) / threadsPerBlock_;
     config.gridSize[1] = 1;
     config.gridSize[2] = 1;
 
@@ -469,11 +472,11 @@ void LincsGpu::apply(const float3* d_x,
     // max{3, 2, 6} = 6 floats per thread are needed in case virial is computed, or max{3, 2} = 3 if not.
     if (computeVirial)
     {
-        config.sharedMemorySize = c_threadsPerBlock * 6 * sizeof(float);
+        config.sharedMemorySize = threadsPerBlock_ * 6 * sizeof(float);
     }
     else
     {
-        config.sharedMemorySize = c_threadsPerBlock * 3 * sizeof(float);
+        config.sharedMemorySize = threadsPerBlock_ * 3 * sizeof(float);
     }
 
     kernelParams_.pbcAiuc = pbcAiuc;
@@ -512,7 +515,8 @@ LincsGpu::LincsGpu(int                  numIterations,
                    const DeviceContext& deviceContext,
                    const DeviceStream&  deviceStream) :
     deviceContext_(deviceContext),
-    deviceStream_(deviceStream)
+    deviceStream_(deviceStream),
+    threadsPerBlock_(c_threadsPerBlock)
 {
     kernelParams_.numIterations  = numIterations;
     kernelParams_.expansionOrder = expansionOrder;
@@ -522,6 +526,12 @@ LincsGpu::LincsGpu(int                  numIterations,
     static_assert(
             c_threadsPerBlock > 0 && ((c_threadsPerBlock & (c_threadsPerBlock - 1)) == 0),
             "Number of threads per block should be a power of two in order for reduction to work.");
+    static_assert(c_maxThreadsPerBlock % c_threadsPerBlock == 0
+                          && ((c_maxThreadsPerBlock / c_threadsPerBlock)
+                              & (c_maxThreadsPerBlock / c_threadsPerBlock - 1))
+                                     == 0,
+                  "The maximum number of threads per block should be a power of two multiple of "
+                  "the default number of threads per block.");
 
     allocateDeviceBuffer(&kernelParams_.d_virialScaled, 6, deviceContext_);
     h_virialScaled_.resize(6);
@@ -715,7 +725,7 @@ bool LincsGpu::isNumCoupledConstraintsSupported(const gmx_mtop_t& mtop)
         const auto numCoupledConstraints = countNumCoupledConstraints(iatoms, atomsAdjacencyList);
         for (const int numCoupled : numCoupledConstraints)
         {
-            if (numCoupled > c_threadsPerBlock)
+            if (numCoupled > c_maxThreadsPerBlock)
             {
                 return false;
             }
@@ -756,34 +766,44 @@ void LincsGpu::set(const InteractionDefinitions& idef, const int numAtoms, const
     // Compute, how many constraints are coupled to each constraint
     const auto numCoupledConstraints = countNumCoupledConstraints(iatoms, atomsAdjacencyList);
 
+    // Use the smallest block size that fits the largest group of coupled constraints,
+    // so the common case of small groups keeps the default block size.
+    const int maxCoupledGroupSize =
+            *std::max_element(numCoupledConstraints.begin(), numCoupledConstraints.end());
+    // Check if coupled constraints all fit in one block
+    if (maxCoupledGroupSize > c_maxThreadsPerBlock)
+    {
+        gmx_fatal(FARGS,
+                  "Maximum number of coupled constraints (%d) exceeds the maximum size of the CUDA "
+                  "thread block (%d). Most likely, you are trying to use the GPU version of "
+                  "LINCS with constraints on all-bonds, which is not supported for large "
+                  "molecules. When compatible with the force field and integration settings, "
+                  "using constraints on H-bonds only.",
+                  maxCoupledGroupSize, c_maxThreadsPerBlock);
+    }
+    threadsPerBlock_ = c_threadsPerBlock;
+    while (threadsPerBlock_ < maxCoupledGroupSize)
+    {
+        threadsPerBlock_ *= 2;
+    }
+
     // Map of splits in the constraints data. For each 'old' constraint index gives 'new' which
     // takes into account the empty spaces which might be needed in the end of each thread block.
     std::vector<int> splitMap(numConstraints, -1);
     int              currentMapIndex = 0;
     for (int c = 0; c < numConstraints; c++)
     {
-        // Check if coupled constraints all fit in one block
-        if (numCoupledConstraints.at(c) > c_threadsPerBlock)
-        {
-            gmx_fatal(FARGS,
-                      "Maximum number of coupled constraints (%d) exceeds the size of the CUDA "
-                      "thread block (%d). Most likely, you are trying to use the GPU version of "
-                      "LINCS with constraints on all-bonds, which is not supported for large "
-                      "molecules. When compatible with the force field and integration settings, "
-                      "using constraints on H-bonds only.",
-                      numCoupledConstraints.at(c), c_threadsPerBlock);
-        }
-        if (currentMapIndex / c_threadsPerBlock
-            != (currentMapIndex + numCoupledConstraints.at(c)) / c_threadsPerBlock)
+        if (currentMapIndex / threadsPerBlock_
+            != (currentMapIndex + numCoupledConstraints.at(c)) / threadsPerBlock_)
         {
-            currentMapIndex = ((currentMapIndex / c_threadsPerBlock) + 1) * c_threadsPerBlock;
+            currentMapIndex = ((currentMapIndex / threadsPerBlock_) + 1) * threadsPerBlock_;
         }
         addWithCoupled(iatoms, stride, atomsAdjacencyList, splitMap, c, &currentMapIndex);
     }
 
     kernelParams_.numConstraintsThreads =
-            currentMapIndex + c_threadsPerBlock - currentMapIndex % c_threadsPerBlock;
-    GMX_RELEASE_ASSERT(kernelParams_.numConstraintsThreads % c_threadsPerBlock == 0,
+            currentMapIndex + threadsPerBlock_ - currentMapIndex % threadsPerBlock_;
+    GMX_RELEASE_ASSERT(kernelParams_.numConstraintsThreads % threadsPerBlock_ == 0,
                        "Number of threads should be a multiple of the block size");
 
     // Initialize constraints and their target indexes taking into account the splits in the data arrays.
@@ -179,6 +179,12 @@ private:
     //! Parameters and pointers, passed to the GPU kernel
     LincsGpuKernelParameters kernelParams_;
 
+    /*! \brief Number of threads in a block.
+     *
+     * Set in set() to fit the largest group of coupled constraints in one block.
+     */
+    int threadsPerBlock_;
+
     //! Scaled virial tensor (6 floats: [XX, XY, XZ, YY, YZ, ZZ])
     std::vector<float> h_virialScaled_;
 
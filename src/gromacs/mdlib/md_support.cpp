@@ -126,7 +126,7 @@ static void calc_ke_part_normal(gmx::ArrayRef<const gmx::RVec> v,
         int     ga, gt;
         rvec    v_corrt;
         real    hm;
-        int     d, m;
+        int     d;
         matrix* ekin_sum;
         real*   dekindl_sum;
 
@@ -142,37 +142,64 @@ static void calc_ke_part_normal(gmx::ArrayRef<const gmx::RVec> v,
         }
         *dekindl_sum = 0.0;
 
+        /* The kinetic energy tensor is symmetric, so we accumulate only
+         * the upper triangle. We sum in local variables and only add to
+         * the tensor of T-coupling group gt when the group changes, since
+         * atoms of the same group are usually consecutive.
+         */
+        real ekinXX = 0, ekinXY = 0, ekinXZ = 0;
+        real ekinYY = 0, ekinYZ = 0, ekinZZ = 0;
+
+        auto addLocalSumsToGroup = [&](int group) {
+            ekin_sum[group][XX][XX] += ekinXX;
+            ekin_sum[group][XX][YY] += ekinXY;
+            ekin_sum[group][XX][ZZ] += ekinXZ;
+            ekin_sum[group][YY][XX] += ekinXY;
+            ekin_sum[group][YY][YY] += ekinYY;
+            ekin_sum[group][YY][ZZ] += ekinYZ;
+            ekin_sum[group][ZZ][XX] += ekinXZ;
+            ekin_sum[group][ZZ][YY] += ekinYZ;
+            ekin_sum[group][ZZ][ZZ] += ekinZZ;
+            ekinXX = ekinXY = ekinXZ = 0;
+            ekinYY = ekinYZ = ekinZZ = 0;
+        };
+
         ga = 0;
-        gt = 0;
+        gt = (md->cTC && start_t < end_t) ? md->cTC[start_t] : 0;
         for (n = start_t; n < end_t; n++)
         {
             if (md->cACC)
             {
                 ga = md->cACC[n];
             }
-            if (md->cTC)
+            if (md->cTC && md->cTC[n] != gt)
             {
+                addLocalSumsToGroup(gt);
                 gt = md->cTC[n];
             }
             hm = 0.5 * md->massT[n];
 
+            /* if we're computing a full step velocity, v_corrt[d] has v(t).
+             * Otherwise, v(t+dt/2) */
             for (d = 0; (d < DIM); d++)
             {
                 v_corrt[d] = v[n][d] - grpstat[ga].u[d];
             }
-            for (d = 0; (d < DIM); d++)
-            {
-                for (m = 0; (m < DIM); m++)
-                {
-                    /* if we're computing a full step velocity, v_corrt[d] has v(t).  Otherwise, v(t+dt/2) */
-                    ekin_sum[gt][m][d] += hm * v_corrt[m] * v_corrt[d];
-                }
-            }
+            const real hvx = hm * v_corrt[XX];
+            const real hvy = hm * v_corrt[YY];
+            const real hvz = hm * v_corrt[ZZ];
+            ekinXX += hvx * v_corrt[XX];
+            ekinXY += hvx * v_corrt[YY];
+            ekinXZ += hvx * v_corrt[ZZ];
+            ekinYY += hvy * v_corrt[YY];
+            ekinYZ += hvy * v_corrt[ZZ];
+            ekinZZ += hvz * v_corrt[ZZ];
             if (md->nMassPerturbed && md->bPerturbed[n])
             {
                 *dekindl_sum += 0.5 * (md->massB[n] - md->massA[n]) * iprod(v_corrt, v_corrt);
             }
         }
+        addLocalSumsToGroup(gt);
     }
 
     ekind->dekindl = 0;
@@ -0,0 +1,123 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ *
+ * \brief Declares the MD step CUDA graph.
+ *
+ * With GPU-resident steps, the force and update work of a step is
+ * a fixed sequence of launches into the device streams. This sequence
+ * can be captured into a CUDA graph once and then replayed on the
+ * following steps with the same workload, which removes most of the
+ * CPU launch overhead.
+ *
+ * \inlibraryapi
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_MDGRAPH_GPU_H
+#define GMX_MDLIB_MDGRAPH_GPU_H
+
+#include "gromacs/utility/classhelpers.h"
+
+class DeviceStreamManager;
+class GpuEventSynchronizer;
+struct gmx_wallcycle;
+
+namespace gmx
+{
+
+/*! \brief Whether this build supports capturing the MD step in a GPU graph. */
+bool buildSupportsMdGpuGraph();
+
+/*! \libinternal
+ * \brief Captures the GPU work of an MD step in a graph and replays it.
+ *
+ * The capture starts in the update stream. All other streams that take
+ * part in the step are forked from it at the start of the capture and
+ * joined back into it at the end, so the graph contains the complete
+ * dependency structure of the step. Capturing does not execute any work,
+ * so the graph should be launched on the capture step as well.
+ *
+ * The graph stores the kernel arguments of the captured step. It is only
+ * valid as long as the pairlist, the box and the buffers are unchanged,
+ * so the caller should call reset() when any of these change.
+ */
+class MdGpuGraph
+{
+public:
+    /*! \brief Create the MD step graph object.
+     *
+     * \param[in] deviceStreamManager  Device stream manager; the update stream and,
+     *                                 when valid, the local nonbonded and PME streams are used.
+     * \param[in] wcycle               Wall-clock cycle counter.
+     */
+    MdGpuGraph(const DeviceStreamManager& deviceStreamManager, gmx_wallcycle* wcycle);
+    ~MdGpuGraph();
+
+    /*! \brief Start capturing the GPU work of the step.
+     *
+     * The event that signals that the coordinates are ready on the device is
+     * marked inside the capture, so that consumers of the coordinates that wait
+     * on it become part of the graph.
+     *
+     * \param[in] xReadyOnDeviceEvent  Event that consumers of the coordinates wait on.
+     */
+    void startRecord(GpuEventSynchronizer* xReadyOnDeviceEvent);
+
+    /*! \brief End the capture and create the executable graph. */
+    void endRecord();
+
+    /*! \brief Launch the captured graph.
+     *
+     * The graph waits for the preceding work in all involved streams and the
+     * streams wait for the graph before any following work.
+     *
+     * \param[in] xUpdatedOnDeviceEvent  Event marked when the updated coordinates are ready.
+     */
+    void launchGraphMdStep(GpuEventSynchronizer* xUpdatedOnDeviceEvent);
+
+    /*! \brief Discard the captured graph, a new capture is needed before the next launch. */
+    void reset();
+
+    /*! \brief Whether a graph has been captured and can be launched. */
+    bool graphIsCaptured() const;
+
+private:
+    class Impl;
+    PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace gmx
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Stub for the MD step GPU graph in non-CUDA builds.
+ *
+ * \ingroup module_mdlib
+ */
+
+#include "gmxpre.h"
+
+#include "config.h"
+
+#include "gromacs/mdlib/mdgraph_gpu.h"
+
+#if !GMX_GPU_CUDA
+
+#    include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+class MdGpuGraph::Impl
+{
+};
+
+bool buildSupportsMdGpuGraph()
+{
+    return false;
+}
+
+MdGpuGraph::MdGpuGraph(const DeviceStreamManager& /* deviceStreamManager */,
+                       gmx_wallcycle* /* wcycle */) :
+    impl_(nullptr)
+{
+    GMX_ASSERT(false,
+               "A CPU stub for MdGpuGraph was called instead of the correct implementation.");
+}
+
+MdGpuGraph::~MdGpuGraph() = default;
+
+// NOLINTNEXTLINE readability-convert-member-functions-to-static
+void MdGpuGraph::startRecord(GpuEventSynchronizer* /* xReadyOnDeviceEvent */)
+{
+    GMX_ASSERT(false,
+               "A CPU stub for MdGpuGraph was called instead of the correct implementation.");
+}
+
+// NOLINTNEXTLINE readability-convert-member-functions-to-static
+void MdGpuGraph::endRecord()
+{
+    GMX_ASSERT(false,
+               "A CPU stub for MdGpuGraph was called instead of the correct implementation.");
+}
+
+// NOLINTNEXTLINE readability-convert-member-functions-to-static
+void MdGpuGraph::launchGraphMdStep(GpuEventSynchronizer* /* xUpdatedOnDeviceEvent */)
+{
+    GMX_ASSERT(false,
+               "A CPU stub for MdGpuGraph was called instead of the correct implementation.");
+}
+
+// NOLINTNEXTLINE readability-convert-member-functions-to-static
+void MdGpuGraph::reset()
+{
+    GMX_ASSERT(false,
+               "A CPU stub for MdGpuGraph was called instead of the correct implementation.");
+}
+
+// NOLINTNEXTLINE readability-convert-member-functions-to-static
+bool MdGpuGraph::graphIsCaptured() const
+{
+    GMX_ASSERT(false,
+               "A CPU stub for MdGpuGraph was called instead of the correct implementation.");
+    return false;
+}
+
+} // namespace gmx
+
+#endif // !GMX_GPU_CUDA
@@ -0,0 +1,222 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Implements the MD step graph using CUDA graphs.
+ *
+ * \ingroup module_mdlib
+ */
+
+#include "gmxpre.h"
+
+#include "mdgraph_gpu_impl.h"
+
+#include "gromacs/gpu_utils/cudautils.cuh"
+#include "gromacs/gpu_utils/device_stream_manager.h"
+#include "gromacs/timing/wallcycle.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+bool buildSupportsMdGpuGraph()
+{
+    return true;
+}
+
+MdGpuGraph::Impl::Impl(const DeviceStreamManager& deviceStreamManager, gmx_wallcycle* wcycle) :
+    launchStream_(deviceStreamManager.stream(DeviceStreamType::UpdateAndConstraints)),
+    wcycle_(wcycle)
+{
+    // Without domain decomposition or separate PME ranks, only the local nonbonded
+    // and the PME streams take part in the step, next to the update stream.
+    const DeviceStreamType forkedStreamTypes[] = { DeviceStreamType::NonBondedLocal,
+                                                   DeviceStreamType::Pme };
+    for (const DeviceStreamType streamType : forkedStreamTypes)
+    {
+        if (deviceStreamManager.streamIsValid(streamType))
+        {
+            forkedStreams_.push_back(&deviceStreamManager.stream(streamType));
+            joinEvents_.push_back(std::make_unique<GpuEventSynchronizer>());
+        }
+    }
+}
+
+MdGpuGraph::Impl::~Impl()
+{
+    reset();
+}
+
+void MdGpuGraph::Impl::startRecord(GpuEventSynchronizer* xReadyOnDeviceEvent)
+{
+    GMX_ASSERT(!isRecording_, "Can not start a capture while capturing");
+
+    reset();
+
+    wallcycle_start_nocount(wcycle_, ewcLAUNCH_GPU);
+
+    // Only this thread launches work into the involved streams, so other threads
+    // can keep using CUDA while the capture is in progress.
+    cudaError_t stat =
+            cudaStreamBeginCapture(launchStream_.stream(), cudaStreamCaptureModeThreadLocal);
+    CU_RET_ERR(stat, "cudaStreamBeginCapture failed when capturing the MD step GPU graph");
+    isRecording_ = true;
+
+    // The other streams join the capture by waiting on an event recorded in it
+    forkEvent_.markEvent(launchStream_);
+    for (const DeviceStream* stream : forkedStreams_)
+    {
+        forkEvent_.enqueueWaitEvent(*stream);
+    }
+
+    // The coordinates are ready at the start of the graph, as the graph waits for
+    // the preceding work at launch. Marking the event here lets the consumers that
+    // wait on it take part in the capture.
+    xReadyOnDeviceEvent->markEvent(launchStream_);
+
+    wallcycle_stop(wcycle_, ewcLAUNCH_GPU);
+}
+
+void MdGpuGraph::Impl::endRecord()
+{
+    GMX_ASSERT(isRecording_, "Can only end a capture that has been started");
+
+    wallcycle_start_nocount(wcycle_, ewcLAUNCH_GPU);
+
+    for (size_t i = 0; i < forkedStreams_.size(); i++)
+    {
+        joinEvents_[i]->markEvent(*forkedStreams_[i]);
+        joinEvents_[i]->enqueueWaitEvent(launchStream_);
+    }
+
+    // A failing capture means that the work of this step was not executed,
+    // so the run can not continue
+    cudaError_t stat = cudaStreamEndCapture(launchStream_.stream(), &graph_);
+    CU_RET_ERR(stat,
+               "cudaStreamEndCapture failed when capturing the MD step GPU graph, "
+               "unset GMX_CUDA_GRAPH to run without GPU graphs");
+    isRecording_ = false;
+
+#if CUDART_VERSION >= 11040
+    stat = cudaGraphInstantiateWithFlags(&graphInstance_, graph_, 0);
+#else
+    stat = cudaGraphInstantiate(&graphInstance_, graph_, nullptr, nullptr, 0);
+#endif
+    CU_RET_ERR(stat, "cudaGraphInstantiate failed for the MD step GPU graph");
+    graphIsCaptured_ = true;
+
+    wallcycle_stop(wcycle_, ewcLAUNCH_GPU);
+}
+
+void MdGpuGraph::Impl::launchGraphMdStep(GpuEventSynchronizer* xUpdatedOnDeviceEvent)
+{
+    GMX_ASSERT(graphIsCaptured_, "Can only launch a captured graph");
+
+    wallcycle_start_nocount(wcycle_, ewcLAUNCH_GPU);
+
+    // The graph depends on the work launched earlier into any of the involved streams.
+    for (size_t i = 0; i < forkedStreams_.size(); i++)
+    {
+        joinEvents_[i]->markEvent(*forkedStreams_[i]);
+        joinEvents_[i]->enqueueWaitEvent(launchStream_);
+    }
+
+    cudaError_t stat = cudaGraphLaunch(graphInstance_, launchStream_.stream());
+    CU_RET_ERR(stat, "cudaGraphLaunch failed for the MD step GPU graph");
+
+    // Events recorded during the capture are internal to the graph, so the
+    // completion of the update has to be marked again for the consumers outside it.
+    xUpdatedOnDeviceEvent->markEvent(launchStream_);
+
+    // Work launched later into any of the involved streams depends on the graph
+    forkEvent_.markEvent(launchStream_);
+    for (const DeviceStream* stream : forkedStreams_)
+    {
+        forkEvent_.enqueueWaitEvent(*stream);
+    }
+
+    wallcycle_stop(wcycle_, ewcLAUNCH_GPU);
+}
+
+void MdGpuGraph::Impl::reset()
+{
+    if (graphInstance_ != nullptr)
+    {
+        cudaError_t gmx_used_in_debug stat = cudaGraphExecDestroy(graphInstance_);
+        GMX_ASSERT(stat == cudaSuccess, "cudaGraphExecDestroy failed");
+        graphInstance_ = nullptr;
+    }
+    if (graph_ != nullptr)
+    {
+        cudaError_t gmx_used_in_debug stat = cudaGraphDestroy(graph_);
+        GMX_ASSERT(stat == cudaSuccess, "cudaGraphDestroy failed");
+        graph_ = nullptr;
+    }
+    graphIsCaptured_ = false;
+}
+
+MdGpuGraph::MdGpuGraph(const DeviceStreamManager& deviceStreamManager, gmx_wallcycle* wcycle) :
+    impl_(new Impl(deviceStreamManager, wcycle))
+{
+}
+
+MdGpuGraph::~MdGpuGraph() = default;
+
+void MdGpuGraph::startRecord(GpuEventSynchronizer* xReadyOnDeviceEvent)
+{
+    impl_->startRecord(xReadyOnDeviceEvent);
+}
+
+void MdGpuGraph::endRecord()
+{
+    impl_->endRecord();
+}
+
+void MdGpuGraph::launchGraphMdStep(GpuEventSynchronizer* xUpdatedOnDeviceEvent)
+{
+    impl_->launchGraphMdStep(xUpdatedOnDeviceEvent);
+}
+
+void MdGpuGraph::reset()
+{
+    impl_->reset();
+}
+
+bool MdGpuGraph::graphIsCaptured() const
+{
+    return impl_->graphIsCaptured();
+}
+
+} // namespace gmx
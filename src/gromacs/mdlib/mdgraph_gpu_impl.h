@@ -0,0 +1,101 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Declares the CUDA implementation of the MD step graph.
+ *
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_MDGRAPH_GPU_IMPL_H
+#define GMX_MDLIB_MDGRAPH_GPU_IMPL_H
+
+#include "gmxpre.h"
+
+#include <memory>
+#include <vector>
+
+#include "gromacs/gpu_utils/gpueventsynchronizer.cuh"
+#include "gromacs/mdlib/mdgraph_gpu.h"
+
+namespace gmx
+{
+
+/*! \internal \brief CUDA implementation of the MD step graph. */
+class MdGpuGraph::Impl
+{
+public:
+    //! \copydoc MdGpuGraph::MdGpuGraph
+    Impl(const DeviceStreamManager& deviceStreamManager, gmx_wallcycle* wcycle);
+    ~Impl();
+
+    //! \copydoc MdGpuGraph::startRecord
+    void startRecord(GpuEventSynchronizer* xReadyOnDeviceEvent);
+
+    //! \copydoc MdGpuGraph::endRecord
+    void endRecord();
+
+    //! \copydoc MdGpuGraph::launchGraphMdStep
+    void launchGraphMdStep(GpuEventSynchronizer* xUpdatedOnDeviceEvent);
+
+    //! \copydoc MdGpuGraph::reset
+    void reset();
+
+    //! \copydoc MdGpuGraph::graphIsCaptured
+    bool graphIsCaptured() const { return graphIsCaptured_; }
+
+private:
+    //! Stream in which the capture is started and the graph is launched
+    const DeviceStream& launchStream_;
+    //! The other streams that take part in the step
+    std::vector<const DeviceStream*> forkedStreams_;
+    //! Event to fork the other streams from the launch stream, also after the graph launch
+    GpuEventSynchronizer forkEvent_;
+    //! Events to join the other streams into the launch stream, one per forked stream
+    std::vector<std::unique_ptr<GpuEventSynchronizer>> joinEvents_;
+    //! The captured graph
+    cudaGraph_t graph_ = nullptr;
+    //! The executable instance of the captured graph
+    cudaGraphExec_t graphInstance_ = nullptr;
+    //! Whether a capture is in progress
+    bool isRecording_ = false;
+    //! Whether an executable graph is available
+    bool graphIsCaptured_ = false;
+    //! Wall-clock cycle counter
+    gmx_wallcycle* wcycle_;
+};
+
+} // namespace gmx
+
+#endif
@@ -39,17 +39,30 @@
 
 #include "config.h"
 
+#include <cstdio>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "gromacs/commandline/filenm.h"
+#include "gromacs/coordinateio/outputadaptercontainer.h"
+#include "gromacs/coordinateio/outputadapters/streamframes.h"
 #include "gromacs/domdec/collect.h"
+#include "gromacs/domdec/domdec_network.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/tngio.h"
+#include "gromacs/fileio/trxio.h"
 #include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdlib/trajectory_writing.h"
+#include "gromacs/mdlib/trajectorywriterthread.h"
 #include "gromacs/mdrunutility/handlerestart.h"
 #include "gromacs/mdrunutility/multisim.h"
 #include "gromacs/mdtypes/awh_history.h"
@@ -66,13 +79,130 @@
 #include "gromacs/mdtypes/swaphistory.h"
 #include "gromacs/timing/wallcycle.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/utility/baseversion.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/path.h"
 #include "gromacs/utility/pleasecite.h"
 #include "gromacs/utility/programcontext.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/sysinfo.h"
 
+namespace
+{
+
+/*! \brief Runs the final part of checkpoint writing on a background thread
+ *
+ * Only one checkpoint is finished at a time. Errors are reported as
+ * fatal errors when waiting for the completion.
+ */
+class CheckpointFinisher
+{
+public:
+    ~CheckpointFinisher()
+    {
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+    }
+
+    //! Starts running \p task, which returns an error message or an empty string
+    void start(std::function<std::string()> task)
+    {
+        wait();
+        thread_ = std::thread([this, task]() {
+            try
+            {
+                error_ = task();
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        });
+    }
+
+    //! Waits for the last started task to complete
+    void wait()
+    {
+        if (thread_.joinable())
+        {
+            thread_.join();
+            if (!error_.empty())
+            {
+                gmx_file(error_);
+            }
+        }
+    }
+
+private:
+    //! The thread running the task
+    std::thread thread_;
+    //! The error message of the task
+    std::string error_;
+};
+
+/*! \brief Writes the per-atom state of checkpoints as one file per domain decomposition rank
+ *
+ * This avoids collecting the coordinates, velocities and CG search
+ * directions on the master rank. The main checkpoint file, written by
+ * the master rank, refers to the part files through their base name.
+ * The part files of the two most recent checkpoints are kept, since
+ * these are referred to by the checkpoint file and its _prev backup.
+ */
+class DistributedCheckpointWriter
+{
+public:
+    DistributedCheckpointWriter(const char* checkpointFileName, bool keepAndNumberCheckpointFiles) :
+        directory_(gmx::Path::getParentPath(checkpointFileName)),
+        nameStem_(gmx::Path::stripExtension(gmx::Path::getFilename(checkpointFileName))),
+        keepAndNumberCheckpointFiles_(keepAndNumberCheckpointFiles)
+    {
+    }
+
+    //! Returns the base name of the part files for checkpoints at \p step
+    std::string baseName(int64_t step) const
+    {
+        char sbuf[STEPSTRSIZE];
+
+        return nameStem_ + "_step" + gmx_step_str(step, sbuf);
+    }
+
+    /*! \brief Writes the atom data of this rank to its part file for \p step
+     *
+     * Removes the part file of the third most recent checkpoint,
+     * unless checkpoint files are kept.
+     */
+    void writePart(const gmx_domdec_t* dd, int64_t step, int natomsGlobal, const t_state* localState)
+    {
+        const std::string fn = checkpointAtomDataPartFileName(directory_, baseName(step).c_str(), dd->rank);
+        write_checkpoint_atom_data_part(fn.c_str(), step, dd->rank, dd->nnodes, natomsGlobal,
+                                        dd_local_state_global_atom_indices(dd, localState),
+                                        *localState);
+
+        if (!keepAndNumberCheckpointFiles_)
+        {
+            writtenFiles_.push_back(fn);
+            if (writtenFiles_.size() > c_numCheckpointsToKeep)
+            {
+                std::remove(writtenFiles_.front().c_str());
+                writtenFiles_.pop_front();
+            }
+        }
+    }
+
+private:
+    //! The number of checkpoints referred to by the current and the _prev checkpoint file
+    static constexpr size_t c_numCheckpointsToKeep = 2;
+
+    std::string             directory_;
+    std::string             nameStem_;
+    bool                    keepAndNumberCheckpointFiles_;
+    std::deque<std::string> writtenFiles_;
+};
+
+} // namespace
+
 struct gmx_mdoutf
 {
     t_fileio*                     fp_trn;
@@ -97,6 +227,10 @@ struct gmx_mdoutf
     const gmx::MdModulesNotifier* mdModulesNotifier;
     bool                          simulationsShareState;
     MPI_Comm                      mastersComm;
+    gmx::TrajectoryWriterThread*  writerThread; /* writes TRR and XTC frames, when used */
+    CheckpointFinisher*           checkpointFinisher; /* completes checkpoint writing, when used */
+    DistributedCheckpointWriter*  distributedCheckpointWriter; /* writes per-rank atom data, when used */
+    gmx::OutputAdapterContainer*  frameStreamAdapters; /* stream compressed output frames, when used */
 };
 
 
@@ -129,6 +263,10 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
     of->tng          = nullptr;
     of->tng_low_prec = nullptr;
     of->fp_dhdl      = nullptr;
+    of->writerThread       = nullptr;
+    of->checkpointFinisher = nullptr;
+    of->distributedCheckpointWriter = nullptr;
+    of->frameStreamAdapters         = nullptr;
 
     of->eIntegrator             = ir->eI;
     of->bExpanded               = ir->bExpanded;
@@ -153,13 +291,25 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
 
         filemode = restartWithAppending ? appendMode : writeMode;
 
-        if (EI_DYNAMICS(ir->eI) && ir->nstxout_compressed > 0)
+        if (EI_DYNAMICS(ir->eI)
+            && (ir->nstxout_compressed > 0 || ir->nstvout_compressed > 0
+                || ir->nstfout_compressed > 0))
         {
             const char* filename;
             filename = ftp2fn(efCOMPRESSED, nfile, fnm);
             switch (fn2ftp(filename))
             {
-                case efXTC: of->fp_xtc = open_xtc(filename, filemode); break;
+                case efXTC:
+                    if (ir->nstvout_compressed > 0 || ir->nstfout_compressed > 0)
+                    {
+                        gmx_fatal(FARGS,
+                                  "Compressed output of velocities and/or forces was requested "
+                                  "with nstvout-compressed or nstfout-compressed, but the XTC "
+                                  "format can only store positions. Use the TNG format for the "
+                                  "compressed trajectory instead, e.g. -x traj_comp.tng");
+                    }
+                    of->fp_xtc = open_xtc(filename, filemode);
+                    break;
                 case efTNG:
                     gmx_tng_open(filename, filemode[0], &of->tng_low_prec);
                     if (filemode[0] == 'w')
@@ -183,8 +333,10 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
                 case efTRN:
                     /* If there is no uncompressed coordinate output and
                        there is compressed TNG output write forces
-                       and/or velocities to the TNG file instead. */
-                    if (ir->nstxout != 0 || ir->nstxout_compressed == 0 || !of->tng_low_prec)
+                       and/or velocities to the TNG file instead,
+                       unless those have their own compressed output. */
+                    if (ir->nstxout != 0 || ir->nstxout_compressed == 0 || !of->tng_low_prec
+                        || ir->nstvout_compressed > 0 || ir->nstfout_compressed > 0)
                     {
                         of->fp_trn = gmx_trr_open(filename, filemode);
                     }
@@ -237,10 +389,45 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
             }
         }
 
-        if (ir->nstfout && DOMAINDECOMP(cr))
+        if ((ir->nstfout || ir->nstfout_compressed) && DOMAINDECOMP(cr))
         {
             snew(of->f_global, top_global->natoms);
         }
+
+        /* TNG output is written synchronously, since the frames written
+           depend on the file contents and settings */
+        if (getenv("GMX_ASYNC_TRAJECTORY_OUTPUT") != nullptr && !GMX_FAHCORE && !of->tng
+            && !of->tng_low_prec && (of->fp_trn || of->fp_xtc))
+        {
+            of->writerThread = new gmx::TrajectoryWriterThread(of->fp_trn, of->fp_xtc,
+                                                               of->x_compression_precision);
+        }
+
+        /* Barriers between simulations can not be done from another thread */
+        if (getenv("GMX_ASYNC_CHECKPOINT") != nullptr && !GMX_FAHCORE && !of->simulationsShareState)
+        {
+            of->checkpointFinisher = new CheckpointFinisher;
+        }
+
+        /* Co-located analysis processes can read the compressed output frames from memory */
+        const char* frameStreamFileName = getenv("GMX_FRAME_STREAM");
+        if (frameStreamFileName != nullptr && EI_DYNAMICS(ir->eI) && ir->nstxout_compressed > 0)
+        {
+            of->frameStreamAdapters = new gmx::OutputAdapterContainer(gmx::CoordinateFileFlags::Base);
+            of->frameStreamAdapters->addAdapter(std::make_unique<gmx::StreamFrames>(frameStreamFileName),
+                                                gmx::CoordinateFileFlags::RequireFrameStreaming);
+            if (fplog)
+            {
+                fprintf(fplog, "Streaming compressed output frames to %s\n", frameStreamFileName);
+            }
+        }
+    }
+
+    /* All domain decomposition ranks write their own part of the checkpoint */
+    if (getenv("GMX_DISTRIBUTED_CHECKPOINT") != nullptr && DOMAINDECOMP(cr) && !GMX_FAHCORE)
+    {
+        of->distributedCheckpointWriter = new DistributedCheckpointWriter(
+                opt2fn("-cpo", nfile, fnm), mdrunOptions.checkpointOptions.keepAndNumberCheckpointFiles);
     }
 
     if (bCiteTng)
@@ -278,6 +465,101 @@ static void mpiBarrierBeforeRename(const bool applyMpiBarrierBeforeRename, MPI_C
 #endif
     }
 }
+/*! \brief Syncs and closes the checkpoint file \p fp and moves it to \p fn
+ *
+ * This is the part of checkpoint writing that does not access the
+ * simulation state, so it can run in the background. Frees \p fntemp.
+ *
+ * \returns An error message, empty on success
+ */
+static std::string finishCheckpointWriting(t_fileio*   fp,
+                                           const char* fn,
+                                           char*       fntemp,
+                                           gmx_bool    bNumberAndKeep,
+                                           bool        applyMpiBarrierBeforeRename,
+                                           MPI_Comm    mpiBarrierCommunicator)
+{
+    char        buf[1024];
+    t_fileio*   ret;
+    std::string error;
+
+    /* we really, REALLY, want to make sure to physically write the checkpoint,
+       and all the files it depends on, out to disk. Because we've
+       opened the checkpoint with gmx_fio_open(), it's in our list
+       of open files.  */
+    ret = gmx_fio_all_output_fsync();
+
+    if (ret)
+    {
+        sprintf(buf, "Cannot fsync '%s'; maybe you are out of disk space?", gmx_fio_getname(ret));
+
+        if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
+        {
+            sfree(fntemp);
+            return buf;
+        }
+        else
+        {
+            gmx_warning("%s", buf);
+        }
+    }
+
+    if (gmx_fio_close(fp) != 0)
+    {
+        sfree(fntemp);
+        return "Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?";
+    }
+
+    /* we don't move the checkpoint if the user specified they didn't want it,
+       or if the fsyncs failed */
+#if !GMX_NO_RENAME
+    if (!bNumberAndKeep && !ret)
+    {
+        if (gmx_fexist(fn))
+        {
+            /* Rename the previous checkpoint file */
+            mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+
+            std::strcpy(buf, fn);
+            buf[std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1] = '\0';
+            std::strcat(buf, "_prev");
+            std::strcat(buf, fn + std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1);
+            if (!GMX_FAHCORE)
+            {
+                /* we copy here so that if something goes wrong between now and
+                 * the rename below, there's always a state.cpt.
+                 * If renames are atomic (such as in POSIX systems),
+                 * this copying should be unneccesary.
+                 */
+                gmx_file_copy(fn, buf, FALSE);
+                /* We don't really care if this fails:
+                 * there's already a new checkpoint.
+                 */
+            }
+            else
+            {
+                gmx_file_rename(fn, buf);
+            }
+        }
+
+        /* Rename the checkpoint file from the temporary to the final name */
+        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+
+        if (gmx_file_rename(fntemp, fn) != 0)
+        {
+            error = "Cannot rename checkpoint file; maybe you are out of disk space?";
+        }
+    }
+#else
+    GMX_UNUSED_VALUE(fn);
+    GMX_UNUSED_VALUE(bNumberAndKeep);
+#endif /* GMX_NO_RENAME */
+
+    sfree(fntemp);
+
+    return error;
+}
+
 /*! \brief Write a checkpoint to the filename
  *
  * Appends the _step<step>.cpt with bNumberAndKeep, otherwise moves
@@ -300,13 +582,15 @@ static void write_checkpoint(const char*                     fn,
                              const gmx::MdModulesNotifier&   mdModulesNotifier,
                              gmx::WriteCheckpointDataHolder* modularSimulatorCheckpointData,
                              bool                            applyMpiBarrierBeforeRename,
-                             MPI_Comm                        mpiBarrierCommunicator)
+                             MPI_Comm                        mpiBarrierCommunicator,
+                             CheckpointFinisher*             checkpointFinisher,
+                             int                             numAtomDataParts,
+                             const std::string&              atomDataPartBaseName)
 {
     t_fileio* fp;
     char*     fntemp; /* the temporary checkpoint file name */
     int       npmenodes;
     char      buf[1024], suffix[5 + STEPSTRSIZE], sbuf[STEPSTRSIZE];
-    t_fileio* ret;
 
     if (DOMAINDECOMP(cr))
     {
@@ -389,6 +673,8 @@ static void write_checkpoint(const char*                     fn,
     std::strcpy(headerContents.version, gmx_version());
     std::strcpy(headerContents.fprog, gmx::getProgramContext().fullBinaryPath());
     std::strcpy(headerContents.ftime, timebuf.c_str());
+    headerContents.numAtomDataParts = numAtomDataParts;
+    std::strcpy(headerContents.atomDataPartBaseName, atomDataPartBaseName.c_str());
     if (DOMAINDECOMP(cr))
     {
         copy_ivec(domdecCells, headerContents.dd_nc);
@@ -397,75 +683,22 @@ static void write_checkpoint(const char*                     fn,
     write_checkpoint_data(fp, headerContents, bExpanded, elamstats, state, observablesHistory,
                           mdModulesNotifier, &outputfiles, modularSimulatorCheckpointData);
 
-    /* we really, REALLY, want to make sure to physically write the checkpoint,
-       and all the files it depends on, out to disk. Because we've
-       opened the checkpoint with gmx_fio_open(), it's in our list
-       of open files.  */
-    ret = gmx_fio_all_output_fsync();
-
-    if (ret)
+    if (checkpointFinisher)
     {
-        char buf[STRLEN];
-        sprintf(buf, "Cannot fsync '%s'; maybe you are out of disk space?", gmx_fio_getname(ret));
-
-        if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
-        {
-            gmx_file(buf);
-        }
-        else
-        {
-            gmx_warning("%s", buf);
-        }
-    }
-
-    if (gmx_fio_close(fp) != 0)
-    {
-        gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
+        checkpointFinisher->start([=]() {
+            return finishCheckpointWriting(fp, fn, fntemp, bNumberAndKeep,
+                                           applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+        });
     }
-
-    /* we don't move the checkpoint if the user specified they didn't want it,
-       or if the fsyncs failed */
-#if !GMX_NO_RENAME
-    if (!bNumberAndKeep && !ret)
+    else
     {
-        if (gmx_fexist(fn))
+        const std::string error = finishCheckpointWriting(
+                fp, fn, fntemp, bNumberAndKeep, applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+        if (!error.empty())
         {
-            /* Rename the previous checkpoint file */
-            mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
-
-            std::strcpy(buf, fn);
-            buf[std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1] = '\0';
-            std::strcat(buf, "_prev");
-            std::strcat(buf, fn + std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1);
-            if (!GMX_FAHCORE)
-            {
-                /* we copy here so that if something goes wrong between now and
-                 * the rename below, there's always a state.cpt.
-                 * If renames are atomic (such as in POSIX systems),
-                 * this copying should be unneccesary.
-                 */
-                gmx_file_copy(fn, buf, FALSE);
-                /* We don't really care if this fails:
-                 * there's already a new checkpoint.
-                 */
-            }
-            else
-            {
-                gmx_file_rename(fn, buf);
-            }
-        }
-
-        /* Rename the checkpoint file from the temporary to the final name */
-        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
-
-        if (gmx_file_rename(fntemp, fn) != 0)
-        {
-            gmx_file("Cannot rename checkpoint file; maybe you are out of disk space?");
+            gmx_file(error);
         }
     }
-#endif /* GMX_NO_RENAME */
-
-    sfree(fntemp);
 
 #if GMX_FAHCORE
     /*code for alternate checkpointing scheme.  moved from top of loop over
@@ -478,15 +711,31 @@ static void write_checkpoint(const char*                     fn,
 #endif /* end GMX_FAHCORE block */
 }
 
-void mdoutf_write_checkpoint(gmx_mdoutf_t                    of,
-                             FILE*                           fplog,
-                             const t_commrec*                cr,
-                             int64_t                         step,
-                             double                          t,
-                             t_state*                        state_global,
-                             ObservablesHistory*             observablesHistory,
-                             gmx::WriteCheckpointDataHolder* modularSimulatorCheckpointData)
+/*! \brief Writes the checkpoint file, referring to \p numAtomDataParts separate atom data files
+ *
+ * With \p numAtomDataParts = 0, the checkpoint contains all data.
+ */
+static void writeCheckpointFile(gmx_mdoutf_t                    of,
+                                FILE*                           fplog,
+                                const t_commrec*                cr,
+                                int64_t                         step,
+                                double                          t,
+                                t_state*                        state_global,
+                                ObservablesHistory*             observablesHistory,
+                                gmx::WriteCheckpointDataHolder* modularSimulatorCheckpointData,
+                                int                             numAtomDataParts,
+                                const std::string&              atomDataPartBaseName)
 {
+    if (of->checkpointFinisher)
+    {
+        /* Only one checkpoint is written at a time */
+        of->checkpointFinisher->wait();
+    }
+    if (of->writerThread)
+    {
+        /* The checkpoint stores the positions of, and syncs, all output files */
+        of->writerThread->waitForPendingFrames();
+    }
     fflush_tng(of->tng);
     fflush_tng(of->tng_low_prec);
     /* Write the checkpoint file.
@@ -500,7 +749,141 @@ void mdoutf_write_checkpoint(gmx_mdoutf_t                    of,
                      DOMAINDECOMP(cr) ? cr->dd->nnodes : cr->nnodes, of->eIntegrator,
                      of->simulation_part, of->bExpanded, of->elamstats, step, t, state_global,
                      observablesHistory, *(of->mdModulesNotifier), modularSimulatorCheckpointData,
-                     of->simulationsShareState, of->mastersComm);
+                     of->simulationsShareState, of->mastersComm, of->checkpointFinisher,
+                     numAtomDataParts, atomDataPartBaseName);
+}
+
+void mdoutf_write_checkpoint(gmx_mdoutf_t                    of,
+                             FILE*                           fplog,
+                             const t_commrec*                cr,
+                             int64_t                         step,
+                             double                          t,
+                             t_state*                        state_global,
+                             ObservablesHistory*             observablesHistory,
+                             gmx::WriteCheckpointDataHolder* modularSimulatorCheckpointData)
+{
+    writeCheckpointFile(of, fplog, cr, step, t, state_global, observablesHistory,
+                        modularSimulatorCheckpointData, 0, std::string());
+}
+
+bool mdoutf_checkpoint_atom_data_is_distributed(gmx_mdoutf_t of)
+{
+    return of->distributedCheckpointWriter != nullptr;
+}
+
+/*! \brief Copies the frame data to a frame buffer of the output thread and submits it
+ *
+ * The output thread writes the TRR and XTC frames, so the MD loop
+ * only waits for the copy here.
+ */
+static void submitFrameToWriterThread(gmx_mdoutf_t   of,
+                                      int            mdof_flags,
+                                      int            natoms,
+                                      int64_t        step,
+                                      double         t,
+                                      const t_state* state_local,
+                                      const t_state* state_global,
+                                      const rvec*    f_global)
+{
+    gmx::TrajectoryOutputFrame* frame = of->writerThread->acquireFrame();
+
+    frame->step   = step;
+    frame->time   = t;
+    frame->lambda = state_local->lambda[efptFEP];
+    copy_mat(state_local->box, frame->box);
+
+    frame->writeFullPrecision = (of->fp_trn && (mdof_flags & (MDOF_X | MDOF_V | MDOF_F)));
+    frame->natoms             = natoms;
+    frame->haveX              = frame->writeFullPrecision && (mdof_flags & MDOF_X);
+    frame->haveV              = frame->writeFullPrecision && (mdof_flags & MDOF_V);
+    frame->haveF              = frame->writeFullPrecision && (mdof_flags & MDOF_F);
+    if (frame->haveX)
+    {
+        frame->x.assign(state_global->x.begin(), state_global->x.begin() + natoms);
+    }
+    if (frame->haveV)
+    {
+        frame->v.assign(state_global->v.begin(), state_global->v.begin() + natoms);
+    }
+    if (frame->haveF)
+    {
+        const gmx::RVec* f = reinterpret_cast<const gmx::RVec*>(f_global);
+        frame->f.assign(f, f + natoms);
+    }
+
+    frame->writeCompressed = (of->fp_xtc && (mdof_flags & MDOF_X_COMPRESSED));
+    if (frame->writeCompressed)
+    {
+        if (of->natoms_x_compressed == of->natoms_global)
+        {
+            frame->xCompressed.assign(state_global->x.begin(),
+                                      state_global->x.begin() + of->natoms_global);
+        }
+        else
+        {
+            frame->xCompressed.clear();
+            for (int i = 0; i < of->natoms_global; i++)
+            {
+                if (getGroupType(*of->groups, SimulationAtomGroupType::CompressedPositionOutput, i) == 0)
+                {
+                    frame->xCompressed.push_back(state_global->x[i]);
+                }
+            }
+        }
+    }
+
+    of->writerThread->submitFrame();
+}
+
+/*! \brief Returns the entries of \p v for the atoms in the compressed output groups
+ *
+ * When the compressed output groups do not contain all atoms, the selected
+ * entries are copied to \p buffer and a pointer to its data is returned.
+ */
+static const rvec* selectCompressedOutputAtoms(const gmx_mdoutf*       of,
+                                               const rvec*             v,
+                                               std::vector<gmx::RVec>* buffer)
+{
+    if (of->natoms_x_compressed == of->natoms_global)
+    {
+        return v;
+    }
+
+    buffer->resize(of->natoms_x_compressed);
+    for (int i = 0, j = 0; i < of->natoms_global; i++)
+    {
+        if (getGroupType(*of->groups, SimulationAtomGroupType::CompressedPositionOutput, i) == 0)
+        {
+            copy_rvec(v[i], (*buffer)[j++]);
+        }
+    }
+    return as_rvec_array(buffer->data());
+}
+
+/*! \brief Passes the compressed output positions through the frame streaming adapters
+ *
+ * \p xCompressed has the positions of the compressed output groups only.
+ */
+static void streamCompressedFrame(gmx_mdoutf_t of, int64_t step, double t, const matrix box, rvec* xCompressed)
+{
+    t_trxframe frame;
+    clear_trxframe(&frame, true);
+    frame.natoms = of->natoms_x_compressed;
+    frame.bStep  = true;
+    frame.step   = step;
+    frame.bTime  = true;
+    frame.time   = t;
+    frame.bBox   = true;
+    copy_mat(box, frame.box);
+    frame.bX = true;
+    frame.x  = xCompressed;
+    for (const auto& adapter : of->frameStreamAdapters->getAdapters())
+    {
+        if (adapter)
+        {
+            adapter->processFrame(step, &frame);
+        }
+    }
 }
 
 void mdoutf_write_to_trajectory_files(FILE*                           fplog,
@@ -518,21 +901,35 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
 {
     const rvec* f_global;
 
+    const bool writeDistributedCheckpoint =
+            (mdof_flags & MDOF_CPT) && of->distributedCheckpointWriter != nullptr;
+
     if (DOMAINDECOMP(cr))
     {
-        if (mdof_flags & MDOF_CPT)
+        if ((mdof_flags & MDOF_CPT) && !writeDistributedCheckpoint)
         {
             dd_collect_state(cr->dd, state_local, state_global);
         }
         else
         {
+            if (writeDistributedCheckpoint)
+            {
+                /* Each rank writes its own atom data, the master only needs the rest */
+                dd_collect_state_without_atom_vectors(cr->dd, state_local, state_global);
+                of->distributedCheckpointWriter->writePart(cr->dd, step, natoms, state_local);
+
+                /* The checkpoint file may only refer to completely written parts */
+                int              partIsWritten = 1;
+                std::vector<int> partsAreWritten(MASTER(cr) ? cr->dd->nnodes : 0);
+                dd_gather(cr->dd, sizeof(int), &partIsWritten, partsAreWritten.data());
+            }
             if (mdof_flags & (MDOF_X | MDOF_X_COMPRESSED))
             {
                 auto globalXRef = MASTER(cr) ? state_global->x : gmx::ArrayRef<gmx::RVec>();
                 dd_collect_vec(cr->dd, state_local->ddp_count, state_local->ddp_count_cg_gl,
                                state_local->cg_gl, state_local->x, globalXRef);
             }
-            if (mdof_flags & MDOF_V)
+            if (mdof_flags & (MDOF_V | MDOF_V_COMPRESSED))
             {
                 auto globalVRef = MASTER(cr) ? state_global->v : gmx::ArrayRef<gmx::RVec>();
                 dd_collect_vec(cr->dd, state_local->ddp_count, state_local->ddp_count_cg_gl,
@@ -540,7 +937,7 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
             }
         }
         f_global = of->f_global;
-        if (mdof_flags & MDOF_F)
+        if (mdof_flags & (MDOF_F | MDOF_F_COMPRESSED))
         {
             dd_collect_vec(
                     cr->dd, state_local->ddp_count, state_local->ddp_count_cg_gl, state_local->cg_gl, f_local,
@@ -557,13 +954,23 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
 
     if (MASTER(cr))
     {
-        if (mdof_flags & MDOF_CPT)
+        if (writeDistributedCheckpoint)
+        {
+            writeCheckpointFile(of, fplog, cr, step, t, state_global, observablesHistory,
+                                modularSimulatorCheckpointData, cr->dd->nnodes,
+                                of->distributedCheckpointWriter->baseName(step));
+        }
+        else if (mdof_flags & MDOF_CPT)
         {
             mdoutf_write_checkpoint(of, fplog, cr, step, t, state_global, observablesHistory,
                                     modularSimulatorCheckpointData);
         }
 
-        if (mdof_flags & (MDOF_X | MDOF_V | MDOF_F))
+        if (of->writerThread && (mdof_flags & (MDOF_X | MDOF_V | MDOF_F | MDOF_X_COMPRESSED)))
+        {
+            submitFrameToWriterThread(of, mdof_flags, natoms, step, t, state_local, state_global, f_global);
+        }
+        else if (mdof_flags & (MDOF_X | MDOF_V | MDOF_F))
         {
             const rvec* x = (mdof_flags & MDOF_X) ? state_global->x.rvec_array() : nullptr;
             const rvec* v = (mdof_flags & MDOF_V) ? state_global->v.rvec_array() : nullptr;
@@ -594,7 +1001,25 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
                                state_local->box, natoms, x, v, f);
             }
         }
-        if (mdof_flags & MDOF_X_COMPRESSED)
+
+        /* Velocities and forces are only written to compressed output in TNG format */
+        const bool writeCompressedVOrF =
+                of->tng_low_prec && (mdof_flags & (MDOF_V_COMPRESSED | MDOF_F_COMPRESSED));
+        std::vector<gmx::RVec> vCompressedBuffer;
+        std::vector<gmx::RVec> fCompressedBuffer;
+        const rvec*            vCompressed = nullptr;
+        const rvec*            fCompressed = nullptr;
+        if (writeCompressedVOrF && (mdof_flags & MDOF_V_COMPRESSED))
+        {
+            vCompressed = selectCompressedOutputAtoms(
+                    of, state_global->v.rvec_array(), &vCompressedBuffer);
+        }
+        if (writeCompressedVOrF && (mdof_flags & MDOF_F_COMPRESSED))
+        {
+            fCompressed = selectCompressedOutputAtoms(of, f_global, &fCompressedBuffer);
+        }
+
+        if ((!of->writerThread || of->frameStreamAdapters) && (mdof_flags & MDOF_X_COMPRESSED))
         {
             rvec* xxtc = nullptr;
 
@@ -621,17 +1046,25 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
                     }
                 }
             }
-            if (write_xtc(of->fp_xtc, of->natoms_x_compressed, step, t, state_local->box, xxtc,
-                          of->x_compression_precision)
-                == 0)
+            if (!of->writerThread)
+            {
+                if (write_xtc(of->fp_xtc, of->natoms_x_compressed, step, t, state_local->box, xxtc,
+                              of->x_compression_precision)
+                    == 0)
+                {
+                    gmx_fatal(FARGS,
+                              "XTC error. This indicates you are out of disk space, or a "
+                              "simulation with major instabilities resulting in coordinates "
+                              "that are NaN or too large to be represented in the XTC format.\n");
+                }
+                gmx_fwrite_tng(of->tng_low_prec, TRUE, step, t, state_local->lambda[efptFEP],
+                               state_local->box, of->natoms_x_compressed, xxtc, vCompressed,
+                               fCompressed);
+            }
+            if (of->frameStreamAdapters)
             {
-                gmx_fatal(FARGS,
-                          "XTC error. This indicates you are out of disk space, or a "
-                          "simulation with major instabilities resulting in coordinates "
-                          "that are NaN or too large to be represented in the XTC format.\n");
+                streamCompressedFrame(of, step, t, state_local->box, xxtc);
             }
-            gmx_fwrite_tng(of->tng_low_prec, TRUE, step, t, state_local->lambda[efptFEP],
-                           state_local->box, of->natoms_x_compressed, xxtc, nullptr, nullptr);
             if (of->natoms_x_compressed != of->natoms_global)
             {
                 sfree(xxtc);
@@ -654,7 +1087,7 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
                 gmx_fwrite_tng(of->tng, FALSE, step, t, lambda, box, natoms, nullptr, nullptr, nullptr);
             }
         }
-        if (mdof_flags & (MDOF_BOX_COMPRESSED | MDOF_LAMBDA_COMPRESSED)
+        if ((writeCompressedVOrF || (mdof_flags & (MDOF_BOX_COMPRESSED | MDOF_LAMBDA_COMPRESSED)))
             && !(mdof_flags & (MDOF_X_COMPRESSED)))
         {
             if (of->tng_low_prec)
@@ -669,8 +1102,17 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
                 {
                     lambda = state_local->lambda[efptFEP];
                 }
-                gmx_fwrite_tng(of->tng_low_prec, FALSE, step, t, lambda, box, natoms, nullptr,
-                               nullptr, nullptr);
+                if (writeCompressedVOrF)
+                {
+                    /* Write the velocities and/or forces in the same frame as box and lambda */
+                    gmx_fwrite_tng(of->tng_low_prec, TRUE, step, t, lambda, box,
+                                   of->natoms_x_compressed, nullptr, vCompressed, fCompressed);
+                }
+                else
+                {
+                    gmx_fwrite_tng(of->tng_low_prec, FALSE, step, t, lambda, box, natoms, nullptr,
+                                   nullptr, nullptr);
+                }
             }
         }
 
@@ -698,6 +1140,15 @@ void mdoutf_tng_close(gmx_mdoutf_t of)
 
 void done_mdoutf(gmx_mdoutf_t of)
 {
+    /* Finish the last checkpoint and write the pending frames before closing the files */
+    if (of->checkpointFinisher)
+    {
+        of->checkpointFinisher->wait();
+        delete of->checkpointFinisher;
+    }
+    delete of->writerThread;
+    delete of->distributedCheckpointWriter;
+    delete of->frameStreamAdapters;
     if (of->fp_ene != nullptr)
     {
         done_ener_file(of->fp_ene);
@@ -169,6 +169,13 @@ void mdoutf_write_checkpoint(gmx_mdoutf_t                    of,
                              ObservablesHistory*             observablesHistory,
                              gmx::WriteCheckpointDataHolder* modularSimulatorCheckpointData);
 
+/*! \brief Returns whether the atom data of checkpoints is written by each rank separately
+ *
+ * With distributed checkpoints, x and v are not collected on the master
+ * rank for checkpointing, so the caller needs to collect them when needed.
+ */
+bool mdoutf_checkpoint_atom_data_is_distributed(gmx_mdoutf_t of);
+
 /*! \brief Get the output interval of box size of uncompressed TNG output.
  * Returns 0 if no uncompressed TNG file is open.
  */
@@ -199,5 +206,7 @@ int mdoutf_get_tng_compressed_lambda_output_interval(gmx_mdoutf_t of);
 #define MDOF_LAMBDA (1u << 7u)
 #define MDOF_BOX_COMPRESSED (1u << 8u)
 #define MDOF_LAMBDA_COMPRESSED (1u << 9u)
+#define MDOF_V_COMPRESSED (1u << 10u)
+#define MDOF_F_COMPRESSED (1u << 11u)
 
 #endif
@@ -365,7 +365,23 @@ static void pp_verlet_load(const gmx_mtop_t& mtop,
     *cost_pp *= simd_cycle_factor(bHaveSIMD);
 }
 
-float pme_load_estimate(const gmx_mtop_t& mtop, const t_inputrec& ir, const matrix box)
+/* Returns the number of complex grid points of the PME grid */
+static double pmeComplexGridSize(const t_inputrec& ir)
+{
+    return ir.nkx * ir.nky * int{ (ir.nkz + 1) / 2 };
+}
+
+double pmeFftReferenceCycles(const t_inputrec& ir)
+{
+    double grid = pmeComplexGridSize(ir);
+
+    return c_pme_fft * grid * std::log(grid) / std::log(2.0);
+}
+
+float pme_load_estimate(const gmx_mtop_t&         mtop,
+                        const t_inputrec&         ir,
+                        const matrix              box,
+                        const PmeLoadCalibration& calibration)
 {
     int      nq_tot, nlj_tot;
     gmx_bool bChargePerturbed, bTypePerturbed;
@@ -395,21 +411,22 @@ float pme_load_estimate(const gmx_mtop_t& mtop, const t_inputrec& ir, const matr
     cost_fft    = 0;
     cost_solve  = 0;
 
-    int gridNkzFactor = int{ (ir.nkz + 1) / 2 };
+    const double fftCost = c_pme_fft * calibration.fftCostFactor;
+
     if (EEL_PME(ir.coulombtype))
     {
-        double grid = ir.nkx * ir.nky * gridNkzFactor;
+        double grid = pmeComplexGridSize(ir);
 
         int f = ((ir.efep != efepNO && bChargePerturbed) ? 2 : 1);
         cost_redist += c_pme_redist * nq_tot;
         cost_spread += f * c_pme_spread * nq_tot * gmx::power3(ir.pme_order);
-        cost_fft += f * c_pme_fft * grid * std::log(grid) / std::log(2.0);
+        cost_fft += f * fftCost * grid * std::log(grid) / std::log(2.0);
         cost_solve += f * c_pme_solve * grid * simd_cycle_factor(bHaveSIMD);
     }
 
     if (EVDW_PME(ir.vdwtype))
     {
-        double grid = ir.nkx * ir.nky * gridNkzFactor;
+        double grid = pmeComplexGridSize(ir);
 
         int f = ((ir.efep != efepNO && bTypePerturbed) ? 2 : 1);
         if (ir.ljpme_combination_rule == eljpmeLB)
@@ -419,7 +436,7 @@ float pme_load_estimate(const gmx_mtop_t& mtop, const t_inputrec& ir, const matr
         }
         cost_redist += c_pme_redist * nlj_tot;
         cost_spread += f * c_pme_spread * nlj_tot * gmx::power3(ir.pme_order);
-        cost_fft += f * c_pme_fft * 2 * grid * std::log(grid) / std::log(2.0);
+        cost_fft += f * fftCost * 2 * grid * std::log(grid) / std::log(2.0);
         cost_solve += f * c_pme_solve * grid * simd_cycle_factor(bHaveSIMD);
     }
 
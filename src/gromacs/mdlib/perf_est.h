@@ -50,10 +50,31 @@ void count_bonded_distances(const gmx_mtop_t& mtop, const t_inputrec& ir, double
  * It is allowed to pass NULL for the last two arguments.
  */
 
-float pme_load_estimate(const gmx_mtop_t& mtop, const t_inputrec& ir, const matrix box);
+/* Machine dependent correction factors for the reference costs
+ * used in pme_load_estimate(). A factor of 1 gives the reference cost.
+ */
+struct PmeLoadCalibration
+{
+    /* Factor for the cost of the PME FFTs, which depends strongly on
+     * the FFT library and the cache sizes
+     */
+    double fftCostFactor = 1;
+};
+
+float pme_load_estimate(const gmx_mtop_t&         mtop,
+                        const t_inputrec&         ir,
+                        const matrix              box,
+                        const PmeLoadCalibration& calibration = PmeLoadCalibration());
 /* Returns an estimate for the relative load of the PME mesh calculation
  * in the total force calculation.
  * This estimate is reasonable for recent Intel and AMD x86_64 CPUs.
+ * The reference costs of the model can be corrected with \p calibration.
+ */
+
+double pmeFftReferenceCycles(const t_inputrec& ir);
+/* Returns the cost in cycles on the reference machine of one forward plus
+ * one backward FFT of the Coulomb PME grid, as used in pme_load_estimate().
+ * Dividing measured cycles by this gives PmeLoadCalibration::fftCostFactor.
  */
 
 #endif
@@ -145,6 +145,15 @@ void sum_bin(t_bin* b, const t_commrec* cr)
     gmx_sumd(b->maxreal, b->rbuf, cr);
 }
 
+void start_sum_bin(t_bin* b, const t_commrec* cr, MPI_Request* request)
+{
+    for (int i = b->nreal; (i < b->maxreal); i++)
+    {
+        b->rbuf[i] = 0;
+    }
+    gmx_sumd_start(b->maxreal, b->rbuf, cr, request);
+}
+
 void extract_binr(t_bin* b, int index, int nr, real r[])
 {
     int     i;
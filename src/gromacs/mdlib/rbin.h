@@ -38,6 +38,7 @@
 #define GMX_MDLIB_RBIN_H
 
 #include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/real.h"
 
 struct t_commrec;
@@ -66,6 +67,9 @@ int add_bind(t_bin* b, int nr, const double r[]);
 void sum_bin(t_bin* b, const t_commrec* cr);
 /* Globally sum the reals in the bin */
 
+void start_sum_bin(t_bin* b, const t_commrec* cr, MPI_Request* request);
+/* Start a global sum of the reals in the bin, complete with gmx_sumd_wait() */
+
 void extract_binr(t_bin* b, int index, int nr, real r[]);
 void extract_binr(t_bin* b, int index, gmx::ArrayRef<real> r);
 void extract_bind(t_bin* b, int index, int nr, double r[]);
@@ -0,0 +1,348 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Implements the stochastic dynamics integrator using CUDA
+ *
+ * This file contains the implementation of the leap-frog stochastic dynamics
+ * integrator using CUDA, including class initialization, data-structures management
+ * and GPU kernel. The random numbers are generated with the same counter-based
+ * ThreeFry2x64 function and tabulated normal distribution as on the CPU.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "sd_gpu.h"
+
+#include <cmath>
+
+#include "gromacs/gpu_utils/cudautils.cuh"
+#include "gromacs/gpu_utils/devicebuffer.h"
+#include "gromacs/gpu_utils/vectype_ops.cuh"
+#include "gromacs/math/units.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/random/seed.h"
+#include "gromacs/random/tabulatednormaldistribution.h"
+#include "gromacs/random/threefry_cuda.cuh"
+
+namespace gmx
+{
+
+//! Number of CUDA threads in a block
+constexpr static int c_threadsPerBlock = 256;
+//! Maximum number of threads in a block (for __launch_bounds__)
+constexpr static int c_maxThreadsPerBlock = c_threadsPerBlock;
+
+//! The number of bits of the normal distribution table, the same as for the CPU SD update
+constexpr static int c_normalDistributionTableBits =
+        detail::c_TabulatedNormalDistributionDefaultBits;
+
+/*! \brief Main kernel for the SD integrator.
+ *
+ *  The coordinates and velocities are updated on the GPU. Except for the friction and
+ *  noise part, also saves the intermediate values of the coordinates for further use in
+ *  constraints.
+ *
+ *  Each GPU thread works with a single particle. As on the CPU, the three normally
+ *  distributed numbers for an atom are taken from the first 64 bits of ThreeFry2x64 with
+ *  the step and the global atom index as counter.
+ *
+ * \tparam        updatePart              The part of the SD update to perform.
+ * \tparam        haveMultipleTempGroups  Whether there is more than one T-coupling group.
+ * \param[in]     numAtoms                Total number of atoms.
+ * \param[in,out] gm_x                    Coordinates to update upon integration.
+ * \param[out]    gm_xp                   A copy of the coordinates before the integration.
+ * \param[in,out] gm_v                    Velocities to update.
+ * \param[in]     gm_f                    Atomic forces.
+ * \param[in]     gm_inverseMasses        Reciprocal masses.
+ * \param[in]     dt                      Timestep.
+ * \param[in]     gm_tempScaleGroups      Mapping of atoms into T-coupling groups.
+ * \param[in]     gm_sdConstants          Velocity scaling factor and noise amplitude per group.
+ * \param[in]     gm_globalAtomIndices    Global atom indices, nullptr when equal to local.
+ * \param[in]     gm_normalTable          The tabulated normal distribution.
+ * \param[in]     key                     ThreeFry2x64 key: random seed and random domain.
+ * \param[in]     step                    The MD step.
+ */
+template<SdUpdatePart updatePart, bool haveMultipleTempGroups>
+__launch_bounds__(c_maxThreadsPerBlock) __global__
+        void sd_kernel(const int numAtoms,
+                       float3* __restrict__ gm_x,
+                       float3* __restrict__ gm_xp,
+                       float3* __restrict__ gm_v,
+                       const float3* __restrict__ gm_f,
+                       const float* __restrict__ gm_inverseMasses,
+                       const float dt,
+                       const unsigned short* __restrict__ gm_tempScaleGroups,
+                       const float2* __restrict__ gm_sdConstants,
+                       const int* __restrict__ gm_globalAtomIndices,
+                       const float* __restrict__ gm_normalTable,
+                       const ulonglong2 key,
+                       const int64_t    step);
+
+template<SdUpdatePart updatePart, bool haveMultipleTempGroups>
+__launch_bounds__(c_maxThreadsPerBlock) __global__
+        void sd_kernel(const int numAtoms,
+                       float3* __restrict__ gm_x,
+                       float3* __restrict__ gm_xp,
+                       float3* __restrict__ gm_v,
+                       const float3* __restrict__ gm_f,
+                       const float* __restrict__ gm_inverseMasses,
+                       const float dt,
+                       const unsigned short* __restrict__ gm_tempScaleGroups,
+                       const float2* __restrict__ gm_sdConstants,
+                       const int* __restrict__ gm_globalAtomIndices,
+                       const float* __restrict__ gm_normalTable,
+                       const ulonglong2 key,
+                       const int64_t    step)
+{
+    int threadIndex = blockIdx.x * blockDim.x + threadIdx.x;
+    if (threadIndex < numAtoms)
+    {
+        float3 x  = gm_x[threadIndex];
+        float3 v  = gm_v[threadIndex];
+        float  im = gm_inverseMasses[threadIndex];
+
+        if (updatePart != SdUpdatePart::FrictionAndNoiseOnly)
+        {
+            // As for Leap-Frog, x and xp are swapped: xp gets the coordinates before update.
+            gm_xp[threadIndex] = x;
+        }
+
+        float3 vn = v;
+        if (updatePart != SdUpdatePart::FrictionAndNoiseOnly)
+        {
+            vn += gm_f[threadIndex] * (im * dt);
+        }
+
+        if (updatePart == SdUpdatePart::ForcesOnly)
+        {
+            v = vn;
+            x += v * dt;
+        }
+        else
+        {
+            const int tempGroup = haveMultipleTempGroups ? gm_tempScaleGroups[threadIndex] : 0;
+            const float2 sdConstants = gm_sdConstants[tempGroup];
+
+            const int globalAtomIndex = (gm_globalAtomIndices != nullptr)
+                                                ? gm_globalAtomIndices[threadIndex]
+                                                : threadIndex;
+            const ulonglong2 random =
+                    threeFry2x64(key,
+                                 make_ulonglong2(static_cast<uint64_t>(step),
+                                                 static_cast<uint64_t>(globalAtomIndex)));
+
+            // Three table lookups use the lowest 42 bits, as TabulatedNormalDistribution does
+            constexpr int      c_bits      = c_normalDistributionTableBits;
+            constexpr uint64_t c_tableMask = (1ULL << c_bits) - 1;
+            const float3       noise =
+                    make_float3(gm_normalTable[random.x & c_tableMask],
+                                gm_normalTable[(random.x >> c_bits) & c_tableMask],
+                                gm_normalTable[(random.x >> (2 * c_bits)) & c_tableMask]);
+
+            v = vn * sdConstants.x + noise * (sqrtf(im) * sdConstants.y);
+
+            if (updatePart == SdUpdatePart::FrictionAndNoiseOnly)
+            {
+                // The previous part already updated the positions with a full v*dt term
+                // that must now be half removed.
+                x += (v - vn) * (0.5F * dt);
+            }
+            else
+            {
+                // Here we include half of the friction+noise update of v into the position
+                // update.
+                x += (vn + v) * (0.5F * dt);
+            }
+        }
+
+        gm_v[threadIndex] = v;
+        gm_x[threadIndex] = x;
+    }
+}
+
+/*! \brief Select templated kernel.
+ *
+ * \param[in]  updatePart              The part of the SD update to perform.
+ * \param[in]  haveMultipleTempGroups  Whether there is more than one T-coupling group.
+ *
+ * \returns                        Pointer to CUDA kernel
+ */
+inline auto selectSdKernelPtr(SdUpdatePart updatePart, bool haveMultipleTempGroups)
+{
+    auto kernelPtr = sd_kernel<SdUpdatePart::Combined, false>;
+
+    switch (updatePart)
+    {
+        case SdUpdatePart::ForcesOnly:
+            kernelPtr = sd_kernel<SdUpdatePart::ForcesOnly, false>;
+            break;
+        case SdUpdatePart::FrictionAndNoiseOnly:
+            kernelPtr = haveMultipleTempGroups
+                                ? sd_kernel<SdUpdatePart::FrictionAndNoiseOnly, true>
+                                : sd_kernel<SdUpdatePart::FrictionAndNoiseOnly, false>;
+            break;
+        case SdUpdatePart::Combined:
+            kernelPtr = haveMultipleTempGroups ? sd_kernel<SdUpdatePart::Combined, true>
+                                               : sd_kernel<SdUpdatePart::Combined, false>;
+            break;
+    }
+    return kernelPtr;
+}
+
+void StochasticDynamicsGpu::integrate(DeviceBuffer<float3>       d_x,
+                                      DeviceBuffer<float3>       d_xp,
+                                      DeviceBuffer<float3>       d_v,
+                                      const DeviceBuffer<float3> d_f,
+                                      const real                 dt,
+                                      const int64_t              step,
+                                      const SdUpdatePart         updatePart)
+{
+    ensureNoPendingCudaError("In CUDA version of the SD integrator");
+
+    GMX_ASSERT(numTempScaleValues_ == ssize(h_sdConstants_),
+               "The SD constants should be set for all temperature coupling groups");
+
+    auto kernelPtr = selectSdKernelPtr(updatePart, numTempScaleValues_ > 1);
+
+    // The CPU code passes the seed as int, which is converted to the 64-bit key
+    const ulonglong2 key = make_ulonglong2(static_cast<uint64_t>(seed_),
+                                           static_cast<uint64_t>(RandomDomain::UpdateCoordinates));
+    const int* d_globalAtomIndices = haveGlobalAtomIndices_ ? d_globalAtomIndices_ : nullptr;
+
+    const auto kernelArgs = prepareGpuKernelArguments(
+            kernelPtr, kernelLaunchConfig_, &numAtoms_, &d_x, &d_xp, &d_v, &d_f, &d_inverseMasses_,
+            &dt, &d_tempScaleGroups_, &d_sdConstants_, &d_globalAtomIndices,
+            &d_normalDistributionTable_, &key, &step);
+    launchGpuKernel(kernelPtr, kernelLaunchConfig_, deviceStream_, nullptr, "sd_kernel",
+                    kernelArgs);
+}
+
+StochasticDynamicsGpu::StochasticDynamicsGpu(const DeviceContext& deviceContext,
+                                             const DeviceStream&  deviceStream,
+                                             const int            seed) :
+    deviceContext_(deviceContext),
+    deviceStream_(deviceStream),
+    seed_(seed)
+{
+    changePinningPolicy(&h_sdConstants_, gmx::PinningPolicy::PinnedIfSupported);
+
+    kernelLaunchConfig_.blockSize[0]     = c_threadsPerBlock;
+    kernelLaunchConfig_.blockSize[1]     = 1;
+    kernelLaunchConfig_.blockSize[2]     = 1;
+    kernelLaunchConfig_.sharedMemorySize = 0;
+
+    const auto normalTable =
+            TabulatedNormalDistribution<real, c_normalDistributionTableBits>::makeTable();
+    reallocateDeviceBuffer(&d_normalDistributionTable_, normalTable.size(),
+                           &numNormalDistributionTable_, &numNormalDistributionTableAlloc_,
+                           deviceContext_);
+    copyToDeviceBuffer(&d_normalDistributionTable_, normalTable.data(), 0, normalTable.size(),
+                       deviceStream_, GpuApiCallBehavior::Sync, nullptr);
+}
+
+StochasticDynamicsGpu::~StochasticDynamicsGpu()
+{
+    freeDeviceBuffer(&d_inverseMasses_);
+    freeDeviceBuffer(&d_tempScaleGroups_);
+    freeDeviceBuffer(&d_globalAtomIndices_);
+    freeDeviceBuffer(&d_sdConstants_);
+    freeDeviceBuffer(&d_normalDistributionTable_);
+}
+
+void StochasticDynamicsGpu::set(const int             numAtoms,
+                                const real*           inverseMasses,
+                                const int             numTempScaleValues,
+                                const unsigned short* tempScaleGroups,
+                                ArrayRef<const int>   globalAtomIndices)
+{
+    numAtoms_                       = numAtoms;
+    kernelLaunchConfig_.gridSize[0] = (numAtoms_ + c_threadsPerBlock - 1) / c_threadsPerBlock;
+
+    numTempScaleValues_ = numTempScaleValues;
+
+    reallocateDeviceBuffer(&d_inverseMasses_, numAtoms_, &numInverseMasses_,
+                           &numInverseMassesAlloc_, deviceContext_);
+    copyToDeviceBuffer(&d_inverseMasses_, (float*)inverseMasses, 0, numAtoms_, deviceStream_,
+                       GpuApiCallBehavior::Sync, nullptr);
+
+    // Temperature coupling group map only used if there are more then one group
+    if (numTempScaleValues > 1)
+    {
+        reallocateDeviceBuffer(&d_tempScaleGroups_, numAtoms_, &numTempScaleGroups_,
+                               &numTempScaleGroupsAlloc_, deviceContext_);
+        copyToDeviceBuffer(&d_tempScaleGroups_, tempScaleGroups, 0, numAtoms_, deviceStream_,
+                           GpuApiCallBehavior::Sync, nullptr);
+    }
+
+    // With domain decomposition the random numbers should depend on the global atom index
+    haveGlobalAtomIndices_ = !globalAtomIndices.empty();
+    if (haveGlobalAtomIndices_)
+    {
+        GMX_ASSERT(globalAtomIndices.ssize() >= numAtoms_,
+                   "We need global atom indices for all home atoms");
+        reallocateDeviceBuffer(&d_globalAtomIndices_, numAtoms_, &numGlobalAtomIndices_,
+                               &numGlobalAtomIndicesAlloc_, deviceContext_);
+        copyToDeviceBuffer(&d_globalAtomIndices_, globalAtomIndices.data(), 0, numAtoms_,
+                           deviceStream_, GpuApiCallBehavior::Sync, nullptr);
+    }
+
+    h_sdConstants_.resize(numTempScaleValues_);
+    reallocateDeviceBuffer(&d_sdConstants_, numTempScaleValues_, &numSdConstants_,
+                           &numSdConstantsAlloc_, deviceContext_);
+}
+
+void StochasticDynamicsGpu::updateTemperatureConstants(const t_inputrec& inputRecord)
+{
+    GMX_ASSERT(inputRecord.opts.ngtc == numTempScaleValues_,
+               "The number of temperature coupling groups changed since the last call to set()");
+
+    // This computes the same constants as the CPU SD update, see gmx_stochd_t
+    for (int gt = 0; gt < numTempScaleValues_; gt++)
+    {
+        real em = 1;
+        if (inputRecord.opts.tau_t[gt] > 0)
+        {
+            em = std::exp(-inputRecord.delta_t / inputRecord.opts.tau_t[gt]);
+        }
+        const real kT     = BOLTZ * inputRecord.opts.ref_t[gt];
+        h_sdConstants_[gt] = make_float2(em, std::sqrt(kT * (1 - em * em)));
+    }
+    copyToDeviceBuffer(&d_sdConstants_, h_sdConstants_.data(), 0, numTempScaleValues_,
+                       deviceStream_, GpuApiCallBehavior::Async, nullptr);
+}
+
+} // namespace gmx
@@ -0,0 +1,201 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ *
+ * \brief Declarations for GPU implementation of the stochastic dynamics integrator.
+ *
+ * \ingroup module_mdlib
+ * \inlibraryapi
+ */
+#ifndef GMX_MDLIB_SD_GPU_H
+#define GMX_MDLIB_SD_GPU_H
+
+#include "config.h"
+
+#include <cstdint>
+
+#if GMX_GPU_CUDA
+#    include "gromacs/gpu_utils/devicebuffer.cuh"
+#    include "gromacs/gpu_utils/gputraits.cuh"
+#endif
+
+#include "gromacs/gpu_utils/hostallocator.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/classhelpers.h"
+
+class DeviceContext;
+class DeviceStream;
+struct t_inputrec;
+
+namespace gmx
+{
+
+/*! \brief Sets the part of the SD update to perform
+ *
+ *  This is needed to template the kernel
+ *  \todo Unify with the SDUpdate enum in the CPU update module
+ */
+enum class SdUpdatePart
+{
+    ForcesOnly,           //!< Only the force contribution, before constraining
+    FrictionAndNoiseOnly, //!< Only the friction and noise, after constraining
+    Combined              //!< Both contributions, used without constraints
+};
+
+class StochasticDynamicsGpu
+{
+
+public:
+    /*! \brief Constructor.
+     *
+     * \param[in] deviceContext  Device context (dummy in CUDA).
+     * \param[in] deviceStream   Device stream to use.
+     * \param[in] seed           The random seed, ld-seed from the input record.
+     */
+    StochasticDynamicsGpu(const DeviceContext& deviceContext,
+                          const DeviceStream&  deviceStream,
+                          int                  seed);
+    ~StochasticDynamicsGpu();
+
+    /*! \brief Integrate
+     *
+     * Performs (part of) an SD update step of the coordinates and velocities on the GPU.
+     * The random numbers are drawn with the step and the global atom index as counters,
+     * so they are identical to those of the CPU implementation. As for Leap-Frog, the
+     * current coordinates are saved to \p d_xp for constraints, except for the friction
+     * and noise part, which updates the constrained coordinates once more.
+     *
+     * With constraints, the update is split in two parts, with constraining after each.
+     * For details, see Goga2012.
+     *
+     * \param[in,out] d_x         Coordinates to update
+     * \param[out]    d_xp        Place to save the values of initial coordinates coordinates to.
+     * \param[in,out] d_v         Velocities (will be updated).
+     * \param[in]     d_f         Forces.
+     * \param[in]     dt          Timestep.
+     * \param[in]     step        The MD step, used as counter for the random numbers.
+     * \param[in]     updatePart  Which part of the update to perform.
+     */
+    void integrate(DeviceBuffer<float3>       d_x,
+                   DeviceBuffer<float3>       d_xp,
+                   DeviceBuffer<float3>       d_v,
+                   const DeviceBuffer<float3> d_f,
+                   real                       dt,
+                   int64_t                    step,
+                   SdUpdatePart               updatePart);
+
+    /*! \brief Set the integrator
+     *
+     * Allocates memory for inverse masses, temperature coupling groups and global atom
+     * indices and copies them to the GPU.
+     *
+     * \param[in] numAtoms            Number of atoms in the system.
+     * \param[in] inverseMasses       Inverse masses of atoms.
+     * \param[in] numTempScaleValues  Number of temperature coupling groups.
+     * \param[in] tempScaleGroups     Maps the atom index to temperature coupling group.
+     * \param[in] globalAtomIndices   Global atom indices, empty without domain decomposition.
+     */
+    void set(int                   numAtoms,
+             const real*           inverseMasses,
+             int                   numTempScaleValues,
+             const unsigned short* tempScaleGroups,
+             ArrayRef<const int>   globalAtomIndices);
+
+    /*! \brief Update the friction and noise constants of the temperature coupling groups
+     *
+     * This needs to be called when the reference temperatures change, e.g. with
+     * simulated annealing.
+     *
+     * \param[in] inputRecord  Input record with the coupling time and reference temperatures.
+     */
+    void updateTemperatureConstants(const t_inputrec& inputRecord);
+
+private:
+    //! GPU context object
+    const DeviceContext& deviceContext_;
+    //! GPU stream
+    const DeviceStream& deviceStream_;
+    //! GPU kernel launch config
+    KernelLaunchConfig kernelLaunchConfig_;
+    //! Number of atoms
+    int numAtoms_ = 0;
+    //! The random seed
+    int seed_;
+
+    //! 1/mass for all atoms (GPU)
+    DeviceBuffer<float> d_inverseMasses_ = nullptr;
+    //! Current size of the reciprocal masses array
+    int numInverseMasses_ = -1;
+    //! Maximum size of the reciprocal masses array
+    int numInverseMassesAlloc_ = -1;
+
+    //! Number of temperature coupling groups
+    int numTempScaleValues_ = 0;
+    //! Array that maps atom index onto the temperature coupling group
+    DeviceBuffer<unsigned short> d_tempScaleGroups_ = nullptr;
+    //! Current size of the temperature coupling groups array
+    int numTempScaleGroups_ = -1;
+    //! Maximum size of the temperature coupling groups array
+    int numTempScaleGroupsAlloc_ = -1;
+
+    //! Whether the global atom indices differ from the local ones
+    bool haveGlobalAtomIndices_ = false;
+    //! Global atom indices, used as counter for the random numbers
+    DeviceBuffer<int> d_globalAtomIndices_ = nullptr;
+    //! Current size of the global atom indices array
+    int numGlobalAtomIndices_ = -1;
+    //! Maximum size of the global atom indices array
+    int numGlobalAtomIndicesAlloc_ = -1;
+
+    //! Per temperature coupling group velocity scaling factor exp(-dt/tau-t) and noise amplitude
+    gmx::HostVector<float2> h_sdConstants_;
+    //! Device-side friction and noise constants
+    DeviceBuffer<float2> d_sdConstants_ = nullptr;
+    //! Current size of the friction and noise constants array
+    int numSdConstants_ = -1;
+    //! Maximum size of the friction and noise constants array
+    int numSdConstantsAlloc_ = -1;
+
+    //! The tabulated normal distribution, identical to the CPU one
+    DeviceBuffer<float> d_normalDistributionTable_ = nullptr;
+    //! Current size of the normal distribution table
+    int numNormalDistributionTable_ = -1;
+    //! Maximum size of the normal distribution table
+    int numNormalDistributionTableAlloc_ = -1;
+};
+
+} // namespace gmx
+
+#endif
@@ -366,6 +366,33 @@ void settle_proj(const SettleData&    settled,
 }
 
 
+/*! \brief Tag type for SETTLE without periodic boundary conditions
+ *
+ * Without PBC, or when all waters are whole in the local state,
+ * as with DD with update groups, this avoids the cost of the PBC
+ * arithmetic, which is a significant part of the SIMD SETTLE work.
+ */
+struct SettleNoPbc
+{
+};
+
+//! Returns the distance vector \p dx = \p x1 - \p x2 without PBC
+template<typename T>
+static inline void gmx_simdcall settleDx(SettleNoPbc /* pbc */, const T* x1, const T* x2, T* dx)
+{
+    for (int d = 0; d < DIM; d++)
+    {
+        dx[d] = x1[d] - x2[d];
+    }
+}
+
+//! Returns the distance vector \p dx = \p x1 - \p x2 with PBC
+template<typename T, typename TypePbc>
+static inline void gmx_simdcall settleDx(TypePbc pbc, const T* x1, const T* x2, T* dx)
+{
+    pbc_dx_aiuc(pbc, x1, x2, dx);
+}
+
 /*! \brief The actual settle code, templated for real/SimdReal and for optimization */
 template<typename T, typename TypeBool, int packSize, typename TypePbc, bool bCorrectVelocity, bool bCalcVirial>
 static void settleTemplate(const SettleData& settled,
@@ -449,13 +476,13 @@ static void settleTemplate(const SettleData& settled,
         T dist21[DIM], dist31[DIM];
         T doh2[DIM], doh3[DIM];
 
-        pbc_dx_aiuc(pbc, x_hw2, x_ow1, dist21);
+        settleDx(pbc, x_hw2, x_ow1, dist21);
 
-        pbc_dx_aiuc(pbc, x_hw3, x_ow1, dist31);
+        settleDx(pbc, x_hw3, x_ow1, dist31);
 
-        pbc_dx_aiuc(pbc, xprime_hw2, xprime_ow1, doh2);
+        settleDx(pbc, xprime_hw2, xprime_ow1, doh2);
 
-        pbc_dx_aiuc(pbc, xprime_hw3, xprime_ow1, doh3);
+        settleDx(pbc, xprime_hw3, xprime_ow1, doh3);
         /* 4 * 18 flops (would be 4 * 3 without PBC) */
 
         /* Note that we completely avoid computing the center of mass and
@@ -762,37 +789,43 @@ void csettle(const SettleData&               settled,
     real*       xprimePtr = as_rvec_array(xprime.paddedArrayRef().data())[0];
     real*       vPtr      = as_rvec_array(v.paddedArrayRef().data())[0];
 
+    const bool usePbc = (pbc != nullptr && pbc->pbcType != PbcType::No);
+
 #if GMX_SIMD_HAVE_REAL
     if (settled.useSimd())
     {
-        /* Convert the pbc struct for SIMD */
-        alignas(GMX_SIMD_ALIGNMENT) real pbcSimd[9 * GMX_SIMD_REAL_WIDTH];
-        set_pbc_simd(pbc, pbcSimd);
+        if (usePbc)
+        {
+            /* Convert the pbc struct for SIMD */
+            alignas(GMX_SIMD_ALIGNMENT) real pbcSimd[9 * GMX_SIMD_REAL_WIDTH];
+            set_pbc_simd(pbc, pbcSimd);
 
-        settleTemplateWrapper<SimdReal, SimdBool, GMX_SIMD_REAL_WIDTH, const real*>(
-                settled, nthread, thread, pbcSimd, xPtr, xprimePtr, invdt, vPtr, bCalcVirial,
-                vir_r_m_dr, bErrorHasOccurred);
+            settleTemplateWrapper<SimdReal, SimdBool, GMX_SIMD_REAL_WIDTH, const real*>(
+                    settled, nthread, thread, pbcSimd, xPtr, xprimePtr, invdt, vPtr, bCalcVirial,
+                    vir_r_m_dr, bErrorHasOccurred);
+        }
+        else
+        {
+            settleTemplateWrapper<SimdReal, SimdBool, GMX_SIMD_REAL_WIDTH, SettleNoPbc>(
+                    settled, nthread, thread, SettleNoPbc(), xPtr, xprimePtr, invdt, vPtr,
+                    bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
+        }
     }
     else
 #endif
     {
-        /* This construct is needed because pbc_dx_aiuc doesn't accept pbc=NULL */
-        t_pbc        pbcNo;
-        const t_pbc* pbcNonNull;
-
-        if (pbc != nullptr)
+        if (usePbc)
         {
-            pbcNonNull = pbc;
+            settleTemplateWrapper<real, bool, 1, const t_pbc*>(
+                    settled, nthread, thread, pbc, &xPtr[0], &xprimePtr[0], invdt, &vPtr[0],
+                    bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
         }
         else
         {
-            set_pbc(&pbcNo, PbcType::No, nullptr);
-            pbcNonNull = &pbcNo;
+            settleTemplateWrapper<real, bool, 1, SettleNoPbc>(
+                    settled, nthread, thread, SettleNoPbc(), &xPtr[0], &xprimePtr[0], invdt,
+                    &vPtr[0], bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
         }
-
-        settleTemplateWrapper<real, bool, 1, const t_pbc*>(settled, nthread, thread, pbcNonNull,
-                                                           &xPtr[0], &xprimePtr[0], invdt, &vPtr[0],
-                                                           bCalcVirial, vir_r_m_dr, bErrorHasOccurred);
     }
 }
 
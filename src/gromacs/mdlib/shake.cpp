@@ -356,6 +356,317 @@ void cshake(const int            iatom[],
     *nerror = error;
 }
 
+namespace
+{
+
+/*! \brief Adds to \p atomDisplacement the displacements that multiplier updates \p update cause
+ *
+ * Atom i of constraint l moves by scale * invmass[i] * update[l] * rij[l], atom j in the
+ * opposite direction.
+ */
+void addAtomDisplacements(const int            iatom[],
+                          int                  ncon,
+                          ArrayRef<const RVec> rij,
+                          ArrayRef<const real> update,
+                          real                 scale,
+                          const real           invmass[],
+                          ArrayRef<RVec>       atomDisplacement)
+{
+    for (int ll = 0; ll < ncon; ll++)
+    {
+        const int  i   = iatom[3 * ll + 1];
+        const int  j   = iatom[3 * ll + 2];
+        const real fac = scale * update[ll];
+        for (int d = 0; d < DIM; d++)
+        {
+            atomDisplacement[i][d] += invmass[i] * fac * rij[ll][d];
+            atomDisplacement[j][d] -= invmass[j] * fac * rij[ll][d];
+        }
+    }
+}
+
+//! Clears the displacements of all atoms in the \p ncon constraints in \p iatom
+void clearAtomDisplacements(const int iatom[], int ncon, ArrayRef<RVec> atomDisplacement)
+{
+    for (int ll = 0; ll < ncon; ll++)
+    {
+        clear_rvec(atomDisplacement[iatom[3 * ll + 1]]);
+        clear_rvec(atomDisplacement[iatom[3 * ll + 2]]);
+    }
+}
+
+/*! \brief Computes the product of the constraint Jacobian with \p z in \p y
+ *
+ * Element k of the Jacobian times \p z is half the change of the squared length of
+ * constraint k, to first order, when the multipliers are changed by \p z. The product
+ * is computed without setting up the matrix, by going through the atom displacements.
+ */
+void multiplyByJacobian(const int            iatom[],
+                        int                  ncon,
+                        ArrayRef<const RVec> r,
+                        ArrayRef<const RVec> rij,
+                        ArrayRef<const real> z,
+                        const real           invmass[],
+                        ArrayRef<RVec>       atomDisplacement,
+                        ArrayRef<real>       y)
+{
+    addAtomDisplacements(iatom, ncon, rij, z, 1.0_real, invmass, atomDisplacement);
+    for (int ll = 0; ll < ncon; ll++)
+    {
+        rvec dr;
+        rvec_sub(atomDisplacement[iatom[3 * ll + 1]], atomDisplacement[iatom[3 * ll + 2]], dr);
+        y[ll] = iprod(r[ll], dr);
+    }
+    clearAtomDisplacements(iatom, ncon, atomDisplacement);
+}
+
+//! Returns the inner product of \p a and \p b
+real innerProduct(ArrayRef<const real> a, ArrayRef<const real> b)
+{
+    real sum = 0;
+    for (index i = 0; i < a.ssize(); i++)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/*! \brief Approximately solves the Jacobian system for the multiplier update
+ *
+ * Uses Jacobi-preconditioned BiCGSTAB, stopped at a modest relative residual,
+ * since the outer Newton iteration only needs an approximate solution.
+ * When BiCGSTAB breaks down, the update obtained so far is kept;
+ * the first update is at least the preconditioned right-hand side,
+ * which equals a Jacobi variant of a SHAKE iteration.
+ */
+void solveJacobianSystem(const int            iatom[],
+                         int                  ncon,
+                         const real           invmass[],
+                         ArrayRef<const RVec> rij,
+                         ShakeNewtonData*     nd)
+{
+    // Maximum number of BiCGSTAB iterations per Newton iteration
+    constexpr int c_maxKrylovIterations = 20;
+    // Relative residual at which BiCGSTAB stops
+    constexpr real c_krylovTolerance = 1e-3;
+
+    ArrayRef<const RVec> r        = nd->r;
+    ArrayRef<const real> diagonal = nd->diagonal;
+    ArrayRef<real>       x        = nd->update;
+    ArrayRef<real>       res      = nd->residual;
+    ArrayRef<real>       res0     = nd->shadowResidual;
+    ArrayRef<real>       p        = nd->p;
+    ArrayRef<real>       pPrec    = nd->pPrec;
+    ArrayRef<real>       v        = nd->v;
+    ArrayRef<real>       s        = nd->s;
+    ArrayRef<real>       sPrec    = nd->sPrec;
+    ArrayRef<real>       t        = nd->t;
+
+    for (int ll = 0; ll < ncon; ll++)
+    {
+        x[ll] = nd->rhs[ll] / diagonal[ll];
+        v[ll] = 0;
+        p[ll] = 0;
+    }
+    multiplyByJacobian(iatom, ncon, r, rij, x, invmass, nd->atomDisplacement, t);
+    for (int ll = 0; ll < ncon; ll++)
+    {
+        res[ll]  = nd->rhs[ll] - t[ll];
+        res0[ll] = res[ll];
+    }
+    const real tolerance2 = gmx::square(c_krylovTolerance) * innerProduct(nd->rhs, nd->rhs);
+
+    real rho   = 1;
+    real alpha = 1;
+    real omega = 1;
+    for (int iter = 0; iter < c_maxKrylovIterations && innerProduct(res, res) > tolerance2; iter++)
+    {
+        const real rhoNew = innerProduct(res0, res);
+        if (rhoNew == 0 || omega == 0)
+        {
+            break;
+        }
+        const real beta = (rhoNew / rho) * (alpha / omega);
+        rho             = rhoNew;
+        for (int ll = 0; ll < ncon; ll++)
+        {
+            p[ll]     = res[ll] + beta * (p[ll] - omega * v[ll]);
+            pPrec[ll] = p[ll] / diagonal[ll];
+        }
+        multiplyByJacobian(iatom, ncon, r, rij, pPrec, invmass, nd->atomDisplacement, v);
+        const real res0DotV = innerProduct(res0, v);
+        if (res0DotV == 0)
+        {
+            break;
+        }
+        alpha = rho / res0DotV;
+        for (int ll = 0; ll < ncon; ll++)
+        {
+            s[ll]     = res[ll] - alpha * v[ll];
+            sPrec[ll] = s[ll] / diagonal[ll];
+        }
+        multiplyByJacobian(iatom, ncon, r, rij, sPrec, invmass, nd->atomDisplacement, t);
+        const real tDotT = innerProduct(t, t);
+        omega            = (tDotT > 0 ? innerProduct(t, s) / tDotT : 0);
+        for (int ll = 0; ll < ncon; ll++)
+        {
+            x[ll] += alpha * pPrec[ll] + omega * sPrec[ll];
+            res[ll] = s[ll] - omega * t[ll];
+        }
+    }
+}
+
+/*! \brief Moves the atoms and the multipliers along \p scale times the last Newton update
+ *
+ * The atom displacements are applied atom by atom and cleared right away,
+ * so atoms shared by several constraints are moved only once.
+ */
+void applyNewtonStep(const int            iatom[],
+                     int                  ncon,
+                     ArrayRef<const RVec> rij,
+                     real                 scale,
+                     const real           invmass[],
+                     ArrayRef<RVec>       positions,
+                     ArrayRef<real>       scaled_lagrange_multiplier,
+                     ShakeNewtonData*     nd)
+{
+    ArrayRef<RVec> atomDisplacement = nd->atomDisplacement;
+    addAtomDisplacements(iatom, ncon, rij, nd->update, scale, invmass, atomDisplacement);
+    for (int ll = 0; ll < ncon; ll++)
+    {
+        scaled_lagrange_multiplier[ll] += scale * nd->update[ll];
+        for (int a = 1; a < 3; a++)
+        {
+            const int atom = iatom[3 * ll + a];
+            rvec_inc(positions[atom], atomDisplacement[atom]);
+            clear_rvec(atomDisplacement[atom]);
+        }
+    }
+}
+
+} // namespace
+
+/*! \brief SHAKE solving for all Lagrange multipliers of a block at once
+ *
+ * Instead of updating the multipliers one constraint at a time, as cshake()
+ * does, each iteration takes a Newton step for all constraints of the block
+ * simultaneously. The linear system with the constraint Jacobian is solved
+ * approximately with BiCGSTAB, without setting up the matrix. All loops run over
+ * independent constraints, apart from the scatter of atom displacements, so
+ * they vectorize well. Newton converges quadratically and is independent of
+ * the constraint order, so tight tolerances need far fewer iterations over
+ * coupled constraints than cshake(), as for all-bonds constraints in
+ * free-energy calculations.
+ *
+ * Far from the solution a full Newton step can overshoot. When a step increases
+ * the largest constraint deviation, or turns a constraint by 90 degrees or more,
+ * half of it is taken back, repeatedly if needed.
+ *
+ * The convergence criterion, the error check and the scaling of the
+ * multipliers are the same as in cshake().
+ */
+void cshakeNewton(const int            iatom[],
+                  int                  ncon,
+                  int*                 nnit,
+                  int                  maxnit,
+                  ArrayRef<const real> constraint_distance_squared,
+                  ArrayRef<RVec>       positions,
+                  const t_pbc*         pbc,
+                  ArrayRef<const RVec> initial_displacements,
+                  const real           invmass[],
+                  ArrayRef<const real> distance_squared_tolerance,
+                  ArrayRef<real>       scaled_lagrange_multiplier,
+                  ShakeNewtonData*     nd,
+                  int*                 nerror)
+{
+    const real mytol = 1e-10;
+    // The number of times a step can be halved before giving up on it
+    const int maxNumStepHalvings = 10;
+
+    int maxAtom = -1;
+    for (int ll = 0; ll < ncon; ll++)
+    {
+        maxAtom = std::max(maxAtom, std::max(iatom[3 * ll + 1], iatom[3 * ll + 2]));
+    }
+    if (gmx::ssize(nd->atomDisplacement) <= maxAtom)
+    {
+        nd->atomDisplacement.resize(maxAtom + 1, { 0, 0, 0 });
+    }
+    for (auto* vec : { &nd->diagonal, &nd->update, &nd->rhs, &nd->residual, &nd->shadowResidual,
+                       &nd->p, &nd->pPrec, &nd->v, &nd->s, &nd->sPrec, &nd->t })
+    {
+        vec->resize(ncon);
+    }
+    nd->r.resize(ncon);
+    ArrayRef<RVec> r = nd->r;
+
+    int  error            = 0;
+    bool converged        = false;
+    real previousMaxError = 0;
+    real stepLength       = 0;
+    int  numStepHalvings  = 0;
+    int  nit;
+    for (nit = 0; nit < maxnit && !converged && error == 0; nit++)
+    {
+        real maxError         = 0;
+        int  firstNonPositive = 0;
+        for (int ll = 0; ll < ncon; ll++)
+        {
+            const int i = iatom[3 * ll + 1];
+            const int j = iatom[3 * ll + 2];
+            if (pbc)
+            {
+                pbc_dx(pbc, positions[i], positions[j], r[ll]);
+            }
+            else
+            {
+                rvec_sub(positions[i], positions[j], r[ll]);
+            }
+            const real diff = constraint_distance_squared[ll] - norm2(r[ll]);
+            maxError        = std::max(maxError, std::abs(diff) * distance_squared_tolerance[ll]);
+            // Element ll of the Jacobian times an update gives half the change in squared length
+            nd->rhs[ll] = 0.5_real * diff;
+
+            const real r_dot_r_prime = iprod(initial_displacements[ll], r[ll]);
+            if (r_dot_r_prime < constraint_distance_squared[ll] * mytol && firstNonPositive == 0)
+            {
+                firstNonPositive = ll + 1;
+            }
+            nd->diagonal[ll] = (invmass[i] + invmass[j]) * r_dot_r_prime;
+        }
+        converged = (maxError <= 1.0_real);
+        if (converged)
+        {
+            continue;
+        }
+
+        if (stepLength > 0 && (maxError > previousMaxError || firstNonPositive != 0)
+            && numStepHalvings < maxNumStepHalvings)
+        {
+            // The last step made things worse, take half of it back
+            stepLength *= 0.5_real;
+            applyNewtonStep(iatom, ncon, initial_displacements, -stepLength, invmass, positions,
+                            scaled_lagrange_multiplier, nd);
+            numStepHalvings++;
+            continue;
+        }
+        if (firstNonPositive != 0)
+        {
+            error = firstNonPositive;
+            continue;
+        }
+
+        solveJacobianSystem(iatom, ncon, invmass, initial_displacements, nd);
+        previousMaxError = maxError;
+        stepLength       = 1;
+        numStepHalvings  = 0;
+        applyNewtonStep(iatom, ncon, initial_displacements, stepLength, invmass, positions,
+                        scaled_lagrange_multiplier, nd);
+    }
+    *nnit   = nit;
+    *nerror = error;
+}
+
 //! Implements RATTLE (ie. SHAKE for velocity verlet integrators)
 static void crattle(const int            iatom[],
                     int                  ncon,
@@ -502,9 +813,18 @@ static int vec_shakef(FILE*                     fplog,
     switch (econq)
     {
         case ConstraintVariable::Positions:
-            cshake(iatom, ncon, &nit, maxnit, constraint_distance_squared, prime, pbc, rij,
-                   half_of_reduced_mass, omega, invmass, distance_squared_tolerance,
-                   scaled_lagrange_multiplier, &error);
+            if (shaked->useNewtonSolver)
+            {
+                cshakeNewton(iatom, ncon, &nit, maxnit, constraint_distance_squared, prime, pbc,
+                             rij, invmass, distance_squared_tolerance, scaled_lagrange_multiplier,
+                             &shaked->newtonData, &error);
+            }
+            else
+            {
+                cshake(iatom, ncon, &nit, maxnit, constraint_distance_squared, prime, pbc, rij,
+                       half_of_reduced_mass, omega, invmass, distance_squared_tolerance,
+                       scaled_lagrange_multiplier, &error);
+            }
             break;
         case ConstraintVariable::Velocities:
             crattle(iatom, ncon, &nit, maxnit, constraint_distance_squared, prime, rij,
@@ -62,6 +62,23 @@ class ArrayRef;
 
 enum class ConstraintVariable : int;
 
+/*! \libinternal
+ * \brief Work arrays for the Newton solver of SHAKE, one element per constraint unless noted
+ */
+struct ShakeNewtonData
+{
+    //! The current constraint vectors
+    std::vector<RVec> r;
+    //! The diagonal of the Jacobian, used as preconditioner
+    std::vector<real> diagonal;
+    //! The update of the scaled Lagrange multipliers in the current Newton iteration
+    std::vector<real> update;
+    //! Right-hand side and Krylov vectors for BiCGSTAB
+    std::vector<real> rhs, residual, shadowResidual, p, pPrec, v, s, sPrec, t;
+    //! Displacement of each atom, kept zero between uses, one element per atom
+    std::vector<RVec> atomDisplacement;
+};
+
 /*! \libinternal
  * \brief Working data for the SHAKE algorithm
  */
@@ -92,6 +109,10 @@ struct shakedata
      * Value is -2 * eta from p. 336 of the paper, divided by the
      * constraint distance. */
     std::vector<real> scaled_lagrange_multiplier;
+    //! Whether to solve for all positional constraints of a block at once, see cshakeNewton()
+    bool useNewtonSolver = false;
+    //! Work arrays for the Newton solver
+    ShakeNewtonData newtonData;
 };
 
 //! Make SHAKE blocks when not using DD.
@@ -143,6 +164,25 @@ void cshake(const int            iatom[],
             ArrayRef<real>       scaled_lagrange_multiplier,
             int*                 nerror);
 
+/*! \brief SHAKE solving for all Lagrange multipliers of a block at once
+ *
+ * Has the same arguments as cshake(), apart from the over-relaxation factor,
+ * plus work arrays, and produces the same output.
+ */
+void cshakeNewton(const int            iatom[],
+                  int                  ncon,
+                  int*                 nnit,
+                  int                  maxnit,
+                  ArrayRef<const real> constraint_distance_squared,
+                  ArrayRef<RVec>       positions,
+                  const t_pbc*         pbc,
+                  ArrayRef<const RVec> initial_displacements,
+                  const real           invmass[],
+                  ArrayRef<const real> distance_squared_tolerance,
+                  ArrayRef<real>       scaled_lagrange_multiplier,
+                  ShakeNewtonData*     newtonData,
+                  int*                 nerror);
+
 } // namespace gmx
 
 #endif
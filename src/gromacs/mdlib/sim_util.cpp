@@ -425,6 +425,39 @@ static void do_nb_verlet(t_forcerec*                fr,
     nbv->dispatchNonbondedKernel(ilocality, *ic, stepWork, clearF, *fr, enerd, nrnb);
 }
 
+/*! \brief Computes the local and non-local non-bonded interactions on the CPU
+ *
+ * Compared to two calls to do_nb_verlet(), this computes both localities
+ * in a single OpenMP parallel region.
+ */
+static void do_nb_verlet_local_and_nonlocal_cpu(t_forcerec*                fr,
+                                                const interaction_const_t* ic,
+                                                gmx_enerdata_t*            enerd,
+                                                const StepWorkload&        stepWork,
+                                                const int                  clearF,
+                                                const int64_t              step,
+                                                t_nrnb*                    nrnb,
+                                                gmx_wallcycle_t            wcycle)
+{
+    if (!stepWork.computeNonbondedForces)
+    {
+        /* skip non-bonded calculation */
+        return;
+    }
+
+    nonbonded_verlet_t* nbv = fr->nbv.get();
+
+    if (nbv->isDynamicPruningStepCpu(step))
+    {
+        wallcycle_sub_start(wcycle, ewcsNONBONDED_PRUNING);
+        nbv->dispatchPruneKernelCpu(InteractionLocality::Local, fr->shift_vec);
+        nbv->dispatchPruneKernelCpu(InteractionLocality::NonLocal, fr->shift_vec);
+        wallcycle_sub_stop(wcycle, ewcsNONBONDED_PRUNING);
+    }
+
+    nbv->dispatchLocalAndNonlocalNonbondedKernelCpu(*ic, stepWork, clearF, *fr, enerd, nrnb);
+}
+
 static inline void clearRVecs(ArrayRef<RVec> v, const bool useOpenmpThreading)
 {
     int nth = gmx_omp_nthreads_get_simple_rvec_task(emntDefault, v.ssize());
@@ -639,7 +672,7 @@ static void computeSpecialForces(FILE*                          fplog,
         if (mtsLevel == 0 || stepWork.computeSlowForces)
         {
             const bool needForeignEnergyDifferences = awh->needForeignEnergyDifferences(step);
-            std::vector<double> foreignLambdaDeltaH, foreignLambdaDhDl;
+            ArrayRef<const double> foreignLambdaDeltaH, foreignLambdaDhDl;
             if (needForeignEnergyDifferences)
             {
                 enerd->foreignLambdaTerms.finalizePotentialContributions(enerd->dvdl_lin, lambda,
@@ -921,6 +954,22 @@ static StepWorkload setupStepWorkload(const int                     legacyFlags,
     flags.useGpuXBufferOps = simulationWork.useGpuBufferOps;
     // on virial steps the CPU reduction path is taken
     flags.useGpuFBufferOps = simulationWork.useGpuBufferOps && !flags.computeVirial;
+    if (!mtsLevels.empty() && computeSlowForces)
+    {
+        // With MTS, the GPU reduction can only produce the MTS-combined force for the GPU update
+        // and only when all slow forces are PME forces computed on, or received to, this GPU.
+        // Otherwise, or when the normal force is needed, the CPU path combines the forces.
+        const auto& slowForceGroups = mtsLevels[1].forceGroups;
+        const bool  haveOnlyPmeAtMtsLevel1 =
+                (slowForceGroups.count() == 1
+                 && slowForceGroups[static_cast<int>(gmx::MtsForceGroups::LongrangeNonbonded)]);
+        const bool combineMtsForcesOnGpu =
+                simulationWork.useGpuUpdate && simulationWork.useGpuPme
+                && (rankHasPmeDuty || simulationWork.useGpuPmePpCommunication)
+                && haveOnlyPmeAtMtsLevel1
+                && (legacyFlags & GMX_FORCE_DO_NOT_NEED_NORMAL_FORCE) != 0;
+        flags.useGpuFBufferOps = flags.useGpuFBufferOps && combineMtsForcesOnGpu;
+    }
     flags.useGpuPmeFReduction = flags.computeSlowForces && flags.useGpuFBufferOps && simulationWork.useGpuPme
                                 && (rankHasPmeDuty || simulationWork.useGpuPmePpCommunication);
     flags.useGpuXHalo = simulationWork.useGpuHaloExchange;
@@ -1658,7 +1707,19 @@ void do_force(FILE*                               fplog,
 
     if (!useOrEmulateGpuNb)
     {
-        do_nb_verlet(fr, ic, enerd, stepWork, InteractionLocality::Local, enbvClearFYes, step, nrnb, wcycle);
+        /* Without GPU, the non-local coordinates have already been communicated,
+         * so we can compute both localities in one go.
+         */
+        if (havePPDomainDecomposition(cr))
+        {
+            do_nb_verlet_local_and_nonlocal_cpu(fr, ic, enerd, stepWork, enbvClearFYes, step, nrnb,
+                                                wcycle);
+        }
+        else
+        {
+            do_nb_verlet(fr, ic, enerd, stepWork, InteractionLocality::Local, enbvClearFYes, step,
+                         nrnb, wcycle);
+        }
     }
 
     if (fr->efep != efepNO && stepWork.computeNonbondedForces)
@@ -1682,12 +1743,6 @@ void do_force(FILE*                               fplog,
 
     if (stepWork.computeNonbondedForces && !useOrEmulateGpuNb)
     {
-        if (havePPDomainDecomposition(cr))
-        {
-            do_nb_verlet(fr, ic, enerd, stepWork, InteractionLocality::NonLocal, enbvClearFNo, step,
-                         nrnb, wcycle);
-        }
-
         if (stepWork.computeForces)
         {
             /* Add all the non-bonded force to the normal force array.
@@ -1769,6 +1824,15 @@ void do_force(FILE*                               fplog,
                                      stepWork, ddBalanceRegionHandler);
     }
 
+    if (stepWork.computeNonbondedForces && nbv->haveGpuCpuWorkSplit())
+    {
+        /* Compute the CPU part of the local GPU list, after the other CPU work,
+         * so it fills the time the CPU would otherwise wait for the GPU.
+         */
+        nbv->dispatchCpuPartOfGpuNonbondedKernel(*ic, stepWork, *fr,
+                                                 &forceOutNonbonded->forceWithShiftForces(), enerd);
+    }
+
     wallcycle_stop(wcycle, ewcFORCE);
 
     // VdW dispersion correction, only computed on master rank to avoid double counting
@@ -1924,8 +1988,13 @@ void do_force(FILE*                               fplog,
                              && !DOMAINDECOMP(cr) && !stepWork.useGpuFBufferOps);
     if (alternateGpuWait)
     {
+        const gmx_cycles_t waitStart = gmx_cycles_read();
         alternatePmeNbGpuWaitReduce(fr->nbv.get(), fr->pmedata, forceOutNonbonded,
                                     forceOutMtsLevel1, enerd, lambda[efptCOUL], stepWork, wcycle);
+        if (stepWork.computeNonbondedForces)
+        {
+            nbv->addGpuWaitCyclesToWorkSplit(static_cast<double>(gmx_cycles_read() - waitStart));
+        }
     }
 
     if (!alternateGpuWait && useGpuPmeOnThisRank)
@@ -1948,6 +2017,8 @@ void do_force(FILE*                               fplog,
                 enerd->grpp.ener[egCOULSR].data(),
                 forceOutNonbonded->forceWithShiftForces().shiftForces(), wcycle);
 
+        nbv->addGpuWaitCyclesToWorkSplit(waitCycles);
+
         if (ddBalanceRegionHandler.useBalancingRegion())
         {
             DdBalanceRegionWaitedForGpu waitedForGpu = DdBalanceRegionWaitedForGpu::yes;
@@ -2027,6 +2098,12 @@ void do_force(FILE*                               fplog,
 
             if (stepWork.computeNonbondedForces)
             {
+                // The PME force is only available at (MTS slow) steps where it has been computed.
+                // With MTS it is scaled by the MTS factor to give the MTS-combined force.
+                const float pmeForceScaleFactor =
+                        fr->useMts ? static_cast<float>(inputrec->mtsLevels[1].stepFactor) : 1.0F;
+                fr->gpuForceReduction[gmx::AtomLocality::Local]->setRvecForceContribution(
+                        stepWork.useGpuPmeFReduction, pmeForceScaleFactor);
                 fr->gpuForceReduction[gmx::AtomLocality::Local]->execute();
             }
 
@@ -2060,12 +2137,18 @@ void do_force(FILE*                               fplog,
 
     const bool haveCombinedMtsForces = (stepWork.computeForces && fr->useMts && stepWork.computeSlowForces
                                         && combineMtsForcesBeforeHaloExchange);
+    // With the GPU force reduction at MTS slow steps, the MTS-combined force is only
+    // produced on the GPU, for the GPU update, and the host force buffers are not used.
+    const bool haveCombinedMtsForcesOnGpu =
+            (stepWork.computeForces && fr->useMts && stepWork.computeSlowForces
+             && stepWork.useGpuFBufferOps);
     if (stepWork.computeForces)
     {
         postProcessForceWithShiftForces(nrnb, wcycle, box, x.unpaddedArrayRef(), &forceOutMtsLevel0,
                                         vir_force, *mdatoms, *fr, vsite, stepWork);
 
-        if (fr->useMts && stepWork.computeSlowForces && !haveCombinedMtsForces)
+        if (fr->useMts && stepWork.computeSlowForces && !haveCombinedMtsForces
+            && !haveCombinedMtsForcesOnGpu)
         {
             postProcessForceWithShiftForces(nrnb, wcycle, box, x.unpaddedArrayRef(), forceOutMtsLevel1,
                                             vir_force, *mdatoms, *fr, vsite, stepWork);
@@ -2093,7 +2176,8 @@ void do_force(FILE*                               fplog,
         postProcessForces(cr, step, nrnb, wcycle, box, x.unpaddedArrayRef(), &forceOutCombined,
                           vir_force, mdatoms, fr, vsite, stepWork);
 
-        if (fr->useMts && stepWork.computeSlowForces && !haveCombinedMtsForces)
+        if (fr->useMts && stepWork.computeSlowForces && !haveCombinedMtsForces
+            && !haveCombinedMtsForcesOnGpu)
         {
             postProcessForces(cr, step, nrnb, wcycle, box, x.unpaddedArrayRef(), forceOutMtsLevel1,
                               vir_force, mdatoms, fr, vsite, stepWork);
@@ -67,17 +67,56 @@
 namespace gmx
 {
 
-SimulationSignaller::SimulationSignaller(SimulationSignals*    signals,
-                                         const t_commrec*      cr,
-                                         const gmx_multisim_t* ms,
-                                         bool                  doInterSim,
-                                         bool                  doIntraSim) :
+InterSimulationSignalReduction::InterSimulationSignalReduction(const gmx_multisim_t* ms) :
+    ms_(ms),
+    buffer_{},
+    request_(),
+    isPending_(false)
+{
+    GMX_RELEASE_ASSERT(isMultiSim(ms_),
+                       "Cannot do inter-simulation signalling without a multi-simulation");
+}
+
+InterSimulationSignalReduction::~InterSimulationSignalReduction()
+{
+    if (isPending_)
+    {
+        gmx_sumd_wait(&request_);
+    }
+}
+
+void InterSimulationSignalReduction::exchange(ArrayRef<real> signals)
+{
+    GMX_ASSERT(signals.size() == buffer_.size(), "Signal buffer sizes should match");
+
+    if (isPending_)
+    {
+        gmx_sumd_wait(&request_);
+    }
+    for (size_t i = 0; i < buffer_.size(); i++)
+    {
+        // Return the completed sum and store the new values to sum
+        const double sum = isPending_ ? buffer_[i] : 0;
+        buffer_[i]       = signals[i];
+        signals[i]       = sum;
+    }
+    gmx_sumd_sim_start(buffer_.size(), buffer_.data(), ms_, &request_);
+    isPending_ = true;
+}
+
+SimulationSignaller::SimulationSignaller(SimulationSignals*              signals,
+                                         const t_commrec*                cr,
+                                         const gmx_multisim_t*           ms,
+                                         bool                            doInterSim,
+                                         bool                            doIntraSim,
+                                         InterSimulationSignalReduction* interSimReduction) :
     signals_(signals),
     cr_(cr),
     ms_(ms),
     doInterSim_(doInterSim),
     doIntraSim_(doInterSim || doIntraSim),
-    mpiBuffer_{}
+    mpiBuffer_{},
+    interSimReduction_(interSimReduction)
 {
 }
 
@@ -110,7 +149,14 @@ void SimulationSignaller::signalInterSim()
     if (MASTER(cr_))
     {
         // Communicate the signals between the simulations.
-        gmx_sum_sim(eglsNR, mpiBuffer_.data(), ms_);
+        if (interSimReduction_)
+        {
+            interSimReduction_->exchange(mpiBuffer_);
+        }
+        else
+        {
+            gmx_sum_sim(eglsNR, mpiBuffer_.data(), ms_);
+        }
     }
     if (DOMAINDECOMP(cr_))
     {
@@ -55,6 +55,8 @@
 
 #include <array>
 
+#include "gromacs/utility/classhelpers.h"
+#include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/real.h"
 
 struct gmx_multisim_t;
@@ -105,6 +107,45 @@ public:
 //! Convenience typedef for the group of signals used.
 typedef std::array<SimulationSignal, eglsNR> SimulationSignals;
 
+/*!
+ * \brief Non-blocking reduction of the signals between simulations.
+ *
+ * With a blocking sum the master ranks of all simulations wait for
+ * the slowest simulation at every inter-simulation signalling step.
+ * This object instead starts the sum at one signalling step and
+ * completes it at the next, so the reduction overlaps with the steps
+ * in between. Signals therefore take effect one signalling interval
+ * later, but still at the same step in all simulations.
+ *
+ * Only master ranks should use this object, and all of them should
+ * call exchange() at the same steps. */
+class InterSimulationSignalReduction
+{
+public:
+    //! Constructor
+    explicit InterSimulationSignalReduction(const gmx_multisim_t* ms);
+    //! Destructor, completes a pending reduction
+    ~InterSimulationSignalReduction();
+    /*! \brief Complete the pending reduction and start a new one.
+     *
+     * On return \p signals contains the sum over the simulations of
+     * the values passed at the previous call, or zeros at the first
+     * call, while the values passed now are being summed. */
+    void exchange(ArrayRef<real> signals);
+
+private:
+    //! Multi-sim handler.
+    const gmx_multisim_t* ms_;
+    //! Buffer for the pending reduction.
+    std::array<double, eglsNR> buffer_;
+    //! Request of the pending reduction.
+    MPI_Request request_;
+    //! Whether a reduction has been started and not yet completed.
+    bool isPending_;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(InterSimulationSignalReduction);
+};
+
 /*!
  * \brief Object used by mdrun ranks to signal to each other at this step.
  *
@@ -119,11 +160,12 @@ class SimulationSignaller
 {
 public:
     //! Constructor
-    SimulationSignaller(SimulationSignals*    signals,
-                        const t_commrec*      cr,
-                        const gmx_multisim_t* ms,
-                        bool                  doInterSim,
-                        bool                  doIntraSim);
+    SimulationSignaller(SimulationSignals*              signals,
+                        const t_commrec*                cr,
+                        const gmx_multisim_t*           ms,
+                        bool                            doInterSim,
+                        bool                            doIntraSim,
+                        InterSimulationSignalReduction* interSimReduction = nullptr);
     /*! \brief Return a reference to an array of signal values to communicate.
      *
      * \return If intra-sim signalling will take place, fill and
@@ -137,7 +179,11 @@ public:
      * simulation-master ranks, then propagate from the masters to the
      * rest of the ranks for each simulation. It is the responsibility of
      * the calling code to ensure that any necessary intra-simulation
-     * signalling has already occurred, e.g. in global_stat(). */
+     * signalling has already occurred, e.g. in global_stat().
+     *
+     * When an inter-simulation reduction object was passed, the
+     * signals between the simulations are exchanged with a delay of
+     * one signalling interval without blocking. */
     void signalInterSim();
     /*! \brief Propagate signals when appropriate.
      *
@@ -163,6 +209,8 @@ private:
     bool doIntraSim_;
     //! Buffer for MPI communication.
     std::array<real, eglsNR> mpiBuffer_;
+    //! Non-blocking inter-simulation reduction, can be nullptr.
+    InterSimulationSignalReduction* interSimReduction_;
 };
 
 } // namespace gmx
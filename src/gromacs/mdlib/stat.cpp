@@ -61,6 +61,7 @@
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/smalloc.h"
 
 typedef struct gmx_global_stat
@@ -68,6 +69,10 @@ typedef struct gmx_global_stat
     t_bin* rb;
     int*   itc0;
     int*   itc1;
+    /* Buffer, request and settings for a started half-step kinetic energy reduction */
+    t_bin*      rbEkinh;
+    MPI_Request ekinhRequest;
+    bool        ekinhSumEkinhOld;
 } t_gmx_global_stat;
 
 gmx_global_stat_t global_stat_init(const t_inputrec* ir)
@@ -76,7 +81,8 @@ gmx_global_stat_t global_stat_init(const t_inputrec* ir)
 
     snew(gs, 1);
 
-    gs->rb = mk_bin();
+    gs->rb      = mk_bin();
+    gs->rbEkinh = mk_bin();
     snew(gs->itc0, ir->opts.ngtc);
     snew(gs->itc1, ir->opts.ngtc);
 
@@ -86,6 +92,7 @@ gmx_global_stat_t global_stat_init(const t_inputrec* ir)
 void global_stat_destroy(gmx_global_stat_t gs)
 {
     destroy_bin(gs->rb);
+    destroy_bin(gs->rbEkinh);
     sfree(gs->itc0);
     sfree(gs->itc1);
     sfree(gs);
@@ -385,3 +392,70 @@ void global_stat(const gmx_global_stat*  gs,
         extract_binr(rb, isig, nsig, sig);
     }
 }
+
+/*! \brief Adds the half-step kinetic energy terms to, or extracts them from, \p rb
+ *
+ * The terms are stored consecutively, so extraction only needs to loop
+ * over the same terms in the same order as when adding.
+ */
+static void ekinhTermsToOrFromBin(t_bin*            rb,
+                                  const t_inputrec* inputrec,
+                                  gmx_ekindata_t*   ekind,
+                                  bool              bSumEkinhOld,
+                                  bool              bToBin)
+{
+    int  index = 0;
+    auto terms = [rb, bToBin, &index](int nr, real* r) {
+        if (bToBin)
+        {
+            add_binr(rb, nr, r);
+        }
+        else
+        {
+            extract_binr(rb, index, nr, r);
+        }
+        index += nr;
+    };
+
+    for (int j = 0; j < inputrec->opts.ngtc; j++)
+    {
+        if (bSumEkinhOld)
+        {
+            terms(DIM * DIM, ekind->tcstat[j].ekinh_old[0]);
+        }
+        terms(DIM * DIM, ekind->tcstat[j].ekinh[0]);
+    }
+    terms(1, &ekind->dekindl);
+    if (bSumEkinhOld)
+    {
+        terms(1, &ekind->dekindl_old);
+    }
+    if (ekind->cosacc.cos_accel != 0)
+    {
+        terms(1, &ekind->cosacc.mvcos);
+    }
+}
+
+void global_stat_start_ekinh(gmx_global_stat*  gs,
+                             const t_commrec*  cr,
+                             const t_inputrec* inputrec,
+                             gmx_ekindata_t*   ekind,
+                             bool              bSumEkinhOld)
+{
+    GMX_ASSERT(!EI_VV(inputrec->eI), "Only the half-step kinetic energy can be summed separately");
+
+    reset_bin(gs->rbEkinh);
+    ekinhTermsToOrFromBin(gs->rbEkinh, inputrec, ekind, bSumEkinhOld, true);
+    gs->ekinhSumEkinhOld = bSumEkinhOld;
+
+    start_sum_bin(gs->rbEkinh, cr, &gs->ekinhRequest);
+}
+
+void global_stat_finish_ekinh(gmx_global_stat*  gs,
+                              const t_inputrec* inputrec,
+                              gmx_ekindata_t*   ekind)
+{
+    gmx_sumd_wait(&gs->ekinhRequest);
+
+    ekinhTermsToOrFromBin(gs->rbEkinh, inputrec, ekind, gs->ekinhSumEkinhOld, false);
+}
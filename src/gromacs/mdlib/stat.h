@@ -74,6 +74,24 @@ void global_stat(const gmx_global_stat*  gs,
                  bool                    bSumEkinhOld,
                  int                     flags);
 
+/*! \brief Starts an all-reduce of the half-step kinetic energies over cr->mpi_comm_mygroup
+ *
+ * Sums the same kinetic energy terms as global_stat() does for leap-frog
+ * with CGLO_TEMPERATURE. The terms in \p ekind should not be accessed until
+ * global_stat_finish_ekinh() has been called. With an MPI library without
+ * non-blocking collectives the reduction is completed immediately.
+ */
+void global_stat_start_ekinh(gmx_global_stat*  gs,
+                             const t_commrec*  cr,
+                             const t_inputrec* inputrec,
+                             gmx_ekindata_t*   ekind,
+                             bool              bSumEkinhOld);
+
+/*! \brief Completes a reduction started by global_stat_start_ekinh() */
+void global_stat_finish_ekinh(gmx_global_stat*  gs,
+                              const t_inputrec* inputrec,
+                              gmx_ekindata_t*   ekind);
+
 /*! \brief Returns TRUE if io should be done */
 inline bool do_per_step(int64_t step, int64_t nstep)
 {
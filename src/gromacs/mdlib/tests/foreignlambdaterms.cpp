@@ -0,0 +1,108 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Tests for ForeignLambdaTerms.
+ *
+ * \ingroup module_mdlib
+ */
+
+#include "gmxpre.h"
+
+#include <array>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/mdtypes/enerdata.h"
+#include "gromacs/mdtypes/inputrec.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Accumulates test energies for 1 + \p numLambdas lambda states and finalizes \p terms
+void accumulateAndFinalize(ForeignLambdaTerms* terms, int numLambdas, double offset)
+{
+    for (int i = 0; i < 1 + numLambdas; i++)
+    {
+        terms->accumulate(i, offset + 2 * i, offset + 3 * i);
+    }
+
+    t_lambda                         fepvals    = {};
+    const std::array<double, efptNR> dvdlLinear = {};
+    const std::array<real, efptNR>   lambda     = {};
+    terms->finalizePotentialContributions(dvdlLinear, lambda, fepvals);
+}
+
+TEST(ForeignLambdaTermsTest, GetTermsReturnsDeltaHAndDhdl)
+{
+    const int          numLambdas = 3;
+    ForeignLambdaTerms terms(numLambdas);
+    accumulateAndFinalize(&terms, numLambdas, 1);
+
+    const auto [deltaH, dhdl] = terms.getTerms(nullptr);
+
+    ASSERT_EQ(numLambdas, deltaH.ssize());
+    ASSERT_EQ(numLambdas, dhdl.ssize());
+    for (int i = 0; i < numLambdas; i++)
+    {
+        EXPECT_DOUBLE_EQ(2 * (1 + i), deltaH[i]);
+        EXPECT_DOUBLE_EQ(1 + 3 * (1 + i), dhdl[i]);
+    }
+}
+
+TEST(ForeignLambdaTermsTest, GetTermsReusesStorageForEveryStep)
+{
+    const int          numLambdas = 4;
+    ForeignLambdaTerms terms(numLambdas);
+    accumulateAndFinalize(&terms, numLambdas, 1);
+    const auto firstTerms = terms.getTerms(nullptr);
+
+    terms.zeroAllTerms();
+    accumulateAndFinalize(&terms, numLambdas, 5);
+    const auto secondTerms = terms.getTerms(nullptr);
+
+    // No memory should be allocated for the terms during the run
+    EXPECT_EQ(firstTerms.first.data(), secondTerms.first.data());
+    EXPECT_EQ(firstTerms.second.data(), secondTerms.second.data());
+    EXPECT_DOUBLE_EQ(5 + 3, secondTerms.second[0]);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
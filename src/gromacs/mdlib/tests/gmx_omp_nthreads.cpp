@@ -0,0 +1,134 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the run-time tuning of the module thread counts
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+namespace gmx
+{
+
+namespace test
+{
+
+//! Test fixture setting the number of SETTLE threads
+class ModuleThreadCountTunerTest : public ::testing::Test
+{
+public:
+    ModuleThreadCountTunerTest() : numThreadsSaved_(gmx_omp_nthreads_get(emntSETTLE))
+    {
+        gmx_omp_nthreads_set(emntSETTLE, 4);
+    }
+    ~ModuleThreadCountTunerTest() override { gmx_omp_nthreads_set(emntSETTLE, numThreadsSaved_); }
+
+    //! Records up to \p numCalls calls taking \p cyclesPerThread times the thread count
+    static void recordCalls(ModuleThreadCountTuner* tuner, int numCalls,
+                            gmx_cycles_t cyclesPerThread)
+    {
+        for (int call = 0; call < numCalls && tuner->isTuning(); call++)
+        {
+            tuner->recordCycles(cyclesPerThread * tuner->numThreads());
+        }
+    }
+
+    //! Returns whether the tuner can tune here, which the test environment can prevent
+    static bool tuningIsPossible()
+    {
+        return gmx_cycles_have_counter() && std::getenv("GMX_SETTLE_NUM_THREADS") == nullptr;
+    }
+
+private:
+    //! The SETTLE thread count to restore after the test
+    int numThreadsSaved_;
+};
+
+TEST_F(ModuleThreadCountTunerTest, DoesNotTuneWhenNotRequested)
+{
+    ModuleThreadCountTuner tuner(emntSETTLE, false);
+    EXPECT_FALSE(tuner.isTuning());
+    EXPECT_EQ(4, tuner.numThreads());
+}
+
+TEST_F(ModuleThreadCountTunerTest, PicksTheFastestThreadCount)
+{
+    if (!tuningIsPossible())
+    {
+        return;
+    }
+
+    ModuleThreadCountTuner tuner(emntSETTLE, true);
+    ASSERT_TRUE(tuner.isTuning());
+    // Starts from the thread count of the module
+    EXPECT_EQ(4, tuner.numThreads());
+
+    // With a cost that grows with the thread count, one thread should be picked.
+    // A single slow call is ignored, as the minimum over the timed calls is used.
+    tuner.recordCycles(1000000);
+    recordCalls(&tuner, 1000, 100);
+    EXPECT_FALSE(tuner.isTuning());
+    EXPECT_EQ(1, tuner.numThreads());
+
+    // After tuning, recording has no effect
+    tuner.recordCycles(0);
+    EXPECT_EQ(1, tuner.numThreads());
+}
+
+TEST_F(ModuleThreadCountTunerTest, KeepsAllThreadsWhenEquallyFast)
+{
+    if (!tuningIsPossible())
+    {
+        return;
+    }
+
+    ModuleThreadCountTuner tuner(emntSETTLE, true);
+    while (tuner.isTuning())
+    {
+        tuner.recordCycles(100);
+    }
+    EXPECT_EQ(4, tuner.numThreads());
+}
+
+} // namespace test
+
+} // namespace gmx
@@ -48,8 +48,8 @@
 
 #include "leapfrogtestrunners.h"
 
-#if GMX_GPU_CUDA
-#    include "gromacs/gpu_utils/devicebuffer.cuh"
+#if HAVE_GPU_LEAPFROG
+#    include "gromacs/gpu_utils/devicebuffer.h"
 #    include "gromacs/mdlib/leapfrog_gpu.h"
 #endif
 
@@ -70,12 +70,12 @@ void LeapFrogDeviceTestRunner::integrate(LeapFrogTestData* testData, int numStep
 
     int numAtoms = testData->numAtoms_;
 
-    float3* h_x  = reinterpret_cast<float3*>(testData->x_.data());
-    float3* h_xp = reinterpret_cast<float3*>(testData->xPrime_.data());
-    float3* h_v  = reinterpret_cast<float3*>(testData->v_.data());
-    float3* h_f  = reinterpret_cast<float3*>(testData->f_.data());
+    Float3* h_x  = reinterpret_cast<Float3*>(testData->x_.data());
+    Float3* h_xp = reinterpret_cast<Float3*>(testData->xPrime_.data());
+    Float3* h_v  = reinterpret_cast<Float3*>(testData->v_.data());
+    Float3* h_f  = reinterpret_cast<Float3*>(testData->f_.data());
 
-    DeviceBuffer<float3> d_x, d_xp, d_v, d_f;
+    DeviceBuffer<Float3> d_x, d_xp, d_v, d_f;
 
     allocateDeviceBuffer(&d_x, numAtoms, deviceContext);
     allocateDeviceBuffer(&d_xp, numAtoms, deviceContext);
@@ -100,8 +100,9 @@ void LeapFrogDeviceTestRunner::integrate(LeapFrogTestData* testData, int numStep
                                 && do_per_step(step + testData->inputRecord_.nstpcouple - 1,
                                                testData->inputRecord_.nstpcouple);
         integrator->integrate(d_x, d_xp, d_v, d_f, testData->timestep_, doTempCouple,
-                              testData->kineticEnergyData_.tcstat, doPressureCouple,
-                              testData->dtPressureCouple_, testData->velocityScalingMatrix_);
+                              testData->kineticEnergyData_.tcstat, false, 0, {},
+                              doPressureCouple, testData->dtPressureCouple_,
+                              testData->velocityScalingMatrix_);
     }
 
     copyFromDeviceBuffer(h_xp, &d_x, 0, numAtoms, deviceStream, GpuApiCallBehavior::Sync, nullptr);
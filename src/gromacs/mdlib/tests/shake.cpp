@@ -169,7 +169,6 @@ public:
             }
         }
         std::vector<real> distanceSquaredTolerances;
-        std::vector<real> lagrangianValues;
         std::vector<real> constrainedDistancesSquared;
 
         real coordMax = 0;
@@ -178,7 +177,6 @@ public:
             constrainedDistancesSquared.push_back(constrainedDistances[i] * constrainedDistances[i]);
             distanceSquaredTolerances.push_back(
                     0.5 / (constrainedDistancesSquared.back() * ShakeTest::tolerance_));
-            lagrangianValues.push_back(0.0);
 
             for (size_t j = 1; j < constraintStride; j++)
             {
@@ -191,34 +189,52 @@ public:
         std::vector<real> halfOfReducedMasses  = computeHalfOfReducedMasses(iatom, inverseMasses);
         std::vector<RVec> initialDisplacements = computeDisplacements(iatom, positions);
 
-        std::vector<RVec> finalPositions = positions;
-        int               numIterations  = 0;
-        int               numErrors      = 0;
+        // Check both the iterative solver and the Newton solver
+        for (const bool useNewtonSolver : { false, true })
+        {
+            SCOPED_TRACE(useNewtonSolver ? "Newton solver" : "iterative solver");
+
+            std::vector<RVec> finalPositions = positions;
+            std::vector<real> lagrangianValues(numConstraints, 0.0);
+            int               numIterations = 0;
+            int               numErrors     = 0;
 
-        cshake(iatom.data(), numConstraints, &numIterations, ShakeTest::maxNumIterations_,
-               constrainedDistancesSquared, finalPositions, nullptr, initialDisplacements,
-               halfOfReducedMasses, omega_, inverseMasses.data(), distanceSquaredTolerances,
-               lagrangianValues, &numErrors);
+            if (useNewtonSolver)
+            {
+                ShakeNewtonData newtonData;
+                cshakeNewton(iatom.data(), numConstraints, &numIterations,
+                             ShakeTest::maxNumIterations_, constrainedDistancesSquared,
+                             finalPositions, nullptr, initialDisplacements, inverseMasses.data(),
+                             distanceSquaredTolerances, lagrangianValues, &newtonData, &numErrors);
+            }
+            else
+            {
+                cshake(iatom.data(), numConstraints, &numIterations, ShakeTest::maxNumIterations_,
+                       constrainedDistancesSquared, finalPositions, nullptr, initialDisplacements,
+                       halfOfReducedMasses, omega_, inverseMasses.data(), distanceSquaredTolerances,
+                       lagrangianValues, &numErrors);
+            }
 
-        std::vector<RVec> finalDisplacements    = computeDisplacements(iatom, finalPositions);
-        std::vector<real> finalDistancesSquared = computeDistancesSquared(finalDisplacements);
-        assert(numConstraints == finalDistancesSquared.size());
+            std::vector<RVec> finalDisplacements    = computeDisplacements(iatom, finalPositions);
+            std::vector<real> finalDistancesSquared = computeDistancesSquared(finalDisplacements);
+            assert(numConstraints == finalDistancesSquared.size());
 
-        EXPECT_EQ(0, numErrors);
-        EXPECT_GT(numIterations, 1);
-        EXPECT_LT(numIterations, ShakeTest::maxNumIterations_);
-        // TODO wrap this in a Google Mock matcher if there's
-        // other tests like it some time?
-        for (size_t i = 0; i != numConstraints; ++i)
-        {
-            // We need to allow for the requested tolerance plus rounding
-            // errors due to the absolute size of the coordinate values
-            test::FloatingPointTolerance constraintTolerance =
-                    test::absoluteTolerance(std::sqrt(constrainedDistancesSquared[i]) * ShakeTest::tolerance_
-                                            + coordMax * GMX_REAL_EPS);
-            // Assert that the constrained distances are within the required tolerance
-            EXPECT_FLOAT_EQ_TOL(std::sqrt(constrainedDistancesSquared[i]),
-                                std::sqrt(finalDistancesSquared[i]), constraintTolerance);
+            EXPECT_EQ(0, numErrors);
+            EXPECT_GT(numIterations, 1);
+            EXPECT_LT(numIterations, ShakeTest::maxNumIterations_);
+            // TODO wrap this in a Google Mock matcher if there's
+            // other tests like it some time?
+            for (size_t i = 0; i != numConstraints; ++i)
+            {
+                // We need to allow for the requested tolerance plus rounding
+                // errors due to the absolute size of the coordinate values
+                test::FloatingPointTolerance constraintTolerance = test::absoluteTolerance(
+                        std::sqrt(constrainedDistancesSquared[i]) * ShakeTest::tolerance_
+                        + coordMax * GMX_REAL_EPS);
+                // Assert that the constrained distances are within the required tolerance
+                EXPECT_FLOAT_EQ_TOL(std::sqrt(constrainedDistancesSquared[i]),
+                                    std::sqrt(finalDistancesSquared[i]), constraintTolerance);
+            }
         }
     }
 
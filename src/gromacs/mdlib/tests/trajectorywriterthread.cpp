@@ -0,0 +1,158 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the thread writing trajectory frames.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdlib/trajectorywriterthread.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of atoms in the test frames
+const int c_numAtoms = 20;
+//! The number of frames written
+const int c_numFrames = 7;
+
+//! Returns the coordinate of atom \p i in \p frame
+RVec testCoordinate(int frame, int i)
+{
+    return { 0.1F * i, 0.01F * frame, 1.0F + 0.5F * (i % 3) };
+}
+
+TEST(TrajectoryWriterThreadTest, WritesFramesInOrder)
+{
+    TestFileManager   fileManager;
+    const std::string trrFileName = fileManager.getTemporaryFilePath("traj.trr");
+    const std::string xtcFileName = fileManager.getTemporaryFilePath("traj.xtc");
+
+    t_fileio* fpTrr = gmx_trr_open(trrFileName.c_str(), "w");
+    t_fileio* fpXtc = open_xtc(xtcFileName.c_str(), "w");
+    {
+        TrajectoryWriterThread writerThread(fpTrr, fpXtc, 1000);
+        for (int frameIndex = 0; frameIndex < c_numFrames; frameIndex++)
+        {
+            TrajectoryOutputFrame* frame = writerThread.acquireFrame();
+            frame->step                  = 10 * frameIndex;
+            frame->time                  = 0.02 * frameIndex;
+            frame->lambda                = 0;
+            clear_mat(frame->box);
+            frame->box[XX][XX] = frame->box[YY][YY] = frame->box[ZZ][ZZ] = 3;
+            frame->writeFullPrecision = (frameIndex % 2 == 0);
+            frame->natoms             = c_numAtoms;
+            frame->haveX              = frame->writeFullPrecision;
+            frame->haveV = frame->haveF = false;
+            frame->writeCompressed      = true;
+            frame->x.resize(c_numAtoms);
+            frame->xCompressed.resize(c_numAtoms);
+            for (int i = 0; i < c_numAtoms; i++)
+            {
+                frame->x[i] = frame->xCompressed[i] = testCoordinate(frameIndex, i);
+            }
+            writerThread.submitFrame();
+            if (frameIndex == 3)
+            {
+                writerThread.waitForPendingFrames();
+            }
+        }
+    }
+    gmx_trr_close(fpTrr);
+    close_xtc(fpXtc);
+
+    fpTrr = gmx_trr_open(trrFileName.c_str(), "r");
+    std::vector<RVec> x(c_numAtoms);
+    int64_t           step;
+    real              time, lambda;
+    matrix            box;
+    int               natoms;
+    for (int frameIndex = 0; frameIndex < c_numFrames; frameIndex += 2)
+    {
+        ASSERT_TRUE(gmx_trr_read_frame(fpTrr, &step, &time, &lambda, box, &natoms,
+                                       as_rvec_array(x.data()), nullptr, nullptr));
+        EXPECT_EQ(10 * frameIndex, step);
+        EXPECT_EQ(c_numAtoms, natoms);
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(testCoordinate(frameIndex, i)[d], x[i][d]);
+            }
+        }
+    }
+    EXPECT_FALSE(gmx_trr_read_frame(fpTrr, &step, &time, &lambda, box, &natoms,
+                                    as_rvec_array(x.data()), nullptr, nullptr));
+    gmx_trr_close(fpTrr);
+
+    fpXtc = open_xtc(xtcFileName.c_str(), "r");
+    rvec*    xtcX = nullptr;
+    real     prec;
+    gmx_bool bOK;
+    ASSERT_TRUE(read_first_xtc(fpXtc, &natoms, &step, &time, box, &xtcX, &prec, &bOK));
+    EXPECT_EQ(c_numAtoms, natoms);
+    int numFrames = 1;
+    while (read_next_xtc(fpXtc, natoms, &step, &time, box, xtcX, &prec, &bOK))
+    {
+        EXPECT_EQ(10 * numFrames, step);
+        EXPECT_NEAR(testCoordinate(numFrames, c_numAtoms - 1)[XX], xtcX[c_numAtoms - 1][XX], 1e-3);
+        numFrames++;
+    }
+    EXPECT_EQ(c_numFrames, numFrames);
+    sfree(xtcX);
+    close_xtc(fpXtc);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -38,6 +38,7 @@
 #include "trajectory_writing.h"
 
 #include "gromacs/commandline/filenm.h"
+#include "gromacs/domdec/collect.h"
 #include "gromacs/fileio/confio.h"
 #include "gromacs/fileio/tngio.h"
 #include "gromacs/math/vec.h"
@@ -98,6 +99,14 @@ void do_md_trajectory_writing(FILE*                          fplog,
     {
         mdof_flags |= MDOF_X_COMPRESSED;
     }
+    if (do_per_step(step, ir->nstvout_compressed))
+    {
+        mdof_flags |= MDOF_V_COMPRESSED;
+    }
+    if (do_per_step(step, ir->nstfout_compressed))
+    {
+        mdof_flags |= MDOF_F_COMPRESSED;
+    }
     if (bCPT)
     {
         mdof_flags |= MDOF_CPT;
@@ -148,6 +157,12 @@ void do_md_trajectory_writing(FILE*                          fplog,
         // TODO: Remove duplication asap, make sure to keep in sync in the meantime.
         mdoutf_write_to_trajectory_files(fplog, cr, outf, mdof_flags, top_global->natoms, step, t, state,
                                          state_global, observablesHistory, f, &checkpointDataHolder);
+        if (bLastStep && step_rel == ir->nsteps && bDoConfOut && !bRerunMD && DOMAINDECOMP(cr)
+            && bCPT && mdoutf_checkpoint_atom_data_is_distributed(outf))
+        {
+            /* The distributed checkpoint did not collect x and v for confout */
+            dd_collect_state(cr->dd, state, state_global);
+        }
         if (bLastStep && step_rel == ir->nsteps && bDoConfOut && MASTER(cr) && !bRerunMD)
         {
             if (fr->bMolPBC && state == state_global)
@@ -0,0 +1,179 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the thread that writes TRR and XTC frames off the MD loop.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "trajectorywriterthread.h"
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+TrajectoryWriterThread::TrajectoryWriterThread(t_fileio* fpTrr,
+                                               t_fileio* fpXtc,
+                                               real      xtcPrecision) :
+    fpTrr_(fpTrr), fpXtc_(fpXtc), xtcPrecision_(xtcPrecision)
+{
+    thread_ = std::thread([this]() { threadLoop(); });
+}
+
+TrajectoryWriterThread::~TrajectoryWriterThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+    }
+    stateChanged_.notify_all();
+    thread_.join();
+}
+
+TrajectoryOutputFrame* TrajectoryWriterThread::acquireFrame()
+{
+    GMX_ASSERT(acquiredFrame_ < 0, "Only one frame can be acquired at a time");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    stateChanged_.wait(lock, [this]() { return !frameInUse_[0] || !frameInUse_[1]; });
+    checkForWriteError();
+    acquiredFrame_              = frameInUse_[0] ? 1 : 0;
+    frameInUse_[acquiredFrame_] = true;
+
+    return &frames_[acquiredFrame_];
+}
+
+void TrajectoryWriterThread::submitFrame()
+{
+    GMX_ASSERT(acquiredFrame_ >= 0, "A frame should be acquired before submitting it");
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        submittedFrames_.push(acquiredFrame_);
+        acquiredFrame_ = -1;
+    }
+    stateChanged_.notify_all();
+}
+
+void TrajectoryWriterThread::waitForPendingFrames()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    stateChanged_.wait(lock, [this]() { return !frameInUse_[0] && !frameInUse_[1]; });
+    checkForWriteError();
+}
+
+void TrajectoryWriterThread::checkForWriteError() const
+{
+    if (!writeError_.empty())
+    {
+        gmx_fatal(FARGS, "%s", writeError_.c_str());
+    }
+}
+
+void TrajectoryWriterThread::threadLoop()
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            stateChanged_.wait(lock, [this]() { return stopRequested_ || !submittedFrames_.empty(); });
+            if (submittedFrames_.empty())
+            {
+                /* Stop was requested and all frames have been written */
+                break;
+            }
+            const int frameIndex = submittedFrames_.front();
+            submittedFrames_.pop();
+
+            /* The frame is not touched by the MD loop until we release it */
+            lock.unlock();
+            writeFrame(frames_[frameIndex]);
+            lock.lock();
+
+            frameInUse_[frameIndex] = false;
+            stateChanged_.notify_all();
+        }
+    }
+    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+}
+
+void TrajectoryWriterThread::writeFrame(const TrajectoryOutputFrame& frame)
+{
+    std::string error;
+
+    if (frame.writeFullPrecision && fpTrr_ != nullptr)
+    {
+        gmx_trr_write_frame(fpTrr_, frame.step, frame.time, frame.lambda, frame.box, frame.natoms,
+                            frame.haveX ? as_rvec_array(frame.x.data()) : nullptr,
+                            frame.haveV ? as_rvec_array(frame.v.data()) : nullptr,
+                            frame.haveF ? as_rvec_array(frame.f.data()) : nullptr);
+        if (gmx_fio_flush(fpTrr_) != 0)
+        {
+            error = "Cannot write trajectory; maybe you are out of disk space?";
+        }
+    }
+    if (frame.writeCompressed && fpXtc_ != nullptr)
+    {
+        if (write_xtc(fpXtc_, ssize(frame.xCompressed), frame.step, frame.time, frame.box,
+                      as_rvec_array(frame.xCompressed.data()), xtcPrecision_)
+            == 0)
+        {
+            error = "XTC error. This indicates you are out of disk space, or a "
+                    "simulation with major instabilities resulting in coordinates "
+                    "that are NaN or too large to be represented in the XTC format.\n";
+        }
+    }
+
+    if (!error.empty())
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (writeError_.empty())
+        {
+            writeError_ = error;
+        }
+    }
+}
+
+} // namespace gmx
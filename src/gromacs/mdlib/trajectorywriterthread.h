@@ -0,0 +1,166 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a thread that writes TRR and XTC frames off the MD loop.
+ *
+ * \inlibraryapi
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_TRAJECTORYWRITERTHREAD_H
+#define GMX_MDLIB_TRAJECTORYWRITERTHREAD_H
+
+#include <cstdint>
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/classhelpers.h"
+#include "gromacs/utility/real.h"
+
+struct t_fileio;
+
+namespace gmx
+{
+
+/*! \libinternal \brief A snapshot of all data needed to write one output frame
+ *
+ * The buffers keep their allocation when frames are reused, so after
+ * the first few frames no memory is allocated.
+ */
+struct TrajectoryOutputFrame
+{
+    //! The MD step
+    int64_t step = 0;
+    //! The time
+    double time = 0;
+    //! The FEP lambda value
+    real lambda = 0;
+    //! The box
+    matrix box = { { 0 } };
+    //! Whether a full-precision frame should be written
+    bool writeFullPrecision = false;
+    //! The number of atoms in the full-precision frame
+    int natoms = 0;
+    //! Whether \c x, \c v and \c f are written to the full-precision frame
+    bool haveX = false, haveV = false, haveF = false;
+    //! Positions, velocities and forces for the full-precision frame
+    std::vector<RVec> x, v, f;
+    //! Whether a compressed frame should be written
+    bool writeCompressed = false;
+    //! Positions of the atoms in the compressed output group
+    std::vector<RVec> xCompressed;
+};
+
+/*! \libinternal \brief Writes TRR and XTC frames on a separate thread
+ *
+ * The MD loop copies the collected data into one of two frame buffers
+ * and returns immediately, while the output thread does the compression
+ * and file writing. When both buffers are in use, acquireFrame() waits
+ * for the oldest frame to be written, so at most two frames are pending.
+ *
+ * The files must not be accessed otherwise, e.g. by checkpointing,
+ * without calling waitForPendingFrames() first.
+ * Errors during writing are reported as fatal errors by the next call
+ * from the MD loop.
+ */
+class TrajectoryWriterThread
+{
+public:
+    /*! \brief Starts the output thread
+     *
+     * \param[in] fpTrr         The TRR file, can be nullptr
+     * \param[in] fpXtc         The XTC file, can be nullptr
+     * \param[in] xtcPrecision  The precision of the XTC output
+     */
+    TrajectoryWriterThread(t_fileio* fpTrr, t_fileio* fpXtc, real xtcPrecision);
+    //! Writes all pending frames and stops the thread
+    ~TrajectoryWriterThread();
+
+    /*! \brief Returns a free frame to be filled by the caller
+     *
+     * Waits for a frame to be written when no frame is free.
+     */
+    TrajectoryOutputFrame* acquireFrame();
+    //! Passes the frame returned by the last acquireFrame() call to the output thread
+    void submitFrame();
+    //! Waits until all submitted frames have been written
+    void waitForPendingFrames();
+
+private:
+    //! The loop run by the output thread
+    void threadLoop();
+    //! Writes a frame to the files
+    void writeFrame(const TrajectoryOutputFrame& frame);
+    //! Issues a fatal error when writing failed, expects \c mutex_ to be locked
+    void checkForWriteError() const;
+
+    //! The TRR file
+    t_fileio* fpTrr_;
+    //! The XTC file
+    t_fileio* fpXtc_;
+    //! The precision of the XTC output
+    real xtcPrecision_;
+    //! The two frame buffers
+    std::array<TrajectoryOutputFrame, 2> frames_;
+    //! Whether each frame is in use, acquired but not yet written
+    std::array<bool, 2> frameInUse_ = { { false, false } };
+    //! The index of the acquired frame, -1 when none
+    int acquiredFrame_ = -1;
+    //! Indices of submitted frames in the order they should be written
+    std::queue<int> submittedFrames_;
+    //! Whether the output thread should stop
+    bool stopRequested_ = false;
+    //! The message describing the first write error, empty when no error occurred
+    std::string writeError_;
+    //! Protects all the above state
+    std::mutex mutex_;
+    //! Signals changes of the above state
+    std::condition_variable stateChanged_;
+    //! The output thread
+    std::thread thread_;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(TrajectoryWriterThread);
+};
+
+} // namespace gmx
+
+#endif
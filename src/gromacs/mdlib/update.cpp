@@ -41,8 +41,10 @@
 
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
 
 #include <algorithm>
+#include <array>
 #include <memory>
 
 #include "gromacs/domdec/domdec_struct.h"
@@ -171,8 +173,17 @@ private:
     gmx_stochd_t sd_;
     //! xprime for constraint algorithms
     PaddedVector<RVec> xp_;
+    /*! \brief Whether update_coords() already copied xp_ to the state
+     *
+     * Without constraints the copy is done right after the leap-frog update of
+     * each thread's atoms, while they are in cache, so finish_update() can skip
+     * its pass over all atoms.
+     */
+    bool xpCopiedToState_ = false;
     //! Box deformation handler (or nullptr if inactive).
     BoxDeformation* deform_ = nullptr;
+    //! Tunes the number of threads for update_coords(), when requested
+    ModuleThreadCountTuner updateThreadCountTuner_;
 };
 
 Update::Update(const t_inputrec& inputRecord, BoxDeformation* boxDeformation) :
@@ -1002,7 +1013,8 @@ void Update::Impl::update_temperature_constants(const t_inputrec& inputRecord)
 
 Update::Impl::Impl(const t_inputrec& inputRecord, BoxDeformation* boxDeformation) :
     sd_(inputRecord),
-    deform_(boxDeformation)
+    deform_(boxDeformation),
+    updateThreadCountTuner_(emntUpdate, getenv("GMX_TUNE_MODULE_NUM_THREADS") != nullptr)
 {
     update_temperature_constants(inputRecord);
     xp_.resizeWithPadding(0);
@@ -1014,6 +1026,30 @@ void Update::setNumAtoms(int numAtoms)
     impl_->xp()->resizeWithPadding(numAtoms);
 }
 
+//! The number of atoms for which random bits are generated at once in the SD and BD updates
+static constexpr int c_randomBitsBatchSize = 64;
+
+/*! \brief Generates the random bits for the noise of the atoms starting at local index \p start
+ *
+ * For each atom this gives the same 64 bits as restarting \p rng with \p step and
+ * the global atom index and drawing one value, but the generation is vectorized
+ * over the atoms, which is much faster than restarting the engine for each atom.
+ */
+static void generateAtomRandomBits(const gmx::ThreeFry2x64<0>& rng,
+                                   int64_t                     step,
+                                   int                         start,
+                                   const int*                  gatindex,
+                                   gmx::ArrayRef<uint64_t>     counters,
+                                   gmx::ArrayRef<uint64_t>     randomBits)
+{
+    for (gmx::index i = 0; i < counters.ssize(); i++)
+    {
+        const int n = start + static_cast<int>(i);
+        counters[i] = gatindex ? gatindex[n] : n;
+    }
+    rng.firstForCounters(step, counters, randomBits);
+}
+
 /*! \brief Sets the SD update type */
 enum class SDUpdate : int
 {
@@ -1077,11 +1113,20 @@ static void doSDUpdateGeneral(const gmx_stochd_t&  sd,
     gmx::ThreeFry2x64<0>                       rng(seed, gmx::RandomDomain::UpdateCoordinates);
     gmx::TabulatedNormalDistribution<real, 14> dist;
 
+    std::array<uint64_t, c_randomBitsBatchSize> counters   = {};
+    std::array<uint64_t, c_randomBitsBatchSize> randomBits = {};
+
     for (int n = start; n < nrend; n++)
     {
-        int globalAtomIndex = gatindex ? gatindex[n] : n;
-        rng.restart(step, globalAtomIndex);
-        dist.reset();
+        const int batchIndex = (n - start) % c_randomBitsBatchSize;
+        if (updateType != SDUpdate::ForcesOnly && batchIndex == 0)
+        {
+            const int batchSize = std::min(c_randomBitsBatchSize, nrend - n);
+            generateAtomRandomBits(rng, step, n, gatindex,
+                                   gmx::arrayRefFromArray(counters.data(), batchSize),
+                                   gmx::arrayRefFromArray(randomBits.data(), batchSize));
+        }
+        uint64_t atomRandomBits = randomBits[batchIndex];
 
         real inverseMass = invmass[n];
         real invsqrtMass = std::sqrt(inverseMass);
@@ -1105,7 +1150,8 @@ static void doSDUpdateGeneral(const gmx_stochd_t&  sd,
                 {
                     real vn = v[n][d];
                     v[n][d] = (vn * sd.sdc[temperatureGroup].em
-                               + invsqrtMass * sd.sdsig[temperatureGroup].V * dist(rng));
+                               + invsqrtMass * sd.sdsig[temperatureGroup].V
+                                         * dist.fromRandomBits(&atomRandomBits));
                     // The previous phase already updated the
                     // positions with a full v*dt term that must
                     // now be half removed.
@@ -1115,7 +1161,8 @@ static void doSDUpdateGeneral(const gmx_stochd_t&  sd,
                 {
                     real vn = v[n][d] + (inverseMass * f[n][d] + accel[accelerationGroup][d]) * dt;
                     v[n][d] = (vn * sd.sdc[temperatureGroup].em
-                               + invsqrtMass * sd.sdsig[temperatureGroup].V * dist(rng));
+                               + invsqrtMass * sd.sdsig[temperatureGroup].V
+                                         * dist.fromRandomBits(&atomRandomBits));
                     // Here we include half of the friction+noise
                     // update of v into the position update.
                     xprime[n][d] = x[n][d] + 0.5 * (vn + v[n][d]) * dt;
@@ -1200,6 +1247,9 @@ static void do_update_bd(int         start,
     gmx::ThreeFry2x64<0>                       rng(seed, gmx::RandomDomain::UpdateCoordinates);
     gmx::TabulatedNormalDistribution<real, 14> dist;
 
+    std::array<uint64_t, c_randomBitsBatchSize> counters   = {};
+    std::array<uint64_t, c_randomBitsBatchSize> randomBits = {};
+
     if (friction_coefficient != 0)
     {
         invfr = 1.0 / friction_coefficient;
@@ -1207,10 +1257,15 @@ static void do_update_bd(int         start,
 
     for (n = start; (n < nrend); n++)
     {
-        int ng = gatindex ? gatindex[n] : n;
-
-        rng.restart(step, ng);
-        dist.reset();
+        const int batchIndex = (n - start) % c_randomBitsBatchSize;
+        if (batchIndex == 0)
+        {
+            const int batchSize = std::min(c_randomBitsBatchSize, nrend - n);
+            generateAtomRandomBits(rng, step, n, gatindex,
+                                   gmx::arrayRefFromArray(counters.data(), batchSize),
+                                   gmx::arrayRefFromArray(randomBits.data(), batchSize));
+        }
+        uint64_t atomRandomBits = randomBits[batchIndex];
 
         if (cFREEZE)
         {
@@ -1226,13 +1281,14 @@ static void do_update_bd(int         start,
             {
                 if (friction_coefficient != 0)
                 {
-                    vn = invfr * f[n][d] + rf[gt] * dist(rng);
+                    vn = invfr * f[n][d] + rf[gt] * dist.fromRandomBits(&atomRandomBits);
                 }
                 else
                 {
                     /* NOTE: invmass = 2/(mass*friction_constant*dt) */
                     vn = 0.5 * invmass[n] * f[n][d] * dt
-                         + std::sqrt(0.5 * invmass[n]) * rf[gt] * dist(rng);
+                         + std::sqrt(0.5 * invmass[n]) * rf[gt]
+                                   * dist.fromRandomBits(&atomRandomBits);
                 }
 
                 v[n][d]      = vn;
@@ -1346,6 +1402,58 @@ void getThreadAtomRange(int numThreads, int threadIndex, int numAtoms, int* star
     }
 }
 
+//! Reallocates \p v and copies its contents with the update thread partitioning
+static void placeVectorForThreads(int numThreads, gmx::PaddedHostVector<gmx::RVec>* v)
+{
+    if (v->empty() || v->get_allocator().pinningPolicy() == gmx::PinningPolicy::PinnedIfSupported)
+    {
+        return;
+    }
+
+    // RVec is not initialized on construction, so resizing does not touch the pages
+    gmx::PaddedHostVector<gmx::RVec> placed(v->get_allocator());
+    placed.resizeWithPadding(v->size());
+
+    const int        numAtoms = gmx::ssize(*v);
+    const gmx::RVec* source   = v->data();
+    gmx::RVec*       dest     = placed.data();
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int th = 0; th < numThreads; th++)
+    {
+        try
+        {
+            int startAtom;
+            int endAtom;
+            getThreadAtomRange(numThreads, th, numAtoms, &startAtom, &endAtom);
+            if (th == numThreads - 1)
+            {
+                endAtom = static_cast<int>(v->paddedSize());
+            }
+            std::copy(source + startAtom, source + endAtom, dest + startAtom);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    v->swap(placed);
+}
+
+void placeStateForThreads(int numThreads, t_state* state)
+{
+    if (numThreads <= 1)
+    {
+        return;
+    }
+
+    if (state->flags & (1 << estX))
+    {
+        placeVectorForThreads(numThreads, &state->x);
+    }
+    if (state->flags & (1 << estV))
+    {
+        placeVectorForThreads(numThreads, &state->v);
+    }
+}
+
 void Update::Impl::update_sd_second_half(const t_inputrec& inputRecord,
                                          int64_t           step,
                                          real*             dvdlambda,
@@ -1414,8 +1522,15 @@ void Update::Impl::finish_update(const t_inputrec& inputRecord,
                                  const bool        haveConstraints)
 {
     /* NOTE: Currently we always integrate to a temporary buffer and
-     * then copy the results back here.
+     * then copy the results back here, unless update_coords() did this.
      */
+    if (xpCopiedToState_)
+    {
+        GMX_ASSERT(!haveConstraints,
+                   "The copy can only be fused into the update without constraints");
+        xpCopiedToState_ = false;
+        return;
+    }
 
     wallcycle_start_nocount(wcycle, ewcUPDATE);
 
@@ -1495,8 +1610,15 @@ void Update::Impl::update_coords(const t_inputrec&
     }
 
     /* ############# START The update of velocities and positions ######### */
-    int nth = gmx_omp_nthreads_get(emntUpdate);
+    int nth = updateThreadCountTuner_.numThreads();
+
+    /* With leap-frog and without constraints nothing needs the old coordinates
+     * after the update, so we copy the new ones back to the state here,
+     * per thread and while in cache, instead of in finish_update().
+     */
+    const bool copyToState = (inputRecord.eI == eiMD && !haveConstraints);
 
+    const gmx_cycles_t updateStartCycles = gmx_cycles_read();
 #pragma omp parallel for num_threads(nth) schedule(static)
     for (int th = 0; th < nth; th++)
     {
@@ -1517,6 +1639,11 @@ void Update::Impl::update_coords(const t_inputrec&
                                  inputRecord.opts.acc, inputRecord.etc, inputRecord.epc,
                                  inputRecord.nsttcouple, inputRecord.nstpcouple, md, ekind,
                                  state->box, state->nosehoover_vxi.data(), M);
+                    if (copyToState)
+                    {
+                        std::copy(xp_.begin() + start_th, xp_.begin() + end_th,
+                                  state->x.begin() + start_th);
+                    }
                     break;
                 case (eiSD1):
                     do_update_sd(start_th, end_th, dt, step, x_rvec, xp_rvec, v_rvec, f_rvec,
@@ -1559,6 +1686,9 @@ void Update::Impl::update_coords(const t_inputrec&
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
+    updateThreadCountTuner_.recordCycles(gmx_cycles_read() - updateStartCycles);
+
+    xpCopiedToState_ = copyToState;
 }
 
 void Update::Impl::update_for_constraint_virial(const t_inputrec& inputRecord,
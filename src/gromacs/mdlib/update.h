@@ -243,4 +243,19 @@ void restore_ekinstate_from_state(const t_commrec* cr, gmx_ekindata_t* ekind, co
  */
 void getThreadAtomRange(int numThreads, int threadIndex, int numAtoms, int* startAtom, int* endAtom);
 
+/*! \brief Places the coordinate and velocity buffers of \p state close to the update threads
+ *
+ * With first-touch page placement, the operating system places each memory
+ * page on the NUMA node of the thread that first writes to it. The state is
+ * filled by the master thread, so on multi-socket nodes all update threads
+ * would otherwise access the memory of one socket. This reallocates the
+ * buffers and copies their contents using the same thread partitioning as
+ * getThreadAtomRange(). Buffers that are pinned for GPU transfers are left
+ * untouched, since pinning already touches all pages.
+ *
+ * \param[in]     numThreads  The number of threads used for the update
+ * \param[in,out] state       The state to place
+ */
+void placeStateForThreads(int numThreads, t_state* state);
+
 #endif
@@ -44,6 +44,8 @@
 #ifndef GMX_MDLIB_UPDATE_CONSTRAIN_GPU_H
 #define GMX_MDLIB_UPDATE_CONSTRAIN_GPU_H
 
+#include <cstdint>
+
 #include "gromacs/gpu_utils/devicebuffer_datatype.h"
 #include "gromacs/mdtypes/group.h"
 #include "gromacs/timing/wallcycle.h"
@@ -76,7 +78,8 @@ public:
      * because the markEvent(...) method is called unconditionally.
      *
      * \param[in] ir                Input record data: LINCS takes number of iterations and order of
-     *                              projection from it.
+     *                              projection from it. With the SD integrator, a reference is kept
+     *                              to follow changes of the reference temperatures.
      * \param[in] mtop              Topology of the system: SETTLE gets the masses for O and H atoms
      *                              and target O-H and H-H distances from this object.
      * \param[in] deviceContext     GPU device context.
@@ -101,23 +104,34 @@ public:
      *
      * \param[in]  fReadyOnDevice           Event synchronizer indicating that the forces are
      *                                      ready in the device memory.
+     * \param[in]  spreadVirtualSiteForces  If the forces on virtual sites should be spread
+     *                                      before the update.
      * \param[in]  dt                       Timestep.
+     * \param[in]  step                     The MD step, used for the SD random numbers.
      * \param[in]  updateVelocities         If the velocities should be constrained.
      * \param[in]  computeVirial            If virial should be updated.
      * \param[out] virial                   Place to save virial tensor.
      * \param[in]  doTemperatureScaling     If velocities should be scaled for temperature coupling.
      * \param[in]  tcstat                   Temperature coupling data.
+     * \param[in]  doNoseHoover             If the temperature coupling is Nose-Hoover.
+     * \param[in]  dtTemperatureCouple      Period between temperature coupling steps.
+     * \param[in]  nosehooverVxi            Nose-Hoover thermostat velocities.
      * \param[in]  doParrinelloRahman       If current step is a Parrinello-Rahman pressure coupling step.
      * \param[in]  dtPressureCouple         Period between pressure coupling steps.
      * \param[in]  prVelocityScalingMatrix  Parrinello-Rahman velocity scaling matrix.
      */
     void integrate(GpuEventSynchronizer*             fReadyOnDevice,
+                   bool                              spreadVirtualSiteForces,
                    real                              dt,
+                   int64_t                           step,
                    bool                              updateVelocities,
                    bool                              computeVirial,
                    tensor                            virial,
                    bool                              doTemperatureScaling,
                    gmx::ArrayRef<const t_grp_tcstat> tcstat,
+                   bool                              doNoseHoover,
+                   float                             dtTemperatureCouple,
+                   gmx::ArrayRef<const double>       nosehooverVxi,
                    bool                              doParrinelloRahman,
                    float                             dtPressureCouple,
                    const matrix                      prVelocityScalingMatrix);
@@ -147,13 +161,15 @@ public:
      * \param[in]      idef                System topology
      * \param[in]      md                  Atoms data.
      * \param[in]      numTempScaleValues  Number of temperature scaling groups. Zero for no temperature scaling.
+     * \param[in]      globalAtomIndices   Global atom indices, empty without domain decomposition.
      */
     void set(DeviceBuffer<RVec>            d_x,
              DeviceBuffer<RVec>            d_v,
              DeviceBuffer<RVec>            d_f,
              const InteractionDefinitions& idef,
              const t_mdatoms&              md,
-             int                           numTempScaleValues);
+             int                           numTempScaleValues,
+             ArrayRef<const int>           globalAtomIndices);
 
     /*! \brief
      * Update PBC data.
@@ -177,6 +193,14 @@ public:
      */
     static bool isNumCoupledConstraintsSupported(const gmx_mtop_t& mtop);
 
+    /*! \brief
+     * Returns whether the virtual sites in the system are supported
+     * by the GPU virtual site code.
+     *
+     * \param[in] mtop The molecular topology
+     */
+    static bool areVirtualSitesSupported(const gmx_mtop_t& mtop);
+
 private:
     class Impl;
     gmx::PrivateImplPointer<Impl> impl_;
@@ -71,12 +71,17 @@ UpdateConstrainGpu::UpdateConstrainGpu(const t_inputrec& /* ir   */,
 UpdateConstrainGpu::~UpdateConstrainGpu() = default;
 
 void UpdateConstrainGpu::integrate(GpuEventSynchronizer* /* fReadyOnDevice */,
+                                   const bool /* spreadVirtualSiteForces */,
                                    const real /* dt */,
+                                   const int64_t /* step */,
                                    const bool /* updateVelocities */,
                                    const bool /* computeVirial */,
                                    tensor /* virialScaled */,
                                    const bool /* doTemperatureScaling */,
                                    gmx::ArrayRef<const t_grp_tcstat> /* tcstat */,
+                                   const bool /* doNoseHoover */,
+                                   const float /* dtTemperatureCouple */,
+                                   gmx::ArrayRef<const double> /* nosehooverVxi */,
                                    const bool /* doParrinelloRahman */,
                                    const float /* dtPressureCouple */,
                                    const matrix /* prVelocityScalingMatrix*/)
@@ -102,7 +107,8 @@ void UpdateConstrainGpu::set(DeviceBuffer<RVec> /* d_x */,
                              const DeviceBuffer<RVec> /* d_f */,
                              const InteractionDefinitions& /* idef */,
                              const t_mdatoms& /* md */,
-                             const int /* numTempScaleValues */)
+                             const int /* numTempScaleValues */,
+                             ArrayRef<const int> /* globalAtomIndices */)
 {
     GMX_ASSERT(!impl_,
                "A CPU stub for UpdateConstrain was called instead of the correct implementation.");
@@ -126,6 +132,11 @@ bool UpdateConstrainGpu::isNumCoupledConstraintsSupported(const gmx_mtop_t& /* m
     return false;
 }
 
+bool UpdateConstrainGpu::areVirtualSitesSupported(const gmx_mtop_t& /* mtop */)
+{
+    return false;
+}
+
 } // namespace gmx
 
 #endif /* !GMX_GPU_CUDA */
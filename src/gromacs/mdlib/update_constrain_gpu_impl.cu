@@ -36,7 +36,7 @@
  *
  * \brief Implements update and constraints class using CUDA.
  *
- * The class combines Leap-Frog integrator with LINCS and SETTLE constraints.
+ * The class combines the Leap-Frog or SD integrator with LINCS and SETTLE constraints.
  *
  * \todo The computational procedures in members should be integrated to improve
  *       computational performance.
@@ -64,9 +64,12 @@
 #include "gromacs/gpu_utils/vectype_ops.cuh"
 #include "gromacs/mdlib/leapfrog_gpu.h"
 #include "gromacs/mdlib/lincs_gpu.cuh"
+#include "gromacs/mdlib/sd_gpu.h"
 #include "gromacs/mdlib/settle_gpu.cuh"
 #include "gromacs/mdlib/update_constrain_gpu.h"
+#include "gromacs/mdlib/vsite_gpu.cuh"
 #include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/topology/mtop_util.h"
 #include "gromacs/timing/wallcycle.h"
 
 namespace gmx
@@ -107,12 +110,17 @@ __launch_bounds__(c_maxThreadsPerBlock) __global__
 }
 
 void UpdateConstrainGpu::Impl::integrate(GpuEventSynchronizer*             fReadyOnDevice,
+                                         const bool                        spreadVirtualSiteForces,
                                          const real                        dt,
+                                         const int64_t                     step,
                                          const bool                        updateVelocities,
                                          const bool                        computeVirial,
                                          tensor                            virial,
                                          const bool                        doTemperatureScaling,
                                          gmx::ArrayRef<const t_grp_tcstat> tcstat,
+                                         const bool                        doNoseHoover,
+                                         const float                       dtTemperatureCouple,
+                                         gmx::ArrayRef<const double>       nosehooverVxi,
                                          const bool                        doParrinelloRahman,
                                          const float                       dtPressureCouple,
                                          const matrix                      prVelocityScalingMatrix)
@@ -127,15 +135,48 @@ void UpdateConstrainGpu::Impl::integrate(GpuEventSynchronizer*             fRead
     // Make sure that the forces are ready on device before proceeding with the update.
     fReadyOnDevice->enqueueWaitEvent(deviceStream_);
 
+    if (spreadVirtualSiteForces)
+    {
+        virtualSitesGpu_->spreadForces(d_x_, d_f_, pbcAiuc_);
+    }
+
     // The integrate should save a copy of the current coordinates in d_xp_ and write updated
-    // once into d_x_. The d_xp_ is only needed by constraints.
-    integrator_->integrate(d_x_, d_xp_, d_v_, d_f_, dt, doTemperatureScaling, tcstat,
-                           doParrinelloRahman, dtPressureCouple, prVelocityScalingMatrix);
+    // once into d_x_. The d_xp_ is only needed by constraints and virtual sites.
+    if (sdIntegrator_)
+    {
+        // As on the CPU, SD does not apply temperature or Parrinello-Rahman velocity scaling
+        sdIntegrator_->updateTemperatureConstants(inputRecord_);
+        const SdUpdatePart updatePart =
+                haveConstraints_ ? SdUpdatePart::ForcesOnly : SdUpdatePart::Combined;
+        sdIntegrator_->integrate(d_x_, d_xp_, d_v_, d_f_, dt, step, updatePart);
+    }
+    else
+    {
+        integrator_->integrate(d_x_, d_xp_, d_v_, d_f_, dt, doTemperatureScaling, tcstat,
+                               doNoseHoover, dtTemperatureCouple, nosehooverVxi,
+                               doParrinelloRahman, dtPressureCouple, prVelocityScalingMatrix);
+    }
     // Constraints need both coordinates before (d_x_) and after (d_xp_) update. However, after constraints
     // are applied, the d_x_ can be discarded. So we intentionally swap the d_x_ and d_xp_ here to avoid the
     // d_xp_ -> d_x_ copy after constraints. Note that the integrate saves them in the wrong order as well.
     lincsGpu_->apply(d_xp_, d_x_, updateVelocities, d_v_, 1.0 / dt, computeVirial, virial, pbcAiuc_);
     settleGpu_->apply(d_xp_, d_x_, updateVelocities, d_v_, 1.0 / dt, computeVirial, virial, pbcAiuc_);
+    if (sdIntegrator_ && haveConstraints_)
+    {
+        // Apply friction and noise to the constrained velocities and constrain the coordinates
+        // again, now over half a time step, as in Update::update_sd_second_half().
+        // This does not contribute to the virial.
+        sdIntegrator_->integrate(d_x_, d_xp_, d_v_, d_f_, dt, step,
+                                 SdUpdatePart::FrictionAndNoiseOnly);
+        const real invHalfDt = 2.0 / dt;
+        tensor     unusedVirial;
+        lincsGpu_->apply(d_xp_, d_x_, updateVelocities, d_v_, invHalfDt, false, unusedVirial,
+                         pbcAiuc_);
+        settleGpu_->apply(d_xp_, d_x_, updateVelocities, d_v_, invHalfDt, false, unusedVirial,
+                          pbcAiuc_);
+    }
+    // The coordinates before the update, now in d_xp_, give the velocities of virtual sites
+    virtualSitesGpu_->construct(d_xp_, d_x_, updateVelocities, d_v_, 1.0 / dt, pbcAiuc_);
 
     // scaledVirial -> virial (methods above returns scaled values)
     float scaleFactor = 0.5f / (dt * dt);
@@ -213,6 +254,8 @@ UpdateConstrainGpu::Impl::Impl(const t_inputrec&     ir,
                                gmx_wallcycle*        wcycle) :
     deviceContext_(deviceContext),
     deviceStream_(deviceStream),
+    inputRecord_(ir),
+    haveConstraints_(gmx_mtop_interaction_count(mtop, IF_CONSTRAINT) > 0),
     coordinatesReady_(xUpdatedOnDevice),
     wcycle_(wcycle)
 {
@@ -220,8 +263,15 @@ UpdateConstrainGpu::Impl::Impl(const t_inputrec&     ir,
 
 
     integrator_ = std::make_unique<LeapFrogGpu>(deviceContext_, deviceStream_);
+    if (ir.eI == eiSD1)
+    {
+        // The CPU SD update takes the seed as int, which we need to match for identical noise
+        sdIntegrator_ = std::make_unique<StochasticDynamicsGpu>(deviceContext_, deviceStream_,
+                                                                static_cast<int>(ir.ld_seed));
+    }
     lincsGpu_ = std::make_unique<LincsGpu>(ir.nLincsIter, ir.nProjOrder, deviceContext_, deviceStream_);
     settleGpu_ = std::make_unique<SettleGpu>(mtop, deviceContext_, deviceStream_);
+    virtualSitesGpu_ = std::make_unique<VirtualSitesGpu>(deviceContext_, deviceStream_);
 
     coordinateScalingKernelLaunchConfig_.blockSize[0]     = c_threadsPerBlock;
     coordinateScalingKernelLaunchConfig_.blockSize[1]     = 1;
@@ -236,7 +286,8 @@ void UpdateConstrainGpu::Impl::set(DeviceBuffer<RVec>            d_x,
                                    const DeviceBuffer<RVec>      d_f,
                                    const InteractionDefinitions& idef,
                                    const t_mdatoms&              md,
-                                   const int                     numTempScaleValues)
+                                   const int                     numTempScaleValues,
+                                   ArrayRef<const int>           globalAtomIndices)
 {
     // TODO wallcycle
     wallcycle_start_nocount(wcycle_, ewcLAUNCH_GPU);
@@ -259,8 +310,13 @@ void UpdateConstrainGpu::Impl::set(DeviceBuffer<RVec>            d_x,
 
     // Integrator should also update something, but it does not even have a method yet
     integrator_->set(numAtoms_, md.invmass, numTempScaleValues, md.cTC);
+    if (sdIntegrator_)
+    {
+        sdIntegrator_->set(numAtoms_, md.invmass, numTempScaleValues, md.cTC, globalAtomIndices);
+    }
     lincsGpu_->set(idef, numAtoms_, md.invmass);
     settleGpu_->set(idef);
+    virtualSitesGpu_->set(idef);
 
     coordinateScalingKernelLaunchConfig_.gridSize[0] =
             (numAtoms_ + c_threadsPerBlock - 1) / c_threadsPerBlock;
@@ -293,18 +349,25 @@ UpdateConstrainGpu::UpdateConstrainGpu(const t_inputrec&     ir,
 UpdateConstrainGpu::~UpdateConstrainGpu() = default;
 
 void UpdateConstrainGpu::integrate(GpuEventSynchronizer*             fReadyOnDevice,
+                                   const bool                        spreadVirtualSiteForces,
                                    const real                        dt,
+                                   const int64_t                     step,
                                    const bool                        updateVelocities,
                                    const bool                        computeVirial,
                                    tensor                            virialScaled,
                                    const bool                        doTemperatureScaling,
                                    gmx::ArrayRef<const t_grp_tcstat> tcstat,
+                                   const bool                        doNoseHoover,
+                                   const float                       dtTemperatureCouple,
+                                   gmx::ArrayRef<const double>       nosehooverVxi,
                                    const bool                        doParrinelloRahman,
                                    const float                       dtPressureCouple,
                                    const matrix                      prVelocityScalingMatrix)
 {
-    impl_->integrate(fReadyOnDevice, dt, updateVelocities, computeVirial, virialScaled, doTemperatureScaling,
-                     tcstat, doParrinelloRahman, dtPressureCouple, prVelocityScalingMatrix);
+    impl_->integrate(fReadyOnDevice, spreadVirtualSiteForces, dt, step, updateVelocities,
+                     computeVirial, virialScaled, doTemperatureScaling, tcstat, doNoseHoover,
+                     dtTemperatureCouple, nosehooverVxi, doParrinelloRahman, dtPressureCouple,
+                     prVelocityScalingMatrix);
 }
 
 void UpdateConstrainGpu::scaleCoordinates(const matrix scalingMatrix)
@@ -322,9 +385,10 @@ void UpdateConstrainGpu::set(DeviceBuffer<RVec>            d_x,
                              const DeviceBuffer<RVec>      d_f,
                              const InteractionDefinitions& idef,
                              const t_mdatoms&              md,
-                             const int                     numTempScaleValues)
+                             const int                     numTempScaleValues,
+                             ArrayRef<const int>           globalAtomIndices)
 {
-    impl_->set(d_x, d_v, d_f, idef, md, numTempScaleValues);
+    impl_->set(d_x, d_v, d_f, idef, md, numTempScaleValues, globalAtomIndices);
 }
 
 void UpdateConstrainGpu::setPbc(const PbcType pbcType, const matrix box)
@@ -342,4 +406,9 @@ bool UpdateConstrainGpu::isNumCoupledConstraintsSupported(const gmx_mtop_t& mtop
     return LincsGpu::isNumCoupledConstraintsSupported(mtop);
 }
 
+bool UpdateConstrainGpu::areVirtualSitesSupported(const gmx_mtop_t& mtop)
+{
+    return VirtualSitesGpu::areVirtualSitesSupported(mtop);
+}
+
 } // namespace gmx
@@ -51,8 +51,10 @@
 #include "gromacs/gpu_utils/gpueventsynchronizer.cuh"
 #include "gromacs/mdlib/leapfrog_gpu.h"
 #include "gromacs/mdlib/lincs_gpu.cuh"
+#include "gromacs/mdlib/sd_gpu.h"
 #include "gromacs/mdlib/settle_gpu.cuh"
 #include "gromacs/mdlib/update_constrain_gpu.h"
+#include "gromacs/mdlib/vsite_gpu.cuh"
 #include "gromacs/mdtypes/inputrec.h"
 
 namespace gmx
@@ -72,7 +74,8 @@ public:
      * because the markEvent(...) method is called unconditionally.
      *
      * \param[in] ir                Input record data: LINCS takes number of iterations and order of
-     *                              projection from it.
+     *                              projection from it. With the SD integrator, a reference is kept
+     *                              to follow changes of the reference temperatures.
      * \param[in] mtop              Topology of the system: SETTLE gets the masses for O and H atoms
      *                              and target O-H and H-H distances from this object.
      * \param[in] deviceContext     GPU device context.
@@ -92,8 +95,8 @@ public:
 
     /*! \brief Integrate
      *
-     * Integrates the equation of motion using Leap-Frog algorithm and applies
-     * LINCS and SETTLE constraints.
+     * Integrates the equation of motion using Leap-Frog algorithm, or the SD integrator,
+     * and applies LINCS and SETTLE constraints. Virtual sites are constructed after the update.
      * If computeVirial is true, constraints virial is written at the provided pointer.
      * doTempCouple should be true if:
      *   1. The temperature coupling is enabled.
@@ -102,23 +105,34 @@ public:
      *
      * \param[in]  fReadyOnDevice           Event synchronizer indicating that the forces are ready in
      *                                      the device memory.
+     * \param[in]  spreadVirtualSiteForces  If the forces on virtual sites should be spread
+     *                                      before the update.
      * \param[in]  dt                       Timestep.
+     * \param[in]  step                     The MD step, used for the SD random numbers.
      * \param[in]  updateVelocities         If the velocities should be constrained.
      * \param[in]  computeVirial            If virial should be updated.
      * \param[out] virial                   Place to save virial tensor.
      * \param[in]  doTemperatureScaling     If velocities should be scaled for temperature coupling.
      * \param[in]  tcstat                   Temperature coupling data.
+     * \param[in]  doNoseHoover             If the temperature coupling is Nose-Hoover.
+     * \param[in]  dtTemperatureCouple      Period between temperature coupling steps.
+     * \param[in]  nosehooverVxi            Nose-Hoover thermostat velocities.
      * \param[in]  doParrinelloRahman       If current step is a Parrinello-Rahman pressure coupling step.
      * \param[in]  dtPressureCouple         Period between pressure coupling steps.
      * \param[in]  prVelocityScalingMatrix  Parrinello-Rahman velocity scaling matrix.
      */
     void integrate(GpuEventSynchronizer*             fReadyOnDevice,
+                   bool                              spreadVirtualSiteForces,
                    real                              dt,
+                   int64_t                           step,
                    bool                              updateVelocities,
                    bool                              computeVirial,
                    tensor                            virial,
                    bool                              doTemperatureScaling,
                    gmx::ArrayRef<const t_grp_tcstat> tcstat,
+                   bool                              doNoseHoover,
+                   float                             dtTemperatureCouple,
+                   gmx::ArrayRef<const double>       nosehooverVxi,
                    bool                              doParrinelloRahman,
                    float                             dtPressureCouple,
                    const matrix                      prVelocityScalingMatrix);
@@ -148,13 +162,15 @@ public:
      * \param[in] idef                System topology
      * \param[in] md                  Atoms data.
      * \param[in] numTempScaleValues  Number of temperature scaling groups. Set zero for no temperature coupling.
+     * \param[in] globalAtomIndices   Global atom indices, empty without domain decomposition.
      */
     void set(DeviceBuffer<RVec>            d_x,
              DeviceBuffer<RVec>            d_v,
              const DeviceBuffer<RVec>      d_f,
              const InteractionDefinitions& idef,
              const t_mdatoms&              md,
-             const int                     numTempScaleValues);
+             const int                     numTempScaleValues,
+             ArrayRef<const int>           globalAtomIndices);
 
     /*! \brief
      * Update PBC data.
@@ -214,12 +230,25 @@ private:
     //! Allocation size for the reciprocal masses buffer
     int numInverseMassesAlloc_ = -1;
 
+    /*! \brief Input record
+     *
+     * Kept to follow changes of the reference temperatures, e.g. with simulated annealing,
+     * in the SD integrator.
+     */
+    const t_inputrec& inputRecord_;
+    //! Whether the system has constraints, then SD performs its update in two parts
+    bool haveConstraints_;
+
     //! Leap-Frog integrator
     std::unique_ptr<LeapFrogGpu> integrator_;
+    //! SD integrator, only used with integrator = sd
+    std::unique_ptr<StochasticDynamicsGpu> sdIntegrator_;
     //! LINCS GPU object to use for non-water constraints
     std::unique_ptr<LincsGpu> lincsGpu_;
     //! SETTLE GPU object for water constrains
     std::unique_ptr<SettleGpu> settleGpu_;
+    //! Virtual sites GPU object
+    std::unique_ptr<VirtualSitesGpu> virtualSitesGpu_;
 
     //! An pointer to the event to indicate when the update of coordinates is complete
     GpuEventSynchronizer* coordinatesReady_;
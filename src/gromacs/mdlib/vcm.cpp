@@ -151,6 +151,29 @@ static void update_tensor(const rvec x, real m0, tensor I)
     I[ZZ][YY] += yz;
 }
 
+/*! \brief Adds the sums in \p src to \p dest and clears \p src
+ *
+ * \param[in,out] dest     The accumulation buffer to add to
+ * \param[in,out] src      The partial sums, cleared on return
+ * \param[in]     angular  Whether angular momentum sums are used
+ */
+static void addAndClearVcmSums(t_vcm_thread* dest, t_vcm_thread* src, bool angular)
+{
+    dest->mass += src->mass;
+    rvec_inc(dest->p, src->p);
+    src->mass = 0;
+    clear_rvec(src->p);
+    if (angular)
+    {
+        rvec_inc(dest->j, src->j);
+        rvec_inc(dest->x, src->x);
+        m_add(src->i, dest->i, dest->i);
+        clear_rvec(src->j);
+        clear_rvec(src->x);
+        clear_mat(src->i);
+    }
+}
+
 /* Center of mass code for groups */
 void calc_vcm_grp(const t_mdatoms&               md,
                   gmx::ArrayRef<const gmx::RVec> x,
@@ -182,6 +205,14 @@ void calc_vcm_grp(const t_mdatoms&               md,
                 }
             }
 
+            /* We sum into local variables and only add these to the thread
+             * buffer of a group when the group changes, since atoms of the
+             * same group are usually consecutive.
+             */
+            const bool   angular = (vcm->mode == ecmANGULAR);
+            t_vcm_thread localSums;
+            int          localGroup = 0;
+
 #pragma omp for schedule(static)
             for (int i = 0; i < md.homenr; i++)
             {
@@ -191,16 +222,21 @@ void calc_vcm_grp(const t_mdatoms&               md,
                 {
                     g = md.cVCM[i];
                 }
-                t_vcm_thread* vcm_t = &vcm->thread_vcm[t * vcm->stride + g];
+                if (g != localGroup)
+                {
+                    addAndClearVcmSums(
+                            &vcm->thread_vcm[t * vcm->stride + localGroup], &localSums, angular);
+                    localGroup = g;
+                }
                 /* Calculate linear momentum */
-                vcm_t->mass += m0;
+                localSums.mass += m0;
                 int m;
                 for (m = 0; (m < DIM); m++)
                 {
-                    vcm_t->p[m] += m0 * v[i][m];
+                    localSums.p[m] += m0 * v[i][m];
                 }
 
-                if (vcm->mode == ecmANGULAR)
+                if (angular)
                 {
                     /* Calculate angular momentum */
                     rvec j0;
@@ -208,13 +244,14 @@ void calc_vcm_grp(const t_mdatoms&               md,
 
                     for (m = 0; (m < DIM); m++)
                     {
-                        vcm_t->j[m] += m0 * j0[m];
-                        vcm_t->x[m] += m0 * x[i][m];
+                        localSums.j[m] += m0 * j0[m];
+                        localSums.x[m] += m0 * x[i][m];
                     }
                     /* Update inertia tensor */
-                    update_tensor(x[i], m0, vcm_t->i);
+                    update_tensor(x[i], m0, localSums.i);
                 }
             }
+            addAndClearVcmSums(&vcm->thread_vcm[t * vcm->stride + localGroup], &localSums, angular);
         }
         for (int g = 0; g < vcm->size; g++)
         {
@@ -0,0 +1,525 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Implements virtual site construction and force spreading using CUDA
+ *
+ * The construction and spreading expressions are the same as those
+ * in vsite.cpp, without the virial contributions.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "vsite_gpu.cuh"
+
+#include <assert.h>
+
+#include <vector>
+
+#include "gromacs/gpu_utils/cudautils.cuh"
+#include "gromacs/gpu_utils/devicebuffer.h"
+#include "gromacs/gpu_utils/gputraits.cuh"
+#include "gromacs/gpu_utils/vectype_ops.cuh"
+#include "gromacs/pbcutil/pbc_aiuc_cuda.cuh"
+#include "gromacs/topology/idef.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+//! Number of CUDA threads in a block
+constexpr static int c_threadsPerBlock = 256;
+//! Maximum number of threads in a block (for __launch_bounds__)
+constexpr static int c_maxThreadsPerBlock = c_threadsPerBlock;
+
+//! The last virtual site type handled on the GPU, F_VSITEN is not supported
+constexpr static int c_ftypeVsiteGpuEnd = F_VSITEN;
+
+//! Returns the 1/norm of \p a
+static __forceinline__ __device__ float inverseNorm(const float3 a)
+{
+    return rsqrt(norm2(a));
+}
+
+/*! \brief Returns the position of a virtual site constructed from the atoms in \p gm_x
+ *
+ * See the constr_vsite* functions in vsite.cpp.
+ */
+static __forceinline__ __device__ float3 constructVirtualSite(const VirtualSiteGpuEntry& vsite,
+                                                              const float3* __restrict__ gm_x,
+                                                              const PbcAiuc& pbcAiuc)
+{
+    const float3 xi = gm_x[vsite.atoms[1]];
+
+    switch (vsite.ftype)
+    {
+        case F_VSITE1: return xi;
+        case F_VSITE2:
+        {
+            const float3 xij = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[2]], xi);
+            return xi + vsite.a * xij;
+        }
+        case F_VSITE2FD:
+        {
+            const float3 xij = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[2]], xi);
+            return xi + (vsite.a * inverseNorm(xij)) * xij;
+        }
+        case F_VSITE3:
+        {
+            const float3 xij = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[2]], xi);
+            const float3 xik = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[3]], xi);
+            return xi + vsite.a * xij + vsite.b * xik;
+        }
+        case F_VSITE3FD:
+        {
+            const float3 xj  = gm_x[vsite.atoms[2]];
+            const float3 xij = pbcDxAiuc(pbcAiuc, xj, xi);
+            const float3 xjk = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[3]], xj);
+            // temp goes from i to a point on the line jk
+            const float3 temp = xij + vsite.a * xjk;
+            return xi + (vsite.b * inverseNorm(temp)) * temp;
+        }
+        case F_VSITE3FAD:
+        {
+            const float3 xj     = gm_x[vsite.atoms[2]];
+            const float3 xij    = pbcDxAiuc(pbcAiuc, xj, xi);
+            const float3 xjk    = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[3]], xj);
+            const float  invdij = inverseNorm(xij);
+            const float  c1     = invdij * invdij * iprod(xij, xjk);
+            const float3 xp     = xjk - c1 * xij;
+            return xi + (vsite.a * invdij) * xij + (vsite.b * inverseNorm(xp)) * xp;
+        }
+        case F_VSITE3OUT:
+        {
+            const float3 xij = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[2]], xi);
+            const float3 xik = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[3]], xi);
+            return xi + vsite.a * xij + vsite.b * xik + vsite.c * cprod(xij, xik);
+        }
+        case F_VSITE4FD:
+        {
+            const float3 xj  = gm_x[vsite.atoms[2]];
+            const float3 xij = pbcDxAiuc(pbcAiuc, xj, xi);
+            const float3 xjk = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[3]], xj);
+            const float3 xjl = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[4]], xj);
+            // temp goes from i to a point on the plane jkl
+            const float3 temp = xij + vsite.a * xjk + vsite.b * xjl;
+            return xi + (vsite.c * inverseNorm(temp)) * temp;
+        }
+        case F_VSITE4FDN:
+        {
+            const float3 xij = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[2]], xi);
+            const float3 xik = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[3]], xi);
+            const float3 xil = pbcDxAiuc(pbcAiuc, gm_x[vsite.atoms[4]], xi);
+            const float3 rja = vsite.a * xik - xij;
+            const float3 rjb = vsite.b * xil - xij;
+            const float3 rm  = cprod(rja, rjb);
+            return xi + (vsite.c * inverseNorm(rm)) * rm;
+        }
+        default: assert(false); return xi;
+    }
+}
+
+/*! \brief Virtual site construction kernel
+ *
+ * Each thread constructs a single virtual site.
+ *
+ * \param[in]     numVirtualSites  Number of virtual sites.
+ * \param[in]     gm_virtualSites  The virtual sites with their atoms and parameters.
+ * \param[in]     gm_xOld          Coordinates before the update.
+ * \param[in,out] gm_x             Coordinates, the virtual sites are written here.
+ * \param[in]     invdt            Reciprocal timestep.
+ * \param[out]    gm_v             Velocities, set for virtual sites when updateVelocities.
+ * \param[in]     pbcAiuc          Periodic boundary conditions data.
+ */
+template<bool updateVelocities>
+__launch_bounds__(c_maxThreadsPerBlock) __global__
+        void constructVirtualSites_kernel(const int numVirtualSites,
+                                          const VirtualSiteGpuEntry* __restrict__ gm_virtualSites,
+                                          const float3* __restrict__ gm_xOld,
+                                          float3* __restrict__ gm_x,
+                                          const float invdt,
+                                          float3* __restrict__ gm_v,
+                                          const PbcAiuc pbcAiuc)
+{
+    const int threadIndex = blockIdx.x * blockDim.x + threadIdx.x;
+    if (threadIndex < numVirtualSites)
+    {
+        const VirtualSiteGpuEntry vsite = gm_virtualSites[threadIndex];
+
+        const float3 xv    = constructVirtualSite(vsite, gm_x, pbcAiuc);
+        const float3 xvOld = gm_xOld[vsite.atoms[0]];
+
+        // Keep the virtual site in the same periodic image as before
+        const float3 dx = pbcDxAiuc(pbcAiuc, xv, xvOld);
+
+        gm_x[vsite.atoms[0]] = xvOld + dx;
+        if (updateVelocities)
+        {
+            gm_v[vsite.atoms[0]] = invdt * dx;
+        }
+    }
+}
+
+/*! \brief Spreads the force \p fv on a virtual site to its constructing atoms
+ *
+ * See the spread_vsite* functions in vsite.cpp.
+ */
+static __forceinline__ __device__ void spreadVirtualSiteForce(const VirtualSiteGpuEntry& vsite,
+                                                              const float3 fv,
+                                                              const float3* __restrict__ gm_x,
+                                                              float3* __restrict__ gm_f,
+                                                              const PbcAiuc& pbcAiuc)
+{
+    const float  a  = vsite.a;
+    const float  b  = vsite.b;
+    const float  c  = vsite.c;
+    const int    ai = vsite.atoms[1];
+    const int    aj = vsite.atoms[2];
+    const int    ak = vsite.atoms[3];
+    const int    al = vsite.atoms[4];
+    const float3 xi = gm_x[ai];
+
+    switch (vsite.ftype)
+    {
+        case F_VSITE1: atomicAdd(&gm_f[ai], fv); break;
+        case F_VSITE2:
+            atomicAdd(&gm_f[ai], (1 - a) * fv);
+            atomicAdd(&gm_f[aj], a * fv);
+            break;
+        case F_VSITE2FD:
+        {
+            const float3 xij         = pbcDxAiuc(pbcAiuc, gm_x[aj], xi);
+            const float  invDistance = inverseNorm(xij);
+            const float  fproj       = iprod(xij, fv) * invDistance * invDistance;
+            const float3 fj          = (a * invDistance) * (fv - fproj * xij);
+            atomicAdd(&gm_f[ai], fv - fj);
+            atomicAdd(&gm_f[aj], fj);
+            break;
+        }
+        case F_VSITE3:
+            atomicAdd(&gm_f[ai], (1 - a - b) * fv);
+            atomicAdd(&gm_f[aj], a * fv);
+            atomicAdd(&gm_f[ak], b * fv);
+            break;
+        case F_VSITE3FD:
+        {
+            const float3 xj  = gm_x[aj];
+            const float3 xij = pbcDxAiuc(pbcAiuc, xj, xi);
+            const float3 xjk = pbcDxAiuc(pbcAiuc, gm_x[ak], xj);
+            // xix goes from i to point x on the line jk
+            const float3 xix         = xij + a * xjk;
+            const float  invDistance = inverseNorm(xix);
+            const float  fproj       = iprod(xix, fv) * invDistance * invDistance;
+            const float3 temp        = (b * invDistance) * (fv - fproj * xix);
+            atomicAdd(&gm_f[ai], fv - temp);
+            atomicAdd(&gm_f[aj], (1 - a) * temp);
+            atomicAdd(&gm_f[ak], a * temp);
+            break;
+        }
+        case F_VSITE3FAD:
+        {
+            const float3 xj      = gm_x[aj];
+            const float3 xij     = pbcDxAiuc(pbcAiuc, xj, xi);
+            const float3 xjk     = pbcDxAiuc(pbcAiuc, gm_x[ak], xj);
+            const float  invdij  = inverseNorm(xij);
+            const float  invdij2 = invdij * invdij;
+            const float  c1      = iprod(xij, xjk) * invdij2;
+            // xperp in plane ijk, perpendicular to ij
+            const float3 xperp = xjk - c1 * xij;
+            const float  invdp = inverseNorm(xperp);
+            const float  a1    = a * invdij;
+            const float  b1    = b * invdp;
+            const float  fproj = iprod(xij, fv) * invdij2;
+            // The projections of f on xij and on xperp
+            const float3 fpij = fproj * xij;
+            const float3 fppp = (iprod(xperp, fv) * invdp * invdp) * xperp;
+            const float3 f3   = (b1 * fproj) * xperp;
+            const float3 f1   = a1 * (fv - fpij);
+            const float3 f2   = b1 * (fv - fpij - fppp);
+            const float  c2   = 1 + c1;
+            atomicAdd(&gm_f[ai], fv - f1 + c1 * f2 + f3);
+            atomicAdd(&gm_f[aj], f1 - c2 * f2 - f3);
+            atomicAdd(&gm_f[ak], f2);
+            break;
+        }
+        case F_VSITE3OUT:
+        {
+            const float3 xij = pbcDxAiuc(pbcAiuc, gm_x[aj], xi);
+            const float3 xik = pbcDxAiuc(pbcAiuc, gm_x[ak], xi);
+            const float3 cfv = c * fv;
+            const float3 fj  = a * fv + cprod(xik, cfv);
+            const float3 fk  = b * fv + cprod(cfv, xij);
+            atomicAdd(&gm_f[ai], fv - fj - fk);
+            atomicAdd(&gm_f[aj], fj);
+            atomicAdd(&gm_f[ak], fk);
+            break;
+        }
+        case F_VSITE4FD:
+        {
+            const float3 xj  = gm_x[aj];
+            const float3 xij = pbcDxAiuc(pbcAiuc, xj, xi);
+            const float3 xjk = pbcDxAiuc(pbcAiuc, gm_x[ak], xj);
+            const float3 xjl = pbcDxAiuc(pbcAiuc, gm_x[al], xj);
+            // xix goes from i to point x on the plane jkl
+            const float3 xix         = xij + a * xjk + b * xjl;
+            const float  invDistance = inverseNorm(xix);
+            const float  fproj       = iprod(xix, fv) * invDistance * invDistance;
+            const float3 temp        = (c * invDistance) * (fv - fproj * xix);
+            atomicAdd(&gm_f[ai], fv - temp);
+            atomicAdd(&gm_f[aj], (1 - a - b) * temp);
+            atomicAdd(&gm_f[ak], a * temp);
+            atomicAdd(&gm_f[al], b * temp);
+            break;
+        }
+        case F_VSITE4FDN:
+        {
+            const float3 xij   = pbcDxAiuc(pbcAiuc, gm_x[aj], xi);
+            const float3 xik   = pbcDxAiuc(pbcAiuc, gm_x[ak], xi);
+            const float3 xil   = pbcDxAiuc(pbcAiuc, gm_x[al], xi);
+            const float3 ra    = a * xik;
+            const float3 rb    = b * xil;
+            const float3 rja   = ra - xij;
+            const float3 rjb   = rb - xij;
+            const float3 rab   = rb - ra;
+            const float3 rm    = cprod(rja, rjb);
+            const float  invrm = inverseNorm(rm);
+            const float  denom = invrm * invrm;
+            const float3 cfv   = (c * invrm) * fv;
+            const float  rmcfv = iprod(rm, cfv);
+            // These are the component-wise expressions of spread_vsite4FDN() written with
+            // vector products
+            const float3 fj = cprod(cfv, rab) - (rmcfv * denom) * cprod(rm, rab);
+            const float3 fk = a * cprod(rjb, cfv) - (rmcfv * denom * a) * cprod(rjb, rm);
+            const float3 fl = b * cprod(cfv, rja) - (rmcfv * denom * b) * cprod(rm, rja);
+            atomicAdd(&gm_f[ai], fv - fj - fk - fl);
+            atomicAdd(&gm_f[aj], fj);
+            atomicAdd(&gm_f[ak], fk);
+            atomicAdd(&gm_f[al], fl);
+            break;
+        }
+        default: assert(false);
+    }
+}
+
+/*! \brief Virtual site force spreading kernel
+ *
+ * Each thread spreads the force of a single virtual site and clears it.
+ * As virtual sites are not constructed from other virtual sites, the forces
+ * on virtual sites are not modified by other threads.
+ *
+ * \param[in]     numVirtualSites  Number of virtual sites.
+ * \param[in]     gm_virtualSites  The virtual sites with their atoms and parameters.
+ * \param[in]     gm_x             Coordinates.
+ * \param[in,out] gm_f             Forces.
+ * \param[in]     pbcAiuc          Periodic boundary conditions data.
+ */
+__launch_bounds__(c_maxThreadsPerBlock) __global__
+        void spreadVirtualSiteForces_kernel(const int numVirtualSites,
+                                            const VirtualSiteGpuEntry* __restrict__ gm_virtualSites,
+                                            const float3* __restrict__ gm_x,
+                                            float3* __restrict__ gm_f,
+                                            const PbcAiuc pbcAiuc)
+{
+    const int threadIndex = blockIdx.x * blockDim.x + threadIdx.x;
+    if (threadIndex < numVirtualSites)
+    {
+        const VirtualSiteGpuEntry vsite = gm_virtualSites[threadIndex];
+
+        const float3 fv = gm_f[vsite.atoms[0]];
+        spreadVirtualSiteForce(vsite, fv, gm_x, gm_f, pbcAiuc);
+        gm_f[vsite.atoms[0]] = make_float3(0.0F);
+    }
+}
+
+//! Returns the launch configuration for one thread per virtual site
+static KernelLaunchConfig virtualSitesLaunchConfig(const int numVirtualSites)
+{
+    KernelLaunchConfig config;
+    config.blockSize[0]     = c_threadsPerBlock;
+    config.blockSize[1]     = 1;
+    config.blockSize[2]     = 1;
+    config.gridSize[0]      = (numVirtualSites + c_threadsPerBlock - 1) / c_threadsPerBlock;
+    config.gridSize[1]      = 1;
+    config.gridSize[2]      = 1;
+    config.sharedMemorySize = 0;
+
+    return config;
+}
+
+void VirtualSitesGpu::construct(const float3* d_xOld,
+                                float3*       d_x,
+                                const bool    updateVelocities,
+                                float3*       d_v,
+                                const real    invdt,
+                                const PbcAiuc pbcAiuc)
+{
+    ensureNoPendingCudaError("In CUDA version of virtual site construction");
+
+    // Early exit if no virtual sites
+    if (numVirtualSites_ == 0)
+    {
+        return;
+    }
+
+    auto kernelPtr = updateVelocities ? constructVirtualSites_kernel<true>
+                                      : constructVirtualSites_kernel<false>;
+
+    const KernelLaunchConfig config = virtualSitesLaunchConfig(numVirtualSites_);
+
+    const float invdtFloat = invdt;
+    const auto  kernelArgs = prepareGpuKernelArguments(kernelPtr, config, &numVirtualSites_,
+                                                      &d_virtualSites_, &d_xOld, &d_x,
+                                                      &invdtFloat, &d_v, &pbcAiuc);
+
+    launchGpuKernel(kernelPtr, config, deviceStream_, nullptr,
+                    "constructVirtualSites_kernel<updateVelocities>", kernelArgs);
+}
+
+void VirtualSitesGpu::spreadForces(const float3* d_x, float3* d_f, const PbcAiuc pbcAiuc)
+{
+    ensureNoPendingCudaError("In CUDA version of virtual site force spreading");
+
+    // Early exit if no virtual sites
+    if (numVirtualSites_ == 0)
+    {
+        return;
+    }
+
+    auto kernelPtr = spreadVirtualSiteForces_kernel;
+
+    const KernelLaunchConfig config = virtualSitesLaunchConfig(numVirtualSites_);
+
+    const auto kernelArgs = prepareGpuKernelArguments(kernelPtr, config, &numVirtualSites_,
+                                                      &d_virtualSites_, &d_x, &d_f, &pbcAiuc);
+
+    launchGpuKernel(kernelPtr, config, deviceStream_, nullptr, "spreadVirtualSiteForces_kernel",
+                    kernelArgs);
+}
+
+VirtualSitesGpu::VirtualSitesGpu(const DeviceContext& deviceContext,
+                                 const DeviceStream&  deviceStream) :
+    deviceContext_(deviceContext),
+    deviceStream_(deviceStream)
+{
+    static_assert(sizeof(real) == sizeof(float),
+                  "Real numbers should be in single precision in GPU code.");
+}
+
+VirtualSitesGpu::~VirtualSitesGpu()
+{
+    if (numVirtualSitesEntriesAlloc_ > 0)
+    {
+        freeDeviceBuffer(&d_virtualSites_);
+    }
+}
+
+void VirtualSitesGpu::set(const InteractionDefinitions& idef)
+{
+    h_virtualSites_.clear();
+    for (int ftype = F_VSITE1; ftype < c_ftypeVsiteGpuEnd; ftype++)
+    {
+        const int           nral   = NRAL(ftype);
+        ArrayRef<const int> iatoms = idef.il[ftype].iatoms;
+        for (int i = 0; i < idef.il[ftype].size(); i += 1 + nral)
+        {
+            const t_iparams&    iparams = idef.iparams[iatoms[i]];
+            VirtualSiteGpuEntry vsite;
+            vsite.ftype = ftype;
+            for (int a = 0; a < 5; a++)
+            {
+                vsite.atoms[a] = (a < nral ? iatoms[i + 1 + a] : -1);
+            }
+            vsite.a = iparams.vsite.a;
+            vsite.b = iparams.vsite.b;
+            vsite.c = iparams.vsite.c;
+            h_virtualSites_.push_back(vsite);
+        }
+    }
+    GMX_RELEASE_ASSERT(idef.il[F_VSITEN].empty(), "F_VSITEN is not supported on the GPU");
+
+    numVirtualSites_ = h_virtualSites_.size();
+    if (numVirtualSites_ == 0)
+    {
+        return;
+    }
+
+    reallocateDeviceBuffer(&d_virtualSites_, numVirtualSites_, &numVirtualSitesEntries_,
+                           &numVirtualSitesEntriesAlloc_, deviceContext_);
+    copyToDeviceBuffer(&d_virtualSites_, h_virtualSites_.data(), 0, numVirtualSites_,
+                       deviceStream_, GpuApiCallBehavior::Sync, nullptr);
+}
+
+bool VirtualSitesGpu::areVirtualSitesSupported(const gmx_mtop_t& mtop)
+{
+    for (const gmx_moltype_t& molType : mtop.moltype)
+    {
+        if (!molType.ilist[F_VSITEN].empty())
+        {
+            return false;
+        }
+
+        std::vector<bool> isVirtualSite(molType.atoms.nr, false);
+        for (int ftype = F_VSITE1; ftype < c_ftypeVsiteGpuEnd; ftype++)
+        {
+            ArrayRef<const int> iatoms = molType.ilist[ftype].iatoms;
+            for (int i = 0; i < molType.ilist[ftype].size(); i += 1 + NRAL(ftype))
+            {
+                isVirtualSite[iatoms[i + 1]] = true;
+            }
+        }
+        for (int ftype = F_VSITE1; ftype < c_ftypeVsiteGpuEnd; ftype++)
+        {
+            ArrayRef<const int> iatoms = molType.ilist[ftype].iatoms;
+            for (int i = 0; i < molType.ilist[ftype].size(); i += 1 + NRAL(ftype))
+            {
+                for (int a = 2; a <= NRAL(ftype); a++)
+                {
+                    if (isVirtualSite[iatoms[i + a]])
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+} // namespace gmx
@@ -0,0 +1,162 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Declares class for GPU construction of virtual sites and spreading of their forces
+ *
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_VSITE_GPU_CUH
+#define GMX_MDLIB_VSITE_GPU_CUH
+
+#include "gmxpre.h"
+
+#include <vector>
+
+#include "gromacs/gpu_utils/device_context.h"
+#include "gromacs/gpu_utils/device_stream.h"
+#include "gromacs/gpu_utils/gputraits.cuh"
+#include "gromacs/pbcutil/pbc_aiuc.h"
+
+class InteractionDefinitions;
+struct gmx_mtop_t;
+
+namespace gmx
+{
+
+/*! \internal \brief A virtual site with its constructing atoms and parameters */
+struct VirtualSiteGpuEntry
+{
+    //! The interaction type, F_VSITE1 up to F_VSITE4FDN
+    int ftype;
+    //! The virtual site atom followed by up to four constructing atoms
+    int atoms[5];
+    //! Construction parameter a
+    float a;
+    //! Construction parameter b, not used by all types
+    float b;
+    //! Construction parameter c, not used by all types
+    float c;
+};
+
+/*! \internal \brief Class with interfaces and data for the GPU version of virtual sites
+ *
+ * Virtual sites are constructed after the update and their forces are spread
+ * before the update, so that coordinates and forces can stay on the GPU.
+ * All virtual sites are handled by a single kernel, with one thread per site.
+ * This requires that virtual sites are not constructed from other virtual
+ * sites, which is checked by areVirtualSitesSupported(). The forces are spread
+ * without computing virial contributions; at virial steps the forces should be
+ * spread on the host.
+ */
+class VirtualSitesGpu
+{
+
+public:
+    /*! \brief Create the GPU virtual sites object
+     *
+     * \param[in] deviceContext  Device context (dummy in CUDA).
+     * \param[in] deviceStream   Device stream to use.
+     */
+    VirtualSitesGpu(const DeviceContext& deviceContext, const DeviceStream& deviceStream);
+
+    ~VirtualSitesGpu();
+
+    /*! \brief Construct the virtual sites
+     *
+     * Virtual sites are kept in the same periodic image as their position
+     * in \p d_xOld, from which their velocities are also computed.
+     *
+     * \param[in]     d_xOld            Coordinates before the update (in GPU memory)
+     * \param[in,out] d_x               Coordinates after the update (in GPU memory), the
+     *                                  virtual sites are constructed here
+     * \param[in]     updateVelocities  If the velocities of virtual sites should be set
+     * \param[out]    d_v               Velocities (in GPU memory)
+     * \param[in]     invdt             Reciprocal timestep
+     * \param[in]     pbcAiuc           PBC data
+     */
+    void construct(const float3* d_xOld,
+                   float3*       d_x,
+                   bool          updateVelocities,
+                   float3*       d_v,
+                   real          invdt,
+                   const PbcAiuc pbcAiuc);
+
+    /*! \brief Spread the forces on virtual sites to their constructing atoms
+     *
+     * The forces on the virtual sites are cleared after spreading.
+     *
+     * \param[in]     d_x      Coordinates the forces were computed for (in GPU memory)
+     * \param[in,out] d_f      Forces (in GPU memory)
+     * \param[in]     pbcAiuc  PBC data
+     */
+    void spreadForces(const float3* d_x, float3* d_f, const PbcAiuc pbcAiuc);
+
+    /*! \brief Update the virtual site data (e.g. after NB search step)
+     *
+     * \param[in] idef  The local topology
+     */
+    void set(const InteractionDefinitions& idef);
+
+    /*! \brief Returns whether the virtual sites in \p mtop can be handled on the GPU
+     *
+     * This is not the case with F_VSITEN or with virtual sites constructed
+     * from other virtual sites.
+     *
+     * \param[in] mtop  The molecular topology
+     */
+    static bool areVirtualSitesSupported(const gmx_mtop_t& mtop);
+
+private:
+    //! GPU context object
+    const DeviceContext& deviceContext_;
+    //! GPU stream
+    const DeviceStream& deviceStream_;
+
+    //! Number of local virtual sites
+    int numVirtualSites_ = 0;
+
+    //! Virtual sites (CPU)
+    std::vector<VirtualSiteGpuEntry> h_virtualSites_;
+    //! Virtual sites (GPU)
+    VirtualSiteGpuEntry* d_virtualSites_ = nullptr;
+    //! Current size of the array of virtual sites
+    int numVirtualSitesEntries_ = -1;
+    //! Allocated size for the array of virtual sites
+    int numVirtualSitesEntriesAlloc_ = -1;
+};
+
+} // namespace gmx
+
+#endif // GMX_MDLIB_VSITE_GPU_CUH
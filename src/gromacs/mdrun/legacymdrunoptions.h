@@ -94,6 +94,8 @@ public:
     int nstlist_cmdline = 0;
     //! Parameters for replica-exchange simulations.
     ReplicaExchangeParameters replExParams;
+    //! With -multidir, the number of groups of ranks that run the simulations from a queue.
+    int numMultiDirGroups = 0;
 
     //! Filename options to fill from command-line argument values.
     std::vector<t_filenm> filenames = { { { efTPR, nullptr, nullptr, ffREAD },
@@ -162,7 +164,7 @@ public:
 
     ImdOptions& imdOptions = mdrunOptions.imdOptions;
 
-    t_pargs pa[48] = {
+    t_pargs pa[50] = {
 
         { "-dd", FALSE, etRVEC, { &realddxyz }, "Domain decomposition grid, 0 is optimize" },
         { "-ddorder", FALSE, etENUM, { ddrank_opt_choices }, "DD rank order" },
@@ -333,6 +335,18 @@ public:
           etINT,
           { &replExParams.randomSeed },
           "Seed for replica exchange, -1 is generate a seed" },
+        { "-replexparams",
+          FALSE,
+          etBOOL,
+          { &replExParams.swapParameters },
+          "Exchange the reference temperatures between replicas instead of the coordinates and "
+          "velocities" },
+        { "-multidirgroups",
+          FALSE,
+          etINT,
+          { &numMultiDirGroups },
+          "With -multidir, run the simulations one after another from a queue on this number of "
+          "groups of ranks, 0 runs all simulations at the same time" },
         { "-imdport", FALSE, etINT, { &imdOptions.port }, "HIDDENIMD listening port" },
         { "-imdwait",
           FALSE,
@@ -87,6 +87,7 @@ void LegacySimulator::run()
         case eiCG: do_cg(); break;
         case eiNM: do_nm(); break;
         case eiLBFGS: do_lbfgs(); break;
+        case eiFIRE: do_fire(); break;
         case eiTPI:
         case eiTPIC:
             if (!EI_TPI(inputrec->eI))
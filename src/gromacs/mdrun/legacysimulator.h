@@ -84,6 +84,8 @@ private:
     SimulatorFunctionType do_cg;
     //! Implements onjugate gradient energy minimization using the L-BFGS algorithm
     SimulatorFunctionType do_lbfgs;
+    //! Implements energy minimization using the FIRE algorithm
+    SimulatorFunctionType do_fire;
     //! Implements normal mode analysis
     SimulatorFunctionType do_nm;
     //! Implements test particle insertion
@@ -51,6 +51,7 @@
 #include <algorithm>
 #include <memory>
 #include <numeric>
+#include <string>
 
 #include "gromacs/applied_forces/awh/awh.h"
 #include "gromacs/commandline/filenm.h"
@@ -88,8 +89,10 @@
 #include "gromacs/mdlib/force_flags.h"
 #include "gromacs/mdlib/forcerec.h"
 #include "gromacs/mdlib/freeenergyparameters.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdlib/md_support.h"
 #include "gromacs/mdlib/mdatoms.h"
+#include "gromacs/mdlib/mdgraph_gpu.h"
 #include "gromacs/mdlib/mdoutf.h"
 #include "gromacs/mdlib/membed.h"
 #include "gromacs/mdlib/resethandler.h"
@@ -105,6 +108,7 @@
 #include "gromacs/mdlib/vsite.h"
 #include "gromacs/mdrunutility/handlerestart.h"
 #include "gromacs/mdrunutility/multisim.h"
+#include "gromacs/mdrunutility/performancemetrics.h"
 #include "gromacs/mdrunutility/printtime.h"
 #include "gromacs/mdtypes/awh_history.h"
 #include "gromacs/mdtypes/awh_params.h"
@@ -287,6 +291,13 @@ void gmx::LegacySimulator::do_md()
                             * nstglobalcomm;
         }
     }
+    // The master ranks sum the inter-simulation signals without
+    // blocking, completing the sum at the next signalling step.
+    std::unique_ptr<gmx::InterSimulationSignalReduction> interSimSignalReduction;
+    if (simulationsShareState && MASTER(cr))
+    {
+        interSimSignalReduction = std::make_unique<gmx::InterSimulationSignalReduction>(ms);
+    }
 
     if (startingBehavior != StartingBehavior::RestartWithAppending)
     {
@@ -348,6 +359,9 @@ void gmx::LegacySimulator::do_md()
         /* Copy the pointer to the global state */
         state = state_global;
 
+        /* Place the coordinate and velocity pages on the NUMA nodes of the update threads */
+        placeStateForThreads(gmx_omp_nthreads_get(emntUpdate), state);
+
         /* Generate and initialize new topology */
         mdAlgorithmsSetupAtomData(cr, ir, *top_global, &top, fr, &f, mdAtoms, constr, vsite, shellfc);
 
@@ -371,18 +385,16 @@ void gmx::LegacySimulator::do_md()
         GMX_RELEASE_ASSERT(useGpuForPme || (useGpuForNonbonded && simulationWork.useGpuBufferOps),
                            "Either PME or short-ranged non-bonded interaction tasks must run on "
                            "the GPU to use GPU update.\n");
-        GMX_RELEASE_ASSERT(ir->eI == eiMD,
-                           "Only the md integrator is supported with the GPU update.\n");
-        GMX_RELEASE_ASSERT(
-                ir->etc != etcNOSEHOOVER,
-                "Nose-Hoover temperature coupling is not supported with the GPU update.\n");
+        GMX_RELEASE_ASSERT(ir->eI == eiMD || ir->eI == eiSD1,
+                           "Only the md and sd integrators are supported with the GPU update.\n");
         GMX_RELEASE_ASSERT(
                 ir->epc == epcNO || ir->epc == epcPARRINELLORAHMAN || ir->epc == epcBERENDSEN
                         || ir->epc == epcCRESCALE,
                 "Only Parrinello-Rahman, Berendsen, and C-rescale pressure coupling are supported "
                 "with the GPU update.\n");
-        GMX_RELEASE_ASSERT(!mdatoms->haveVsites,
-                           "Virtual sites are not supported with the GPU update.\n");
+        GMX_RELEASE_ASSERT(!mdatoms->haveVsites || !fr->useMts,
+                           "Virtual sites with multiple time stepping are not supported with the "
+                           "GPU update.\n");
         GMX_RELEASE_ASSERT(ed == nullptr,
                            "Essential dynamics is not supported with the GPU update.\n");
         GMX_RELEASE_ASSERT(!ir->bPull || !pull_have_constraint(*ir->pull),
@@ -420,6 +432,60 @@ void gmx::LegacySimulator::do_md()
         integrator->setPbc(PbcType::Xyz, state->box);
     }
 
+    // With GMX_CUDA_GRAPH set, the GPU work of GPU-resident steps that need no
+    // host-side work is captured in a graph once after each search and replayed.
+    std::unique_ptr<MdGpuGraph> mdGraph;
+    if (useGpuForUpdate && getenv("GMX_CUDA_GRAPH") != nullptr)
+    {
+        std::string reasonForNotUsingGraph;
+        if (!buildSupportsMdGpuGraph())
+        {
+            reasonForNotUsingGraph = "it is only supported with CUDA";
+        }
+        else if (DOMAINDECOMP(cr) || !thisRankHasDuty(cr, DUTY_PME))
+        {
+            reasonForNotUsingGraph = "it is not supported with multiple ranks";
+        }
+        else if (!(useGpuForNonbonded && useGpuForBufferOps)
+                 || (EEL_PME_EWALD(fr->ic->eeltype) && !useGpuForPme))
+        {
+            reasonForNotUsingGraph = "it requires all force work to be offloaded to the GPU";
+        }
+        else if (shellfc != nullptr || vsite != nullptr || fr->useMts || ir->efep != efepNO
+                 || ir->bExpanded || ir->bIMD)
+        {
+            reasonForNotUsingGraph =
+                    "it is not supported with shells, virtual sites, multiple time stepping, "
+                    "free-energy calculations or IMD";
+        }
+        else if (ir->eI == eiSD1)
+        {
+            reasonForNotUsingGraph =
+                    "the sd integrator needs the step number to generate its random numbers";
+        }
+        else if (getenv("GMX_ENABLE_GPU_TIMING") != nullptr)
+        {
+            reasonForNotUsingGraph = "it is not supported with GPU timing";
+        }
+
+        if (reasonForNotUsingGraph.empty())
+        {
+            GMX_LOG(mdlog.info)
+                    .asParagraph()
+                    .appendText(
+                            "GMX_CUDA_GRAPH is set, the GPU work of steps without output or "
+                            "global communication is replayed from a CUDA graph.");
+            mdGraph = std::make_unique<MdGpuGraph>(*fr->deviceStreamManager, wcycle);
+        }
+        else
+        {
+            GMX_LOG(mdlog.warning)
+                    .asParagraph()
+                    .appendTextFormatted("GMX_CUDA_GRAPH is set, but CUDA graphs are not used as %s.",
+                                         reasonForNotUsingGraph.c_str());
+        }
+    }
+
     if (useGpuForPme || (useGpuForNonbonded && useGpuForBufferOps) || useGpuForUpdate)
     {
         changePinningPolicy(&state->x, PinningPolicy::PinnedIfSupported);
@@ -462,7 +528,8 @@ void gmx::LegacySimulator::do_md()
 
     if (useReplicaExchange && MASTER(cr))
     {
-        repl_ex = init_replica_exchange(fplog, ms, top_global->natoms, ir, replExParams);
+        repl_ex = init_replica_exchange(fplog, ms, top_global->natoms, ir, replExParams,
+                                        startingBehavior != StartingBehavior::NewSimulation);
     }
     /* PME tuning is only supported in the Verlet scheme, with PME for
      * Coulomb. It is not supported with only LJ PME. */
@@ -680,6 +747,13 @@ void gmx::LegacySimulator::do_md()
     wallcycle_start(wcycle, ewcRUN);
     print_start(fplog, cr, walltime_accounting, "mdrun");
 
+    std::unique_ptr<PerformanceMetricsWriter> metricsWriter;
+    if (MASTER(cr))
+    {
+        metricsWriter = makePerformanceMetricsWriterFromEnvironment(
+                isMultiSim(ms) ? ms->simulationIndex_ : -1);
+    }
+
     /***********************************************************
      *
      *             Loop over MD steps
@@ -906,11 +980,55 @@ void gmx::LegacySimulator::do_md()
         force_flags = (GMX_FORCE_STATECHANGED | ((inputrecDynamicBox(ir)) ? GMX_FORCE_DYNAMICBOX : 0)
                        | GMX_FORCE_ALLFORCES | (bCalcVir ? GMX_FORCE_VIRIAL : 0)
                        | (bCalcEner ? GMX_FORCE_ENERGY : 0) | (bDoFEP ? GMX_FORCE_DHDL : 0));
-        if (fr->useMts && !do_per_step(step, ir->nstfout))
+        if (fr->useMts && !do_per_step(step, ir->nstfout)
+            && !do_per_step(step, ir->nstfout_compressed))
         {
             force_flags |= GMX_FORCE_DO_NOT_NEED_NORMAL_FORCE;
         }
 
+        // With GPU update, the forces on virtual sites are spread on the GPU, except at
+        // virial and force output steps where the spread forces are needed on the host.
+        const bool spreadVsiteForcesOnGpu =
+                (useGpuForUpdate && vsite != nullptr && !bCalcVir && !do_per_step(step, ir->nstfout)
+                 && !do_per_step(step, ir->nstfout_compressed));
+        // Forces spread on the host with GPU update have to be copied to the GPU
+        const bool vsiteForcesSpreadOnHost = (vsite != nullptr && !spreadVsiteForcesOnGpu);
+
+        // The GPU work of this step can be captured in, or replayed from, the MD graph
+        // when the step has the same workload as the following steps and needs no
+        // data on the host. The coupling, output and kinetic energy conditions below
+        // match those used to set up the GPU update and the copies later in this step.
+        bool useMdGraphThisStep    = false;
+        bool replayMdGraphThisStep = false;
+        if (mdGraph)
+        {
+            const bool isCouplingStep =
+                    (ir->etc != etcNO && do_per_step(step + ir->nsttcouple - 1, ir->nsttcouple))
+                    || (ir->epc != epcNO && do_per_step(step + ir->nstpcouple - 1, ir->nstpcouple));
+            const bool isOutputStep =
+                    do_per_step(step, ir->nstxout) || do_per_step(step, ir->nstvout)
+                    || do_per_step(step, ir->nstfout) || do_per_step(step, ir->nstxout_compressed)
+                    || do_per_step(step, ir->nstvout_compressed)
+                    || do_per_step(step, ir->nstfout_compressed)
+                    || checkpointHandler->isCheckpointingStep();
+            const bool needHalfStepKineticEnergyThisStep =
+                    (do_per_step(step + 1, nstglobalcomm) || step_rel + 1 == ir->nsteps);
+            useMdGraphThisStep = !bNS && !bGStat && !bDoReplEx && !bLastStep && !isCouplingStep
+                                 && !isOutputStep && !needHalfStepKineticEnergyThisStep
+                                 && !runScheduleWork->domainWork.haveCpuLocalForceWork
+                                 && !fr->nbv->isDynamicPruningStepGpu(step);
+            // The graph holds the pairlist and box of the step it was captured in
+            if (bNS || (!useMdGraphThisStep && inputrecDynamicBox(ir)))
+            {
+                mdGraph->reset();
+            }
+            replayMdGraphThisStep = useMdGraphThisStep && mdGraph->graphIsCaptured();
+            if (useMdGraphThisStep && !replayMdGraphThisStep)
+            {
+                mdGraph->startRecord(stateGpu->xUpdatedOnDevice());
+            }
+        }
+
         if (shellfc)
         {
             /* Now is the time to relax the shells */
@@ -941,11 +1059,15 @@ void gmx::LegacySimulator::do_md()
              * This is parallellized as well, and does communication too.
              * Check comments in sim_util.c
              */
-            do_force(fplog, cr, ms, ir, awh.get(), enforcedRotation, imdSession, pull_work, step,
-                     nrnb, wcycle, &top, state->box, state->x.arrayRefWithPadding(), &state->hist,
-                     &f.view(), force_vir, mdatoms, enerd, state->lambda, fr, runScheduleWork,
-                     vsite, mu_tot, t, ed ? ed->getLegacyED() : nullptr,
-                     (bNS ? GMX_FORCE_NS : 0) | force_flags, ddBalanceRegionHandler);
+            if (!replayMdGraphThisStep)
+            {
+                do_force(fplog, cr, ms, ir, awh.get(), enforcedRotation, imdSession, pull_work,
+                         step, nrnb, wcycle, &top, state->box, state->x.arrayRefWithPadding(),
+                         &state->hist, &f.view(), force_vir, mdatoms, enerd, state->lambda, fr,
+                         runScheduleWork, spreadVsiteForcesOnGpu ? nullptr : vsite, mu_tot, t,
+                         ed ? ed->getLegacyED() : nullptr,
+                         (bNS ? GMX_FORCE_NS : 0) | force_flags, ddBalanceRegionHandler);
+            }
         }
 
         // VV integrators do not need the following velocity half step
@@ -1108,8 +1230,32 @@ void gmx::LegacySimulator::do_md()
                statistics, but if performing simulated tempering, we
                do update the velocities and the tau_t. */
 
-            lamnew = ExpandedEnsembleDynamics(fplog, ir, enerd, state, &MassQ, state->fep_state,
-                                              state->dfhist, step, state->v.rvec_array(), mdatoms);
+            /* With the update on the GPU, the velocities are not copied to the host
+             * for the move. Instead a temperature change is applied by scaling
+             * the velocities on the GPU, before the update of this step.
+             */
+            const int fepStateOld = state->fep_state;
+            lamnew                = ExpandedEnsembleDynamics(
+                    fplog, ir, enerd, state, &MassQ, state->fep_state, state->dfhist, step,
+                    useGpuForUpdate ? nullptr : state->v.rvec_array(), mdatoms);
+            if (ir->bSimTemp && lamnew != fepStateOld)
+            {
+                if (useGpuForUpdate)
+                {
+                    const real velocityScaling =
+                            std::sqrt(ir->simtempvals->temperatures[lamnew]
+                                      / ir->simtempvals->temperatures[fepStateOld]);
+                    matrix velocityScalingMatrix;
+                    clear_mat(velocityScalingMatrix);
+                    for (int d = 0; d < DIM; d++)
+                    {
+                        velocityScalingMatrix[d][d] = velocityScaling;
+                    }
+                    integrator->scaleVelocities(velocityScalingMatrix);
+                }
+                /* The SD constants depend on the reference temperatures */
+                upd.update_temperature_constants(*ir);
+            }
             /* history is maintained in state->dfhist, but state_global is what is sent to trajectory and log output */
             if (MASTER(cr))
             {
@@ -1129,7 +1275,8 @@ void gmx::LegacySimulator::do_md()
         // Copy velocities if needed for the output/checkpointing.
         // NOTE: Copy on the search steps is done at the beginning of the step.
         if (useGpuForUpdate && !bNS
-            && (do_per_step(step, ir->nstvout) || checkpointHandler->isCheckpointingStep()))
+            && (do_per_step(step, ir->nstvout) || do_per_step(step, ir->nstvout_compressed)
+                || checkpointHandler->isCheckpointingStep()))
         {
             stateGpu->copyVelocitiesFromGpu(state->v, AtomLocality::Local);
             stateGpu->waitVelocitiesReadyOnHost(AtomLocality::Local);
@@ -1145,7 +1292,7 @@ void gmx::LegacySimulator::do_md()
         // NOTE: The forces should not be copied here if the vsites are present, since they were modified
         //       on host after the D2H copy in do_force(...).
         if (runScheduleWork->stepWork.useGpuFBufferOps && (simulationWork.useGpuUpdate && !vsite)
-            && do_per_step(step, ir->nstfout))
+            && (do_per_step(step, ir->nstfout) || do_per_step(step, ir->nstfout_compressed)))
         {
             stateGpu->copyForcesFromGpu(f.view().force(), AtomLocality::Local);
             stateGpu->waitForcesReadyOnHost(AtomLocality::Local);
@@ -1260,34 +1407,83 @@ void gmx::LegacySimulator::do_md()
             if (bNS && (bFirstStep || DOMAINDECOMP(cr)))
             {
                 integrator->set(stateGpu->getCoordinates(), stateGpu->getVelocities(),
-                                stateGpu->getForces(), top.idef, *mdatoms, ekind->ngtc);
+                                stateGpu->getForces(), top.idef, *mdatoms, ekind->ngtc,
+                                DOMAINDECOMP(cr) ? ArrayRef<const int>(cr->dd->globalAtomIndices)
+                                                 : ArrayRef<const int>());
 
                 // Copy data to the GPU after buffers might have being reinitialized
                 stateGpu->copyVelocitiesToGpu(state->v, AtomLocality::Local);
                 stateGpu->copyCoordinatesToGpu(state->x, AtomLocality::Local);
             }
 
+            // With MTS, the host MTS-combined forces are used for the update at slow steps
+            const bool isMtsSlowStep = (fr->useMts && step % ir->mtsLevels[1].stepFactor == 0);
+            ArrayRef<RVec> forceCombined =
+                    isMtsSlowStep ? f.view().forceMtsCombined() : f.view().force();
+
             if (simulationWork.useGpuPme && !runScheduleWork->simulationWork.useGpuPmePpCommunication
                 && !thisRankHasDuty(cr, DUTY_PME))
             {
                 // The PME forces were recieved to the host, so have to be copied
-                stateGpu->copyForcesToGpu(f.view().force(), AtomLocality::All);
+                stateGpu->copyForcesToGpu(forceCombined, AtomLocality::All);
             }
-            else if (!runScheduleWork->stepWork.useGpuFBufferOps)
+            else if (!runScheduleWork->stepWork.useGpuFBufferOps || vsiteForcesSpreadOnHost)
             {
-                // The buffer ops were not offloaded this step, so the forces are on the
-                // host and have to be copied
-                stateGpu->copyForcesToGpu(f.view().force(), AtomLocality::Local);
+                // The buffer ops were not offloaded this step, or the vsite forces were
+                // spread on the host, so the forces are on the host and have to be copied
+                stateGpu->copyForcesToGpu(forceCombined, AtomLocality::Local);
+            }
+
+            /* As for the CPU update below, with MTS the constraint virial needs an
+             * additional normal update step. This is done on the CPU, using the normal
+             * forces that are on the host at virial steps, after which the GPU update
+             * uses the MTS-combined forces and does not compute the virial.
+             */
+            const bool computeMtsConstraintVirialOnCpu =
+                    (fr->useMts && bCalcVir && constr != nullptr);
+            tensor     gpuConstraintVirial;
+            if (computeMtsConstraintVirialOnCpu)
+            {
+                stateGpu->copyCoordinatesFromGpu(state->x, AtomLocality::Local);
+                stateGpu->copyVelocitiesFromGpu(state->v, AtomLocality::Local);
+                stateGpu->waitCoordinatesReadyOnHost(AtomLocality::Local);
+                stateGpu->waitVelocitiesReadyOnHost(AtomLocality::Local);
+
+                upd.update_for_constraint_virial(*ir, *mdatoms, *state,
+                                                 f.view().forceWithPadding(), *ekind);
+
+                constrain_coordinates(constr, do_log, do_ene, step, state,
+                                      upd.xp()->arrayRefWithPadding(), &dvdl_constr, bCalcVir,
+                                      shake_vir);
             }
 
             const bool doTemperatureScaling =
                     (ir->etc != etcNO && do_per_step(step + ir->nsttcouple - 1, ir->nsttcouple));
 
             // This applies Leap-Frog, LINCS and SETTLE in succession
-            integrator->integrate(stateGpu->getForcesReadyOnDeviceEvent(
-                                          AtomLocality::Local, runScheduleWork->stepWork.useGpuFBufferOps),
-                                  ir->delta_t, true, bCalcVir, shake_vir, doTemperatureScaling,
-                                  ekind->tcstat, doParrinelloRahman, ir->nstpcouple * ir->delta_t, M);
+            if (!replayMdGraphThisStep)
+            {
+                const bool forcesOnDevice =
+                        runScheduleWork->stepWork.useGpuFBufferOps && !vsiteForcesSpreadOnHost;
+                integrator->integrate(
+                        stateGpu->getForcesReadyOnDeviceEvent(AtomLocality::Local, forcesOnDevice),
+                        spreadVsiteForcesOnGpu, ir->delta_t, step, true,
+                        bCalcVir && !computeMtsConstraintVirialOnCpu,
+                        computeMtsConstraintVirialOnCpu ? gpuConstraintVirial : shake_vir,
+                        doTemperatureScaling, ekind->tcstat, ir->etc == etcNOSEHOOVER,
+                        ir->nsttcouple * ir->delta_t, state->nosehoover_vxi,
+                        doParrinelloRahman, ir->nstpcouple * ir->delta_t, M);
+            }
+
+            // The capture only records the work, so the graph is also launched on the capture step
+            if (useMdGraphThisStep)
+            {
+                if (!replayMdGraphThisStep)
+                {
+                    mdGraph->endRecord();
+                }
+                mdGraph->launchGraphMdStep(stateGpu->xUpdatedOnDevice());
+            }
 
             // Copy velocities D2H after update if:
             // - Globals are computed this step (includes the energy output steps).
@@ -1308,10 +1504,12 @@ void gmx::LegacySimulator::do_md()
              */
             if (fr->useMts && bCalcVir && constr != nullptr)
             {
-                upd.update_for_constraint_virial(*ir, *mdatoms, *state, f.view().forceWithPadding(), *ekind);
+                upd.update_for_constraint_virial(*ir, *mdatoms, *state,
+                                                 f.view().forceWithPadding(), *ekind);
 
                 constrain_coordinates(constr, do_log, do_ene, step, state,
-                                      upd.xp()->arrayRefWithPadding(), &dvdl_constr, bCalcVir, shake_vir);
+                                      upd.xp()->arrayRefWithPadding(), &dvdl_constr, bCalcVir,
+                                      shake_vir);
             }
 
             ArrayRefWithPadding<const RVec> forceCombined =
@@ -1383,7 +1581,8 @@ void gmx::LegacySimulator::do_md()
             enerd->term[F_DVDL_CONSTR] += dvdl_constr;
         }
 
-        if (vsite != nullptr)
+        // With GPU update, the vsites are constructed on the GPU
+        if (vsite != nullptr && !useGpuForUpdate)
         {
             wallcycle_start(wcycle, ewcVSITECONSTR);
             vsite->construct(state->x, ir->delta_t, state->v, state->box);
@@ -1416,7 +1615,8 @@ void gmx::LegacySimulator::do_md()
                 // situation where e.g. checkpointing can't be
                 // signalled.
                 bool                doIntraSimSignal = true;
-                SimulationSignaller signaller(&signals, cr, ms, doInterSimSignal, doIntraSimSignal);
+                SimulationSignaller signaller(&signals, cr, ms, doInterSimSignal, doIntraSimSignal,
+                                              interSimSignalReduction.get());
 
                 compute_globals(gstat, cr, ir, fr, ekind, makeConstArrayRef(state->x),
                                 makeConstArrayRef(state->v), state->box, mdatoms, nrnb, &vcm,
@@ -1602,6 +1802,13 @@ void gmx::LegacySimulator::do_md()
             }
             print_time(stderr, walltime_accounting, step, ir, cr);
         }
+        if (metricsWriter && metricsWriter->isDue())
+        {
+            const float ddForceImbalanceLoss =
+                    havePPDomainDecomposition(cr) ? dd_force_imb_perf_loss(cr->dd) : -1;
+            metricsWriter->write(computePerformanceMetrics(walltime_accounting, step, *ir,
+                                                           ddForceImbalanceLoss));
+        }
 
         /* Ion/water position swapping.
          * Not done in last step since trajectory writing happens before this call
@@ -1621,7 +1828,15 @@ void gmx::LegacySimulator::do_md()
 
         /* Replica exchange */
         bExchanged = FALSE;
-        if (bDoReplEx)
+        if (bDoReplEx && replExParams.swapParameters)
+        {
+            /* Only the reference temperatures change, the state stays in place */
+            if (replica_exchange_parameters(fplog, cr, ms, repl_ex, ir, enerd, state, step, t))
+            {
+                upd.update_temperature_constants(*ir);
+            }
+        }
+        else if (bDoReplEx)
         {
             bExchanged = replica_exchange(fplog, cr, ms, repl_ex, state_global, enerd, state, step, t);
         }
@@ -218,6 +218,8 @@ void gmx::LegacySimulator::do_mimic()
     }
 
     ir->nstxout_compressed         = 0;
+    ir->nstvout_compressed         = 0;
+    ir->nstfout_compressed         = 0;
     const SimulationGroups* groups = &top_global->groups;
     {
         auto nonConstGlobalTopology                          = const_cast<gmx_mtop_t*>(top_global);
@@ -702,7 +702,7 @@ static bool do_em_step(const t_commrec*                          cr,
         }
 
         // We should move this check to the different minimizers
-        if (!validStep && ir->eI != eiSteep)
+        if (!validStep && ir->eI != eiSteep && ir->eI != eiFIRE)
         {
             gmx_fatal(FARGS,
                       "The coordinates could not be constrained. Minimizer '%s' can not handle "
@@ -2588,6 +2588,319 @@ void LegacySimulator::do_steep()
     walltime_accounting_set_nsteps_done(walltime_accounting, count);
 }
 
+//! Returns the maximum of \p value over all ranks
+static real globalMax(const t_commrec* cr, real value)
+{
+    if (PAR(cr))
+    {
+        std::vector<double> buffer(cr->nnodes, 0.0);
+        buffer[cr->nodeid] = value;
+        gmx_sumd(cr->nnodes, buffer.data(), cr);
+        value = *std::max_element(buffer.begin(), buffer.end());
+    }
+
+    return value;
+}
+
+void LegacySimulator::do_fire()
+{
+    const char*       FIRE = "FIRE";
+    gmx_localtop_t    top(top_global->ffparams);
+    gmx_global_stat_t gstat;
+    tensor            vir, pres;
+    rvec              mu_tot  = { 0 };
+    auto              mdatoms = mdAtoms->mdatoms();
+
+    /* The FIRE parameters as proposed by Bitzek et al., PRL 97, 170201 (2006) */
+    constexpr int  c_numStepsDelay     = 5;
+    constexpr real c_timeStepIncrease  = 1.1;
+    constexpr real c_timeStepDecrease  = 0.5;
+    constexpr real c_alphaStart        = 0.1;
+    constexpr real c_alphaDecrease     = 0.99;
+    constexpr real c_maxTimeStepFactor = 10;
+
+    if (MASTER(cr))
+    {
+        // In FIRE, the state is extended with velocities
+        state_global->flags |= (1 << estV);
+
+        // Ensure the extra per-atom state array gets allocated
+        state_change_natoms(state_global, state_global->natoms);
+
+        // Start the minimization at rest
+        for (RVec& v : state_global->v)
+        {
+            v = { 0, 0, 0 };
+        }
+    }
+
+    /* Create 2 states on the stack and extract pointers that we will swap */
+    em_state_t  s0{}, s1{};
+    em_state_t* s_min = &s0;
+    em_state_t* s_try = &s1;
+
+    /* Init em and store the local state in s_min */
+    init_em(fplog, mdlog, FIRE, cr, inputrec, imdSession, pull_work, state_global, top_global,
+            s_min, &top, nrnb, fr, mdAtoms, &gstat, vsite, constr, nullptr);
+    const bool        simulationsShareState = false;
+    gmx_mdoutf*       outf = init_mdoutf(fplog, nfile, fnm, mdrunOptions, cr, outputProvider,
+                                   mdModulesNotifier, inputrec, top_global, nullptr, wcycle,
+                                   StartingBehavior::NewSimulation, simulationsShareState, ms);
+    gmx::EnergyOutput energyOutput(mdoutf_get_fp_ene(outf), top_global, inputrec, pull_work, nullptr,
+                                   false, StartingBehavior::NewSimulation, mdModulesNotifier);
+
+    /* Print to log file  */
+    print_em_start(fplog, cr, walltime_accounting, wcycle, FIRE);
+
+    const int nsteps = inputrec->nsteps;
+
+    if (MASTER(cr))
+    {
+        sp_header(stderr, FIRE, inputrec->em_tol, nsteps);
+    }
+    if (fplog)
+    {
+        sp_header(fplog, FIRE, inputrec->em_tol, nsteps);
+    }
+    EnergyEvaluator energyEvaluator{ fplog,    mdlog,      cr,        ms,   top_global,      &top,
+                                     inputrec, imdSession, pull_work, nrnb, wcycle,          gstat,
+                                     vsite,    constr,     mdAtoms,   fr,   runScheduleWork, enerd };
+
+    /* The time step starts at dt and can grow up to c_maxTimeStepFactor*dt.
+     * The displacement of each atom is limited to emstep per step.
+     * As with the other minimizers, all masses are 1.
+     */
+    const real maxTimeStep         = c_maxTimeStepFactor * inputrec->delta_t;
+    const real maxDisplacement     = inputrec->em_stepsize;
+    real       timeStep            = inputrec->delta_t;
+    real       alpha               = c_alphaStart;
+    int        numStepsWithPowerUp = 0;
+
+    int  count  = 0;
+    bool bDone  = false;
+    bool bAbort = false;
+    while (!bDone && !bAbort)
+    {
+        bool validStep = true;
+        if (count > 0)
+        {
+            const rvec* x      = s_min->s.x.rvec_array();
+            rvec*       v      = s_min->s.v.rvec_array();
+            const rvec* f      = as_rvec_array(s_min->f.view().force().data());
+            const int   homenr = mdatoms->homenr;
+
+            /* Determine the power F.v and the norms of F and v, frozen dimensions are excluded */
+            double sums[3] = { 0, 0, 0 };
+            for (int i = 0; i < homenr; i++)
+            {
+                const int gf = (mdatoms->cFREEZE ? mdatoms->cFREEZE[i] : 0);
+                for (int m = 0; m < DIM; m++)
+                {
+                    if (!inputrec->opts.nFreeze[gf][m])
+                    {
+                        sums[0] += f[i][m] * v[i][m];
+                        sums[1] += f[i][m] * f[i][m];
+                        sums[2] += v[i][m] * v[i][m];
+                    }
+                }
+            }
+            if (PAR(cr))
+            {
+                gmx_sumd(3, sums, cr);
+            }
+
+            if (sums[0] > 0)
+            {
+                /* Mix the velocities with the force direction */
+                const real mixFactor = (sums[1] > 0 ? alpha * std::sqrt(sums[2] / sums[1]) : 0);
+                for (int i = 0; i < homenr; i++)
+                {
+                    for (int m = 0; m < DIM; m++)
+                    {
+                        v[i][m] = (1 - alpha) * v[i][m] + mixFactor * f[i][m];
+                    }
+                }
+                numStepsWithPowerUp++;
+                if (numStepsWithPowerUp > c_numStepsDelay)
+                {
+                    timeStep = std::min(timeStep * c_timeStepIncrease, maxTimeStep);
+                    alpha *= c_alphaDecrease;
+                }
+            }
+            else
+            {
+                /* We moved uphill: stop and restart with a smaller time step */
+                for (int i = 0; i < homenr; i++)
+                {
+                    clear_rvec(v[i]);
+                }
+                timeStep *= c_timeStepDecrease;
+                alpha               = c_alphaStart;
+                numStepsWithPowerUp = 0;
+            }
+
+            /* Integrate the velocities and limit the largest displacement */
+            real maxVelocity2 = 0;
+            for (int i = 0; i < homenr; i++)
+            {
+                const int gf = (mdatoms->cFREEZE ? mdatoms->cFREEZE[i] : 0);
+                for (int m = 0; m < DIM; m++)
+                {
+                    if (inputrec->opts.nFreeze[gf][m])
+                    {
+                        v[i][m] = 0;
+                    }
+                    else
+                    {
+                        v[i][m] += timeStep * mdatoms->invmass[i] * f[i][m];
+                    }
+                }
+                maxVelocity2 = std::max(maxVelocity2, norm2(v[i]));
+            }
+            const real maxVelocity = std::sqrt(globalMax(cr, maxVelocity2));
+            if (maxVelocity * timeStep > maxDisplacement)
+            {
+                const real scale = maxDisplacement / (maxVelocity * timeStep);
+                for (int i = 0; i < homenr; i++)
+                {
+                    svmul(scale, v[i], v[i]);
+                }
+            }
+
+            validStep = do_em_step(cr, inputrec, mdatoms, s_min, timeStep,
+                                   s_min->s.v.arrayRefWithPadding(), s_try, constr, count);
+
+            if (validStep)
+            {
+                /* Copy the velocities, with constraints these follow from the displacement */
+                const rvec* xTry = s_try->s.x.rvec_array();
+                rvec*       vTry = s_try->s.v.rvec_array();
+                for (int i = 0; i < homenr; i++)
+                {
+                    if (constr)
+                    {
+                        rvec_sub(xTry[i], x[i], vTry[i]);
+                        svmul(1 / timeStep, vTry[i], vTry[i]);
+                    }
+                    else
+                    {
+                        copy_rvec(v[i], vTry[i]);
+                    }
+                }
+            }
+        }
+
+        if (validStep)
+        {
+            em_state_t* s_eval = (count == 0 ? s_min : s_try);
+            energyEvaluator.run(s_eval, mu_tot, vir, pres, count, count == 0);
+            if (count > 0)
+            {
+                swap_em_state(&s_min, &s_try);
+            }
+        }
+        else
+        {
+            /* Reject the step, as with an uphill step */
+            for (RVec& v : s_min->s.v)
+            {
+                v = { 0, 0, 0 };
+            }
+            timeStep *= c_timeStepDecrease;
+            alpha               = c_alphaStart;
+            numStepsWithPowerUp = 0;
+        }
+
+        if (MASTER(cr))
+        {
+            EnergyOutput::printHeader(fplog, count, count);
+
+            if (mdrunOptions.verbose)
+            {
+                fprintf(stderr, "Step=%5d, Dt= %6.1e ps, Epot= %12.5e Fmax= %11.5e, atom= %d\n",
+                        count, timeStep, s_min->epot, s_min->fmax, s_min->a_fmax + 1);
+                fflush(stderr);
+            }
+
+            if (validStep)
+            {
+                matrix nullBox = {};
+                energyOutput.addDataAtEnergyStep(false, false, static_cast<double>(count),
+                                                 mdatoms->tmass, enerd, nullptr, nullptr, nullBox,
+                                                 PTCouplingArrays(), 0, nullptr, nullptr, vir, pres,
+                                                 nullptr, mu_tot, constr);
+
+                imdSession->fillEnergyRecord(count, TRUE);
+
+                const bool do_dr = do_per_step(count, inputrec->nstdisreout);
+                const bool do_or = do_per_step(count, inputrec->nstorireout);
+                energyOutput.printStepToEnergyFile(mdoutf_get_fp_ene(outf), TRUE, do_dr, do_or,
+                                                   fplog, count, count, fr->fcdata.get(), nullptr);
+                fflush(fplog);
+            }
+        }
+
+        /* Test whether the convergence criterion is met */
+        bDone = (s_min->fmax < inputrec->em_tol);
+
+        if (validStep)
+        {
+            const bool do_x = do_per_step(count, inputrec->nstxout);
+            const bool do_f = do_per_step(count, inputrec->nstfout);
+            write_em_traj(fplog, cr, outf, do_x, do_f, nullptr, top_global, inputrec, count, s_min,
+                          state_global, observablesHistory);
+        }
+
+        /* Stop when out of steps, at non-finite forces or when the time step is too small */
+#if GMX_DOUBLE
+        const real minTimeStep = 1e-12 * inputrec->delta_t;
+#else
+        const real minTimeStep = 1e-6 * inputrec->delta_t;
+#endif
+        if (!bDone && (count == nsteps || !std::isfinite(s_min->fmax) || timeStep < minTimeStep))
+        {
+            if (MASTER(cr))
+            {
+                warn_step(fplog, inputrec->em_tol, s_min->fmax, count == nsteps, constr != nullptr);
+            }
+            bAbort = true;
+        }
+
+        /* Send IMD energies and positions, if bIMD is TRUE. */
+        if (imdSession->run(count, TRUE, MASTER(cr) ? state_global->box : nullptr,
+                            MASTER(cr) ? state_global->x.rvec_array() : nullptr, 0)
+            && MASTER(cr))
+        {
+            imdSession->sendPositionsAndEnergies();
+        }
+
+        count++;
+    } /* End of the loop  */
+
+    /* Print some data...  */
+    if (MASTER(cr))
+    {
+        fprintf(stderr, "\nwriting final coordinates.\n");
+    }
+    write_em_traj(fplog, cr, outf, TRUE, inputrec->nstfout != 0, ftp2fn(efSTO, nfile, fnm),
+                  top_global, inputrec, count, s_min, state_global, observablesHistory);
+
+    if (MASTER(cr))
+    {
+        double sqrtNumAtoms = sqrt(static_cast<double>(state_global->natoms));
+
+        print_converged(stderr, FIRE, inputrec->em_tol, count, bDone, nsteps, s_min, sqrtNumAtoms);
+        print_converged(fplog, FIRE, inputrec->em_tol, count, bDone, nsteps, s_min, sqrtNumAtoms);
+    }
+
+    finish_em(cr, outf, walltime_accounting, wcycle);
+
+    /* To print the actual number of steps we needed somewhere */
+    inputrec->nsteps = count;
+
+    walltime_accounting_set_nsteps_done(walltime_accounting, count);
+}
+
 void LegacySimulator::do_nm()
 {
     const char*         NM = "Normal Mode Analysis";
@@ -2603,7 +2916,7 @@ void LegacySimulator::do_nm()
     real*               full_matrix   = nullptr;
 
     /* added with respect to mdrun */
-    int  row, col;
+    int  row;
     real der_range = 10.0 * std::sqrt(GMX_REAL_EPS);
     real x_min;
     bool bIsMaster = MASTER(cr);
@@ -2826,24 +3139,17 @@ void LegacySimulator::do_nm()
 
                     row = (aid + node) * DIM + d;
 
-                    for (size_t j = 0; j < atom_index.size(); j++)
+                    /* Each row is computed exactly once, so we can store it
+                     * as a whole instead of element by element.
+                     */
+                    if (bSparse)
+                    {
+                        gmx_sparsematrix_set_row_from_dense(
+                                sparse_matrix, row, row, static_cast<int>(sz), dfdx[0] + row);
+                    }
+                    else
                     {
-                        for (size_t k = 0; k < DIM; k++)
-                        {
-                            col = j * DIM + k;
-
-                            if (bSparse)
-                            {
-                                if (col >= row && dfdx[j][k] != 0.0)
-                                {
-                                    gmx_sparsematrix_increment_value(sparse_matrix, row, col, dfdx[j][k]);
-                                }
-                            }
-                            else
-                            {
-                                full_matrix[row * sz + col] = dfdx[j][k];
-                            }
-                        }
+                        std::copy(dfdx[0], dfdx[0] + sz, full_matrix + row * sz);
                     }
                 }
             }
@@ -198,7 +198,8 @@ gmx_repl_ex_t init_replica_exchange(FILE*                            fplog,
                                     const gmx_multisim_t*            ms,
                                     int                              numAtomsInSystem,
                                     const t_inputrec*                ir,
-                                    const ReplicaExchangeParameters& replExParams)
+                                    const ReplicaExchangeParameters& replExParams,
+                                    const bool                       startedFromCheckpoint)
 {
     real                pres;
     int                 i, j;
@@ -337,6 +338,48 @@ gmx_repl_ex_t init_replica_exchange(FILE*                            fplog,
         gmx_sum_sim(re->nrepl, re->pres, ms);
     }
 
+    if (replExParams.swapParameters)
+    {
+        /* Only the reference temperatures are swapped, all other
+         * parameters need to be the same for all replicas.
+         */
+        if (re->type != ereTEMP)
+        {
+            gmx_fatal(FARGS,
+                      "Replica exchange by swapping parameters is only supported for temperature "
+                      "replica exchange");
+        }
+        if (re->bNPT)
+        {
+            for (i = 1; i < re->nrepl; i++)
+            {
+                if (re->pres[i] != re->pres[0])
+                {
+                    gmx_fatal(FARGS,
+                              "Replica exchange by swapping parameters requires the same reference "
+                              "pressure for all replicas");
+                }
+            }
+        }
+        if (ir->etc == etcNOSEHOOVER || EI_VV(ir->eI))
+        {
+            gmx_fatal(FARGS,
+                      "Replica exchange by swapping parameters is not supported with the %s "
+                      "thermostat or velocity Verlet integrators",
+                      ETCOUPLTYPE(etcNOSEHOOVER));
+        }
+        if (startedFromCheckpoint)
+        {
+            gmx_fatal(FARGS,
+                      "Replica exchange by swapping parameters can not be continued from a "
+                      "checkpoint, as the checkpoint does not store which replica each simulation "
+                      "samples");
+        }
+        fprintf(fplog,
+                "Repl  Exchanging the reference temperatures instead of the coordinates and "
+                "velocities\n");
+    }
+
     /* Make an index for increasing replica order */
     /* only makes sense if one or the other is varying, not both!
        if both are varying, we trust the order the person gave. */
@@ -1335,6 +1378,68 @@ gmx_bool replica_exchange(FILE*                 fplog,
     return bThisReplicaExchanged;
 }
 
+gmx_bool replica_exchange_parameters(FILE*                 fplog,
+                                     const t_commrec*      cr,
+                                     const gmx_multisim_t* ms,
+                                     struct gmx_repl_ex*   re,
+                                     t_inputrec*           ir,
+                                     const gmx_enerdata_t* enerd,
+                                     t_state*              state_local,
+                                     int64_t               step,
+                                     real                  time)
+{
+    /* The ratio of the new and the old reference temperature */
+    real temperatureScaling = 1;
+
+    if (MASTER(cr))
+    {
+        /* In this mode re->repl is the replica this simulation currently
+         * samples, so all replica-indexed data collected in the test
+         * below refers to the configuration of the right replica.
+         */
+        test_for_replica_exchange(fplog, ms, re, enerd, det(state_local->box), step, time);
+
+        /* The configuration at replica destinations[i] moves to replica i */
+        int newReplica = re->repl;
+        for (int i = 0; i < re->nrepl; i++)
+        {
+            if (re->destinations[i] == re->repl)
+            {
+                newReplica = i;
+            }
+        }
+        if (newReplica != re->repl)
+        {
+            temperatureScaling = re->q[ereTEMP][newReplica] / re->q[ereTEMP][re->repl];
+            re->repl           = newReplica;
+            re->temp           = re->q[ereTEMP][newReplica];
+            fprintf(fplog, "Repl  This simulation now samples replica %d with T = %g\n",
+                    newReplica, re->temp);
+        }
+    }
+    if (DOMAINDECOMP(cr))
+    {
+#if GMX_MPI
+        MPI_Bcast(&temperatureScaling, sizeof(real), MPI_BYTE, MASTERRANK(cr),
+                  cr->mpi_comm_mygroup);
+#endif
+    }
+
+    /* Replicas have distinct temperatures, so a ratio of one means no exchange */
+    if (temperatureScaling == 1)
+    {
+        return FALSE;
+    }
+
+    for (int i = 0; i < ir->opts.ngtc; i++)
+    {
+        ir->opts.ref_t[i] *= temperatureScaling;
+    }
+    scale_velocities(state_local->v, std::sqrt(temperatureScaling));
+
+    return TRUE;
+}
+
 void print_replica_exchange_statistics(FILE* fplog, struct gmx_repl_ex* re)
 {
     int i;
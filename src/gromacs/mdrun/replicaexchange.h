@@ -68,19 +68,26 @@ struct ReplicaExchangeParameters
     int numExchanges = 0;
     //! The random seed, -1 means generate a seed.
     int randomSeed = -1;
+    //! Whether to exchange the reference temperatures instead of the coordinates and velocities.
+    bool swapParameters = false;
 };
 
 //! Abstract type for replica exchange
 typedef struct gmx_repl_ex* gmx_repl_ex_t;
 
 /*! \brief Setup function.
+ *
+ * \p startedFromCheckpoint is used to reject continuing parameter-swap
+ * replica exchange, as the checkpoint does not store which replica each
+ * simulation samples.
  *
  * Should only be called on the master ranks */
 gmx_repl_ex_t init_replica_exchange(FILE*                            fplog,
                                     const gmx_multisim_t*            ms,
                                     int                              numAtomsInSystem,
                                     const t_inputrec*                ir,
-                                    const ReplicaExchangeParameters& replExParams);
+                                    const ReplicaExchangeParameters& replExParams,
+                                    bool                             startedFromCheckpoint);
 
 /*! \brief Attempts replica exchange.
  *
@@ -102,6 +109,30 @@ gmx_bool replica_exchange(FILE*                 fplog,
                           int64_t               step,
                           real                  time);
 
+/*! \brief Attempts replica exchange by swapping the reference temperatures.
+ *
+ * Should be called on all ranks, instead of replica_exchange() when
+ * ReplicaExchangeParameters::swapParameters is set. The acceptance test
+ * is the same, but instead of sending the coordinates and velocities to
+ * the simulation of the other replica, each simulation keeps its state and
+ * takes over the reference temperatures of the replica its configuration
+ * moved to. The amount of communication is thus independent of the system
+ * size and no domain repartitioning is needed. The velocities in
+ * \p state_local are scaled to the new temperature.
+ *
+ * \returns TRUE if the reference temperatures in \p ir have changed, in which
+ * case the temperature-dependent update constants need to be recomputed.
+ */
+gmx_bool replica_exchange_parameters(FILE*                 fplog,
+                                     const t_commrec*      cr,
+                                     const gmx_multisim_t* ms,
+                                     gmx_repl_ex_t         re,
+                                     t_inputrec*           ir,
+                                     const gmx_enerdata_t* enerd,
+                                     t_state*              state_local,
+                                     int64_t               step,
+                                     real                  time);
+
 /*! \brief Prints replica exchange statistics to the log file.
  *
  * Should only be called on the master ranks */
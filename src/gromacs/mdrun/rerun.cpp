@@ -115,6 +115,8 @@
 #include "gromacs/mdtypes/simulation_workload.h"
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/mimic/utilities.h"
+#include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/pairlistsets.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pulling/pull.h"
 #include "gromacs/swap/swapcoords.h"
@@ -165,6 +167,179 @@ static void prepareRerunState(const t_trxframe&          rerunFrame,
     }
 }
 
+namespace gmx
+{
+
+namespace
+{
+
+/*! \brief Decides per rerun frame whether the pairlist of an earlier frame can be reused
+ *
+ * A pairlist built with radius rlist contains all pairs within the
+ * interaction cut-off as long as no pair of atoms approached by more than
+ * the buffer rlist - cut-off. This is guaranteed when twice the maximum
+ * atom displacement since the list was built is not larger than the buffer.
+ * With dynamic pruning on the CPU, the inner list radius and the coordinates
+ * at the last pruning step are used in the same way, and on pruning steps the
+ * displacement since the search needs to be within the outer-inner buffer.
+ * Frames of a trajectory that are close in time often fulfill this, so most
+ * searches can be avoided while the forces and energies are identical
+ * up to the order of summation.
+ *
+ * Reuse is only supported without domain decomposition, as the rerun loop
+ * repartitions every frame, without shells, as these are relaxed starting from
+ * the frame coordinates, and with GPU lists only without dynamic pruning,
+ * as this happens asynchronously.
+ */
+class RerunPairlistReuse
+{
+public:
+    //! Constructor, sets whether reuse is supported for this setup
+    RerunPairlistReuse(const t_forcerec& fr, bool haveDomainDecomposition, bool haveShells) :
+        fr_(fr),
+        isSupported_(!haveDomainDecomposition && !haveShells && fr.pbcType != PbcType::Screw
+                     && !(fr.nbv->useGpu() && fr.nbv->pairlistSets().params().useDynamicPruning)
+                     && getenv("GMX_DISABLE_RERUN_PAIRLIST_REUSE") == nullptr)
+    {
+    }
+
+    /*! \brief Returns whether the pairlist can be used for coordinates \p x at \p step
+     *
+     * When the list can be reused, the atoms in \p x are shifted to the periodic
+     * images closest to their positions at the last search, since the list
+     * stores the periodic shifts for those.
+     */
+    bool canReusePairlist(ArrayRef<RVec> x, const matrix box, int64_t step)
+    {
+        numFrames_++;
+
+        if (!haveSearched_ || !isSupported_ || x.size() != xSearch_.size()
+            || !boxesAreEqual(box, boxSearch_))
+        {
+            return false;
+        }
+
+        const PairlistParams& params           = fr_.nbv->pairlistSets().params();
+        const real            interactionCutoff = std::max(fr_.ic->rvdw, fr_.ic->rcoulomb);
+        const bool            pruneThisStep     = fr_.nbv->isDynamicPruningStepCpu(step);
+
+        t_pbc pbc;
+        set_pbc(&pbc, fr_.pbcType, box);
+
+        /* The maximum displacements since the last search and the last pruning */
+        real maxDisplacement2Search = 0;
+        real maxDisplacement2Prune  = 0;
+        for (int i = 0; i < x.ssize(); i++)
+        {
+            rvec dx;
+            pbc_dx_aiuc(&pbc, x[i], xSearch_[i], dx);
+            maxDisplacement2Search = std::max(maxDisplacement2Search, norm2(dx));
+            rvec_add(xSearch_[i], dx, shiftedX_[i]);
+            if (params.useDynamicPruning)
+            {
+                maxDisplacement2Prune =
+                        std::max(maxDisplacement2Prune, distance2(shiftedX_[i], xPrune_[i]));
+            }
+        }
+
+        const real maxDisplacementSearch = std::sqrt(maxDisplacement2Search);
+        const real maxDisplacementPrune  = std::sqrt(maxDisplacement2Prune);
+        bool       canReuse;
+        if (!params.useDynamicPruning)
+        {
+            canReuse = (2 * maxDisplacementSearch <= params.rlistOuter - interactionCutoff);
+        }
+        else if (pruneThisStep)
+        {
+            canReuse = (2 * maxDisplacementSearch <= params.rlistOuter - params.rlistInner);
+        }
+        else
+        {
+            canReuse = (2 * maxDisplacementPrune <= params.rlistInner - interactionCutoff);
+        }
+
+        if (canReuse)
+        {
+            std::copy(shiftedX_.begin(), shiftedX_.end(), x.begin());
+            if (pruneThisStep)
+            {
+                xPrune_ = shiftedX_;
+            }
+        }
+
+        return canReuse;
+    }
+
+    //! Stores the coordinates, after placing them in the box, of a frame with a search
+    void setSearchCoordinates(ArrayRef<const RVec> x, const matrix box)
+    {
+        numSearches_++;
+        if (!isSupported_)
+        {
+            return;
+        }
+        haveSearched_ = true;
+        xSearch_.assign(x.begin(), x.end());
+        xPrune_ = xSearch_;
+        shiftedX_.resize(xSearch_.size());
+        copy_mat(box, boxSearch_);
+    }
+
+    //! Notes how many frames reused the pairlist in the log
+    void printStatistics(const MDLogger& mdlog) const
+    {
+        if (isSupported_ && numFrames_ > 0)
+        {
+            GMX_LOG(mdlog.info)
+                    .asParagraph()
+                    .appendTextFormatted(
+                            "The pair list was reused, instead of searched, for %d out of %d "
+                            "rerun frames",
+                            numFrames_ - numSearches_, numFrames_);
+        }
+    }
+
+private:
+    //! Returns whether the two boxes are identical
+    static bool boxesAreEqual(const matrix box1, const matrix box2)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            for (int e = 0; e < DIM; e++)
+            {
+                if (box1[d][e] != box2[d][e])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    //! The force record, holds the pairlist setup
+    const t_forcerec& fr_;
+    //! Whether pairlist reuse is supported
+    const bool isSupported_;
+    //! Whether a search has been done
+    bool haveSearched_ = false;
+    //! The coordinates at the last search
+    std::vector<RVec> xSearch_;
+    //! The coordinates at the last pruning, only used with dynamic pruning
+    std::vector<RVec> xPrune_;
+    //! Buffer for the coordinates shifted towards the images at the last search
+    std::vector<RVec> shiftedX_;
+    //! The box at the last search
+    matrix boxSearch_ = { { 0 } };
+    //! The number of frames processed
+    int numFrames_ = 0;
+    //! The number of frames with a search
+    int numSearches_ = 0;
+};
+
+} // namespace
+
+} // namespace gmx
+
 void gmx::LegacySimulator::do_rerun()
 {
     // TODO Historically, the EM and MD "integrators" used different
@@ -269,10 +444,12 @@ void gmx::LegacySimulator::do_rerun()
     /* Settings for rerun */
     ir->nstlist              = 1;
     ir->nstcalcenergy        = 1;
-    int        nstglobalcomm = 1;
-    const bool bNS           = true;
+    int nstglobalcomm = 1;
+    bool bNS          = true;
 
     ir->nstxout_compressed         = 0;
+    ir->nstvout_compressed         = 0;
+    ir->nstfout_compressed         = 0;
     const SimulationGroups* groups = &top_global->groups;
     if (ir->eI == eiMimic)
     {
@@ -395,7 +572,8 @@ void gmx::LegacySimulator::do_rerun()
     rerun_fr.natoms = 0;
     if (MASTER(cr))
     {
-        isLastStep = !read_first_frame(oenv, &status, opt2fn("-rerun", nfile, fnm), &rerun_fr, TRX_NEED_X);
+        isLastStep = !read_first_frame(oenv, &status, opt2fn("-rerun", nfile, fnm), &rerun_fr,
+                                       TRX_NEED_X | TRX_PREFETCH);
         if (rerun_fr.natoms != top_global->natoms)
         {
             gmx_fatal(FARGS,
@@ -457,6 +635,8 @@ void gmx::LegacySimulator::do_rerun()
 
     const DDBalanceRegionHandler ddBalanceRegionHandler(cr);
 
+    RerunPairlistReuse pairlistReuse(*fr, DOMAINDECOMP(cr), shellfc != nullptr);
+
     /* and stop now if we should */
     isLastStep = (isLastStep || (ir->nsteps >= 0 && step_rel > ir->nsteps));
     while (!isLastStep)
@@ -507,6 +687,8 @@ void gmx::LegacySimulator::do_rerun()
             prepareRerunState(rerun_fr, state_global, constructVsites, vsite, ir->delta_t);
         }
 
+        bNS = !pairlistReuse.canReusePairlist(state->x, state->box, step);
+
         isLastStep = isLastStep || stopHandler->stoppingAfterCurrentStep(bNS);
 
         if (DOMAINDECOMP(cr))
@@ -555,7 +737,12 @@ void gmx::LegacySimulator::do_rerun()
             do_force(fplog, cr, ms, ir, awh, enforcedRotation, imdSession, pull_work, step, nrnb,
                      wcycle, &top, state->box, state->x.arrayRefWithPadding(), &state->hist,
                      &f.view(), force_vir, mdatoms, enerd, state->lambda, fr, runScheduleWork,
-                     vsite, mu_tot, t, ed, GMX_FORCE_NS | force_flags, ddBalanceRegionHandler);
+                     vsite, mu_tot, t, ed, (bNS ? GMX_FORCE_NS : 0) | force_flags,
+                     ddBalanceRegionHandler);
+        }
+        if (bNS)
+        {
+            pairlistReuse.setSearchCoordinates(state->x, state->box);
         }
 
         /* Now we have the energies and forces corresponding to the
@@ -700,6 +887,8 @@ void gmx::LegacySimulator::do_rerun()
 
     done_mdoutf(outf);
 
+    pairlistReuse.printStatistics(mdlog);
+
     done_shellfc(fplog, shellfc, step_rel);
 
     walltime_accounting_set_nsteps_done(walltime_accounting, step_rel);
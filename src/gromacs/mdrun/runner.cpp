@@ -132,6 +132,7 @@
 #include "gromacs/nbnxm/gpu_data_mgmt.h"
 #include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/nbnxm/pairlist_tuning.h"
+#include "gromacs/nbnxm/pairlistparams.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pulling/output.h"
 #include "gromacs/pulling/pull.h"
@@ -161,6 +162,7 @@
 #include "gromacs/utility/logger.h"
 #include "gromacs/utility/loggerbuilder.h"
 #include "gromacs/utility/mdmodulenotification.h"
+#include "gromacs/utility/mpiinfo.h"
 #include "gromacs/utility/physicalnodecommunicator.h"
 #include "gromacs/utility/pleasecite.h"
 #include "gromacs/utility/programcontext.h"
@@ -185,7 +187,9 @@ namespace gmx
  * issued.
  *
  * Note that some development features overrides are applied already here:
- * the GPU communication flags are set to false in non-tMPI and non-CUDA builds.
+ * the GPU communication flags are set to false in non-CUDA builds, GPU PME-PP
+ * communication in non-tMPI builds, and GPU halo exchange with library MPI
+ * when the MPI library is not CUDA-aware.
  *
  * \param[in]  mdlog                Logger object.
  * \param[in]  useGpuForNonbonded   True if the nonbonded task is offloaded in this run.
@@ -205,10 +209,11 @@ static DevelopmentFeatureFlags manageDevelopmentFeatures(const gmx::MDLogger& md
 
     devFlags.enableGpuBufferOps =
             GMX_GPU_CUDA && useGpuForNonbonded && (getenv("GMX_USE_GPU_BUFFER_OPS") != nullptr);
-    devFlags.enableGpuHaloExchange = GMX_GPU_CUDA && GMX_THREAD_MPI && getenv("GMX_GPU_DD_COMMS") != nullptr;
+    devFlags.enableGpuHaloExchange = GMX_GPU_CUDA && GMX_MPI && getenv("GMX_GPU_DD_COMMS") != nullptr;
+    const bool forceCudaAwareMpi   = (getenv("GMX_FORCE_CUDA_AWARE_MPI") != nullptr);
     devFlags.forceGpuUpdateDefault = (getenv("GMX_FORCE_UPDATE_DEFAULT_GPU") != nullptr) || GMX_FAHCORE;
     devFlags.enableGpuPmePPComm =
-            GMX_GPU_CUDA && GMX_THREAD_MPI && getenv("GMX_GPU_PME_PP_COMMS") != nullptr;
+            GMX_GPU_CUDA && GMX_MPI && getenv("GMX_GPU_PME_PP_COMMS") != nullptr;
 
 #pragma GCC diagnostic pop
 
@@ -231,6 +236,41 @@ static DevelopmentFeatureFlags manageDevelopmentFeatures(const gmx::MDLogger& md
                         "decomposition lacks substantial testing and should be used with caution.");
     }
 
+    if (devFlags.enableGpuHaloExchange && GMX_LIB_MPI)
+    {
+        // With library MPI the halo data is communicated by passing
+        // device buffers to MPI, which requires CUDA-aware MPI.
+        const CudaAwareMpiStatus cudaAwareMpiStatus = checkMpiCudaAwareSupport();
+        if (cudaAwareMpiStatus == CudaAwareMpiStatus::Supported || forceCudaAwareMpi)
+        {
+            if (cudaAwareMpiStatus != CudaAwareMpiStatus::Supported)
+            {
+                GMX_LOG(mdlog.warning)
+                        .asParagraph()
+                        .appendTextFormatted(
+                                "The MPI library does not report CUDA-aware support, but its use "
+                                "was forced by the GMX_FORCE_CUDA_AWARE_MPI environment variable. "
+                                "The GPU halo exchange will fail if the MPI library cannot "
+                                "communicate from and to GPU memory.");
+            }
+        }
+        else
+        {
+            GMX_LOG(mdlog.warning)
+                    .asParagraph()
+                    .appendTextFormatted(
+                            "GMX_GPU_DD_COMMS environment variable detected, but the 'GPU halo "
+                            "exchange' feature will not be enabled as %s. If you are sure that "
+                            "your MPI library is CUDA-aware, you can force its use by setting the "
+                            "GMX_FORCE_CUDA_AWARE_MPI environment variable.",
+                            cudaAwareMpiStatus == CudaAwareMpiStatus::NotSupported
+                                    ? "the MPI library reports that it is not CUDA-aware"
+                                    : "it could not be detected whether the MPI library is "
+                                      "CUDA-aware");
+            devFlags.enableGpuHaloExchange = false;
+        }
+    }
+
     if (devFlags.enableGpuHaloExchange)
     {
         if (useGpuForNonbonded)
@@ -263,6 +303,29 @@ static DevelopmentFeatureFlags manageDevelopmentFeatures(const gmx::MDLogger& md
         }
     }
 
+    if (devFlags.enableGpuPmePPComm && GMX_LIB_MPI)
+    {
+        // With library MPI the PME ranks can be on other nodes and the
+        // PME-PP data is communicated by passing device buffers to MPI,
+        // which requires CUDA-aware MPI.
+        const CudaAwareMpiStatus cudaAwareMpiStatus = checkMpiCudaAwareSupport();
+        if (cudaAwareMpiStatus != CudaAwareMpiStatus::Supported && !forceCudaAwareMpi)
+        {
+            GMX_LOG(mdlog.warning)
+                    .asParagraph()
+                    .appendTextFormatted(
+                            "GMX_GPU_PME_PP_COMMS environment variable detected, but the 'GPU "
+                            "PME-PP communications' feature will not be enabled as %s. If you are "
+                            "sure that your MPI library is CUDA-aware, you can force its use by "
+                            "setting the GMX_FORCE_CUDA_AWARE_MPI environment variable.",
+                            cudaAwareMpiStatus == CudaAwareMpiStatus::NotSupported
+                                    ? "the MPI library reports that it is not CUDA-aware"
+                                    : "it could not be detected whether the MPI library is "
+                                      "CUDA-aware");
+            devFlags.enableGpuPmePPComm = false;
+        }
+    }
+
     if (devFlags.enableGpuPmePPComm)
     {
         if (pmeRunMode == PmeRunMode::GPU)
@@ -520,16 +583,30 @@ static bool gpuAccelerationOfNonbondedIsUseful(const MDLogger& mdlog, const t_in
     bool        gpuIsUseful = true;
     std::string warning;
 
-    if (ir.opts.ngener - ir.nwall > 1)
+    if (ir.opts.ngener - ir.nwall > 1
+        && (!GMX_GPU_CUDA || ir.opts.ngener > c_nbnxnGpuMaxNumEnergyGroups))
     {
-        /* The GPU code does not support more than one energy group.
+        /* Only the CUDA kernels support multiple energy groups, up to a limited number.
+         * Note that the wall groups are also counted in the nonbonded kernels.
          * If the user requested GPUs explicitly, a fatal error is given later.
          */
         gpuIsUseful = false;
-        warning =
-                "Multiple energy groups is not implemented for GPUs, falling back to the CPU. "
-                "For better performance, run on the GPU without energy groups and then do "
-                "gmx mdrun -rerun option on the trajectory with an energy group .tpr file.";
+        if (GMX_GPU_CUDA)
+        {
+            warning = formatString(
+                    "More than %d energy groups is not implemented for GPUs, falling back to the "
+                    "CPU. For better performance, run on the GPU with fewer energy groups and "
+                    "then do gmx mdrun -rerun option on the trajectory with an energy group .tpr "
+                    "file.",
+                    c_nbnxnGpuMaxNumEnergyGroups);
+        }
+        else
+        {
+            warning =
+                    "Multiple energy groups is not implemented for GPUs, falling back to the CPU. "
+                    "For better performance, run on the GPU without energy groups and then do "
+                    "gmx mdrun -rerun option on the trajectory with an energy group .tpr file.";
+        }
     }
 
     if (EI_TPI(ir.eI))
@@ -692,9 +769,13 @@ static void finish_run(FILE*                     fplog,
         {
             pme_gpu_get_timings(pme, &pme_gpu_timings);
         }
+        gmx_gpu_nbnxn_list_counters_t gpuListCounters;
+        const bool                    haveGpuListCounters =
+                (nbv != nullptr && nbv->getGpuListCounters(&gpuListCounters));
+
         wallcycle_print(fplog, mdlog, cr->nnodes, cr->npmenodes, nthreads_pp, nthreads_pme,
                         elapsed_time_over_all_ranks, wcycle, cycle_sum, nbnxn_gpu_timings,
-                        &pme_gpu_timings);
+                        &pme_gpu_timings, haveGpuListCounters ? &gpuListCounters : nullptr);
 
         if (EI_DYNAMICS(inputrec->eI))
         {
@@ -779,8 +860,14 @@ int Mdrunner::mdrunner()
 
     auto partialDeserializedTpr = std::make_unique<PartialDeserializedTprFile>();
 
+    // Wall times of the startup phases, reported in the log after GPU setup
+    double inputReadTimeInSeconds   = 0;
+    double deviceSetupTimeInSeconds = 0;
+
     if (isSimulationMasterRank)
     {
+        const double inputReadStart = gmx_gettime();
+
         // Allocate objects to be initialized by later function calls.
         /* Only the master rank has the global state */
         globalState = std::make_unique<t_state>();
@@ -791,6 +878,8 @@ int Mdrunner::mdrunner()
          */
         applyGlobalSimulationState(*inputHolder_.get(), partialDeserializedTpr.get(),
                                    globalState.get(), inputrec.get(), &mtop);
+        retainGlobalSimulationState(inputHolder_.get(), *partialDeserializedTpr, *globalState);
+        inputReadTimeInSeconds = gmx_gettime() - inputReadStart;
     }
 
     /* Check and update the hardware options for internal consistency */
@@ -827,7 +916,14 @@ int Mdrunner::mdrunner()
          * correctly. */
         hw_opt.nthreads_tmpi =
                 get_nthreads_mpi(hwinfo_, &hw_opt, numDevicesToUse, useGpuForNonbonded, useGpuForPme,
-                                 inputrec.get(), &mtop, mdlog, membedHolder.doMembed());
+                                 domdecOptions.numPmeRanks, inputrec.get(), &mtop, mdlog,
+                                 membedHolder.doMembed());
+        if (useGpuForPme && hw_opt.nthreads_tmpi == 2 && domdecOptions.numPmeRanks < 0)
+        {
+            // PME on GPUs with two ranks is only supported with a separate PME rank,
+            // which then gets its own GPU. This is inherited by the spawned threads.
+            domdecOptions.numPmeRanks = 1;
+        }
 
         // Now start the threads for thread MPI.
         spawnThreads(hw_opt.nthreads_tmpi);
@@ -1282,10 +1378,22 @@ int Mdrunner::mdrunner()
         {
             dd_setup_dlb_resource_sharing(cr, deviceId);
         }
+        const double deviceSetupStart = gmx_gettime();
+
         deviceStreamManager = std::make_unique<DeviceStreamManager>(
                 *deviceInfo, havePPDomainDecomposition(cr), runScheduleWork.simulationWork, useTiming);
+
+        deviceSetupTimeInSeconds = gmx_gettime() - deviceSetupStart;
     }
 
+    GMX_LOG(mdlog.info)
+            .asParagraph()
+            .appendTextFormatted(
+                    "Startup wall times (s): hardware detection %.3f, reading input %.3f, "
+                    "GPU context and stream setup %.3f",
+                    hwinfo_->detectionTimeInSeconds, inputReadTimeInSeconds,
+                    deviceSetupTimeInSeconds);
+
     // If the user chose a task assignment, give them some hints
     // where appropriate.
     if (!userGpuTaskAssignment.empty())
@@ -1383,13 +1491,15 @@ int Mdrunner::mdrunner()
          */
         gmx_check_thread_affinity_set(mdlog, &hw_opt, hwinfo_->nthreads_hw_avail, TRUE);
 
-        int numThreadsOnThisNode, intraNodeThreadOffset;
+        int  numThreadsOnThisNode, intraNodeThreadOffset;
+        bool allRanksOnThisNodeHaveEqualNumThreads;
         analyzeThreadsOnThisNode(physicalNodeComm, numThreadsOnThisRank, &numThreadsOnThisNode,
-                                 &intraNodeThreadOffset);
+                                 &intraNodeThreadOffset, &allRanksOnThisNodeHaveEqualNumThreads);
 
         /* Set the CPU affinity */
         gmx_set_thread_affinity(mdlog, cr, &hw_opt, *hwinfo_->hardwareTopology, numThreadsOnThisRank,
-                                numThreadsOnThisNode, intraNodeThreadOffset, nullptr);
+                                numThreadsOnThisNode, intraNodeThreadOffset,
+                                allRanksOnThisNodeHaveEqualNumThreads, nullptr);
     }
 
     if (mdrunOptions.timingOptions.resetStep > -1)
@@ -1460,6 +1570,24 @@ int Mdrunner::mdrunner()
         fr->nbv = Nbnxm::init_nb_verlet(mdlog, inputrec.get(), fr, cr, *hwinfo_,
                                         runScheduleWork.simulationWork.useGpuNonbonded,
                                         deviceStreamManager.get(), &mtop, box, wcycle);
+        if (getenv("GMX_NB_GPU_CPU_SPLIT") != nullptr)
+        {
+            // The CPU part of the work uses the coordinate and force buffers on the host
+            if (runScheduleWork.simulationWork.useGpuNonbonded
+                && !runScheduleWork.simulationWork.useGpuBufferOps)
+            {
+                fr->nbv->enableGpuCpuWorkSplit(mdlog, *fr->ic);
+            }
+            else
+            {
+                GMX_LOG(mdlog.warning)
+                        .asParagraph()
+                        .appendText(
+                                "GMX_NB_GPU_CPU_SPLIT is only supported with non-bonded "
+                                "interactions on a GPU without GPU buffer operations or update, "
+                                "ignoring it");
+            }
+        }
         // TODO: Move the logic below to a GPU bonded builder
         if (runScheduleWork.simulationWork.useGpuBonded)
         {
@@ -1738,6 +1866,12 @@ int Mdrunner::mdrunner()
         auto simulator = simulatorBuilder.build(useModularSimulator);
         simulator->run();
 
+        if (MASTER(cr) && EI_DYNAMICS(inputrec->eI) && !doRerun && mdrunOptions.writeConfout)
+        {
+            // Only with confout output is the final configuration collected in globalState
+            updateRetainedState(inputHolder_.get(), *globalState);
+        }
+
         if (fr->pmePpCommGpu)
         {
             // destroy object since it is no longer required. (This needs to be done while the GPU context still exists.)
@@ -97,6 +97,12 @@ struct t_shell
     rvec xold;            /* The old shell coordinates */
     rvec fold;            /* The old force on the shell */
     rvec step;            /* Step size for steepest descents */
+    /* The shell displacements with respect to nucl1 at the end of the last two
+     * relaxations, used for extrapolating the shell positions
+     */
+    rvec dispLast       = { 0 };
+    rvec dispPrev       = { 0 };
+    int  numDispHistory = 0; /* The number of valid displacements, max 2 */
 };
 
 struct gmx_shellfc_t
@@ -109,6 +115,8 @@ struct gmx_shellfc_t
     bool                 predictShells = false; /* Predict shell positions                   */
     bool                 requireInit   = false; /* Require initialization of shell positions */
     int                  nflexcon      = 0;     /* The number of flexible constraints        */
+    /* Predict shell positions by extrapolating their displacements */
+    bool extrapolateShells = false;
 
     std::array<PaddedHostVector<RVec>, 2> x; /* Coordinate buffers for iterative minimization */
     std::array<PaddedHostVector<RVec>, 2> f; /* Force buffers for iterative minimization */
@@ -253,6 +261,42 @@ static void predict_shells(FILE*                   fplog,
     }
 }
 
+/*! \brief Predicts shell positions by linear extrapolation of their displacements
+ *
+ * The displacement of each shell with respect to its first nucleus at the end
+ * of the last two relaxations is extrapolated to the current step. Shells with
+ * less history keep the position given by predict_shells().
+ */
+static void extrapolate_shells(ArrayRef<RVec> x, ArrayRef<const t_shell> shells)
+{
+    for (const t_shell& shell : shells)
+    {
+        if (shell.numDispHistory == 2)
+        {
+            const int s1 = shell.shellIndex;
+            const int n1 = shell.nucl1;
+            for (int m = 0; m < DIM; m++)
+            {
+                x[s1][m] = x[n1][m] + 2 * shell.dispLast[m] - shell.dispPrev[m];
+            }
+        }
+    }
+}
+
+/*! \brief Stores the current shell displacements for extrapolate_shells() */
+static void store_shell_displacements(ArrayRef<const RVec> x,
+                                      ArrayRef<t_shell>    shells,
+                                      const t_pbc*         pbc)
+{
+    for (t_shell& shell : shells)
+    {
+        copy_rvec(shell.dispLast, shell.dispPrev);
+        /* The shell and its nucleus can be in different periodic images */
+        pbc_dx_aiuc(pbc, x[shell.shellIndex], x[shell.nucl1], shell.dispLast);
+        shell.numDispHistory = std::min(shell.numDispHistory + 1, 2);
+    }
+}
+
 gmx_shellfc_t* init_shell_flexcon(FILE*             fplog,
                                   const gmx_mtop_t* mtop,
                                   int               nflexcon,
@@ -518,6 +562,11 @@ gmx_shellfc_t* init_shell_flexcon(FILE*             fplog,
         {
             fprintf(fplog, "\nWill always initiate shell positions\n");
         }
+        shfc->extrapolateShells = (getenv("GMX_SHELL_EXTRAPOLATE") != nullptr);
+        if (shfc->extrapolateShells && fplog)
+        {
+            fprintf(fplog, "\nWill predict shell positions by extrapolating displacements\n");
+        }
     }
 
     if (shfc->predictShells)
@@ -536,7 +585,8 @@ gmx_shellfc_t* init_shell_flexcon(FILE*             fplog,
              *    shell velocities are zeroed, it's a bit tricky to keep
              *    track of the shell displacements and thus the velocity.
              */
-            shfc->predictShells = false;
+            shfc->predictShells     = false;
+            shfc->extrapolateShells = false;
         }
     }
 
@@ -1027,6 +1077,10 @@ void relax_shell_flexcon(FILE*                         fplog,
     if (shfc->predictShells && !bCont && (EI_STATE_VELOCITY(inputrec->eI) || bInit))
     {
         predict_shells(fplog, x, v, inputrec->delta_t, shells, md->massT, nullptr, bInit);
+        if (shfc->extrapolateShells && !bInit)
+        {
+            extrapolate_shells(x, shells);
+        }
     }
 
     /* Calculate the forces first time around */
@@ -1220,6 +1274,13 @@ void relax_shell_flexcon(FILE*                         fplog,
     /* Copy back the coordinates and the forces */
     std::copy(pos[Min].begin(), pos[Min].end(), x.data());
     std::copy(force[Min].begin(), force[Min].end(), f->force().begin());
+
+    if (shfc->extrapolateShells && EI_STATE_VELOCITY(inputrec->eI))
+    {
+        t_pbc pbc;
+        set_pbc(&pbc, fr->pbcType, box);
+        store_shell_displacements(x, shfc->shells, &pbc);
+    }
 }
 
 void done_shellfc(FILE* fplog, gmx_shellfc_t* shfc, int64_t numSteps)
@@ -39,9 +39,11 @@
 
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/tpxio.h"
+#include "gromacs/math/vec.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/observableshistory.h"
 #include "gromacs/mdtypes/state.h"
+#include "gromacs/utility/gmxassert.h"
 
 namespace gmx
 {
@@ -52,10 +54,53 @@ void applyGlobalSimulationState(const SimulationInput&      simulationInput,
                                 t_inputrec*                 inputRecord,
                                 gmx_mtop_t*                 molecularTopology)
 {
+    if (simulationInput.retainedTpr_)
+    {
+        // Deserialize from memory, as non-master ranks do after the broadcast
+        *partialDeserializedTpr = *simulationInput.retainedTpr_;
+        partialDeserializedTpr->pbcType =
+                completeTprDeserialization(partialDeserializedTpr, inputRecord, molecularTopology);
+        *globalState = *simulationInput.retainedState_;
+        return;
+    }
     *partialDeserializedTpr = read_tpx_state(simulationInput.tprFilename_.c_str(), inputRecord,
                                              globalState, molecularTopology);
 }
 
+void retainGlobalSimulationState(SimulationInput*                  simulationInput,
+                                 const PartialDeserializedTprFile& partialDeserializedTpr,
+                                 const t_state&                    globalState)
+{
+    if (!simulationInput->retainInMemory_ || simulationInput->retainedTpr_)
+    {
+        return;
+    }
+    // The state was just read, so it does not refer to any history data yet
+    simulationInput->retainedTpr_ =
+            std::make_shared<PartialDeserializedTprFile>(partialDeserializedTpr);
+    simulationInput->retainedState_ = std::make_shared<t_state>(globalState);
+}
+
+void updateRetainedState(SimulationInput* simulationInput, const t_state& finalState)
+{
+    if (!simulationInput->retainedState_)
+    {
+        return;
+    }
+    t_state* state = simulationInput->retainedState_.get();
+    GMX_RELEASE_ASSERT(state->natoms == finalState.natoms,
+                       "The final state should match the retained input");
+    state->x = finalState.x;
+    copy_mat(finalState.box, state->box);
+    if ((finalState.flags & (1 << estV)) != 0)
+    {
+        state->v = finalState.v;
+        state->flags |= (1 << estV);
+    }
+    state->fep_state = finalState.fep_state;
+    state->lambda    = finalState.lambda;
+}
+
 void applyLocalState(const SimulationInput&         simulationInput,
                      t_fileio*                      logfio,
                      const t_commrec*               cr,
@@ -84,6 +84,19 @@ public:
 
     std::string tprFilename_;
     std::string cpiFilename_;
+
+    /*! \brief Whether to keep the input in memory for further runs from this input.
+     *
+     * When set, the runner retains the input record, topology and state after
+     * reading the TPR file once, and replaces the retained configuration by
+     * the final one of each run. Later runs then start a new simulation from
+     * that configuration without reading the TPR file or a checkpoint file.
+     */
+    bool retainInMemory_ = false;
+    //! Serialized input record and topology, once retained.
+    std::shared_ptr<PartialDeserializedTprFile> retainedTpr_;
+    //! Global state for the next run, once retained.
+    std::shared_ptr<t_state> retainedState_;
 };
 
 /*! \brief Get the global simulation input.
@@ -117,6 +130,26 @@ void applyGlobalSimulationState(const SimulationInput&      simulationInput,
                                 t_state*                    globalState,
                                 t_inputrec*                 inputrec,
                                 gmx_mtop_t*                 globalTopology);
+
+/*! \brief Keep the global input that was just read in memory.
+ *
+ * Only has an effect when \p simulationInput requests retaining its input
+ * and nothing is retained yet. Call on the simulation master rank.
+ */
+void retainGlobalSimulationState(SimulationInput*                  simulationInput,
+                                 const PartialDeserializedTprFile& partialDeserializedTpr,
+                                 const t_state&                    globalState);
+
+/*! \brief Replace the retained configuration by the final one of a run.
+ *
+ * Copies the coordinates, velocities, box and alchemical state, in the same
+ * way as \c gmx \c grompp \c -t starts from a configuration. Hidden degrees
+ * of freedom of thermostats and barostats are reinitialized from the input
+ * record by the next run. Call on the simulation master rank, with a global
+ * state that holds the final configuration.
+ */
+void updateRetainedState(SimulationInput* simulationInput, const t_state& finalState);
+
 // TODO: Implement the following, pending further discussion re #3374.
 std::unique_ptr<t_state> globalSimulationState(const SimulationInput&);
 void                     applyGlobalInputRecord(const SimulationInput&, t_inputrec*);
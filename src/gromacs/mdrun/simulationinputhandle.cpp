@@ -40,6 +40,7 @@
 #include <utility>
 
 #include "gromacs/mdrun/legacymdrunoptions.h"
+#include "gromacs/mdrun/simulationinput.h"
 
 namespace gmx
 {
@@ -54,18 +55,11 @@ namespace gmx
  * develop a much better understanding of simulation input portability.
  *
  */
-class SimulationInput
+SimulationInput::SimulationInput(const char* tprFilename, const char* cpiFilename) :
+    tprFilename_(tprFilename),
+    cpiFilename_(cpiFilename)
 {
-public:
-    SimulationInput(const char* tprFilename, const char* cpiFilename) :
-        tprFilename_(tprFilename),
-        cpiFilename_(cpiFilename)
-    {
-    }
-
-    std::string tprFilename_;
-    std::string cpiFilename_;
-};
+}
 /*! \endcond */
 
 class detail::SimulationInputHandleImpl final
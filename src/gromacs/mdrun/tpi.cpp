@@ -321,7 +321,7 @@ void LegacySimulator::do_tpi()
 
     if (EEL_PME(fr->ic->eeltype))
     {
-        gmx_pme_reinit_atoms(fr->pmedata, a_tp0, nullptr, nullptr);
+        gmx_pme_reinit_atoms(fr->pmedata, a_tp0, nullptr, nullptr, nullptr);
     }
 
     /* With reacion-field we have distance dependent potentials
@@ -597,6 +597,8 @@ void LegacySimulator::do_tpi()
         bStateChanged = TRUE;
         bNS           = TRUE;
 
+        bool haveSetSystemAtomProperties = false;
+
         put_atoms_in_box(fr->pbcType, box, x);
 
         /* Put all atoms except for the inserted ones on the grid */
@@ -677,10 +679,13 @@ void LegacySimulator::do_tpi()
                 nbnxn_put_on_grid(fr->nbv.get(), box, 1, x_init, x_init, nullptr, { a_tp0, a_tp1 },
                                   -1, fr->cginfo, x, 0, nullptr);
 
-                /* TODO: Avoid updating all atoms at every bNS step */
+                /* The system atoms only need to be set once per frame,
+                 * after that only the inserted molecule on grid 1.
+                 */
                 fr->nbv->setAtomProperties(gmx::constArrayRefFromArray(mdatoms->typeA, mdatoms->nr),
                                            gmx::constArrayRefFromArray(mdatoms->chargeA, mdatoms->nr),
-                                           fr->cginfo);
+                                           fr->cginfo, haveSetSystemAtomProperties ? 1 : 0);
+                haveSetSystemAtomProperties = true;
 
                 fr->nbv->constructPairlist(InteractionLocality::Local, top.excls, step, nrnb);
 
@@ -53,6 +53,7 @@
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/logger.h"
 #include "gromacs/utility/smalloc.h"
+#include "gromacs/utility/stringutil.h"
 
 std::unique_ptr<gmx_multisim_t> buildMultiSimulation(MPI_Comm                         worldComm,
                                                      gmx::ArrayRef<const std::string> multidirs)
@@ -217,6 +218,20 @@ void gmx_sumd_sim(int gmx_unused nr, double gmx_unused r[], const gmx_multisim_t
 #endif
 }
 
+void gmx_sumd_sim_start(int gmx_unused nr,
+                        double gmx_unused r[],
+                        const gmx_multisim_t gmx_unused* ms,
+                        MPI_Request gmx_unused* request)
+{
+#if !GMX_MPI
+    GMX_RELEASE_ASSERT(false, "Invalid call to gmx_sumd_sim_start");
+#elif GMX_LIB_MPI && MPI_VERSION >= 3
+    MPI_Iallreduce(MPI_IN_PLACE, r, nr, MPI_DOUBLE, MPI_SUM, ms->mastersComm_, request);
+#else
+    gmx_sumd_comm(nr, r, ms->mastersComm_);
+#endif
+}
+
 void gmx_sumf_sim(int gmx_unused nr, float gmx_unused r[], const gmx_multisim_t gmx_unused* ms)
 {
 #if !GMX_MPI
@@ -490,3 +505,119 @@ void logInitialMultisimStatus(const gmx_multisim_t* ms,
         }
     }
 }
+
+namespace gmx
+{
+
+/*! \brief Implementation of the queue of simulations
+ *
+ * The queue position is a counter on world rank 0, which the master
+ * ranks of the groups increment atomically with one-sided MPI
+ * communication. This needs no rank to serve the queue.
+ */
+class MultiSimulationQueue::Impl
+{
+public:
+    Impl(MPI_Comm worldComm, int numSimulations, int numGroups);
+    ~Impl();
+
+    //! The number of simulations in the queue
+    int numSimulations_;
+    //! The communicator between the ranks of this group
+    MPI_Comm groupComm_ = MPI_COMM_NULL;
+    //! Whether this rank claims the simulations for its group
+    bool isGroupMaster_ = false;
+#if GMX_LIB_MPI
+    //! The window exposing the queue position on world rank 0
+    MPI_Win queueWindow_ = MPI_WIN_NULL;
+    //! The queue position, only allocated on world rank 0
+    int* queuePosition_ = nullptr;
+#endif
+};
+
+MultiSimulationQueue::Impl::Impl(MPI_Comm worldComm, int numSimulations, int numGroups) :
+    numSimulations_(numSimulations)
+{
+#if GMX_LIB_MPI
+    int numRanks;
+    MPI_Comm_size(worldComm, &numRanks);
+    if (numGroups < 1 || numRanks % numGroups != 0)
+    {
+        auto message = gmx::formatString(
+                "The number of ranks (%d) is not a multiple of the number of simulation groups "
+                "(%d)",
+                numRanks, numGroups);
+        GMX_THROW(gmx::InconsistentInputError(message));
+    }
+    const int numRanksPerGroup = numRanks / numGroups;
+    int       rankWithinWorldComm;
+    MPI_Comm_rank(worldComm, &rankWithinWorldComm);
+
+    MPI_Comm_split(worldComm, rankWithinWorldComm / numRanksPerGroup, rankWithinWorldComm,
+                   &groupComm_);
+    isGroupMaster_ = (rankWithinWorldComm % numRanksPerGroup == 0);
+
+    const MPI_Aint windowSize = (rankWithinWorldComm == 0 ? sizeof(int) : 0);
+    MPI_Win_allocate(windowSize, sizeof(int), MPI_INFO_NULL, worldComm, &queuePosition_,
+                     &queueWindow_);
+    if (rankWithinWorldComm == 0)
+    {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, queueWindow_);
+        *queuePosition_ = 0;
+        MPI_Win_unlock(0, queueWindow_);
+    }
+    // No group should claim a simulation before the position is initialized
+    MPI_Barrier(worldComm);
+#else
+    GMX_UNUSED_VALUE(worldComm);
+    GMX_UNUSED_VALUE(numGroups);
+    GMX_THROW(gmx::NotImplementedError(
+            "Queues of simulations are only supported when GROMACS has been "
+            "configured with a proper external MPI library."));
+#endif
+}
+
+MultiSimulationQueue::Impl::~Impl()
+{
+#if GMX_LIB_MPI
+    if (queueWindow_ != MPI_WIN_NULL)
+    {
+        MPI_Win_free(&queueWindow_);
+    }
+    if (groupComm_ != MPI_COMM_NULL)
+    {
+        MPI_Comm_free(&groupComm_);
+    }
+#endif
+}
+
+MultiSimulationQueue::MultiSimulationQueue(MPI_Comm worldComm, int numSimulations, int numGroups) :
+    impl_(new Impl(worldComm, numSimulations, numGroups))
+{
+}
+
+MultiSimulationQueue::~MultiSimulationQueue() = default;
+
+MPI_Comm MultiSimulationQueue::groupComm() const
+{
+    return impl_->groupComm_;
+}
+
+int MultiSimulationQueue::claimNextSimulation()
+{
+    int simulationIndex = -1;
+#if GMX_LIB_MPI
+    if (impl_->isGroupMaster_)
+    {
+        const int increment = 1;
+        MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, impl_->queueWindow_);
+        MPI_Fetch_and_op(&increment, &simulationIndex, MPI_INT, 0, 0, MPI_SUM, impl_->queueWindow_);
+        MPI_Win_unlock(0, impl_->queueWindow_);
+    }
+    MPI_Bcast(&simulationIndex, 1, MPI_INT, 0, impl_->groupComm_);
+#endif
+
+    return (simulationIndex < impl_->numSimulations_) ? simulationIndex : -1;
+}
+
+} // namespace gmx
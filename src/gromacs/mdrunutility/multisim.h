@@ -49,6 +49,7 @@
 
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/gmxmpi.h"
 
 namespace gmx
@@ -142,6 +143,13 @@ void gmx_sumf_sim(int nr, float r[], const gmx_multisim_t* ms);
 //! Calculate the sum over the simulations of an array of doubles
 void gmx_sumd_sim(int nr, double r[], const gmx_multisim_t* ms);
 
+/*! \brief Start a sum over the simulations of an array of doubles
+ *
+ * \p r should not be accessed until gmx_sumd_wait() has been called
+ * with the same request. Without support for non-blocking collectives
+ * in the MPI library the sum is completed before returning. */
+void gmx_sumd_sim_start(int nr, double r[], const gmx_multisim_t* ms, MPI_Request* request);
+
 /*! \brief Return a vector containing the gathered values of \c
  * localValue found on the master rank of each simulation. */
 std::vector<int> gatherIntFromMultiSimulation(const gmx_multisim_t* ms, int localValue);
@@ -202,4 +210,51 @@ void logInitialMultisimStatus(const gmx_multisim_t* ms,
                               int                   numSteps,
                               int                   initialStep);
 
+namespace gmx
+{
+
+/*! \libinternal
+ * \brief Queue of simulations that groups of ranks run one after another
+ *
+ * Splits the MPI world into groups with equal numbers of ranks. Each
+ * group runs one simulation at a time and claims the next simulation
+ * from a queue shared by all groups when it finishes. Thus a group
+ * whose simulations finish early does not sit idle while simulations
+ * are still waiting to be run. The simulations are independent, so no
+ * multi-simulation communication is available between them.
+ */
+class MultiSimulationQueue
+{
+public:
+    /*! \brief Constructor, collective over \p worldComm
+     *
+     * \param[in]  worldComm       MPI communicator to split into groups
+     * \param[in]  numSimulations  The number of simulations in the queue
+     * \param[in]  numGroups       The number of groups of ranks
+     *
+     * \throws NotImplementedError     when not using real MPI
+     * \throws InconsistentInputError  when the number of MPI ranks is not a multiple
+     *                                 of \p numGroups
+     */
+    MultiSimulationQueue(MPI_Comm worldComm, int numSimulations, int numGroups);
+    ~MultiSimulationQueue();
+
+    //! Returns the communicator between the ranks of this group
+    MPI_Comm groupComm() const;
+
+    /*! \brief Returns the index of the next simulation this group should run
+     *
+     * Returns -1 when all simulations have been claimed.
+     * Collective over the ranks of this group.
+     */
+    int claimNextSimulation();
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace gmx
+
 #endif
@@ -0,0 +1,138 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Defines functions for exporting performance metrics while mdrun runs.
+ *
+ * \ingroup module_mdrunutility
+ */
+#include "gmxpre.h"
+
+#include "performancemetrics.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/timing/walltime_accounting.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/stringutil.h"
+
+namespace gmx
+{
+
+PerformanceMetrics computePerformanceMetrics(gmx_walltime_accounting* walltime_accounting,
+                                             int64_t                  step,
+                                             const t_inputrec&        ir,
+                                             float                    ddForceImbalanceLoss)
+{
+    PerformanceMetrics metrics;
+
+    metrics.step     = step;
+    metrics.wallTime = walltime_accounting_get_time_since_start(walltime_accounting);
+    if (metrics.wallTime > 0)
+    {
+        const double timePerStep = metrics.wallTime / (step - ir.init_step + 1);
+        metrics.nanosecondsPerDay = ir.delta_t / 1000 * 24 * 60 * 60 / timePerStep;
+    }
+    metrics.ddForceImbalanceLoss = ddForceImbalanceLoss;
+
+    return metrics;
+}
+
+std::string formatPerformanceMetricsAsJson(const PerformanceMetrics& metrics)
+{
+    std::string json = formatString(
+            "{\n  \"step\": %" PRId64 ",\n  \"wall_time_s\": %.3f,\n  \"performance_ns_per_day\": %.3f",
+            metrics.step, metrics.wallTime, metrics.nanosecondsPerDay);
+    if (metrics.ddForceImbalanceLoss >= 0)
+    {
+        json += formatString(",\n  \"dd_force_imbalance_loss\": %.4f", metrics.ddForceImbalanceLoss);
+    }
+    json += "\n}\n";
+
+    return json;
+}
+
+PerformanceMetricsWriter::PerformanceMetricsWriter(const std::string& fileName, double writeInterval) :
+    fileName_(fileName),
+    writeInterval_(writeInterval),
+    nextWriteTime_(gmx_gettime() + writeInterval)
+{
+}
+
+bool PerformanceMetricsWriter::isDue() const
+{
+    return gmx_gettime() >= nextWriteTime_;
+}
+
+void PerformanceMetricsWriter::write(const PerformanceMetrics& metrics)
+{
+    /* Write to a temporary file first, so readers never see a partial file */
+    const std::string temporaryFileName = fileName_ + ".tmp";
+
+    FILE* fp = gmx_ffopen(temporaryFileName, "w");
+    fputs(formatPerformanceMetricsAsJson(metrics).c_str(), fp);
+    gmx_ffclose(fp);
+    gmx_file_rename(temporaryFileName.c_str(), fileName_.c_str());
+
+    nextWriteTime_ = gmx_gettime() + writeInterval_;
+}
+
+std::unique_ptr<PerformanceMetricsWriter> makePerformanceMetricsWriterFromEnvironment(int simulationIndex)
+{
+    const char* fileNameEnv = std::getenv("GMX_PERFORMANCE_METRICS");
+    if (fileNameEnv == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::string fileName = fileNameEnv;
+    if (simulationIndex >= 0)
+    {
+        fileName += formatString(".%d", simulationIndex);
+    }
+
+    double      writeInterval = 60;
+    const char* intervalEnv   = std::getenv("GMX_PERFORMANCE_METRICS_INTERVAL");
+    if (intervalEnv != nullptr)
+    {
+        writeInterval = std::strtod(intervalEnv, nullptr);
+    }
+
+    return std::make_unique<PerformanceMetricsWriter>(fileName, writeInterval);
+}
+
+} // namespace gmx
@@ -0,0 +1,132 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ *
+ * \brief Declares functions for exporting performance metrics while mdrun runs.
+ *
+ * The metrics are written as a small JSON file that is replaced at
+ * regular wall-time intervals, so that schedulers and monitoring tools
+ * can follow the performance of a running simulation.
+ *
+ * \ingroup module_mdrunutility
+ * \inlibraryapi
+ */
+#ifndef GMX_MDRUNUTILITY_PERFORMANCEMETRICS_H
+#define GMX_MDRUNUTILITY_PERFORMANCEMETRICS_H
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+
+struct gmx_walltime_accounting;
+struct t_inputrec;
+
+namespace gmx
+{
+
+//! Performance metrics of a running simulation
+struct PerformanceMetrics
+{
+    //! The current step
+    int64_t step = 0;
+    //! The wall time in seconds since the start of the run
+    double wallTime = 0;
+    //! The average performance since the start of the run, 0 when not yet measured
+    double nanosecondsPerDay = 0;
+    //! The relative performance loss due to force load imbalance, -1 without domain decomposition
+    float ddForceImbalanceLoss = -1;
+};
+
+/*! \brief Returns the performance metrics for \p step
+ *
+ * \param[in] walltime_accounting   Wall time accounting of the run
+ * \param[in] step                  The current step
+ * \param[in] ir                    The input record
+ * \param[in] ddForceImbalanceLoss  The DD force imbalance loss, or -1 without DD
+ */
+PerformanceMetrics computePerformanceMetrics(gmx_walltime_accounting* walltime_accounting,
+                                             int64_t                  step,
+                                             const t_inputrec&        ir,
+                                             float                    ddForceImbalanceLoss);
+
+//! Returns the metrics formatted as a JSON object
+std::string formatPerformanceMetricsAsJson(const PerformanceMetrics& metrics);
+
+/*! \libinternal
+ * \brief Writes performance metrics to a file at regular wall-time intervals
+ *
+ * Each write replaces the file through a rename, so readers never
+ * see a partially written file. Checking whether a write is due only
+ * reads the clock and involves no communication.
+ */
+class PerformanceMetricsWriter
+{
+public:
+    /*! \brief Constructor
+     *
+     * \param[in] fileName       The name of the file to write the metrics to
+     * \param[in] writeInterval  The minimum wall time in seconds between writes
+     */
+    PerformanceMetricsWriter(const std::string& fileName, double writeInterval);
+
+    //! Returns whether at least the write interval has passed since the last write
+    bool isDue() const;
+
+    //! Writes \p metrics to the file, replacing its previous contents
+    void write(const PerformanceMetrics& metrics);
+
+private:
+    //! The name of the metrics file
+    std::string fileName_;
+    //! The minimum wall time in seconds between writes
+    double writeInterval_;
+    //! The wall time at which the next write is due
+    double nextWriteTime_;
+};
+
+/*! \brief Returns a metrics writer when the GMX_PERFORMANCE_METRICS environment variable is set
+ *
+ * The variable gives the file name. The interval between writes in seconds
+ * is taken from GMX_PERFORMANCE_METRICS_INTERVAL, with a default of 60.
+ * Returns nullptr when the variable is not set.
+ *
+ * \param[in] simulationIndex  When >= 0, the index is appended to the file name
+ */
+std::unique_ptr<PerformanceMetricsWriter> makePerformanceMetricsWriterFromEnvironment(int simulationIndex);
+
+} // namespace gmx
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Tests for the performance metrics export.
+ *
+ * \ingroup module_mdrunutility
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdrunutility/performancemetrics.h"
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/textreader.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(PerformanceMetricsTest, FormatsMetricsWithoutDomainDecomposition)
+{
+    PerformanceMetrics metrics;
+    metrics.step              = 1000;
+    metrics.wallTime          = 12.5;
+    metrics.nanosecondsPerDay = 345.25;
+
+    EXPECT_EQ("{\n  \"step\": 1000,\n  \"wall_time_s\": 12.500,\n  \"performance_ns_per_day\": "
+              "345.250\n}\n",
+              formatPerformanceMetricsAsJson(metrics));
+}
+
+TEST(PerformanceMetricsTest, FormatsMetricsWithDomainDecomposition)
+{
+    PerformanceMetrics metrics;
+    metrics.step                 = 20;
+    metrics.wallTime             = 1;
+    metrics.nanosecondsPerDay    = 2;
+    metrics.ddForceImbalanceLoss = 0.125;
+
+    EXPECT_EQ("{\n  \"step\": 20,\n  \"wall_time_s\": 1.000,\n  \"performance_ns_per_day\": "
+              "2.000,\n  \"dd_force_imbalance_loss\": 0.1250\n}\n",
+              formatPerformanceMetricsAsJson(metrics));
+}
+
+TEST(PerformanceMetricsTest, WriterReplacesFileContents)
+{
+    TestFileManager    fileManager;
+    const std::string  fileName = fileManager.getTemporaryFilePath("metrics.json");
+    PerformanceMetrics metrics;
+
+    PerformanceMetricsWriter writer(fileName, 1000);
+    EXPECT_FALSE(writer.isDue());
+
+    metrics.step = 10;
+    writer.write(metrics);
+    metrics.step = 20;
+    writer.write(metrics);
+
+    EXPECT_EQ(formatPerformanceMetricsAsJson(metrics), TextReader::readFileToString(fileName));
+}
+
+TEST(PerformanceMetricsTest, WriterIsDueAfterZeroInterval)
+{
+    TestFileManager          fileManager;
+    PerformanceMetricsWriter writer(fileManager.getTemporaryFilePath("metrics.json"), 0);
+
+    EXPECT_TRUE(writer.isDue());
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -159,6 +159,44 @@ TEST_F(ThreadAffinityTest, HandlesPinningFailureWithSingleThread)
 
 // TODO: If it wouldn't result in a multitude of #if's, it would be nice
 // to somehow indicate in a no-OpenMP build that some tests are missing.
+TEST(CacheAlignedThreadOffsetTest, KeepsAlignedPlacement)
+{
+    // 4 ranks with 2 and 4 threads on 8 domains of 4 cores
+    for (int rank = 0; rank < 4; rank++)
+    {
+        EXPECT_EQ(rank * 2, cacheAlignedIntraNodeThreadOffset(rank * 2, 2, 8, 32, 4));
+        EXPECT_EQ(rank * 4, cacheAlignedIntraNodeThreadOffset(rank * 4, 4, 16, 32, 4));
+    }
+}
+
+TEST(CacheAlignedThreadOffsetTest, PlacesRanksWithinDomains)
+{
+    // 4 ranks with 3 threads on 8 domains of 4 cores
+    EXPECT_EQ(0, cacheAlignedIntraNodeThreadOffset(0, 3, 12, 32, 4));
+    EXPECT_EQ(4, cacheAlignedIntraNodeThreadOffset(3, 3, 12, 32, 4));
+    EXPECT_EQ(8, cacheAlignedIntraNodeThreadOffset(6, 3, 12, 32, 4));
+    EXPECT_EQ(12, cacheAlignedIntraNodeThreadOffset(9, 3, 12, 32, 4));
+    // 4 ranks with 3 threads on 4 domains of 8 cores, two ranks per domain
+    EXPECT_EQ(3, cacheAlignedIntraNodeThreadOffset(3, 3, 12, 32, 8));
+    EXPECT_EQ(8, cacheAlignedIntraNodeThreadOffset(6, 3, 12, 32, 8));
+    EXPECT_EQ(11, cacheAlignedIntraNodeThreadOffset(9, 3, 12, 32, 8));
+}
+
+TEST(CacheAlignedThreadOffsetTest, StartsLargeRanksAtDomains)
+{
+    // 2 ranks with 6 threads on 4 domains of 4 cores
+    EXPECT_EQ(0, cacheAlignedIntraNodeThreadOffset(0, 6, 12, 16, 4));
+    EXPECT_EQ(8, cacheAlignedIntraNodeThreadOffset(6, 6, 12, 16, 4));
+}
+
+TEST(CacheAlignedThreadOffsetTest, KeepsPlacementWhenAlignmentDoesNotFit)
+{
+    // 5 ranks with 3 threads on 4 domains of 4 cores
+    EXPECT_EQ(3, cacheAlignedIntraNodeThreadOffset(3, 3, 15, 16, 4));
+    // 3 ranks with 6 threads on 5 domains of 4 cores
+    EXPECT_EQ(6, cacheAlignedIntraNodeThreadOffset(6, 6, 18, 20, 4));
+}
+
 #if GMX_OPENMP
 TEST_F(ThreadAffinityTest, PinsMultipleThreadsWithAuto)
 {
@@ -152,11 +152,13 @@ public:
         }
         gmx::PhysicalNodeCommunicator comm(MPI_COMM_WORLD, physicalNodeId_);
         int                           numThreadsOnThisNode, indexWithinNodeOfFirstThreadOnThisRank;
+        bool                          allRanksOnThisNodeHaveEqualNumThreads;
         analyzeThreadsOnThisNode(comm, numThreadsOnThisRank, &numThreadsOnThisNode,
-                                 &indexWithinNodeOfFirstThreadOnThisRank);
+                                 &indexWithinNodeOfFirstThreadOnThisRank,
+                                 &allRanksOnThisNodeHaveEqualNumThreads);
         gmx_set_thread_affinity(logHelper_.logger(), cr_, &hwOpt_, *hwTop_, numThreadsOnThisRank,
                                 numThreadsOnThisNode, indexWithinNodeOfFirstThreadOnThisRank,
-                                &affinityAccess_);
+                                allRanksOnThisNodeHaveEqualNumThreads, &affinityAccess_);
     }
 
 private:
@@ -369,10 +369,12 @@ static bool set_affinity(const t_commrec*            cr,
 void analyzeThreadsOnThisNode(const gmx::PhysicalNodeCommunicator& physicalNodeComm,
                               int                                  numThreadsOnThisRank,
                               int*                                 numThreadsOnThisNode,
-                              int*                                 intraNodeThreadOffset)
+                              int*                                 intraNodeThreadOffset,
+                              bool* allRanksOnThisNodeHaveEqualNumThreads)
 {
-    *intraNodeThreadOffset = 0;
-    *numThreadsOnThisNode  = numThreadsOnThisRank;
+    *intraNodeThreadOffset                 = 0;
+    *numThreadsOnThisNode                  = numThreadsOnThisRank;
+    *allRanksOnThisNodeHaveEqualNumThreads = true;
 #if GMX_MPI
     if (physicalNodeComm.size_ > 1)
     {
@@ -384,12 +386,76 @@ void analyzeThreadsOnThisNode(const gmx::PhysicalNodeCommunicator& physicalNodeC
         /* Get the total number of threads on this physical node */
         MPI_Allreduce(&numThreadsOnThisRank, numThreadsOnThisNode, 1, MPI_INT, MPI_SUM,
                       physicalNodeComm.comm_);
+        int minMaxNumThreads[2] = { -numThreadsOnThisRank, numThreadsOnThisRank };
+        MPI_Allreduce(MPI_IN_PLACE, minMaxNumThreads, 2, MPI_INT, MPI_MAX, physicalNodeComm.comm_);
+        *allRanksOnThisNodeHaveEqualNumThreads = (-minMaxNumThreads[0] == minMaxNumThreads[1]);
     }
 #else
     GMX_UNUSED_VALUE(physicalNodeComm);
 #endif
 }
 
+int cacheAlignedIntraNodeThreadOffset(int intraNodeThreadOffset,
+                                      int numThreadsOnThisRank,
+                                      int numThreadsOnThisNode,
+                                      int numSlots,
+                                      int numSlotsPerCacheDomain)
+{
+    if (numThreadsOnThisRank <= 0 || numSlotsPerCacheDomain <= 1
+        || numThreadsOnThisNode % numThreadsOnThisRank != 0)
+    {
+        return intraNodeThreadOffset;
+    }
+
+    const int numRanks   = numThreadsOnThisNode / numThreadsOnThisRank;
+    const int rankIndex  = intraNodeThreadOffset / numThreadsOnThisRank;
+    const int numDomains = numSlots / numSlotsPerCacheDomain;
+
+    if (numThreadsOnThisRank <= numSlotsPerCacheDomain)
+    {
+        /* Place whole ranks within domains */
+        const int numRanksPerDomain = numSlotsPerCacheDomain / numThreadsOnThisRank;
+        const int numDomainsNeeded  = (numRanks + numRanksPerDomain - 1) / numRanksPerDomain;
+        if (numDomainsNeeded <= numDomains)
+        {
+            return (rankIndex / numRanksPerDomain) * numSlotsPerCacheDomain
+                   + (rankIndex % numRanksPerDomain) * numThreadsOnThisRank;
+        }
+    }
+    else
+    {
+        /* Start each rank at the start of a domain */
+        const int numDomainsPerRank =
+                (numThreadsOnThisRank + numSlotsPerCacheDomain - 1) / numSlotsPerCacheDomain;
+        if (numRanks * numDomainsPerRank <= numDomains)
+        {
+            return rankIndex * numDomainsPerRank * numSlotsPerCacheDomain;
+        }
+    }
+
+    return intraNodeThreadOffset;
+}
+
+/*! \brief Returns the number of logical processors sharing the last-level cache
+ *
+ * Returns 0 when this is unknown or when the last-level cache is shared
+ * by all logical processors.
+ */
+static int numLogicalProcessorsSharingLastLevelCache(const gmx::HardwareTopology& hwTop)
+{
+    if (hwTop.supportLevel() < gmx::HardwareTopology::SupportLevel::Full
+        || hwTop.machine().caches.empty())
+    {
+        return 0;
+    }
+    const int numShared = hwTop.machine().caches.back().shared;
+    if (numShared <= 0 || numShared >= hwTop.machine().logicalProcessorCount)
+    {
+        return 0;
+    }
+    return numShared;
+}
+
 /* Set CPU affinity. Can be important for performance.
    On some systems (e.g. Cray) CPU Affinity is set by default.
    But default assigning doesn't work (well) with only some ranks
@@ -406,6 +472,7 @@ void gmx_set_thread_affinity(const gmx::MDLogger&         mdlog,
                              int                          numThreadsOnThisRank,
                              int                          numThreadsOnThisNode,
                              int                          intraNodeThreadOffset,
+                             bool                         allRanksOnThisNodeHaveEqualNumThreads,
                              gmx::IThreadAffinityAccess*  affinityAccess)
 {
     int* localityOrder = nullptr;
@@ -452,6 +519,42 @@ void gmx_set_thread_affinity(const gmx::MDLogger&         mdlog,
             &core_pinning_stride, &localityOrder, &issuedWarning);
     const gmx::sfree_guard localityOrderGuard(localityOrder);
 
+    /* With an automatically chosen stride, avoid ranks straddling last-level
+     * cache domains when there are more cores than threads. The domains are
+     * consecutive in the locality order, so this requires an aligned offset.
+     */
+    const int numSharingCache = numLogicalProcessorsSharingLastLevelCache(hwTop);
+    if (validLayout && hw_opt->core_pinning_stride == 0 && localityOrder != nullptr
+        && allRanksOnThisNodeHaveEqualNumThreads && numSharingCache > 0
+        && numSharingCache % core_pinning_stride == 0 && offset % numSharingCache == 0)
+    {
+        const int numSlots = (hwTop.machine().logicalProcessorCount - offset) / core_pinning_stride;
+        const int numSlotsPerCacheDomain = numSharingCache / core_pinning_stride;
+
+        /* Check whether this changes the placement of any rank on this node */
+        bool changesPlacement = false;
+        for (int rankOffset = 0; rankOffset < numThreadsOnThisNode;
+             rankOffset += numThreadsOnThisRank)
+        {
+            changesPlacement = changesPlacement
+                               || cacheAlignedIntraNodeThreadOffset(
+                                          rankOffset, numThreadsOnThisRank, numThreadsOnThisNode,
+                                          numSlots, numSlotsPerCacheDomain)
+                                          != rankOffset;
+        }
+        if (changesPlacement)
+        {
+            GMX_LOG(mdlog.info)
+                    .appendTextFormatted(
+                            "Aligning the threads of ranks to last-level cache domains of %d "
+                            "logical cores",
+                            numSharingCache);
+            intraNodeThreadOffset = cacheAlignedIntraNodeThreadOffset(
+                    intraNodeThreadOffset, numThreadsOnThisRank, numThreadsOnThisNode, numSlots,
+                    numSlotsPerCacheDomain);
+        }
+    }
+
     bool allAffinitiesSet;
     if (validLayout)
     {
@@ -75,7 +75,30 @@ protected:
 void analyzeThreadsOnThisNode(const gmx::PhysicalNodeCommunicator& physicalNodeComm,
                               int                                  numThreadsOnThisRank,
                               int*                                 numThreadsOnThisNode,
-                              int*                                 intraNodeThreadOffset);
+                              int*                                 intraNodeThreadOffset,
+                              bool* allRanksOnThisNodeHaveEqualNumThreads);
+
+/*! \brief Returns the first placement slot of this rank, aligned to cache domains when possible
+ *
+ * Threads are placed on consecutive slots, e.g. physical cores, which are
+ * grouped in domains of \p numSlotsPerCacheDomain slots sharing a last-level
+ * cache. With equal thread counts on all ranks, ranks are placed such that
+ * no rank straddles a domain boundary unnecessarily, which avoids ranks
+ * sharing a cache and cache-line transfers between domains within a rank.
+ * When this does not fit in \p numSlots slots, or the consecutive placement
+ * is already aligned, \p intraNodeThreadOffset is returned.
+ *
+ * \param[in] intraNodeThreadOffset   Consecutive placement of the first thread of this rank
+ * \param[in] numThreadsOnThisRank    The number of threads on each rank
+ * \param[in] numThreadsOnThisNode    The number of threads on all ranks of this node
+ * \param[in] numSlots                The number of slots available for placement
+ * \param[in] numSlotsPerCacheDomain  The number of slots sharing a last-level cache
+ */
+int cacheAlignedIntraNodeThreadOffset(int intraNodeThreadOffset,
+                                      int numThreadsOnThisRank,
+                                      int numThreadsOnThisNode,
+                                      int numSlots,
+                                      int numSlotsPerCacheDomain);
 
 /*! \brief
  * Sets the thread affinity using the requested setting stored in hw_opt.
@@ -90,6 +113,8 @@ void analyzeThreadsOnThisNode(const gmx::PhysicalNodeCommunicator& physicalNodeC
  * \param[in]  numThreadsOnThisNode   The number of threads on all ranks of this node.
  * \param[in]  intraNodeThreadOffset  The index of the first hardware thread of this rank
  *   in the set of all the threads of all MPI ranks within a node (ordered by MPI rank ID).
+ * \param[in]  allRanksOnThisNodeHaveEqualNumThreads  Whether all ranks on this node have
+ *   \p numThreadsOnThisRank threads, which allows aligning ranks to cache domains.
  * \param[in]  affinityAccess         Interface for low-level access to affinity details.
  */
 void gmx_set_thread_affinity(const gmx::MDLogger&         mdlog,
@@ -99,6 +124,7 @@ void gmx_set_thread_affinity(const gmx::MDLogger&         mdlog,
                              int                          numThreadsOnThisRank,
                              int                          numThreadsOnThisNode,
                              int                          intraNodeThreadOffset,
+                             bool                         allRanksOnThisNodeHaveEqualNumThreads,
                              gmx::IThreadAffinityAccess*  affinityAccess);
 
 /*! \brief
@@ -42,7 +42,9 @@
 #ifndef GMX_MODULARSIMULATOR_CHECKPOINTDATA_H
 #define GMX_MODULARSIMULATOR_CHECKPOINTDATA_H
 
+#include <algorithm>
 #include <optional>
+#include <vector>
 
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/arrayref.h"
@@ -107,6 +109,20 @@ struct IsSerializableType
                               || std::is_same<T, float>::value || std::is_same<T, double>::value;
 };
 
+/*! \internal
+ * \ingroup module_modularsimulator
+ * \brief Struct allowing to check if a type can be stored as a contiguous array
+ *
+ * Arrays of these types are written directly from the referenced data,
+ * without making a copy per element in the key-value tree.
+ */
+template<typename T>
+struct IsContiguousArraySerializableType
+{
+    static bool const value = std::is_same<T, int>::value || std::is_same<T, int64_t>::value
+                              || std::is_same<T, float>::value || std::is_same<T, double>::value;
+};
+
 /*! \internal
  * \ingroup module_modularsimulator
  * \brief Struct allowing to check if enum has a serializable underlying type
@@ -178,6 +194,11 @@ public:
      * int64_t, float, double, and gmx::RVec. Type compatibility is checked
      * at compile time.
      *
+     * When writing arrays of int, int64_t, float, double or RVec, the data
+     * is not copied, but referenced and written directly when the checkpoint
+     * is serialized. The referenced data therefore needs to stay valid and
+     * unchanged until the checkpoint has been written.
+     *
      * \tparam operation  Whether we are reading or writing
      * \tparam T          The type of values stored in the ArrayRef
      * \param key         The key to [read|write] the ArrayRef [from|to]
@@ -431,6 +452,18 @@ inline std::enable_if_t<IsSerializableType<T>::value, void>
 ReadCheckpointData::arrayRef(const std::string& key, ArrayRef<T> values) const
 {
     GMX_RELEASE_ASSERT(inputTree_, "No input checkpoint data available.");
+    if constexpr (IsContiguousArraySerializableType<T>::value)
+    {
+        if ((*inputTree_)[key].isType<std::vector<T>>())
+        {
+            const auto& inputValues = (*inputTree_)[key].cast<std::vector<T>>();
+            GMX_RELEASE_ASSERT(values.size() >= inputValues.size(),
+                               "Read vector does not fit in passed ArrayRef.");
+            std::copy(inputValues.begin(), inputValues.end(), values.begin());
+            return;
+        }
+    }
+    // Arrays of other types, and arrays from older checkpoint files, are stored per element
     GMX_RELEASE_ASSERT(values.size() >= (*inputTree_)[key].asArray().values().size(),
                        "Read vector does not fit in passed ArrayRef.");
     auto outputIt  = values.begin();
@@ -448,15 +481,31 @@ inline std::enable_if_t<IsSerializableType<T>::value, void>
 WriteCheckpointData::arrayRef(const std::string& key, ArrayRef<const T> values)
 {
     GMX_RELEASE_ASSERT(outputTreeBuilder_, "No output checkpoint data available.");
-    auto builder = outputTreeBuilder_->addUniformArray<T>(key);
-    for (const auto& value : values)
+    if constexpr (IsContiguousArraySerializableType<T>::value)
+    {
+        outputTreeBuilder_->addArrayRef<T>(key, values);
+    }
+    else
     {
-        builder.addValue(value);
+        auto builder = outputTreeBuilder_->addUniformArray<T>(key);
+        for (const auto& value : values)
+        {
+            builder.addValue(value);
+        }
     }
 }
 
 inline void ReadCheckpointData::arrayRef(const std::string& key, ArrayRef<RVec> values) const
 {
+    if ((*inputTree_)[key].isType<std::vector<real>>())
+    {
+        const auto& inputValues = (*inputTree_)[key].cast<std::vector<real>>();
+        GMX_RELEASE_ASSERT(values.size() * DIM >= inputValues.size(),
+                           "Read vector does not fit in passed ArrayRef.");
+        std::copy(inputValues.begin(), inputValues.end(), values.data()[0].as_vec());
+        return;
+    }
+    // Older checkpoint files store an object with an array per RVec
     GMX_RELEASE_ASSERT(values.size() >= (*inputTree_)[key].asArray().values().size(),
                        "Read vector does not fit in passed ArrayRef.");
     auto outputIt  = values.begin();
@@ -473,12 +522,10 @@ inline void ReadCheckpointData::arrayRef(const std::string& key, ArrayRef<RVec>
 
 inline void WriteCheckpointData::arrayRef(const std::string& key, ArrayRef<const RVec> values)
 {
-    auto builder = outputTreeBuilder_->addObjectArray(key);
-    for (const auto& value : values)
-    {
-        auto subbuilder = builder.addObject();
-        subbuilder.addUniformArray("RVec", { value[XX], value[YY], value[ZZ] });
-    }
+    // Store the RVecs as a contiguous array of reals
+    const real* data = values.empty() ? nullptr : values.data()[0].as_vec();
+    outputTreeBuilder_->addArrayRef<real>(key,
+                                          ArrayRef<const real>(data, data + values.size() * DIM));
 }
 
 inline void ReadCheckpointData::tensor(const std::string& key, ::tensor values) const
@@ -46,6 +46,7 @@
 
 struct mpi_in_place_buf_t;
 struct gmx_domdec_t;
+struct NodeSharedSumBuffer;
 
 #define DUTY_PP (1U << 0U)
 #define DUTY_PME (1U << 1U)
@@ -70,7 +71,8 @@ typedef struct
     MPI_Comm comm_intra;
     int      rank_intra;
     MPI_Comm comm_inter;
-
+    /* Buffers in node-shared memory for intra-node sums, nullptr when not used */
+    NodeSharedSumBuffer* sharedSumBuffer;
 } gmx_nodecomm_t;
 
 struct t_commrec
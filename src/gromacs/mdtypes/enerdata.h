@@ -159,9 +159,13 @@ public:
      * Note: should only be called after the object has been finalized by a call to
      * accumulateLinearPotentialComponents() (is asserted).
      *
+     * The lists refer to storage of this object, which is reused by the next call,
+     * so that no memory is allocated during the run.
+     *
      * \param[in] cr  Communication record, used to reduce the terms when !=nullptr
      */
-    std::pair<std::vector<double>, std::vector<double>> getTerms(const t_commrec* cr) const;
+    std::pair<gmx::ArrayRef<const double>, gmx::ArrayRef<const double>>
+    getTerms(const t_commrec* cr);
 
     //! Sets all terms to 0
     void zeroAllTerms();
@@ -179,6 +183,8 @@ private:
     std::vector<double> energies_;
     //! Storage for foreign lambda dH/dlambda
     std::vector<double> dhdl_;
+    //! Storage for the deltaH and dH/dlambda lists returned by getTerms()
+    std::vector<double> terms_;
     //! Tells whether all potential energy contributions have been accumulated
     bool finalizedPotentialContributions_ = false;
 };
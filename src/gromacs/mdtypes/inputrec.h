@@ -346,6 +346,10 @@ struct t_inputrec // NOLINT (clang-analyzer-optin.performance.Padding)
     int nstenergy;
     //! Number of steps after which compressed trj (.xtc,.tng) is output
     int nstxout_compressed;
+    //! Number of steps after which V is output to the compressed trj (.tng only)
+    int nstvout_compressed;
+    //! Number of steps after which F is output to the compressed trj (.tng only)
+    int nstfout_compressed;
     //! Initial time (ps)
     double init_t;
     //! Time step (ps)
@@ -56,7 +56,7 @@ const char* yesno_names[BOOL_NR + 1] = { "no", "yes", nullptr };
 
 const char* ei_names[eiNR + 1] = { "md",    "steep",      "cg",    "bd",   "sd2 - removed",
                                    "nm",    "l-bfgs",     "tpi",   "tpic", "sd",
-                                   "md-vv", "md-vv-avek", "mimic", nullptr };
+                                   "md-vv", "md-vv-avek", "mimic", "fire", nullptr };
 
 const char* ecutscheme_names[ecutsNR + 1] = { "Verlet", "Group", nullptr };
 
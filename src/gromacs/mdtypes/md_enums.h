@@ -330,6 +330,7 @@ enum
     eiVV,
     eiVVAK,
     eiMimic,
+    eiFIRE,
     eiNR
 };
 //! Name of the integrator algorithm
@@ -350,7 +351,8 @@ extern const char* ei_names[eiNR + 1];
 //! Do we use any type of dynamics
 #define EI_DYNAMICS(e) (EI_MD(e) || EI_RANDOM(e))
 //! Or do we use minimization
-#define EI_ENERGY_MINIMIZATION(e) ((e) == eiSteep || (e) == eiCG || (e) == eiLBFGS)
+#define EI_ENERGY_MINIMIZATION(e) \
+    ((e) == eiSteep || (e) == eiCG || (e) == eiLBFGS || (e) == eiFIRE)
 //! Do we apply test particle insertion
 #define EI_TPI(e) ((e) == eiTPI || (e) == eiTPIC)
 //! Do we deal with particle velocities
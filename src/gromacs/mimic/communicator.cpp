@@ -39,6 +39,7 @@
 #include "config.h"
 
 #include <unordered_set>
+#include <vector>
 
 #include "gromacs/math/units.h"
 #include "gromacs/utility/fatalerror.h"
@@ -98,6 +99,16 @@ static void MCL_destroy()
 }
 #endif
 
+namespace
+{
+/*! \brief Buffer for the coordinates and forces converted to MiMiC units
+ *
+ * Kept between calls, so the exchange with MiMiC every step
+ * does not need to allocate memory.
+ */
+std::vector<double> s_conversionBuffer;
+} // namespace
+
 void gmx::MimicCommunicator::init()
 {
     char path[GMX_PATH_MAX];
@@ -105,7 +116,8 @@ void gmx::MimicCommunicator::init()
     MCL_init_client(path);
 }
 
-void gmx::MimicCommunicator::sendInitData(gmx_mtop_t* mtop, PaddedHostVector<gmx::RVec> coords)
+void gmx::MimicCommunicator::sendInitData(gmx_mtop_t*                        mtop,
+                                          const PaddedHostVector<gmx::RVec>& coords)
 {
     MCL_send(&mtop->natoms, 1, TYPE_INT, 0);
     MCL_send(&mtop->atomtypes.nr, 1, TYPE_INT, 0);
@@ -232,7 +244,7 @@ void gmx::MimicCommunicator::sendInitData(gmx_mtop_t* mtop, PaddedHostVector<gmx
     MCL_send(&*elements.begin(), mtop->atomtypes.nr, TYPE_INT, 0);
 
     std::vector<double> convertedCoords;
-    for (auto& coord : coords)
+    for (const auto& coord : coords)
     {
         convertedCoords.push_back(static_cast<double>(coord[0]) / BOHR2NM);
         convertedCoords.push_back(static_cast<double>(coord[1]) / BOHR2NM);
@@ -252,8 +264,9 @@ int64_t gmx::MimicCommunicator::getStepNumber()
 
 void gmx::MimicCommunicator::getCoords(PaddedHostVector<RVec>* x, const int natoms)
 {
-    std::vector<double> coords(natoms * 3);
-    MCL_receive(&*coords.begin(), 3 * natoms, TYPE_DOUBLE, 0);
+    std::vector<double>& coords = s_conversionBuffer;
+    coords.resize(natoms * 3);
+    MCL_receive(coords.data(), 3 * natoms, TYPE_DOUBLE, 0);
     for (int j = 0; j < natoms; ++j)
     {
         (*x)[j][0] = static_cast<real>(coords[j * 3] * BOHR2NM);
@@ -270,18 +283,21 @@ void gmx::MimicCommunicator::sendEnergies(real energy)
 
 void gmx::MimicCommunicator::sendForces(gmx::ArrayRef<gmx::RVec> forces, int natoms)
 {
-    std::vector<double> convertedForce;
+    std::vector<double>& convertedForce = s_conversionBuffer;
+    convertedForce.resize(natoms * 3);
     for (int j = 0; j < natoms; ++j)
     {
-        convertedForce.push_back(static_cast<real>(forces[j][0]) / HARTREE_BOHR2MD);
-        convertedForce.push_back(static_cast<real>(forces[j][1]) / HARTREE_BOHR2MD);
-        convertedForce.push_back(static_cast<real>(forces[j][2]) / HARTREE_BOHR2MD);
+        convertedForce[j * 3]     = static_cast<real>(forces[j][0]) / HARTREE_BOHR2MD;
+        convertedForce[j * 3 + 1] = static_cast<real>(forces[j][1]) / HARTREE_BOHR2MD;
+        convertedForce[j * 3 + 2] = static_cast<real>(forces[j][2]) / HARTREE_BOHR2MD;
     }
-    MCL_send(&*convertedForce.begin(), convertedForce.size(), TYPE_DOUBLE, 0);
+    MCL_send(convertedForce.data(), convertedForce.size(), TYPE_DOUBLE, 0);
 }
 
 void gmx::MimicCommunicator::finalize()
 {
+    s_conversionBuffer.clear();
+    s_conversionBuffer.shrink_to_fit();
     MCL_destroy();
 }
 
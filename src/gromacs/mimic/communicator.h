@@ -73,7 +73,7 @@ public:
      * @param mtop global topology data
      * @param coords coordinates of all atoms
      */
-    static void sendInitData(gmx_mtop_t* mtop, PaddedHostVector<gmx::RVec> coords);
+    static void sendInitData(gmx_mtop_t* mtop, const PaddedHostVector<gmx::RVec>& coords);
 
     /*! \brief
      * Gets the number of MD steps to perform from MiMiC
@@ -50,12 +50,15 @@
 #include "gromacs/mdlib/md_support.h"
 #include "gromacs/mdlib/mdatoms.h"
 #include "gromacs/mdlib/stat.h"
+#include "gromacs/mdlib/tgroup.h"
 #include "gromacs/mdlib/update.h"
 #include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/enerdata.h"
 #include "gromacs/mdtypes/group.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/timing/wallcycle.h"
 #include "gromacs/topology/topology.h"
 
 #include "freeenergyperturbationdata.h"
@@ -88,6 +91,7 @@ ComputeGlobalsElement<algorithm>::ComputeGlobalsElement(StatePropagatorData* sta
     nstglobalcomm_(nstglobalcomm),
     lastStep_(inputrec->nsteps + inputrec->init_step),
     initStep_(inputrec->init_step),
+    canDeferKineticEnergyReduction_(algorithm == ComputeGlobalsAlgorithm::LeapFrog && PAR(cr)),
     nullSignaller_(std::make_unique<SimulationSignaller>(nullptr, nullptr, nullptr, false, false)),
     totalNumberOfBondedInteractions_(0),
     shouldCheckNumberOfBondedInteractions_(false),
@@ -205,9 +209,25 @@ void ComputeGlobalsElement<algorithm>::scheduleTask(Step step,
         auto signaller = std::make_shared<SimulationSignaller>(signals_, cr_, nullptr,
                                                                doInterSimSignal, doIntraSimSignal);
 
-        registerRunFunction([this, step, flags, signaller = std::move(signaller)]() {
-            compute(step, flags, signaller.get(), true);
-        });
+        // When the reduction is only needed for the kinetic energy, which
+        // is used after the force calculation of the next step at the earliest,
+        // we only start reducing the kinetic energy here. The signals are then
+        // communicated at the next full reduction.
+        const bool canDeferReduction = canDeferKineticEnergyReduction_ && needGlobalReduction
+                                       && !doEnergy && !needComReduction
+                                       && step != virialReductionStep_ && step != lastStep_;
+
+        registerRunFunction(
+                [this, step, flags, signaller = std::move(signaller), canDeferReduction]() {
+                    if (canDeferReduction && !shouldCheckNumberOfBondedInteractions_)
+                    {
+                        computeAndStartKineticEnergyReduction(step, flags);
+                    }
+                    else
+                    {
+                        compute(step, flags, signaller.get(), true);
+                    }
+                });
     }
     else if (algorithm == ComputeGlobalsAlgorithm::VelocityVerlet)
     {
@@ -297,6 +317,43 @@ void ComputeGlobalsElement<algorithm>::compute(gmx::Step            step,
     }
 }
 
+template<ComputeGlobalsAlgorithm algorithm>
+void ComputeGlobalsElement<algorithm>::computeAndStartKineticEnergyReduction(Step         step,
+                                                                             unsigned int flags)
+{
+    GMX_ASSERT(algorithm == ComputeGlobalsAlgorithm::LeapFrog,
+               "The kinetic energy reduction can only be deferred with leap-frog");
+
+    // compute_globals signals that ekinh_old still needs summing, but we sum it here
+    const bool sumEkinhOld = *energyData_->needToSumEkinhOld();
+    compute(step, flags & ~CGLO_GSTAT, nullSignaller_.get(), true);
+    *energyData_->needToSumEkinhOld() = false;
+
+    wallcycle_start(wcycle_, ewcMoveE);
+    global_stat_start_ekinh(gstat_, cr_, inputrec_, energyData_->ekindata(), sumEkinhOld);
+    wallcycle_stop(wcycle_, ewcMoveE);
+
+    energyData_->setKineticEnergyReductionCompletion(
+            [this]() { completeKineticEnergyReduction(); });
+}
+
+template<ComputeGlobalsAlgorithm algorithm>
+void ComputeGlobalsElement<algorithm>::completeKineticEnergyReduction()
+{
+    auto* ekind = energyData_->ekindata();
+    auto* enerd = energyData_->enerdata();
+
+    wallcycle_start(wcycle_, ewcMoveE);
+    global_stat_finish_ekinh(gstat_, inputrec_, ekind);
+    wallcycle_stop(wcycle_, ewcMoveE);
+
+    // As in compute_globals, with the half-step average kinetic energy of leap-frog
+    real dvdlEkin             = 0;
+    enerd->term[F_TEMP]       = sum_ekin(&(inputrec_->opts), ekind, &dvdlEkin, false, false);
+    enerd->dvdl_lin[efptMASS] = static_cast<double>(dvdlEkin);
+    enerd->term[F_EKIN]       = trace(ekind->ekin);
+}
+
 template<ComputeGlobalsAlgorithm algorithm>
 CheckBondedInteractionsCallback ComputeGlobalsElement<algorithm>::getCheckNumberOfBondedInteractionsCallback()
 {
@@ -94,6 +94,13 @@ typedef std::function<void()> CheckBondedInteractionsCallback;
  * constraint virial after the second propagation of velocities (+dt/2) and of
  * the positions (+dt).
  *
+ * With leap-frog, steps at which the global reduction is only needed for the
+ * kinetic energy, i.e. for temperature coupling at the next step, start a
+ * non-blocking reduction of the kinetic energy only. It is completed on the
+ * first access to the kinetic energy data, which allows the reduction to
+ * overlap with the force calculation of the next step. Intra-simulation
+ * signals are then communicated at the next full reduction.
+ *
  * \tparam algorithm  The global reduction scheme
  */
 template<ComputeGlobalsAlgorithm algorithm>
@@ -172,6 +179,10 @@ private:
     std::optional<SignallerCallback> registerTrajectorySignallerCallback(TrajectoryEvent event) override;
     //! The compute_globals call
     void compute(Step step, unsigned int flags, SimulationSignaller* signaller, bool useLastBox, bool isInit = false);
+    //! Local compute_globals call followed by starting the kinetic energy reduction (only LF)
+    void computeAndStartKineticEnergyReduction(Step step, unsigned int flags);
+    //! Completes the kinetic energy reduction and computes the temperatures (only LF)
+    void completeKineticEnergyReduction();
 
     //! Next step at which energy needs to be reduced
     Step energyReductionStep_;
@@ -191,6 +202,8 @@ private:
     const Step lastStep_;
     //! The initial step (only used for VV)
     const Step initStep_;
+    //! Whether the kinetic energy reduction can overlap with the next step (only used for LF)
+    const bool canDeferKineticEnergyReduction_;
     //! A dummy signaller (used for setup and VV)
     std::unique_ptr<SimulationSignaller> nullSignaller_;
 
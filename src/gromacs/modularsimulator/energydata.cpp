@@ -150,6 +150,7 @@ void EnergyData::Element::scheduleTask(Step step, Time time, const RegisterRunFu
 
 void EnergyData::teardown()
 {
+    completeKineticEnergyReduction();
     if (inputrec_->nstcalcenergy > 0 && isMasterRank_)
     {
         energyOutput_->printAverages(fplog_, groups_);
@@ -232,6 +233,7 @@ std::optional<SignallerCallback> EnergyData::Element::registerEnergyCallback(Ene
 
 void EnergyData::doStep(Time time, bool isEnergyCalculationStep, bool isFreeEnergyCalculationStep)
 {
+    completeKineticEnergyReduction();
     enerd_->term[F_ETOT] = enerd_->term[F_EPOT] + enerd_->term[F_EKIN];
     if (freeEnergyPerturbationData_)
     {
@@ -356,9 +358,28 @@ gmx_enerdata_t* EnergyData::enerdata()
 
 gmx_ekindata_t* EnergyData::ekindata()
 {
+    completeKineticEnergyReduction();
     return ekind_;
 }
 
+void EnergyData::setKineticEnergyReductionCompletion(std::function<void()> completion)
+{
+    GMX_ASSERT(!kineticEnergyReductionCompletion_,
+               "Only one kinetic energy reduction can be pending at a time");
+    kineticEnergyReductionCompletion_ = std::move(completion);
+}
+
+void EnergyData::completeKineticEnergyReduction()
+{
+    if (kineticEnergyReductionCompletion_)
+    {
+        // Clear before calling, as the completion accesses the kinetic energy data
+        auto completion = std::move(kineticEnergyReductionCompletion_);
+        kineticEnergyReductionCompletion_ = nullptr;
+        completion();
+    }
+}
+
 bool* EnergyData::needToSumEkinhOld()
 {
     return &needToSumEkinhOld_;
@@ -398,6 +419,7 @@ void EnergyData::Element::doCheckpointData(CheckpointData<operation>* checkpoint
 void EnergyData::Element::saveCheckpointState(std::optional<WriteCheckpointData> checkpointData,
                                               const t_commrec*                   cr)
 {
+    energyData_->completeKineticEnergyReduction();
     if (MASTER(cr))
     {
         if (energyData_->needToSumEkinhOld_)
@@ -172,9 +172,18 @@ public:
 
     /*! \brief Get pointer to kinetic energy structure
      *
+     * This completes a pending kinetic energy reduction.
      */
     gmx_ekindata_t* ekindata();
 
+    /*! \brief Set a function completing a started kinetic energy reduction
+     *
+     * The function is called on the next access to the kinetic energy
+     * data, which allows the reduction to overlap with the work done
+     * until the kinetic energy is used.
+     */
+    void setKineticEnergyReductionCompletion(std::function<void()> completion);
+
     /*! \brief Get pointer to needToSumEkinhOld
      *
      */
@@ -240,6 +249,9 @@ private:
      */
     void write(gmx_mdoutf* outf, Step step, Time time, bool writeTrajectory, bool writeLog);
 
+    //! Completes a pending kinetic energy reduction, if any
+    void completeKineticEnergyReduction();
+
     /*
      * Data owned by EnergyData
      */
@@ -277,6 +289,8 @@ private:
     bool needToSumEkinhOld_;
     //! Whether we have read ekin from checkpoint
     bool hasReadEkinFromCheckpoint_;
+    //! Completes a pending kinetic energy reduction, empty when none is pending
+    std::function<void()> kineticEnergyReductionCompletion_;
 
     //! Describes how the simulation (re)starts
     const StartingBehavior startingBehavior_;
@@ -607,7 +607,8 @@ static void nbnxn_atomdata_params_init(const gmx::MDLogger&      mdlog,
     if (!simple)
     {
         // We now check for energy groups already when starting mdrun
-        GMX_RELEASE_ASSERT(n_energygroups == 1, "GPU kernels do not support energy groups");
+        GMX_RELEASE_ASSERT(n_energygroups <= c_nbnxnGpuMaxNumEnergyGroups,
+                           "GPU kernels support a limited number of energy groups");
     }
     /* Temporary storage goes as #grp^3*simd_width^2/2, so limit to 64 */
     if (params->nenergrp > 64)
@@ -696,6 +697,11 @@ void nbnxn_atomdata_init(const gmx::MDLogger&    mdlog,
     {
         nbat->bUseTreeReduce = false;
     }
+    if (nout != nth)
+    {
+        /* The tree reduction requires one output buffer per thread */
+        nbat->bUseTreeReduce = false;
+    }
     if (nbat->bUseTreeReduce)
     {
         GMX_LOG(mdlog.info).asParagraph().appendText("Using tree force reduction");
@@ -722,13 +728,14 @@ static void copy_lj_to_nbat_lj_comb(gmx::ArrayRef<const real> ljparam_type, cons
 }
 
 /* Sets the atom type in nbnxn_atomdata_t */
-static void nbnxn_atomdata_set_atomtypes(nbnxn_atomdata_t::Params* params,
-                                         const Nbnxm::GridSet&     gridSet,
-                                         ArrayRef<const int>       atomTypes)
+static void nbnxn_atomdata_set_atomtypes(nbnxn_atomdata_t::Params*   params,
+                                         const Nbnxm::GridSet&       gridSet,
+                                         ArrayRef<const Nbnxm::Grid> grids,
+                                         ArrayRef<const int>         atomTypes)
 {
     params->type.resize(gridSet.numGridAtomsTotal());
 
-    for (const Nbnxm::Grid& grid : gridSet.grids())
+    for (const Nbnxm::Grid& grid : grids)
     {
         /* Loop over all columns and copy and fill */
         for (int i = 0; i < grid.numColumns(); i++)
@@ -744,15 +751,16 @@ static void nbnxn_atomdata_set_atomtypes(nbnxn_atomdata_t::Params* params,
 }
 
 /* Sets the LJ combination rule parameters in nbnxn_atomdata_t */
-static void nbnxn_atomdata_set_ljcombparams(nbnxn_atomdata_t::Params* params,
-                                            const int                 XFormat,
-                                            const Nbnxm::GridSet&     gridSet)
+static void nbnxn_atomdata_set_ljcombparams(nbnxn_atomdata_t::Params*   params,
+                                            const int                   XFormat,
+                                            const Nbnxm::GridSet&       gridSet,
+                                            ArrayRef<const Nbnxm::Grid> grids)
 {
     params->lj_comb.resize(gridSet.numGridAtomsTotal() * 2);
 
     if (params->comb_rule != ljcrNONE)
     {
-        for (const Nbnxm::Grid& grid : gridSet.grids())
+        for (const Nbnxm::Grid& grid : grids)
         {
             /* Loop over all columns and copy and fill */
             for (int i = 0; i < grid.numColumns(); i++)
@@ -783,16 +791,17 @@ static void nbnxn_atomdata_set_ljcombparams(nbnxn_atomdata_t::Params* params,
 }
 
 /* Sets the charges in nbnxn_atomdata_t *nbat */
-static void nbnxn_atomdata_set_charges(nbnxn_atomdata_t*     nbat,
-                                       const Nbnxm::GridSet& gridSet,
-                                       ArrayRef<const real>  charges)
+static void nbnxn_atomdata_set_charges(nbnxn_atomdata_t*           nbat,
+                                       const Nbnxm::GridSet&       gridSet,
+                                       ArrayRef<const Nbnxm::Grid> grids,
+                                       ArrayRef<const real>        charges)
 {
     if (nbat->XFormat != nbatXYZQ)
     {
         nbat->paramsDeprecated().q.resize(nbat->numAtoms());
     }
 
-    for (const Nbnxm::Grid& grid : gridSet.grids())
+    for (const Nbnxm::Grid& grid : grids)
     {
         /* Loop over all columns and copy and fill */
         for (int cxy = 0; cxy < grid.numColumns(); cxy++)
@@ -843,7 +852,7 @@ static void nbnxn_atomdata_set_charges(nbnxn_atomdata_t*     nbat,
  * All perturbed interactions are calculated in the free energy kernel,
  * using the original charge and LJ data, not nbnxn_atomdata_t.
  */
-static void nbnxn_atomdata_mask_fep(nbnxn_atomdata_t* nbat, const Nbnxm::GridSet& gridSet)
+static void nbnxn_atomdata_mask_fep(nbnxn_atomdata_t* nbat, ArrayRef<const Nbnxm::Grid> grids)
 {
     nbnxn_atomdata_t::Params& params = nbat->paramsDeprecated();
     real*                     q;
@@ -860,7 +869,7 @@ static void nbnxn_atomdata_mask_fep(nbnxn_atomdata_t* nbat, const Nbnxm::GridSet
         stride_q = 1;
     }
 
-    for (const Nbnxm::Grid& grid : gridSet.grids())
+    for (const Nbnxm::Grid& grid : grids)
     {
         int nsubc;
         if (grid.geometry().isSimple)
@@ -927,9 +936,10 @@ copy_egp_to_nbat_egps(const int* a, int na, int na_round, int na_c, int bit_shif
 }
 
 /* Set the energy group indices for atoms in nbnxn_atomdata_t */
-static void nbnxn_atomdata_set_energygroups(nbnxn_atomdata_t::Params* params,
-                                            const Nbnxm::GridSet&     gridSet,
-                                            ArrayRef<const int>       atomInfo)
+static void nbnxn_atomdata_set_energygroups(nbnxn_atomdata_t::Params*   params,
+                                            const Nbnxm::GridSet&       gridSet,
+                                            ArrayRef<const Nbnxm::Grid> grids,
+                                            ArrayRef<const int>         atomInfo)
 {
     if (params->nenergrp == 1)
     {
@@ -938,7 +948,7 @@ static void nbnxn_atomdata_set_energygroups(nbnxn_atomdata_t::Params* params,
 
     params->energrp.resize(gridSet.numGridAtomsTotal());
 
-    for (const Nbnxm::Grid& grid : gridSet.grids())
+    for (const Nbnxm::Grid& grid : grids)
     {
         /* Loop over all columns and copy and fill */
         for (int i = 0; i < grid.numColumns(); i++)
@@ -946,9 +956,20 @@ static void nbnxn_atomdata_set_energygroups(nbnxn_atomdata_t::Params* params,
             const int numAtoms   = grid.paddedNumAtomsInColumn(i);
             const int atomOffset = grid.firstAtomInColumn(i);
 
-            copy_egp_to_nbat_egps(gridSet.atomIndices().data() + atomOffset, grid.numAtomsInColumn(i),
-                                  numAtoms, c_nbnxnCpuIClusterSize, params->neg_2log, atomInfo.data(),
-                                  params->energrp.data() + grid.atomToCluster(atomOffset));
+            if (grid.geometry().isSimple)
+            {
+                copy_egp_to_nbat_egps(gridSet.atomIndices().data() + atomOffset,
+                                      grid.numAtomsInColumn(i), numAtoms, c_nbnxnCpuIClusterSize,
+                                      params->neg_2log, atomInfo.data(),
+                                      params->energrp.data() + grid.atomToCluster(atomOffset));
+            }
+            else
+            {
+                /* The GPU kernels read the energy group of each atom separately */
+                copy_egp_to_nbat_egps(gridSet.atomIndices().data() + atomOffset,
+                                      grid.numAtomsInColumn(i), numAtoms, 1, 0, atomInfo.data(),
+                                      params->energrp.data() + atomOffset);
+            }
         }
     }
 }
@@ -958,23 +979,29 @@ void nbnxn_atomdata_set(nbnxn_atomdata_t*     nbat,
                         const Nbnxm::GridSet& gridSet,
                         ArrayRef<const int>   atomTypes,
                         ArrayRef<const real>  atomCharges,
-                        ArrayRef<const int>   atomInfo)
+                        ArrayRef<const int>   atomInfo,
+                        int                   firstGrid)
 {
+    GMX_ASSERT(firstGrid >= 0 && firstGrid <= gridSet.grids().ssize(), "Need a valid grid index");
+
     nbnxn_atomdata_t::Params& params = nbat->paramsDeprecated();
 
-    nbnxn_atomdata_set_atomtypes(&params, gridSet, atomTypes);
+    const ArrayRef<const Nbnxm::Grid> grids =
+            gridSet.grids().subArray(firstGrid, gridSet.grids().ssize() - firstGrid);
 
-    nbnxn_atomdata_set_charges(nbat, gridSet, atomCharges);
+    nbnxn_atomdata_set_atomtypes(&params, gridSet, grids, atomTypes);
+
+    nbnxn_atomdata_set_charges(nbat, gridSet, grids, atomCharges);
 
     if (gridSet.haveFep())
     {
-        nbnxn_atomdata_mask_fep(nbat, gridSet);
+        nbnxn_atomdata_mask_fep(nbat, grids);
     }
 
     /* This must be done after masking types for FEP */
-    nbnxn_atomdata_set_ljcombparams(&params, nbat->XFormat, gridSet);
+    nbnxn_atomdata_set_ljcombparams(&params, nbat->XFormat, gridSet, grids);
 
-    nbnxn_atomdata_set_energygroups(&params, gridSet, atomInfo);
+    nbnxn_atomdata_set_energygroups(&params, gridSet, grids, atomInfo);
 }
 
 /* Copies the shift vector array to nbnxn_atomdata_t */
@@ -1470,6 +1497,40 @@ void reduceForces(nbnxn_atomdata_t* nbat, const gmx::AtomLocality locality, cons
     }
 }
 
+void reduceOutputBufferForces(const nbnxn_atomdata_t&                        nbat,
+                              gmx::ArrayRef<const nbnxn_atomdata_output_t> outputBuffers,
+                              const gmx::AtomLocality                        locality,
+                              const Nbnxm::GridSet&                          gridSet,
+                              rvec*                                          f)
+{
+    int a0 = 0;
+    int na = 0;
+
+    nbnxn_get_atom_range(locality, gridSet, &a0, &na);
+
+    if (na == 0 || outputBuffers.empty())
+    {
+        return;
+    }
+
+    int nth = gmx_omp_nthreads_get(emntNonbonded);
+
+#pragma omp parallel for num_threads(nth) schedule(static)
+    for (int th = 0; th < nth; th++)
+    {
+        try
+        {
+            /* Each thread adds all buffers to its own part of f */
+            for (const nbnxn_atomdata_output_t& out : outputBuffers)
+            {
+                nbnxn_atomdata_add_nbat_f_to_f_part(gridSet, nbat, out, a0 + ((th + 0) * na) / nth,
+                                                    a0 + ((th + 1) * na) / nth, f);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
 void nbnxn_atomdata_add_nbat_fshift_to_fshift(const nbnxn_atomdata_t& nbat, gmx::ArrayRef<gmx::RVec> fshift)
 {
     gmx::ArrayRef<const nbnxn_atomdata_output_t> outputBuffers = nbat.out;
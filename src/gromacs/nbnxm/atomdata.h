@@ -205,7 +205,11 @@ struct nbnxn_atomdata_t
         int nenergrp;
         //! 2log(nenergrp)
         int neg_2log;
-        //! The energy groups, one int entry per cluster, only set when needed
+        /*! \brief The energy groups, only set when needed
+         *
+         * For CPU lists one int entry per cluster with packed group indices,
+         * for GPU lists one entry per atom.
+         */
         gmx::HostVector<int> energrp;
     };
 
@@ -330,12 +334,17 @@ void nbnxn_atomdata_init(const gmx::MDLogger&      mdlog,
                          int                       n_energygroups,
                          int                       nout);
 
-//! Sets the atomdata after pair search
+/*! \brief Sets the atomdata after pair search
+ *
+ * Only the atoms on the grids with index \p firstGrid and higher are set,
+ * which avoids setting all atoms when only the last grid(s) changed.
+ */
 void nbnxn_atomdata_set(nbnxn_atomdata_t*         nbat,
                         const Nbnxm::GridSet&     gridSet,
                         gmx::ArrayRef<const int>  atomTypes,
                         gmx::ArrayRef<const real> atomCharges,
-                        gmx::ArrayRef<const int>  atomInfo);
+                        gmx::ArrayRef<const int>  atomInfo,
+                        int                       firstGrid = 0);
 
 //! Copy the shift vectors to nbat
 void nbnxn_atomdata_copy_shiftvec(gmx_bool dynamic_box, rvec* shift_vec, nbnxn_atomdata_t* nbat);
@@ -384,6 +393,22 @@ void nbnxn_atomdata_x_to_nbat_x_gpu(const Nbnxm::GridSet&   gridSet,
  */
 void reduceForces(nbnxn_atomdata_t* nbat, gmx::AtomLocality locality, const Nbnxm::GridSet& gridSet, rvec* totalForce);
 
+/*! \brief Add the forces in the extra output buffers \p outputBuffers to \p totalForce
+ *
+ * The buffers should have the force layout of \p nbat.
+ *
+ * \param[in]  nbat           Atom data in NBNXM format.
+ * \param[in]  outputBuffers  The output buffers to reduce.
+ * \param[in]  locality       If the reduction should be performed on local or non-local atoms.
+ * \param[in]  gridSet        The grids data.
+ * \param[out] totalForce     Buffer to accumulate resulting force
+ */
+void reduceOutputBufferForces(const nbnxn_atomdata_t&                        nbat,
+                              gmx::ArrayRef<const nbnxn_atomdata_output_t> outputBuffers,
+                              gmx::AtomLocality                              locality,
+                              const Nbnxm::GridSet&                          gridSet,
+                              rvec*                                          totalForce);
+
 //! Add the fshift force stored in nbat to fshift
 void nbnxn_atomdata_add_nbat_fshift_to_fshift(const nbnxn_atomdata_t& nbat, gmx::ArrayRef<gmx::RVec> fshift);
 
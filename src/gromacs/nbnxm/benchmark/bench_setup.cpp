@@ -45,9 +45,14 @@
 
 #include "bench_setup.h"
 
+#include <cinttypes>
+
 #include <optional>
 
 #include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/gpu_utils/device_stream_manager.h"
+#include "gromacs/hardware/device_information.h"
+#include "gromacs/hardware/device_management.h"
 #include "gromacs/mdlib/dispersioncorrection.h"
 #include "gromacs/mdlib/force_flags.h"
 #include "gromacs/mdlib/forcerec.h"
@@ -58,8 +63,10 @@
 #include "gromacs/mdtypes/mdatom.h"
 #include "gromacs/mdtypes/simulation_workload.h"
 #include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/gpu_data_mgmt.h"
 #include "gromacs/nbnxm/gridset.h"
 #include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/nbnxm_gpu.h"
 #include "gromacs/nbnxm/nbnxm_simd.h"
 #include "gromacs/nbnxm/pairlistset.h"
 #include "gromacs/nbnxm/pairlistsets.h"
@@ -70,34 +77,72 @@
 #include "gromacs/timing/cyclecounter.h"
 #include "gromacs/utility/enumerationhelpers.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/logger.h"
+#include "gromacs/utility/stringutil.h"
 
 #include "bench_system.h"
 
 namespace Nbnxm
 {
 
+/*! \internal \brief
+ * Timings and pair counts of one benchmark instance
+ *
+ * All times are totals over all iterations, except for the search time,
+ * and are given in micro seconds or in Mcycles.
+ */
+struct BenchmarkResult
+{
+    //! The options the instance was run with
+    KernelBenchOptions options;
+    //! The number of atom pairs in the pairlist
+    gmx::index numPairs;
+    //! Estimate of the number of atom pairs within the cut-off
+    real numUsefulPairs;
+    //! The time spent in the non-bonded kernel
+    double kernelTime;
+    //! The time spent in the dynamic pruning kernel, only set with pruning
+    double pruneTime;
+    //! The time for putting the atoms on the grid and constructing the pairlist, done once
+    double searchTime;
+    //! The time spent converting the coordinates to the nbnxm layout
+    double xBufferOpsTime;
+    //! The time spent reducing the nbnxm forces to the force buffer
+    double fBufferOpsTime;
+};
+
 /*! \brief Checks the kernel setup
  *
  * Returns an error string when the kernel is not available.
  */
 static std::optional<std::string> checkKernelSetup(const KernelBenchOptions& options)
 {
-    GMX_RELEASE_ASSERT(options.nbnxmSimd < BenchMarkKernels::Count
-                               && options.nbnxmSimd != BenchMarkKernels::SimdAuto,
-                       "Need a valid kernel SIMD type");
+    if (options.useGpu)
+    {
+        if (!GMX_GPU)
+        {
+            return "GROMACS was built without GPU support";
+        }
+    }
+    else
+    {
+        GMX_RELEASE_ASSERT(options.nbnxmSimd < BenchMarkKernels::Count
+                                   && options.nbnxmSimd != BenchMarkKernels::SimdAuto,
+                           "Need a valid kernel SIMD type");
 
-    // Check SIMD support
-    if ((options.nbnxmSimd != BenchMarkKernels::SimdNo && !GMX_SIMD)
+        // Check SIMD support
+        if ((options.nbnxmSimd != BenchMarkKernels::SimdNo && !GMX_SIMD)
 #ifndef GMX_NBNXN_SIMD_4XN
-        || options.nbnxmSimd == BenchMarkKernels::Simd4XM
+            || options.nbnxmSimd == BenchMarkKernels::Simd4XM
 #endif
 #ifndef GMX_NBNXN_SIMD_2XNN
-        || options.nbnxmSimd == BenchMarkKernels::Simd2XMM
+            || options.nbnxmSimd == BenchMarkKernels::Simd2XMM
 #endif
-    )
-    {
-        return "the requested SIMD kernel was not set up at configuration time";
+        )
+        {
+            return "the requested SIMD kernel was not set up at configuration time";
+        }
     }
 
     if (options.reportTime && (0 > gmx_cycles_calibrate(1.0)))
@@ -124,6 +169,15 @@ static KernelSetup getKernelSetup(const KernelBenchOptions& options)
 
     KernelSetup kernelSetup;
 
+    if (options.useGpu)
+    {
+        // The GPU module selects the Ewald exclusion treatment itself
+        kernelSetup.kernelType         = KernelType::Gpu8x8x8;
+        kernelSetup.ewaldExclusionType = EwaldExclusionType::Analytical;
+
+        return kernelSetup;
+    }
+
     // The int enum options.nbnxnSimd is set up to match KernelType + 1
     kernelSetup.kernelType = translateBenchmarkEnum(options.nbnxmSimd);
     // The plain-C kernel does not support analytical ewald correction
@@ -140,6 +194,60 @@ static KernelSetup getKernelSetup(const KernelBenchOptions& options)
     return kernelSetup;
 }
 
+//! Returns the name of the kernel type used for output
+static const char* kernelName(const KernelBenchOptions& options)
+{
+    static const gmx::EnumerationArray<BenchMarkKernels, const char*> c_kernelNames = { "auto", "no",
+                                                                                        "4xM", "2xMM" };
+
+    return options.useGpu ? "gpu" : c_kernelNames[options.nbnxmSimd];
+}
+
+//! Returns the name of the LJ combination rule used for output
+static const char* combRuleName(const KernelBenchOptions& options)
+{
+    static const gmx::EnumerationArray<BenchMarkCombRule, const char*> c_combRuleNames = { "geom.",
+                                                                                           "LB", "none" };
+
+    return c_combRuleNames[options.ljCombinationRule];
+}
+
+//! Returns the name of the Ewald exclusion correction used for output, empty with RF
+static const char* ewaldExclusionName(const KernelBenchOptions& options)
+{
+    if (options.coulombType == BenchMarkCoulomb::ReactionField)
+    {
+        return "";
+    }
+    else if (options.useGpu)
+    {
+        return "auto";
+    }
+    else
+    {
+        return (options.nbnxmSimd == BenchMarkKernels::SimdNo || options.useTabulatedEwaldCorr)
+                       ? "table"
+                       : "analytical";
+    }
+}
+
+//! Returns the SIMD width of the kernel, 0 for plain-C and GPU kernels
+static int simdWidth(const KernelBenchOptions& options)
+{
+#if GMX_SIMD
+    return (!options.useGpu && options.nbnxmSimd != BenchMarkKernels::SimdNo) ? GMX_SIMD_REAL_WIDTH : 0;
+#else
+    GMX_UNUSED_VALUE(options);
+    return 0;
+#endif
+}
+
+//! Returns the cut-off of the (outer) pairlist
+static real outerPairlistCutoff(const KernelBenchOptions& options)
+{
+    return options.pairlistCutoff + (options.doPrune ? options.pruneBuffer : 0);
+}
+
 //! Return an interaction constants struct with members used in the benchmark set appropriately
 static interaction_const_t setupInteractionConst(const KernelBenchOptions& options)
 
@@ -171,9 +279,22 @@ static interaction_const_t setupInteractionConst(const KernelBenchOptions& optio
     return ic;
 }
 
-//! Sets up and returns a Nbnxm object for the given benchmark options and system
-static std::unique_ptr<nonbonded_verlet_t> setupNbnxmForBenchInstance(const KernelBenchOptions& options,
-                                                                      const gmx::BenchmarkSystem& system)
+/*! \brief Sets up and returns a Nbnxm object for the given benchmark options and system
+ *
+ * Also constructs the pairlist and, with a GPU, uploads all data the kernels need.
+ *
+ * \param[in]  options              How the benchmark will be run
+ * \param[in]  system               The system to run on
+ * \param[in]  ic                   The interaction constants
+ * \param[in]  deviceStreamManager  The GPU context and streams, only used with a GPU
+ * \param[out] searchCycles         The cycles spent on gridding and constructing the pairlist
+ */
+static std::unique_ptr<nonbonded_verlet_t>
+setupNbnxmForBenchInstance(const KernelBenchOptions&       options,
+                           const gmx::BenchmarkSystem&     system,
+                           const interaction_const_t&      ic,
+                           const gmx::DeviceStreamManager* deviceStreamManager,
+                           gmx_cycles_t*                   searchCycles)
 {
     const auto pinPolicy  = (options.useGpu ? gmx::PinningPolicy::PinnedIfSupported
                                            : gmx::PinningPolicy::CannotBePinned);
@@ -188,25 +309,46 @@ static std::unique_ptr<nonbonded_verlet_t> setupNbnxmForBenchInstance(const Kern
     }
     Nbnxm::KernelSetup kernelSetup = getKernelSetup(options);
 
-    PairlistParams pairlistParams(kernelSetup.kernelType, false, options.pairlistCutoff, false);
+    PairlistParams pairlistParams(kernelSetup.kernelType, false, outerPairlistCutoff(options), false);
+    if (options.doPrune)
+    {
+        // We prune the outer list, every iteration when timing, with the interaction cut-off
+        pairlistParams.useDynamicPruning = true;
+        pairlistParams.rlistInner        = options.pairlistCutoff;
+        pairlistParams.nstlistPrune      = 1;
+    }
 
     GridSet gridSet(PbcType::Xyz, false, nullptr, nullptr, pairlistParams.pairlistType, false,
                     numThreads, pinPolicy);
 
-    auto pairlistSets = std::make_unique<PairlistSets>(pairlistParams, false, 0);
+    auto atomData = std::make_unique<nbnxn_atomdata_t>(pinPolicy);
+
+    nbnxn_atomdata_init(gmx::MDLogger(), atomData.get(), kernelSetup.kernelType, combinationRule,
+                        system.numAtomTypes, system.nonbondedParameters, 1,
+                        options.useGpu ? 1 : numThreads);
+
+    NbnxmGpu* gpu_nbv                          = nullptr;
+    int       minimumIlistCountForGpuBalancing = 0;
+    if (options.useGpu)
+    {
+        GMX_RELEASE_ASSERT(deviceStreamManager != nullptr,
+                           "Need a device stream manager to run on a GPU");
+        gpu_nbv = gpu_init(*deviceStreamManager, &ic, pairlistParams, atomData.get(), false);
+        minimumIlistCountForGpuBalancing = gpu_min_ci_balanced(gpu_nbv);
+    }
+
+    auto pairlistSets =
+            std::make_unique<PairlistSets>(pairlistParams, false, minimumIlistCountForGpuBalancing);
 
     auto pairSearch =
             std::make_unique<PairSearch>(PbcType::Xyz, false, nullptr, nullptr,
                                          pairlistParams.pairlistType, false, numThreads, pinPolicy);
 
-    auto atomData = std::make_unique<nbnxn_atomdata_t>(pinPolicy);
-
     // Put everything together
     auto nbv = std::make_unique<nonbonded_verlet_t>(std::move(pairlistSets), std::move(pairSearch),
-                                                    std::move(atomData), kernelSetup, nullptr, nullptr);
+                                                    std::move(atomData), kernelSetup, gpu_nbv, nullptr);
 
-    nbnxn_atomdata_init(gmx::MDLogger(), nbv->nbat.get(), kernelSetup.kernelType, combinationRule,
-                        system.numAtomTypes, system.nonbondedParameters, 1, numThreads);
+    nbnxn_atomdata_copy_shiftvec(false, system.forceRec.shift_vec, nbv->nbat.get());
 
     t_nrnb nrnb;
 
@@ -226,13 +368,34 @@ static std::unique_ptr<nonbonded_verlet_t> setupNbnxmForBenchInstance(const Kern
 
     const real atomDensity = system.coordinates.size() / det(system.box);
 
+    gmx_cycles_t cycles = gmx_cycles_read();
     nbnxn_put_on_grid(nbv.get(), system.box, 0, lowerCorner, upperCorner, nullptr,
                       { 0, int(system.coordinates.size()) }, atomDensity, atomInfo,
                       system.coordinates, 0, nullptr);
+    *searchCycles = gmx_cycles_read() - cycles;
 
+    nbv->setAtomProperties(system.atomTypes, system.charges, atomInfo);
+
+    if (options.useGpu)
+    {
+        gpu_init_atomdata(nbv->gpu_nbv, nbv->nbat.get());
+    }
+
+    cycles = gmx_cycles_read();
     nbv->constructPairlist(gmx::InteractionLocality::Local, system.excls, 0, &nrnb);
+    *searchCycles += gmx_cycles_read() - cycles;
 
-    nbv->setAtomProperties(system.atomTypes, system.charges, atomInfo);
+    if (options.useGpu)
+    {
+        nbv->setupGpuShortRangeWork(nullptr, gmx::InteractionLocality::Local);
+        gpu_upload_shiftvec(nbv->gpu_nbv, nbv->nbat.get());
+        gpu_copy_xq_to_gpu(nbv->gpu_nbv, nbv->nbat.get(), gmx::AtomLocality::Local);
+    }
+    else if (options.doPrune)
+    {
+        // The CPU kernels compute the interactions of the inner list produced by pruning
+        nbv->dispatchPruneKernelCpu(gmx::InteractionLocality::Local, system.forceRec.shift_vec);
+    }
 
     return nbv;
 }
@@ -241,7 +404,12 @@ static std::unique_ptr<nonbonded_verlet_t> setupNbnxmForBenchInstance(const Kern
 static void expandSimdOptionAndPushBack(const KernelBenchOptions&        options,
                                         std::vector<KernelBenchOptions>* optionsList)
 {
-    if (options.nbnxmSimd == BenchMarkKernels::SimdAuto)
+    if (options.useGpu)
+    {
+        // The SIMD setting does not apply to GPU kernels
+        optionsList->push_back(options);
+    }
+    else if (options.nbnxmSimd == BenchMarkKernels::SimdAuto)
     {
         bool addedInstance = false;
 #ifdef GMX_NBNXN_SIMD_4XN
@@ -266,13 +434,41 @@ static void expandSimdOptionAndPushBack(const KernelBenchOptions&        options
     }
 }
 
+/*! \brief Runs the non-bonded kernel for one iteration
+ *
+ * With a GPU this includes the transfer of the forces back to the host
+ * and waiting for the results, as these are part of every MD step.
+ */
+static void runNonbondedKernel(nonbonded_verlet_t*         nbv,
+                               const interaction_const_t&  ic,
+                               const gmx::StepWorkload&    stepWork,
+                               const int                   clearF,
+                               const gmx::BenchmarkSystem& system,
+                               gmx_enerdata_t*             enerd,
+                               t_nrnb*                     nrnb,
+                               gmx::ArrayRef<gmx::RVec>    shiftForces)
+{
+    nbv->dispatchNonbondedKernel(gmx::InteractionLocality::Local, ic, stepWork, clearF,
+                                 system.forceRec, enerd, nrnb);
+
+    if (nbv->useGpu())
+    {
+        gpu_launch_cpyback(nbv->gpu_nbv, nbv->nbat.get(), stepWork, gmx::AtomLocality::Local);
+        gpu_wait_finish_task(nbv->gpu_nbv, stepWork, gmx::AtomLocality::Local,
+                             enerd->grpp.ener[egLJSR].data(), enerd->grpp.ener[egCOULSR].data(),
+                             shiftForces, nullptr);
+        gpu_clear_outputs(nbv->gpu_nbv, stepWork.computeVirial);
+    }
+}
+
 //! Sets up and runs the requested benchmark instance and prints the results
 //
 // When \p doWarmup is true runs the warmup iterations instead
-// of the normal ones and does not print any results
-static void setupAndRunInstance(const gmx::BenchmarkSystem& system,
-                                const KernelBenchOptions&   options,
-                                const bool                  doWarmup)
+// of the normal ones and does not print or return any results
+static std::optional<BenchmarkResult> setupAndRunInstance(const gmx::BenchmarkSystem&     system,
+                                                          const KernelBenchOptions&       options,
+                                                          const gmx::DeviceStreamManager* deviceStreamManager,
+                                                          const bool                      doWarmup)
 {
     // Generate an, accurate, estimate of the number of non-zero pair interactions
     const real atomDensity = system.coordinates.size() / det(system.box);
@@ -280,15 +476,19 @@ static void setupAndRunInstance(const gmx::BenchmarkSystem& system,
             atomDensity * 4.0 / 3.0 * M_PI * std::pow(options.pairlistCutoff, 3);
     const real numUsefulPairs = system.coordinates.size() * 0.5 * (numPairsWithinCutoff + 1);
 
-    std::unique_ptr<nonbonded_verlet_t> nbv = setupNbnxmForBenchInstance(options, system);
-
     // We set the interaction cut-off to the pairlist cut-off
     interaction_const_t ic = setupInteractionConst(options);
 
+    gmx_cycles_t                        searchCycles = 0;
+    std::unique_ptr<nonbonded_verlet_t> nbv =
+            setupNbnxmForBenchInstance(options, system, ic, deviceStreamManager, &searchCycles);
+
     t_nrnb nrnb = { 0 };
 
     gmx_enerdata_t enerd(1, 0);
 
+    std::vector<gmx::RVec> shiftForces(SHIFTS);
+
     gmx::StepWorkload stepWork;
     stepWork.computeForces = true;
     if (options.computeVirialAndEnergy)
@@ -297,47 +497,30 @@ static void setupAndRunInstance(const gmx::BenchmarkSystem& system,
         stepWork.computeEnergy = true;
     }
 
-    const gmx::EnumerationArray<BenchMarkKernels, std::string> kernelNames = { "auto", "no", "4xM",
-                                                                               "2xMM" };
-
-    const gmx::EnumerationArray<BenchMarkCombRule, std::string> combruleNames = { "geom.", "LB",
-                                                                                  "none" };
-
     if (!doWarmup)
     {
         fprintf(stdout, "%-7s %-4s %-5s %-4s ",
                 options.coulombType == BenchMarkCoulomb::Pme ? "Ewald" : "RF",
-                options.useHalfLJOptimization ? "half" : "all",
-                combruleNames[options.ljCombinationRule].c_str(), kernelNames[options.nbnxmSimd].c_str());
+                options.useHalfLJOptimization ? "half" : "all", combRuleName(options),
+                kernelName(options));
         if (!options.outputFile.empty())
         {
             fprintf(system.csv,
                     "\"%d\",\"%zu\",\"%g\",\"%d\",\"%d\",\"%s\",\"%s\",\"%s\",\"%s\",\"%s\",\"%"
                     "s\",",
-#if GMX_SIMD
-                    (options.nbnxmSimd != BenchMarkKernels::SimdNo) ? GMX_SIMD_REAL_WIDTH : 0,
-#else
-                    0,
-#endif
-                    system.coordinates.size(), options.pairlistCutoff, options.numThreads,
-                    options.numIterations, options.computeVirialAndEnergy ? "yes" : "no",
-                    (options.coulombType != BenchMarkCoulomb::ReactionField)
-                            ? ((options.nbnxmSimd == BenchMarkKernels::SimdNo || options.useTabulatedEwaldCorr)
-                                       ? "table"
-                                       : "analytical")
-                            : "",
+                    simdWidth(options), system.coordinates.size(), options.pairlistCutoff,
+                    options.numThreads, options.numIterations,
+                    options.computeVirialAndEnergy ? "yes" : "no", ewaldExclusionName(options),
                     options.coulombType == BenchMarkCoulomb::Pme ? "Ewald" : "RF",
-                    options.useHalfLJOptimization ? "half" : "all",
-                    combruleNames[options.ljCombinationRule].c_str(),
-                    kernelNames[options.nbnxmSimd].c_str());
+                    options.useHalfLJOptimization ? "half" : "all", combRuleName(options),
+                    kernelName(options));
         }
     }
 
     // Run pre-iteration to avoid cache misses
     for (int iter = 0; iter < options.numPreIterations; iter++)
     {
-        nbv->dispatchNonbondedKernel(gmx::InteractionLocality::Local, ic, stepWork, enbvClearFYes,
-                                     system.forceRec, &enerd, &nrnb);
+        runNonbondedKernel(nbv.get(), ic, stepWork, enbvClearFYes, system, &enerd, &nrnb, shiftForces);
     }
 
     const int numIterations = (doWarmup ? options.numWarmupIterations : options.numIterations);
@@ -347,58 +530,284 @@ static void setupAndRunInstance(const gmx::BenchmarkSystem& system,
     for (int iter = 0; iter < numIterations; iter++)
     {
         // Run the kernel without force clearing
-        nbv->dispatchNonbondedKernel(gmx::InteractionLocality::Local, ic, stepWork, enbvClearFNo,
-                                     system.forceRec, &enerd, &nrnb);
+        runNonbondedKernel(nbv.get(), ic, stepWork, enbvClearFNo, system, &enerd, &nrnb, shiftForces);
     }
     cycles = gmx_cycles_read() - cycles;
-    if (!doWarmup)
+
+    if (doWarmup)
+    {
+        return {};
+    }
+
+    const double uSecPerCycle = (options.reportTime ? gmx_cycles_calibrate(1.0) * 1.e6 : 0);
+    if (options.reportTime)
     {
-        if (options.reportTime)
+        const double uSec = static_cast<double>(cycles) * uSecPerCycle;
+        if (options.cyclesPerPair)
         {
-            const double uSec = static_cast<double>(cycles) * gmx_cycles_calibrate(1.0) * 1.e6;
-            if (options.cyclesPerPair)
+            fprintf(stdout, "%13.2f %13.3f %10.3f %10.3f\n", uSec, uSec / options.numIterations,
+                    uSec / (options.numIterations * numPairs),
+                    uSec / (options.numIterations * numUsefulPairs));
+            if (!options.outputFile.empty())
             {
-                fprintf(stdout, "%13.2f %13.3f %10.3f %10.3f\n", uSec, uSec / options.numIterations,
-                        uSec / (options.numIterations * numPairs),
+                fprintf(system.csv, "\"%.3f\",\"%.4f\",\"%.4f\",\"%.4f\"\n", uSec,
+                        uSec / options.numIterations, uSec / (options.numIterations * numPairs),
                         uSec / (options.numIterations * numUsefulPairs));
-                if (!options.outputFile.empty())
-                {
-                    fprintf(system.csv, "\"%.3f\",\"%.4f\",\"%.4f\",\"%.4f\"\n", uSec,
-                            uSec / options.numIterations, uSec / (options.numIterations * numPairs),
-                            uSec / (options.numIterations * numUsefulPairs));
-                }
             }
-            else
+        }
+        else
+        {
+            fprintf(stdout, "%13.2f %13.3f %10.3f %10.3f\n", uSec, uSec / options.numIterations,
+                    options.numIterations * numPairs / uSec,
+                    options.numIterations * numUsefulPairs / uSec);
+            if (!options.outputFile.empty())
             {
-                fprintf(stdout, "%13.2f %13.3f %10.3f %10.3f\n", uSec, uSec / options.numIterations,
-                        options.numIterations * numPairs / uSec,
+                fprintf(system.csv, "\"%.3f\",\"%.4f\",\"%.4f\",\"%.4f\"\n", uSec,
+                        uSec / options.numIterations, options.numIterations * numPairs / uSec,
                         options.numIterations * numUsefulPairs / uSec);
-                if (!options.outputFile.empty())
-                {
-                    fprintf(system.csv, "\"%.3f\",\"%.4f\",\"%.4f\",\"%.4f\"\n", uSec,
-                            uSec / options.numIterations, options.numIterations * numPairs / uSec,
-                            options.numIterations * numUsefulPairs / uSec);
-                }
             }
         }
+    }
+    else
+    {
+        const double dCycles = static_cast<double>(cycles);
+        if (options.cyclesPerPair)
+        {
+            fprintf(stdout, "%10.3f %10.4f %8.4f %8.4f\n", cycles * 1e-6,
+                    dCycles / options.numIterations * 1e-6,
+                    dCycles / (options.numIterations * numPairs),
+                    dCycles / (options.numIterations * numUsefulPairs));
+        }
         else
         {
-            const double dCycles = static_cast<double>(cycles);
-            if (options.cyclesPerPair)
+            fprintf(stdout, "%10.3f %10.4f %8.4f %8.4f\n", dCycles * 1e-6,
+                    dCycles / options.numIterations * 1e-6, options.numIterations * numPairs / dCycles,
+                    options.numIterations * numUsefulPairs / dCycles);
+        }
+    }
+
+    double pruneCycles = 0;
+    if (options.doPrune)
+    {
+        const gmx_cycles_t pruneStart = gmx_cycles_read();
+        for (int iter = 0; iter < options.numIterations; iter++)
+        {
+            if (nbv->useGpu())
             {
-                fprintf(stdout, "%10.3f %10.4f %8.4f %8.4f\n", cycles * 1e-6,
-                        dCycles / options.numIterations * 1e-6,
-                        dCycles / (options.numIterations * numPairs),
-                        dCycles / (options.numIterations * numUsefulPairs));
+                // With a GPU, the completion of the pruning can only be waited for together
+                // with the non-bonded kernel, so we subtract the kernel-only time below
+                gpu_launch_kernel_pruneonly(nbv->gpu_nbv, gmx::InteractionLocality::Local, 1);
+                runNonbondedKernel(nbv.get(), ic, stepWork, enbvClearFNo, system, &enerd, &nrnb,
+                                   shiftForces);
             }
             else
             {
-                fprintf(stdout, "%10.3f %10.4f %8.4f %8.4f\n", dCycles * 1e-6,
-                        dCycles / options.numIterations * 1e-6, options.numIterations * numPairs / dCycles,
-                        options.numIterations * numUsefulPairs / dCycles);
+                nbv->dispatchPruneKernelCpu(gmx::InteractionLocality::Local, system.forceRec.shift_vec);
             }
         }
+        pruneCycles = static_cast<double>(gmx_cycles_read() - pruneStart);
+        if (nbv->useGpu())
+        {
+            pruneCycles -= static_cast<double>(cycles);
+        }
+    }
+
+    const gmx_cycles_t xBufferOpsStart = gmx_cycles_read();
+    for (int iter = 0; iter < options.numIterations; iter++)
+    {
+        nbv->convertCoordinates(gmx::AtomLocality::Local, false, system.coordinates);
+    }
+    const gmx_cycles_t xBufferOpsCycles = gmx_cycles_read() - xBufferOpsStart;
+
+    std::vector<gmx::RVec> forces(system.coordinates.size(), { 0, 0, 0 });
+    const gmx_cycles_t     fBufferOpsStart = gmx_cycles_read();
+    for (int iter = 0; iter < options.numIterations; iter++)
+    {
+        nbv->atomdata_add_nbat_f_to_f(gmx::AtomLocality::Local, forces);
+    }
+    const gmx_cycles_t fBufferOpsCycles = gmx_cycles_read() - fBufferOpsStart;
+
+    // Convert to micro seconds or Mcycles
+    const double conversionFactor = (options.reportTime ? uSecPerCycle : 1e-6);
+
+    BenchmarkResult result;
+    result.options        = options;
+    result.numPairs       = numPairs;
+    result.numUsefulPairs = numUsefulPairs;
+    result.kernelTime     = static_cast<double>(cycles) * conversionFactor;
+    result.pruneTime      = pruneCycles * conversionFactor;
+    result.searchTime     = static_cast<double>(searchCycles) * conversionFactor;
+    result.xBufferOpsTime = static_cast<double>(xBufferOpsCycles) * conversionFactor;
+    result.fBufferOpsTime = static_cast<double>(fBufferOpsCycles) * conversionFactor;
+
+    return result;
+}
+
+//! Prints the timings of the pair search, pruning and buffer operations of all instances
+static void printSearchAndBufferOps(const KernelBenchOptions&              options,
+                                    gmx::ArrayRef<const BenchmarkResult> results)
+{
+    fprintf(stdout, "\nPair search, pruning and buffer operations, in %s\n",
+            options.reportTime ? "micro seconds" : "Mcycles");
+    fprintf(stdout, "Coulomb LJ   comb. SIMD      search   prune/it.    x-op/it.    f-op/it.\n");
+    for (const BenchmarkResult& result : results)
+    {
+        const KernelBenchOptions& opt           = result.options;
+        const double              numIterations = opt.numIterations;
+        fprintf(stdout, "%-7s %-4s %-5s %-4s %11.3f ",
+                opt.coulombType == BenchMarkCoulomb::Pme ? "Ewald" : "RF",
+                opt.useHalfLJOptimization ? "half" : "all", combRuleName(opt), kernelName(opt),
+                result.searchTime);
+        if (opt.doPrune)
+        {
+            fprintf(stdout, "%11.4f ", result.pruneTime / numIterations);
+        }
+        else
+        {
+            fprintf(stdout, "%11s ", "-");
+        }
+        fprintf(stdout, "%11.4f %11.4f\n", result.xBufferOpsTime / numIterations,
+                result.fBufferOpsTime / numIterations);
+    }
+}
+
+/*! \brief Prints which of the SIMD kernel layouts is fastest, when both were run
+ *
+ * The time per step includes the pruning and buffer operations, as these
+ * also depend on the layout. The search is left out, as it is only done
+ * once per pairlist lifetime.
+ */
+static void printFastestSimdLayout(gmx::ArrayRef<const BenchmarkResult> results)
+{
+    gmx::EnumerationArray<BenchMarkKernels, double> timePerIteration = {};
+    gmx::EnumerationArray<BenchMarkKernels, bool>   wasRun           = {};
+    for (const BenchmarkResult& result : results)
+    {
+        const KernelBenchOptions& opt = result.options;
+        if (opt.useGpu)
+        {
+            return;
+        }
+        const double stepTime = result.kernelTime + result.pruneTime + result.xBufferOpsTime
+                                + result.fBufferOpsTime;
+        timePerIteration[opt.nbnxmSimd] += stepTime / opt.numIterations;
+        wasRun[opt.nbnxmSimd] = true;
+    }
+    if (!wasRun[BenchMarkKernels::Simd4XM] || !wasRun[BenchMarkKernels::Simd2XMM])
+    {
+        return;
+    }
+
+    const double time4xM      = timePerIteration[BenchMarkKernels::Simd4XM];
+    const double time2xMM     = timePerIteration[BenchMarkKernels::Simd2XMM];
+    const bool   fastestIs4xM = (time4xM <= time2xMM);
+    fprintf(stdout,
+            "\nThe %s SIMD kernel layout is fastest on this CPU, by %.1f%% per step summed over\n"
+            "all setups. Set the environment variable GMX_NBNXN_SIMD_%s to select it in mdrun.\n",
+            fastestIs4xM ? "4xM" : "2xMM",
+            100 * (fastestIs4xM ? time2xMM / time4xM - 1 : time4xM / time2xMM - 1),
+            fastestIs4xM ? "4XN" : "2XNN");
+}
+
+//! Returns \p input with the characters that need it escaped for use in a JSON string
+static std::string jsonEscaped(const std::string& input)
+{
+    return gmx::replaceAll(gmx::replaceAll(input, "\\", "\\\\"), "\"", "\\\"");
+}
+
+//! Writes the settings and the results of all benchmark instances to a JSON file
+static void writeJsonReport(const KernelBenchOptions&              options,
+                            const gmx::BenchmarkSystem&            system,
+                            const DeviceInformation*               deviceInfo,
+                            gmx::ArrayRef<const BenchmarkResult> results)
+{
+    FILE* fp = gmx_ffopen(options.jsonOutputFile, "w");
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"atoms\": %zu,\n", system.coordinates.size());
+    fprintf(fp, "  \"atom_density\": %g,\n", system.coordinates.size() / det(system.box));
+    fprintf(fp, "  \"cutoff\": %g,\n", options.pairlistCutoff);
+    if (options.doPrune)
+    {
+        fprintf(fp, "  \"outer_pairlist_cutoff\": %g,\n", outerPairlistCutoff(options));
+    }
+    fprintf(fp, "  \"threads\": %d,\n", options.numThreads);
+    fprintf(fp, "  \"iterations\": %d,\n", options.numIterations);
+    fprintf(fp, "  \"compute_energy\": %s,\n", options.computeVirialAndEnergy ? "true" : "false");
+    if (deviceInfo != nullptr)
+    {
+        fprintf(fp, "  \"gpu\": \"%s\",\n", jsonEscaped(getDeviceInformationString(*deviceInfo)).c_str());
+    }
+    fprintf(fp, "  \"time_unit\": \"%s\",\n", options.reportTime ? "microseconds" : "megacycles");
+    fprintf(fp, "  \"benchmarks\": [\n");
+    for (gmx::index i = 0; i < results.ssize(); i++)
+    {
+        const BenchmarkResult&    result        = results[i];
+        const KernelBenchOptions& opt           = result.options;
+        const double              numIterations = opt.numIterations;
+
+        fprintf(fp, "    {\n");
+        fprintf(fp, "      \"coulomb\": \"%s\",\n",
+                opt.coulombType == BenchMarkCoulomb::Pme ? "Ewald" : "RF");
+        fprintf(fp, "      \"lj\": \"%s\",\n", opt.useHalfLJOptimization ? "half" : "all");
+        fprintf(fp, "      \"comb_rule\": \"%s\",\n", combRuleName(opt));
+        fprintf(fp, "      \"kernel\": \"%s\",\n", kernelName(opt));
+        fprintf(fp, "      \"simd_width\": %d,\n", simdWidth(opt));
+        fprintf(fp, "      \"ewald_exclusion\": \"%s\",\n", ewaldExclusionName(opt));
+        fprintf(fp, "      \"total_pairs\": %" PRId64 ",\n", static_cast<int64_t>(result.numPairs));
+        fprintf(fp, "      \"useful_pairs\": %.0f,\n", result.numUsefulPairs);
+        fprintf(fp, "      \"search\": %g,\n", result.searchTime);
+        fprintf(fp, "      \"kernel_per_iteration\": %g,\n", result.kernelTime / numIterations);
+        if (opt.doPrune)
+        {
+            fprintf(fp, "      \"prune_per_iteration\": %g,\n", result.pruneTime / numIterations);
+        }
+        fprintf(fp, "      \"x_buffer_ops_per_iteration\": %g,\n", result.xBufferOpsTime / numIterations);
+        fprintf(fp, "      \"f_buffer_ops_per_iteration\": %g\n", result.fBufferOpsTime / numIterations);
+        fprintf(fp, "    }%s\n", i + 1 < results.ssize() ? "," : "");
     }
+    fprintf(fp, "  ]\n");
+    fprintf(fp, "}\n");
+
+    gmx_ffclose(fp);
+}
+
+/*! \brief Detects the GPUs and activates the one selected by \p options
+ *
+ * \p deviceInfoList returns all detected devices and should outlive
+ * the use of the returned device.
+ */
+static DeviceInformation* selectGpu(const KernelBenchOptions&                        options,
+                                    std::vector<std::unique_ptr<DeviceInformation>>* deviceInfoList)
+{
+    auto messageWhenInvalid = checkKernelSetup(options);
+    if (messageWhenInvalid)
+    {
+        gmx_fatal(FARGS, "Requested kernel is unavailable because %s.", messageWhenInvalid->c_str());
+    }
+
+    std::string errorMessage;
+    if (!canPerformDeviceDetection(&errorMessage))
+    {
+        gmx_fatal(FARGS, "Cannot detect GPUs: %s", errorMessage.c_str());
+    }
+    *deviceInfoList = findDevices();
+    DeviceInformation* deviceInfo = nullptr;
+    for (auto& detectedDeviceInfo : *deviceInfoList)
+    {
+        if (detectedDeviceInfo->id == options.gpuId)
+        {
+            deviceInfo = detectedDeviceInfo.get();
+        }
+    }
+    if (deviceInfo == nullptr || !deviceIdIsCompatible(*deviceInfoList, options.gpuId))
+    {
+        gmx_fatal(FARGS, "GPU with ID %d was requested, but it was not detected or is not compatible",
+                  options.gpuId);
+    }
+    setActiveDevice(*deviceInfo);
+
+    return deviceInfo;
 }
 
 void bench(const int sizeFactor, const KernelBenchOptions& options)
@@ -407,16 +816,29 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
     gmx_omp_nthreads_set(emntPairsearch, options.numThreads);
     gmx_omp_nthreads_set(emntNonbonded, options.numThreads);
 
-    const gmx::BenchmarkSystem system(sizeFactor, options.outputFile);
+    const gmx::BenchmarkSystem system(sizeFactor, options.densityFactor, options.outputFile);
 
     real minBoxSize = norm(system.box[XX]);
     for (int dim = YY; dim < DIM; dim++)
     {
         minBoxSize = std::min(minBoxSize, norm(system.box[dim]));
     }
-    if (options.pairlistCutoff > 0.5 * minBoxSize)
+    if (outerPairlistCutoff(options) > 0.5 * minBoxSize)
     {
-        gmx_fatal(FARGS, "The cut-off should be shorter than half the box size");
+        gmx_fatal(FARGS, "The (outer pairlist) cut-off should be shorter than half the box size");
+    }
+
+    std::vector<std::unique_ptr<DeviceInformation>> deviceInfoList;
+    DeviceInformation*                              deviceInfo = nullptr;
+    std::unique_ptr<gmx::DeviceStreamManager>       deviceStreamManager;
+    if (options.useGpu)
+    {
+        deviceInfo = selectGpu(options, &deviceInfoList);
+
+        gmx::SimulationWorkload simulationWork;
+        simulationWork.useGpuNonbonded = true;
+        deviceStreamManager =
+                std::make_unique<gmx::DeviceStreamManager>(*deviceInfo, false, simulationWork, false);
     }
 
     std::vector<KernelBenchOptions> optionsList;
@@ -427,7 +849,8 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
         for (auto coulombType : coulombIter)
         {
             opt.coulombType = coulombType;
-            for (int halfLJ = 0; halfLJ <= 1; halfLJ++)
+            // The GPU kernels do not have a half-LJ optimization
+            for (int halfLJ = 0; halfLJ <= (options.useGpu ? 0 : 1); halfLJ++)
             {
                 opt.useHalfLJOptimization = (halfLJ == 1);
 
@@ -447,29 +870,36 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
     }
     GMX_RELEASE_ASSERT(!optionsList.empty(), "Expect at least on benchmark setup");
 
+    if (deviceInfo != nullptr)
+    {
+        fprintf(stdout, "GPU:                  %s\n", getDeviceInformationString(*deviceInfo).c_str());
+    }
 #if GMX_SIMD
-    if (options.nbnxmSimd != BenchMarkKernels::SimdNo)
+    if (!options.useGpu && options.nbnxmSimd != BenchMarkKernels::SimdNo)
     {
         fprintf(stdout, "SIMD width:           %d\n", GMX_SIMD_REAL_WIDTH);
     }
 #endif
     fprintf(stdout, "System size:          %zu atoms\n", system.coordinates.size());
+    fprintf(stdout, "Atom density:         %g atoms/nm^3\n",
+            system.coordinates.size() / det(system.box));
     fprintf(stdout, "Cut-off radius:       %g nm\n", options.pairlistCutoff);
+    if (options.doPrune)
+    {
+        fprintf(stdout, "Outer list cut-off:   %g nm\n", outerPairlistCutoff(options));
+    }
     fprintf(stdout, "Number of threads:    %d\n", options.numThreads);
     fprintf(stdout, "Number of iterations: %d\n", options.numIterations);
     fprintf(stdout, "Compute energies:     %s\n", options.computeVirialAndEnergy ? "yes" : "no");
     if (options.coulombType != BenchMarkCoulomb::ReactionField)
     {
-        fprintf(stdout, "Ewald excl. corr.:    %s\n",
-                options.nbnxmSimd == BenchMarkKernels::SimdNo || options.useTabulatedEwaldCorr
-                        ? "table"
-                        : "analytical");
+        fprintf(stdout, "Ewald excl. corr.:    %s\n", ewaldExclusionName(options));
     }
     printf("\n");
 
     if (options.numWarmupIterations > 0)
     {
-        setupAndRunInstance(system, optionsList[0], true);
+        setupAndRunInstance(system, optionsList[0], deviceStreamManager.get(), true);
     }
 
     if (options.reportTime)
@@ -503,15 +933,34 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
         fprintf(stdout, "                                                total    useful\n");
     }
 
+    std::vector<BenchmarkResult> results;
     for (const auto& optionsInstance : optionsList)
     {
-        setupAndRunInstance(system, optionsInstance, false);
+        results.push_back(*setupAndRunInstance(system, optionsInstance, deviceStreamManager.get(), false));
+    }
+
+    if (options.printSearchAndBufferOps)
+    {
+        printSearchAndBufferOps(options, results);
     }
 
+    printFastestSimdLayout(results);
+
     if (!options.outputFile.empty())
     {
         fclose(system.csv);
     }
+
+    if (!options.jsonOutputFile.empty())
+    {
+        writeJsonReport(options, system, deviceInfo, results);
+    }
+
+    deviceStreamManager.reset();
+    if (deviceInfo != nullptr)
+    {
+        releaseDevice(deviceInfo);
+    }
 }
 
 } // namespace Nbnxm
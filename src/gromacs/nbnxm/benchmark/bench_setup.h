@@ -85,10 +85,14 @@ enum class BenchMarkCoulomb : int
  */
 struct KernelBenchOptions
 {
-    //! Whether to use a GPU, currently GPUs are not supported
+    //! Whether to run the kernels on a GPU
     bool useGpu = false;
+    //! The ID of the GPU to use
+    int gpuId = 0;
     //! The number of OpenMP threads to use
     int numThreads = 1;
+    //! The atom density relative to that of the water box
+    real densityFactor = 1;
     //! The SIMD type for the kernel
     BenchMarkKernels nbnxmSimd = BenchMarkKernels::SimdAuto;
     //! The LJ combination rule
@@ -97,6 +101,10 @@ struct KernelBenchOptions
     bool useHalfLJOptimization = false;
     //! The pairlist and interaction cut-off
     real pairlistCutoff = 1.0;
+    //! Whether to also run the dynamic pruning kernel
+    bool doPrune = false;
+    //! The buffer of the outer pairlist with respect to the cut-off with dynamic pruning
+    real pruneBuffer = 0.1;
     //! The Coulomb Ewald coefficient
     real ewaldcoeff_q = 0;
     //! Whether to compute energies (shift forces for virial are always computed on CPU)
@@ -117,17 +125,22 @@ struct KernelBenchOptions
     bool cyclesPerPair = false;
     //! Report in micro seconds instead of cycles
     bool reportTime = false;
+    //! Also print the timings of the pair search and the buffer operations
+    bool printSearchAndBufferOps = false;
     //! Also report into a csv file
     std::string outputFile;
+    //! Also report into a JSON file
+    std::string jsonOutputFile;
 };
 
 /*! \brief
  * Sets up and runs one or more Nbnxm kernel benchmarks
  *
  * The simulated system is a box of 1000 SPC/E water molecules scaled
- * by the factor \p sizeFactor, which has to be a power of 2.
+ * by the factor \p sizeFactor, which has to be a positive integer.
  * One or more benchmarks are run, as specified by \p options.
- * Benchmark settings and timings are printed to stdout.
+ * Benchmark settings and timings are printed to stdout and,
+ * when requested, written to csv and JSON files.
  *
  * \param[in] sizeFactor How much should the system size be increased.
  * \param[in] options How the benchmark will be run.
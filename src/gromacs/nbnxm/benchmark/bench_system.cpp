@@ -45,6 +45,7 @@
 
 #include "bench_system.h"
 
+#include <cmath>
 #include <numeric>
 #include <vector>
 
@@ -85,13 +86,14 @@ constexpr real c12Oxygen = 2.634129e-06;
 
 //! Generates coordinates and a box for the base system scaled by \p multiplicationFactor
 //
-// The parameter \p multiplicationFactor should be a power of 2.
-// A fatal error is generated when this is not the case.
+// The prime factors of \p multiplicationFactor are distributed over the dimensions
+// such that the stacked box is as close to cubic as possible.
+// A fatal error is generated when \p multiplicationFactor is not positive.
 static void generateCoordinates(int multiplicationFactor, std::vector<gmx::RVec>* coordinates, matrix box)
 {
-    if (multiplicationFactor < 1 || (multiplicationFactor & (multiplicationFactor - 1)) != 0)
+    if (multiplicationFactor < 1)
     {
-        gmx_fatal(FARGS, "The size factor has to be a power of 2");
+        gmx_fatal(FARGS, "The size factor has to be a positive integer");
     }
 
     if (multiplicationFactor == 1)
@@ -102,18 +104,29 @@ static void generateCoordinates(int multiplicationFactor, std::vector<gmx::RVec>
         return;
     }
 
-    ivec factors = { 1, 1, 1 };
+    std::vector<int> primeFactors;
+    for (int factor = 2; multiplicationFactor > 1; factor++)
+    {
+        while (multiplicationFactor % factor == 0)
+        {
+            primeFactors.push_back(factor);
+            multiplicationFactor /= factor;
+        }
+    }
 
-    int dim = 0;
-    while (multiplicationFactor > 1)
+    // Assign the largest factors first, each to the currently shortest dimension
+    ivec factors = { 1, 1, 1 };
+    for (auto factor = primeFactors.rbegin(); factor != primeFactors.rend(); ++factor)
     {
-        factors[dim] *= 2;
-        multiplicationFactor /= 2;
-        dim++;
-        if (dim == DIM)
+        int dimWithMinFactor = XX;
+        for (int dim = YY; dim < DIM; dim++)
         {
-            dim = 0;
+            if (factors[dim] < factors[dimWithMinFactor])
+            {
+                dimWithMinFactor = dim;
+            }
         }
+        factors[dimWithMinFactor] *= *factor;
     }
     printf("Stacking a box of %zu atoms %d x %d x %d times\n", coordinates1000.size(), factors[XX],
            factors[YY], factors[ZZ]);
@@ -150,7 +163,19 @@ static void generateCoordinates(int multiplicationFactor, std::vector<gmx::RVec>
     }
 }
 
-BenchmarkSystem::BenchmarkSystem(const int multiplicationFactor, const std::string& outputFile)
+//! Scales the coordinates and the box by \p scalingFactor in all dimensions
+static void scaleCoordinates(real scalingFactor, std::vector<gmx::RVec>* coordinates, matrix box)
+{
+    for (gmx::RVec& x : *coordinates)
+    {
+        x *= scalingFactor;
+    }
+    msmul(box, scalingFactor, box);
+}
+
+BenchmarkSystem::BenchmarkSystem(const int          multiplicationFactor,
+                                 const real         densityFactor,
+                                 const std::string& outputFile)
 {
     numAtomTypes = 2;
     nonbondedParameters.resize(numAtomTypes * numAtomTypes * 2, 0);
@@ -158,6 +183,14 @@ BenchmarkSystem::BenchmarkSystem(const int multiplicationFactor, const std::stri
     nonbondedParameters[1] = c12Oxygen;
 
     generateCoordinates(multiplicationFactor, &coordinates, box);
+    if (densityFactor <= 0)
+    {
+        gmx_fatal(FARGS, "The density factor should be positive");
+    }
+    if (densityFactor != 1)
+    {
+        scaleCoordinates(std::cbrt(1 / densityFactor), &coordinates, box);
+    }
     put_atoms_in_box(PbcType::Xyz, box, coordinates);
 
     int numAtoms = coordinates.size();
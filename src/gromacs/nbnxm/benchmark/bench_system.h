@@ -62,12 +62,14 @@ struct BenchmarkSystem
      *
      * Generates a benchmark system of size \p multiplicationFactor
      * times the base size by stacking cubic boxes of 1000 water molecules
-     * with 3000 atoms total.
+     * with 3000 atoms total. The system is then scaled uniformly such that
+     * the atom density is \p densityFactor times that of the water box.
      *
-     * \param[in] multiplicationFactor  Should be a power of 2, is checked
+     * \param[in] multiplicationFactor  Should be a positive integer, is checked
+     * \param[in] densityFactor         Should be positive, is checked
      * \param[in] outputFile            The name of the csv file to write benchmark results
      */
-    BenchmarkSystem(int multiplicationFactor, const std::string& outputFile);
+    BenchmarkSystem(int multiplicationFactor, real densityFactor, const std::string& outputFile);
 
     //! Number of different atom types in test system.
     int numAtomTypes;
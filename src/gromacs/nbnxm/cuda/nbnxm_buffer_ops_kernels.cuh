@@ -43,6 +43,7 @@
  */
 
 #include "gromacs/gpu_utils/vectype_ops.cuh"
+#include "gromacs/nbnxm/gpu_compact_xq.h"
 #include "gromacs/nbnxm/nbnxm.h"
 
 /*! \brief CUDA kernel for transforming position coordinates from rvec to nbnxm layout.
@@ -117,3 +118,90 @@ static __global__ void nbnxn_gpu_x_to_nbat_x_kernel(int numColumns,
         }
     }
 }
+
+/*! \brief CUDA kernel packing coordinates into the compact j-atom format, see gpu_compact_xq.h
+ *
+ * One thread handles one cluster. The arithmetic matches Nbnxm::packCompactXq().
+ *
+ * \param[in]     numClusters         The number of clusters to pack.
+ * \param[in]     clusterOffset       The first cluster to pack.
+ * \param[in]     gm_xq               Coordinates and charges in nbnxm layout.
+ * \param[in]     gm_atomTypes        Atom type indices, nullptr when not used.
+ * \param[out]    gm_xqCompactRef     Reference points and scales per cluster.
+ * \param[out]    gm_xqCompact        Fixed-point coordinate offsets and types per atom.
+ * \param[out]    gm_qCompact         Charges per atom.
+ */
+static __global__ void nbnxn_gpu_pack_compact_xq_kernel(int numClusters,
+                                                        int clusterOffset,
+                                                        const float4* __restrict__ gm_xq,
+                                                        const int* __restrict__ gm_atomTypes,
+                                                        float4* __restrict__ gm_xqCompactRef,
+                                                        short4* __restrict__ gm_xqCompact,
+                                                        float* __restrict__ gm_qCompact)
+{
+    const int threadIndex = blockIdx.x * blockDim.x + threadIdx.x;
+
+    if (threadIndex < numClusters)
+    {
+        const int cluster   = clusterOffset + threadIndex;
+        const int atomStart = cluster * c_nbnxnGpuClusterSize;
+        const int atomEnd   = atomStart + c_nbnxnGpuClusterSize;
+
+        /* Determine the bounding box of the real atoms, ignoring fillers */
+        float3 lower     = make_float3(0.0f);
+        float3 upper     = make_float3(0.0f);
+        bool   haveAtoms = false;
+        for (int a = atomStart; a < atomEnd; a++)
+        {
+            const float4 xq = gm_xq[a];
+            if (xq.x >= Nbnxm::c_compactXqFillerThreshold)
+            {
+                const float3 x = make_float3(xq.x, xq.y, xq.z);
+                if (haveAtoms)
+                {
+                    lower = make_float3(fminf(lower.x, x.x), fminf(lower.y, x.y), fminf(lower.z, x.z));
+                    upper = make_float3(fmaxf(upper.x, x.x), fmaxf(upper.y, x.y), fmaxf(upper.z, x.z));
+                }
+                else
+                {
+                    lower = x;
+                    upper = x;
+                }
+                haveAtoms = true;
+            }
+        }
+
+        const float3 center     = 0.5f * (lower + upper);
+        const float  halfExtent = fmaxf(fmaxf(0.5f * (upper.x - lower.x), 0.5f * (upper.y - lower.y)),
+                                       0.5f * (upper.z - lower.z));
+        const float  scale      = halfExtent / Nbnxm::c_compactXqMaxOffset;
+        const float  invScale   = (scale > 0 ? 1.0f / scale : 0.0f);
+
+        gm_xqCompactRef[cluster] = make_float4(center.x, center.y, center.z, scale);
+
+        for (int a = atomStart; a < atomEnd; a++)
+        {
+            const float4 xq   = gm_xq[a];
+            const short  type = (gm_atomTypes != nullptr ? gm_atomTypes[a] : 0);
+            short4       compact;
+            if (xq.x >= Nbnxm::c_compactXqFillerThreshold)
+            {
+                const int maxOffset = Nbnxm::c_compactXqMaxOffset;
+
+                compact = make_short4(
+                        min(max(__float2int_rn((xq.x - center.x) * invScale), -maxOffset), maxOffset),
+                        min(max(__float2int_rn((xq.y - center.y) * invScale), -maxOffset), maxOffset),
+                        min(max(__float2int_rn((xq.z - center.z) * invScale), -maxOffset), maxOffset),
+                        type);
+            }
+            else
+            {
+                const short filler = Nbnxm::c_compactXqFillerOffset;
+
+                compact = make_short4(filler, filler, filler, type);
+            }
+            gm_xqCompact[a] = compact;
+            gm_qCompact[a]  = xq.w;
+        }
+    }
+}
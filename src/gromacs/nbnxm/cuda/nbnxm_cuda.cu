@@ -81,7 +81,8 @@
  * - force-only output;
  * - force and energy output;
  * - force-only with pair list pruning;
- * - force and energy output with pair list pruning.
+ * - force and energy output with pair list pruning;
+ * - force-only with compact j-atom coordinates, with and without pruning.
  */
 #define FUNCTION_DECLARATION_ONLY
 /** Force only **/
@@ -101,6 +102,14 @@
 #undef CALC_ENERGIES
 #undef PRUNE_NBL
 
+/*** Compact j-atom coordinate kernels, force only ***/
+#define COMPACT_XQ
+#include "nbnxm_cuda_kernels.cuh"
+#define PRUNE_NBL
+#include "nbnxm_cuda_kernels.cuh"
+#undef PRUNE_NBL
+#undef COMPACT_XQ
+
 /* Prune-only kernels */
 #include "nbnxm_cuda_kernel_pruneonly.cuh"
 #undef FUNCTION_DECLARATION_ONLY
@@ -111,6 +120,8 @@
 #    include "nbnxm_cuda_kernel_F_prune.cu"
 #    include "nbnxm_cuda_kernel_VF_noprune.cu"
 #    include "nbnxm_cuda_kernel_VF_prune.cu"
+#    include "nbnxm_cuda_kernel_F_noprune_compact.cu"
+#    include "nbnxm_cuda_kernel_F_prune_compact.cu"
 #    include "nbnxm_cuda_kernel_pruneonly.cu"
 #endif /* GMX_CUDA_NB_SINGLE_COMPILATION_UNIT */
 
@@ -124,6 +135,60 @@ constexpr static int c_bufOpsThreadsPerBlock = 128;
 /*! Nonbonded kernel function pointer type */
 typedef void (*nbnxn_cu_kfunc_ptr_t)(const cu_atomdata_t, const NBParamGpu, const gpu_plist, bool);
 
+/*! \brief Packs the coordinates of locality \p iloc into the compact j-atom format
+ *
+ * The non-local kernel also reads the local compact data, so the non-local
+ * stream waits for the local packing to complete.
+ */
+static void launchPackCompactXq(NbnxmGpu* nb, const InteractionLocality iloc)
+{
+    cu_atomdata_t*      adat         = nb->atdat;
+    const DeviceStream& deviceStream = *nb->deviceStreams[iloc];
+
+    const int clusterOffset =
+            (iloc == InteractionLocality::Local ? 0 : adat->natoms_local / c_nbnxnGpuClusterSize);
+    const int clusterEnd = (iloc == InteractionLocality::Local ? adat->natoms_local : adat->natoms)
+                           / c_nbnxnGpuClusterSize;
+    const int numClusters = clusterEnd - clusterOffset;
+
+    if (numClusters > 0)
+    {
+        KernelLaunchConfig config;
+        config.blockSize[0]     = c_bufOpsThreadsPerBlock;
+        config.blockSize[1]     = 1;
+        config.blockSize[2]     = 1;
+        config.gridSize[0]      = (numClusters + c_bufOpsThreadsPerBlock - 1) / c_bufOpsThreadsPerBlock;
+        config.gridSize[1]      = 1;
+        config.gridSize[2]      = 1;
+        config.sharedMemorySize = 0;
+
+        const auto    kernelFn   = nbnxn_gpu_pack_compact_xq_kernel;
+        const float4* d_xq       = adat->xq;
+        const int*    d_types    = (useLjCombRule(nb->nbparam->vdwType) ? nullptr : adat->atom_types);
+        float4*       d_ref      = adat->xqCompactRef;
+        short4*       d_compact  = adat->xqCompact;
+        float*        d_q        = adat->qCompact;
+        const auto    kernelArgs = prepareGpuKernelArguments(kernelFn, config, &numClusters,
+                                                          &clusterOffset, &d_xq, &d_types, &d_ref,
+                                                          &d_compact, &d_q);
+        launchGpuKernel(kernelFn, config, deviceStream, nullptr, "PackCompactXq", kernelArgs);
+    }
+
+    if (nb->bUseTwoStreams)
+    {
+        if (iloc == InteractionLocality::Local)
+        {
+            cudaError_t stat = cudaEventRecord(nb->compactXqLocalDone, deviceStream.stream());
+            CU_RET_ERR(stat, "cudaEventRecord on compactXqLocalDone failed");
+        }
+        else
+        {
+            cudaError_t stat = cudaStreamWaitEvent(deviceStream.stream(), nb->compactXqLocalDone, 0);
+            CU_RET_ERR(stat, "cudaStreamWaitEvent on compactXqLocalDone failed");
+        }
+    }
+}
+
 /*********************************/
 
 /*! Returns the number of blocks to be used for the nonbonded GPU kernel. */
@@ -281,11 +346,70 @@ static const nbnxn_cu_kfunc_ptr_t nb_kfunc_ener_prune_ptr[c_numElecTypes][c_numV
       nbnxn_kernel_ElecEwTwinCut_VdwLJEwCombLB_VF_prune_cuda }
 };
 
+/*! Force-only kernel function pointers using compact j-atom coordinates. */
+static const nbnxn_cu_kfunc_ptr_t nb_kfunc_noener_noprune_compact_ptr[c_numElecTypes][c_numVdwTypes] = {
+    { nbnxn_kernel_ElecCut_VdwLJ_F_compact_cuda, nbnxn_kernel_ElecCut_VdwLJCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecCut_VdwLJCombLB_F_compact_cuda, nbnxn_kernel_ElecCut_VdwLJFsw_F_compact_cuda,
+      nbnxn_kernel_ElecCut_VdwLJPsw_F_compact_cuda, nbnxn_kernel_ElecCut_VdwLJEwCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecCut_VdwLJEwCombLB_F_compact_cuda },
+    { nbnxn_kernel_ElecRF_VdwLJ_F_compact_cuda, nbnxn_kernel_ElecRF_VdwLJCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecRF_VdwLJCombLB_F_compact_cuda, nbnxn_kernel_ElecRF_VdwLJFsw_F_compact_cuda,
+      nbnxn_kernel_ElecRF_VdwLJPsw_F_compact_cuda, nbnxn_kernel_ElecRF_VdwLJEwCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecRF_VdwLJEwCombLB_F_compact_cuda },
+    { nbnxn_kernel_ElecEwQSTab_VdwLJ_F_compact_cuda, nbnxn_kernel_ElecEwQSTab_VdwLJCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecEwQSTab_VdwLJCombLB_F_compact_cuda, nbnxn_kernel_ElecEwQSTab_VdwLJFsw_F_compact_cuda,
+      nbnxn_kernel_ElecEwQSTab_VdwLJPsw_F_compact_cuda, nbnxn_kernel_ElecEwQSTab_VdwLJEwCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecEwQSTab_VdwLJEwCombLB_F_compact_cuda },
+    { nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJ_F_compact_cuda, nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJCombLB_F_compact_cuda, nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJFsw_F_compact_cuda,
+      nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJPsw_F_compact_cuda, nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJEwCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJEwCombLB_F_compact_cuda },
+    { nbnxn_kernel_ElecEw_VdwLJ_F_compact_cuda, nbnxn_kernel_ElecEw_VdwLJCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecEw_VdwLJCombLB_F_compact_cuda, nbnxn_kernel_ElecEw_VdwLJFsw_F_compact_cuda,
+      nbnxn_kernel_ElecEw_VdwLJPsw_F_compact_cuda, nbnxn_kernel_ElecEw_VdwLJEwCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecEw_VdwLJEwCombLB_F_compact_cuda },
+    { nbnxn_kernel_ElecEwTwinCut_VdwLJ_F_compact_cuda, nbnxn_kernel_ElecEwTwinCut_VdwLJCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecEwTwinCut_VdwLJCombLB_F_compact_cuda, nbnxn_kernel_ElecEwTwinCut_VdwLJFsw_F_compact_cuda,
+      nbnxn_kernel_ElecEwTwinCut_VdwLJPsw_F_compact_cuda, nbnxn_kernel_ElecEwTwinCut_VdwLJEwCombGeom_F_compact_cuda,
+      nbnxn_kernel_ElecEwTwinCut_VdwLJEwCombLB_F_compact_cuda }
+};
+
+/*! Force + pruning kernel function pointers using compact j-atom coordinates. */
+static const nbnxn_cu_kfunc_ptr_t nb_kfunc_noener_prune_compact_ptr[c_numElecTypes][c_numVdwTypes] = {
+    { nbnxn_kernel_ElecCut_VdwLJ_F_prune_compact_cuda, nbnxn_kernel_ElecCut_VdwLJCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecCut_VdwLJCombLB_F_prune_compact_cuda, nbnxn_kernel_ElecCut_VdwLJFsw_F_prune_compact_cuda,
+      nbnxn_kernel_ElecCut_VdwLJPsw_F_prune_compact_cuda, nbnxn_kernel_ElecCut_VdwLJEwCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecCut_VdwLJEwCombLB_F_prune_compact_cuda },
+    { nbnxn_kernel_ElecRF_VdwLJ_F_prune_compact_cuda, nbnxn_kernel_ElecRF_VdwLJCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecRF_VdwLJCombLB_F_prune_compact_cuda, nbnxn_kernel_ElecRF_VdwLJFsw_F_prune_compact_cuda,
+      nbnxn_kernel_ElecRF_VdwLJPsw_F_prune_compact_cuda, nbnxn_kernel_ElecRF_VdwLJEwCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecRF_VdwLJEwCombLB_F_prune_compact_cuda },
+    { nbnxn_kernel_ElecEwQSTab_VdwLJ_F_prune_compact_cuda, nbnxn_kernel_ElecEwQSTab_VdwLJCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwQSTab_VdwLJCombLB_F_prune_compact_cuda, nbnxn_kernel_ElecEwQSTab_VdwLJFsw_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwQSTab_VdwLJPsw_F_prune_compact_cuda, nbnxn_kernel_ElecEwQSTab_VdwLJEwCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwQSTab_VdwLJEwCombLB_F_prune_compact_cuda },
+    { nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJ_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJCombLB_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJFsw_F_prune_compact_cuda, nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJPsw_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJEwCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwQSTabTwinCut_VdwLJEwCombLB_F_prune_compact_cuda },
+    { nbnxn_kernel_ElecEw_VdwLJ_F_prune_compact_cuda, nbnxn_kernel_ElecEw_VdwLJCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEw_VdwLJCombLB_F_prune_compact_cuda, nbnxn_kernel_ElecEw_VdwLJFsw_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEw_VdwLJPsw_F_prune_compact_cuda, nbnxn_kernel_ElecEw_VdwLJEwCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEw_VdwLJEwCombLB_F_prune_compact_cuda },
+    { nbnxn_kernel_ElecEwTwinCut_VdwLJ_F_prune_compact_cuda, nbnxn_kernel_ElecEwTwinCut_VdwLJCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwTwinCut_VdwLJCombLB_F_prune_compact_cuda, nbnxn_kernel_ElecEwTwinCut_VdwLJFsw_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwTwinCut_VdwLJPsw_F_prune_compact_cuda, nbnxn_kernel_ElecEwTwinCut_VdwLJEwCombGeom_F_prune_compact_cuda,
+      nbnxn_kernel_ElecEwTwinCut_VdwLJEwCombLB_F_prune_compact_cuda }
+};
+
 /*! Return a pointer to the kernel version to be executed at the current step. */
 static inline nbnxn_cu_kfunc_ptr_t select_nbnxn_kernel(enum ElecType           elecType,
                                                        enum VdwType            vdwType,
                                                        bool                    bDoEne,
                                                        bool                    bDoPrune,
+                                                       bool                    bUseCompactXq,
                                                        const DeviceInformation gmx_unused* deviceInfo)
 {
     const int elecTypeIdx = static_cast<int>(elecType);
@@ -314,6 +438,17 @@ static inline nbnxn_cu_kfunc_ptr_t select_nbnxn_kernel(enum ElecType           e
             return nb_kfunc_ener_noprune_ptr[elecTypeIdx][vdwTypeIdx];
         }
     }
+    else if (bUseCompactXq)
+    {
+        if (bDoPrune)
+        {
+            return nb_kfunc_noener_prune_compact_ptr[elecTypeIdx][vdwTypeIdx];
+        }
+        else
+        {
+            return nb_kfunc_noener_noprune_compact_ptr[elecTypeIdx][vdwTypeIdx];
+        }
+    }
     else
     {
         if (bDoPrune)
@@ -330,7 +465,9 @@ static inline nbnxn_cu_kfunc_ptr_t select_nbnxn_kernel(enum ElecType           e
 /*! \brief Calculates the amount of shared memory required by the nonbonded kernel in use. */
 static inline int calc_shmem_required_nonbonded(const int               num_threads_z,
                                                 const DeviceInformation gmx_unused* deviceInfo,
-                                                const NBParamGpu*                   nbp)
+                                                const NBParamGpu*                   nbp,
+                                                const int                           numEnergyGroups,
+                                                const bool                          computeEnergy)
 {
     int shmem;
 
@@ -354,6 +491,14 @@ static inline int calc_shmem_required_nonbonded(const int               num_thre
         shmem += c_nbnxnGpuNumClusterPerSupercluster * c_clSize * sizeof(int);
     }
 
+    if (computeEnergy && numEnergyGroups > 1)
+    {
+        /* i-atom energy groups in shared memory */
+        shmem += c_nbnxnGpuNumClusterPerSupercluster * c_clSize * sizeof(int);
+        /* LJ and electrostatic energy group-pair accumulation buffers */
+        shmem += 2 * numEnergyGroups * numEnergyGroups * sizeof(float);
+    }
+
     return shmem;
 }
 
@@ -515,6 +660,13 @@ void gpu_launch_kernel(NbnxmGpu* nb, const gmx::StepWorkload& stepWork, const In
         gpu_launch_kernel_pruneonly(nb, iloc, 1);
     }
 
+    /* The compact format is only used by the force-only kernels */
+    const bool useCompactXq = (nb->useCompactXq && !stepWork.computeEnergy);
+    if (useCompactXq)
+    {
+        launchPackCompactXq(nb, iloc);
+    }
+
     if (plist->nsci == 0)
     {
         /* Don't launch an empty local kernel (not allowed with CUDA) */
@@ -546,7 +698,8 @@ void gpu_launch_kernel(NbnxmGpu* nb, const gmx::StepWorkload& stepWork, const In
     config.blockSize[2] = num_threads_z;
     config.gridSize[0]  = nblock;
     config.sharedMemorySize =
-            calc_shmem_required_nonbonded(num_threads_z, &nb->deviceContext_->deviceInfo(), nbp);
+            calc_shmem_required_nonbonded(num_threads_z, &nb->deviceContext_->deviceInfo(), nbp,
+                                          adat->numEnergyGroups, stepWork.computeEnergy);
 
     if (debug)
     {
@@ -563,7 +716,7 @@ void gpu_launch_kernel(NbnxmGpu* nb, const gmx::StepWorkload& stepWork, const In
     const auto kernel =
             select_nbnxn_kernel(nbp->elecType, nbp->vdwType, stepWork.computeEnergy,
                                 (plist->haveFreshList && !nb->timers->interaction[iloc].didPrune),
-                                &nb->deviceContext_->deviceInfo());
+                                useCompactXq, &nb->deviceContext_->deviceInfo());
     const auto kernelArgs =
             prepareGpuKernelArguments(kernel, config, adat, nbp, plist, &stepWork.computeVirial);
     launchGpuKernel(kernel, config, deviceStream, timingEvent, "k_calc_nb", kernelArgs);
@@ -796,13 +949,13 @@ void gpu_launch_cpyback(NbnxmGpu*                nb,
         {
             static_assert(sizeof(nb->nbst.e_lj[0]) == sizeof(adat->e_lj[0]),
                           "Sizes of host- and device-side LJ energy terms should be the same.");
-            copyFromDeviceBuffer(nb->nbst.e_lj, &adat->e_lj, 0, 1, deviceStream,
-                                 GpuApiCallBehavior::Async, nullptr);
+            copyFromDeviceBuffer(nb->nbst.e_lj, &adat->e_lj, 0, nb->nbst.numEnergyGroupPairs,
+                                 deviceStream, GpuApiCallBehavior::Async, nullptr);
             static_assert(sizeof(nb->nbst.e_el[0]) == sizeof(adat->e_el[0]),
                           "Sizes of host- and device-side electrostatic energy terms should be the "
                           "same.");
-            copyFromDeviceBuffer(nb->nbst.e_el, &adat->e_el, 0, 1, deviceStream,
-                                 GpuApiCallBehavior::Async, nullptr);
+            copyFromDeviceBuffer(nb->nbst.e_el, &adat->e_el, 0, nb->nbst.numEnergyGroupPairs,
+                                 deviceStream, GpuApiCallBehavior::Async, nullptr);
         }
     }
 
@@ -824,6 +977,8 @@ void cuda_set_cacheconfig()
             cudaFuncSetCacheConfig(nb_kfunc_ener_prune_ptr[i][j], cudaFuncCachePreferEqual);
             cudaFuncSetCacheConfig(nb_kfunc_ener_noprune_ptr[i][j], cudaFuncCachePreferEqual);
             cudaFuncSetCacheConfig(nb_kfunc_noener_prune_ptr[i][j], cudaFuncCachePreferEqual);
+            cudaFuncSetCacheConfig(nb_kfunc_noener_prune_compact_ptr[i][j], cudaFuncCachePreferEqual);
+            cudaFuncSetCacheConfig(nb_kfunc_noener_noprune_compact_ptr[i][j], cudaFuncCachePreferEqual);
             stat = cudaFuncSetCacheConfig(nb_kfunc_noener_noprune_ptr[i][j], cudaFuncCachePreferEqual);
             CU_RET_ERR(stat, "cudaFuncSetCacheConfig failed");
         }
@@ -63,6 +63,7 @@
 #include "gromacs/mdtypes/interaction_const.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/gpu_compact_xq.h"
 #include "gromacs/nbnxm/gpu_data_mgmt.h"
 #include "gromacs/nbnxm/gridset.h"
 #include "gromacs/nbnxm/nbnxm.h"
@@ -97,20 +98,25 @@ static void nbnxn_cuda_clear_e_fshift(NbnxmGpu* nb);
 
 /*! Initializes the atomdata structure first time, it only gets filled at
     pair-search. */
-static void init_atomdata_first(cu_atomdata_t* ad, int ntypes, const DeviceContext& deviceContext)
+static void init_atomdata_first(cu_atomdata_t*       ad,
+                                int                  ntypes,
+                                int                  numEnergyGroups,
+                                const DeviceContext& deviceContext)
 {
     ad->ntypes = ntypes;
     allocateDeviceBuffer(&ad->shift_vec, SHIFTS, deviceContext);
     ad->bShiftVecUploaded = false;
 
+    ad->numEnergyGroups = numEnergyGroups;
     allocateDeviceBuffer(&ad->fshift, SHIFTS, deviceContext);
-    allocateDeviceBuffer(&ad->e_lj, 1, deviceContext);
-    allocateDeviceBuffer(&ad->e_el, 1, deviceContext);
+    allocateDeviceBuffer(&ad->e_lj, numEnergyGroups * numEnergyGroups, deviceContext);
+    allocateDeviceBuffer(&ad->e_el, numEnergyGroups * numEnergyGroups, deviceContext);
 
     /* initialize to nullptr poiters to data that is not allocated here and will
        need reallocation in nbnxn_cuda_init_atomdata */
-    ad->xq = nullptr;
-    ad->f  = nullptr;
+    ad->xq           = nullptr;
+    ad->f            = nullptr;
+    ad->energyGroups = nullptr;
 
     /* size -1 indicates that the respective array hasn't been initialized yet */
     ad->natoms = -1;
@@ -169,7 +175,7 @@ static void cuda_init_const(NbnxmGpu*                       nb,
                             const PairlistParams&           listParams,
                             const nbnxn_atomdata_t::Params& nbatParams)
 {
-    init_atomdata_first(nb->atdat, nbatParams.numTypes, *nb->deviceContext_);
+    init_atomdata_first(nb->atdat, nbatParams.numTypes, nbatParams.nenergrp, *nb->deviceContext_);
     init_nbparam(nb->nbparam, ic, listParams, nbatParams, *nb->deviceContext_);
 
     /* clear energy and shift force outputs */
@@ -200,8 +206,11 @@ NbnxmGpu* gpu_init(const gmx::DeviceStreamManager& deviceStreamManager,
     snew(nb->timings, 1);
 
     /* init nbst */
-    pmalloc((void**)&nb->nbst.e_lj, sizeof(*nb->nbst.e_lj));
-    pmalloc((void**)&nb->nbst.e_el, sizeof(*nb->nbst.e_el));
+    GMX_RELEASE_ASSERT(nbat->params().nenergrp <= c_nbnxnGpuMaxNumEnergyGroups,
+                       "The CUDA kernels support a limited number of energy groups");
+    nb->nbst.numEnergyGroupPairs = nbat->params().nenergrp * nbat->params().nenergrp;
+    pmalloc((void**)&nb->nbst.e_lj, nb->nbst.numEnergyGroupPairs * sizeof(*nb->nbst.e_lj));
+    pmalloc((void**)&nb->nbst.e_el, nb->nbst.numEnergyGroupPairs * sizeof(*nb->nbst.e_el));
     pmalloc((void**)&nb->nbst.fshift, SHIFTS * sizeof(*nb->nbst.fshift));
 
     init_plist(nb->plist[InteractionLocality::Local]);
@@ -232,6 +241,8 @@ NbnxmGpu* gpu_init(const gmx::DeviceStreamManager& deviceStreamManager,
     CU_RET_ERR(stat, "cudaEventCreate on nonlocal_done failed");
     stat = cudaEventCreateWithFlags(&nb->misc_ops_and_local_H2D_done, cudaEventDisableTiming);
     CU_RET_ERR(stat, "cudaEventCreate on misc_ops_and_local_H2D_done failed");
+    stat = cudaEventCreateWithFlags(&nb->compactXqLocalDone, cudaEventDisableTiming);
+    CU_RET_ERR(stat, "cudaEventCreate on compactXqLocalDone failed");
 
     nb->xNonLocalCopyD2HDone = new GpuEventSynchronizer();
 
@@ -241,6 +252,10 @@ NbnxmGpu* gpu_init(const gmx::DeviceStreamManager& deviceStreamManager,
     // TODO: Consider turning on by default when we can detect nr of streams.
     nb->bDoTime = (getenv("GMX_ENABLE_GPU_TIMING") != nullptr);
 
+    /* The type index is stored as a 16-bit integer in the compact format */
+    nb->useCompactXq = (getenv("GMX_GPU_NB_COMPACT_XQ") != nullptr
+                        && nbat->params().numTypes <= c_compactXqMaxNumTypes);
+
     if (nb->bDoTime)
     {
         init_timings(nb->timings);
@@ -298,8 +313,8 @@ static void nbnxn_cuda_clear_e_fshift(NbnxmGpu* nb)
     const DeviceStream& localStream = *nb->deviceStreams[InteractionLocality::Local];
 
     clearDeviceBufferAsync(&adat->fshift, 0, SHIFTS, localStream);
-    clearDeviceBufferAsync(&adat->e_lj, 0, 1, localStream);
-    clearDeviceBufferAsync(&adat->e_el, 0, 1, localStream);
+    clearDeviceBufferAsync(&adat->e_lj, 0, nb->nbst.numEnergyGroupPairs, localStream);
+    clearDeviceBufferAsync(&adat->e_el, 0, nb->nbst.numEnergyGroupPairs, localStream);
 }
 
 void gpu_clear_outputs(NbnxmGpu* nb, bool computeVirial)
@@ -345,6 +360,10 @@ void gpu_init_atomdata(NbnxmGpu* nb, const nbnxn_atomdata_t* nbat)
             freeDeviceBuffer(&d_atdat->xq);
             freeDeviceBuffer(&d_atdat->atom_types);
             freeDeviceBuffer(&d_atdat->lj_comb);
+            freeDeviceBuffer(&d_atdat->xqCompact);
+            freeDeviceBuffer(&d_atdat->qCompact);
+            freeDeviceBuffer(&d_atdat->xqCompactRef);
+            freeDeviceBuffer(&d_atdat->energyGroups);
         }
 
         allocateDeviceBuffer(&d_atdat->f, nalloc, deviceContext);
@@ -357,6 +376,16 @@ void gpu_init_atomdata(NbnxmGpu* nb, const nbnxn_atomdata_t* nbat)
         {
             allocateDeviceBuffer(&d_atdat->atom_types, nalloc, deviceContext);
         }
+        if (nb->useCompactXq)
+        {
+            allocateDeviceBuffer(&d_atdat->xqCompact, nalloc, deviceContext);
+            allocateDeviceBuffer(&d_atdat->qCompact, nalloc, deviceContext);
+            allocateDeviceBuffer(&d_atdat->xqCompactRef, nalloc / c_nbnxnGpuClusterSize + 1, deviceContext);
+        }
+        if (d_atdat->numEnergyGroups > 1)
+        {
+            allocateDeviceBuffer(&d_atdat->energyGroups, nalloc, deviceContext);
+        }
 
         d_atdat->nalloc = nalloc;
         realloced       = true;
@@ -387,6 +416,13 @@ void gpu_init_atomdata(NbnxmGpu* nb, const nbnxn_atomdata_t* nbat)
                            GpuApiCallBehavior::Async, nullptr);
     }
 
+    if (d_atdat->numEnergyGroups > 1)
+    {
+        /* With GPU lists nbat stores the energy group index per atom */
+        copyToDeviceBuffer(&d_atdat->energyGroups, nbat->params().energrp.data(), 0, natoms,
+                           localStream, GpuApiCallBehavior::Async, nullptr);
+    }
+
     if (bDoTime)
     {
         timers->atdat.closeTimingRegion(localStream);
@@ -417,6 +453,8 @@ void gpu_free(NbnxmGpu* nb)
     CU_RET_ERR(stat, "cudaEventDestroy failed on timers->nonlocal_done");
     stat = cudaEventDestroy(nb->misc_ops_and_local_H2D_done);
     CU_RET_ERR(stat, "cudaEventDestroy failed on timers->misc_ops_and_local_H2D_done");
+    stat = cudaEventDestroy(nb->compactXqLocalDone);
+    CU_RET_ERR(stat, "cudaEventDestroy failed on compactXqLocalDone");
 
     delete nb->timers;
 
@@ -440,6 +478,10 @@ void gpu_free(NbnxmGpu* nb)
     freeDeviceBuffer(&atdat->xq);
     freeDeviceBuffer(&atdat->atom_types);
     freeDeviceBuffer(&atdat->lj_comb);
+    freeDeviceBuffer(&atdat->energyGroups);
+    freeDeviceBuffer(&atdat->xqCompact);
+    freeDeviceBuffer(&atdat->qCompact);
+    freeDeviceBuffer(&atdat->xqCompactRef);
 
     /* Free plist */
     auto* plist = nb->plist[InteractionLocality::Local];
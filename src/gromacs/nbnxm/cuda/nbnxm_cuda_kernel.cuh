@@ -76,6 +76,10 @@
 #    define LJ_EWALD
 #endif
 
+#if defined COMPACT_XQ && defined CALC_ENERGIES
+#    error "The compact j-atom coordinate format is only supported in force-only kernels"
+#endif
+
 #if defined LJ_COMB_GEOM || defined LJ_COMB_LB
 #    define LJ_COMB
 #endif
@@ -148,12 +152,16 @@ __launch_bounds__(THREADS_PER_BLOCK)
 #ifdef PRUNE_NBL
 #    ifdef CALC_ENERGIES
         __global__ void NB_KERNEL_FUNC_NAME(nbnxn_kernel, _VF_prune_cuda)
+#    elif defined COMPACT_XQ
+        __global__ void NB_KERNEL_FUNC_NAME(nbnxn_kernel, _F_prune_compact_cuda)
 #    else
         __global__ void NB_KERNEL_FUNC_NAME(nbnxn_kernel, _F_prune_cuda)
 #    endif /* CALC_ENERGIES */
 #else
 #    ifdef CALC_ENERGIES
         __global__ void NB_KERNEL_FUNC_NAME(nbnxn_kernel, _VF_cuda)
+#    elif defined COMPACT_XQ
+        __global__ void NB_KERNEL_FUNC_NAME(nbnxn_kernel, _F_compact_cuda)
 #    else
         __global__ void NB_KERNEL_FUNC_NAME(nbnxn_kernel, _F_cuda)
 #    endif /* CALC_ENERGIES */
@@ -178,6 +186,13 @@ __launch_bounds__(THREADS_PER_BLOCK)
     float2        ljcp_i, ljcp_j;
 #    endif
     const float4*        xq          = atdat.xq;
+#    ifdef COMPACT_XQ
+    const float4*        xqCompactRef = atdat.xqCompactRef;
+    const short4*        xqCompact    = atdat.xqCompact;
+    const float*         qCompact     = atdat.qCompact;
+    float4               xqRefBuf;
+    short4               xqCompactBuf;
+#    endif
     float3*              f           = atdat.f;
     const float3*        shift_vec   = atdat.shift_vec;
     float                rcoulomb_sq = nbparam.rcoulomb_sq;
@@ -208,6 +223,10 @@ __launch_bounds__(THREADS_PER_BLOCK)
 #        endif /* EL_EWALD_ANY */
     float*               e_lj        = atdat.e_lj;
     float*               e_el        = atdat.e_el;
+    const int            numEnergyGroups = atdat.numEnergyGroups;
+    const int*           energyGroups    = atdat.energyGroups;
+    /* With multiple energy groups the energies are accumulated per group pair in shared memory */
+    const bool           useEnergyGroups = (numEnergyGroups > 1);
 #    endif     /* CALC_ENERGIES */
 
     /* thread/block/warp id-s */
@@ -236,7 +255,8 @@ __launch_bounds__(THREADS_PER_BLOCK)
 #    endif
     float        int_bit, F_invr;
 #    ifdef CALC_ENERGIES
-    float        E_lj, E_el;
+    float        E_lj, E_el, E_el_p;
+    int          egj;
 #    endif
 #    if defined CALC_ENERGIES || defined LJ_POT_SWITCH
     float        E_lj_p;
@@ -279,6 +299,23 @@ __launch_bounds__(THREADS_PER_BLOCK)
     float2* ljcpib = (float2*)sm_nextSlotPtr;
     sm_nextSlotPtr += (c_nbnxnGpuNumClusterPerSupercluster * c_clSize * sizeof(*ljcpib));
 #    endif
+
+#    ifdef CALC_ENERGIES
+    /* shmem buffers for i-atom energy group pre-loading and for the LJ and
+     * electrostatic energy group-pair sums, only present with energy groups */
+    int*   egib        = nullptr;
+    float* sm_eGroupLJ = nullptr;
+    float* sm_eGroupEl = nullptr;
+    if (useEnergyGroups)
+    {
+        egib = (int*)sm_nextSlotPtr;
+        sm_nextSlotPtr += (c_nbnxnGpuNumClusterPerSupercluster * c_clSize * sizeof(*egib));
+        sm_eGroupLJ = (float*)sm_nextSlotPtr;
+        sm_nextSlotPtr += (numEnergyGroups * numEnergyGroups * sizeof(*sm_eGroupLJ));
+        sm_eGroupEl = (float*)sm_nextSlotPtr;
+        sm_nextSlotPtr += (numEnergyGroups * numEnergyGroups * sizeof(*sm_eGroupEl));
+    }
+#    endif
     /*********************************************************************/
 
     nb_sci     = pl_sci[bidx];         /* my i super-cluster's index = current bidx */
@@ -304,6 +341,19 @@ __launch_bounds__(THREADS_PER_BLOCK)
         /* Pre-load the LJ combination parameters into shared memory */
         ljcpib[tidxj * c_clSize + tidxi] = lj_comb[ai];
 #    endif
+
+#    ifdef CALC_ENERGIES
+        if (useEnergyGroups)
+        {
+            /* Pre-load the i-atom energy groups and clear the group-pair energies */
+            egib[tidxj * c_clSize + tidxi] = energyGroups[ai];
+            for (i = tidx; i < numEnergyGroups * numEnergyGroups; i += c_clSize * c_clSize)
+            {
+                sm_eGroupLJ[i] = 0.0f;
+                sm_eGroupEl[i] = 0.0f;
+            }
+        }
+#    endif
     }
     __syncthreads();
 
@@ -327,41 +377,61 @@ __launch_bounds__(THREADS_PER_BLOCK)
     if (nb_sci.shift == CENTRAL && pl_cj4[cij4_start].cj[0] == sci * c_nbnxnGpuNumClusterPerSupercluster)
     {
         /* we have the diagonal: add the charge and LJ self interaction energy term */
+
+        /* divide the self term(s) equally over the j-threads, then multiply with the coefficients. */
+        float selfScaleLJ = 0.0f;
+        float selfScaleEl = 0.0f;
+#            ifdef LJ_EWALD
+        selfScaleLJ = 0.5f * c_oneSixth * lje_coeff6_6 / (c_clSize * NTHREAD_Z);
+#            endif
+
+#            if defined EL_EWALD_ANY || defined EL_RF || defined EL_CUTOFF
+        /* Correct for epsfac^2 due to adding qi^2 */
+#                if defined EL_RF || defined EL_CUTOFF
+        selfScaleEl = -0.5f * c_rf / (nbparam.epsfac * c_clSize * NTHREAD_Z);
+#                else
+        /* last factor 1/sqrt(pi) */
+        selfScaleEl = -beta * M_FLOAT_1_SQRTPI / (nbparam.epsfac * c_clSize * NTHREAD_Z);
+#                endif
+#            endif /* EL_EWALD_ANY || defined EL_RF || defined EL_CUTOFF */
+
         for (i = 0; i < c_nbnxnGpuNumClusterPerSupercluster; i++)
         {
+            float E_lj_self = 0.0f;
+            float E_el_self = 0.0f;
 #            if defined EL_EWALD_ANY || defined EL_RF || defined EL_CUTOFF
-            qi = xqib[i * c_clSize + tidxi].w;
-            E_el += qi * qi;
+            qi        = xqib[i * c_clSize + tidxi].w;
+            E_el_self = qi * qi;
 #            endif
 
 #            ifdef LJ_EWALD
 #                if DISABLE_CUDA_TEXTURES
-            E_lj += LDG(&nbparam.nbfp[atom_types[(sci * c_nbnxnGpuNumClusterPerSupercluster + i) * c_clSize + tidxi]
-                                      * (ntypes + 1) * 2]);
+            E_lj_self = LDG(&nbparam.nbfp[atom_types[(sci * c_nbnxnGpuNumClusterPerSupercluster + i) * c_clSize + tidxi]
+                                          * (ntypes + 1) * 2]);
 #                else
-            E_lj += tex1Dfetch<float>(
+            E_lj_self = tex1Dfetch<float>(
                     nbparam.nbfp_texobj,
                     atom_types[(sci * c_nbnxnGpuNumClusterPerSupercluster + i) * c_clSize + tidxi]
                             * (ntypes + 1) * 2);
 #                endif
 #            endif
-        }
 
-        /* divide the self term(s) equally over the j-threads, then multiply with the coefficients. */
-#            ifdef LJ_EWALD
-        E_lj /= c_clSize * NTHREAD_Z;
-        E_lj *= 0.5f * c_oneSixth * lje_coeff6_6;
-#            endif
+            if (useEnergyGroups)
+            {
+                /* the self terms of an atom belong to the diagonal group pair */
+                const int egp = egib[i * c_clSize + tidxi] * (numEnergyGroups + 1);
+                atomicAdd(sm_eGroupLJ + egp, E_lj_self * selfScaleLJ);
+                atomicAdd(sm_eGroupEl + egp, E_el_self * selfScaleEl);
+            }
+            else
+            {
+                E_lj += E_lj_self;
+                E_el += E_el_self;
+            }
+        }
 
-#            if defined EL_EWALD_ANY || defined EL_RF || defined EL_CUTOFF
-        /* Correct for epsfac^2 due to adding qi^2 */
-        E_el /= nbparam.epsfac * c_clSize * NTHREAD_Z;
-#                if defined EL_RF || defined EL_CUTOFF
-        E_el *= -0.5f * c_rf;
-#                else
-        E_el *= -beta * M_FLOAT_1_SQRTPI; /* last factor 1/sqrt(pi) */
-#                endif
-#            endif /* EL_EWALD_ANY || defined EL_RF || defined EL_CUTOFF */
+        E_lj *= selfScaleLJ;
+        E_el *= selfScaleEl;
     }
 #        endif     /* EXCLUSION_FORCES */
 
@@ -406,13 +476,39 @@ __launch_bounds__(THREADS_PER_BLOCK)
                     aj = cj * c_clSize + tidxj;
 
                     /* load j atom data */
+#    ifdef COMPACT_XQ
+                    /* decode the fixed-point offset relative to the cluster reference,
+                     * filler atoms are put far away as in the regular layout */
+                    xqRefBuf     = xqCompactRef[cj];
+                    xqCompactBuf = xqCompact[aj];
+                    if (xqCompactBuf.x == Nbnxm::c_compactXqFillerOffset)
+                    {
+                        xj = make_float3(Nbnxm::c_compactXqFarAway);
+                    }
+                    else
+                    {
+                        xj = make_float3(xqRefBuf.x + xqRefBuf.w * xqCompactBuf.x,
+                                         xqRefBuf.y + xqRefBuf.w * xqCompactBuf.y,
+                                         xqRefBuf.z + xqRefBuf.w * xqCompactBuf.z);
+                    }
+                    qj_f = qCompact[aj];
+#        ifndef LJ_COMB
+                    typej = xqCompactBuf.w;
+#        else
+                    ljcp_j = lj_comb[aj];
+#        endif
+#    else
                     xqbuf = xq[aj];
                     xj    = make_float3(xqbuf.x, xqbuf.y, xqbuf.z);
                     qj_f  = xqbuf.w;
-#    ifndef LJ_COMB
+#        ifndef LJ_COMB
                     typej = atom_types[aj];
-#    else
+#        else
                     ljcp_j = lj_comb[aj];
+#        endif
+#    endif /* COMPACT_XQ */
+#    ifdef CALC_ENERGIES
+                    egj = useEnergyGroups ? energyGroups[aj] : 0;
 #    endif
 
                     fcj_buf = make_float3(0.0f);
@@ -555,11 +651,6 @@ __launch_bounds__(THREADS_PER_BLOCK)
 #        endif
 #    endif /* VDW_CUTOFF_CHECK */
 
-#    ifdef CALC_ENERGIES
-                                E_lj += E_lj_p;
-#    endif
-
-
 #    ifdef EL_CUTOFF
 #        ifdef EXCLUSION_FORCES
                                 F_invr += qi * qj_f * int_bit * inv_r2 * inv_r;
@@ -582,16 +673,30 @@ __launch_bounds__(THREADS_PER_BLOCK)
 
 #    ifdef CALC_ENERGIES
 #        ifdef EL_CUTOFF
-                                E_el += qi * qj_f * (int_bit * inv_r - c_rf);
+                                E_el_p = qi * qj_f * (int_bit * inv_r - c_rf);
 #        endif
 #        ifdef EL_RF
-                                E_el += qi * qj_f * (int_bit * inv_r + 0.5f * two_k_rf * r2 - c_rf);
+                                E_el_p = qi * qj_f * (int_bit * inv_r + 0.5f * two_k_rf * r2 - c_rf);
 #        endif
 #        ifdef EL_EWALD_ANY
                                 /* 1.0f - erff is faster than erfcf */
-                                E_el += qi * qj_f
-                                        * (inv_r * (int_bit - erff(r2 * inv_r * beta)) - int_bit * ewald_shift);
+                                E_el_p = qi * qj_f
+                                         * (inv_r * (int_bit - erff(r2 * inv_r * beta)) - int_bit * ewald_shift);
 #        endif /* EL_EWALD_ANY */
+
+                                if (useEnergyGroups)
+                                {
+                                    /* each group pair is stored once, in the upper triangle */
+                                    const int egi = egib[i * c_clSize + tidxi];
+                                    const int egp = min(egi, egj) * numEnergyGroups + max(egi, egj);
+                                    atomicAdd(sm_eGroupLJ + egp, E_lj_p);
+                                    atomicAdd(sm_eGroupEl + egp, E_el_p);
+                                }
+                                else
+                                {
+                                    E_lj += E_lj_p;
+                                    E_el += E_el_p;
+                                }
 #    endif
                                 f_ij = rv * F_invr;
 
@@ -643,8 +748,22 @@ __launch_bounds__(THREADS_PER_BLOCK)
     }
 
 #    ifdef CALC_ENERGIES
-    /* reduce the energies over warps and store into global memory */
-    reduce_energy_warp_shfl(E_lj, E_el, e_lj, e_el, tidx, c_fullWarpMask);
+    if (useEnergyGroups)
+    {
+        /* add the group-pair energies of this block into global memory */
+        __syncthreads();
+        for (i = tidxz * c_clSize * c_clSize + tidx; i < numEnergyGroups * numEnergyGroups;
+             i += THREADS_PER_BLOCK)
+        {
+            atomicAdd(e_lj + i, sm_eGroupLJ[i]);
+            atomicAdd(e_el + i, sm_eGroupEl[i]);
+        }
+    }
+    else
+    {
+        /* reduce the energies over warps and store into global memory */
+        reduce_energy_warp_shfl(E_lj, E_el, e_lj, e_el, tidx, c_fullWarpMask);
+    }
 #    endif
 }
 #endif /* FUNCTION_DECLARATION_ONLY */
@@ -53,6 +53,7 @@
 #include "gromacs/gpu_utils/cuda_arch_utils.cuh"
 #include "gromacs/gpu_utils/cuda_kernel_utils.cuh"
 #include "gromacs/gpu_utils/vectype_ops.cuh"
+#include "gromacs/nbnxm/gpu_compact_xq.h"
 
 #include "nbnxm_cuda_types.h"
 
@@ -91,10 +91,12 @@ typedef struct cu_atomdata cu_atomdata_t;
  */
 struct nb_staging_t
 {
-    //! LJ energy
+    //! LJ energy, size numEnergyGroupPairs
     float* e_lj = nullptr;
-    //! electrostatic energy
+    //! electrostatic energy, size numEnergyGroupPairs
     float* e_el = nullptr;
+    //! number of energy group pairs, the square of the number of energy groups
+    int numEnergyGroupPairs = 1;
     //! shift forces
     float3* fshift = nullptr;
 };
@@ -116,9 +118,14 @@ struct cu_atomdata
     //! force output array, size natoms
     DeviceBuffer<float3> f;
 
-    //! LJ energy output, size 1
+    //! number of energy groups, 1 when not decomposing the energies over groups
+    int numEnergyGroups;
+    //! energy group indices, size natoms, only used with numEnergyGroups > 1
+    DeviceBuffer<int> energyGroups;
+
+    //! LJ energy output, size numEnergyGroups^2
     DeviceBuffer<float> e_lj;
-    //! Electrostatics energy input, size 1
+    //! Electrostatics energy input, size numEnergyGroups^2
     DeviceBuffer<float> e_el;
 
     //! shift forces
@@ -131,6 +138,13 @@ struct cu_atomdata
     //! sqrt(c6),sqrt(c12) size natoms
     DeviceBuffer<float2> lj_comb;
 
+    //! compact fixed-point coordinate offsets + type index, size natoms, see gpu_compact_xq.h
+    DeviceBuffer<short4> xqCompact;
+    //! charges for the compact format, size natoms
+    DeviceBuffer<float> qCompact;
+    //! reference point + fixed-point scale for the compact format, size natoms / c_clSize
+    DeviceBuffer<float4> xqCompactRef;
+
     //! shifts
     DeviceBuffer<float3> shift_vec;
     //! true if the shift vector has been uploaded
@@ -196,6 +210,9 @@ struct NbnxmGpu
      * x/q H2D, buffer op initialization in local stream that is
      * required also by nonlocal stream ) */
     cudaEvent_t misc_ops_and_local_H2D_done = nullptr;
+    /*! \brief Event triggered when the local coordinates have been
+     * packed into the compact format, needed by the non-local kernel */
+    cudaEvent_t compactXqLocalDone = nullptr;
     /*! \} */
 
     /*! \brief True if there is work for the current domain in the
@@ -218,6 +235,8 @@ struct NbnxmGpu
      * setting bDoTime needs to be change if this CUDA "feature" gets fixed. */
     /*! \brief True if event-based timing is enabled. */
     bool bDoTime = false;
+    /*! \brief True when the force-only kernels use the compact j-atom coordinate format */
+    bool useCompactXq = false;
     /*! \brief CUDA event-based timers. */
     cu_timers_t* timers = nullptr;
     /*! \brief Timing data. TODO: deprecate this and query timers for accumulated data instead */
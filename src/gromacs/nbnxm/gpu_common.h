@@ -55,6 +55,10 @@
 #    include "opencl/nbnxm_ocl_types.h"
 #endif
 
+#if GMX_GPU_SYCL
+#    include "sycl/nbnxm_sycl_types.h"
+#endif
+
 #include "gromacs/gpu_utils/gpu_utils.h"
 #include "gromacs/listed_forces/gpubonded.h"
 #include "gromacs/math/vec.h"
@@ -241,8 +245,8 @@ static void countPruneKernelTime(GpuTimers*                 timers,
  * \param[in]  iLocality      Interaction locality specifier
  * \param[in]  reduceEnergies True if energy reduction should be done
  * \param[in]  reduceFshift   True if shift force reduction should be done
- * \param[out] e_lj           Variable to accumulate LJ energy into
- * \param[out] e_el           Variable to accumulate electrostatic energy into
+ * \param[out] e_lj           Array to accumulate LJ energy into, one element per energy group pair
+ * \param[out] e_el           Array to accumulate electrostatic energy into, one element per group pair
  * \param[out] fshift         Pointer to the array of shift forces to accumulate into
  */
 template<typename StagingData>
@@ -259,8 +263,11 @@ static inline void gpu_reduce_staged_outputs(const StagingData&        nbst,
     {
         if (reduceEnergies)
         {
-            *e_lj += *nbst.e_lj;
-            *e_el += *nbst.e_el;
+            for (int i = 0; i < nbst.numEnergyGroupPairs; i++)
+            {
+                e_lj[i] += nbst.e_lj[i];
+                e_el[i] += nbst.e_el[i];
+            }
         }
 
         if (reduceFshift)
@@ -0,0 +1,130 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ * \brief
+ * Implements the reference packing of the compact GPU coordinate format
+ *
+ * \ingroup module_nbnxm
+ */
+
+#include "gmxpre.h"
+
+#include "gpu_compact_xq.h"
+
+#include <cmath>
+
+#include <algorithm>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace Nbnxm
+{
+
+void packCompactXq(gmx::ArrayRef<const real>                xq,
+                   gmx::ArrayRef<const int>                 types,
+                   const int                                clusterSize,
+                   gmx::ArrayRef<CompactXqClusterReference> references,
+                   gmx::ArrayRef<CompactXqAtom>             atoms)
+{
+    const int numAtoms = atoms.ssize();
+
+    GMX_RELEASE_ASSERT(xq.ssize() == 4 * numAtoms, "xq should be in xyzq format");
+    GMX_RELEASE_ASSERT(types.empty() || types.ssize() == numAtoms,
+                       "We need a type for every atom");
+    GMX_RELEASE_ASSERT(references.ssize() * clusterSize == numAtoms,
+                       "The number of atoms should be a multiple of the cluster size");
+
+    for (int cluster = 0; cluster < references.ssize(); cluster++)
+    {
+        const int atomStart = cluster * clusterSize;
+        const int atomEnd   = atomStart + clusterSize;
+
+        /* Determine the bounding box of the real atoms, ignoring fillers */
+        float lower[DIM] = { 0, 0, 0 };
+        float upper[DIM] = { 0, 0, 0 };
+        bool  haveAtoms  = false;
+        for (int a = atomStart; a < atomEnd; a++)
+        {
+            if (xq[4 * a + XX] >= c_compactXqFillerThreshold)
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    const float x = xq[4 * a + d];
+                    lower[d]      = haveAtoms ? std::min(lower[d], x) : x;
+                    upper[d]      = haveAtoms ? std::max(upper[d], x) : x;
+                }
+                haveAtoms = true;
+            }
+        }
+
+        float center[DIM];
+        float halfExtent = 0;
+        for (int d = 0; d < DIM; d++)
+        {
+            center[d]  = 0.5F * (lower[d] + upper[d]);
+            halfExtent = std::max(halfExtent, 0.5F * (upper[d] - lower[d]));
+        }
+        const float scale    = halfExtent / c_compactXqMaxOffset;
+        const float invScale = (scale > 0 ? 1.0F / scale : 0.0F);
+
+        references[cluster] = { center[XX], center[YY], center[ZZ], scale };
+
+        for (int a = atomStart; a < atomEnd; a++)
+        {
+            int16_t offset[DIM];
+            for (int d = 0; d < DIM; d++)
+            {
+                if (xq[4 * a + XX] >= c_compactXqFillerThreshold)
+                {
+                    const float dx    = static_cast<float>(xq[4 * a + d]) - center[d];
+                    const long  value = std::lrint(dx * invScale);
+                    offset[d]         = static_cast<int16_t>(std::clamp(
+                            value, long(-c_compactXqMaxOffset), long(c_compactXqMaxOffset)));
+                }
+                else
+                {
+                    offset[d] = c_compactXqFillerOffset;
+                }
+            }
+            const int16_t type = static_cast<int16_t>(types.empty() ? 0 : types[a]);
+
+            atoms[a] = { offset[XX], offset[YY], offset[ZZ], type };
+        }
+    }
+}
+
+} // namespace Nbnxm
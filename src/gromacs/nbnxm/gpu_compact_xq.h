@@ -0,0 +1,127 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ * \brief
+ * Declares the compact GPU coordinate format for the nbnxm GPU kernels
+ *
+ * In the compact format the j-atom data of the GPU kernels is stored as
+ * 16-bit fixed-point coordinate offsets with respect to a per-cluster
+ * reference point, with the atom type index packed into the fourth
+ * 16-bit element. Charges are stored separately. This reduces the j-atom
+ * data read by the kernels from 20 to 14 bytes per atom.
+ *
+ * The reference implementation here is used for checking the accuracy
+ * and for emulating the format with the plain-C GPU reference kernel.
+ * The CUDA packing kernel uses identical arithmetic.
+ *
+ * \ingroup module_nbnxm
+ */
+
+#ifndef GMX_NBNXM_GPU_COMPACT_XQ_H
+#define GMX_NBNXM_GPU_COMPACT_XQ_H
+
+#include <cstdint>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+
+namespace Nbnxm
+{
+
+//! The maximum absolute value of a fixed-point coordinate offset
+static constexpr int c_compactXqMaxOffset = 32767;
+//! The offset value marking filler particles, which are decoded as far away
+static constexpr int c_compactXqFillerOffset = -32768;
+//! Coordinates of filler particles are below this value, real atoms never are
+static constexpr float c_compactXqFillerThreshold = -500000.0F;
+//! The decoded coordinate of filler particles
+static constexpr float c_compactXqFarAway = -1000000.0F;
+//! The maximum number of atom types that can be packed
+static constexpr int c_compactXqMaxNumTypes = 32768;
+
+/*! \internal
+ * \brief Reference point and fixed-point scaling factor for a cluster
+ */
+struct CompactXqClusterReference
+{
+    //! The reference point, the center of the bounding box of the cluster
+    float x, y, z;
+    //! The size of one fixed-point unit
+    float scale;
+};
+
+/*! \internal
+ * \brief The fixed-point coordinate offsets and type index of an atom
+ */
+struct CompactXqAtom
+{
+    //! The coordinate offsets in units of the cluster scale
+    int16_t x, y, z;
+    //! The atom type index
+    int16_t type;
+};
+
+/*! \brief Packs coordinates and types into the compact format
+ *
+ * \param[in]  xq           Coordinates and charges in xyzq format, size 4 * number of atoms
+ * \param[in]  types        Atom type indices, can be empty, then zero is stored
+ * \param[in]  clusterSize  The number of atoms per cluster
+ * \param[out] references   Reference points, size number of atoms / clusterSize
+ * \param[out] atoms        Compact atom data, size number of atoms
+ */
+void packCompactXq(gmx::ArrayRef<const real>                xq,
+                   gmx::ArrayRef<const int>                 types,
+                   int                                      clusterSize,
+                   gmx::ArrayRef<CompactXqClusterReference> references,
+                   gmx::ArrayRef<CompactXqAtom>             atoms);
+
+//! Returns the coordinates decoded from the compact format
+static inline gmx::RVec unpackCompactXq(const CompactXqClusterReference& reference,
+                                        const CompactXqAtom&             atom)
+{
+    if (atom.x == c_compactXqFillerOffset)
+    {
+        return { c_compactXqFarAway, c_compactXqFarAway, c_compactXqFarAway };
+    }
+
+    return { reference.x + reference.scale * atom.x, reference.y + reference.scale * atom.y,
+             reference.z + reference.scale * atom.z };
+}
+
+} // namespace Nbnxm
+
+#endif
@@ -79,11 +79,16 @@ NbnxmGpu* gpu_init(const gmx::DeviceStreamManager gmx_unused& deviceStreamManage
                    /* true if both local and non-local are done on GPU */
                    bool gmx_unused bLocalAndNonlocal) GPU_FUNC_TERM_WITH_RETURN(nullptr);
 
-/** Initializes pair-list data for GPU, called at every pair search step. */
+/*! \brief Initializes pair-list data for GPU, called at every pair search step.
+ *
+ * Only the first \p numSci i-superclusters of \p h_nblist are computed on the GPU,
+ * the remaining ones can be computed on the CPU.
+ */
 GPU_FUNC_QUALIFIER
 void gpu_init_pairlist(NbnxmGpu gmx_unused*          nb,
                        const struct NbnxnPairlistGpu gmx_unused* h_nblist,
-                       gmx::InteractionLocality gmx_unused iloc) GPU_FUNC_TERM;
+                       gmx::InteractionLocality gmx_unused iloc,
+                       int gmx_unused numSci) GPU_FUNC_TERM;
 
 /** Initializes atom-data on the GPU, called at every pair search step. */
 GPU_FUNC_QUALIFIER
@@ -58,6 +58,10 @@
 #    include "gromacs/gpu_utils/gpuregiontimer.cuh"
 #endif
 
+#if GMX_GPU_SYCL
+#    include "gromacs/gpu_utils/gpuregiontimer_sycl.h"
+#endif
+
 /** \internal
  * \brief Parameters required for the GPU nonbonded calculations.
  */
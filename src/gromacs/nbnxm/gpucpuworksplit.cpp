@@ -0,0 +1,149 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *
+ * \brief
+ * Implements the GpuCpuWorkSplit class
+ *
+ * \ingroup module_nbnxm
+ */
+
+#include "gmxpre.h"
+
+#include "gpucpuworksplit.h"
+
+#include <algorithm>
+
+#include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/pairlist.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace Nbnxm
+{
+
+/*! \brief The average wait time per step above which we move work to the CPU
+ *
+ * This should be larger than the overhead of the GPU wait API calls,
+ * which is between 0.5 and 1.5 Mcycles.
+ */
+static constexpr double c_minimumWaitCycles = 2e6;
+
+//! The CPU share we start with when the CPU waits for the GPU
+static constexpr double c_initialCpuFraction = 0.02;
+
+//! The maximum CPU share, the CPU kernel is much slower than the GPU kernel
+static constexpr double c_maximumCpuFraction = 0.5;
+
+//! The factor the CPU share is scaled with when the CPU did not wait for the GPU
+static constexpr double c_decreaseFactor = 0.9;
+
+GpuCpuWorkSplit::GpuCpuWorkSplit(const int numEnergyGroups, const int numThreads)
+{
+    GMX_RELEASE_ASSERT(numThreads >= 1, "Need at least one thread");
+
+    for (int th = 0; th < numThreads; th++)
+    {
+        outputBuffers_.emplace_back(KernelType::Cpu8x8x8_PlainC, numEnergyGroups, 0,
+                                    gmx::PinningPolicy::CannotBePinned);
+    }
+}
+
+int GpuCpuWorkSplit::updateSplit(const NbnxnPairlistGpu& list)
+{
+    if (numWaitSteps_ > 0)
+    {
+        const double averageWaitCycles = gpuWaitCycles_ / numWaitSteps_;
+
+        if (averageWaitCycles > c_minimumWaitCycles)
+        {
+            if (numCj4Cpu_ > 0 && numCpuSteps_ > 0 && cpuCycles_ > 0)
+            {
+                /* Moving work to the CPU shortens the GPU time and lengthens
+                 * the CPU time by roughly the same amount, so we move the work
+                 * that takes half the wait time on the CPU.
+                 */
+                const double cyclesPerCj4 = cpuCycles_ / (numCpuSteps_ * numCj4Cpu_);
+
+                cpuFraction_ += 0.5 * averageWaitCycles / (cyclesPerCj4 * std::max(numCj4Total_, 1));
+            }
+            else
+            {
+                cpuFraction_ = std::max(cpuFraction_, c_initialCpuFraction);
+            }
+        }
+        else
+        {
+            cpuFraction_ *= c_decreaseFactor;
+        }
+
+        cpuFraction_ = std::min(cpuFraction_, c_maximumCpuFraction);
+    }
+
+    gpuWaitCycles_ = 0;
+    numWaitSteps_  = 0;
+    cpuCycles_     = 0;
+    numCpuSteps_   = 0;
+
+    /* Assign the i-superclusters at the end of the list, which are the cheapest,
+     * to the CPU until the CPU has its share of j-cluster groups.
+     */
+    numCj4Total_                 = gmx::ssize(list.cj4);
+    const double numCj4CpuTarget = cpuFraction_ * numCj4Total_;
+
+    firstCpuSci_ = gmx::ssize(list.sci);
+    numCj4Cpu_   = 0;
+    while (firstCpuSci_ > 0 && numCj4Cpu_ < numCj4CpuTarget)
+    {
+        firstCpuSci_--;
+        numCj4Cpu_ += list.sci[firstCpuSci_].numJClusterGroups();
+    }
+
+    return firstCpuSci_;
+}
+
+void GpuCpuWorkSplit::addGpuWaitCycles(const double cycles)
+{
+    gpuWaitCycles_ += cycles;
+    numWaitSteps_++;
+}
+
+void GpuCpuWorkSplit::addCpuCycles(const double cycles)
+{
+    cpuCycles_ += cycles;
+    numCpuSteps_++;
+}
+
+} // namespace Nbnxm
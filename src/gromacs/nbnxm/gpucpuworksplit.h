@@ -0,0 +1,124 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *
+ * \brief
+ * Declares the GpuCpuWorkSplit class
+ *
+ * With a GPU for the non-bonded interactions, part of the local pair list
+ * can be computed on the CPU, while the CPU would otherwise wait for the GPU.
+ * This class sets and adapts the part of the list that is computed on the CPU.
+ *
+ * \ingroup module_nbnxm
+ */
+
+#ifndef GMX_NBNXM_GPUCPUWORKSPLIT_H
+#define GMX_NBNXM_GPUCPUWORKSPLIT_H
+
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
+
+#include "atomdata.h"
+
+struct NbnxnPairlistGpu;
+
+namespace Nbnxm
+{
+
+/*! \internal
+ * \brief Splits the local GPU pair list into a part for the GPU and a part for the CPU
+ *
+ * The i-superclusters in the GPU list are sorted on decreasing size,
+ * so the CPU is assigned the cheapest i-superclusters at the end of the list.
+ * The CPU share is only changed at pair search steps, based on the time
+ * the CPU waited for the local GPU output and the time the CPU spent
+ * on its share of the list during the lifetime of the previous list.
+ */
+class GpuCpuWorkSplit
+{
+public:
+    /*! \brief Constructor
+     *
+     * \param[in] numEnergyGroups  The number of energy groups
+     * \param[in] numThreads       The number of OpenMP threads used for the CPU part
+     */
+    GpuCpuWorkSplit(int numEnergyGroups, int numThreads);
+
+    /*! \brief Updates the CPU share using the timings since the last call and applies it to \p list
+     *
+     * Should be called at every pair search step with the new local list.
+     *
+     * \returns The number of i-superclusters at the start of \p list to compute on the GPU
+     */
+    int updateSplit(const NbnxnPairlistGpu& list);
+
+    //! Returns the index of the first i-supercluster of the list that is computed on the CPU
+    int firstCpuSci() const { return firstCpuSci_; }
+
+    //! Adds the cycles the CPU waited for the local GPU output during one step
+    void addGpuWaitCycles(double cycles);
+
+    //! Adds the cycles the CPU spent on its part of the list during one step
+    void addCpuCycles(double cycles);
+
+    //! Returns the output buffers, one per thread, for the CPU part
+    gmx::ArrayRef<nbnxn_atomdata_output_t> outputBuffers() { return outputBuffers_; }
+
+private:
+    //! The fraction of the j-cluster groups of the list to compute on the CPU
+    double cpuFraction_ = 0;
+    //! The index of the first i-supercluster computed on the CPU
+    int firstCpuSci_ = 0;
+    //! The number of j-cluster groups in the current list
+    int numCj4Total_ = 0;
+    //! The number of j-cluster groups in the current list assigned to the CPU
+    int numCj4Cpu_ = 0;
+    //! The number of steps the GPU wait time was recorded for with the current list
+    int numWaitSteps_ = 0;
+    //! The GPU wait cycles summed over the steps with the current list
+    double gpuWaitCycles_ = 0;
+    //! The number of steps the CPU time was recorded for with the current list
+    int numCpuSteps_ = 0;
+    //! The cycles for the CPU part summed over the steps with the current list
+    double cpuCycles_ = 0;
+    //! Output buffers for the CPU part, one per thread
+    std::vector<nbnxn_atomdata_output_t> outputBuffers_;
+};
+
+} // namespace Nbnxm
+
+#endif
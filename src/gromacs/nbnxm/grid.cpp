@@ -1164,6 +1164,19 @@ void Grid::sortColumnsGpuGeometry(GridSetData*                   gridSetData,
 }
 
 /*! \brief Sets the cell index in the cell array for atom \p atomIndex and increments the atom count for the grid column */
+/*! \brief Returns the part of \p atomRange that \p thread out of \p nthread assigns to columns
+ *
+ * This partitioning is used both for computing the column indices and
+ * for filling the grid, so both steps see the same per-thread counts.
+ */
+static gmx::Range<int> columnIndicesAtomRange(const gmx::Range<int> atomRange,
+                                              const int             thread,
+                                              const int             nthread)
+{
+    return { *atomRange.begin() + static_cast<int>((thread + 0) * atomRange.size()) / nthread,
+             *atomRange.begin() + static_cast<int>((thread + 1) * atomRange.size()) / nthread };
+}
+
 static void setCellAndAtomCount(gmx::ArrayRef<int> cell, int cellIndex, gmx::ArrayRef<int> cxy_na, int atomIndex)
 {
     cell[atomIndex] = cellIndex;
@@ -1184,13 +1197,14 @@ void Grid::calcColumnIndices(const Grid::Dimensions&        gridDims,
     const int numColumns = gridDims.numCells[XX] * gridDims.numCells[YY];
 
     /* We add one extra cell for particles which moved during DD */
-    for (int i = 0; i < numColumns; i++)
+    for (int i = 0; i < numColumns + 1; i++)
     {
         cxy_na[i] = 0;
     }
 
-    int taskAtomStart = *atomRange.begin() + static_cast<int>((thread + 0) * atomRange.size()) / nthread;
-    int taskAtomEnd = *atomRange.begin() + static_cast<int>((thread + 1) * atomRange.size()) / nthread;
+    const gmx::Range<int> taskAtomRange = columnIndicesAtomRange(atomRange, thread, nthread);
+    const int             taskAtomStart = *taskAtomRange.begin();
+    const int             taskAtomEnd   = *taskAtomRange.end();
 
     if (dd_zone == 0)
     {
@@ -1303,34 +1317,52 @@ void Grid::setCellIndices(int                            ddZone,
 
     const int numAtomsPerCell = geometry_.numAtomsPerCell;
 
-    /* Make the cell index as a function of x and y */
+    /* Count the atoms in each column, including the extra column for moved
+     * atoms, and convert the per-thread counts into the offset of the first
+     * atom of each thread in each column, so all threads can fill the grid
+     * concurrently below. The number of cells of each column is temporarily
+     * stored in cxy_ind_.
+     */
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int thread = 0; thread < nthread; thread++)
+    {
+        // Trivial OpenMP block that does not throw
+        const int columnStart = ((thread + 0) * (numColumns() + 1)) / nthread;
+        const int columnEnd   = ((thread + 1) * (numColumns() + 1)) / nthread;
+        for (int i = columnStart; i < columnEnd; i++)
+        {
+            int cxy_na_i = 0;
+            for (int t = 0; t < nthread; t++)
+            {
+                const int numAtomsOfThread       = gridWork[t].numAtomsPerColumn[i];
+                gridWork[t].numAtomsPerColumn[i] = cxy_na_i;
+                cxy_na_i += numAtomsOfThread;
+            }
+            int ncz = (cxy_na_i + numAtomsPerCell - 1) / numAtomsPerCell;
+            if (nbat->XFormat == nbatX8)
+            {
+                /* Make the number of cell a multiple of 2 */
+                ncz = (ncz + 1) & ~1;
+            }
+            cxy_ind_[i + 1] = ncz;
+            cxy_na_[i]      = cxy_na_i;
+        }
+    }
+
+    /* Make the cell index as a function of x and y.
+     * We skip i=grid->ncx*grid->numCells[YY] for ncz_max, these are moved
+     * particles that do not need to be ordered on the grid.
+     */
     int ncz_max = 0;
-    int ncz     = 0;
     cxy_ind_[0] = 0;
     for (int i = 0; i < numColumns() + 1; i++)
     {
-        /* We set ncz_max at the beginning of the loop iso at the end
-         * to skip i=grid->ncx*grid->numCells[YY] which are moved particles
-         * that do not need to be ordered on the grid.
-         */
-        if (ncz > ncz_max)
-        {
-            ncz_max = ncz;
-        }
-        int cxy_na_i = gridWork[0].numAtomsPerColumn[i];
-        for (int thread = 1; thread < nthread; thread++)
+        const int ncz = cxy_ind_[i + 1];
+        if (i < numColumns())
         {
-            cxy_na_i += gridWork[thread].numAtomsPerColumn[i];
-        }
-        ncz = (cxy_na_i + numAtomsPerCell - 1) / numAtomsPerCell;
-        if (nbat->XFormat == nbatX8)
-        {
-            /* Make the number of cell a multiple of 2 */
-            ncz = (ncz + 1) & ~1;
+            ncz_max = std::max(ncz_max, ncz);
         }
         cxy_ind_[i + 1] = cxy_ind_[i] + ncz;
-        /* Clear cxy_na_, so we can reuse the array below */
-        cxy_na_[i] = 0;
     }
     numCellsTotal_     = cxy_ind_[numColumns()] - cxy_ind_[0];
     numCellsColumnMax_ = ncz_max;
@@ -1371,14 +1403,24 @@ void Grid::setCellIndices(int                            ddZone,
 
     /* Now we know the dimensions we can fill the grid.
      * This is the first, unsorted fill. We sort the columns after this.
+     * Each thread fills the atoms it assigned to columns in calcColumnIndices,
+     * starting at its offsets in each column, so the result is independent
+     * of the number of threads.
      */
     gmx::ArrayRef<int> cells       = gridSetData->cells;
     gmx::ArrayRef<int> atomIndices = gridSetData->atomIndices;
-    for (int i : atomRange)
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int thread = 0; thread < nthread; thread++)
     {
-        /* At this point nbs->cell contains the local grid x,y indices */
-        const int cxy                                        = cells[i];
-        atomIndices[firstAtomInColumn(cxy) + cxy_na_[cxy]++] = i;
+        // Trivial OpenMP block that does not throw
+        const gmx::Range<int> threadAtomRange = columnIndicesAtomRange(atomRange, thread, nthread);
+        gmx::ArrayRef<int>    threadOffsets   = gridWork[thread].numAtomsPerColumn;
+        for (int i : threadAtomRange)
+        {
+            /* At this point nbs->cell contains the local grid x,y indices */
+            const int cxy                                              = cells[i];
+            atomIndices[firstAtomInColumn(cxy) + threadOffsets[cxy]++] = i;
+        }
     }
 
     if (ddZone == 0)
@@ -36,6 +36,10 @@
 
 #include "gmxpre.h"
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 #include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/gmxlib/nonbonded/nb_free_energy.h"
 #include "gromacs/gmxlib/nonbonded/nb_kernel.h"
@@ -54,17 +58,21 @@
 #include "gromacs/mdtypes/simulation_workload.h"
 #include "gromacs/nbnxm/gpu_data_mgmt.h"
 #include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/pbcutil/ishift.h"
 #include "gromacs/simd/simd.h"
+#include "gromacs/timing/cyclecounter.h"
 #include "gromacs/timing/wallcycle.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/real.h"
 
+#include "gpucpuworksplit.h"
 #include "kernel_common.h"
 #include "nbnxm_gpu.h"
 #include "nbnxm_gpu_data_mgmt.h"
 #include "nbnxm_simd.h"
 #include "pairlistset.h"
 #include "pairlistsets.h"
+#include "pairsearch.h"
 #include "kernels_reference/kernel_gpu_ref.h"
 #define INCLUDE_KERNELFUNCTION_TABLES
 #include "kernels_reference/kernel_ref.h"
@@ -88,6 +96,15 @@ static void clearGroupEnergies(nbnxn_atomdata_output_t* out)
     std::fill(out->VSc.begin(), out->VSc.end(), 0.0_real);
 }
 
+/*! \brief Clears the group-pair energy buffers used by the SIMD kernels
+ *
+ */
+static void clearGroupEnergySimdBuffers(nbnxn_atomdata_output_t* out)
+{
+    std::fill(out->VSvdw.begin(), out->VSvdw.end(), 0.0_real);
+    std::fill(out->VSc.begin(), out->VSc.end(), 0.0_real);
+}
+
 /*! \brief Reduce the group-pair energy buffers produced by a SIMD kernel
  * to single terms in the output buffers.
  *
@@ -134,13 +151,145 @@ static void reduceGroupEnergySimdBuffers(int numGroups, int numGroups_2log, nbnx
     }
 }
 
+/*! \brief Computes the interactions in one CPU pairlist using the selected kernel
+ *
+ * \param[in]     kernelSetup   The non-bonded kernel setup
+ * \param[in]     coulkt        The Coulomb kernel type
+ * \param[in]     vdwkt         The Van der Waals kernel type
+ * \param[in]     pairlist      The pairlist to compute the interactions for
+ * \param[in]     nbat          The atomdata for the interactions
+ * \param[in]     ic            Non-bonded interaction constants
+ * \param[in]     shiftVectors  The PBC shift vectors
+ * \param[in]     stepWork      Flags that tell what to compute
+ * \param[in]     isFirstSet    Whether this is the first list computed into \p out this step
+ * \param[in,out] out           The output buffer for this list
+ */
+static void nbnxn_kernel_cpu_list(const Nbnxm::KernelSetup&  kernelSetup,
+                                  int                        coulkt,
+                                  int                        vdwkt,
+                                  const NbnxnPairlistCpu*    pairlist,
+                                  const nbnxn_atomdata_t*    nbat,
+                                  const interaction_const_t& ic,
+                                  rvec*                      shiftVectors,
+                                  const gmx::StepWorkload&   stepWork,
+                                  bool                       isFirstSet,
+                                  nbnxn_atomdata_output_t*   out)
+{
+    const nbnxn_atomdata_t::Params& nbatParams = nbat->params();
+
+    if (!stepWork.computeEnergy)
+    {
+        /* Don't calculate energies */
+        switch (kernelSetup.kernelType)
+        {
+            case Nbnxm::KernelType::Cpu4x4_PlainC:
+                nbnxn_kernel_noener_ref[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#ifdef GMX_NBNXN_SIMD_2XNN
+            case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
+                nbnxm_kernel_noener_simd_2xmm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#endif
+#ifdef GMX_NBNXN_SIMD_4XN
+            case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
+                nbnxm_kernel_noener_simd_4xm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#endif
+            default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
+        }
+    }
+    else if (out->Vvdw.size() == 1)
+    {
+        /* A single energy group (pair), the kernels accumulate */
+        if (isFirstSet)
+        {
+            out->Vvdw[0] = 0;
+            out->Vc[0]   = 0;
+        }
+
+        switch (kernelSetup.kernelType)
+        {
+            case Nbnxm::KernelType::Cpu4x4_PlainC:
+                nbnxn_kernel_ener_ref[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#ifdef GMX_NBNXN_SIMD_2XNN
+            case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
+                nbnxm_kernel_ener_simd_2xmm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#endif
+#ifdef GMX_NBNXN_SIMD_4XN
+            case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
+                nbnxm_kernel_ener_simd_4xm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#endif
+            default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
+        }
+    }
+    else
+    {
+        /* Calculate energy group contributions.
+         * The SIMD buffers are reduced into the group energies after each
+         * pairlist set, so for later sets we only clear the SIMD buffers.
+         */
+        if (isFirstSet)
+        {
+            clearGroupEnergies(out);
+        }
+        else
+        {
+            clearGroupEnergySimdBuffers(out);
+        }
+
+        int unrollj = 0;
+
+        switch (kernelSetup.kernelType)
+        {
+            case Nbnxm::KernelType::Cpu4x4_PlainC:
+                unrollj = c_nbnxnCpuIClusterSize;
+                nbnxn_kernel_energrp_ref[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#ifdef GMX_NBNXN_SIMD_2XNN
+            case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
+                unrollj = GMX_SIMD_REAL_WIDTH / 2;
+                nbnxm_kernel_energrp_simd_2xmm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#endif
+#ifdef GMX_NBNXN_SIMD_4XN
+            case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
+                unrollj = GMX_SIMD_REAL_WIDTH;
+                nbnxm_kernel_energrp_simd_4xm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#endif
+            default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
+        }
+
+        if (kernelSetup.kernelType != Nbnxm::KernelType::Cpu4x4_PlainC)
+        {
+            switch (unrollj)
+            {
+                case 2:
+                    reduceGroupEnergySimdBuffers<2>(nbatParams.nenergrp, nbatParams.neg_2log, out);
+                    break;
+                case 4:
+                    reduceGroupEnergySimdBuffers<4>(nbatParams.nenergrp, nbatParams.neg_2log, out);
+                    break;
+                case 8:
+                    reduceGroupEnergySimdBuffers<8>(nbatParams.nenergrp, nbatParams.neg_2log, out);
+                    break;
+                default: GMX_RELEASE_ASSERT(false, "Unsupported j-unroll size");
+            }
+        }
+    }
+}
+
 /*! \brief Dispatches the non-bonded N versus M atom cluster CPU kernels.
  *
  * OpenMP parallelization is performed within this function.
  * Energy reduction, but not force and shift force reduction, is performed
- * within this function.
+ * within this function. With multiple pairlist sets, all sets are computed
+ * within the same parallel region.
  *
- * \param[in]     pairlistSet   Pairlists with local or non-local interactions to compute
+ * \param[in]     pairlistSets  Pairlist sets with local and/or non-local interactions to compute
  * \param[in]     kernelSetup   The non-bonded kernel setup
  * \param[in,out] nbat          The atomdata for the interactions
  * \param[in]     ic            Non-bonded interaction constants
@@ -151,16 +300,16 @@ static void reduceGroupEnergySimdBuffers(int numGroups, int numGroups_2log, nbnx
  * \param[out]    vVdw          Output buffer for Van der Waals energies
  * \param[in]     wcycle        Pointer to cycle counting data structure.
  */
-static void nbnxn_kernel_cpu(const PairlistSet&         pairlistSet,
-                             const Nbnxm::KernelSetup&  kernelSetup,
-                             nbnxn_atomdata_t*          nbat,
-                             const interaction_const_t& ic,
-                             rvec*                      shiftVectors,
-                             const gmx::StepWorkload&   stepWork,
-                             int                        clearF,
-                             real*                      vCoulomb,
-                             real*                      vVdw,
-                             gmx_wallcycle*             wcycle)
+static void nbnxn_kernel_cpu(gmx::ArrayRef<const PairlistSet* const> pairlistSets,
+                             const Nbnxm::KernelSetup&               kernelSetup,
+                             nbnxn_atomdata_t*                       nbat,
+                             const interaction_const_t&              ic,
+                             rvec*                                   shiftVectors,
+                             const gmx::StepWorkload&                stepWork,
+                             int                                     clearF,
+                             real*                                   vCoulomb,
+                             real*                                   vVdw,
+                             gmx_wallcycle*                          wcycle)
 {
 
     int coulkt;
@@ -236,12 +385,17 @@ static void nbnxn_kernel_cpu(const PairlistSet&         pairlistSet,
         GMX_RELEASE_ASSERT(false, "Unsupported VdW interaction type");
     }
 
-    gmx::ArrayRef<const NbnxnPairlistCpu> pairlists = pairlistSet.cpuLists();
+    const int numLists = pairlistSets[0]->cpuLists().ssize();
+    for (const PairlistSet* pairlistSet : pairlistSets)
+    {
+        GMX_RELEASE_ASSERT(pairlistSet->cpuLists().ssize() == numLists,
+                           "All pairlist sets should have the same number of lists");
+    }
 
     int gmx_unused nthreads = gmx_omp_nthreads_get(emntNonbonded);
     wallcycle_sub_start(wcycle, ewcsNONBONDED_CLEAR);
 #pragma omp parallel for schedule(static) num_threads(nthreads)
-    for (gmx::index nb = 0; nb < pairlists.ssize(); nb++)
+    for (gmx::index nb = 0; nb < numLists; nb++)
     {
         // Presently, the kernels do not call C++ code that can throw,
         // so no need for a try/catch pair in this OpenMP region.
@@ -260,105 +414,23 @@ static void nbnxn_kernel_cpu(const PairlistSet&         pairlistSet,
             wallcycle_sub_start(wcycle, ewcsNONBONDED_KERNEL);
         }
 
-        // TODO: Change to reference
-        const NbnxnPairlistCpu* pairlist = &pairlists[nb];
-
-        if (!stepWork.computeEnergy)
-        {
-            /* Don't calculate energies */
-            switch (kernelSetup.kernelType)
-            {
-                case Nbnxm::KernelType::Cpu4x4_PlainC:
-                    nbnxn_kernel_noener_ref[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
-#ifdef GMX_NBNXN_SIMD_2XNN
-                case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
-                    nbnxm_kernel_noener_simd_2xmm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
-#endif
-#ifdef GMX_NBNXN_SIMD_4XN
-                case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
-                    nbnxm_kernel_noener_simd_4xm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
-#endif
-                default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
-            }
-        }
-        else if (out->Vvdw.size() == 1)
+        /* The lists with the same index in all sets use the same output buffer,
+         * so we compute them one after the other on the same thread.
+         */
+        for (gmx::index set = 0; set < pairlistSets.ssize(); set++)
         {
-            /* A single energy group (pair) */
-            out->Vvdw[0] = 0;
-            out->Vc[0]   = 0;
-
-            switch (kernelSetup.kernelType)
-            {
-                case Nbnxm::KernelType::Cpu4x4_PlainC:
-                    nbnxn_kernel_ener_ref[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
-#ifdef GMX_NBNXN_SIMD_2XNN
-                case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
-                    nbnxm_kernel_ener_simd_2xmm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
-#endif
-#ifdef GMX_NBNXN_SIMD_4XN
-                case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
-                    nbnxm_kernel_ener_simd_4xm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
-#endif
-                default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
-            }
-        }
-        else
-        {
-            /* Calculate energy group contributions */
-            clearGroupEnergies(out);
-
-            int unrollj = 0;
-
-            switch (kernelSetup.kernelType)
-            {
-                case Nbnxm::KernelType::Cpu4x4_PlainC:
-                    unrollj = c_nbnxnCpuIClusterSize;
-                    nbnxn_kernel_energrp_ref[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
-#ifdef GMX_NBNXN_SIMD_2XNN
-                case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
-                    unrollj = GMX_SIMD_REAL_WIDTH / 2;
-                    nbnxm_kernel_energrp_simd_2xmm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
-#endif
-#ifdef GMX_NBNXN_SIMD_4XN
-                case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
-                    unrollj = GMX_SIMD_REAL_WIDTH;
-                    nbnxm_kernel_energrp_simd_4xm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
-#endif
-                default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
-            }
+            // TODO: Change to reference
+            const NbnxnPairlistCpu* pairlist = &pairlistSets[set]->cpuLists()[nb];
 
-            if (kernelSetup.kernelType != Nbnxm::KernelType::Cpu4x4_PlainC)
-            {
-                switch (unrollj)
-                {
-                    case 2:
-                        reduceGroupEnergySimdBuffers<2>(nbatParams.nenergrp, nbatParams.neg_2log, out);
-                        break;
-                    case 4:
-                        reduceGroupEnergySimdBuffers<4>(nbatParams.nenergrp, nbatParams.neg_2log, out);
-                        break;
-                    case 8:
-                        reduceGroupEnergySimdBuffers<8>(nbatParams.nenergrp, nbatParams.neg_2log, out);
-                        break;
-                    default: GMX_RELEASE_ASSERT(false, "Unsupported j-unroll size");
-                }
-            }
+            nbnxn_kernel_cpu_list(kernelSetup, coulkt, vdwkt, pairlist, nbat, ic, shiftVectors,
+                                  stepWork, set == 0, out);
         }
     }
     wallcycle_sub_stop(wcycle, ewcsNONBONDED_KERNEL);
 
     if (stepWork.computeEnergy)
     {
-        reduce_energies_over_lists(nbat, pairlists.ssize(), vVdw, vCoulomb);
+        reduce_energies_over_lists(nbat, numLists, vVdw, vCoulomb);
     }
 }
 
@@ -425,15 +497,16 @@ void nonbonded_verlet_t::dispatchNonbondedKernel(gmx::InteractionLocality   iLoc
                                                  gmx_enerdata_t*            enerd,
                                                  t_nrnb*                    nrnb)
 {
-    const PairlistSet& pairlistSet = pairlistSets().pairlistSet(iLocality);
+    const PairlistSet& pairlistSet    = pairlistSets().pairlistSet(iLocality);
+    const PairlistSet* pairlistSetPtr = &pairlistSet;
 
     switch (kernelSetup().kernelType)
     {
         case Nbnxm::KernelType::Cpu4x4_PlainC:
         case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
         case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
-            nbnxn_kernel_cpu(pairlistSet, kernelSetup(), nbat.get(), ic, fr.shift_vec, stepWork,
-                             clearF, enerd->grpp.ener[egCOULSR].data(),
+            nbnxn_kernel_cpu(gmx::arrayRefFromArray(&pairlistSetPtr, 1), kernelSetup(), nbat.get(),
+                             ic, fr.shift_vec, stepWork, clearF, enerd->grpp.ener[egCOULSR].data(),
                              fr.bBHAM ? enerd->grpp.ener[egBHAMSR].data() : enerd->grpp.ener[egLJSR].data(),
                              wcycle_);
             break;
@@ -446,7 +519,8 @@ void nonbonded_verlet_t::dispatchNonbondedKernel(gmx::InteractionLocality   iLoc
             nbnxn_kernel_gpu_ref(
                     pairlistSet.gpuList(), nbat.get(), &ic, fr.shift_vec, stepWork, clearF,
                     nbat->out[0].f, nbat->out[0].fshift.data(), enerd->grpp.ener[egCOULSR].data(),
-                    fr.bBHAM ? enerd->grpp.ener[egBHAMSR].data() : enerd->grpp.ener[egLJSR].data());
+                    fr.bBHAM ? enerd->grpp.ener[egBHAMSR].data() : enerd->grpp.ener[egLJSR].data(),
+                    kernelSetup().useCompactGpuXq);
             break;
 
         default: GMX_RELEASE_ASSERT(false, "Invalid nonbonded kernel type passed!");
@@ -455,6 +529,110 @@ void nonbonded_verlet_t::dispatchNonbondedKernel(gmx::InteractionLocality   iLoc
     accountFlops(nrnb, pairlistSet, *this, ic, stepWork);
 }
 
+void nonbonded_verlet_t::dispatchLocalAndNonlocalNonbondedKernelCpu(
+        const interaction_const_t& ic,
+        const gmx::StepWorkload&   stepWork,
+        int                        clearF,
+        const t_forcerec&          fr,
+        gmx_enerdata_t*            enerd,
+        t_nrnb*                    nrnb)
+{
+    GMX_RELEASE_ASSERT(!useGpu() && !emulateGpu(),
+                       "Local and non-local kernels can only be combined with CPU kernels");
+
+    const PairlistSet& localSet    = pairlistSets().pairlistSet(gmx::InteractionLocality::Local);
+    const PairlistSet& nonlocalSet = pairlistSets().pairlistSet(gmx::InteractionLocality::NonLocal);
+    const std::array<const PairlistSet*, 2> sets = { &localSet, &nonlocalSet };
+
+    nbnxn_kernel_cpu(sets, kernelSetup(), nbat.get(), ic, fr.shift_vec, stepWork, clearF,
+                     enerd->grpp.ener[egCOULSR].data(),
+                     fr.bBHAM ? enerd->grpp.ener[egBHAMSR].data() : enerd->grpp.ener[egLJSR].data(),
+                     wcycle_);
+
+    accountFlops(nrnb, localSet, *this, ic, stepWork);
+    accountFlops(nrnb, nonlocalSet, *this, ic, stepWork);
+}
+
+void nonbonded_verlet_t::dispatchCpuPartOfGpuNonbondedKernel(
+        const interaction_const_t& ic,
+        const gmx::StepWorkload&   stepWork,
+        const t_forcerec&          fr,
+        gmx::ForceWithShiftForces* forceWithShiftForces,
+        gmx_enerdata_t*            enerd)
+{
+    if (!gpuCpuWorkSplit_)
+    {
+        return;
+    }
+
+    const NbnxnPairlistGpu* gpuList =
+            pairlistSets().pairlistSet(gmx::InteractionLocality::Local).gpuList();
+    const int sciStart = gpuCpuWorkSplit_->firstCpuSci();
+    const int numSci   = gmx::ssize(gpuList->sci) - sciStart;
+    if (numSci == 0)
+    {
+        return;
+    }
+
+    const gmx_cycles_t cycleStart = gmx_cycles_read();
+    wallcycle_sub_start(wcycle_, ewcsNONBONDED_KERNEL);
+
+    /* Use at most one thread per i-supercluster, so all threads have work */
+    const int numThreads = std::min(gpuCpuWorkSplit_->outputBuffers().ssize(), gmx::index(numSci));
+    gmx::ArrayRef<nbnxn_atomdata_output_t> outputBuffers =
+            gpuCpuWorkSplit_->outputBuffers().subArray(0, numThreads);
+
+#pragma omp parallel for schedule(static) num_threads(numThreads)
+    for (int th = 0; th < numThreads; th++)
+    {
+        try
+        {
+            nbnxn_atomdata_output_t& out = outputBuffers[th];
+
+            out.f.resize(nbat->numAtoms() * nbat->fstride);
+            std::fill(out.fshift.begin(), out.fshift.end(), 0.0_real);
+            std::fill(out.Vc.begin(), out.Vc.end(), 0.0_real);
+            std::fill(out.Vvdw.begin(), out.Vvdw.end(), 0.0_real);
+
+            const gmx::Range<int> sciRange(sciStart + (th * numSci) / numThreads,
+                                           sciStart + ((th + 1) * numSci) / numThreads);
+            nbnxn_kernel_gpu_ref(gpuList, nbat.get(), &ic, fr.shift_vec, stepWork, enbvClearFYes,
+                                 out.f, out.fshift.data(), out.Vc.data(), out.Vvdw.data(), false,
+                                 sciRange);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    reduceOutputBufferForces(*nbat, outputBuffers, gmx::AtomLocality::Local, pairSearch_->gridSet(),
+                             as_rvec_array(forceWithShiftForces->force().data()));
+
+    for (const nbnxn_atomdata_output_t& out : outputBuffers)
+    {
+        if (stepWork.computeVirial)
+        {
+            gmx::ArrayRef<gmx::RVec> shiftForces = forceWithShiftForces->shiftForces();
+            for (int s = 0; s < SHIFTS; s++)
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    shiftForces[s][d] += out.fshift[s * DIM + d];
+                }
+            }
+        }
+        if (stepWork.computeEnergy)
+        {
+            for (gmx::index i = 0; i < gmx::ssize(out.Vc); i++)
+            {
+                enerd->grpp.ener[egCOULSR][i] += out.Vc[i];
+                enerd->grpp.ener[egLJSR][i] += out.Vvdw[i];
+            }
+        }
+    }
+
+    wallcycle_sub_stop(wcycle_, ewcsNONBONDED_KERNEL);
+    gpuCpuWorkSplit_->addCpuCycles(static_cast<double>(gmx_cycles_read() - cycleStart));
+}
+
 void nonbonded_verlet_t::dispatchFreeEnergyKernel(gmx::InteractionLocality   iLocality,
                                                   const t_forcerec*          fr,
                                                   rvec                       x[],
@@ -494,6 +672,8 @@ void nonbonded_verlet_t::dispatchFreeEnergyKernel(gmx::InteractionLocality   iLo
     nb_kernel_data_t kernel_data;
     real             dvdl_nb[efptNR] = { 0 };
     kernel_data.flags                = donb_flags;
+    kernel_data.numLambdas           = 1;
+    kernel_data.numEnergyGroupPairs  = enerd->grpp.nener;
     kernel_data.lambda               = lambda.data();
     kernel_data.dvdl                 = dvdl_nb;
 
@@ -528,39 +708,62 @@ void nonbonded_verlet_t::dispatchFreeEnergyKernel(gmx::InteractionLocality   iLo
 
     /* If we do foreign lambda and we have soft-core interactions
      * we have to recalculate the (non-linear) energies contributions.
+     * All lambda states are computed in a single pass over the pair list.
      */
     if (fepvals->n_lambda > 0 && stepWork.computeDhdl && fepvals->sc_alpha != 0)
     {
-        real lam_i[efptNR];
-        kernel_data.flags = (donb_flags & ~(GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE))
-                            | GMX_NONBONDED_DO_FOREIGNLAMBDA;
-        kernel_data.lambda         = lam_i;
-        kernel_data.dvdl           = dvdl_nb;
-        kernel_data.energygrp_elec = enerd->foreign_grpp.ener[egCOULSR].data();
-        kernel_data.energygrp_vdw  = enerd->foreign_grpp.ener[egLJSR].data();
-
-        for (gmx::index i = 0; i < 1 + enerd->foreignLambdaTerms.numLambdas(); i++)
+        const int numLambdas          = 1 + enerd->foreignLambdaTerms.numLambdas();
+        const int numEnergyGroupPairs = enerd->grpp.nener;
+
+        /* The buffers are kept in this object, so they are only allocated once */
+        std::vector<real>& lambdas      = foreignLambdas_;
+        std::vector<real>& dvdls        = foreignDvdl_;
+        std::vector<real>& energiesElec = foreignEnergyGroupElec_;
+        std::vector<real>& energiesVdw  = foreignEnergyGroupVdw_;
+        lambdas.resize(numLambdas * efptNR);
+        dvdls.assign(numLambdas * efptNR, 0);
+        energiesElec.assign(numLambdas * numEnergyGroupPairs, 0);
+        energiesVdw.assign(numLambdas * numEnergyGroupPairs, 0);
+        for (int i = 0; i < numLambdas; i++)
         {
-            std::fill(std::begin(dvdl_nb), std::end(dvdl_nb), 0);
             for (int j = 0; j < efptNR; j++)
             {
-                lam_i[j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
+                lambdas[i * efptNR + j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
             }
-            reset_foreign_enerdata(enerd);
+        }
+
+        kernel_data.flags = (donb_flags & ~(GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE))
+                            | GMX_NONBONDED_DO_FOREIGNLAMBDA;
+        kernel_data.numLambdas          = numLambdas;
+        kernel_data.numEnergyGroupPairs = numEnergyGroupPairs;
+        kernel_data.lambda              = lambdas.data();
+        kernel_data.dvdl                = dvdls.data();
+        kernel_data.energygrp_elec      = energiesElec.data();
+        kernel_data.energygrp_vdw       = energiesVdw.data();
+
 #pragma omp parallel for schedule(static) num_threads(nbl_fep.ssize())
-            for (gmx::index th = 0; th < nbl_fep.ssize(); th++)
+        for (gmx::index th = 0; th < nbl_fep.ssize(); th++)
+        {
+            try
             {
-                try
-                {
-                    gmx_nb_free_energy_kernel(nbl_fep[th].get(), x, forceWithShiftForces, fr,
-                                              &mdatoms, &kernel_data, nrnb);
-                }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                gmx_nb_free_energy_kernel(nbl_fep[th].get(), x, forceWithShiftForces, fr, &mdatoms,
+                                          &kernel_data, nrnb);
             }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+
+        for (int i = 0; i < numLambdas; i++)
+        {
+            reset_foreign_enerdata(enerd);
+            std::copy_n(energiesElec.begin() + i * numEnergyGroupPairs, numEnergyGroupPairs,
+                        enerd->foreign_grpp.ener[egCOULSR].begin());
+            std::copy_n(energiesVdw.begin() + i * numEnergyGroupPairs, numEnergyGroupPairs,
+                        enerd->foreign_grpp.ener[egLJSR].begin());
 
             sum_epot(enerd->foreign_grpp, enerd->foreign_term);
-            enerd->foreignLambdaTerms.accumulate(i, enerd->foreign_term[F_EPOT],
-                                                 dvdl_nb[efptVDW] + dvdl_nb[efptCOUL]);
+            enerd->foreignLambdaTerms.accumulate(
+                    i, enerd->foreign_term[F_EPOT],
+                    dvdls[i * efptNR + efptVDW] + dvdls[i * efptNR + efptCOUL]);
         }
     }
     wallcycle_sub_stop(wcycle_, ewcsNONBONDED_FEP);
@@ -40,14 +40,17 @@
 #include <cmath>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/math/functions.h"
 #include "gromacs/math/utilities.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/group.h"
 #include "gromacs/mdtypes/interaction_const.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/mdtypes/simulation_workload.h"
 #include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/gpu_compact_xq.h"
 #include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/nbnxm/pairlist.h"
 #include "gromacs/pbcutil/ishift.h"
@@ -64,7 +67,9 @@ void nbnxn_kernel_gpu_ref(const NbnxnPairlistGpu*    nbl,
                           gmx::ArrayRef<real>        f,
                           real*                      fshift,
                           real*                      Vc,
-                          real*                      Vvdw)
+                          real*                      Vvdw,
+                          bool                       useCompactXq,
+                          gmx::Range<int>            sciRange)
 {
     gmx_bool            bEwald;
     const real*         Ftab = nullptr;
@@ -135,12 +140,38 @@ void nbnxn_kernel_gpu_ref(const NbnxnPairlistGpu*    nbl,
 
     const real* x = nbat->x().data();
 
+    /* With energy groups, the group of each atom is stored separately */
+    const int  ngid    = nbat->params().nenergrp;
+    const int* energrp = nbat->params().energrp.data();
+
+    /* Emulate the compact j-atom coordinates of the force-only GPU kernels */
+    const bool                                    emulateCompactXq = (useCompactXq && !stepWork.computeEnergy);
+    std::vector<Nbnxm::CompactXqClusterReference> compactReferences;
+    std::vector<Nbnxm::CompactXqAtom>             compactAtoms;
+    if (emulateCompactXq)
+    {
+        GMX_RELEASE_ASSERT(nbat->xstride == 4, "The GPU layout should be xyzq");
+
+        const int numAtoms = nbat->numAtoms();
+        compactReferences.resize(numAtoms / c_clSize);
+        compactAtoms.resize(numAtoms);
+        Nbnxm::packCompactXq(gmx::constArrayRefFromArray(x, numAtoms * nbat->xstride), {},
+                             c_clSize, compactReferences, compactAtoms);
+    }
+
     npair_tot   = 0;
     nhwu        = 0;
     nhwu_pruned = 0;
 
-    for (const nbnxn_sci_t& nbln : nbl->sci)
+    if (sciRange.empty())
     {
+        sciRange = gmx::Range<int>(0, gmx::ssize(nbl->sci));
+    }
+
+    for (const int sciIndex : sciRange)
+    {
+        const nbnxn_sci_t& nbln = nbl->sci[sciIndex];
+
         ish3     = 3 * nbln.shift;
         shX      = shiftvec[ish3];
         shY      = shiftvec[ish3 + 1];
@@ -156,6 +187,16 @@ void nbnxn_kernel_gpu_ref(const NbnxnPairlistGpu*    nbl,
             /* we have the diagonal:
              * add the charge self interaction energy term
              */
+            real selfFactor;
+            if (!bEwald)
+            {
+                selfFactor = -facel * 0.5 * iconst->c_rf;
+            }
+            else
+            {
+                /* last factor 1/sqrt(pi) */
+                selfFactor = -facel * iconst->ewaldcoeff_q * M_1_SQRTPI;
+            }
             for (im = 0; im < c_nbnxnGpuNumClusterPerSupercluster; im++)
             {
                 ci = sci * c_nbnxnGpuNumClusterPerSupercluster + im;
@@ -163,18 +204,18 @@ void nbnxn_kernel_gpu_ref(const NbnxnPairlistGpu*    nbl,
                 {
                     ia = ci * c_clSize + ic;
                     iq = x[ia * nbat->xstride + 3];
-                    vctot += iq * iq;
+                    if (ngid > 1)
+                    {
+                        ggid = energrp[ia] * ngid + energrp[ia];
+                        Vc[ggid] += selfFactor * iq * iq;
+                    }
+                    else
+                    {
+                        vctot += iq * iq;
+                    }
                 }
             }
-            if (!bEwald)
-            {
-                vctot *= -facel * 0.5 * iconst->c_rf;
-            }
-            else
-            {
-                /* last factor 1/sqrt(pi) */
-                vctot *= -facel * iconst->ewaldcoeff_q * M_1_SQRTPI;
-            }
+            vctot *= selfFactor;
         }
 
         for (cj4_ind = cj4_ind0; (cj4_ind < cj4_ind1); cj4_ind++)
@@ -234,9 +275,20 @@ void nbnxn_kernel_gpu_ref(const NbnxnPairlistGpu*    nbl,
 
                                 js  = ja * nbat->xstride;
                                 jfs = ja * nbat->fstride;
-                                jx  = x[js + 0];
-                                jy  = x[js + 1];
-                                jz  = x[js + 2];
+                                if (emulateCompactXq)
+                                {
+                                    const gmx::RVec xj = Nbnxm::unpackCompactXq(
+                                            compactReferences[cj], compactAtoms[ja]);
+                                    jx = xj[XX];
+                                    jy = xj[YY];
+                                    jz = xj[ZZ];
+                                }
+                                else
+                                {
+                                    jx = x[js + 0];
+                                    jy = x[js + 1];
+                                    jz = x[js + 2];
+                                }
                                 dx  = ix - jx;
                                 dy  = iy - jy;
                                 dz  = iz - jz;
@@ -306,13 +358,23 @@ void nbnxn_kernel_gpu_ref(const NbnxnPairlistGpu*    nbl,
 
                                     if (stepWork.computeEnergy)
                                     {
-                                        vctot += vcoul;
-
-                                        Vvdwtot +=
+                                        const real vvdw =
                                                 (Vvdw_rep + int_bit * c12 * iconst->repulsion_shift.cpot) / 12
                                                 - (Vvdw_disp
                                                    + int_bit * c6 * iconst->dispersion_shift.cpot)
                                                           / 6;
+
+                                        if (ngid > 1)
+                                        {
+                                            ggid = GID(energrp[ia], energrp[ja], ngid);
+                                            Vc[ggid] += vcoul;
+                                            Vvdw[ggid] += vvdw;
+                                        }
+                                        else
+                                        {
+                                            vctot += vcoul;
+                                            Vvdwtot += vvdw;
+                                        }
                                     }
                                 }
 
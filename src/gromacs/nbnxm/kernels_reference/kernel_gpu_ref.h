@@ -47,6 +47,7 @@
 
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/range.h"
 #include "gromacs/utility/real.h"
 
 struct NbnxnPairlistGpu;
@@ -59,7 +60,13 @@ namespace gmx
 class StepWorkload;
 }
 
-//! Reference (slow) kernel for nb n vs n GPU type pair lists
+/*! \brief Reference (slow) kernel for nb n vs n GPU type pair lists
+ *
+ * With \p useCompactXq the j-atom coordinates are taken from the compact
+ * format when no energies are computed, as in the GPU kernels.
+ * Only the i-superclusters with indices in \p sciRange are computed,
+ * an empty range, the default, selects the whole list.
+ */
 void nbnxn_kernel_gpu_ref(const NbnxnPairlistGpu*    nbl,
                           const nbnxn_atomdata_t*    nbat,
                           const interaction_const_t* iconst,
@@ -69,6 +76,8 @@ void nbnxn_kernel_gpu_ref(const NbnxnPairlistGpu*    nbl,
                           gmx::ArrayRef<real>        f,
                           real*                      fshift,
                           real*                      Vc,
-                          real*                      Vvdw);
+                          real*                      Vvdw,
+                          bool                       useCompactXq = false,
+                          gmx::Range<int>            sciRange     = {});
 
 #endif
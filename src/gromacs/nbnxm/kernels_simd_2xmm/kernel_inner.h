@@ -63,6 +63,14 @@
 #    define EXCL_FORCES
 #endif
 
+/* With SKIP_CUTOFF_CHECK all atom pairs are known to be within the cut-off
+ * for the whole lifetime of the list, so we can avoid all cut-off masking.
+ * Such cluster pairs never have exclusions.
+ */
+#if defined SKIP_CUTOFF_CHECK && defined CHECK_EXCLS
+#    error "SKIP_CUTOFF_CHECK can not be combined with CHECK_EXCLS"
+#endif
+
 {
     int cj, aj, ajx, ajy, ajz;
 
@@ -84,13 +92,15 @@
     SimdReal tx_S2, ty_S2, tz_S2;
     SimdReal rsq_S0, rinv_S0, rinvsq_S0;
     SimdReal rsq_S2, rinv_S2, rinvsq_S2;
+#ifndef SKIP_CUTOFF_CHECK
     /* wco: within cut-off, mask of all 1's or 0's */
     SimdBool wco_S0;
     SimdBool wco_S2;
-#ifdef VDW_CUTOFF_CHECK
+#    ifdef VDW_CUTOFF_CHECK
     SimdBool wco_vdw_S0;
-#    ifndef HALF_LJ
+#        ifndef HALF_LJ
     SimdBool wco_vdw_S2;
+#        endif
 #    endif
 #endif
 
@@ -240,9 +250,11 @@
     rsq_S0 = norm2(dx_S0, dy_S0, dz_S0);
     rsq_S2 = norm2(dx_S2, dy_S2, dz_S2);
 
+#ifndef SKIP_CUTOFF_CHECK
     /* Do the cut-off check */
     wco_S0 = (rsq_S0 < rc2_S);
     wco_S2 = (rsq_S2 < rc2_S);
+#endif
 
 #ifdef CHECK_EXCLS
 #    ifdef EXCL_FORCES
@@ -348,9 +360,11 @@
 
 #endif /* CALC_LJ */
 
+#ifndef SKIP_CUTOFF_CHECK
     /* Set rinv to zero for r beyond the cut-off */
     rinv_S0 = selectByMask(rinv_S0, wco_S0);
     rinv_S2 = selectByMask(rinv_S2, wco_S2);
+#endif
 
     rinvsq_S0 = rinv_S0 * rinv_S0;
     rinvsq_S2 = rinv_S2 * rinv_S2;
@@ -387,8 +401,13 @@
     /* We need to mask (or limit) rsq for the cut-off,
      * as large distances can cause an overflow in gmx_pmecorrF/V.
      */
-    brsq_S0   = beta2_S * selectByMask(rsq_S0, wco_S0);
-    brsq_S2   = beta2_S * selectByMask(rsq_S2, wco_S2);
+#        ifdef SKIP_CUTOFF_CHECK
+    brsq_S0 = beta2_S * rsq_S0;
+    brsq_S2 = beta2_S * rsq_S2;
+#        else
+    brsq_S0 = beta2_S * selectByMask(rsq_S0, wco_S0);
+    brsq_S2 = beta2_S * selectByMask(rsq_S2, wco_S2);
+#        endif
     ewcorr_S0 = beta_S * pmeForceCorrection(brsq_S0);
     ewcorr_S2 = beta_S * pmeForceCorrection(brsq_S2);
     frcoul_S0 = qq_S0 * fma(ewcorr_S0, brsq_S0, rinv_ex_S0);
@@ -474,7 +493,7 @@
 
 #    endif
 
-#    ifdef CALC_ENERGIES
+#    if defined CALC_ENERGIES && !defined SKIP_CUTOFF_CHECK
     /* Mask energy for cut-off and diagonal */
     vcoul_S0 = selectByMask(vcoul_S0, wco_S0);
     vcoul_S2 = selectByMask(vcoul_S2, wco_S2);
@@ -486,9 +505,11 @@
     /* Lennard-Jones interaction */
 
 #    ifdef VDW_CUTOFF_CHECK
+#        ifndef SKIP_CUTOFF_CHECK
     wco_vdw_S0 = (rsq_S0 < rcvdw2_S);
-#        ifndef HALF_LJ
+#            ifndef HALF_LJ
     wco_vdw_S2 = (rsq_S2 < rcvdw2_S);
+#            endif
 #        endif
 #    else
     /* Same cut-off for Coulomb and VdW, reuse the registers */
@@ -569,7 +590,7 @@
     sir6_S2 = selectByMask(sir6_S2, interact_S2);
 #            endif
 #        endif
-#        ifdef VDW_CUTOFF_CHECK
+#        if defined VDW_CUTOFF_CHECK && !defined SKIP_CUTOFF_CHECK
     sir6_S0 = selectByMask(sir6_S0, wco_vdw_S0);
 #            ifndef HALF_LJ
     sir6_S2 = selectByMask(sir6_S2, wco_vdw_S2);
@@ -734,10 +755,17 @@
 #            endif
 #        endif
 
+#        ifdef SKIP_CUTOFF_CHECK
+        cr2_S0 = lje_c2_S * rsq_S0;
+#            ifndef HALF_LJ
+        cr2_S2 = lje_c2_S * rsq_S2;
+#            endif
+#        else
         /* Mask for the cut-off to avoid overflow of cr2^2 */
         cr2_S0 = lje_c2_S * selectByMask(rsq_S0, wco_vdw_S0);
-#        ifndef HALF_LJ
+#            ifndef HALF_LJ
         cr2_S2 = lje_c2_S * selectByMask(rsq_S2, wco_vdw_S2);
+#            endif
 #        endif
         // Unsafe version of our exp() should be fine, since these arguments should never
         // be smaller than -127 for any reasonable choice of cutoff or ewald coefficients.
@@ -785,7 +813,7 @@
     }
 #    endif /* LJ_EWALD_GEOM */
 
-#    if defined VDW_CUTOFF_CHECK
+#    if defined VDW_CUTOFF_CHECK && !defined SKIP_CUTOFF_CHECK
     /* frLJ is multiplied later by rinvsq, which is masked for the Coulomb
      * cut-off, but if the VdW cut-off is shorter, we need to mask with that.
      */
@@ -795,7 +823,7 @@
 #        endif
 #    endif
 
-#    ifdef CALC_ENERGIES
+#    if defined CALC_ENERGIES && !defined SKIP_CUTOFF_CHECK
     /* The potential shift should be removed for pairs beyond cut-off */
     VLJ_S0 = selectByMask(VLJ_S0, wco_vdw_S0);
 #        ifndef HALF_LJ
@@ -392,6 +392,8 @@
         do_LJ   = ((ciEntry.shift & NBNXN_CI_DO_LJ(0)) != 0);
         do_coul = ((ciEntry.shift & NBNXN_CI_DO_COUL(0)) != 0);
         half_LJ = (((ciEntry.shift & NBNXN_CI_HALF_LJ(0)) != 0) || !do_LJ) && do_coul;
+        /* With this flag set, all j-clusters without exclusions are in range */
+        const bool allJInRange = ((ciEntry.shift & NBNXN_CI_ALL_J_IN_RANGE) != 0);
 
 #ifdef ENERGY_GROUPS
         egps_i = nbatParams.energrp[ci];
@@ -577,9 +579,21 @@
                 cjind++;
             }
 #undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
+            if (allJInRange)
             {
+#define SKIP_CUTOFF_CHECK
+                for (; (cjind < cjind1); cjind++)
+                {
 #include "kernel_inner.h"
+                }
+#undef SKIP_CUTOFF_CHECK
+            }
+            else
+            {
+                for (; (cjind < cjind1); cjind++)
+                {
+#include "kernel_inner.h"
+                }
             }
 #undef HALF_LJ
 #undef CALC_COULOMB
@@ -595,9 +609,21 @@
                 cjind++;
             }
 #undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
+            if (allJInRange)
             {
+#define SKIP_CUTOFF_CHECK
+                for (; (cjind < cjind1); cjind++)
+                {
 #include "kernel_inner.h"
+                }
+#undef SKIP_CUTOFF_CHECK
+            }
+            else
+            {
+                for (; (cjind < cjind1); cjind++)
+                {
+#include "kernel_inner.h"
+                }
             }
 #undef CALC_COULOMB
         }
@@ -611,9 +637,21 @@
                 cjind++;
             }
 #undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
+            if (allJInRange)
+            {
+#define SKIP_CUTOFF_CHECK
+                for (; (cjind < cjind1); cjind++)
+                {
+#include "kernel_inner.h"
+                }
+#undef SKIP_CUTOFF_CHECK
+            }
+            else
             {
+                for (; (cjind < cjind1); cjind++)
+                {
 #include "kernel_inner.h"
+                }
             }
         }
 #undef CALC_LJ
@@ -56,6 +56,14 @@
 #        define EXCL_FORCES
 #    endif
 
+/* With SKIP_CUTOFF_CHECK all atom pairs are known to be within the cut-off
+ * for the whole lifetime of the list, so we can avoid all cut-off masking.
+ * Such cluster pairs never have exclusions.
+ */
+#    if defined SKIP_CUTOFF_CHECK && defined CHECK_EXCLS
+#        error "SKIP_CUTOFF_CHECK can not be combined with CHECK_EXCLS"
+#    endif
+
 {
     int cj, ajx, ajy, ajz;
     int gmx_unused aj;
@@ -87,18 +95,20 @@
     SimdReal rsq_S2, rinv_S2, rinvsq_S2;
     SimdReal rsq_S3, rinv_S3, rinvsq_S3;
 
+#    ifndef SKIP_CUTOFF_CHECK
     /* wco: within cut-off, mask of all 1's or 0's */
     SimdBool wco_S0;
     SimdBool wco_S1;
     SimdBool wco_S2;
     SimdBool wco_S3;
 
-#    ifdef VDW_CUTOFF_CHECK
+#        ifdef VDW_CUTOFF_CHECK
     SimdBool wco_vdw_S0;
     SimdBool wco_vdw_S1;
-#        ifndef HALF_LJ
+#            ifndef HALF_LJ
     SimdBool wco_vdw_S2;
     SimdBool wco_vdw_S3;
+#            endif
 #        endif
 #    endif
 
@@ -299,11 +309,13 @@
     rsq_S2 = norm2(dx_S2, dy_S2, dz_S2);
     rsq_S3 = norm2(dx_S3, dy_S3, dz_S3);
 
+#    ifndef SKIP_CUTOFF_CHECK
     /* Do the cut-off check */
     wco_S0 = (rsq_S0 < rc2_S);
     wco_S1 = (rsq_S1 < rc2_S);
     wco_S2 = (rsq_S2 < rc2_S);
     wco_S3 = (rsq_S3 < rc2_S);
+#    endif
 
 #    ifdef CHECK_EXCLS
 #        ifdef EXCL_FORCES
@@ -451,11 +463,13 @@
 
 #    endif /* CALC_LJ */
 
+#    ifndef SKIP_CUTOFF_CHECK
     /* Set rinv to zero for r beyond the cut-off */
     rinv_S0 = selectByMask(rinv_S0, wco_S0);
     rinv_S1 = selectByMask(rinv_S1, wco_S1);
     rinv_S2 = selectByMask(rinv_S2, wco_S2);
     rinv_S3 = selectByMask(rinv_S3, wco_S3);
+#    endif
 
     rinvsq_S0 = rinv_S0 * rinv_S0;
     rinvsq_S1 = rinv_S1 * rinv_S1;
@@ -502,10 +516,17 @@
     /* We need to mask (or limit) rsq for the cut-off,
      * as large distances can cause an overflow in gmx_pmecorrF/V.
      */
-    brsq_S0   = beta2_S * selectByMask(rsq_S0, wco_S0);
-    brsq_S1   = beta2_S * selectByMask(rsq_S1, wco_S1);
-    brsq_S2   = beta2_S * selectByMask(rsq_S2, wco_S2);
-    brsq_S3   = beta2_S * selectByMask(rsq_S3, wco_S3);
+#            ifdef SKIP_CUTOFF_CHECK
+    brsq_S0 = beta2_S * rsq_S0;
+    brsq_S1 = beta2_S * rsq_S1;
+    brsq_S2 = beta2_S * rsq_S2;
+    brsq_S3 = beta2_S * rsq_S3;
+#            else
+    brsq_S0 = beta2_S * selectByMask(rsq_S0, wco_S0);
+    brsq_S1 = beta2_S * selectByMask(rsq_S1, wco_S1);
+    brsq_S2 = beta2_S * selectByMask(rsq_S2, wco_S2);
+    brsq_S3 = beta2_S * selectByMask(rsq_S3, wco_S3);
+#            endif
     ewcorr_S0 = beta_S * pmeForceCorrection(brsq_S0);
     ewcorr_S1 = beta_S * pmeForceCorrection(brsq_S1);
     ewcorr_S2 = beta_S * pmeForceCorrection(brsq_S2);
@@ -633,7 +654,7 @@
 
 #        endif
 
-#        ifdef CALC_ENERGIES
+#        if defined CALC_ENERGIES && !defined SKIP_CUTOFF_CHECK
     /* Mask energy for cut-off and diagonal */
     vcoul_S0 = selectByMask(vcoul_S0, wco_S0);
     vcoul_S1 = selectByMask(vcoul_S1, wco_S1);
@@ -647,11 +668,13 @@
     /* Lennard-Jones interaction */
 
 #        ifdef VDW_CUTOFF_CHECK
+#            ifndef SKIP_CUTOFF_CHECK
     wco_vdw_S0 = (rsq_S0 < rcvdw2_S);
     wco_vdw_S1 = (rsq_S1 < rcvdw2_S);
-#            ifndef HALF_LJ
+#                ifndef HALF_LJ
     wco_vdw_S2 = (rsq_S2 < rcvdw2_S);
     wco_vdw_S3 = (rsq_S3 < rcvdw2_S);
+#                endif
 #            endif
 #        else
     /* Same cut-off for Coulomb and VdW, reuse the registers */
@@ -763,7 +786,7 @@
     sir6_S3 = selectByMask(sir6_S3, interact_S3);
 #                endif
 #            endif
-#            ifdef VDW_CUTOFF_CHECK
+#            if defined VDW_CUTOFF_CHECK && !defined SKIP_CUTOFF_CHECK
     sir6_S0 = selectByMask(sir6_S0, wco_vdw_S0);
     sir6_S1 = selectByMask(sir6_S1, wco_vdw_S1);
 #                ifndef HALF_LJ
@@ -985,12 +1008,21 @@
 #                endif
 #            endif
 
+#            ifdef SKIP_CUTOFF_CHECK
+        cr2_S0 = lje_c2_S * rsq_S0;
+        cr2_S1 = lje_c2_S * rsq_S1;
+#                ifndef HALF_LJ
+        cr2_S2 = lje_c2_S * rsq_S2;
+        cr2_S3 = lje_c2_S * rsq_S3;
+#                endif
+#            else
         /* Mask for the cut-off to avoid overflow of cr2^2 */
         cr2_S0 = lje_c2_S * selectByMask(rsq_S0, wco_vdw_S0);
         cr2_S1 = lje_c2_S * selectByMask(rsq_S1, wco_vdw_S1);
-#            ifndef HALF_LJ
+#                ifndef HALF_LJ
         cr2_S2 = lje_c2_S * selectByMask(rsq_S2, wco_vdw_S2);
         cr2_S3 = lje_c2_S * selectByMask(rsq_S3, wco_vdw_S3);
+#                endif
 #            endif
         // Unsafe version of our exp() should be fine, since these arguments should never
         // be smaller than -127 for any reasonable choice of cutoff or ewald coefficients.
@@ -1054,7 +1086,7 @@
     }
 #        endif /* LJ_EWALD_GEOM */
 
-#        if defined VDW_CUTOFF_CHECK
+#        if defined VDW_CUTOFF_CHECK && !defined SKIP_CUTOFF_CHECK
     /* frLJ is multiplied later by rinvsq, which is masked for the Coulomb
      * cut-off, but if the VdW cut-off is shorter, we need to mask with that.
      */
@@ -1066,7 +1098,7 @@
 #            endif
 #        endif
 
-#        ifdef CALC_ENERGIES
+#        if defined CALC_ENERGIES && !defined SKIP_CUTOFF_CHECK
     /* The potential shift should be removed for pairs beyond cut-off */
     VLJ_S0 = selectByMask(VLJ_S0, wco_vdw_S0);
     VLJ_S1 = selectByMask(VLJ_S1, wco_vdw_S1);
@@ -413,6 +413,8 @@
         do_LJ   = ((ciEntry.shift & NBNXN_CI_DO_LJ(0)) != 0);
         do_coul = ((ciEntry.shift & NBNXN_CI_DO_COUL(0)) != 0);
         half_LJ = (((ciEntry.shift & NBNXN_CI_HALF_LJ(0)) != 0) || !do_LJ) && do_coul;
+        /* With this flag set, all j-clusters without exclusions are in range */
+        const bool allJInRange = ((ciEntry.shift & NBNXN_CI_ALL_J_IN_RANGE) != 0);
 
 #ifdef ENERGY_GROUPS
         egps_i = nbatParams.energrp[ci];
@@ -621,9 +623,21 @@
                 cjind++;
             }
 #undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
+            if (allJInRange)
             {
+#define SKIP_CUTOFF_CHECK
+                for (; (cjind < cjind1); cjind++)
+                {
 #include "kernel_inner.h"
+                }
+#undef SKIP_CUTOFF_CHECK
+            }
+            else
+            {
+                for (; (cjind < cjind1); cjind++)
+                {
+#include "kernel_inner.h"
+                }
             }
 #undef HALF_LJ
 #undef CALC_COULOMB
@@ -639,9 +653,21 @@
                 cjind++;
             }
 #undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
+            if (allJInRange)
             {
+#define SKIP_CUTOFF_CHECK
+                for (; (cjind < cjind1); cjind++)
+                {
 #include "kernel_inner.h"
+                }
+#undef SKIP_CUTOFF_CHECK
+            }
+            else
+            {
+                for (; (cjind < cjind1); cjind++)
+                {
+#include "kernel_inner.h"
+                }
             }
 #undef CALC_COULOMB
         }
@@ -655,9 +681,21 @@
                 cjind++;
             }
 #undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
+            if (allJInRange)
+            {
+#define SKIP_CUTOFF_CHECK
+                for (; (cjind < cjind1); cjind++)
+                {
+#include "kernel_inner.h"
+                }
+#undef SKIP_CUTOFF_CHECK
+            }
+            else
             {
+                for (; (cjind < cjind1); cjind++)
+                {
 #include "kernel_inner.h"
+                }
             }
         }
 #undef CALC_LJ
@@ -47,8 +47,10 @@
 
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/timing/gpu_timing.h"
 #include "gromacs/timing/wallcycle.h"
 
+#include "gpucpuworksplit.h"
 #include "nbnxm_gpu.h"
 #include "pairlistsets.h"
 #include "pairsearch.h"
@@ -121,9 +123,11 @@ void nonbonded_verlet_t::setLocalAtomOrder()
 
 void nonbonded_verlet_t::setAtomProperties(gmx::ArrayRef<const int>  atomTypes,
                                            gmx::ArrayRef<const real> atomCharges,
-                                           gmx::ArrayRef<const int>  atomInfo)
+                                           gmx::ArrayRef<const int>  atomInfo,
+                                           const int                 firstGrid)
 {
-    nbnxn_atomdata_set(nbat.get(), pairSearch_->gridSet(), atomTypes, atomCharges, atomInfo);
+    nbnxn_atomdata_set(
+            nbat.get(), pairSearch_->gridSet(), atomTypes, atomCharges, atomInfo, firstGrid);
 }
 
 void nonbonded_verlet_t::convertCoordinates(const gmx::AtomLocality        locality,
@@ -179,6 +183,14 @@ void nonbonded_verlet_t::atomdata_add_nbat_f_to_f(const gmx::AtomLocality  local
     wallcycle_stop(wcycle_, ewcNB_XF_BUF_OPS);
 }
 
+void nonbonded_verlet_t::addGpuWaitCyclesToWorkSplit(const double cycles)
+{
+    if (gpuCpuWorkSplit_)
+    {
+        gpuCpuWorkSplit_->addGpuWaitCycles(cycles);
+    }
+}
+
 int nonbonded_verlet_t::getNumAtoms(const gmx::AtomLocality locality)
 {
     int numAtoms = 0;
@@ -212,6 +224,18 @@ real nonbonded_verlet_t::pairlistOuterRadius() const
     return pairlistSets_->params().rlistOuter;
 }
 
+bool nonbonded_verlet_t::getGpuListCounters(gmx_gpu_nbnxn_list_counters_t* counters) const
+{
+    if (!pairlistSets_->params().computeGpuListCounters)
+    {
+        return false;
+    }
+
+    *counters = pairlistSets_->gpuListCounters();
+
+    return true;
+}
+
 void nonbonded_verlet_t::changePairlistRadii(real rlistOuter, real rlistInner)
 {
     pairlistSets_->changePairlistRadii(rlistOuter, rlistInner);
@@ -112,6 +112,7 @@
 #define GMX_NBNXM_NBNXM_H
 
 #include <memory>
+#include <vector>
 
 #include "gromacs/gpu_utils/devicebuffer_datatype.h"
 #include "gromacs/math/vectypes.h"
@@ -123,6 +124,7 @@
 struct DeviceInformation;
 struct gmx_domdec_zones_t;
 struct gmx_enerdata_t;
+struct gmx_gpu_nbnxn_list_counters_t;
 struct gmx_hw_info_t;
 struct gmx_mtop_t;
 struct NbnxmGpu;
@@ -158,6 +160,7 @@ class UpdateGroupsCog;
 //! Namespace for non-bonded kernels
 namespace Nbnxm
 {
+class GpuCpuWorkSplit;
 enum class KernelType;
 
 /*! \brief Nbnxm electrostatic GPU kernel flavors.
@@ -240,6 +243,8 @@ struct KernelSetup
     KernelType kernelType = KernelType::NotSet;
     //! Ewald exclusion computation handling type, currently only used for CPU
     EwaldExclusionType ewaldExclusionType = EwaldExclusionType::NotSet;
+    //! Whether the force-only GPU (emulation) kernels use the compact coordinate format
+    bool useCompactGpuXq = false;
 };
 
 /*! \brief Return a string identifying the kernel type.
@@ -312,10 +317,15 @@ public:
                            int64_t                      step,
                            t_nrnb*                      nrnb);
 
-    //! Updates all the atom properties in Nbnxm
+    /*! \brief Updates the atom properties in Nbnxm
+     *
+     * Only the atoms on the search grids with index \p firstGrid and higher are updated.
+     * With TPI, passing 1 updates only the molecule to insert, which has its own grid.
+     */
     void setAtomProperties(gmx::ArrayRef<const int>  atomTypes,
                            gmx::ArrayRef<const real> atomCharges,
-                           gmx::ArrayRef<const int>  atomInfo);
+                           gmx::ArrayRef<const int>  atomInfo,
+                           int                       firstGrid = 0);
 
     /*!\brief Convert the coordinates to NBNXM format for the given locality.
      *
@@ -350,6 +360,12 @@ public:
     //! Returns a reference to the pairlist sets
     const PairlistSets& pairlistSets() const { return *pairlistSets_; }
 
+    /*! \brief Gets the cluster and atom pair counts of the GPU lists, summed over searches
+     *
+     * \returns false when counting was not requested, \p counters is then not changed.
+     */
+    bool getGpuListCounters(gmx_gpu_nbnxn_list_counters_t* counters) const;
+
     //! Returns whether step is a dynamic list pruning step, for CPU lists
     bool isDynamicPruningStepCpu(int64_t step) const;
 
@@ -371,6 +387,19 @@ public:
                                  gmx_enerdata_t*            enerd,
                                  t_nrnb*                    nrnb);
 
+    /*! \brief Executes the local and non-local non-bonded CPU kernels in one parallel region
+     *
+     * Each thread computes its local and non-local lists one after the other,
+     * which avoids a fork-join and the barrier between two dispatchNonbondedKernel() calls.
+     * Should only be called with CPU kernels, when the non-local coordinates are available.
+     */
+    void dispatchLocalAndNonlocalNonbondedKernelCpu(const interaction_const_t& ic,
+                                                    const gmx::StepWorkload&   stepWork,
+                                                    int                        clearF,
+                                                    const t_forcerec&          fr,
+                                                    gmx_enerdata_t*            enerd,
+                                                    t_nrnb*                    nrnb);
+
     //! Executes the non-bonded free-energy kernel, always runs on the CPU
     void dispatchFreeEnergyKernel(gmx::InteractionLocality   iLocality,
                                   const t_forcerec*          fr,
@@ -383,6 +412,36 @@ public:
                                   const gmx::StepWorkload&   stepWork,
                                   t_nrnb*                    nrnb);
 
+    /*! \brief Enables computing part of the local GPU pair list on the CPU, when supported
+     *
+     * The size of the CPU part is adapted at every pair search step,
+     * based on the time the CPU waited for the GPU.
+     * The CPU part is computed with the plain-C GPU-layout kernel, which supports
+     * plain LJ cut-off with reaction-field or Ewald electrostatics only.
+     * The CPU part uses the coordinates and forces in host memory,
+     * so this should not be called with GPU buffer operations.
+     * Whether the split is enabled is reported in \p mdlog.
+     */
+    void enableGpuCpuWorkSplit(const gmx::MDLogger& mdlog, const interaction_const_t& ic);
+
+    //! Returns whether part of the local GPU pair list is computed on the CPU
+    bool haveGpuCpuWorkSplit() const { return gpuCpuWorkSplit_ != nullptr; }
+
+    /*! \brief Computes the CPU part of the local GPU pair list
+     *
+     * The forces, shift forces and energies are added directly to the output
+     * buffers, so they should not be cleared afterwards.
+     * Does nothing when haveGpuCpuWorkSplit() returns false.
+     */
+    void dispatchCpuPartOfGpuNonbondedKernel(const interaction_const_t& ic,
+                                             const gmx::StepWorkload&   stepWork,
+                                             const t_forcerec&          fr,
+                                             gmx::ForceWithShiftForces* forceWithShiftForces,
+                                             gmx_enerdata_t*            enerd);
+
+    //! Records the cycles the CPU waited for the local GPU output to adapt the GPU-CPU work split
+    void addGpuWaitCyclesToWorkSplit(double cycles);
+
     /*! \brief Add the forces stored in nbat to f, zeros the forces in nbat
      * \param [in] locality         Local or non-local
      * \param [inout] force         Force to be added to
@@ -431,6 +490,16 @@ private:
     Nbnxm::KernelSetup kernelSetup_;
     //! \brief Pointer to wallcycle structure.
     gmx_wallcycle* wcycle_;
+    //! Lambda values of all lambda states, for the foreign-lambda free-energy kernel
+    std::vector<real> foreignLambdas_;
+    //! dV/dlambda for all lambda states, accumulated by the foreign-lambda free-energy kernel
+    std::vector<real> foreignDvdl_;
+    //! Electrostatic energy group pair energies for all lambda states
+    std::vector<real> foreignEnergyGroupElec_;
+    //! Van der Waals energy group pair energies for all lambda states
+    std::vector<real> foreignEnergyGroupVdw_;
+    //! Setup for computing part of the local GPU list on the CPU, nullptr when not used
+    std::unique_ptr<Nbnxm::GpuCpuWorkSplit> gpuCpuWorkSplit_;
 
 public:
     //! GPU Nbnxm data, only used with a physical GPU (TODO: use unique_ptr)
@@ -191,8 +191,8 @@ void gpu_launch_cpyback(NbnxmGpu gmx_unused* nb,
  * \param[in]  nb             The nonbonded data GPU structure
  * \param[in]  stepWork       Step schedule flags
  * \param[in]  aloc           Atom locality identifier
- * \param[out] e_lj           Pointer to the LJ energy output to accumulate into
- * \param[out] e_el           Pointer to the electrostatics energy output to accumulate into
+ * \param[out] e_lj           Pointer to the LJ energy group-pair output to accumulate into
+ * \param[out] e_el           Pointer to the electrostatics energy group-pair output to accumulate into
  * \param[out] shiftForces    Shift forces buffer to accumulate into
  * \param[in]  completionKind Indicates whether nnbonded task completion should only be checked rather than waited for
  * \param[out] wcycle         Pointer to wallcycle data structure
@@ -218,8 +218,8 @@ bool gpu_try_finish_task(NbnxmGpu gmx_unused*    nb,
  * \param[in] nb The nonbonded data GPU structure
  * \param[in]  stepWork        Step schedule flags
  * \param[in] aloc Atom locality identifier
- * \param[out] e_lj Pointer to the LJ energy output to accumulate into
- * \param[out] e_el Pointer to the electrostatics energy output to accumulate into
+ * \param[out] e_lj Pointer to the LJ energy group-pair output to accumulate into
+ * \param[out] e_el Pointer to the electrostatics energy group-pair output to accumulate into
  * \param[out] shiftForces Shift forces buffer to accumulate into
  * \param[out] wcycle         Pointer to wallcycle data structure               */
 GPU_FUNC_QUALIFIER
@@ -233,9 +233,9 @@ float gpu_wait_finish_task(NbnxmGpu gmx_unused*    nb,
 
 /*! \brief Initialization for X buffer operations on GPU.
  * Called on the NS step and performs (re-)allocations and memory copies. !*/
-CUDA_FUNC_QUALIFIER
+CUDA_OR_SYCL_FUNC_QUALIFIER
 void nbnxn_gpu_init_x_to_nbat_x(const Nbnxm::GridSet gmx_unused& gridSet,
-                                NbnxmGpu gmx_unused* gpu_nbv) CUDA_FUNC_TERM;
+                                NbnxmGpu gmx_unused* gpu_nbv) CUDA_OR_SYCL_FUNC_TERM;
 
 /*! \brief X buffer operations on GPU: performs conversion from rvec to nb format.
  *
@@ -249,7 +249,7 @@ void nbnxn_gpu_init_x_to_nbat_x(const Nbnxm::GridSet gmx_unused& gridSet,
  * \param[in]     gridId           Index of the grid being converted.
  * \param[in]     numColumnsMax    Maximum number of columns in the grid.
  */
-CUDA_FUNC_QUALIFIER
+CUDA_OR_SYCL_FUNC_QUALIFIER
 void nbnxn_gpu_x_to_nbat_x(const Nbnxm::Grid gmx_unused& grid,
                            bool gmx_unused setFillerCoords,
                            NbnxmGpu gmx_unused*    gpu_nbv,
@@ -257,15 +257,15 @@ void nbnxn_gpu_x_to_nbat_x(const Nbnxm::Grid gmx_unused& grid,
                            GpuEventSynchronizer gmx_unused* xReadyOnDevice,
                            gmx::AtomLocality gmx_unused locality,
                            int gmx_unused gridId,
-                           int gmx_unused numColumnsMax) CUDA_FUNC_TERM;
+                           int gmx_unused numColumnsMax) CUDA_OR_SYCL_FUNC_TERM;
 
 /*! \brief Sync the nonlocal stream with dependent tasks in the local queue.
  * \param[in] nb                   The nonbonded data GPU structure
  * \param[in] interactionLocality  Local or NonLocal sync point
  */
-CUDA_FUNC_QUALIFIER
+CUDA_OR_SYCL_FUNC_QUALIFIER
 void nbnxnInsertNonlocalGpuDependency(const NbnxmGpu gmx_unused* nb,
-                                      gmx::InteractionLocality gmx_unused interactionLocality) CUDA_FUNC_TERM;
+                                      gmx::InteractionLocality gmx_unused interactionLocality) CUDA_OR_SYCL_FUNC_TERM;
 
 /*! \brief Set up internal flags that indicate what type of short-range work there is.
  *
@@ -56,6 +56,10 @@
 #    include "opencl/nbnxm_ocl_types.h"
 #endif
 
+#if GMX_GPU_SYCL
+#    include "sycl/nbnxm_sycl_types.h"
+#endif
+
 #include "nbnxm_gpu_data_mgmt.h"
 
 #include "gromacs/mdtypes/interaction_const.h"
@@ -246,13 +250,16 @@ void init_timings(gmx_wallclock_gpu_nbnxn_t* t)
 }
 
 //! This function is documented in the header file
-void gpu_init_pairlist(NbnxmGpu* nb, const NbnxnPairlistGpu* h_plist, const InteractionLocality iloc)
+void gpu_init_pairlist(NbnxmGpu*                 nb,
+                       const NbnxnPairlistGpu*   h_plist,
+                       const InteractionLocality iloc,
+                       const int                 numSci)
 {
     char sbuf[STRLEN];
     // Timing accumulation should happen only if there was work to do
     // because getLastRangeTime() gets skipped with empty lists later
     // which leads to the counter not being reset.
-    bool                bDoTime      = (nb->bDoTime && !h_plist->sci.empty());
+    bool                bDoTime      = (nb->bDoTime && numSci > 0);
     const DeviceStream& deviceStream = *nb->deviceStreams[iloc];
     gpu_plist*          d_plist      = nb->plist[iloc];
 
@@ -281,9 +288,11 @@ void gpu_init_pairlist(NbnxmGpu* nb, const NbnxnPairlistGpu* h_plist, const Inte
     // TODO most of this function is same in CUDA and OpenCL, move into the header
     const DeviceContext& deviceContext = *nb->deviceContext_;
 
-    reallocateDeviceBuffer(&d_plist->sci, h_plist->sci.size(), &d_plist->nsci, &d_plist->sci_nalloc,
+    GMX_ASSERT(numSci >= 0 && numSci <= gmx::ssize(h_plist->sci),
+               "Can not compute more i-superclusters than present in the list");
+    reallocateDeviceBuffer(&d_plist->sci, numSci, &d_plist->nsci, &d_plist->sci_nalloc,
                            deviceContext);
-    copyToDeviceBuffer(&d_plist->sci, h_plist->sci.data(), 0, h_plist->sci.size(), deviceStream,
+    copyToDeviceBuffer(&d_plist->sci, h_plist->sci.data(), 0, numSci, deviceStream,
                        GpuApiCallBehavior::Async, bDoTime ? iTimers.pl_h2d.fetchNextEvent() : nullptr);
 
     reallocateDeviceBuffer(&d_plist->cj4, h_plist->cj4.size(), &d_plist->ncj4, &d_plist->cj4_nalloc,
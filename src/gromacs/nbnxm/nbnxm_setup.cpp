@@ -42,6 +42,8 @@
 
 #include "gmxpre.h"
 
+#include <algorithm>
+
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/hardware/hw_info.h"
@@ -59,6 +61,7 @@
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/logger.h"
 
+#include "gpucpuworksplit.h"
 #include "grid.h"
 #include "nbnxm_geometry.h"
 #include "nbnxm_simd.h"
@@ -267,6 +270,20 @@ static KernelSetup pick_nbnxn_kernel(const gmx::MDLogger&     mdlog,
         }
     }
 
+    /* The compact format is only implemented in CUDA and the GPU emulation */
+    if ((nonbondedResource == NonbondedResource::EmulateGpu
+         || (nonbondedResource == NonbondedResource::Gpu && GMX_GPU_CUDA))
+        && getenv("GMX_GPU_NB_COMPACT_XQ") != nullptr)
+    {
+        kernelSetup.useCompactGpuXq = true;
+
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendText(
+                        "Using compact fixed-point j-atom coordinates in the force-only "
+                        "nonbonded GPU kernels");
+    }
+
     GMX_LOG(mdlog.info)
             .asParagraph()
             .appendTextFormatted("Using %s %dx%d nonbonded short-range kernels",
@@ -388,6 +405,68 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger& mdlog,
 
     setupDynamicPairlistPruning(mdlog, ir, mtop, box, fr->ic, &pairlistParams);
 
+    if (getenv("GMX_NBNXN_SPLIT_IN_RANGE") != nullptr
+        && (kernelSetup.kernelType == KernelType::Cpu4xN_Simd_4xN
+            || kernelSetup.kernelType == KernelType::Cpu4xN_Simd_2xNN))
+    {
+        /* Only the SIMD kernels have a path without cut-off masking */
+        pairlistParams.splitFullyInRangeJClusters = true;
+        pairlistParams.rcutoffMin                 = std::min(fr->ic->rcoulomb, fr->ic->rvdw);
+
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendText(
+                        "Using separate pair-list entries for cluster pairs fully within the "
+                        "cut-off");
+    }
+
+    const char* numListsEnv = getenv("GMX_NBNXN_NUM_LISTS");
+    if (numListsEnv != nullptr && Nbnxm::kernelTypeUsesSimplePairlist(kernelSetup.kernelType)
+        && !emulateGpu)
+    {
+        const int numLists = strtol(numListsEnv, nullptr, 10);
+        if (numLists < 1 || numLists > NBNXN_BUFFERFLAG_MAX_THREADS)
+        {
+            gmx_fatal(FARGS, "GMX_NBNXN_NUM_LISTS should be between 1 and %d, not '%s'",
+                      NBNXN_BUFFERFLAG_MAX_THREADS, numListsEnv);
+        }
+        if (bFEP_NonBonded)
+        {
+            GMX_LOG(mdlog.warning)
+                    .asParagraph()
+                    .appendText(
+                            "GMX_NBNXN_NUM_LISTS is ignored with perturbed non-bonded "
+                            "interactions");
+        }
+        else
+        {
+            /* With a fixed number of lists and output buffers the force
+             * summation order does not depend on the number of threads.
+             */
+            pairlistParams.fixedNumCpuLists = numLists;
+
+            GMX_LOG(mdlog.info)
+                    .asParagraph()
+                    .appendTextFormatted(
+                            "Using %d non-bonded pair lists, forces are independent of the "
+                            "number of OpenMP threads",
+                            numLists);
+        }
+    }
+
+    if (getenv("GMX_NBNXN_GPU_LIST_COUNTERS") != nullptr
+        && pairlistParams.pairlistType == PairlistType::HierarchicalNxN)
+    {
+        pairlistParams.computeGpuListCounters = true;
+        pairlistParams.rcutoffMax             = std::max(fr->ic->rcoulomb, fr->ic->rvdw);
+
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendText(
+                        "Counting cluster and atom pairs in the GPU pair lists, this slows down "
+                        "the pair search");
+    }
+
     int enbnxninitcombrule;
     if (fr->ic->vdwtype == evdwCUT
         && (fr->ic->vdw_modifier == eintmodNONE || fr->ic->vdw_modifier == eintmodPOTSHIFT)
@@ -428,9 +507,17 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger& mdlog,
          */
         mimimumNumEnergyGroupNonbonded = 1;
     }
+    int numOutputBuffers = gmx_omp_nthreads_get(emntNonbonded);
+    if (useGpuForNonbonded || emulateGpu)
+    {
+        numOutputBuffers = 1;
+    }
+    else if (pairlistParams.fixedNumCpuLists > 0)
+    {
+        numOutputBuffers = pairlistParams.fixedNumCpuLists;
+    }
     nbnxn_atomdata_init(mdlog, nbat.get(), kernelSetup.kernelType, enbnxninitcombrule, fr->ntype,
-                        fr->nbfp, mimimumNumEnergyGroupNonbonded,
-                        (useGpuForNonbonded || emulateGpu) ? 1 : gmx_omp_nthreads_get(emntNonbonded));
+                        fr->nbfp, mimimumNumEnergyGroupNonbonded, numOutputBuffers);
 
     NbnxmGpu* gpu_nbv                          = nullptr;
     int       minimumIlistCountForGpuBalancing = 0;
@@ -452,7 +539,8 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger& mdlog,
     auto pairSearch = std::make_unique<PairSearch>(
             ir->pbcType, EI_TPI(ir->eI), DOMAINDECOMP(cr) ? &cr->dd->numCells : nullptr,
             DOMAINDECOMP(cr) ? domdec_zones(cr->dd) : nullptr, pairlistParams.pairlistType,
-            bFEP_NonBonded, gmx_omp_nthreads_get(emntPairsearch), pinPolicy);
+            bFEP_NonBonded,
+            std::max(gmx_omp_nthreads_get(emntPairsearch), pairlistParams.fixedNumCpuLists), pinPolicy);
 
     return std::make_unique<nonbonded_verlet_t>(std::move(pairlistSets), std::move(pairSearch),
                                                 std::move(nbat), kernelSetup, gpu_nbv, wcycle);
@@ -482,3 +570,31 @@ nonbonded_verlet_t::~nonbonded_verlet_t()
 {
     Nbnxm::gpu_free(gpu_nbv);
 }
+
+void nonbonded_verlet_t::enableGpuCpuWorkSplit(const gmx::MDLogger&       mdlog,
+                                               const interaction_const_t& ic)
+{
+    GMX_RELEASE_ASSERT(useGpu(), "The GPU-CPU work split can only be used with a GPU");
+
+    /* The plain-C GPU-layout kernel only supports plain LJ with cut-off */
+    if (ic.vdwtype != evdwCUT
+        || !(ic.vdw_modifier == eintmodNONE || ic.vdw_modifier == eintmodPOTSHIFT))
+    {
+        GMX_LOG(mdlog.warning)
+                .asParagraph()
+                .appendText(
+                        "Computing part of the non-bonded work on the CPU is only supported with "
+                        "plain Lennard-Jones interactions with cut-off, all non-bonded work is "
+                        "done on the GPU");
+        return;
+    }
+
+    gpuCpuWorkSplit_ = std::make_unique<Nbnxm::GpuCpuWorkSplit>(
+            nbat->params().nenergrp, gmx_omp_nthreads_get(emntNonbonded));
+
+    GMX_LOG(mdlog.info)
+            .asParagraph()
+            .appendText(
+                    "Computing part of the local non-bonded pair list on the CPU when the CPU "
+                    "waits for the GPU, the CPU part is adapted at every pair search step");
+}
@@ -101,6 +101,8 @@ struct nb_staging_t
     float* e_lj = nullptr;
     //! electrostatic energy
     float* e_el = nullptr;
+    //! number of energy group pairs, always 1 as energy groups are not supported
+    int numEnergyGroupPairs = 1;
     //! float3 buffer with shift forces
     float (*fshift)[3] = nullptr;
 };
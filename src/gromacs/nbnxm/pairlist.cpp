@@ -41,6 +41,7 @@
 #include "config.h"
 
 #include <cassert>
+#include <cinttypes>
 #include <cmath>
 #include <cstring>
 
@@ -61,6 +62,7 @@
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/simd/simd.h"
 #include "gromacs/simd/vector_operations.h"
+#include "gromacs/timing/gpu_timing.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxomp.h"
@@ -69,6 +71,7 @@
 
 #include "boundingboxes.h"
 #include "clusterdistancekerneltype.h"
+#include "gpucpuworksplit.h"
 #include "gridset.h"
 #include "nbnxm_geometry.h"
 #include "nbnxm_simd.h"
@@ -341,6 +344,20 @@ get_cell_range(real b0, real b1, const Grid::Dimensions& jGridDims, real d2, rea
    }
  */
 
+/*! \brief Returns the maximum distance^2 between any two points in two bounding boxes
+ *
+ * \param[in] bb_i  First bounding box
+ * \param[in] bb_j  Second bounding box
+ */
+static float clusterBoundingBoxMaxDistance2(const BoundingBox& bb_i, const BoundingBox& bb_j)
+{
+    const float dx = std::max(bb_i.upper.x - bb_j.lower.x, bb_j.upper.x - bb_i.lower.x);
+    const float dy = std::max(bb_i.upper.y - bb_j.lower.y, bb_j.upper.y - bb_i.lower.y);
+    const float dz = std::max(bb_i.upper.z - bb_j.lower.z, bb_j.upper.z - bb_i.lower.z);
+
+    return dx * dx + dy * dy + dz * dz;
+}
+
 #if !NBNXN_SEARCH_BB_SIMD4
 
 /*! \brief Plain C code calculating the distance^2 between two bounding boxes in xyz0 format
@@ -687,7 +704,11 @@ PairlistSet::PairlistSet(const InteractionLocality locality, const PairlistParam
     // Currently GPU lists are always combined
     combineLists_ = !isCpuType_;
 
-    const int numLists = gmx_omp_nthreads_get(emntNonbonded);
+    const int numLists = (isCpuType_ && params_.fixedNumCpuLists > 0)
+                                 ? params_.fixedNumCpuLists
+                                 : gmx_omp_nthreads_get(emntNonbonded);
+    GMX_RELEASE_ASSERT(!params_.haveFep || numLists == gmx_omp_nthreads_get(emntNonbonded),
+                       "With FEP the number of lists should match the number of threads");
 
     if (!combineLists_ && numLists > NBNXN_BUFFERFLAG_MAX_THREADS)
     {
@@ -762,12 +783,20 @@ static void print_nblist_statistics(FILE*                   fp,
     fprintf(fp, "nbl average j cell list length %.1f\n",
             0.25 * nbl.ncjInUse / std::max(static_cast<double>(nbl.ci.size()), 1.0));
 
-    int cs[SHIFTS] = { 0 };
-    int npexcl     = 0;
+    int cs[SHIFTS]         = { 0 };
+    int npexcl             = 0;
+    int numInRangeEntries  = 0;
+    int numInRangeClusters = 0;
     for (const nbnxn_ci_t& ciEntry : nbl.ci)
     {
         cs[ciEntry.shift & NBNXN_CI_SHIFT] += ciEntry.cj_ind_end - ciEntry.cj_ind_start;
 
+        if (ciEntry.shift & NBNXN_CI_ALL_J_IN_RANGE)
+        {
+            numInRangeEntries++;
+            numInRangeClusters += ciEntry.cj_ind_end - ciEntry.cj_ind_start;
+        }
+
         int j = ciEntry.cj_ind_start;
         while (j < ciEntry.cj_ind_end && nbl.cj[j].excl != NBNXN_INTERACTION_MASK_ALL)
         {
@@ -777,6 +806,14 @@ static void print_nblist_statistics(FILE*                   fp,
     }
     fprintf(fp, "nbl cell pairs, total: %zu excl: %d %.1f%%\n", nbl.cj.size(), npexcl,
             100 * npexcl / std::max(static_cast<double>(nbl.cj.size()), 1.0));
+    if (numInRangeEntries > 0)
+    {
+        /* These cluster pairs are computed without cut-off masking */
+        fprintf(fp, "nbl cell pairs fully in range: %d %.1f%% in %d i-entries\n",
+                numInRangeClusters,
+                100 * numInRangeClusters / std::max(static_cast<double>(nbl.cj.size()), 1.0),
+                numInRangeEntries);
+    }
     for (int s = 0; s < SHIFTS; s++)
     {
         if (cs[s] > 0)
@@ -1695,6 +1732,131 @@ static inline int a_mod_wj(int a)
     return a & (c_nbnxnGpuClusterSize / c_nbnxnGpuClusterpairSplit - 1);
 }
 
+/* Counts the cluster and atom pairs in GPU list \p nbl, as computed by the kernels
+ *
+ * The counts are added to \p counters. Only cluster pairs with at least one atom
+ * pair within \p rlistInner are computed by the kernels, as the others are pruned.
+ * Atom pairs within \p rcutoff and not masked by exclusions are the useful work.
+ */
+static void addGpuListCounters(const NbnxnPairlistGpu&        nbl,
+                               const nbnxn_atomdata_t&        nbat,
+                               const real                     rlistInner,
+                               const real                     rcutoff,
+                               gmx_gpu_nbnxn_list_counters_t* counters)
+{
+    const real  rlistInner2 = rlistInner * rlistInner;
+    const real  rcutoff2    = rcutoff * rcutoff;
+    const int   numSci      = gmx::ssize(nbl.sci);
+    const real* x           = nbat.x().data();
+
+    int64_t numClusterPairs         = 0;
+    int64_t numClusterPairsInner    = 0;
+    int64_t numAtomPairsNotExcluded = 0;
+    int64_t numAtomPairsInRange     = 0;
+
+#pragma omp parallel for schedule(static) num_threads(gmx_omp_nthreads_get(emntPairsearch)) \
+    reduction(+: numClusterPairs, numClusterPairsInner, numAtomPairsNotExcluded, \
+              numAtomPairsInRange)
+    for (int s = 0; s < numSci; s++)
+    {
+        const nbnxn_sci_t& sci   = nbl.sci[s];
+        const gmx::RVec&   shift = nbat.shift_vec[sci.shift & NBNXN_CI_SHIFT];
+
+        for (int cj4Ind = sci.cj4_ind_start; cj4Ind < sci.cj4_ind_end; cj4Ind++)
+        {
+            const nbnxn_cj4_t& cj4 = nbl.cj4[cj4Ind];
+
+            for (int jm = 0; jm < c_nbnxnGpuJgroupSize; jm++)
+            {
+                for (int c = 0; c < c_gpuNumClusterPerCell; c++)
+                {
+                    const unsigned int maskBit = 1U << (jm * c_gpuNumClusterPerCell + c);
+                    if ((cj4.imei[0].imask & maskBit) == 0)
+                    {
+                        continue;
+                    }
+                    numClusterPairs++;
+
+                    const int ciAtomStart = (sci.sci * c_gpuNumClusterPerCell + c) * nbl.na_ci;
+                    const int cjAtomStart = cj4.cj[jm] * nbl.na_cj;
+
+                    bool    isInInnerList  = false;
+                    int64_t numNotExcluded = 0;
+                    int64_t numInRange     = 0;
+                    for (int j = 0; j < nbl.na_cj; j++)
+                    {
+                        const int jHalf = j / (c_nbnxnGpuClusterSize / c_nbnxnGpuClusterpairSplit);
+                        const nbnxn_excl_t& excl = nbl.excl[cj4.imei[jHalf].excl_ind];
+                        const real*         xj   = x + (cjAtomStart + j) * nbat.xstride;
+
+                        for (int i = 0; i < nbl.na_ci; i++)
+                        {
+                            const real* xi = x + (ciAtomStart + i) * nbat.xstride;
+                            const real  dx = xi[XX] + shift[XX] - xj[XX];
+                            const real  dy = xi[YY] + shift[YY] - xj[YY];
+                            const real  dz = xi[ZZ] + shift[ZZ] - xj[ZZ];
+                            const real  r2 = dx * dx + dy * dy + dz * dz;
+
+                            isInInnerList = isInInnerList || (r2 < rlistInner2);
+
+                            if (excl.pair[a_mod_wj(j) * nbl.na_ci + i] & maskBit)
+                            {
+                                numNotExcluded++;
+                                if (r2 < rcutoff2)
+                                {
+                                    numInRange++;
+                                }
+                            }
+                        }
+                    }
+                    if (isInInnerList)
+                    {
+                        numClusterPairsInner++;
+                        numAtomPairsNotExcluded += numNotExcluded;
+                        numAtomPairsInRange += numInRange;
+                    }
+                }
+            }
+        }
+    }
+
+    counters->numSearches++;
+    counters->numClusterPairs += numClusterPairs;
+    counters->numClusterPairsInner += numClusterPairsInner;
+    counters->numAtomPairs += numClusterPairsInner * nbl.na_ci * nbl.na_cj;
+    counters->numAtomPairsNotExcluded += numAtomPairsNotExcluded;
+    counters->numAtomPairsInRange += numAtomPairsInRange;
+}
+
+/* Adds the cluster and atom pair counts in \p src to \p dest */
+static void accumulateGpuListCounters(const gmx_gpu_nbnxn_list_counters_t& src,
+                                      gmx_gpu_nbnxn_list_counters_t*       dest)
+{
+    dest->numSearches += src.numSearches;
+    dest->numClusterPairs += src.numClusterPairs;
+    dest->numClusterPairsInner += src.numClusterPairsInner;
+    dest->numAtomPairs += src.numAtomPairs;
+    dest->numAtomPairsNotExcluded += src.numAtomPairsNotExcluded;
+    dest->numAtomPairsInRange += src.numAtomPairsInRange;
+}
+
+/* Prints the efficiency of the list given by the cluster and atom pair counters */
+static void printGpuListCounters(FILE* fp, const gmx_gpu_nbnxn_list_counters_t& counters)
+{
+    if (counters.numClusterPairs == 0 || counters.numAtomPairs == 0)
+    {
+        return;
+    }
+
+    fprintf(fp, "nbl cluster-pairs %" PRId64 " inner %" PRId64 " pruned %.1f%%\n",
+            counters.numClusterPairs, counters.numClusterPairsInner,
+            100.0 * (counters.numClusterPairs - counters.numClusterPairsInner)
+                    / counters.numClusterPairs);
+    fprintf(fp, "nbl atom-pairs %" PRId64 " not excluded %.1f%% in range %.1f%%\n",
+            counters.numAtomPairs, 100.0 * counters.numAtomPairsNotExcluded / counters.numAtomPairs,
+            100.0 * counters.numAtomPairsInRange / counters.numAtomPairs);
+}
+
 /* As make_fep_list above, but for super/sub lists. */
 static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
                           const nbnxn_atomdata_t*  nbat,
@@ -1729,14 +1891,26 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
     const int cj4_ind_start = nbl_sci->cj4_ind_start;
     const int cj4_ind_end   = nbl_sci->cj4_ind_end;
 
+    const nbnxn_atomdata_t::Params& nbatParams = nbat->params();
+
+    const int ngid = nbatParams.nenergrp;
+
     /* Here we process one super-cell, max #atoms na_sc, versus a list
      * cj4 entries, each with max c_nbnxnGpuJgroupSize cj's, each
      * of size na_cj atoms.
-     * On the GPU we don't support energy groups (yet).
-     * So for each of the na_sc i-atoms, we need max one FEP list
-     * for each max_nrj_fep j-atoms.
+     * Without energy groups, for each of the na_sc i-atoms, we need max
+     * one FEP list for each max_nrj_fep j-atoms. With energy groups,
+     * in worst case the group pair changes for every j-atom.
      */
-    nri_max = nbl->na_sc * nbl->na_cj * (1 + (numJClusterGroups * c_nbnxnGpuJgroupSize) / max_nrj_fep);
+    if (ngid > 1)
+    {
+        nri_max = nbl->na_sc * nbl->na_cj * numJClusterGroups * c_nbnxnGpuJgroupSize;
+    }
+    else
+    {
+        nri_max = nbl->na_sc * nbl->na_cj
+                  * (1 + (numJClusterGroups * c_nbnxnGpuJgroupSize) / max_nrj_fep);
+    }
     if (nlist->nri + nri_max > nlist->maxnri)
     {
         nlist->maxnri = over_alloc_large(nlist->nri + nri_max);
@@ -1757,10 +1931,13 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
                 nri                    = nlist->nri;
                 nlist->jindex[nri + 1] = nlist->jindex[nri];
                 nlist->iinr[nri]       = ai;
-                /* With GPUs, energy groups are not supported */
+                /* The actual energy group pair index is set later */
                 nlist->gid[nri]   = 0;
                 nlist->shift[nri] = nbl_sci->shift & NBNXN_CI_SHIFT;
 
+                /* With GPU lists the energy group is stored per atom */
+                const int gid_i = (ngid > 1 ? nbatParams.energrp[ind_i] : 0);
+
                 bFEP_i = iGrid.atomIsPerturbed(c_abs - iGrid.cellOffset() * c_gpuNumClusterPerCell, i);
 
                 xi = nbat->x()[ind_i * nbat->xstride + XX] + shx;
@@ -1823,6 +2000,21 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
                                      */
                                     if (dx * dx + dy * dy + dz * dz < rlist_fep2)
                                     {
+                                        if (ngid > 1)
+                                        {
+                                            const int gid =
+                                                    GID(gid_i, nbatParams.energrp[ind_j], ngid);
+
+                                            if (nlist->nrj > nlist->jindex[nri]
+                                                && nlist->gid[nri] != gid)
+                                            {
+                                                /* Energy group pair changed: new list */
+                                                fep_list_new_nri_copy(nlist);
+                                                nri = nlist->nri;
+                                            }
+                                            nlist->gid[nri] = gid;
+                                        }
+
                                         if (nlist->nrj - nlist->jindex[nri] >= max_nrj_fep)
                                         {
                                             fep_list_new_nri_copy(nlist);
@@ -2029,15 +2221,205 @@ static void sort_cj_excl(nbnxn_cj_t* cj, int ncj, NbnxnPairlistCpuWork* work)
     }
 }
 
+/* The minimum number of fully in range j-clusters worth a separate i-entry */
+static constexpr int c_minNumJClustersForInRangeSplit = 4;
+
+/* Moves the j-clusters without exclusions of i-entry ciIndex of nbl for which
+ * all atom pairs are within distance sqrt(rFullyInRange2) to a new i-entry
+ * with flag NBNXN_CI_ALL_J_IN_RANGE set, so the kernels can skip cut-off masking.
+ * The j-clusters with exclusions have to be sorted to the start of the list.
+ */
+static void splitOffFullyInRangeJClusters(NbnxnPairlistCpu* nbl,
+                                          const int         ciIndex,
+                                          const Grid&       jGrid,
+                                          real              rFullyInRange2)
+{
+    const BoundingBox& bb_ci  = nbl->work->iClusterData.bb[0];
+    nbnxn_ci_t         ciEntry = nbl->ci[ciIndex];
+
+    /* The j-cluster index in the list includes the offset of the j-grid */
+    const int jClusterOffset =
+            (jGrid.cellOffset() * c_nbnxnCpuIClusterSize) / jGrid.geometry().numAtomsJCluster;
+
+    auto jClusterIsInRange = [&](const nbnxn_cj_t& cjEntry) {
+        return clusterBoundingBoxMaxDistance2(bb_ci, jGrid.jBoundingBoxes()[cjEntry.cj - jClusterOffset])
+               < rFullyInRange2;
+    };
+
+    int cjIndFirst = ciEntry.cj_ind_start;
+    while (cjIndFirst < ciEntry.cj_ind_end && nbl->cj[cjIndFirst].excl != NBNXN_INTERACTION_MASK_ALL)
+    {
+        cjIndFirst++;
+    }
+
+    int numInRange = 0;
+    for (int j = cjIndFirst; j < ciEntry.cj_ind_end; j++)
+    {
+        if (jClusterIsInRange(nbl->cj[j]))
+        {
+            numInRange++;
+        }
+    }
+    if (numInRange < c_minNumJClustersForInRangeSplit)
+    {
+        return;
+    }
+
+    /* Move the in range j-clusters to the end of the list, keeping the order */
+    std::vector<nbnxn_cj_t>& work = nbl->work->cj;
+    work.resize(numInRange);
+    int jNew     = cjIndFirst;
+    int numMoved = 0;
+    for (int j = cjIndFirst; j < ciEntry.cj_ind_end; j++)
+    {
+        if (jClusterIsInRange(nbl->cj[j]))
+        {
+            work[numMoved++] = nbl->cj[j];
+        }
+        else
+        {
+            nbl->cj[jNew++] = nbl->cj[j];
+        }
+    }
+    std::copy(work.begin(), work.end(), nbl->cj.begin() + jNew);
+
+    if (jNew == ciEntry.cj_ind_start)
+    {
+        /* All j-clusters are in range, we only need to set the flag */
+        nbl->ci[ciIndex].shift |= NBNXN_CI_ALL_J_IN_RANGE;
+    }
+    else
+    {
+        nbl->ci[ciIndex].cj_ind_end = jNew;
+
+        ciEntry.shift |= NBNXN_CI_ALL_J_IN_RANGE;
+        ciEntry.cj_ind_start = jNew;
+        nbl->ci.push_back(ciEntry);
+    }
+}
+
+/* Returns the Coulomb and LJ interaction flags of j-cluster cj
+ *
+ * The grid stores the flags per cluster of the i-cluster size, a j-cluster
+ * gets the union of the flags of the i-clusters it overlaps with.
+ */
+static int jClusterInteractionFlags(const Grid& jGrid, const int cj)
+{
+    const int numAtomsJCluster = jGrid.geometry().numAtomsJCluster;
+    /* The j-cluster index in the list includes the offset of the j-grid */
+    const int firstAtom = cj * numAtomsJCluster - jGrid.cellOffset() * c_nbnxnCpuIClusterSize;
+    const int lastAtom  = firstAtom + numAtomsJCluster - 1;
+
+    gmx::ArrayRef<const int> clusterFlags = jGrid.clusterFlags();
+    int                      flags        = 0;
+    for (int c = firstAtom / c_nbnxnCpuIClusterSize; c <= lastAtom / c_nbnxnCpuIClusterSize; c++)
+    {
+        flags |= clusterFlags[c];
+    }
+
+    return flags & (NBNXN_CI_DO_LJ(0) | NBNXN_CI_DO_COUL(0));
+}
+
+/* Splits the last i-entry of nbl on the interactions with its j-clusters
+ *
+ * The flags of an i-entry tell the kernels whether the i-cluster has
+ * LJ and/or Coulomb interactions. Here we also take the j-clusters into
+ * account: j-clusters without charges are moved to a new i-entry without
+ * the Coulomb flag, j-clusters without LJ to a new i-entry without the LJ
+ * flag and j-clusters with neither are removed. With many uncharged or
+ * LJ-free clusters, as in coarse-grained and united-atom systems, this lets
+ * the kernels skip Coulomb or LJ computations that would only add zeros.
+ * The order of the j-clusters, with exclusions first, is kept in each entry.
+ * The entry containing the self-interaction keeps the i-cluster flags.
+ */
+static void splitOffJClustersOnInteractions(NbnxnPairlistCpu* nbl, const Grid& jGrid)
+{
+    const nbnxn_ci_t ciEntry = nbl->ci.back();
+    GMX_ASSERT(ciEntry.cj_ind_end == static_cast<int>(nbl->cj.size()),
+               "The last i-entry should have the last j-clusters");
+
+    const int iFlags = ciEntry.shift & (NBNXN_CI_DO_LJ(0) | NBNXN_CI_DO_COUL(0));
+
+    /* The i-entry flags for pairs with only LJ and with only Coulomb */
+    const int flagsLJOnly   = ciEntry.shift & ~NBNXN_CI_DO_COUL(0);
+    const int flagsCoulOnly = ciEntry.shift & ~(NBNXN_CI_DO_LJ(0) | NBNXN_CI_HALF_LJ(0));
+
+    std::vector<nbnxn_cj_t>& work = nbl->work->cj;
+    work.resize(ciEntry.cj_ind_end - ciEntry.cj_ind_start);
+    /* We first store the LJ-only j-clusters in work, the Coulomb-only
+     * j-clusters are stored from the end of work backward.
+     */
+    int numFull     = 0;
+    int numLJOnly   = 0;
+    int numCoulOnly = 0;
+    for (int j = ciEntry.cj_ind_start; j < ciEntry.cj_ind_end; j++)
+    {
+        const int pairFlags = iFlags & jClusterInteractionFlags(jGrid, nbl->cj[j].cj);
+        if (pairFlags == iFlags)
+        {
+            nbl->cj[ciEntry.cj_ind_start + numFull++] = nbl->cj[j];
+        }
+        else if (pairFlags == NBNXN_CI_DO_LJ(0))
+        {
+            work[numLJOnly++] = nbl->cj[j];
+        }
+        else if (pairFlags == NBNXN_CI_DO_COUL(0))
+        {
+            numCoulOnly++;
+            work[work.size() - numCoulOnly] = nbl->cj[j];
+        }
+    }
+    if (numFull == ciEntry.cj_ind_end - ciEntry.cj_ind_start)
+    {
+        return;
+    }
+
+    const int numRemoved =
+            ciEntry.cj_ind_end - ciEntry.cj_ind_start - numFull - numLJOnly - numCoulOnly;
+    nbl->cj.resize(nbl->cj.size() - numRemoved);
+    nbl->ncjInUse -= numRemoved;
+
+    int cjIndex = ciEntry.cj_ind_start + numFull;
+    std::copy(work.begin(), work.begin() + numLJOnly, nbl->cj.begin() + cjIndex);
+    std::reverse_copy(work.end() - numCoulOnly, work.end(), nbl->cj.begin() + cjIndex + numLJOnly);
+
+    if (numFull > 0)
+    {
+        nbl->ci.back().cj_ind_end = cjIndex;
+    }
+    else
+    {
+        nbl->ci.pop_back();
+    }
+    nbnxn_ci_t newEntry = ciEntry;
+    if (numLJOnly > 0)
+    {
+        newEntry.shift        = flagsLJOnly;
+        newEntry.cj_ind_start = cjIndex;
+        newEntry.cj_ind_end   = cjIndex + numLJOnly;
+        nbl->ci.push_back(newEntry);
+        cjIndex += numLJOnly;
+    }
+    if (numCoulOnly > 0)
+    {
+        newEntry.shift        = flagsCoulOnly;
+        newEntry.cj_ind_start = cjIndex;
+        newEntry.cj_ind_end   = cjIndex + numCoulOnly;
+        nbl->ci.push_back(newEntry);
+    }
+}
+
 /* Close this simple list i entry */
 static void closeIEntry(NbnxnPairlistCpu* nbl,
+                        const Grid&       jGrid,
+                        real              rFullyInRange2,
                         int gmx_unused sp_max_av,
                         gmx_bool gmx_unused progBal,
                         float gmx_unused nsp_tot_est,
                         int gmx_unused thread,
                         int gmx_unused nthread)
 {
-    nbnxn_ci_t& ciEntry = nbl->ci.back();
+    const nbnxn_ci_t& ciEntry = nbl->ci.back();
 
     /* All content of the new ci entry have already been filled correctly,
      * we only need to sort and increase counts or remove the entry when empty.
@@ -2047,16 +2429,32 @@ static void closeIEntry(NbnxnPairlistCpu* nbl,
     {
         sort_cj_excl(nbl->cj.data() + ciEntry.cj_ind_start, jlen, nbl->work.get());
 
-        /* The counts below are used for non-bonded pair/flop counts
-         * and should therefore match the available kernel setups.
-         */
-        if (!(ciEntry.shift & NBNXN_CI_DO_COUL(0)))
-        {
-            nbl->work->ncj_noq += jlen;
-        }
-        else if ((ciEntry.shift & NBNXN_CI_HALF_LJ(0)) || !(ciEntry.shift & NBNXN_CI_DO_LJ(0)))
+        /* Note that this can replace the entry by up to three entries */
+        const int ciIndexStart = nbl->ci.size() - 1;
+        splitOffJClustersOnInteractions(nbl, jGrid);
+        const int ciIndexEnd = nbl->ci.size();
+
+        for (int ciIndex = ciIndexStart; ciIndex < ciIndexEnd; ciIndex++)
         {
-            nbl->work->ncj_hlj += jlen;
+            const nbnxn_ci_t& entry = nbl->ci[ciIndex];
+            const int         numJ  = entry.cj_ind_end - entry.cj_ind_start;
+
+            /* The counts below are used for non-bonded pair/flop counts
+             * and should therefore match the available kernel setups.
+             */
+            if (!(entry.shift & NBNXN_CI_DO_COUL(0)))
+            {
+                nbl->work->ncj_noq += numJ;
+            }
+            else if ((entry.shift & NBNXN_CI_HALF_LJ(0)) || !(entry.shift & NBNXN_CI_DO_LJ(0)))
+            {
+                nbl->work->ncj_hlj += numJ;
+            }
+
+            if (rFullyInRange2 > 0)
+            {
+                splitOffFullyInRangeJClusters(nbl, ciIndex, jGrid, rFullyInRange2);
+            }
         }
     }
     else
@@ -2164,7 +2562,14 @@ static void split_sci_entry(NbnxnPairlistGpu* nbl,
 }
 
 /* Clost this super/sub list i entry */
-static void closeIEntry(NbnxnPairlistGpu* nbl, int nsp_max_av, gmx_bool progBal, float nsp_tot_est, int thread, int nthread)
+static void closeIEntry(NbnxnPairlistGpu* nbl,
+                        const gmx_unused Grid& jGrid,
+                        real gmx_unused rFullyInRange2,
+                        int                     nsp_max_av,
+                        gmx_bool                progBal,
+                        float                   nsp_tot_est,
+                        int                     thread,
+                        int                     nthread)
 {
     nbnxn_sci_t& sciEntry = *getOpenIEntry(nbl);
 
@@ -3080,6 +3485,7 @@ static void nbnxn_make_pairlist_part(const Nbnxm::GridSet&   gridSet,
                                      const nbnxn_atomdata_t* nbat,
                                      const ListOfLists<int>& exclusions,
                                      real                    rlist,
+                                     real                    rFullyInRange,
                                      const PairlistType      pairlistType,
                                      int                     ci_block,
                                      gmx_bool                bFBufferFlag,
@@ -3135,6 +3541,8 @@ static void nbnxn_make_pairlist_part(const Nbnxm::GridSet&   gridSet,
 
     const real rlist2 = nbl->rlist * nbl->rlist;
 
+    const real rFullyInRange2 = rFullyInRange * rFullyInRange;
+
     // Select the cluster pair distance kernel type
     const ClusterDistanceKernelType kernelType = getClusterDistanceKernelType(pairlistType, *nbat);
 
@@ -3553,7 +3961,8 @@ static void nbnxn_make_pairlist_part(const Nbnxm::GridSet&   gridSet,
                     }
 
                     /* Close this ci list */
-                    closeIEntry(nbl, nsubpair_max, progBal, nsubpair_tot_est, th, nth);
+                    closeIEntry(nbl, jGrid, rFullyInRange2, nsubpair_max, progBal,
+                                nsubpair_tot_est, th, nth);
                 }
             }
         }
@@ -3723,10 +4132,12 @@ static void rebalanceSimpleLists(gmx::ArrayRef<const NbnxnPairlistCpu> srcSet,
     const int numLists  = srcSet.ssize();
     const int ncjTarget = (ncjTotal + numLists - 1) / numLists;
 
-#pragma omp parallel num_threads(numLists)
-    {
-        int t = gmx_omp_get_thread_num();
+    /* With a fixed number of lists we can have fewer threads than lists */
+    const int gmx_unused numThreads = std::min(numLists, gmx_omp_nthreads_get(emntNonbonded));
 
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int t = 0; t < numLists; t++)
+    {
         int cjStart = ncjTarget * t;
         int cjEnd   = ncjTarget * (t + 1);
 
@@ -3928,6 +4339,14 @@ void PairlistSet::constructPairlists(const Nbnxm::GridSet&         gridSet,
 {
     const real rlist = params_.rlistOuter;
 
+    /* j-clusters within this distance stay within the cut-off during the lifetime
+     * of the list, assuming they do not move more than the buffer size.
+     */
+    const real rFullyInRange =
+            (params_.splitFullyInRangeJClusters && isCpuType_
+                     ? std::max(2 * params_.rcutoffMin - rlist, static_cast<real>(0))
+                     : 0);
+
     int      nsubpair_target;
     float    nsubpair_tot_est;
     int      ci_block;
@@ -3935,6 +4354,8 @@ void PairlistSet::constructPairlists(const Nbnxm::GridSet&         gridSet,
     int      np_tot, np_noq, np_hlj, nap;
 
     const int numLists = (isCpuType_ ? cpuLists_.size() : gpuLists_.size());
+    /* With a fixed number of lists we can have fewer threads than lists */
+    const int gmx_unused numThreads = std::min(numLists, gmx_omp_nthreads_get(emntNonbonded));
 
     if (debug)
     {
@@ -4007,7 +4428,7 @@ void PairlistSet::constructPairlists(const Nbnxm::GridSet&         gridSet,
              */
             progBal = (locality_ == InteractionLocality::Local || ddZones->n <= 2);
 
-#pragma omp parallel for num_threads(numLists) schedule(static)
+#pragma omp parallel for num_threads(numThreads) schedule(static)
             for (int th = 0; th < numLists; th++)
             {
                 try
@@ -4037,16 +4458,16 @@ void PairlistSet::constructPairlists(const Nbnxm::GridSet&         gridSet,
                     if (isCpuType_)
                     {
                         nbnxn_make_pairlist_part(gridSet, iGrid, jGrid, &work, nbat, exclusions, rlist,
-                                                 params_.pairlistType, ci_block, nbat->bUseBufferFlags,
-                                                 nsubpair_target, progBal, nsubpair_tot_est, th,
-                                                 numLists, &cpuLists_[th], fepListPtr);
+                                                 rFullyInRange, params_.pairlistType, ci_block,
+                                                 nbat->bUseBufferFlags, nsubpair_target, progBal,
+                                                 nsubpair_tot_est, th, numLists, &cpuLists_[th], fepListPtr);
                     }
                     else
                     {
                         nbnxn_make_pairlist_part(gridSet, iGrid, jGrid, &work, nbat, exclusions, rlist,
-                                                 params_.pairlistType, ci_block, nbat->bUseBufferFlags,
-                                                 nsubpair_target, progBal, nsubpair_tot_est, th,
-                                                 numLists, &gpuLists_[th], fepListPtr);
+                                                 rFullyInRange, params_.pairlistType, ci_block,
+                                                 nbat->bUseBufferFlags, nsubpair_target, progBal,
+                                                 nsubpair_tot_est, th, numLists, &gpuLists_[th], fepListPtr);
                     }
 
                     work.cycleCounter.stop();
@@ -4151,6 +4572,20 @@ void PairlistSet::constructPairlists(const Nbnxm::GridSet&         gridSet,
         GMX_ASSERT(cpuLists_[0].ciOuter.empty(), "ciOuter is invalid so it should be empty");
     }
 
+    if (params_.computeGpuListCounters && !isCpuType_)
+    {
+        /* Only list 0 is used by the kernels, the other lists were combined into it */
+        gmx_gpu_nbnxn_list_counters_t listCounters;
+        addGpuListCounters(gpuLists_[0], *nbat, params_.rlistInner, params_.rcutoffMax,
+                           &listCounters);
+        accumulateGpuListCounters(listCounters, &gpuListCounters_);
+
+        if (debug)
+        {
+            printGpuListCounters(debug, listCounters);
+        }
+    }
+
     /* If we have more than one list, they either got rebalancing (CPU)
      * or combined (GPU), so we should dump the final result to debug.
      */
@@ -4198,6 +4633,17 @@ void PairlistSet::constructPairlists(const Nbnxm::GridSet&         gridSet,
     }
 }
 
+gmx_gpu_nbnxn_list_counters_t PairlistSets::gpuListCounters() const
+{
+    gmx_gpu_nbnxn_list_counters_t counters = localSet_->gpuListCounters();
+    if (nonlocalSet_)
+    {
+        accumulateGpuListCounters(nonlocalSet_->gpuListCounters(), &counters);
+    }
+
+    return counters;
+}
+
 void PairlistSets::construct(const InteractionLocality iLocality,
                              PairSearch*               pairSearch,
                              nbnxn_atomdata_t*         nbat,
@@ -4253,11 +4699,20 @@ void nonbonded_verlet_t::constructPairlist(const InteractionLocality iLocality,
 
     if (useGpu())
     {
+        const NbnxnPairlistGpu* gpuList = pairlistSets().pairlistSet(iLocality).gpuList();
+
+        /* With the GPU-CPU work split, the end of the local list is computed on the CPU */
+        int numSciOnGpu = gmx::ssize(gpuList->sci);
+        if (gpuCpuWorkSplit_ && iLocality == InteractionLocality::Local)
+        {
+            numSciOnGpu = gpuCpuWorkSplit_->updateSplit(*gpuList);
+        }
+
         /* Launch the transfer of the pairlist to the GPU.
          *
          * NOTE: The launch overhead is currently not timed separately
          */
-        Nbnxm::gpu_init_pairlist(gpu_nbv, pairlistSets().pairlistSet(iLocality).gpuList(), iLocality);
+        Nbnxm::gpu_init_pairlist(gpu_nbv, gpuList, iLocality, numSciOnGpu);
     }
 }
 
@@ -108,6 +108,15 @@ struct nbnxn_cj_t
 #define NBNXN_CI_DO_COUL(subc) (1 << (9 + 3 * (subc)))
 //! \}
 
+/*! \brief Flag telling that all j-clusters without exclusions are in range
+ *
+ * When set, all atom pairs of j-clusters in the entry without exclusions
+ * stay within the cut-off during the lifetime of the list, so the kernels
+ * can skip the cut-off masking. Only used with CPU lists, where the flags
+ * above are only set for subc=0, so this bit is not used otherwise.
+ */
+#define NBNXN_CI_ALL_J_IN_RANGE (1 << 30)
+
 /*! \brief Cluster-pair Interaction masks
  *
  * Bit i*j-cluster-size + j tells if atom i and j interact.
@@ -63,7 +63,12 @@ PairlistParams::PairlistParams(const Nbnxm::KernelType kernelType,
     mtsFactor(1),
     nstlistPrune(-1),
     numRollingPruningParts(1),
-    lifetime(-1)
+    lifetime(-1),
+    splitFullyInRangeJClusters(false),
+    rcutoffMin(rlist),
+    fixedNumCpuLists(0),
+    computeGpuListCounters(false),
+    rcutoffMax(rlist)
 {
     if (!Nbnxm::kernelTypeUsesSimplePairlist(kernelType))
     {
@@ -66,6 +66,13 @@ static constexpr int c_nbnxnGpuClusterSize = GMX_OPENCL_NB_CLUSTER_SIZE;
 static constexpr int c_nbnxnGpuClusterSize = 8;
 #endif
 
+/*! \brief The maximum number of energy groups supported by the GPU kernels
+ *
+ * The energy-group pair energies are accumulated in shared memory,
+ * which is sized by the square of this value.
+ */
+static constexpr int c_nbnxnGpuMaxNumEnergyGroups = 8;
+
 //! The number of clusters along Z in a pair-search grid cell for GPU lists
 static constexpr int c_gpuNumClusterPerCellZ = 2;
 //! The number of clusters along Y in a pair-search grid cell for GPU lists
@@ -138,6 +145,20 @@ struct PairlistParams
     int numRollingPruningParts;
     //! Lifetime in steps of the pair-list
     int lifetime;
+    //! Whether to split off j-clusters fully within the cut-off into separate i-entries, CPU only
+    bool splitFullyInRangeJClusters;
+    //! The minimum of the Coulomb and VdW cut-off distances, used for the split above
+    real rcutoffMin;
+    /*! \brief When > 0, the number of CPU pair lists, independent of the number of threads
+     *
+     * With a fixed number of lists and force output buffers, the non-bonded
+     * forces are bitwise independent of the number of OpenMP threads.
+     */
+    int fixedNumCpuLists;
+    //! Whether to count cluster and atom pairs of GPU lists for efficiency reporting
+    bool computeGpuListCounters;
+    //! The maximum of the Coulomb and VdW cut-off distances, used for the counters above
+    real rcutoffMax;
 };
 
 #endif
@@ -54,6 +54,7 @@
 
 #include "gromacs/math/vectypes.h"
 #include "gromacs/mdtypes/locality.h"
+#include "gromacs/timing/gpu_timing.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/real.h"
 
@@ -121,6 +122,9 @@ public:
     //! Returns the lists of free-energy pairlists, empty when nonbonded interactions are not perturbed
     gmx::ArrayRef<const std::unique_ptr<t_nblist>> fepLists() const { return fepLists_; }
 
+    //! Returns the cluster and atom pair counts of the GPU lists, only set when requested
+    const gmx_gpu_nbnxn_list_counters_t& gpuListCounters() const { return gpuListCounters_; }
+
 private:
     //! The locality of the pairlist set
     gmx::InteractionLocality locality_;
@@ -138,6 +142,8 @@ private:
     gmx_bool isCpuType_;
     //! Lists for perturbed interactions in simple atom-atom layout
     std::vector<std::unique_ptr<t_nblist>> fepLists_;
+    //! Cluster and atom pair counts of the GPU lists, summed over searches
+    gmx_gpu_nbnxn_list_counters_t gpuListCounters_;
 
 public:
     /* Pair counts for flop counting */
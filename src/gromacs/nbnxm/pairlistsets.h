@@ -54,6 +54,7 @@
 
 #include "pairlistparams.h"
 
+struct gmx_gpu_nbnxn_list_counters_t;
 struct nbnxn_atomdata_t;
 class PairlistSet;
 enum class PairlistType;
@@ -134,6 +135,9 @@ public:
         }
     }
 
+    //! Returns the cluster and atom pair counts of the local and non-local GPU lists
+    gmx_gpu_nbnxn_list_counters_t gpuListCounters() const;
+
 private:
     //! Returns the pair-list set for the given locality
     PairlistSet& pairlistSet(gmx::InteractionLocality iLocality)
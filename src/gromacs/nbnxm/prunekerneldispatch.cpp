@@ -35,6 +35,8 @@
 
 #include "gmxpre.h"
 
+#include <algorithm>
+
 #include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/timing/wallcycle.h"
@@ -63,11 +65,13 @@ void PairlistSet::dispatchPruneKernel(const nbnxn_atomdata_t* nbat, const rvec*
     GMX_ASSERT(cpuLists_[0].ciOuter.size() >= cpuLists_[0].ci.size(),
                "Here we should either have an empty ci list or ciOuter should be >= ci");
 
-    int gmx_unused nthreads = gmx_omp_nthreads_get(emntNonbonded);
-    GMX_ASSERT(nthreads == static_cast<gmx::index>(cpuLists_.size()),
+    const int numLists = cpuLists_.size();
+    /* With a fixed number of lists we can have fewer threads than lists */
+    int gmx_unused nthreads = std::min(numLists, gmx_omp_nthreads_get(emntNonbonded));
+    GMX_ASSERT(nthreads == numLists || params_.fixedNumCpuLists > 0,
                "The number of threads should match the number of lists");
 #pragma omp parallel for schedule(static) num_threads(nthreads)
-    for (int i = 0; i < nthreads; i++)
+    for (int i = 0; i < numLists; i++)
     {
         NbnxnPairlistCpu* nbl = &cpuLists_[i];
 
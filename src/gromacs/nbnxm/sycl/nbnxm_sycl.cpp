@@ -0,0 +1,498 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *  \brief
+ *  Implements the SYCL version of the functions declared in nbnxm_gpu.h
+ *  that launch the non-bonded work and the transfers.
+ *
+ *  \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gpu_utils/devicebuffer.h"
+#include "gromacs/gpu_utils/gmxsycl.h"
+#include "gromacs/mdtypes/simulation_workload.h"
+#include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/gpu_common.h"
+#include "gromacs/nbnxm/gpu_common_utils.h"
+#include "gromacs/nbnxm/grid.h"
+#include "gromacs/nbnxm/nbnxm_gpu.h"
+#include "gromacs/utility/gmxassert.h"
+
+#include "nbnxm_sycl_kernel.h"
+#include "nbnxm_sycl_kernel_pruneonly.h"
+#include "nbnxm_sycl_kernel_utils.h"
+#include "nbnxm_sycl_types.h"
+
+namespace Nbnxm
+{
+
+//! Number of work-items in a work-group of the X buffer operations kernel
+constexpr static int c_bufOpsThreadsPerBlock = 128;
+
+//! Unique kernel name for each X buffer operations kernel flavor
+template<bool setFillerCoords>
+class NbnxmKernelXToNbatX;
+
+/*! \brief Set up the accessors and return the kernel functor that
+ * transforms the coordinates from rvec to the nbnxm layout.
+ *
+ * The second dimension of the range runs over the grid columns, the first
+ * over the atoms in each column. Only x, y and z are written,
+ * the charges in \p d_xq are left untouched.
+ *
+ * \tparam    setFillerCoords  Whether to set the coordinates of the filler particles.
+ * \param[in] cgh              SYCL command group handler.
+ * \param[in] d_xq             Coordinates buffer in nbnxm layout.
+ * \param[in] d_x              Coordinates buffer.
+ * \param[in] d_atomIndices    Atom index mapping.
+ * \param[in] d_cxy_na         Number of atoms per column, for all grids.
+ * \param[in] d_cxy_ind        Cell index of each column, for all grids.
+ * \param[in] columnOffset     Offset of the columns of this grid in \p d_cxy_na and \p d_cxy_ind.
+ * \param[in] numColumns       Extent of cell-level parallelism.
+ * \param[in] cellOffset       First cell.
+ * \param[in] numAtomsPerCell  Number of atoms per cell.
+ */
+template<bool setFillerCoords>
+auto nbnxmKernelXToNbatX(cl::sycl::handler&                     cgh,
+                         const DeviceBuffer<cl::sycl::float4>& d_xq,
+                         const DeviceBuffer<gmx::RVec>&         d_x,
+                         const DeviceBuffer<int>&               d_atomIndices,
+                         const DeviceBuffer<int>&               d_cxy_na,
+                         const DeviceBuffer<int>&               d_cxy_ind,
+                         const int                              columnOffset,
+                         const int                              numColumns,
+                         const int                              cellOffset,
+                         const int                              numAtomsPerCell)
+{
+    using cl::sycl::access::mode;
+
+    const auto a_xq          = getAccessor<mode::read_write>(d_xq, cgh);
+    const auto a_x           = getAccessor<mode::read>(d_x, cgh);
+    const auto a_atomIndices = getAccessor<mode::read>(d_atomIndices, cgh);
+    const auto a_numAtoms    = getAccessor<mode::read>(d_cxy_na, cgh);
+    const auto a_cellIndex   = getAccessor<mode::read>(d_cxy_ind, cgh);
+
+    return [=](cl::sycl::nd_item<2> itemIdx) {
+        const float farAway = -1000000.0F;
+
+        // Map cell-level parallelism to the second dimension of the range.
+        const int cxy = itemIdx.get_global_id(1);
+
+        if (cxy < numColumns)
+        {
+            const int numAtoms = a_numAtoms[columnOffset + cxy];
+            const int offset   = (cellOffset + a_cellIndex[columnOffset + cxy]) * numAtomsPerCell;
+            int       numAtomsRounded;
+            if constexpr (setFillerCoords)
+            {
+                numAtomsRounded = (a_cellIndex[columnOffset + cxy + 1] - a_cellIndex[columnOffset + cxy])
+                                  * numAtomsPerCell;
+            }
+            else
+            {
+                // We fill only the real particle locations.
+                // We assume the filling entries at the end have been
+                // properly set before during pair-list generation.
+                numAtomsRounded = numAtoms;
+            }
+
+            const int threadIndex = itemIdx.get_global_id(0);
+
+            // Perform layout conversion of each element.
+            if (threadIndex < numAtomsRounded)
+            {
+                cl::sycl::float4& xqDest = a_xq[threadIndex + offset];
+                if (threadIndex < numAtoms)
+                {
+                    const gmx::RVec& x = a_x[a_atomIndices[threadIndex + offset]];
+                    xqDest = cl::sycl::float4(x[XX], x[YY], x[ZZ], xqDest.w());
+                }
+                else
+                {
+                    xqDest = cl::sycl::float4(farAway, farAway, farAway, xqDest.w());
+                }
+            }
+        }
+    };
+}
+
+/*! \brief Sync the nonlocal stream with dependent tasks in the local queue.
+ *
+ *  As the point where the local stream tasks can be considered complete happens
+ *  at the same call point where the nonlocal stream should be synced with the
+ *  the local, this function marks the event if called with the local stream as
+ *  argument and inserts in the GPU stream a wait on the event on the nonlocal.
+ *  The wait releases the event, so each mark has to be matched by exactly one wait.
+ */
+void nbnxnInsertNonlocalGpuDependency(const NbnxmGpu* nb, const InteractionLocality interactionLocality)
+{
+    const DeviceStream& deviceStream = *nb->deviceStreams[interactionLocality];
+
+    /* When we get here all misc operations issued in the local stream as well as
+       the local xq H2D are done,
+       so we record that in the local stream and wait for it in the nonlocal one.
+       This wait needs to precede any PP tasks, bonded or nonbonded, that may
+       compute on interactions between local and nonlocal atoms.
+     */
+    if (nb->bUseTwoStreams)
+    {
+        if (interactionLocality == InteractionLocality::Local)
+        {
+            nb->misc_ops_and_local_H2D_done.markEvent(deviceStream);
+        }
+        else
+        {
+            nb->misc_ops_and_local_H2D_done.enqueueWaitEvent(deviceStream);
+        }
+    }
+}
+
+/*! \brief Launch asynchronously the xq buffer host to device copy. */
+void gpu_copy_xq_to_gpu(NbnxmGpu* nb, const nbnxn_atomdata_t* nbatom, const AtomLocality atomLocality)
+{
+    GMX_ASSERT(nb, "Need a valid nbnxn_gpu object");
+
+    GMX_ASSERT(atomLocality == AtomLocality::Local || atomLocality == AtomLocality::NonLocal,
+               "Only local and non-local xq transfers are supported");
+
+    const InteractionLocality iloc = gpuAtomToInteractionLocality(atomLocality);
+
+    int adat_begin, adat_len; /* local/nonlocal offset and length used for xq and f */
+
+    sycl_atomdata_t*    adat         = nb->atdat;
+    gpu_plist*          plist        = nb->plist[iloc];
+    const DeviceStream& deviceStream = *nb->deviceStreams[iloc];
+
+    /* Don't launch the non-local H2D copy if there is no dependent
+       work to do: neither non-local nor other (e.g. bonded) work
+       to do that has as input the nbnxn coordaintes.
+       Doing the same for the local kernel is more complicated, since the
+       local part of the force array also depends on the non-local kernel.
+       So to avoid complicating the code and to reduce the risk of bugs,
+       we always call the local local x+q copy (and the rest of the local
+       work in nbnxn_gpu_launch_kernel().
+       The event marked in the local stream is still waited for, which
+       releases it for the next step.
+     */
+    if ((iloc == InteractionLocality::NonLocal) && !haveGpuShortRangeWork(*nb, iloc))
+    {
+        plist->haveFreshList = false;
+
+        nbnxnInsertNonlocalGpuDependency(nb, iloc);
+
+        return;
+    }
+
+    getGpuAtomRange(adat, atomLocality, &adat_begin, &adat_len);
+
+    /* HtoD x, q */
+    static_assert(sizeof(float) * 4 == sizeof(cl::sycl::float4),
+                  "The size of the xyzq buffer element should be equal to the size of float4.");
+    copyToDeviceBuffer(&adat->xq, reinterpret_cast<const cl::sycl::float4*>(nbatom->x().data()) + adat_begin,
+                       adat_begin, adat_len, deviceStream, GpuApiCallBehavior::Async, nullptr);
+
+    /* When we get here all misc operations issued in the local stream as well as
+       the local xq H2D are done,
+       so we record that in the local stream and wait for it in the nonlocal one.
+       This wait needs to precede any PP tasks, bonded or nonbonded, that may
+       compute on interactions between local and nonlocal atoms.
+     */
+    nbnxnInsertNonlocalGpuDependency(nb, iloc);
+}
+
+/*! As we execute nonbonded workload in separate streams, before launching
+   the kernel we need to make sure that he following operations have completed:
+   - atomdata allocation and related H2D transfers (every nstlist step);
+   - pair list H2D transfer (every nstlist step);
+   - shift vector H2D transfer (every nstlist step);
+   - force (+shift force and energy) output clearing (every step).
+
+   These operations are issued in the local stream at the beginning of the step
+   and therefore always complete before the local kernel launch. The non-local
+   kernel is launched after the local on the same device/context, but as the
+   streams are independent the dependency needs to be enforced.
+   We use the misc_ops_and_local_H2D_done event to record the point where
+   the local x+q H2D (and all preceding) tasks are complete and synchronize
+   with this event in the non-local stream before launching the non-bonded kernel.
+ */
+void gpu_launch_kernel(NbnxmGpu* nb, const gmx::StepWorkload& stepWork, const InteractionLocality iloc)
+{
+    const NBParamGpu* nbp   = nb->nbparam;
+    gpu_plist*        plist = nb->plist[iloc];
+
+    /* Don't launch the non-local kernel if there is no work to do.
+       Doing the same for the local kernel is more complicated, since the
+       local part of the force array also depends on the non-local kernel.
+       So to avoid complicating the code and to reduce the risk of bugs,
+       we always call the local kernel, and later (not in
+       this function) the stream wait, local f copyback and the f buffer
+       clearing. All these operations, except for the local interaction kernel,
+       are needed for the non-local interactions. The skip of the local kernel
+       call is taken care of later in this function. */
+    if (canSkipNonbondedWork(*nb, iloc))
+    {
+        plist->haveFreshList = false;
+
+        return;
+    }
+
+    if (nbp->useDynamicPruning && plist->haveFreshList)
+    {
+        /* Prunes for rlistOuter and rlistInner, sets plist->haveFreshList=false
+           (TODO: ATM that's the way the timing accounting can distinguish between
+           separate prune kernel and combined force+prune, maybe we need a better way?).
+         */
+        gpu_launch_kernel_pruneonly(nb, iloc, 1);
+    }
+
+    if (plist->nsci == 0)
+    {
+        /* Don't launch an empty local kernel */
+        return;
+    }
+
+    launchNbnxmKernel(nb, stepWork, iloc);
+}
+
+void gpu_launch_kernel_pruneonly(NbnxmGpu* nb, const InteractionLocality iloc, const int numParts)
+{
+    gpu_plist* plist = nb->plist[iloc];
+
+    if (plist->haveFreshList)
+    {
+        GMX_ASSERT(numParts == 1, "With first pruning we expect 1 part");
+
+        /* Set rollingPruningNumParts to signal that it is not set */
+        plist->rollingPruningNumParts = 0;
+        plist->rollingPruningPart     = 0;
+    }
+    else
+    {
+        if (plist->rollingPruningNumParts == 0)
+        {
+            plist->rollingPruningNumParts = numParts;
+        }
+        else
+        {
+            GMX_ASSERT(numParts == plist->rollingPruningNumParts,
+                       "It is not allowed to change numParts in between list generation steps");
+        }
+    }
+
+    /* Use a local variable for part and update in plist, so we can return here
+     * without duplicating the part increment code.
+     */
+    const int part = plist->rollingPruningPart;
+
+    plist->rollingPruningPart++;
+    if (plist->rollingPruningPart >= plist->rollingPruningNumParts)
+    {
+        plist->rollingPruningPart = 0;
+    }
+
+    /* Compute the number of list entries to prune in this pass */
+    const int numSciInPart = (plist->nsci - part) / numParts;
+
+    /* Don't launch the kernel if there is no work to do */
+    if (numSciInPart <= 0)
+    {
+        plist->haveFreshList = false;
+
+        return;
+    }
+
+    launchNbnxmKernelPruneOnly(nb, iloc, numParts, part, numSciInPart);
+
+    if (plist->haveFreshList)
+    {
+        plist->haveFreshList = false;
+        /* Mark that pruning has been done */
+        nb->timers->interaction[iloc].didPrune = true;
+    }
+    else
+    {
+        /* Mark that rolling pruning has been done */
+        nb->timers->interaction[iloc].didRollingPrune = true;
+    }
+}
+
+void gpu_launch_cpyback(NbnxmGpu*                nb,
+                        nbnxn_atomdata_t*        nbatom,
+                        const gmx::StepWorkload& stepWork,
+                        const AtomLocality       atomLocality)
+{
+    GMX_ASSERT(nb, "Need a valid nbnxn_gpu object");
+
+    int adat_begin, adat_len; /* local/nonlocal offset and length used for xq and f */
+
+    /* determine interaction locality from atom locality */
+    const InteractionLocality iloc = gpuAtomToInteractionLocality(atomLocality);
+
+    /* extract the data */
+    sycl_atomdata_t*    adat         = nb->atdat;
+    const DeviceStream& deviceStream = *nb->deviceStreams[iloc];
+
+    /* don't launch non-local copy-back if there was no non-local work to do */
+    if ((iloc == InteractionLocality::NonLocal) && !haveGpuShortRangeWork(*nb, iloc))
+    {
+        nb->bNonLocalStreamActive = false;
+        return;
+    }
+
+    getGpuAtomRange(adat, atomLocality, &adat_begin, &adat_len);
+
+    /* With DD the local D2H transfer can only start after the non-local
+       kernel has finished. */
+    if (iloc == InteractionLocality::Local && nb->bNonLocalStreamActive)
+    {
+        nb->nonlocal_done.enqueueWaitEvent(deviceStream);
+    }
+
+    /* DtoH f
+     * Skip if buffer ops / reduction is offloaded to the GPU.
+     */
+    if (!stepWork.useGpuFBufferOps)
+    {
+        static_assert(sizeof(*nbatom->out[0].f.data()) * DIM == sizeof(gmx::RVec),
+                      "The size of the force buffer element should be equal to the size of float3.");
+        copyFromDeviceBuffer(reinterpret_cast<gmx::RVec*>(nbatom->out[0].f.data()) + adat_begin,
+                             &adat->f, adat_begin, adat_len, deviceStream,
+                             GpuApiCallBehavior::Async, nullptr);
+    }
+
+    /* After the non-local D2H is launched the nonlocal_done event can be
+       recorded which signals that the local D2H can proceed. This event is not
+       placed after the non-local kernel because we want the non-local data
+       back first. */
+    if (iloc == InteractionLocality::NonLocal)
+    {
+        nb->nonlocal_done.markEvent(deviceStream);
+        nb->bNonLocalStreamActive = true;
+    }
+
+    /* only transfer energies in the local stream */
+    if (iloc == InteractionLocality::Local)
+    {
+        /* DtoH fshift when virial is needed */
+        if (stepWork.computeVirial)
+        {
+            copyFromDeviceBuffer(nb->nbst.fshift, &adat->fshift, 0, SHIFTS, deviceStream,
+                                 GpuApiCallBehavior::Async, nullptr);
+        }
+
+        /* DtoH energies */
+        if (stepWork.computeEnergy)
+        {
+            copyFromDeviceBuffer(nb->nbst.e_lj, &adat->e_lj, 0, 1, deviceStream,
+                                 GpuApiCallBehavior::Async, nullptr);
+            copyFromDeviceBuffer(nb->nbst.e_el, &adat->e_el, 0, 1, deviceStream,
+                                 GpuApiCallBehavior::Async, nullptr);
+        }
+    }
+}
+
+/* X buffer operations on GPU: performs conversion from rvec to nb format. */
+void nbnxn_gpu_x_to_nbat_x(const Nbnxm::Grid&        grid,
+                           bool                      setFillerCoords,
+                           NbnxmGpu*                 nb,
+                           DeviceBuffer<gmx::RVec>   d_x,
+                           GpuEventSynchronizer*     xReadyOnDevice,
+                           const Nbnxm::AtomLocality locality,
+                           int                       gridId,
+                           int                       numColumnsMax)
+{
+    GMX_ASSERT(nb, "Need a valid nbnxn_gpu object");
+
+    sycl_atomdata_t* adat = nb->atdat;
+
+    const int                  numColumns      = grid.numColumns();
+    const int                  cellOffset      = grid.cellOffset();
+    const int                  numAtomsPerCell = grid.numAtomsPerCell();
+    Nbnxm::InteractionLocality interactionLoc  = gpuAtomToInteractionLocality(locality);
+
+    const DeviceStream& deviceStream = *nb->deviceStreams[interactionLoc];
+
+    int numAtoms = grid.srcAtomEnd() - grid.srcAtomBegin();
+    // avoid empty kernel launch, skip to inserting stream dependency
+    if (numAtoms != 0)
+    {
+        GMX_ASSERT(d_x, "Need a valid device buffer");
+
+        // ensure that coordinates are ready on the device before launching the kernel
+        GMX_ASSERT(xReadyOnDevice, "Need a valid GpuEventSynchronizer object");
+        xReadyOnDevice->enqueueWaitEvent(deviceStream);
+
+        const size_t numBlocks =
+                (grid.numCellsColumnMax() * numAtomsPerCell + c_bufOpsThreadsPerBlock - 1)
+                / c_bufOpsThreadsPerBlock;
+        GMX_ASSERT(numBlocks > 0, "Can not have empty grid, early return above avoids this");
+
+        const cl::sycl::range<2>    blockSize{ c_bufOpsThreadsPerBlock, 1 };
+        const cl::sycl::range<2>    globalSize{ numBlocks * c_bufOpsThreadsPerBlock,
+                                             static_cast<size_t>(numColumns) };
+        const cl::sycl::nd_range<2> range{ globalSize, blockSize };
+
+        const int columnOffset = numColumnsMax * gridId;
+
+        cl::sycl::queue q = deviceStream.stream();
+        q.submit([&](cl::sycl::handler& cgh) {
+            if (setFillerCoords)
+            {
+                auto kernel = nbnxmKernelXToNbatX<true>(cgh, adat->xq, d_x, nb->atomIndices, nb->cxy_na,
+                                                        nb->cxy_ind, columnOffset, numColumns,
+                                                        cellOffset, numAtomsPerCell);
+                cgh.parallel_for<NbnxmKernelXToNbatX<true>>(range, kernel);
+            }
+            else
+            {
+                auto kernel = nbnxmKernelXToNbatX<false>(cgh, adat->xq, d_x, nb->atomIndices, nb->cxy_na,
+                                                         nb->cxy_ind, columnOffset, numColumns,
+                                                         cellOffset, numAtomsPerCell);
+                cgh.parallel_for<NbnxmKernelXToNbatX<false>>(range, kernel);
+            }
+        });
+    }
+
+    /* The event is released by the wait, so the non-local stream only waits
+     * once per step, for the first non-local grid. */
+    if (interactionLoc == InteractionLocality::Local || gridId == 1)
+    {
+        nbnxnInsertNonlocalGpuDependency(nb, interactionLoc);
+    }
+}
+
+} // namespace Nbnxm
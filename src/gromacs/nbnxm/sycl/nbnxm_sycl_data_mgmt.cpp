@@ -0,0 +1,459 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *  \brief
+ *  Implements the SYCL version of the functions declared in gpu_data_mgmt.h
+ *  that set up and tear down the non-bonded GPU data.
+ *
+ *  \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include <cstdio>
+
+#include "gromacs/gpu_utils/device_context.h"
+#include "gromacs/gpu_utils/device_stream_manager.h"
+#include "gromacs/gpu_utils/devicebuffer.h"
+#include "gromacs/hardware/device_information.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/gpu_data_mgmt.h"
+#include "gromacs/nbnxm/gridset.h"
+#include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/nbnxm_gpu.h"
+#include "gromacs/nbnxm/nbnxm_gpu_data_mgmt.h"
+#include "gromacs/nbnxm/pairlistsets.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/timing/gpu_timing.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "nbnxm_sycl_types.h"
+
+namespace Nbnxm
+{
+
+/*! \brief Heuristic for the minimum number of i-clusters per compute unit,
+ * taken over from the CUDA implementation.
+ */
+static constexpr int c_syclMinCiBalancedFactor = 44;
+
+/*! \brief Initializes the atomdata structure first time, it only gets filled at pair-search. */
+static void init_atomdata_first(sycl_atomdata_t* ad, int ntypes, const DeviceContext& deviceContext)
+{
+    ad->ntypes = ntypes;
+    allocateDeviceBuffer(&ad->shift_vec, SHIFTS, deviceContext);
+    ad->bShiftVecUploaded = false;
+
+    allocateDeviceBuffer(&ad->fshift, SHIFTS, deviceContext);
+    allocateDeviceBuffer(&ad->e_lj, 1, deviceContext);
+    allocateDeviceBuffer(&ad->e_el, 1, deviceContext);
+
+    /* initialize to nullptr pointers to data that is not allocated here and will
+       need reallocation in gpu_init_atomdata */
+    ad->xq = nullptr;
+    ad->f  = nullptr;
+
+    /* size -1 indicates that the respective array hasn't been initialized yet */
+    ad->natoms = -1;
+    ad->nalloc = -1;
+}
+
+/*! \brief Initializes the nonbonded parameter data structure. */
+static void init_nbparam(NBParamGpu*                     nbp,
+                         const interaction_const_t*      ic,
+                         const PairlistParams&           listParams,
+                         const nbnxn_atomdata_t::Params& nbatParams,
+                         const DeviceContext&            deviceContext)
+{
+    const int ntypes = nbatParams.numTypes;
+
+    set_cutoff_parameters(nbp, ic, listParams);
+
+    nbp->vdwType  = nbnxmGpuPickVdwKernelType(ic, nbatParams.comb_rule);
+    nbp->elecType = nbnxmGpuPickElectrostaticsKernelType(ic);
+
+    /* generate table for PME */
+    nbp->coulomb_tab = nullptr;
+    if (nbp->elecType == ElecType::EwaldTab || nbp->elecType == ElecType::EwaldTabTwin)
+    {
+        GMX_RELEASE_ASSERT(ic->coulombEwaldTables, "Need valid Coulomb Ewald correction tables");
+        init_ewald_coulomb_force_table(*ic->coulombEwaldTables, nbp, deviceContext);
+    }
+
+    /* set up LJ parameter lookup table */
+    if (!useLjCombRule(nbp->vdwType))
+    {
+        initParamLookupTable(&nbp->nbfp, &nbp->nbfp_texobj, nbatParams.nbfp.data(),
+                             2 * ntypes * ntypes, deviceContext);
+    }
+
+    /* set up LJ-PME parameter lookup table */
+    if (ic->vdwtype == evdwPME)
+    {
+        initParamLookupTable(&nbp->nbfp_comb, &nbp->nbfp_comb_texobj, nbatParams.nbfp_comb.data(),
+                             2 * ntypes, deviceContext);
+    }
+}
+
+/*! \brief Clears the first natoms_clear elements of the GPU nonbonded force output array. */
+static void nbnxn_sycl_clear_f(NbnxmGpu* nb, int natoms_clear)
+{
+    sycl_atomdata_t*    adat        = nb->atdat;
+    const DeviceStream& localStream = *nb->deviceStreams[InteractionLocality::Local];
+    clearDeviceBufferAsync(&adat->f, 0, natoms_clear, localStream);
+}
+
+/*! \brief Clears nonbonded shift force output array and energy outputs on the GPU. */
+static void nbnxn_sycl_clear_e_fshift(NbnxmGpu* nb)
+{
+    sycl_atomdata_t*    adat        = nb->atdat;
+    const DeviceStream& localStream = *nb->deviceStreams[InteractionLocality::Local];
+
+    clearDeviceBufferAsync(&adat->fshift, 0, SHIFTS, localStream);
+    clearDeviceBufferAsync(&adat->e_lj, 0, 1, localStream);
+    clearDeviceBufferAsync(&adat->e_el, 0, 1, localStream);
+}
+
+/*! \brief Initializes simulation constant data. */
+static void sycl_init_const(NbnxmGpu*                       nb,
+                            const interaction_const_t*      ic,
+                            const PairlistParams&           listParams,
+                            const nbnxn_atomdata_t::Params& nbatParams)
+{
+    init_atomdata_first(nb->atdat, nbatParams.numTypes, *nb->deviceContext_);
+    init_nbparam(nb->nbparam, ic, listParams, nbatParams, *nb->deviceContext_);
+
+    /* clear energy and shift force outputs */
+    nbnxn_sycl_clear_e_fshift(nb);
+}
+
+NbnxmGpu* gpu_init(const gmx::DeviceStreamManager& deviceStreamManager,
+                   const interaction_const_t*      ic,
+                   const PairlistParams&           listParams,
+                   const nbnxn_atomdata_t*         nbat,
+                   bool                            bLocalAndNonlocal)
+{
+    auto nb            = new NbnxmGpu();
+    nb->deviceContext_ = &deviceStreamManager.context();
+    // The SYCL structures hold device buffers, so they are constructed rather than snew'ed
+    nb->atdat                             = new sycl_atomdata_t();
+    nb->nbparam                           = new NBParamGpu();
+    nb->plist[InteractionLocality::Local] = new gpu_plist();
+    if (bLocalAndNonlocal)
+    {
+        nb->plist[InteractionLocality::NonLocal] = new gpu_plist();
+    }
+
+    nb->bUseTwoStreams = bLocalAndNonlocal;
+
+    nb->timers = new sycl_timers_t();
+    snew(nb->timings, 1);
+
+    /* init nbst */
+    snew(nb->nbst.e_lj, 1);
+    snew(nb->nbst.e_el, 1);
+    nb->nbst.fshift = new gmx::RVec[SHIFTS];
+
+    init_plist(nb->plist[InteractionLocality::Local]);
+
+    /* local/non-local GPU streams */
+    GMX_RELEASE_ASSERT(deviceStreamManager.streamIsValid(gmx::DeviceStreamType::NonBondedLocal),
+                       "Local non-bonded stream should be initialized to use GPU for non-bonded.");
+    nb->deviceStreams[InteractionLocality::Local] =
+            &deviceStreamManager.stream(gmx::DeviceStreamType::NonBondedLocal);
+    if (nb->bUseTwoStreams)
+    {
+        init_plist(nb->plist[InteractionLocality::NonLocal]);
+
+        GMX_RELEASE_ASSERT(deviceStreamManager.streamIsValid(gmx::DeviceStreamType::NonBondedNonLocal),
+                           "Non-local non-bonded stream should be initialized to use GPU for "
+                           "non-bonded with domain decomposition.");
+        nb->deviceStreams[InteractionLocality::NonLocal] =
+                &deviceStreamManager.stream(gmx::DeviceStreamType::NonBondedNonLocal);
+    }
+
+    /* SYCL timing is not implemented, see NbnxmGpu::bDoTime */
+    nb->bDoTime = false;
+
+    sycl_init_const(nb, ic, listParams, nbat->params());
+
+    nb->atomIndicesSize       = 0;
+    nb->atomIndicesSize_alloc = 0;
+    nb->ncxy_na               = 0;
+    nb->ncxy_na_alloc         = 0;
+    nb->ncxy_ind              = 0;
+    nb->ncxy_ind_alloc        = 0;
+
+    if (debug)
+    {
+        fprintf(debug, "Initialized SYCL data structures.\n");
+    }
+
+    return nb;
+}
+
+void gpu_upload_shiftvec(NbnxmGpu* nb, const nbnxn_atomdata_t* nbatom)
+{
+    sycl_atomdata_t*    adat        = nb->atdat;
+    const DeviceStream& localStream = *nb->deviceStreams[InteractionLocality::Local];
+
+    /* only if we have a dynamic box */
+    if (nbatom->bDynamicBox || !adat->bShiftVecUploaded)
+    {
+        static_assert(sizeof(gmx::RVec) == sizeof(nbatom->shift_vec[0]),
+                      "Sizes of host- and device-side shift vectors should be the same.");
+        copyToDeviceBuffer(&adat->shift_vec, nbatom->shift_vec.data(), 0, SHIFTS, localStream,
+                           GpuApiCallBehavior::Async, nullptr);
+        adat->bShiftVecUploaded = true;
+    }
+}
+
+void gpu_clear_outputs(NbnxmGpu* nb, bool computeVirial)
+{
+    nbnxn_sycl_clear_f(nb, nb->atdat->natoms);
+    /* clear shift force array and energies if the outputs were
+       used in the current step */
+    if (computeVirial)
+    {
+        nbnxn_sycl_clear_e_fshift(nb);
+    }
+}
+
+void gpu_init_atomdata(NbnxmGpu* nb, const nbnxn_atomdata_t* nbat)
+{
+    sycl_atomdata_t*     d_atdat       = nb->atdat;
+    const DeviceContext& deviceContext = *nb->deviceContext_;
+    const DeviceStream&  localStream   = *nb->deviceStreams[InteractionLocality::Local];
+
+    const int natoms    = nbat->numAtoms();
+    bool      realloced = false;
+
+    /* need to reallocate if we have to copy more atoms than the amount of space
+       available and only allocate if we haven't initialized yet, i.e d_atdat->natoms == -1 */
+    if (natoms > d_atdat->nalloc)
+    {
+        const int nalloc = over_alloc_small(natoms);
+
+        /* free up first if the arrays have already been initialized */
+        if (d_atdat->nalloc != -1)
+        {
+            freeDeviceBuffer(&d_atdat->f);
+            freeDeviceBuffer(&d_atdat->xq);
+            freeDeviceBuffer(&d_atdat->atom_types);
+            freeDeviceBuffer(&d_atdat->lj_comb);
+        }
+
+        allocateDeviceBuffer(&d_atdat->f, nalloc, deviceContext);
+        allocateDeviceBuffer(&d_atdat->xq, nalloc, deviceContext);
+        if (useLjCombRule(nb->nbparam->vdwType))
+        {
+            allocateDeviceBuffer(&d_atdat->lj_comb, nalloc, deviceContext);
+        }
+        else
+        {
+            allocateDeviceBuffer(&d_atdat->atom_types, nalloc, deviceContext);
+        }
+
+        d_atdat->nalloc = nalloc;
+        realloced       = true;
+    }
+
+    d_atdat->natoms       = natoms;
+    d_atdat->natoms_local = nbat->natoms_local;
+
+    /* need to clear GPU f output if realloc happened */
+    if (realloced)
+    {
+        nbnxn_sycl_clear_f(nb, d_atdat->nalloc);
+    }
+
+    if (useLjCombRule(nb->nbparam->vdwType))
+    {
+        static_assert(sizeof(float) * 2 == sizeof(cl::sycl::float2),
+                      "Size of the LJ parameters element should be equal to the size of float2.");
+        copyToDeviceBuffer(&d_atdat->lj_comb,
+                           reinterpret_cast<const cl::sycl::float2*>(nbat->params().lj_comb.data()),
+                           0, natoms, localStream, GpuApiCallBehavior::Async, nullptr);
+    }
+    else
+    {
+        static_assert(sizeof(int) == sizeof(nbat->params().type[0]),
+                      "Sizes of host- and device-side atom types should be the same.");
+        copyToDeviceBuffer(&d_atdat->atom_types, nbat->params().type.data(), 0, natoms, localStream,
+                           GpuApiCallBehavior::Async, nullptr);
+    }
+}
+
+/*! \brief Releases the device buffers of a pair list and the list itself. */
+static void free_plist(gpu_plist* plist)
+{
+    freeDeviceBuffer(&plist->sci);
+    freeDeviceBuffer(&plist->cj4);
+    freeDeviceBuffer(&plist->imask);
+    freeDeviceBuffer(&plist->excl);
+    delete plist;
+}
+
+void gpu_free(NbnxmGpu* nb)
+{
+    if (nb == nullptr)
+    {
+        return;
+    }
+
+    sycl_atomdata_t* atdat   = nb->atdat;
+    NBParamGpu*      nbparam = nb->nbparam;
+
+    if (nbparam->coulomb_tab)
+    {
+        destroyParamLookupTable(&nbparam->coulomb_tab, nbparam->coulomb_tab_texobj);
+    }
+
+    delete nb->timers;
+
+    if (!useLjCombRule(nbparam->vdwType))
+    {
+        destroyParamLookupTable(&nbparam->nbfp, nbparam->nbfp_texobj);
+    }
+
+    if (nbparam->vdwType == VdwType::EwaldGeom || nbparam->vdwType == VdwType::EwaldLB)
+    {
+        destroyParamLookupTable(&nbparam->nbfp_comb, nbparam->nbfp_comb_texobj);
+    }
+
+    freeDeviceBuffer(&atdat->shift_vec);
+    freeDeviceBuffer(&atdat->fshift);
+
+    freeDeviceBuffer(&atdat->e_lj);
+    freeDeviceBuffer(&atdat->e_el);
+
+    freeDeviceBuffer(&atdat->f);
+    freeDeviceBuffer(&atdat->xq);
+    freeDeviceBuffer(&atdat->atom_types);
+    freeDeviceBuffer(&atdat->lj_comb);
+
+    /* Free plist */
+    free_plist(nb->plist[InteractionLocality::Local]);
+    if (nb->bUseTwoStreams)
+    {
+        free_plist(nb->plist[InteractionLocality::NonLocal]);
+    }
+
+    /* Free nbst */
+    sfree(nb->nbst.e_lj);
+    nb->nbst.e_lj = nullptr;
+
+    sfree(nb->nbst.e_el);
+    nb->nbst.e_el = nullptr;
+
+    delete[] nb->nbst.fshift;
+    nb->nbst.fshift = nullptr;
+
+    delete atdat;
+    delete nbparam;
+    sfree(nb->timings);
+    delete nb;
+
+    if (debug)
+    {
+        fprintf(debug, "Cleaned up SYCL data structures.\n");
+    }
+}
+
+int gpu_min_ci_balanced(NbnxmGpu* nb)
+{
+    if (nb == nullptr)
+    {
+        return 0;
+    }
+    const cl::sycl::device& device = nb->deviceContext_->deviceInfo().syclDevice;
+    return c_syclMinCiBalancedFactor * device.get_info<cl::sycl::info::device::max_compute_units>();
+}
+
+/* Initialization for X buffer operations on GPU. */
+void nbnxn_gpu_init_x_to_nbat_x(const Nbnxm::GridSet& gridSet, NbnxmGpu* gpu_nbv)
+{
+    const DeviceStream& deviceStream  = *gpu_nbv->deviceStreams[InteractionLocality::Local];
+    const int           maxNumColumns = gridSet.numColumnsMax();
+
+    reallocateDeviceBuffer(&gpu_nbv->cxy_na, maxNumColumns * gridSet.grids().size(),
+                           &gpu_nbv->ncxy_na, &gpu_nbv->ncxy_na_alloc, *gpu_nbv->deviceContext_);
+    reallocateDeviceBuffer(&gpu_nbv->cxy_ind, maxNumColumns * gridSet.grids().size(),
+                           &gpu_nbv->ncxy_ind, &gpu_nbv->ncxy_ind_alloc, *gpu_nbv->deviceContext_);
+
+    for (unsigned int g = 0; g < gridSet.grids().size(); g++)
+    {
+        const Nbnxm::Grid& grid = gridSet.grids()[g];
+
+        const int  numColumns      = grid.numColumns();
+        const int* atomIndices     = gridSet.atomIndices().data();
+        const int  atomIndicesSize = gridSet.atomIndices().size();
+        const int* cxy_na          = grid.cxy_na().data();
+        const int* cxy_ind         = grid.cxy_ind().data();
+
+        reallocateDeviceBuffer(&gpu_nbv->atomIndices, atomIndicesSize, &gpu_nbv->atomIndicesSize,
+                               &gpu_nbv->atomIndicesSize_alloc, *gpu_nbv->deviceContext_);
+
+        if (atomIndicesSize > 0)
+        {
+            copyToDeviceBuffer(&gpu_nbv->atomIndices, atomIndices, 0, atomIndicesSize, deviceStream,
+                               GpuApiCallBehavior::Async, nullptr);
+        }
+
+        if (numColumns > 0)
+        {
+            // The columns of each grid are stored at an offset of maxNumColumns * g
+            copyToDeviceBuffer(&gpu_nbv->cxy_na, cxy_na, maxNumColumns * g, numColumns,
+                               deviceStream, GpuApiCallBehavior::Async, nullptr);
+            copyToDeviceBuffer(&gpu_nbv->cxy_ind, cxy_ind, maxNumColumns * g, numColumns,
+                               deviceStream, GpuApiCallBehavior::Async, nullptr);
+        }
+    }
+
+    // The above data is transferred on the local stream but is a
+    // dependency of the nonlocal stream (specifically the nonlocal X
+    // buf ops kernel).  We therefore set a dependency to ensure
+    // that the nonlocal stream waits on the local stream here.
+    // This call records an event in the local stream:
+    nbnxnInsertNonlocalGpuDependency(gpu_nbv, Nbnxm::InteractionLocality::Local);
+    // ...and this call instructs the nonlocal stream to wait on that event:
+    nbnxnInsertNonlocalGpuDependency(gpu_nbv, Nbnxm::InteractionLocality::NonLocal);
+}
+
+} // namespace Nbnxm
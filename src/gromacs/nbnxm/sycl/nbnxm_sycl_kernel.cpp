@@ -0,0 +1,628 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *  \brief
+ *  Implements the SYCL non-bonded kernel, ported from nbnxm_cuda_kernel.cuh.
+ *
+ *  The kernel is templated on whether to prune the pair list in the kernel
+ *  and whether to compute energies, as well as on the electrostatics and
+ *  VdW flavors, so that the compiler removes all unused code paths.
+ *
+ *  \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include "nbnxm_sycl_kernel.h"
+
+#include "gromacs/gpu_utils/devicebuffer.h"
+#include "gromacs/gpu_utils/gmxsycl.h"
+#include "gromacs/math/utilities.h"
+#include "gromacs/mdtypes/simulation_workload.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/utility/template_mp.h"
+
+#include "nbnxm_sycl_kernel_utils.h"
+#include "nbnxm_sycl_types.h"
+
+namespace Nbnxm
+{
+
+//! Compile-time properties of the electrostatics and VdW flavors of the kernel
+template<enum ElecType elecType, enum VdwType vdwType>
+struct EnergyFunctionProperties
+{
+    //! Plain cut-off electrostatics
+    static constexpr bool elecCutoff = (elecType == ElecType::Cut);
+    //! Reaction-field electrostatics
+    static constexpr bool elecRF = (elecType == ElecType::RF);
+    //! Analytical Ewald electrostatics
+    static constexpr bool elecEwaldAna =
+            (elecType == ElecType::EwaldAna || elecType == ElecType::EwaldAnaTwin);
+    //! Tabulated Ewald electrostatics
+    static constexpr bool elecEwaldTab =
+            (elecType == ElecType::EwaldTab || elecType == ElecType::EwaldTabTwin);
+    //! Ewald electrostatics with a VdW cut-off shorter than the Coulomb cut-off
+    static constexpr bool elecEwaldTwin =
+            (elecType == ElecType::EwaldAnaTwin || elecType == ElecType::EwaldTabTwin);
+    //! Any flavor of Ewald electrostatics
+    static constexpr bool elecEwald = (elecEwaldAna || elecEwaldTab);
+    //! Plain LJ cut-off with geometric combination rule
+    static constexpr bool vdwCombGeom = (vdwType == VdwType::CutCombGeom);
+    //! Plain LJ cut-off with Lorentz-Berthelot combination rule
+    static constexpr bool vdwCombLB = (vdwType == VdwType::CutCombLB);
+    //! Plain LJ cut-off with any combination rule
+    static constexpr bool vdwComb = (vdwCombGeom || vdwCombLB);
+    //! LJ force switch
+    static constexpr bool vdwFSwitch = (vdwType == VdwType::FSwitch);
+    //! LJ potential switch
+    static constexpr bool vdwPSwitch = (vdwType == VdwType::PSwitch);
+    //! LJ-PME with geometric combination rule
+    static constexpr bool vdwEwaldCombGeom = (vdwType == VdwType::EwaldGeom);
+    //! LJ-PME with Lorentz-Berthelot combination rule
+    static constexpr bool vdwEwaldCombLB = (vdwType == VdwType::EwaldLB);
+    //! Any flavor of LJ-PME
+    static constexpr bool vdwEwald = (vdwEwaldCombGeom || vdwEwaldCombLB);
+};
+
+//! Unique kernel name for each kernel flavor
+template<bool doPruneNBL, bool doCalcEnergies, enum ElecType elecType, enum VdwType vdwType>
+class NbnxmKernel;
+
+/*! \brief Set up the accessors and return the non-bonded kernel functor.
+ *
+ * A block of c_clSize x c_clSize work-items processes one super-cluster:
+ * each work-item handles one i-atom of each i-cluster and one j-atom of each
+ * j-cluster. The two halves of the block, each a sub-group, process
+ * the two halves of each j-cluster group.
+ */
+template<bool doPruneNBL, bool doCalcEnergies, enum ElecType elecType, enum VdwType vdwType>
+auto nbnxmKernel(cl::sycl::handler&     cgh,
+                 const sycl_atomdata_t& atdat,
+                 const NBParamGpu&      nbp,
+                 const gpu_plist&       plist,
+                 const bool             calcShift)
+{
+    using Props = EnergyFunctionProperties<elecType, vdwType>;
+    using cl::sycl::access::mode;
+
+    //! Whether the forces from excluded pairs within the cut-off are computed
+    constexpr bool doExclusionForces =
+            (Props::elecEwald || Props::elecRF || Props::vdwEwald || (Props::elecCutoff && doCalcEnergies));
+    //! Whether the VdW cut-off needs to be checked separately from the Coulomb cut-off
+    constexpr bool doVdwCutoffCheck = Props::elecEwaldTwin;
+    //! Whether per-atom combination rule parameters are used instead of atom types
+    constexpr bool ljComb = Props::vdwComb;
+
+    const auto a_xq       = getAccessor<mode::read>(atdat.xq, cgh);
+    const auto a_f        = getAccessor<mode::read_write>(atdat.f, cgh);
+    const auto a_shiftVec = getAccessor<mode::read>(atdat.shift_vec, cgh);
+    const auto a_fShift   = getAccessor<mode::read_write>(atdat.fshift, cgh);
+    const auto a_energyVdw  = getOptionalAccessor<mode::read_write, doCalcEnergies>(atdat.e_lj, cgh);
+    const auto a_energyElec = getOptionalAccessor<mode::read_write, doCalcEnergies>(atdat.e_el, cgh);
+    const auto a_plistCJ4 = getAccessor<doPruneNBL ? mode::read_write : mode::read>(plist.cj4, cgh);
+    const auto a_plistSci  = getAccessor<mode::read>(plist.sci, cgh);
+    const auto a_plistExcl = getAccessor<mode::read>(plist.excl, cgh);
+    const auto a_ljComb    = getOptionalAccessor<mode::read, ljComb>(atdat.lj_comb, cgh);
+    const auto a_atomTypes = getOptionalAccessor<mode::read, !ljComb>(atdat.atom_types, cgh);
+    const auto a_nbfp      = getOptionalAccessor<mode::read, !ljComb>(nbp.nbfp, cgh);
+    const auto a_nbfpComb  = getOptionalAccessor<mode::read, Props::vdwEwald>(nbp.nbfp_comb, cgh);
+    const auto a_coulombTab = getOptionalAccessor<mode::read, Props::elecEwaldTab>(nbp.coulomb_tab, cgh);
+
+    // i-atom coordinates and charges, with the shift applied and the charge scaled
+    LocalAccessor<cl::sycl::float4> sm_xq(
+            cl::sycl::range<1>(c_nbnxnGpuNumClusterPerSupercluster * c_clSize), cgh);
+    // j-cluster indices of the current j4 group, separate for each sub-group
+    LocalAccessor<int> sm_jList(cl::sycl::range<1>(c_nbnxnGpuClusterpairSplit * c_nbnxnGpuJgroupSize), cgh);
+    // i-atom types or combination rule parameters
+    auto sm_atomTypeI = getOptionalLocalAccessor<int, !ljComb>(
+            c_nbnxnGpuNumClusterPerSupercluster * c_clSize, cgh);
+    auto sm_ljCombI = getOptionalLocalAccessor<cl::sycl::float2, ljComb>(
+            c_nbnxnGpuNumClusterPerSupercluster * c_clSize, cgh);
+
+    // Only scalars are captured by the kernel, the parameter structs hold device buffers
+    const int             numTypes        = atdat.ntypes;
+    const float           epsFac          = nbp.epsfac;
+    const float           cRF             = nbp.c_rf;
+    const float           twoKRf          = nbp.two_k_rf;
+    const float           ewaldBeta       = nbp.ewald_beta;
+    const float           ewaldShift      = nbp.sh_ewald;
+    const float           ljEwaldShift    = nbp.sh_lj_ewald;
+    const float           ewaldCoeffLJ    = nbp.ewaldcoeff_lj;
+    const float           rCoulombSq      = nbp.rcoulomb_sq;
+    const float           rVdwSq          = nbp.rvdw_sq;
+    const float           rVdwSwitch      = nbp.rvdw_switch;
+    const float           rlistOuterSq    = nbp.rlistOuter_sq;
+    const shift_consts_t  dispersionShift = nbp.dispersion_shift;
+    const shift_consts_t  repulsionShift  = nbp.repulsion_shift;
+    const switch_consts_t vdwSwitch       = nbp.vdw_switch;
+    const float           coulombTabScale = nbp.coulomb_tab_scale;
+
+    return [=](cl::sycl::nd_item<3> itemIdx) [[intel::reqd_sub_group_size(c_subGroupSize)]]
+    {
+        /* thread/block/sub-group id-s */
+        const unsigned                    tidxi = itemIdx.get_local_id(2);
+        const unsigned                    tidxj = itemIdx.get_local_id(1);
+        const unsigned                    tidx  = tidxj * c_clSize + tidxi;
+        const unsigned                    bidx  = itemIdx.get_group(0);
+        const unsigned                    widx  = tidx / c_subGroupSize;
+        const cl::sycl::ONEAPI::sub_group sg    = itemIdx.get_sub_group();
+
+        cl::sycl::float3 fCiBuf[c_nbnxnGpuNumClusterPerSupercluster];
+        for (int i = 0; i < c_nbnxnGpuNumClusterPerSupercluster; i++)
+        {
+            fCiBuf[i] = cl::sycl::float3(0.0F, 0.0F, 0.0F);
+        }
+
+        const nbnxn_sci_t nbSci     = a_plistSci[bidx];
+        const int         sci       = nbSci.sci;
+        const int         cij4Start = nbSci.cj4_ind_start;
+        const int         cij4End   = nbSci.cj4_ind_end;
+
+        // Only used with analytical Ewald
+        const float beta2 = ewaldBeta * ewaldBeta;
+        const float beta3 = ewaldBeta * ewaldBeta * ewaldBeta;
+
+        // Only used with LJ-PME
+        const float ljEwaldCoeff2   = ewaldCoeffLJ * ewaldCoeffLJ;
+        const float ljEwaldCoeff6_6 = ljEwaldCoeff2 * ljEwaldCoeff2 * ljEwaldCoeff2 * c_oneSixth;
+
+        /* Pre-load i-atom x and q into shared memory */
+        {
+            const int ci = sci * c_nbnxnGpuNumClusterPerSupercluster + tidxj;
+            const int ai = ci * c_clSize + tidxi;
+
+            const gmx::RVec        shift = a_shiftVec[nbSci.shift];
+            const cl::sycl::float4 xq    = a_xq[ai];
+            sm_xq[tidxj * c_clSize + tidxi] = cl::sycl::float4(
+                    xq.x() + shift[XX], xq.y() + shift[YY], xq.z() + shift[ZZ], xq.w() * epsFac);
+
+            if constexpr (!ljComb)
+            {
+                sm_atomTypeI[tidxj * c_clSize + tidxi] = a_atomTypes[ai];
+            }
+            else
+            {
+                sm_ljCombI[tidxj * c_clSize + tidxi] = a_ljComb[ai];
+            }
+        }
+        itemIdx.barrier(cl::sycl::access::fence_space::local_space);
+
+        float energyVdw  = 0.0F;
+        float energyElec = 0.0F;
+
+        if constexpr (doCalcEnergies && doExclusionForces)
+        {
+            if (nbSci.shift == CENTRAL && a_plistCJ4[cij4Start].cj[0] == sci * c_nbnxnGpuNumClusterPerSupercluster)
+            {
+                // we have the diagonal: add the charge and LJ self interaction energy term
+                for (int i = 0; i < c_nbnxnGpuNumClusterPerSupercluster; i++)
+                {
+                    const float qi = sm_xq[i * c_clSize + tidxi].w();
+                    energyElec += qi * qi;
+
+                    if constexpr (Props::vdwEwald)
+                    {
+                        energyVdw += a_nbfp[a_atomTypes[(sci * c_nbnxnGpuNumClusterPerSupercluster + i) * c_clSize + tidxi]
+                                            * (numTypes + 1) * 2];
+                    }
+                }
+
+                /* divide the self term(s) equally over the j-threads, then multiply with the coefficients. */
+                if constexpr (Props::vdwEwald)
+                {
+                    energyVdw /= c_clSize;
+                    energyVdw *= 0.5F * c_oneSixth * ljEwaldCoeff6_6;
+                }
+
+                energyElec /= epsFac * c_clSize;
+                if constexpr (Props::elecRF || Props::elecCutoff)
+                {
+                    energyElec *= -0.5F * cRF;
+                }
+                else
+                {
+                    energyElec *= -ewaldBeta * M_FLOAT_1_SQRTPI; /* last factor 1/sqrt(pi) */
+                }
+            }
+        }
+
+        const bool nonSelfInteraction = !(nbSci.shift == CENTRAL && tidxj <= tidxi);
+
+        for (int j4 = cij4Start; j4 < cij4End; j4++)
+        {
+            const int      wexclIdx = a_plistCJ4[j4].imei[widx].excl_ind;
+            unsigned       imask    = a_plistCJ4[j4].imei[widx].imask;
+            const unsigned wexcl    = a_plistExcl[wexclIdx].pair[tidx & (c_subGroupSize - 1)];
+
+            if (doPruneNBL || imask)
+            {
+                /* Pre-load cj into shared memory on both sub-groups separately */
+                if ((tidxj == 0 || tidxj == c_splitClSize) && tidxi < c_nbnxnGpuJgroupSize)
+                {
+                    sm_jList[tidxi + tidxj * c_nbnxnGpuJgroupSize / c_splitClSize] = a_plistCJ4[j4].cj[tidxi];
+                }
+                sg.barrier();
+
+                for (int jm = 0; jm < c_nbnxnGpuJgroupSize; jm++)
+                {
+                    if (imask & (superClInteractionMask << (jm * c_nbnxnGpuNumClusterPerSupercluster)))
+                    {
+                        unsigned  maskJi = (1U << (jm * c_nbnxnGpuNumClusterPerSupercluster));
+                        const int cj = sm_jList[jm + (tidxj & c_splitClSize) * c_nbnxnGpuJgroupSize / c_splitClSize];
+                        const int aj = cj * c_clSize + tidxj;
+
+                        /* load j atom data */
+                        const cl::sycl::float4 xqj = a_xq[aj];
+                        const cl::sycl::float3 xj(xqj.x(), xqj.y(), xqj.z());
+                        const float            qj = xqj.w();
+
+                        int              atomTypeJ = 0;
+                        cl::sycl::float2 ljCombJ;
+                        if constexpr (!ljComb)
+                        {
+                            atomTypeJ = a_atomTypes[aj];
+                        }
+                        else
+                        {
+                            ljCombJ = a_ljComb[aj];
+                        }
+
+                        cl::sycl::float3 fCjBuf(0.0F, 0.0F, 0.0F);
+
+                        for (int i = 0; i < c_nbnxnGpuNumClusterPerSupercluster; i++)
+                        {
+                            if (imask & maskJi)
+                            {
+                                /* i cluster index */
+                                const int ci = sci * c_nbnxnGpuNumClusterPerSupercluster + i;
+                                /* all threads load an atom from i cluster ci into shmem! */
+                                const cl::sycl::float4 xqi = sm_xq[i * c_clSize + tidxi];
+                                const cl::sycl::float3 xi(xqi.x(), xqi.y(), xqi.z());
+
+                                /* distance between i and j atoms */
+                                const cl::sycl::float3 rv = xi - xj;
+                                float                  r2 = cl::sycl::dot(rv, rv);
+
+                                if constexpr (doPruneNBL)
+                                {
+                                    /* If _none_ of the atoms pairs are in cutoff range,
+                                     * the bit corresponding to the current
+                                     * cluster-pair in imask gets set to 0. */
+                                    if (!cl::sycl::ONEAPI::any_of(sg, r2 < rlistOuterSq))
+                                    {
+                                        imask &= ~maskJi;
+                                    }
+                                }
+
+                                const float intBit = (wexcl & maskJi) ? 1.0F : 0.0F;
+
+                                /* cutoff & exclusion check */
+                                const bool withinCutoff =
+                                        doExclusionForces
+                                                ? (r2 < rCoulombSq && (nonSelfInteraction || ci != cj))
+                                                : (r2 < rCoulombSq && (wexcl & maskJi));
+                                if (withinCutoff)
+                                {
+                                    const float qi = xqi.w();
+
+                                    int   atomTypeI = 0;
+                                    float c6        = 0.0F;
+                                    float c12       = 0.0F;
+                                    float sigma     = 0.0F;
+                                    float epsilon   = 0.0F;
+                                    if constexpr (!ljComb)
+                                    {
+                                        /* LJ 6*C6 and 12*C12 */
+                                        atomTypeI = sm_atomTypeI[i * c_clSize + tidxi];
+                                        c6        = a_nbfp[2 * (numTypes * atomTypeI + atomTypeJ)];
+                                        c12       = a_nbfp[2 * (numTypes * atomTypeI + atomTypeJ) + 1];
+                                    }
+                                    else
+                                    {
+                                        const cl::sycl::float2 ljCombI = sm_ljCombI[i * c_clSize + tidxi];
+                                        if constexpr (Props::vdwCombGeom)
+                                        {
+                                            c6  = ljCombI.x() * ljCombJ.x();
+                                            c12 = ljCombI.y() * ljCombJ.y();
+                                        }
+                                        else
+                                        {
+                                            sigma   = ljCombI.x() + ljCombJ.x();
+                                            epsilon = ljCombI.y() * ljCombJ.y();
+                                            if constexpr (doCalcEnergies)
+                                            {
+                                                convertSigmaEpsilonToC6C12(sigma, epsilon, &c6, &c12);
+                                            }
+                                        }
+                                    }
+
+                                    // Ensure distance do not become so small that r^-12 overflows
+                                    r2 = cl::sycl::fmax(r2, c_nbnxnMinDistanceSquared);
+
+                                    const float rInv  = cl::sycl::rsqrt(r2);
+                                    const float r2Inv = rInv * rInv;
+
+                                    float fInvR       = 0.0F;
+                                    float energyLJPair = 0.0F;
+                                    if constexpr (!Props::vdwCombLB || doCalcEnergies)
+                                    {
+                                        float r6Inv = r2Inv * r2Inv * r2Inv;
+                                        if constexpr (doExclusionForces)
+                                        {
+                                            /* We could mask r2Inv, but with Ewald
+                                             * masking both r6Inv and fInvR is faster */
+                                            r6Inv *= intBit;
+                                        }
+
+                                        fInvR = r6Inv * (c12 * r6Inv - c6) * r2Inv;
+                                        if constexpr (doCalcEnergies || Props::vdwPSwitch)
+                                        {
+                                            energyLJPair = intBit
+                                                           * (c12 * (r6Inv * r6Inv + repulsionShift.cpot) * c_oneTwelveth
+                                                              - c6 * (r6Inv + dispersionShift.cpot) * c_oneSixth);
+                                        }
+                                    }
+                                    else
+                                    {
+                                        const float sigmaRInv = sigma * rInv;
+                                        const float sigma2    = sigmaRInv * sigmaRInv;
+                                        float       sigma6    = sigma2 * sigma2 * sigma2;
+                                        if constexpr (doExclusionForces)
+                                        {
+                                            sigma6 *= intBit;
+                                        }
+                                        fInvR = epsilon * sigma6 * (sigma6 - 1.0F) * r2Inv;
+                                    }
+
+                                    if constexpr (Props::vdwFSwitch)
+                                    {
+                                        if constexpr (doCalcEnergies)
+                                        {
+                                            ljForceSwitchFE(dispersionShift, repulsionShift, rVdwSwitch, c6,
+                                                            c12, rInv, r2, &fInvR, &energyLJPair);
+                                        }
+                                        else
+                                        {
+                                            ljForceSwitchF(dispersionShift, repulsionShift, rVdwSwitch, c6,
+                                                           c12, rInv, r2, &fInvR);
+                                        }
+                                    }
+
+                                    if constexpr (Props::vdwEwaldCombGeom)
+                                    {
+                                        const float c6grid = a_nbfpComb[2 * atomTypeI] * a_nbfpComb[2 * atomTypeJ];
+                                        ljEwaldCombGeomFE(c6grid, r2, r2Inv, ljEwaldCoeff2, ljEwaldCoeff6_6,
+                                                          ljEwaldShift, intBit, &fInvR,
+                                                          doCalcEnergies ? &energyLJPair : nullptr);
+                                    }
+                                    else if constexpr (Props::vdwEwaldCombLB)
+                                    {
+                                        const float sigmaGrid =
+                                                a_nbfpComb[2 * atomTypeI] + a_nbfpComb[2 * atomTypeJ];
+                                        const float epsilonGrid =
+                                                a_nbfpComb[2 * atomTypeI + 1] * a_nbfpComb[2 * atomTypeJ + 1];
+                                        ljEwaldCombLBFE(sigmaGrid, epsilonGrid, r2, r2Inv, ljEwaldCoeff2,
+                                                        ljEwaldCoeff6_6, ljEwaldShift, intBit, &fInvR,
+                                                        doCalcEnergies ? &energyLJPair : nullptr);
+                                    }
+
+                                    if constexpr (Props::vdwPSwitch)
+                                    {
+                                        if constexpr (doCalcEnergies)
+                                        {
+                                            ljPotentialSwitchFE(vdwSwitch, rVdwSwitch, rInv, r2, &fInvR,
+                                                                &energyLJPair);
+                                        }
+                                        else
+                                        {
+                                            ljPotentialSwitchF(vdwSwitch, rVdwSwitch, rInv, r2, &fInvR,
+                                                               &energyLJPair);
+                                        }
+                                    }
+
+                                    if constexpr (doVdwCutoffCheck)
+                                    {
+                                        /* Separate VDW cut-off check to enable twin-range cut-offs
+                                         * (rvdw < rcoulomb <= rlist) */
+                                        const float vdwInRange = (r2 < rVdwSq) ? 1.0F : 0.0F;
+                                        fInvR *= vdwInRange;
+                                        if constexpr (doCalcEnergies)
+                                        {
+                                            energyLJPair *= vdwInRange;
+                                        }
+                                    }
+
+                                    if constexpr (doCalcEnergies)
+                                    {
+                                        energyVdw += energyLJPair;
+                                    }
+
+                                    if constexpr (Props::elecCutoff)
+                                    {
+                                        if constexpr (doExclusionForces)
+                                        {
+                                            fInvR += qi * qj * intBit * r2Inv * rInv;
+                                        }
+                                        else
+                                        {
+                                            fInvR += qi * qj * r2Inv * rInv;
+                                        }
+                                    }
+                                    if constexpr (Props::elecRF)
+                                    {
+                                        fInvR += qi * qj * (intBit * r2Inv * rInv - twoKRf);
+                                    }
+                                    if constexpr (Props::elecEwaldAna)
+                                    {
+                                        fInvR += qi * qj * (intBit * r2Inv * rInv + pmeCorrF(beta2 * r2) * beta3);
+                                    }
+                                    else if constexpr (Props::elecEwaldTab)
+                                    {
+                                        fInvR += qi * qj
+                                                 * (intBit * r2Inv
+                                                    - interpolateCoulombForceR(a_coulombTab, coulombTabScale,
+                                                                               r2 * rInv))
+                                                 * rInv;
+                                    }
+
+                                    if constexpr (doCalcEnergies)
+                                    {
+                                        if constexpr (Props::elecCutoff)
+                                        {
+                                            energyElec += qi * qj * (intBit * rInv - cRF);
+                                        }
+                                        if constexpr (Props::elecRF)
+                                        {
+                                            energyElec += qi * qj * (intBit * rInv + 0.5F * twoKRf * r2 - cRF);
+                                        }
+                                        if constexpr (Props::elecEwald)
+                                        {
+                                            /* 1.0F - erff is faster than erfcf */
+                                            energyElec += qi * qj
+                                                          * (rInv * (intBit - cl::sycl::erf(r2 * rInv * ewaldBeta))
+                                                             - intBit * ewaldShift);
+                                        }
+                                    }
+
+                                    const cl::sycl::float3 forceIJ = rv * fInvR;
+
+                                    /* accumulate j forces in registers */
+                                    fCjBuf -= forceIJ;
+
+                                    /* accumulate i forces in registers */
+                                    fCiBuf[i] += forceIJ;
+                                }
+                            }
+                            /* shift the mask bit by 1 */
+                            maskJi += maskJi;
+                        }
+
+                        /* reduce j forces */
+                        reduceForceJShuffle(fCjBuf, sg, tidxi, aj, a_f);
+                    }
+                }
+                if constexpr (doPruneNBL)
+                {
+                    /* Update the imask with the new one which does not contain the
+                     * out of range clusters anymore. */
+                    a_plistCJ4[j4].imei[widx].imask = imask;
+                }
+            }
+            sg.barrier();
+        }
+
+        /* skip central shifts when summing shift forces */
+        const bool doCalcShift = (calcShift && nbSci.shift != CENTRAL);
+
+        float fShiftBuf = 0.0F;
+
+        /* reduce i forces */
+        for (int i = 0; i < c_nbnxnGpuNumClusterPerSupercluster; i++)
+        {
+            const int ai = (sci * c_nbnxnGpuNumClusterPerSupercluster + i) * c_clSize + tidxi;
+            reduceForceIShuffle(fCiBuf[i], sg, tidxj, ai, doCalcShift, &fShiftBuf, a_f);
+        }
+
+        /* add up local shift forces into global mem, tidxj indexes x,y,z */
+        if (doCalcShift && (tidxj & 3) < 3)
+        {
+            atomicFetchAdd(a_fShift[nbSci.shift][tidxj & 3], fShiftBuf);
+        }
+
+        if constexpr (doCalcEnergies)
+        {
+            /* reduce the energies over the sub-group and let its first lane add them */
+            const float energyVdwGroup =
+                    cl::sycl::ONEAPI::reduce(sg, energyVdw, cl::sycl::ONEAPI::plus<float>());
+            const float energyElecGroup =
+                    cl::sycl::ONEAPI::reduce(sg, energyElec, cl::sycl::ONEAPI::plus<float>());
+
+            if (tidx % c_subGroupSize == 0)
+            {
+                atomicFetchAdd(a_energyVdw[0], energyVdwGroup);
+                atomicFetchAdd(a_energyElec[0], energyElecGroup);
+            }
+        }
+    };
+}
+
+//! Submit the non-bonded kernel flavor given by the template parameters to \p deviceStream
+template<bool doPruneNBL, bool doCalcEnergies, enum ElecType elecType, enum VdwType vdwType>
+static void submitNbnxmKernel(const DeviceStream&    deviceStream,
+                              const int              numSci,
+                              const sycl_atomdata_t& atdat,
+                              const NBParamGpu&      nbp,
+                              const gpu_plist&       plist,
+                              const bool             calcShift)
+{
+    using KernelNameType = NbnxmKernel<doPruneNBL, doCalcEnergies, elecType, vdwType>;
+
+    /* Kernel launch config:
+     * - The thread block dimensions match the size of i-clusters and j-clusters.
+     * - The 1D block-grid contains as many blocks as super-clusters.
+     */
+    const cl::sycl::range<3>    blockSize{ 1, c_clSize, c_clSize };
+    const cl::sycl::range<3>    globalSize{ numSci * blockSize[0], blockSize[1], blockSize[2] };
+    const cl::sycl::nd_range<3> range{ globalSize, blockSize };
+
+    cl::sycl::queue q = deviceStream.stream();
+    q.submit([&](cl::sycl::handler& cgh) {
+        auto kernel = nbnxmKernel<doPruneNBL, doCalcEnergies, elecType, vdwType>(
+                cgh, atdat, nbp, plist, calcShift);
+        cgh.parallel_for<KernelNameType>(range, kernel);
+    });
+}
+
+void launchNbnxmKernel(NbnxmGpu* nb, const gmx::StepWorkload& stepWork, const InteractionLocality iloc)
+{
+    const sycl_atomdata_t* adat         = nb->atdat;
+    const NBParamGpu*      nbp          = nb->nbparam;
+    const gpu_plist*       plist        = nb->plist[iloc];
+    const DeviceStream&    deviceStream = *nb->deviceStreams[iloc];
+
+    /* The list is pruned in the kernel when it is fresh and was not pruned
+     * by a separate prune-only kernel. */
+    const bool doPruneNBL = (plist->haveFreshList && !nb->timers->interaction[iloc].didPrune);
+
+    gmx::dispatchTemplatedFunction(
+            [&](auto doPruneNBL_, auto doCalcEnergies_, auto elecType_, auto vdwType_) {
+                submitNbnxmKernel<doPruneNBL_, doCalcEnergies_, elecType_, vdwType_>(
+                        deviceStream, plist->nsci, *adat, *nbp, *plist, stepWork.computeVirial);
+            },
+            doPruneNBL, stepWork.computeEnergy, nbp->elecType, nbp->vdwType);
+}
+
+} // namespace Nbnxm
@@ -0,0 +1,274 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *  \brief
+ *  Implements the SYCL prune-only kernel, ported from nbnxm_cuda_kernel_pruneonly.cuh.
+ *
+ *  \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include "nbnxm_sycl_kernel_pruneonly.h"
+
+#include "gromacs/gpu_utils/devicebuffer.h"
+#include "gromacs/gpu_utils/gmxsycl.h"
+
+#include "nbnxm_sycl_kernel_utils.h"
+#include "nbnxm_sycl_types.h"
+
+namespace Nbnxm
+{
+
+//! Unique kernel name for each prune-only kernel flavor
+template<bool haveFreshList>
+class NbnxmKernelPruneOnly;
+
+/*! \brief Set up the accessors and return the prune-only kernel functor.
+ *
+ * With a fresh list the kernel prunes with the outer list cut-off, which is
+ * stored in plist.imask, as well as with the inner list cut-off, which goes
+ * into the cj4 mask used by the non-bonded kernel.
+ * Without a fresh list only the pairs whose masks differ are re-checked with
+ * the inner cut-off (rolling pruning).
+ *
+ * The work-groups have c_syclPruneKernelJ4Concurrency pairs of sub-groups,
+ * each processing a different j4 entry.
+ */
+template<bool haveFreshList>
+auto nbnxmKernelPruneOnly(cl::sycl::handler&     cgh,
+                          const sycl_atomdata_t& atdat,
+                          const NBParamGpu&      nbp,
+                          const gpu_plist&       plist,
+                          const int              numParts,
+                          const int              part)
+{
+    using cl::sycl::access::mode;
+
+    const auto a_xq       = getAccessor<mode::read>(atdat.xq, cgh);
+    const auto a_shiftVec = getAccessor<mode::read>(atdat.shift_vec, cgh);
+    const auto a_plistCJ4 = getAccessor<mode::read_write>(plist.cj4, cgh);
+    const auto a_plistSci = getAccessor<mode::read>(plist.sci, cgh);
+    const auto a_plistIMask = getAccessor<haveFreshList ? mode::write : mode::read>(plist.imask, cgh);
+
+    // i-atom coordinates with the shift applied, q is not used
+    LocalAccessor<cl::sycl::float4> sm_xq(
+            cl::sycl::range<1>(c_nbnxnGpuNumClusterPerSupercluster * c_clSize), cgh);
+    // j-cluster indices of the current j4 group, separate for each sub-group
+    LocalAccessor<int> sm_jList(
+            cl::sycl::range<1>(c_syclPruneKernelJ4Concurrency * c_nbnxnGpuClusterpairSplit * c_nbnxnGpuJgroupSize),
+            cgh);
+
+    const float rlistOuterSq = nbp.rlistOuter_sq;
+    const float rlistInnerSq = nbp.rlistInner_sq;
+
+    return [=](cl::sycl::nd_item<3> itemIdx) [[intel::reqd_sub_group_size(c_subGroupSize)]]
+    {
+        /* thread/block/sub-group id-s */
+        const unsigned                    tidxi = itemIdx.get_local_id(2);
+        const unsigned                    tidxj = itemIdx.get_local_id(1);
+        const unsigned                    tidxz = itemIdx.get_local_id(0);
+        const unsigned                    bidx  = itemIdx.get_group(0);
+        const unsigned                    widx  = (tidxj * c_clSize) / c_subGroupSize;
+        const cl::sycl::ONEAPI::sub_group sg    = itemIdx.get_sub_group();
+
+        /* the j-list offset of the pair of sub-groups in the j-concurrent execution */
+        const int jListOffset = tidxz * c_nbnxnGpuClusterpairSplit * c_nbnxnGpuJgroupSize;
+
+        /* my i super-cluster's index = current bidx * numParts + part */
+        const nbnxn_sci_t nbSci     = a_plistSci[bidx * numParts + part];
+        const int         sci       = nbSci.sci;
+        const int         cij4Start = nbSci.cj4_ind_start;
+        const int         cij4End   = nbSci.cj4_ind_end;
+
+        if (tidxz == 0)
+        {
+            /* Pre-load i-atom x into shared memory */
+            const int ci = sci * c_nbnxnGpuNumClusterPerSupercluster + tidxj;
+            const int ai = ci * c_clSize + tidxi;
+
+            const gmx::RVec        shift = a_shiftVec[nbSci.shift];
+            const cl::sycl::float4 xq    = a_xq[ai];
+            sm_xq[tidxj * c_clSize + tidxi] =
+                    cl::sycl::float4(xq.x() + shift[XX], xq.y() + shift[YY], xq.z() + shift[ZZ], xq.w());
+        }
+        itemIdx.barrier(cl::sycl::access::fence_space::local_space);
+
+        /* loop over the j clusters = seen by any of the atoms in the current super-cluster;
+         * The loop stride c_syclPruneKernelJ4Concurrency ensures that consecutive
+         * sub-group pairs are assigned consecutive j4's entries.
+         */
+        for (int j4 = cij4Start + tidxz; j4 < cij4End; j4 += c_syclPruneKernelJ4Concurrency)
+        {
+            unsigned imaskFull, imaskCheck, imaskNew;
+
+            if constexpr (haveFreshList)
+            {
+                /* Read the mask from the list transferred from the CPU */
+                imaskFull = a_plistCJ4[j4].imei[widx].imask;
+                /* We attempt to prune all pairs present in the original list */
+                imaskCheck = imaskFull;
+                imaskNew   = 0;
+            }
+            else
+            {
+                /* Read the mask from the sub-group-pruned by rlistOuter mask array */
+                imaskFull = a_plistIMask[j4 * c_nbnxnGpuClusterpairSplit + widx];
+                /* Read the old rolling pruned mask, use as a base for new */
+                imaskNew = a_plistCJ4[j4].imei[widx].imask;
+                /* We only need to check pairs with different mask */
+                imaskCheck = (imaskNew ^ imaskFull);
+            }
+
+            if (imaskCheck)
+            {
+                /* Pre-load cj into shared memory on both sub-groups separately */
+                if ((tidxj == 0 || tidxj == c_splitClSize) && tidxi < c_nbnxnGpuJgroupSize)
+                {
+                    sm_jList[jListOffset + tidxi + tidxj * c_nbnxnGpuJgroupSize / c_splitClSize] =
+                            a_plistCJ4[j4].cj[tidxi];
+                }
+                sg.barrier();
+
+                for (int jm = 0; jm < c_nbnxnGpuJgroupSize; jm++)
+                {
+                    if (imaskCheck & (superClInteractionMask << (jm * c_nbnxnGpuNumClusterPerSupercluster)))
+                    {
+                        unsigned  maskJi = (1U << (jm * c_nbnxnGpuNumClusterPerSupercluster));
+                        const int cj     = sm_jList[jListOffset + jm
+                                                + (tidxj & c_splitClSize) * c_nbnxnGpuJgroupSize / c_splitClSize];
+                        const int aj = cj * c_clSize + tidxj;
+
+                        /* load j atom data */
+                        const cl::sycl::float4 xqj = a_xq[aj];
+                        const cl::sycl::float3 xj(xqj.x(), xqj.y(), xqj.z());
+
+                        for (int i = 0; i < c_nbnxnGpuNumClusterPerSupercluster; i++)
+                        {
+                            if (imaskCheck & maskJi)
+                            {
+                                /* load i-cluster coordinates from shmem */
+                                const cl::sycl::float4 xqi = sm_xq[i * c_clSize + tidxi];
+                                const cl::sycl::float3 xi(xqi.x(), xqi.y(), xqi.z());
+
+                                /* distance between i and j atoms */
+                                const cl::sycl::float3 rv = xi - xj;
+                                const float            r2 = cl::sycl::dot(rv, rv);
+
+                                /* If _none_ of the atoms pairs are in rlistOuter
+                                   range, the bit corresponding to the current
+                                   cluster-pair in imask gets set to 0. */
+                                if (haveFreshList && !cl::sycl::ONEAPI::any_of(sg, r2 < rlistOuterSq))
+                                {
+                                    imaskFull &= ~maskJi;
+                                }
+                                /* If any atom pair is within range, set the bit
+                                   corresponding to the current cluster-pair. */
+                                if (cl::sycl::ONEAPI::any_of(sg, r2 < rlistInnerSq))
+                                {
+                                    imaskNew |= maskJi;
+                                }
+                            }
+
+                            /* shift the mask bit by 1 */
+                            maskJi += maskJi;
+                        }
+                    }
+                }
+
+                if constexpr (haveFreshList)
+                {
+                    /* copy the list pruned to rlistOuter to a separate buffer */
+                    a_plistIMask[j4 * c_nbnxnGpuClusterpairSplit + widx] = imaskFull;
+                }
+                /* update the imask with only the pairs up to rlistInner */
+                a_plistCJ4[j4].imei[widx].imask = imaskNew;
+            }
+            // avoid shared memory WAR hazards between loop iterations
+            sg.barrier();
+        }
+    };
+}
+
+//! Submit the prune-only kernel flavor given by the template parameter to \p deviceStream
+template<bool haveFreshList>
+static void submitNbnxmKernelPruneOnly(const DeviceStream&    deviceStream,
+                                       const int              numSciInPart,
+                                       const sycl_atomdata_t& atdat,
+                                       const NBParamGpu&      nbp,
+                                       const gpu_plist&       plist,
+                                       const int              numParts,
+                                       const int              part)
+{
+    using KernelNameType = NbnxmKernelPruneOnly<haveFreshList>;
+
+    /* Kernel launch config:
+     * - The thread block dimensions match the size of i-clusters, j-clusters,
+     *   and j-cluster concurrency, in x, y, and z, respectively.
+     * - The 1D block-grid contains as many blocks as super-clusters in this part.
+     */
+    const cl::sycl::range<3>    blockSize{ c_syclPruneKernelJ4Concurrency, c_clSize, c_clSize };
+    const cl::sycl::range<3>    globalSize{ numSciInPart * blockSize[0], blockSize[1], blockSize[2] };
+    const cl::sycl::nd_range<3> range{ globalSize, blockSize };
+
+    cl::sycl::queue q = deviceStream.stream();
+    q.submit([&](cl::sycl::handler& cgh) {
+        auto kernel = nbnxmKernelPruneOnly<haveFreshList>(cgh, atdat, nbp, plist, numParts, part);
+        cgh.parallel_for<KernelNameType>(range, kernel);
+    });
+}
+
+void launchNbnxmKernelPruneOnly(NbnxmGpu*                 nb,
+                                const InteractionLocality iloc,
+                                const int                 numParts,
+                                const int                 part,
+                                const int                 numSciInPart)
+{
+    const sycl_atomdata_t* adat         = nb->atdat;
+    const NBParamGpu*      nbp          = nb->nbparam;
+    const gpu_plist*       plist        = nb->plist[iloc];
+    const DeviceStream&    deviceStream = *nb->deviceStreams[iloc];
+
+    if (plist->haveFreshList)
+    {
+        submitNbnxmKernelPruneOnly<true>(deviceStream, numSciInPart, *adat, *nbp, *plist, numParts, part);
+    }
+    else
+    {
+        submitNbnxmKernelPruneOnly<false>(deviceStream, numSciInPart, *adat, *nbp, *plist, numParts, part);
+    }
+}
+
+} // namespace Nbnxm
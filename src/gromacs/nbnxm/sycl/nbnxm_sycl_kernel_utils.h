@@ -0,0 +1,375 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *  \brief
+ *  Utility constants and functions for the SYCL non-bonded kernels.
+ *
+ *  This is a port of nbnxm_cuda_kernel_utils.cuh; the device functions
+ *  take the parameters they need explicitly, as NBParamGpu holds device
+ *  buffers and can not be captured by a SYCL kernel. The generic accessor
+ *  helpers are in gpu_utils/syclutils.h.
+ *
+ *  \ingroup module_nbnxm
+ */
+
+#ifndef NBNXM_SYCL_NBNXM_SYCL_KERNEL_UTILS_H
+#define NBNXM_SYCL_NBNXM_SYCL_KERNEL_UTILS_H
+
+#include "gromacs/gpu_utils/devicebuffer.h"
+#include "gromacs/gpu_utils/gmxsycl.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/nbnxm/pairlistparams.h"
+
+#include "nbnxm_sycl_types.h"
+
+namespace Nbnxm
+{
+
+//! Square of cluster size
+static constexpr int c_clSizeSq = c_clSize * c_clSize;
+//! j-cluster size after split (4 in the current implementation)
+static constexpr int c_splitClSize = c_clSize / c_nbnxnGpuClusterpairSplit;
+/*! \brief The sub-group size the kernels are written for.
+ *
+ * One sub-group processes half of a cluster pair, like a warp does in CUDA.
+ */
+static constexpr int c_subGroupSize = c_clSizeSq / c_nbnxnGpuClusterpairSplit;
+//! i-cluster interaction mask for a super-cluster with all c_nbnxnGpuNumClusterPerSupercluster bits set
+static constexpr unsigned superClInteractionMask = ((1U << c_nbnxnGpuNumClusterPerSupercluster) - 1U);
+
+//! 1/6, single precision
+static constexpr float c_oneSixth = 0.16666667F;
+//! 1/12, single precision
+static constexpr float c_oneTwelveth = 0.08333333F;
+
+//! Atomically add \p value to \p destination in global memory
+static inline void atomicFetchAdd(float& destination, const float value)
+{
+    cl::sycl::ONEAPI::atomic_ref<float, cl::sycl::ONEAPI::memory_order::relaxed, cl::sycl::ONEAPI::memory_scope::device,
+                                 cl::sycl::access::address_space::global_space>
+            ref(destination);
+    ref.fetch_add(value);
+}
+
+//! Convert LJ sigma,epsilon parameters to C6,C12
+static inline void convertSigmaEpsilonToC6C12(const float sigma, const float epsilon, float* c6, float* c12)
+{
+    const float sigma2 = sigma * sigma;
+    const float sigma6 = sigma2 * sigma2 * sigma2;
+    *c6                = epsilon * sigma6;
+    *c12               = *c6 * sigma6;
+}
+
+//! Apply force switch, force-only version
+static inline void ljForceSwitchF(const shift_consts_t dispersionShift,
+                                  const shift_consts_t repulsionShift,
+                                  const float          rVdwSwitch,
+                                  const float          c6,
+                                  const float          c12,
+                                  const float          rInv,
+                                  const float          r2,
+                                  float*               fInvR)
+{
+    const float r       = r2 * rInv;
+    const float rSwitch = cl::sycl::fmax(r - rVdwSwitch, 0.0F);
+
+    *fInvR += -c6 * (dispersionShift.c2 + dispersionShift.c3 * rSwitch) * rSwitch * rSwitch * rInv
+              + c12 * (repulsionShift.c2 + repulsionShift.c3 * rSwitch) * rSwitch * rSwitch * rInv;
+}
+
+//! Apply force switch, force + energy version
+static inline void ljForceSwitchFE(const shift_consts_t dispersionShift,
+                                   const shift_consts_t repulsionShift,
+                                   const float          rVdwSwitch,
+                                   const float          c6,
+                                   const float          c12,
+                                   const float          rInv,
+                                   const float          r2,
+                                   float*               fInvR,
+                                   float*               eLJ)
+{
+    const float r       = r2 * rInv;
+    const float rSwitch = cl::sycl::fmax(r - rVdwSwitch, 0.0F);
+
+    *fInvR += -c6 * (dispersionShift.c2 + dispersionShift.c3 * rSwitch) * rSwitch * rSwitch * rInv
+              + c12 * (repulsionShift.c2 + repulsionShift.c3 * rSwitch) * rSwitch * rSwitch * rInv;
+    *eLJ += c6 * (dispersionShift.c2 / 3 + dispersionShift.c3 / 4 * rSwitch) * rSwitch * rSwitch * rSwitch
+            - c12 * (repulsionShift.c2 / 3 + repulsionShift.c3 / 4 * rSwitch) * rSwitch * rSwitch * rSwitch;
+}
+
+//! Apply potential switch, force-only version
+static inline void ljPotentialSwitchF(const switch_consts_t vdwSwitch,
+                                      const float           rVdwSwitch,
+                                      const float           rInv,
+                                      const float           r2,
+                                      float*                fInvR,
+                                      const float*          eLJ)
+{
+    const float r       = r2 * rInv;
+    const float rSwitch = r - rVdwSwitch;
+
+    /* Unlike in the F+E kernel, conditional is faster here */
+    if (rSwitch > 0.0F)
+    {
+        const float sw =
+                1.0F
+                + (vdwSwitch.c3 + (vdwSwitch.c4 + vdwSwitch.c5 * rSwitch) * rSwitch) * rSwitch * rSwitch * rSwitch;
+        const float dsw = (3 * vdwSwitch.c3 + (4 * vdwSwitch.c4 + 5 * vdwSwitch.c5 * rSwitch) * rSwitch)
+                          * rSwitch * rSwitch;
+
+        *fInvR = (*fInvR) * sw - rInv * (*eLJ) * dsw;
+    }
+}
+
+//! Apply potential switch, force + energy version
+static inline void ljPotentialSwitchFE(const switch_consts_t vdwSwitch,
+                                       const float           rVdwSwitch,
+                                       const float           rInv,
+                                       const float           r2,
+                                       float*                fInvR,
+                                       float*                eLJ)
+{
+    const float r       = r2 * rInv;
+    const float rSwitch = cl::sycl::fmax(r - rVdwSwitch, 0.0F);
+
+    /* Unlike in the F-only kernel, masking is faster here */
+    const float sw =
+            1.0F + (vdwSwitch.c3 + (vdwSwitch.c4 + vdwSwitch.c5 * rSwitch) * rSwitch) * rSwitch * rSwitch * rSwitch;
+    const float dsw = (3 * vdwSwitch.c3 + (4 * vdwSwitch.c4 + 5 * vdwSwitch.c5 * rSwitch) * rSwitch)
+                      * rSwitch * rSwitch;
+
+    *fInvR = (*fInvR) * sw - rInv * (*eLJ) * dsw;
+    *eLJ *= sw;
+}
+
+/*! \brief Calculate LJ-PME grid force contribution with geometric combination rule.
+ *
+ * \p c6grid is the product of the per-type grid coefficients.
+ * The energy is only computed when \p eLJ is not nullptr.
+ */
+static inline void ljEwaldCombGeomFE(const float c6grid,
+                                     const float r2,
+                                     const float r2Inv,
+                                     const float ljEwaldCoeff2,
+                                     const float ljEwaldCoeff6_6,
+                                     const float ljEwaldShift,
+                                     const float intBit,
+                                     float*      fInvR,
+                                     float*      eLJ)
+{
+    /* Recalculate inv_r6 without exclusion mask */
+    const float r6InvNoMask = r2Inv * r2Inv * r2Inv;
+    const float cr2         = ljEwaldCoeff2 * r2;
+    const float expmcr2     = cl::sycl::exp(-cr2);
+    const float poly        = 1.0F + cr2 + 0.5F * cr2 * cr2;
+
+    /* Subtract the grid force from the total LJ force */
+    *fInvR += c6grid * (r6InvNoMask - expmcr2 * (r6InvNoMask * poly + ljEwaldCoeff6_6)) * r2Inv;
+
+    if (eLJ != nullptr)
+    {
+        /* Shift should be applied only to real LJ pairs */
+        const float shiftMask = ljEwaldShift * intBit;
+        *eLJ += c_oneSixth * c6grid * (r6InvNoMask * (1.0F - expmcr2 * poly) + shiftMask);
+    }
+}
+
+/*! \brief Calculate LJ-PME grid force contribution with Lorentz-Berthelot combination rule.
+ *
+ * \p sigma and \p epsilon are the combined per-type grid parameters, scaled to give 6*C6.
+ * The energy is only computed when \p eLJ is not nullptr.
+ */
+static inline void ljEwaldCombLBFE(const float sigma,
+                                   const float epsilon,
+                                   const float r2,
+                                   const float r2Inv,
+                                   const float ljEwaldCoeff2,
+                                   const float ljEwaldCoeff6_6,
+                                   const float ljEwaldShift,
+                                   const float intBit,
+                                   float*      fInvR,
+                                   float*      eLJ)
+{
+    const float sigma2 = sigma * sigma;
+    const float c6grid = epsilon * sigma2 * sigma2 * sigma2;
+
+    ljEwaldCombGeomFE(c6grid, r2, r2Inv, ljEwaldCoeff2, ljEwaldCoeff6_6, ljEwaldShift, intBit, fInvR, eLJ);
+}
+
+//! Linear interpolation using exactly two FMA operations
+static inline float lerp(const float d0, const float d1, const float t)
+{
+    return cl::sycl::fma(t, d1, cl::sycl::fma(-t, d0, d0));
+}
+
+//! Interpolate Ewald coulomb force correction using the F*r table
+template<typename TableAccessor>
+static inline float interpolateCoulombForceR(const TableAccessor& a_coulombTab,
+                                             const float          coulombTabScale,
+                                             const float          r)
+{
+    const float normalized = coulombTabScale * r;
+    const int   index      = static_cast<int>(normalized);
+    const float fraction   = normalized - index;
+
+    const float left  = a_coulombTab[index];
+    const float right = a_coulombTab[index + 1];
+
+    return lerp(left, right, fraction);
+}
+
+//! Calculate analytical Ewald correction term
+static inline float pmeCorrF(const float z2)
+{
+    constexpr float FN6 = -1.7357322914161492954e-8F;
+    constexpr float FN5 = 1.4703624142580877519e-6F;
+    constexpr float FN4 = -0.000053401640219807709149F;
+    constexpr float FN3 = 0.0010054721316683106153F;
+    constexpr float FN2 = -0.019278317264888380590F;
+    constexpr float FN1 = 0.069670166153766424023F;
+    constexpr float FN0 = -0.75225204789749321333F;
+
+    constexpr float FD4 = 0.0011193462567257629232F;
+    constexpr float FD3 = 0.014866955030185295499F;
+    constexpr float FD2 = 0.11583842382862377919F;
+    constexpr float FD1 = 0.50736591960530292870F;
+    constexpr float FD0 = 1.0F;
+
+    const float z4 = z2 * z2;
+
+    float polyFD0 = FD4 * z4 + FD2;
+    float polyFD1 = FD3 * z4 + FD1;
+    polyFD0       = polyFD0 * z4 + FD0;
+    polyFD0       = polyFD1 * z2 + polyFD0;
+
+    polyFD0 = 1.0F / polyFD0;
+
+    float polyFN0 = FN6 * z4 + FN4;
+    float polyFN1 = FN5 * z4 + FN3;
+    polyFN0       = polyFN0 * z4 + FN2;
+    polyFN1       = polyFN1 * z4 + FN1;
+    polyFN0       = polyFN0 * z4 + FN0;
+    polyFN0       = polyFN1 * z2 + polyFN0;
+
+    return polyFN0 * polyFD0;
+}
+
+/*! \brief Final j-force reduction over the i-atoms in a sub-group.
+ *
+ * Uses shuffles, so works only with power of two cluster sizes.
+ * Thread \p tidxi with \p tidxi < 3 adds component \p tidxi of the force on \p aidx.
+ */
+template<typename ForceAccessor>
+static inline void reduceForceJShuffle(cl::sycl::float3                 f,
+                                       const cl::sycl::ONEAPI::sub_group sg,
+                                       const int                        tidxi,
+                                       const int                        aidx,
+                                       const ForceAccessor&             a_f)
+{
+    static_assert(c_clSize == 8, "The shuffle-based reduction assumes 8-wide clusters");
+
+    f[0] += sg.shuffle_down(f[0], 1);
+    f[1] += sg.shuffle_up(f[1], 1);
+    f[2] += sg.shuffle_down(f[2], 1);
+
+    if (tidxi & 1)
+    {
+        f[0] = f[1];
+    }
+
+    f[0] += sg.shuffle_down(f[0], 2);
+    f[2] += sg.shuffle_up(f[2], 2);
+
+    if (tidxi & 2)
+    {
+        f[0] = f[2];
+    }
+
+    f[0] += sg.shuffle_down(f[0], 4);
+
+    if (tidxi < 3)
+    {
+        atomicFetchAdd(a_f[aidx][tidxi], f[0]);
+    }
+}
+
+/*! \brief Final i-force reduction over the j-atoms in a sub-group.
+ *
+ * Uses shuffles, so works only with power of two cluster sizes.
+ * The threads with (\p tidxj & 3) < 3 add a component of the force on \p aidx,
+ * and accumulate it in \p fShiftBuf when \p calcFShift is set.
+ */
+template<typename ForceAccessor>
+static inline void reduceForceIShuffle(cl::sycl::float3                 fin,
+                                       const cl::sycl::ONEAPI::sub_group sg,
+                                       const int                        tidxj,
+                                       const int                        aidx,
+                                       const bool                       calcFShift,
+                                       float*                           fShiftBuf,
+                                       const ForceAccessor&             a_f)
+{
+    fin[0] += sg.shuffle_down(fin[0], c_clSize);
+    fin[1] += sg.shuffle_up(fin[1], c_clSize);
+    fin[2] += sg.shuffle_down(fin[2], c_clSize);
+
+    if (tidxj & 1)
+    {
+        fin[0] = fin[1];
+    }
+
+    fin[0] += sg.shuffle_down(fin[0], 2 * c_clSize);
+    fin[2] += sg.shuffle_up(fin[2], 2 * c_clSize);
+
+    if (tidxj & 2)
+    {
+        fin[0] = fin[2];
+    }
+
+    /* Threads 0,1,2 and 4,5,6 increment x,y,z for their sub-group */
+    if ((tidxj & 3) < 3)
+    {
+        atomicFetchAdd(a_f[aidx][tidxj & 3], fin[0]);
+
+        if (calcFShift)
+        {
+            *fShiftBuf += fin[0];
+        }
+    }
+}
+
+} // namespace Nbnxm
+
+#endif // NBNXM_SYCL_NBNXM_SYCL_KERNEL_UTILS_H
@@ -0,0 +1,206 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the compact GPU j-atom coordinate format.
+ *
+ * \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include "gromacs/nbnxm/gpu_compact_xq.h"
+
+#include <cmath>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/vec.h"
+
+namespace Nbnxm
+{
+namespace test
+{
+namespace
+{
+
+//! The GPU cluster size
+constexpr int c_clusterSize = 8;
+//! The number of clusters in the test data
+constexpr int c_numClusters = 3;
+
+/*! \brief Returns xyzq test data with clusters of different spatial extent
+ *
+ * The last two atoms of the last cluster are fillers.
+ */
+std::vector<real> generateXq()
+{
+    std::vector<real> xq;
+    for (int c = 0; c < c_numClusters; c++)
+    {
+        const float extent = 0.1F + 0.4F * c;
+        for (int i = 0; i < c_clusterSize; i++)
+        {
+            const int a = c * c_clusterSize + i;
+            if (c == c_numClusters - 1 && i >= c_clusterSize - 2)
+            {
+                xq.insert(xq.end(), { c_compactXqFarAway, c_compactXqFarAway, c_compactXqFarAway, 0 });
+            }
+            else
+            {
+                xq.insert(xq.end(), { 2.0F * c + extent * std::sin(1.3F * a),
+                                      7.5F - extent * std::cos(0.7F * a),
+                                      1.0F + extent * std::sin(2.1F * a + 0.5F), 0.1F * (i - 4) });
+            }
+        }
+    }
+    return xq;
+}
+
+class CompactXqTest : public ::testing::Test
+{
+public:
+    CompactXqTest() :
+        xq_(generateXq()),
+        types_(c_numClusters * c_clusterSize),
+        references_(c_numClusters),
+        atoms_(c_numClusters * c_clusterSize)
+    {
+        for (size_t a = 0; a < types_.size(); a++)
+        {
+            types_[a] = (a * 7919) % c_compactXqMaxNumTypes;
+        }
+        packCompactXq(xq_, types_, c_clusterSize, references_, atoms_);
+    }
+
+    //! Returns whether atom \p a is a filler particle
+    bool isFiller(int a) const { return xq_[4 * a] == c_compactXqFarAway; }
+
+    //! Returns the decoded coordinates of atom \p a
+    gmx::RVec decode(int a) const { return unpackCompactXq(references_[a / c_clusterSize], atoms_[a]); }
+
+    std::vector<real>                      xq_;
+    std::vector<int>                       types_;
+    std::vector<CompactXqClusterReference> references_;
+    std::vector<CompactXqAtom>             atoms_;
+};
+
+TEST_F(CompactXqTest, CoordinateErrorIsWithinHalfAUnit)
+{
+    for (size_t a = 0; a < atoms_.size(); a++)
+    {
+        if (isFiller(a))
+        {
+            continue;
+        }
+        const CompactXqClusterReference& ref = references_[a / c_clusterSize];
+        const gmx::RVec                  x   = decode(a);
+        for (int d = 0; d < DIM; d++)
+        {
+            /* Half a fixed-point unit plus float rounding of the reference */
+            const float tolerance = 0.5F * ref.scale + 4 * GMX_FLOAT_EPS * std::abs(xq_[4 * a + d]);
+            EXPECT_NEAR(xq_[4 * a + d], x[d], tolerance) << "atom " << a << " dim " << d;
+        }
+    }
+}
+
+TEST_F(CompactXqTest, PairDistanceErrorIsSmall)
+{
+    for (size_t a = 0; a < atoms_.size(); a++)
+    {
+        for (size_t b = a + 1; b < atoms_.size(); b++)
+        {
+            if (isFiller(a) || isFiller(b))
+            {
+                continue;
+            }
+            const gmx::RVec xa(xq_[4 * a], xq_[4 * a + 1], xq_[4 * a + 2]);
+            const gmx::RVec xb(xq_[4 * b], xq_[4 * b + 1], xq_[4 * b + 2]);
+            const float     scaleA = references_[a / c_clusterSize].scale;
+            const float     scaleB = references_[b / c_clusterSize].scale;
+
+            const float tolerance = std::sqrt(3.0F) * 0.5F * (scaleA + scaleB) + 1e-5F;
+            EXPECT_NEAR(norm(xa - xb), norm(decode(a) - decode(b)), tolerance)
+                    << "atoms " << a << " " << b;
+        }
+    }
+}
+
+TEST_F(CompactXqTest, FillersAreFarAway)
+{
+    for (size_t a = 0; a < atoms_.size(); a++)
+    {
+        if (isFiller(a))
+        {
+            EXPECT_EQ(c_compactXqFillerOffset, atoms_[a].x);
+            EXPECT_EQ(c_compactXqFarAway, decode(a)[XX]);
+        }
+        else
+        {
+            EXPECT_NE(c_compactXqFillerOffset, atoms_[a].x);
+        }
+    }
+}
+
+TEST_F(CompactXqTest, TypesArePreserved)
+{
+    for (size_t a = 0; a < atoms_.size(); a++)
+    {
+        EXPECT_EQ(types_[a], atoms_[a].type);
+    }
+}
+
+TEST(CompactXqSingleAtomTest, ClusterWithOneAtomIsExact)
+{
+    std::vector<real> xq(4 * c_clusterSize, c_compactXqFarAway);
+    xq[0] = 1.25F;
+    xq[1] = -3.5F;
+    xq[2] = 0.75F;
+    xq[3] = 1.0F;
+    std::vector<CompactXqClusterReference> references(1);
+    std::vector<CompactXqAtom>             atoms(c_clusterSize);
+    packCompactXq(xq, {}, c_clusterSize, references, atoms);
+
+    const gmx::RVec x = unpackCompactXq(references[0], atoms[0]);
+    EXPECT_EQ(xq[0], x[XX]);
+    EXPECT_EQ(xq[1], x[YY]);
+    EXPECT_EQ(xq[2], x[ZZ]);
+    EXPECT_EQ(0, atoms[0].type);
+}
+
+} // namespace
+} // namespace test
+} // namespace Nbnxm
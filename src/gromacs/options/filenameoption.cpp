@@ -84,7 +84,7 @@ const FileTypeMapping c_fileTypeMapping[] = { { eftTopology, efTPS },   { eftRun
                                               { eftTrajectory, efTRX }, { eftEnergy, efEDR },
                                               { eftPDB, efPDB },        { eftIndex, efNDX },
                                               { eftPlot, efXVG },       { eftGenericData, efDAT },
-                                              { eftCsv, efCSV } };
+                                              { eftCsv, efCSV },        { eftJson, efJSON } };
 
 /********************************************************************
  * FileTypeHandler
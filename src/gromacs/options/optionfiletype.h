@@ -63,6 +63,7 @@ enum OptionFileType
     eftPlot,
     eftGenericData,
     eftCsv,
+    eftJson,
     eftOptionFileType_NR
 };
 
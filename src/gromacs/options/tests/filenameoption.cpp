@@ -241,4 +241,20 @@ TEST(FileNameOptionTest, HandlesRequiredCsvOptionWithoutValue)
     EXPECT_EQ("testfile.csv", value);
 }
 
+TEST(FileNameOptionTest, HandlesRequiredJsonValueWithoutExtension)
+{
+    gmx::Options options;
+    std::string  value;
+    ASSERT_NO_THROW_GMX(options.addOption(
+            FileNameOption("f").store(&value).required().filetype(gmx::eftJson).outputFile().defaultBasename("testfile")));
+    EXPECT_EQ("testfile.json", value);
+
+    gmx::OptionsAssigner assigner(&options);
+    EXPECT_NO_THROW_GMX(assigner.start());
+    EXPECT_NO_THROW_GMX(assigner.finish());
+    EXPECT_NO_THROW_GMX(options.finish());
+
+    EXPECT_EQ("testfile.json", value);
+}
+
 } // namespace
@@ -48,6 +48,7 @@
 #include "gromacs/topology/idef.h"
 #include "gromacs/topology/ifunc.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/strconvert.h"
 #include "gromacs/utility/stringutil.h"
@@ -301,6 +302,88 @@ static gmx_bool determine_graph_parts(const EdgesGenerator& edgesG, ArrayRef<int
     return haveMultipleParts;
 }
 
+/* Return the first node/atom with colour Col starting at fC.
+ * return -1 if none found.
+ */
+static gmx::index first_colour(const int fC, const egCol Col, const t_graph* g, ArrayRef<const egCol> edgeColor)
+{
+    for (gmx::index i = fC; i < gmx::ssize(g->edges); i++)
+    {
+        if (!g->edges[i].empty() && edgeColor[i] == Col)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/* Determine the order in which mk_mshift() assigns shifts to the nodes.
+ *
+ * The order only depends on the connectivity, so it is determined once
+ * here by colouring the graph. Nodes are made black in order of their
+ * index within each disconnected part. When a black node is processed,
+ * its white neighbours are made grey and get their shift from this node.
+ */
+static void mk_traversal(t_graph* g)
+{
+    const int g0 = g->edgeAtomBegin;
+
+    g->traversalOrder.clear();
+    g->traversalPartStart.clear();
+    g->shiftParent.assign(g->edges.size(), -1);
+    std::fill(g->edgeColor.begin(), g->edgeColor.end(), egcolWhite);
+
+    int nW = g->numConnectedAtoms;
+    int fW = 0;
+    while (nW > 0)
+    {
+        /* Find the first white, this will allways be a larger
+         * number than before, because no nodes are made white
+         * in the loop
+         */
+        if ((fW = first_colour(fW, egcolWhite, g, g->edgeColor)) == -1)
+        {
+            gmx_fatal(FARGS, "No WHITE nodes found while nW=%d\n", nW);
+        }
+        g->traversalPartStart.push_back(g->traversalOrder.size());
+
+        /* Make the first white node grey */
+        g->edgeColor[fW] = egcolGrey;
+        int nG           = 1;
+        nW--;
+
+        int fG = fW;
+        while (nG > 0)
+        {
+            if ((fG = first_colour(fG, egcolGrey, g, g->edgeColor)) == -1)
+            {
+                gmx_fatal(FARGS, "No GREY nodes found while nG=%d\n", nG);
+            }
+
+            /* Make the first grey node black */
+            g->edgeColor[fG] = egcolBlack;
+            g->traversalOrder.push_back(fG);
+            nG--;
+
+            /* Make all the white neighbours of this black node grey */
+            const int node = fG;
+            for (const int aj : g->edges[node])
+            {
+                if (g->edgeColor[aj - g0] == egcolWhite)
+                {
+                    fG                      = std::min(fG, aj - g0);
+                    g->edgeColor[aj - g0]   = egcolGrey;
+                    g->shiftParent[aj - g0] = node;
+                    nG++;
+                    nW--;
+                }
+            }
+        }
+    }
+    g->traversalPartStart.push_back(g->traversalOrder.size());
+}
+
 template<typename T>
 static t_graph mk_graph_ilist(FILE* fplog, const T* ilist, int at_end, gmx_bool bShakeOnly, gmx_bool bSettle)
 {
@@ -386,6 +469,7 @@ static t_graph mk_graph_ilist(FILE* fplog, const T* ilist, int at_end, gmx_bool
 
     graph.edgeColor.resize(graph.edges.size());
     graph.ishift.resize(graph.shiftAtomEnd);
+    mk_traversal(&graph);
 
     if (gmx_debug_at)
     {
@@ -561,15 +645,12 @@ static void mk_1shift_screw(const matrix box, const rvec hbox, const rvec xi, co
     }
 }
 
-static int mk_grey(ArrayRef<egCol> edgeColor,
-                   t_graph*        g,
-                   int*            AtomI,
-                   int             npbcdim,
-                   const matrix    box,
-                   const rvec      x[],
-                   int*            nerror)
+/* Assign shifts to the nodes of disconnected part \p part of the graph,
+ * returns the number of inconsistent shifts found.
+ */
+static int mk_part_shifts(t_graph* g, int part, int npbcdim, const matrix box, const rvec x[])
 {
-    int      m, ng, ai, g0;
+    int      m;
     rvec     dx, hbox;
     gmx_bool bTriclinic;
     ivec     is_aj;
@@ -581,73 +662,55 @@ static int mk_grey(ArrayRef<egCol> edgeColor,
     }
     bTriclinic = TRICLINIC(box);
 
-    g0 = g->edgeAtomBegin;
-    ng = 0;
-    ai = g0 + *AtomI;
+    const int g0     = g->edgeAtomBegin;
+    int       nerror = 0;
 
-    /* Loop over all the bonds */
-    for (const int aj : g->edges[ai - g0])
+    for (int k = g->traversalPartStart[part]; k < g->traversalPartStart[part + 1]; k++)
     {
-        /* If there is a white one, make it grey and set pbc */
-        if (g->useScrewPbc)
-        {
-            mk_1shift_screw(box, hbox, x[ai], x[aj], g->ishift[ai], is_aj);
-        }
-        else if (bTriclinic)
-        {
-            mk_1shift_tric(npbcdim, box, hbox, x[ai], x[aj], g->ishift[ai], is_aj);
-        }
-        else
-        {
-            mk_1shift(npbcdim, hbox, x[ai], x[aj], g->ishift[ai], is_aj);
-        }
+        const int node = g->traversalOrder[k];
+        const int ai   = g0 + node;
 
-        if (edgeColor[aj - g0] == egcolWhite)
+        /* Loop over all the bonds */
+        for (const int aj : g->edges[node])
         {
-            if (aj - g0 < *AtomI)
+            if (g->useScrewPbc)
             {
-                *AtomI = aj - g0;
+                mk_1shift_screw(box, hbox, x[ai], x[aj], g->ishift[ai], is_aj);
             }
-            edgeColor[aj - g0] = egcolGrey;
-
-            copy_ivec(is_aj, g->ishift[aj]);
-
-            ng++;
-        }
-        else if ((is_aj[XX] != g->ishift[aj][XX]) || (is_aj[YY] != g->ishift[aj][YY])
-                 || (is_aj[ZZ] != g->ishift[aj][ZZ]))
-        {
-            if (gmx_debug_at)
+            else if (bTriclinic)
             {
-                set_pbc(&pbc, PbcType::Unset, box);
-                pbc_dx(&pbc, x[ai], x[aj], dx);
-                fprintf(debug,
-                        "mk_grey: shifts for atom %d due to atom %d\n"
-                        "are (%d,%d,%d), should be (%d,%d,%d)\n"
-                        "dx = (%g,%g,%g)\n",
-                        aj + 1, ai + 1, is_aj[XX], is_aj[YY], is_aj[ZZ], g->ishift[aj][XX],
-                        g->ishift[aj][YY], g->ishift[aj][ZZ], dx[XX], dx[YY], dx[ZZ]);
+                mk_1shift_tric(npbcdim, box, hbox, x[ai], x[aj], g->ishift[ai], is_aj);
+            }
+            else
+            {
+                mk_1shift(npbcdim, hbox, x[ai], x[aj], g->ishift[ai], is_aj);
             }
-            (*nerror)++;
-        }
-    }
-    return ng;
-}
 
-/* Return the first node/atom with colour Col starting at fC.
- * return -1 if none found.
- */
-static gmx::index first_colour(const int fC, const egCol Col, const t_graph* g, ArrayRef<const egCol> edgeColor)
-{
-    for (gmx::index i = fC; i < gmx::ssize(g->edges); i++)
-    {
-        if (!g->edges[i].empty() && edgeColor[i] == Col)
-        {
-            return i;
+            if (g->shiftParent[aj - g0] == node)
+            {
+                /* This node determines the shift of aj */
+                copy_ivec(is_aj, g->ishift[aj]);
+            }
+            else if ((is_aj[XX] != g->ishift[aj][XX]) || (is_aj[YY] != g->ishift[aj][YY])
+                     || (is_aj[ZZ] != g->ishift[aj][ZZ]))
+            {
+                if (gmx_debug_at)
+                {
+                    set_pbc(&pbc, PbcType::Unset, box);
+                    pbc_dx(&pbc, x[ai], x[aj], dx);
+                    fprintf(debug,
+                            "mk_mshift: shifts for atom %d due to atom %d\n"
+                            "are (%d,%d,%d), should be (%d,%d,%d)\n"
+                            "dx = (%g,%g,%g)\n",
+                            aj + 1, ai + 1, is_aj[XX], is_aj[YY], is_aj[ZZ], g->ishift[aj][XX],
+                            g->ishift[aj][YY], g->ishift[aj][ZZ], dx[XX], dx[YY], dx[ZZ]);
+                }
+                nerror++;
+            }
         }
     }
 
-    return -1;
+    return nerror;
 }
 
 /* Returns the maximum length of the graph edges for coordinates x */
@@ -672,13 +735,16 @@ static real maxEdgeLength(const t_graph& g, PbcType pbcType, const matrix box, c
     return std::sqrt(maxEdgeLength2);
 }
 
-void mk_mshift(FILE* log, t_graph* g, PbcType pbcType, const matrix box, const rvec x[])
+void mk_mshift(FILE*        log,
+               t_graph*     g,
+               PbcType      pbcType,
+               const matrix box,
+               const rvec   x[],
+               int          numThreads)
 {
     static int nerror_tot = 0;
     int        npbcdim;
-    int        ng, i;
-    int        nW, nG, nB; /* Number of Grey, Black, White	*/
-    int        fW, fG;     /* First of each category	*/
+    int        i;
     int        nerror = 0;
 
     g->useScrewPbc = (pbcType == PbcType::Screw);
@@ -707,61 +773,17 @@ void mk_mshift(FILE* log, t_graph* g, PbcType pbcType, const matrix box, const r
         return;
     }
 
-    std::fill(g->edgeColor.begin(), g->edgeColor.end(), egcolWhite);
-
-    nW = g->numConnectedAtoms;
-    nG = 0;
-    nB = 0;
-
-    fW = 0;
-
-    /* We even have a loop invariant:
-     * nW+nG+nB == g->nbound
-     */
-#ifdef DEBUG2
-    fprintf(log, "Starting W loop\n");
-#endif
-    while (nW > 0)
+    /* The disconnected parts only access the shifts of their own nodes */
+    const int numParts = gmx::ssize(g->traversalPartStart) - 1;
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic, 16) reduction(+ : nerror) \
+        if (numThreads > 1)
+    for (int part = 0; part < numParts; part++)
     {
-        /* Find the first white, this will allways be a larger
-         * number than before, because no nodes are made white
-         * in the loop
-         */
-        if ((fW = first_colour(fW, egcolWhite, g, g->edgeColor)) == -1)
-        {
-            gmx_fatal(FARGS, "No WHITE nodes found while nW=%d\n", nW);
-        }
-
-        /* Make the first white node grey */
-        g->edgeColor[fW] = egcolGrey;
-        nG++;
-        nW--;
-
-        /* Initial value for the first grey */
-        fG = fW;
-#ifdef DEBUG2
-        fprintf(log, "Starting G loop (nW=%d, nG=%d, nB=%d, total %d)\n", nW, nG, nB, nW + nG + nB);
-#endif
-        while (nG > 0)
+        try
         {
-            if ((fG = first_colour(fG, egcolGrey, g, g->edgeColor)) == -1)
-            {
-                gmx_fatal(FARGS, "No GREY nodes found while nG=%d\n", nG);
-            }
-
-            /* Make the first grey node black */
-            g->edgeColor[fG] = egcolBlack;
-            nB++;
-            nG--;
-
-            /* Make all the neighbours of this black node grey
-             * and set their periodicity
-             */
-            ng = mk_grey(g->edgeColor, g, &fG, npbcdim, box, x, &nerror);
-            /* ng is the number of white nodes made grey */
-            nG += ng;
-            nW -= ng;
+            nerror += mk_part_shifts(g, part, npbcdim, box, x);
         }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
     if (nerror > 0)
     {
@@ -837,27 +859,26 @@ void mk_mshift(FILE* log, t_graph* g, PbcType pbcType, const matrix box, const r
  *
  ************************************************************/
 
-void shift_x(const t_graph* g, const matrix box, const rvec x[], rvec x_s[])
+void shift_x(const t_graph* g, const matrix box, const rvec x[], rvec x_s[], int numThreads)
 {
-    int j, tx, ty, tz;
-
     GCHECK(g);
     const int            g0 = g->edgeAtomBegin;
     const int            g1 = g->edgeAtomEnd;
     ArrayRef<const IVec> is = g->ishift;
 
-    for (j = 0; j < g0; j++)
+    for (int j = 0; j < g0; j++)
     {
         copy_rvec(x[j], x_s[j]);
     }
 
     if (g->useScrewPbc)
     {
-        for (j = g0; (j < g1); j++)
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+        for (int j = g0; j < g1; j++)
         {
-            tx = is[j][XX];
-            ty = is[j][YY];
-            tz = is[j][ZZ];
+            const int tx = is[j][XX];
+            const int ty = is[j][YY];
+            const int tz = is[j][ZZ];
 
             if ((tx > 0 && tx % 2 == 1) || (tx < 0 && -tx % 2 == 1))
             {
@@ -875,11 +896,12 @@ void shift_x(const t_graph* g, const matrix box, const rvec x[], rvec x_s[])
     }
     else if (TRICLINIC(box))
     {
-        for (j = g0; (j < g1); j++)
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+        for (int j = g0; j < g1; j++)
         {
-            tx = is[j][XX];
-            ty = is[j][YY];
-            tz = is[j][ZZ];
+            const int tx = is[j][XX];
+            const int ty = is[j][YY];
+            const int tz = is[j][ZZ];
 
             x_s[j][XX] = x[j][XX] + tx * box[XX][XX] + ty * box[YY][XX] + tz * box[ZZ][XX];
             x_s[j][YY] = x[j][YY] + ty * box[YY][YY] + tz * box[ZZ][YY];
@@ -888,11 +910,12 @@ void shift_x(const t_graph* g, const matrix box, const rvec x[], rvec x_s[])
     }
     else
     {
-        for (j = g0; (j < g1); j++)
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+        for (int j = g0; j < g1; j++)
         {
-            tx = is[j][XX];
-            ty = is[j][YY];
-            tz = is[j][ZZ];
+            const int tx = is[j][XX];
+            const int ty = is[j][YY];
+            const int tz = is[j][ZZ];
 
             x_s[j][XX] = x[j][XX] + tx * box[XX][XX];
             x_s[j][YY] = x[j][YY] + ty * box[YY][YY];
@@ -900,16 +923,14 @@ void shift_x(const t_graph* g, const matrix box, const rvec x[], rvec x_s[])
         }
     }
 
-    for (j = g1; j < g->shiftAtomEnd; j++)
+    for (int j = g1; j < g->shiftAtomEnd; j++)
     {
         copy_rvec(x[j], x_s[j]);
     }
 }
 
-void shift_self(const t_graph& g, const matrix box, rvec x[])
+void shift_self(const t_graph& g, const matrix box, rvec x[], int numThreads)
 {
-    int j, tx, ty, tz;
-
     GMX_RELEASE_ASSERT(!g.useScrewPbc, "screw pbc not implemented for shift_self");
 
     const int            g0 = g.edgeAtomBegin;
@@ -921,11 +942,12 @@ void shift_self(const t_graph& g, const matrix box, rvec x[])
 #endif
     if (TRICLINIC(box))
     {
-        for (j = g0; (j < g1); j++)
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+        for (int j = g0; j < g1; j++)
         {
-            tx = is[j][XX];
-            ty = is[j][YY];
-            tz = is[j][ZZ];
+            const int tx = is[j][XX];
+            const int ty = is[j][YY];
+            const int tz = is[j][ZZ];
 
             x[j][XX] = x[j][XX] + tx * box[XX][XX] + ty * box[YY][XX] + tz * box[ZZ][XX];
             x[j][YY] = x[j][YY] + ty * box[YY][YY] + tz * box[ZZ][YY];
@@ -934,11 +956,12 @@ void shift_self(const t_graph& g, const matrix box, rvec x[])
     }
     else
     {
-        for (j = g0; (j < g1); j++)
+#pragma omp parallel for num_threads(numThreads) schedule(static) if (numThreads > 1)
+        for (int j = g0; j < g1; j++)
         {
-            tx = is[j][XX];
-            ty = is[j][YY];
-            tz = is[j][ZZ];
+            const int tx = is[j][XX];
+            const int ty = is[j][YY];
+            const int tz = is[j][ZZ];
 
             x[j][XX] = x[j][XX] + tx * box[XX][XX];
             x[j][YY] = x[j][YY] + ty * box[YY][YY];
@@ -947,9 +970,9 @@ void shift_self(const t_graph& g, const matrix box, rvec x[])
     }
 }
 
-void shift_self(const t_graph* g, const matrix box, rvec x[])
+void shift_self(const t_graph* g, const matrix box, rvec x[], int numThreads)
 {
-    shift_self(*g, box, x);
+    shift_self(*g, box, x, numThreads);
 }
 
 void unshift_x(const t_graph* g, const matrix box, rvec x[], const rvec x_s[])
@@ -95,6 +95,12 @@ struct t_graph
     std::vector<gmx::IVec> ishift;
     // Work buffer for coloring nodes
     std::vector<egCol> edgeColor;
+    // The connected nodes, in the order in which their neighbors are assigned shifts
+    std::vector<int> traversalOrder;
+    // The start of each disconnected part in traversalOrder, plus the end of the last part
+    std::vector<int> traversalPartStart;
+    // For each node, the node from which its shift is determined, -1 for the first node of a part
+    std::vector<int> shiftParent;
     // Tells how connected this graph is
     BondedParts parts = BondedParts::Single;
 };
@@ -139,16 +145,23 @@ void done_graph(t_graph* g);
 void p_graph(FILE* log, const char* title, const t_graph* g);
 /* Print a graph to log */
 
-void mk_mshift(FILE* log, t_graph* g, PbcType pbcType, const matrix box, const rvec x[]);
-/* Calculate the mshift codes, based on the connection graph in g. */
+void mk_mshift(FILE*        log,
+               t_graph*     g,
+               PbcType      pbcType,
+               const matrix box,
+               const rvec   x[],
+               int          numThreads = 1);
+/* Calculate the mshift codes, based on the connection graph in g.
+ * With numThreads > 1 the disconnected parts are processed by OpenMP threads.
+ */
 
-void shift_x(const t_graph* g, const matrix box, const rvec x[], rvec x_s[]);
+void shift_x(const t_graph* g, const matrix box, const rvec x[], rvec x_s[], int numThreads = 1);
 /* Add the shift vector to x, and store in x_s (may be same array as x) */
 
-void shift_self(const t_graph& g, const matrix box, rvec x[]);
+void shift_self(const t_graph& g, const matrix box, rvec x[], int numThreads = 1);
 /* Id. but in place */
 
-void shift_self(const t_graph* g, const matrix box, rvec x[]);
+void shift_self(const t_graph* g, const matrix box, rvec x[], int numThreads = 1);
 /* Id. but in place */
 
 void unshift_x(const t_graph* g, const matrix box, rvec x[], const rvec x_s[]);
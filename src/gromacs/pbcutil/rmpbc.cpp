@@ -52,6 +52,7 @@
 #include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 typedef struct
@@ -203,8 +204,9 @@ void gmx_rmpbc(gmx_rmpbc_t gpbc, int natoms, const matrix box, rvec x[])
     gr      = gmx_rmpbc_get_graph(gpbc, pbcType, natoms);
     if (gr != nullptr)
     {
-        mk_mshift(stdout, gr, pbcType, box, x);
-        shift_self(gr, box, x);
+        const int numThreads = gmx_omp_get_max_threads();
+        mk_mshift(stdout, gr, pbcType, box, x, numThreads);
+        shift_self(gr, box, x, numThreads);
     }
 }
 
@@ -218,8 +220,9 @@ void gmx_rmpbc_copy(gmx_rmpbc_t gpbc, int natoms, const matrix box, rvec x[], rv
     gr      = gmx_rmpbc_get_graph(gpbc, pbcType, natoms);
     if (gr != nullptr)
     {
-        mk_mshift(stdout, gr, pbcType, box, x);
-        shift_x(gr, box, x, x_s);
+        const int numThreads = gmx_omp_get_max_threads();
+        mk_mshift(stdout, gr, pbcType, box, x, numThreads);
+        shift_x(gr, box, x, x_s, numThreads);
     }
     else
     {
@@ -241,8 +244,9 @@ void gmx_rmpbc_trxfr(gmx_rmpbc_t gpbc, t_trxframe* fr)
         gr      = gmx_rmpbc_get_graph(gpbc, pbcType, fr->natoms);
         if (gr != nullptr)
         {
-            mk_mshift(stdout, gr, pbcType, fr->box, fr->x);
-            shift_self(gr, fr->box, fr->x);
+            const int numThreads = gmx_omp_get_max_threads();
+            mk_mshift(stdout, gr, pbcType, fr->box, fr->x, numThreads);
+            shift_self(gr, fr->box, fr->x, numThreads);
         }
     }
 }
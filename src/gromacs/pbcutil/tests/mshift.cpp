@@ -153,6 +153,31 @@ TEST(MShift, shiftsAndUnshiftsSelf)
     EXPECT_THAT(coordinates(), Pointwise(RVecEq(defaultFloatTolerance()), x));
 }
 
+//! Tests that shifting works with multiple threads for multiple disconnected parts
+TEST(MShift, shiftsMultiplePartsWithThreads)
+{
+    /* Two copies of moleculeType() */
+    gmx_moltype_t molType          = moleculeType();
+    molType.atoms.nr               = 10;
+    molType.ilist[F_CONSTR].iatoms = { 0, 1, 2, 0, 6, 7 };
+    molType.ilist[F_ANGLES].iatoms = { 1, 2, 1, 3, 1, 7, 6, 8 };
+
+    std::vector<RVec> x           = coordinates();
+    std::vector<RVec> xWhole      = coordinatesWhole();
+    const int         numAtomsOne = x.size();
+    for (int i = 0; i < numAtomsOne; i++)
+    {
+        x.push_back(x[i]);
+        xWhole.push_back(xWhole[i]);
+    }
+
+    t_graph graph = mk_graph_moltype(molType);
+    mk_mshift(nullptr, &graph, PbcType::Xyz, c_box, as_rvec_array(x.data()), 2);
+
+    shift_self(&graph, c_box, as_rvec_array(x.data()), 2);
+    EXPECT_THAT(xWhole, Pointwise(RVecEq(defaultFloatTolerance()), x));
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
@@ -309,6 +309,22 @@ public:
         return param.mean() + value * param.stddev();
     }
 
+    /*! \brief Return normal distribution value from the lowest bits of \p randomBits
+     *
+     * Uses the lowest tableBits of \p *randomBits, which are then shifted out,
+     * so repeated calls give the same values as calls with an engine that
+     * returned \p *randomBits right after reset(). This is useful when the
+     * random bits for many atoms are generated at once.
+     *
+     * \param[in,out] randomBits  Random bits to use, the used bits are shifted out
+     */
+    result_type fromRandomBits(uint64_t* randomBits) const
+    {
+        result_type value = c_table_[*randomBits & ((1ULL << tableBits) - 1)];
+        *randomBits >>= tableBits;
+        return param_.mean() + value * param_.stddev();
+    }
+
     /*!\brief Check if two tabulated normal distributions have identical states.
      *
      * \param  x     Instance to compare with.
@@ -138,6 +138,21 @@ TEST(TabulatedNormalDistributionTest, Reset)
     EXPECT_REAL_EQ_TOL(valA, valB, gmx::test::ulpTolerance(0));
 }
 
+TEST(TabulatedNormalDistributionTest, FromRandomBitsMatchesEngine)
+{
+    gmx::ThreeFry2x64<2>               rngA(123456, gmx::RandomDomain::Other);
+    gmx::ThreeFry2x64<2>               rngB(123456, gmx::RandomDomain::Other);
+    gmx::TabulatedNormalDistribution<> distA(2.0, 5.0);
+    gmx::TabulatedNormalDistribution<> distB(2.0, 5.0);
+
+    uint64_t randomBits = rngB();
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_REAL_EQ_TOL(
+                distA(rngA), distB.fromRandomBits(&randomBits), gmx::test::ulpTolerance(0));
+    }
+}
+
 TEST(TabulatedNormalDistributionTest, AltParam)
 {
     gmx::ThreeFry2x64<2>                           rngA(123456, gmx::RandomDomain::Other);
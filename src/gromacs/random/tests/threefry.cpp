@@ -42,6 +42,8 @@
 
 #include "gromacs/random/threefry.h"
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "gromacs/utility/exceptions.h"
@@ -217,6 +219,23 @@ TEST_F(ThreeFry2x64Test, Discard)
 }
 
 
+TEST_F(ThreeFry2x64Test, FirstForCountersMatchesRestart)
+{
+    gmx::ThreeFry2x64<0> rngA(123456, gmx::RandomDomain::UpdateCoordinates);
+    gmx::ThreeFry2x64<0> rngB(123456, gmx::RandomDomain::UpdateCoordinates);
+
+    const uint64_t        step     = 987654321;
+    std::vector<uint64_t> counters = { 0, 1, 2, 7, 12345, 0xFFFFFFFFFFFFFFFF };
+    std::vector<uint64_t> result(counters.size());
+
+    rngA.firstForCounters(step, counters, result);
+    for (size_t i = 0; i < counters.size(); i++)
+    {
+        rngB.restart(step, counters[i]);
+        EXPECT_EQ(rngB(), result[i]);
+    }
+}
+
 TEST_F(ThreeFry2x64Test, InvalidCounter)
 {
     gmx::ThreeFry2x64<10> rngA(123456, gmx::RandomDomain::Other);
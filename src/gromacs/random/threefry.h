@@ -49,8 +49,10 @@
 
 #include "gromacs/math/functions.h"
 #include "gromacs/random/seed.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
 
 /*
  * The GROMACS implementation of the ThreeFry random engine has been
@@ -347,7 +349,7 @@ private:
      *
      *  \return Input value rotated 'bits' left.
      */
-    result_type rotLeft(result_type i, unsigned int bits)
+    static result_type rotLeft(result_type i, unsigned int bits)
     {
         return (i << bits) | (i >> (std::numeric_limits<result_type>::digits - bits));
     }
@@ -364,7 +366,7 @@ private:
      *
      *  \return Newly encrypted 2x64 block, according to the class template parameters.
      */
-    counter_type generateBlock(const counter_type& key, const counter_type& ctr)
+    static counter_type generateBlock(const counter_type& key, const counter_type& ctr)
     {
         const unsigned int rotations[] = { 16, 42, 12, 31, 16, 32, 24, 21 };
         counter_type       x           = ctr;
@@ -666,6 +668,36 @@ public:
         index_ = 0;
     }
 
+    /*! \brief Generate the first random number after restarting at each of a batch of counters
+     *
+     *  \param ctr0    First word of all counters
+     *  \param ctr1    Second words of the counters
+     *  \param result  The first random number for each counter, same size as \p ctr1
+     *
+     * This gives the same values as calling restart(ctr0, ctr1[i]) followed by
+     * operator()() for each i, but leaves the engine state unchanged. Since
+     * the blocks for different counters are independent, the compiler can
+     * vectorize the encryption rounds over the batch, which is much faster
+     * than restarting the engine for each counter, e.g. for each atom.
+     *
+     * Only available without internal counter bits, as the counters then
+     * do not need to be checked.
+     */
+    void firstForCounters(uint64_t                 ctr0,
+                          ArrayRef<const uint64_t> ctr1,
+                          ArrayRef<uint64_t>       result) const
+    {
+        static_assert(internalCounterBits == 0,
+                      "Batched counters are only supported without internal counter bits");
+        GMX_ASSERT(ctr1.size() == result.size(), "Need one result per counter");
+
+        const counter_type key = key_;
+        for (size_t i = 0; i < ctr1.size(); i++)
+        {
+            result[i] = generateBlock(key, { { ctr0, ctr1[i] } })[0];
+        }
+    }
+
     /*! \brief Generate the next random number
      *
      *  This will return the next stored 64-bit value if one is available,
@@ -0,0 +1,93 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ *
+ * \brief ThreeFry2x64 random block function for use in CUDA kernels.
+ *
+ * This is the raw 20-round ThreeFry2x64 function, i.e. it returns the same
+ * two 64-bit values as a gmx::ThreeFry2x64<0> engine that is seeded with
+ * the same key and restarted with the same counter. This allows GPU kernels
+ * to draw exactly the same random numbers as the CPU code.
+ *
+ * \inlibraryapi
+ * \ingroup module_random
+ */
+#ifndef GMX_RANDOM_THREEFRY_CUDA_CUH
+#define GMX_RANDOM_THREEFRY_CUDA_CUH
+
+#include <cstdint>
+
+namespace gmx
+{
+
+/*! \brief Returns the 20-round ThreeFry2x64 encryption of \p counter with \p key
+ *
+ * \param[in] key      The key, i.e. the random seed and the random domain.
+ * \param[in] counter  The counter, e.g. the step and the global atom index.
+ */
+static __forceinline__ __device__ ulonglong2 threeFry2x64(const ulonglong2 key,
+                                                          const ulonglong2 counter)
+{
+    constexpr int c_numRounds = 20;
+
+    const uint64_t keySchedule[3] = { key.x, key.y, 0x1bd11bdaa9fc1a22 ^ key.x ^ key.y };
+
+    uint64_t x0 = counter.x + keySchedule[0];
+    uint64_t x1 = counter.y + keySchedule[1];
+
+#pragma unroll
+    for (int round = 0; round < c_numRounds; round++)
+    {
+        constexpr unsigned int c_rotations[8] = { 16, 42, 12, 31, 16, 32, 24, 21 };
+
+        const unsigned int rotation = c_rotations[round % 8];
+
+        x0 += x1;
+        x1 = (x1 << rotation) | (x1 >> (64 - rotation));
+        x1 ^= x0;
+        if ((round + 1) % 4 == 0)
+        {
+            const int injection = (round + 1) / 4;
+            x0 += keySchedule[injection % 3];
+            x1 += keySchedule[(injection + 1) % 3] + injection;
+        }
+    }
+
+    return make_ulonglong2(x0, x1);
+}
+
+} // namespace gmx
+
+#endif
@@ -38,6 +38,7 @@
 #include "restraintmdmodule.h"
 
 #include <memory>
+#include <vector>
 
 #include "gromacs/mdtypes/forceoutput.h"
 #include "gromacs/mdtypes/iforceprovider.h"
@@ -63,6 +64,44 @@ RestraintForceProvider::RestraintForceProvider(std::shared_ptr<IRestraintPotenti
     }
 }
 
+/*! \brief Returns the positions of all \p sites
+ *
+ * With domain decomposition the positions of all sites are obtained
+ * with a single reduction, instead of one reduction per site.
+ */
+static std::vector<RVec> sitePositions(ArrayRef<const Site> sites,
+                                       const t_commrec&     cr,
+                                       size_t               nx,
+                                       ArrayRef<const RVec> x)
+{
+    std::vector<RVec> positions;
+    positions.reserve(sites.size());
+    for (const Site& site : sites)
+    {
+        positions.push_back(site.localContribution(cr, nx, x));
+    }
+    if (DOMAINDECOMP(&cr))
+    {
+        std::vector<double> buffer(DIM * positions.size());
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            for (int d = 0; d < DIM; ++d)
+            {
+                buffer[DIM * i + d] = positions[i][d];
+            }
+        }
+        gmx_sumd(buffer.size(), buffer.data(), &cr);
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            for (int d = 0; d < DIM; ++d)
+            {
+                positions[i][d] = static_cast<real>(buffer[DIM * i + d]);
+            }
+        }
+    }
+    return positions;
+}
+
 void RestraintForceProvider::calculateForces(const ForceProviderInput& forceProviderInput,
                                              ForceProviderOutput*      forceProviderOutput)
 {
@@ -80,7 +119,9 @@ void RestraintForceProvider::calculateForces(const ForceProviderInput& forceProv
     const auto& cr = forceProviderInput.cr_;
     const auto& t  = forceProviderInput.t_;
     // Cooperatively get Cartesian coordinates for center of mass of each site
-    RVec r1 = sites_[0].centerOfMass(cr, static_cast<size_t>(mdatoms.homenr), x, t);
+    const std::vector<RVec> siteX =
+            sitePositions(sites_, cr, static_cast<size_t>(mdatoms.homenr), x);
+    RVec r1 = siteX[0];
     // r2 is to be constructed as
     // r2 = (site[N] - site[N-1]) + (site_{N-1} - site_{N-2}) + ... + (site_2 - site_1) + site_1
     // where the minimum image convention is applied to each path but not to the overall sum.
@@ -96,10 +137,8 @@ void RestraintForceProvider::calculateForces(const ForceProviderInput& forceProv
     // a big molecule in a small box.
     for (size_t i = 0; i < sites_.size() - 1; ++i)
     {
-        RVec a = sites_[i].centerOfMass(cr, static_cast<size_t>(mdatoms.homenr), x, t);
-        RVec b = sites_[i + 1].centerOfMass(cr, static_cast<size_t>(mdatoms.homenr), x, t);
         // dr = minimum_image_vector(b - a)
-        pbc_dx(&pbc, b, a, dr);
+        pbc_dx(&pbc, siteX[i + 1], siteX[i], dr);
         r2[0] += dr[0];
         r2[1] += dr[1];
         r2[2] += dr[2];
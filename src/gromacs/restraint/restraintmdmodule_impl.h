@@ -131,6 +131,44 @@ public:
     {
         // Center of mass to return for the site. Currently the only form of site
         // implemented is as a global atomic coordinate.
+        gmx::RVec r = localContribution(cr, nx, x);
+        if (DOMAINDECOMP(&cr)) // Domain decomposition
+        {
+            // AllReduce across the ranks of the simulation to get the center-of-mass
+            // of the site locally available everywhere. For single-atom sites, this
+            // is trivial: exactly one rank should have a non-zero position.
+            // For future multi-atom selections,
+            // we will receive weighted center-of-mass contributions from
+            // each rank and combine to get the global center of mass.
+            // \todo use generalized "pull group" facility when available.
+            std::array<double, 3> buffer{ { r[0], r[1], r[2] } };
+            // This should be an all-reduce sum, which gmx_sumd appears to be.
+            gmx_sumd(3, buffer.data(), &cr);
+            r[0] = static_cast<real>(buffer[0]);
+            r[1] = static_cast<real>(buffer[1]);
+            r[2] = static_cast<real>(buffer[2]);
+
+        } // end domain decomposition branch
+        // Update cache and cache status.
+        copy_rvec(r, r_);
+
+        return r_;
+    }
+
+    /*!
+     * \brief Get the contribution of this rank to the position of this site.
+     *
+     * Without domain decomposition this is the position of the site. With domain
+     * decomposition, the contributions of all ranks need to be summed to get the
+     * position, which allows callers to reduce the data of several sites at once.
+     *
+     * \param cr Communications record.
+     * \param nx Number of locally available atoms (size of local atom data arrays)
+     * \param x Array of locally available atom coordinates.
+     * \return this rank's contribution to the position vector.
+     */
+    RVec localContribution(const t_commrec& cr, size_t nx, ArrayRef<const RVec> x) const
+    {
         gmx::RVec r = { 0, 0, 0 };
         if (DOMAINDECOMP(&cr)) // Domain decomposition
         {
@@ -152,31 +190,14 @@ public:
             {
                 // Nothing to contribute on this rank. Leave position == [0,0,0].
             }
-            // AllReduce across the ranks of the simulation to get the center-of-mass
-            // of the site locally available everywhere. For single-atom sites, this
-            // is trivial: exactly one rank should have a non-zero position.
-            // For future multi-atom selections,
-            // we will receive weighted center-of-mass contributions from
-            // each rank and combine to get the global center of mass.
-            // \todo use generalized "pull group" facility when available.
-            std::array<double, 3> buffer{ { r[0], r[1], r[2] } };
-            // This should be an all-reduce sum, which gmx_sumd appears to be.
-            gmx_sumd(3, buffer.data(), &cr);
-            r[0] = static_cast<real>(buffer[0]);
-            r[1] = static_cast<real>(buffer[1]);
-            r[2] = static_cast<real>(buffer[2]);
-
-        } // end domain decomposition branch
+        }
         else
         {
             // No DD so all atoms are local.
             copy_rvec(x[index_], r);
             (void)nx;
         }
-        // Update cache and cache status.
-        copy_rvec(r, r_);
-
-        return r_;
+        return r;
     }
 
 private:
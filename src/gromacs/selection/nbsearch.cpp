@@ -123,7 +123,6 @@ class AnalysisNeighborhoodSearchImpl
 public:
     typedef AnalysisNeighborhoodPairSearch::ImplPointer PairSearchImplPointer;
     typedef std::vector<PairSearchImplPointer>          PairSearchList;
-    typedef std::vector<std::vector<int>>               CellList;
 
     explicit AnalysisNeighborhoodSearchImpl(real cutoff);
     ~AnalysisNeighborhoodSearchImpl();
@@ -205,8 +204,19 @@ private:
      *
      * \p cell should satisfy the conditions that \p mapPointToGridCell()
      * produces.
+     * The index only becomes visible in the cell after finishGridCells()
+     * has been called.
      */
     void addToGridCell(const rvec cell, int i);
+    /*! \brief
+     * Sorts the indices added with addToGridCell() into the cells.
+     *
+     * Cell contents are stored contiguously in order of increasing cell
+     * index, and in order of increasing position index within each cell.
+     * The positions are also copied into the same order, such that the
+     * pair search loop over a cell accesses memory sequentially.
+     */
+    void finishGridCells();
     /*! \brief
      * Initializes a cell pair loop for a dimension.
      *
@@ -317,8 +327,20 @@ private:
     real cellShiftYX_;
     //! Number of cells along each dimension.
     ivec ncelldim_;
-    //! Data structure to hold the grid cell contents.
-    CellList cells_;
+    /*! \brief
+     * Start of each grid cell in \p cellContents_.
+     *
+     * Contains one more element than there are cells, such that the
+     * contents of cell `ci` are in the range
+     * `[cellStart_[ci], cellStart_[ci + 1])`.
+     */
+    std::vector<int> cellStart_;
+    //! Reference position indices of all grid cells, ordered by cell.
+    std::vector<int> cellContents_;
+    //! Reference positions (from \p xrefAlloc_) in the order of \p cellContents_.
+    std::vector<RVec> cellPositions_;
+    //! Grid cell index of each reference position.
+    std::vector<int> refCellIndex_;
 
     Mutex          createPairSearchMutex_;
     PairSearchList pairSearchList_;
@@ -536,17 +558,10 @@ bool AnalysisNeighborhoodSearchImpl::initGridCells(const matrix box, bool bSingl
     {
         return false;
     }
-    // Never decrease the size of the cell vector to avoid reallocating
-    // memory for the nested vectors.  The actual size of the vector is not
-    // used outside this function.
-    if (cells_.size() < static_cast<size_t>(totalCellCount))
-    {
-        cells_.resize(totalCellCount);
-    }
-    for (int ci = 0; ci < totalCellCount; ++ci)
-    {
-        cells_[ci].clear();
-    }
+    // The grid cell contents are kept in flat arrays that are reused between
+    // frames, so that only the first frame (or a frame with more cells or
+    // positions than seen before) needs to allocate memory.
+    cellStart_.assign(totalCellCount + 1, 0);
     return true;
 }
 
@@ -710,8 +725,35 @@ int AnalysisNeighborhoodSearchImpl::getGridCellIndex(const rvec cell) const
 
 void AnalysisNeighborhoodSearchImpl::addToGridCell(const rvec cell, int i)
 {
-    const int ci = getGridCellIndex(cell);
-    cells_[ci].push_back(i);
+    const int ci     = getGridCellIndex(cell);
+    refCellIndex_[i] = ci;
+    ++cellStart_[ci + 1];
+}
+
+void AnalysisNeighborhoodSearchImpl::finishGridCells()
+{
+    // cellStart_[ci + 1] holds the number of positions in cell ci; convert
+    // the counts into start indices, and then fill in the cells in order of
+    // increasing position index.  After the fill, cellStart_[ci] points one
+    // past the end of cell ci, so shift the entries to get the start indices.
+    const int cellCount = ssize(cellStart_) - 1;
+    for (int ci = 0; ci < cellCount; ++ci)
+    {
+        cellStart_[ci + 1] += cellStart_[ci];
+    }
+    cellContents_.resize(nref_);
+    cellPositions_.resize(nref_);
+    for (int i = 0; i < nref_; ++i)
+    {
+        const int cellIndex       = cellStart_[refCellIndex_[i]]++;
+        cellContents_[cellIndex]  = i;
+        cellPositions_[cellIndex] = xrefAlloc_[i];
+    }
+    for (int ci = cellCount - 1; ci > 0; --ci)
+    {
+        cellStart_[ci] = cellStart_[ci - 1];
+    }
+    cellStart_[0] = 0;
 }
 
 void AnalysisNeighborhoodSearchImpl::initCellRange(const rvec centerCell, ivec currCell, ivec upperBound, int dim) const
@@ -914,6 +956,7 @@ void AnalysisNeighborhoodSearchImpl::init(AnalysisNeighborhood::SearchMode     m
     {
         xrefAlloc_.resize(nref_);
         xref_ = as_rvec_array(xrefAlloc_.data());
+        refCellIndex_.resize(nref_);
 
         for (int i = 0; i < nref_; ++i)
         {
@@ -922,6 +965,7 @@ void AnalysisNeighborhoodSearchImpl::init(AnalysisNeighborhood::SearchMode     m
             mapPointToGridCell(positions.x_[ii], refcell, xrefAlloc_[i]);
             addToGridCell(refcell, i);
         }
+        finishGridCells();
     }
     else if (refIndices_ != nullptr)
     {
@@ -1078,23 +1122,25 @@ bool AnalysisNeighborhoodPairSearchImpl::searchNext(Action action)
                 {
                     continue;
                 }
-                const int cellSize = ssize(search_.cells_[ci]);
+                const int   cellStart = search_.cellStart_[ci];
+                const int   cellSize  = search_.cellStart_[ci + 1] - cellStart;
+                const int*  cell      = search_.cellContents_.data() + cellStart;
+                const rvec* cellX     = as_rvec_array(search_.cellPositions_.data()) + cellStart;
                 for (; cai < cellSize; ++cai)
                 {
-                    const int i = search_.cells_[ci][cai];
+                    const int i = cell[cai];
                     if (selfSearchMode_ && ci == testCellIndex_ && i >= testIndex_)
                     {
                         continue;
                     }
-                    if (isExcluded(i))
-                    {
-                        continue;
-                    }
                     rvec dx;
-                    rvec_sub(search_.xref_[i], xtest_, dx);
+                    rvec_sub(cellX[cai], xtest_, dx);
                     rvec_sub(dx, shift, dx);
                     const real r2 = search_.bXY_ ? dx[XX] * dx[XX] + dx[YY] * dx[YY] : norm2(dx);
-                    if (r2 <= search_.cutoff2_)
+                    // Exclusions are only checked for positions within the
+                    // cutoff; isExcluded() can skip over positions that are
+                    // not checked, as long as the indices increase.
+                    if (r2 <= search_.cutoff2_ && !isExcluded(i))
                     {
                         if (action(i, r2, dx))
                         {
@@ -45,6 +45,8 @@
 
 #include "selection.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "gromacs/selection/nbsearch.h"
@@ -52,6 +54,7 @@
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 #include "gromacs/utility/textwriter.h"
 
@@ -126,9 +129,47 @@ SelectionData::SelectionData(SelectionTreeElement* elem, const char* selstr) :
 }
 
 
+SelectionData::SelectionData(const SelectionData* other) :
+    name_(other->name_),
+    selectionText_(other->selectionText_),
+    flags_(other->flags_),
+    rootElement_(other->rootElement_),
+    coveredFractionType_(other->coveredFractionType_),
+    coveredFraction_(other->coveredFraction_),
+    averageCoveredFraction_(other->averageCoveredFraction_),
+    bDynamic_(other->bDynamic_),
+    bDynamicCoveredFraction_(other->bDynamicCoveredFraction_)
+{
+    gmx_ana_pos_t&       dest = rawPositions_;
+    const gmx_ana_pos_t& src  = other->rawPositions_;
+    gmx_ana_pos_reserve(&dest, src.m.b.nr, -1);
+    gmx_ana_pos_copy(&dest, const_cast<gmx_ana_pos_t*>(&src), true);
+    // Dynamic selections may reference atoms in the evaluation tree that
+    // are overwritten when the next frame is evaluated, so always keep our
+    // own copy of the atom indices.
+    if (dest.m.mapb.nalloc_a == 0)
+    {
+        dest.m.mapb.nalloc_a = std::max(std::max(src.m.b.nra, src.m.mapb.nra), 1);
+        snew(dest.m.mapb.a, dest.m.mapb.nalloc_a);
+        std::copy(src.m.mapb.a, src.m.mapb.a + src.m.mapb.nra, dest.m.mapb.a);
+    }
+    posMass_.reserve(src.m.b.nr);
+    posCharge_.reserve(src.m.b.nr);
+    posMass_   = other->posMass_;
+    posCharge_ = other->posCharge_;
+}
+
+
 SelectionData::~SelectionData() {}
 
 
+// static
+std::unique_ptr<SelectionData> SelectionData::createValueCopy(const SelectionData& other)
+{
+    return std::unique_ptr<SelectionData>(new SelectionData(&other));
+}
+
+
 bool SelectionData::initCoveredFraction(e_coverfrac_t type)
 {
     coveredFractionType_ = type;
@@ -190,6 +231,36 @@ void computeMassesAndCharges(const gmx_mtop_t*    top,
 
 } // namespace
 
+void SelectionData::copyEvaluatedValues(const SelectionData& other)
+{
+    gmx_ana_pos_t&       dest = rawPositions_;
+    const gmx_ana_pos_t& src  = other.rawPositions_;
+    GMX_ASSERT(src.count() <= dest.nalloc_x && src.m.mapb.nra <= dest.m.mapb.nalloc_a,
+               "Selection values do not fit in the memory allocated for the copy");
+    const int count = src.count();
+    std::memcpy(dest.x, src.x, count * sizeof(*dest.x));
+    if (dest.v != nullptr)
+    {
+        std::memcpy(dest.v, src.v, count * sizeof(*dest.v));
+    }
+    if (dest.f != nullptr)
+    {
+        std::memcpy(dest.f, src.f, count * sizeof(*dest.f));
+    }
+    dest.m.mapb.nr  = count;
+    dest.m.mapb.nra = src.m.mapb.nra;
+    std::copy(src.m.mapb.a, src.m.mapb.a + src.m.mapb.nra, dest.m.mapb.a);
+    std::copy(src.m.mapb.index, src.m.mapb.index + count + 1, dest.m.mapb.index);
+    std::copy(src.m.refid, src.m.refid + count, dest.m.refid);
+    std::copy(src.m.mapid, src.m.mapid + count, dest.m.mapid);
+    dest.m.bStatic = src.m.bStatic;
+    posMass_.assign(other.posMass_.begin(), other.posMass_.end());
+    posCharge_.assign(other.posCharge_.begin(), other.posCharge_.end());
+    massChargeBlockIndex_.clear();
+    massChargeAtoms_.clear();
+    coveredFraction_ = other.coveredFraction_;
+}
+
 bool SelectionData::hasSortedAtomIndices() const
 {
     gmx_ana_index_t g;
@@ -216,6 +287,12 @@ void SelectionData::initializeMassesAndCharges(const gmx_mtop_t* top)
     else
     {
         computeMassesAndCharges(top, rawPositions_, &posMass_, &posCharge_);
+        if (isDynamic())
+        {
+            const t_blocka& mapb = rawPositions_.m.mapb;
+            massChargeBlockIndex_.assign(mapb.index, mapb.index + mapb.nr + 1);
+            massChargeAtoms_.assign(mapb.a, mapb.a + mapb.nra);
+        }
     }
 }
 
@@ -224,7 +301,18 @@ void SelectionData::refreshMassesAndCharges(const gmx_mtop_t* top)
 {
     if (top != nullptr && isDynamic() && !hasFlag(efSelection_DynamicMask))
     {
+        // Many dynamic selections select the same atoms in consecutive
+        // frames; the topology lookups can then be skipped.
+        const t_blocka& mapb = rawPositions_.m.mapb;
+        if (ssize(massChargeBlockIndex_) == mapb.nr + 1 && ssize(massChargeAtoms_) == mapb.nra
+            && std::equal(mapb.index, mapb.index + mapb.nr + 1, massChargeBlockIndex_.begin())
+            && std::equal(mapb.a, mapb.a + mapb.nra, massChargeAtoms_.begin()))
+        {
+            return;
+        }
         computeMassesAndCharges(top, rawPositions_, &posMass_, &posCharge_);
+        massChargeBlockIndex_.assign(mapb.index, mapb.index + mapb.nr + 1);
+        massChargeAtoms_.assign(mapb.a, mapb.a + mapb.nra);
     }
 }
 
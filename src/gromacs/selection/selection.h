@@ -45,6 +45,7 @@
 #ifndef GMX_SELECTION_SELECTION_H
 #define GMX_SELECTION_SELECTION_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -98,6 +99,22 @@ public:
     SelectionData(SelectionTreeElement* elem, const char* selstr);
     ~SelectionData();
 
+    /*! \brief
+     * Creates an object that holds a copy of the evaluated values of a selection.
+     *
+     * \param[in] other  Selection to copy.
+     * \throws    std::bad_alloc if out of memory.
+     *
+     * The copy shares the evaluation tree with \p other and cannot itself
+     * be evaluated; copyEvaluatedValues() updates it after \p other has been
+     * evaluated for a frame.  Memory is allocated for the maximal set of
+     * positions in \p other, so \p other should not have been evaluated
+     * when this is called.
+     *
+     * Used for analyzing several frames in parallel.
+     */
+    static std::unique_ptr<SelectionData> createValueCopy(const SelectionData& other);
+
     //! Returns the name for this selection.
     const char* name() const { return name_.c_str(); }
     //! Returns the string that was parsed to produce this selection.
@@ -160,6 +177,9 @@ public:
      *
      * \param[in] top   Topology information.
      *
+     * The values are only recomputed if the atoms in the positions have
+     * changed since the previous call.
+     *
      * Called by SelectionEvaluator.
      */
     void refreshMassesAndCharges(const gmx_mtop_t* top);
@@ -189,8 +209,20 @@ public:
      * Called by SelectionEvaluator::evaluateFinal().
      */
     void restoreOriginalPositions(const gmx_mtop_t* top);
+    /*! \brief
+     * Copies the evaluated values for the current frame from another selection.
+     *
+     * \param[in] other  Selection this object was created from with
+     *     createValueCopy().
+     *
+     * Does not throw.
+     */
+    void copyEvaluatedValues(const SelectionData& other);
 
 private:
+    //! Initializes a copy of \p other for createValueCopy().
+    explicit SelectionData(const SelectionData* other);
+
     //! Name of the selection.
     std::string name_;
     //! The actual selection string.
@@ -201,6 +233,10 @@ private:
     std::vector<real> posMass_;
     //! Total charges for the current positions.
     std::vector<real> posCharge_;
+    //! Value of `rawPositions_.m.mapb.index` for which \p posMass_ was computed.
+    std::vector<int>  massChargeBlockIndex_;
+    //! Value of `rawPositions_.m.mapb.a` for which \p posMass_ was computed.
+    std::vector<int>  massChargeAtoms_;
     SelectionFlags    flags_;
     //! Root of the selection evaluation tree.
     SelectionTreeElement& rootElement_;
@@ -566,6 +602,10 @@ private:
      * Needed to access the data to adjust flags.
      */
     friend class SelectionOptionStorage;
+    /*! \brief
+     * Needed to map selections to copies of their values.
+     */
+    friend class SelectionCollection;
 };
 
 /*! \brief
@@ -877,6 +877,32 @@ void SelectionCollection::evaluateFinal(int nframes)
 }
 
 
+void SelectionCollection::copyEvaluatedValues(SelectionValueCopies* copies) const
+{
+    for (const auto& sel : impl_->sc_.sel)
+    {
+        std::unique_ptr<internal::SelectionData>& copy = (*copies)[sel.get()];
+        if (copy)
+        {
+            copy->copyEvaluatedValues(*sel);
+        }
+        else
+        {
+            copy = internal::SelectionData::createValueCopy(*sel);
+        }
+    }
+}
+
+
+// static
+Selection SelectionCollection::findValueCopy(const SelectionValueCopies& copies,
+                                             const Selection&            selection)
+{
+    const auto copy = copies.find(selection.sel_);
+    return copy != copies.end() ? Selection(copy->second.get()) : selection;
+}
+
+
 void SelectionCollection::printTree(FILE* fp, bool bValues) const
 {
     SelectionTreeElementPointer sel = impl_->sc_.root;
@@ -46,6 +46,8 @@
 
 #include <cstdio>
 
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -67,6 +69,14 @@ class TextInputStream;
 class TextOutputStream;
 struct SelectionTopologyProperties;
 
+/*! \brief
+ * Copies of evaluated selection values, indexed by the selection they copy.
+ *
+ * \see SelectionCollection::copyEvaluatedValues()
+ */
+typedef std::map<const internal::SelectionData*, std::unique_ptr<internal::SelectionData>>
+        SelectionValueCopies;
+
 /*! \brief
  * Collection of selections.
  *
@@ -388,6 +398,32 @@ public:
      * Does not throw.
      */
     void evaluateFinal(int nframes);
+    /*! \brief
+     * Copies the evaluated values of all selections.
+     *
+     * \param[in,out] copies  Copies to update.
+     * \throws    std::bad_alloc if out of memory.
+     *
+     * Copies that do not yet exist in \p copies are created, with memory
+     * for the maximal set of positions of each selection.
+     * After the copies have been created, the method does not throw.
+     *
+     * Each copy remains valid after the collection has been evaluated for
+     * the next frame, which allows analyzing several frames in parallel
+     * while the selections are evaluated serially.
+     */
+    void copyEvaluatedValues(SelectionValueCopies* copies) const;
+    /*! \brief
+     * Returns the copy of a selection created by copyEvaluatedValues().
+     *
+     * \param[in] copies     Copies created with copyEvaluatedValues().
+     * \param[in] selection  Selection to find the copy for.
+     * \returns   The copy of \p selection, or \p selection itself if
+     *     \p copies does not contain a copy of it.
+     *
+     * Does not throw.
+     */
+    static Selection findValueCopy(const SelectionValueCopies& copies, const Selection& selection);
 
     /*! \brief
      * Prints a human-readable version of the internal selection element
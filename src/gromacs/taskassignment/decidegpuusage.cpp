@@ -64,6 +64,7 @@
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/mdtypes/mdrunoptions.h"
+#include "gromacs/mdtypes/multipletimestepping.h"
 #include "gromacs/pulling/pull.h"
 #include "gromacs/taskassignment/taskassignment.h"
 #include "gromacs/topology/mtop_util.h"
@@ -524,7 +525,7 @@ bool decideWhetherToUseGpusForBonded(bool              useGpuForNonbonded,
     // Note that here we assume that the auto setting of PME ranks will not
     // choose seperate PME ranks when nonBonded are assigned to the GPU.
     bool usingOurCpuForPmeOrEwald =
-            (EVDW_PME(inputrec.vdwtype)
+            ((EVDW_PME(inputrec.vdwtype) && !useGpuForPme)
              || (EEL_PME_EWALD(inputrec.coulombtype) && !useGpuForPme && numPmeRanksPerSimulation <= 0));
 
     return gpusWereDetected && usingOurCpuForPmeOrEwald;
@@ -585,9 +586,12 @@ bool decideWhetherToUseGpuForUpdate(const bool                     isDomainDecom
         }
     }
 
-    if (inputrec.useMts)
+    if (inputrec.useMts
+        && inputrec.mtsLevels.back().forceGroups[static_cast<int>(gmx::MtsForceGroups::Nonbonded)])
     {
-        errorMessage += "Multiple time stepping is not supported.\n";
+        errorMessage +=
+                "With multiple time stepping, nonbonded interactions can not be computed at the "
+                "slow level.\n";
     }
 
     if (inputrec.eConstrAlg == econtSHAKE && hasAnyConstraints && gmx_mtop_ftype_count(mtop, F_CONSTR) > 0)
@@ -611,13 +615,9 @@ bool decideWhetherToUseGpuForUpdate(const bool                     isDomainDecom
     {
         errorMessage += "Only a CUDA build is supported.\n";
     }
-    if (inputrec.eI != eiMD)
-    {
-        errorMessage += "Only the md integrator is supported.\n";
-    }
-    if (inputrec.etc == etcNOSEHOOVER)
+    if (inputrec.eI != eiMD && inputrec.eI != eiSD1)
     {
-        errorMessage += "Nose-Hoover temperature coupling is not supported.\n";
+        errorMessage += "Only the md and sd integrators are supported.\n";
     }
     if (!(inputrec.epc == epcNO || inputrec.epc == epcPARRINELLORAHMAN
           || inputrec.epc == epcBERENDSEN || inputrec.epc == epcCRESCALE))
@@ -633,7 +633,22 @@ bool decideWhetherToUseGpuForUpdate(const bool                     isDomainDecom
     }
     if (gmx_mtop_interaction_count(mtop, IF_VSITE) > 0)
     {
-        errorMessage += "Virtual sites are not supported.\n";
+        if (!UpdateConstrainGpu::areVirtualSitesSupported(mtop))
+        {
+            errorMessage +=
+                    "Virtual sites of type N and virtual sites constructed from other virtual "
+                    "sites are not supported.\n";
+        }
+        if (isDomainDecomposition && !useUpdateGroups)
+        {
+            errorMessage +=
+                    "With domain decomposition, virtual sites are only supported when update "
+                    "groups are used.\n";
+        }
+        if (inputrec.useMts)
+        {
+            errorMessage += "Virtual sites are not supported with multiple time stepping.\n";
+        }
     }
     if (useEssentialDynamics)
     {
@@ -662,6 +677,20 @@ bool decideWhetherToUseGpuForUpdate(const bool                     isDomainDecom
     {
         errorMessage += "Replica exchange simulations are not supported.\n";
     }
+    if (inputrec.bSimTemp)
+    {
+        // Temperature changes are applied by scaling all velocities uniformly
+        for (int i = 0; i < inputrec.opts.ngtc; i++)
+        {
+            if (inputrec.opts.ref_t[i] <= 0)
+            {
+                errorMessage +=
+                        "Simulated tempering with uncoupled temperature-coupling groups is not "
+                        "supported.\n";
+                break;
+            }
+        }
+    }
     if (inputrec.eSwapCoords != eswapNO)
     {
         errorMessage += "Swapping the coordinates is not supported.\n";
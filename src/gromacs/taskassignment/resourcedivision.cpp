@@ -344,6 +344,7 @@ int get_nthreads_mpi(const gmx_hw_info_t* hwinfo,
                      const int            numDevicesToUse,
                      bool                 nonbondedOnGpu,
                      bool                 pmeOnGpu,
+                     const int            numPmeRanks,
                      const t_inputrec*    inputrec,
                      const gmx_mtop_t*    mtop,
                      const gmx::MDLogger& mdlog,
@@ -355,6 +356,7 @@ int get_nthreads_mpi(const gmx_hw_info_t* hwinfo,
     const gmx::CpuInfo&          cpuInfo = *hwinfo->cpuInfo;
     const gmx::HardwareTopology& hwTop   = *hwinfo->hardwareTopology;
 
+    bool useSeparatePmeGpuRank = false;
     if (pmeOnGpu)
     {
         GMX_RELEASE_ASSERT((EEL_PME(inputrec->coulombtype) || EVDW_PME(inputrec->vdwtype))
@@ -364,10 +366,19 @@ int get_nthreads_mpi(const gmx_hw_info_t* hwinfo,
                            "PME can't be on GPUs unless we are using PME");
 
         // PME on GPUs supports a single PME rank with PP running on the same or few other ranks.
-        // For now, let's treat separate PME GPU rank as opt-in.
+        // When PME is required to run on a GPU (otherwise pmeOnGpu is only set with
+        // a single GPU), we put it on a separate rank when there is a second GPU for it.
+        // This uses both GPUs without PP domain decomposition. Otherwise a separate PME
+        // GPU rank is opt-in.
         if (hw_opt->nthreads_tmpi < 1)
         {
-            return 1;
+            useSeparatePmeGpuRank = (nonbondedOnGpu && numDevicesToUse >= 2 && numPmeRanks != 0
+                                     && hwinfo->nthreads_hw_avail >= 2
+                                     && (hw_opt->nthreads_tot == 0 || hw_opt->nthreads_tot >= 2));
+            if (!useSeparatePmeGpuRank)
+            {
+                return 1;
+            }
         }
     }
 
@@ -401,6 +412,16 @@ int get_nthreads_mpi(const gmx_hw_info_t* hwinfo,
         }
     }
 
+    if (useSeparatePmeGpuRank)
+    {
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendText(
+                        "Using two thread-MPI ranks, one for PP with the non-bonded "
+                        "interactions and one for PME, each with its own GPU.");
+        return 2;
+    }
+
     if (hw_opt->nthreads_tmpi > 0)
     {
         /* Trivial, return the user's choice right away */
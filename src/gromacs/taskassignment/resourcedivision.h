@@ -72,12 +72,15 @@ class PhysicalNodeCommunicator;
  * Thus all options should be internally consistent and consistent
  * with the hardware, except that ntmpi could be larger than number of GPUs.
  * If necessary, this function will modify hw_opt->nthreads_omp.
+ * With PME required on a GPU, \p numPmeRanks not set to 0 and at least two
+ * GPUs, two ranks are used: a PP rank and a PME rank, each with its own GPU.
  */
 int get_nthreads_mpi(const gmx_hw_info_t* hwinfo,
                      gmx_hw_opt_t*        hw_opt,
                      int                  numDevicesToUse,
                      bool                 nonbondedOnGpu,
                      bool                 pmeOnGpu,
+                     int                  numPmeRanks,
                      const t_inputrec*    inputrec,
                      const gmx_mtop_t*    mtop,
                      const gmx::MDLogger& mdlog,
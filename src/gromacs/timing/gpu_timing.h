@@ -44,6 +44,8 @@
 #ifndef GMX_TIMING_GPU_TIMING_H
 #define GMX_TIMING_GPU_TIMING_H
 
+#include <cstdint>
+
 /*! \internal \brief GPU kernel time and call count. */
 struct gmx_kernel_timing_data_t
 {
@@ -91,4 +93,27 @@ struct gmx_wallclock_gpu_nbnxn_t
     int                      pl_h2d_c; /**< pair search step  host to device transfer call count */
 };
 
+/*! \internal \brief Cluster-pair and atom-pair counts of GPU pair lists, summed over searches.
+ *
+ * These are counted on the host when the list is constructed and describe
+ * the work the non-bonded kernels perform and how much of it is useful.
+ * When dynamic pruning is used, the kernels compute the pairs of cluster
+ * pairs within the inner list buffer, so all atom-pair counts refer to those.
+ */
+struct gmx_gpu_nbnxn_list_counters_t
+{
+    //! Number of pair searches counted
+    int64_t numSearches = 0;
+    //! The number of i-/j-cluster pairs in the outer list
+    int64_t numClusterPairs = 0;
+    //! The number of cluster pairs with an atom pair within the inner list cut-off
+    int64_t numClusterPairsInner = 0;
+    //! The number of atom pairs computed by the kernels for the inner cluster pairs
+    int64_t numAtomPairs = 0;
+    //! The number of computed atom pairs not masked by exclusions
+    int64_t numAtomPairsNotExcluded = 0;
+    //! The number of non-excluded atom pairs within the interaction cut-off
+    int64_t numAtomPairsInRange = 0;
+};
+
 #endif
@@ -0,0 +1,104 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares functions for annotating code regions for external profilers.
+ *
+ * Depending on the GMX_INSTRUMENTATION CMake option, the regions are passed
+ * to NVTX, ROCTX or Intel ITT, so that profiles made with Nsight Systems,
+ * rocprof or VTune show the same regions as the mdrun cycle accounting.
+ * Without instrumentation, the functions are empty and compiled away.
+ *
+ * \inlibraryapi
+ * \ingroup module_timing
+ */
+#ifndef GMX_TIMING_INSTRUMENTATION_H
+#define GMX_TIMING_INSTRUMENTATION_H
+
+#include "config.h"
+
+#if GMX_USE_NVTX
+#    include <nvtx3/nvToolsExt.h>
+#elif GMX_USE_ROCTX
+#    include <roctracer/roctx.h>
+#elif GMX_USE_ITT
+#    include <ittnotify.h>
+#endif
+
+#include "gromacs/utility/basedefinitions.h"
+
+namespace gmx
+{
+
+#if GMX_USE_ITT
+//! Returns the ITT domain that all GROMACS regions belong to
+static inline __itt_domain* ittDomain()
+{
+    static __itt_domain* domain = __itt_domain_create("GROMACS");
+    return domain;
+}
+#endif
+
+/*! \brief Marks the start of the region named \p name on the calling thread
+ *
+ * Regions can be nested, but each has to be ended with
+ * instrumentationRangeEnd() on the same thread.
+ */
+static inline void instrumentationRangeStart(const char* gmx_unused name)
+{
+#if GMX_USE_NVTX
+    nvtxRangePushA(name);
+#elif GMX_USE_ROCTX
+    roctxRangePushA(name);
+#elif GMX_USE_ITT
+    __itt_task_begin(ittDomain(), __itt_null, __itt_null, __itt_string_handle_create(name));
+#endif
+}
+
+//! Marks the end of the region that was started last on the calling thread
+static inline void instrumentationRangeEnd()
+{
+#if GMX_USE_NVTX
+    nvtxRangePop();
+#elif GMX_USE_ROCTX
+    roctxRangePop();
+#elif GMX_USE_ITT
+    __itt_task_end(ittDomain());
+#endif
+}
+
+} // namespace gmx
+
+#endif
@@ -43,20 +43,33 @@
 
 #include <cstdlib>
 
+#if defined(__linux__)
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+#include <algorithm>
 #include <array>
+#include <string>
 #include <vector>
 
 #include "gromacs/math/functions.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/timing/cyclecounter.h"
 #include "gromacs/timing/gpu_timing.h"
+#include "gromacs/timing/instrumentation.h"
 #include "gromacs/timing/wallcyclereporting.h"
+#include "gromacs/timing/walltime_accounting.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/logger.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/snprintf.h"
+#include "gromacs/utility/stringutil.h"
 
 static const bool useCycleSubcounters = GMX_CYCLE_SUBCOUNTERS;
 
@@ -77,6 +90,69 @@ typedef struct
     gmx_cycles_t start;
 } wallcc_t;
 
+/*! \brief Timed region recorded for the timeline trace
+ *
+ * Subcounters are stored with an offset of ewcNR in \p counter.
+ */
+struct WallcycleTraceEvent
+{
+    int          counter;
+    gmx_cycles_t start;
+    gmx_cycles_t stop;
+};
+
+/*! \brief Records the start and stop of every timed region for a timeline trace
+ *
+ * The events are stored in a buffer of fixed size which is overwritten
+ * from the start when it is full, so the trace only contains the last
+ * c_traceBufferSize regions of long runs and tracing never allocates
+ * after initialization.
+ */
+struct WallcycleTrace
+{
+    //! The maximum number of events kept in the buffer
+    static constexpr size_t c_traceBufferSize = 1 << 20;
+
+    //! Name of the trace file to write
+    std::string fileName;
+    //! The rank, used as process ID in the trace
+    int rank = 0;
+    //! Circular buffer of recorded events
+    std::vector<WallcycleTraceEvent> events;
+    //! The total number of events recorded
+    int64_t numEventsRecorded = 0;
+    //! The cycle counter at initialization
+    gmx_cycles_t cycleAtInit = 0;
+    //! The wall time at initialization, used to convert cycles to time
+    double timeAtInit = 0;
+};
+
+/* The hardware events counted for each main counter with GMX_CYCLE_HWCOUNTERS */
+enum
+{
+    ehwINSTRUCTIONS,
+    ehwCORE_CYCLES,
+    ehwCACHE_REFERENCES,
+    ehwCACHE_MISSES,
+    ehwNR
+};
+
+/*! \brief Hardware performance counters for each main counter
+ *
+ * The events are counted with a Linux perf_event group for the thread
+ * that called wallcycle_init(), i.e. the master thread of each rank,
+ * so that all events are read with a single system call.
+ */
+struct WallcycleHardwareCounters
+{
+    //! The perf_event file descriptors, the first is the group leader
+    std::array<int, ehwNR> fds;
+    //! Event values at the last start of each counter, index ewc*ehwNR + event
+    std::array<uint64_t, ewcNR * ehwNR> start = {};
+    //! Event counts accumulated for each counter, index ewc*ehwNR + event
+    std::array<double, ewcNR * ehwNR> sum = {};
+};
+
 struct gmx_wallcycle
 {
     wallcc_t* wcc;
@@ -98,6 +174,10 @@ struct gmx_wallcycle
     MPI_Comm mpi_comm_mygroup;
 #endif
     wallcc_t* wcsc;
+    /* timeline trace recorder, only set with GMX_CYCLE_TRACE */
+    WallcycleTrace* trace;
+    /* hardware performance counters, only set with GMX_CYCLE_HWCOUNTERS */
+    WallcycleHardwareCounters* hwCounters;
 };
 
 /* Each name should not exceed 19 printing characters
@@ -190,6 +270,81 @@ static const char* PMEStageNames[] = {
     "PME solve",  "PME 3D-FFT c2r", "PME gather",
 };
 
+/*! \brief Opens the hardware counters for the calling thread
+ *
+ * Returns nullptr when the counters are not supported or not permitted,
+ * e.g. due to the perf_event_paranoid setting of the kernel.
+ */
+static WallcycleHardwareCounters* openHardwareCounters()
+{
+#if defined(__linux__)
+    const std::array<uint64_t, ehwNR> events = { PERF_COUNT_HW_INSTRUCTIONS,
+                                                 PERF_COUNT_HW_CPU_CYCLES,
+                                                 PERF_COUNT_HW_CACHE_REFERENCES,
+                                                 PERF_COUNT_HW_CACHE_MISSES };
+
+    auto* counters = new WallcycleHardwareCounters;
+    for (int e = 0; e < ehwNR; e++)
+    {
+        perf_event_attr attr = {};
+        attr.type            = PERF_TYPE_HARDWARE;
+        attr.size            = sizeof(attr);
+        attr.config          = events[e];
+        attr.disabled        = (e == 0 ? 1 : 0);
+        attr.exclude_kernel  = 1;
+        attr.exclude_hv      = 1;
+        attr.read_format     = PERF_FORMAT_GROUP;
+
+        const int groupFd = (e == 0 ? -1 : counters->fds[0]);
+        /* pid 0 and cpu -1 count the calling thread on any CPU */
+        counters->fds[e] =
+                static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+        if (counters->fds[e] < 0)
+        {
+            for (int i = 0; i < e; i++)
+            {
+                close(counters->fds[i]);
+            }
+            delete counters;
+            return nullptr;
+        }
+    }
+    ioctl(counters->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    return counters;
+#else
+    return nullptr;
+#endif
+}
+
+/* Reads the current values of all hardware events into \p values */
+static void readHardwareCounters(gmx_unused const WallcycleHardwareCounters& counters,
+                                 uint64_t*                                  values)
+{
+#if defined(__linux__)
+    /* With PERF_FORMAT_GROUP the number of events precedes the values */
+    std::array<uint64_t, 1 + ehwNR> buffer;
+    if (read(counters.fds[0], buffer.data(), sizeof(buffer)) == sizeof(buffer))
+    {
+        std::copy(buffer.begin() + 1, buffer.end(), values);
+        return;
+    }
+#endif
+    std::fill(values, values + ehwNR, 0);
+}
+
+static void closeHardwareCounters(WallcycleHardwareCounters* counters)
+{
+#if defined(__linux__)
+    for (int fd : counters->fds)
+    {
+        close(fd);
+    }
+#endif
+    delete counters;
+}
+
 gmx_bool wallcycle_have_counter()
 {
     return gmx_cycles_have_counter();
@@ -241,6 +396,46 @@ gmx_wallcycle_t wallcycle_init(FILE* fplog, int resetstep, t_commrec gmx_unused*
         snew(wc->wcsc, ewcsNR);
     }
 
+    const char* traceFileName = getenv("GMX_CYCLE_TRACE");
+    if (traceFileName != nullptr)
+    {
+        wc->trace           = new WallcycleTrace;
+        wc->trace->fileName = traceFileName;
+        if (cr != nullptr && cr->nnodes > 1)
+        {
+            wc->trace->rank = cr->nodeid;
+            wc->trace->fileName += gmx::formatString(".%d", cr->nodeid);
+        }
+        wc->trace->events.resize(WallcycleTrace::c_traceBufferSize);
+        wc->trace->cycleAtInit = gmx_cycles_read();
+        wc->trace->timeAtInit  = gmx_gettime();
+        if (fplog)
+        {
+            fprintf(fplog, "\nWill write a timeline trace of the timed regions to %s\n\n",
+                    wc->trace->fileName.c_str());
+        }
+    }
+
+    if (getenv("GMX_CYCLE_HWCOUNTERS") != nullptr)
+    {
+        wc->hwCounters = openHardwareCounters();
+        if (fplog)
+        {
+            if (wc->hwCounters != nullptr)
+            {
+                fprintf(fplog,
+                        "\nWill count hardware events for the timed regions of the master "
+                        "thread\n\n");
+            }
+            else
+            {
+                fprintf(fplog,
+                        "\nHardware event counting was requested, but is not supported or not "
+                        "permitted\n\n");
+            }
+        }
+    }
+
 #ifdef DEBUG_WCYCLE
     wc->count_depth = 0;
 #endif
@@ -248,6 +443,56 @@ gmx_wallcycle_t wallcycle_init(FILE* fplog, int resetstep, t_commrec gmx_unused*
     return wc;
 }
 
+/*! \brief Writes the recorded events in the Chrome/Perfetto JSON trace format
+ *
+ * The cycle counts are converted to time using the cycles and wall time
+ * elapsed since the trace was started.
+ */
+static void writeTrace(const WallcycleTrace& trace)
+{
+    const double elapsedTime   = gmx_gettime() - trace.timeAtInit;
+    const double elapsedCycles = static_cast<double>(gmx_cycles_read() - trace.cycleAtInit);
+    /* Trace event times are in microseconds */
+    const double microsecondsPerCycle = (elapsedCycles > 0 ? 1e6 * elapsedTime / elapsedCycles : 0);
+
+    const int64_t bufferSize = trace.events.size();
+    const int64_t numEvents  = std::min(trace.numEventsRecorded, bufferSize);
+    const int64_t firstEvent = trace.numEventsRecorded - numEvents;
+
+    FILE* fp = gmx_ffopen(trace.fileName, "w");
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (int64_t i = firstEvent; i < firstEvent + numEvents; i++)
+    {
+        const WallcycleTraceEvent& event = trace.events[i % bufferSize];
+
+        const bool  isSubcounter = (event.counter >= ewcNR);
+        const char* name = isSubcounter ? wcsn[event.counter - ewcNR] : wcn[event.counter];
+        /* Subtract before converting to avoid losing precision */
+        const double start    = static_cast<double>(event.start - trace.cycleAtInit);
+        const double duration = static_cast<double>(event.stop - event.start);
+        fprintf(fp,
+                "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,"
+                "\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                name, isSubcounter ? "subcounter" : "counter", trace.rank,
+                start * microsecondsPerCycle, duration * microsecondsPerCycle,
+                i + 1 < firstEvent + numEvents ? "," : "");
+    }
+    fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+    gmx_ffclose(fp);
+}
+
+/* Records a timed region in the trace, when tracing is active */
+static void traceEvent(gmx_wallcycle_t wc, int counter, gmx_cycles_t start, gmx_cycles_t stop)
+{
+    if (wc->trace != nullptr && stop >= start)
+    {
+        WallcycleTrace& trace = *wc->trace;
+
+        trace.events[trace.numEventsRecorded % trace.events.size()] = { counter, start, stop };
+        trace.numEventsRecorded++;
+    }
+}
+
 void wallcycle_destroy(gmx_wallcycle_t wc)
 {
     if (wc == nullptr)
@@ -255,6 +500,16 @@ void wallcycle_destroy(gmx_wallcycle_t wc)
         return;
     }
 
+    if (wc->trace != nullptr)
+    {
+        writeTrace(*wc->trace);
+        delete wc->trace;
+    }
+    if (wc->hwCounters != nullptr)
+    {
+        closeHardwareCounters(wc->hwCounters);
+    }
+
     if (wc->wcc != nullptr)
     {
         sfree(wc->wcc);
@@ -335,8 +590,14 @@ void wallcycle_start(gmx_wallcycle_t wc, int ewc)
     debug_start_check(wc, ewc);
 #endif
 
+    gmx::instrumentationRangeStart(wcn[ewc]);
+
     cycle              = gmx_cycles_read();
     wc->wcc[ewc].start = cycle;
+    if (wc->hwCounters != nullptr)
+    {
+        readHardwareCounters(*wc->hwCounters, &wc->hwCounters->start[ewc * ehwNR]);
+    }
     if (wc->wcc_all != nullptr)
     {
         wc->wc_depth++;
@@ -411,6 +672,19 @@ double wallcycle_stop(gmx_wallcycle_t wc, int ewc)
     }
     wc->wcc[ewc].c += last;
     wc->wcc[ewc].n++;
+    traceEvent(wc, ewc, wc->wcc[ewc].start, cycle);
+    if (wc->hwCounters != nullptr)
+    {
+        std::array<uint64_t, ehwNR> values;
+        readHardwareCounters(*wc->hwCounters, values.data());
+        for (int e = 0; e < ehwNR; e++)
+        {
+            wc->hwCounters->sum[ewc * ehwNR + e] +=
+                    static_cast<double>(values[e] - wc->hwCounters->start[ewc * ehwNR + e]);
+        }
+    }
+
+    gmx::instrumentationRangeEnd();
     if (wc->wcc_all)
     {
         wc->wc_depth--;
@@ -465,6 +739,10 @@ void wallcycle_reset_all(gmx_wallcycle_t wc)
             wc->wcsc[i].c = 0;
         }
     }
+    if (wc->hwCounters)
+    {
+        wc->hwCounters->sum.fill(0);
+    }
 }
 
 static gmx_bool is_pme_counter(int ewc)
@@ -660,6 +938,13 @@ WallcycleCounts wallcycle_sum(const t_commrec* cr, gmx_wallcycle_t wc)
             sfree(buf_all);
             sfree(cyc_all);
         }
+
+        if (wc->hwCounters != nullptr)
+        {
+            // TODO Use MPI_Reduce
+            MPI_Allreduce(MPI_IN_PLACE, wc->hwCounters->sum.data(), wc->hwCounters->sum.size(),
+                          MPI_DOUBLE, MPI_SUM, cr->mpi_comm_mysim);
+        }
     }
     else
 #endif
@@ -718,6 +1003,23 @@ print_cycles(FILE* fplog, double c2t, const char* name, int nnodes, int nthreads
     }
 }
 
+/* Prints the instruction count, instructions per cycle and last-level cache behavior of a region */
+static void print_hardware_counters(FILE* fplog, const char* name, const double* values)
+{
+    const double instructions = values[ehwINSTRUCTIONS];
+
+    if (instructions > 0)
+    {
+        const double ipc = (values[ehwCORE_CYCLES] > 0 ? instructions / values[ehwCORE_CYCLES] : 0);
+        const double missRate =
+                (values[ehwCACHE_REFERENCES] > 0
+                         ? 100 * values[ehwCACHE_MISSES] / values[ehwCACHE_REFERENCES]
+                         : 0);
+        fprintf(fplog, " %-19.19s %14.3f %8.2f %14.3f %10.1f\n", name, instructions * 1e-9, ipc,
+                1e3 * values[ehwCACHE_MISSES] / instructions, missRate);
+    }
+}
+
 static void print_gputimes(FILE* fplog, const char* name, int n, double t, double tot_t)
 {
     char num[11];
@@ -776,17 +1078,18 @@ static void print_header(FILE* fplog, int nrank_pp, int nth_pp, int nrank_pme, i
 }
 
 
-void wallcycle_print(FILE*                            fplog,
-                     const gmx::MDLogger&             mdlog,
-                     int                              nnodes,
-                     int                              npme,
-                     int                              nth_pp,
-                     int                              nth_pme,
-                     double                           realtime,
-                     gmx_wallcycle_t                  wc,
-                     const WallcycleCounts&           cyc_sum,
-                     const gmx_wallclock_gpu_nbnxn_t* gpu_nbnxn_t,
-                     const gmx_wallclock_gpu_pme_t*   gpu_pme_t)
+void wallcycle_print(FILE*                                fplog,
+                     const gmx::MDLogger&                 mdlog,
+                     int                                  nnodes,
+                     int                                  npme,
+                     int                                  nth_pp,
+                     int                                  nth_pme,
+                     double                               realtime,
+                     gmx_wallcycle_t                      wc,
+                     const WallcycleCounts&               cyc_sum,
+                     const gmx_wallclock_gpu_nbnxn_t*     gpu_nbnxn_t,
+                     const gmx_wallclock_gpu_pme_t*       gpu_pme_t,
+                     const gmx_gpu_nbnxn_list_counters_t* gpu_nbnxn_list_counters)
 {
     double      tot, tot_for_pp, tot_for_rest, tot_cpu_overlap, gpu_cpu_ratio;
     double      c2t, c2t_pp, c2t_pme = 0;
@@ -951,6 +1254,23 @@ void wallcycle_print(FILE*                            fplog,
         fprintf(fplog, "%s\n", hline);
     }
 
+    if (wc->hwCounters)
+    {
+        fprintf(fplog,
+                "\n Hardware counters of the master thread of each rank, summed over ranks\n"
+                " (including their nested regions)\n%s\n",
+                hline);
+        fprintf(fplog,
+                " Computing:               Giga-Instr.      IPC  LLC miss/kInstr  LLC miss %%\n"
+                "%s\n",
+                hline);
+        for (i = 0; i < ewcNR; i++)
+        {
+            print_hardware_counters(fplog, wcn[i], &wc->hwCounters->sum[i * ehwNR]);
+        }
+        fprintf(fplog, "%s\n", hline);
+    }
+
     /* print GPU timing summary */
     double tot_gpu = 0.0;
     if (gpu_pme_t)
@@ -1093,6 +1413,28 @@ void wallcycle_print(FILE*                            fplog,
         }
     }
 
+    if (gpu_nbnxn_list_counters && gpu_nbnxn_list_counters->numAtomPairs > 0)
+    {
+        const gmx_gpu_nbnxn_list_counters_t& counters    = *gpu_nbnxn_list_counters;
+        const double                         numSearches = counters.numSearches;
+
+        fprintf(fplog, "\n GPU non-bonded pair-list efficiency, lists of this rank\n%s\n", hline);
+        fprintf(fplog, " Cluster pairs per search:       %12.0f\n",
+                counters.numClusterPairs / numSearches);
+        fprintf(fplog, " Cluster pairs after pruning:    %12.0f  %5.1f %c\n",
+                counters.numClusterPairsInner / numSearches,
+                100.0 * counters.numClusterPairsInner / counters.numClusterPairs, '%');
+        fprintf(fplog, " Atom pairs computed:            %12.0f\n",
+                counters.numAtomPairs / numSearches);
+        fprintf(fplog, " Atom pairs not excluded:        %12.0f  %5.1f %c\n",
+                counters.numAtomPairsNotExcluded / numSearches,
+                100.0 * counters.numAtomPairsNotExcluded / counters.numAtomPairs, '%');
+        fprintf(fplog, " Atom pairs within the cut-off:  %12.0f  %5.1f %c\n",
+                counters.numAtomPairsInRange / numSearches,
+                100.0 * counters.numAtomPairsInRange / counters.numAtomPairs, '%');
+        fprintf(fplog, "%s\n", hline);
+    }
+
     if (wc->wc_barrier)
     {
         GMX_LOG(mdlog.warning)
@@ -1164,6 +1506,7 @@ void wallcycle_sub_start(gmx_wallcycle_t wc, int ewcs)
 {
     if (useCycleSubcounters && wc != nullptr)
     {
+        gmx::instrumentationRangeStart(wcsn[ewcs]);
         wc->wcsc[ewcs].start = gmx_cycles_read();
     }
 }
@@ -1181,7 +1524,10 @@ void wallcycle_sub_stop(gmx_wallcycle_t wc, int ewcs)
 {
     if (useCycleSubcounters && wc != nullptr)
     {
-        wc->wcsc[ewcs].c += gmx_cycles_read() - wc->wcsc[ewcs].start;
+        const gmx_cycles_t cycle = gmx_cycles_read();
+        wc->wcsc[ewcs].c += cycle - wc->wcsc[ewcs].start;
         wc->wcsc[ewcs].n++;
+        traceEvent(wc, ewcNR + ewcs, wc->wcsc[ewcs].start, cycle);
+        gmx::instrumentationRangeEnd();
     }
 }
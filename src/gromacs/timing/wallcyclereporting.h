@@ -57,6 +57,7 @@ class MDLogger;
 typedef struct gmx_wallcycle* gmx_wallcycle_t;
 struct gmx_wallclock_gpu_nbnxn_t;
 struct gmx_wallclock_gpu_pme_t;
+struct gmx_gpu_nbnxn_list_counters_t;
 
 typedef std::array<double, int(ewcNR) + int(ewcsNR)> WallcycleCounts;
 /* Convenience typedef */
@@ -65,17 +66,19 @@ WallcycleCounts wallcycle_sum(const t_commrec* cr, gmx_wallcycle_t wc);
 /* Return a vector of the sum of cycle counts over the nodes in
    cr->mpi_comm_mysim. */
 
-void wallcycle_print(FILE*                            fplog,
-                     const gmx::MDLogger&             mdlog,
-                     int                              nnodes,
-                     int                              npme,
-                     int                              nth_pp,
-                     int                              nth_pme,
-                     double                           realtime,
-                     gmx_wallcycle_t                  wc,
-                     const WallcycleCounts&           cyc_sum,
-                     const gmx_wallclock_gpu_nbnxn_t* gpu_nbnxn_t,
-                     const gmx_wallclock_gpu_pme_t*   gpu_pme_t);
-/* Print the cycle and time accounting */
+void wallcycle_print(FILE*                                fplog,
+                     const gmx::MDLogger&                 mdlog,
+                     int                                  nnodes,
+                     int                                  npme,
+                     int                                  nth_pp,
+                     int                                  nth_pme,
+                     double                               realtime,
+                     gmx_wallcycle_t                      wc,
+                     const WallcycleCounts&               cyc_sum,
+                     const gmx_wallclock_gpu_nbnxn_t*     gpu_nbnxn_t,
+                     const gmx_wallclock_gpu_pme_t*       gpu_pme_t,
+                     const gmx_gpu_nbnxn_list_counters_t* gpu_nbnxn_list_counters);
+/* Print the cycle and time accounting,
+ * the GPU timings and the GPU pair-list counters can be nullptr */
 
 #endif
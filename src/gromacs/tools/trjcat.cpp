@@ -44,7 +44,9 @@
 #include <cstring>
 
 #include <algorithm>
+#include <limits>
 #include <string>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/confio.h"
@@ -73,11 +75,66 @@
 #endif
 #define FLAGS (TRX_READ_X | TRX_READ_V | TRX_READ_F)
 
-static void scan_trj_files(gmx::ArrayRef<const std::string> files,
-                           real*                            readtime,
-                           real*                            timestep,
-                           int                              imax,
-                           const gmx_output_env_t*          oenv)
+/*! \brief Reads the next XTC frame without decoding the coordinates
+ *
+ * The raw frame is stored in \p frameData, the number of atoms, step
+ * and time in \p fr. Returns whether a complete frame was read.
+ */
+static bool read_next_xtc_frame_raw(t_fileio*          fio,
+                                    int                natoms,
+                                    std::vector<char>* frameData,
+                                    t_trxframe*        fr)
+{
+    gmx_bool bOK;
+    int      frameNatoms;
+
+    if (!read_next_xtc_frame_data(fio, natoms, frameData, &bOK) || !bOK
+        || !read_xtc_frame_data_header(frameData, &frameNatoms, &fr->step, &fr->time))
+    {
+        return false;
+    }
+    fr->natoms = frameNatoms;
+    fr->bStep  = TRUE;
+    fr->bTime  = TRUE;
+
+    return true;
+}
+
+/*! \brief Reads the times of the first two frames of an XTC file from the frame headers
+ *
+ * Returns the number of atoms.
+ */
+static int scan_xtc_file(const std::string& file, real* readtime, real* timestep)
+{
+    t_fileio*         fio = open_xtc(file.c_str(), "r");
+    std::vector<char> frameData;
+    t_trxframe        fr;
+
+    clear_trxframe(&fr, TRUE);
+    if (!read_next_xtc_frame_raw(fio, std::numeric_limits<int>::max(), &frameData, &fr))
+    {
+        gmx_fatal(FARGS, "\nCouldn't read frame from file.");
+    }
+    const int natoms = fr.natoms;
+    *readtime        = fr.time;
+    if (read_next_xtc_frame_raw(fio, natoms, &frameData, &fr))
+    {
+        *timestep = fr.time - *readtime;
+    }
+    else
+    {
+        *timestep = 0;
+    }
+    close_xtc(fio);
+
+    return natoms;
+}
+
+static int scan_trj_files(gmx::ArrayRef<const std::string> files,
+                          real*                            readtime,
+                          real*                            timestep,
+                          int                              imax,
+                          const gmx_output_env_t*          oenv)
 {
     /* Check start time of all files */
     int          natoms = 0;
@@ -87,6 +144,26 @@ static void scan_trj_files(gmx::ArrayRef<const std::string> files,
 
     for (gmx::index i = 0; i < files.ssize(); i++)
     {
+        if (fn2ftp(files[i].c_str()) == efXTC)
+        {
+            /* Only the frame headers are needed, so we skip decoding the coordinates */
+            fr.natoms = scan_xtc_file(files[i], &readtime[i], &timestep[i]);
+            if (i == 0)
+            {
+                natoms = fr.natoms;
+            }
+            else if (imax == -1 && natoms != fr.natoms)
+            {
+                gmx_fatal(FARGS, "\nDifferent numbers of atoms (%d/%d) in files", natoms,
+                          fr.natoms);
+            }
+            else if (imax != -1 && fr.natoms <= imax)
+            {
+                gmx_fatal(FARGS, "\nNot enough atoms (%d) for index group (%d)", fr.natoms, imax);
+            }
+            continue;
+        }
+
         ok = read_first_frame(oenv, &status, files[i].c_str(), &fr, FLAGS);
 
         if (!ok)
@@ -149,6 +226,8 @@ static void scan_trj_files(gmx::ArrayRef<const std::string> files,
         }
     }
     fprintf(stderr, "\n");
+
+    return natoms;
 }
 
 static void sort_files(gmx::ArrayRef<std::string> files, real* settime)
@@ -606,7 +685,7 @@ int gmx_trjcat(int argc, char* argv[])
     {
         snew(readtime, inFiles.size() + 1);
         snew(timest, inFiles.size() + 1);
-        scan_trj_files(inFiles, readtime, timest, imax, oenv);
+        const int natoms = scan_trj_files(inFiles, readtime, timest, imax, oenv);
 
         snew(settime, inFiles.size() + 1);
         snew(cont_type, inFiles.size() + 1);
@@ -755,6 +834,11 @@ int gmx_trjcat(int argc, char* argv[])
             }
             frout = fr;
         }
+        /* Without an index group, XTC frames are copied without decoding the coordinates */
+        const bool        copyXtcFrames = (ftpin == efXTC && ftpout == efXTC && !bIndex);
+        t_fileio*         xtcIn         = nullptr;
+        std::vector<char> frameData;
+
         /* Lets stitch up some files */
         timestep = timest[0];
         for (size_t i = n_append + 1; i < inFilesEdited.size(); i++)
@@ -813,7 +897,19 @@ int gmx_trjcat(int argc, char* argv[])
             {
                 timestep = timest[i];
             }
-            read_first_frame(oenv, &status, inFilesEdited[i].c_str(), &fr, FLAGS);
+            if (copyXtcFrames)
+            {
+                clear_trxframe(&fr, TRUE);
+                xtcIn = open_xtc(inFilesEdited[i].c_str(), "r");
+                if (!read_next_xtc_frame_raw(xtcIn, natoms, &frameData, &fr))
+                {
+                    gmx_fatal(FARGS, "\nCouldn't read frame from file.");
+                }
+            }
+            else
+            {
+                read_first_frame(oenv, &status, inFilesEdited[i].c_str(), &fr, FLAGS);
+            }
             if (!fr.bTime)
             {
                 fr.time = 0;
@@ -899,7 +995,17 @@ int gmx_trjcat(int argc, char* argv[])
                             bNewFile = FALSE;
                         }
 
-                        if (bIndex)
+                        if (copyXtcFrames)
+                        {
+                            if (!write_xtc_frame_data(trx_get_fileio(trxout), &frameData,
+                                                      frout.step, frout.time))
+                            {
+                                gmx_fatal(FARGS,
+                                          "Cannot write trajectory frame; maybe you are out of "
+                                          "disk space?");
+                            }
+                        }
+                        else if (bIndex)
                         {
                             write_trxframe_indexed(trxout, &frout, isize, index, nullptr);
                         }
@@ -915,9 +1021,17 @@ int gmx_trjcat(int argc, char* argv[])
                         }
                     }
                 }
-            } while (read_next_frame(oenv, status, &fr));
+            } while (copyXtcFrames ? read_next_xtc_frame_raw(xtcIn, natoms, &frameData, &fr)
+                                   : read_next_frame(oenv, status, &fr));
 
-            close_trx(status);
+            if (copyXtcFrames)
+            {
+                close_xtc(xtcIn);
+            }
+            else
+            {
+                close_trx(status);
+            }
         }
         if (trxout)
         {
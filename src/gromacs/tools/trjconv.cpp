@@ -62,6 +62,7 @@
 #include "gromacs/math/do_fit.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdlib/trajectorywriterthread.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pbcutil/pbcmethods.h"
@@ -73,6 +74,7 @@
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 static void mk_filenm(char* base, const char* ext, int ndigit, int file_nr, char out_file[])
@@ -215,6 +217,68 @@ static std::unique_ptr<gmx_mtop_t> read_mtop_for_tng(const char* tps_file,
     return mtop;
 }
 
+/*! \brief Writes an XTC or TRR frame to \p trxout on a writer thread
+ *
+ * The frame is copied, so the caller can reuse its buffers immediately,
+ * while the writer thread does the compression and file writing.
+ * The writer thread is started at the first frame written to \p trxout.
+ */
+static void writeFrameOnWriterThread(std::unique_ptr<gmx::TrajectoryWriterThread>* writerThread,
+                                     t_trxstatus*                                  trxout,
+                                     int                                           ftp,
+                                     const t_trxframe&                             fr)
+{
+    if (ftp == efXTC && !fr.bX)
+    {
+        gmx_fatal(FARGS, "Need coordinates to write a %s trajectory", ftp2ext(ftp));
+    }
+    if (*writerThread == nullptr)
+    {
+        t_fileio* fio  = trx_get_fileio(trxout);
+        real      prec = fr.bPrec ? fr.prec : 1000.0;
+
+        *writerThread = std::make_unique<gmx::TrajectoryWriterThread>(
+                ftp == efTRR ? fio : nullptr, ftp == efXTC ? fio : nullptr, prec);
+    }
+
+    gmx::TrajectoryOutputFrame* frame = (*writerThread)->acquireFrame();
+    frame->step                       = fr.step;
+    frame->time                       = fr.time;
+    frame->lambda                     = fr.lambda;
+    copy_mat(fr.box, frame->box);
+    const gmx::RVec* x = reinterpret_cast<const gmx::RVec*>(fr.x);
+    const gmx::RVec* v = reinterpret_cast<const gmx::RVec*>(fr.v);
+    const gmx::RVec* f = reinterpret_cast<const gmx::RVec*>(fr.f);
+    if (ftp == efXTC)
+    {
+        frame->writeFullPrecision = false;
+        frame->writeCompressed    = true;
+        frame->xCompressed.assign(x, x + fr.natoms);
+    }
+    else
+    {
+        frame->writeFullPrecision = true;
+        frame->writeCompressed    = false;
+        frame->natoms             = fr.natoms;
+        frame->haveX              = fr.bX;
+        frame->haveV              = fr.bV;
+        frame->haveF              = fr.bF;
+        if (fr.bX)
+        {
+            frame->x.assign(x, x + fr.natoms);
+        }
+        if (fr.bV)
+        {
+            frame->v.assign(v, v + fr.natoms);
+        }
+        if (fr.bF)
+        {
+            frame->f.assign(f, f + fr.natoms);
+        }
+    }
+    (*writerThread)->submitFrame();
+}
+
 int gmx_trjconv(int argc, char* argv[])
 {
     const char* desc[] = {
@@ -406,7 +470,8 @@ int gmx_trjconv(int argc, char* argv[])
     static rvec     newbox = { 0, 0, 0 }, shift = { 0, 0, 0 }, trans = { 0, 0, 0 };
     static char*    exec_command = nullptr;
     static real     dropunder = 0, dropover = 0;
-    static gmx_bool bRound = FALSE;
+    static gmx_bool bRound   = FALSE;
+    static int      nthreads = -1;
 
     t_pargs pa[] = {
         { "-skip", FALSE, etINT, { &skip_nr }, "Only write every nr-th frame" },
@@ -469,12 +534,15 @@ int gmx_trjconv(int argc, char* argv[])
           { &bCONECT },
           "Add conect records when writing [REF].pdb[ref] files. Useful "
           "for visualization of non-standard molecules, e.g. "
-          "coarse grained ones" }
+          "coarse grained ones" },
+        { "-nt", FALSE, etINT, { &nthreads }, "Number of threads to start" }
     };
 #define NPA asize(pa)
 
     FILE*        out    = nullptr;
     t_trxstatus* trxout = nullptr;
+    /* Compresses and writes XTC and TRR frames while the next frames are processed */
+    std::unique_ptr<gmx::TrajectoryWriterThread> writerThread;
     t_trxstatus* trxin;
     int          file_nr;
     t_trxframe   fr, frout;
@@ -521,11 +589,13 @@ int gmx_trjconv(int argc, char* argv[])
                        { efXVG, "-drop", "drop", ffOPTRD } };
 #define NFILE asize(fnm)
 
+    nthreads = gmx_omp_get_max_threads();
     if (!parse_common_args(&argc, argv, PCA_CAN_BEGIN | PCA_CAN_END | PCA_CAN_VIEW | PCA_TIME_UNIT,
                            NFILE, fnm, NPA, pa, asize(desc), desc, 0, nullptr, &oenv))
     {
         return 0;
     }
+    gmx_omp_set_num_threads(nthreads);
     fprintf(stdout,
             "Note that major changes are planned in future for "
             "trjconv, to improve usability and utility.\n");
@@ -845,6 +915,8 @@ int gmx_trjconv(int argc, char* argv[])
         {
             flags = TRX_NEED_X;
         }
+        /* decode XTC frames ahead on the OpenMP threads */
+        flags = flags | TRX_PREFETCH;
         if (bVels)
         {
             flags = flags | TRX_READ_V;
@@ -1332,13 +1404,22 @@ int gmx_trjconv(int argc, char* argv[])
                             case efXTC:
                                 if (bSplitHere)
                                 {
+                                    /* Write all pending frames to the old file */
+                                    writerThread.reset();
                                     if (trxout)
                                     {
                                         close_trx(trxout);
                                     }
                                     trxout = open_trx(out_file2, filemode);
                                 }
-                                write_trxframe(trxout, &frout, gc);
+                                if (nthreads > 1)
+                                {
+                                    writeFrameOnWriterThread(&writerThread, trxout, ftp, frout);
+                                }
+                                else
+                                {
+                                    write_trxframe(trxout, &frout, gc);
+                                }
                                 break;
                             case efGRO:
                             case efG96:
@@ -1466,6 +1547,7 @@ int gmx_trjconv(int argc, char* argv[])
             gmx_rmpbc_done(gpbc);
         }
 
+        writerThread.reset();
         if (trxout)
         {
             close_trx(trxout);
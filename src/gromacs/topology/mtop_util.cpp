@@ -50,6 +50,7 @@
 #include "gromacs/topology/exclusionblocks.h"
 #include "gromacs/topology/idef.h"
 #include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/mtop_lookup.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/topology/topsort.h"
 #include "gromacs/utility/arrayref.h"
@@ -111,8 +112,24 @@ AtomIterator::AtomIterator(const gmx_mtop_t& mtop, int globalAtomNumber) :
     localAtomNumber_(0),
     globalAtomNumber_(globalAtomNumber)
 {
-    GMX_ASSERT(globalAtomNumber == 0 || globalAtomNumber == mtop.natoms,
-               "Starting at other atoms not implemented yet");
+    GMX_ASSERT(globalAtomNumber >= 0 && globalAtomNumber <= mtop.natoms,
+               "The atom to start at should be within range");
+    if (globalAtomNumber > 0 && globalAtomNumber < mtop.natoms)
+    {
+        int moleculeBlock = 0;
+        mtopGetMolblockIndex(&mtop, globalAtomNumber, &moleculeBlock, &currentMolecule_,
+                             &localAtomNumber_);
+        mblock_ = moleculeBlock;
+        atoms_  = &mtop.moltype[mtop.molblock[mblock_].type].atoms;
+        /* The residue number counter is at the start of the block,
+         * advanced by the molecules before the current one.
+         */
+        highestResidueNumber_ = mtop.moleculeBlockIndices[mblock_].residueNumberStart - 1;
+        if (atoms_->nres <= mtop.maxResiduesPerMoleculeToTriggerRenumber())
+        {
+            highestResidueNumber_ += currentMolecule_ * atoms_->nres;
+        }
+    }
 }
 
 AtomIterator& AtomIterator::operator++()
@@ -110,7 +110,11 @@ class AtomIterator :
             boost::stl_interfaces::proxy_iterator_interface<AtomIterator, std::forward_iterator_tag, t_atom, AtomProxy>;
 
 public:
-    //! Construct from topology and optionalally a global atom number.
+    /*! \brief Construct from topology and optionally a global atom number to start at.
+     *
+     * Starting at an atom other than the first requires the molecule
+     * block indices, i.e. a finalized topology.
+     */
     explicit AtomIterator(const gmx_mtop_t& mtop, int globalAtomNumber = 0);
 
     //! Prefix increment.
@@ -148,6 +152,12 @@ class AtomRange
 public:
     //! Default constructor.
     explicit AtomRange(const gmx_mtop_t& mtop) : begin_(mtop), end_(mtop, mtop.natoms) {}
+    /*! \brief Range over the atoms from \p begin up to \p end
+     *
+     * Allows processing the atoms of a large system in chunks,
+     * without setting up data for all atoms.
+     */
+    AtomRange(const gmx_mtop_t& mtop, int begin, int end) : begin_(mtop, begin), end_(mtop, end) {}
     //! Iterator to begin of range.
     AtomIterator& begin() { return begin_; }
     //! Iterator to end of range.
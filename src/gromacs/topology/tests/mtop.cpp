@@ -41,10 +41,13 @@
  */
 #include "gmxpre.h"
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "gromacs/topology/mtop_util.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/smalloc.h"
 
 namespace gmx
 {
@@ -137,6 +140,60 @@ TEST(MtopTest, Operators)
     EXPECT_FALSE(it == otherIt);
 }
 
+TEST(MtopTest, AtomRangeCanStartWithinTheSystem)
+{
+    gmx_mtop_t mtop;
+    // Two molecule types, with one and with two residues per molecule
+    mtop.moltype.resize(2);
+    for (int numResidues = 1; numResidues <= 2; numResidues++)
+    {
+        auto& moltype      = mtop.moltype[numResidues - 1];
+        moltype.atoms.nr   = 3;
+        moltype.atoms.nres = numResidues;
+        snew(moltype.atoms.atom, moltype.atoms.nr);
+        snew(moltype.atoms.resinfo, numResidues);
+        for (int i = 0; i < moltype.atoms.nr; i++)
+        {
+            moltype.atoms.atom[i].resind = (i * numResidues) / moltype.atoms.nr;
+        }
+        for (int r = 0; r < numResidues; r++)
+        {
+            moltype.atoms.resinfo[r].nr = 11 + r;
+        }
+    }
+    mtop.molblock.resize(3);
+    mtop.molblock[0].type = 0;
+    mtop.molblock[0].nmol = 2;
+    mtop.molblock[1].type = 1;
+    mtop.molblock[1].nmol = 3;
+    mtop.molblock[2].type = 0;
+    mtop.molblock[2].nmol = 2;
+    mtop.natoms           = 21;
+    mtop.finalize();
+
+    std::vector<int> residueNumbers;
+    std::vector<int> atomNumbersInMol;
+    for (const AtomProxy atomP : AtomRange(mtop))
+    {
+        residueNumbers.push_back(atomP.residueNumber());
+        atomNumbersInMol.push_back(atomP.atomNumberInMol());
+    }
+    ASSERT_EQ(residueNumbers.size(), 21U);
+
+    for (int begin = 0; begin <= mtop.natoms; begin++)
+    {
+        int count = begin;
+        for (const AtomProxy atomP : AtomRange(mtop, begin, mtop.natoms))
+        {
+            EXPECT_EQ(atomP.globalAtomNumber(), count);
+            EXPECT_EQ(atomP.residueNumber(), residueNumbers[count]);
+            EXPECT_EQ(atomP.atomNumberInMol(), atomNumbersInMol[count]);
+            ++count;
+        }
+        EXPECT_EQ(count, mtop.natoms);
+    }
+}
+
 TEST(MtopTest, CanFindResidueStartAndEndAtoms)
 {
     gmx_mtop_t mtop;
@@ -46,11 +46,14 @@
 
 #include <map>
 #include <utility>
+#include <vector>
 
 #include "gromacs/analysisdata/analysisdata.h"
 #include "gromacs/selection/selection.h"
+#include "gromacs/selection/selectioncollection.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/inmemoryserializer.h"
 
 namespace gmx
 {
@@ -109,8 +112,16 @@ public:
 
     //! Keeps a data handle for each AnalysisData object.
     HandleContainer handles_;
+    /*! \brief
+     * Valid data handles in the order of the dataset names.
+     *
+     * The order is the same in all processes, unlike in \a handles_.
+     */
+    std::vector<AnalysisDataHandle> orderedHandles_;
     //! Stores thread-local selections.
     const SelectionCollection& selections_;
+    //! Frame-local copies of the selection values, set by copySelectionValues().
+    SelectionValueCopies selectionCopies_;
 };
 
 TrajectoryAnalysisModuleData::Impl::Impl(TrajectoryAnalysisModule*          module,
@@ -125,6 +136,7 @@ TrajectoryAnalysisModuleData::Impl::Impl(TrajectoryAnalysisModule*          modu
         if (isInitialized(*i->second))
         {
             handle = i->second->startData(opt);
+            orderedHandles_.push_back(handle);
         }
         handles_.insert(std::make_pair(i->second, handle));
     }
@@ -172,6 +184,7 @@ void TrajectoryAnalysisModuleData::finishDataHandles()
         }
     }
     impl_->handles_.clear();
+    impl_->orderedHandles_.clear();
 }
 
 
@@ -183,14 +196,14 @@ AnalysisDataHandle TrajectoryAnalysisModuleData::dataHandle(const AnalysisData&
 }
 
 
-Selection TrajectoryAnalysisModuleData::parallelSelection(const Selection& selection)
+Selection TrajectoryAnalysisModuleData::parallelSelection(const Selection& selection) const
 {
-    // TODO: Implement properly.
-    return selection;
+    return SelectionCollection::findValueCopy(impl_->selectionCopies_, selection);
 }
 
 
-SelectionList TrajectoryAnalysisModuleData::parallelSelections(const SelectionList& selections)
+SelectionList
+TrajectoryAnalysisModuleData::parallelSelections(const SelectionList& selections) const
 {
     // TODO: Consider an implementation that does not allocate memory every time.
     SelectionList newSelections;
@@ -204,6 +217,44 @@ SelectionList TrajectoryAnalysisModuleData::parallelSelections(const SelectionLi
 }
 
 
+void TrajectoryAnalysisModuleData::copySelectionValues()
+{
+    impl_->selections_.copyEvaluatedValues(&impl_->selectionCopies_);
+}
+
+
+std::vector<char> TrajectoryAnalysisModuleData::takeRecordedFrame()
+{
+    InMemorySerializer serializer;
+    for (AnalysisDataHandle& handle : impl_->orderedHandles_)
+    {
+        std::vector<char> frame = handle.takeRecordedFrame();
+        int               size  = frame.size();
+        serializer.doInt(&size);
+        serializer.doOpaque(frame.data(), size);
+    }
+    return serializer.finishAndGetBuffer();
+}
+
+
+void TrajectoryAnalysisModuleData::addRecordedFrame(ArrayRef<const char> frame)
+{
+    InMemoryDeserializer deserializer(frame, GMX_DOUBLE);
+    std::vector<char>    handleFrame;
+    for (AnalysisDataHandle& handle : impl_->orderedHandles_)
+    {
+        int size;
+        deserializer.doInt(&size);
+        handleFrame.resize(size);
+        deserializer.doOpaque(handleFrame.data(), size);
+        if (size > 0)
+        {
+            handle.addRecordedFrame(handleFrame);
+        }
+    }
+}
+
+
 /********************************************************************
  * TrajectoryAnalysisModuleDataBasic
  */
@@ -50,6 +50,7 @@
 #include <vector>
 
 #include "gromacs/selection/selection.h" // For gmx::SelectionList
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/classhelpers.h"
 
 struct t_pbc;
@@ -126,11 +127,13 @@ public:
      * \p selection is the selection object that was obtained from
      * SelectionOption.  The return value is the corresponding selection
      * in the selection collection with which this data object was
-     * constructed with.
+     * constructed with.  If the frames are analyzed in parallel, the
+     * returned selection holds the values for the frame that is being
+     * analyzed with this data object (see copySelectionValues()).
      *
      * Does not throw.
      */
-    static Selection parallelSelection(const Selection& selection);
+    Selection parallelSelection(const Selection& selection) const;
     /*! \brief
      * Returns a set of selection that corresponds to the given selections.
      *
@@ -140,7 +143,41 @@ public:
      *
      * \see parallelSelection()
      */
-    static SelectionList parallelSelections(const SelectionList& selections);
+    SelectionList parallelSelections(const SelectionList& selections) const;
+    /*! \brief
+     * Copies the current values of all selections into this object.
+     *
+     * \throws std::bad_alloc if out of memory.
+     *
+     * Called by the trajectory analysis runner after the selections have
+     * been evaluated for a frame that will be analyzed using this object,
+     * when several frames are analyzed in parallel.  After the first call,
+     * parallelSelection() returns the copied values instead of the global
+     * selections, and the selections can be evaluated for other frames
+     * while this frame is being analyzed.
+     * Memory is only allocated in the first call.
+     */
+    void copySelectionValues();
+    /*! \brief
+     * Returns the last frame recorded in all data handles.
+     *
+     * \throws std::bad_alloc if out of memory.
+     *
+     * Can only be called if the data object was created with options that
+     * request frames to be recorded (see AnalysisDataParallelOptions).
+     * The frames of all registered datasets are combined into a single
+     * buffer, which can be passed to addRecordedFrame() on a data object
+     * for the same module in another process.
+     */
+    std::vector<char> takeRecordedFrame();
+    /*! \brief
+     * Adds a frame returned by takeRecordedFrame() to all data handles.
+     *
+     * \param[in] frame  Frame returned by takeRecordedFrame().
+     * \throws    unspecified  Any exception thrown by
+     *     AnalysisDataHandle::addRecordedFrame().
+     */
+    void addRecordedFrame(ArrayRef<const char> frame);
 
 protected:
     /*! \brief
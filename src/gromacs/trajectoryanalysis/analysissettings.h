@@ -128,6 +128,25 @@ public:
          * \see setRmPBC()
          */
         efNoUserRmPBC = 1 << 5,
+        /*! \brief
+         * Allows analyzing several frames in parallel.
+         *
+         * If this flag is specified, the user can request with an \p -nt
+         * option that several frames are passed to
+         * TrajectoryAnalysisModule::analyzeFrame() concurrently from
+         * different threads.  The module should then only modify data in
+         * the TrajectoryAnalysisModuleData object, obtain its selections
+         * through TrajectoryAnalysisModuleData::parallelSelection(), and
+         * not depend on the order in which frames are analyzed outside
+         * TrajectoryAnalysisModule::finishFrameSerial().
+         *
+         * With an MPI library, the frames are also distributed over the
+         * MPI ranks, and only the data added through the registered
+         * datasets is collected on the master rank.  The module should
+         * then not accumulate results in its own data structures, e.g., in
+         * TrajectoryAnalysisModule::finishFrames().
+         */
+        efAllowFrameParallel = 1 << 6,
     };
 
     //! Initializes default settings.
@@ -44,9 +44,16 @@
 
 #include "cmdlinerunner.h"
 
+#include "config.h"
+
+#include <algorithm>
+#include <vector>
+
 #include "gromacs/analysisdata/paralleloptions.h"
 #include "gromacs/commandline/cmdlinemodulemanager.h"
 #include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/options/basicoptions.h"
 #include "gromacs/options/ioptionscontainer.h"
 #include "gromacs/options/timeunitmanager.h"
 #include "gromacs/pbcutil/pbc.h"
@@ -59,6 +66,8 @@
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/filestream.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxmpi.h"
+#include "gromacs/utility/gmxomp.h"
 
 #include "runnercommon.h"
 
@@ -68,6 +77,51 @@ namespace gmx
 namespace
 {
 
+/********************************************************************
+ * FrameCopy
+ */
+
+/*! \brief
+ * Copy of a trajectory frame that stays valid while later frames are read.
+ *
+ * The header and the atom data pointers are copied, while the coordinates,
+ * velocities and forces are stored in the object itself.
+ */
+class FrameCopy
+{
+public:
+    FrameCopy() : frame_() {}
+
+    //! Copies \p frame into this object.
+    void assign(const t_trxframe& frame)
+    {
+        frame_ = frame;
+        copyArray(frame.x, frame.natoms, &x_, &frame_.x);
+        copyArray(frame.v, frame.natoms, &v_, &frame_.v);
+        copyArray(frame.f, frame.natoms, &f_, &frame_.f);
+    }
+
+    //! Returns the copied frame.
+    t_trxframe& frame() { return frame_; }
+
+private:
+    static void copyArray(const rvec* source, int count, std::vector<RVec>* dest, rvec** destPtr)
+    {
+        if (source == nullptr)
+        {
+            *destPtr = nullptr;
+            return;
+        }
+        dest->assign(source, source + count);
+        *destPtr = as_rvec_array(dest->data());
+    }
+
+    t_trxframe        frame_;
+    std::vector<RVec> x_;
+    std::vector<RVec> v_;
+    std::vector<RVec> f_;
+};
+
 /********************************************************************
  * RunnerModule
  */
@@ -86,10 +140,25 @@ public:
     void optionsFinished() override;
     int  run() override;
 
+    //! Analyzes the frames one at a time, returning the number of frames.
+    int runSerial(const TopologyInformation& topology);
+    //! Analyzes batches of \p threadCount frames in parallel, returning the number of frames.
+    int runFrameParallel(const TopologyInformation& topology, int threadCount);
+#if GMX_LIB_MPI
+    /*! \brief
+     * Distributes the frames over MPI ranks, returning the number of frames.
+     *
+     * \p localFrameCount is set to the number of frames analyzed on this rank.
+     */
+    int runDistributed(const TopologyInformation& topology, int* localFrameCount);
+#endif
+
     TrajectoryAnalysisModulePointer module_;
     TrajectoryAnalysisSettings      settings_;
     TrajectoryAnalysisRunnerCommon  common_;
     SelectionCollection             selections_;
+    //! Number of frames to analyze in parallel (0 = use all threads).
+    int frameThreadCount_ = 1;
 };
 
 void RunnerModule::initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings)
@@ -106,6 +175,13 @@ void RunnerModule::initOptions(IOptionsContainer* options, ICommandLineOptionsMo
     module_->initOptions(&moduleOptions, &settings_);
     settings_.setOptionsModuleSettings(nullptr);
     common_.initOptions(&commonOptions, timeUnitBehavior.get());
+    if (settings_.hasFlag(TrajectoryAnalysisSettings::efAllowFrameParallel))
+    {
+        commonOptions.addOption(IntegerOption("nt")
+                                        .store(&frameThreadCount_)
+                                        .description("Number of threads for analyzing frames in "
+                                                     "parallel (0 is all available)"));
+    }
     selectionOptionBehavior->initOptions(&commonOptions);
 }
 
@@ -126,6 +202,64 @@ int RunnerModule::run()
     common_.initFrameIndexGroup();
     module_->initAfterFirstFrame(settings_, common_.frame());
 
+    int threadCount = frameThreadCount_;
+    if (threadCount <= 0)
+    {
+        threadCount = gmx_omp_get_max_threads();
+    }
+    bool bMaster         = true;
+    int  nframes         = 0;
+    int  localFrameCount = 0;
+#if GMX_LIB_MPI
+    int rankCount = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &rankCount);
+    if (rankCount > 1 && common_.hasTrajectory()
+        && settings_.hasFlag(TrajectoryAnalysisSettings::efAllowFrameParallel))
+    {
+        int rank = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        bMaster = (rank == 0);
+        nframes = runDistributed(topology, &localFrameCount);
+    }
+    else
+#endif
+    {
+        if (threadCount > 1 && common_.hasTrajectory())
+        {
+            nframes = runFrameParallel(topology, threadCount);
+        }
+        else
+        {
+            nframes = runSerial(topology);
+        }
+        localFrameCount = nframes;
+    }
+
+    // Restore the maximal groups for dynamic selections.
+    selections_.evaluateFinal(localFrameCount);
+    if (!bMaster)
+    {
+        // All results have been sent to the master rank.
+        return 0;
+    }
+
+    if (common_.hasTrajectory())
+    {
+        fprintf(stderr, "Analyzed %d frames, last time %.3f\n", nframes, common_.frame().time);
+    }
+    else
+    {
+        fprintf(stderr, "Analyzed topology coordinates\n");
+    }
+
+    module_->finishAnalysis(nframes);
+    module_->writeOutput();
+
+    return 0;
+}
+
+int RunnerModule::runSerial(const TopologyInformation& topology)
+{
     t_pbc  pbc;
     t_pbc* ppbc = settings_.hasPBC() ? &pbc : nullptr;
 
@@ -153,24 +287,144 @@ int RunnerModule::run()
         pdata->finish();
     }
     pdata.reset();
+    return nframes;
+}
 
-    if (common_.hasTrajectory())
+int RunnerModule::runFrameParallel(const TopologyInformation& topology, int threadCount)
+{
+    // Frames are read and the selections evaluated serially, storing a copy
+    // of each frame and of the evaluated selections in a per-thread slot.
+    // The module then analyzes the whole batch in parallel, and the serial
+    // processing of the data is done in frame order after the batch.
+    AnalysisDataParallelOptions                      dataOptions(threadCount);
+    std::vector<TrajectoryAnalysisModuleDataPointer> pdata;
+    std::vector<FrameCopy>                           frames(threadCount);
+    std::vector<t_pbc>                               pbc(threadCount);
+    for (int i = 0; i < threadCount; ++i)
     {
-        fprintf(stderr, "Analyzed %d frames, last time %.3f\n", nframes, common_.frame().time);
+        pdata.push_back(module_->startFrames(dataOptions, selections_));
     }
-    else
+
+    int  nframes        = 0;
+    bool bHaveNextFrame = true;
+    while (bHaveNextFrame)
     {
-        fprintf(stderr, "Analyzed topology coordinates\n");
+        int batchSize = 0;
+        while (bHaveNextFrame && batchSize < threadCount)
+        {
+            common_.initFrame();
+            frames[batchSize].assign(common_.frame());
+            t_trxframe& frame = frames[batchSize].frame();
+            t_pbc*      ppbc  = settings_.hasPBC() ? &pbc[batchSize] : nullptr;
+            if (ppbc != nullptr)
+            {
+                set_pbc(ppbc, topology.pbcType(), frame.box);
+            }
+            selections_.evaluate(&frame, ppbc);
+            pdata[batchSize]->copySelectionValues();
+            ++batchSize;
+            bHaveNextFrame = common_.readNextFrame();
+        }
+
+#pragma omp parallel for num_threads(batchSize) schedule(static, 1)
+        for (int i = 0; i < batchSize; ++i)
+        {
+            try
+            {
+                t_pbc* ppbc = settings_.hasPBC() ? &pbc[i] : nullptr;
+                module_->analyzeFrame(nframes + i, frames[i].frame(), ppbc, pdata[i].get());
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+
+        for (int i = 0; i < batchSize; ++i)
+        {
+            module_->finishFrameSerial(nframes + i);
+        }
+        nframes += batchSize;
     }
+    for (auto& data : pdata)
+    {
+        module_->finishFrames(data.get());
+        if (data.get() != nullptr)
+        {
+            data->finish();
+        }
+        data.reset();
+    }
+    return nframes;
+}
 
-    // Restore the maximal groups for dynamic selections.
-    selections_.evaluateFinal(nframes);
+#if GMX_LIB_MPI
+int RunnerModule::runDistributed(const TopologyInformation& topology, int* localFrameCount)
+{
+    // Frame i is analyzed on rank i % rankCount.  The other ranks record
+    // the data they produce and send it to the master rank, which adds the
+    // frames in order to its own data objects, such that all attached
+    // modules see the full trajectory.
+    int rank      = 0;
+    int rankCount = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &rankCount);
 
-    module_->finishAnalysis(nframes);
-    module_->writeOutput();
+    t_pbc  pbc;
+    t_pbc* ppbc = settings_.hasPBC() ? &pbc : nullptr;
 
-    return 0;
+    AnalysisDataParallelOptions dataOptions;
+    dataOptions.setRecordFrames(rank != 0);
+    TrajectoryAnalysisModuleDataPointer pdata(module_->startFrames(dataOptions, selections_));
+    std::vector<char>                   frameData;
+
+    int nframes      = 0;
+    *localFrameCount = 0;
+    do
+    {
+        const int frameRank = nframes % rankCount;
+        if (frameRank == rank)
+        {
+            common_.initFrame();
+            t_trxframe& frame = common_.frame();
+            if (ppbc != nullptr)
+            {
+                set_pbc(ppbc, topology.pbcType(), frame.box);
+            }
+
+            selections_.evaluate(&frame, ppbc);
+            module_->analyzeFrame(nframes, frame, ppbc, pdata.get());
+            ++(*localFrameCount);
+            if (rank != 0)
+            {
+                frameData      = pdata->takeRecordedFrame();
+                int frameBytes = frameData.size();
+                MPI_Send(&frameBytes, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
+                MPI_Send(frameData.data(), frameBytes, MPI_BYTE, 0, 0, MPI_COMM_WORLD);
+            }
+        }
+        else if (rank == 0)
+        {
+            int frameBytes = 0;
+            MPI_Recv(&frameBytes, 1, MPI_INT, frameRank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            frameData.resize(frameBytes);
+            MPI_Recv(frameData.data(), frameBytes, MPI_BYTE, frameRank, 0, MPI_COMM_WORLD,
+                     MPI_STATUS_IGNORE);
+            pdata->addRecordedFrame(frameData);
+        }
+        if (rank == 0)
+        {
+            module_->finishFrameSerial(nframes);
+        }
+
+        ++nframes;
+    } while (common_.readNextFrame());
+    module_->finishFrames(pdata.get());
+    if (pdata.get() != nullptr)
+    {
+        pdata->finish();
+    }
+    pdata.reset();
+    return nframes;
 }
+#endif
 
 } // namespace
 
@@ -50,6 +50,7 @@
 #include "modules/angle.h"
 #include "modules/convert_trj.h"
 #include "modules/distance.h"
+#include "modules/dssp.h"
 #include "modules/extract_cluster.h"
 #include "modules/freevolume.h"
 #include "modules/pairdist.h"
@@ -94,6 +95,7 @@ void registerTrajectoryAnalysisModules(CommandLineModuleManager* manager)
     registerModule<AngleInfo>(manager, group);
     registerModule<ConvertTrjInfo>(manager, group);
     registerModule<DistanceInfo>(manager, group);
+    registerModule<DsspInfo>(manager, group);
     registerModule<ExtractClusterInfo>(manager, group);
     registerModule<FreeVolumeInfo>(manager, group);
     registerModule<PairDistanceInfo>(manager, group);
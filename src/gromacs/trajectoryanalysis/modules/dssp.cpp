@@ -0,0 +1,937 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements gmx::analysismodules::Dssp.
+ *
+ * \ingroup module_trajectoryanalysis
+ */
+#include "gmxpre.h"
+
+#include "dssp.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gromacs/analysisdata/analysisdata.h"
+#include "gromacs/analysisdata/dataframe.h"
+#include "gromacs/analysisdata/datamodule.h"
+#include "gromacs/analysisdata/modules/plot.h"
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/math/units.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/filenameoption.h"
+#include "gromacs/options/ioptionscontainer.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/selection/nbsearch.h"
+#include "gromacs/selection/selection.h"
+#include "gromacs/selection/selectionoption.h"
+#include "gromacs/topology/mtop_lookup.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/trajectoryanalysis/analysissettings.h"
+#include "gromacs/trajectoryanalysis/topologyinformation.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/enumerationhelpers.h"
+#include "gromacs/utility/exceptions.h"
+
+namespace gmx
+{
+
+namespace analysismodules
+{
+
+namespace
+{
+
+//! \addtogroup module_trajectoryanalysis
+//! \{
+
+//! Secondary structure types, in the order they are written to `-num`.
+enum class SecondaryStructure : int
+{
+    Loop,
+    AlphaHelix,
+    Bridge,
+    Strand,
+    Helix310,
+    PiHelix,
+    Turn,
+    Bend,
+    Count
+};
+
+//! One-letter codes corresponding to SecondaryStructure, as used by DSSP.
+const EnumerationArray<SecondaryStructure, char> c_secondaryStructureCodes = {
+    { '~', 'H', 'B', 'E', 'G', 'I', 'T', 'S' }
+};
+//! Legends corresponding to SecondaryStructure.
+const EnumerationArray<SecondaryStructure, const char*> c_secondaryStructureNames = {
+    { "Coil", "A-Helix", "B-Bridge", "B-Sheet", "3-Helix", "5-Helix", "Turn", "Bend" }
+};
+
+//! Coupling constant of the DSSP electrostatic hydrogen-bond energy (kcal/mol nm).
+constexpr real c_couplingConstant = -2.7888;
+//! Hydrogen-bond energy below which a pair is considered hydrogen bonded (kcal/mol).
+constexpr real c_maxHBondEnergy = -0.5;
+//! Lower bound for the hydrogen-bond energy (kcal/mol).
+constexpr real c_minHBondEnergy = -9.9;
+//! Atom distance below which the hydrogen-bond energy is set to the lower bound (nm).
+constexpr real c_minAtomDistance = 0.05;
+//! Longest C-N distance that is still considered a peptide bond (nm).
+constexpr real c_maxPeptideBondLength = 0.25;
+//! Length of the N-H bond for the hydrogens placed on the backbone (nm).
+constexpr real c_nhBondLength = 0.1;
+//! Smallest CA(i-2)-CA(i)-CA(i+2) bend angle assigned as a bend (degrees).
+constexpr real c_minBendAngle = 70;
+//! Shortest turn considered, in residues.
+constexpr int c_minTurnLength = 3;
+//! Longest turn considered, in residues.
+constexpr int c_maxTurnLength = 5;
+
+//! Backbone atom indices of a residue used in the assignment.
+struct BackboneResidue
+{
+    //! Index of the amide nitrogen.
+    int n = -1;
+    //! Index of the alpha carbon.
+    int ca = -1;
+    //! Index of the carbonyl carbon.
+    int c = -1;
+    //! Index of the carbonyl oxygen.
+    int o = -1;
+    //! Whether the residue is a proline, which has no amide hydrogen.
+    bool isProline = false;
+};
+
+//! Position of a residue within an n-turn.
+enum class TurnPosition : int
+{
+    None,
+    Start,
+    End,
+    StartAndEnd,
+    Middle
+};
+
+//! Type of a bridge between two residues.
+enum class BridgeType : int
+{
+    None,
+    Parallel,
+    Antiparallel
+};
+
+//! Hydrogen bond from the N-H of a residue to the C=O of another.
+struct HydrogenBond
+{
+    //! Index of the acceptor residue, or -1 if none.
+    int acceptor = -1;
+    //! Energy of the bond (kcal/mol).
+    real energy = 0;
+};
+
+//! Consecutive bridges between two strands, possibly linked over beta bulges.
+struct Ladder
+{
+    //! Type of the bridges in the ladder.
+    BridgeType type;
+    //! Residues on the first strand, in increasing order.
+    std::deque<int> i;
+    //! Residues on the second strand, in increasing order.
+    std::deque<int> j;
+};
+
+//! Calculates the vector from \p b to \p a, using PBC if given.
+void pbcDx(const t_pbc* pbc, const rvec a, const rvec b, rvec dx)
+{
+    if (pbc != nullptr)
+    {
+        pbc_dx(pbc, a, b, dx);
+    }
+    else
+    {
+        rvec_sub(a, b, dx);
+    }
+}
+
+//! Calculates the distance between \p a and \p b, using PBC if given.
+real pbcDistance(const t_pbc* pbc, const rvec a, const rvec b)
+{
+    rvec dx;
+    pbcDx(pbc, a, b, dx);
+    return norm(dx);
+}
+
+/*! \brief
+ * Assigns the secondary structure of a single frame.
+ *
+ * Implements the DSSP algorithm of Kabsch and Sander: backbone hydrogen
+ * bonds are identified from an electrostatic energy evaluated for residue
+ * pairs found with a neighborhood search on the alpha carbons, and the
+ * patterns of these bonds are used to assign turns, helices, bridges and
+ * strands.  All the memory is reused from frame to frame.
+ */
+class SecondaryStructureAssigner
+{
+public:
+    //! Reserves memory for \p residueCount residues.
+    explicit SecondaryStructureAssigner(int residueCount) :
+        n_(residueCount),
+        ca_(residueCount),
+        c_(residueCount),
+        o_(residueCount),
+        h_(residueCount),
+        chainBreakCount_(residueCount),
+        isBend_(residueCount),
+        hbonds_(residueCount),
+        turns_(residueCount),
+        ss_(residueCount)
+    {
+    }
+
+    /*! \brief
+     * Assigns the secondary structure for the residues in frame \p fr.
+     *
+     * \p nb is used for finding the residue pairs for which the
+     * hydrogen-bond energy is evaluated.
+     */
+    ArrayRef<const SecondaryStructure> assign(ArrayRef<const BackboneResidue> residues,
+                                              const t_trxframe&               fr,
+                                              const t_pbc*                    pbc,
+                                              AnalysisNeighborhood*           nb);
+
+private:
+    //! Collects the backbone positions and finds chain breaks and bends.
+    void initResidues(ArrayRef<const BackboneResidue> residues,
+                      const t_trxframe&               fr,
+                      const t_pbc*                    pbc);
+    //! Finds the two strongest hydrogen bonds for the N-H of each residue.
+    void calculateHydrogenBonds(ArrayRef<const BackboneResidue> residues,
+                                const t_pbc*                    pbc,
+                                AnalysisNeighborhood*           nb);
+    //! Returns the hydrogen-bond energy from N-H of \p donor to C=O of \p acceptor.
+    real hydrogenBondEnergy(const t_pbc* pbc, int donor, int acceptor) const;
+    //! Assigns bridges and strands.
+    void assignBridges();
+    //! Assigns turns and helices of all lengths.
+    void assignHelices();
+    //! Assigns turns and bends to residues not in any other structure.
+    void assignTurnsAndBends();
+    //! Returns the type of bridge between residues \p i and \p j.
+    BridgeType bridgeType(int i, int j) const;
+
+    //! Whether the N-H of \p donor is hydrogen bonded to the C=O of \p acceptor.
+    bool hasHBond(int donor, int acceptor) const
+    {
+        for (const HydrogenBond& hbond : hbonds_[donor])
+        {
+            if (hbond.acceptor == acceptor && hbond.energy < c_maxHBondEnergy)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    //! Whether residues from \p first to \p last are all linked by peptide bonds.
+    bool noChainBreak(int first, int last) const
+    {
+        return chainBreakCount_[first] == chainBreakCount_[last];
+    }
+    //! Whether an n-turn of length \p length starts at residue \p i.
+    bool isTurnStart(int i, int length) const
+    {
+        const TurnPosition position = turns_[i][length - c_minTurnLength];
+        return position == TurnPosition::Start || position == TurnPosition::StartAndEnd;
+    }
+    //! Number of residues.
+    int residueCount() const { return ssize(ss_); }
+
+    //! Backbone positions of each residue.
+    std::vector<RVec> n_, ca_, c_, o_, h_;
+    //! Number of chain breaks before each residue, for checking chain continuity.
+    std::vector<int> chainBreakCount_;
+    //! Whether the chain is bent at each residue.
+    std::vector<bool> isBend_;
+    //! Two strongest hydrogen bonds with the N-H of each residue as the donor.
+    std::vector<std::array<HydrogenBond, 2>> hbonds_;
+    //! Position of each residue in n-turns of each length.
+    std::vector<std::array<TurnPosition, c_maxTurnLength - c_minTurnLength + 1>> turns_;
+    //! Ladders found in the current frame.
+    std::vector<Ladder> ladders_;
+    //! Assigned secondary structure of each residue.
+    std::vector<SecondaryStructure> ss_;
+};
+
+void SecondaryStructureAssigner::initResidues(ArrayRef<const BackboneResidue> residues,
+                                              const t_trxframe&               fr,
+                                              const t_pbc*                    pbc)
+{
+    for (int i = 0; i < residueCount(); ++i)
+    {
+        copy_rvec(fr.x[residues[i].n], n_[i]);
+        copy_rvec(fr.x[residues[i].ca], ca_[i]);
+        copy_rvec(fr.x[residues[i].c], c_[i]);
+        copy_rvec(fr.x[residues[i].o], o_[i]);
+    }
+    // The amide hydrogen is placed along the C=O direction of the previous
+    // residue, as in DSSP, so that the hydrogens in the topology do not
+    // matter.  Residues without a preceding peptide bond get H on N.
+    for (int i = 0; i < residueCount(); ++i)
+    {
+        const bool isBreak =
+                (i == 0 || pbcDistance(pbc, c_[i - 1], n_[i]) > c_maxPeptideBondLength);
+        chainBreakCount_[i] = (i == 0 ? 0 : chainBreakCount_[i - 1]) + (isBreak ? 1 : 0);
+        copy_rvec(n_[i], h_[i]);
+        if (!isBreak)
+        {
+            rvec co;
+            pbcDx(pbc, c_[i - 1], o_[i - 1], co);
+            unitv(co, co);
+            svmul(c_nhBondLength, co, co);
+            rvec_inc(h_[i], co);
+        }
+    }
+    for (int i = 0; i < residueCount(); ++i)
+    {
+        isBend_[i] = false;
+        if (i >= 2 && i + 2 < residueCount() && noChainBreak(i - 2, i + 2))
+        {
+            rvec before, after;
+            pbcDx(pbc, ca_[i], ca_[i - 2], before);
+            pbcDx(pbc, ca_[i + 2], ca_[i], after);
+            isBend_[i] = gmx_angle(before, after) * RAD2DEG > c_minBendAngle;
+        }
+    }
+}
+
+real SecondaryStructureAssigner::hydrogenBondEnergy(const t_pbc* pbc, int donor, int acceptor) const
+{
+    const real rON = pbcDistance(pbc, o_[acceptor], n_[donor]);
+    const real rCH = pbcDistance(pbc, c_[acceptor], h_[donor]);
+    const real rOH = pbcDistance(pbc, o_[acceptor], h_[donor]);
+    const real rCN = pbcDistance(pbc, c_[acceptor], n_[donor]);
+    if (std::min({ rON, rCH, rOH, rCN }) < c_minAtomDistance)
+    {
+        return c_minHBondEnergy;
+    }
+    const real energy = c_couplingConstant * (1 / rOH - 1 / rCH + 1 / rCN - 1 / rON);
+    return std::max(energy, c_minHBondEnergy);
+}
+
+void SecondaryStructureAssigner::calculateHydrogenBonds(ArrayRef<const BackboneResidue> residues,
+                                                        const t_pbc*                    pbc,
+                                                        AnalysisNeighborhood*           nb)
+{
+    std::fill(hbonds_.begin(), hbonds_.end(), std::array<HydrogenBond, 2>());
+    AnalysisNeighborhoodSearch     nbsearch   = nb->initSearch(pbc, ca_);
+    AnalysisNeighborhoodPairSearch pairSearch = nbsearch.startPairSearch(ca_);
+    AnalysisNeighborhoodPair       pair;
+    while (pairSearch.findNextPair(&pair))
+    {
+        const int donor    = pair.testIndex();
+        const int acceptor = pair.refIndex();
+        // As in DSSP, the N-H of a residue is never bonded to the C=O of the
+        // residue preceding it.
+        if (donor == acceptor || donor == acceptor + 1 || residues[donor].isProline)
+        {
+            continue;
+        }
+        const real                   energy = hydrogenBondEnergy(pbc, donor, acceptor);
+        std::array<HydrogenBond, 2>& hbonds = hbonds_[donor];
+        if (energy < hbonds[0].energy)
+        {
+            hbonds[1] = hbonds[0];
+            hbonds[0] = { acceptor, energy };
+        }
+        else if (energy < hbonds[1].energy)
+        {
+            hbonds[1] = { acceptor, energy };
+        }
+    }
+}
+
+BridgeType SecondaryStructureAssigner::bridgeType(int i, int j) const
+{
+    if (i < 1 || j < 1 || i + 1 >= residueCount() || j + 1 >= residueCount()
+        || !noChainBreak(i - 1, i + 1) || !noChainBreak(j - 1, j + 1))
+    {
+        return BridgeType::None;
+    }
+    if ((hasHBond(i + 1, j) && hasHBond(j, i - 1)) || (hasHBond(j + 1, i) && hasHBond(i, j - 1)))
+    {
+        return BridgeType::Parallel;
+    }
+    if ((hasHBond(i + 1, j - 1) && hasHBond(j + 1, i - 1)) || (hasHBond(j, i) && hasHBond(i, j)))
+    {
+        return BridgeType::Antiparallel;
+    }
+    return BridgeType::None;
+}
+
+void SecondaryStructureAssigner::assignBridges()
+{
+    ladders_.clear();
+    std::vector<int> partners;
+    for (int i = 1; i + 4 < residueCount(); ++i)
+    {
+        // Every bridge pattern contains a bond from i or i+1 to j or j-1,
+        // so only the acceptors of these two residues need to be tested
+        // instead of all the other residues.
+        partners.clear();
+        for (int donor = i; donor <= i + 1; ++donor)
+        {
+            for (const HydrogenBond& hbond : hbonds_[donor])
+            {
+                if (hbond.acceptor >= 0 && hbond.energy < c_maxHBondEnergy)
+                {
+                    partners.push_back(hbond.acceptor);
+                    partners.push_back(hbond.acceptor + 1);
+                }
+            }
+        }
+        std::sort(partners.begin(), partners.end());
+        partners.erase(std::unique(partners.begin(), partners.end()), partners.end());
+        for (const int j : partners)
+        {
+            if (j < i + 3 || j + 1 >= residueCount())
+            {
+                continue;
+            }
+            const BridgeType type = bridgeType(i, j);
+            if (type == BridgeType::None)
+            {
+                continue;
+            }
+            bool bFound = false;
+            for (Ladder& ladder : ladders_)
+            {
+                if (ladder.type != type || ladder.i.back() + 1 != i)
+                {
+                    continue;
+                }
+                if (type == BridgeType::Parallel && ladder.j.back() + 1 == j)
+                {
+                    ladder.i.push_back(i);
+                    ladder.j.push_back(j);
+                    bFound = true;
+                    break;
+                }
+                if (type == BridgeType::Antiparallel && ladder.j.front() - 1 == j)
+                {
+                    ladder.i.push_back(i);
+                    ladder.j.push_front(j);
+                    bFound = true;
+                    break;
+                }
+            }
+            if (!bFound)
+            {
+                ladders_.push_back({ type, { i }, { j } });
+            }
+        }
+    }
+
+    // Link ladders of the same type that are separated by a beta bulge.
+    // The ladders are already sorted by their first residue.
+    for (size_t l1 = 0; l1 < ladders_.size(); ++l1)
+    {
+        for (size_t l2 = l1 + 1; l2 < ladders_.size(); ++l2)
+        {
+            Ladder&   first  = ladders_[l1];
+            Ladder&   second = ladders_[l2];
+            const int ibi    = first.i.front();
+            const int iei    = first.i.back();
+            const int jbi    = first.j.front();
+            const int jei    = first.j.back();
+            const int ibj    = second.i.front();
+            const int iej    = second.i.back();
+            const int jbj    = second.j.front();
+            const int jej    = second.j.back();
+            if (first.type != second.type || !noChainBreak(std::min(ibi, ibj), std::max(iei, iej))
+                || !noChainBreak(std::min(jbi, jbj), std::max(jei, jej)) || ibj < iei
+                || ibj - iei >= 6 || (iei >= ibj && ibi <= iej))
+            {
+                continue;
+            }
+            const int  gap = (first.type == BridgeType::Parallel ? jbj - jei : jbi - jej);
+            const bool bBulge = gap >= 0 && ((gap < 6 && ibj - iei < 3) || gap < 3);
+            if (bBulge)
+            {
+                first.i.insert(first.i.end(), second.i.begin(), second.i.end());
+                if (first.type == BridgeType::Parallel)
+                {
+                    first.j.insert(first.j.end(), second.j.begin(), second.j.end());
+                }
+                else
+                {
+                    first.j.insert(first.j.begin(), second.j.begin(), second.j.end());
+                }
+                ladders_.erase(ladders_.begin() + l2);
+                --l2;
+            }
+        }
+    }
+
+    for (const Ladder& ladder : ladders_)
+    {
+        const SecondaryStructure type =
+                (ladder.i.size() > 1 ? SecondaryStructure::Strand : SecondaryStructure::Bridge);
+        for (const std::deque<int>* strand : { &ladder.i, &ladder.j })
+        {
+            for (int k = strand->front(); k <= strand->back(); ++k)
+            {
+                if (ss_[k] != SecondaryStructure::Strand)
+                {
+                    ss_[k] = type;
+                }
+            }
+        }
+    }
+}
+
+void SecondaryStructureAssigner::assignHelices()
+{
+    for (auto& turn : turns_)
+    {
+        turn.fill(TurnPosition::None);
+    }
+    for (int length = c_minTurnLength; length <= c_maxTurnLength; ++length)
+    {
+        const int index = length - c_minTurnLength;
+        for (int i = 0; i + length < residueCount(); ++i)
+        {
+            if (noChainBreak(i, i + length) && hasHBond(i + length, i))
+            {
+                turns_[i + length][index] = TurnPosition::End;
+                for (int j = i + 1; j < i + length; ++j)
+                {
+                    if (turns_[j][index] == TurnPosition::None)
+                    {
+                        turns_[j][index] = TurnPosition::Middle;
+                    }
+                }
+                turns_[i][index] = (turns_[i][index] == TurnPosition::End
+                                            ? TurnPosition::StartAndEnd
+                                            : TurnPosition::Start);
+            }
+        }
+    }
+
+    // Two consecutive 4-turns make an alpha helix, which overrides
+    // everything else.  3-10 and pi helices are only assigned to residues
+    // that are not yet in any other structure.
+    const std::array<std::pair<int, SecondaryStructure>, 3> helices = {
+        { { 4, SecondaryStructure::AlphaHelix },
+          { 3, SecondaryStructure::Helix310 },
+          { 5, SecondaryStructure::PiHelix } }
+    };
+    for (const auto& helix : helices)
+    {
+        const int length = helix.first;
+        for (int i = 1; i + length < residueCount(); ++i)
+        {
+            if (!isTurnStart(i, length) || !isTurnStart(i - 1, length))
+            {
+                continue;
+            }
+            bool bEmpty = true;
+            if (helix.second != SecondaryStructure::AlphaHelix)
+            {
+                for (int j = i; j < i + length; ++j)
+                {
+                    bEmpty = bEmpty
+                             && (ss_[j] == SecondaryStructure::Loop || ss_[j] == helix.second);
+                }
+            }
+            if (bEmpty)
+            {
+                std::fill(ss_.begin() + i, ss_.begin() + i + length, helix.second);
+            }
+        }
+    }
+}
+
+void SecondaryStructureAssigner::assignTurnsAndBends()
+{
+    for (int i = 1; i + 1 < residueCount(); ++i)
+    {
+        if (ss_[i] != SecondaryStructure::Loop)
+        {
+            continue;
+        }
+        bool bTurn = false;
+        for (int length = c_minTurnLength; length <= c_maxTurnLength && !bTurn; ++length)
+        {
+            for (int k = 1; k < length && !bTurn; ++k)
+            {
+                bTurn = (i >= k && isTurnStart(i - k, length));
+            }
+        }
+        if (bTurn)
+        {
+            ss_[i] = SecondaryStructure::Turn;
+        }
+        else if (isBend_[i])
+        {
+            ss_[i] = SecondaryStructure::Bend;
+        }
+    }
+}
+
+ArrayRef<const SecondaryStructure>
+SecondaryStructureAssigner::assign(ArrayRef<const BackboneResidue> residues,
+                                   const t_trxframe&               fr,
+                                   const t_pbc*                    pbc,
+                                   AnalysisNeighborhood*           nb)
+{
+    std::fill(ss_.begin(), ss_.end(), SecondaryStructure::Loop);
+    initResidues(residues, fr, pbc);
+    calculateHydrogenBonds(residues, pbc, nb);
+    assignBridges();
+    assignHelices();
+    assignTurnsAndBends();
+    return ss_;
+}
+
+/*! \internal \brief
+ * Data module for writing the secondary structure of each frame as a line.
+ *
+ * Each column of the input data is written as the character it contains.
+ */
+class SecondaryStructureWriterModule : public AnalysisDataModuleSerial
+{
+public:
+    ~SecondaryStructureWriterModule() override { closeFile(); }
+
+    //! Sets the file name to write the secondary structure to.
+    void setFileName(const std::string& fnm) { fnm_ = fnm; }
+
+    int flags() const override { return efAllowMulticolumn; }
+
+    void dataStarted(AbstractAnalysisData* /*data*/) override
+    {
+        if (!fnm_.empty())
+        {
+            fp_ = gmx_fio_fopen(fnm_.c_str(), "w");
+        }
+    }
+    void frameStarted(const AnalysisDataFrameHeader& /*header*/) override { line_.clear(); }
+    void pointsAdded(const AnalysisDataPointSetRef& points) override
+    {
+        for (int i = 0; i < points.columnCount(); ++i)
+        {
+            line_.push_back(static_cast<char>(points.y(i)));
+        }
+    }
+    void frameFinished(const AnalysisDataFrameHeader& /*header*/) override
+    {
+        if (fp_ != nullptr)
+        {
+            std::fprintf(fp_, "%s\n", line_.c_str());
+        }
+    }
+    void dataFinished() override { closeFile(); }
+
+private:
+    void closeFile()
+    {
+        if (fp_ != nullptr)
+        {
+            gmx_fio_fclose(fp_);
+            fp_ = nullptr;
+        }
+    }
+
+    std::string fnm_;
+    FILE*       fp_ = nullptr;
+    //! Secondary structure string of the current frame.
+    std::string line_;
+};
+
+/*! \brief
+ * Implements `gmx dssp` trajectory analysis module.
+ */
+class Dssp : public TrajectoryAnalysisModule
+{
+public:
+    Dssp();
+
+    void initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings* settings) override;
+    void initAnalysis(const TrajectoryAnalysisSettings& settings, const TopologyInformation& top) override;
+
+    TrajectoryAnalysisModuleDataPointer startFrames(const AnalysisDataParallelOptions& opt,
+                                                    const SelectionCollection& selections) override;
+    void                                analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAnalysisModuleData* pdata) override;
+
+    void finishAnalysis(int nframes) override;
+    void writeOutput() override;
+
+private:
+    Selection   sel_;
+    std::string fnSecondaryStructure_;
+    std::string fnCount_;
+    double      cutoff_;
+
+    //! Backbone atoms of the residues in `sel_`.
+    std::vector<BackboneResidue> residues_;
+    //! Secondary structure code of each residue as a function of time.
+    AnalysisData secondaryStructure_;
+    //! Number of residues in each secondary structure as a function of time.
+    AnalysisData counts_;
+    //! Neighborhood search for residue pairs that may be hydrogen bonded.
+    AnalysisNeighborhood nb_;
+
+    // Copy and assign disallowed by base.
+};
+
+Dssp::Dssp() : cutoff_(0.9)
+{
+    registerAnalysisDataset(&secondaryStructure_, "ss");
+    registerAnalysisDataset(&counts_, "num");
+}
+
+
+void Dssp::initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings* settings)
+{
+    static const char* const desc[] = {
+        "[THISMODULE] assigns the secondary structure of the protein residues",
+        "in [TT]-sel[tt] for each frame with the DSSP algorithm of Kabsch and",
+        "Sander. Unlike [gmx-do_dssp], it does not need the external DSSP",
+        "program, and the frames can be analyzed in parallel.[PAR]",
+        "Residues are taken into account if the selection contains their",
+        "backbone atoms N, CA, C and O (OC1 or OT1 for the C terminus).",
+        "The amide hydrogens are placed from the backbone geometry as in",
+        "DSSP. Hydrogen bonds are only evaluated for residues whose CA atoms",
+        "are closer than [TT]-cutoff[tt].[PAR]",
+        "The secondary structure of each frame is written to [TT]-o[tt] as a",
+        "line with one character per residue: H (alpha helix),",
+        "B (isolated bridge), E (strand), G (3-10 helix), I (pi helix),",
+        "T (turn), S (bend) or ~ (coil).",
+        "The number of residues in each type of secondary structure is",
+        "written to [TT]-num[tt] as a function of time."
+    };
+
+    settings->setHelpText(desc);
+    settings->setFlag(TrajectoryAnalysisSettings::efRequireTop);
+    settings->setFlag(TrajectoryAnalysisSettings::efAllowFrameParallel);
+
+    options->addOption(FileNameOption("o")
+                               .filetype(eftGenericData)
+                               .outputFile()
+                               .store(&fnSecondaryStructure_)
+                               .defaultBasename("dssp")
+                               .description("Secondary structure for each frame"));
+    options->addOption(FileNameOption("num")
+                               .filetype(eftPlot)
+                               .outputFile()
+                               .store(&fnCount_)
+                               .defaultBasename("num")
+                               .description("Number of residues in each secondary structure"));
+
+    options->addOption(DoubleOption("cutoff").store(&cutoff_).description(
+            "CA distance cutoff for hydrogen bonds (nm)"));
+
+    options->addOption(SelectionOption("sel")
+                               .store(&sel_)
+                               .onlySortedAtoms()
+                               .onlyStatic()
+                               .defaultSelectionText("group \"Protein\"")
+                               .description("Residues to assign secondary structure for"));
+}
+
+
+void Dssp::initAnalysis(const TrajectoryAnalysisSettings& settings, const TopologyInformation& top)
+{
+    // Look up the names through the molecule types, without the atoms of the whole system
+    const gmx_mtop_t*   mtop    = top.mtop();
+    ArrayRef<const int> indices = sel_.atomIndices();
+    int                 molb    = 0;
+    for (size_t k = 0; k < indices.size();)
+    {
+        const char* residueName;
+        int         resind;
+        mtopGetAtomAndResidueName(mtop, indices[k], &molb, nullptr, nullptr, &residueName, &resind);
+        BackboneResidue residue;
+        residue.isProline = (std::strcmp(residueName, "PRO") == 0);
+        for (; k < indices.size(); ++k)
+        {
+            const int   index = indices[k];
+            const char* name;
+            int         atomResind;
+            mtopGetAtomAndResidueName(mtop, index, &molb, &name, nullptr, nullptr, &atomResind);
+            if (atomResind != resind)
+            {
+                break;
+            }
+            if (std::strcmp(name, "N") == 0)
+            {
+                residue.n = index;
+            }
+            else if (std::strcmp(name, "CA") == 0)
+            {
+                residue.ca = index;
+            }
+            else if (std::strcmp(name, "C") == 0)
+            {
+                residue.c = index;
+            }
+            else if (std::strcmp(name, "O") == 0
+                     || (residue.o < 0
+                         && (std::strcmp(name, "OC1") == 0 || std::strcmp(name, "OT1") == 0)))
+            {
+                residue.o = index;
+            }
+        }
+        if (residue.n >= 0 && residue.ca >= 0 && residue.c >= 0 && residue.o >= 0)
+        {
+            residues_.push_back(residue);
+        }
+    }
+    if (residues_.empty())
+    {
+        GMX_THROW(InconsistentInputError(
+                "Selection does not contain the backbone atoms of any protein residue"));
+    }
+
+    secondaryStructure_.setColumnCount(0, residues_.size());
+    if (!fnSecondaryStructure_.empty())
+    {
+        auto writer = std::make_shared<SecondaryStructureWriterModule>();
+        writer->setFileName(fnSecondaryStructure_);
+        secondaryStructure_.addModule(writer);
+    }
+
+    counts_.setColumnCount(0, static_cast<int>(SecondaryStructure::Count));
+    if (!fnCount_.empty())
+    {
+        AnalysisDataPlotModulePointer plotm(new AnalysisDataPlotModule(settings.plotSettings()));
+        plotm->setFileName(fnCount_);
+        plotm->setTitle("Secondary structure");
+        plotm->setXAxisIsTime();
+        plotm->setYLabel("Number of residues");
+        for (const char* name : c_secondaryStructureNames)
+        {
+            plotm->appendLegend(name);
+        }
+        counts_.addModule(plotm);
+    }
+
+    nb_.setCutoff(cutoff_);
+}
+
+/*! \brief
+ * Temporary memory for use within a single-frame calculation.
+ */
+class DsspModuleData : public TrajectoryAnalysisModuleData
+{
+public:
+    /*! \brief
+     * Reserves memory for the frame-local data.
+     */
+    DsspModuleData(TrajectoryAnalysisModule*          module,
+                   const AnalysisDataParallelOptions& opt,
+                   const SelectionCollection&         selections,
+                   int                                residueCount) :
+        TrajectoryAnalysisModuleData(module, opt, selections),
+        assigner_(residueCount)
+    {
+    }
+
+    void finish() override { finishDataHandles(); }
+
+    //! Secondary structure assignment for the frame.
+    SecondaryStructureAssigner assigner_;
+};
+
+TrajectoryAnalysisModuleDataPointer Dssp::startFrames(const AnalysisDataParallelOptions& opt,
+                                                      const SelectionCollection&         selections)
+{
+    return TrajectoryAnalysisModuleDataPointer(
+            new DsspModuleData(this, opt, selections, residues_.size()));
+}
+
+void Dssp::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAnalysisModuleData* pdata)
+{
+    AnalysisDataHandle ssHandle    = pdata->dataHandle(secondaryStructure_);
+    AnalysisDataHandle countHandle = pdata->dataHandle(counts_);
+    DsspModuleData&    frameData   = *static_cast<DsspModuleData*>(pdata);
+
+    ArrayRef<const SecondaryStructure> ss = frameData.assigner_.assign(residues_, fr, pbc, &nb_);
+
+    EnumerationArray<SecondaryStructure, int> counts = { { 0 } };
+    ssHandle.startFrame(frnr, fr.time);
+    for (size_t i = 0; i < ss.size(); ++i)
+    {
+        ssHandle.setPoint(i, c_secondaryStructureCodes[ss[i]]);
+        ++counts[ss[i]];
+    }
+    ssHandle.finishFrame();
+
+    countHandle.startFrame(frnr, fr.time);
+    for (const SecondaryStructure type : keysOf(counts))
+    {
+        countHandle.setPoint(static_cast<int>(type), counts[type]);
+    }
+    countHandle.finishFrame();
+}
+
+void Dssp::finishAnalysis(int /*nframes*/) {}
+
+void Dssp::writeOutput() {}
+
+//! \}
+
+} // namespace
+
+const char DsspInfo::name[]             = "dssp";
+const char DsspInfo::shortDescription[] = "Assign secondary structure without external programs";
+
+TrajectoryAnalysisModulePointer DsspInfo::create()
+{
+    return TrajectoryAnalysisModulePointer(new Dssp);
+}
+
+} // namespace analysismodules
+
+} // namespace gmx
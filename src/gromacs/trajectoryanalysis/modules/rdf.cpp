@@ -157,9 +157,10 @@ private:
     /*! \brief
      * Raw pairwise distance data from which the RDF is computed.
      *
-     * There is a data set for each selection in `sel_`, with a single
-     * column.  Each point set will contain a single pairwise distance
-     * that contributes to the RDF.
+     * There is a data set for each selection in `sel_`, with two
+     * columns.  The pairwise distances are binned locally for each frame,
+     * and each point set contains the center of a non-empty bin and the
+     * number of pairs that fell into that bin.
      */
     AnalysisData pairDist_;
     /*! \brief
@@ -174,11 +175,12 @@ private:
     /*! \brief
      * Histogram module that computes the actual RDF from `pairDist_`.
      *
-     * The per-frame histograms are raw pair counts in each bin;
+     * The per-frame histograms are raw pair counts in each bin, accumulated
+     * as weights from the locally binned counts in `pairDist_`;
      * the averager is normalized by the average number of reference
      * positions (average of the first column of `normFactors_`).
      */
-    AnalysisDataSimpleHistogramModulePointer pairCounts_;
+    AnalysisDataWeightedHistogramModulePointer pairCounts_;
     /*! \brief
      * Average normalization factors.
      */
@@ -207,7 +209,7 @@ private:
 
 Rdf::Rdf() :
     surface_(SurfaceType::None),
-    pairCounts_(new AnalysisDataSimpleHistogramModule()),
+    pairCounts_(new AnalysisDataWeightedHistogramModule()),
     normAve_(new AnalysisDataAverageModule()),
     localTop_(nullptr),
     binwidth_(0.002),
@@ -284,6 +286,7 @@ void Rdf::initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings* se
     };
 
     settings->setHelpText(desc);
+    settings->setFlag(TrajectoryAnalysisSettings::efAllowFrameParallel);
 
     options->addOption(FileNameOption("o")
                                .filetype(eftPlot)
@@ -356,7 +359,7 @@ void Rdf::initAnalysis(const TrajectoryAnalysisSettings& settings, const Topolog
     pairDist_.setDataSetCount(sel_.size());
     for (size_t i = 0; i < sel_.size(); ++i)
     {
-        pairDist_.setColumnCount(i, 1);
+        pairDist_.setColumnCount(i, 2);
     }
     plotSettings_ = settings.plotSettings();
     nb_.setXYMode(bXY_);
@@ -446,10 +449,12 @@ public:
     RdfModuleData(TrajectoryAnalysisModule*          module,
                   const AnalysisDataParallelOptions& opt,
                   const SelectionCollection&         selections,
-                  int                                surfaceGroupCount) :
+                  int                                surfaceGroupCount,
+                  int                                binCount) :
         TrajectoryAnalysisModuleData(module, opt, selections)
     {
         surfaceDist2_.resize(surfaceGroupCount);
+        binCounts_.resize(binCount);
     }
 
     void finish() override { finishDataHandles(); }
@@ -466,22 +471,33 @@ public:
      * the RDF from these numbers.
      */
     std::vector<real> surfaceDist2_;
+    /*! \brief
+     * Pair counts in each histogram bin for the current selection.
+     *
+     * Binning the distances here and only passing the non-empty bins to
+     * the data handle avoids the per-pair notification overhead (and
+     * the locking in frame-parallel analysis) of the histogram module.
+     */
+    std::vector<int64_t> binCounts_;
 };
 
 TrajectoryAnalysisModuleDataPointer Rdf::startFrames(const AnalysisDataParallelOptions& opt,
                                                      const SelectionCollection&         selections)
 {
-    return TrajectoryAnalysisModuleDataPointer(new RdfModuleData(this, opt, selections, surfaceGroupCount_));
+    return TrajectoryAnalysisModuleDataPointer(new RdfModuleData(
+            this, opt, selections, surfaceGroupCount_, pairCounts_->settings().binCount()));
 }
 
 void Rdf::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAnalysisModuleData* pdata)
 {
-    AnalysisDataHandle   dh        = pdata->dataHandle(pairDist_);
-    AnalysisDataHandle   nh        = pdata->dataHandle(normFactors_);
-    const Selection&     refSel    = TrajectoryAnalysisModuleData::parallelSelection(refSel_);
-    const SelectionList& sel       = TrajectoryAnalysisModuleData::parallelSelections(sel_);
-    RdfModuleData&       frameData = *static_cast<RdfModuleData*>(pdata);
-    const bool           bSurface  = !frameData.surfaceDist2_.empty();
+    AnalysisDataHandle               dh        = pdata->dataHandle(pairDist_);
+    AnalysisDataHandle               nh        = pdata->dataHandle(normFactors_);
+    const Selection&                 refSel    = pdata->parallelSelection(refSel_);
+    const SelectionList&             sel       = pdata->parallelSelections(sel_);
+    RdfModuleData&                   frameData = *static_cast<RdfModuleData*>(pdata);
+    const bool                       bSurface  = !frameData.surfaceDist2_.empty();
+    std::vector<int64_t>&            binCounts = frameData.binCounts_;
+    const AnalysisHistogramSettings& histogram = pairCounts_->settings();
 
     matrix boxForVolume;
     copy_mat(fr.box, boxForVolume);
@@ -530,6 +546,7 @@ void Rdf::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAna
     for (size_t g = 0; g < sel.size(); ++g)
     {
         dh.selectDataSet(g);
+        std::fill(binCounts.begin(), binCounts.end(), 0);
 
         if (bSurface)
         {
@@ -560,8 +577,11 @@ void Rdf::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAna
                     // surface positions.
                     if (r2 > cut2_ && r2 <= rmax2_)
                     {
-                        dh.setPoint(0, std::sqrt(r2));
-                        dh.finishPointSet();
+                        const int bin = histogram.findBin(std::sqrt(r2));
+                        if (bin != -1)
+                        {
+                            ++binCounts[bin];
+                        }
                     }
                 }
             }
@@ -577,13 +597,27 @@ void Rdf::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAna
                 const real r2 = pair.distance2();
                 if (r2 > cut2_)
                 {
-                    // TODO: Consider whether the histogramming could be done with
-                    // less overhead (after first measuring the overhead).
-                    dh.setPoint(0, std::sqrt(r2));
-                    dh.finishPointSet();
+                    const int bin = histogram.findBin(std::sqrt(r2));
+                    if (bin != -1)
+                    {
+                        ++binCounts[bin];
+                    }
                 }
             }
         }
+        // Pass the non-empty bins on as (bin center, count) pairs.  Counts are
+        // split such that each weight is exactly representable as a real.
+        const int64_t maxWeight = int64_t(1) << std::numeric_limits<real>::digits;
+        for (size_t bin = 0; bin < binCounts.size(); ++bin)
+        {
+            const real binCenter = histogram.firstEdge() + (bin + 0.5) * histogram.binWidth();
+            for (int64_t count = binCounts[bin]; count > 0; count -= maxWeight)
+            {
+                dh.setPoint(0, binCenter);
+                dh.setPoint(1, std::min(count, maxWeight));
+                dh.finishPointSet();
+            }
+        }
         // Normalization factor for the number density (only used without
         // -surf, but does not hurt to populate otherwise).
         nh.setPoint(g + 1, sel[g].posCount() * inverseVolume);
@@ -66,6 +66,7 @@
 #include "gromacs/options/ioptionscontainer.h"
 #include "gromacs/selection/selection.h"
 #include "gromacs/selection/selectionoption.h"
+#include "gromacs/topology/mtop_lookup.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/trajectoryanalysis/analysissettings.h"
@@ -626,7 +627,7 @@ void Select::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* /* pbc */, Traj
     AnalysisDataHandle   cdh = pdata->dataHandle(cdata_);
     AnalysisDataHandle   idh = pdata->dataHandle(idata_);
     AnalysisDataHandle   mdh = pdata->dataHandle(mdata_);
-    const SelectionList& sel = TrajectoryAnalysisModuleData::parallelSelections(sel_);
+    const SelectionList& sel = pdata->parallelSelections(sel_);
 
     sdh.startFrame(frnr, fr.time);
     for (size_t g = 0; g < sel.size(); ++g)
@@ -648,6 +649,7 @@ void Select::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* /* pbc */, Traj
     cdh.finishFrame();
 
     idh.startFrame(frnr, fr.time);
+    int molb = 0;
     for (size_t g = 0; g < sel.size(); ++g)
     {
         idh.setPoint(0, sel[g].posCount());
@@ -657,7 +659,11 @@ void Select::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* /* pbc */, Traj
             const SelectionPosition& p = sel[g].position(i);
             if (sel[g].type() == INDEX_RES && !bResInd_)
             {
-                idh.setPoint(1, top_->atoms()->resinfo[p.mappedId()].nr);
+                // Look up the residue number through an atom of the residue
+                int residueNumber;
+                mtopGetAtomAndResidueName(top_->mtop(), p.atomIndices()[0], &molb, nullptr,
+                                          &residueNumber, nullptr, nullptr);
+                idh.setPoint(1, residueNumber);
             }
             else
             {
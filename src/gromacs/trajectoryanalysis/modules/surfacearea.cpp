@@ -45,6 +45,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <numeric>
 #include <vector>
 
 #include "gromacs/math/functions.h"
@@ -650,7 +651,9 @@ static void nsc_dclm_pbc(const rvec*                 coords,
     pos.indexed(constArrayRefFromArray(index, nat));
     AnalysisNeighborhoodSearch nbsearch(nb->initSearch(pbc, pos));
 
-    std::vector<int> wkdot(n_dot);
+    // Indices of the surface dots of the current atom that are not yet
+    // covered by any neighbor, in increasing order.
+    std::vector<int> freeDots(n_dot);
 
     for (int i = 0; i < nat; ++i)
     {
@@ -659,7 +662,7 @@ static void nsc_dclm_pbc(const rvec*                 coords,
         const real                     aisq = ai * ai;
         AnalysisNeighborhoodPairSearch pairSearch(nbsearch.startPairSearch(coords[iat]));
         AnalysisNeighborhoodPair       pair;
-        std::fill(wkdot.begin(), wkdot.end(), 1);
+        std::iota(freeDots.begin(), freeDots.end(), 0);
         int currDotCount = n_dot;
         while (currDotCount > 0 && pairSearch.findNextPair(&pair))
         {
@@ -672,26 +675,19 @@ static void nsc_dclm_pbc(const rvec*                 coords,
             }
             const rvec& dx     = pair.dx();
             const real  refdot = (d2 + aisq - aj * aj) / (2 * ai);
-            // TODO: Consider whether micro-optimizations from the old
-            // implementation would be useful, compared to the complexity that
-            // they bring: instead of this direct loop, the neighbors were
-            // stored into a temporary array, the loop order was
-            // reversed (first over dots, then over neighbors), and for each
-            // dot, it was first checked whether the same neighbor that
-            // resulted in marking the previous dot covered would also cover
-            // this dot. This presumably plays together with sorting of the
-            // surface dots (done in make_unsp) to avoid some of the looping.
-            // Alternatively, we could keep a skip list here to avoid
-            // repeatedly looping over dots that have already marked as
-            // covered.
-            for (int j = 0; j < n_dot; ++j)
+            // Only loop over the dots that are still free, and remove the
+            // ones covered by this neighbor from the list.  The list is
+            // compacted in place, so it stays sorted.
+            int freeCount = 0;
+            for (int k = 0; k < currDotCount; ++k)
             {
-                if (wkdot[j] && iprod(&xus[3 * j], dx) > refdot)
+                const int j = freeDots[k];
+                if (iprod(&xus[3 * j], dx) <= refdot)
                 {
-                    --currDotCount;
-                    wkdot[j] = 0;
+                    freeDots[freeCount++] = j;
                 }
             }
+            currDotCount = freeCount;
         }
 
         const real a = aisq * dotarea * currDotCount;
@@ -705,33 +701,29 @@ static void nsc_dclm_pbc(const rvec*                 coords,
         const real zi = coords[iat][ZZ];
         if (mode & FLAG_DOTS)
         {
-            for (int l = 0; l < n_dot; l++)
+            for (int k = 0; k < currDotCount; k++)
             {
-                if (wkdot[l])
+                const int l = freeDots[k];
+                lfnr++;
+                if (maxdots <= 3 * lfnr + 1)
                 {
-                    lfnr++;
-                    if (maxdots <= 3 * lfnr + 1)
-                    {
-                        maxdots = maxdots + n_dot * 3;
-                        srenew(dots, maxdots);
-                    }
-                    dots[3 * lfnr - 3] = ai * xus[3 * l] + xi;
-                    dots[3 * lfnr - 2] = ai * xus[1 + 3 * l] + yi;
-                    dots[3 * lfnr - 1] = ai * xus[2 + 3 * l] + zi;
+                    maxdots = maxdots + n_dot * 3;
+                    srenew(dots, maxdots);
                 }
+                dots[3 * lfnr - 3] = ai * xus[3 * l] + xi;
+                dots[3 * lfnr - 2] = ai * xus[1 + 3 * l] + yi;
+                dots[3 * lfnr - 1] = ai * xus[2 + 3 * l] + zi;
             }
         }
         if (mode & FLAG_VOLUME)
         {
             real dx = 0.0, dy = 0.0, dz = 0.0;
-            for (int l = 0; l < n_dot; l++)
+            for (int k = 0; k < currDotCount; k++)
             {
-                if (wkdot[l])
-                {
-                    dx = dx + xus[3 * l];
-                    dy = dy + xus[1 + 3 * l];
-                    dz = dz + xus[2 + 3 * l];
-                }
+                const int l = freeDots[k];
+                dx          = dx + xus[3 * l];
+                dy          = dy + xus[1 + 3 * l];
+                dz          = dz + xus[2 + 3 * l];
             }
             vol = vol + aisq * (dx * (xi - xs) + dy * (yi - ys) + dz * (zi - zs) + ai * currDotCount);
         }
@@ -212,6 +212,9 @@ void TrajectoryAnalysisRunnerCommon::Impl::initFirstFrame()
 
     int frflags = settings_.frflags();
     frflags |= TRX_NEED_X;
+    // The trajectory is only read through read_next_frame(), so frames can
+    // be decoded ahead in parallel.
+    frflags |= TRX_PREFETCH;
 
     snew(fr, 1);
 
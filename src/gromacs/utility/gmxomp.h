@@ -89,6 +89,13 @@ int gmx_omp_get_num_procs();
  */
 int gmx_omp_get_thread_num();
 
+/*! \brief
+ * Returns the number of threads in the current thread team.
+ *
+ * Acts as a wrapper for omp_get_num_threads().
+ */
+int gmx_omp_get_num_threads();
+
 /*! \brief
  * Sets the number of threads in subsequent parallel regions, unless overridden
  * by a num_threads clause.
@@ -36,9 +36,11 @@
 
 #include "keyvaluetree.h"
 
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/compare.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/strconvert.h"
@@ -58,6 +60,48 @@ std::vector<std::string> splitPathElements(const std::string& path)
     return splitDelimitedString(path.substr(1), '/');
 }
 
+/*! \brief Returns the values of a contiguous array of type \p T, if \p value is one
+ *
+ * Contiguous arrays are stored as ArrayRef when built for writing
+ * and as std::vector after deserialization.
+ */
+template<typename T>
+std::optional<ArrayRef<const T>> contiguousArrayValues(const KeyValueTreeValue& value)
+{
+    if (value.isType<std::vector<T>>())
+    {
+        return makeConstArrayRef(value.cast<std::vector<T>>());
+    }
+    if (value.isType<ArrayRef<const T>>())
+    {
+        return value.cast<ArrayRef<const T>>();
+    }
+    return std::nullopt;
+}
+
+//! Returns whether \p value is a contiguous array of any of the supported types
+bool isContiguousArray(const KeyValueTreeValue& value)
+{
+    return contiguousArrayValues<int>(value) || contiguousArrayValues<int64_t>(value)
+           || contiguousArrayValues<float>(value) || contiguousArrayValues<double>(value);
+}
+
+//! Writes the elements of \p value when it is a contiguous array of type \p T
+template<typename T>
+void dumpContiguousArray(TextWriter* writer, const KeyValueTreeValue& value)
+{
+    if (const auto values = contiguousArrayValues<T>(value))
+    {
+        writer->writeString("[");
+        for (const T& elem : *values)
+        {
+            writer->writeString(" ");
+            writer->writeString(toString(elem));
+        }
+        writer->writeString(" ]");
+    }
+}
+
 } // namespace
 
 /********************************************************************
@@ -130,6 +174,13 @@ void dumpKeyValueTree(TextWriter* writer, const KeyValueTreeObject& tree)
                 }
                 writer->writeString(" ]");
             }
+            else if (isContiguousArray(value))
+            {
+                dumpContiguousArray<int>(writer, value);
+                dumpContiguousArray<int64_t>(writer, value);
+                dumpContiguousArray<float>(writer, value);
+                dumpContiguousArray<double>(writer, value);
+            }
             else
             {
                 writer->writeString(simpleValueToString(value));
@@ -186,7 +237,18 @@ public:
 private:
     void compareValues(const KeyValueTreeValue& value1, const KeyValueTreeValue& value2)
     {
-        if (value1.type() == value2.type())
+        // Contiguous arrays can be stored as ArrayRef or std::vector
+        if (isContiguousArray(value1) && isContiguousArray(value2))
+        {
+            if (!compareContiguousArrays<int>(value1, value2)
+                && !compareContiguousArrays<int64_t>(value1, value2)
+                && !compareContiguousArrays<float>(value1, value2)
+                && !compareContiguousArrays<double>(value1, value2))
+            {
+                handleMismatchingTypes(value1, value2);
+            }
+        }
+        else if (value1.type() == value2.type())
         {
             if (value1.isObject())
             {
@@ -221,6 +283,53 @@ private:
         }
     }
 
+    /*! \brief Compares two contiguous arrays with elements of type \p T
+     *
+     * \returns false, without comparing, when not both values hold elements of type \p T.
+     */
+    template<typename T>
+    bool compareContiguousArrays(const KeyValueTreeValue& value1, const KeyValueTreeValue& value2)
+    {
+        const auto values1 = contiguousArrayValues<T>(value1);
+        const auto values2 = contiguousArrayValues<T>(value2);
+        if (!values1 || !values2)
+        {
+            return false;
+        }
+        if (values1->size() != values2->size())
+        {
+            writer_->writeString(currentPath_.toString());
+            writer_->writeLine(
+                    formatString(" (size %zu - size %zu)", values1->size(), values2->size()));
+            return true;
+        }
+        for (size_t i = 0; i < values1->size(); i++)
+        {
+            if (!areElementsEqual((*values1)[i], (*values2)[i]))
+            {
+                writer_->writeString(currentPath_.toString());
+                writer_->writeLine(formatString("[%zu] (%s - %s)", i,
+                                                toString((*values1)[i]).c_str(),
+                                                toString((*values2)[i]).c_str()));
+            }
+        }
+        return true;
+    }
+
+    //! Element comparison for contiguous arrays
+    //! \{
+    static bool areElementsEqual(int value1, int value2) { return value1 == value2; }
+    static bool areElementsEqual(int64_t value1, int64_t value2) { return value1 == value2; }
+    bool        areElementsEqual(float value1, float value2) const
+    {
+        return equal_float(value1, value2, ftol_, abstol_);
+    }
+    bool areElementsEqual(double value1, double value2) const
+    {
+        return equal_double(value1, value2, ftol_, abstol_);
+    }
+    //! \}
+
     bool areSimpleValuesOfSameTypeEqual(const KeyValueTreeValue& value1, const KeyValueTreeValue& value2)
     {
         GMX_ASSERT(value1.type() == value2.type(), "Caller should ensure that types are equal");
@@ -277,7 +386,7 @@ private:
 
     static std::string formatValueForMissingMessage(const KeyValueTreeValue& value)
     {
-        if (value.isObject() || value.isArray())
+        if (value.isObject() || value.isArray() || isContiguousArray(value))
         {
             return "present";
         }
@@ -57,6 +57,7 @@
 #include <vector>
 
 #include "gromacs/utility/any.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/keyvaluetree.h"
 
@@ -341,6 +342,21 @@ public:
             builder.addValue(value);
         }
     }
+    /*! \brief
+     * Adds a contiguous array-valued property that references existing data.
+     *
+     * \tparam T  Type of the values, int, int64_t, float or double.
+     *
+     * In contrast to addUniformArray(), the values are not copied into the
+     * tree, but are written directly from `values` when the tree is
+     * serialized, so `values` needs to stay valid until then.
+     * A deserialized tree holds the values as a `std::vector<T>`.
+     */
+    template<typename T>
+    void addArrayRef(const std::string& key, ArrayRef<const T> values)
+    {
+        addValue<ArrayRef<const T>>(key, values);
+    }
     /*! \brief
      * Adds an array-valued property with objects in the array with given
      * key.
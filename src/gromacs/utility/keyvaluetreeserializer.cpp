@@ -36,6 +36,9 @@
 
 #include "keyvaluetreeserializer.h"
 
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/iserializer.h"
 #include "gromacs/utility/keyvaluetree.h"
 #include "gromacs/utility/keyvaluetreebuilder.h"
@@ -212,6 +215,60 @@ struct SerializationTraits<double>
     }
 };
 
+//! Helper functions for (de)serializing contiguous arrays of a certain type.
+//! \{
+void doArray(int* values, int count, ISerializer* serializer)
+{
+    serializer->doIntArray(values, count);
+}
+void doArray(int64_t* values, int count, ISerializer* serializer)
+{
+    serializer->doInt64Array(values, count);
+}
+void doArray(float* values, int count, ISerializer* serializer)
+{
+    serializer->doFloatArray(values, count);
+}
+void doArray(double* values, int count, ISerializer* serializer)
+{
+    serializer->doDoubleArray(values, count);
+}
+//! \}
+
+/*! \brief Serialization of contiguous arrays
+ *
+ * Arrays written from an ArrayRef referencing external data are read
+ * back into a std::vector owned by the tree, so both share a type tag.
+ */
+template<typename T>
+struct ContiguousArraySerializationTraits
+{
+    static void serialize(ArrayRef<const T> values, ISerializer* serializer)
+    {
+        int count = values.size();
+        serializer->doInt(&count);
+        doArray(const_cast<T*>(values.data()), count, serializer);
+    }
+    static void deserialize(KeyValueTreeValueBuilder* builder, ISerializer* serializer)
+    {
+        int count;
+        serializer->doInt(&count);
+        std::vector<T> values(count);
+        doArray(values.data(), count, serializer);
+        builder->setAnyValue(Any::create<std::vector<T>>(std::move(values)));
+    }
+};
+
+template<typename T>
+struct SerializationTraits<ArrayRef<const T>> : public ContiguousArraySerializationTraits<T>
+{
+};
+
+template<typename T>
+struct SerializationTraits<std::vector<T>> : public ContiguousArraySerializationTraits<T>
+{
+};
+
 //! Helper function for serializing values of a certain type.
 template<typename T>
 void serializeValueType(const KeyValueTreeValue& value, ISerializer* serializer)
@@ -244,6 +301,14 @@ void ValueSerializer::initSerializers()
         SERIALIZER('l', int64_t),
         SERIALIZER('f', float),
         SERIALIZER('d', double),
+        SERIALIZER('I', std::vector<int>),
+        SERIALIZER('I', ArrayRef<const int>),
+        SERIALIZER('L', std::vector<int64_t>),
+        SERIALIZER('L', ArrayRef<const int64_t>),
+        SERIALIZER('F', std::vector<float>),
+        SERIALIZER('F', ArrayRef<const float>),
+        SERIALIZER('D', std::vector<double>),
+        SERIALIZER('D', ArrayRef<const double>),
     };
     for (const auto& item : s_serializers)
     {
@@ -0,0 +1,68 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares functions to query properties of the MPI library.
+ *
+ * \inlibraryapi
+ * \ingroup module_utility
+ */
+#ifndef GMX_UTILITY_MPIINFO_H
+#define GMX_UTILITY_MPIINFO_H
+
+namespace gmx
+{
+
+//! Whether the MPI library can communicate directly from and to CUDA device memory
+enum class CudaAwareMpiStatus : int
+{
+    //! The MPI library reports CUDA support
+    Supported,
+    //! The MPI library reports that it has no CUDA support
+    NotSupported,
+    //! The MPI library provides no way to query CUDA support
+    NotKnown
+};
+
+/*! \brief Return whether the MPI library supports communication of CUDA device buffers
+ *
+ * This uses the MPIX_Query_cuda_support() extension, which is currently
+ * only provided by Open MPI. With other MPI libraries NotKnown is returned.
+ */
+CudaAwareMpiStatus checkMpiCudaAwareSupport();
+
+} // namespace gmx
+
+#endif
@@ -98,6 +98,29 @@ auto dispatchTemplatedFunction(Function&& f, Enum e, Enums... es)
             es...);
 }
 
+/** \internal \brief Helper function to select appropriate template based on runtime values.
+ *
+ * Overload of the above for boolean switches, which are passed to \p f
+ * as \c std::integral_constant<bool>. Boolean and enum arguments can be
+ * mixed in any order.
+ */
+template<class Function, class... Enums>
+auto dispatchTemplatedFunction(Function&& f, bool b, Enums... es)
+{
+    return dispatchTemplatedFunction(
+            [&](auto... es_) {
+                if (b)
+                {
+                    return std::forward<Function>(f)(std::true_type(), es_...);
+                }
+                else
+                {
+                    return std::forward<Function>(f)(std::false_type(), es_...);
+                }
+            },
+            es...);
+}
+
 } // namespace gmx
 
 #endif // GMX_UTILITY_TEMPLATE_MP_H
@@ -37,6 +37,7 @@
 #include "gromacs/utility/keyvaluetreeserializer.h"
 
 #include <cstddef>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -155,4 +156,35 @@ TEST_F(KeyValueTreeSerializerTest, ObjectWithObjects)
     runTest();
 }
 
+TEST(KeyValueTreeSerializer, ContiguousArraysRoundTrip)
+{
+    const std::vector<int>     ints    = { 1, -2, 3 };
+    const std::vector<int64_t> int64s  = { 4, 5000000000 };
+    const std::vector<float>   floats  = { 1.5, -2.5 };
+    const std::vector<double>  doubles = { 0.125, 3.0, -1e10 };
+    const std::vector<float>   empty;
+
+    gmx::KeyValueTreeBuilder builder;
+    builder.rootObject().addArrayRef<int>("i", ints);
+    builder.rootObject().addArrayRef<int64_t>("l", int64s);
+    builder.rootObject().addArrayRef<float>("f", floats);
+    builder.rootObject().addArrayRef<double>("d", doubles);
+    builder.rootObject().addArrayRef<float>("empty", empty);
+    builder.rootObject().addValue<int>("after", 7);
+    gmx::KeyValueTreeObject input = builder.build();
+
+    gmx::InMemorySerializer serializer;
+    gmx::serializeKeyValueTree(input, &serializer);
+    std::vector<char>         buffer = serializer.finishAndGetBuffer();
+    gmx::InMemoryDeserializer deserializer(buffer, false);
+    gmx::KeyValueTreeObject   output = gmx::deserializeKeyValueTree(&deserializer);
+
+    EXPECT_EQ(ints, output["i"].cast<std::vector<int>>());
+    EXPECT_EQ(int64s, output["l"].cast<std::vector<int64_t>>());
+    EXPECT_EQ(floats, output["f"].cast<std::vector<float>>());
+    EXPECT_EQ(doubles, output["d"].cast<std::vector<double>>());
+    EXPECT_TRUE(output["empty"].cast<std::vector<float>>().empty());
+    EXPECT_EQ(7, output["after"].cast<int>());
+}
+
 } // namespace
@@ -66,5 +66,22 @@ TEST(TemplateMPTest, DispatchTemplatedFunction)
     EXPECT_EQ(two1plus2plus5, 9);
 }
 
+template<bool doDouble, Options i>
+static int testBoolTimesI(int k)
+{
+    return (doDouble ? 2 : 1) * int(i) + k;
+}
+
+TEST(TemplateMPTest, DispatchTemplatedFunctionWithBool)
+{
+    int five = 5;
+    for (bool doDouble : { false, true })
+    {
+        int result = dispatchTemplatedFunction(
+                [=](auto p1, auto p2) { return testBoolTimesI<p1, p2>(five); }, doDouble, Options::Op2);
+        EXPECT_EQ(result, doDouble ? 9 : 7);
+    }
+}
+
 } // anonymous namespace
 } // namespace gmx
@@ -0,0 +1,176 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Micro-benchmarks of the SETTLE and LINCS constraint kernels.
+ */
+#include "gmxpre.h"
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/constr.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdlib/lincs.h"
+#include "gromacs/mdlib/settle.h"
+#include "gromacs/mdrunutility/multisim.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/listoflists.h"
+
+#include "gromacs/mdlib/tests/constrtestdata.h"
+#include "gromacs/mdlib/tests/settletestdata.h"
+
+#include "microbenchmark.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(ConstraintsBenchmark, Settle)
+{
+    // The test water system holds 17 molecules
+    SettleTestData testData(17);
+
+    SettleData settled(testData.mtop_);
+    settled.setConstraints(testData.idef_->il[F_SETTLE], testData.numAtoms_,
+                           testData.masses_.data(), testData.inverseMasses_.data());
+
+    t_pbc  pbc;
+    matrix box = { { 0 } };
+    set_pbc(&pbc, PbcType::No, box);
+
+    bool errorOccurred = false;
+    for (const bool calcVirial : { false, true })
+    {
+        runMicroBenchmark(calcVirial ? "Settle.17Waters.Virial" : "Settle.17Waters", [&]() {
+            csettle(settled, 1, 0, &pbc, testData.x_.arrayRefWithPadding(),
+                    testData.xPrime_.arrayRefWithPadding(), testData.reciprocalTimeStep_,
+                    testData.v_.arrayRefWithPadding(), calcVirial, testData.virial_,
+                    &errorOccurred);
+        });
+    }
+    EXPECT_FALSE(errorOccurred);
+}
+
+TEST(ConstraintsBenchmark, Lincs)
+{
+    // Straight chains of atoms with all bonds constrained, loosely
+    // mimicking the chains of heavy atoms in lipids or polymers
+    const int  numChains     = 1000;
+    const int  atomsPerChain = 16;
+    const int  numAtoms      = numChains * atomsPerChain;
+    const real bondLength    = 0.15;
+    const real chainSpacing  = 0.5;
+
+    std::vector<real> masses(numAtoms, 12.011);
+    std::vector<int>  constraints;
+    std::vector<RVec> x(numAtoms);
+    std::vector<RVec> xPrime(numAtoms);
+    std::vector<RVec> v(numAtoms, { 0, 0, 0 });
+
+    std::mt19937                         rng(1234);
+    std::uniform_real_distribution<real> displacement(-0.005, 0.005);
+    for (int chain = 0; chain < numChains; chain++)
+    {
+        for (int i = 0; i < atomsPerChain; i++)
+        {
+            const int a = chain * atomsPerChain + i;
+            x[a] = { i * bondLength, (chain % 32) * chainSpacing, (chain / 32) * chainSpacing };
+            xPrime[a]   = x[a] + RVec(displacement(rng), displacement(rng), displacement(rng));
+            if (i > 0)
+            {
+                constraints.insert(constraints.end(), { 0, a - 1, a });
+            }
+        }
+    }
+
+    tensor              virialScaledRef = { { 0 } };
+    ConstraintsTestData testData("Chains", numAtoms, masses, constraints, { bondLength }, true,
+                                 virialScaledRef, false, 0, real(0.0), real(0.002), x, xPrime, v,
+                                 real(0.0001), false, 1, 4, real(30.0));
+
+    gmx_omp_nthreads_set(emntLINCS, 1);
+    t_commrec cr;
+    cr.nnodes = 1;
+    cr.dd     = nullptr;
+    gmx_multisim_t ms{ 1, 0, MPI_COMM_NULL, MPI_COMM_NULL };
+
+    std::vector<ListOfLists<int>> at2con_mt;
+    for (const gmx_moltype_t& moltype : testData.mtop_.moltype)
+    {
+        at2con_mt.push_back(make_at2con(moltype, testData.mtop_.ffparams.iparams,
+                                        flexibleConstraintTreatment(EI_DYNAMICS(testData.ir_.eI))));
+    }
+    Lincs* lincsd = init_lincs(nullptr, testData.mtop_, testData.nflexcon_, at2con_mt, false,
+                               testData.ir_.nLincsIter, testData.ir_.nProjOrder);
+    set_lincs(*testData.idef_, testData.numAtoms_, testData.invmass_.data(), testData.lambda_,
+              EI_DYNAMICS(testData.ir_.eI), &cr, lincsd);
+
+    t_pbc  pbc;
+    matrix box = { { 0 } };
+    set_pbc(&pbc, PbcType::No, box);
+
+    bool success      = true;
+    int  warningCount = 0;
+    for (const bool computeVirial : { false, true })
+    {
+        runMicroBenchmark(computeVirial ? "Lincs.Chains.Virial" : "Lincs.Chains", [&]() {
+            const bool lincsSuccess = constrain_lincs(
+                    false, testData.ir_, 0, lincsd, testData.invmass_.data(), &cr, &ms,
+                    testData.x_.arrayRefWithPadding(), testData.xPrime_.arrayRefWithPadding(),
+                    testData.xPrime2_.arrayRefWithPadding().unpaddedArrayRef(), pbc.box, &pbc,
+                    false, testData.lambda_, &testData.dHdLambda_, testData.invdt_,
+                    testData.v_.arrayRefWithPadding().unpaddedArrayRef(), computeVirial,
+                    testData.virialScaled_, ConstraintVariable::Positions, &testData.nrnb_, 100,
+                    &warningCount);
+            success = success && lincsSuccess;
+        });
+    }
+    EXPECT_TRUE(success);
+    EXPECT_EQ(warningCount, 0);
+    done_lincs(lincsd);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
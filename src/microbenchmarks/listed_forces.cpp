@@ -0,0 +1,170 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Micro-benchmarks of the listed-forces kernels.
+ */
+#include "gmxpre.h"
+
+#include <cmath>
+
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/listed_forces/bonded.h"
+#include "gromacs/math/units.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/topology/idef.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "microbenchmark.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Returns the parameters used for all interactions of type \p ftype
+t_iparams makeParameters(int ftype)
+{
+    t_iparams iparams = {};
+    switch (ftype)
+    {
+        case F_BONDS:
+            iparams.harmonic.rA  = 0.15;
+            iparams.harmonic.krA = 300000;
+            break;
+        case F_ANGLES:
+            iparams.harmonic.rA  = 111;
+            iparams.harmonic.krA = 400;
+            break;
+        case F_PDIHS:
+            iparams.pdihs.phiA = 0;
+            iparams.pdihs.cpA  = 5;
+            iparams.pdihs.mult = 3;
+            break;
+        case F_IDIHS:
+            iparams.harmonic.rA  = 0;
+            iparams.harmonic.krA = 40;
+            break;
+        case F_RBDIHS:
+            for (int i = 0; i < NR_RBDIHS; i++)
+            {
+                iparams.rbdihs.rbcA[i] = 1.0 - 0.3 * i;
+            }
+            break;
+        default: GMX_RELEASE_ASSERT(false, "Interaction type not covered by the benchmarks");
+    }
+    return iparams;
+}
+
+//! Parameters are the interaction type and the kernel flavor
+using ListedForcesBenchmarkParameters = std::tuple<int, BondedKernelFlavor>;
+
+class ListedForcesBenchmark : public ::testing::TestWithParam<ListedForcesBenchmarkParameters>
+{
+};
+
+TEST_P(ListedForcesBenchmark, Kernel)
+{
+    const int                ftype  = std::get<0>(GetParam());
+    const BondedKernelFlavor flavor = std::get<1>(GetParam());
+
+    // A fixed random-walk chain, as the backbone of a large polymer
+    const int                      numAtoms = 30000;
+    const real                     boxSize  = 20;
+    std::vector<RVec>              x(numAtoms);
+    std::mt19937                   rng(1234);
+    std::normal_distribution<real> direction(0, 1);
+    x[0] = { 0.5 * boxSize, 0.5 * boxSize, 0.5 * boxSize };
+    for (int i = 1; i < numAtoms; i++)
+    {
+        RVec step = { direction(rng), direction(rng), direction(rng) };
+        x[i]      = x[i - 1] + step * (real(0.15) / norm(step));
+    }
+
+    // Every consecutive set of atoms forms one interaction
+    const int            numAtomsPerInteraction = NRAL(ftype);
+    std::vector<t_iatom> iatoms;
+    for (int i = 0; i + numAtomsPerInteraction <= numAtoms; i++)
+    {
+        iatoms.push_back(0);
+        for (int a = 0; a < numAtomsPerInteraction; a++)
+        {
+            iatoms.push_back(i + a);
+        }
+    }
+    const t_iparams iparams = makeParameters(ftype);
+
+    matrix box = { { boxSize, 0, 0 }, { 0, boxSize, 0 }, { 0, 0, boxSize } };
+    t_pbc  pbc;
+    set_pbc(&pbc, PbcType::Xyz, box);
+
+    std::vector<rvec4> f(numAtoms);
+    rvec               fshift[SHIFTS];
+    t_mdatoms          mdatoms   = { 0 };
+    real               dvdlambda = 0;
+
+    const std::string name = formatString("ListedForces.%s.%s", interaction_function[ftype].name,
+                                          c_bondedKernelFlavorStrings[flavor].c_str());
+    runMicroBenchmark(name, [&]() {
+        calculateSimpleBond(ftype, iatoms.size(), iatoms.data(), &iparams, as_rvec_array(x.data()),
+                            f.data(), fshift, &pbc, 0, &dvdlambda,
+                            &mdatoms, nullptr, nullptr, flavor);
+    });
+}
+
+INSTANTIATE_TEST_CASE_P(Kernels,
+                        ListedForcesBenchmark,
+                        ::testing::Combine(::testing::Values(F_BONDS, F_ANGLES, F_PDIHS, F_IDIHS,
+                                                             F_RBDIHS),
+                                           ::testing::Values(
+                                                   BondedKernelFlavor::ForcesSimdWhenAvailable,
+                                                   BondedKernelFlavor::ForcesAndVirialAndEnergy)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
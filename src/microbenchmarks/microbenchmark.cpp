@@ -0,0 +1,113 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the timing harness for the kernel micro-benchmarks.
+ */
+#include "gmxpre.h"
+
+#include "microbenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/ioptionscontainer.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/testoptions.h"
+
+namespace gmx
+{
+namespace test
+{
+
+namespace
+{
+
+//! Minimum duration of a timed batch of kernel calls in seconds
+double g_minTime = 0.2;
+//! Number of timed batches, the fastest is reported
+int g_numRepeats = 3;
+
+//! \cond
+GMX_TEST_OPTIONS(MicroBenchmarkOptions, options)
+{
+    options->addOption(DoubleOption("min-time").store(&g_minTime).description(
+            "Minimum duration in seconds of a timed batch of calls"));
+    options->addOption(IntegerOption("repeats").store(&g_numRepeats).description(
+            "Number of timed batches per benchmark, the fastest is reported"));
+}
+//! \endcond
+
+} // namespace
+
+double runMicroBenchmark(const std::string& name, const std::function<void()>& kernel)
+{
+    using Clock = std::chrono::steady_clock;
+
+    kernel();
+
+    double nsPerCall = std::numeric_limits<double>::max();
+    for (int repeat = 0; repeat < std::max(g_numRepeats, 1); repeat++)
+    {
+        for (long numCalls = 1;; numCalls *= 2)
+        {
+            const auto start = Clock::now();
+            for (long call = 0; call < numCalls; call++)
+            {
+                kernel();
+            }
+            const std::chrono::duration<double> elapsed = Clock::now() - start;
+            if (elapsed.count() >= g_minTime)
+            {
+                nsPerCall = std::min(nsPerCall, 1e9 * elapsed.count() / numCalls);
+                break;
+            }
+        }
+    }
+
+    std::printf("[  TIMING  ] %-40s %14.1f ns/call\n", name.c_str(), nsPerCall);
+    ::testing::Test::RecordProperty(name, formatString("%.1f", nsPerCall));
+
+    return nsPerCall;
+}
+
+} // namespace test
+} // namespace gmx
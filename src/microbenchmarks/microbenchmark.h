@@ -0,0 +1,67 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Declares the timing harness for the kernel micro-benchmarks.
+ */
+#ifndef GMX_MICROBENCHMARKS_MICROBENCHMARK_H
+#define GMX_MICROBENCHMARKS_MICROBENCHMARK_H
+
+#include <functional>
+#include <string>
+
+namespace gmx
+{
+namespace test
+{
+
+/*! \brief Times repeated calls of \p kernel and reports the time per call
+ *
+ * The kernel is called once to warm up caches, then in batches of
+ * doubling size until one batch takes at least the minimum time given
+ * by the -min-time option. This is repeated -repeats times and the
+ * fastest batch is reported on stdout and as a GoogleTest property
+ * with key \p name, so it ends up in the XML or JSON test output.
+ *
+ * \param[in] name    Name of the benchmark, should be a valid XML attribute name
+ * \param[in] kernel  The code to time, should have the same cost on every call
+ * \returns The time per call of \p kernel in nanoseconds
+ */
+double runMicroBenchmark(const std::string& name, const std::function<void()>& kernel);
+
+} // namespace test
+} // namespace gmx
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Micro-benchmarks of the CPU PME spline, spread, solve and gather stages.
+ */
+#include "gmxpre.h"
+
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/ewald/pme.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "gromacs/ewald/tests/pmetestcommon.h"
+
+#include "microbenchmark.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Grid spacing in nm, the box is the grid size times this
+constexpr real c_gridSpacing = 0.12;
+//! Atom density in atoms/nm^3, roughly that of water
+constexpr real c_atomDensity = 100;
+
+//! Parameters are the PME order and the number of grid points along each box vector
+using PmeBenchmarkParameters = std::tuple<int, int>;
+
+class PmeBenchmark : public ::testing::TestWithParam<PmeBenchmarkParameters>
+{
+};
+
+TEST_P(PmeBenchmark, CpuStages)
+{
+    const int  pmeOrder  = std::get<0>(GetParam());
+    const int  gridSize  = std::get<1>(GetParam());
+    const real boxSize   = gridSize * c_gridSpacing;
+    const int  atomCount = static_cast<int>(c_atomDensity * boxSize * boxSize * boxSize);
+
+    t_inputrec inputRec;
+    inputRec.nkx         = gridSize;
+    inputRec.nky         = gridSize;
+    inputRec.nkz         = gridSize;
+    inputRec.pme_order   = pmeOrder;
+    inputRec.coulombtype = eelPME;
+    inputRec.epsilon_r   = 1.0;
+
+    const Matrix3x3 box = { { boxSize, 0, 0, 0, boxSize, 0, 0, 0, boxSize } };
+
+    // Fixed input: uniformly distributed, alternating charges
+    std::mt19937                         rng(1234);
+    std::uniform_real_distribution<real> position(0, boxSize);
+    CoordinatesVector                    coordinates(atomCount);
+    std::vector<real>                    charges(atomCount);
+    for (int i = 0; i < atomCount; i++)
+    {
+        coordinates[i] = { position(rng), position(rng), position(rng) };
+        charges[i]     = (i % 2 == 0) ? 0.5 : -0.5;
+    }
+
+    const real     ewaldCoeff = 3.12;
+    PmeSafePointer pme =
+            pmeInitWrapper(&inputRec, CodePath::CPU, nullptr, nullptr, nullptr, box, ewaldCoeff);
+    pmeInitAtoms(pme.get(), nullptr, CodePath::CPU, coordinates, charges);
+
+    const std::string name = formatString("Pme.Order%d.Grid%d.", pmeOrder, gridSize);
+
+    runMicroBenchmark(name + "Spline",
+                      [&]() { pmePerformSplineAndSpread(pme.get(), CodePath::CPU, true, false); });
+    runMicroBenchmark(name + "Spread",
+                      [&]() { pmePerformSplineAndSpread(pme.get(), CodePath::CPU, false, true); });
+
+    std::vector<RVec> forces(atomCount);
+    ForcesVector      forcesRef(forces);
+    runMicroBenchmark(name + "Gather",
+                      [&]() { pmePerformGather(pme.get(), CodePath::CPU, forcesRef); });
+
+    // Solve works in place on the complex grid, so we start from
+    // zero to avoid denormals from repeated application.
+    pmeSetComplexGrid(pme.get(), CodePath::CPU, GridOrdering::YZX, {});
+    const real cellVolume = boxSize * boxSize * boxSize;
+    runMicroBenchmark(name + "Solve", [&]() {
+        pmePerformSolve(pme.get(), CodePath::CPU, PmeSolveAlgorithm::Coulomb, cellVolume,
+                        GridOrdering::YZX, true);
+    });
+}
+
+INSTANTIATE_TEST_CASE_P(Kernels,
+                        PmeBenchmark,
+                        ::testing::Combine(::testing::Values(4, 5), ::testing::Values(32, 64)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,112 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Micro-benchmarks of the SIMD math functions.
+ */
+#include "gmxpre.h"
+
+#include "config.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/simd/simd.h"
+#include "gromacs/simd/simd_math.h"
+#include "gromacs/utility/alignedallocator.h"
+
+#include "microbenchmark.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+#if GMX_SIMD_HAVE_REAL
+
+//! Number of values each function is applied to per call, small enough to stay in L1
+constexpr int c_numValues = 1024;
+
+/*! \brief Benchmarks \p function applied to all values in [\p low, \p high)
+ *
+ * The results are summed into a buffer to keep the compiler from
+ * eliminating the calls.
+ */
+void benchmarkSimdFunction(const std::string&                       name,
+                           real                                     low,
+                           real                                     high,
+                           const std::function<SimdReal(SimdReal)>& function)
+{
+    std::vector<real, AlignedAllocator<real>> input(c_numValues);
+    std::vector<real, AlignedAllocator<real>> output(GMX_SIMD_REAL_WIDTH, 0);
+    for (int i = 0; i < c_numValues; i++)
+    {
+        input[i] = low + (high - low) * i / c_numValues;
+    }
+
+    runMicroBenchmark("SimdMath." + name, [&]() {
+        SimdReal sum = load<SimdReal>(output.data());
+        for (int i = 0; i < c_numValues; i += GMX_SIMD_REAL_WIDTH)
+        {
+            sum = sum + function(load<SimdReal>(input.data() + i));
+        }
+        store(output.data(), sum);
+    });
+}
+
+TEST(SimdMathBenchmark, Functions)
+{
+    benchmarkSimdFunction("invsqrt", 0.01, 10, [](SimdReal x) { return invsqrt(x); });
+    benchmarkSimdFunction("sqrt", 0.01, 10, [](SimdReal x) { return sqrt(x); });
+    benchmarkSimdFunction("exp", -20, 20, [](SimdReal x) { return exp(x); });
+    benchmarkSimdFunction("log", 0.01, 100, [](SimdReal x) { return log(x); });
+    benchmarkSimdFunction("erfc", 0, 5, [](SimdReal x) { return erfc(x); });
+    benchmarkSimdFunction("pmeForceCorrection", 0, 16,
+                          [](SimdReal x) { return pmeForceCorrection(x); });
+    benchmarkSimdFunction("sin", -10, 10, [](SimdReal x) { return sin(x); });
+    benchmarkSimdFunction("acos", -1, 1, [](SimdReal x) { return acos(x); });
+    benchmarkSimdFunction("atan2", -10, 10, [](SimdReal x) { return atan2(x, SimdReal(1.5)); });
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
+} // namespace
+} // namespace test
+} // namespace gmx
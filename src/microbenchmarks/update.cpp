@@ -0,0 +1,106 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Micro-benchmarks of the leap-frog coordinate update.
+ */
+#include "gmxpre.h"
+
+#include <string>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdlib/update.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "gromacs/mdlib/tests/leapfrogtestdata.h"
+
+#include "microbenchmark.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Parameters are the number of T-coupling groups and the P-coupling interval (0 is none)
+using UpdateBenchmarkParameters = std::tuple<int, int>;
+
+class UpdateBenchmark : public ::testing::TestWithParam<UpdateBenchmarkParameters>
+{
+};
+
+TEST_P(UpdateBenchmark, LeapFrog)
+{
+    const int  numAtoms         = 100000;
+    const int  numTCoupleGroups = std::get<0>(GetParam());
+    const int  nstpcouple       = std::get<1>(GetParam());
+    const rvec v0               = { 1.0, -0.5, 0.2 };
+    const rvec f0               = { -0.3, 0.8, 0.1 };
+
+    LeapFrogTestData testData(numAtoms, 0.002, v0, f0, numTCoupleGroups, nstpcouple);
+    testData.state_.x.resizeWithPadding(numAtoms);
+    testData.state_.v.resizeWithPadding(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        testData.state_.x[i] = testData.x_[i];
+        testData.state_.v[i] = testData.v_[i];
+    }
+
+    gmx_omp_nthreads_set(emntUpdate, 1);
+
+    const std::string name =
+            formatString("Update.LeapFrog.TCouple%d.PCouple%d", numTCoupleGroups, nstpcouple);
+    runMicroBenchmark(name, [&]() {
+        testData.update_->update_coords(
+                testData.inputRecord_, 0, &testData.mdAtoms_, &testData.state_, testData.f_,
+                testData.forceCalculationData_, &testData.kineticEnergyData_,
+                testData.velocityScalingMatrix_, etrtNONE, nullptr, false);
+    });
+}
+
+INSTANTIATE_TEST_CASE_P(Kernels,
+                        UpdateBenchmark,
+                        ::testing::Values(std::make_tuple(0, 0),
+                                          std::make_tuple(1, 0),
+                                          std::make_tuple(1, 1)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
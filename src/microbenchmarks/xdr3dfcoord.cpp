@@ -0,0 +1,107 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Micro-benchmarks of the XTC coordinate compression.
+ */
+#include "gmxpre.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/xdrf.h"
+
+#include "microbenchmark.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(Xdr3dfcoordBenchmark, EncodeAndDecode)
+{
+    // Fixed water-like input: every third atom starts a molecule at a
+    // random position, the two others are close to it
+    const int                             numAtoms = 30000;
+    const float                           boxSize  = 6.0F;
+    std::mt19937                          rng(1234);
+    std::uniform_real_distribution<float> position(0.0F, boxSize);
+    std::uniform_real_distribution<float> displacement(-0.1F, 0.1F);
+    std::vector<float>                    x(3 * numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        const int firstAtomOfMolecule = i - i % 3;
+        for (int d = 0; d < 3; d++)
+        {
+            x[3 * i + d] = (i == firstAtomOfMolecule)
+                                   ? position(rng)
+                                   : x[3 * firstAtomOfMolecule + d] + displacement(rng);
+        }
+    }
+
+    std::vector<char>  buffer(x.size() * sizeof(float) + 1024);
+    std::vector<float> xDecoded(x.size());
+    for (const bool useReference : { true, false })
+    {
+        xdr3dfcoord_use_reference_implementation(useReference);
+        const std::string implementation = useReference ? "Reference" : "Fast";
+
+        XDR xdrs;
+        runMicroBenchmark("Xdr3dfcoord.Encode." + implementation, [&]() {
+            xdrmem_create(&xdrs, buffer.data(), buffer.size(), XDR_ENCODE);
+            int   size      = numAtoms;
+            float precision = 1000.0F;
+            xdr3dfcoord(&xdrs, x.data(), &size, &precision);
+            xdr_destroy(&xdrs);
+        });
+        runMicroBenchmark("Xdr3dfcoord.Decode." + implementation, [&]() {
+            xdrmem_create(&xdrs, buffer.data(), buffer.size(), XDR_DECODE);
+            int   size      = numAtoms;
+            float precision = 0.0F;
+            xdr3dfcoord(&xdrs, xDecoded.data(), &size, &precision);
+            xdr_destroy(&xdrs);
+        });
+    }
+    xdr3dfcoord_use_reference_implementation(false);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
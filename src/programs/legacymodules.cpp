@@ -71,6 +71,7 @@
 
 #include "mdrun/mdrun_main.h"
 #include "mdrun/nonbonded_bench.h"
+#include "mdrun/pme_bench.h"
 #include "view/view.h"
 
 namespace
@@ -190,6 +191,10 @@ void registerLegacyModules(gmx::CommandLineModuleManager* manager)
             manager, gmx::NonbondedBenchmarkInfo::name,
             gmx::NonbondedBenchmarkInfo::shortDescription, &gmx::NonbondedBenchmarkInfo::create);
 
+    gmx::ICommandLineOptionsModule::registerModuleFactory(manager, gmx::PmeBenchmarkInfo::name,
+                                                          gmx::PmeBenchmarkInfo::shortDescription,
+                                                          &gmx::PmeBenchmarkInfo::create);
+
     gmx::ICommandLineOptionsModule::registerModuleFactory(manager, gmx::InsertMoleculesInfo::name(),
                                                           gmx::InsertMoleculesInfo::shortDescription(),
                                                           &gmx::InsertMoleculesInfo::create);
@@ -459,6 +464,7 @@ void registerLegacyModules(gmx::CommandLineModuleManager* manager)
     {
         gmx::CommandLineModuleGroup group = manager->addModuleGroup("Protein-specific analysis");
         group.addModule("do_dssp");
+        group.addModule("dssp");
         group.addModule("chi");
         group.addModule("helix");
         group.addModule("helixorient");
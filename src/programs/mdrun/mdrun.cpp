@@ -54,12 +54,15 @@
 
 #include "config.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/domdec/options.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/hardware/detecthardware.h"
+#include "gromacs/mdlib/sighandler.h"
 #include "gromacs/mdrun/legacymdrunoptions.h"
 #include "gromacs/mdrun/runner.h"
 #include "gromacs/mdrun/simulationcontext.h"
@@ -68,6 +71,8 @@
 #include "gromacs/mdrunutility/multisim.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basenetwork.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/physicalnodecommunicator.h"
 
 #include "mdrun_main.h"
@@ -85,10 +90,117 @@ int gmx_mdrun(int argc, char* argv[])
     return gmx_mdrun(communicator, *hwinfo, argc, argv);
 }
 
-int gmx_mdrun(MPI_Comm communicator, const gmx_hw_info_t& hwinfo, int argc, char* argv[])
+/*! \brief Runs one simulation, or a multi-simulation with \p multiSimDirectoryNames
+ *
+ * \param[in]     communicator            The communicator for the ranks of this run
+ * \param[in]     hwinfo                  The detected hardware
+ * \param[in,out] options                 The mdrun options, the filenames can be updated
+ * \param[in]     multiSimDirectoryNames  The directories of a multi-simulation, or empty
+ */
+static int runSimulation(MPI_Comm                    communicator,
+                         const gmx_hw_info_t&        hwinfo,
+                         LegacyMdrunOptions*         options,
+                         ArrayRef<const std::string> multiSimDirectoryNames)
 {
     auto mdModules = std::make_unique<MDModules>();
 
+    // The SimulationContext is necessary with gmxapi so that
+    // resources owned by the client code can have suitable
+    // lifetime. The gmx wrapper binary uses the same infrastructure,
+    // but the lifetime is now trivially that of the invocation of the
+    // wrapper binary.
+    SimulationContext simulationContext(communicator, multiSimDirectoryNames);
+
+    StartingBehavior startingBehavior        = StartingBehavior::NewSimulation;
+    LogFilePtr       logFileGuard            = nullptr;
+    gmx_multisim_t*  ms                      = simulationContext.multiSimulation_.get();
+    std::tie(startingBehavior, logFileGuard) = handleRestart(
+            findIsSimulationMasterRank(ms, communicator), communicator, ms,
+            options->mdrunOptions.appendingBehavior, ssize(options->filenames),
+            options->filenames.data());
+
+    /* The named components for the builder exposed here are descriptive of the
+     * state of mdrun at implementation and are not intended to be prescriptive
+     * of future design. (Note the ICommandLineOptions... framework used elsewhere.)
+     * The modules should ultimately take part in composing the Director code
+     * for an extensible Builder.
+     *
+     * In the near term, we assume that resources like domain decomposition and
+     * neighbor lists must be reinitialized between simulation segments.
+     * We would prefer to rebuild resources only as necessary, but we defer such
+     * details to future optimizations.
+     */
+    auto builder = MdrunnerBuilder(std::move(mdModules),
+                                   compat::not_null<SimulationContext*>(&simulationContext));
+    builder.addHardwareDetectionResult(&hwinfo);
+    builder.addSimulationMethod(options->mdrunOptions, options->pforce, startingBehavior);
+    builder.addDomainDecomposition(options->domdecOptions);
+    // \todo pass by value
+    builder.addNonBonded(options->nbpu_opt_choices[0]);
+    // \todo pass by value
+    builder.addElectrostatics(options->pme_opt_choices[0], options->pme_fft_opt_choices[0]);
+    builder.addBondedTaskAssignment(options->bonded_opt_choices[0]);
+    builder.addUpdateTaskAssignment(options->update_opt_choices[0]);
+    builder.addNeighborList(options->nstlist_cmdline);
+    builder.addReplicaExchange(options->replExParams);
+    // Need to establish run-time values from various inputs to provide a resource handle to Mdrunner
+    builder.addHardwareOptions(options->hw_opt);
+    // \todo File names are parameters that should be managed modularly through further factoring.
+    builder.addFilenames(options->filenames);
+    builder.addInput(makeSimulationInput(*options));
+    // Note: The gmx_output_env_t life time is not managed after the call to parse_common_args.
+    // \todo Implement lifetime management for gmx_output_env_t.
+    // \todo Output environment should be configured outside of Mdrunner and provided as a resource.
+    builder.addOutputEnvironment(options->oenv);
+    builder.addLogFile(logFileGuard.get());
+
+    auto runner = builder.build();
+
+    return runner.mdrunner();
+}
+
+/*! \brief Runs the simulations in \p directoryNames from a queue shared by groups of ranks
+ *
+ * Each group runs the simulation of one directory at a time, as an
+ * independent simulation. When it finishes, the group claims the next
+ * directory, so the hardware of groups that finish early is used
+ * for the remaining simulations.
+ */
+static int runSimulationQueue(MPI_Comm                    communicator,
+                              const gmx_hw_info_t&        hwinfo,
+                              LegacyMdrunOptions*         options,
+                              ArrayRef<const std::string> directoryNames)
+{
+    if (options->replExParams.exchangeInterval != 0)
+    {
+        GMX_THROW(InconsistentInputError(
+                "Replica exchange needs all simulations to run at the same time, "
+                "which is not the case with -multidirgroups"));
+    }
+
+    MultiSimulationQueue queue(communicator, ssize(directoryNames), options->numMultiDirGroups);
+
+    // Each simulation starts from the file names given on the command line
+    const std::vector<t_filenm> initialFilenames = options->filenames;
+    char                        startDirectory[GMX_PATH_MAX];
+    gmx_getcwd(startDirectory, GMX_PATH_MAX);
+
+    int returnValue = 0;
+    for (int simulationIndex = queue.claimNextSimulation(); simulationIndex >= 0;
+         simulationIndex     = queue.claimNextSimulation())
+    {
+        options->filenames = initialFilenames;
+        gmx_chdir(directoryNames[simulationIndex].c_str());
+        gmx_reset_stop_condition();
+        returnValue = std::max(returnValue, runSimulation(queue.groupComm(), hwinfo, options, {}));
+        gmx_chdir(startDirectory);
+    }
+
+    return returnValue;
+}
+
+int gmx_mdrun(MPI_Comm communicator, const gmx_hw_info_t& hwinfo, int argc, char* argv[])
+{
     std::vector<const char*> desc = {
         "[THISMODULE] is the main computational chemistry engine",
         "within GROMACS. Obviously, it performs Molecular Dynamics simulations,",
@@ -226,58 +338,12 @@ int gmx_mdrun(MPI_Comm communicator, const gmx_hw_info_t& hwinfo, int argc, char
     ArrayRef<const std::string> multiSimDirectoryNames =
             opt2fnsIfOptionSet("-multidir", ssize(options.filenames), options.filenames.data());
 
-    // The SimulationContext is necessary with gmxapi so that
-    // resources owned by the client code can have suitable
-    // lifetime. The gmx wrapper binary uses the same infrastructure,
-    // but the lifetime is now trivially that of the invocation of the
-    // wrapper binary.
-    SimulationContext simulationContext(communicator, multiSimDirectoryNames);
-
-    StartingBehavior startingBehavior        = StartingBehavior::NewSimulation;
-    LogFilePtr       logFileGuard            = nullptr;
-    gmx_multisim_t*  ms                      = simulationContext.multiSimulation_.get();
-    std::tie(startingBehavior, logFileGuard) = handleRestart(
-            findIsSimulationMasterRank(ms, communicator), communicator, ms,
-            options.mdrunOptions.appendingBehavior, ssize(options.filenames), options.filenames.data());
-
-    /* The named components for the builder exposed here are descriptive of the
-     * state of mdrun at implementation and are not intended to be prescriptive
-     * of future design. (Note the ICommandLineOptions... framework used elsewhere.)
-     * The modules should ultimately take part in composing the Director code
-     * for an extensible Builder.
-     *
-     * In the near term, we assume that resources like domain decomposition and
-     * neighbor lists must be reinitialized between simulation segments.
-     * We would prefer to rebuild resources only as necessary, but we defer such
-     * details to future optimizations.
-     */
-    auto builder = MdrunnerBuilder(std::move(mdModules),
-                                   compat::not_null<SimulationContext*>(&simulationContext));
-    builder.addHardwareDetectionResult(&hwinfo);
-    builder.addSimulationMethod(options.mdrunOptions, options.pforce, startingBehavior);
-    builder.addDomainDecomposition(options.domdecOptions);
-    // \todo pass by value
-    builder.addNonBonded(options.nbpu_opt_choices[0]);
-    // \todo pass by value
-    builder.addElectrostatics(options.pme_opt_choices[0], options.pme_fft_opt_choices[0]);
-    builder.addBondedTaskAssignment(options.bonded_opt_choices[0]);
-    builder.addUpdateTaskAssignment(options.update_opt_choices[0]);
-    builder.addNeighborList(options.nstlist_cmdline);
-    builder.addReplicaExchange(options.replExParams);
-    // Need to establish run-time values from various inputs to provide a resource handle to Mdrunner
-    builder.addHardwareOptions(options.hw_opt);
-    // \todo File names are parameters that should be managed modularly through further factoring.
-    builder.addFilenames(options.filenames);
-    builder.addInput(makeSimulationInput(options));
-    // Note: The gmx_output_env_t life time is not managed after the call to parse_common_args.
-    // \todo Implement lifetime management for gmx_output_env_t.
-    // \todo Output environment should be configured outside of Mdrunner and provided as a resource.
-    builder.addOutputEnvironment(options.oenv);
-    builder.addLogFile(logFileGuard.get());
-
-    auto runner = builder.build();
+    if (options.numMultiDirGroups > 0 && !multiSimDirectoryNames.empty())
+    {
+        return runSimulationQueue(communicator, hwinfo, &options, multiSimDirectoryNames);
+    }
 
-    return runner.mdrunner();
+    return runSimulation(communicator, hwinfo, &options, multiSimDirectoryNames);
 }
 
 } // namespace gmx
@@ -152,7 +152,26 @@ void NonbondedBenchmark::initOptions(IOptionsContainer* options, ICommandLineOpt
         "In the MD engine, any clusters where at most half of the atoms",
         "have LJ interactions will automatically use this kernel.",
         "And finally, the [TT]-energy[tt] option selects the computation",
-        "of energies, which are usually only needed infrequently."
+        "of energies, which are usually only needed infrequently.[PAR]",
+        "The system consists of [TT]-size[tt] times 1000 water molecules",
+        "stacked along the three dimensions. With [TT]-density[tt] the whole",
+        "system is scaled uniformly to obtain a different atom density,",
+        "which changes the number of pairs per atom at the same cut-off.[PAR]",
+        "With [TT]-gpu[tt] the GPU kernels are run on the GPU selected",
+        "with [TT]-gpu_id[tt]. The GPU times are measured on the host and",
+        "include the launch overhead, the transfer of the forces back",
+        "to the host and waiting for the GPU, as during an MD step.",
+        "With [TT]-prune[tt] the pairlist is generated with a cut-off that is",
+        "[TT]-prunebuffer[tt] longer than the interaction cut-off and the",
+        "dynamic pruning kernel is timed as well. Total pair counts then refer",
+        "to the outer list. With a GPU, the time of the pruning kernel is",
+        "the difference between iterations with and without pruning.[PAR]",
+        "The time for putting the atoms on the grid and constructing the",
+        "pairlist, as well as the time for the coordinate and force buffer",
+        "operations that convert between the nbnxm and the normal atom",
+        "layout, are measured for each kernel setup. These are printed",
+        "with [TT]-breakdown[tt]. All results can be written to a JSON file",
+        "with [TT]-json[tt] for comparisons between hardware and versions."
     };
 
     settings->setHelpText(desc);
@@ -169,8 +188,16 @@ void NonbondedBenchmark::initOptions(IOptionsContainer* options, ICommandLineOpt
 
     options->addOption(
             IntegerOption("size").store(&sizeFactor_).description("The system size is 3000 atoms times this value"));
+    options->addOption(RealOption("density")
+                               .store(&benchmarkOptions_.densityFactor)
+                               .description("The atom density relative to that of water"));
     options->addOption(
             IntegerOption("nt").store(&benchmarkOptions_.numThreads).description("The number of OpenMP threads to use"));
+    options->addOption(
+            BooleanOption("gpu").store(&benchmarkOptions_.useGpu).description("Run the kernels on a GPU"));
+    options->addOption(IntegerOption("gpu_id")
+                               .store(&benchmarkOptions_.gpuId)
+                               .description("The ID of the GPU to use with -gpu"));
     options->addOption(EnumOption<Nbnxm::BenchMarkKernels>("simd")
                                .store(&benchmarkOptions_.nbnxmSimd)
                                .enumValue(c_nbnxmSimdStrings)
@@ -199,6 +226,12 @@ void NonbondedBenchmark::initOptions(IOptionsContainer* options, ICommandLineOpt
     options->addOption(RealOption("cutoff")
                                .store(&benchmarkOptions_.pairlistCutoff)
                                .description("Pair-list and interaction cut-off distance"));
+    options->addOption(BooleanOption("prune")
+                               .store(&benchmarkOptions_.doPrune)
+                               .description("Also time the dynamic pruning kernel"));
+    options->addOption(RealOption("prunebuffer")
+                               .store(&benchmarkOptions_.pruneBuffer)
+                               .description("The pairlist buffer beyond the cut-off with -prune"));
     options->addOption(IntegerOption("iter")
                                .store(&benchmarkOptions_.numIterations)
                                .description("The number of iterations for each kernel"));
@@ -216,6 +249,15 @@ void NonbondedBenchmark::initOptions(IOptionsContainer* options, ICommandLineOpt
                                .store(&benchmarkOptions_.outputFile)
                                .defaultBasename("nonbonded-benchmark")
                                .description("Also output results in csv format"));
+    options->addOption(BooleanOption("breakdown")
+                               .store(&benchmarkOptions_.printSearchAndBufferOps)
+                               .description("Also print the pair search and buffer operation times"));
+    options->addOption(FileNameOption("json")
+                               .filetype(eftJson)
+                               .outputFile()
+                               .store(&benchmarkOptions_.jsonOutputFile)
+                               .defaultBasename("nonbonded-benchmark")
+                               .description("Also output all results in JSON format"));
 }
 
 void NonbondedBenchmark::optionsFinished()
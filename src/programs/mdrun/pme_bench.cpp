@@ -0,0 +1,169 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *
+ * \brief This file contains the main function for the PME kernel benchmark
+ */
+
+#include "gmxpre.h"
+
+#include "pme_bench.h"
+
+#include <vector>
+
+#include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/ewald/benchmark/pme_bench.h"
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/filenameoption.h"
+#include "gromacs/options/ioptionscontainer.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+class PmeBenchmark : public ICommandLineOptionsModule
+{
+public:
+    PmeBenchmark() {}
+
+    // From ICommandLineOptionsModule
+    void init(CommandLineModuleSettings* /*settings*/) override {}
+    void initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings) override;
+    void optionsFinished() override {}
+    int  run() override;
+
+private:
+    PmeBenchOptions benchmarkOptions_;
+};
+
+void PmeBenchmark::initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings)
+{
+    std::vector<const char*> desc = {
+        "[THISMODULE] times the stages of a smooth PME mesh calculation",
+        "for Coulomb interactions: the spline computation together with",
+        "the spreading of the charges on the grid, the forward and backward",
+        "3D FFT, the solve in reciprocal space and the gathering of the forces.",
+        "The same code as in mdrun is used, either on the CPU or, with",
+        "[TT]-gpu[tt], on the GPU selected with [TT]-gpu_id[tt].[PAR]",
+        "The system is a cubic box with [TT]-grid[tt] grid points along",
+        "each box vector at a grid spacing of [TT]-spacing[tt], filled with",
+        "uniformly distributed atoms with alternating charges.",
+        "By default the number of atoms is set from the box volume and",
+        "[TT]-density[tt], which is roughly the atom density of water.",
+        "With [TT]-natoms[tt] the atom counts can be set explicitly.",
+        "Multiple values can be given for [TT]-grid[tt], [TT]-order[tt] and",
+        "[TT]-natoms[tt]; all combinations are run.[PAR]",
+        "Each setup is run for [TT]-warmup[tt] untimed iterations followed",
+        "by [TT]-iter[tt] timed iterations, the time per iteration of each",
+        "stage is reported in microseconds. On the CPU the stages are timed",
+        "with the mdrun cycle counters, so the times correspond to the",
+        "PME entries of the performance table in the mdrun log file.",
+        "The number of OpenMP threads is set with [TT]-nt[tt].",
+        "On the GPU each stage is launched separately and waited for,",
+        "so the times include the launch overhead of the stage and,",
+        "for the gather, the transfer of the forces to the host.",
+        "With [TT]-energy[tt] the energy and virial are computed as well.[PAR]",
+        "All results can be written to a JSON file with [TT]-json[tt]",
+        "for comparisons between hardware and versions."
+    };
+
+    settings->setHelpText(desc);
+
+    options->addOption(IntegerOption("grid")
+                               .storeVector(&benchmarkOptions_.gridSizes)
+                               .multiValue()
+                               .description("The number of grid points along each box vector"));
+    options->addOption(IntegerOption("order")
+                               .storeVector(&benchmarkOptions_.pmeOrders)
+                               .multiValue()
+                               .description("The PME interpolation order"));
+    options->addOption(IntegerOption("natoms")
+                               .storeVector(&benchmarkOptions_.atomCounts)
+                               .multiValue()
+                               .description("The number of atoms, by default set from -density"));
+    options->addOption(RealOption("spacing")
+                               .store(&benchmarkOptions_.gridSpacing)
+                               .description("The grid spacing (nm)"));
+    options->addOption(RealOption("density")
+                               .store(&benchmarkOptions_.atomDensity)
+                               .description("The atom density (nm^-3) without -natoms"));
+    options->addOption(RealOption("cutoff")
+                               .store(&benchmarkOptions_.cutoff)
+                               .description("The Coulomb cut-off that sets the Ewald coefficient"));
+    options->addOption(
+            IntegerOption("nt").store(&benchmarkOptions_.numThreads).description("The number of OpenMP threads to use"));
+    options->addOption(
+            BooleanOption("gpu").store(&benchmarkOptions_.useGpu).description("Run PME on a GPU"));
+    options->addOption(IntegerOption("gpu_id")
+                               .store(&benchmarkOptions_.gpuId)
+                               .description("The ID of the GPU to use with -gpu"));
+    options->addOption(BooleanOption("energy")
+                               .store(&benchmarkOptions_.computeEnergy)
+                               .description("Compute the energy and virial in addition to forces"));
+    options->addOption(IntegerOption("iter")
+                               .store(&benchmarkOptions_.numIterations)
+                               .description("The number of timed iterations for each setup"));
+    options->addOption(IntegerOption("warmup")
+                               .store(&benchmarkOptions_.numWarmupIterations)
+                               .description("The number of iterations for initial warmup"));
+    options->addOption(FileNameOption("json")
+                               .filetype(eftJson)
+                               .outputFile()
+                               .store(&benchmarkOptions_.jsonOutputFile)
+                               .defaultBasename("pme-benchmark")
+                               .description("Also output all results in JSON format"));
+}
+
+int PmeBenchmark::run()
+{
+    pmeBench(benchmarkOptions_);
+
+    return 0;
+}
+
+} // namespace
+
+const char PmeBenchmarkInfo::name[]             = "pme-benchmark";
+const char PmeBenchmarkInfo::shortDescription[] = "Benchmarking tool for the PME mesh stages.";
+
+ICommandLineOptionsModulePointer PmeBenchmarkInfo::create()
+{
+    return ICommandLineOptionsModulePointer(std::make_unique<PmeBenchmark>());
+}
+
+} // namespace gmx
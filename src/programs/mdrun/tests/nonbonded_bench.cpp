@@ -48,6 +48,7 @@
 
 #include "testutils/refdata.h"
 #include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
 
 #include "moduletest.h"
 
@@ -67,6 +68,27 @@ TEST(NonbondedBenchTest, BasicEndToEndTest)
                          &gmx::NonbondedBenchmarkInfo::create, &cmdline));
 }
 
+TEST(NonbondedBenchTest, WritesJsonReportWithPruningAndBufferOps)
+{
+    TestFileManager   fileManager;
+    const std::string jsonFileName = fileManager.getTemporaryFilePath("bench.json");
+    const char* const command[]    = { "nonbonded-benchmark" };
+    CommandLine       cmdline(command);
+    cmdline.addOption("-iter", 1);
+    cmdline.addOption("-prune");
+    cmdline.addOption("-breakdown");
+    cmdline.addOption("-json", jsonFileName);
+    ASSERT_EQ(0, gmx::test::CommandLineTestHelper::runModuleFactory(
+                         &gmx::NonbondedBenchmarkInfo::create, &cmdline));
+
+    const std::string report = TextReader::readFileToString(jsonFileName);
+    EXPECT_TRUE(startsWith(report, "{"));
+    EXPECT_TRUE(endsWith(report, "}\n"));
+    EXPECT_NE(std::string::npos, report.find("\"benchmarks\": ["));
+    EXPECT_NE(std::string::npos, report.find("\"prune_per_iteration\""));
+    EXPECT_NE(std::string::npos, report.find("\"f_buffer_ops_per_iteration\""));
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
@@ -0,0 +1,84 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ * \brief
+ * This implements basic PME bench tests.
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include "programs/mdrun/pme_bench.h"
+
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/textreader.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(PmeBenchTest, WritesJsonReport)
+{
+    TestFileManager   fileManager;
+    const std::string jsonFileName = fileManager.getTemporaryFilePath("bench.json");
+    const char* const command[]    = { "pme-benchmark", "-grid", "16", "20", "-order", "4", "5" };
+    CommandLine       cmdline(command);
+    cmdline.addOption("-iter", 1);
+    cmdline.addOption("-warmup", 0);
+    cmdline.addOption("-energy");
+    cmdline.addOption("-json", jsonFileName);
+    ASSERT_EQ(0, gmx::test::CommandLineTestHelper::runModuleFactory(&gmx::PmeBenchmarkInfo::create,
+                                                                    &cmdline));
+
+    const std::string report = TextReader::readFileToString(jsonFileName);
+    EXPECT_TRUE(startsWith(report, "{"));
+    EXPECT_TRUE(endsWith(report, "}\n"));
+    EXPECT_NE(std::string::npos, report.find("\"benchmarks\": ["));
+    EXPECT_NE(std::string::npos, report.find("\"grid\": 20"));
+    EXPECT_NE(std::string::npos, report.find("\"order\": 5"));
+    EXPECT_NE(std::string::npos, report.find("\"gather\""));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+#
+# This file is part of the GROMACS molecular simulation package.
+#
+# Copyright (c) 2021, by the GROMACS development team, led by
+# Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+# and including many others, as listed in the AUTHORS file in the
+# top-level source directory and at http://www.gromacs.org.
+#
+# GROMACS is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public License
+# as published by the Free Software Foundation; either version 2.1
+# of the License, or (at your option) any later version.
+#
+# GROMACS is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with GROMACS; if not, see
+# http://www.gnu.org/licenses, or write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+#
+# If you want to redistribute modifications to GROMACS, please
+# consider that scientific software is very special. Version
+# control is crucial - bugs must be traceable. We will be happy to
+# consider code for inclusion in the official distribution, but
+# derived work must not be called official GROMACS. Details are found
+# in the README & COPYING files - if they are missing, get the
+# official version at http://www.gromacs.org.
+#
+# To help us fund GROMACS development, we humbly ask that you cite
+# the research papers on the package. Check out http://www.gromacs.org.
+
+"""Runs a set of mdrun performance benchmarks and writes the results as JSON.
+
+Every system listed in the input JSON file is prepared once (either by
+solvating a box of the requested size or by copying a user-supplied tpr
+file) and then run with every combination of the mdrun options given in
+the "sweep" entry. For every run the ns/day and the wallcycle breakdown
+from md.log are stored. When a reference result file is given, runs whose
+performance dropped by more than the tolerance are reported and the script
+returns a non-zero exit code, so it can be used for regression tracking.
+"""
+
+import argparse
+import datetime
+import itertools
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+
+
+def gmx_command(args, name):
+    return [os.path.join(args.bindir, name + args.suffix)]
+
+
+def run_command(cmd, cwd, verbose):
+    if verbose:
+        print(' '.join(cmd))
+    result = subprocess.run(cmd, cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    with open(os.path.join(cwd, 'commands.log'), 'a') as log:
+        log.write('$ ' + ' '.join(cmd) + '\n')
+        log.write(result.stdout)
+    return result.returncode
+
+
+def prepare_system(system, args, source_dir):
+    """Creates <wd>/<name>/system.tpr and returns the directory it is in."""
+    directory = os.path.join(args.wd, system['name'])
+    if os.path.exists(directory):
+        shutil.rmtree(directory)
+    os.makedirs(directory)
+    gmx = gmx_command(args, 'gmx')
+
+    if 'tpr' in system:
+        tpr = system['tpr']
+        if not os.path.isabs(tpr):
+            tpr = os.path.join(source_dir, tpr)
+        shutil.copy(tpr, os.path.join(directory, 'system.tpr'))
+        return directory
+
+    input_dir = os.path.join(source_dir, 'systems', system['dir'])
+    box = str(system['box'])
+    if run_command(gmx + ['solvate', '-cs', 'spc216', '-box', box, box, box,
+                          '-o', 'system.gro'], directory, args.verbose) != 0:
+        return None
+    with open(os.path.join(directory, 'system.gro')) as gro:
+        gro.readline()
+        num_molecules = int(gro.readline()) // 3
+    with open(os.path.join(input_dir, 'system.top')) as template:
+        topology = template.read().replace('@NUMMOLS@', str(num_molecules))
+    with open(os.path.join(directory, 'system.top'), 'w') as top:
+        top.write(topology)
+    shutil.copy(os.path.join(input_dir, 'system.mdp'), directory)
+    if run_command(gmx + ['grompp', '-f', 'system.mdp', '-p', 'system.top', '-c', 'system.gro',
+                          '-o', 'system.tpr'], directory, args.verbose) != 0:
+        return None
+    return directory
+
+
+def sweep_configurations(sweep):
+    """Returns all combinations of the sweep options that mdrun can run.
+
+    PME and the update can only be offloaded when the nonbonded
+    interactions are, so combinations violating that are skipped.
+    """
+    keys = sorted(sweep.keys())
+    for values in itertools.product(*(sweep[key] for key in keys)):
+        config = dict(zip(keys, values))
+        if config.get('nb') == 'cpu' and (config.get('pme') == 'gpu'
+                                          or config.get('update') == 'gpu'):
+            continue
+        yield config
+
+
+def configuration_name(config):
+    return '_'.join('{}{}'.format(key, config[key]) for key in sorted(config.keys()))
+
+
+def parse_log(filename):
+    """Returns the ns/day and the wallcycle table from an mdrun log file."""
+    performance = None
+    wallcycle = {}
+    in_table = False
+    separators = 0
+    with open(filename) as log:
+        for line in log:
+            if 'R E A L   C Y C L E   A N D   T I M E   A C C O U N T I N G' in line:
+                in_table = True
+                separators = 0
+                wallcycle = {}
+            elif in_table:
+                if line.startswith('-----'):
+                    separators += 1
+                    # The table ends with the separator after the total
+                    if separators == 3:
+                        in_table = False
+                elif separators > 0 and line.strip():
+                    fields = line[20:].split()
+                    if len(fields) >= 3:
+                        wallcycle[line[1:20].strip()] = {
+                            'wall_time_s': float(fields[-3]),
+                            'giga_cycles': float(fields[-2]),
+                            'percent': float(fields[-1]),
+                        }
+            if line.startswith('Performance:'):
+                performance = float(line.split()[1])
+    return performance, wallcycle
+
+
+def run_benchmarks(args, spec, source_dir):
+    results = []
+    sweep = spec['sweep']
+    if args.sweep:
+        sweep = json.loads(args.sweep)
+    for system in spec['systems']:
+        if args.systems and system['name'] not in args.systems:
+            continue
+        print('Preparing ' + system['name'])
+        directory = prepare_system(system, args, source_dir)
+        if directory is None:
+            print('  preparing failed, see ' + os.path.join(args.wd, system['name'], 'commands.log'))
+            results.append({'system': system['name'], 'status': 'prepare failed'})
+            continue
+        nsteps = args.nsteps if args.nsteps else system.get('nsteps', 10000)
+        for config in sweep_configurations(sweep):
+            name = configuration_name(config)
+            cmd = gmx_command(args, 'gmx') + ['mdrun', '-s', 'system.tpr', '-deffnm', name,
+                                              '-nsteps', str(nsteps), '-resethway', '-noconfout']
+            for key in sorted(config.keys()):
+                cmd += ['-' + key, str(config[key])]
+            cmd += args.mdrun_args
+            if args.mpicmd:
+                cmd = args.mpicmd.split() + cmd
+            print('  running ' + name)
+            result = {'system': system['name'], 'options': config, 'nsteps': nsteps}
+            if run_command(cmd, directory, args.verbose) != 0:
+                result['status'] = 'failed'
+            else:
+                performance, wallcycle = parse_log(os.path.join(directory, name + '.log'))
+                result['status'] = 'ok' if performance is not None else 'no performance data'
+                result['ns_per_day'] = performance
+                result['wallcycle'] = wallcycle
+                print('    {} ns/day'.format(performance))
+            results.append(result)
+    return results
+
+
+def compare_to_reference(results, reference_file, tolerance):
+    """Prints and returns the runs that are slower than in the reference."""
+    with open(reference_file) as f:
+        reference = json.load(f)
+    reference_performance = {}
+    for result in reference['results']:
+        if result.get('ns_per_day'):
+            key = (result['system'], configuration_name(result['options']))
+            reference_performance[key] = result['ns_per_day']
+    regressions = []
+    for result in results:
+        if not result.get('ns_per_day'):
+            continue
+        key = (result['system'], configuration_name(result['options']))
+        if key not in reference_performance:
+            continue
+        change = result['ns_per_day'] / reference_performance[key] - 1
+        result['change_vs_reference'] = change
+        if change < -tolerance:
+            print('Regression for {} {}: {:.3f} ns/day vs {:.3f} ns/day ({:+.1f}%)'.format(
+                key[0], key[1], result['ns_per_day'], reference_performance[key], 100 * change))
+            regressions.append(result)
+    return regressions
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(
+        description='Run the GROMACS mdrun performance benchmarks and store the results as JSON.')
+    parser.add_argument('json', type=open, help='JSON file listing the systems and the sweep.')
+    parser.add_argument('-s', '--systems', nargs='*', metavar='NAME',
+                        help='Only run the named systems (default: all).')
+    parser.add_argument('--sweep', default=None,
+                        help='JSON dictionary replacing the option sweep of the input file, '
+                        'e.g. \'{"ntomp": [4, 8], "nb": ["gpu"]}\'.')
+    parser.add_argument('--nsteps', type=int, default=None,
+                        help='Number of steps per run, overrides the per-system value.')
+    parser.add_argument('--mdrun-args', nargs=argparse.REMAINDER, default=[],
+                        help='Further arguments passed to every mdrun call; must come last.')
+    parser.add_argument('-o', '--output', default='benchmark_results.json',
+                        help='File the results are written to, relative to --wd.')
+    parser.add_argument('--reference', default=None,
+                        help='Result file of an earlier run to compare the performance against.')
+    parser.add_argument('--tolerance', type=float, default=0.05,
+                        help='Relative performance drop reported as regression (default: 0.05).')
+    parser.add_argument('--wd', '--working-dir', default=os.getcwd(),
+                        help='Directory the benchmarks are run in.')
+    parser.add_argument('--bindir', default='', help='Directory of the gmx binary.')
+    parser.add_argument('--suffix', default='', help='Suffix of the gmx binary.')
+    parser.add_argument('--mpicmd', default=None,
+                        help='MPI launcher prepended to mdrun, e.g. "mpirun -np 4".')
+    parser.add_argument('-v', '--verbose', action='store_true', help='Print the commands run.')
+    args = parser.parse_args(argv)
+
+    spec = json.load(args.json)
+    source_dir = os.path.dirname(os.path.abspath(args.json.name))
+    args.wd = os.path.abspath(args.wd)
+    if not os.path.exists(args.wd):
+        os.makedirs(args.wd)
+
+    results = run_benchmarks(args, spec, source_dir)
+    regressions = []
+    if args.reference:
+        regressions = compare_to_reference(results, args.reference, args.tolerance)
+
+    output = {
+        'date': datetime.datetime.now().isoformat(),
+        'host': platform.node(),
+        'results': results,
+    }
+    output_file = os.path.join(args.wd, args.output)
+    with open(output_file, 'w') as f:
+        json.dump(output, f, indent=4)
+    print('Results written to ' + output_file)
+
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))